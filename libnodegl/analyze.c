@@ -0,0 +1,268 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "darray.h"
+#include "format.h"
+#include "hmap.h"
+#include "nodegl.h"
+#include "nodes.h"
+
+struct analyze_node {
+    struct ngl_node *node;
+    int64_t memory;     /* estimated from the parameters */
+    int unknown_size;
+    int gpu_buffer;     /* used by other nodes than textures */
+    int was_active;     /* activity before the analysis, restored after it */
+    int active;         /* activity at the previous time */
+};
+
+struct analyze_ctx {
+    struct darray nodes; /* struct analyze_node */
+    struct hmap *index;  /* index + 1 in nodes, by node address */
+};
+
+static const char *get_key(char *key, size_t size, const void *id)
+{
+    snprintf(key, size, "%p", id);
+    return key;
+}
+
+static int get_index(const struct analyze_ctx *ctx, const struct ngl_node *node)
+{
+    char key[32];
+    return (int)(intptr_t)ngli_hmap_get(ctx->index, get_key(key, sizeof(key), node)) - 1;
+}
+
+static int collect_nodes(struct analyze_ctx *ctx, struct ngl_node *node)
+{
+    if (get_index(ctx, node) >= 0)
+        return 0;
+
+    char key[32];
+    const int index = ngli_darray_count(&ctx->nodes);
+    int ret = ngli_hmap_set(ctx->index, get_key(key, sizeof(key), node), (void *)(intptr_t)(index + 1));
+    if (ret < 0)
+        return ret;
+    const struct analyze_node analyze_node = {.node = node, .was_active = node->is_active};
+    if (!ngli_darray_push(&ctx->nodes, &analyze_node))
+        return NGL_ERROR_MEMORY;
+
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++) {
+        ret = collect_nodes(ctx, children[i]);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+static int64_t estimate_texture_memory(const struct ngl_node *node, int *unknown_size)
+{
+    const struct texture_priv *s = node->priv_data;
+    const struct texture_params *params = &s->params;
+
+    int height = params->height;
+    int nb_layers = 1;
+    if (node->class->id == NGL_NODE_TEXTURECUBE) {
+        height = params->width;
+        nb_layers = 6;
+    } else if (node->class->id == NGL_NODE_TEXTURE3D) {
+        nb_layers = params->depth;
+    }
+
+    /* The dimensions of the media and images are only known once decoded */
+    if (!params->width || !height || !nb_layers) {
+        *unknown_size = 1;
+        return 0;
+    }
+
+    const int format = s->rtt_format != NGLI_FORMAT_UNDEFINED ? s->rtt_format : params->format;
+    int64_t size = ngli_format_get_image_size(format, params->width, height) * nb_layers;
+    if (params->mipmap_filter != NGLI_MIPMAP_FILTER_NONE)
+        size += size / 3;
+    return size;
+}
+
+/*
+ * The buffers only used as the data source of textures stay on the CPU, and
+ * the ones holding block fields are accounted with their block
+ */
+static void mark_gpu_buffers(struct analyze_ctx *ctx)
+{
+    struct analyze_node *nodes = ngli_darray_data(&ctx->nodes);
+    for (int i = 0; i < ngli_darray_count(&ctx->nodes); i++) {
+        const struct ngl_node *node = nodes[i].node;
+        if (node->class->category == NGLI_NODE_CATEGORY_TEXTURE)
+            continue;
+        struct ngl_node **children = ngli_darray_data(&node->children);
+        for (int j = 0; j < ngli_darray_count(&node->children); j++) {
+            if (children[j]->class->category == NGLI_NODE_CATEGORY_BUFFER)
+                nodes[get_index(ctx, children[j])].gpu_buffer = 1;
+        }
+    }
+}
+
+static void estimate_memory(struct analyze_node *analyze_node)
+{
+    const struct ngl_node *node = analyze_node->node;
+
+    switch (node->class->category) {
+        case NGLI_NODE_CATEGORY_TEXTURE:
+            analyze_node->memory = estimate_texture_memory(node, &analyze_node->unknown_size);
+            return;
+        case NGLI_NODE_CATEGORY_BUFFER: {
+            const struct buffer_priv *buffer = node->priv_data;
+            analyze_node->memory = analyze_node->gpu_buffer && !buffer->block ? buffer->data_size : 0;
+            return;
+        }
+        case NGLI_NODE_CATEGORY_BLOCK: {
+            const struct block_priv *block = node->priv_data;
+            analyze_node->memory = block->data_size;
+            return;
+        }
+    }
+
+    if (node->class->id == NGL_NODE_RENDERTOTEXTURE)
+        analyze_node->memory = ngli_node_rtt_estimate_memory(node);
+    else if (node->class->id == NGL_NODE_PARTICLESYSTEM)
+        analyze_node->memory = ngli_node_particlesystem_estimate_memory(node);
+}
+
+/* The draws of the active branches, a node shared by several of them being drawn by each */
+static void count_draws(const struct ngl_node *node, double t, struct ngl_analysis *analysis)
+{
+    if (!node->is_active)
+        return;
+
+    switch (node->class->id) {
+        case NGL_NODE_RENDER:
+        case NGL_NODE_TEXT:
+        case NGL_NODE_SHAPE:
+        case NGL_NODE_BLUR:
+        case NGL_NODE_HUD:
+            analysis->nb_draws++;
+            break;
+        case NGL_NODE_COMPUTE:
+            analysis->nb_dispatches++;
+            break;
+        case NGL_NODE_PARTICLESYSTEM:
+            /* Emission, preparation of the simulation and simulation */
+            analysis->nb_draws++;
+            analysis->nb_dispatches += 3;
+            break;
+        case NGL_NODE_TIMERANGEFILTER:
+            if (!ngli_node_timerangefilter_draws_child(node, t))
+                return;
+            break;
+    }
+
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++)
+        count_draws(children[i], t, analysis);
+}
+
+static void analyze_time(struct analyze_ctx *ctx, struct ngl_node *scene, double t,
+                         struct ngl_analysis *analysis)
+{
+    memset(analysis, 0, sizeof(*analysis));
+    analysis->t = t;
+
+    struct analyze_node *nodes = ngli_darray_data(&ctx->nodes);
+    for (int i = 0; i < ngli_darray_count(&ctx->nodes); i++) {
+        struct analyze_node *analyze_node = &nodes[i];
+        if (!analyze_node->node->is_active) {
+            analyze_node->active = 0;
+            continue;
+        }
+        analysis->nb_active_nodes++;
+        analysis->memory += analyze_node->memory;
+        analysis->nb_unknown_sizes += analyze_node->unknown_size;
+        if (!analyze_node->active) {
+            analysis->nb_prefetches++;
+            analysis->prefetch_memory += analyze_node->memory;
+        }
+        analyze_node->active = 1;
+    }
+
+    count_draws(scene, t, analysis);
+}
+
+/*
+ * The nodes are only visited: their activity is decided the same way as for
+ * a draw, but honor_release_prefetch() is never called so nothing gets
+ * allocated or released, and the activity of the nodes is restored at the
+ * end for the next draw to take its decisions from the actual states
+ */
+int ngli_analyze(struct ngl_ctx *s, const double *times, int nb_times, struct ngl_analysis *analysis)
+{
+    struct ngl_node *scene = s->scene;
+    if (!scene) {
+        for (int i = 0; i < nb_times; i++)
+            analysis[i] = (struct ngl_analysis){.t = times[i]};
+        return 0;
+    }
+
+    struct analyze_ctx ctx = {.index = ngli_hmap_create()};
+    if (!ctx.index)
+        return NGL_ERROR_MEMORY;
+    ngli_darray_init(&ctx.nodes, sizeof(struct analyze_node), 0);
+
+    int ret = collect_nodes(&ctx, scene);
+    if (ret < 0)
+        goto end;
+
+    mark_gpu_buffers(&ctx);
+
+    struct analyze_node *nodes = ngli_darray_data(&ctx.nodes);
+    const int nb_nodes = ngli_darray_count(&ctx.nodes);
+    for (int i = 0; i < nb_nodes; i++) {
+        estimate_memory(&nodes[i]);
+        /* A time identical to the last draw must not be taken as already visited */
+        nodes[i].node->visit_time = -1.;
+    }
+
+    /* The release of the held nodes is left to the next draw */
+    const int visit_release_held = s->visit_release_held;
+    s->activity_gen++;
+    for (int i = 0; i < nb_times; i++) {
+        ret = ngli_visit_scene(s, times[i]);
+        if (ret < 0)
+            break;
+        analyze_time(&ctx, scene, times[i], &analysis[i]);
+    }
+    s->visit_release_held = visit_release_held;
+
+    for (int i = 0; i < nb_nodes; i++) {
+        nodes[i].node->is_active = nodes[i].was_active;
+        nodes[i].node->visit_time = -1.;
+    }
+    s->activity_gen++;
+    s->frame_changed = 1;
+
+end:
+    ngli_darray_reset(&ctx.nodes);
+    ngli_hmap_freep(&ctx.index);
+    return ret;
+}
@@ -27,14 +27,18 @@ public class OnFrameAvailableListener implements SurfaceTexture.OnFrameAvailable
     private long nativePtr;
 
     public synchronized void onFrameAvailable(SurfaceTexture surfaceTexture) {
-        nativeOnFrameAvailable(nativePtr);
+        /* The listener is detached from its native surface before the
+         * surface is freed, while the callbacks already queued on the
+         * shared handler thread may still be delivered */
+        if (nativePtr != 0)
+            nativeOnFrameAvailable(nativePtr);
     }
 
     public long getNativePtr() {
         return this.nativePtr;
     }
 
-    public void setNativePtr(long nativePtr) {
+    public synchronized void setNativePtr(long nativePtr) {
         this.nativePtr = nativePtr;
     }
 
@@ -26,9 +26,12 @@
 #include "android_handler.h"
 #include "android_handlerthread.h"
 #include "memory.h"
+#include "utils.h"
 
 struct android_handlerthread {
     pthread_t tid;
+    int priority;
+    uint64_t affinity;
     pthread_mutex_t lock;
     pthread_cond_t cond;
     struct android_looper *looper;
@@ -40,6 +43,9 @@ static void *run(void * data)
     int ret;
     struct android_handlerthread *thread = data;
 
+    if (thread->priority || thread->affinity)
+        ngli_thread_set_priority(thread->priority, thread->affinity);
+
     pthread_mutex_lock(&thread->lock);
 
     thread->looper = ngli_android_looper_new();
@@ -73,12 +79,15 @@ fail:
     return NULL;
 }
 
-struct android_handlerthread *ngli_android_handlerthread_new(void)
+struct android_handlerthread *ngli_android_handlerthread_new(int priority, uint64_t affinity)
 {
     struct android_handlerthread *thread = ngli_calloc(1, sizeof(*thread));
     if (!thread)
         return NULL;
 
+    thread->priority = priority;
+    thread->affinity = affinity;
+
     pthread_mutex_init(&thread->lock, NULL);
     pthread_cond_init(&thread->cond, NULL);
     pthread_mutex_lock(&thread->lock);
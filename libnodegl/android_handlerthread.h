@@ -22,8 +22,10 @@
 #ifndef ANDROID_HANDLERTHREAD_H
 #define ANDROID_HANDLERTHREAD_H
 
+#include <stdint.h>
+
 struct android_handlerthread;
-struct android_handlerthread *ngli_android_handlerthread_new(void);
+struct android_handlerthread *ngli_android_handlerthread_new(int priority, uint64_t affinity);
 void *ngli_android_handlerthread_get_native_handler(struct android_handlerthread *thread);
 void ngli_android_handlerthread_free(struct android_handlerthread **thread);
 
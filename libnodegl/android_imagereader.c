@@ -0,0 +1,305 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include <android/api-level.h>
+
+#if __ANDROID_API__ >= 26
+#include <android/hardware_buffer.h>
+#include <android/native_window_jni.h>
+#include <media/NdkImageReader.h>
+#endif
+
+#include "android_imagereader.h"
+#include "egl.h"
+#include "glincludes.h"
+#include "glstate.h"
+#include "jni_utils.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#if __ANDROID_API__ >= 26
+
+/*
+ * One image is written by the codec while the latest one is sampled and the
+ * previous one may still be in use by the GPU
+ */
+#define MAX_IMAGES 3
+
+struct android_imagereader {
+    struct glcontext *gl;
+    int tex_id;
+    AImageReader *reader;
+    jobject surface;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int on_image_available;
+    AImage *images[MAX_IMAGES - 1];      /* latest first */
+    EGLImageKHR egl_images[MAX_IMAGES - 1];
+};
+
+int ngli_android_imagereader_is_supported(struct glcontext *gl)
+{
+    const uint64_t features = NGLI_FEATURE_OES_EGL_EXTERNAL_IMAGE |
+                              NGLI_FEATURE_EGL_IMAGE_BASE_KHR |
+                              NGLI_FEATURE_EGL_ANDROID_NATIVE_BUFFER;
+    return (gl->features & features) == features && android_get_device_api_level() >= 26;
+}
+
+static void on_image_available(void *user_arg, AImageReader *image_reader)
+{
+    struct android_imagereader *reader = user_arg;
+
+    pthread_mutex_lock(&reader->lock);
+    reader->on_image_available = 1;
+    pthread_cond_signal(&reader->cond);
+    pthread_mutex_unlock(&reader->lock);
+}
+
+struct android_imagereader *ngli_android_imagereader_new(struct glcontext *gl, int tex_id)
+{
+    struct android_imagereader *ret = ngli_calloc(1, sizeof(*ret));
+    if (!ret)
+        return NULL;
+
+    ret->gl = gl;
+    ret->tex_id = tex_id;
+    pthread_mutex_init(&ret->lock, NULL);
+    pthread_cond_init(&ret->cond, NULL);
+
+    JNIEnv *env = ngli_jni_get_env();
+    if (!env)
+        goto fail;
+
+    /* The codec overrides the default dimensions with the frame ones */
+    media_status_t status = AImageReader_newWithUsage(16, 16, AIMAGE_FORMAT_PRIVATE,
+                                                      AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE,
+                                                      MAX_IMAGES, &ret->reader);
+    if (status != AMEDIA_OK) {
+        LOG(ERROR, "could not create image reader: %d", status);
+        goto fail;
+    }
+
+    AImageReader_ImageListener listener = {
+        .context = ret,
+        .onImageAvailable = on_image_available,
+    };
+    status = AImageReader_setImageListener(ret->reader, &listener);
+    if (status != AMEDIA_OK) {
+        LOG(ERROR, "could not set image reader listener: %d", status);
+        goto fail;
+    }
+
+    ANativeWindow *window = NULL;
+    status = AImageReader_getWindow(ret->reader, &window);
+    if (status != AMEDIA_OK) {
+        LOG(ERROR, "could not get image reader window: %d", status);
+        goto fail;
+    }
+
+    jobject surface = ANativeWindow_toSurface(env, window);
+    if (!surface)
+        goto fail;
+    ret->surface = (*env)->NewGlobalRef(env, surface);
+    (*env)->DeleteLocalRef(env, surface);
+    if (!ret->surface)
+        goto fail;
+
+    return ret;
+
+fail:
+    ngli_android_imagereader_free(&ret);
+    return NULL;
+}
+
+static void release_image(struct android_imagereader *reader, int index)
+{
+    if (reader->egl_images[index]) {
+        ngli_eglDestroyImageKHR(reader->gl, reader->egl_images[index]);
+        reader->egl_images[index] = NULL;
+    }
+    if (reader->images[index]) {
+        AImage_delete(reader->images[index]);
+        reader->images[index] = NULL;
+    }
+}
+
+void ngli_android_imagereader_free(struct android_imagereader **readerp)
+{
+    struct android_imagereader *reader = *readerp;
+    if (!reader)
+        return;
+
+    for (int i = 0; i < NGLI_ARRAY_NB(reader->images); i++)
+        release_image(reader, i);
+
+    if (reader->surface) {
+        JNIEnv *env = ngli_jni_get_env();
+        if (env)
+            (*env)->DeleteGlobalRef(env, reader->surface);
+    }
+
+    if (reader->reader)
+        AImageReader_delete(reader->reader);
+
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->cond);
+    ngli_free(reader);
+    *readerp = NULL;
+}
+
+void *ngli_android_imagereader_get_surface(struct android_imagereader *reader)
+{
+    if (!reader)
+        return NULL;
+
+    return reader->surface;
+}
+
+int ngli_android_imagereader_release_buffer(struct android_imagereader *reader, AVMediaCodecBuffer *buffer)
+{
+    pthread_mutex_lock(&reader->lock);
+    reader->on_image_available = 0;
+    int ret = av_mediacodec_release_buffer(buffer, 1);
+    pthread_mutex_unlock(&reader->lock);
+
+    return ret < 0 ? -1 : 0;
+}
+
+int ngli_android_imagereader_acquire_frame(struct android_imagereader *reader, float *matrix, int wait)
+{
+    struct glcontext *gl = reader->gl;
+
+    pthread_mutex_lock(&reader->lock);
+    if (!reader->on_image_available) {
+        if (!wait) {
+            pthread_mutex_unlock(&reader->lock);
+            return 0;
+        }
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 30000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&reader->cond, &reader->lock, &ts);
+    }
+    reader->on_image_available = 0;
+    pthread_mutex_unlock(&reader->lock);
+
+    AImage *image = NULL;
+    media_status_t status = AImageReader_acquireLatestImage(reader->reader, &image);
+    if (status == AMEDIA_IMGREADER_NO_BUFFER_AVAILABLE) {
+        LOG(WARNING, "no frame available");
+        return 0;
+    } else if (status != AMEDIA_OK) {
+        LOG(ERROR, "could not acquire image: %d", status);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    AHardwareBuffer *hardware_buffer = NULL;
+    int32_t width = 0, height = 0;
+    AImageCropRect crop = {0};
+    if (AImage_getHardwareBuffer(image, &hardware_buffer) != AMEDIA_OK ||
+        AImage_getWidth(image, &width) != AMEDIA_OK ||
+        AImage_getHeight(image, &height) != AMEDIA_OK ||
+        AImage_getCropRect(image, &crop) != AMEDIA_OK || !width || !height) {
+        LOG(ERROR, "could not get image properties");
+        AImage_delete(image);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    EGLClientBuffer client_buffer = ngli_eglGetNativeClientBufferANDROID(gl, hardware_buffer);
+    static const EGLint attribs[] = {EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE};
+    EGLImageKHR egl_image = ngli_eglCreateImageKHR(gl, EGL_NO_CONTEXT, EGL_NATIVE_BUFFER_ANDROID,
+                                                   client_buffer, attribs);
+    if (!egl_image) {
+        LOG(ERROR, "could not create egl image from hardware buffer");
+        AImage_delete(image);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_EXTERNAL_OES, reader->tex_id);
+    ngli_glEGLImageTargetTexture2DOES(gl, GL_TEXTURE_EXTERNAL_OES, egl_image);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_EXTERNAL_OES, 0);
+
+    /* The oldest image is given back to the codec */
+    const int last = NGLI_ARRAY_NB(reader->images) - 1;
+    release_image(reader, last);
+    memmove(reader->images + 1, reader->images, last * sizeof(*reader->images));
+    memmove(reader->egl_images + 1, reader->egl_images, last * sizeof(*reader->egl_images));
+    reader->images[0] = image;
+    reader->egl_images[0] = egl_image;
+
+    /* Crop and vertical flip, as SurfaceTexture.getTransformMatrix() */
+    const float sx = (crop.right - crop.left) / (float)width;
+    const float sy = (crop.bottom - crop.top) / (float)height;
+    const float tx = crop.left / (float)width;
+    const float ty = crop.top / (float)height;
+    const float crop_matrix[] = {
+        sx,   0.0f, 0.0f, 0.0f,
+        0.0f, -sy,  0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        tx,   ty + sy, 0.0f, 1.0f,
+    };
+    memcpy(matrix, crop_matrix, sizeof(crop_matrix));
+
+    return 1;
+}
+
+#else
+
+int ngli_android_imagereader_is_supported(struct glcontext *gl)
+{
+    return 0;
+}
+
+struct android_imagereader *ngli_android_imagereader_new(struct glcontext *gl, int tex_id)
+{
+    return NULL;
+}
+
+void ngli_android_imagereader_free(struct android_imagereader **readerp)
+{
+}
+
+void *ngli_android_imagereader_get_surface(struct android_imagereader *reader)
+{
+    return NULL;
+}
+
+int ngli_android_imagereader_release_buffer(struct android_imagereader *reader, AVMediaCodecBuffer *buffer)
+{
+    return NGL_ERROR_UNSUPPORTED;
+}
+
+int ngli_android_imagereader_acquire_frame(struct android_imagereader *reader, float *matrix, int wait)
+{
+    return NGL_ERROR_UNSUPPORTED;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef ANDROID_IMAGEREADER_H
+#define ANDROID_IMAGEREADER_H
+
+#include <libavcodec/mediacodec.h>
+
+#include "glcontext.h"
+
+/*
+ * MediaCodec output surface backed by an AImageReader (Android API 26+): the
+ * decoded frames are AHardwareBuffers imported as EGL images into an external
+ * OES texture, without any SurfaceTexture or per-frame JNI call.
+ */
+struct android_imagereader;
+
+/*
+ * Return 1 if the image reader can be used with this context, 0 otherwise.
+ */
+int ngli_android_imagereader_is_supported(struct glcontext *gl);
+
+struct android_imagereader *ngli_android_imagereader_new(struct glcontext *gl, int tex_id);
+void ngli_android_imagereader_free(struct android_imagereader **readerp);
+
+/*
+ * Return the android.view.Surface Java object the codec must render to.
+ */
+void *ngli_android_imagereader_get_surface(struct android_imagereader *reader);
+
+/*
+ * Same semantics as ngli_android_surface_release_buffer() and
+ * ngli_android_surface_acquire_frame(), the returned matrix following the
+ * SurfaceTexture.getTransformMatrix() convention.
+ */
+int ngli_android_imagereader_release_buffer(struct android_imagereader *reader, AVMediaCodecBuffer *buffer);
+int ngli_android_imagereader_acquire_frame(struct android_imagereader *reader, float *matrix, int wait);
+
+#endif /* ANDROID_IMAGEREADER_H */
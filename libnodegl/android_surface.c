@@ -39,6 +39,28 @@ static void native_on_frame_available(JNIEnv *env, jobject object, jlong surface
     ngli_android_surface_signal_frame(surface);
 }
 
+/*
+ * The handler thread servicing the callbacks is shared by all the surfaces
+ * of the context and outlives them, so the listener must stop reaching the
+ * surface before it is freed.
+ */
+static void surface_listener_detach(JNIEnv *env, jobject listener)
+{
+    jclass listener_class = (*env)->GetObjectClass(env, listener);
+    if (!listener_class)
+        return;
+
+    jmethodID set_native_ptr_id = (*env)->GetMethodID(env, listener_class, "setNativePtr", "(J)V");
+    if (ngli_jni_exception_check(env, 1) < 0)
+        goto done;
+
+    (*env)->CallVoidMethod(env, listener, set_native_ptr_id, (jlong)0);
+    ngli_jni_exception_check(env, 1);
+
+done:
+    (*env)->DeleteLocalRef(env, listener_class);
+}
+
 static jobject surface_listener_new(struct android_surface *surface)
 {
     jobject listener = NULL;
@@ -242,6 +264,9 @@ void ngli_android_surface_free(struct android_surface **surface)
         return;
     }
 
+    if ((*surface)->listener)
+        surface_listener_detach(env, (*surface)->listener);
+
     if ((*surface)->surface) {
         (*env)->CallVoidMethod(env, (*surface)->surface, (*surface)->jfields.surface_release_id);
         if (ngli_jni_exception_check(env, 1) < 0) {
@@ -330,7 +355,20 @@ fail:
     return ret;
 }
 
-int ngli_android_surface_render_buffer(struct android_surface *surface, AVMediaCodecBuffer *buffer, float *matrix)
+int ngli_android_surface_release_buffer(struct android_surface *surface, AVMediaCodecBuffer *buffer)
+{
+    if (!surface)
+        return 0;
+
+    pthread_mutex_lock(&surface->lock);
+    surface->on_frame_available = 0;
+    int ret = av_mediacodec_release_buffer(buffer, 1);
+    pthread_mutex_unlock(&surface->lock);
+
+    return ret < 0 ? -1 : 0;
+}
+
+int ngli_android_surface_acquire_frame(struct android_surface *surface, float *matrix, int wait)
 {
     int ret = 0;
 
@@ -344,22 +382,25 @@ int ngli_android_surface_render_buffer(struct android_surface *surface, AVMediaC
     }
 
     pthread_mutex_lock(&surface->lock);
-    surface->on_frame_available = 0;
-
-    if (av_mediacodec_release_buffer(buffer, 1) < 0) {
-        pthread_mutex_unlock(&surface->lock);
-        ret = -1;
-        goto fail;
-    }
 
+    /* Without a listener, the frame availability can not be known */
     if (surface->listener && !surface->on_frame_available) {
+        if (!wait) {
+            pthread_mutex_unlock(&surface->lock);
+            return 0;
+        }
         struct timespec ts;
         clock_gettime(CLOCK_REALTIME, &ts);
         ts.tv_nsec += 30000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
         pthread_cond_timedwait(&surface->cond, &surface->lock, &ts);
     }
 
     ret = surface->on_frame_available;
+    surface->on_frame_available = 0;
     pthread_mutex_unlock(&surface->lock);
 
     if (!ret)
@@ -380,11 +421,22 @@ int ngli_android_surface_render_buffer(struct android_surface *surface, AVMediaC
     if ((ret = ngli_jni_exception_check(env, 1)) < 0)
         goto fail;
 
+    ret = 1;
+
 fail:
 
     return ret;
 }
 
+int ngli_android_surface_render_buffer(struct android_surface *surface, AVMediaCodecBuffer *buffer, float *matrix)
+{
+    int ret = ngli_android_surface_release_buffer(surface, buffer);
+    if (ret < 0)
+        return ret;
+    ret = ngli_android_surface_acquire_frame(surface, matrix, 1);
+    return ret < 0 ? ret : 0;
+}
+
 void ngli_android_surface_signal_frame(struct android_surface *surface)
 {
     if (!surface)
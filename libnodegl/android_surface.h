@@ -30,6 +30,21 @@ void ngli_android_surface_free(struct android_surface **surface);
 void *ngli_android_surface_get_surface(struct android_surface *surface);
 int ngli_android_surface_attach_to_gl_context(struct android_surface *surface, int tex_id);
 int ngli_android_surface_detach_from_gl_context(struct android_surface *surface);
+
+/*
+ * Release the codec buffer to the surface, without waiting for the frame to
+ * reach the SurfaceTexture.
+ */
+int ngli_android_surface_release_buffer(struct android_surface *surface, AVMediaCodecBuffer *buffer);
+
+/*
+ * Latch the last frame released to the surface and get its transformation
+ * matrix. If wait is not set and the frame has not reached the
+ * SurfaceTexture yet, return 0 without latching it. Return 1 if the frame
+ * has been latched, or a negative error code.
+ */
+int ngli_android_surface_acquire_frame(struct android_surface *surface, float *matrix, int wait);
+
 int ngli_android_surface_render_buffer(struct android_surface *surface, AVMediaCodecBuffer *buffer, float *matrix);
 void ngli_android_surface_signal_frame(struct android_surface *surface);
 
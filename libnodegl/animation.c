@@ -20,54 +20,202 @@
  */
 
 #include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include "animation.h"
 #include "log.h"
+#include "math_utils.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "timeindex.h"
+#include "utils.h"
 
-static int get_kf_id(struct ngl_node * const *animkf, int nb_animkf, int start, double t)
+struct animation_easing {
+    easing_function function;
+    const double *args;     /* in easing_data */
+    int nb_args;
+    int scale_boundaries;
+    double offsets[2];
+    double boundaries[2];
+    const double *lut;      /* in easing_data */
+    int lut_size;
+};
+
+static double get_kf_time(const void *arg, int index)
 {
-    int ret = -1;
+    const double *times = arg;
+    return times[index];
+}
 
-    for (int i = start; i < nb_animkf; i++) {
-        const struct animkeyframe_priv *kf = animkf[i]->priv_data;
-        if (kf->time > t)
-            break;
-        ret = i;
-    }
-    return ret;
+static double sample_lut(const double *lut, int lut_size, double x)
+{
+    const double pos = NGLI_MIN(NGLI_MAX(x, 0.0), 1.0) * (lut_size - 1);
+    const int i = NGLI_MIN((int)pos, lut_size - 2);
+    return NGLI_MIX(lut[i], lut[i + 1], pos - i);
+}
+
+static double get_ratio(const struct animation_easing *easing, double tnorm)
+{
+    if (easing->lut)
+        return sample_lut(easing->lut, easing->lut_size, tnorm);
+    if (easing->scale_boundaries)
+        tnorm = (easing->offsets[1] - easing->offsets[0]) * tnorm + easing->offsets[0];
+    double ratio = easing->function(tnorm, easing->nb_args, easing->args);
+    if (easing->scale_boundaries)
+        ratio = (ratio - easing->boundaries[0]) / (easing->boundaries[1] - easing->boundaries[0]);
+    return ratio;
+}
+
+static void evaluate_samples(const struct animation *s, float *dst, double t)
+{
+    double pos = (t - s->samples_start) * s->samples_rate;
+
+    /* Snap to the sampling times despite the rounding of t */
+    const double nearest = round(pos);
+    if (fabs(pos - nearest) < 1e-6)
+        pos = nearest;
+
+    pos = NGLI_MIN(NGLI_MAX(pos, 0.0), s->nb_samples - 1);
+    const int i = NGLI_MIN((int)pos, s->nb_samples - 2);
+    const float *v0 = s->samples + i * s->nb_comps;
+    const float *v1 = v0 + s->nb_comps;
+    const double ratio = pos - i;
+    for (int c = 0; c < s->nb_comps; c++)
+        dst[c] = NGLI_MIX(v0[c], v1[c], ratio);
 }
 
 int ngli_animation_evaluate(struct animation *s, void *dst, double t)
 {
-    struct ngl_node * const *animkf = s->kfs;
-    const int nb_animkf = s->nb_kfs;
-    if (!nb_animkf)
+    if (s->samples) {
+        evaluate_samples(s, dst, t);
         return 0;
-    int kf_id = get_kf_id(animkf, nb_animkf, s->current_kf, t);
-    if (kf_id < 0)
-        kf_id = get_kf_id(animkf, nb_animkf, 0, t);
-    if (kf_id >= 0 && kf_id < nb_animkf - 1) {
-        const struct animkeyframe_priv *kf0 = animkf[kf_id    ]->priv_data;
-        const struct animkeyframe_priv *kf1 = animkf[kf_id + 1]->priv_data;
-        const double t0 = kf0->time;
-        const double t1 = kf1->time;
-
-        double tnorm = (t - t0) / (t1 - t0);
-        if (kf1->scale_boundaries)
-            tnorm = (kf1->offsets[1] - kf1->offsets[0]) * tnorm + kf1->offsets[0];
-        double ratio = kf1->function(tnorm, kf1->nb_args, kf1->args);
-        if (kf1->scale_boundaries)
-            ratio = (ratio - kf1->boundaries[0]) / (kf1->boundaries[1] - kf1->boundaries[0]);
+    }
 
+    const double *times = s->times;
+    const int nb_kfs = s->nb_kfs;
+    if (!nb_kfs)
+        return 0;
+    const int kf_id = ngli_timeindex_search(times, nb_kfs, s->current_kf, t, get_kf_time);
+    if (kf_id >= 0 && kf_id < nb_kfs - 1) {
+        const double t0 = times[kf_id];
+        const double t1 = times[kf_id + 1];
+        const double ratio = get_ratio(&s->easings[kf_id + 1], (t - t0) / (t1 - t0));
         s->current_kf = kf_id;
-        s->mix_func(s->user_arg, dst, kf0, kf1, ratio);
+        s->mix_func(s->user_arg, dst, &s->values[kf_id], &s->values[kf_id + 1], ratio);
     } else {
-        const struct animkeyframe_priv *kf0 = animkf[            0]->priv_data;
-        const struct animkeyframe_priv *kfn = animkf[nb_animkf - 1]->priv_data;
-        const struct animkeyframe_priv *kf  = t < kf0->time ? kf0 : kfn;
-        s->cpy_func(s->user_arg, dst, kf);
+        const int index = t < times[0] ? 0 : nb_kfs - 1;
+        s->cpy_func(s->user_arg, dst, &s->values[index]);
+    }
+    return 0;
+}
+
+static int same_values(const struct animation_value *v0, const struct animation_value *v1)
+{
+    return v0->scalar == v1->scalar && !memcmp(v0->value, v1->value, sizeof(v0->value)) &&
+           v0->data_size == v1->data_size && (!v0->data_size || !memcmp(v0->data, v1->data, v0->data_size));
+}
+
+/* The baked samples are interpolated, so a sampling interval crossing t changes */
+static double sample_floor(const struct animation *s, double t)
+{
+    return s->samples_start + floor((t - s->samples_start) * s->samples_rate) / s->samples_rate;
+}
+
+static double sample_ceil(const struct animation *s, double t)
+{
+    return s->samples_start + ceil((t - s->samples_start) * s->samples_rate) / s->samples_rate;
+}
+
+double ngli_animation_get_next_change(struct animation *s, double t)
+{
+    const double *times = s->times;
+    const int nb_kfs = s->nb_kfs;
+    if (!nb_kfs)
+        return DBL_MAX;
+
+    if (t < times[0])
+        return times[0];
+    const double end = s->samples ? s->samples_start + (s->nb_samples - 1) / s->samples_rate : times[nb_kfs - 1];
+    if (t >= end)
+        return DBL_MAX;
+
+    /* The value is held between two key frames of the same value */
+    const int kf_id = ngli_timeindex_search(times, nb_kfs, s->current_kf, t, get_kf_time);
+    if (kf_id < 0 || kf_id >= nb_kfs - 1)
+        return t;
+    if (!same_values(&s->values[kf_id], &s->values[kf_id + 1]))
+        return t;
+    const double t_start = times[kf_id];
+    const double t_end   = times[kf_id + 1];
+    if (!s->samples)
+        return t_end;
+    if (t < sample_ceil(s, t_start))
+        return t;
+    return NGLI_MAX(sample_floor(s, t_end), t);
+}
+
+int ngli_animation_evaluate_batch(struct animation *s, void *dst, int dst_stride,
+                                  const double *times, int nb_times)
+{
+    uint8_t *dstp = dst;
+    for (int i = 0; i < nb_times; i++) {
+        int ret = ngli_animation_evaluate(s, dstp, times[i]);
+        if (ret < 0)
+            return ret;
+        dstp += dst_stride;
+    }
+    return 0;
+}
+
+static int compile_kfs(struct animation *s, struct ngl_node * const *kfs, int nb_kfs)
+{
+    int easing_data_size = 0;
+    for (int i = 0; i < nb_kfs; i++) {
+        const struct animkeyframe_priv *kf = kfs[i]->priv_data;
+        easing_data_size += kf->nb_args + (kf->lut ? kf->lut_size : 0);
+    }
+
+    s->times = ngli_calloc(nb_kfs, sizeof(*s->times));
+    s->values = ngli_calloc(nb_kfs, sizeof(*s->values));
+    s->easings = ngli_calloc(nb_kfs, sizeof(*s->easings));
+    s->easing_data = ngli_calloc(NGLI_MAX(easing_data_size, 1), sizeof(*s->easing_data));
+    if (!s->times || !s->values || !s->easings || !s->easing_data)
+        return NGL_ERROR_MEMORY;
+
+    double *easing_data = s->easing_data;
+    for (int i = 0; i < nb_kfs; i++) {
+        const struct animkeyframe_priv *kf = kfs[i]->priv_data;
+
+        s->times[i] = kf->time;
+
+        struct animation_value *value = &s->values[i];
+        value->scalar = kf->scalar;
+        memcpy(value->value, kf->value, sizeof(value->value));
+        value->data = kf->data;
+        value->data_size = kf->data_size;
+
+        struct animation_easing *easing = &s->easings[i];
+        easing->function = kf->function;
+        easing->nb_args = kf->nb_args;
+        easing->scale_boundaries = kf->scale_boundaries;
+        memcpy(easing->offsets, kf->offsets, sizeof(easing->offsets));
+        memcpy(easing->boundaries, kf->boundaries, sizeof(easing->boundaries));
+        if (kf->nb_args) {
+            memcpy(easing_data, kf->args, kf->nb_args * sizeof(*easing_data));
+            easing->args = easing_data;
+            easing_data += kf->nb_args;
+        }
+        if (kf->lut) {
+            memcpy(easing_data, kf->lut, kf->lut_size * sizeof(*easing_data));
+            easing->lut = easing_data;
+            easing->lut_size = kf->lut_size;
+            easing_data += kf->lut_size;
+        }
     }
+
+    s->nb_kfs = nb_kfs;
     return 0;
 }
 
@@ -94,8 +242,65 @@ int ngli_animation_init(struct animation *s, void *user_arg,
         prev_time = kf->time;
     }
 
-    s->kfs = kfs;
-    s->nb_kfs = nb_kfs;
+    if (!nb_kfs)
+        return 0;
+
+    int ret = compile_kfs(s, kfs, nb_kfs);
+    if (ret < 0)
+        ngli_animation_reset(s);
+    return ret;
+}
+
+#define MAX_SAMPLES (1 << 20)
+
+int ngli_animation_bake(struct animation *s, int nb_comps, double rate)
+{
+    ngli_assert(!s->samples && rate > 0.);
+    if (s->nb_kfs < 2)
+        return 0;
+
+    const double start = s->times[0];
+    const double end = s->times[s->nb_kfs - 1];
+    const double nb_intervals = ceil((end - start) * rate);
+    if (nb_intervals < 1. || nb_intervals >= MAX_SAMPLES) {
+        LOG(DEBUG, "not baking an animation spanning %g samples", nb_intervals + 1);
+        return 0;
+    }
+
+    const int nb_samples = nb_intervals + 1;
+    float *samples = ngli_calloc(nb_samples, nb_comps * sizeof(*samples));
+    if (!samples)
+        return NGL_ERROR_MEMORY;
 
+    for (int i = 0; i < nb_samples; i++) {
+        int ret = ngli_animation_evaluate(s, samples + i * nb_comps, start + i / rate);
+        if (ret < 0) {
+            ngli_free(samples);
+            return ret;
+        }
+    }
+
+    s->samples = samples;
+    s->nb_samples = nb_samples;
+    s->nb_comps = nb_comps;
+    s->samples_start = start;
+    s->samples_rate = rate;
     return 0;
 }
+
+void ngli_animation_reset(struct animation *s)
+{
+    ngli_free(s->times);
+    ngli_free(s->values);
+    ngli_free(s->easings);
+    ngli_free(s->easing_data);
+    s->times = NULL;
+    s->values = NULL;
+    s->easings = NULL;
+    s->easing_data = NULL;
+    s->nb_kfs = 0;
+    s->current_kf = 0;
+    ngli_free(s->samples);
+    s->samples = NULL;
+    s->nb_samples = 0;
+}
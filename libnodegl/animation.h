@@ -22,27 +22,55 @@
 #ifndef ANIMATION_H
 #define ANIMATION_H
 
+#include <stdint.h>
+
 #include "nodegl.h"
 
-struct animkeyframe_priv;
+/* Value of a key frame, copied from its node by ngli_animation_init() */
+struct animation_value {
+    double scalar;
+    float value[4];
+    const uint8_t *data;    /* owned by the key frame node */
+    int data_size;
+};
+
+struct animation_easing;
 
 typedef void (*ngli_animation_mix_func_type)(void *user_arg, void *dst,
-                                             const struct animkeyframe_priv *kf0,
-                                             const struct animkeyframe_priv *kf1,
+                                             const struct animation_value *v0,
+                                             const struct animation_value *v1,
                                              double ratio);
 
 typedef void (*ngli_animation_cpy_func_type)(void *user_arg, void *dst,
-                                             const struct animkeyframe_priv *kf);
+                                             const struct animation_value *v);
 
+/*
+ * The key frames are compiled into contiguous arrays, so that the evaluation
+ * never has to go through the key frame nodes
+ */
 struct animation {
-    struct ngl_node * const *kfs;
     int nb_kfs;
+    double *times;
+    struct animation_value *values;
+    struct animation_easing *easings;
+    double *easing_data;    /* arguments and look-up tables of the easings */
     int current_kf;
     void *user_arg;
     ngli_animation_mix_func_type mix_func;
     ngli_animation_cpy_func_type cpy_func;
+
+    /* baked samples, see ngli_animation_bake() */
+    float *samples;
+    int nb_samples;
+    int nb_comps;
+    double samples_start;
+    double samples_rate;
 };
 
+/*
+ * The key frames must be initialized, their later changes are not seen by
+ * the animation until it is reset and initialized again.
+ */
 int ngli_animation_init(struct animation *s, void *user_arg,
                         struct ngl_node * const *kfs, int nb_kfs,
                         ngli_animation_mix_func_type mix_func,
@@ -50,4 +78,31 @@ int ngli_animation_init(struct animation *s, void *user_arg,
 
 int ngli_animation_evaluate(struct animation *s, void *dst, double t);
 
+/*
+ * Evaluate the animation at each of the nb_times times, writing the
+ * results dst_stride bytes apart. The key frame cursor is shared between
+ * the evaluations, so monotonic times are the cheapest to sample.
+ */
+int ngli_animation_evaluate_batch(struct animation *s, void *dst, int dst_stride,
+                                  const double *times, int nb_times);
+
+/*
+ * Return the earliest time after t at which the value of the animation may
+ * change: the first key frame before it, the end of a hold between two key
+ * frames of the same value, DBL_MAX after the last key frame, and t itself
+ * while interpolating.
+ */
+double ngli_animation_get_next_change(struct animation *s, double t);
+
+/*
+ * Sample the animation, whose values are made of nb_comps floats, rate times
+ * per second from its first to its last key frame. The next evaluations
+ * only linearly interpolate between the two nearest samples, which is exact
+ * at the sampling times. The baking is skipped if the key frames span too
+ * many samples.
+ */
+int ngli_animation_bake(struct animation *s, int nb_comps, double rate);
+
+void ngli_animation_reset(struct animation *s);
+
 #endif
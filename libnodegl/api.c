@@ -19,9 +19,11 @@
  * under the License.
  */
 
+#include <float.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 
 #if defined(TARGET_ANDROID)
 #include <jni.h>
@@ -30,18 +32,82 @@
 #endif
 
 #include "backend.h"
+#include "captureconv.h"
 #include "darray.h"
+#include "framecache.h"
+#include "gctx.h"
 #include "log.h"
 #include "math_utils.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "pass.h"
+#include "patch.h"
+#include "readback.h"
+#include "tracemarker.h"
+#include "transforms.h"
+#include "utils.h"
+
+static int configure_jobpool(struct ngl_ctx *s, const struct ngl_config *config)
+{
+    const int nb_threads = config->nb_update_threads;
+    if (nb_threads <= 1) {
+        ngli_jobpool_freep(&s->jobpool);
+        return 0;
+    }
+
+    /* The current configuration is the one the pool was created with */
+    if (s->jobpool && ngli_jobpool_get_nb_threads(s->jobpool) == nb_threads &&
+        s->config.thread_priority == config->thread_priority &&
+        s->config.thread_affinity == config->thread_affinity)
+        return 0;
+
+    ngli_jobpool_freep(&s->jobpool);
+    s->jobpool = ngli_jobpool_create(nb_threads, config->thread_priority, config->thread_affinity);
+    if (!s->jobpool) {
+        LOG(ERROR, "unable to create the pool of %d update threads", nb_threads);
+        return NGL_ERROR_MEMORY;
+    }
+    return 0;
+}
+
+#define DEFAULT_FRAME_CACHE_SIZE 1024
+
+static int configure_frame_cache(struct ngl_ctx *s, const struct ngl_config *config)
+{
+    ngli_framecache_reset(&s->frame_cache);
+    s->frame_cache_enabled = 0;
+    s->scene_hash_valid = 0;
+
+    if (!config->frame_cache_dir)
+        return 0;
+
+    if (!config->capture_buffer || config->pipelined_updates || config->nb_outputs) {
+        LOG(WARNING, "the frame cache is only used with capture_buffer, "
+            "without pipelined_updates nor additional outputs");
+        return 0;
+    }
+
+    const int cache_size = config->frame_cache_size ? config->frame_cache_size : DEFAULT_FRAME_CACHE_SIZE;
+    int ret = ngli_framecache_init(&s->frame_cache, config->frame_cache_dir, cache_size * (1LL << 20),
+                                   s->frame_arena);
+    if (ret < 0) {
+        ngli_framecache_reset(&s->frame_cache);
+        return ret;
+    }
+    s->frame_cache_enabled = 1;
+    return 0;
+}
 
 static int cmd_reconfigure(struct ngl_ctx *s, void *arg)
 {
     struct ngl_config *config = arg;
     struct ngl_config *current_config = &s->config;
 
+    ngli_framepacer_init(&s->framepacer);
+    s->frame_changed = 1;
+    ngli_damage_invalidate(&s->damage);
+
     if (config->platform == NGL_PLATFORM_AUTO)
         config->platform = current_config->platform;
     if (config->backend == NGL_BACKEND_AUTO)
@@ -53,45 +119,165 @@ static int cmd_reconfigure(struct ngl_ctx *s, void *arg)
         return NGL_ERROR_UNSUPPORTED;
     }
 
-    if (current_config->display   != config->display   ||
-        current_config->window    != config->window    ||
-        current_config->handle    != config->handle    ||
-        current_config->offscreen != config->offscreen ||
-        current_config->samples   != config->samples) {
-        if (s->scene)
-            ngli_node_detach_ctx(s->scene, s);
-        s->backend->destroy(s);
-        int ret = s->backend->configure(s, config);
-        if (ret < 0)
-            return ret;
-        if (s->scene)
-            ret = ngli_node_attach_ctx(s->scene, s);
-        if (ret < 0)
+    int ret = configure_jobpool(s, config);
+    if (ret < 0)
+        return ret;
+
+    ret = configure_frame_cache(s, config);
+    if (ret < 0)
+        return ret;
+
+    /*
+     * The scene resources are kept unless the graphic context itself needs
+     * to be recreated: the backend is first given a chance to switch to
+     * the new window in place, and the samples of an offscreen rendering
+     * only affect its render target.
+     */
+    const int recreate = current_config->display   != config->display   ||
+                         current_config->handle    != config->handle    ||
+                         current_config->offscreen != config->offscreen ||
+                         current_config->device    != config->device    ||
+                         (!config->offscreen && current_config->samples != config->samples);
+    if (!recreate) {
+        ret = s->backend->reconfigure(s, config);
+        if (ret != NGL_ERROR_UNSUPPORTED) {
+            if (ret < 0)
+                LOG(ERROR, "unable to reconfigure %s", s->backend->name);
             return ret;
-        return 0;
+        }
     }
 
-    int ret = s->backend->reconfigure(s, config);
+    /* The resources of the scene are created again with the new context */
+    s->activity_gen++;
+    if (s->scene)
+        ngli_node_detach_ctx(s->scene, s);
+    if (s->prepared_scene)
+        ngli_node_detach_ctx(s->prepared_scene, s);
+    s->backend->destroy(s);
+    ret = s->backend->configure(s, config);
     if (ret < 0)
-        LOG(ERROR, "unable to reconfigure %s", s->backend->name);
-    return ret;
+        return ret;
+    if (s->scene)
+        ret = ngli_node_attach_ctx(s->scene, s);
+    if (ret < 0)
+        return ret;
+    /* The nodes have been initialized again */
+    ret = ngli_schedule_init(&s->schedule, s->scene);
+    if (ret < 0)
+        return ret;
+    if (s->prepared_scene)
+        ret = ngli_node_attach_ctx(s->prepared_scene, s);
+    if (ret < 0)
+        return ret;
+    return 0;
 }
 
 static int cmd_configure(struct ngl_ctx *s, void *arg)
 {
-    int ret = s->backend->configure(s, arg);
+    ngli_framepacer_init(&s->framepacer);
+    s->frame_changed = 1;
+    ngli_damage_invalidate(&s->damage);
+
+    const struct ngl_config *config = arg;
+    int ret = configure_jobpool(s, config);
+    if (ret < 0)
+        return ret;
+
+    ret = configure_frame_cache(s, config);
+    if (ret < 0)
+        return ret;
+
+    ret = s->backend->configure(s, arg);
     if (ret < 0)
         LOG(ERROR, "unable to configure %s", s->backend->name);
     return ret;
 }
 
+/*
+ * Dispatched separately since the configuration itself runs on the calling
+ * thread on Darwin.
+ */
+static int cmd_set_thread_priority(struct ngl_ctx *s, void *arg)
+{
+    const struct ngl_config *config = arg;
+    if (s->thread_priority == config->thread_priority &&
+        s->thread_affinity == config->thread_affinity)
+        return 0;
+
+    ngli_thread_set_priority(config->thread_priority, config->thread_affinity);
+    s->thread_priority = config->thread_priority;
+    s->thread_affinity = config->thread_affinity;
+    return 0;
+}
+
 static int cmd_set_scene(struct ngl_ctx *s, void *arg)
 {
+    s->activity_gen++;
+    s->frame_changed = 1;
+    s->scene_hash_valid = 0;
+
+    struct ngl_node *scene = arg;
+
+    /*
+     * A prepared scene is already initialized: it is swapped in before the
+     * previous scene is detached so the nodes they have in common are kept
+     * alive instead of being released and initialized again.
+     */
+    if (scene && scene == s->prepared_scene) {
+        struct ngl_node *prev_scene = s->scene;
+        s->scene = s->prepared_scene;
+        s->prepared_scene = NULL;
+        if (prev_scene) {
+            ngli_node_detach_ctx(prev_scene, s);
+            ngl_node_unrefp(&prev_scene);
+        }
+        return ngli_schedule_init(&s->schedule, s->scene);
+    }
+
+    ngli_schedule_reset(&s->schedule);
     if (s->scene) {
         ngli_node_detach_ctx(s->scene, s);
         ngl_node_unrefp(&s->scene);
     }
 
+    if (!scene)
+        return 0;
+
+    int ret = ngli_node_attach_ctx(scene, s);
+    if (ret < 0 || (ret = ngli_schedule_init(&s->schedule, scene)) < 0) {
+        ngli_node_detach_ctx(scene, s);
+        return ret;
+    }
+
+    s->scene = ngl_node_ref(scene);
+    return 0;
+}
+
+static int cmd_update_scene(struct ngl_ctx *s, void *arg)
+{
+    struct ngl_node *scene = arg;
+
+    if (s->scene && scene && s->scene != scene) {
+        int ret = ngli_patch_scene(s->scene, scene);
+        if (ret < 0)
+            return ret;
+        if (ret) {
+            LOG(DEBUG, "scene %s updated in place", s->scene->label);
+            s->scene_hash_valid = 0;
+            return 0;
+        }
+    }
+
+    return cmd_set_scene(s, scene);
+}
+
+static int cmd_prepare_scene(struct ngl_ctx *s, void *arg)
+{
+    if (s->prepared_scene) {
+        ngli_node_detach_ctx(s->prepared_scene, s);
+        ngl_node_unrefp(&s->prepared_scene);
+    }
+
     struct ngl_node *scene = arg;
     if (!scene)
         return 0;
@@ -102,13 +288,110 @@ static int cmd_set_scene(struct ngl_ctx *s, void *arg)
         return ret;
     }
 
-    s->scene = ngl_node_ref(scene);
+    s->prepared_scene = ngl_node_ref(scene);
     return 0;
 }
 
-static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
+static void release_param_update(struct ngl_param_update *update)
 {
-    const double t = *(double *)arg;
+    const struct node_param *par = &update->node->class->params[update->handle];
+    if (par->type == PARAM_TYPE_STR)
+        ngli_free((char *)update->value.str);
+    ngl_node_unrefp(&update->node);
+}
+
+static void release_param_updates(struct darray *updates)
+{
+    struct ngl_param_update *entries = ngli_darray_data(updates);
+    for (int i = 0; i < ngli_darray_count(updates); i++)
+        release_param_update(&entries[i]);
+    updates->count = 0;
+}
+
+static int apply_param_updates(struct ngl_ctx *s)
+{
+    pthread_mutex_lock(&s->param_updates_lock);
+    const struct darray updates = s->param_updates;
+    s->param_updates = s->applied_param_updates;
+    s->applied_param_updates = updates;
+    pthread_mutex_unlock(&s->param_updates_lock);
+
+    int ret = 0;
+    const struct ngl_param_update *entries = ngli_darray_data(&s->applied_param_updates);
+    for (int i = 0; i < ngli_darray_count(&s->applied_param_updates); i++) {
+        int update_ret = ngli_node_param_update(entries[i].node, &entries[i]);
+        if (update_ret < 0 && !ret)
+            ret = update_ret;
+    }
+    release_param_updates(&s->applied_param_updates);
+    return ret;
+}
+
+/*
+ * The nodes warmed up by ngl_warmup() are kept ready while the drawn times
+ * remain in the warmed up range and the memory budget is respected; once
+ * out of it, the visit releases the ones inactive since then
+ */
+static void update_warmup_hold(struct ngl_ctx *s, double t)
+{
+    if (s->warmup_range[0] >= s->warmup_range[1])
+        return;
+
+    if (t >= s->warmup_range[0] && t < s->warmup_range[1] && !ngli_node_exceeds_memory_budget(s)) {
+        s->warmup_hold = 1;
+        return;
+    }
+
+    s->warmup_range[0] = s->warmup_range[1] = 0.;
+    s->warmup_hold = 0;
+    s->visit_release_held = 1;
+}
+
+int ngli_visit_scene(struct ngl_ctx *s, double t)
+{
+    s->activitycheck_nodes.count = 0;
+    s->visit_skipped_nodes.count = 0;
+    s->visit_has_release = 0;
+    s->nb_scheduled_prefetches = 0;
+    s->scheduled_prefetch_cost = 0;
+    s->upload_budget = s->config.prefetch_upload_budget * 1024LL;
+    ngli_node_evict_idle(s);
+
+    /* The held subtrees are only reached by a full visit */
+    s->visit_noskip = s->visit_release_held;
+
+    NGLI_TRACEMARKER_BEGIN(visit, "ngl visit");
+    int ret = ngli_node_visit(s->scene, 1, t);
+    if (ret >= 0 && s->visit_has_release)
+        ret = ngli_node_revisit_skipped(s, t);
+    NGLI_TRACEMARKER_END(visit);
+
+    s->visit_noskip = 0;
+    if (ret >= 0)
+        s->visit_release_held = 0;
+    return ret;
+}
+
+static int prefetch_scene(struct ngl_ctx *s)
+{
+    NGLI_TRACEMARKER_BEGIN(prefetch, "ngl prefetch");
+    int ret = ngli_node_honor_release_prefetch(&s->activitycheck_nodes);
+    if (ret >= 0)
+        ret = ngli_node_run_deferred_uploads(s);
+    NGLI_TRACEMARKER_END(prefetch);
+    if (ret < 0) {
+        /* The states of the graph are unknown, invalidate the activity bounds */
+        s->activity_gen++;
+        s->frame_changed = 1;
+    }
+    return ret;
+}
+
+static int prepare_draw(struct ngl_ctx *s, double t)
+{
+    int ret = apply_param_updates(s);
+    if (ret < 0)
+        return ret;
 
     struct ngl_node *scene = s->scene;
     if (!scene) {
@@ -117,68 +400,562 @@ static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
 
     LOG(DEBUG, "prepare scene %s @ t=%f", scene->label, t);
 
-    s->activitycheck_nodes.count = 0;
-    int ret = ngli_node_visit(scene, 1, t);
+    update_warmup_hold(s, t);
+
+    struct ngl_stats *stats = &s->stats;
+    int64_t start = ngli_gettime();
+    ret = ngli_visit_scene(s, t);
     if (ret < 0)
         return ret;
 
-    ret = ngli_node_honor_release_prefetch(&s->activitycheck_nodes);
+    int64_t end = ngli_gettime();
+    stats->visit_time = end - start;
+    start = end;
+
+    ret = prefetch_scene(s);
     if (ret < 0)
         return ret;
 
-    ret = ngli_node_update(scene, t);
+    NGLI_TRACEMARKER_BEGIN(release, "ngl release");
+    ngli_node_release_deferred(s);
+    NGLI_TRACEMARKER_END(release);
+
+    end = ngli_gettime();
+    stats->prefetch_time = end - start;
+    start = end;
+
+    /* The changes made outside of the updates can not be located on screen */
+    if (s->frame_changed)
+        ngli_damage_set_full(&s->damage);
+    s->update_gen++;
+    s->next_change_time = DBL_MAX;
+
+    NGLI_TRACEMARKER_BEGIN(update, "ngl update");
+    ret = ngli_node_update_cpu(s, t);
+    if (ret >= 0)
+        ret = ngli_node_update(scene, t);
+    NGLI_TRACEMARKER_END(update);
     if (ret < 0)
         return ret;
 
+    /* The data left to upload lands in the next frames */
+    if (ngli_darray_count(&s->deferred_uploads))
+        s->next_change_time = t;
+
+    stats->update_time = ngli_gettime() - start;
+
     return 0;
 }
 
-static int cmd_draw(struct ngl_ctx *s, void *arg)
+static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
 {
-    const double t = *(double *)arg;
+    NGLI_TRACEMARKER_BEGIN(prepare, "ngl prepare_draw");
+    const int ret = prepare_draw(s, *(double *)arg);
+    NGLI_TRACEMARKER_END(prepare);
+    return ret;
+}
 
-    int ret = s->backend->pre_draw(s, t);
-    if (ret < 0)
-        goto end;
+/*
+ * Run the draws of the scene without drawing anything, to locate the areas
+ * they damage. The partial redraw is only usable when the main render target
+ * is the only one drawn and starts cleared.
+ */
+static void collect_damage(struct ngl_ctx *s)
+{
+    const struct ngl_config *config = &s->config;
+    struct damage *damage = &s->damage;
+
+    if (s->nb_outputs || config->color_load_op != NGLI_LOAD_OP_CLEAR)
+        ngli_damage_set_full(damage);
+
+    if (s->scene) {
+        s->damage_pass = 1;
+        ngli_node_draw(s->scene);
+        s->damage_pass = 0;
+    }
 
-    ret = cmd_prepare_draw(s, arg);
+    int viewport[4];
+    ngli_gctx_get_viewport(s, viewport);
+    ngli_damage_end_frame(damage, viewport);
+}
+
+static void reset_frame_stats(struct ngl_stats *stats)
+{
+    stats->nb_draws = 0;
+    stats->nb_dispatches = 0;
+    stats->nb_texture_binds = 0;
+    stats->uploaded_bytes = 0;
+    stats->visit_time = 0;
+    stats->prefetch_time = 0;
+    stats->update_time = 0;
+    stats->draw_time = 0;
+    stats->capture_time = 0;
+    stats->swap_time = 0;
+    stats->frame_reused = 0;
+    stats->frame_cached = 0;
+    memset(stats->redraw_region, 0, sizeof(stats->redraw_region));
+}
+
+static int draw_frame(struct ngl_ctx *s, double t)
+{
+    const int64_t start = ngli_gettime();
+
+    /* The requested time is drawn by the next call, once its updates ran */
+    const int pipelined = s->config.pipelined_updates && s->jobpool;
+    const double next_t = t;
+    if (pipelined && s->has_pipelined_t)
+        t = s->pipelined_t;
+    s->pipelined_t = next_t;
+    s->has_pipelined_t = pipelined;
+
+    struct ngl_stats *stats = &s->stats;
+
+    /*
+     * In idle frames mode, the updates run first so the redraw can be skipped
+     * entirely when nothing changed since the last frame; in damage tracking
+     * mode, so the damage of the frame is known before it is drawn
+     */
+    int ret;
+    const int skip_idle = s->config.skip_idle_frames;
+    const int damage_tracking = s->config.damage_tracking;
+    const int update_first = skip_idle || damage_tracking;
+    if (update_first) {
+        ret = cmd_prepare_draw(s, &t);
+        if (ret < 0)
+            return ret;
+        if (skip_idle && !s->frame_changed && s->scene) {
+            LOG(DEBUG, "scene %s unchanged @ t=%f, reuse the last frame", s->scene->label, t);
+            if (pipelined) {
+                ret = ngli_node_start_cpu_update(s, next_t);
+                if (ret < 0)
+                    return ret;
+            }
+            stats->frame_reused = 1;
+            stats->cpu_time = ngli_gettime() - start;
+            s->last_stats = *stats;
+            return 0;
+        }
+        if (damage_tracking)
+            collect_damage(s);
+    }
+
+    ret = s->backend->pre_draw(s, t);
     if (ret < 0)
         goto end;
 
+    if (!update_first) {
+        ret = cmd_prepare_draw(s, &t);
+        if (ret < 0)
+            goto end;
+    }
+
     if (s->scene) {
         LOG(DEBUG, "draw scene %s @ t=%f", s->scene->label, t);
+        const int64_t draw_start = ngli_gettime();
+        NGLI_TRACEMARKER_BEGIN(draw, "ngl draw");
         ngli_node_draw(s->scene);
+        ret = s->backend->draw_outputs(s);
+        NGLI_TRACEMARKER_END(draw);
+        stats->draw_time = ngli_gettime() - draw_start;
     }
 
+    if (ret >= 0 && pipelined)
+        ret = ngli_node_start_cpu_update(s, next_t);
+
+    if (ret >= 0)
+        s->frame_changed = 0;
+
 end:;
     int end_ret = s->backend->post_draw(s, t);
     if (end_ret < 0)
         return end_ret;
 
+    /* Without a swap interval the presentation is not paced by the display */
+    const struct ngl_config *config = &s->config;
+    if (!config->offscreen && config->swap_interval)
+        ngli_framepacer_add(&s->framepacer, start, ngli_gettime());
+    stats->display_period = s->framepacer.period;
+    stats->nb_late_frames = s->framepacer.nb_late_frames;
+    stats->nb_dropped_frames = s->framepacer.nb_dropped_frames;
+
+    if (s->profiler.active) {
+        s->profiler.nb_frames++;
+        ngli_profiler_collect(&s->profiler, 0);
+    }
+
+    stats->cpu_time = ngli_gettime() - start;
+    s->last_stats = *stats;
+
+    return ret;
+}
+
+static int get_scene_hash(struct ngl_ctx *s, uint64_t *hash)
+{
+    if (!s->scene_hash_valid) {
+        size_t size;
+        uint8_t *data = ngl_node_serialize_binary(s->scene, &size);
+        if (!data)
+            return NGL_ERROR_MEMORY;
+
+        s->scene_hash = ngli_fnv1a64(data, size);
+        ngli_free(data);
+
+        s->scene_hash_valid = 1;
+    }
+    *hash = s->scene_hash;
+    return 0;
+}
+
+/*
+ * Deliver the frame from the cache if it has already been rendered (and
+ * return 1), otherwise return the key and size to store it with once
+ * rendered
+ */
+static int frame_cache_lookup(struct ngl_ctx *s, double t, char **keyp, int *sizep)
+{
+    const struct ngl_config *config = &s->config;
+
+    /* The live changes are part of the scene identity */
+    int ret = apply_param_updates(s);
+    if (ret < 0)
+        return ret;
+
+    uint64_t scene_hash;
+    ret = get_scene_hash(s, &scene_hash);
+    if (ret < 0)
+        return ret;
+
+    const int width  = config->capture_width  ? config->capture_width  : config->width;
+    const int height = config->capture_height ? config->capture_height : config->height;
+    char *key = ngli_framecache_get_key(s->frame_arena, scene_hash, t, width, height, config->capture_format);
+    if (!key)
+        return NGL_ERROR_MEMORY;
+
+    const int size = ngli_captureconv_get_buffer_size(config->capture_format, width, height);
+    if (ngli_framecache_load(&s->frame_cache, key, config->capture_buffer, size))
+        return 1;
+
+    *keyp = key;
+    *sizep = size;
+    return 0;
+}
+
+static int cmd_draw(struct ngl_ctx *s, void *arg)
+{
+    const double t = *(double *)arg;
+    struct ngl_stats *stats = &s->stats;
+    reset_frame_stats(stats);
+    ngli_arena_reset(s->frame_arena);
+
+    if (!s->frame_cache_enabled || !s->scene)
+        return draw_frame(s, t);
+
+    const int64_t start = ngli_gettime();
+    char *key = NULL;
+    int size = 0;
+    int ret = frame_cache_lookup(s, t, &key, &size);
+    if (ret < 0)
+        return ret;
+    if (ret) {
+        LOG(DEBUG, "scene %s @ t=%f delivered from the frame cache", s->scene->label, t);
+        /* The rendered frame does not match the delivered one anymore */
+        s->frame_changed = 1;
+        stats->frame_cached = 1;
+        stats->cpu_time = ngli_gettime() - start;
+        s->last_stats = *stats;
+        return 0;
+    }
+
+    ret = draw_frame(s, t);
+    if (ret >= 0)
+        ret = ngli_framecache_store(&s->frame_cache, key, s->config.capture_buffer, size);
+    return ret;
+}
+
+struct draw_batch {
+    const double *times;
+    int nb_times;
+    uint8_t *atlas;
+    int nb_columns;
+};
+
+struct batch_entry {
+    double t;
+    int index;
+};
+
+static int cmp_batch_entry(const void *a, const void *b)
+{
+    const struct batch_entry *ea = a;
+    const struct batch_entry *eb = b;
+    if (ea->t != eb->t)
+        return ea->t < eb->t ? -1 : 1;
+    return ea->index - eb->index;
+}
+
+static int cmd_draw_batch(struct ngl_ctx *s, void *arg)
+{
+    const struct draw_batch *batch = arg;
+    const struct ngl_config *config = &s->config;
+    const int nb_rows = (batch->nb_times + batch->nb_columns - 1) / batch->nb_columns;
+
+    /* The times are drawn in order so the activity of the nodes evolves
+     * progressively, but each frame lands in the tile of its index */
+    ngli_arena_reset(s->frame_arena);
+    struct batch_entry *entries = ngli_arena_alloc(s->frame_arena, batch->nb_times * sizeof(*entries));
+    if (!entries)
+        return NGL_ERROR_MEMORY;
+    for (int i = 0; i < batch->nb_times; i++) {
+        entries[i].t = batch->times[i];
+        entries[i].index = i;
+    }
+    qsort(entries, batch->nb_times, sizeof(*entries), cmp_batch_entry);
+
+    int ret = s->backend->begin_batch(s, config->width * batch->nb_columns,
+                                      config->height * nb_rows, batch->atlas);
+    if (ret < 0)
+        return ret;
+
+    /* Keep the resources of the nodes inactive at some of the times */
+    s->hold_resources = 1;
+    for (int i = 0; i < batch->nb_times && s->scene; i++) {
+        const int col = entries[i].index % batch->nb_columns;
+        const int row = entries[i].index / batch->nb_columns;
+
+        ret = cmd_prepare_draw(s, &entries[i].t);
+        if (ret < 0)
+            break;
+
+        /* The atlas is flipped on read back, so the first row is on top */
+        const int viewport[4] = {
+            col * config->width,
+            (nb_rows - 1 - row) * config->height,
+            config->width,
+            config->height,
+        };
+        ngli_gctx_set_viewport(s, viewport);
+        ngli_node_draw(s->scene);
+    }
+    s->hold_resources = 0;
+
+    /* Release the resources held during the batch on the next draw */
+    s->activity_gen++;
+    s->visit_release_held = 1;
+    /* The batch rendering did not go to the regular output */
+    s->frame_changed = 1;
+
+    const int end_ret = s->backend->end_batch(s);
+    return ret < 0 ? ret : end_ret;
+}
+
+struct warmup {
+    double start;
+    double duration;
+    ngl_warmup_callback_type progress_cb;
+    void *user_arg;
+};
+
+/*
+ * Visit the scene at each time its activity changes within the range
+ * (following the activity bounds of the root), prefetching every node
+ * becoming active, then run the updates at the start of the range
+ */
+static int cmd_warmup(struct ngl_ctx *s, void *arg)
+{
+    const struct warmup *warmup = arg;
+    struct ngl_node *scene = s->scene;
+
+    int ret = apply_param_updates(s);
+    if (ret < 0 || !scene)
+        return ret;
+
+    const double start = warmup->start;
+    double end = start + warmup->duration;
+    s->warmup_hold = 1;
+
+    double t = start;
+    for (;;) {
+        ret = ngli_visit_scene(s, t);
+        if (ret < 0)
+            break;
+        /* Complete the uploads without waiting for the following frames */
+        s->upload_budget = INT64_MAX;
+        ret = prefetch_scene(s);
+        if (ret < 0)
+            break;
+
+        if (ngli_node_exceeds_memory_budget(s)) {
+            LOG(WARNING, "GPU memory budget reached, scene %s only warmed up until t=%f", scene->label, t);
+            end = t;
+            break;
+        }
+
+        const double next_t = scene->activity_bounds[1];
+        if (next_t <= t || next_t >= end)
+            break;
+        if (warmup->progress_cb)
+            warmup->progress_cb(warmup->user_arg, (t - start) / warmup->duration);
+        t = next_t;
+    }
+
+    if (ret < 0) {
+        s->warmup_hold = 0;
+        s->visit_release_held = 1;
+        return ret;
+    }
+
+    /* The hold starts with the first draw in the range */
+    s->warmup_hold = 0;
+    if (end > start) {
+        s->warmup_range[0] = start;
+        s->warmup_range[1] = end;
+    } else {
+        s->visit_release_held = 1;
+    }
+
+    /* The first frames are decoded and uploaded ahead as well */
+    ret = prepare_draw(s, start);
+    if (ret >= 0 && warmup->progress_cb)
+        warmup->progress_cb(warmup->user_arg, 1.0);
+
+    s->frame_changed = 1;
     return ret;
 }
 
+NGLI_STATIC_ASSERT(cpu_memory_nb,      (int)NGLI_MEMTAG_NB      == (int)NGL_STATS_CPU_MEMORY_NB);
+NGLI_STATIC_ASSERT(cpu_memory_nodes,   (int)NGLI_MEMTAG_NODES   == (int)NGL_STATS_CPU_MEMORY_NODES);
+NGLI_STATIC_ASSERT(cpu_memory_buffers, (int)NGLI_MEMTAG_BUFFERS == (int)NGL_STATS_CPU_MEMORY_BUFFERS);
+NGLI_STATIC_ASSERT(cpu_memory_drawing, (int)NGLI_MEMTAG_DRAWING == (int)NGL_STATS_CPU_MEMORY_DRAWING);
+
+static int cmd_get_stats(struct ngl_ctx *s, void *arg)
+{
+    struct ngl_stats *stats = arg;
+    *stats = s->last_stats;
+    memcpy(stats->memory, s->stats.memory, sizeof(stats->memory));
+    stats->memory[NGL_STATS_MEMORY_TEXTURE_POOL] = s->texture_pool.size;
+    memcpy(stats->nb_rtt_formats, s->stats.nb_rtt_formats, sizeof(stats->nb_rtt_formats));
+    stats->nb_rtt_dropped_depths = s->stats.nb_rtt_dropped_depths;
+    stats->rtt_saved_memory = s->stats.rtt_saved_memory;
+    ngli_memory_get_usage(stats->cpu_memory, stats->cpu_memory_peak);
+    return 0;
+}
+
+static int cmd_predict_display_delay(struct ngl_ctx *s, void *arg)
+{
+    const int64_t now = ngli_gettime();
+    *(int64_t *)arg = ngli_framepacer_predict(&s->framepacer, now) - now;
+    return 0;
+}
+
+static int cmd_profile_start(struct ngl_ctx *s, void *arg)
+{
+    return ngli_profiler_start(&s->profiler, s->glcontext);
+}
+
+static int cmd_profile_stop(struct ngl_ctx *s, void *arg)
+{
+    return ngli_profiler_stop(&s->profiler, arg);
+}
+
+struct dot_cost_params {
+    int metric;
+    char *graph;
+};
+
+static int cmd_dot_cost(struct ngl_ctx *s, void *arg)
+{
+    struct dot_cost_params *params = arg;
+    params->graph = ngli_dot_cost(s, params->metric);
+    return params->graph ? 0 : NGL_ERROR_GENERIC;
+}
+
+static int cmd_get_next_change_time(struct ngl_ctx *s, void *arg)
+{
+    /* The live changes are only applied by the next draw */
+    pthread_mutex_lock(&s->param_updates_lock);
+    const int pending_updates = ngli_darray_count(&s->param_updates);
+    pthread_mutex_unlock(&s->param_updates_lock);
+
+    *(double *)arg = s->frame_changed || pending_updates ? -DBL_MAX
+                   : s->scene                            ? s->next_change_time
+                   : DBL_MAX;
+    return 0;
+}
+
+struct analyze_params {
+    const double *times;
+    int nb_times;
+    struct ngl_analysis *analysis;
+};
+
+static int cmd_analyze(struct ngl_ctx *s, void *arg)
+{
+    const struct analyze_params *params = arg;
+    int ret = apply_param_updates(s);
+    if (ret < 0)
+        return ret;
+    return ngli_analyze(s, params->times, params->nb_times, params->analysis);
+}
+
+static int cmd_flush(struct ngl_ctx *s, void *arg)
+{
+    return s->backend->flush(s);
+}
+
 static int cmd_stop(struct ngl_ctx *s, void *arg)
 {
     if (s->backend)
         s->backend->destroy(s);
+    ngli_framecache_reset(&s->frame_cache);
 
     return 0;
 }
 
-static int dispatch_cmd(struct ngl_ctx *s, cmd_func_type cmd_func, void *arg)
+/* Must be called with the lock held */
+static void queue_cmd(struct ngl_ctx *s, const struct api_cmd *cmd)
 {
-    pthread_mutex_lock(&s->lock);
-    s->cmd_func = cmd_func;
-    s->cmd_arg = arg;
+    while (s->cmd_queue_count == NGLI_CMD_QUEUE_SIZE)
+        pthread_cond_wait(&s->cond_ctl, &s->lock);
+
+    const int index = (s->cmd_queue_head + s->cmd_queue_count) % NGLI_CMD_QUEUE_SIZE;
+    struct api_cmd *queued_cmd = &s->cmd_queue[index];
+    *queued_cmd = *cmd;
+    if (queued_cmd->async)
+        queued_cmd->arg = &queued_cmd->t;
+    s->cmd_queue_count++;
     pthread_cond_signal(&s->cond_wkr);
-    while (s->cmd_func)
+}
+
+/* Must be called with the lock held */
+static void wait_cmd_queue(struct ngl_ctx *s)
+{
+    while (s->cmd_queue_count)
         pthread_cond_wait(&s->cond_ctl, &s->lock);
+}
+
+static int dispatch_cmd(struct ngl_ctx *s, cmd_func_type cmd_func, void *arg)
+{
+    const struct api_cmd cmd = {.func = cmd_func, .arg = arg};
+
+    pthread_mutex_lock(&s->lock);
+    queue_cmd(s, &cmd);
+    wait_cmd_queue(s);
     pthread_mutex_unlock(&s->lock);
 
     return s->cmd_ret;
 }
 
+static int dispatch_cmd_async(struct ngl_ctx *s, cmd_func_type cmd_func, double t)
+{
+    const struct api_cmd cmd = {.func = cmd_func, .async = 1, .t = t};
+
+    pthread_mutex_lock(&s->lock);
+    queue_cmd(s, &cmd);
+    pthread_mutex_unlock(&s->lock);
+
+    return 0;
+}
+
 static void *worker_thread(void *arg)
 {
     struct ngl_ctx *s = arg;
@@ -187,11 +964,30 @@ static void *worker_thread(void *arg)
 
     pthread_mutex_lock(&s->lock);
     for (;;) {
-        while (!s->cmd_func)
+        while (!s->cmd_queue_count)
             pthread_cond_wait(&s->cond_wkr, &s->lock);
-        s->cmd_ret = s->cmd_func(s, s->cmd_arg);
-        int need_stop = s->cmd_func == cmd_stop;
-        s->cmd_func = s->cmd_arg = NULL;
+
+        /*
+         * The command slot remains reserved until the command is completed,
+         * so it is safe to release the lock while executing it: the
+         * controller is only allowed to queue commands in the free slots.
+         */
+        struct api_cmd *cmd = &s->cmd_queue[s->cmd_queue_head];
+        pthread_mutex_unlock(&s->lock);
+        /* Pipelined updates may still be running on the graph */
+        ngli_node_wait_cpu_update(s);
+        const int ret = cmd->func(s, cmd->arg);
+        pthread_mutex_lock(&s->lock);
+
+        if (cmd->async) {
+            if (ret < 0 && !s->async_ret)
+                s->async_ret = ret;
+        } else {
+            s->cmd_ret = ret;
+        }
+        const int need_stop = cmd->func == cmd_stop;
+        s->cmd_queue_head = (s->cmd_queue_head + 1) % NGLI_CMD_QUEUE_SIZE;
+        s->cmd_queue_count--;
         pthread_cond_signal(&s->cond_ctl);
 
         if (need_stop)
@@ -244,8 +1040,15 @@ static void stop_thread(struct ngl_ctx *s)
     pthread_cond_destroy(&s->cond_ctl);
     pthread_cond_destroy(&s->cond_wkr);
     pthread_mutex_destroy(&s->lock);
+    pthread_mutex_destroy(&s->param_updates_lock);
+    pthread_mutex_destroy(&s->readback_lock);
 }
 
+#define FRAME_ARENA_BLOCK_SIZE 4096
+
+/* Pixels of the still images kept decoded once unused by the media */
+#define IMAGE_CACHE_SIZE (64 * 1024 * 1024)
+
 struct ngl_ctx *ngl_create(void)
 {
     struct ngl_ctx *s = ngli_calloc(1, sizeof(*s));
@@ -253,22 +1056,47 @@ struct ngl_ctx *ngl_create(void)
         return NULL;
 
     if (pthread_mutex_init(&s->lock, NULL) ||
+        pthread_mutex_init(&s->param_updates_lock, NULL) ||
+        pthread_mutex_init(&s->readback_lock, NULL) ||
         pthread_cond_init(&s->cond_ctl, NULL) ||
         pthread_cond_init(&s->cond_wkr, NULL) ||
         pthread_create(&s->worker_tid, NULL, worker_thread, s)) {
         pthread_cond_destroy(&s->cond_ctl);
         pthread_cond_destroy(&s->cond_wkr);
         pthread_mutex_destroy(&s->lock);
+        pthread_mutex_destroy(&s->param_updates_lock);
+        pthread_mutex_destroy(&s->readback_lock);
         ngli_free(s);
         return NULL;
     }
 
-    ngli_darray_init(&s->modelview_matrix_stack, 4 * 4 * sizeof(float), 1);
+    ngli_darray_init(&s->modelview_matrix_stack, sizeof(struct modelview), 1);
     ngli_darray_init(&s->projection_matrix_stack, 4 * 4 * sizeof(float), 1);
     ngli_darray_init(&s->activitycheck_nodes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->visit_skipped_nodes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->deferred_releases, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->deferred_uploads, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->parked_players, sizeof(struct sxplayer_ctx *), 0);
+    ngli_darray_init(&s->idle_nodes, sizeof(struct idle_node), 0);
+    ngli_darray_init(&s->cpu_update_nodes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->animation_bakes, sizeof(struct animation_bake), 0);
+    ngli_darray_init(&s->draw_items, sizeof(struct draw_item), 1);
+    ngli_darray_init(&s->param_updates, sizeof(struct ngl_param_update), 0);
+    ngli_darray_init(&s->applied_param_updates, sizeof(struct ngl_param_update), 0);
+    ngli_darray_init(&s->readback_requests, sizeof(struct readback), 0);
+    ngli_darray_init(&s->readbacks, sizeof(struct readback), 0);
+    ngli_damage_init(&s->damage);
+    s->frame_arena = ngli_arena_create(FRAME_ARENA_BLOCK_SIZE, NGLI_MEMTAG_DRAWING);
+    if (!s->frame_arena)
+        goto fail;
+    if (ngli_imagecache_init(&s->image_cache, IMAGE_CACHE_SIZE, ngli_node_media_free_still_texture, NULL) < 0)
+        goto fail;
+    s->activity_gen = 1;
+    s->frame_changed = 1;
+    s->modelview_version = NGLI_MODELVIEW_VERSION_IDENTITY;
 
     static const NGLI_ALIGNED_MAT(id_matrix) = NGLI_MAT4_IDENTITY;
-    if (!ngli_darray_push(&s->modelview_matrix_stack, id_matrix) ||
+    if (ngli_modelview_push(s, id_matrix, NGLI_MODELVIEW_VERSION_IDENTITY) < 0 ||
         !ngli_darray_push(&s->projection_matrix_stack, id_matrix))
         goto fail;
 
@@ -328,13 +1156,91 @@ int ngl_configure(struct ngl_ctx *s, struct ngl_config *config)
                 config->height);
             return NGL_ERROR_INVALID_ARG;
         }
+        if (!!config->capture_buffer + !!config->capture_callback +
+            !!config->capture_dmabuf + !!config->capture_hardware_buffer +
+            !!config->capture_d3d11_texture > 1) {
+            LOG(ERROR, "capture_buffer, capture_callback, capture_dmabuf, "
+                "capture_hardware_buffer and capture_d3d11_texture are mutually exclusive");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->device < 0) {
+            LOG(ERROR, "invalid device %d", config->device);
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->capture_format < 0 || config->capture_format > NGL_CAPTURE_FORMAT_P010) {
+            LOG(ERROR, "invalid capture format %d", config->capture_format);
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->capture_width < 0 || config->capture_height < 0 ||
+            !config->capture_width != !config->capture_height) {
+            LOG(ERROR, "invalid capture dimensions (%dx%d)", config->capture_width, config->capture_height);
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->nb_outputs < 0 || (config->nb_outputs && !config->outputs)) {
+            LOG(ERROR, "invalid outputs");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        for (int i = 0; i < config->nb_outputs; i++) {
+            const struct ngl_output *output = &config->outputs[i];
+            if (output->width <= 0 || output->height <= 0 || !output->capture_buffer) {
+                LOG(ERROR, "output %d must have valid dimensions (%dx%d) and a capture buffer",
+                    i, output->width, output->height);
+                return NGL_ERROR_INVALID_ARG;
+            }
+        }
     } else {
         if (config->capture_buffer) {
             LOG(ERROR, "capture_buffer is only supported with offscreen rendering");
             return NGL_ERROR_INVALID_ARG;
         }
+        if (config->capture_callback) {
+            LOG(ERROR, "capture_callback is only supported with offscreen rendering");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->capture_dmabuf) {
+            LOG(ERROR, "capture_dmabuf is only supported with offscreen rendering");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->capture_hardware_buffer) {
+            LOG(ERROR, "capture_hardware_buffer is only supported with offscreen rendering");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->capture_d3d11_texture) {
+            LOG(ERROR, "capture_d3d11_texture is only supported with offscreen rendering");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (config->nb_outputs) {
+            LOG(ERROR, "outputs are only supported with offscreen rendering");
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    if (config->color_load_op < 0 || config->color_load_op >= NGLI_NB_LOAD_OP ||
+        config->depth_stencil_load_op < 0 || config->depth_stencil_load_op >= NGLI_NB_LOAD_OP) {
+        LOG(ERROR, "invalid load operation");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (config->depth_stencil_store_op < 0 || config->depth_stencil_store_op >= NGLI_NB_STORE_OP) {
+        LOG(ERROR, "invalid store operation");
+        return NGL_ERROR_INVALID_ARG;
     }
 
+    if (config->frame_cache_size < 0) {
+        LOG(ERROR, "invalid frame cache size %d", config->frame_cache_size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (config->thread_priority < 0 || config->thread_priority > NGL_THREAD_PRIORITY_REALTIME) {
+        LOG(ERROR, "invalid thread priority %d", config->thread_priority);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    /* Applied first so the threads spawned by the rendering thread inherit it */
+    int ret = dispatch_cmd(s, cmd_set_thread_priority, config);
+    if (ret < 0)
+        return ret;
+
     if (s->configured)
 #if defined(TARGET_IPHONE) || defined(TARGET_DARWIN)
         return reconfigure_ios(s, config);
@@ -363,9 +1269,9 @@ int ngl_configure(struct ngl_ctx *s, struct ngl_config *config)
     }
 
 #if defined(TARGET_IPHONE) || defined(TARGET_DARWIN)
-    int ret = configure_ios(s, config);
+    ret = configure_ios(s, config);
 #else
-    int ret = dispatch_cmd(s, cmd_configure, config);
+    ret = dispatch_cmd(s, cmd_configure, config);
 #endif
     if (ret < 0) {
         return ret;
@@ -385,6 +1291,89 @@ int ngl_set_scene(struct ngl_ctx *s, struct ngl_node *scene)
     return dispatch_cmd(s, cmd_set_scene, scene);
 }
 
+int ngl_update_scene(struct ngl_ctx *s, struct ngl_node *scene)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before updating a scene");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_update_scene, scene);
+}
+
+int ngl_params_update(struct ngl_ctx *s, const struct ngl_param_update *updates, int nb_updates)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before updating parameters");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (nb_updates < 0 || (nb_updates && !updates)) {
+        LOG(ERROR, "invalid parameter updates");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < nb_updates; i++) {
+        const struct ngl_param_update *update = &updates[i];
+        if (!update->node || update->node->ctx != s) {
+            LOG(ERROR, "the node of the parameter update %d is not associated with the context", i);
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        if (!ngli_node_param_check_update(update->node, update))
+            return NGL_ERROR_INVALID_ARG;
+    }
+
+    return ngli_queue_param_updates(s, updates, nb_updates);
+}
+
+int ngli_queue_param_updates(struct ngl_ctx *s, const struct ngl_param_update *updates, int nb_updates)
+{
+    int ret = 0;
+    pthread_mutex_lock(&s->param_updates_lock);
+    const int count = ngli_darray_count(&s->param_updates);
+    for (int i = 0; i < nb_updates; i++) {
+        const struct ngl_param_update *update = &updates[i];
+        const struct node_param *par = &update->node->class->params[update->handle];
+
+        struct ngl_param_update entry = *update;
+        if (par->type == PARAM_TYPE_STR && entry.value.str) {
+            entry.value.str = ngli_strdup(entry.value.str);
+            if (!entry.value.str) {
+                ret = NGL_ERROR_MEMORY;
+                break;
+            }
+        }
+        if (!ngli_darray_push(&s->param_updates, &entry)) {
+            if (par->type == PARAM_TYPE_STR)
+                ngli_free((char *)entry.value.str);
+            ret = NGL_ERROR_MEMORY;
+            break;
+        }
+        ngl_node_ref(entry.node);
+    }
+
+    /* The updates are queued all at once or not at all */
+    if (ret < 0) {
+        struct ngl_param_update *entries = ngli_darray_data(&s->param_updates);
+        for (int i = count; i < ngli_darray_count(&s->param_updates); i++)
+            release_param_update(&entries[i]);
+        s->param_updates.count = count;
+    }
+    pthread_mutex_unlock(&s->param_updates_lock);
+
+    return ret;
+}
+
+int ngl_prepare_scene(struct ngl_ctx *s, struct ngl_node *scene)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before preparing a scene");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_prepare_scene, scene);
+}
+
 int ngli_prepare_draw(struct ngl_ctx *s, double t)
 {
     if (!s->configured) {
@@ -405,6 +1394,182 @@ int ngl_draw(struct ngl_ctx *s, double t)
     return dispatch_cmd(s, cmd_draw, &t);
 }
 
+int ngl_draw_batch(struct ngl_ctx *s, const double *times, int nb_times,
+                   uint8_t *atlas, int nb_columns)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before drawing");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (!s->config.offscreen) {
+        LOG(ERROR, "batch drawing is only supported with offscreen rendering");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (!times || nb_times <= 0 || !atlas || nb_columns <= 0) {
+        LOG(ERROR, "invalid batch drawing arguments");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    struct draw_batch batch = {
+        .times = times,
+        .nb_times = nb_times,
+        .atlas = atlas,
+        .nb_columns = nb_columns,
+    };
+    return dispatch_cmd(s, cmd_draw_batch, &batch);
+}
+
+int ngl_warmup(struct ngl_ctx *s, double t_start, double duration,
+               ngl_warmup_callback_type progress_cb, void *user_arg)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before warming up");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (duration < 0.) {
+        LOG(ERROR, "invalid warm up duration %g", duration);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    struct warmup warmup = {
+        .start = t_start,
+        .duration = duration,
+        .progress_cb = progress_cb,
+        .user_arg = user_arg,
+    };
+    return dispatch_cmd(s, cmd_warmup, &warmup);
+}
+
+int ngl_draw_async(struct ngl_ctx *s, double t)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before drawing");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd_async(s, cmd_draw, t);
+}
+
+int ngl_wait(struct ngl_ctx *s)
+{
+    pthread_mutex_lock(&s->lock);
+    wait_cmd_queue(s);
+    int ret = s->async_ret;
+    s->async_ret = 0;
+    pthread_mutex_unlock(&s->lock);
+
+    if (s->configured) {
+        const int flush_ret = dispatch_cmd(s, cmd_flush, NULL);
+        if (ret >= 0)
+            ret = flush_ret;
+    }
+
+    return ret;
+}
+
+int ngl_get_stats(struct ngl_ctx *s, struct ngl_stats *stats)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before getting statistics");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_get_stats, stats);
+}
+
+int ngl_predict_display_delay(struct ngl_ctx *s, int64_t *delayp)
+{
+    *delayp = 0;
+
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before predicting the display time");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_predict_display_delay, delayp);
+}
+
+int ngl_get_next_change_time(struct ngl_ctx *s, double *tp)
+{
+    *tp = -DBL_MAX;
+
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before getting the next change time");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_get_next_change_time, tp);
+}
+
+int ngl_profile_start(struct ngl_ctx *s)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before profiling");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_profile_start, NULL);
+}
+
+int ngl_profile_stop(struct ngl_ctx *s, char **tracep)
+{
+    *tracep = NULL;
+
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before profiling");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return dispatch_cmd(s, cmd_profile_stop, tracep);
+}
+
+char *ngl_dot_cost(struct ngl_ctx *s, int metric)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before profiling");
+        return NULL;
+    }
+
+    if (metric < 0 || metric >= NGL_DOT_COST_NB) {
+        LOG(ERROR, "invalid cost metric %d", metric);
+        return NULL;
+    }
+
+    struct dot_cost_params params = {.metric = metric};
+    dispatch_cmd(s, cmd_dot_cost, &params);
+    return params.graph;
+}
+
+int ngl_analyze(struct ngl_ctx *s, const double *times, int nb_times, struct ngl_analysis *analysis)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before analyzing");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (!times || nb_times <= 0 || !analysis) {
+        LOG(ERROR, "invalid analysis arguments");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    for (int i = 1; i < nb_times; i++) {
+        if (times[i] <= times[i - 1]) {
+            LOG(ERROR, "analysis times must be increasing: %g <= %g", times[i], times[i - 1]);
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    struct analyze_params params = {
+        .times = times,
+        .nb_times = nb_times,
+        .analysis = analysis,
+    };
+    return dispatch_cmd(s, cmd_analyze, &params);
+}
+
 void ngl_freep(struct ngl_ctx **ss)
 {
     struct ngl_ctx *s = *ss;
@@ -412,13 +1577,37 @@ void ngl_freep(struct ngl_ctx **ss)
     if (!s)
         return;
 
-    if (s->configured)
+    if (s->configured) {
+        ngl_prepare_scene(s, NULL);
         ngl_set_scene(s, NULL);
+    }
 
     stop_thread(s);
     ngli_darray_reset(&s->modelview_matrix_stack);
     ngli_darray_reset(&s->projection_matrix_stack);
     ngli_darray_reset(&s->activitycheck_nodes);
+    ngli_darray_reset(&s->visit_skipped_nodes);
+    ngli_darray_reset(&s->deferred_releases);
+    ngli_darray_reset(&s->deferred_uploads);
+    ngli_darray_reset(&s->parked_players);
+    ngli_darray_reset(&s->idle_nodes);
+    ngli_darray_reset(&s->cpu_update_nodes);
+    ngli_darray_reset(&s->animation_bakes);
+    ngli_schedule_reset(&s->schedule);
+    ngli_jobpool_freep(&s->jobpool);
+#if defined(TARGET_ANDROID)
+    /* The media have all been released with the scene */
+    ngli_android_handlerthread_free(&s->android_handlerthread);
+#endif
+    ngli_darray_reset(&s->draw_items);
+    release_param_updates(&s->param_updates);
+    ngli_darray_reset(&s->param_updates);
+    ngli_darray_reset(&s->applied_param_updates);
+    ngli_darray_reset(&s->readback_requests);
+    ngli_darray_reset(&s->readbacks);
+    ngli_damage_reset(&s->damage);
+    ngli_arena_unrefp(&s->frame_arena);
+    ngli_imagecache_reset(&s->image_cache);
     ngli_free(*ss);
     *ss = NULL;
 }
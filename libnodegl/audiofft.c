@@ -0,0 +1,179 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "audiofft.h"
+#include "glcontext.h"
+#include "log.h"
+#include "memory.h"
+#include "nodes.h"
+#include "type.h"
+#include "utils.h"
+
+#define LOCAL_SIZE 64
+
+/*
+ * One work group per channel: the Hann windowed samples are loaded in bit
+ * reversed order in shared memory, then transformed in place by log2(N)
+ * radix-2 butterfly passes.
+ */
+static const char compute_data[] =
+    "#version %s\n"
+    "#define N %d\n"
+    "#define LOG2N %d\n"
+    "#define LOCAL_SIZE %d\n"
+    "#define PI 3.14159265358979\n"
+    "precision highp float;\n"
+    "layout(local_size_x = LOCAL_SIZE) in;\n"
+    "layout(std430, binding = 0) readonly buffer window_block { float samples[]; };\n"
+    "layout(r32f, binding = 0) uniform highp image2D spectrum;\n"
+    "uniform float smoothing;\n"
+    "shared vec2 data[N];\n"
+    "\n"
+    "void main(void)\n"
+    "{\n"
+    "    int channel = int(gl_WorkGroupID.x);\n"
+    "    int lid = int(gl_LocalInvocationID.x);\n"
+    "\n"
+    "    for (int i = lid; i < N; i += LOCAL_SIZE) {\n"
+    "        int r = int(bitfieldReverse(uint(i)) >> uint(32 - LOG2N));\n"
+    "        float w = 0.5 - 0.5 * cos(2.0 * PI * float(i) / float(N - 1));\n"
+    "        data[r] = vec2(samples[i * 2 + channel] * w, 0.0);\n"
+    "    }\n"
+    "    memoryBarrierShared();\n"
+    "    barrier();\n"
+    "\n"
+    "    for (int size = 2; size <= N; size *= 2) {\n"
+    "        int hsize = size / 2;\n"
+    "        for (int k = lid; k < N / 2; k += LOCAL_SIZE) {\n"
+    "            int pos = k %% hsize;\n"
+    "            int i = (k / hsize) * size + pos;\n"
+    "            float angle = -2.0 * PI * float(pos) / float(size);\n"
+    "            vec2 tw = vec2(cos(angle), sin(angle));\n"
+    "            vec2 a = data[i];\n"
+    "            vec2 b = data[i + hsize];\n"
+    "            vec2 t = vec2(b.x * tw.x - b.y * tw.y, b.x * tw.y + b.y * tw.x);\n"
+    "            data[i] = a + t;\n"
+    "            data[i + hsize] = a - t;\n"
+    "        }\n"
+    "        memoryBarrierShared();\n"
+    "        barrier();\n"
+    "    }\n"
+    "\n"
+    "    for (int k = lid; k < N / 2; k += LOCAL_SIZE) {\n"
+    "        float wave = samples[(N / 2 + k) * 2 + channel];\n"
+    "        imageStore(spectrum, ivec2(k, channel), vec4(wave));\n"
+    "        ivec2 pos = ivec2(k, 2 + channel);\n"
+    "        float amplitude = length(data[k]) * 4.0 / float(N);\n"
+    "        float prev = imageLoad(spectrum, pos).r;\n"
+    "        imageStore(spectrum, pos, vec4(mix(amplitude, prev, smoothing)));\n"
+    "    }\n"
+    "}\n";
+
+int ngli_audiofft_init(struct audiofft *s, struct ngl_ctx *ctx, struct texture *dst_texture,
+                       int nb_bins, float smoothing)
+{
+    struct glcontext *gl = ctx->glcontext;
+
+    s->ctx = ctx;
+    s->nb_bins = nb_bins;
+    s->smoothing = smoothing;
+
+    if (!(gl->features & NGLI_FEATURE_COMPUTE_SHADER_ALL)) {
+        LOG(ERROR, "context does not support the compute shaders required by the audio spectrum");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    const int window_size = nb_bins * 2;
+    int log2_size = 0;
+    while ((1 << log2_size) < window_size)
+        log2_size++;
+
+    const char *version = gl->backend == NGL_BACKEND_OPENGLES ? "310 es" : "430";
+    char *compute = ngli_asprintf(compute_data, version, window_size, log2_size, LOCAL_SIZE);
+    if (!compute)
+        return NGL_ERROR_MEMORY;
+
+    int ret = ngli_program_init(&s->program, ctx, NULL, NULL, compute);
+    ngli_free(compute);
+    if (ret < 0)
+        return ret;
+
+    /* The window of interleaved stereo samples is uploaded for every new audio frame */
+    ret = ngli_buffer_init(&s->window, ctx, window_size * 2 * sizeof(float), NGLI_BUFFER_USAGE_DYNAMIC);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "smoothing", .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->smoothing},
+    };
+
+    const struct pipeline_texture textures[] = {
+        {.name = "spectrum", .texture = dst_texture},
+    };
+
+    const struct pipeline_buffer buffers[] = {
+        {.name = "window_block", .buffer = &s->window},
+    };
+
+    const struct pipeline_params pipeline_params = {
+        .type        = NGLI_PIPELINE_TYPE_COMPUTE,
+        .program     = &s->program,
+        .textures    = textures,
+        .nb_textures = NGLI_ARRAY_NB(textures),
+        .uniforms    = uniforms,
+        .nb_uniforms = NGLI_ARRAY_NB(uniforms),
+        .buffers     = buffers,
+        .nb_buffers  = NGLI_ARRAY_NB(buffers),
+        .compute     = {
+            .nb_group_x = 2,
+            .nb_group_y = 1,
+            .nb_group_z = 1,
+            .barriers   = NGLI_BARRIER_TEXTURE_FETCH_BIT | NGLI_BARRIER_IMAGE_ACCESS_BIT,
+        },
+    };
+
+    return ngli_pipeline_init(&s->pipeline, ctx, &pipeline_params);
+}
+
+int ngli_audiofft_compute(struct audiofft *s, const float *window)
+{
+    int ret = ngli_buffer_upload(&s->window, window, s->window.size);
+    if (ret < 0)
+        return ret;
+
+    ngli_pipeline_exec(&s->pipeline);
+
+    return 0;
+}
+
+void ngli_audiofft_reset(struct audiofft *s)
+{
+    if (!s->ctx)
+        return;
+
+    ngli_pipeline_reset(&s->pipeline);
+    ngli_buffer_reset(&s->window);
+    ngli_program_reset(&s->program);
+
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef AUDIOFFT_H
+#define AUDIOFFT_H
+
+#include "buffer.h"
+#include "pipeline.h"
+#include "program.h"
+#include "texture.h"
+
+#define NGLI_AUDIOFFT_MIN_BINS 16
+#define NGLI_AUDIOFFT_MAX_BINS 512
+
+/*
+ * Spectrum of a stereo PCM window computed by a compute shader. The window
+ * holds 2*nb_bins interleaved stereo samples and the destination texture is
+ * a nb_bins x 4 R32 float texture laid out like the sxplayer audio texture:
+ * the 2 first rows are the most recent waves of the left and right
+ * channels, the 2 next rows their amplitude spectrum, smoothed over time.
+ */
+struct audiofft {
+    struct ngl_ctx *ctx;
+    int nb_bins;
+    float smoothing;
+
+    struct program program;
+    struct buffer window;
+    struct pipeline pipeline;
+};
+
+int ngli_audiofft_init(struct audiofft *s, struct ngl_ctx *ctx, struct texture *dst_texture,
+                       int nb_bins, float smoothing);
+int ngli_audiofft_compute(struct audiofft *s, const float *window);
+void ngli_audiofft_reset(struct audiofft *s);
+
+#endif
@@ -24,13 +24,27 @@
 
 #include "nodegl.h"
 
+struct rendertarget;
+
 struct backend {
     const char *name;
     int (*reconfigure)(struct ngl_ctx *s, const struct ngl_config *config);
     int (*configure)(struct ngl_ctx *s, const struct ngl_config *config);
     int (*pre_draw)(struct ngl_ctx *s, double t);
+    int (*draw_outputs)(struct ngl_ctx *s);
     int (*post_draw)(struct ngl_ctx *s, double t);
+    int (*begin_batch)(struct ngl_ctx *s, int width, int height, uint8_t *data);
+    int (*end_batch)(struct ngl_ctx *s);
+    int (*flush)(struct ngl_ctx *s);
     void (*destroy)(struct ngl_ctx *s);
+
+    /* Render state commands, only called through the ngli_gctx_* helpers */
+    void (*set_rendertarget)(struct ngl_ctx *s, struct rendertarget *rt);
+    void (*set_viewport)(struct ngl_ctx *s, const int *viewport);
+    void (*set_scissor)(struct ngl_ctx *s, const int *scissor);
+    void (*set_clear_color)(struct ngl_ctx *s, const float *color);
+    void (*clear)(struct ngl_ctx *s, int color, int depth_stencil);
+    void (*invalidate)(struct ngl_ctx *s, int color, int depth_stencil);
 };
 
 #endif
@@ -25,17 +25,68 @@
 #include "gctx.h"
 #include "nodes.h"
 #include "backend.h"
+#include "captureconv.h"
 #include "glcontext.h"
 #include "memory.h"
+#include "pass.h"
+#include "readback.h"
+#include "sharegroup.h"
+#include "tracemarker.h"
+#include "uploader.h"
+#include "utils.h"
 
 #if defined(TARGET_IPHONE)
 #include <CoreVideo/CoreVideo.h>
+#elif defined(TARGET_DARWIN)
+#include <CoreVideo/CoreVideo.h>
+#include <IOSurface/IOSurface.h>
+#include <OpenGL/CGLIOSurface.h>
+#endif
+
+#if defined(HAVE_GLPLATFORM_WGL)
+#define COBJMACROS
+#include <d3d11.h>
+#include "wgl.h"
 #endif
 
 #if defined(HAVE_VAAPI_X11)
 #include "vaapi.h"
 #endif
 
+#define DEFAULT_TEXTURE_POOL_SIZE 64 /* in MB */
+
+static void update_viewport(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    const struct ngl_config *config = &s->config;
+
+    int viewport[4] = {0, 0, gl->width, gl->height};
+    if (config->viewport[2] > 0 && config->viewport[3] > 0)
+        memcpy(viewport, config->viewport, sizeof(viewport));
+
+    /* The offscreen rendering may happen at a lower resolution */
+    if (config->offscreen && (s->rt.width != config->width || s->rt.height != config->height)) {
+        viewport[0] = viewport[0] * s->rt.width  / config->width;
+        viewport[1] = viewport[1] * s->rt.height / config->height;
+        viewport[2] = viewport[2] * s->rt.width  / config->width;
+        viewport[3] = viewport[3] * s->rt.height / config->height;
+    }
+
+    ngli_gctx_set_viewport(s, viewport);
+}
+
+/*
+ * Whether the multisampled offscreen rendering is resolved on-chip into a
+ * single sampled color texture, without any multisample color buffer
+ */
+static int has_implicit_msaa(const struct ngl_ctx *s)
+{
+    const struct glcontext *gl = s->glcontext;
+    const struct ngl_config *config = &s->config;
+    return config->samples > 0 && config->samples <= gl->max_samples &&
+           (gl->features & NGLI_FEATURE_MULTISAMPLED_RENDER_TO_TEXTURE);
+}
+
 static int offscreen_rendertarget_init(struct ngl_ctx *s)
 {
     struct glcontext *gl = s->glcontext;
@@ -47,17 +98,29 @@ static int offscreen_rendertarget_init(struct ngl_ctx *s)
         config->samples = 0;
     }
 
+    /* A multisampled buffer can not be scaled while being resolved, so the
+     * anti-aliasing is disabled while rendering at a lower resolution */
+    const struct renderscale *renderscale = &s->renderscale;
+    const int width = ngli_renderscale_get_size(renderscale, config->width);
+    const int height = ngli_renderscale_get_size(renderscale, config->height);
+    const int samples = renderscale->level ? 0 : config->samples;
+    const int implicit_samples = samples > 0 && has_implicit_msaa(s) ? samples : 0;
+
     struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
     attachment_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
-    attachment_params.width = config->width;
-    attachment_params.height = config->height;
-    attachment_params.samples = config->samples;
-    attachment_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+    attachment_params.width = width;
+    attachment_params.height = height;
+    attachment_params.samples = implicit_samples ? 0 : samples;
+    attachment_params.usage = implicit_samples ? 0 : NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
     int ret = ngli_texture_init(&s->rt_color, s, &attachment_params);
     if (ret < 0)
         return ret;
 
     attachment_params.format = NGLI_FORMAT_D24_UNORM_S8_UINT;
+    attachment_params.samples = samples;
+    attachment_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+    if (implicit_samples)
+        attachment_params.usage |= NGLI_TEXTURE_USAGE_IMPLICIT_MULTISAMPLE;
     ret = ngli_texture_init(&s->rt_depth, s, &attachment_params);
     if (ret < 0)
         return ret;
@@ -65,18 +128,18 @@ static int offscreen_rendertarget_init(struct ngl_ctx *s)
     const struct texture *attachments[] = {&s->rt_color, &s->rt_depth};
     const int nb_attachments = NGLI_ARRAY_NB(attachments);
     struct rendertarget_params rt_params = {
-        .width = config->width,
-        .height = config->height,
+        .width = width,
+        .height = height,
         .nb_attachments = nb_attachments,
         .attachments = attachments,
+        .implicit_samples = implicit_samples,
     };
     ret = ngli_rendertarget_init(&s->rt, s, &rt_params);
     if (ret < 0)
         return ret;
 
     ngli_gctx_set_rendertarget(s, &s->rt);
-    const int vp[4] = {0, 0, config->width, config->height};
-    ngli_gctx_set_viewport(s, vp);
+    update_viewport(s);
 
     return 0;
 }
@@ -88,6 +151,141 @@ static void offscreen_rendertarget_reset(struct ngl_ctx *s)
     ngli_texture_reset(&s->rt_depth);
 }
 
+static int output_init(struct ngl_ctx *s, struct output *output)
+{
+    const int width = output->params.width;
+    const int height = output->params.height;
+
+    struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    attachment_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    attachment_params.width = width;
+    attachment_params.height = height;
+    attachment_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+    int ret = ngli_texture_init(&output->color, s, &attachment_params);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_texture_init(&output->capture_color, s, &attachment_params);
+    if (ret < 0)
+        return ret;
+
+    attachment_params.format = NGLI_FORMAT_D24_UNORM_S8_UINT;
+    ret = ngli_texture_init(&output->depth, s, &attachment_params);
+    if (ret < 0)
+        return ret;
+
+    const struct texture *attachments[] = {&output->color, &output->depth};
+    struct rendertarget_params rt_params = {
+        .width = width,
+        .height = height,
+        .nb_attachments = NGLI_ARRAY_NB(attachments),
+        .attachments = attachments,
+    };
+    ret = ngli_rendertarget_init(&output->rt, s, &rt_params);
+    if (ret < 0)
+        return ret;
+
+    const struct texture *capture_attachments[] = {&output->capture_color};
+    struct rendertarget_params capture_rt_params = {
+        .width = width,
+        .height = height,
+        .nb_attachments = NGLI_ARRAY_NB(capture_attachments),
+        .attachments = capture_attachments,
+    };
+    return ngli_rendertarget_init(&output->capture_rt, s, &capture_rt_params);
+}
+
+static void output_capture(struct ngl_ctx *s, struct output *output)
+{
+    ngli_rendertarget_blit(&output->rt, &output->capture_rt, 1);
+    ngli_rendertarget_read_pixels(&output->capture_rt, output->params.capture_buffer);
+    ngli_gctx_store_attachments(s, NGLI_STORE_OP_DONT_CARE, NGLI_STORE_OP_DONT_CARE);
+}
+
+static void output_reset(struct output *output)
+{
+    ngli_rendertarget_reset(&output->capture_rt);
+    ngli_rendertarget_reset(&output->rt);
+    ngli_texture_reset(&output->capture_color);
+    ngli_texture_reset(&output->depth);
+    ngli_texture_reset(&output->color);
+}
+
+static void outputs_reset(struct ngl_ctx *s)
+{
+    for (int i = 0; i < s->nb_outputs; i++)
+        output_reset(&s->outputs[i]);
+    ngli_free(s->outputs);
+    s->outputs = NULL;
+    s->nb_outputs = 0;
+}
+
+static int outputs_init(struct ngl_ctx *s, const struct ngl_config *config)
+{
+    struct glcontext *gl = s->glcontext;
+
+    /* The user array is not kept past the configuration */
+    s->config.outputs = NULL;
+    s->config.nb_outputs = 0;
+
+    if (!config->nb_outputs)
+        return 0;
+
+    if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT)) {
+        LOG(ERROR, "context does not support the framebuffer object feature, "
+            "additional outputs are not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    s->outputs = ngli_calloc(config->nb_outputs, sizeof(*s->outputs));
+    if (!s->outputs)
+        return NGL_ERROR_MEMORY;
+    s->nb_outputs = config->nb_outputs;
+
+    for (int i = 0; i < s->nb_outputs; i++) {
+        struct output *output = &s->outputs[i];
+        output->params = config->outputs[i];
+        int ret = output_init(s, output);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int same_outputs(const struct ngl_ctx *s, const struct ngl_config *config)
+{
+    if (s->nb_outputs != config->nb_outputs)
+        return 0;
+    for (int i = 0; i < s->nb_outputs; i++)
+        if (memcmp(&s->outputs[i].params, &config->outputs[i], sizeof(config->outputs[i])))
+            return 0;
+    return 1;
+}
+
+static void renderscale_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    const struct ngl_config *config = &s->config;
+
+    int64_t target = config->offscreen ? config->target_frame_time : 0;
+    if (target && (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT) || s->stats.gpu_time < 0)) {
+        LOG(WARNING, "context does not support the framebuffer object and timer query features, "
+            "the rendering resolution will not be adapted to the frame time");
+        target = 0;
+    }
+    ngli_renderscale_init(&s->renderscale, target);
+}
+
+/* Run the conversion into the capture format and return where to read the frame from */
+static struct rendertarget *capture_convert(struct ngl_ctx *s)
+{
+    if (!s->capture_conv)
+        return &s->capture_rt;
+    ngli_captureconv_convert(s->capture_conv);
+    return &s->capture_conv->rt;
+}
+
 static void capture_default(struct ngl_ctx *s)
 {
     struct ngl_config *config = &s->config;
@@ -95,10 +293,10 @@ static void capture_default(struct ngl_ctx *s)
     struct rendertarget *capture_rt = &s->capture_rt;
 
     ngli_rendertarget_blit(rt, capture_rt, 1);
-    ngli_rendertarget_read_pixels(capture_rt, config->capture_buffer);
+    ngli_rendertarget_read_pixels(capture_convert(s), config->capture_buffer);
 }
 
-static void capture_ios(struct ngl_ctx *s)
+static void capture_zero_copy(struct ngl_ctx *s)
 {
     struct glcontext *gl = s->glcontext;
     struct rendertarget *rt = &s->rt;
@@ -108,6 +306,23 @@ static void capture_ios(struct ngl_ctx *s)
     ngli_glFinish(gl);
 }
 
+#if defined(HAVE_GLPLATFORM_WGL)
+static void capture_d3d11(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct rendertarget *rt = &s->rt;
+    struct rendertarget *capture_rt = &s->capture_rt;
+
+    if (!ngli_wglDXLockObjectsNV(gl, s->capture_dx_device, 1, &s->capture_dx_object)) {
+        LOG(ERROR, "could not lock the capture D3D11 texture (%lu)", GetLastError());
+        return;
+    }
+    ngli_rendertarget_blit(rt, capture_rt, 1);
+    /* Unlocking flushes the rendering before D3D11 accesses the texture */
+    ngli_wglDXUnlockObjectsNV(gl, s->capture_dx_device, 1, &s->capture_dx_object);
+}
+#endif
+
 static void capture_gles_msaa(struct ngl_ctx *s)
 {
     struct ngl_config *config = &s->config;
@@ -117,10 +332,10 @@ static void capture_gles_msaa(struct ngl_ctx *s)
 
     ngli_rendertarget_blit(rt, oes_resolve_rt, 0);
     ngli_rendertarget_blit(oes_resolve_rt, capture_rt, 1);
-    ngli_rendertarget_read_pixels(capture_rt, config->capture_buffer);
+    ngli_rendertarget_read_pixels(capture_convert(s), config->capture_buffer);
 }
 
-static void capture_ios_msaa(struct ngl_ctx *s)
+static void capture_zero_copy_msaa(struct ngl_ctx *s)
 {
     struct glcontext *gl = s->glcontext;
     struct rendertarget *rt = &s->rt;
@@ -148,17 +363,430 @@ static void capture_cpu_fallback(struct ngl_ctx *s)
     }
 }
 
-static int capture_init(struct ngl_ctx *s)
+static int capture_async_pop(struct ngl_ctx *s, int wait)
 {
     struct glcontext *gl = s->glcontext;
     struct ngl_config *config = &s->config;
-    const int ios_capture = gl->platform == NGL_PLATFORM_IOS && config->window;
 
-    if (!config->capture_buffer && !ios_capture)
+    if (!s->capture_pbo_count)
         return 0;
 
+    const int index = s->capture_pbo_head;
+    GLsync fence = s->capture_fences[index];
+    if (wait) {
+        const GLuint64 timeout = 1000000; /* 1ms */
+        while (ngli_glClientWaitSync(gl, fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED)
+            ;
+    } else if (ngli_glClientWaitSync(gl, fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        return 0;
+    }
+    ngli_glDeleteSync(gl, fence);
+    s->capture_fences[index] = NULL;
+
+    ngli_glBindBuffer(gl, GL_PIXEL_PACK_BUFFER, s->capture_pbos[index]);
+    const uint8_t *data = ngli_glMapBufferRange(gl, GL_PIXEL_PACK_BUFFER, 0, s->capture_size, GL_MAP_READ_BIT);
+    if (data) {
+        config->capture_callback(config->capture_user_arg, data);
+        ngli_glUnmapBuffer(gl, GL_PIXEL_PACK_BUFFER);
+    } else {
+        LOG(ERROR, "could not map capture pixel buffer");
+    }
+    ngli_glBindBuffer(gl, GL_PIXEL_PACK_BUFFER, 0);
+
+    s->capture_pbo_head = (s->capture_pbo_head + 1) % NGLI_CAPTURE_NB_PBOS;
+    s->capture_pbo_count--;
+    return 1;
+}
+
+static void capture_async_flush(struct ngl_ctx *s)
+{
+    while (capture_async_pop(s, 1))
+        ;
+}
+
+static void capture_async_read(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct rendertarget *capture_rt = capture_convert(s);
+
+    /* All the pixel buffers are in flight: wait for the oldest one */
+    if (s->capture_pbo_count == NGLI_CAPTURE_NB_PBOS)
+        capture_async_pop(s, 1);
+
+    /* With a pixel pack buffer bound, the read pixels are written in the
+     * buffer and the read does not wait for the rendering to complete */
+    const int index = (s->capture_pbo_head + s->capture_pbo_count) % NGLI_CAPTURE_NB_PBOS;
+    ngli_glBindBuffer(gl, GL_PIXEL_PACK_BUFFER, s->capture_pbos[index]);
+    ngli_rendertarget_read_pixels(capture_rt, NULL);
+    ngli_glBindBuffer(gl, GL_PIXEL_PACK_BUFFER, 0);
+    s->capture_fences[index] = ngli_glFenceSync(gl, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s->capture_pbo_count++;
+
+    /* Deliver the frames already read back without blocking */
+    while (capture_async_pop(s, 0))
+        ;
+}
+
+static void capture_async(struct ngl_ctx *s)
+{
+    struct rendertarget *rt = &s->rt;
+    struct rendertarget *capture_rt = &s->capture_rt;
+
+    ngli_rendertarget_blit(rt, capture_rt, 1);
+    capture_async_read(s);
+}
+
+static void capture_async_gles_msaa(struct ngl_ctx *s)
+{
+    struct rendertarget *rt = &s->rt;
+    struct rendertarget *capture_rt = &s->capture_rt;
+    struct rendertarget *oes_resolve_rt = &s->oes_resolve_rt;
+
+    ngli_rendertarget_blit(rt, oes_resolve_rt, 0);
+    ngli_rendertarget_blit(oes_resolve_rt, capture_rt, 1);
+    capture_async_read(s);
+}
+
+static int capture_async_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+
+    const int features = NGLI_FEATURE_MAP_BUFFER_RANGE | NGLI_FEATURE_SYNC;
+    if ((gl->features & features) != features) {
+        LOG(ERROR, "context does not support the map buffer range and sync features, "
+            "asynchronous capture is not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    ngli_glGenBuffers(gl, NGLI_CAPTURE_NB_PBOS, s->capture_pbos);
+    for (int i = 0; i < NGLI_CAPTURE_NB_PBOS; i++) {
+        ngli_glBindBuffer(gl, GL_PIXEL_PACK_BUFFER, s->capture_pbos[i]);
+        ngli_glBufferData(gl, GL_PIXEL_PACK_BUFFER, s->capture_size, NULL, GL_STREAM_READ);
+    }
+    ngli_glBindBuffer(gl, GL_PIXEL_PACK_BUFFER, 0);
+
+    return 0;
+}
+
+static void capture_async_reset(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+
+    if (!s->capture_pbos[0])
+        return;
+
+    capture_async_flush(s);
+    ngli_glDeleteBuffers(gl, NGLI_CAPTURE_NB_PBOS, s->capture_pbos);
+    memset(s->capture_pbos, 0, sizeof(s->capture_pbos));
+    s->capture_pbo_head = 0;
+    s->capture_pbo_count = 0;
+}
+
+#if defined(HAVE_GLPLATFORM_EGL)
+static int capture_egl_image_wrap(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct ngl_config *config = &s->config;
+
+    ngli_glGenTextures(gl, 1, &s->capture_egl_texture);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, s->capture_egl_texture);
+    ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    ngli_glEGLImageTargetTexture2DOES(gl, GL_TEXTURE_2D, s->capture_egl_image);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
+
+    struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    attachment_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    attachment_params.width = config->width;
+    attachment_params.height = config->height;
+    return ngli_texture_wrap(&s->capture_rt_color, s, &attachment_params, s->capture_egl_texture);
+}
+
+static int capture_dmabuf_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct ngl_config *config = &s->config;
+    const struct ngl_dmabuf *dmabuf = config->capture_dmabuf;
+
+    const int features = NGLI_FEATURE_OES_EGL_IMAGE |
+                         NGLI_FEATURE_EGL_IMAGE_BASE_KHR |
+                         NGLI_FEATURE_EGL_EXT_IMAGE_DMA_BUF_IMPORT;
+    if ((gl->features & features) != features) {
+        LOG(ERROR, "context does not support the egl image dma-buf import features, "
+            "capturing to a dma-buf is not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    const EGLint attribs[] = {
+        EGL_LINUX_DRM_FOURCC_EXT,      dmabuf->fourcc,
+        EGL_WIDTH,                     config->width,
+        EGL_HEIGHT,                    config->height,
+        EGL_DMA_BUF_PLANE0_FD_EXT,     dmabuf->fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, dmabuf->offset,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT,  dmabuf->pitch,
+        EGL_NONE
+    };
+    s->capture_egl_image = ngli_eglCreateImageKHR(gl, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+    if (!s->capture_egl_image) {
+        LOG(ERROR, "could not create egl image from dma-buf");
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    return capture_egl_image_wrap(s);
+}
+
+#if defined(TARGET_ANDROID) && __ANDROID_API__ >= 26
+static int capture_hardware_buffer_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct ngl_config *config = &s->config;
+    AHardwareBuffer *hardware_buffer = config->capture_hardware_buffer;
+
+    const uint64_t features = NGLI_FEATURE_OES_EGL_IMAGE |
+                              NGLI_FEATURE_EGL_IMAGE_BASE_KHR |
+                              NGLI_FEATURE_EGL_ANDROID_NATIVE_BUFFER;
+    if ((gl->features & features) != features) {
+        LOG(ERROR, "context does not support the egl image native buffer features, "
+            "capturing to a hardware buffer is not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    AHardwareBuffer_Desc desc = {0};
+    AHardwareBuffer_describe(hardware_buffer, &desc);
+    if (desc.width != config->width || desc.height != config->height ||
+        desc.format != AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM ||
+        !(desc.usage & AHARDWAREBUFFER_USAGE_GPU_COLOR_OUTPUT)) {
+        LOG(ERROR, "capture hardware buffer must be a %dx%d R8G8B8A8 GPU color output buffer",
+            config->width, config->height);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    AHardwareBuffer_acquire(hardware_buffer);
+    s->capture_hardware_buffer = hardware_buffer;
+
+    EGLClientBuffer client_buffer = ngli_eglGetNativeClientBufferANDROID(gl, hardware_buffer);
+    static const EGLint attribs[] = {EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE};
+    s->capture_egl_image = ngli_eglCreateImageKHR(gl, EGL_NO_CONTEXT, EGL_NATIVE_BUFFER_ANDROID,
+                                                  client_buffer, attribs);
+    if (!s->capture_egl_image) {
+        LOG(ERROR, "could not create egl image from hardware buffer");
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    return capture_egl_image_wrap(s);
+}
+#endif
+
+static void capture_egl_image_reset(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+
+    if (s->capture_egl_texture) {
+        ngli_glstate_forget_texture(gl, s->capture_egl_texture);
+        ngli_glDeleteTextures(gl, 1, &s->capture_egl_texture);
+        s->capture_egl_texture = 0;
+    }
+    if (s->capture_egl_image) {
+        ngli_eglDestroyImageKHR(gl, s->capture_egl_image);
+        s->capture_egl_image = NULL;
+    }
+#if defined(TARGET_ANDROID) && __ANDROID_API__ >= 26
+    if (s->capture_hardware_buffer) {
+        AHardwareBuffer_release(s->capture_hardware_buffer);
+        s->capture_hardware_buffer = NULL;
+    }
+#endif
+}
+#endif
+
+#if defined(HAVE_GLPLATFORM_WGL)
+static int capture_d3d11_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct ngl_config *config = &s->config;
+    ID3D11Texture2D *d3d11_texture = config->capture_d3d11_texture;
+
+    if (!(gl->features & NGLI_FEATURE_WGL_NV_DX_INTEROP2)) {
+        LOG(ERROR, "context does not support the WGL_NV_DX_interop2 extension, "
+            "capturing to a D3D11 texture is not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    ID3D11Texture2D_GetDesc(d3d11_texture, &desc);
+    if (desc.Width != config->width || desc.Height != config->height ||
+        desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM || desc.SampleDesc.Count > 1 ||
+        !(desc.BindFlags & D3D11_BIND_RENDER_TARGET)) {
+        LOG(ERROR, "capture D3D11 texture must be a %dx%d single sampled R8G8B8A8_UNORM render target",
+            config->width, config->height);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    ID3D11Texture2D_AddRef(d3d11_texture);
+    s->capture_d3d11_texture = d3d11_texture;
+
+    ID3D11Device *device = NULL;
+    ID3D11Texture2D_GetDevice(d3d11_texture, &device);
+    s->capture_dx_device = ngli_wglDXOpenDeviceNV(gl, device);
+    ID3D11Device_Release(device);
+    if (!s->capture_dx_device) {
+        LOG(ERROR, "could not open the D3D11 device for interop (%lu)", GetLastError());
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    ngli_glGenTextures(gl, 1, &s->capture_dx_texture);
+    s->capture_dx_object = ngli_wglDXRegisterObjectNV(gl, s->capture_dx_device, d3d11_texture,
+                                                      s->capture_dx_texture, GL_TEXTURE_2D,
+                                                      WGL_ACCESS_WRITE_DISCARD_NV);
+    if (!s->capture_dx_object) {
+        LOG(ERROR, "could not register the capture D3D11 texture (%lu)", GetLastError());
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    attachment_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    attachment_params.width = config->width;
+    attachment_params.height = config->height;
+    return ngli_texture_wrap(&s->capture_rt_color, s, &attachment_params, s->capture_dx_texture);
+}
+
+static void capture_d3d11_reset(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+
+    if (s->capture_dx_object) {
+        ngli_wglDXUnregisterObjectNV(gl, s->capture_dx_device, s->capture_dx_object);
+        s->capture_dx_object = NULL;
+    }
+    if (s->capture_dx_texture) {
+        ngli_glstate_forget_texture(gl, s->capture_dx_texture);
+        ngli_glDeleteTextures(gl, 1, &s->capture_dx_texture);
+        s->capture_dx_texture = 0;
+    }
+    if (s->capture_dx_device) {
+        ngli_wglDXCloseDeviceNV(gl, s->capture_dx_device);
+        s->capture_dx_device = NULL;
+    }
+    if (s->capture_d3d11_texture) {
+        ID3D11Texture2D_Release(s->capture_d3d11_texture);
+        s->capture_d3d11_texture = NULL;
+    }
+}
+#endif
+
+#if defined(TARGET_DARWIN)
+static int capture_iosurface_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct ngl_config *config = &s->config;
+
+    CVPixelBufferRef capture_cvbuffer = (CVPixelBufferRef)config->window;
+    IOSurfaceRef surface = CVPixelBufferGetIOSurface(capture_cvbuffer);
+    if (!surface) {
+        LOG(ERROR, "capture CVPixelBuffer is not backed by an IOSurface");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    const OSType format = IOSurfaceGetPixelFormat(surface);
+    if (format != kCVPixelFormatType_32BGRA) {
+        LOG(ERROR, "unsupported capture IOSurface format: 0x%x", format);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    s->capture_cvbuffer = (CVPixelBufferRef)CFRetain(capture_cvbuffer);
+    if (!s->capture_cvbuffer)
+        return NGL_ERROR_MEMORY;
+
+    const int width = IOSurfaceGetWidth(surface);
+    const int height = IOSurfaceGetHeight(surface);
+
+    ngli_glGenTextures(gl, 1, &s->capture_iosurface_texture);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_RECTANGLE, s->capture_iosurface_texture);
+    CGLError err = CGLTexImageIOSurface2D(CGLGetCurrentContext(), GL_TEXTURE_RECTANGLE,
+                                          GL_RGBA8, width, height,
+                                          GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, surface, 0);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_RECTANGLE, 0);
+    if (err != kCGLNoError) {
+        LOG(ERROR, "could not bind capture IOSurface to texture: %d", err);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    attachment_params.format = NGLI_FORMAT_B8G8R8A8_UNORM;
+    attachment_params.width = width;
+    attachment_params.height = height;
+    attachment_params.rectangle = 1;
+    return ngli_texture_wrap(&s->capture_rt_color, s, &attachment_params, s->capture_iosurface_texture);
+}
+#endif
+
+static int capture_init(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct ngl_config *config = &s->config;
+    const int ios_capture = (gl->platform == NGL_PLATFORM_IOS ||
+                             gl->platform == NGL_PLATFORM_MACOS) && config->window;
+    const int dmabuf_capture = !!config->capture_dmabuf;
+    const int hardware_buffer_capture = !!config->capture_hardware_buffer;
+    const int d3d11_capture = !!config->capture_d3d11_texture;
+
+    if (!config->capture_buffer && !config->capture_callback && !ios_capture && !dmabuf_capture &&
+        !hardware_buffer_capture && !d3d11_capture)
+        return 0;
+
+    const int capture_width = config->capture_width ? config->capture_width : config->width;
+    const int capture_height = config->capture_height ? config->capture_height : config->height;
+    const int convert = config->capture_format != NGL_CAPTURE_FORMAT_RGBA;
+    const int scale = capture_width != config->width || capture_height != config->height;
+    if ((convert || scale) && (ios_capture || dmabuf_capture || hardware_buffer_capture || d3d11_capture)) {
+        LOG(ERROR, "the capture format and dimensions only apply to capture_buffer and capture_callback");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+    s->capture_size = ngli_captureconv_get_buffer_size(config->capture_format, capture_width, capture_height);
+
+#if !defined(HAVE_GLPLATFORM_EGL)
+    if (dmabuf_capture) {
+        LOG(ERROR, "capturing to a dma-buf is only supported with EGL");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+#endif
+
+#if !defined(TARGET_ANDROID) || __ANDROID_API__ < 26
+    if (hardware_buffer_capture) {
+        LOG(ERROR, "capturing to a hardware buffer is only supported on Android API 26+");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+#endif
+
+#if !defined(HAVE_GLPLATFORM_WGL)
+    if (d3d11_capture) {
+        LOG(ERROR, "capturing to a D3D11 texture is only supported with WGL");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+#endif
+
     if (gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT) {
-        if (ios_capture) {
+        if (dmabuf_capture) {
+#if defined(HAVE_GLPLATFORM_EGL)
+            int ret = capture_dmabuf_init(s);
+            if (ret < 0)
+                return ret;
+#endif
+        } else if (hardware_buffer_capture) {
+#if defined(TARGET_ANDROID) && __ANDROID_API__ >= 26
+            int ret = capture_hardware_buffer_init(s);
+            if (ret < 0)
+                return ret;
+#endif
+        } else if (d3d11_capture) {
+#if defined(HAVE_GLPLATFORM_WGL)
+            int ret = capture_d3d11_init(s);
+            if (ret < 0)
+                return ret;
+#endif
+        } else if (ios_capture) {
 #if defined(TARGET_IPHONE)
             CVPixelBufferRef capture_cvbuffer = (CVPixelBufferRef)config->window;
             s->capture_cvbuffer = (CVPixelBufferRef)CFRetain(capture_cvbuffer);
@@ -186,10 +814,10 @@ static int capture_init(struct ngl_ctx *s)
             }
 
             GLuint id = CVOpenGLESTextureGetName(s->capture_cvtexture);
-            ngli_glBindTexture(gl, GL_TEXTURE_2D, id);
+            ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, id);
             ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            ngli_glBindTexture(gl, GL_TEXTURE_2D, 0);
+            ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
 
             struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
             attachment_params.format = NGLI_FORMAT_B8G8R8A8_UNORM;
@@ -198,13 +826,23 @@ static int capture_init(struct ngl_ctx *s)
             int ret = ngli_texture_wrap(&s->capture_rt_color, s, &attachment_params, id);
             if (ret < 0)
                 return ret;
+#elif defined(TARGET_DARWIN)
+            int ret = capture_iosurface_init(s);
+            if (ret < 0)
+                return ret;
 #endif
         } else {
+            /* The frame is sampled by the conversion, which filters the chroma */
             struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
             attachment_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
-            attachment_params.width = config->width;
-            attachment_params.height = config->height;
-            attachment_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+            attachment_params.width = capture_width;
+            attachment_params.height = capture_height;
+            if (convert) {
+                attachment_params.min_filter = NGLI_FILTER_LINEAR;
+                attachment_params.mag_filter = NGLI_FILTER_LINEAR;
+            } else {
+                attachment_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+            }
             int ret = ngli_texture_init(&s->capture_rt_color, s, &attachment_params);
             if (ret < 0)
                 return ret;
@@ -214,16 +852,39 @@ static int capture_init(struct ngl_ctx *s)
         const int nb_attachments = NGLI_ARRAY_NB(attachments);
 
         struct rendertarget_params rt_params = {
-            .width = config->width,
-            .height = config->height,
+            .width = capture_width,
+            .height = capture_height,
             .nb_attachments = nb_attachments,
             .attachments = attachments,
         };
+#if defined(HAVE_GLPLATFORM_WGL)
+        /* The interop texture is only accessible to GL while locked */
+        if (s->capture_dx_object &&
+            !ngli_wglDXLockObjectsNV(gl, s->capture_dx_device, 1, &s->capture_dx_object)) {
+            LOG(ERROR, "could not lock the capture D3D11 texture (%lu)", GetLastError());
+            return NGL_ERROR_EXTERNAL;
+        }
+#endif
         int ret = ngli_rendertarget_init(&s->capture_rt, s, &rt_params);
+#if defined(HAVE_GLPLATFORM_WGL)
+        if (s->capture_dx_object)
+            ngli_wglDXUnlockObjectsNV(gl, s->capture_dx_device, 1, &s->capture_dx_object);
+#endif
         if (ret < 0)
             return ret;
 
-        if (gl->backend == NGL_BACKEND_OPENGLES && config->samples > 0) {
+        if (convert) {
+            s->capture_conv = ngli_calloc(1, sizeof(*s->capture_conv));
+            if (!s->capture_conv)
+                return NGL_ERROR_MEMORY;
+            ret = ngli_captureconv_init(s->capture_conv, s, &s->capture_rt_color, config->capture_format);
+            if (ret < 0)
+                return ret;
+        }
+
+        /* A multisample buffer must be resolved at the same size and
+         * orientation before being flipped into the capture target */
+        if (gl->backend == NGL_BACKEND_OPENGLES && config->samples > 0 && !has_implicit_msaa(s)) {
             struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
             attachment_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
             attachment_params.width = config->width;
@@ -246,9 +907,25 @@ static int capture_init(struct ngl_ctx *s)
             if (ret < 0)
                 return ret;
 
-            s->capture_func = config->capture_buffer ? capture_gles_msaa : capture_ios_msaa;
+            if (config->capture_callback)
+                s->capture_func = capture_async_gles_msaa;
+            else
+                s->capture_func = config->capture_buffer ? capture_gles_msaa : capture_zero_copy_msaa;
         } else {
-            s->capture_func = config->capture_buffer ? capture_default : capture_ios;
+            if (config->capture_callback)
+                s->capture_func = capture_async;
+            else
+                s->capture_func = config->capture_buffer ? capture_default : capture_zero_copy;
+#if defined(HAVE_GLPLATFORM_WGL)
+            if (s->capture_dx_object)
+                s->capture_func = capture_d3d11;
+#endif
+        }
+
+        if (config->capture_callback) {
+            int ret = capture_async_init(s);
+            if (ret < 0)
+                return ret;
         }
 
     } else {
@@ -257,6 +934,31 @@ static int capture_init(struct ngl_ctx *s)
                 "capturing to a CVPixelBuffer is not supported");
             return NGL_ERROR_UNSUPPORTED;
         }
+        if (dmabuf_capture) {
+            LOG(ERROR, "context does not support the framebuffer object feature, "
+                "capturing to a dma-buf is not supported");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (hardware_buffer_capture) {
+            LOG(ERROR, "context does not support the framebuffer object feature, "
+                "capturing to a hardware buffer is not supported");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (d3d11_capture) {
+            LOG(ERROR, "context does not support the framebuffer object feature, "
+                "capturing to a D3D11 texture is not supported");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (config->capture_callback) {
+            LOG(ERROR, "context does not support the framebuffer object feature, "
+                "asynchronous capture is not supported");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (convert || scale) {
+            LOG(ERROR, "context does not support the framebuffer object feature, "
+                "the capture format and dimensions are not supported");
+            return NGL_ERROR_UNSUPPORTED;
+        }
         s->capture_buffer = ngli_calloc(config->width * config->height, 4 /* RGBA */);
         if (!s->capture_buffer)
             return NGL_ERROR_MEMORY;
@@ -271,21 +973,46 @@ static int capture_init(struct ngl_ctx *s)
 
 static void capture_reset(struct ngl_ctx *s)
 {
+    capture_async_reset(s);
+    if (s->capture_conv) {
+        ngli_captureconv_reset(s->capture_conv);
+        ngli_free(s->capture_conv);
+        s->capture_conv = NULL;
+    }
+    s->capture_size = 0;
     ngli_rendertarget_reset(&s->capture_rt);
     ngli_texture_reset(&s->capture_rt_color);
     ngli_rendertarget_reset(&s->oes_resolve_rt);
     ngli_texture_reset(&s->oes_resolve_rt_color);
     ngli_free(s->capture_buffer);
     s->capture_buffer = NULL;
+#if defined(HAVE_GLPLATFORM_EGL)
+    capture_egl_image_reset(s);
+#endif
+#if defined(HAVE_GLPLATFORM_WGL)
+    capture_d3d11_reset(s);
+#endif
 #if defined(TARGET_IPHONE)
     if (s->capture_cvbuffer) {
         CFRelease(s->capture_cvbuffer);
         s->capture_cvbuffer = NULL;
     }
     if (s->capture_cvtexture) {
+        GLuint id = CVOpenGLESTextureGetName(s->capture_cvtexture);
+        ngli_glstate_forget_texture(s->glcontext, id);
         CFRelease(s->capture_cvtexture);
         s->capture_cvtexture = NULL;
     }
+#elif defined(TARGET_DARWIN)
+    if (s->capture_iosurface_texture) {
+        ngli_glstate_forget_texture(s->glcontext, s->capture_iosurface_texture);
+        ngli_glDeleteTextures(s->glcontext, 1, &s->capture_iosurface_texture);
+        s->capture_iosurface_texture = 0;
+    }
+    if (s->capture_cvbuffer) {
+        CFRelease(s->capture_cvbuffer);
+        s->capture_cvbuffer = NULL;
+    }
 #endif
     s->capture_func = NULL;
 }
@@ -295,6 +1022,17 @@ static int gl_reconfigure(struct ngl_ctx *s, const struct ngl_config *config)
     struct glcontext *gl = s->glcontext;
     struct ngl_config *current_config = &s->config;
 
+    /* Checked first so nothing is changed if the switch is not supported */
+    if (current_config->window != config->window) {
+        int ret = ngli_glcontext_set_window(gl, config->window);
+        if (ret < 0)
+            return ret;
+        current_config->window = config->window;
+    }
+
+    /* Deliver the pending frames before the capture configuration changes */
+    capture_async_flush(s);
+
     ngli_glcontext_set_swap_interval(gl, config->swap_interval);
     current_config->swap_interval = config->swap_interval;
 
@@ -305,18 +1043,71 @@ static int gl_reconfigure(struct ngl_ctx *s, const struct ngl_config *config)
     current_config->width = config->width;
     current_config->height = config->height;
 
-    const int update_capture = !current_config->capture_buffer != !config->capture_buffer;
+    const int update_samples = current_config->samples != config->samples;
+    current_config->samples = config->samples;
+
+    const int update_renderscale = current_config->target_frame_time != config->target_frame_time;
+    current_config->target_frame_time = config->target_frame_time;
+    current_config->release_delay = config->release_delay;
+    current_config->release_memory_limit = config->release_memory_limit;
+    current_config->decoder_pool_size = config->decoder_pool_size;
+    current_config->gpu_memory_budget = config->gpu_memory_budget;
+    current_config->prefetch_upload_budget = config->prefetch_upload_budget;
+    current_config->nb_update_threads = config->nb_update_threads;
+    current_config->pipelined_updates = config->pipelined_updates;
+    current_config->thread_priority = config->thread_priority;
+    current_config->thread_affinity = config->thread_affinity;
+    current_config->skip_idle_frames = config->skip_idle_frames;
+    current_config->damage_tracking = config->damage_tracking;
+    current_config->debug = config->debug;
+    ngli_glcontext_set_debug(gl, config->debug);
+    if (update_renderscale)
+        renderscale_init(s);
+
+    const int update_capture = !current_config->capture_buffer != !config->capture_buffer ||
+                               !current_config->capture_callback != !config->capture_callback ||
+                               current_config->capture_format != config->capture_format ||
+                               current_config->capture_width != config->capture_width ||
+                               current_config->capture_height != config->capture_height;
     current_config->capture_buffer = config->capture_buffer;
+    current_config->capture_callback = config->capture_callback;
+    current_config->capture_user_arg = config->capture_user_arg;
+    current_config->capture_format = config->capture_format;
+    current_config->capture_width = config->capture_width;
+    current_config->capture_height = config->capture_height;
+
+    /* The dma-buf is imported again since only its description is known */
+    const int update_dmabuf = current_config->capture_dmabuf || config->capture_dmabuf;
+    current_config->capture_dmabuf = config->capture_dmabuf;
+
+    const int update_hardware_buffer = current_config->capture_hardware_buffer != config->capture_hardware_buffer;
+    current_config->capture_hardware_buffer = config->capture_hardware_buffer;
+
+    const int update_d3d11_texture = current_config->capture_d3d11_texture != config->capture_d3d11_texture;
+    current_config->capture_d3d11_texture = config->capture_d3d11_texture;
+
+    memcpy(current_config->viewport, config->viewport, sizeof(config->viewport));
+
+    if (config->offscreen && !same_outputs(s, config)) {
+        outputs_reset(s);
+        int ret = outputs_init(s, config);
+        if (ret < 0)
+            return ret;
+    }
 
     if (config->offscreen) {
-        if (update_dimensions) {
+        if (update_dimensions || update_samples || update_renderscale) {
+            /* The default viewport follows the offscreen dimensions */
+            gl->width = config->width;
+            gl->height = config->height;
             offscreen_rendertarget_reset(s);
             int ret = offscreen_rendertarget_init(s);
             if (ret < 0)
                 return ret;
         }
 
-        if (update_dimensions || update_capture) {
+        if (update_dimensions || update_samples || update_capture || update_dmabuf || update_hardware_buffer ||
+            update_d3d11_texture) {
             capture_reset(s);
             int ret = capture_init(s);
             if (ret < 0)
@@ -328,26 +1119,29 @@ static int gl_reconfigure(struct ngl_ctx *s, const struct ngl_config *config)
             return ret;
     }
 
-    const int *viewport = config->viewport;
-    if (viewport[2] > 0 && viewport[3] > 0) {
-        ngli_gctx_set_viewport(s, viewport);
-        memcpy(current_config->viewport, config->viewport, sizeof(config->viewport));
-    } else {
-        struct glcontext *gl = s->glcontext;
-        const int default_viewport[] = {0, 0, gl->width, gl->height};
-        ngli_gctx_set_viewport(s, default_viewport);
-    }
+    update_viewport(s);
 
     ngli_gctx_set_clear_color(s, config->clear_color);
     memcpy(current_config->clear_color, config->clear_color, sizeof(config->clear_color));
 
+    current_config->color_load_op = config->color_load_op;
+    current_config->depth_stencil_load_op = config->depth_stencil_load_op;
+    current_config->depth_stencil_store_op = config->depth_stencil_store_op;
+
     const int scissor[] = {0, 0, gl->width, gl->height};
-    struct graphicconfig *graphicconfig = &s->graphicconfig;
-    memcpy(graphicconfig->scissor, scissor, sizeof(scissor));
+    struct graphicconfig graphicconfig = s->graphicconfig;
+    memcpy(graphicconfig.scissor, scissor, sizeof(scissor));
+    ngli_glstate_set_pending(s, &graphicconfig, NULL);
 
     return 0;
 }
 
+static void release_pooled_texture(void *user_arg, const struct texturepool_key *key, GLuint id)
+{
+    struct ngl_ctx *s = user_arg;
+    ngli_texture_delete(s->glcontext, key->target, id);
+}
+
 static int gl_configure(struct ngl_ctx *s, const struct ngl_config *config)
 {
     memcpy(&s->config, config, sizeof(s->config));
@@ -356,43 +1150,70 @@ static int gl_configure(struct ngl_ctx *s, const struct ngl_config *config)
     if (!s->glcontext)
         return NGL_ERROR_MEMORY;
 
+    const int pool_size = config->texture_pool_size ? config->texture_pool_size : DEFAULT_TEXTURE_POOL_SIZE;
+    ngli_texturepool_init(&s->texture_pool, NGLI_MAX(pool_size, 0) * (1LL << 20), release_pooled_texture, s);
+    ngli_textureatlas_init(&s->texture_atlas, s);
+    ngli_samplercache_init(&s->sampler_cache, s->glcontext);
+
+    if (config->program_cache_dir) {
+        s->program_cache_dir = ngli_strdup(config->program_cache_dir);
+        if (!s->program_cache_dir)
+            return NGL_ERROR_MEMORY;
+    }
+    s->share_group = ngli_share_group_ref(config->share_group);
+
+    /* Let the driver pick the number of background compiler threads */
+    if (config->async_programs && (s->glcontext->features & NGLI_FEATURE_PARALLEL_SHADER_COMPILE))
+        ngli_glMaxShaderCompilerThreadsKHR(s->glcontext, 0xFFFFFFFF);
+
+    int ret = ngli_gputimer_init(&s->frame_timer, s->glcontext);
+    s->stats.gpu_time = ret < 0 ? -1 : 0;
+
+    renderscale_init(s);
+
     if (s->glcontext->offscreen) {
-        int ret = offscreen_rendertarget_init(s);
+        ret = offscreen_rendertarget_init(s);
         if (ret < 0)
             return ret;
 
         ret = capture_init(s);
         if (ret < 0)
             return ret;
+
+        ret = outputs_init(s, config);
+        if (ret < 0)
+            return ret;
     }
 
     ngli_glstate_probe(s->glcontext, &s->glstate);
 
-    /* This field is used by the pipeline API in order to reduce the total
-     * number of GL program switches. This means pipeline draw calls may alter
-     * this value, but we don't want it to be hard-reconfigure resilient (the
-     * value is specific to a given GL context). As a result, we need to make
-     * sure the value is always reset. */
-    s->program_id = 0;
+    /* The bindings cache is used to skip redundant GL binding calls. The
+     * context may be provided by the user (wrapped), in which case its
+     * current bindings are unknown, so we need to make sure the cache is
+     * always reset. */
+    ngli_glstate_reset_bindings(s->glcontext);
 
-    const int *viewport = config->viewport;
-    if (viewport[2] > 0 && viewport[3] > 0) {
-        ngli_gctx_set_viewport(s, viewport);
-    } else {
-        struct glcontext *gl = s->glcontext;
-        const int default_viewport[] = {0, 0, gl->width, gl->height};
-        ngli_gctx_set_viewport(s, default_viewport);
-    }
+    update_viewport(s);
 
     ngli_gctx_set_clear_color(s, config->clear_color);
 
-    struct graphicconfig *graphicconfig = &s->graphicconfig;
-    ngli_graphicconfig_init(graphicconfig);
+    /* The probed state is diffed against the configuration on the first draw */
+    struct graphicconfig graphicconfig;
+    ngli_graphicconfig_init(&graphicconfig);
     const GLint scissor[] = {0, 0, config->width, config->height};
-    memcpy(graphicconfig->scissor, scissor, sizeof(scissor));
+    memcpy(graphicconfig.scissor, scissor, sizeof(scissor));
+    ngli_glstate_set_pending(s, &graphicconfig, NULL);
+    s->glstate_gen = s->pending_glstate_gen = s->graphicconfig_gen - 1;
+
+    if (config->upload_thread) {
+        s->uploader = ngli_uploader_create(s);
+        if (!s->uploader)
+            LOG(WARNING, "could not create the upload thread, "
+                "the frames will be uploaded by the rendering thread");
+    }
 
 #if defined(HAVE_VAAPI_X11)
-    int ret = ngli_vaapi_init(s);
+    ret = ngli_vaapi_init(s);
     if (ret < 0)
         LOG(WARNING, "could not initialize vaapi");
 #endif
@@ -402,8 +1223,148 @@ static int gl_configure(struct ngl_ctx *s, const struct ngl_config *config)
 
 static int gl_pre_draw(struct ngl_ctx *s, double t)
 {
-    ngli_gctx_clear_color(s);
-    ngli_gctx_clear_depth_stencil(s);
+    const struct ngl_config *config = &s->config;
+
+    if (s->uniform_ring.ctx)
+        ngli_uniformring_begin_frame(&s->uniform_ring);
+
+    int rescale = 0;
+    int64_t gpu_time;
+    while (ngli_gputimer_read(&s->frame_timer, &gpu_time)) {
+        s->stats.gpu_time = gpu_time / 1000;
+        rescale |= ngli_renderscale_update(&s->renderscale, s->stats.gpu_time);
+    }
+
+    if (rescale) {
+        offscreen_rendertarget_reset(s);
+        int ret = offscreen_rendertarget_init(s);
+        if (ret < 0)
+            return ret;
+        LOG(DEBUG, "rendering resolution changed to %dx%d", s->rt.width, s->rt.height);
+        ngli_damage_invalidate(&s->damage);
+    }
+
+    /*
+     * The offscreen render target keeps the last frame drawn, while the
+     * window buffers are rotated by the swap. The scissor is enabled behind
+     * the back of the GL state tracking, which is fine as long as no
+     * GraphicConfig of the scene enables it (the frame is then fully damaged).
+     */
+    int region[4];
+    s->damage_scissor = 0;
+    if (config->damage_tracking && !rescale) {
+        const int age = s->glcontext->offscreen ? 1 : ngli_glcontext_get_buffer_age(s->glcontext);
+        s->damage_scissor = ngli_damage_get_region(&s->damage, age, region);
+    }
+    if (s->damage_scissor) {
+        ngli_glcontext_set_damage_region(s->glcontext, region);
+        ngli_glEnable(s->glcontext, GL_SCISSOR_TEST);
+        ngli_gctx_set_scissor(s, region);
+        ngli_gctx_load_attachments(s, NGLI_LOAD_OP_CLEAR, NGLI_LOAD_OP_CLEAR);
+    } else {
+        ngli_gctx_get_viewport(s, region);
+        ngli_gctx_load_attachments(s, config->color_load_op, config->depth_stencil_load_op);
+    }
+    memcpy(s->stats.redraw_region, region, sizeof(s->stats.redraw_region));
+    ngli_gputimer_begin(&s->frame_timer);
+
+    return 0;
+}
+
+static int gl_draw_outputs(struct ngl_ctx *s)
+{
+    if (!s->nb_outputs)
+        return 0;
+
+    const struct ngl_config *config = &s->config;
+
+    /* The pending draws target the main render target */
+    ngli_pass_flush_draw_list(s);
+
+    struct rendertarget *prev_rt = ngli_gctx_get_rendertarget(s);
+    int prev_vp[4] = {0};
+    ngli_gctx_get_viewport(s, prev_vp);
+
+    int viewport[4] = {0, 0, config->width, config->height};
+    if (config->viewport[2] > 0 && config->viewport[3] > 0)
+        memcpy(viewport, config->viewport, sizeof(viewport));
+
+    s->drawing_outputs = 1;
+    for (int i = 0; i < s->nb_outputs; i++) {
+        struct output *output = &s->outputs[i];
+        const int width = output->params.width;
+        const int height = output->params.height;
+
+        ngli_gctx_set_rendertarget(s, &output->rt);
+        const int output_vp[4] = {
+            viewport[0] * width  / config->width,
+            viewport[1] * height / config->height,
+            viewport[2] * width  / config->width,
+            viewport[3] * height / config->height,
+        };
+        ngli_gctx_set_viewport(s, output_vp);
+        ngli_gctx_load_attachments(s, NGLI_LOAD_OP_CLEAR, NGLI_LOAD_OP_CLEAR);
+
+        ngli_node_draw(s->scene);
+        ngli_pass_flush_draw_list(s);
+        ngli_honor_pending_glstate(s);
+        output_capture(s, output);
+    }
+    s->drawing_outputs = 0;
+
+    ngli_gctx_set_rendertarget(s, prev_rt);
+    ngli_gctx_set_viewport(s, prev_vp);
+
+    return 0;
+}
+
+static int gl_begin_batch(struct ngl_ctx *s, int width, int height, uint8_t *data)
+{
+    struct glcontext *gl = s->glcontext;
+
+    if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT)) {
+        LOG(ERROR, "context does not support the framebuffer object feature, "
+            "batch drawing is not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    struct output *batch = &s->batch;
+    memset(batch, 0, sizeof(*batch));
+    batch->params.width = width;
+    batch->params.height = height;
+    batch->params.capture_buffer = data;
+    int ret = output_init(s, batch);
+    if (ret < 0) {
+        output_reset(batch);
+        return ret;
+    }
+
+    s->batch_prev_rt = ngli_gctx_get_rendertarget(s);
+    ngli_gctx_get_viewport(s, s->batch_prev_vp);
+
+    /* The tiles are disjoint so the attachments are only cleared once */
+    ngli_gctx_set_rendertarget(s, &batch->rt);
+    const int viewport[4] = {0, 0, width, height};
+    ngli_gctx_set_viewport(s, viewport);
+    ngli_gctx_load_attachments(s, NGLI_LOAD_OP_CLEAR, NGLI_LOAD_OP_CLEAR);
+
+    return 0;
+}
+
+static int gl_end_batch(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct output *batch = &s->batch;
+
+    ngli_honor_pending_glstate(s);
+    output_capture(s, batch);
+
+    ngli_gctx_set_rendertarget(s, s->batch_prev_rt);
+    ngli_gctx_set_viewport(s, s->batch_prev_vp);
+    output_reset(batch);
+
+    if (s->config.debug && ngli_glcontext_check_gl_error(gl, __FUNCTION__))
+        return -1;
 
     return 0;
 }
@@ -415,38 +1376,161 @@ static int gl_post_draw(struct ngl_ctx *s, double t)
 
     ngli_honor_pending_glstate(s);
 
-    if (s->capture_func)
+    if (s->damage_scissor) {
+        const struct glstate *glstate = &s->glstate;
+        ngli_glDisable(gl, GL_SCISSOR_TEST);
+        ngli_gctx_set_scissor(s, glstate->scissor);
+        s->damage_scissor = 0;
+    }
+
+    ngli_gputimer_end(&s->frame_timer);
+
+    ngli_readback_submit(s);
+
+    if (s->capture_func) {
+        const int64_t capture_start = ngli_gettime();
+        NGLI_TRACEMARKER_BEGIN(capture, "ngl capture");
         s->capture_func(s);
+        NGLI_TRACEMARKER_END(capture);
+        s->stats.capture_time = ngli_gettime() - capture_start;
+    }
+
+    /* The multisample color buffer has been resolved by the capture and is
+     * not needed anymore unless the next frame loads it */
+    int color_store_op = NGLI_STORE_OP_STORE;
+    if (s->capture_func && config->samples > 0 && config->color_load_op != NGLI_LOAD_OP_LOAD &&
+        !config->damage_tracking)
+        color_store_op = NGLI_STORE_OP_DONT_CARE;
+    ngli_gctx_store_attachments(s, color_store_op, config->depth_stencil_store_op);
 
     int ret = 0;
-    if (ngli_glcontext_check_gl_error(gl, __FUNCTION__))
+    if (config->debug && ngli_glcontext_check_gl_error(gl, __FUNCTION__))
         ret = -1;
 
     if (config->set_surface_pts)
         ngli_glcontext_set_surface_pts(gl, t);
 
-    ngli_glcontext_swap_buffers(gl);
+    const int64_t swap_start = ngli_gettime();
+    if (config->damage_tracking)
+        ngli_glcontext_swap_buffers_with_damage(gl, s->damage.rect);
+    else
+        ngli_glcontext_swap_buffers(gl);
+    s->stats.swap_time = ngli_gettime() - swap_start;
 
     return ret;
 }
 
+static int gl_flush(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+
+    capture_async_flush(s);
+    ngli_readback_flush(s);
+
+    if (s->config.debug && ngli_glcontext_check_gl_error(gl, __FUNCTION__))
+        return -1;
+
+    return 0;
+}
+
 static void gl_destroy(struct ngl_ctx *s)
 {
+    ngli_readback_reset(s);
+    outputs_reset(s);
     capture_reset(s);
     offscreen_rendertarget_reset(s);
 #if defined(HAVE_VAAPI_X11)
     ngli_vaapi_reset(s);
 #endif
+    ngli_profiler_reset(&s->profiler);
+    ngli_gputimer_reset(&s->frame_timer);
+    ngli_textureatlas_reset(&s->texture_atlas);
+    ngli_pass_reset_framebuffer_copy(s);
+    ngli_texturepool_reset(&s->texture_pool);
+    ngli_imagecache_drop_privs(&s->image_cache);
+    ngli_samplercache_reset(&s->sampler_cache);
+    ngli_uniformring_reset(&s->uniform_ring);
+    ngli_free(s->program_cache_dir);
+    s->program_cache_dir = NULL;
+    ngli_share_group_unrefp(&s->share_group);
+    ngli_uploader_freep(&s->uploader);
     ngli_glcontext_freep(&s->glcontext);
 }
 
+static void gl_set_rendertarget(struct ngl_ctx *s, struct rendertarget *rt)
+{
+    struct glcontext *gl = s->glcontext;
+    const GLuint fbo_id = rt ? rt->id : ngli_glcontext_get_default_framebuffer(gl);
+    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+}
+
+static void gl_set_viewport(struct ngl_ctx *s, const int *viewport)
+{
+    struct glcontext *gl = s->glcontext;
+    ngli_glViewport(gl, viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+static void gl_set_scissor(struct ngl_ctx *s, const int *scissor)
+{
+    struct glcontext *gl = s->glcontext;
+    ngli_glScissor(gl, scissor[0], scissor[1], scissor[2], scissor[3]);
+}
+
+static void gl_set_clear_color(struct ngl_ctx *s, const float *color)
+{
+    struct glcontext *gl = s->glcontext;
+    ngli_glClearColor(gl, color[0], color[1], color[2], color[3]);
+}
+
+static void gl_clear(struct ngl_ctx *s, int color, int depth_stencil)
+{
+    struct glcontext *gl = s->glcontext;
+    GLbitfield flags = 0;
+    if (color)
+        flags |= GL_COLOR_BUFFER_BIT;
+    if (depth_stencil)
+        flags |= GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+    ngli_glClear(gl, flags);
+}
+
+static void gl_invalidate(struct ngl_ctx *s, int color, int depth_stencil)
+{
+    struct glcontext *gl = s->glcontext;
+    struct rendertarget *rt = s->rendertarget;
+
+    if (rt) {
+        ngli_rendertarget_invalidate(rt, color, depth_stencil);
+        return;
+    }
+
+    if (!(gl->features & NGLI_FEATURE_INVALIDATE_SUBDATA))
+        return;
+
+    /* The default framebuffer uses its own attachment names */
+    static const GLenum attachments[] = {GL_COLOR, GL_DEPTH, GL_STENCIL};
+    const int start = color ? 0 : 1;
+    const int end = depth_stencil ? NGLI_ARRAY_NB(attachments) : 1;
+    ngli_glInvalidateFramebuffer(gl, GL_FRAMEBUFFER, end - start, attachments + start);
+}
+
 const struct backend ngli_backend_gl = {
     .name         = "OpenGL",
     .reconfigure  = gl_reconfigure,
     .configure    = gl_configure,
     .pre_draw     = gl_pre_draw,
+    .draw_outputs = gl_draw_outputs,
     .post_draw    = gl_post_draw,
+    .begin_batch  = gl_begin_batch,
+    .end_batch    = gl_end_batch,
+    .flush        = gl_flush,
     .destroy      = gl_destroy,
+
+    .set_rendertarget = gl_set_rendertarget,
+    .set_viewport     = gl_set_viewport,
+    .set_scissor      = gl_set_scissor,
+    .set_clear_color  = gl_set_clear_color,
+    .clear            = gl_clear,
+    .invalidate       = gl_invalidate,
 };
 
 const struct backend ngli_backend_gles = {
@@ -454,6 +1538,17 @@ const struct backend ngli_backend_gles = {
     .reconfigure  = gl_reconfigure,
     .configure    = gl_configure,
     .pre_draw     = gl_pre_draw,
+    .draw_outputs = gl_draw_outputs,
     .post_draw    = gl_post_draw,
+    .begin_batch  = gl_begin_batch,
+    .end_batch    = gl_end_batch,
+    .flush        = gl_flush,
     .destroy      = gl_destroy,
+
+    .set_rendertarget = gl_set_rendertarget,
+    .set_viewport     = gl_set_viewport,
+    .set_scissor      = gl_set_scissor,
+    .set_clear_color  = gl_set_clear_color,
+    .clear            = gl_clear,
+    .invalidate       = gl_invalidate,
 };
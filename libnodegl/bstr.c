@@ -19,11 +19,15 @@
  * under the License.
  */
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "bstr.h"
 #include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
 
 #define INITIAL_SIZE 1024
 
@@ -49,6 +53,24 @@ struct bstr *ngli_bstr_create(void)
     return b;
 }
 
+/* The buffer grows geometrically so appending stays linear overall */
+static int reserve(struct bstr *b, int len)
+{
+    const int avail = b->bufsize - b->len - 1;
+    if (len <= avail)
+        return 0;
+    if (len > INT_MAX - 1 - b->len)
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    const int grown_size = b->bufsize > INT_MAX / 2 ? INT_MAX : b->bufsize * 2;
+    const int new_size = NGLI_MAX(grown_size, b->len + len + 1);
+    void *ptr = ngli_realloc(b->str, new_size);
+    if (!ptr)
+        return NGL_ERROR_MEMORY;
+    b->str = ptr;
+    b->bufsize = new_size;
+    return 0;
+}
+
 int ngli_bstr_print(struct bstr *b, const char *fmt, ...)
 {
     va_list va;
@@ -60,15 +82,9 @@ int ngli_bstr_print(struct bstr *b, const char *fmt, ...)
     if (len < 0)
         return len;
 
-    const int avail = b->bufsize - b->len - 1;
-    if (len > avail) {
-        const int new_size = b->len + len + 1;
-        void *ptr = ngli_realloc(b->str, new_size);
-        if (!ptr)
-            return 0;
-        b->str = ptr;
-        b->bufsize = new_size;
-    }
+    int ret = reserve(b, len);
+    if (ret < 0)
+        return ret;
 
     va_start(va, fmt);
     len = vsnprintf(b->str + b->len, len + 1, fmt, va);
@@ -82,6 +98,17 @@ int ngli_bstr_print(struct bstr *b, const char *fmt, ...)
     return 0;
 }
 
+int ngli_bstr_append(struct bstr *b, const char *str, int len)
+{
+    int ret = reserve(b, len);
+    if (ret < 0)
+        return ret;
+    memcpy(b->str + b->len, str, len);
+    b->len += len;
+    b->str[b->len] = 0;
+    return 0;
+}
+
 void ngli_bstr_clear(struct bstr *b)
 {
     b->len = 0;
@@ -30,6 +30,7 @@ struct bstr;
 
 struct bstr *ngli_bstr_create(void);
 int ngli_bstr_print(struct bstr *b, const char *fmt, ...) ngli_printf_format(2, 3);
+int ngli_bstr_append(struct bstr *b, const char *str, int len);
 void ngli_bstr_clear(struct bstr *b);
 char *ngli_bstr_strdup(struct bstr *b);
 char *ngli_bstr_strptr(struct bstr *b);
@@ -24,18 +24,56 @@
 #include "buffer.h"
 #include "glcontext.h"
 #include "glincludes.h"
+#include "log.h"
 #include "nodes.h"
+#include "utils.h"
 
 static const GLenum gl_usage_map[NGLI_BUFFER_USAGE_NB] = {
     [NGLI_BUFFER_USAGE_STATIC]  = GL_STATIC_DRAW,
     [NGLI_BUFFER_USAGE_DYNAMIC] = GL_DYNAMIC_DRAW,
+    [NGLI_BUFFER_USAGE_STREAM]  = GL_STREAM_DRAW,
 };
 
+#define FEATURES_PERSISTENT (NGLI_FEATURE_BUFFER_STORAGE | NGLI_FEATURE_MAP_BUFFER_RANGE | NGLI_FEATURE_SYNC)
+
 static GLenum get_gl_usage(int usage)
 {
     return gl_usage_map[usage];
 }
 
+static int get_region_alignment(const struct glcontext *gl)
+{
+    /* The regions must be usable as attributes, uniform and storage blocks */
+    return NGLI_MAX(NGLI_MAX(gl->uniform_buffer_offset_alignment,
+                             gl->storage_buffer_offset_alignment), 16);
+}
+
+static int persistent_init(struct buffer *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    const int alignment = get_region_alignment(gl);
+    s->region_size = (s->size + alignment - 1) / alignment * alignment;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const int total_size = s->region_size * NGLI_BUFFER_NB_REGIONS;
+    ngli_glBufferStorage(gl, GL_ARRAY_BUFFER, total_size, NULL, flags);
+    s->mapped_data = ngli_glMapBufferRange(gl, GL_ARRAY_BUFFER, 0, total_size, flags);
+    if (!s->mapped_data) {
+        LOG(ERROR, "could not map buffer persistently");
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    s->persistent = 1;
+    return 0;
+}
+
+static int64_t get_storage_size(const struct buffer *s)
+{
+    return s->region_size ? (int64_t)s->region_size * NGLI_BUFFER_NB_REGIONS : s->size;
+}
+
 int ngli_buffer_init(struct buffer *s, struct ngl_ctx *ctx, int size, int usage)
 {
     s->ctx = ctx;
@@ -43,26 +81,135 @@ int ngli_buffer_init(struct buffer *s, struct ngl_ctx *ctx, int size, int usage)
     s->usage = usage;
     struct glcontext *gl = ctx->glcontext;
     ngli_glGenBuffers(gl, 1, &s->id);
-    ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, s->id);
-    ngli_glBufferData(gl, GL_ARRAY_BUFFER, size, NULL, get_gl_usage(usage));
-    return 0;
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+    int ret = 0;
+    if (usage == NGLI_BUFFER_USAGE_DYNAMIC && size > 0 &&
+        (gl->features & FEATURES_PERSISTENT) == FEATURES_PERSISTENT)
+        ret = persistent_init(s);
+    else
+        ngli_glBufferData(gl, GL_ARRAY_BUFFER, size, NULL, get_gl_usage(usage));
+    ctx->stats.memory[NGL_STATS_MEMORY_BUFFERS] += get_storage_size(s);
+    return ret;
+}
+
+/*
+ * The fence of a region is inserted when switching to the next one, so it
+ * guards all the commands issued while the region was the current one.
+ */
+static uint8_t *persistent_next_region(struct buffer *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    s->fences[s->region] = ngli_glFenceSync(gl, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s->region = (s->region + 1) % NGLI_BUFFER_NB_REGIONS;
+    s->offset = s->region * s->region_size;
+
+    GLsync fence = s->fences[s->region];
+    if (fence) {
+        const GLuint64 timeout = 1000000000; /* 1 second */
+        while (ngli_glClientWaitSync(gl, fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED)
+            LOG(WARNING, "buffer region is still in use after 1 second");
+        ngli_glDeleteSync(gl, fence);
+        s->fences[s->region] = NULL;
+    }
+
+    return s->mapped_data + s->offset;
 }
 
 int ngli_buffer_upload(struct buffer *s, const void *data, int size)
 {
     struct ngl_ctx *ctx = s->ctx;
     struct glcontext *gl = ctx->glcontext;
-    ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, s->id);
+
+    ctx->stats.uploaded_bytes += size;
+
+    if (s->persistent) {
+        memcpy(persistent_next_region(s), data, size);
+        return 0;
+    }
+
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+    /* Orphan the previous storage so the upload does not wait for the draws using it */
+    if (s->usage == NGLI_BUFFER_USAGE_DYNAMIC && size == s->size)
+        ngli_glBufferData(gl, GL_ARRAY_BUFFER, size, NULL, get_gl_usage(s->usage));
     ngli_glBufferSubData(gl, GL_ARRAY_BUFFER, 0, size, data);
     return 0;
 }
 
+uint8_t *ngli_buffer_renew(struct buffer *s)
+{
+    if (s->persistent)
+        return persistent_next_region(s);
+
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+    ngli_glBufferData(gl, GL_ARRAY_BUFFER, s->size, NULL, get_gl_usage(s->usage));
+    return NULL;
+}
+
+int ngli_buffer_upload_range(struct buffer *s, const void *data, int offset, int size)
+{
+    /* A new region needs the whole content */
+    if (s->persistent || (offset == 0 && size == s->size))
+        return ngli_buffer_upload(s, data, s->size);
+
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    ctx->stats.uploaded_bytes += size;
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+    ngli_glBufferSubData(gl, GL_ARRAY_BUFFER, offset, size, (const uint8_t *)data + offset);
+    return 0;
+}
+
+int ngli_buffer_upload_at(struct buffer *s, const void *data, int offset, int size)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    ngli_assert(!s->persistent);
+    ctx->stats.uploaded_bytes += size;
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+    ngli_glBufferSubData(gl, GL_ARRAY_BUFFER, offset, size, data);
+    return 0;
+}
+
+int ngli_buffer_download(struct buffer *s, void *data, int size)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    ngli_assert(!s->persistent);
+    if (!(gl->features & NGLI_FEATURE_MAP_BUFFER_RANGE))
+        return NGL_ERROR_UNSUPPORTED;
+
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+    const void *src = ngli_glMapBufferRange(gl, GL_ARRAY_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (!src) {
+        LOG(ERROR, "could not map buffer for reading");
+        return NGL_ERROR_EXTERNAL;
+    }
+    memcpy(data, src, size);
+    ngli_glUnmapBuffer(gl, GL_ARRAY_BUFFER);
+    return 0;
+}
+
 void ngli_buffer_reset(struct buffer *s)
 {
     struct ngl_ctx *ctx = s->ctx;
     if (!ctx)
         return;
     struct glcontext *gl = ctx->glcontext;
+    for (int i = 0; i < NGLI_BUFFER_NB_REGIONS; i++)
+        if (s->fences[i])
+            ngli_glDeleteSync(gl, s->fences[i]);
+    if (s->mapped_data) {
+        ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->id);
+        ngli_glUnmapBuffer(gl, GL_ARRAY_BUFFER);
+    }
+    ngli_glstate_forget_buffer(gl, s->id);
     ngli_glDeleteBuffers(gl, 1, &s->id);
+    ctx->stats.memory[NGL_STATS_MEMORY_BUFFERS] -= get_storage_size(s);
     memset(s, 0, sizeof(*s));
 }
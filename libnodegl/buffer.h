@@ -22,23 +22,64 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
+#include <stdint.h>
+
 #include "glincludes.h"
 
 enum {
-    NGLI_BUFFER_USAGE_STATIC,
-    NGLI_BUFFER_USAGE_DYNAMIC,
+    NGLI_BUFFER_USAGE_STATIC,   /* uploaded once */
+    NGLI_BUFFER_USAGE_DYNAMIC,  /* uploaded at most once per frame, used by many draws */
+    NGLI_BUFFER_USAGE_STREAM,   /* uploaded before every draw using it */
     NGLI_BUFFER_USAGE_NB
 };
 
+#define NGLI_BUFFER_NB_REGIONS 3
+
 struct buffer {
     struct ngl_ctx *ctx;
     int size;
     int usage;
     GLuint id;
+
+    /*
+     * When supported, dynamic buffers are persistently mapped and split into
+     * regions used in turn: offset is the position of the current region,
+     * to be honored by every user of the buffer.
+     */
+    int offset;
+    int persistent;
+    int region;
+    int region_size;
+    uint8_t *mapped_data;
+    GLsync fences[NGLI_BUFFER_NB_REGIONS];
 };
 
 int ngli_buffer_init(struct buffer *s, struct ngl_ctx *ctx, int size, int usage);
 int ngli_buffer_upload(struct buffer *s, const void *data, int size);
+
+/*
+ * Upload the whole content of the buffer, knowing only the bytes in the
+ * [offset, offset + size) range changed since the previous upload.
+ */
+int ngli_buffer_upload_range(struct buffer *s, const void *data, int offset, int size);
+/*
+ * Overwrite the [offset, offset + size) range of the current storage of a
+ * non persistent buffer with data, which only holds that range
+ */
+int ngli_buffer_upload_at(struct buffer *s, const void *data, int offset, int size);
+/*
+ * Switch to a storage the GPU is not using anymore, with an undefined
+ * content: the next region of a persistently mapped buffer, whose mapped
+ * data is returned, or a new storage (orphaning the previous one) for the
+ * other buffers, in which case NULL is returned.
+ */
+uint8_t *ngli_buffer_renew(struct buffer *s);
+
+/*
+ * Read back the content of a non persistent buffer, waiting for the GPU to
+ * complete the commands writing into it
+ */
+int ngli_buffer_download(struct buffer *s, void *data, int size);
 void ngli_buffer_reset(struct buffer *s);
 
 #endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "captureconv.h"
+#include "gctx.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "topology.h"
+#include "utils.h"
+
+#define VERTEX_DATA                                                              \
+    "#version 100"                                                          "\n" \
+    "precision highp float;"                                                "\n" \
+    "attribute vec4 position;"                                              "\n" \
+    "void main()"                                                           "\n" \
+    "{"                                                                     "\n" \
+    "    gl_Position = vec4(position.xy, 0.0, 1.0);"                        "\n" \
+    "}"
+
+/*
+ * Every row of the destination holds one row of bytes of the final buffer:
+ * the height rows of the Y plane are followed by height / 2 rows of the
+ * chroma planes (2 rows of U or V samples per row for I420). The chroma
+ * samples are the bilinear average of their 2x2 pixel block.
+ */
+#define FRAGMENT_DATA                                                            \
+    "#version 100"                                                          "\n" \
+    "precision highp float;"                                                "\n" \
+    "uniform sampler2D tex0;"                                               "\n" \
+    "#define W %d.0"                                                        "\n" \
+    "#define H %d.0"                                                        "\n" \
+    "#define FORMAT %d"                                                     "\n" \
+    "#define NV12 %d"                                                       "\n" \
+    "#define I420 %d"                                                       "\n" \
+    "#define P010 %d"                                                       "\n" \
+    "const vec3 luma = vec3(0.2126, 0.7152, 0.0722);"                       "\n" \
+    "float get_y(float x, float y)"                                         "\n" \
+    "{"                                                                     "\n" \
+    "    vec3 c = texture2D(tex0, vec2(x + 0.5, y + 0.5) / vec2(W, H)).rgb;" "\n" \
+    "    return 16.0 + 219.0 * dot(c, luma);"                               "\n" \
+    "}"                                                                     "\n" \
+    "vec2 get_uv(float x, float y)"                                         "\n" \
+    "{"                                                                     "\n" \
+    "    vec3 c = texture2D(tex0, vec2(2.0 * x + 1.0, 2.0 * y + 1.0) / vec2(W, H)).rgb;" "\n" \
+    "    float l = dot(c, luma);"                                           "\n" \
+    "    return 128.0 + 224.0 * vec2((c.b - l) / 1.8556, (c.r - l) / 1.5748);" "\n" \
+    "}"                                                                     "\n" \
+    "float get_nv12(float x, float r)"                                      "\n" \
+    "{"                                                                     "\n" \
+    "    if (r < H)"                                                        "\n" \
+    "        return get_y(x, r);"                                           "\n" \
+    "    vec2 uv = get_uv(floor(x / 2.0), r - H);"                          "\n" \
+    "    return mod(x, 2.0) < 0.5 ? uv.x : uv.y;"                           "\n" \
+    "}"                                                                     "\n" \
+    "float get_byte(float x, float r)"                                      "\n" \
+    "{"                                                                     "\n" \
+    "#if FORMAT == P010"                                                    "\n" \
+    "    float s = floor(x / 2.0);"                                         "\n" \
+    "    float v = floor(clamp(get_nv12(s, r), 0.0, 255.0) * 4.0 + 0.5) * 64.0;" "\n" \
+    "    float hi = floor(v / 256.0);"                                      "\n" \
+    "    return x - 2.0 * s < 0.5 ? v - hi * 256.0 : hi;"                   "\n" \
+    "#elif FORMAT == I420"                                                  "\n" \
+    "    if (r < H)"                                                        "\n" \
+    "        return get_y(x, r);"                                           "\n" \
+    "    float i = r - H;"                                                  "\n" \
+    "    float plane = i < H / 4.0 ? 0.0 : 1.0;"                            "\n" \
+    "    i -= plane * H / 4.0;"                                             "\n" \
+    "    float half_row = x < W / 2.0 ? 0.0 : 1.0;"                         "\n" \
+    "    vec2 uv = get_uv(x - half_row * W / 2.0, 2.0 * i + half_row);"     "\n" \
+    "    return plane < 0.5 ? uv.x : uv.y;"                                 "\n" \
+    "#else"                                                                 "\n" \
+    "    return get_nv12(x, r);"                                            "\n" \
+    "#endif"                                                                "\n" \
+    "}"                                                                     "\n" \
+    "void main(void)"                                                       "\n" \
+    "{"                                                                     "\n" \
+    "    float r = floor(gl_FragCoord.y);"                                  "\n" \
+    "    float x = floor(gl_FragCoord.x) * 4.0;"                            "\n" \
+    "    vec4 bytes = vec4(get_byte(x, r), get_byte(x + 1.0, r),"           "\n" \
+    "                      get_byte(x + 2.0, r), get_byte(x + 3.0, r));"    "\n" \
+    "    gl_FragColor = floor(clamp(bytes, 0.0, 255.0) + 0.5) / 255.0;"     "\n" \
+    "}"
+
+int ngli_captureconv_get_buffer_size(int format, int width, int height)
+{
+    switch (format) {
+    case NGL_CAPTURE_FORMAT_NV12:
+    case NGL_CAPTURE_FORMAT_I420: return width * height * 3 / 2;
+    case NGL_CAPTURE_FORMAT_P010: return width * height * 3;
+    default:                      return width * height * 4;
+    }
+}
+
+int ngli_captureconv_init(struct captureconv *s, struct ngl_ctx *ctx,
+                          struct texture *src_texture, int format)
+{
+    s->ctx = ctx;
+
+    const int width = src_texture->params.width;
+    const int height = src_texture->params.height;
+    if (width % 4 || height % 4) {
+        LOG(ERROR, "YUV captures require dimensions multiple of 4 (%dx%d)", width, height);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    /* Each RGBA texel packs 4 consecutive bytes of a row */
+    const int row_size = format == NGL_CAPTURE_FORMAT_P010 ? width * 2 : width;
+    struct texture_params color_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    color_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    color_params.width = row_size / 4;
+    color_params.height = height * 3 / 2;
+    color_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+    int ret = ngli_texture_init(&s->color, ctx, &color_params);
+    if (ret < 0)
+        return ret;
+
+    const struct texture *attachments[] = {&s->color};
+    struct rendertarget_params rt_params = {
+        .width = color_params.width,
+        .height = color_params.height,
+        .nb_attachments = NGLI_ARRAY_NB(attachments),
+        .attachments = attachments,
+    };
+    ret = ngli_rendertarget_init(&s->rt, ctx, &rt_params);
+    if (ret < 0)
+        return ret;
+
+    char *fragment_data = ngli_asprintf(FRAGMENT_DATA, width, height, format,
+                                        NGL_CAPTURE_FORMAT_NV12,
+                                        NGL_CAPTURE_FORMAT_I420,
+                                        NGL_CAPTURE_FORMAT_P010);
+    if (!fragment_data)
+        return NGL_ERROR_MEMORY;
+
+    ret = ngli_program_init(&s->program, ctx, VERTEX_DATA, fragment_data, NULL);
+    ngli_free(fragment_data);
+    if (ret < 0)
+        return ret;
+
+    static const float vertices[] = {
+        -1.0f, -1.0f, 0.0f, 0.0f,
+         1.0f, -1.0f, 1.0f, 0.0f,
+         1.0f,  1.0f, 1.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f, 1.0f,
+    };
+    ret = ngli_buffer_init(&s->vertices, ctx, sizeof(vertices), NGLI_BUFFER_USAGE_STATIC);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_buffer_upload(&s->vertices, vertices, sizeof(vertices));
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_texture textures[] = {
+        {.name = "tex0", .texture = src_texture},
+    };
+
+    const struct pipeline_attribute attributes[] = {
+        {.name = "position", .format = NGLI_FORMAT_R32G32B32A32_SFLOAT, .stride = 4 * 4, .buffer = &s->vertices},
+    };
+
+    struct pipeline_params pipeline_params = {
+        .type          = NGLI_PIPELINE_TYPE_GRAPHICS,
+        .program       = &s->program,
+        .textures      = textures,
+        .nb_textures   = NGLI_ARRAY_NB(textures),
+        .attributes    = attributes,
+        .nb_attributes = NGLI_ARRAY_NB(attributes),
+        .graphics      = {
+            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN,
+            .nb_vertices = 4,
+        },
+    };
+
+    return ngli_pipeline_init(&s->pipeline, ctx, &pipeline_params);
+}
+
+void ngli_captureconv_convert(struct captureconv *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+
+    struct rendertarget *rt = &s->rt;
+    struct rendertarget *prev_rt = ngli_gctx_get_rendertarget(ctx);
+    ngli_gctx_set_rendertarget(ctx, rt);
+
+    int prev_vp[4] = {0};
+    ngli_gctx_get_viewport(ctx, prev_vp);
+
+    const int vp[4] = {0, 0, rt->width, rt->height};
+    ngli_gctx_set_viewport(ctx, vp);
+
+    /* The conversion overwrites the whole target */
+    ngli_gctx_load_attachments(ctx, NGLI_LOAD_OP_DONT_CARE, NGLI_LOAD_OP_DONT_CARE);
+
+    ngli_pipeline_exec(&s->pipeline);
+
+    ngli_gctx_set_rendertarget(ctx, prev_rt);
+    ngli_gctx_set_viewport(ctx, prev_vp);
+}
+
+void ngli_captureconv_reset(struct captureconv *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    if (!ctx)
+        return;
+
+    ngli_pipeline_reset(&s->pipeline);
+    ngli_buffer_reset(&s->vertices);
+    ngli_program_reset(&s->program);
+    ngli_rendertarget_reset(&s->rt);
+    ngli_texture_reset(&s->color);
+
+    memset(s, 0, sizeof(*s));
+}
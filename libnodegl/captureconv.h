@@ -0,0 +1,52 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CAPTURECONV_H
+#define CAPTURECONV_H
+
+#include "buffer.h"
+#include "pipeline.h"
+#include "program.h"
+#include "rendertarget.h"
+#include "texture.h"
+
+/*
+ * Conversion of the captured RGBA frames into a planar YUV layout (any of
+ * NGL_CAPTURE_FORMAT_*). The planes are written byte for byte into an RGBA
+ * render target, so reading it back gives the final buffer directly.
+ */
+struct captureconv {
+    struct ngl_ctx *ctx;
+
+    struct texture color;
+    struct rendertarget rt;
+    struct program program;
+    struct buffer vertices;
+    struct pipeline pipeline;
+};
+
+int ngli_captureconv_get_buffer_size(int format, int width, int height);
+int ngli_captureconv_init(struct captureconv *s, struct ngl_ctx *ctx,
+                          struct texture *src_texture, int format);
+void ngli_captureconv_convert(struct captureconv *s);
+void ngli_captureconv_reset(struct captureconv *s);
+
+#endif
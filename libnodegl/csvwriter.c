@@ -0,0 +1,220 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L // clock_gettime()
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bstr.h"
+#include "csvwriter.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+/* Delay between two flushes of the ring by the writer thread */
+#define FLUSH_INTERVAL_MS 100
+
+struct csvwriter {
+    int fd;
+    int nb_columns;
+    int capacity;
+    double *times;
+    int64_t *values;
+
+    /*
+     * Monotonic row counters: head is only written by the producer and tail
+     * only by the writer thread, the ring is full when they are capacity
+     * rows apart
+     */
+    unsigned head;
+    unsigned tail;
+    int nb_dropped;
+
+    /* Writer thread state */
+    pthread_t thread;
+    int thread_started;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int quit;
+    struct bstr *line;
+    int ret;
+};
+
+static int write_line(struct csvwriter *s)
+{
+    const int len = ngli_bstr_len(s->line);
+    const ssize_t n = write(s->fd, ngli_bstr_strptr(s->line), len);
+    return n == len ? 0 : NGL_ERROR_IO;
+}
+
+static void flush_rows(struct csvwriter *s)
+{
+    const unsigned head = __atomic_load_n(&s->head, __ATOMIC_ACQUIRE);
+    unsigned tail = s->tail;
+
+    while (tail != head) {
+        const int slot = tail % s->capacity;
+        const int64_t *values = s->values + slot * s->nb_columns;
+
+        ngli_bstr_clear(s->line);
+        /* Quoting to prevent locale issues with float printing */
+        ngli_bstr_print(s->line, "\"%f\"", s->times[slot]);
+        for (int i = 0; i < s->nb_columns; i++)
+            ngli_bstr_print(s->line, ",%"PRId64, values[i]);
+        ngli_bstr_print(s->line, "\n");
+
+        if (!s->ret) {
+            s->ret = write_line(s);
+            if (s->ret < 0)
+                LOG(ERROR, "unable to write CSV row, the following rows are discarded");
+        }
+
+        tail++;
+        __atomic_store_n(&s->tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+static void *writer_thread(void *arg)
+{
+    struct csvwriter *s = arg;
+
+    ngli_thread_set_name("ngl-csv");
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        const int quit = s->quit;
+        pthread_mutex_unlock(&s->lock);
+
+        flush_rows(s);
+        if (quit)
+            break;
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += FLUSH_INTERVAL_MS * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+
+        pthread_mutex_lock(&s->lock);
+        if (!s->quit)
+            pthread_cond_timedwait(&s->cond, &s->lock, &deadline);
+    }
+
+    return NULL;
+}
+
+struct csvwriter *ngli_csvwriter_create(const char *filename, const char *header,
+                                        int nb_columns, int capacity)
+{
+    if (nb_columns < 0 || capacity < 1)
+        return NULL;
+
+    struct csvwriter *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+
+    s->fd = -1;
+    s->nb_columns = nb_columns;
+    s->capacity = capacity;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+
+    s->times = ngli_calloc(capacity, sizeof(*s->times));
+    s->values = ngli_calloc(capacity * NGLI_MAX(nb_columns, 1), sizeof(*s->values));
+    s->line = ngli_bstr_create();
+    if (!s->times || !s->values || !s->line)
+        goto fail;
+
+    s->fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (s->fd == -1) {
+        LOG(ERROR, "unable to open \"%s\" for writing", filename);
+        goto fail;
+    }
+
+    ngli_bstr_print(s->line, "%s\n", header);
+    if (write_line(s) < 0) {
+        LOG(ERROR, "unable to write CSV header");
+        goto fail;
+    }
+
+    if (pthread_create(&s->thread, NULL, writer_thread, s)) {
+        LOG(ERROR, "unable to create CSV writer thread");
+        goto fail;
+    }
+    s->thread_started = 1;
+
+    return s;
+
+fail:
+    ngli_csvwriter_close(&s);
+    return NULL;
+}
+
+int ngli_csvwriter_push(struct csvwriter *s, double t, const int64_t *values)
+{
+    const unsigned head = s->head;
+    const unsigned tail = __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE);
+    if (head - tail == (unsigned)s->capacity) {
+        s->nb_dropped++;
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    }
+
+    const int slot = head % s->capacity;
+    s->times[slot] = t;
+    memcpy(s->values + slot * s->nb_columns, values, s->nb_columns * sizeof(*values));
+    __atomic_store_n(&s->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int ngli_csvwriter_close(struct csvwriter **sp)
+{
+    struct csvwriter *s = *sp;
+    if (!s)
+        return 0;
+
+    if (s->thread_started) {
+        pthread_mutex_lock(&s->lock);
+        s->quit = 1;
+        pthread_cond_signal(&s->cond);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+    }
+
+    const int ret = s->ret < 0 ? s->ret : s->nb_dropped;
+
+    if (s->fd != -1)
+        close(s->fd);
+    ngli_bstr_freep(&s->line);
+    ngli_free(s->values);
+    ngli_free(s->times);
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    ngli_free(s);
+    *sp = NULL;
+    return ret;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <stdint.h>
+
+/*
+ * CSV file written by a background thread. The rows are pushed as fixed
+ * size binary samples (a time and a fixed number of integer columns) into a
+ * lock-free ring with a single producer, and formatted and written by the
+ * background thread, so the pushing thread never does any file I/O.
+ */
+struct csvwriter;
+
+/*
+ * Create the file and write its header line (without the trailing newline)
+ * synchronously. The ring holds up to capacity rows not yet written.
+ */
+struct csvwriter *ngli_csvwriter_create(const char *filename, const char *header,
+                                        int nb_columns, int capacity);
+
+/*
+ * Push a row of nb_columns values at time t. The row is dropped and
+ * NGL_ERROR_LIMIT_EXCEEDED is returned if the ring is full. Only one thread
+ * may push rows.
+ */
+int ngli_csvwriter_push(struct csvwriter *s, double t, const int64_t *values);
+
+/*
+ * Write the remaining rows, close the file and return the number of rows
+ * dropped since the creation, or a negative error if writing failed.
+ */
+int ngli_csvwriter_close(struct csvwriter **sp);
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "damage.h"
+#include "nodegl.h"
+#include "utils.h"
+
+void ngli_damage_init(struct damage *s)
+{
+    memset(s, 0, sizeof(*s));
+    ngli_darray_init(&s->draws, sizeof(struct damage_draw), 0);
+    ngli_darray_init(&s->prev_draws, sizeof(struct damage_draw), 0);
+    s->full = 1;
+}
+
+void ngli_damage_set_full(struct damage *s)
+{
+    s->full = 1;
+}
+
+int ngli_damage_add_draw(struct damage *s, const void *id, const int *rect, int changed)
+{
+    struct damage_draw draw = {.id = id, .changed = changed};
+    memcpy(draw.rect, rect, sizeof(draw.rect));
+    if (!ngli_darray_push(&s->draws, &draw))
+        return NGL_ERROR_MEMORY;
+    return 0;
+}
+
+static int is_empty(const int *rect)
+{
+    return rect[2] <= 0 || rect[3] <= 0;
+}
+
+static void add_rect(int *dst, const int *rect)
+{
+    if (is_empty(rect))
+        return;
+    if (is_empty(dst)) {
+        memcpy(dst, rect, 4 * sizeof(*dst));
+        return;
+    }
+    const int x0 = NGLI_MIN(dst[0], rect[0]);
+    const int y0 = NGLI_MIN(dst[1], rect[1]);
+    const int x1 = NGLI_MAX(dst[0] + dst[2], rect[0] + rect[2]);
+    const int y1 = NGLI_MAX(dst[1] + dst[3], rect[1] + rect[3]);
+    dst[0] = x0;
+    dst[1] = y0;
+    dst[2] = x1 - x0;
+    dst[3] = y1 - y0;
+}
+
+static int covers(const int *rect, const int *viewport)
+{
+    return rect[0] <= viewport[0] && rect[0] + rect[2] >= viewport[0] + viewport[2] &&
+           rect[1] <= viewport[1] && rect[1] + rect[3] >= viewport[1] + viewport[3];
+}
+
+static int compare_draws(const void *a, const void *b)
+{
+    const struct damage_draw *da = a;
+    const struct damage_draw *db = b;
+    const uintptr_t ida = (uintptr_t)da->id;
+    const uintptr_t idb = (uintptr_t)db->id;
+    if (ida != idb)
+        return ida < idb ? -1 : 1;
+    for (int i = 0; i < 4; i++)
+        if (da->rect[i] != db->rect[i])
+            return da->rect[i] < db->rect[i] ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Both lists are sorted, so the draws found in both frames at the same place
+ * are matched by a single merge pass
+ */
+static void compute_damage(const struct damage *s, int *rect)
+{
+    const struct damage_draw *draws = ngli_darray_data(&s->draws);
+    const struct damage_draw *prev_draws = ngli_darray_data(&s->prev_draws);
+    const int nb_draws = ngli_darray_count(&s->draws);
+    const int nb_prev_draws = ngli_darray_count(&s->prev_draws);
+
+    int i = 0, j = 0;
+    while (i < nb_draws || j < nb_prev_draws) {
+        const int cmp = i == nb_draws      ?  1
+                      : j == nb_prev_draws ? -1
+                      : compare_draws(&draws[i], &prev_draws[j]);
+        if (cmp == 0) {
+            if (draws[i].changed)
+                add_rect(rect, draws[i].rect);
+            i++;
+            j++;
+        } else if (cmp < 0) {
+            add_rect(rect, draws[i++].rect);
+        } else {
+            add_rect(rect, prev_draws[j++].rect);
+        }
+    }
+}
+
+void ngli_damage_end_frame(struct damage *s, const int *viewport)
+{
+    if (memcmp(s->viewport, viewport, sizeof(s->viewport))) {
+        memcpy(s->viewport, viewport, sizeof(s->viewport));
+        ngli_damage_invalidate(s);
+        s->full = 1;
+    }
+
+    qsort(ngli_darray_data(&s->draws), ngli_darray_count(&s->draws),
+          sizeof(struct damage_draw), compare_draws);
+
+    int rect[4] = {0};
+    if (!s->full)
+        compute_damage(s, rect);
+    if (s->full || covers(rect, viewport))
+        memcpy(rect, viewport, sizeof(rect));
+    memcpy(s->rect, rect, sizeof(s->rect));
+
+    memmove(s->history[1], s->history[0], (NGLI_DAMAGE_HISTORY - 1) * sizeof(*s->history));
+    memcpy(s->history[0], rect, sizeof(s->history[0]));
+    s->nb_history = NGLI_MIN(s->nb_history + 1, NGLI_DAMAGE_HISTORY);
+
+    struct darray tmp = s->prev_draws;
+    s->prev_draws = s->draws;
+    s->draws = tmp;
+    s->draws.count = 0;
+    s->full = 0;
+}
+
+void ngli_damage_invalidate(struct damage *s)
+{
+    s->nb_history = 0;
+}
+
+int ngli_damage_get_region(const struct damage *s, int age, int *rect)
+{
+    memcpy(rect, s->viewport, sizeof(s->viewport));
+    if (age < 1 || age > s->nb_history)
+        return 0;
+
+    int region[4] = {0};
+    for (int i = 0; i < age; i++)
+        add_rect(region, s->history[i]);
+    if (covers(region, s->viewport))
+        return 0;
+
+    memcpy(rect, region, sizeof(region));
+    return 1;
+}
+
+int ngli_damage_project_box(const float *matrix, const float *box_min, const float *box_max,
+                            const int *viewport, int *rect)
+{
+    float xmin = 1.f, ymin = 1.f, xmax = -1.f, ymax = -1.f;
+    for (int i = 0; i < 8; i++) {
+        const float corner[3] = {
+            i & 1 ? box_max[0] : box_min[0],
+            i & 2 ? box_max[1] : box_min[1],
+            i & 4 ? box_max[2] : box_min[2],
+        };
+        float clip[4];
+        for (int j = 0; j < 4; j++)
+            clip[j] = matrix[j] * corner[0] + matrix[4 + j] * corner[1] + matrix[8 + j] * corner[2] + matrix[12 + j];
+        if (clip[3] <= 1e-6f)
+            return 0;
+        const float x = clip[0] / clip[3];
+        const float y = clip[1] / clip[3];
+        xmin = i ? NGLI_MIN(xmin, x) : x;
+        ymin = i ? NGLI_MIN(ymin, y) : y;
+        xmax = i ? NGLI_MAX(xmax, x) : x;
+        ymax = i ? NGLI_MAX(ymax, y) : y;
+    }
+
+    /* Clamp in normalized coordinates to keep the conversion in range */
+    xmin = NGLI_MAX(xmin, -1.f);
+    ymin = NGLI_MAX(ymin, -1.f);
+    xmax = NGLI_MIN(xmax,  1.f);
+    ymax = NGLI_MIN(ymax,  1.f);
+    if (xmin > xmax || ymin > ymax) {
+        memset(rect, 0, 4 * sizeof(*rect));
+        return 1;
+    }
+
+    /* The padding accounts for the rasterization rounding and filtering */
+    const int x0 = NGLI_MAX((int)floorf(viewport[0] + (xmin + 1.f) * .5f * viewport[2]) - 1, viewport[0]);
+    const int y0 = NGLI_MAX((int)floorf(viewport[1] + (ymin + 1.f) * .5f * viewport[3]) - 1, viewport[1]);
+    const int x1 = NGLI_MIN((int)ceilf(viewport[0] + (xmax + 1.f) * .5f * viewport[2]) + 1, viewport[0] + viewport[2]);
+    const int y1 = NGLI_MIN((int)ceilf(viewport[1] + (ymax + 1.f) * .5f * viewport[3]) + 1, viewport[1] + viewport[3]);
+    rect[0] = x0;
+    rect[1] = y0;
+    rect[2] = x1 - x0;
+    rect[3] = y1 - y0;
+    return 1;
+}
+
+void ngli_damage_reset(struct damage *s)
+{
+    ngli_darray_reset(&s->draws);
+    ngli_darray_reset(&s->prev_draws);
+    memset(s, 0, sizeof(*s));
+}
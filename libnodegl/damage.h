@@ -0,0 +1,97 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include "darray.h"
+
+#define NGLI_DAMAGE_HISTORY 4
+
+/*
+ * Screen-space region changed by a frame, computed from the draws of the
+ * frame and of the previous one: a draw whose output changed damages its
+ * area, and a draw which moved, appeared or disappeared damages its previous
+ * and current areas.
+ *
+ * The rectangles are expressed as {x, y, width, height} in window
+ * coordinates (origin at the bottom left), like the viewport.
+ */
+struct damage_draw {
+    const void *id; // identifies the same draw from one frame to another
+    int rect[4];
+    int changed;
+};
+
+struct damage {
+    struct darray draws;        // struct damage_draw, of the current frame
+    struct darray prev_draws;   // struct damage_draw, of the previous frame
+    int viewport[4];
+    int full;                   // the current frame can not be located
+    int rect[4];                // damage of the last frame ended
+    int history[NGLI_DAMAGE_HISTORY][4]; // damages of the last frames ended, most recent first
+    int nb_history;
+};
+
+void ngli_damage_init(struct damage *s);
+
+/*
+ * Mark the whole viewport of the current frame as damaged.
+ */
+void ngli_damage_set_full(struct damage *s);
+
+/*
+ * Register a draw of the current frame covering rect.
+ */
+int ngli_damage_add_draw(struct damage *s, const void *id, const int *rect, int changed);
+
+/*
+ * Compute the damage of the current frame from its draws, and start a new
+ * one. A change of viewport damages the whole frame.
+ */
+void ngli_damage_end_frame(struct damage *s, const int *viewport);
+
+/*
+ * Forget the damages of the previous frames, for instance when the content
+ * of the buffers is lost.
+ */
+void ngli_damage_invalidate(struct damage *s);
+
+/*
+ * Region to redraw to bring a buffer holding the frame drawn age frames
+ * before the last frame ended (0 if its content is unknown) to the content
+ * of the last frame ended. Return 0 if the whole viewport has to be redrawn,
+ * 1 otherwise.
+ */
+int ngli_damage_get_region(const struct damage *s, int age, int *rect);
+
+/*
+ * Window area covered by the box (box_min, box_max) transformed by matrix
+ * (a projection times a modelview matrix), padded by a pixel and clipped to
+ * the viewport. Return 0 if the area can not be computed because the box
+ * crosses the plane of the eye.
+ */
+int ngli_damage_project_box(const float *matrix, const float *box_min, const float *box_max,
+                            const int *viewport, int *rect);
+
+void ngli_damage_reset(struct damage *s);
+
+#endif
@@ -19,69 +19,23 @@
  * under the License.
  */
 
+#include <string.h>
+
+#include "bstr.h"
 #include "default_shaders.h"
 #include "program.h"
 
-static const char default_vertex_shader[] =
-    "#version 100"                                                                      "\n"
-    ""                                                                                  "\n"
-    "precision highp float;"                                                            "\n"
-    "attribute vec4 ngl_position;"                                                      "\n"
-    "attribute vec2 ngl_uvcoord;"                                                       "\n"
-    "attribute vec3 ngl_normal;"                                                        "\n"
-    "uniform mat4 ngl_modelview_matrix;"                                                "\n"
-    "uniform mat4 ngl_projection_matrix;"                                               "\n"
-    "uniform mat3 ngl_normal_matrix;"                                                   "\n"
-
-    "uniform mat4 tex0_coord_matrix;"                                                   "\n"
-
-    "varying vec2 var_uvcoord;"                                                         "\n"
-    "varying vec3 var_normal;"                                                          "\n"
-    "varying vec2 var_tex0_coord;"                                                      "\n"
-    "void main()"                                                                       "\n"
-    "{"                                                                                 "\n"
-    "    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position;"    "\n"
-    "    var_uvcoord = ngl_uvcoord;"                                                    "\n"
-    "    var_normal = ngl_normal_matrix * ngl_normal;"                                  "\n"
-    "    var_tex0_coord = (tex0_coord_matrix * vec4(ngl_uvcoord, 0.0, 1.0)).xy;"        "\n"
-    "}";
-
-#if defined(TARGET_ANDROID)
 static const char default_fragment_shader[] =
     "#version 100"                                                                      "\n"
-    "#extension GL_OES_EGL_image_external : require"                                    "\n"
     ""                                                                                  "\n"
     "precision highp float;"                                                            "\n"
-    "uniform int tex0_sampling_mode;"                                                   "\n"
-    "uniform sampler2D tex0_sampler;"                                                   "\n"
-    "uniform samplerExternalOES tex0_external_sampler;"                                 "\n"
-    "varying vec2 var_uvcoord;"                                                         "\n"
     "varying vec2 var_tex0_coord;"                                                      "\n"
     "void main(void)"                                                                   "\n"
     "{"                                                                                 "\n"
-    "    if (tex0_sampling_mode == 1)"                                                  "\n"
-    "        gl_FragColor = texture2D(tex0_sampler, var_tex0_coord);"                   "\n"
-    "    else if (tex0_sampling_mode == 2)"                                             "\n"
-    "        gl_FragColor = texture2D(tex0_external_sampler, var_tex0_coord);"          "\n"
-    "    else"                                                                          "\n"
-    "        gl_FragColor = vec4(1.0, 0.0, 0.0, 1.0);"                                  "\n"
+    "    gl_FragColor = ngl_texvideo(tex0, var_tex0_coord);"                            "\n"
     "}";
-#else
-static const char default_fragment_shader[] =
-    "#version 100"                                                                      "\n"
-    ""                                                                                  "\n"
-    "precision highp float;"                                                            "\n"
-    "uniform sampler2D tex0_sampler;"                                                   "\n"
-    "varying vec2 var_uvcoord;"                                                         "\n"
-    "varying vec2 var_tex0_coord;"                                                      "\n"
-    "void main(void)"                                                                   "\n"
-    "{"                                                                                 "\n"
-    "    gl_FragColor = texture2D(tex0_sampler, var_tex0_coord);"                       "\n"
-    "}";
-#endif
 
 static const char * const shader_map[NGLI_PROGRAM_SHADER_NB] = {
-    [NGLI_PROGRAM_SHADER_VERT] = default_vertex_shader,
     [NGLI_PROGRAM_SHADER_FRAG] = default_fragment_shader,
 };
 
@@ -89,3 +43,47 @@ const char *ngli_get_default_shader(int stage)
 {
     return shader_map[stage];
 }
+
+char *ngli_get_default_vertex_shader(const char *fragment)
+{
+    const int uvcoord = strstr(fragment, "var_uvcoord") != NULL;
+    const int normal = strstr(fragment, "var_normal") != NULL;
+    const int tex0_coord = strstr(fragment, "var_tex0_coord") != NULL;
+
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+
+    ngli_bstr_print(b, "#version 100\n"
+                       "\n"
+                       "precision highp float;\n"
+                       "attribute vec4 ngl_position;\n"
+                       "uniform mat4 ngl_modelview_matrix;\n"
+                       "uniform mat4 ngl_projection_matrix;\n");
+    if (uvcoord || tex0_coord)
+        ngli_bstr_print(b, "attribute vec2 ngl_uvcoord;\n");
+    if (uvcoord)
+        ngli_bstr_print(b, "varying vec2 var_uvcoord;\n");
+    if (normal)
+        ngli_bstr_print(b, "attribute vec3 ngl_normal;\n"
+                           "uniform mat3 ngl_normal_matrix;\n"
+                           "varying vec3 var_normal;\n");
+    if (tex0_coord)
+        ngli_bstr_print(b, "uniform mat4 tex0_coord_matrix;\n"
+                           "varying vec2 var_tex0_coord;\n");
+
+    ngli_bstr_print(b, "void main()\n"
+                       "{\n"
+                       "    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position;\n");
+    if (uvcoord)
+        ngli_bstr_print(b, "    var_uvcoord = ngl_uvcoord;\n");
+    if (normal)
+        ngli_bstr_print(b, "    var_normal = ngl_normal_matrix * ngl_normal;\n");
+    if (tex0_coord)
+        ngli_bstr_print(b, "    var_tex0_coord = (tex0_coord_matrix * vec4(ngl_uvcoord, 0.0, 1.0)).xy;\n");
+    ngli_bstr_print(b, "}");
+
+    char *vertex = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return vertex;
+}
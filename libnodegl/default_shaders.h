@@ -24,4 +24,13 @@
 
 const char *ngli_get_default_shader(int stage);
 
+/*
+ * Return the default vertex shader, only computing the outputs read by the
+ * fragment shader among var_uvcoord, var_normal and var_tex0_coord, so the
+ * unused attributes and uniforms (such as the normal matrix, computed on
+ * the CPU) are not even declared. The returned source must be freed with
+ * ngli_free().
+ */
+char *ngli_get_default_vertex_shader(const char *fragment);
+
 #endif
@@ -19,16 +19,49 @@
  * under the License.
  */
 
+#include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "darray.h"
+#include "jobpool.h"
 #include "log.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "params.h"
+#include "serialize.h"
+#include "utils.h"
+
+/*
+ * The nodes of a deserialized scene are allocated together from an arena,
+ * which is released along with the last of them
+ */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/* Size of the reads of a serialized scene from a file descriptor */
+#define READ_CHUNK_SIZE (64 * 1024)
+
+/*
+ * The data payloads from this size are decoded in chunks by a pool of
+ * threads, created along with the first of them
+ */
+#define PARALLEL_DATA_SIZE (1024 * 1024)
+#define DATA_CHUNK_SIZE (256 * 1024)
+#define MAX_DATA_THREADS 8
+
+struct deserializer {
+    struct arena *arena;
+    struct darray nodes_array;
+    struct ngl_node *node;
+    int header_parsed;
+    struct jobpool *jobpool;
+    int jobpool_tried;
+};
 
 #define CASE_LITERAL(param_type, type, parse_func)      \
 case param_type: {                                      \
@@ -101,29 +134,32 @@ static int parse_##type(const char *s, type *valp)                          \
 DECLARE_FLT_PARSE_FUNC(float,  32, 23, 'z')
 DECLARE_FLT_PARSE_FUNC(double, 64, 52, 'Z')
 
+/* Number of elements of a list, which ends along with its parameter */
+static int count_list_elems(const char *s)
+{
+    int nb_elems = 1;
+    for (; *s && *s != ' ' && *s != '\n'; s++)
+        nb_elems += *s == ',';
+    return nb_elems;
+}
+
 #define DECLARE_PARSE_LIST_FUNC(type, parse_func)                           \
 static int parse_func##s(const char *s, type **valsp, int *nb_valsp)        \
 {                                                                           \
-    type *vals = NULL;                                                      \
-    int nb_vals = 0, consumed = 0, len;                                     \
+    const int max_vals = count_list_elems(s);                               \
+    type *vals = ngli_calloc(max_vals, sizeof(*vals));                      \
+    int nb_vals = 0, consumed = vals ? 0 : -1, len;                         \
                                                                             \
-    for (;;) {                                                              \
+    while (vals && nb_vals < max_vals) {                                    \
         type v;                                                             \
         len = parse_func(s, &v);                                            \
         if (len < 0) {                                                      \
             consumed = -1;                                                  \
             break;                                                          \
         }                                                                   \
-        type *new_vals = ngli_realloc(vals,                                 \
-                                      (nb_vals + 1) * sizeof(*new_vals));   \
-        if (!new_vals) {                                                    \
-            consumed = -1;                                                  \
-            break;                                                          \
-        }                                                                   \
         s += len;                                                           \
         consumed += len;                                                    \
-        new_vals[nb_vals++] = v;                                            \
-        vals = new_vals;                                                    \
+        vals[nb_vals++] = v;                                                \
         if (*s != ',')                                                      \
             break;                                                          \
         s++;                                                                \
@@ -210,9 +246,64 @@ static inline int hexv(char c)
     return 0;
 }
 
-static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
+static void decode_hex(uint8_t *dst, const char *src, int size)
+{
+    static const uint8_t hexm[256] = {
+        ['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3,
+        ['4'] = 0x4, ['5'] = 0x5, ['6'] = 0x6, ['7'] = 0x7,
+        ['8'] = 0x8, ['9'] = 0x9, ['a'] = 0xa, ['b'] = 0xb,
+        ['c'] = 0xc, ['d'] = 0xd, ['e'] = 0xe, ['f'] = 0xf,
+    };
+    for (int i = 0; i < size; i++) {
+        dst[i] = hexm[(uint8_t)src[0]]<<4 | hexm[(uint8_t)src[1]];
+        src += 2;
+    }
+}
+
+struct hex_payload {
+    uint8_t *dst;
+    const char *src;
+    int size;
+};
+
+static int decode_hex_job(void *arg, int index)
+{
+    const struct hex_payload *payload = arg;
+    const int start = index * DATA_CHUNK_SIZE;
+    const int size = NGLI_MIN(DATA_CHUNK_SIZE, payload->size - start);
+    decode_hex(payload->dst + start, payload->src + start * 2, size);
+    return 0;
+}
+
+static struct jobpool *get_jobpool(struct deserializer *d)
+{
+    if (d->jobpool_tried)
+        return d->jobpool;
+    d->jobpool_tried = 1;
+
+    const int nb_threads = NGLI_MIN(ngli_get_nb_cpus(), MAX_DATA_THREADS);
+    if (nb_threads > 1)
+        d->jobpool = ngli_jobpool_create(nb_threads, NGL_THREAD_PRIORITY_DEFAULT, 0);
+    return d->jobpool;
+}
+
+static int decode_data(struct deserializer *d, uint8_t *dst, const char *src, int size)
+{
+    struct jobpool *jobpool = size >= PARALLEL_DATA_SIZE ? get_jobpool(d) : NULL;
+    if (!jobpool) {
+        decode_hex(dst, src, size);
+        return 0;
+    }
+
+    struct hex_payload payload = {.dst = dst, .src = src, .size = size};
+    const int nb_chunks = (size + DATA_CHUNK_SIZE - 1) / DATA_CHUNK_SIZE;
+    return ngli_jobpool_run(jobpool, decode_hex_job, &payload, nb_chunks);
+}
+
+static int parse_param(struct deserializer *d, uint8_t *base_ptr,
                        const struct node_param *par, const char *str)
 {
+    struct darray *nodes_array = &d->nodes_array;
     int len = -1;
 
     switch (par->type) {
@@ -283,23 +374,17 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
             if (cur >= end - consumed)
                 return NGL_ERROR_INVALID_DATA;
             cur += consumed;
-            uint8_t *data = ngli_calloc(size, sizeof(*data));
+            if (size < 0 || end - cur < 2 * (int64_t)size)
+                return NGL_ERROR_INVALID_DATA;
+            uint8_t *data = ngli_malloc(size);
             if (!data)
                 return NGL_ERROR_MEMORY;
-            for (int i = 0; i < size; i++) {
-                if (cur > end - 2) {
-                    ngli_free(data);
-                    return NGL_ERROR_INVALID_DATA;
-                }
-                static const uint8_t hexm[256] = {
-                    ['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3,
-                    ['4'] = 0x4, ['5'] = 0x5, ['6'] = 0x6, ['7'] = 0x7,
-                    ['8'] = 0x8, ['9'] = 0x9, ['a'] = 0xa, ['b'] = 0xb,
-                    ['c'] = 0xc, ['d'] = 0xd, ['e'] = 0xe, ['f'] = 0xf,
-                };
-                data[i] = hexm[(uint8_t)cur[0]]<<4 | hexm[(uint8_t)cur[1]];
-                cur += 2;
+            ret = decode_data(d, data, cur, size);
+            if (ret < 0) {
+                ngli_free(data);
+                return ret;
             }
+            cur += 2 * size;
             ret = ngli_params_vset(base_ptr, par, size, data);
             ngli_free(data);
             if (ret < 0)
@@ -419,7 +504,7 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
     return len;
 }
 
-static int set_node_params(struct darray *nodes_array, char *str,
+static int set_node_params(struct deserializer *d, char *str,
                            const struct ngl_node *node)
 {
     uint8_t *base_ptr = node->priv_data;
@@ -434,7 +519,7 @@ static int set_node_params(struct darray *nodes_array, char *str,
         if (!(par->flags & PARAM_FLAG_CONSTRUCTOR))
             break;
 
-        int ret = parse_param(nodes_array, base_ptr, par, str);
+        int ret = parse_param(d, base_ptr, par, str);
         if (ret < 0) {
             LOG(ERROR, "invalid value specified for parameter %s.%s",
                 node->class->name, par->key);
@@ -461,7 +546,7 @@ static int set_node_params(struct darray *nodes_array, char *str,
         }
 
         str = eok + 1;
-        int ret = parse_param(nodes_array, base_ptr, par, str);
+        int ret = parse_param(d, base_ptr, par, str);
         if (ret < 0) {
             LOG(ERROR, "invalid value specified for parameter %s.%s",
                 node->class->name, par->key);
@@ -477,43 +562,480 @@ static int set_node_params(struct darray *nodes_array, char *str,
     return 0;
 }
 
-struct ngl_node *ngl_node_deserialize(const char *str)
+static int deserializer_init(struct deserializer *d)
 {
-    struct ngl_node *node = NULL;
-    struct darray nodes_array;
-
-    ngli_darray_init(&nodes_array, sizeof(struct ngl_node *), 0);
-
-    char *s = ngli_strdup(str);
-    if (!s)
-        return NULL;
-
-    char *sstart = s;
-    char *send = s + strlen(s);
+    memset(d, 0, sizeof(*d));
+    ngli_darray_init(&d->nodes_array, sizeof(struct ngl_node *), 0);
+    d->arena = ngli_arena_create(ARENA_BLOCK_SIZE, NGLI_MEMTAG_NODES);
+    if (!d->arena)
+        return NGL_ERROR_MEMORY;
+    return 0;
+}
 
+static int parse_header(const char *line)
+{
     int major, minor, micro;
-    int n = sscanf(s, "# Node.GL v%d.%d.%d", &major, &minor, &micro);
+    int n = sscanf(line, "# Node.GL v%d.%d.%d", &major, &minor, &micro);
     if (n != 3) {
         LOG(ERROR, "invalid serialized scene");
-        goto end;
+        return NGL_ERROR_INVALID_DATA;
     }
     if (NODEGL_VERSION_INT != NODEGL_GET_VERSION(major, minor, micro)) {
         LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
             major, minor, micro,
             NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
-        goto end;
+        return NGL_ERROR_INVALID_DATA;
+    }
+    return 0;
+}
+
+/* Parse one line of the scene, without its line feed */
+static int parse_line(struct deserializer *d, char *s)
+{
+    if (!d->header_parsed) {
+        d->header_parsed = 1;
+        return parse_header(s);
     }
-    s += strcspn(s, "\n");
-    if (*s == '\n')
+
+    if (!*s)
+        return 0;
+    if (strlen(s) < 4)
+        return NGL_ERROR_INVALID_DATA;
+
+    const int type = NGLI_FOURCC(s[0], s[1], s[2], s[3]);
+    s += 4;
+    if (*s == ' ')
         s++;
 
-    while (s < send - 4) {
-        const int type = NGLI_FOURCC(s[0], s[1], s[2], s[3]);
-        s += 4;
-        if (*s == ' ')
-            s++;
+    d->node = ngli_node_create_noconstructor(type, d->arena);
+    if (!d->node)
+        return NGL_ERROR_INVALID_DATA;
+
+    if (!ngli_darray_push(&d->nodes_array, &d->node)) {
+        ngl_node_unrefp(&d->node);
+        return NGL_ERROR_MEMORY;
+    }
+
+    return set_node_params(d, s, d->node);
+}
+
+static void deserializer_reset(struct deserializer *d)
+{
+    struct ngl_node **nodes = ngli_darray_data(&d->nodes_array);
+    for (int i = 0; i < ngli_darray_count(&d->nodes_array); i++)
+        ngl_node_unrefp(&nodes[i]);
+
+    ngli_darray_reset(&d->nodes_array);
+    ngli_arena_unrefp(&d->arena);
+    ngli_jobpool_freep(&d->jobpool);
+}
+
+/* Return the last node of the scene, which is its root, on success */
+static struct ngl_node *deserializer_end(struct deserializer *d, int ret)
+{
+    /* An empty scene has no header */
+    if (ret >= 0 && !d->header_parsed)
+        ret = parse_header("");
+
+    struct ngl_node *node = ret >= 0 && d->node ? ngl_node_ref(d->node) : NULL;
+    deserializer_reset(d);
+    return node;
+}
+
+struct ngl_node *ngl_node_deserialize(const char *str)
+{
+    struct deserializer d;
+    int ret = deserializer_init(&d);
+    if (ret < 0)
+        return deserializer_end(&d, ret);
+
+    char *s = ngli_strdup(str);
+    if (!s)
+        return deserializer_end(&d, NGL_ERROR_MEMORY);
+
+    char *line = s;
+    while (*line) {
+        const size_t eol = strcspn(line, "\n");
+        const int last = !line[eol];
+        line[eol] = 0;
+        ret = parse_line(&d, line);
+        if (ret < 0 || last)
+            break;
+        line += eol + 1;
+    }
+
+    ngli_free(s);
+    return deserializer_end(&d, ret);
+}
+
+static int read_fd(int fd, char *buf, size_t size)
+{
+    for (;;) {
+        const ssize_t n = read(fd, buf, size);
+        if (n >= 0 || errno != EINTR)
+            return n < 0 ? NGL_ERROR_IO : (int)n;
+    }
+}
+
+/*
+ * The scene is parsed line by line while it is read, so only the line being
+ * parsed is held in memory. A binary scene is read entirely beforehand.
+ */
+struct ngl_node *ngl_node_deserialize_fd(int fd)
+{
+    struct deserializer d;
+    int ret = deserializer_init(&d);
+    if (ret < 0)
+        return deserializer_end(&d, ret);
+
+    char *buf = NULL;
+    size_t len = 0, buf_size = 0;
+    int binary = -1;
+
+    for (;;) {
+        if (buf_size - len < READ_CHUNK_SIZE + 1) {
+            const size_t new_size = NGLI_MAX(buf_size * 2, len + READ_CHUNK_SIZE + 1);
+            char *new_buf = ngli_realloc(buf, new_size);
+            if (!new_buf) {
+                ret = NGL_ERROR_MEMORY;
+                break;
+            }
+            buf = new_buf;
+            buf_size = new_size;
+        }
+
+        const int n = read_fd(fd, buf + len, buf_size - len - 1);
+        if (n < 0) {
+            LOG(ERROR, "unable to read the serialized scene");
+            ret = n;
+            break;
+        }
+
+        /* The current line, starting at buf, had no line feed before */
+        const size_t start = len;
+        len += n;
+        buf[len] = 0;
+
+        if (binary < 0 && (len >= 4 || !n))
+            binary = len >= 4 && !memcmp(buf, NGLI_BINSCENE_MAGIC, 4);
+        if (binary > 0) {
+            if (n)
+                continue;
+            deserializer_reset(&d);
+            struct ngl_node *node = ngl_node_deserialize_binary(buf, len);
+            ngli_free(buf);
+            return node;
+        }
+        if (binary < 0)
+            continue;
+
+        char *line = buf;
+        char *eol = memchr(buf + start, '\n', len - start);
+        while (eol) {
+            *eol = 0;
+            ret = parse_line(&d, line);
+            if (ret < 0)
+                break;
+            line = eol + 1;
+            eol = memchr(line, '\n', buf + len - line);
+        }
+        if (ret < 0)
+            break;
+
+        len -= line - buf;
+        memmove(buf, line, len);
+        buf[len] = 0;
+
+        if (!n) {
+            if (len)
+                ret = parse_line(&d, buf);
+            break;
+        }
+    }
+
+    ngli_free(buf);
+    return deserializer_end(&d, ret);
+}
+
+struct ngl_node *ngl_node_deserialize_file(const char *filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        LOG(ERROR, "unable to open %s", filename);
+        return NULL;
+    }
+    struct ngl_node *node = ngl_node_deserialize_fd(fd);
+    close(fd);
+    return node;
+}
 
-        node = ngli_node_create_noconstructor(type);
+struct binreader {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    int error;
+};
+
+static const uint8_t *bin_read(struct binreader *r, size_t size)
+{
+    if (r->error || size > r->size - r->pos) {
+        r->error = NGL_ERROR_INVALID_DATA;
+        return NULL;
+    }
+    const uint8_t *p = r->data + r->pos;
+    r->pos += size;
+    return p;
+}
+
+static uint32_t bin_read_u32(struct binreader *r)
+{
+    const uint8_t *d = bin_read(r, 4);
+    if (!d)
+        return 0;
+    return (uint32_t)d[0] | (uint32_t)d[1] << 8 | (uint32_t)d[2] << 16 | (uint32_t)d[3] << 24;
+}
+
+static uint64_t bin_read_u64(struct binreader *r)
+{
+    const uint64_t lo = bin_read_u32(r);
+    const uint64_t hi = bin_read_u32(r);
+    return hi << 32 | lo;
+}
+
+static float bin_read_float(struct binreader *r)
+{
+    const union { uint32_t i; float f; } u = {.i = bin_read_u32(r)};
+    return u.f;
+}
+
+static double bin_read_double(struct binreader *r)
+{
+    const union { uint64_t i; double f; } u = {.i = bin_read_u64(r)};
+    return u.f;
+}
+
+static void bin_read_floats(struct binreader *r, int n, float *f)
+{
+    for (int i = 0; i < n; i++)
+        f[i] = bin_read_float(r);
+}
+
+/* The strings are nul-terminated in the scene, so they are used in place */
+static const char *bin_read_str(struct binreader *r)
+{
+    const uint32_t len = bin_read_u32(r);
+    const char *s = (const char *)bin_read(r, (size_t)len + 1);
+    if (!s || s[len]) {
+        r->error = NGL_ERROR_INVALID_DATA;
+        return NULL;
+    }
+    return s;
+}
+
+static struct ngl_node *bin_read_node(struct binreader *r, struct darray *nodes_array)
+{
+    const uint32_t node_id = bin_read_u32(r);
+    if (r->error || node_id > INT_MAX)
+        return NULL;
+    struct ngl_node **nodep = ngli_darray_get(nodes_array, node_id);
+    return nodep ? *nodep : NULL;
+}
+
+static int parse_binary_param(struct binreader *r, struct darray *nodes_array,
+                              uint8_t *base_ptr, const struct node_param *par,
+                              const struct binreader *payloads)
+{
+    int ret = 0;
+
+    switch (par->type) {
+        case PARAM_TYPE_INT:
+        case PARAM_TYPE_BOOL: {
+            const int v = bin_read_u32(r);
+            if (!r->error)
+                ret = ngli_params_vset(base_ptr, par, v);
+            break;
+        }
+        case PARAM_TYPE_I64: {
+            const int64_t v = bin_read_u64(r);
+            if (!r->error)
+                ret = ngli_params_vset(base_ptr, par, v);
+            break;
+        }
+        case PARAM_TYPE_DBL: {
+            const double v = bin_read_double(r);
+            if (!r->error)
+                ret = ngli_params_vset(base_ptr, par, v);
+            break;
+        }
+        case PARAM_TYPE_RATIONAL: {
+            const int num = bin_read_u32(r);
+            const int den = bin_read_u32(r);
+            if (!r->error)
+                ret = ngli_params_vset(base_ptr, par, num, den);
+            break;
+        }
+        case PARAM_TYPE_STR:
+        case PARAM_TYPE_SELECT:
+        case PARAM_TYPE_FLAGS: {
+            const char *s = bin_read_str(r);
+            if (s)
+                ret = ngli_params_vset(base_ptr, par, s);
+            break;
+        }
+        case PARAM_TYPE_DATA: {
+            const uint64_t offset = bin_read_u64(r);
+            const uint32_t size = bin_read_u32(r);
+            if (r->error)
+                break;
+            if (size > INT_MAX || offset > payloads->size || size > payloads->size - offset)
+                return NGL_ERROR_INVALID_DATA;
+            ret = ngli_params_vset(base_ptr, par, (int)size, (void *)(payloads->data + offset));
+            break;
+        }
+        case PARAM_TYPE_VEC2:
+        case PARAM_TYPE_VEC3:
+        case PARAM_TYPE_VEC4:
+        case PARAM_TYPE_MAT4: {
+            float v[16];
+            const int n = par->type == PARAM_TYPE_MAT4 ? 16 : par->type - PARAM_TYPE_VEC2 + 2;
+            bin_read_floats(r, n, v);
+            if (!r->error)
+                ret = ngli_params_vset(base_ptr, par, v);
+            break;
+        }
+        case PARAM_TYPE_NODE: {
+            struct ngl_node *node = bin_read_node(r, nodes_array);
+            if (!node)
+                return NGL_ERROR_INVALID_DATA;
+            ret = ngli_params_vset(base_ptr, par, node);
+            break;
+        }
+        case PARAM_TYPE_NODELIST: {
+            const uint32_t nb_nodes = bin_read_u32(r);
+            for (uint32_t i = 0; i < nb_nodes && ret >= 0; i++) {
+                struct ngl_node *node = bin_read_node(r, nodes_array);
+                if (!node)
+                    return NGL_ERROR_INVALID_DATA;
+                ret = ngli_params_add(base_ptr, par, 1, &node);
+            }
+            break;
+        }
+        case PARAM_TYPE_DBLLIST: {
+            const uint32_t nb_dbls = bin_read_u32(r);
+            if (r->error || nb_dbls > (r->size - r->pos) / sizeof(double))
+                return NGL_ERROR_INVALID_DATA;
+            double *dbls = ngli_malloc(nb_dbls * sizeof(*dbls));
+            if (!dbls)
+                return NGL_ERROR_MEMORY;
+            for (uint32_t i = 0; i < nb_dbls; i++)
+                dbls[i] = bin_read_double(r);
+            ret = ngli_params_add(base_ptr, par, nb_dbls, dbls);
+            ngli_free(dbls);
+            break;
+        }
+        case PARAM_TYPE_NODEDICT: {
+            const uint32_t nb_nodes = bin_read_u32(r);
+            for (uint32_t i = 0; i < nb_nodes && ret >= 0; i++) {
+                const char *key = bin_read_str(r);
+                struct ngl_node *node = bin_read_node(r, nodes_array);
+                if (!key || !node)
+                    return NGL_ERROR_INVALID_DATA;
+                ret = ngli_params_vset(base_ptr, par, key, node);
+            }
+            break;
+        }
+        default:
+            LOG(ERROR, "cannot deserialize %s: "
+                "unsupported parameter type", par->key);
+            return NGL_ERROR_UNSUPPORTED;
+    }
+    return r->error ? r->error : ret;
+}
+
+static int set_node_binary_params(struct binreader *r, struct darray *nodes_array,
+                                  struct ngl_node *node, uint32_t nb_params,
+                                  const struct binreader *payloads)
+{
+    for (uint32_t i = 0; i < nb_params; i++) {
+        const char *key = bin_read_str(r);
+        const uint32_t type = bin_read_u32(r);
+        if (r->error)
+            return r->error;
+
+        uint8_t *base_ptr;
+        const struct node_param *par = ngli_node_param_find(node, key, &base_ptr);
+        if (!par) {
+            LOG(ERROR, "unable to find parameter %s.%s", node->class->name, key);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        if (par->type != type) {
+            LOG(ERROR, "mismatching type for parameter %s.%s", node->class->name, key);
+            return NGL_ERROR_INVALID_DATA;
+        }
+
+        int ret = parse_binary_param(r, nodes_array, base_ptr, par, payloads);
+        if (ret < 0) {
+            LOG(ERROR, "invalid value specified for parameter %s.%s",
+                node->class->name, par->key);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+struct ngl_node *ngl_node_deserialize_binary(const void *data, size_t size)
+{
+    struct binreader header = {.data = data, .size = size};
+    const uint8_t *magic = bin_read(&header, 4);
+    if (!magic || memcmp(magic, NGLI_BINSCENE_MAGIC, 4)) {
+        LOG(ERROR, "invalid binary serialized scene");
+        return NULL;
+    }
+
+    const uint32_t version = bin_read_u32(&header);
+    const uint32_t ngl_version = bin_read_u32(&header);
+    const uint32_t nb_nodes = bin_read_u32(&header);
+    const uint64_t params_offset = bin_read_u64(&header);
+    const uint64_t payloads_offset = bin_read_u64(&header);
+    if (header.error || params_offset < NGLI_BINSCENE_HEADER_SIZE || params_offset > payloads_offset || payloads_offset > size ||
+        nb_nodes > (params_offset - NGLI_BINSCENE_HEADER_SIZE) / NGLI_BINSCENE_NODE_SIZE) {
+        LOG(ERROR, "invalid binary serialized scene");
+        return NULL;
+    }
+    if (version != NGLI_BINSCENE_VERSION) {
+        LOG(ERROR, "unsupported binary scene version %u", version);
+        return NULL;
+    }
+    if (ngl_version != NODEGL_VERSION_INT) {
+        LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
+            ngl_version >> 16 & 0xff, ngl_version >> 8 & 0xff, ngl_version & 0xff,
+            NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
+        return NULL;
+    }
+
+    struct binreader table = {.data = header.data, .size = params_offset, .pos = header.pos};
+    struct binreader params = {.data = header.data + params_offset, .size = payloads_offset - params_offset};
+    const struct binreader payloads = {.data = header.data + payloads_offset, .size = size - payloads_offset};
+
+    struct arena *arena = ngli_arena_create(ARENA_BLOCK_SIZE, NGLI_MEMTAG_NODES);
+    if (!arena)
+        return NULL;
+
+    struct ngl_node *node = NULL;
+    struct darray nodes_array;
+    ngli_darray_init(&nodes_array, sizeof(struct ngl_node *), 0);
+
+    for (uint32_t i = 0; i < nb_nodes; i++) {
+        const uint32_t type = bin_read_u32(&table);
+        const uint32_t nb_params = bin_read_u32(&table);
+        const uint64_t offset = bin_read_u64(&table);
+        if (table.error || offset > params.size) {
+            LOG(ERROR, "invalid binary serialized scene");
+            node = NULL;
+            break;
+        }
+
+        node = ngli_node_create_noconstructor(type, arena);
         if (!node)
             break;
 
@@ -522,16 +1044,12 @@ struct ngl_node *ngl_node_deserialize(const char *str)
             break;
         }
 
-        size_t eol = strcspn(s, "\n");
-        s[eol] = 0;
-
-        int ret = set_node_params(&nodes_array, s, node);
+        params.pos = offset;
+        int ret = set_node_binary_params(&params, &nodes_array, node, nb_params, &payloads);
         if (ret < 0) {
             node = NULL;
             break;
         }
-
-        s += eol + 1;
     }
 
     if (node)
@@ -541,8 +1059,7 @@ struct ngl_node *ngl_node_deserialize(const char *str)
     for (int i = 0; i < ngli_darray_count(&nodes_array); i++)
         ngl_node_unrefp(&nodes[i]);
 
-end:
     ngli_darray_reset(&nodes_array);
-    ngli_free(sstart);
+    ngli_arena_unrefp(&arena);
     return node;
 }
@@ -24,14 +24,31 @@
 
 #include "bstr.h"
 #include "hmap.h"
+#include "image.h"
+#include "log.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "profiler.h"
 
 #define LB "<br align=\"left\"/>"
 #define HSLFMT "\"0.%u 0.6 0.9\""
+#define HEATFMT "\"%.3f 0.7 0.9\""
 #define INACTIVE_COLOR "\"#333333\""
 
+struct node_cost {
+    int64_t time[NGLI_PROFILER_NB]; /* excluding the children, summed over the profile */
+    int64_t memory;
+    int nb_draws;                   /* of the whole subtree */
+};
+
+struct dot_costs {
+    struct hmap *nodes;             /* struct node_cost indexed by node address */
+    int metric;
+    int nb_frames;
+    int64_t max_value;
+};
+
 extern const struct node_param ngli_base_node_params[];
 
 static int visited(struct hmap *ptr_set, const void *id)
@@ -45,6 +62,53 @@ static int visited(struct hmap *ptr_set, const void *id)
     return ngli_hmap_set(ptr_set, key, "");
 }
 
+static const char *get_key(char *key, size_t size, const void *id)
+{
+    snprintf(key, size, "%p", id);
+    return key;
+}
+
+static struct node_cost *get_cost(const struct dot_costs *costs, const void *id)
+{
+    char key[32];
+    return ngli_hmap_get(costs->nodes, get_key(key, sizeof(key), id));
+}
+
+static int64_t get_cost_value(const struct dot_costs *costs, const struct node_cost *cost)
+{
+    switch (costs->metric) {
+        case NGL_DOT_COST_CPU:    return cost->time[NGLI_PROFILER_UPDATE] + cost->time[NGLI_PROFILER_DRAW];
+        case NGL_DOT_COST_GPU:    return cost->time[NGLI_PROFILER_GPU];
+        case NGL_DOT_COST_MEMORY: return cost->memory;
+    }
+    return 0;
+}
+
+static void print_time(struct bstr *b, const char *name, int64_t time, int nb_frames)
+{
+    const double ms = time / 1000. / nb_frames;
+    if (ms >= 0.001)
+        ngli_bstr_print(b, "%s: %.3fms" LB, name, ms);
+}
+
+static void print_size(struct bstr *b, const char *name, int64_t size)
+{
+    if (size >= 1024 * 1024)
+        ngli_bstr_print(b, "%s: %.1fMiB" LB, name, size / (1024. * 1024.));
+    else if (size > 0)
+        ngli_bstr_print(b, "%s: %.1fKiB" LB, name, size / 1024.);
+}
+
+static void print_cost(struct bstr *b, const struct dot_costs *costs, const struct node_cost *cost)
+{
+    print_time(b, "update", cost->time[NGLI_PROFILER_UPDATE], costs->nb_frames);
+    print_time(b, "draw", cost->time[NGLI_PROFILER_DRAW], costs->nb_frames);
+    print_time(b, "gpu", cost->time[NGLI_PROFILER_GPU], costs->nb_frames);
+    print_size(b, "memory", cost->memory);
+    if (cost->nb_draws)
+        ngli_bstr_print(b, "draws: %d" LB, cost->nb_draws);
+}
+
 static unsigned get_hue(const char *name)
 {
     const uint32_t hash = ngli_crc32(name);
@@ -121,25 +185,37 @@ static void print_custom_priv_options(struct bstr *b, const struct ngl_node *nod
 
 static void print_decls(struct bstr *b, const struct ngl_node *node,
                         const struct node_param *p, uint8_t *priv,
-                        struct hmap *decls);
+                        struct hmap *decls, const struct dot_costs *costs);
 
-static void print_all_decls(struct bstr *b, const struct ngl_node *node, struct hmap *decls)
+static void print_all_decls(struct bstr *b, const struct ngl_node *node, struct hmap *decls,
+                            const struct dot_costs *costs)
 {
     if (visited(decls, node))
         return;
 
+    const struct node_cost *cost = costs ? get_cost(costs, node) : NULL;
+
     ngli_bstr_print(b, "    %s_%p[label=<<b>%s</b><br/>",
                     node->class->name, node, node->class->name);
     if (!ngli_is_default_label(node->class->name, node->label) && *node->label)
         ngli_bstr_print(b, "<i>%s</i><br/>", node->label);
-    print_custom_priv_options(b, node);
-    if (!node->ctx || node->is_active)
-        ngli_bstr_print(b, ">,color="HSLFMT"]\n", get_hue(node->class->name));
+    if (cost)
+        print_cost(b, costs, cost);
     else
+        print_custom_priv_options(b, node);
+    if (node->ctx && !node->is_active) {
         ngli_bstr_print(b, ">,color="INACTIVE_COLOR"]\n");
+    } else if (cost) {
+        /* From green for the cheapest nodes to red for the most expensive one */
+        const int64_t value = get_cost_value(costs, cost);
+        const double ratio = costs->max_value ? (double)value / costs->max_value : 0.;
+        ngli_bstr_print(b, ">,color="HEATFMT"]\n", 0.33 * (1. - ratio));
+    } else {
+        ngli_bstr_print(b, ">,color="HSLFMT"]\n", get_hue(node->class->name));
+    }
 
-    print_decls(b, node, ngli_base_node_params, (uint8_t *)node, decls);
-    print_decls(b, node, node->class->params, node->priv_data, decls);
+    print_decls(b, node, ngli_base_node_params, (uint8_t *)node, decls, costs);
+    print_decls(b, node, node->class->params, node->priv_data, decls, costs);
 }
 
 static void print_packed_decls(struct bstr *b, const char *label,
@@ -162,14 +238,14 @@ static void print_packed_decls(struct bstr *b, const char *label,
 
 static void print_decls(struct bstr *b, const struct ngl_node *node,
                         const struct node_param *p, uint8_t *priv,
-                        struct hmap *decls)
+                        struct hmap *decls, const struct dot_costs *costs)
 {
     while (p && p->key) {
         switch (p->type) {
             case PARAM_TYPE_NODE: {
                 const struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
                 if (child)
-                    print_all_decls(b, child, decls);
+                    print_all_decls(b, child, decls, costs);
                 break;
             }
             case PARAM_TYPE_NODELIST: {
@@ -184,7 +260,7 @@ static void print_decls(struct bstr *b, const struct ngl_node *node,
                 }
 
                 for (int i = 0; i < nb_children; i++)
-                    print_all_decls(b, children[i], decls);
+                    print_all_decls(b, children[i], decls, costs);
                 break;
             }
             case PARAM_TYPE_NODEDICT: {
@@ -193,7 +269,7 @@ static void print_decls(struct bstr *b, const struct ngl_node *node,
                     break;
                 const struct hmap_entry *entry = NULL;
                 while ((entry = ngli_hmap_next(hmap, entry)))
-                    print_all_decls(b, entry->data, decls);
+                    print_all_decls(b, entry->data, decls, costs);
                 break;
             }
         }
@@ -292,11 +368,8 @@ static void print_links(struct bstr *b, const struct ngl_node *node,
     }
 }
 
-char *ngl_node_dot(const struct ngl_node *node)
+static char *print_graph(const struct ngl_node *node, const struct dot_costs *costs)
 {
-    if (!node)
-        return NULL;
-
     char *graph = NULL;
     struct hmap *decls = ngli_hmap_create();
     struct hmap *links = ngli_hmap_create();
@@ -312,7 +385,7 @@ char *ngl_node_dot(const struct ngl_node *node)
                     "    node [style=filled,%s];\n",
                     font_settings, font_settings);
 
-    print_all_decls(b, node, decls);
+    print_all_decls(b, node, decls, costs);
     print_all_links(b, node, links);
 
     ngli_bstr_print(b, "}\n");
@@ -326,6 +399,13 @@ end:
     return graph;
 }
 
+char *ngl_node_dot(const struct ngl_node *node)
+{
+    if (!node)
+        return NULL;
+    return print_graph(node, NULL);
+}
+
 char *ngl_dot(struct ngl_ctx *s, double t)
 {
     int ret = ngli_prepare_draw(s, t);
@@ -333,3 +413,175 @@ char *ngl_dot(struct ngl_ctx *s, double t)
         return NULL;
     return ngl_node_dot(s->scene);
 }
+
+static int64_t get_node_memory(const struct ngl_node *node)
+{
+    switch (node->class->category) {
+        case NGLI_NODE_CATEGORY_BUFFER: {
+            const struct buffer_priv *buffer = node->priv_data;
+            return buffer->block ? 0 : buffer->data_size * (buffer->buffer_refcount > 0);
+        }
+        case NGLI_NODE_CATEGORY_BLOCK: {
+            const struct block_priv *block = node->priv_data;
+            return block->data_size * (block->buffer_refcount > 0);
+        }
+        case NGLI_NODE_CATEGORY_TEXTURE: {
+            const struct texture_priv *texture = node->priv_data;
+            return ngli_image_get_memory_size(&texture->image) * node->is_active;
+        }
+    }
+    return 0;
+}
+
+/* The nodes shared by several branches of the subtree only count once */
+static int count_draws(const struct ngl_node *node, struct hmap *counted)
+{
+    if (visited(counted, node))
+        return 0;
+    int nb_draws = node->class->id == NGL_NODE_RENDER ? node->draw_count : 0;
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++)
+        nb_draws += count_draws(children[i], counted);
+    return nb_draws;
+}
+
+static int collect_node_costs(struct dot_costs *costs, const struct ngl_node *node)
+{
+    char key[32];
+    get_key(key, sizeof(key), node);
+    if (ngli_hmap_get(costs->nodes, key))
+        return 0;
+
+    struct node_cost *cost = ngli_calloc(1, sizeof(*cost));
+    if (!cost)
+        return NGL_ERROR_MEMORY;
+    int ret = ngli_hmap_set(costs->nodes, key, cost);
+    if (ret < 0) {
+        ngli_free(cost);
+        return ret;
+    }
+
+    struct hmap *counted = ngli_hmap_create();
+    if (!counted)
+        return NGL_ERROR_MEMORY;
+    cost->nb_draws = count_draws(node, counted);
+    ngli_hmap_freep(&counted);
+
+    cost->memory = get_node_memory(node);
+
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++) {
+        ret = collect_node_costs(costs, children[i]);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+/*
+ * The time of an event includes the time of the events nested in it (the
+ * children of the node), which is subtracted to get the time spent in the
+ * node itself. The CPU events are recorded when they end (a nested event
+ * comes before its parent) while the GPU events are recorded when they
+ * start (a nested event comes after its parent).
+ */
+static int add_event_times(struct dot_costs *costs, const struct profiler *profiler)
+{
+    const struct profiler_event *events = ngli_darray_data(&profiler->events);
+    const int nb_events = ngli_darray_count(&profiler->events);
+    if (!nb_events)
+        return 0;
+
+    int64_t *self_times = ngli_calloc(nb_events, sizeof(*self_times));
+    int *stack = ngli_calloc(nb_events, sizeof(*stack));
+    if (!self_times || !stack) {
+        ngli_free(self_times);
+        ngli_free(stack);
+        return NGL_ERROR_MEMORY;
+    }
+
+    int nb_stacked = 0;
+    for (int i = 0; i < nb_events; i++) {
+        const struct profiler_event *event = &events[i];
+        if (event->phase == NGLI_PROFILER_GPU)
+            continue;
+        self_times[i] = event->dur;
+        while (nb_stacked) {
+            const struct profiler_event *nested = &events[stack[nb_stacked - 1]];
+            if (nested->ts < event->ts || nested->ts + nested->dur > event->ts + event->dur)
+                break;
+            self_times[i] -= nested->dur;
+            nb_stacked--;
+        }
+        stack[nb_stacked++] = i;
+    }
+
+    nb_stacked = 0;
+    for (int i = 0; i < nb_events; i++) {
+        const struct profiler_event *event = &events[i];
+        if (event->phase != NGLI_PROFILER_GPU || event->dur < 0)
+            continue;
+        self_times[i] += event->dur;
+        while (nb_stacked) {
+            const struct profiler_event *parent = &events[stack[nb_stacked - 1]];
+            if (event->ts < parent->ts + parent->dur)
+                break;
+            nb_stacked--;
+        }
+        if (nb_stacked)
+            self_times[stack[nb_stacked - 1]] -= event->dur;
+        stack[nb_stacked++] = i;
+    }
+
+    for (int i = 0; i < nb_events; i++) {
+        const struct profiler_event *event = &events[i];
+        struct node_cost *cost = get_cost(costs, event->id);
+        if (cost && self_times[i] > 0)
+            cost->time[event->phase] += self_times[i];
+    }
+
+    ngli_free(self_times);
+    ngli_free(stack);
+    return 0;
+}
+
+static void free_cost(void *user_arg, void *data)
+{
+    ngli_free(data);
+}
+
+char *ngli_dot_cost(struct ngl_ctx *s, int metric)
+{
+    struct profiler *profiler = &s->profiler;
+    if (!profiler->active) {
+        LOG(ERROR, "the costs are measured by the profiler, which must be started");
+        return NULL;
+    }
+    if (!s->scene)
+        return NULL;
+
+    ngli_profiler_collect(profiler, 1);
+
+    char *graph = NULL;
+    struct dot_costs costs = {
+        .nodes = ngli_hmap_create(),
+        .metric = metric,
+        .nb_frames = NGLI_MAX(profiler->nb_frames, 1),
+    };
+    if (!costs.nodes)
+        return NULL;
+    ngli_hmap_set_free(costs.nodes, free_cost, NULL);
+
+    if (collect_node_costs(&costs, s->scene) < 0 || add_event_times(&costs, profiler) < 0)
+        goto end;
+
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(costs.nodes, entry)))
+        costs.max_value = NGLI_MAX(costs.max_value, get_cost_value(&costs, entry->data));
+
+    graph = print_graph(s->scene, &costs);
+
+end:
+    ngli_hmap_freep(&costs.nodes);
+    return graph;
+}
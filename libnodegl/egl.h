@@ -25,6 +25,10 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#if defined(TARGET_ANDROID)
+#include <android/hardware_buffer.h>
+#endif
+
 #include "glcontext.h"
 
 EGLImageKHR ngli_eglCreateImageKHR(struct glcontext *gl,
@@ -36,4 +40,9 @@ EGLImageKHR ngli_eglCreateImageKHR(struct glcontext *gl,
 EGLBoolean ngli_eglDestroyImageKHR(struct glcontext *gl,
                                    EGLImageKHR image);
 
+#if defined(TARGET_ANDROID)
+EGLClientBuffer ngli_eglGetNativeClientBufferANDROID(struct glcontext *gl,
+                                                     const struct AHardwareBuffer *buffer);
+#endif
+
 #endif
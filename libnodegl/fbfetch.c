@@ -0,0 +1,293 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "fbfetch.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#define FETCH_FUNC "ngl_framebuffer_fetch"
+
+static int is_ident_char(int c)
+{
+    return isalnum(c) || c == '_';
+}
+
+static const char *skip_spaces(const char *p)
+{
+    while (*p && isspace(*p))
+        p++;
+    return p;
+}
+
+static const char *find_word(const char *start, const char *word)
+{
+    const size_t len = strlen(word);
+    const char *p = start;
+    while ((p = strstr(p, word))) {
+        if ((p == start || !is_ident_char(p[-1])) && !is_ident_char(p[len]))
+            return p;
+        p += len;
+    }
+    return NULL;
+}
+
+static const char *read_word(const char *p, const char *word)
+{
+    const size_t len = strlen(word);
+    p = skip_spaces(p);
+    if (strncmp(p, word, len) || is_ident_char(p[len]))
+        return NULL;
+    return p + len;
+}
+
+static int has_texel_fetch(const char *src)
+{
+    const char *p = strstr(src, "#version");
+    if (!p)
+        return 0;
+    p = skip_spaces(p + strlen("#version"));
+    const int version = atoi(p);
+    while (isdigit(*p))
+        p++;
+    const int es = version == 100 || !strncmp(skip_spaces(p), "es", 2);
+    return es ? version >= 300 : version >= 130;
+}
+
+/* Same as the insertion point of the texvideo preprocessing */
+static const char *get_insert_point(const char *src)
+{
+    const char *p = src;
+    for (;;) {
+        const char *line = skip_spaces(p);
+        if (strncmp(line, "#version", 8) && strncmp(line, "#extension", 10))
+            return line;
+        const char *eol = strchr(line, '\n');
+        if (!eol)
+            return line + strlen(line);
+        p = eol + 1;
+    }
+}
+
+/* Right before the top-level declaration holding the first call */
+static const char *get_code_point(const char *start, const char *call)
+{
+    const char *ret = start;
+    int depth = 0;
+    for (const char *p = start; p < call; p++) {
+        if (*p == '{') {
+            depth++;
+        } else if (*p == '}' || *p == ';') {
+            if (*p == '}')
+                depth--;
+            if (!depth)
+                ret = p + 1;
+        }
+    }
+    return ret == start ? start : skip_spaces(ret);
+}
+
+/*
+ * Find the first occurrence of a word outside of any block or parenthesis,
+ * where the fragment outputs and the main function are declared
+ */
+static const char *find_top_level_word(const char *start, const char *word,
+                                       const char *(*check)(const char *p))
+{
+    const size_t len = strlen(word);
+    int depth = 0;
+    for (const char *p = start; *p; p++) {
+        if (*p == '{' || *p == '(') {
+            depth++;
+        } else if (*p == '}' || *p == ')') {
+            depth--;
+        } else if (!depth && !strncmp(p, word, len) && !is_ident_char(p[len]) &&
+                   (p == start || !is_ident_char(p[-1])) && (!check || check(p + len))) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* Check that an output is declared as [precision] vec4 name, and return its name */
+static const char *get_vec4_output_name(const char *p)
+{
+    const char *precisions[] = {"lowp", "mediump", "highp"};
+    for (int i = 0; i < NGLI_ARRAY_NB(precisions); i++) {
+        const char *next = read_word(p, precisions[i]);
+        if (next) {
+            p = next;
+            break;
+        }
+    }
+    p = read_word(p, "vec4");
+    if (!p)
+        return NULL;
+    p = skip_spaces(p);
+    return is_ident_char(*p) && !isdigit(*p) ? p : NULL;
+}
+
+static const char *is_main_definition(const char *p)
+{
+    return *skip_spaces(p) == '(' ? p : NULL;
+}
+
+struct edit {
+    const char *pos;
+    int len;            /* number of source characters replaced */
+    const char *str;
+};
+
+static void print_edited(struct bstr *b, const char *p, const struct edit *edits, int nb_edits)
+{
+    for (int i = 0; i < nb_edits; i++) {
+        const struct edit *e = &edits[i];
+        ngli_bstr_print(b, "%.*s%s", (int)(e->pos - p), p, e->str);
+        p = e->pos + e->len;
+    }
+    ngli_bstr_print(b, "%s", p);
+}
+
+static int compare_edits(const void *a, const void *b)
+{
+    const struct edit *e0 = a;
+    const struct edit *e1 = b;
+    if (e0->pos != e1->pos)
+        return e0->pos > e1->pos ? 1 : -1;
+    /* The insertions come before the replacements at the same position */
+    return e0->len - e1->len;
+}
+
+int ngli_fbfetch_is_used(const char *src)
+{
+    return src && find_word(src, FETCH_FUNC) != NULL;
+}
+
+int ngli_fbfetch_preprocess(const struct glcontext *gl, const char *src, char **dstp)
+{
+    *dstp = NULL;
+
+    if (!ngli_fbfetch_is_used(src))
+        return 0;
+
+    const char *header_end = get_insert_point(src);
+    const char *call = find_word(header_end, FETCH_FUNC);
+    if (!call) {
+        LOG(ERROR, FETCH_FUNC "() can not be used in the preprocessor directives");
+        return NGL_ERROR_INVALID_ARG;
+    }
+    const char *code_point = get_code_point(header_end, call);
+
+    struct bstr *b = ngli_bstr_create();
+    struct bstr *code = ngli_bstr_create();
+    if (!b || !code) {
+        ngli_bstr_freep(&code);
+        ngli_bstr_freep(&b);
+        return NGL_ERROR_MEMORY;
+    }
+
+    int ret = 0;
+    const int native = !!(gl->features & NGLI_FEATURE_SHADER_FRAMEBUFFER_FETCH);
+    const int texel_fetch = has_texel_fetch(src);
+    struct edit edits[3] = {{.pos = code_point}};
+    int nb_edits = 1;
+    char *wrapper = NULL;
+
+    ngli_bstr_print(b, "%.*s", (int)(header_end - src), src);
+    if (native)
+        ngli_bstr_print(b, "#extension GL_EXT_shader_framebuffer_fetch : require\n");
+    /* The preprocessor directives must start a line */
+    if (code_point > src && code_point[-1] != '\n')
+        ngli_bstr_print(code, "\n");
+    if (!find_word(src, "precision"))
+        ngli_bstr_print(code, "#if defined(GL_ES)\nprecision mediump float;\n#endif\n");
+
+    if (native && !texel_fetch) {
+        ngli_bstr_print(code, "#define " FETCH_FUNC "() gl_LastFragData[0]\n");
+    } else if (native) {
+        /*
+         * The fragment output holds the previous color until it is written:
+         * it is saved before running the user main function so the fetch
+         * is not affected by the writes of the shader
+         */
+        const char *out = find_top_level_word(header_end, "out", get_vec4_output_name);
+        const char *main_func = find_top_level_word(header_end, "main", is_main_definition);
+        if (!out || !main_func) {
+            LOG(ERROR, FETCH_FUNC "() requires a vec4 fragment output and a main function");
+            ret = NGL_ERROR_INVALID_ARG;
+            goto end;
+        }
+        const char *name = get_vec4_output_name(out + strlen("out"));
+        int name_len = 0;
+        while (is_ident_char(name[name_len]))
+            name_len++;
+
+        ngli_bstr_print(code, "vec4 ngli_framebuffer_color;\n"
+                              "#define " FETCH_FUNC "() ngli_framebuffer_color\n");
+        edits[nb_edits++] = (struct edit){.pos = out, .len = strlen("out"), .str = "inout"};
+        edits[nb_edits++] = (struct edit){.pos = main_func, .len = strlen("main"), .str = "ngli_fbfetch_main"};
+        wrapper = ngli_asprintf("\nvoid main()\n"
+                                "{\n"
+                                "    ngli_framebuffer_color = %.*s;\n"
+                                "    ngli_fbfetch_main();\n"
+                                "}\n", name_len, name);
+        if (!wrapper) {
+            ret = NGL_ERROR_MEMORY;
+            goto end;
+        }
+    } else if (texel_fetch) {
+        ngli_bstr_print(code, "uniform sampler2D ngl_framebuffer;\n"
+                              "vec4 " FETCH_FUNC "()\n"
+                              "{\n"
+                              "    return texelFetch(ngl_framebuffer, ivec2(gl_FragCoord.xy), 0);\n"
+                              "}\n");
+    } else {
+        ngli_bstr_print(code, "uniform sampler2D ngl_framebuffer;\n"
+                              "uniform vec2 ngl_framebuffer_scale;\n"
+                              "vec4 " FETCH_FUNC "()\n"
+                              "{\n"
+                              "    return texture2D(ngl_framebuffer, gl_FragCoord.xy * ngl_framebuffer_scale);\n"
+                              "}\n");
+    }
+
+    edits[0].str = ngli_bstr_strptr(code);
+    qsort(edits, nb_edits, sizeof(*edits), compare_edits);
+    print_edited(b, header_end, edits, nb_edits);
+    if (wrapper)
+        ngli_bstr_print(b, "%s", wrapper);
+
+    *dstp = ngli_bstr_strdup(b);
+    if (!*dstp)
+        ret = NGL_ERROR_MEMORY;
+
+end:
+    ngli_free(wrapper);
+    ngli_bstr_freep(&code);
+    ngli_bstr_freep(&b);
+    return ret;
+}
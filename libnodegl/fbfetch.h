@@ -0,0 +1,45 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef FBFETCH_H
+#define FBFETCH_H
+
+#include "glcontext.h"
+
+/*
+ * Expand the ngl_framebuffer_fetch() calls of a fragment shader source,
+ * returning the color of the render target at the fragment position before
+ * the draw. With GL_EXT_shader_framebuffer_fetch, the color is read from
+ * the tile memory; otherwise it is sampled from a copy of the render target
+ * bound to the ngl_framebuffer sampler (and ngl_framebuffer_scale, mapping
+ * gl_FragCoord to the copy coordinates, on GLSL versions without
+ * texelFetch()).
+ *
+ * On success, *dstp is set to the newly allocated shader source, or NULL if
+ * the source does not use ngl_framebuffer_fetch().
+ */
+int ngli_fbfetch_preprocess(const struct glcontext *gl, const char *src, char **dstp);
+
+/* Whether the fragment shader source relies on ngl_framebuffer_fetch() */
+int ngli_fbfetch_is_used(const char *src);
+
+#endif
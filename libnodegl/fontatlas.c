@@ -0,0 +1,138 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bstr.h"
+#include "drawutils.h"
+#include "fontatlas.h"
+#include "hmap.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+
+static char *get_atlas_key(int min_filter, int mag_filter, int mipmap_filter)
+{
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+    ngli_bstr_print(b, "%d:%d:%d", min_filter, mag_filter, mipmap_filter);
+    char *key = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return key;
+}
+
+static int atlas_texture_init(struct fontatlas *atlas, struct ngl_ctx *ctx,
+                              int min_filter, int mag_filter, int mipmap_filter)
+{
+    struct canvas canvas = {.w = NGLI_FONTATLAS_W, .h = NGLI_FONTATLAS_H};
+    canvas.buf = ngli_calloc_tagged(canvas.w * canvas.h, 4, NGLI_MEMTAG_DRAWING);
+    if (!canvas.buf)
+        return NGL_ERROR_MEMORY;
+
+    for (int i = 1; i < NGLI_FONTATLAS_NB_COLS * NGLI_FONTATLAS_NB_ROWS; i++) {
+        const char str[] = {i, 0};
+        const int x = i % NGLI_FONTATLAS_NB_COLS * NGLI_FONTATLAS_CELL_W + 1;
+        const int y = i / NGLI_FONTATLAS_NB_COLS * NGLI_FONTATLAS_CELL_H + 1;
+        ngli_drawutils_print(&canvas, x, y, str, 0xffffffff);
+    }
+
+    struct texture_params tex_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    tex_params.width = canvas.w;
+    tex_params.height = canvas.h;
+    tex_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    tex_params.min_filter = min_filter;
+    tex_params.mag_filter = mag_filter;
+    tex_params.mipmap_filter = mipmap_filter;
+    int ret = ngli_texture_init(&atlas->texture, ctx, &tex_params);
+    if (ret >= 0)
+        ret = ngli_texture_upload(&atlas->texture, canvas.buf, 0);
+    ngli_free_tagged(canvas.buf);
+    return ret;
+}
+
+int ngli_fontatlas_acquire(struct ngl_ctx *ctx, int min_filter, int mag_filter, int mipmap_filter,
+                           struct fontatlas **atlasp)
+{
+    char *key = get_atlas_key(min_filter, mag_filter, mipmap_filter);
+    if (!key)
+        return NGL_ERROR_MEMORY;
+
+    if (!ctx->fontatlas_pool) {
+        ctx->fontatlas_pool = ngli_hmap_create();
+        if (!ctx->fontatlas_pool) {
+            ngli_free(key);
+            return NGL_ERROR_MEMORY;
+        }
+    }
+
+    struct fontatlas *atlas = ngli_hmap_get(ctx->fontatlas_pool, key);
+    if (atlas) {
+        ngli_free(key);
+        atlas->refcount++;
+        *atlasp = atlas;
+        return 0;
+    }
+
+    atlas = ngli_calloc(1, sizeof(*atlas));
+    if (!atlas) {
+        ngli_free(key);
+        return NGL_ERROR_MEMORY;
+    }
+    atlas->key = key;
+    atlas->refcount = 1;
+
+    int ret = ngli_hmap_set(ctx->fontatlas_pool, key, atlas);
+    if (ret < 0) {
+        ngli_free(atlas->key);
+        ngli_free(atlas);
+        return ret;
+    }
+    *atlasp = atlas;
+
+    return atlas_texture_init(atlas, ctx, min_filter, mag_filter, mipmap_filter);
+}
+
+void ngli_fontatlas_get_glyph_coords(char c, float *coords)
+{
+    const int cell_x = (c & 0x7f) % NGLI_FONTATLAS_NB_COLS * NGLI_FONTATLAS_CELL_W + 1;
+    const int cell_y = (c & 0x7f) / NGLI_FONTATLAS_NB_COLS * NGLI_FONTATLAS_CELL_H + 1;
+    coords[0] = cell_x / (float)NGLI_FONTATLAS_W;
+    coords[1] = cell_y / (float)NGLI_FONTATLAS_H;
+    coords[2] = (cell_x + NGLI_FONT_W) / (float)NGLI_FONTATLAS_W;
+    coords[3] = (cell_y + NGLI_FONT_H) / (float)NGLI_FONTATLAS_H;
+}
+
+void ngli_fontatlas_release(struct ngl_ctx *ctx, struct fontatlas **atlasp)
+{
+    struct fontatlas *atlas = *atlasp;
+    if (!atlas)
+        return;
+
+    *atlasp = NULL;
+    if (--atlas->refcount)
+        return;
+
+    ngli_texture_reset(&atlas->texture);
+    ngli_hmap_set(ctx->fontatlas_pool, atlas->key, NULL);
+    ngli_free(atlas->key);
+    ngli_free(atlas);
+    if (!ngli_hmap_count(ctx->fontatlas_pool))
+        ngli_hmap_freep(&ctx->fontatlas_pool);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FONTATLAS_H
+#define FONTATLAS_H
+
+#include "drawutils.h"
+#include "texture.h"
+
+struct ngl_ctx;
+
+/*
+ * Texture holding every glyph of the font, shared by all the users of the
+ * same filtering: each glyph lies in its own cell, surrounded by a 1 pixel
+ * transparent border so the filtering does not bleed over the neighbour
+ * cells. The glyphs are white, only their alpha differs.
+ */
+#define NGLI_FONTATLAS_NB_COLS 16
+#define NGLI_FONTATLAS_NB_ROWS 8
+#define NGLI_FONTATLAS_CELL_W (NGLI_FONT_W + 2)
+#define NGLI_FONTATLAS_CELL_H (NGLI_FONT_H + 2)
+#define NGLI_FONTATLAS_W (NGLI_FONTATLAS_NB_COLS * NGLI_FONTATLAS_CELL_W)
+#define NGLI_FONTATLAS_H (NGLI_FONTATLAS_NB_ROWS * NGLI_FONTATLAS_CELL_H)
+
+struct fontatlas {
+    char *key;
+    int refcount;
+    struct texture texture;
+};
+
+int ngli_fontatlas_acquire(struct ngl_ctx *ctx, int min_filter, int mag_filter, int mipmap_filter,
+                           struct fontatlas **atlasp);
+
+/*
+ * Get the texture coordinates of the glyph of a character (u0, v0, u1, v1),
+ * the first row of the glyph being at v0
+ */
+void ngli_fontatlas_get_glyph_coords(char c, float *coords);
+
+void ngli_fontatlas_release(struct ngl_ctx *ctx, struct fontatlas **atlasp);
+
+#endif
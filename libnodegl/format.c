@@ -21,6 +21,8 @@
 
 #include "format.h"
 #include "glcontext.h"
+#include "log.h"
+#include "nodegl.h"
 #include "nodes.h"
 
 static const struct {
@@ -72,6 +74,33 @@ static const struct {
     [NGLI_FORMAT_R32_UINT]            = {1, 4},
     [NGLI_FORMAT_R32_SINT]            = {1, 4},
     [NGLI_FORMAT_R64_SINT]            = {1, 8},
+    [NGLI_FORMAT_A2B10G10R10_UNORM_PACK32] = {4, 4},
+    [NGLI_FORMAT_A2B10G10R10_SNORM_PACK32] = {4, 4},
+    [NGLI_FORMAT_B10G11R11_UFLOAT_PACK32]  = {3, 4},
+    [NGLI_FORMAT_ETC2_R8G8B8_UNORM_BLOCK]   = {3, 0},
+    [NGLI_FORMAT_ETC2_R8G8B8_SRGB_BLOCK]    = {3, 0},
+    [NGLI_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK] = {4, 0},
+    [NGLI_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK] = {4, 0},
+    [NGLI_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK]  = {4, 0},
+    [NGLI_FORMAT_EAC_R11_UNORM_BLOCK]       = {1, 0},
+    [NGLI_FORMAT_EAC_R11G11_UNORM_BLOCK]    = {2, 0},
+    [NGLI_FORMAT_ASTC_4x4_UNORM_BLOCK]      = {4, 0},
+    [NGLI_FORMAT_ASTC_4x4_SRGB_BLOCK]       = {4, 0},
+    [NGLI_FORMAT_ASTC_5x5_UNORM_BLOCK]      = {4, 0},
+    [NGLI_FORMAT_ASTC_5x5_SRGB_BLOCK]       = {4, 0},
+    [NGLI_FORMAT_ASTC_6x6_UNORM_BLOCK]      = {4, 0},
+    [NGLI_FORMAT_ASTC_6x6_SRGB_BLOCK]       = {4, 0},
+    [NGLI_FORMAT_ASTC_8x8_UNORM_BLOCK]      = {4, 0},
+    [NGLI_FORMAT_ASTC_8x8_SRGB_BLOCK]       = {4, 0},
+    [NGLI_FORMAT_BC1_RGB_UNORM_BLOCK]       = {3, 0},
+    [NGLI_FORMAT_BC1_RGBA_UNORM_BLOCK]      = {4, 0},
+    [NGLI_FORMAT_BC2_UNORM_BLOCK]           = {4, 0},
+    [NGLI_FORMAT_BC3_UNORM_BLOCK]           = {4, 0},
+    [NGLI_FORMAT_BC4_UNORM_BLOCK]           = {1, 0},
+    [NGLI_FORMAT_BC5_UNORM_BLOCK]           = {2, 0},
+    [NGLI_FORMAT_BC6H_UFLOAT_BLOCK]         = {3, 0},
+    [NGLI_FORMAT_BC7_UNORM_BLOCK]           = {4, 0},
+    [NGLI_FORMAT_BC7_SRGB_BLOCK]            = {4, 0},
     [NGLI_FORMAT_R32_SFLOAT]          = {1, 4},
     [NGLI_FORMAT_R32G32_UINT]         = {2, 4 + 4},
     [NGLI_FORMAT_R32G32_SINT]         = {2, 4 + 4},
@@ -100,6 +129,81 @@ int ngli_format_get_nb_comp(int format)
     return format_comp_sizes[format].nb_comp;
 }
 
+#define ETC2 NGLI_FEATURE_TEXTURE_COMPRESSION_ETC2
+#define ASTC NGLI_FEATURE_TEXTURE_COMPRESSION_ASTC
+#define S3TC NGLI_FEATURE_TEXTURE_COMPRESSION_S3TC
+#define RGTC NGLI_FEATURE_TEXTURE_COMPRESSION_RGTC
+#define BPTC NGLI_FEATURE_TEXTURE_COMPRESSION_BPTC
+
+static const struct compressed_format {
+    int block_width;
+    int block_height;
+    int block_size;
+    GLint internal_format;
+    uint64_t feature;
+} compressed_formats[NGLI_FORMAT_NB] = {
+    [NGLI_FORMAT_ETC2_R8G8B8_UNORM_BLOCK]   = {4, 4,  8, GL_COMPRESSED_RGB8_ETC2,                     ETC2},
+    [NGLI_FORMAT_ETC2_R8G8B8_SRGB_BLOCK]    = {4, 4,  8, GL_COMPRESSED_SRGB8_ETC2,                    ETC2},
+    [NGLI_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK] = {4, 4,  8, GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, ETC2},
+    [NGLI_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK] = {4, 4, 16, GL_COMPRESSED_RGBA8_ETC2_EAC,                ETC2},
+    [NGLI_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK]  = {4, 4, 16, GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC,         ETC2},
+    [NGLI_FORMAT_EAC_R11_UNORM_BLOCK]       = {4, 4,  8, GL_COMPRESSED_R11_EAC,                       ETC2},
+    [NGLI_FORMAT_EAC_R11G11_UNORM_BLOCK]    = {4, 4, 16, GL_COMPRESSED_RG11_EAC,                      ETC2},
+    [NGLI_FORMAT_ASTC_4x4_UNORM_BLOCK]      = {4, 4, 16, GL_COMPRESSED_RGBA_ASTC_4x4_KHR,             ASTC},
+    [NGLI_FORMAT_ASTC_4x4_SRGB_BLOCK]       = {4, 4, 16, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR,     ASTC},
+    [NGLI_FORMAT_ASTC_5x5_UNORM_BLOCK]      = {5, 5, 16, GL_COMPRESSED_RGBA_ASTC_5x5_KHR,             ASTC},
+    [NGLI_FORMAT_ASTC_5x5_SRGB_BLOCK]       = {5, 5, 16, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR,     ASTC},
+    [NGLI_FORMAT_ASTC_6x6_UNORM_BLOCK]      = {6, 6, 16, GL_COMPRESSED_RGBA_ASTC_6x6_KHR,             ASTC},
+    [NGLI_FORMAT_ASTC_6x6_SRGB_BLOCK]       = {6, 6, 16, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR,     ASTC},
+    [NGLI_FORMAT_ASTC_8x8_UNORM_BLOCK]      = {8, 8, 16, GL_COMPRESSED_RGBA_ASTC_8x8_KHR,             ASTC},
+    [NGLI_FORMAT_ASTC_8x8_SRGB_BLOCK]       = {8, 8, 16, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR,     ASTC},
+    [NGLI_FORMAT_BC1_RGB_UNORM_BLOCK]       = {4, 4,  8, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,             S3TC},
+    [NGLI_FORMAT_BC1_RGBA_UNORM_BLOCK]      = {4, 4,  8, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,            S3TC},
+    [NGLI_FORMAT_BC2_UNORM_BLOCK]           = {4, 4, 16, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,            S3TC},
+    [NGLI_FORMAT_BC3_UNORM_BLOCK]           = {4, 4, 16, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,            S3TC},
+    [NGLI_FORMAT_BC4_UNORM_BLOCK]           = {4, 4,  8, GL_COMPRESSED_RED_RGTC1,                     RGTC},
+    [NGLI_FORMAT_BC5_UNORM_BLOCK]           = {4, 4, 16, GL_COMPRESSED_RG_RGTC2,                      RGTC},
+    [NGLI_FORMAT_BC6H_UFLOAT_BLOCK]         = {4, 4, 16, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,       BPTC},
+    [NGLI_FORMAT_BC7_UNORM_BLOCK]           = {4, 4, 16, GL_COMPRESSED_RGBA_BPTC_UNORM,               BPTC},
+    [NGLI_FORMAT_BC7_SRGB_BLOCK]            = {4, 4, 16, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,         BPTC},
+};
+
+int ngli_format_is_compressed(int format)
+{
+    return compressed_formats[format].block_size != 0;
+}
+
+int64_t ngli_format_get_image_size(int format, int width, int height)
+{
+    const struct compressed_format *compressed = &compressed_formats[format];
+    if (!compressed->block_size)
+        return (int64_t)format_comp_sizes[format].size * width * height;
+    const int64_t nb_blocks_x = (width  + compressed->block_width  - 1) / compressed->block_width;
+    const int64_t nb_blocks_y = (height + compressed->block_height - 1) / compressed->block_height;
+    return nb_blocks_x * nb_blocks_y * compressed->block_size;
+}
+
+static int get_gl_compressed_format(struct glcontext *gl, int data_format,
+                                    GLint *formatp, GLint *internal_formatp, GLenum *typep)
+{
+    const struct compressed_format *compressed = &compressed_formats[data_format];
+    if (!(gl->features & compressed->feature)) {
+        LOG(ERROR, "context does not support compressed texture format 0x%x",
+            compressed->internal_format);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    /* Compressed images are transferred as is, with no pixel format nor type */
+    if (formatp)
+        *formatp = 0;
+    if (internal_formatp)
+        *internal_formatp = compressed->internal_format;
+    if (typep)
+        *typep = 0;
+
+    return 0;
+}
+
 static int get_gl_format_type(struct glcontext *gl, int data_format,
                               GLint *formatp, GLint *internal_formatp, GLenum *typep)
 {
@@ -163,6 +267,8 @@ static int get_gl_format_type(struct glcontext *gl, int data_format,
         [NGLI_FORMAT_R32G32B32A32_UINT]    = {GL_RGBA_INTEGER,    GL_RGBA32UI,           GL_UNSIGNED_INT},
         [NGLI_FORMAT_R32G32B32A32_SINT]    = {GL_RGBA_INTEGER,    GL_RGBA32I,            GL_INT},
         [NGLI_FORMAT_R32G32B32A32_SFLOAT]  = {GL_RGBA,            GL_RGBA32F,            GL_FLOAT},
+        [NGLI_FORMAT_A2B10G10R10_UNORM_PACK32] = {GL_RGBA,        GL_RGB10_A2,           GL_UNSIGNED_INT_2_10_10_10_REV},
+        [NGLI_FORMAT_B10G11R11_UFLOAT_PACK32]  = {GL_RGB,         GL_R11F_G11F_B10F,     GL_UNSIGNED_INT_10F_11F_11F_REV},
         [NGLI_FORMAT_D16_UNORM]            = {GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT16,  GL_UNSIGNED_SHORT},
         [NGLI_FORMAT_X8_D24_UNORM_PACK32]  = {GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT24,  GL_UNSIGNED_INT},
         [NGLI_FORMAT_D32_SFLOAT]           = {GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT32F, GL_FLOAT},
@@ -194,6 +300,9 @@ int ngli_format_get_gl_texture_format(struct glcontext *gl, int data_format,
     GLint internal_format;
     GLenum type;
 
+    if (ngli_format_is_compressed(data_format))
+        return get_gl_compressed_format(gl, data_format, formatp, internal_formatp, typep);
+
     int ret = get_gl_format_type(gl, data_format, &format, &internal_format, &type);
     if (ret < 0)
         return ret;
@@ -220,3 +329,67 @@ int ngli_format_get_gl_renderbuffer_format(struct glcontext *gl, int data_format
 {
     return get_gl_format_type(gl, data_format, NULL, formatp, NULL);
 }
+
+int ngli_format_get_gl_attribute_format(struct glcontext *gl, int data_format,
+                                        GLint *sizep, GLenum *typep, GLboolean *normalizedp)
+{
+    static const struct entry {
+        GLenum type;
+        GLboolean normalized;
+    } format_map[NGLI_FORMAT_NB] = {
+        [NGLI_FORMAT_R8_UNORM]                 = {GL_UNSIGNED_BYTE,                GL_TRUE},
+        [NGLI_FORMAT_R8_SNORM]                 = {GL_BYTE,                         GL_TRUE},
+        [NGLI_FORMAT_R8G8_UNORM]               = {GL_UNSIGNED_BYTE,                GL_TRUE},
+        [NGLI_FORMAT_R8G8_SNORM]               = {GL_BYTE,                         GL_TRUE},
+        [NGLI_FORMAT_R8G8B8_UNORM]             = {GL_UNSIGNED_BYTE,                GL_TRUE},
+        [NGLI_FORMAT_R8G8B8_SNORM]             = {GL_BYTE,                         GL_TRUE},
+        [NGLI_FORMAT_R8G8B8A8_UNORM]           = {GL_UNSIGNED_BYTE,                GL_TRUE},
+        [NGLI_FORMAT_R8G8B8A8_SNORM]           = {GL_BYTE,                         GL_TRUE},
+        [NGLI_FORMAT_R16_UNORM]                = {GL_UNSIGNED_SHORT,               GL_TRUE},
+        [NGLI_FORMAT_R16_SNORM]                = {GL_SHORT,                        GL_TRUE},
+        [NGLI_FORMAT_R16_SFLOAT]               = {GL_HALF_FLOAT,                   GL_FALSE},
+        [NGLI_FORMAT_R16G16_UNORM]             = {GL_UNSIGNED_SHORT,               GL_TRUE},
+        [NGLI_FORMAT_R16G16_SNORM]             = {GL_SHORT,                        GL_TRUE},
+        [NGLI_FORMAT_R16G16_SFLOAT]            = {GL_HALF_FLOAT,                   GL_FALSE},
+        [NGLI_FORMAT_R16G16B16_UNORM]          = {GL_UNSIGNED_SHORT,               GL_TRUE},
+        [NGLI_FORMAT_R16G16B16_SNORM]          = {GL_SHORT,                        GL_TRUE},
+        [NGLI_FORMAT_R16G16B16_SFLOAT]         = {GL_HALF_FLOAT,                   GL_FALSE},
+        [NGLI_FORMAT_R16G16B16A16_UNORM]       = {GL_UNSIGNED_SHORT,               GL_TRUE},
+        [NGLI_FORMAT_R16G16B16A16_SNORM]       = {GL_SHORT,                        GL_TRUE},
+        [NGLI_FORMAT_R16G16B16A16_SFLOAT]      = {GL_HALF_FLOAT,                   GL_FALSE},
+        [NGLI_FORMAT_R32_SFLOAT]               = {GL_FLOAT,                        GL_FALSE},
+        [NGLI_FORMAT_R32G32_SFLOAT]            = {GL_FLOAT,                        GL_FALSE},
+        [NGLI_FORMAT_R32G32B32_SFLOAT]         = {GL_FLOAT,                        GL_FALSE},
+        [NGLI_FORMAT_R32G32B32A32_SFLOAT]      = {GL_FLOAT,                        GL_FALSE},
+        [NGLI_FORMAT_A2B10G10R10_UNORM_PACK32] = {GL_UNSIGNED_INT_2_10_10_10_REV,  GL_TRUE},
+        [NGLI_FORMAT_A2B10G10R10_SNORM_PACK32] = {GL_INT_2_10_10_10_REV,           GL_TRUE},
+    };
+
+    ngli_assert(data_format >= 0 && data_format < NGLI_ARRAY_NB(format_map));
+    const struct entry *entry = &format_map[data_format];
+    if (!entry->type) {
+        LOG(ERROR, "format %d can not be used as a vertex attribute", data_format);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    const int es = gl->backend == NGL_BACKEND_OPENGLES;
+    if (entry->type == GL_HALF_FLOAT && es && gl->version < 300) {
+        LOG(ERROR, "half float vertex attributes are not supported by this context");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    const int packed = entry->type == GL_UNSIGNED_INT_2_10_10_10_REV || entry->type == GL_INT_2_10_10_10_REV;
+    if (packed && gl->version < (es ? 300 : 330)) {
+        LOG(ERROR, "packed 10_10_10_2 vertex attributes are not supported by this context");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    if (sizep)
+        *sizep = ngli_format_get_nb_comp(data_format);
+    if (typep)
+        *typep = entry->type;
+    if (normalizedp)
+        *normalizedp = entry->normalized;
+
+    return 0;
+}
@@ -22,6 +22,8 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
+#include <stdint.h>
+
 #include "glcontext.h"
 #include "glincludes.h"
 
@@ -82,6 +84,33 @@ enum {
     NGLI_FORMAT_R32G32B32A32_SINT,
     NGLI_FORMAT_R32G32B32A32_SFLOAT,
     NGLI_FORMAT_R64_SINT,
+    NGLI_FORMAT_A2B10G10R10_UNORM_PACK32,
+    NGLI_FORMAT_A2B10G10R10_SNORM_PACK32,
+    NGLI_FORMAT_B10G11R11_UFLOAT_PACK32,
+    NGLI_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,
+    NGLI_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,
+    NGLI_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK,
+    NGLI_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,
+    NGLI_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,
+    NGLI_FORMAT_EAC_R11_UNORM_BLOCK,
+    NGLI_FORMAT_EAC_R11G11_UNORM_BLOCK,
+    NGLI_FORMAT_ASTC_4x4_UNORM_BLOCK,
+    NGLI_FORMAT_ASTC_4x4_SRGB_BLOCK,
+    NGLI_FORMAT_ASTC_5x5_UNORM_BLOCK,
+    NGLI_FORMAT_ASTC_5x5_SRGB_BLOCK,
+    NGLI_FORMAT_ASTC_6x6_UNORM_BLOCK,
+    NGLI_FORMAT_ASTC_6x6_SRGB_BLOCK,
+    NGLI_FORMAT_ASTC_8x8_UNORM_BLOCK,
+    NGLI_FORMAT_ASTC_8x8_SRGB_BLOCK,
+    NGLI_FORMAT_BC1_RGB_UNORM_BLOCK,
+    NGLI_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    NGLI_FORMAT_BC2_UNORM_BLOCK,
+    NGLI_FORMAT_BC3_UNORM_BLOCK,
+    NGLI_FORMAT_BC4_UNORM_BLOCK,
+    NGLI_FORMAT_BC5_UNORM_BLOCK,
+    NGLI_FORMAT_BC6H_UFLOAT_BLOCK,
+    NGLI_FORMAT_BC7_UNORM_BLOCK,
+    NGLI_FORMAT_BC7_SRGB_BLOCK,
     NGLI_FORMAT_D16_UNORM,
     NGLI_FORMAT_X8_D24_UNORM_PACK32,
     NGLI_FORMAT_D32_SFLOAT,
@@ -95,6 +124,14 @@ int ngli_format_get_bytes_per_pixel(int format);
 
 int ngli_format_get_nb_comp(int format);
 
+int ngli_format_is_compressed(int format);
+
+/*
+ * Get the size in bytes of a width x height image, compressed formats being
+ * made of blocks of pixels which are always stored whole.
+ */
+int64_t ngli_format_get_image_size(int format, int width, int height);
+
 int ngli_format_get_gl_texture_format(struct glcontext *gl,
                                       int data_format,
                                       GLint *formatp,
@@ -105,5 +142,16 @@ int ngli_format_get_gl_renderbuffer_format(struct glcontext *gl,
                                            int data_format,
                                            GLint *formatp);
 
+/*
+ * Get the glVertexAttribPointer() parameters reading a buffer of the given
+ * format as floating point attributes, converted from the normalized
+ * integers or half floats if needed.
+ */
+int ngli_format_get_gl_attribute_format(struct glcontext *gl,
+                                        int data_format,
+                                        GLint *sizep,
+                                        GLenum *typep,
+                                        GLboolean *normalizedp);
+
 
 #endif
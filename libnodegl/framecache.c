@@ -0,0 +1,293 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L // stat(), opendir()
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+#include "darray.h"
+#include "framecache.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#define FRAME_MAGIC "NGLF"
+#define FRAME_SUFFIX ".frame"
+
+struct frame_header {
+    char magic[4];
+    uint32_t size;
+};
+
+struct framecache_entry {
+    int64_t size;
+    int64_t last_use;
+};
+
+struct scanned_file {
+    char *key;
+    int64_t size;
+    time_t mtime;
+};
+
+static void free_entry(void *user_arg, void *data)
+{
+    ngli_free(data);
+}
+
+static char *get_path(const struct framecache *s, const char *key)
+{
+    return ngli_arena_asprintf(s->scratch, "%s/%s" FRAME_SUFFIX, s->dir, key);
+}
+
+static int add_entry(struct framecache *s, const char *key, int64_t size)
+{
+    struct framecache_entry *entry = ngli_hmap_get(s->entries, key);
+    if (entry) {
+        s->total_size -= entry->size;
+    } else {
+        entry = ngli_calloc(1, sizeof(*entry));
+        if (!entry)
+            return NGL_ERROR_MEMORY;
+        int ret = ngli_hmap_set(s->entries, key, entry);
+        if (ret < 0) {
+            ngli_free(entry);
+            return ret;
+        }
+    }
+    entry->size = size;
+    entry->last_use = ++s->use_counter;
+    s->total_size += size;
+    return 0;
+}
+
+static void remove_entry(struct framecache *s, const char *key)
+{
+    struct framecache_entry *entry = ngli_hmap_get(s->entries, key);
+    if (!entry)
+        return;
+    s->total_size -= entry->size;
+
+    const char *path = get_path(s, key);
+    if (path)
+        remove(path);
+
+    ngli_hmap_set(s->entries, key, NULL);
+}
+
+static void evict(struct framecache *s)
+{
+    while (s->total_size > s->max_size) {
+        const struct hmap_entry *lru = NULL;
+        const struct hmap_entry *e = NULL;
+        while ((e = ngli_hmap_next(s->entries, e))) {
+            const struct framecache_entry *entry = e->data;
+            if (!lru || entry->last_use < ((const struct framecache_entry *)lru->data)->last_use)
+                lru = e;
+        }
+        if (!lru)
+            break;
+        LOG(DEBUG, "evict frame %s from the cache", lru->key);
+        char *key = ngli_arena_asprintf(s->scratch, "%s", lru->key);
+        if (!key)
+            break;
+        remove_entry(s, key);
+    }
+}
+
+static int cmp_mtime(const void *a, const void *b)
+{
+    const struct scanned_file *fa = a;
+    const struct scanned_file *fb = b;
+    return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+}
+
+/* The frames are indexed from the least to the most recently used */
+static int scan_dir(struct framecache *s)
+{
+    DIR *dir = opendir(s->dir);
+    if (!dir) {
+        LOG(ERROR, "could not open frame cache directory %s", s->dir);
+        return NGL_ERROR_IO;
+    }
+
+    int ret = 0;
+    struct darray files;
+    ngli_darray_init(&files, sizeof(struct scanned_file), 0);
+
+    const size_t suffix_len = strlen(FRAME_SUFFIX);
+    struct dirent *dirent;
+    while ((dirent = readdir(dir))) {
+        const size_t len = strlen(dirent->d_name);
+        if (len <= suffix_len || strcmp(dirent->d_name + len - suffix_len, FRAME_SUFFIX))
+            continue;
+
+        char *path = ngli_asprintf("%s/%s", s->dir, dirent->d_name);
+        if (!path) {
+            ret = NGL_ERROR_MEMORY;
+            break;
+        }
+        struct stat st;
+        const int stat_ret = stat(path, &st);
+        ngli_free(path);
+        if (stat_ret || !S_ISREG(st.st_mode))
+            continue;
+
+        struct scanned_file file = {
+            .key   = ngli_malloc(len - suffix_len + 1),
+            .size  = st.st_size,
+            .mtime = st.st_mtime,
+        };
+        if (!file.key) {
+            ret = NGL_ERROR_MEMORY;
+            break;
+        }
+        memcpy(file.key, dirent->d_name, len - suffix_len);
+        file.key[len - suffix_len] = 0;
+        if (!ngli_darray_push(&files, &file)) {
+            ngli_free(file.key);
+            ret = NGL_ERROR_MEMORY;
+            break;
+        }
+    }
+    closedir(dir);
+
+    struct scanned_file *files_data = ngli_darray_data(&files);
+    const int nb_files = ngli_darray_count(&files);
+    if (ret >= 0)
+        qsort(files_data, nb_files, sizeof(*files_data), cmp_mtime);
+    for (int i = 0; i < nb_files; i++) {
+        if (ret >= 0)
+            ret = add_entry(s, files_data[i].key, files_data[i].size);
+        ngli_free(files_data[i].key);
+    }
+    ngli_darray_reset(&files);
+    return ret;
+}
+
+int ngli_framecache_init(struct framecache *s, const char *dir, int64_t max_size, struct arena *scratch)
+{
+    s->dir = ngli_strdup(dir);
+    s->scratch = scratch;
+    s->entries = ngli_hmap_create();
+    if (!s->dir || !s->entries)
+        return NGL_ERROR_MEMORY;
+    ngli_hmap_set_free(s->entries, free_entry, NULL);
+    s->max_size = max_size;
+
+    int ret = scan_dir(s);
+    if (ret < 0)
+        return ret;
+
+    LOG(DEBUG, "%d frames (%" PRId64 " bytes) found in %s",
+        ngli_hmap_count(s->entries), s->total_size, s->dir);
+    evict(s);
+    return 0;
+}
+
+char *ngli_framecache_get_key(struct arena *arena, uint64_t scene_hash, double t, int width, int height, int format)
+{
+    uint64_t t_bits;
+    memcpy(&t_bits, &t, sizeof(t_bits));
+    return ngli_arena_asprintf(arena, "%016" PRIx64 "-%016" PRIx64 "-%dx%d-%d",
+                         scene_hash, t_bits, width, height, format);
+}
+
+int ngli_framecache_load(struct framecache *s, const char *key, uint8_t *data, int size)
+{
+    struct framecache_entry *entry = ngli_hmap_get(s->entries, key);
+    if (!entry)
+        return 0;
+
+    const char *path = get_path(s, key);
+    if (!path)
+        return 0;
+
+    int ret = 0;
+    FILE *fp = fopen(path, "rb");
+    if (fp) {
+        struct frame_header header;
+        ret = fread(&header, sizeof(header), 1, fp) == 1 &&
+              !memcmp(header.magic, FRAME_MAGIC, sizeof(header.magic)) &&
+              header.size == size &&
+              fread(data, size, 1, fp) == 1;
+        fclose(fp);
+    }
+
+    if (ret) {
+        entry->last_use = ++s->use_counter;
+        /* Keep the recency for the next sessions */
+        utime(path, NULL);
+    } else {
+        LOG(WARNING, "invalid cached frame %s, removing it", path);
+        remove_entry(s, key);
+    }
+
+    return ret;
+}
+
+int ngli_framecache_store(struct framecache *s, const char *key, const uint8_t *data, int size)
+{
+    const int64_t file_size = sizeof(struct frame_header) + size;
+    if (file_size > s->max_size)
+        return 0;
+
+    const char *path = get_path(s, key);
+    const char *tmp_path = path ? ngli_arena_asprintf(s->scratch, "%s.tmp", path) : NULL;
+    if (!tmp_path)
+        return NGL_ERROR_MEMORY;
+
+    /* Written aside and renamed, so the other sessions sharing the
+     * directory never read a partial frame */
+    struct frame_header header = {.magic = FRAME_MAGIC, .size = size};
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        LOG(WARNING, "could not open %s to store the frame", tmp_path);
+        return 0;
+    }
+    const int written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                        fwrite(data, size, 1, fp) == 1;
+    if (fclose(fp) || !written || rename(tmp_path, path)) {
+        LOG(WARNING, "could not store frame to %s", path);
+        remove(tmp_path);
+        return 0;
+    }
+
+    int ret = add_entry(s, key, file_size);
+    if (ret < 0)
+        return ret;
+    evict(s);
+    return 0;
+}
+
+void ngli_framecache_reset(struct framecache *s)
+{
+    ngli_free(s->dir);
+    ngli_hmap_freep(&s->entries);
+    memset(s, 0, sizeof(*s));
+}
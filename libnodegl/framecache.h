@@ -0,0 +1,69 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <stdint.h>
+
+#include "hmap.h"
+#include "memory.h"
+
+/*
+ * Rendered frames stored as files in a directory, identified by a key
+ * built from the scene, the time and the capture properties. The least
+ * recently used frames are removed once the files exceed the maximum size.
+ * The files found in the directory are indexed at init so the frames
+ * rendered by the previous sessions are reused as well, and their
+ * modification time is refreshed on every hit so the recency persists.
+ * The keys and paths are transient strings allocated from a scratch arena,
+ * which must not be rewound while they are in use.
+ */
+struct framecache {
+    char *dir;
+    struct arena *scratch;
+    int64_t max_size;
+    int64_t total_size;
+    int64_t use_counter;
+    struct hmap *entries; /* struct framecache_entry per key */
+};
+
+int ngli_framecache_init(struct framecache *s, const char *dir, int64_t max_size, struct arena *scratch);
+
+/*
+ * Build the key of the frame at time t of a scene identified by a hash,
+ * captured with the specified dimensions and NGL_CAPTURE_FORMAT_*, allocated
+ * from an arena
+ */
+char *ngli_framecache_get_key(struct arena *arena, uint64_t scene_hash, double t, int width, int height, int format);
+
+/*
+ * Read the frame of a key into data, which must be exactly size bytes.
+ * Return 1 on a hit, 0 otherwise.
+ */
+int ngli_framecache_load(struct framecache *s, const char *key, uint8_t *data, int size);
+
+int ngli_framecache_store(struct framecache *s, const char *key, const uint8_t *data, int size);
+
+void ngli_framecache_reset(struct framecache *s);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "framepacer.h"
+
+/* Minimum number of intervals needed to estimate the refresh period */
+#define MIN_INTERVALS 8
+
+/* A gap longer than this is a pause in the drawing, not a late frame */
+#define MAX_GAP 500000
+
+void ngli_framepacer_init(struct framepacer *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+static int cmp_int64(const void *a, const void *b)
+{
+    const int64_t va = *(const int64_t *)a;
+    const int64_t vb = *(const int64_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+static int64_t get_median_interval(const struct framepacer *s)
+{
+    int64_t intervals[NGLI_FRAMEPACER_NB_INTERVALS];
+    memcpy(intervals, s->intervals, s->nb_intervals * sizeof(*intervals));
+    qsort(intervals, s->nb_intervals, sizeof(*intervals), cmp_int64);
+    return intervals[s->nb_intervals / 2];
+}
+
+static void add_interval(struct framepacer *s, int64_t interval)
+{
+    s->intervals[s->interval_pos] = interval;
+    s->interval_pos = (s->interval_pos + 1) % NGLI_FRAMEPACER_NB_INTERVALS;
+    if (s->nb_intervals < NGLI_FRAMEPACER_NB_INTERVALS)
+        s->nb_intervals++;
+    if (s->nb_intervals >= MIN_INTERVALS)
+        s->period = get_median_interval(s);
+}
+
+void ngli_framepacer_add(struct framepacer *s, int64_t start, int64_t present)
+{
+    const int64_t render_time = present - start;
+    s->render_time = s->render_time ? (s->render_time * 7 + render_time) / 8 : render_time;
+
+    const int64_t interval = present - s->last_present;
+    if (s->last_present && interval > 0 && interval < MAX_GAP) {
+        if (s->period) {
+            const int64_t nb_periods = (interval + s->period / 2) / s->period;
+            if (nb_periods > 1) {
+                s->nb_late_frames++;
+                s->nb_dropped_frames += nb_periods - 1;
+            }
+            add_interval(s, nb_periods > 1 ? interval / nb_periods : interval);
+        } else {
+            add_interval(s, interval);
+        }
+    }
+    s->last_present = present;
+}
+
+int64_t ngli_framepacer_predict(const struct framepacer *s, int64_t now)
+{
+    const int64_t target = now + s->render_time;
+    if (!s->period || !s->last_present || target - s->last_present > MAX_GAP)
+        return target;
+
+    /* First refresh after the end of the rendering */
+    const int64_t nb_periods = (target - s->last_present + s->period - 1) / s->period;
+    return s->last_present + (nb_periods > 1 ? nb_periods : 1) * s->period;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <stdint.h>
+
+#define NGLI_FRAMEPACER_NB_INTERVALS 32
+
+/*
+ * Estimation of the display refresh period and of the presentation time of
+ * the next frame, from the times at which the previous frames have been
+ * presented (the time the buffer swap returns, which is synchronized with
+ * the vertical blanking when the swap interval is not 0).
+ *
+ * The period is the median of the recent presentation intervals, each
+ * interval being normalized by the number of refresh periods it spans so
+ * the missed refreshes do not bias the estimation.
+ */
+struct framepacer {
+    int64_t last_present;   // microseconds, 0 if no frame has been presented yet
+    int64_t period;         // microseconds, 0 while unknown
+    int64_t render_time;    // smoothed delay between a draw start and its presentation
+    int64_t intervals[NGLI_FRAMEPACER_NB_INTERVALS];
+    int nb_intervals;
+    int interval_pos;
+    int nb_late_frames;
+    int nb_dropped_frames;
+};
+
+void ngli_framepacer_init(struct framepacer *s);
+
+/*
+ * Register a frame whose draw started at the time start and which has been
+ * presented at the time present.
+ */
+void ngli_framepacer_add(struct framepacer *s, int64_t start, int64_t present);
+
+/*
+ * Predict the presentation time of a frame whose draw starts at the time now.
+ */
+int64_t ngli_framepacer_predict(const struct framepacer *s, int64_t now);
+
+#endif
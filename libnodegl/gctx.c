@@ -1,38 +1,14 @@
-/*
- * Copyright 2019 GoPro Inc.
- *
- * Licensed to the Apache Software Foundation (ASF) under one
- * or more contributor license agreements.  See the NOTICE file
- * distributed with this work for additional information
- * regarding copyright ownership.  The ASF licenses this file
- * to you under the Apache License, Version 2.0 (the
- * "License"); you may not use this file except in compliance
- * with the License.  You may obtain a copy of the License at
- *
- *   http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing,
- * software distributed under the License is distributed on an
- * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
- * KIND, either express or implied.  See the License for the
- * specific language governing permissions and limitations
- * under the License.
- */
-
 #include <string.h>
 
+#include "backend.h"
 #include "gctx.h"
 
 void ngli_gctx_set_rendertarget(struct ngl_ctx *s, struct rendertarget *rt)
 {
-    struct glcontext *gl = s->glcontext;
-
     if (rt == s->rendertarget)
         return;
 
-    const GLuint fbo_id = rt ? rt->id : ngli_glcontext_get_default_framebuffer(gl);
-    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
-
+    s->backend->set_rendertarget(s, rt);
     s->rendertarget = rt;
 }
 
@@ -43,8 +19,7 @@ struct rendertarget *ngli_gctx_get_rendertarget(struct ngl_ctx *s)
 
 void ngli_gctx_set_viewport(struct ngl_ctx *s, const int *viewport)
 {
-    struct glcontext *gl = s->glcontext;
-    ngli_glViewport(gl, viewport[0], viewport[1], viewport[2], viewport[3]);
+    s->backend->set_viewport(s, viewport);
     memcpy(&s->viewport, viewport, sizeof(s->viewport));
 }
 
@@ -55,15 +30,13 @@ void ngli_gctx_get_viewport(struct ngl_ctx *s, int *viewport)
 
 void ngli_gctx_set_scissor(struct ngl_ctx *s, const int *scissor)
 {
-    struct glcontext *gl = s->glcontext;
-    ngli_glScissor(gl, scissor[0], scissor[1], scissor[2], scissor[3]);
+    s->backend->set_scissor(s, scissor);
 }
 
 void ngli_gctx_set_clear_color(struct ngl_ctx *s, const float *color)
 {
-    struct glcontext *gl = s->glcontext;
     memcpy(s->clear_color, color, sizeof(s->clear_color));
-    ngli_glClearColor(gl, color[0], color[1], color[2], color[3]);
+    s->backend->set_clear_color(s, color);
 }
 
 void ngli_gctx_get_clear_color(struct ngl_ctx *s, float *color)
@@ -73,23 +46,31 @@ void ngli_gctx_get_clear_color(struct ngl_ctx *s, float *color)
 
 void ngli_gctx_clear_color(struct ngl_ctx *s)
 {
-    struct glcontext *gl = s->glcontext;
-    ngli_glClear(gl, GL_COLOR_BUFFER_BIT);
+    s->backend->clear(s, 1, 0);
 }
 
 void ngli_gctx_clear_depth_stencil(struct ngl_ctx *s)
 {
-    struct glcontext *gl = s->glcontext;
-    ngli_glClear(gl, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    s->backend->clear(s, 0, 1);
 }
 
-void ngli_gctx_invalidate_depth_stencil(struct ngl_ctx *s)
+void ngli_gctx_load_attachments(struct ngl_ctx *s, int color_op, int depth_stencil_op)
 {
-    struct glcontext *gl = s->glcontext;
-
-    if (!(gl->features & NGLI_FEATURE_INVALIDATE_SUBDATA))
-        return;
+    const int clear_color = color_op == NGLI_LOAD_OP_CLEAR;
+    const int clear_depth_stencil = depth_stencil_op == NGLI_LOAD_OP_CLEAR;
+    if (clear_color || clear_depth_stencil)
+        s->backend->clear(s, clear_color, clear_depth_stencil);
+
+    const int invalidate_color = color_op == NGLI_LOAD_OP_DONT_CARE;
+    const int invalidate_depth_stencil = depth_stencil_op == NGLI_LOAD_OP_DONT_CARE;
+    if (invalidate_color || invalidate_depth_stencil)
+        s->backend->invalidate(s, invalidate_color, invalidate_depth_stencil);
+}
 
-    static const GLenum attachments[] = {GL_DEPTH_ATTACHMENT, GL_STENCIL_ATTACHMENT};
-    ngli_glInvalidateFramebuffer(gl, GL_FRAMEBUFFER, NGLI_ARRAY_NB(attachments), attachments);
+void ngli_gctx_store_attachments(struct ngl_ctx *s, int color_op, int depth_stencil_op)
+{
+    const int invalidate_color = color_op == NGLI_STORE_OP_DONT_CARE;
+    const int invalidate_depth_stencil = depth_stencil_op == NGLI_STORE_OP_DONT_CARE;
+    if (invalidate_color || invalidate_depth_stencil)
+        s->backend->invalidate(s, invalidate_color, invalidate_depth_stencil);
 }
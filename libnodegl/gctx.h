@@ -36,6 +36,12 @@ void ngli_gctx_get_clear_color(struct ngl_ctx *s, float *color);
 
 void ngli_gctx_clear_color(struct ngl_ctx *s);
 void ngli_gctx_clear_depth_stencil(struct ngl_ctx *s);
-void ngli_gctx_invalidate_depth_stencil(struct ngl_ctx *s);
+
+/*
+ * Apply the load (respectively store) operations (NGLI_LOAD_OP_* and
+ * NGLI_STORE_OP_*) to the attachments of the current render target
+ */
+void ngli_gctx_load_attachments(struct ngl_ctx *s, int color_op, int depth_stencil_op);
+void ngli_gctx_store_attachments(struct ngl_ctx *s, int color_op, int depth_stencil_op);
 
 #endif
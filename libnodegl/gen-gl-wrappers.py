@@ -50,9 +50,11 @@ cmds_optional = [
     #  Buffers
     'glBindBufferBase',
     'glBindBufferRange',
+    'glCopyBufferSubData',
 
     # Compute shaders
     'glDispatchCompute',
+    'glDispatchComputeIndirect',
 
     # Shaders
     'glGetProgramResourceLocation',
@@ -73,6 +75,8 @@ cmds_optional = [
     'glGenQueries',
     'glDeleteQueries',
     'glGetQueryObjectui64v',
+    'glGetQueryObjectuiv',
+    'glQueryCounter',
 
     # Query EXT
     'glBeginQueryEXT',
@@ -80,12 +84,19 @@ cmds_optional = [
     'glGenQueriesEXT',
     'glDeleteQueriesEXT',
     'glGetQueryObjectui64vEXT',
+    'glQueryCounterEXT',
 
     # Instancing
     'glDrawArraysInstanced',
     'glDrawElementsInstanced',
     'glVertexAttribDivisor',
 
+    # Indirect draws
+    'glDrawArraysIndirect',
+    'glDrawElementsIndirect',
+    'glMultiDrawArraysIndirect',
+    'glMultiDrawElementsIndirect',
+
     # Uniform Block Object
     'glGetUniformBlockIndex',
     'glUniformBlockBinding',
@@ -99,10 +110,50 @@ cmds_optional = [
     'glFenceSync',
     'glWaitSync',
     'glClientWaitSync',
+    'glDeleteSync',
+
+    # Buffer storage and mapping
+    'glBufferStorage',
+    'glMapBufferRange',
+    'glUnmapBuffer',
+
+    # Program binary
+    'glGetProgramBinary',
+    'glProgramBinary',
+    'glProgramParameteri',
+
+    # Parallel shader compile
+    'glMaxShaderCompilerThreadsKHR',
 
     # Read/Draw Buffer
     'glReadBuffer',
     'glDrawBuffers',
+
+    # Sampler objects
+    'glBindSampler',
+    'glDeleteSamplers',
+    'glGenSamplers',
+    'glSamplerParameteri',
+
+    # Bindless textures
+    'glGetTextureHandleARB',
+    'glGetTextureSamplerHandleARB',
+    'glMakeTextureHandleResidentARB',
+    'glMakeTextureHandleNonResidentARB',
+    'glUniformHandleui64ARB',
+
+    # Debug output
+    'glDebugMessageCallback',
+    'glDebugMessageControl',
+    'glObjectLabel',
+
+    # Multisampled render to texture
+    'glFramebufferTexture2DMultisampleEXT',
+    'glRenderbufferStorageMultisampleEXT',
+
+    # Multiview
+    'glFramebufferTextureLayer',
+    'glFramebufferTextureMultiviewOVR',
 ]
 
 cmds = [
@@ -149,6 +200,8 @@ cmds = [
     # Texture
     'glActiveTexture',
     'glBindTexture',
+    'glCompressedTexImage2D',
+    'glCompressedTexSubImage2D',
     'glDeleteTextures',
     'glGenTextures',
     'glGenerateMipmap',
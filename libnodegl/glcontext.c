@@ -20,6 +20,7 @@
  */
 
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -89,15 +90,45 @@ static const int platform_to_glplatform[] = {
     [NGL_PLATFORM_WINDOWS] = GLPLATFORM_WGL,
 };
 
-static int glcontext_load_functions(struct glcontext *glcontext)
+#define NB_GLDEFINITIONS NGLI_ARRAY_NB(gldefinitions)
+
+/*
+ * Capabilities probed on a previous run with the same driver, stored in the
+ * program cache directory. The function bitmap lists the functions which
+ * were found, so the missing ones are not looked up again.
+ */
+#define CAPS_MAGIC "NGLC"
+
+struct caps_header {
+    char magic[4];
+    uint32_t layout;
+    uint32_t key_size;
+};
+
+struct caps_data {
+    int32_t version;
+    uint64_t features;
+    int32_t max_texture_image_units;
+    int32_t max_compute_work_group_counts[3];
+    int32_t max_uniform_block_size;
+    int32_t uniform_buffer_offset_alignment;
+    int32_t storage_buffer_offset_alignment;
+    int32_t max_samples;
+    int32_t max_color_attachments;
+    int32_t max_draw_buffers;
+    uint8_t funcs[(NB_GLDEFINITIONS + 7) / 8];
+};
+
+static int glcontext_load_functions(struct glcontext *glcontext, const uint8_t *found_funcs)
 {
     const struct glfunctions *gl = &glcontext->funcs;
 
     for (int i = 0; i < NGLI_ARRAY_NB(gldefinitions); i++) {
-        void *func;
+        void *func = NULL;
         const struct gldefinition *gldefinition = &gldefinitions[i];
 
-        func = ngli_glcontext_get_proc_address(glcontext, gldefinition->name);
+        if (!found_funcs || (found_funcs[i >> 3] & (1 << (i & 7))))
+            func = ngli_glcontext_get_proc_address(glcontext, gldefinition->name);
         if ((gldefinition->flags & M) && !func) {
             LOG(ERROR, "could not find core function: %s", gldefinition->name);
             return NGL_ERROR_NOT_FOUND;
@@ -287,6 +318,11 @@ static int glcontext_probe_settings(struct glcontext *glcontext)
 
     if (glcontext->features & NGLI_FEATURE_UNIFORM_BUFFER_OBJECT) {
         ngli_glGetIntegerv(glcontext, GL_MAX_UNIFORM_BLOCK_SIZE, &glcontext->max_uniform_block_size);
+        ngli_glGetIntegerv(glcontext, GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &glcontext->uniform_buffer_offset_alignment);
+    }
+
+    if (glcontext->features & NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT) {
+        ngli_glGetIntegerv(glcontext, GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &glcontext->storage_buffer_offset_alignment);
     }
 
     if (glcontext->features & NGLI_FEATURE_COMPUTE_SHADER) {
@@ -304,9 +340,149 @@ static int glcontext_probe_settings(struct glcontext *glcontext)
     return 0;
 }
 
-static int glcontext_load_extensions(struct glcontext *glcontext)
+static uint32_t hash_extensions(uint32_t layout, const char **extensions)
+{
+    for (; extensions && *extensions; extensions++)
+        layout = layout * 31 + ngli_crc32(*extensions);
+    return layout;
+}
+
+/*
+ * Changes whenever the layout of the functions or the features tables do,
+ * including the requirements of the features
+ */
+static uint32_t get_caps_layout(void)
 {
-    int ret = glcontext_load_functions(glcontext);
+    uint32_t layout = sizeof(struct caps_data);
+    for (int i = 0; i < NGLI_ARRAY_NB(gldefinitions); i++)
+        layout = layout * 31 + ngli_crc32(gldefinitions[i].name);
+    for (int i = 0; i < NGLI_ARRAY_NB(glfeatures); i++) {
+        const struct glfeature *glfeature = &glfeatures[i];
+        layout = layout * 31 + ngli_crc32(glfeature->name);
+        layout = layout * 31 + glfeature->version;
+        layout = layout * 31 + glfeature->es_version;
+        layout = hash_extensions(layout, glfeature->extensions);
+        layout = hash_extensions(layout, glfeature->es_extensions);
+    }
+    return layout;
+}
+
+static char *get_caps_key(struct glcontext *glcontext)
+{
+    glcontext->funcs.GetString = ngli_glcontext_get_proc_address(glcontext, "glGetString");
+    if (!glcontext->funcs.GetString)
+        return NULL;
+
+    const char *vendor   = (const char *)ngli_glGetString(glcontext, GL_VENDOR);
+    const char *renderer = (const char *)ngli_glGetString(glcontext, GL_RENDERER);
+    const char *version  = (const char *)ngli_glGetString(glcontext, GL_VERSION);
+    if (!vendor || !renderer || !version)
+        return NULL;
+
+    return ngli_asprintf("%d\n%s\n%s\n%s", glcontext->backend, vendor, renderer, version);
+}
+
+static int glcontext_load_caps(struct glcontext *glcontext, const char *path, const char *key)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+
+    int ret = 0;
+    char *data = NULL;
+    const uint32_t key_size = strlen(key);
+    struct caps_header header;
+    struct caps_data caps;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, CAPS_MAGIC, sizeof(header.magic)) ||
+        header.layout != get_caps_layout() ||
+        header.key_size != key_size)
+        goto end;
+
+    data = ngli_malloc(key_size);
+    if (!data)
+        goto end;
+    if (fread(data, key_size, 1, fp) != 1 || memcmp(data, key, key_size) ||
+        fread(&caps, sizeof(caps), 1, fp) != 1)
+        goto end;
+
+    if (glcontext_load_functions(glcontext, caps.funcs) < 0)
+        goto end;
+
+    glcontext->version = caps.version;
+    glcontext->features |= caps.features;
+    glcontext->max_texture_image_units = caps.max_texture_image_units;
+    memcpy(glcontext->max_compute_work_group_counts, caps.max_compute_work_group_counts,
+           sizeof(glcontext->max_compute_work_group_counts));
+    glcontext->max_uniform_block_size = caps.max_uniform_block_size;
+    glcontext->uniform_buffer_offset_alignment = caps.uniform_buffer_offset_alignment;
+    glcontext->storage_buffer_offset_alignment = caps.storage_buffer_offset_alignment;
+    glcontext->max_samples = caps.max_samples;
+    glcontext->max_color_attachments = caps.max_color_attachments;
+    glcontext->max_draw_buffers = caps.max_draw_buffers;
+    ret = 1;
+
+end:
+    ngli_free(data);
+    fclose(fp);
+    return ret;
+}
+
+static void glcontext_save_caps(const struct glcontext *glcontext, const char *path, const char *key,
+                                uint64_t probed_features)
+{
+    struct caps_data caps = {
+        .version                         = glcontext->version,
+        .features                        = probed_features,
+        .max_texture_image_units         = glcontext->max_texture_image_units,
+        .max_uniform_block_size          = glcontext->max_uniform_block_size,
+        .uniform_buffer_offset_alignment = glcontext->uniform_buffer_offset_alignment,
+        .storage_buffer_offset_alignment = glcontext->storage_buffer_offset_alignment,
+        .max_samples                     = glcontext->max_samples,
+        .max_color_attachments           = glcontext->max_color_attachments,
+        .max_draw_buffers                = glcontext->max_draw_buffers,
+    };
+    memcpy(caps.max_compute_work_group_counts, glcontext->max_compute_work_group_counts,
+           sizeof(caps.max_compute_work_group_counts));
+
+    const struct glfunctions *gl = &glcontext->funcs;
+    for (int i = 0; i < NGLI_ARRAY_NB(gldefinitions); i++) {
+        if (*(void **)((uint8_t *)gl + gldefinitions[i].offset))
+            caps.funcs[i >> 3] |= 1 << (i & 7);
+    }
+
+    char *tmp_path = ngli_asprintf("%s.tmp", path);
+    if (!tmp_path)
+        return;
+
+    const uint32_t key_size = strlen(key);
+    struct caps_header header = {
+        .magic    = CAPS_MAGIC,
+        .layout   = get_caps_layout(),
+        .key_size = key_size,
+    };
+
+    /* Same atomic replacement as the program binaries */
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        LOG(WARNING, "could not open %s to store the OpenGL capabilities", tmp_path);
+        goto end;
+    }
+    const int written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                        fwrite(key, key_size, 1, fp) == 1 &&
+                        fwrite(&caps, sizeof(caps), 1, fp) == 1;
+    if (fclose(fp) || !written || rename(tmp_path, path)) {
+        LOG(WARNING, "could not store OpenGL capabilities to %s", path);
+        remove(tmp_path);
+    }
+
+end:
+    ngli_free(tmp_path);
+}
+
+static int glcontext_probe_caps(struct glcontext *glcontext)
+{
+    int ret = glcontext_load_functions(glcontext, NULL);
     if (ret < 0)
         return ret;
 
@@ -329,6 +505,36 @@ static int glcontext_load_extensions(struct glcontext *glcontext)
     return 0;
 }
 
+static int glcontext_load_extensions(struct glcontext *glcontext, const char *cache_dir)
+{
+    if (!cache_dir)
+        return glcontext_probe_caps(glcontext);
+
+    char *path = NULL;
+    char *key = get_caps_key(glcontext);
+    if (key)
+        path = ngli_asprintf("%s/caps-%08x.bin", cache_dir, ngli_crc32(key));
+    if (!path) {
+        ngli_free(key);
+        return glcontext_probe_caps(glcontext);
+    }
+
+    int ret = 0;
+    if (glcontext_load_caps(glcontext, path, key)) {
+        LOG(INFO, "OpenGL capabilities loaded from %s", path);
+    } else {
+        /* The features set by the platform are not part of the cache */
+        const uint64_t platform_features = glcontext->features;
+        ret = glcontext_probe_caps(glcontext);
+        if (ret >= 0)
+            glcontext_save_caps(glcontext, path, key, glcontext->features & ~platform_features);
+    }
+
+    ngli_free(path);
+    ngli_free(key);
+    return ret;
+}
+
 struct glcontext *ngli_glcontext_new(const struct ngl_config *config)
 {
     if (config->platform < 0 || config->platform >= NGLI_ARRAY_NB(platform_to_glplatform))
@@ -354,6 +560,7 @@ struct glcontext *ngli_glcontext_new(const struct ngl_config *config)
     glcontext->platform = config->platform;
     glcontext->backend = config->backend;
     glcontext->offscreen = config->offscreen;
+    glcontext->device = config->device;
     glcontext->width = config->width;
     glcontext->height = config->height;
     glcontext->samples = config->samples;
@@ -368,10 +575,13 @@ struct glcontext *ngli_glcontext_new(const struct ngl_config *config)
     if (ret < 0)
         goto fail;
 
-    ret = glcontext_load_extensions(glcontext);
+    ret = glcontext_load_extensions(glcontext, config->program_cache_dir);
     if (ret < 0)
         goto fail;
 
+    if (config->debug)
+        ngli_glcontext_set_debug(glcontext, 1);
+
     if (!glcontext->offscreen) {
         int ret = ngli_glcontext_resize(glcontext);
         if (ret < 0)
@@ -387,6 +597,39 @@ fail:
     return NULL;
 }
 
+struct glcontext *ngli_glcontext_new_shared(const struct glcontext *other)
+{
+    if (!other->class->init_shared)
+        return NULL;
+
+    struct glcontext *glcontext = ngli_calloc(1, sizeof(*glcontext));
+    if (!glcontext)
+        return NULL;
+
+    /* Same driver and configuration: the version, features, limits and
+     * functions of the other context apply as is */
+    *glcontext = *other;
+    glcontext->priv_data = NULL;
+    glcontext->offscreen = 1;
+    glcontext->debug = 0;
+
+    if (glcontext->class->priv_size) {
+        glcontext->priv_data = ngli_calloc(1, glcontext->class->priv_size);
+        if (!glcontext->priv_data) {
+            ngli_free(glcontext);
+            return NULL;
+        }
+    }
+
+    int ret = glcontext->class->init_shared(glcontext, other);
+    if (ret < 0) {
+        ngli_glcontext_freep(&glcontext);
+        return NULL;
+    }
+
+    return glcontext;
+}
+
 int ngli_glcontext_make_current(struct glcontext *glcontext, int current)
 {
     if (glcontext->class->make_current)
@@ -409,6 +652,27 @@ void ngli_glcontext_swap_buffers(struct glcontext *glcontext)
         glcontext->class->swap_buffers(glcontext);
 }
 
+void ngli_glcontext_swap_buffers_with_damage(struct glcontext *glcontext, const int *rect)
+{
+    if (glcontext->class->swap_buffers_with_damage)
+        glcontext->class->swap_buffers_with_damage(glcontext, rect);
+    else
+        ngli_glcontext_swap_buffers(glcontext);
+}
+
+int ngli_glcontext_get_buffer_age(struct glcontext *glcontext)
+{
+    if (glcontext->class->get_buffer_age)
+        return glcontext->class->get_buffer_age(glcontext);
+    return 0;
+}
+
+void ngli_glcontext_set_damage_region(struct glcontext *glcontext, const int *rect)
+{
+    if (glcontext->class->set_damage_region)
+        glcontext->class->set_damage_region(glcontext, rect);
+}
+
 void ngli_glcontext_set_surface_pts(struct glcontext *glcontext, double t)
 {
     if (glcontext->class->set_surface_pts)
@@ -428,6 +692,81 @@ int ngli_glcontext_resize(struct glcontext *glcontext)
     return NGL_ERROR_UNSUPPORTED;
 }
 
+int ngli_glcontext_set_window(struct glcontext *glcontext, uintptr_t window)
+{
+    if (glcontext->offscreen || !glcontext->class->set_window)
+        return NGL_ERROR_UNSUPPORTED;
+
+    return glcontext->class->set_window(glcontext, window);
+}
+
+static const char *get_debug_type_str(GLenum type)
+{
+    switch (type) {
+    case GL_DEBUG_TYPE_ERROR:               return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+    default:                                return "message";
+    }
+}
+
+/*
+ * Called by the driver, possibly from one of its own threads and after the
+ * command involved returned since the output is not synchronous.
+ */
+static void NGLI_GL_APIENTRY debug_message_callback(GLenum source, GLenum type, GLuint id,
+                                                    GLenum severity, GLsizei length,
+                                                    const GLchar *message, const void *user_param)
+{
+    const char *type_str = get_debug_type_str(type);
+    switch (severity) {
+    case GL_DEBUG_SEVERITY_HIGH:   LOG(ERROR,   "GL %s 0x%x: %s", type_str, id, message); break;
+    case GL_DEBUG_SEVERITY_MEDIUM: LOG(WARNING, "GL %s 0x%x: %s", type_str, id, message); break;
+    case GL_DEBUG_SEVERITY_LOW:    LOG(INFO,    "GL %s 0x%x: %s", type_str, id, message); break;
+    default:                       LOG(DEBUG,   "GL %s 0x%x: %s", type_str, id, message); break;
+    }
+}
+
+void ngli_glcontext_set_debug(struct glcontext *glcontext, int debug)
+{
+    if (glcontext->debug == debug)
+        return;
+    glcontext->debug = debug;
+
+    if (!(glcontext->features & NGLI_FEATURE_KHR_DEBUG)) {
+        if (debug)
+            LOG(WARNING, "context does not support KHR_debug, only the GL errors will be reported");
+        return;
+    }
+
+    if (!debug) {
+        ngli_glDisable(glcontext, GL_DEBUG_OUTPUT);
+        ngli_glDebugMessageCallback(glcontext, NULL, NULL);
+        return;
+    }
+
+    /* The notifications (such as the buffer placements) are too verbose to
+     * be reported every frame */
+    ngli_glDebugMessageControl(glcontext, GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+    ngli_glDebugMessageControl(glcontext, GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
+    ngli_glDebugMessageCallback(glcontext, debug_message_callback, NULL);
+    ngli_glEnable(glcontext, GL_DEBUG_OUTPUT);
+}
+
+/* Lower bound of GL_MAX_LABEL_LENGTH, terminating character included */
+#define MAX_LABEL_LENGTH 256
+
+void ngli_glcontext_set_object_label(struct glcontext *glcontext, GLenum identifier, GLuint name, const char *label)
+{
+    if (!glcontext->debug || !(glcontext->features & NGLI_FEATURE_KHR_DEBUG) || !name || !label)
+        return;
+
+    const size_t length = strlen(label);
+    ngli_glObjectLabel(glcontext, identifier, name, NGLI_MIN(length, MAX_LABEL_LENGTH - 1), label);
+}
+
 void ngli_glcontext_freep(struct glcontext **glcontextp)
 {
     struct glcontext *glcontext;
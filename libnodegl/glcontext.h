@@ -54,12 +54,65 @@
 #define NGLI_FEATURE_TEXTURE_CUBE_MAP             (1 << 25)
 #define NGLI_FEATURE_DRAW_BUFFERS                 (1 << 26)
 #define NGLI_FEATURE_ROW_LENGTH                   (1 << 27)
+#define NGLI_FEATURE_BUFFER_STORAGE               (1 << 28)
+#define NGLI_FEATURE_MAP_BUFFER_RANGE             (1 << 29)
+#define NGLI_FEATURE_PROGRAM_BINARY               (1 << 30)
+#define NGLI_FEATURE_PARALLEL_SHADER_COMPILE      (1ULL << 31)
+#define NGLI_FEATURE_DRAW_INDIRECT                (1ULL << 32)
+#define NGLI_FEATURE_MULTI_DRAW_INDIRECT          (1ULL << 33)
+#define NGLI_FEATURE_TEXTURE_COMPRESSION_ETC2     (1ULL << 34)
+#define NGLI_FEATURE_TEXTURE_COMPRESSION_ASTC     (1ULL << 35)
+#define NGLI_FEATURE_TEXTURE_COMPRESSION_S3TC     (1ULL << 36)
+#define NGLI_FEATURE_TEXTURE_COMPRESSION_RGTC     (1ULL << 37)
+#define NGLI_FEATURE_TEXTURE_COMPRESSION_BPTC     (1ULL << 38)
+#define NGLI_FEATURE_EGL_ANDROID_NATIVE_BUFFER    (1ULL << 39)
+#define NGLI_FEATURE_BINDLESS_TEXTURE            (1ULL << 40)
+#define NGLI_FEATURE_SAMPLER_OBJECT              (1ULL << 41)
+#define NGLI_FEATURE_MULTISAMPLED_RENDER_TO_TEXTURE (1ULL << 42)
+#define NGLI_FEATURE_OCCLUSION_QUERY             (1ULL << 43)
+#define NGLI_FEATURE_KHR_DEBUG                   (1ULL << 44)
+#define NGLI_FEATURE_COPY_BUFFER                 (1ULL << 45)
+#define NGLI_FEATURE_WGL_NV_DX_INTEROP2          (1ULL << 46)
+#define NGLI_FEATURE_SHADER_FRAMEBUFFER_FETCH    (1ULL << 47)
+#define NGLI_FEATURE_OVR_MULTIVIEW               (1ULL << 48)
+#define NGLI_FEATURE_COLOR_BUFFER_FLOAT          (1ULL << 49)
 
 #define NGLI_FEATURE_COMPUTE_SHADER_ALL (NGLI_FEATURE_COMPUTE_SHADER           | \
                                          NGLI_FEATURE_PROGRAM_INTERFACE_QUERY  | \
                                          NGLI_FEATURE_SHADER_IMAGE_LOAD_STORE  | \
                                          NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT)
 
+#define NGLI_GLBINDINGS_MAX_TEXTURE_UNITS   64
+#define NGLI_GLBINDINGS_MAX_BUFFER_BINDINGS 32
+
+enum {
+    NGLI_GLBINDINGS_TEXTURE_2D,
+    NGLI_GLBINDINGS_TEXTURE_2D_RECT,
+    NGLI_GLBINDINGS_TEXTURE_3D,
+    NGLI_GLBINDINGS_TEXTURE_CUBE,
+    NGLI_GLBINDINGS_TEXTURE_EXTERNAL_OES,
+    NGLI_GLBINDINGS_TEXTURE_NB
+};
+
+/*
+ * Object bindings currently set in the GL context, maintained by the
+ * ngli_glstate_bind_*() functions. NGLI_GLBINDINGS_UNKNOWN marks the
+ * bindings which need to be set unconditionally.
+ */
+#define NGLI_GLBINDINGS_UNKNOWN ((GLuint)-1)
+
+struct glbindings {
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    GLuint element_array_buffer;
+    GLuint uniform_buffers[NGLI_GLBINDINGS_MAX_BUFFER_BINDINGS];
+    GLuint storage_buffers[NGLI_GLBINDINGS_MAX_BUFFER_BINDINGS];
+    GLenum active_texture;
+    GLuint textures[NGLI_GLBINDINGS_MAX_TEXTURE_UNITS][NGLI_GLBINDINGS_TEXTURE_NB];
+    GLuint samplers[NGLI_GLBINDINGS_MAX_TEXTURE_UNITS];
+};
+
 struct glcontext_class;
 
 struct glcontext {
@@ -71,31 +124,43 @@ struct glcontext {
     int platform;
     int backend;
     int offscreen;
+    int device;
     int width;
     int height;
     int samples;
+    int debug;
 
     /* GL api */
     int version;
 
     /* GL features */
-    int features;
+    uint64_t features;
     int max_texture_image_units;
     int max_compute_work_group_counts[3];
     int max_uniform_block_size;
+    int uniform_buffer_offset_alignment;
+    int storage_buffer_offset_alignment;
     int max_samples;
     int max_color_attachments;
     int max_draw_buffers;
 
     /* GL functions */
     struct glfunctions funcs;
+
+    /* GL bindings cache */
+    struct glbindings bindings;
 };
 
 struct glcontext_class {
     int (*init)(struct glcontext *glcontext, uintptr_t display, uintptr_t window, uintptr_t handle);
+    int (*init_shared)(struct glcontext *glcontext, const struct glcontext *other);
     int (*resize)(struct glcontext *glcontext);
+    int (*set_window)(struct glcontext *glcontext, uintptr_t window);
     int (*make_current)(struct glcontext *glcontext, int current);
     void (*swap_buffers)(struct glcontext *glcontext);
+    void (*swap_buffers_with_damage)(struct glcontext *glcontext, const int *rect);
+    int (*get_buffer_age)(struct glcontext *glcontext);
+    void (*set_damage_region)(struct glcontext *glcontext, const int *rect);
     int (*set_swap_interval)(struct glcontext *glcontext, int interval);
     void (*set_surface_pts)(struct glcontext *glcontext, double t);
     void* (*get_texture_cache)(struct glcontext *glcontext);
@@ -108,16 +173,56 @@ struct glcontext_class {
 };
 
 struct glcontext *ngli_glcontext_new(const struct ngl_config *config);
+
+/*
+ * Create an offscreen context sharing the objects of another one, to be
+ * made current by another thread. It inherits the capabilities probed for
+ * the other context. Return NULL if the platform does not support it.
+ */
+struct glcontext *ngli_glcontext_new_shared(const struct glcontext *other);
 int ngli_glcontext_make_current(struct glcontext *glcontext, int current);
 void ngli_glcontext_swap_buffers(struct glcontext *glcontext);
+
+/*
+ * Present the back buffer, hinting that only rect ({x, y, width, height}
+ * from the bottom left corner) changed since the last presentation.
+ */
+void ngli_glcontext_swap_buffers_with_damage(struct glcontext *glcontext, const int *rect);
+
+/*
+ * Number of frames since the back buffer content has been drawn, 0 if its
+ * content is unknown.
+ */
+int ngli_glcontext_get_buffer_age(struct glcontext *glcontext);
+
+/*
+ * Restrict the updates of the back buffer to rect, which must be called once
+ * the buffer age has been queried and before drawing.
+ */
+void ngli_glcontext_set_damage_region(struct glcontext *glcontext, const int *rect);
 int ngli_glcontext_set_swap_interval(struct glcontext *glcontext, int interval);
 void ngli_glcontext_set_surface_pts(struct glcontext *glcontext, double t);
 int ngli_glcontext_resize(struct glcontext *glcontext);
+
+/*
+ * Render into another native window while keeping the GL context (and thus
+ * all its objects). Return NGL_ERROR_UNSUPPORTED if the platform can not
+ * switch windows in place.
+ */
+int ngli_glcontext_set_window(struct glcontext *glcontext, uintptr_t window);
 void *ngli_glcontext_get_proc_address(struct glcontext *glcontext, const char *name);
 void *ngli_glcontext_get_texture_cache(struct glcontext *glcontext);
 uintptr_t ngli_glcontext_get_display(struct glcontext *glcontext);
 uintptr_t ngli_glcontext_get_handle(struct glcontext *glcontext);
 GLuint ngli_glcontext_get_default_framebuffer(struct glcontext *glcontext);
+
+/*
+ * Report the messages of the GL debug output (KHR_debug) through the log,
+ * asynchronously and at a level matching their severity, and label the GL
+ * objects given to ngli_glcontext_set_object_label().
+ */
+void ngli_glcontext_set_debug(struct glcontext *glcontext, int debug);
+void ngli_glcontext_set_object_label(struct glcontext *glcontext, GLenum identifier, GLuint name, const char *label);
 void ngli_glcontext_freep(struct glcontext **glcontext);
 int ngli_glcontext_check_extension(const char *extension, const char *extensions);
 int ngli_glcontext_check_gl_error(const struct glcontext *glcontext, const char *context);
@@ -39,6 +39,12 @@
 #include "utils.h"
 
 #define EGL_PLATFORM_X11 0x31D5
+#define EGL_PLATFORM_DEVICE 0x313F
+#define EGL_PLATFORM_SURFACELESS 0x31DD
+
+#ifndef EGL_BUFFER_AGE_KHR
+#define EGL_BUFFER_AGE_KHR 0x313D
+#endif
 
 struct egl_priv {
     EGLNativeDisplayType native_display;
@@ -51,9 +57,16 @@ struct egl_priv {
     const char *extensions;
     EGLBoolean (*PresentationTimeANDROID)(EGLDisplay dpy, EGLSurface sur, khronos_stime_nanoseconds_t time);
     EGLDisplay (*GetPlatformDisplay)(EGLenum platform, void *native_display, const EGLint *attrib_list);
+    EGLBoolean (*QueryDevices)(EGLint max_devices, void **devices, EGLint *nb_devices);
+    int surfaceless;
+    int shared; /* created by egl_init_shared() */
     EGLAPIENTRY EGLImageKHR (*CreateImageKHR)(EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, const EGLint *);
     EGLAPIENTRY EGLBoolean (*DestroyImageKHR)(EGLDisplay, EGLImageKHR);
     EGLAPIENTRY void (*EGLImageTargetTexture2DOES)(GLenum, GLeglImageOES);
+    EGLAPIENTRY EGLClientBuffer (*GetNativeClientBufferANDROID)(const struct AHardwareBuffer *);
+    int has_buffer_age;
+    EGLAPIENTRY EGLBoolean (*SetDamageRegionKHR)(EGLDisplay, EGLSurface, EGLint *, EGLint);
+    EGLAPIENTRY EGLBoolean (*SwapBuffersWithDamage)(EGLDisplay, EGLSurface, EGLint *, EGLint);
 };
 
 EGLImageKHR ngli_eglCreateImageKHR(struct glcontext *gl, EGLConfig context, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list)
@@ -68,6 +81,14 @@ EGLBoolean ngli_eglDestroyImageKHR(struct glcontext *gl, EGLImageKHR image)
     return egl->DestroyImageKHR(egl->display, image);
 }
 
+#if defined(TARGET_ANDROID)
+EGLClientBuffer ngli_eglGetNativeClientBufferANDROID(struct glcontext *gl, const struct AHardwareBuffer *buffer)
+{
+    struct egl_priv *egl = gl->priv_data;
+    return egl->GetNativeClientBufferANDROID(buffer);
+}
+#endif
+
 static int egl_probe_extensions(struct glcontext *ctx)
 {
     struct egl_priv *egl = ctx->priv_data;
@@ -96,10 +117,55 @@ static int egl_probe_extensions(struct glcontext *ctx)
         ctx->features |= NGLI_FEATURE_EGL_EXT_IMAGE_DMA_BUF_IMPORT;
     }
 
+    /* EGL_KHR_partial_update also defines the buffer age query */
+    if (ngli_glcontext_check_extension("EGL_KHR_partial_update", egl->extensions)) {
+        egl->SetDamageRegionKHR = (void *)eglGetProcAddress("eglSetDamageRegionKHR");
+        if (!egl->SetDamageRegionKHR) {
+            LOG(ERROR, "could not retrieve eglSetDamageRegionKHR()");
+            return -1;
+        }
+        egl->has_buffer_age = 1;
+    }
+
+    if (ngli_glcontext_check_extension("EGL_EXT_buffer_age", egl->extensions))
+        egl->has_buffer_age = 1;
+
+    if (ngli_glcontext_check_extension("EGL_KHR_swap_buffers_with_damage", egl->extensions))
+        egl->SwapBuffersWithDamage = (void *)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    else if (ngli_glcontext_check_extension("EGL_EXT_swap_buffers_with_damage", egl->extensions))
+        egl->SwapBuffersWithDamage = (void *)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+
+#if defined(TARGET_ANDROID)
+    if (ngli_glcontext_check_extension("EGL_ANDROID_get_native_client_buffer", egl->extensions) &&
+        ngli_glcontext_check_extension("EGL_ANDROID_image_native_buffer", egl->extensions)) {
+        egl->GetNativeClientBufferANDROID = (void *)eglGetProcAddress("eglGetNativeClientBufferANDROID");
+        if (!egl->GetNativeClientBufferANDROID) {
+            LOG(ERROR, "could not retrieve eglGetNativeClientBufferANDROID()");
+            return -1;
+        }
+        ctx->features |= NGLI_FEATURE_EGL_ANDROID_NATIVE_BUFFER;
+    }
+#endif
+
     return 0;
 }
 
 #if defined(TARGET_LINUX)
+static int egl_load_get_platform_display(struct egl_priv *egl)
+{
+    if (egl->GetPlatformDisplay)
+        return 0;
+
+    egl->GetPlatformDisplay = (void *)eglGetProcAddress("eglGetPlatformDisplay");
+    if (!egl->GetPlatformDisplay)
+        egl->GetPlatformDisplay = (void *)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!egl->GetPlatformDisplay) {
+        LOG(ERROR, "could not retrieve eglGetPlatformDisplay()");
+        return -1;
+    }
+    return 0;
+}
+
 static int egl_probe_platform_x11_ext(struct egl_priv *egl)
 {
     const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
@@ -110,18 +176,56 @@ static int egl_probe_platform_x11_ext(struct egl_priv *egl)
 
     if (ngli_glcontext_check_extension("EGL_KHR_platform_x11", client_extensions) ||
         ngli_glcontext_check_extension("EGL_EXT_platform_x11", client_extensions)) {
-        egl->GetPlatformDisplay = (void *)eglGetProcAddress("eglGetPlatformDisplay");
-        if (!egl->GetPlatformDisplay)
-            egl->GetPlatformDisplay = (void *)eglGetProcAddress("eglGetPlatformDisplayEXT");
-        if (!egl->GetPlatformDisplay) {
-            LOG(ERROR, "could not retrieve eglGetPlatformDisplay()");
-            return -1;
-        }
+        int ret = egl_load_get_platform_display(egl);
+        if (ret < 0)
+            return ret;
         return 1;
     }
 
     return 0;
 }
+
+/*
+ * Display of an EGL device, or of the Mesa surfaceless platform for the
+ * first device, available without any display server
+ */
+static EGLDisplay egl_get_headless_display(struct egl_priv *egl, int device)
+{
+    const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!client_extensions)
+        return EGL_NO_DISPLAY;
+
+    if (ngli_glcontext_check_extension("EGL_EXT_platform_device", client_extensions) &&
+        ngli_glcontext_check_extension("EGL_EXT_device_enumeration", client_extensions)) {
+        egl->QueryDevices = (void *)eglGetProcAddress("eglQueryDevicesEXT");
+        if (!egl->QueryDevices || egl_load_get_platform_display(egl) < 0)
+            return EGL_NO_DISPLAY;
+
+        void *devices[16];
+        EGLint nb_devices = 0;
+        if (!egl->QueryDevices(NGLI_ARRAY_NB(devices), devices, &nb_devices) || !nb_devices) {
+            LOG(ERROR, "could not query EGL devices: 0x%x", eglGetError());
+            return EGL_NO_DISPLAY;
+        }
+
+        const int index = device ? device - 1 : 0;
+        if (index >= nb_devices) {
+            LOG(ERROR, "EGL device %d requested but only %d are available", device, nb_devices);
+            return EGL_NO_DISPLAY;
+        }
+
+        LOG(INFO, "rendering on EGL device %d/%d", index + 1, nb_devices);
+        return egl->GetPlatformDisplay(EGL_PLATFORM_DEVICE, devices[index], NULL);
+    }
+
+    if (device <= 1 && ngli_glcontext_check_extension("EGL_MESA_platform_surfaceless", client_extensions)) {
+        if (egl_load_get_platform_display(egl) < 0)
+            return EGL_NO_DISPLAY;
+        return egl->GetPlatformDisplay(EGL_PLATFORM_SURFACELESS, EGL_DEFAULT_DISPLAY, NULL);
+    }
+
+    return EGL_NO_DISPLAY;
+}
 #endif
 
 static int egl_set_native_display(struct egl_priv *egl, uintptr_t native_display)
@@ -158,51 +262,30 @@ static EGLDisplay egl_get_display(struct egl_priv *egl, EGLNativeDisplayType nat
 #endif
 }
 
-static int egl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window, uintptr_t other)
+static int egl_create_window_surface(struct egl_priv *egl, uintptr_t window)
 {
-    struct egl_priv *egl = ctx->priv_data;
-
-    int ret = egl_set_native_display(egl, display);
-    if (ret < 0) {
-        LOG(ERROR, "could not set native display");
+    egl->native_window = (EGLNativeWindowType)window;
+    if (!egl->native_window) {
+        LOG(ERROR, "could not retrieve EGL native window");
         return -1;
     }
-
-    egl->display = egl_get_display(egl, egl->native_display);
-    if (!egl->display) {
-        LOG(ERROR, "could not retrieve EGL display");
-        return -1;
-    }
-
-    EGLint egl_minor;
-    EGLint egl_major;
-    ret = eglInitialize(egl->display, &egl_major, &egl_minor);
-    if (!ret) {
-        LOG(ERROR, "could initialize EGL: 0x%x", eglGetError());
-        return -1;
-    }
-
-    egl->extensions = eglQueryString(egl->display, EGL_EXTENSIONS);
-    if (!egl->extensions) {
-        LOG(ERROR, "could not retrieve EGL extensions");
-        return -1;
-    }
-
-    if (egl_major < 1 || egl_minor < 4) {
-        LOG(ERROR, "unsupported EGL version %d.%d, only 1.4+ is supported", egl_major, egl_minor);
+    egl->surface = eglCreateWindowSurface(egl->display, egl->config, egl->native_window, NULL);
+    if (!egl->surface) {
+        LOG(ERROR, "could not create EGL window surface: 0x%x", eglGetError());
         return -1;
     }
+    return 0;
+}
 
-    int api = ctx->backend == NGL_BACKEND_OPENGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API;
-    if (!eglBindAPI(api)) {
-        LOG(ERROR, "could not bind OpenGL%s API", ctx->backend == NGL_BACKEND_OPENGL ? "" : "ES");
-        return -1;
-    }
+static int egl_choose_config(struct glcontext *ctx)
+{
+    struct egl_priv *egl = ctx->priv_data;
 
     const EGLint type = ctx->backend == NGL_BACKEND_OPENGL ? EGL_OPENGL_BIT : EGL_OPENGL_ES2_BIT;
+    const EGLint surface_type = egl->surfaceless ? 0 : ctx->offscreen ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT;
     const EGLint config_attribs[] = {
         EGL_RENDERABLE_TYPE, type,
-        EGL_SURFACE_TYPE, ctx->offscreen ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT,
+        EGL_SURFACE_TYPE, surface_type,
         EGL_RED_SIZE,   8,
         EGL_GREEN_SIZE, 8,
         EGL_BLUE_SIZE,  8,
@@ -215,13 +298,18 @@ static int egl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window,
     };
 
     EGLint nb_configs;
-    ret = eglChooseConfig(egl->display, config_attribs, &egl->config, 1, &nb_configs);
+    int ret = eglChooseConfig(egl->display, config_attribs, &egl->config, 1, &nb_configs);
     if (!ret || !nb_configs) {
         LOG(ERROR, "could not choose a valid EGL configuration: 0x%x", eglGetError());
         return -1;
     }
 
-    EGLContext shared_context = other ? (EGLContext)other : NULL;
+    return 0;
+}
+
+static int egl_create_context(struct glcontext *ctx, EGLContext shared_context)
+{
+    struct egl_priv *egl = ctx->priv_data;
 
     if (ctx->backend == NGL_BACKEND_OPENGL) {
         static const EGLint ctx_attribs[] = {
@@ -246,32 +334,104 @@ static int egl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window,
         return -1;
     }
 
-    if (ctx->offscreen) {
-        const EGLint attribs[] = {
-            EGL_WIDTH, 1,
-            EGL_HEIGHT, 1,
-            EGL_NONE
-        };
+    return 0;
+}
+
+static int egl_create_pbuffer_surface(struct egl_priv *egl)
+{
+    const EGLint attribs[] = {
+        EGL_WIDTH, 1,
+        EGL_HEIGHT, 1,
+        EGL_NONE
+    };
 
-        egl->surface = eglCreatePbufferSurface(egl->display, egl->config, attribs);
-        if (!egl->surface) {
-            LOG(ERROR, "could not create EGL window surface: 0x%x", eglGetError());
+    egl->surface = eglCreatePbufferSurface(egl->display, egl->config, attribs);
+    if (!egl->surface) {
+        LOG(ERROR, "could not create EGL window surface: 0x%x", eglGetError());
+        return -1;
+    }
+    return 0;
+}
+
+static int egl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window, uintptr_t other)
+{
+    struct egl_priv *egl = ctx->priv_data;
+
+#if defined(TARGET_LINUX)
+    /* Offscreen rendering does not need any display server */
+    if (ctx->offscreen && !display) {
+        egl->display = egl_get_headless_display(egl, ctx->device);
+        if (!egl->display && ctx->device) {
+            LOG(ERROR, "could not retrieve the display of EGL device %d", ctx->device);
             return -1;
         }
-    } else {
+    }
+#endif
 
-        egl->native_window = (EGLNativeWindowType)window;
-        if (!egl->native_window) {
-            LOG(ERROR, "could not retrieve EGL native window");
+    if (!egl->display) {
+        int ret = egl_set_native_display(egl, display);
+        if (ret < 0) {
+            LOG(ERROR, "could not set native display");
             return -1;
         }
-        egl->surface = eglCreateWindowSurface(egl->display, egl->config, egl->native_window, NULL);
-        if (!egl->surface) {
-            LOG(ERROR, "could not create EGL window surface: 0x%x", eglGetError());
+
+        egl->display = egl_get_display(egl, egl->native_display);
+        if (!egl->display) {
+            LOG(ERROR, "could not retrieve EGL display");
             return -1;
         }
     }
 
+    EGLint egl_minor;
+    EGLint egl_major;
+    int ret = eglInitialize(egl->display, &egl_major, &egl_minor);
+    if (!ret) {
+        LOG(ERROR, "could initialize EGL: 0x%x", eglGetError());
+        return -1;
+    }
+
+    egl->extensions = eglQueryString(egl->display, EGL_EXTENSIONS);
+    if (!egl->extensions) {
+        LOG(ERROR, "could not retrieve EGL extensions");
+        return -1;
+    }
+
+    if (egl_major < 1 || egl_minor < 4) {
+        LOG(ERROR, "unsupported EGL version %d.%d, only 1.4+ is supported", egl_major, egl_minor);
+        return -1;
+    }
+
+    int api = ctx->backend == NGL_BACKEND_OPENGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API;
+    if (!eglBindAPI(api)) {
+        LOG(ERROR, "could not bind OpenGL%s API", ctx->backend == NGL_BACKEND_OPENGL ? "" : "ES");
+        return -1;
+    }
+
+    /* The offscreen rendering happens in framebuffer objects, a surface is
+     * only needed to make the context current without this extension */
+    egl->surfaceless = ctx->offscreen &&
+                       ngli_glcontext_check_extension("EGL_KHR_surfaceless_context", egl->extensions);
+
+    ret = egl_choose_config(ctx);
+    if (ret < 0)
+        return ret;
+
+    ret = egl_create_context(ctx, other ? (EGLContext)other : NULL);
+    if (ret < 0)
+        return ret;
+
+    if (egl->surfaceless) {
+        egl->surface = EGL_NO_SURFACE;
+    } else if (ctx->offscreen) {
+        ret = egl_create_pbuffer_surface(egl);
+        if (ret < 0)
+            return ret;
+    } else {
+        ret = egl_create_window_surface(egl, window);
+        if (ret < 0)
+            return ret;
+    }
+
     ret = egl_probe_extensions(ctx);
     if (ret < 0)
         return ret;
@@ -279,11 +439,44 @@ static int egl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window,
     return 0;
 }
 
+/*
+ * The display belongs to the other context (see egl_uninit()), and the
+ * context is made current by another thread (see egl_make_current())
+ */
+static int egl_init_shared(struct glcontext *ctx, const struct glcontext *other)
+{
+    struct egl_priv *egl = ctx->priv_data;
+    const struct egl_priv *egl_other = other->priv_data;
+
+    egl->shared = 1;
+    egl->display = egl_other->display;
+    egl->extensions = egl_other->extensions;
+    egl->surfaceless = ngli_glcontext_check_extension("EGL_KHR_surfaceless_context", egl->extensions);
+
+    int ret = egl_choose_config(ctx);
+    if (ret < 0)
+        return ret;
+
+    ret = egl_create_context(ctx, egl_other->handle);
+    if (ret < 0)
+        return ret;
+
+    if (!egl->surfaceless) {
+        ret = egl_create_pbuffer_surface(egl);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 static void egl_uninit(struct glcontext *ctx)
 {
     struct egl_priv *egl = ctx->priv_data;
 
-    ngli_glcontext_make_current(ctx, 0);
+    /* A shared context has already been released by its thread */
+    if (!egl->shared)
+        ngli_glcontext_make_current(ctx, 0);
 
     if (egl->surface)
         eglDestroySurface(egl->display, egl->surface);
@@ -291,7 +484,7 @@ static void egl_uninit(struct glcontext *ctx)
     if (egl->handle)
         eglDestroyContext(egl->display, egl->handle);
 
-    if (egl->display)
+    if (egl->display && !egl->shared)
         eglTerminate(egl->display);
 
 #if defined(TARGET_LINUX)
@@ -328,12 +521,36 @@ static int egl_resize(struct glcontext *ctx)
     return 0;
 }
 
+/* Only the surface is replaced, the context and its objects are kept */
+static int egl_set_window(struct glcontext *ctx, uintptr_t window)
+{
+    struct egl_priv *egl = ctx->priv_data;
+
+    eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(egl->display, egl->surface);
+    egl->surface = EGL_NO_SURFACE;
+
+    int ret = egl_create_window_surface(egl, window);
+    if (ret < 0)
+        return ret;
+
+    if (!eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->handle)) {
+        LOG(ERROR, "could not make the context current on the new surface: 0x%x", eglGetError());
+        return -1;
+    }
+    return 0;
+}
+
 static int egl_make_current(struct glcontext *ctx, int current)
 {
     int ret;
     struct egl_priv *egl = ctx->priv_data;
 
     if (current) {
+        /* The API is bound per thread, and a shared context is made current
+         * by another thread than the one which created it */
+        if (egl->shared)
+            eglBindAPI(ctx->backend == NGL_BACKEND_OPENGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API);
         ret = eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->handle);
     } else {
         ret = eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
@@ -345,9 +562,53 @@ static int egl_make_current(struct glcontext *ctx, int current)
 static void egl_swap_buffers(struct glcontext *ctx)
 {
     struct egl_priv *egl = ctx->priv_data;
+    if (egl->surfaceless)
+        return;
     eglSwapBuffers(egl->display, egl->surface);
 }
 
+static void egl_swap_buffers_with_damage(struct glcontext *ctx, const int *rect)
+{
+    struct egl_priv *egl = ctx->priv_data;
+
+    if (egl->surfaceless)
+        return;
+
+    /* An empty damage is not expressible, the whole surface is posted */
+    if (ctx->offscreen || !egl->SwapBuffersWithDamage || rect[2] <= 0 || rect[3] <= 0) {
+        eglSwapBuffers(egl->display, egl->surface);
+        return;
+    }
+
+    EGLint rects[] = {rect[0], rect[1], rect[2], rect[3]};
+    egl->SwapBuffersWithDamage(egl->display, egl->surface, rects, 1);
+}
+
+static int egl_get_buffer_age(struct glcontext *ctx)
+{
+    struct egl_priv *egl = ctx->priv_data;
+
+    if (ctx->offscreen || !egl->has_buffer_age)
+        return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(egl->display, egl->surface, EGL_BUFFER_AGE_KHR, &age))
+        return 0;
+    return age;
+}
+
+static void egl_set_damage_region(struct glcontext *ctx, const int *rect)
+{
+    struct egl_priv *egl = ctx->priv_data;
+
+    if (ctx->offscreen || !egl->SetDamageRegionKHR)
+        return;
+
+    EGLint rects[] = {rect[0], rect[1], rect[2], rect[3]};
+    const EGLint nb_rects = rect[2] > 0 && rect[3] > 0;
+    egl->SetDamageRegionKHR(egl->display, egl->surface, rects, nb_rects);
+}
+
 static int egl_set_swap_interval(struct glcontext *ctx, int interval)
 {
     struct egl_priv *egl = ctx->priv_data;
@@ -394,10 +655,15 @@ static uintptr_t egl_get_handle(struct glcontext *ctx)
 
 const struct glcontext_class ngli_glcontext_egl_class = {
     .init = egl_init,
+    .init_shared = egl_init_shared,
     .uninit = egl_uninit,
     .resize = egl_resize,
+    .set_window = egl_set_window,
     .make_current = egl_make_current,
     .swap_buffers = egl_swap_buffers,
+    .swap_buffers_with_damage = egl_swap_buffers_with_damage,
+    .get_buffer_age = egl_get_buffer_age,
+    .set_damage_region = egl_set_damage_region,
     .set_swap_interval = egl_set_swap_interval,
     .set_surface_pts = egl_set_surface_pts,
     .get_proc_address = egl_get_proc_address,
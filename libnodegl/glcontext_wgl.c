@@ -21,14 +21,11 @@
 
 #include <stddef.h>
 #include <stdio.h>
-#include <windows.h>
-
-#include <GL/glcorearb.h>
-#include <GL/wglext.h>
 
 #include "glcontext.h"
 #include "nodegl.h"
 #include "log.h"
+#include "wgl.h"
 
 struct wgl_priv {
     HWND window;
@@ -43,8 +40,91 @@ struct wgl_priv {
     PFNWGLDESTROYPBUFFERARBPROC DestroyPbufferARB;
     PFNWGLGETPBUFFERDCARBPROC GetPbufferDCARB;
     PFNWGLSWAPINTERVALEXTPROC SwapIntervalEXT;
+    PFNWGLGETEXTENSIONSSTRINGARBPROC GetExtensionsStringARB;
+    PFNWGLDXOPENDEVICENVPROC DXOpenDeviceNV;
+    PFNWGLDXCLOSEDEVICENVPROC DXCloseDeviceNV;
+    PFNWGLDXREGISTEROBJECTNVPROC DXRegisterObjectNV;
+    PFNWGLDXUNREGISTEROBJECTNVPROC DXUnregisterObjectNV;
+    PFNWGLDXLOCKOBJECTSNVPROC DXLockObjectsNV;
+    PFNWGLDXUNLOCKOBJECTSNVPROC DXUnlockObjectsNV;
 };
 
+HANDLE ngli_wglDXOpenDeviceNV(struct glcontext *gl, void *dx_device)
+{
+    struct wgl_priv *wgl = gl->priv_data;
+    return wgl->DXOpenDeviceNV(dx_device);
+}
+
+BOOL ngli_wglDXCloseDeviceNV(struct glcontext *gl, HANDLE device)
+{
+    struct wgl_priv *wgl = gl->priv_data;
+    return wgl->DXCloseDeviceNV(device);
+}
+
+HANDLE ngli_wglDXRegisterObjectNV(struct glcontext *gl, HANDLE device, void *dx_object,
+                                  GLuint name, GLenum type, GLenum access)
+{
+    struct wgl_priv *wgl = gl->priv_data;
+    return wgl->DXRegisterObjectNV(device, dx_object, name, type, access);
+}
+
+BOOL ngli_wglDXUnregisterObjectNV(struct glcontext *gl, HANDLE device, HANDLE object)
+{
+    struct wgl_priv *wgl = gl->priv_data;
+    return wgl->DXUnregisterObjectNV(device, object);
+}
+
+BOOL ngli_wglDXLockObjectsNV(struct glcontext *gl, HANDLE device, GLint count, HANDLE *objects)
+{
+    struct wgl_priv *wgl = gl->priv_data;
+    return wgl->DXLockObjectsNV(device, count, objects);
+}
+
+BOOL ngli_wglDXUnlockObjectsNV(struct glcontext *gl, HANDLE device, GLint count, HANDLE *objects)
+{
+    struct wgl_priv *wgl = gl->priv_data;
+    return wgl->DXUnlockObjectsNV(device, count, objects);
+}
+
+static int wgl_probe_extensions(struct glcontext *ctx)
+{
+    struct wgl_priv *wgl = ctx->priv_data;
+
+    if (!wgl->GetExtensionsStringARB)
+        return 0;
+
+    const char *extensions = wgl->GetExtensionsStringARB(wgl->device_context);
+    if (!extensions)
+        return 0;
+
+    if (ngli_glcontext_check_extension("WGL_NV_DX_interop", extensions) &&
+        ngli_glcontext_check_extension("WGL_NV_DX_interop2", extensions)) {
+        static const struct {
+            const char *name;
+            int offset;
+        } functions[] = {
+            {"wglDXOpenDeviceNV", offsetof(struct wgl_priv, DXOpenDeviceNV)},
+            {"wglDXCloseDeviceNV", offsetof(struct wgl_priv, DXCloseDeviceNV)},
+            {"wglDXRegisterObjectNV", offsetof(struct wgl_priv, DXRegisterObjectNV)},
+            {"wglDXUnregisterObjectNV", offsetof(struct wgl_priv, DXUnregisterObjectNV)},
+            {"wglDXLockObjectsNV", offsetof(struct wgl_priv, DXLockObjectsNV)},
+            {"wglDXUnlockObjectsNV", offsetof(struct wgl_priv, DXUnlockObjectsNV)},
+        };
+
+        for (int i = 0; i < NGLI_ARRAY_NB(functions); i++) {
+            void *function_ptr = wglGetProcAddress(functions[i].name);
+            if (!function_ptr) {
+                LOG(ERROR, "could not retrieve %s()", functions[i].name);
+                return -1;
+            }
+            memcpy(((uint8_t *)wgl) + functions[i].offset, &function_ptr, sizeof(function_ptr));
+        }
+        ctx->features |= NGLI_FEATURE_WGL_NV_DX_INTEROP2;
+    }
+
+    return 0;
+}
+
 static int wgl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window, uintptr_t other)
 {
     struct wgl_priv *wgl = ctx->priv_data;
@@ -136,6 +216,8 @@ static int wgl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window,
     if (!wgl->SwapIntervalEXT)
         LOG(WARNING, "context does not support any swap interval extension (%lu)", GetLastError());
 
+    wgl->GetExtensionsStringARB = (PFNWGLGETEXTENSIONSSTRINGARBPROC)wglGetProcAddress("wglGetExtensionsStringARB");
+
     const int pixel_format_attributes[] = {
         WGL_DRAW_TO_WINDOW_ARB, GL_TRUE,
         WGL_DRAW_TO_PBUFFER_ARB, GL_TRUE,
@@ -199,7 +281,7 @@ static int wgl_init(struct glcontext *ctx, uintptr_t display, uintptr_t window,
         return -1;
     }
 
-    return 0;
+    return wgl_probe_extensions(ctx);
 }
 
 static void wgl_uninit(struct glcontext *ctx)
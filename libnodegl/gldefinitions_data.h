@@ -24,6 +24,7 @@ static const struct gldefinition {
     {"glBindFramebuffer", offsetof(struct glfunctions, BindFramebuffer), M},
     {"glBindImageTexture", offsetof(struct glfunctions, BindImageTexture), 0},
     {"glBindRenderbuffer", offsetof(struct glfunctions, BindRenderbuffer), M},
+    {"glBindSampler", offsetof(struct glfunctions, BindSampler), 0},
     {"glBindTexture", offsetof(struct glfunctions, BindTexture), M},
     {"glBindVertexArray", offsetof(struct glfunctions, BindVertexArray), 0},
     {"glBlendColor", offsetof(struct glfunctions, BlendColor), M},
@@ -33,6 +34,7 @@ static const struct gldefinition {
     {"glBlendFuncSeparate", offsetof(struct glfunctions, BlendFuncSeparate), M},
     {"glBlitFramebuffer", offsetof(struct glfunctions, BlitFramebuffer), 0},
     {"glBufferData", offsetof(struct glfunctions, BufferData), M},
+    {"glBufferStorage", offsetof(struct glfunctions, BufferStorage), 0},
     {"glBufferSubData", offsetof(struct glfunctions, BufferSubData), M},
     {"glCheckFramebufferStatus", offsetof(struct glfunctions, CheckFramebufferStatus), M},
     {"glClear", offsetof(struct glfunctions, Clear), M},
@@ -40,16 +42,23 @@ static const struct gldefinition {
     {"glClientWaitSync", offsetof(struct glfunctions, ClientWaitSync), 0},
     {"glColorMask", offsetof(struct glfunctions, ColorMask), M},
     {"glCompileShader", offsetof(struct glfunctions, CompileShader), M},
+    {"glCompressedTexImage2D", offsetof(struct glfunctions, CompressedTexImage2D), M},
+    {"glCompressedTexSubImage2D", offsetof(struct glfunctions, CompressedTexSubImage2D), M},
+    {"glCopyBufferSubData", offsetof(struct glfunctions, CopyBufferSubData), 0},
     {"glCreateProgram", offsetof(struct glfunctions, CreateProgram), M},
     {"glCreateShader", offsetof(struct glfunctions, CreateShader), M},
     {"glCullFace", offsetof(struct glfunctions, CullFace), M},
+    {"glDebugMessageCallback", offsetof(struct glfunctions, DebugMessageCallback), 0},
+    {"glDebugMessageControl", offsetof(struct glfunctions, DebugMessageControl), 0},
     {"glDeleteBuffers", offsetof(struct glfunctions, DeleteBuffers), M},
     {"glDeleteFramebuffers", offsetof(struct glfunctions, DeleteFramebuffers), M},
     {"glDeleteProgram", offsetof(struct glfunctions, DeleteProgram), M},
     {"glDeleteQueries", offsetof(struct glfunctions, DeleteQueries), 0},
     {"glDeleteQueriesEXT", offsetof(struct glfunctions, DeleteQueriesEXT), 0},
     {"glDeleteRenderbuffers", offsetof(struct glfunctions, DeleteRenderbuffers), M},
+    {"glDeleteSamplers", offsetof(struct glfunctions, DeleteSamplers), 0},
     {"glDeleteShader", offsetof(struct glfunctions, DeleteShader), M},
+    {"glDeleteSync", offsetof(struct glfunctions, DeleteSync), 0},
     {"glDeleteTextures", offsetof(struct glfunctions, DeleteTextures), M},
     {"glDeleteVertexArrays", offsetof(struct glfunctions, DeleteVertexArrays), 0},
     {"glDepthFunc", offsetof(struct glfunctions, DepthFunc), M},
@@ -58,10 +67,13 @@ static const struct gldefinition {
     {"glDisable", offsetof(struct glfunctions, Disable), M},
     {"glDisableVertexAttribArray", offsetof(struct glfunctions, DisableVertexAttribArray), M},
     {"glDispatchCompute", offsetof(struct glfunctions, DispatchCompute), 0},
+    {"glDispatchComputeIndirect", offsetof(struct glfunctions, DispatchComputeIndirect), 0},
     {"glDrawArrays", offsetof(struct glfunctions, DrawArrays), M},
+    {"glDrawArraysIndirect", offsetof(struct glfunctions, DrawArraysIndirect), 0},
     {"glDrawArraysInstanced", offsetof(struct glfunctions, DrawArraysInstanced), 0},
     {"glDrawBuffers", offsetof(struct glfunctions, DrawBuffers), 0},
     {"glDrawElements", offsetof(struct glfunctions, DrawElements), M},
+    {"glDrawElementsIndirect", offsetof(struct glfunctions, DrawElementsIndirect), 0},
     {"glDrawElementsInstanced", offsetof(struct glfunctions, DrawElementsInstanced), 0},
     {"glEGLImageTargetTexture2DOES", offsetof(struct glfunctions, EGLImageTargetTexture2DOES), 0},
     {"glEnable", offsetof(struct glfunctions, Enable), M},
@@ -73,11 +85,15 @@ static const struct gldefinition {
     {"glFlush", offsetof(struct glfunctions, Flush), M},
     {"glFramebufferRenderbuffer", offsetof(struct glfunctions, FramebufferRenderbuffer), M},
     {"glFramebufferTexture2D", offsetof(struct glfunctions, FramebufferTexture2D), M},
+    {"glFramebufferTexture2DMultisampleEXT", offsetof(struct glfunctions, FramebufferTexture2DMultisampleEXT), 0},
+    {"glFramebufferTextureLayer", offsetof(struct glfunctions, FramebufferTextureLayer), 0},
+    {"glFramebufferTextureMultiviewOVR", offsetof(struct glfunctions, FramebufferTextureMultiviewOVR), 0},
     {"glGenBuffers", offsetof(struct glfunctions, GenBuffers), M},
     {"glGenFramebuffers", offsetof(struct glfunctions, GenFramebuffers), M},
     {"glGenQueries", offsetof(struct glfunctions, GenQueries), 0},
     {"glGenQueriesEXT", offsetof(struct glfunctions, GenQueriesEXT), 0},
     {"glGenRenderbuffers", offsetof(struct glfunctions, GenRenderbuffers), M},
+    {"glGenSamplers", offsetof(struct glfunctions, GenSamplers), 0},
     {"glGenTextures", offsetof(struct glfunctions, GenTextures), M},
     {"glGenVertexArrays", offsetof(struct glfunctions, GenVertexArrays), 0},
     {"glGenerateMipmap", offsetof(struct glfunctions, GenerateMipmap), M},
@@ -92,6 +108,7 @@ static const struct gldefinition {
     {"glGetIntegeri_v", offsetof(struct glfunctions, GetIntegeri_v), M},
     {"glGetIntegerv", offsetof(struct glfunctions, GetIntegerv), M},
     {"glGetInternalformativ", offsetof(struct glfunctions, GetInternalformativ), 0},
+    {"glGetProgramBinary", offsetof(struct glfunctions, GetProgramBinary), 0},
     {"glGetProgramInfoLog", offsetof(struct glfunctions, GetProgramInfoLog), M},
     {"glGetProgramInterfaceiv", offsetof(struct glfunctions, GetProgramInterfaceiv), 0},
     {"glGetProgramResourceIndex", offsetof(struct glfunctions, GetProgramResourceIndex), 0},
@@ -101,25 +118,41 @@ static const struct gldefinition {
     {"glGetProgramiv", offsetof(struct glfunctions, GetProgramiv), M},
     {"glGetQueryObjectui64v", offsetof(struct glfunctions, GetQueryObjectui64v), 0},
     {"glGetQueryObjectui64vEXT", offsetof(struct glfunctions, GetQueryObjectui64vEXT), 0},
+    {"glGetQueryObjectuiv", offsetof(struct glfunctions, GetQueryObjectuiv), 0},
     {"glGetRenderbufferParameteriv", offsetof(struct glfunctions, GetRenderbufferParameteriv), M},
     {"glGetShaderInfoLog", offsetof(struct glfunctions, GetShaderInfoLog), M},
     {"glGetShaderSource", offsetof(struct glfunctions, GetShaderSource), M},
     {"glGetShaderiv", offsetof(struct glfunctions, GetShaderiv), M},
     {"glGetString", offsetof(struct glfunctions, GetString), M},
     {"glGetStringi", offsetof(struct glfunctions, GetStringi), M},
+    {"glGetTextureHandleARB", offsetof(struct glfunctions, GetTextureHandleARB), 0},
+    {"glGetTextureSamplerHandleARB", offsetof(struct glfunctions, GetTextureSamplerHandleARB), 0},
     {"glGetUniformBlockIndex", offsetof(struct glfunctions, GetUniformBlockIndex), 0},
     {"glGetUniformLocation", offsetof(struct glfunctions, GetUniformLocation), M},
     {"glGetUniformiv", offsetof(struct glfunctions, GetUniformiv), M},
     {"glInvalidateFramebuffer", offsetof(struct glfunctions, InvalidateFramebuffer), 0},
     {"glLinkProgram", offsetof(struct glfunctions, LinkProgram), M},
+    {"glMakeTextureHandleNonResidentARB", offsetof(struct glfunctions, MakeTextureHandleNonResidentARB), 0},
+    {"glMakeTextureHandleResidentARB", offsetof(struct glfunctions, MakeTextureHandleResidentARB), 0},
+    {"glMapBufferRange", offsetof(struct glfunctions, MapBufferRange), 0},
+    {"glMaxShaderCompilerThreadsKHR", offsetof(struct glfunctions, MaxShaderCompilerThreadsKHR), 0},
     {"glMemoryBarrier", offsetof(struct glfunctions, MemoryBarrier), 0},
+    {"glMultiDrawArraysIndirect", offsetof(struct glfunctions, MultiDrawArraysIndirect), 0},
+    {"glMultiDrawElementsIndirect", offsetof(struct glfunctions, MultiDrawElementsIndirect), 0},
+    {"glObjectLabel", offsetof(struct glfunctions, ObjectLabel), 0},
     {"glPixelStorei", offsetof(struct glfunctions, PixelStorei), M},
     {"glPolygonMode", offsetof(struct glfunctions, PolygonMode), 0},
+    {"glProgramBinary", offsetof(struct glfunctions, ProgramBinary), 0},
+    {"glProgramParameteri", offsetof(struct glfunctions, ProgramParameteri), 0},
+    {"glQueryCounter", offsetof(struct glfunctions, QueryCounter), 0},
+    {"glQueryCounterEXT", offsetof(struct glfunctions, QueryCounterEXT), 0},
     {"glReadBuffer", offsetof(struct glfunctions, ReadBuffer), 0},
     {"glReadPixels", offsetof(struct glfunctions, ReadPixels), M},
     {"glReleaseShaderCompiler", offsetof(struct glfunctions, ReleaseShaderCompiler), M},
     {"glRenderbufferStorage", offsetof(struct glfunctions, RenderbufferStorage), M},
     {"glRenderbufferStorageMultisample", offsetof(struct glfunctions, RenderbufferStorageMultisample), 0},
+    {"glRenderbufferStorageMultisampleEXT", offsetof(struct glfunctions, RenderbufferStorageMultisampleEXT), 0},
+    {"glSamplerParameteri", offsetof(struct glfunctions, SamplerParameteri), 0},
     {"glScissor", offsetof(struct glfunctions, Scissor), M},
     {"glShaderBinary", offsetof(struct glfunctions, ShaderBinary), M},
     {"glShaderSource", offsetof(struct glfunctions, ShaderSource), M},
@@ -153,9 +186,11 @@ static const struct gldefinition {
     {"glUniform4i", offsetof(struct glfunctions, Uniform4i), M},
     {"glUniform4iv", offsetof(struct glfunctions, Uniform4iv), M},
     {"glUniformBlockBinding", offsetof(struct glfunctions, UniformBlockBinding), 0},
+    {"glUniformHandleui64ARB", offsetof(struct glfunctions, UniformHandleui64ARB), 0},
     {"glUniformMatrix2fv", offsetof(struct glfunctions, UniformMatrix2fv), M},
     {"glUniformMatrix3fv", offsetof(struct glfunctions, UniformMatrix3fv), M},
     {"glUniformMatrix4fv", offsetof(struct glfunctions, UniformMatrix4fv), M},
+    {"glUnmapBuffer", offsetof(struct glfunctions, UnmapBuffer), 0},
     {"glUseProgram", offsetof(struct glfunctions, UseProgram), M},
     {"glVertexAttribDivisor", offsetof(struct glfunctions, VertexAttribDivisor), 0},
     {"glVertexAttribPointer", offsetof(struct glfunctions, VertexAttribPointer), M},
@@ -26,7 +26,7 @@
 #define OFFSET(x) offsetof(struct glfunctions, x)
 static const struct glfeature {
     const char *name;
-    int flag;
+    uint64_t flag;
     size_t offset;
     int version;
     int es_version;
@@ -68,6 +68,7 @@ static const struct glfeature {
         .es_version     = 310,
         .extensions     = (const char*[]){"GL_ARB_compute_shader", NULL},
         .funcs_offsets  = (const size_t[]){OFFSET(DispatchCompute),
+                                           OFFSET(DispatchComputeIndirect),
                                            OFFSET(MemoryBarrier),
                                            -1}
     }, {
@@ -127,6 +128,8 @@ static const struct glfeature {
         .flag           = NGLI_FEATURE_TIMER_QUERY,
         .version        = 330,
         .extensions     = (const char*[]){"ARB_timer_query", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(QueryCounter),
+                                           -1}
     }, {
         .name           = "ext_disjoint_timer_query",
         .flag           = NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY,
@@ -136,6 +139,29 @@ static const struct glfeature {
                                            OFFSET(GenQueriesEXT),
                                            OFFSET(DeleteQueriesEXT),
                                            OFFSET(GetQueryObjectui64vEXT),
+                                           OFFSET(QueryCounterEXT),
+                                           -1}
+    }, {
+        .name           = "occlusion_query",
+        .flag           = NGLI_FEATURE_OCCLUSION_QUERY,
+        .version        = 330,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_occlusion_query2", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(BeginQuery),
+                                           OFFSET(EndQuery),
+                                           OFFSET(GenQueries),
+                                           OFFSET(DeleteQueries),
+                                           OFFSET(GetQueryObjectuiv),
+                                           -1}
+    }, {
+        .name           = "khr_debug",
+        .flag           = NGLI_FEATURE_KHR_DEBUG,
+        .version        = 430,
+        .es_version     = 320,
+        .extensions     = (const char*[]){"GL_KHR_debug", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(DebugMessageCallback),
+                                           OFFSET(DebugMessageControl),
+                                           OFFSET(ObjectLabel),
                                            -1}
     }, {
         .name           = "draw_instanced",
@@ -208,6 +234,7 @@ static const struct glfeature {
         .funcs_offsets  = (const size_t[]){OFFSET(FenceSync),
                                            OFFSET(ClientWaitSync),
                                            OFFSET(WaitSync),
+                                           OFFSET(DeleteSync),
                                            -1}
     }, {
         .name           = "yuv_target",
@@ -239,7 +266,141 @@ static const struct glfeature {
     }, {
         .name           = "row_length",
         .flag           = NGLI_FEATURE_ROW_LENGTH,
+        .version        = 100,
+        .es_version     = 300,
+        .es_extensions  = (const char*[]){"GL_EXT_unpack_subimage", NULL},
+    }, {
+        .name           = "buffer_storage",
+        .flag           = NGLI_FEATURE_BUFFER_STORAGE,
+        .version        = 440,
+        .extensions     = (const char*[]){"GL_ARB_buffer_storage", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(BufferStorage),
+                                           -1}
+    }, {
+        .name           = "map_buffer_range",
+        .flag           = NGLI_FEATURE_MAP_BUFFER_RANGE,
+        .version        = 300,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_map_buffer_range", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(MapBufferRange),
+                                           OFFSET(UnmapBuffer),
+                                           -1}
+    }, {
+        .name           = "program_binary",
+        .flag           = NGLI_FEATURE_PROGRAM_BINARY,
+        .version        = 410,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_get_program_binary", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(GetProgramBinary),
+                                           OFFSET(ProgramBinary),
+                                           OFFSET(ProgramParameteri),
+                                           -1}
+    }, {
+        .name           = "parallel_shader_compile",
+        .flag           = NGLI_FEATURE_PARALLEL_SHADER_COMPILE,
+        .extensions     = (const char*[]){"GL_KHR_parallel_shader_compile", NULL},
+        .es_extensions  = (const char*[]){"GL_KHR_parallel_shader_compile", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(MaxShaderCompilerThreadsKHR),
+                                           -1}
+    }, {
+        .name           = "draw_indirect",
+        .flag           = NGLI_FEATURE_DRAW_INDIRECT,
+        .version        = 400,
+        .es_version     = 310,
+        .extensions     = (const char*[]){"GL_ARB_draw_indirect", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(DrawArraysIndirect),
+                                           OFFSET(DrawElementsIndirect),
+                                           -1}
+    }, {
+        .name           = "multi_draw_indirect",
+        .flag           = NGLI_FEATURE_MULTI_DRAW_INDIRECT,
+        .version        = 430,
+        .extensions     = (const char*[]){"GL_ARB_multi_draw_indirect", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(MultiDrawArraysIndirect),
+                                           OFFSET(MultiDrawElementsIndirect),
+                                           -1}
+    }, {
+        .name           = "texture_compression_etc2",
+        .flag           = NGLI_FEATURE_TEXTURE_COMPRESSION_ETC2,
+        .version        = 430,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_ES3_compatibility", NULL},
+    }, {
+        .name           = "texture_compression_astc",
+        .flag           = NGLI_FEATURE_TEXTURE_COMPRESSION_ASTC,
+        .es_version     = 320,
+        .extensions     = (const char*[]){"GL_KHR_texture_compression_astc_ldr", NULL},
+        .es_extensions  = (const char*[]){"GL_KHR_texture_compression_astc_ldr", NULL},
+    }, {
+        .name           = "texture_compression_s3tc",
+        .flag           = NGLI_FEATURE_TEXTURE_COMPRESSION_S3TC,
+        .extensions     = (const char*[]){"GL_EXT_texture_compression_s3tc", NULL},
+        .es_extensions  = (const char*[]){"GL_EXT_texture_compression_s3tc", NULL},
+    }, {
+        .name           = "texture_compression_rgtc",
+        .flag           = NGLI_FEATURE_TEXTURE_COMPRESSION_RGTC,
         .version        = 300,
+        .extensions     = (const char*[]){"GL_ARB_texture_compression_rgtc", NULL},
+        .es_extensions  = (const char*[]){"GL_EXT_texture_compression_rgtc", NULL},
+    }, {
+        .name           = "texture_compression_bptc",
+        .flag           = NGLI_FEATURE_TEXTURE_COMPRESSION_BPTC,
+        .version        = 420,
+        .extensions     = (const char*[]){"GL_ARB_texture_compression_bptc", NULL},
+        .es_extensions  = (const char*[]){"GL_EXT_texture_compression_bptc", NULL},
+    }, {
+        .name           = "bindless_texture",
+        .flag           = NGLI_FEATURE_BINDLESS_TEXTURE,
+        .extensions     = (const char*[]){"GL_ARB_bindless_texture", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(GetTextureHandleARB),
+                                           OFFSET(GetTextureSamplerHandleARB),
+                                           OFFSET(MakeTextureHandleResidentARB),
+                                           OFFSET(MakeTextureHandleNonResidentARB),
+                                           OFFSET(UniformHandleui64ARB),
+                                           -1}
+    }, {
+        .name           = "sampler_object",
+        .flag           = NGLI_FEATURE_SAMPLER_OBJECT,
+        .version        = 330,
         .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_sampler_objects", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(BindSampler),
+                                           OFFSET(DeleteSamplers),
+                                           OFFSET(GenSamplers),
+                                           OFFSET(SamplerParameteri),
+                                           -1}
+    }, {
+        .name           = "multisampled_render_to_texture",
+        .flag           = NGLI_FEATURE_MULTISAMPLED_RENDER_TO_TEXTURE,
+        .es_extensions  = (const char*[]){"GL_EXT_multisampled_render_to_texture", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(FramebufferTexture2DMultisampleEXT),
+                                           OFFSET(RenderbufferStorageMultisampleEXT),
+                                           -1}
+    }, {
+        .name           = "copy_buffer",
+        .flag           = NGLI_FEATURE_COPY_BUFFER,
+        .version        = 310,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_copy_buffer", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(CopyBufferSubData),
+                                           -1}
+    }, {
+        .name           = "shader_framebuffer_fetch",
+        .flag           = NGLI_FEATURE_SHADER_FRAMEBUFFER_FETCH,
+        .extensions     = (const char*[]){"GL_EXT_shader_framebuffer_fetch", NULL},
+        .es_extensions  = (const char*[]){"GL_EXT_shader_framebuffer_fetch", NULL},
+    }, {
+        .name           = "ovr_multiview",
+        .flag           = NGLI_FEATURE_OVR_MULTIVIEW,
+        .extensions     = (const char*[]){"GL_OVR_multiview", NULL},
+        .es_extensions  = (const char*[]){"GL_OVR_multiview", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(FramebufferTextureMultiviewOVR),
+                                           OFFSET(FramebufferTextureLayer),
+                                           -1}
+    }, {
+        .name           = "color_buffer_float",
+        .flag           = NGLI_FEATURE_COLOR_BUFFER_FLOAT,
+        .version        = 300,
+        .es_extensions  = (const char*[]){"GL_EXT_color_buffer_float", NULL}
     }
 };
@@ -23,6 +23,7 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*BindFramebuffer)(GLenum target, GLuint framebuffer);
     NGLI_GL_APIENTRY void (*BindImageTexture)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
     NGLI_GL_APIENTRY void (*BindRenderbuffer)(GLenum target, GLuint renderbuffer);
+    NGLI_GL_APIENTRY void (*BindSampler)(GLuint unit, GLuint sampler);
     NGLI_GL_APIENTRY void (*BindTexture)(GLenum target, GLuint texture);
     NGLI_GL_APIENTRY void (*BindVertexArray)(GLuint array);
     NGLI_GL_APIENTRY void (*BlendColor)(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
@@ -32,6 +33,7 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*BlendFuncSeparate)(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha);
     NGLI_GL_APIENTRY void (*BlitFramebuffer)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
     NGLI_GL_APIENTRY void (*BufferData)(GLenum target, GLsizeiptr size, const void * data, GLenum usage);
+    NGLI_GL_APIENTRY void (*BufferStorage)(GLenum target, GLsizeiptr size, const void * data, GLbitfield flags);
     NGLI_GL_APIENTRY void (*BufferSubData)(GLenum target, GLintptr offset, GLsizeiptr size, const void * data);
     NGLI_GL_APIENTRY GLenum (*CheckFramebufferStatus)(GLenum target);
     NGLI_GL_APIENTRY void (*Clear)(GLbitfield mask);
@@ -39,16 +41,23 @@ struct glfunctions {
     NGLI_GL_APIENTRY GLenum (*ClientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
     NGLI_GL_APIENTRY void (*ColorMask)(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
     NGLI_GL_APIENTRY void (*CompileShader)(GLuint shader);
+    NGLI_GL_APIENTRY void (*CompressedTexImage2D)(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void * data);
+    NGLI_GL_APIENTRY void (*CompressedTexSubImage2D)(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void * data);
+    NGLI_GL_APIENTRY void (*CopyBufferSubData)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
     NGLI_GL_APIENTRY GLuint (*CreateProgram)();
     NGLI_GL_APIENTRY GLuint (*CreateShader)(GLenum type);
     NGLI_GL_APIENTRY void (*CullFace)(GLenum mode);
+    NGLI_GL_APIENTRY void (*DebugMessageCallback)(GLDEBUGPROC callback, const void * userParam);
+    NGLI_GL_APIENTRY void (*DebugMessageControl)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint * ids, GLboolean enabled);
     NGLI_GL_APIENTRY void (*DeleteBuffers)(GLsizei n, const GLuint * buffers);
     NGLI_GL_APIENTRY void (*DeleteFramebuffers)(GLsizei n, const GLuint * framebuffers);
     NGLI_GL_APIENTRY void (*DeleteProgram)(GLuint program);
     NGLI_GL_APIENTRY void (*DeleteQueries)(GLsizei n, const GLuint * ids);
     NGLI_GL_APIENTRY void (*DeleteQueriesEXT)(GLsizei n, const GLuint * ids);
     NGLI_GL_APIENTRY void (*DeleteRenderbuffers)(GLsizei n, const GLuint * renderbuffers);
+    NGLI_GL_APIENTRY void (*DeleteSamplers)(GLsizei n, const GLuint * samplers);
     NGLI_GL_APIENTRY void (*DeleteShader)(GLuint shader);
+    NGLI_GL_APIENTRY void (*DeleteSync)(GLsync sync);
     NGLI_GL_APIENTRY void (*DeleteTextures)(GLsizei n, const GLuint * textures);
     NGLI_GL_APIENTRY void (*DeleteVertexArrays)(GLsizei n, const GLuint * arrays);
     NGLI_GL_APIENTRY void (*DepthFunc)(GLenum func);
@@ -57,10 +66,13 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*Disable)(GLenum cap);
     NGLI_GL_APIENTRY void (*DisableVertexAttribArray)(GLuint index);
     NGLI_GL_APIENTRY void (*DispatchCompute)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+    NGLI_GL_APIENTRY void (*DispatchComputeIndirect)(GLintptr indirect);
     NGLI_GL_APIENTRY void (*DrawArrays)(GLenum mode, GLint first, GLsizei count);
+    NGLI_GL_APIENTRY void (*DrawArraysIndirect)(GLenum mode, const void * indirect);
     NGLI_GL_APIENTRY void (*DrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
     NGLI_GL_APIENTRY void (*DrawBuffers)(GLsizei n, const GLenum * bufs);
     NGLI_GL_APIENTRY void (*DrawElements)(GLenum mode, GLsizei count, GLenum type, const void * indices);
+    NGLI_GL_APIENTRY void (*DrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect);
     NGLI_GL_APIENTRY void (*DrawElementsInstanced)(GLenum mode, GLsizei count, GLenum type, const void * indices, GLsizei instancecount);
     NGLI_GL_APIENTRY void (*EGLImageTargetTexture2DOES)(GLenum target, GLeglImageOES image);
     NGLI_GL_APIENTRY void (*Enable)(GLenum cap);
@@ -72,11 +84,15 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*Flush)();
     NGLI_GL_APIENTRY void (*FramebufferRenderbuffer)(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
     NGLI_GL_APIENTRY void (*FramebufferTexture2D)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+    NGLI_GL_APIENTRY void (*FramebufferTexture2DMultisampleEXT)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples);
+    NGLI_GL_APIENTRY void (*FramebufferTextureLayer)(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
+    NGLI_GL_APIENTRY void (*FramebufferTextureMultiviewOVR)(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews);
     NGLI_GL_APIENTRY void (*GenBuffers)(GLsizei n, GLuint * buffers);
     NGLI_GL_APIENTRY void (*GenFramebuffers)(GLsizei n, GLuint * framebuffers);
     NGLI_GL_APIENTRY void (*GenQueries)(GLsizei n, GLuint * ids);
     NGLI_GL_APIENTRY void (*GenQueriesEXT)(GLsizei n, GLuint * ids);
     NGLI_GL_APIENTRY void (*GenRenderbuffers)(GLsizei n, GLuint * renderbuffers);
+    NGLI_GL_APIENTRY void (*GenSamplers)(GLsizei n, GLuint * samplers);
     NGLI_GL_APIENTRY void (*GenTextures)(GLsizei n, GLuint * textures);
     NGLI_GL_APIENTRY void (*GenVertexArrays)(GLsizei n, GLuint * arrays);
     NGLI_GL_APIENTRY void (*GenerateMipmap)(GLenum target);
@@ -91,6 +107,7 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*GetIntegeri_v)(GLenum target, GLuint index, GLint * data);
     NGLI_GL_APIENTRY void (*GetIntegerv)(GLenum pname, GLint * data);
     NGLI_GL_APIENTRY void (*GetInternalformativ)(GLenum target, GLenum internalformat, GLenum pname, GLsizei bufSize, GLint * params);
+    NGLI_GL_APIENTRY void (*GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void * binary);
     NGLI_GL_APIENTRY void (*GetProgramInfoLog)(GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog);
     NGLI_GL_APIENTRY void (*GetProgramInterfaceiv)(GLuint program, GLenum programInterface, GLenum pname, GLint * params);
     NGLI_GL_APIENTRY GLuint (*GetProgramResourceIndex)(GLuint program, GLenum programInterface, const GLchar * name);
@@ -100,25 +117,41 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*GetProgramiv)(GLuint program, GLenum pname, GLint * params);
     NGLI_GL_APIENTRY void (*GetQueryObjectui64v)(GLuint id, GLenum pname, GLuint64 * params);
     NGLI_GL_APIENTRY void (*GetQueryObjectui64vEXT)(GLuint id, GLenum pname, GLuint64 * params);
+    NGLI_GL_APIENTRY void (*GetQueryObjectuiv)(GLuint id, GLenum pname, GLuint * params);
     NGLI_GL_APIENTRY void (*GetRenderbufferParameteriv)(GLenum target, GLenum pname, GLint * params);
     NGLI_GL_APIENTRY void (*GetShaderInfoLog)(GLuint shader, GLsizei bufSize, GLsizei * length, GLchar * infoLog);
     NGLI_GL_APIENTRY void (*GetShaderSource)(GLuint shader, GLsizei bufSize, GLsizei * length, GLchar * source);
     NGLI_GL_APIENTRY void (*GetShaderiv)(GLuint shader, GLenum pname, GLint * params);
     NGLI_GL_APIENTRY const GLubyte * (*GetString)(GLenum name);
     NGLI_GL_APIENTRY const GLubyte * (*GetStringi)(GLenum name, GLuint index);
+    NGLI_GL_APIENTRY GLuint64 (*GetTextureHandleARB)(GLuint texture);
+    NGLI_GL_APIENTRY GLuint64 (*GetTextureSamplerHandleARB)(GLuint texture, GLuint sampler);
     NGLI_GL_APIENTRY GLuint (*GetUniformBlockIndex)(GLuint program, const GLchar * uniformBlockName);
     NGLI_GL_APIENTRY GLint (*GetUniformLocation)(GLuint program, const GLchar * name);
     NGLI_GL_APIENTRY void (*GetUniformiv)(GLuint program, GLint location, GLint * params);
     NGLI_GL_APIENTRY void (*InvalidateFramebuffer)(GLenum target, GLsizei numAttachments, const GLenum * attachments);
     NGLI_GL_APIENTRY void (*LinkProgram)(GLuint program);
+    NGLI_GL_APIENTRY void (*MakeTextureHandleNonResidentARB)(GLuint64 handle);
+    NGLI_GL_APIENTRY void (*MakeTextureHandleResidentARB)(GLuint64 handle);
+    NGLI_GL_APIENTRY void * (*MapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    NGLI_GL_APIENTRY void (*MaxShaderCompilerThreadsKHR)(GLuint count);
     NGLI_GL_APIENTRY void (*MemoryBarrier)(GLbitfield barriers);
+    NGLI_GL_APIENTRY void (*MultiDrawArraysIndirect)(GLenum mode, const void * indirect, GLsizei drawcount, GLsizei stride);
+    NGLI_GL_APIENTRY void (*MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride);
+    NGLI_GL_APIENTRY void (*ObjectLabel)(GLenum identifier, GLuint name, GLsizei length, const GLchar * label);
     NGLI_GL_APIENTRY void (*PixelStorei)(GLenum pname, GLint param);
     NGLI_GL_APIENTRY void (*PolygonMode)(GLenum face, GLenum mode);
+    NGLI_GL_APIENTRY void (*ProgramBinary)(GLuint program, GLenum binaryFormat, const void * binary, GLsizei length);
+    NGLI_GL_APIENTRY void (*ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+    NGLI_GL_APIENTRY void (*QueryCounter)(GLuint id, GLenum target);
+    NGLI_GL_APIENTRY void (*QueryCounterEXT)(GLuint id, GLenum target);
     NGLI_GL_APIENTRY void (*ReadBuffer)(GLenum src);
     NGLI_GL_APIENTRY void (*ReadPixels)(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void * pixels);
     NGLI_GL_APIENTRY void (*ReleaseShaderCompiler)();
     NGLI_GL_APIENTRY void (*RenderbufferStorage)(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
     NGLI_GL_APIENTRY void (*RenderbufferStorageMultisample)(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+    NGLI_GL_APIENTRY void (*RenderbufferStorageMultisampleEXT)(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+    NGLI_GL_APIENTRY void (*SamplerParameteri)(GLuint sampler, GLenum pname, GLint param);
     NGLI_GL_APIENTRY void (*Scissor)(GLint x, GLint y, GLsizei width, GLsizei height);
     NGLI_GL_APIENTRY void (*ShaderBinary)(GLsizei count, const GLuint * shaders, GLenum binaryformat, const void * binary, GLsizei length);
     NGLI_GL_APIENTRY void (*ShaderSource)(GLuint shader, GLsizei count, const GLchar *const* string, const GLint * length);
@@ -152,9 +185,11 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*Uniform4i)(GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
     NGLI_GL_APIENTRY void (*Uniform4iv)(GLint location, GLsizei count, const GLint * value);
     NGLI_GL_APIENTRY void (*UniformBlockBinding)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+    NGLI_GL_APIENTRY void (*UniformHandleui64ARB)(GLint location, GLuint64 value);
     NGLI_GL_APIENTRY void (*UniformMatrix2fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value);
     NGLI_GL_APIENTRY void (*UniformMatrix3fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value);
     NGLI_GL_APIENTRY void (*UniformMatrix4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value);
+    NGLI_GL_APIENTRY GLboolean (*UnmapBuffer)(GLenum target);
     NGLI_GL_APIENTRY void (*UseProgram)(GLuint program);
     NGLI_GL_APIENTRY void (*VertexAttribDivisor)(GLuint index, GLuint divisor);
     NGLI_GL_APIENTRY void (*VertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer);
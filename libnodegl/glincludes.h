@@ -63,6 +63,11 @@
 typedef void* GLeglImageOES;
 #endif
 
+#if !defined(GL_VERSION_4_3) && !defined(GL_ES_VERSION_3_2)
+typedef void (*GLDEBUGPROC)(GLenum source, GLenum type, GLuint id, GLenum severity,
+                            GLsizei length, const GLchar *message, const void *userParam);
+#endif
+
 #if NGL_OGL3_COMPAT_INCLUDES
 # define GL_LUMINANCE                          0x1909
 # define GL_LUMINANCE_ALPHA                    0x190A
@@ -96,6 +101,11 @@ typedef void* GLeglImageOES;
 # define GL_MINOR_VERSION                      0x821C
 # define GL_NUM_EXTENSIONS                     0x821D
 # define GL_HALF_FLOAT                         0x140B
+# define GL_UNSIGNED_INT_2_10_10_10_REV        0x8368
+# define GL_INT_2_10_10_10_REV                 0x8D9F
+# define GL_RGB10_A2                           0x8059
+# define GL_R11F_G11F_B10F                     0x8C3A
+# define GL_UNSIGNED_INT_10F_11F_11F_REV       0x8C3B
 # define GL_RED                                0x1903
 # define GL_RED_INTEGER                        0x8D94
 # define GL_RG                                 0x8227
@@ -166,6 +176,7 @@ typedef void* GLeglImageOES;
 # define GL_WRITE_ONLY                         0x88B9
 # define GL_READ_WRITE                         0x88BA
 # define GL_TIME_ELAPSED                       0x88BF
+# define GL_TIMESTAMP                          0x8E28
 # define GL_STREAM_READ                        0x88E1
 # define GL_STREAM_COPY                        0x88E2
 # define GL_STATIC_READ                        0x88E5
@@ -176,6 +187,7 @@ typedef void* GLeglImageOES;
 # define GL_POLYGON_MODE                       0x0B40
 # define GL_FILL                               0x1B02
 # define GL_TEXTURE_3D                         0x806F
+# define GL_TEXTURE_2D_ARRAY                   0x8C1A
 # define GL_TEXTURE_WRAP_R                     0x8072
 # define GL_MIN                                0x8007
 # define GL_MAX                                0x8008
@@ -189,6 +201,14 @@ typedef void* GLeglImageOES;
 # define GL_UNIFORM_BUFFER                     0x8A11
 # define GL_UNIFORM_BLOCK_BINDING              0x8A3F
 # define GL_MAX_UNIFORM_BLOCK_SIZE             0x8A30
+# define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT    0x8A34
+# define GL_MAP_READ_BIT                       0x0001
+# define GL_MAP_WRITE_BIT                      0x0002
+# define GL_MAP_INVALIDATE_BUFFER_BIT          0x0008
+# define GL_PIXEL_PACK_BUFFER                  0x88EB
+# define GL_PIXEL_UNPACK_BUFFER                0x88EC
+# define GL_SYNC_FLUSH_COMMANDS_BIT            0x00000001
+# define GL_TIMEOUT_EXPIRED                    0x911B
 # define GL_TEXTURE_CUBE_MAP                   0x8513
 # define GL_TEXTURE_BINDING_CUBE_MAP           0x8514
 # define GL_TEXTURE_CUBE_MAP_POSITIVE_X        0x8515
@@ -197,6 +217,11 @@ typedef void* GLeglImageOES;
 # define GL_TEXTURE_CUBE_MAP_NEGATIVE_Y        0x8518
 # define GL_TEXTURE_CUBE_MAP_POSITIVE_Z        0x8519
 # define GL_TEXTURE_CUBE_MAP_NEGATIVE_Z        0x851A
+# define GL_COLOR                              0x1800
+# define GL_PROGRAM_BINARY_RETRIEVABLE_HINT    0x8257
+# define GL_PROGRAM_BINARY_LENGTH              0x8741
+# define GL_DEPTH                              0x1801
+# define GL_STENCIL                            0x1802
 #endif
 
 #if NGL_CS_COMPAT_INCLUDES
@@ -209,6 +234,7 @@ typedef void* GLeglImageOES;
 # define GL_SHADER_STORAGE_BUFFER_BINDING      0x90D3
 # define GL_SHADER_STORAGE_BUFFER_START        0x90D4
 # define GL_SHADER_STORAGE_BUFFER_SIZE         0x90D5
+# define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
 # define GL_SHADER_STORAGE_BLOCK               0x92E6
 # define GL_BUFFER_BINDING                     0x9302
 # define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT    0x00000001
@@ -223,9 +249,93 @@ typedef void* GLeglImageOES;
 # define GL_FRAMEBUFFER_BARRIER_BIT            0x00000400
 # define GL_TRANSFORM_FEEDBACK_BARRIER_BIT     0x00000800
 # define GL_ATOMIC_COUNTER_BARRIER_BIT         0x00001000
+# define GL_SHADER_STORAGE_BARRIER_BIT         0x00002000
+# define GL_DISPATCH_INDIRECT_BUFFER           0x90EE
 # define GL_ALL_BARRIER_BITS                   0xFFFFFFFF
 # define GL_IMAGE_2D                           0x904D
 # define GL_ACTIVE_RESOURCES                   0x92F5
 #endif
 
+#ifndef GL_MAP_PERSISTENT_BIT
+# define GL_MAP_PERSISTENT_BIT                 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+# define GL_MAP_COHERENT_BIT                   0x0080
+#endif
+
+#ifndef GL_GPU_DISJOINT_EXT
+# define GL_GPU_DISJOINT_EXT                   0x8FBB
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+# define GL_COMPLETION_STATUS_KHR              0x91B1
+#endif
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+# define GL_DRAW_INDIRECT_BUFFER               0x8F3F
+#endif
+
+#ifndef GL_COMPRESSED_RGB8_ETC2
+# define GL_COMPRESSED_R11_EAC                        0x9270
+# define GL_COMPRESSED_RG11_EAC                       0x9272
+# define GL_COMPRESSED_RGB8_ETC2                      0x9274
+# define GL_COMPRESSED_SRGB8_ETC2                     0x9275
+# define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2  0x9276
+# define GL_COMPRESSED_RGBA8_ETC2_EAC                 0x9278
+# define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC          0x9279
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+# define GL_COMPRESSED_RGBA_ASTC_4x4_KHR              0x93B0
+# define GL_COMPRESSED_RGBA_ASTC_5x5_KHR              0x93B2
+# define GL_COMPRESSED_RGBA_ASTC_6x6_KHR              0x93B4
+# define GL_COMPRESSED_RGBA_ASTC_8x8_KHR              0x93B7
+# define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR      0x93D0
+# define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR      0x93D2
+# define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR      0x93D4
+# define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR      0x93D7
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+# define GL_COMPRESSED_RGB_S3TC_DXT1_EXT              0x83F0
+# define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT             0x83F1
+# define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT             0x83F2
+# define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT             0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_RED_RGTC1
+# define GL_COMPRESSED_RED_RGTC1                      0x8DBB
+# define GL_COMPRESSED_RG_RGTC2                       0x8DBD
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+# define GL_COMPRESSED_RGBA_BPTC_UNORM                0x8E8C
+# define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM          0x8E8D
+# define GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT        0x8E8F
+#endif
+
+#ifndef GL_COPY_READ_BUFFER
+# define GL_COPY_READ_BUFFER                          0x8F36
+# define GL_COPY_WRITE_BUFFER                         0x8F37
+#endif
+
+#ifndef GL_ANY_SAMPLES_PASSED
+# define GL_ANY_SAMPLES_PASSED                        0x8C2F
+#endif
+
+#ifndef GL_DEBUG_OUTPUT
+# define GL_DEBUG_OUTPUT                              0x92E0
+# define GL_DEBUG_TYPE_ERROR                          0x824C
+# define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR            0x824D
+# define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR             0x824E
+# define GL_DEBUG_TYPE_PORTABILITY                    0x824F
+# define GL_DEBUG_TYPE_PERFORMANCE                    0x8250
+# define GL_DEBUG_SEVERITY_HIGH                       0x9146
+# define GL_DEBUG_SEVERITY_MEDIUM                     0x9147
+# define GL_DEBUG_SEVERITY_LOW                        0x9148
+# define GL_DEBUG_SEVERITY_NOTIFICATION               0x826B
+# define GL_BUFFER                                    0x82E0
+#endif
+
 #endif /* GLINCLUDES_H */
@@ -26,6 +26,7 @@
 #include "glstate.h"
 #include "graphicconfig.h"
 #include "nodes.h"
+#include "utils.h"
 
 static const GLenum gl_blend_factor_map[NGLI_BLEND_FACTOR_NB] = {
     [NGLI_BLEND_FACTOR_ZERO]                = GL_ZERO,
@@ -140,7 +141,7 @@ void ngli_glstate_probe(const struct glcontext *gl, struct glstate *state)
 
 }
 
-static void init_state(struct glstate *s, const struct graphicconfig *gc)
+void ngli_glstate_resolve(struct glstate *s, const struct graphicconfig *gc)
 {
     s->blend              = gc->blend;
     s->blend_dst_factor   = get_gl_blend_factor(gc->blend_dst_factor);
@@ -287,14 +288,193 @@ static int honor_state(const struct glcontext *gl,
     return 1;
 }
 
+void ngli_glstate_set_pending(struct ngl_ctx *ctx, const struct graphicconfig *gc,
+                              const struct glstate *glstate)
+{
+    if (memcmp(&ctx->graphicconfig, gc, sizeof(*gc))) {
+        ctx->graphicconfig = *gc;
+        ctx->graphicconfig_gen++;
+    }
+    if (glstate && ctx->pending_glstate_gen != ctx->graphicconfig_gen) {
+        ctx->pending_glstate = *glstate;
+        ctx->pending_glstate_gen = ctx->graphicconfig_gen;
+    }
+}
+
 void ngli_honor_pending_glstate(struct ngl_ctx *ctx)
 {
     struct glcontext *gl = ctx->glcontext;
 
-    struct glstate glstate = {0};
-    init_state(&glstate, &ctx->graphicconfig);
+    if (ctx->glstate_gen == ctx->graphicconfig_gen)
+        return;
+
+    if (ctx->pending_glstate_gen != ctx->graphicconfig_gen) {
+        memset(&ctx->pending_glstate, 0, sizeof(ctx->pending_glstate));
+        ngli_glstate_resolve(&ctx->pending_glstate, &ctx->graphicconfig);
+        ctx->pending_glstate_gen = ctx->graphicconfig_gen;
+    }
 
-    int ret = honor_state(gl, &glstate, &ctx->glstate);
+    int ret = honor_state(gl, &ctx->pending_glstate, &ctx->glstate);
     if (ret > 0)
-        ctx->glstate = glstate;
+        ctx->glstate = ctx->pending_glstate;
+    ctx->glstate_gen = ctx->graphicconfig_gen;
+}
+
+void ngli_glstate_reset_bindings(struct glcontext *gl)
+{
+    memset(&gl->bindings, 0xff, sizeof(gl->bindings));
+}
+
+void ngli_glstate_use_program(struct glcontext *gl, GLuint program)
+{
+    struct glbindings *b = &gl->bindings;
+    if (b->program == program)
+        return;
+    ngli_glUseProgram(gl, program);
+    b->program = program;
+}
+
+void ngli_glstate_bind_vertex_array(struct glcontext *gl, GLuint vertex_array)
+{
+    struct glbindings *b = &gl->bindings;
+    if (b->vertex_array == vertex_array)
+        return;
+    ngli_glBindVertexArray(gl, vertex_array);
+    b->vertex_array = vertex_array;
+
+    /* The element array buffer binding is part of the vertex array state */
+    b->element_array_buffer = NGLI_GLBINDINGS_UNKNOWN;
+}
+
+static GLuint *get_buffer_binding(struct glbindings *b, GLenum target)
+{
+    switch (target) {
+        case GL_ARRAY_BUFFER:           return &b->array_buffer;
+        case GL_ELEMENT_ARRAY_BUFFER:   return &b->element_array_buffer;
+    }
+    return NULL;
+}
+
+void ngli_glstate_bind_buffer(struct glcontext *gl, GLenum target, GLuint buffer)
+{
+    GLuint *binding = get_buffer_binding(&gl->bindings, target);
+    if (binding && *binding == buffer)
+        return;
+    ngli_glBindBuffer(gl, target, buffer);
+    if (binding)
+        *binding = buffer;
+}
+
+static GLuint *get_indexed_buffer_binding(struct glbindings *b, GLenum target, GLuint index)
+{
+    if (index >= NGLI_GLBINDINGS_MAX_BUFFER_BINDINGS)
+        return NULL;
+    switch (target) {
+        case GL_UNIFORM_BUFFER:         return &b->uniform_buffers[index];
+        case GL_SHADER_STORAGE_BUFFER:  return &b->storage_buffers[index];
+    }
+    return NULL;
+}
+
+void ngli_glstate_bind_buffer_base(struct glcontext *gl, GLenum target, GLuint index, GLuint buffer)
+{
+    GLuint *binding = get_indexed_buffer_binding(&gl->bindings, target, index);
+    if (binding && *binding == buffer)
+        return;
+    ngli_glBindBufferBase(gl, target, index, buffer);
+    if (binding)
+        *binding = buffer;
+}
+
+void ngli_glstate_bind_buffer_range(struct glcontext *gl, GLenum target, GLuint index, GLuint buffer,
+                                    GLintptr offset, GLsizeiptr size)
+{
+    /* The cache does not track the ranges so the binding becomes unknown */
+    GLuint *binding = get_indexed_buffer_binding(&gl->bindings, target, index);
+    ngli_glBindBufferRange(gl, target, index, buffer, offset, size);
+    if (binding)
+        *binding = NGLI_GLBINDINGS_UNKNOWN;
+}
+
+void ngli_glstate_active_texture(struct glcontext *gl, GLenum texture)
+{
+    struct glbindings *b = &gl->bindings;
+    if (b->active_texture == texture)
+        return;
+    ngli_glActiveTexture(gl, texture);
+    b->active_texture = texture;
+}
+
+static GLuint *get_texture_binding(struct glbindings *b, GLenum target)
+{
+    if (b->active_texture == NGLI_GLBINDINGS_UNKNOWN)
+        return NULL;
+    const GLuint unit = b->active_texture - GL_TEXTURE0;
+    if (unit >= NGLI_GLBINDINGS_MAX_TEXTURE_UNITS)
+        return NULL;
+    switch (target) {
+        case GL_TEXTURE_2D:             return &b->textures[unit][NGLI_GLBINDINGS_TEXTURE_2D];
+        case GL_TEXTURE_RECTANGLE:      return &b->textures[unit][NGLI_GLBINDINGS_TEXTURE_2D_RECT];
+        case GL_TEXTURE_3D:             return &b->textures[unit][NGLI_GLBINDINGS_TEXTURE_3D];
+        case GL_TEXTURE_CUBE_MAP:       return &b->textures[unit][NGLI_GLBINDINGS_TEXTURE_CUBE];
+        case GL_TEXTURE_EXTERNAL_OES:   return &b->textures[unit][NGLI_GLBINDINGS_TEXTURE_EXTERNAL_OES];
+    }
+    return NULL;
+}
+
+void ngli_glstate_bind_texture(struct glcontext *gl, GLenum target, GLuint texture)
+{
+    GLuint *binding = get_texture_binding(&gl->bindings, target);
+    if (binding && *binding == texture)
+        return;
+    ngli_glBindTexture(gl, target, texture);
+    if (binding)
+        *binding = texture;
+}
+
+void ngli_glstate_bind_sampler(struct glcontext *gl, GLuint unit, GLuint sampler)
+{
+    struct glbindings *b = &gl->bindings;
+    GLuint *binding = unit < NGLI_GLBINDINGS_MAX_TEXTURE_UNITS ? &b->samplers[unit] : NULL;
+    if (binding && *binding == sampler)
+        return;
+    ngli_glBindSampler(gl, unit, sampler);
+    if (binding)
+        *binding = sampler;
+}
+
+static void forget_binding(GLuint *bindings, int nb_bindings, GLuint id)
+{
+    for (int i = 0; i < nb_bindings; i++)
+        if (bindings[i] == id)
+            bindings[i] = NGLI_GLBINDINGS_UNKNOWN;
+}
+
+void ngli_glstate_forget_program(struct glcontext *gl, GLuint program)
+{
+    forget_binding(&gl->bindings.program, 1, program);
+}
+
+void ngli_glstate_forget_vertex_array(struct glcontext *gl, GLuint vertex_array)
+{
+    struct glbindings *b = &gl->bindings;
+    if (b->vertex_array == vertex_array) {
+        b->vertex_array = NGLI_GLBINDINGS_UNKNOWN;
+        b->element_array_buffer = NGLI_GLBINDINGS_UNKNOWN;
+    }
+}
+
+void ngli_glstate_forget_buffer(struct glcontext *gl, GLuint buffer)
+{
+    struct glbindings *b = &gl->bindings;
+    forget_binding(&b->array_buffer, 1, buffer);
+    forget_binding(&b->element_array_buffer, 1, buffer);
+    forget_binding(b->uniform_buffers, NGLI_ARRAY_NB(b->uniform_buffers), buffer);
+    forget_binding(b->storage_buffers, NGLI_ARRAY_NB(b->storage_buffers), buffer);
+}
+
+void ngli_glstate_forget_texture(struct glcontext *gl, GLuint texture)
+{
+    struct glbindings *b = &gl->bindings;
+    forget_binding(&b->textures[0][0], sizeof(b->textures) / sizeof(b->textures[0][0]), texture);
 }
@@ -24,6 +24,7 @@
 
 #include "glcontext.h"
 #include "glincludes.h"
+#include "graphicconfig.h"
 
 struct glstate {
     GLenum blend;
@@ -59,6 +60,39 @@ struct glstate {
 void ngli_glstate_probe(const struct glcontext *gl,
                         struct glstate *glstate);
 
+/*
+ * Resolve the GL state corresponding to a graphic configuration.
+ */
+void ngli_glstate_resolve(struct glstate *glstate, const struct graphicconfig *gc);
+
+/*
+ * Set the graphic configuration to honor with the next draw. The glstate
+ * may be provided if already resolved; otherwise it is only resolved when
+ * honored. The GL state is not diffed again until the configuration changes.
+ */
+void ngli_glstate_set_pending(struct ngl_ctx *ctx, const struct graphicconfig *gc,
+                              const struct glstate *glstate);
+
 void ngli_honor_pending_glstate(struct ngl_ctx *ctx);
 
+void ngli_glstate_reset_bindings(struct glcontext *gl);
+void ngli_glstate_use_program(struct glcontext *gl, GLuint program);
+void ngli_glstate_bind_vertex_array(struct glcontext *gl, GLuint vertex_array);
+void ngli_glstate_bind_buffer(struct glcontext *gl, GLenum target, GLuint buffer);
+void ngli_glstate_bind_buffer_base(struct glcontext *gl, GLenum target, GLuint index, GLuint buffer);
+void ngli_glstate_bind_buffer_range(struct glcontext *gl, GLenum target, GLuint index, GLuint buffer,
+                                    GLintptr offset, GLsizeiptr size);
+void ngli_glstate_active_texture(struct glcontext *gl, GLenum texture);
+void ngli_glstate_bind_texture(struct glcontext *gl, GLenum target, GLuint texture);
+void ngli_glstate_bind_sampler(struct glcontext *gl, GLuint unit, GLuint sampler);
+
+/*
+ * Must be called when an object is deleted (or may have been deleted
+ * externally) so its name can not be mistaken for a later object reusing it
+ */
+void ngli_glstate_forget_program(struct glcontext *gl, GLuint program);
+void ngli_glstate_forget_vertex_array(struct glcontext *gl, GLuint vertex_array);
+void ngli_glstate_forget_buffer(struct glcontext *gl, GLuint buffer);
+void ngli_glstate_forget_texture(struct glcontext *gl, GLuint texture);
+
 #endif
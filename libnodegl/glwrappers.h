@@ -74,6 +74,12 @@ static inline void ngli_glBindRenderbuffer(const struct glcontext *gl, GLenum ta
     check_error_code(gl, "glBindRenderbuffer");
 }
 
+static inline void ngli_glBindSampler(const struct glcontext *gl, GLuint unit, GLuint sampler)
+{
+    gl->funcs.BindSampler(unit, sampler);
+    check_error_code(gl, "glBindSampler");
+}
+
 static inline void ngli_glBindTexture(const struct glcontext *gl, GLenum target, GLuint texture)
 {
     gl->funcs.BindTexture(target, texture);
@@ -128,6 +134,12 @@ static inline void ngli_glBufferData(const struct glcontext *gl, GLenum target,
     check_error_code(gl, "glBufferData");
 }
 
+static inline void ngli_glBufferStorage(const struct glcontext *gl, GLenum target, GLsizeiptr size, const void * data, GLbitfield flags)
+{
+    gl->funcs.BufferStorage(target, size, data, flags);
+    check_error_code(gl, "glBufferStorage");
+}
+
 static inline void ngli_glBufferSubData(const struct glcontext *gl, GLenum target, GLintptr offset, GLsizeiptr size, const void * data)
 {
     gl->funcs.BufferSubData(target, offset, size, data);
@@ -172,6 +184,24 @@ static inline void ngli_glCompileShader(const struct glcontext *gl, GLuint shade
     check_error_code(gl, "glCompileShader");
 }
 
+static inline void ngli_glCompressedTexImage2D(const struct glcontext *gl, GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void * data)
+{
+    gl->funcs.CompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+    check_error_code(gl, "glCompressedTexImage2D");
+}
+
+static inline void ngli_glCompressedTexSubImage2D(const struct glcontext *gl, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void * data)
+{
+    gl->funcs.CompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data);
+    check_error_code(gl, "glCompressedTexSubImage2D");
+}
+
+static inline void ngli_glCopyBufferSubData(const struct glcontext *gl, GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+    gl->funcs.CopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+    check_error_code(gl, "glCopyBufferSubData");
+}
+
 static inline GLuint ngli_glCreateProgram(const struct glcontext *gl)
 {
     GLuint ret = gl->funcs.CreateProgram();
@@ -192,6 +222,18 @@ static inline void ngli_glCullFace(const struct glcontext *gl, GLenum mode)
     check_error_code(gl, "glCullFace");
 }
 
+static inline void ngli_glDebugMessageCallback(const struct glcontext *gl, GLDEBUGPROC callback, const void * userParam)
+{
+    gl->funcs.DebugMessageCallback(callback, userParam);
+    check_error_code(gl, "glDebugMessageCallback");
+}
+
+static inline void ngli_glDebugMessageControl(const struct glcontext *gl, GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint * ids, GLboolean enabled)
+{
+    gl->funcs.DebugMessageControl(source, type, severity, count, ids, enabled);
+    check_error_code(gl, "glDebugMessageControl");
+}
+
 static inline void ngli_glDeleteBuffers(const struct glcontext *gl, GLsizei n, const GLuint * buffers)
 {
     gl->funcs.DeleteBuffers(n, buffers);
@@ -228,12 +270,24 @@ static inline void ngli_glDeleteRenderbuffers(const struct glcontext *gl, GLsize
     check_error_code(gl, "glDeleteRenderbuffers");
 }
 
+static inline void ngli_glDeleteSamplers(const struct glcontext *gl, GLsizei n, const GLuint * samplers)
+{
+    gl->funcs.DeleteSamplers(n, samplers);
+    check_error_code(gl, "glDeleteSamplers");
+}
+
 static inline void ngli_glDeleteShader(const struct glcontext *gl, GLuint shader)
 {
     gl->funcs.DeleteShader(shader);
     check_error_code(gl, "glDeleteShader");
 }
 
+static inline void ngli_glDeleteSync(const struct glcontext *gl, GLsync sync)
+{
+    gl->funcs.DeleteSync(sync);
+    check_error_code(gl, "glDeleteSync");
+}
+
 static inline void ngli_glDeleteTextures(const struct glcontext *gl, GLsizei n, const GLuint * textures)
 {
     gl->funcs.DeleteTextures(n, textures);
@@ -282,12 +336,24 @@ static inline void ngli_glDispatchCompute(const struct glcontext *gl, GLuint num
     check_error_code(gl, "glDispatchCompute");
 }
 
+static inline void ngli_glDispatchComputeIndirect(const struct glcontext *gl, GLintptr indirect)
+{
+    gl->funcs.DispatchComputeIndirect(indirect);
+    check_error_code(gl, "glDispatchComputeIndirect");
+}
+
 static inline void ngli_glDrawArrays(const struct glcontext *gl, GLenum mode, GLint first, GLsizei count)
 {
     gl->funcs.DrawArrays(mode, first, count);
     check_error_code(gl, "glDrawArrays");
 }
 
+static inline void ngli_glDrawArraysIndirect(const struct glcontext *gl, GLenum mode, const void * indirect)
+{
+    gl->funcs.DrawArraysIndirect(mode, indirect);
+    check_error_code(gl, "glDrawArraysIndirect");
+}
+
 static inline void ngli_glDrawArraysInstanced(const struct glcontext *gl, GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
 {
     gl->funcs.DrawArraysInstanced(mode, first, count, instancecount);
@@ -306,6 +372,12 @@ static inline void ngli_glDrawElements(const struct glcontext *gl, GLenum mode,
     check_error_code(gl, "glDrawElements");
 }
 
+static inline void ngli_glDrawElementsIndirect(const struct glcontext *gl, GLenum mode, GLenum type, const void * indirect)
+{
+    gl->funcs.DrawElementsIndirect(mode, type, indirect);
+    check_error_code(gl, "glDrawElementsIndirect");
+}
+
 static inline void ngli_glDrawElementsInstanced(const struct glcontext *gl, GLenum mode, GLsizei count, GLenum type, const void * indices, GLsizei instancecount)
 {
     gl->funcs.DrawElementsInstanced(mode, count, type, indices, instancecount);
@@ -373,6 +445,24 @@ static inline void ngli_glFramebufferTexture2D(const struct glcontext *gl, GLenu
     check_error_code(gl, "glFramebufferTexture2D");
 }
 
+static inline void ngli_glFramebufferTexture2DMultisampleEXT(const struct glcontext *gl, GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples)
+{
+    gl->funcs.FramebufferTexture2DMultisampleEXT(target, attachment, textarget, texture, level, samples);
+    check_error_code(gl, "glFramebufferTexture2DMultisampleEXT");
+}
+
+static inline void ngli_glFramebufferTextureLayer(const struct glcontext *gl, GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer)
+{
+    gl->funcs.FramebufferTextureLayer(target, attachment, texture, level, layer);
+    check_error_code(gl, "glFramebufferTextureLayer");
+}
+
+static inline void ngli_glFramebufferTextureMultiviewOVR(const struct glcontext *gl, GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews)
+{
+    gl->funcs.FramebufferTextureMultiviewOVR(target, attachment, texture, level, baseViewIndex, numViews);
+    check_error_code(gl, "glFramebufferTextureMultiviewOVR");
+}
+
 static inline void ngli_glGenBuffers(const struct glcontext *gl, GLsizei n, GLuint * buffers)
 {
     gl->funcs.GenBuffers(n, buffers);
@@ -403,6 +493,12 @@ static inline void ngli_glGenRenderbuffers(const struct glcontext *gl, GLsizei n
     check_error_code(gl, "glGenRenderbuffers");
 }
 
+static inline void ngli_glGenSamplers(const struct glcontext *gl, GLsizei n, GLuint * samplers)
+{
+    gl->funcs.GenSamplers(n, samplers);
+    check_error_code(gl, "glGenSamplers");
+}
+
 static inline void ngli_glGenTextures(const struct glcontext *gl, GLsizei n, GLuint * textures)
 {
     gl->funcs.GenTextures(n, textures);
@@ -487,6 +583,12 @@ static inline void ngli_glGetInternalformativ(const struct glcontext *gl, GLenum
     check_error_code(gl, "glGetInternalformativ");
 }
 
+static inline void ngli_glGetProgramBinary(const struct glcontext *gl, GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void * binary)
+{
+    gl->funcs.GetProgramBinary(program, bufSize, length, binaryFormat, binary);
+    check_error_code(gl, "glGetProgramBinary");
+}
+
 static inline void ngli_glGetProgramInfoLog(const struct glcontext *gl, GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog)
 {
     gl->funcs.GetProgramInfoLog(program, bufSize, length, infoLog);
@@ -543,6 +645,12 @@ static inline void ngli_glGetQueryObjectui64vEXT(const struct glcontext *gl, GLu
     check_error_code(gl, "glGetQueryObjectui64vEXT");
 }
 
+static inline void ngli_glGetQueryObjectuiv(const struct glcontext *gl, GLuint id, GLenum pname, GLuint * params)
+{
+    gl->funcs.GetQueryObjectuiv(id, pname, params);
+    check_error_code(gl, "glGetQueryObjectuiv");
+}
+
 static inline void ngli_glGetRenderbufferParameteriv(const struct glcontext *gl, GLenum target, GLenum pname, GLint * params)
 {
     gl->funcs.GetRenderbufferParameteriv(target, pname, params);
@@ -581,6 +689,20 @@ static inline const GLubyte * ngli_glGetStringi(const struct glcontext *gl, GLen
     return ret;
 }
 
+static inline GLuint64 ngli_glGetTextureHandleARB(const struct glcontext *gl, GLuint texture)
+{
+    GLuint64 ret = gl->funcs.GetTextureHandleARB(texture);
+    check_error_code(gl, "glGetTextureHandleARB");
+    return ret;
+}
+
+static inline GLuint64 ngli_glGetTextureSamplerHandleARB(const struct glcontext *gl, GLuint texture, GLuint sampler)
+{
+    GLuint64 ret = gl->funcs.GetTextureSamplerHandleARB(texture, sampler);
+    check_error_code(gl, "glGetTextureSamplerHandleARB");
+    return ret;
+}
+
 static inline GLuint ngli_glGetUniformBlockIndex(const struct glcontext *gl, GLuint program, const GLchar * uniformBlockName)
 {
     GLuint ret = gl->funcs.GetUniformBlockIndex(program, uniformBlockName);
@@ -613,12 +735,55 @@ static inline void ngli_glLinkProgram(const struct glcontext *gl, GLuint program
     check_error_code(gl, "glLinkProgram");
 }
 
+static inline void ngli_glMakeTextureHandleNonResidentARB(const struct glcontext *gl, GLuint64 handle)
+{
+    gl->funcs.MakeTextureHandleNonResidentARB(handle);
+    check_error_code(gl, "glMakeTextureHandleNonResidentARB");
+}
+
+static inline void ngli_glMakeTextureHandleResidentARB(const struct glcontext *gl, GLuint64 handle)
+{
+    gl->funcs.MakeTextureHandleResidentARB(handle);
+    check_error_code(gl, "glMakeTextureHandleResidentARB");
+}
+
+static inline void * ngli_glMapBufferRange(const struct glcontext *gl, GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    void * ret = gl->funcs.MapBufferRange(target, offset, length, access);
+    check_error_code(gl, "glMapBufferRange");
+    return ret;
+}
+
+static inline void ngli_glMaxShaderCompilerThreadsKHR(const struct glcontext *gl, GLuint count)
+{
+    gl->funcs.MaxShaderCompilerThreadsKHR(count);
+    check_error_code(gl, "glMaxShaderCompilerThreadsKHR");
+}
+
 static inline void ngli_glMemoryBarrier(const struct glcontext *gl, GLbitfield barriers)
 {
     gl->funcs.MemoryBarrier(barriers);
     check_error_code(gl, "glMemoryBarrier");
 }
 
+static inline void ngli_glMultiDrawArraysIndirect(const struct glcontext *gl, GLenum mode, const void * indirect, GLsizei drawcount, GLsizei stride)
+{
+    gl->funcs.MultiDrawArraysIndirect(mode, indirect, drawcount, stride);
+    check_error_code(gl, "glMultiDrawArraysIndirect");
+}
+
+static inline void ngli_glMultiDrawElementsIndirect(const struct glcontext *gl, GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride)
+{
+    gl->funcs.MultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+    check_error_code(gl, "glMultiDrawElementsIndirect");
+}
+
+static inline void ngli_glObjectLabel(const struct glcontext *gl, GLenum identifier, GLuint name, GLsizei length, const GLchar * label)
+{
+    gl->funcs.ObjectLabel(identifier, name, length, label);
+    check_error_code(gl, "glObjectLabel");
+}
+
 static inline void ngli_glPixelStorei(const struct glcontext *gl, GLenum pname, GLint param)
 {
     gl->funcs.PixelStorei(pname, param);
@@ -631,6 +796,30 @@ static inline void ngli_glPolygonMode(const struct glcontext *gl, GLenum face, G
     check_error_code(gl, "glPolygonMode");
 }
 
+static inline void ngli_glProgramBinary(const struct glcontext *gl, GLuint program, GLenum binaryFormat, const void * binary, GLsizei length)
+{
+    gl->funcs.ProgramBinary(program, binaryFormat, binary, length);
+    check_error_code(gl, "glProgramBinary");
+}
+
+static inline void ngli_glProgramParameteri(const struct glcontext *gl, GLuint program, GLenum pname, GLint value)
+{
+    gl->funcs.ProgramParameteri(program, pname, value);
+    check_error_code(gl, "glProgramParameteri");
+}
+
+static inline void ngli_glQueryCounter(const struct glcontext *gl, GLuint id, GLenum target)
+{
+    gl->funcs.QueryCounter(id, target);
+    check_error_code(gl, "glQueryCounter");
+}
+
+static inline void ngli_glQueryCounterEXT(const struct glcontext *gl, GLuint id, GLenum target)
+{
+    gl->funcs.QueryCounterEXT(id, target);
+    check_error_code(gl, "glQueryCounterEXT");
+}
+
 static inline void ngli_glReadBuffer(const struct glcontext *gl, GLenum src)
 {
     gl->funcs.ReadBuffer(src);
@@ -661,6 +850,18 @@ static inline void ngli_glRenderbufferStorageMultisample(const struct glcontext
     check_error_code(gl, "glRenderbufferStorageMultisample");
 }
 
+static inline void ngli_glRenderbufferStorageMultisampleEXT(const struct glcontext *gl, GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    gl->funcs.RenderbufferStorageMultisampleEXT(target, samples, internalformat, width, height);
+    check_error_code(gl, "glRenderbufferStorageMultisampleEXT");
+}
+
+static inline void ngli_glSamplerParameteri(const struct glcontext *gl, GLuint sampler, GLenum pname, GLint param)
+{
+    gl->funcs.SamplerParameteri(sampler, pname, param);
+    check_error_code(gl, "glSamplerParameteri");
+}
+
 static inline void ngli_glScissor(const struct glcontext *gl, GLint x, GLint y, GLsizei width, GLsizei height)
 {
     gl->funcs.Scissor(x, y, width, height);
@@ -859,6 +1060,12 @@ static inline void ngli_glUniformBlockBinding(const struct glcontext *gl, GLuint
     check_error_code(gl, "glUniformBlockBinding");
 }
 
+static inline void ngli_glUniformHandleui64ARB(const struct glcontext *gl, GLint location, GLuint64 value)
+{
+    gl->funcs.UniformHandleui64ARB(location, value);
+    check_error_code(gl, "glUniformHandleui64ARB");
+}
+
 static inline void ngli_glUniformMatrix2fv(const struct glcontext *gl, GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
 {
     gl->funcs.UniformMatrix2fv(location, count, transpose, value);
@@ -877,6 +1084,13 @@ static inline void ngli_glUniformMatrix4fv(const struct glcontext *gl, GLint loc
     check_error_code(gl, "glUniformMatrix4fv");
 }
 
+static inline GLboolean ngli_glUnmapBuffer(const struct glcontext *gl, GLenum target)
+{
+    GLboolean ret = gl->funcs.UnmapBuffer(target);
+    check_error_code(gl, "glUnmapBuffer");
+    return ret;
+}
+
 static inline void ngli_glUseProgram(const struct glcontext *gl, GLuint program)
 {
     gl->funcs.UseProgram(program);
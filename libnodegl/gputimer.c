@@ -0,0 +1,114 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "glcontext.h"
+#include "gputimer.h"
+#include "nodegl.h"
+
+int ngli_gputimer_init(struct gputimer *s, struct glcontext *gl)
+{
+    memset(s, 0, sizeof(*s));
+
+    if (gl->features & NGLI_FEATURE_TIMER_QUERY) {
+        s->glGenQueries          = ngli_glGenQueries;
+        s->glDeleteQueries       = ngli_glDeleteQueries;
+        s->glQueryCounter        = ngli_glQueryCounter;
+        s->glGetQueryObjectui64v = ngli_glGetQueryObjectui64v;
+    } else if (gl->features & NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY) {
+        s->glGenQueries          = ngli_glGenQueriesEXT;
+        s->glDeleteQueries       = ngli_glDeleteQueriesEXT;
+        s->glQueryCounter        = ngli_glQueryCounterEXT;
+        s->glGetQueryObjectui64v = ngli_glGetQueryObjectui64vEXT;
+        s->check_disjoint = 1;
+    } else {
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    s->gl = gl;
+    for (int i = 0; i < NGLI_GPUTIMER_NB_QUERIES; i++)
+        s->glGenQueries(gl, 2, s->queries[i]);
+    return 0;
+}
+
+void ngli_gputimer_begin(struct gputimer *s)
+{
+    if (!s->gl || s->nb_pending == NGLI_GPUTIMER_NB_QUERIES)
+        return;
+    s->glQueryCounter(s->gl, s->queries[s->head][0], GL_TIMESTAMP);
+    s->started = 1;
+}
+
+void ngli_gputimer_end(struct gputimer *s)
+{
+    if (!s->started)
+        return;
+    s->glQueryCounter(s->gl, s->queries[s->head][1], GL_TIMESTAMP);
+    s->head = (s->head + 1) % NGLI_GPUTIMER_NB_QUERIES;
+    s->nb_pending++;
+    s->started = 0;
+}
+
+int ngli_gputimer_read(struct gputimer *s, int64_t *t)
+{
+    if (!s->nb_pending)
+        return 0;
+
+    /*
+     * With EXT_disjoint_timer_query, a disjoint operation (such as a GPU
+     * frequency change) makes the results of the queries in flight
+     * meaningless
+     */
+    if (s->check_disjoint) {
+        GLint disjoint = 0;
+        ngli_glGetIntegerv(s->gl, GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint) {
+            s->nb_pending = 0;
+            return 0;
+        }
+    }
+
+    const int tail = (s->head - s->nb_pending + NGLI_GPUTIMER_NB_QUERIES) % NGLI_GPUTIMER_NB_QUERIES;
+    const GLuint *queries = s->queries[tail];
+
+    GLuint64 available = 0;
+    s->glGetQueryObjectui64v(s->gl, queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return 0;
+
+    GLuint64 start = 0, end = 0;
+    s->glGetQueryObjectui64v(s->gl, queries[0], GL_QUERY_RESULT, &start);
+    s->glGetQueryObjectui64v(s->gl, queries[1], GL_QUERY_RESULT, &end);
+    s->nb_pending--;
+
+    *t = end - start;
+    return 1;
+}
+
+void ngli_gputimer_reset(struct gputimer *s)
+{
+    if (s->gl) {
+        for (int i = 0; i < NGLI_GPUTIMER_NB_QUERIES; i++)
+            s->glDeleteQueries(s->gl, 2, s->queries[i]);
+    }
+    memset(s, 0, sizeof(*s));
+}
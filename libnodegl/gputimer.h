@@ -0,0 +1,70 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <stdint.h>
+
+#include "glcontext.h"
+
+/*
+ * Number of measures a GPU timer can have in flight before their results
+ * are read back; if the GPU lags further behind, the measures are skipped
+ */
+#define NGLI_GPUTIMER_NB_QUERIES 4
+
+/*
+ * Ring of timestamp query pairs (start and end of the timed scope) read back
+ * without ever waiting for the GPU. Unlike GL_TIME_ELAPSED queries,
+ * timestamps can be nested, so any number of timers can be running at the
+ * same time.
+ */
+struct gputimer {
+    struct glcontext *gl;
+    GLuint queries[NGLI_GPUTIMER_NB_QUERIES][2];
+    int head;
+    int nb_pending;
+    int started;
+    int check_disjoint;
+    void (*glGenQueries)(const struct glcontext *gl, GLsizei n, GLuint * ids);
+    void (*glDeleteQueries)(const struct glcontext *gl, GLsizei n, const GLuint * ids);
+    void (*glQueryCounter)(const struct glcontext *gl, GLuint id, GLenum target);
+    void (*glGetQueryObjectui64v)(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 *params);
+};
+
+/*
+ * Return 0 on success, or NGL_ERROR_UNSUPPORTED if the context does not
+ * support timer queries, in which case the timer is a no-op.
+ */
+int ngli_gputimer_init(struct gputimer *s, struct glcontext *gl);
+void ngli_gputimer_begin(struct gputimer *s);
+void ngli_gputimer_end(struct gputimer *s);
+
+/*
+ * Fetch the oldest measure (in nanoseconds) if the GPU is done with it.
+ * Return 1 if a measure was read, 0 otherwise.
+ */
+int ngli_gputimer_read(struct gputimer *s, int64_t *t);
+
+void ngli_gputimer_reset(struct gputimer *s);
+
+#endif
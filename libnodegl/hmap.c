@@ -28,16 +28,30 @@
 #include "nodegl.h"
 #include "utils.h"
 
-struct bucket {
-    struct hmap_entry *entries;
-    int nb_entries;
+/*
+ * The entries are stored contiguously in insertion order, and indexed by an
+ * open-addressing table using Robin Hood hashing. Each slot holds the hash
+ * of its entry key so most of the probing does not need to dereference the
+ * entries, and the hashes are kept to rebuild the index without hashing the
+ * keys again.
+ *
+ * Removed entries are left as holes (with a NULL key) in the entries array
+ * until it needs to grow, at which point it is compacted.
+ */
+
+struct slot {
+    uint32_t hash;
+    int entry_id; // -1 if the slot is empty
 };
 
 struct hmap {
-    struct bucket *buckets;
+    struct slot *slots;
     int size;
     uint32_t mask;
-    int count; // total number of entries
+    struct hmap_entry *entries;
+    int nb_entries; // including the removed ones
+    int entries_capacity;
+    int count; // number of live entries
     user_free_func_type user_free_func;
     void *user_arg;
 };
@@ -48,6 +62,16 @@ void ngli_hmap_set_free(struct hmap *hm, user_free_func_type user_free_func, voi
     hm->user_arg = user_arg;
 }
 
+static struct slot *alloc_slots(int size)
+{
+    struct slot *slots = ngli_malloc(size * sizeof(*slots));
+    if (!slots)
+        return NULL;
+    for (int i = 0; i < size; i++)
+        slots[i].entry_id = -1;
+    return slots;
+}
+
 struct hmap *ngli_hmap_create(void)
 {
     struct hmap *hm = ngli_calloc(1, sizeof(*hm));
@@ -55,8 +79,8 @@ struct hmap *ngli_hmap_create(void)
         return NULL;
     hm->size = 1 << HMAP_SIZE_NBIT;
     hm->mask = hm->size - 1;
-    hm->buckets = ngli_calloc(hm->size, sizeof(*hm->buckets));
-    if (!hm->buckets) {
+    hm->slots = alloc_slots(hm->size);
+    if (!hm->slots) {
         ngli_free(hm);
         return NULL;
     }
@@ -68,136 +92,180 @@ int ngli_hmap_count(const struct hmap *hm)
     return hm->count;
 }
 
-int ngli_hmap_set(struct hmap *hm, const char *key, void *data)
+/* FNV-1a */
+uint32_t ngli_hmap_hash(const char *key)
 {
-    if (!key)
-        return NGL_ERROR_INVALID_ARG;
+    uint32_t hash = 0x811c9dc5;
+    for (int i = 0; key[i]; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
 
-    const uint32_t hash = ngli_crc32(key);
-    int id = hash & hm->mask;
-    struct bucket *b = &hm->buckets[id];
+static uint32_t get_distance(const struct hmap *hm, int pos, uint32_t hash)
+{
+    return (pos - (hash & hm->mask)) & hm->mask;
+}
 
-    /* Delete */
-    if (!data) {
-        for (int i = 0; i < b->nb_entries; i++) {
-            struct hmap_entry *e = &b->entries[i];
-            if (!strcmp(e->key, key)) {
-                ngli_free(e->key);
-                if (hm->user_free_func)
-                    hm->user_free_func(hm->user_arg, e->data);
-                hm->count--;
-                b->nb_entries--;
-                if (!b->nb_entries) {
-                    ngli_free(b->entries);
-                } else {
-                    memmove(e, e + 1, (b->nb_entries - i) * sizeof(*b->entries));
-                    struct hmap_entry *entries =
-                        ngli_realloc(b->entries, b->nb_entries * sizeof(*b->entries));
-                    if (!entries)
-                        return 0; // unable to realloc but entry got dropped, so this is OK
-                    b->entries = entries;
-                }
-                return 1;
-            }
+static int find_slot(const struct hmap *hm, const char *key, uint32_t hash)
+{
+    int pos = hash & hm->mask;
+    for (uint32_t dist = 0;; dist++) {
+        const struct slot *slot = &hm->slots[pos];
+        if (slot->entry_id < 0 || get_distance(hm, pos, slot->hash) < dist)
+            return -1;
+        if (slot->hash == hash && !strcmp(hm->entries[slot->entry_id].key, key))
+            return pos;
+        pos = (pos + 1) & hm->mask;
+    }
+}
+
+static void insert_slot(struct hmap *hm, uint32_t hash, int entry_id)
+{
+    struct slot cur = {.hash = hash, .entry_id = entry_id};
+    int pos = hash & hm->mask;
+    for (uint32_t dist = 0;; dist++) {
+        struct slot *slot = &hm->slots[pos];
+        if (slot->entry_id < 0) {
+            *slot = cur;
+            return;
         }
-        return 0;
+        const uint32_t slot_dist = get_distance(hm, pos, slot->hash);
+        if (slot_dist < dist) {
+            const struct slot tmp = *slot;
+            *slot = cur;
+            cur = tmp;
+            dist = slot_dist;
+        }
+        pos = (pos + 1) & hm->mask;
     }
+}
 
-    /* Replace */
-    for (int i = 0; i < b->nb_entries; i++) {
-        struct hmap_entry *e = &b->entries[i];
-        if (!strcmp(e->key, key)) {
-            if (hm->user_free_func)
-                hm->user_free_func(hm->user_arg, e->data);
-            e->data = data;
-            return 0;
+/* Backward shift deletion, which keeps the probe sequences intact */
+static void remove_slot(struct hmap *hm, int pos)
+{
+    for (;;) {
+        const int next = (pos + 1) & hm->mask;
+        const struct slot *next_slot = &hm->slots[next];
+        if (next_slot->entry_id < 0 || !get_distance(hm, next, next_slot->hash)) {
+            hm->slots[pos].entry_id = -1;
+            return;
         }
+        hm->slots[pos] = *next_slot;
+        pos = next;
     }
+}
 
-    /* Resize check before addition  */
-    if (hm->count * 3 / 4 >= hm->size) {
-        struct hmap old_hm = *hm;
+static int rebuild(struct hmap *hm, int size)
+{
+    struct slot *slots = alloc_slots(size);
+    if (!slots)
+        return NGL_ERROR_MEMORY;
+    ngli_free(hm->slots);
+    hm->slots = slots;
+    hm->size = size;
+    hm->mask = size - 1;
+
+    int nb_entries = 0;
+    for (int i = 0; i < hm->nb_entries; i++) {
+        const struct hmap_entry *e = &hm->entries[i];
+        if (!e->key)
+            continue;
+        hm->entries[nb_entries] = *e;
+        insert_slot(hm, e->hash, nb_entries);
+        nb_entries++;
+    }
+    hm->nb_entries = nb_entries;
+    return 0;
+}
 
+static int reserve_entry(struct hmap *hm)
+{
+    /* Keep the load factor of the index below 3/4 */
+    if ((hm->count + 1) * 4 > hm->size * 3) {
         if (hm->size >= 1 << (sizeof(hm->size)*8 - 2))
             return NGL_ERROR_LIMIT_EXCEEDED;
+        int ret = rebuild(hm, hm->size << 1);
+        if (ret < 0)
+            return ret;
+    }
 
-        struct bucket *new_buckets = ngli_calloc(hm->size << 1, sizeof(*new_buckets));
-        if (new_buckets) {
-            hm->buckets = new_buckets;
-            hm->count = 0;
-            hm->size <<= 1;
-            hm->mask = hm->size - 1;
-
-            if (old_hm.count) {
-                /* Transfer all entries to the new map */
-                const struct hmap_entry *e = NULL;
-                while ((e = ngli_hmap_next(&old_hm, e))) {
-                    const int new_id = ngli_crc32(e->key) & hm->mask;
-                    struct bucket *b = &hm->buckets[new_id];
-                    struct hmap_entry *entries =
-                        ngli_realloc(b->entries, (b->nb_entries + 1) * sizeof(*b->entries));
-                    if (!entries) {
-                        /* Unable to allocate more, ngli_free the incomplete buckets
-                         * and restore the previous hashmap state */
-                        for (int j = 0; j < hm->size; j++)
-                            ngli_free(hm->buckets[j].entries);
-                        ngli_free(hm->buckets);
-                        *hm = old_hm;
-                        return NGL_ERROR_MEMORY;
-                    }
-                    b->entries = entries;
-                    struct hmap_entry *new_e = &entries[b->nb_entries++];
-                    new_e->key = e->key;
-                    new_e->data = e->data;
-                    new_e->bucket_id = new_id;
-                    hm->count++;
-                }
-
-                /* Destroy previous indexes in the old buckets */
-                for (int j = 0; j < old_hm.size; j++) {
-                    struct bucket *b = &old_hm.buckets[j];
-                    ngli_free(b->entries);
-                    old_hm.count -= b->nb_entries;
-                    if (old_hm.count == 0)
-                        break;
-                }
-            }
-
-            ngli_free(old_hm.buckets);
-
-            /* Fix the bucket position for the entry to add */
-            id = hash & hm->mask;
-            b = &hm->buckets[id];
-        }
+    if (hm->nb_entries < hm->entries_capacity)
+        return 0;
+
+    /* Reclaim the holes left by the removed entries before growing */
+    if (hm->count < hm->nb_entries)
+        return rebuild(hm, hm->size);
+
+    const int capacity = hm->entries_capacity ? hm->entries_capacity * 2 : hm->size;
+    struct hmap_entry *entries = ngli_realloc(hm->entries, capacity * sizeof(*entries));
+    if (!entries)
+        return NGL_ERROR_MEMORY;
+    hm->entries = entries;
+    hm->entries_capacity = capacity;
+    return 0;
+}
+
+int ngli_hmap_set(struct hmap *hm, const char *key, void *data)
+{
+    if (!key)
+        return NGL_ERROR_INVALID_ARG;
+
+    const uint32_t hash = ngli_hmap_hash(key);
+    const int pos = find_slot(hm, key, hash);
+
+    /* Delete */
+    if (!data) {
+        if (pos < 0)
+            return 0;
+        struct hmap_entry *e = &hm->entries[hm->slots[pos].entry_id];
+        remove_slot(hm, pos);
+        ngli_free(e->key);
+        if (hm->user_free_func)
+            hm->user_free_func(hm->user_arg, e->data);
+        e->key = NULL;
+        e->data = NULL;
+        hm->count--;
+        return 1;
+    }
+
+    /* Replace */
+    if (pos >= 0) {
+        struct hmap_entry *e = &hm->entries[hm->slots[pos].entry_id];
+        if (hm->user_free_func)
+            hm->user_free_func(hm->user_arg, e->data);
+        e->data = data;
+        return 0;
     }
 
     /* Add */
     char *new_key = ngli_strdup(key);
     if (!new_key)
         return NGL_ERROR_MEMORY;
-    struct hmap_entry *entries =
-        ngli_realloc(b->entries, (b->nb_entries + 1) * sizeof(*b->entries));
-    if (!entries) {
+    int ret = reserve_entry(hm);
+    if (ret < 0) {
         ngli_free(new_key);
-        return NGL_ERROR_MEMORY;
+        return ret;
     }
-    b->entries = entries;
-    struct hmap_entry *e = &entries[b->nb_entries++];
+    const int entry_id = hm->nb_entries++;
+    struct hmap_entry *e = &hm->entries[entry_id];
     e->key = new_key;
     e->data = data;
-    e->bucket_id = id;
+    e->hash = hash;
+    insert_slot(hm, hash, entry_id);
     hm->count++;
 
     return 0;
 }
 
 static const struct hmap_entry *get_first_entry(const struct hmap *hm,
-                                                int bucket_start)
+                                                int entry_start)
 {
-    for (int i = bucket_start; i < hm->size; i++) {
-        const struct bucket *b = &hm->buckets[i];
-        if (b->nb_entries)
-            return &b->entries[0];
+    for (int i = entry_start; i < hm->nb_entries; i++) {
+        const struct hmap_entry *e = &hm->entries[i];
+        if (e->key)
+            return e;
     }
     return NULL;
 }
@@ -207,34 +275,18 @@ const struct hmap_entry *ngli_hmap_next(const struct hmap *hm,
 {
     if (!hm->count)
         return NULL;
+    return get_first_entry(hm, prev ? prev - hm->entries + 1 : 0);
+}
 
-    if (!prev)
-        return get_first_entry(hm, 0);
-
-    const int id = prev->bucket_id;
-    const struct bucket *b = &hm->buckets[id];
-    const int entry_id = prev - b->entries;
-
-    if (entry_id < b->nb_entries - 1)
-        return &b->entries[entry_id + 1];
-
-    if (id < hm->size - 1)
-        return get_first_entry(hm, id + 1);
-
-    return NULL;
+void *ngli_hmap_get_h(const struct hmap *hm, const char *key, uint32_t hash)
+{
+    const int pos = find_slot(hm, key, hash);
+    return pos < 0 ? NULL : hm->entries[hm->slots[pos].entry_id].data;
 }
 
 void *ngli_hmap_get(const struct hmap *hm, const char *key)
 {
-    const int id = ngli_crc32(key) & hm->mask;
-    const struct bucket *b = &hm->buckets[id];
-
-    for (int i = 0; i < b->nb_entries; i++) {
-        struct hmap_entry *e = &b->entries[i];
-        if (!strcmp(e->key, key))
-            return e->data;
-    }
-    return NULL;
+    return ngli_hmap_get_h(hm, key, ngli_hmap_hash(key));
 }
 
 void ngli_hmap_freep(struct hmap **hmp)
@@ -244,23 +296,17 @@ void ngli_hmap_freep(struct hmap **hmp)
     if (!hm)
         return;
 
-    if (hm->count) {
-        for (int j = 0; j < hm->size; j++) {
-            struct bucket *b = &hm->buckets[j];
-            for (int i = 0; i < b->nb_entries; i++) {
-                struct hmap_entry *e = &b->entries[i];
-                ngli_free(e->key);
-                if (hm->user_free_func)
-                    hm->user_free_func(hm->user_arg, e->data);
-            }
-            ngli_free(b->entries);
-            hm->count -= b->nb_entries;
-            if (hm->count == 0)
-                break;
-        }
+    for (int i = 0; i < hm->nb_entries; i++) {
+        struct hmap_entry *e = &hm->entries[i];
+        if (!e->key)
+            continue;
+        ngli_free(e->key);
+        if (hm->user_free_func)
+            hm->user_free_func(hm->user_arg, e->data);
     }
 
-    ngli_free(hm->buckets);
+    ngli_free(hm->entries);
+    ngli_free(hm->slots);
     ngli_free(hm);
     *hmp = NULL;
 }
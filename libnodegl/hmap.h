@@ -22,6 +22,8 @@
 #ifndef HMAP_H
 #define HMAP_H
 
+#include <stdint.h>
+
 #ifndef HMAP_SIZE_NBIT
 #define HMAP_SIZE_NBIT 3
 #endif
@@ -31,7 +33,7 @@ struct hmap;
 struct hmap_entry {
     char *key;
     void *data;
-    int bucket_id;
+    uint32_t hash;
 };
 
 typedef void (*user_free_func_type)(void *user_arg, void *data);
@@ -41,6 +43,19 @@ void ngli_hmap_set_free(struct hmap *hm, user_free_func_type user_free_func, voi
 int ngli_hmap_count(const struct hmap *hm);
 int ngli_hmap_set(struct hmap *hm, const char *key, void *data);
 void *ngli_hmap_get(const struct hmap *hm, const char *key);
+
+/*
+ * Hash of a key, to be passed to ngli_hmap_get_h() when the same key is
+ * looked up repeatedly or in several maps. The entries returned by
+ * ngli_hmap_next() also carry the hash of their key.
+ */
+uint32_t ngli_hmap_hash(const char *key);
+void *ngli_hmap_get_h(const struct hmap *hm, const char *key, uint32_t hash);
+
+/*
+ * Iterate over the entries in insertion order. The map must not be modified
+ * during the iteration.
+ */
 const struct hmap_entry *ngli_hmap_next(const struct hmap *hm,
                                         const struct hmap_entry *prev);
 void ngli_hmap_freep(struct hmap **hmp);
@@ -248,7 +248,8 @@ int ngli_hwconv_convert(struct hwconv *hwconv, struct texture *planes, const flo
     const int vp[4] = {0, 0, rt->width, rt->height};
     ngli_gctx_set_viewport(ctx, vp);
 
-    ngli_gctx_clear_color(ctx);
+    /* The conversion overwrites the whole target */
+    ngli_gctx_load_attachments(ctx, NGLI_LOAD_OP_DONT_CARE, NGLI_LOAD_OP_DONT_CARE);
 
     const struct hwconv_desc *desc = &hwconv_descs[hwconv->src_layout];
     float dimensions[4] = {0};
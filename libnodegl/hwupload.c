@@ -24,6 +24,7 @@
 #include <string.h>
 #include <sxplayer.h>
 
+#include "format.h"
 #include "glincludes.h"
 #include "hwupload.h"
 #include "log.h"
@@ -31,6 +32,7 @@
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "uploader.h"
 
 extern const struct hwupload_class ngli_hwupload_common_class;
 extern const struct hwupload_class ngli_hwupload_mc_class;
@@ -41,6 +43,7 @@ extern const struct hwupload_class ngli_hwupload_vaapi_class;
 static const struct hwupload_class *hwupload_class_map[] = {
     [SXPLAYER_PIXFMT_RGBA]        = &ngli_hwupload_common_class,
     [SXPLAYER_PIXFMT_BGRA]        = &ngli_hwupload_common_class,
+    [SXPLAYER_PIXFMT_NV12]        = &ngli_hwupload_common_class,
     [SXPLAYER_SMPFMT_FLT]         = &ngli_hwupload_common_class,
 #if defined(TARGET_ANDROID)
     [SXPLAYER_PIXFMT_MEDIACODEC]  = &ngli_hwupload_mc_class,
@@ -64,18 +67,104 @@ static const struct hwmap_class *get_hwmap_class(struct ngl_node *node, struct s
     return cls->get_hwmap(node, frame);
 }
 
+static int upload_frame(struct glcontext *gl, void *arg)
+{
+    struct ngl_node *node = arg;
+    struct texture_priv *s = node->priv_data;
+    return s->hwupload_map_class->upload_frame(node, gl, s->hwupload_frame);
+}
+
+/* Called on the rendering thread once the frame is transferred, which
+ * may happen while binding the textures of a draw */
+static void complete_upload(void *arg, int ret)
+{
+    struct ngl_node *node = arg;
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct image *image = &s->image;
+
+    for (int i = 0; i < image->nb_planes; i++) {
+        struct texture *plane = image->planes[i];
+        plane->upload_job = NULL;
+        if (ret < 0)
+            continue;
+        const struct texture_params *params = &plane->params;
+        ctx->stats.uploaded_bytes += ngli_format_get_image_size(params->format, params->width, params->height);
+        /* Regenerated once the texture is bound, see ngli_texture_update_mipmap() */
+        ngli_texture_invalidate_mipmap(plane);
+    }
+
+    ngli_node_media_release_frame(s->data_src, s->hwupload_frame);
+    s->hwupload_frame = NULL;
+}
+
+static void complete_async_upload(void *arg, int ret)
+{
+    struct ngl_node *node = arg;
+    if (ret < 0)
+        LOG(ERROR, "could not upload the media frame of texture '%s'", node->label);
+    complete_upload(node, ret);
+}
+
+/* The frame being uploaded must land before its textures are touched again */
+static void sync_upload(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    if (s->hwupload_frame)
+        ngli_uploader_sync(ctx->uploader, &s->hwupload_job);
+}
+
+/*
+ * The frame is handed over to the upload thread if any, the textures then
+ * waiting for the transfer when they are first used (see ngli_texture_sync()).
+ * The textures of a frame cache are taken over right after the upload, so
+ * they are always uploaded synchronously.
+ */
+static int transfer_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    const struct media_priv *media = s->data_src->priv_data;
+
+    s->hwupload_frame = frame;
+
+    if (!ctx->uploader || media->frame_cache) {
+        const int ret = upload_frame(ctx->glcontext, node);
+        complete_upload(node, ret);
+        return ret;
+    }
+
+    s->hwupload_job = (struct uploader_job){
+        .func     = upload_frame,
+        .complete = complete_async_upload,
+        .arg      = node,
+    };
+    struct image *image = &s->image;
+    for (int i = 0; i < image->nb_planes; i++)
+        image->planes[i]->upload_job = &s->hwupload_job;
+    ngli_uploader_submit(ctx->uploader, &s->hwupload_job);
+    return 0;
+}
+
 int ngli_hwupload_upload_frame(struct ngl_node *node)
 {
     struct texture_priv *s = node->priv_data;
     struct media_priv *media = s->data_src->priv_data;
     struct sxplayer_frame *frame = media->frame;
-    if (!frame)
+    if (!frame) {
+        const struct hwmap_class *hwmap_class = s->hwupload_map_class;
+        if (hwmap_class && hwmap_class->sync_frame)
+            return hwmap_class->sync_frame(node);
         return 0;
+    }
     media->frame = NULL;
 
+    sync_upload(node);
+
     const struct hwmap_class *hwmap_class = get_hwmap_class(node, frame);
     if (!hwmap_class) {
-        sxplayer_release_frame(frame);
+        ngli_node_media_release_frame(s->data_src, frame);
         return NGL_ERROR_UNSUPPORTED;
     }
 
@@ -85,14 +174,14 @@ int ngli_hwupload_upload_frame(struct ngl_node *node)
         if (hwmap_class->priv_size) {
             s->hwupload_priv_data = ngli_calloc(1, hwmap_class->priv_size);
             if (!s->hwupload_priv_data) {
-                sxplayer_release_frame(frame);
+                ngli_node_media_release_frame(s->data_src, frame);
                 return NGL_ERROR_MEMORY;
             }
         }
 
         int ret = hwmap_class->init(node, frame);
         if (ret < 0) {
-            sxplayer_release_frame(frame);
+            ngli_node_media_release_frame(s->data_src, frame);
             return ret;
         }
         s->hwupload_map_class = hwmap_class;
@@ -103,19 +192,24 @@ int ngli_hwupload_upload_frame(struct ngl_node *node)
     int ret = hwmap_class->map_frame(node, frame);
     s->image.ts = frame->ts;
 
+    if (ret >= 0 && hwmap_class->upload_frame)
+        return transfer_frame(node, frame);
+
     if (!(hwmap_class->flags &  HWMAP_FLAG_FRAME_OWNER))
-        sxplayer_release_frame(frame);
+        ngli_node_media_release_frame(s->data_src, frame);
     return ret;
 }
 
 void ngli_hwupload_uninit(struct ngl_node *node)
 {
     struct texture_priv *s = node->priv_data;
+    sync_upload(node);
     if (s->hwupload_map_class && s->hwupload_map_class->uninit) {
         s->hwupload_map_class->uninit(node);
     }
     ngli_free(s->hwupload_priv_data);
     s->hwupload_priv_data = NULL;
     s->hwupload_map_class = NULL;
+    s->hwupload_pending_width = s->hwupload_pending_height = 0;
     ngli_image_reset(&s->image);
 }
@@ -25,9 +25,11 @@
 #include <stdlib.h>
 #include <sxplayer.h>
 
+#include "glcontext.h"
 #include "nodegl.h"
 
 #define HWMAP_FLAG_FRAME_OWNER (1 << 0)
+#define HWMAP_FLAG_CACHEABLE   (1 << 1) /* the frame is only uploaded into the node texture, which can be taken over */
 
 struct hwmap_class {
     const char *name;
@@ -35,6 +37,10 @@ struct hwmap_class {
     size_t priv_size;
     int (*init)(struct ngl_node *node, struct sxplayer_frame *frame);
     int (*map_frame)(struct ngl_node *node, struct sxplayer_frame *frame);
+    /* transfer of the frame mapped into the image planes, possibly issued
+     * from the upload thread context (see ngl_config.upload_thread) */
+    int (*upload_frame)(struct ngl_node *node, struct glcontext *gl, struct sxplayer_frame *frame);
+    int (*sync_frame)(struct ngl_node *node); /* complete a deferred mapping, called when there is no new frame */
     void (*uninit)(struct ngl_node *node);
 };
 
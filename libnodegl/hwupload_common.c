@@ -25,12 +25,15 @@
 #include <sxplayer.h>
 
 #include "android_surface.h"
+#include "audiofft.h"
 #include "format.h"
 #include "glincludes.h"
+#include "hwconv.h"
 #include "hwupload.h"
 #include "image.h"
 #include "log.h"
 #include "math_utils.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 
@@ -83,18 +86,394 @@ static int common_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
             return ret;
     }
 
+    return 0;
+}
+
+static int common_upload_frame(struct ngl_node *node, struct glcontext *gl, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+
     const int linesize = frame->linesize >> 2;
-    return ngli_texture_upload(texture, frame->data, linesize);
+    return ngli_texture_upload_shared(&s->texture, gl, frame->data, linesize);
 }
 
 static const struct hwmap_class hwmap_common_class = {
-    .name      = "default",
-    .init      = common_init,
-    .map_frame = common_map_frame,
+    .name         = "default",
+    .flags        = HWMAP_FLAG_CACHEABLE,
+    .init         = common_init,
+    .map_frame    = common_map_frame,
+    .upload_frame = common_upload_frame,
+};
+
+#define NB_PBOS 3
+
+struct hwupload_pbo {
+    GLuint pbos[NB_PBOS];
+    int sizes[NB_PBOS];
+    int index;
+};
+
+static int pbo_init(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_pbo *pbo = s->hwupload_priv_data;
+
+    int ret = common_init(node, frame);
+    if (ret < 0)
+        return ret;
+
+    ngli_glGenBuffers(gl, NB_PBOS, pbo->pbos);
+    return 0;
+}
+
+/*
+ * The frame is copied into one of the pixel unpack buffers and released
+ * right away, the actual texture transfer being performed by the driver
+ * without blocking. The buffers are used in turn and orphaned before being
+ * mapped so the copy never waits for a previous transfer to complete.
+ */
+static int pbo_upload_frame(struct ngl_node *node, struct glcontext *gl, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_pbo *pbo = s->hwupload_priv_data;
+
+    const int size = frame->linesize * frame->height;
+    const GLuint id = pbo->pbos[pbo->index];
+
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, id);
+    if (pbo->sizes[pbo->index] != size) {
+        ngli_glBufferData(gl, GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        pbo->sizes[pbo->index] = size;
+    }
+
+    void *data = ngli_glMapBufferRange(gl, GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!data) {
+        ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+        LOG(ERROR, "could not map pixel unpack buffer");
+        return NGL_ERROR_EXTERNAL;
+    }
+    memcpy(data, frame->data, size);
+    ngli_glUnmapBuffer(gl, GL_PIXEL_UNPACK_BUFFER);
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+
+    pbo->index = (pbo->index + 1) % NB_PBOS;
+
+    const int linesize = frame->linesize >> 2;
+    return ngli_texture_upload_from_buffer_shared(&s->texture, gl, id, 0, linesize);
+}
+
+static void pbo_uninit(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_pbo *pbo = s->hwupload_priv_data;
+
+    ngli_glDeleteBuffers(gl, NB_PBOS, pbo->pbos);
+    ngli_texture_reset(&s->texture);
+}
+
+static const struct hwmap_class hwmap_pbo_class = {
+    .name         = "pixel buffer object",
+    .flags        = HWMAP_FLAG_CACHEABLE,
+    .priv_size    = sizeof(struct hwupload_pbo),
+    .init         = pbo_init,
+    .map_frame    = common_map_frame,
+    .upload_frame = pbo_upload_frame,
+    .uninit       = pbo_uninit,
+};
+
+/*
+ * Software decoded NV12 frames are uploaded as is, the luma plane in a R8
+ * texture and the interleaved chroma plane in a half sized R8G8 texture,
+ * leaving the colorspace conversion to the GPU.
+ */
+struct hwupload_nv12 {
+    struct texture planes[2];
+    struct hwconv hwconv;
+};
+
+static int nv12_init_planes(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    for (int i = 0; i < 2; i++) {
+        struct texture_params params = s->params;
+        params.format = i ? NGLI_FORMAT_R8G8_UNORM : NGLI_FORMAT_R8_UNORM;
+        params.width  = i ? (frame->width  + 1) >> 1 : frame->width;
+        params.height = i ? (frame->height + 1) >> 1 : frame->height;
+        params.mipmap_filter = NGLI_MIPMAP_FILTER_NONE;
+
+        int ret = ngli_texture_init(&nv12->planes[i], ctx, &params);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int nv12_map_planes(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    if (!ngli_texture_match_dimensions(&nv12->planes[0], frame->width, frame->height, 0)) {
+        for (int i = 0; i < 2; i++)
+            ngli_texture_reset(&nv12->planes[i]);
+
+        int ret = nv12_init_planes(node, frame);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int nv12_upload_planes(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    int ret = nv12_map_planes(node, frame);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < 2; i++) {
+        const int linesize = i ? frame->linesizep[i] >> 1 : frame->linesizep[i];
+        int ret = ngli_texture_upload(&nv12->planes[i], frame->datap[i], linesize);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int nv12_init_conversion(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    struct texture_params params = s->params;
+    params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    params.width  = frame->width;
+    params.height = frame->height;
+
+    int ret = ngli_texture_init(&s->texture, ctx, &params);
+    if (ret < 0)
+        return ret;
+
+    return ngli_hwconv_init(&nv12->hwconv, ctx, &s->texture, NGLI_IMAGE_LAYOUT_NV12);
+}
+
+static int nv12_init(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+
+    int ret = nv12_init_planes(node, frame);
+    if (ret < 0)
+        return ret;
+
+    ret = nv12_init_conversion(node, frame);
+    if (ret < 0)
+        return ret;
+
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+
+    return 0;
+}
+
+static int nv12_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    int ret = nv12_upload_planes(node, frame);
+    if (ret < 0)
+        return ret;
+
+    if (!ngli_texture_match_dimensions(&s->texture, frame->width, frame->height, 0)) {
+        ngli_hwconv_reset(&nv12->hwconv);
+        ngli_texture_reset(&s->texture);
+
+        ret = nv12_init_conversion(node, frame);
+        if (ret < 0)
+            return ret;
+    }
+
+    ret = ngli_hwconv_convert(&nv12->hwconv, nv12->planes, NULL);
+    if (ret < 0)
+        return ret;
+
+    if (ngli_texture_has_mipmap(&s->texture))
+        ngli_texture_generate_mipmap(&s->texture);
+
+    return 0;
+}
+
+static void nv12_uninit(struct ngl_node *node)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    ngli_hwconv_reset(&nv12->hwconv);
+    for (int i = 0; i < 2; i++)
+        ngli_texture_reset(&nv12->planes[i]);
+    ngli_texture_reset(&s->texture);
+}
+
+static int nv12_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    return nv12_init_planes(node, frame);
+}
+
+static int nv12_dr_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    int ret = nv12_map_planes(node, frame);
+    if (ret < 0)
+        return ret;
+
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_NV12, &nv12->planes[0], &nv12->planes[1]);
+
+    return 0;
+}
+
+static int nv12_dr_upload_frame(struct ngl_node *node, struct glcontext *gl, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_nv12 *nv12 = s->hwupload_priv_data;
+
+    for (int i = 0; i < 2; i++) {
+        const int linesize = i ? frame->linesizep[i] >> 1 : frame->linesizep[i];
+        int ret = ngli_texture_upload_shared(&nv12->planes[i], gl, frame->datap[i], linesize);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static const struct hwmap_class hwmap_nv12_class = {
+    .name      = "nv12 (planes → rgba)",
+    .priv_size = sizeof(struct hwupload_nv12),
+    .init      = nv12_init,
+    .map_frame = nv12_map_frame,
+    .uninit    = nv12_uninit,
+};
+
+static const struct hwmap_class hwmap_nv12_dr_class = {
+    .name         = "nv12 (planes)",
+    .priv_size    = sizeof(struct hwupload_nv12),
+    .init         = nv12_dr_init,
+    .map_frame    = nv12_dr_map_frame,
+    .upload_frame = nv12_dr_upload_frame,
+    .uninit       = nv12_uninit,
+};
+
+struct hwupload_audiofft {
+    float *window;
+    int window_size;
+    struct audiofft audiofft;
+};
+
+static int audiofft_init(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_audiofft *fft = s->hwupload_priv_data;
+    const struct media_priv *media = s->data_src->priv_data;
+
+    struct texture_params params = s->params;
+    params.format = NGLI_FORMAT_R32_SFLOAT;
+    params.width  = media->audio_nb_bins;
+    params.height = 4;
+    params.mipmap_filter = NGLI_MIPMAP_FILTER_NONE;
+    params.access = NGLI_ACCESS_READ_WRITE;
+
+    int ret = ngli_texture_init(&s->texture, ctx, &params);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_audiofft_init(&fft->audiofft, ctx, &s->texture, media->audio_nb_bins, media->audio_smoothing);
+    if (ret < 0)
+        return ret;
+
+    /* Interleaved stereo samples of the window, the most recent ones last */
+    fft->window_size = media->audio_nb_bins * 2;
+    fft->window = ngli_calloc(fft->window_size * 2, sizeof(*fft->window));
+    if (!fft->window)
+        return NGL_ERROR_MEMORY;
+
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+
+    return 0;
+}
+
+static int audiofft_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_audiofft *fft = s->hwupload_priv_data;
+
+    /* The raw audio frames hold frame->width interleaved stereo samples */
+    const float *samples = (const float *)frame->data;
+    const int nb_samples = NGLI_MIN(frame->width, fft->window_size);
+    const int nb_kept = fft->window_size - nb_samples;
+    memmove(fft->window, fft->window + nb_samples * 2, nb_kept * 2 * sizeof(*fft->window));
+    memcpy(fft->window + nb_kept * 2, samples + (frame->width - nb_samples) * 2,
+           nb_samples * 2 * sizeof(*fft->window));
+
+    return ngli_audiofft_compute(&fft->audiofft, fft->window);
+}
+
+static void audiofft_uninit(struct ngl_node *node)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_audiofft *fft = s->hwupload_priv_data;
+
+    ngli_audiofft_reset(&fft->audiofft);
+    ngli_free(fft->window);
+    fft->window = NULL;
+    ngli_texture_reset(&s->texture);
+}
+
+static const struct hwmap_class hwmap_audiofft_class = {
+    .name      = "audio (pcm window → gpu spectrum)",
+    .priv_size = sizeof(struct hwupload_audiofft),
+    .init      = audiofft_init,
+    .map_frame = audiofft_map_frame,
+    .uninit    = audiofft_uninit,
 };
 
 static const struct hwmap_class *common_get_hwmap(struct ngl_node *node, struct sxplayer_frame *frame)
 {
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    if (frame->pix_fmt == SXPLAYER_PIXFMT_NV12) {
+        struct texture_priv *s = node->priv_data;
+        const int direct_rendering = (s->supported_image_layouts & (1 << NGLI_IMAGE_LAYOUT_NV12)) &&
+                                     !s->params.mipmap_filter;
+        return direct_rendering ? &hwmap_nv12_dr_class : &hwmap_nv12_class;
+    }
+
+    if (frame->pix_fmt == SXPLAYER_SMPFMT_FLT) {
+        const struct texture_priv *s = node->priv_data;
+        const struct media_priv *media = s->data_src->priv_data;
+        if (media->audio_fft)
+            return &hwmap_audiofft_class;
+    }
+
+    /* Audio frames are tiny, only the video frames benefit from the buffers */
+    if (frame->pix_fmt != SXPLAYER_SMPFMT_FLT && (gl->features & NGLI_FEATURE_MAP_BUFFER_RANGE))
+        return &hwmap_pbo_class;
     return &hwmap_common_class;
 }
 
@@ -41,6 +41,55 @@ struct hwupload_mc {
     struct texture planes;
 };
 
+/*
+ * Release the codec buffer to the surface; the frame is then latched by
+ * mc_common_acquire_frame(), which in asynchronous mode returns 0 as long as
+ * it has not reached the SurfaceTexture.
+ */
+static int mc_common_render_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct media_priv *media = s->data_src->priv_data;
+    AVMediaCodecBuffer *buffer = (AVMediaCodecBuffer *)frame->data;
+
+    int ret = media->android_imagereader
+            ? ngli_android_imagereader_release_buffer(media->android_imagereader, buffer)
+            : ngli_android_surface_release_buffer(media->android_surface, buffer);
+    if (ret < 0)
+        return ret;
+
+    s->hwupload_pending_width = frame->width;
+    s->hwupload_pending_height = frame->height;
+    return 0;
+}
+
+static int mc_common_acquire_frame(struct ngl_node *node, float *matrix)
+{
+    struct texture_priv *s = node->priv_data;
+    struct media_priv *media = s->data_src->priv_data;
+
+    NGLI_ALIGNED_MAT(flip_matrix) = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f,-1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 1.0f,
+    };
+
+    const int wait = !media->async_surface;
+    int ret = media->android_imagereader
+            ? ngli_android_imagereader_acquire_frame(media->android_imagereader, matrix, wait)
+            : ngli_android_surface_acquire_frame(media->android_surface, matrix, wait);
+    if (ret <= 0)
+        return ret;
+    ngli_mat4_mul(matrix, matrix, flip_matrix);
+
+    ngli_texture_set_dimensions(&media->android_texture,
+                                s->hwupload_pending_width, s->hwupload_pending_height, 0);
+    s->hwupload_pending_width = s->hwupload_pending_height = 0;
+
+    return 1;
+}
+
 static int mc_init(struct ngl_node *node, struct sxplayer_frame *frame)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -74,41 +123,26 @@ static void mc_uninit(struct ngl_node *node)
     ngli_texture_reset(&s->texture);
 }
 
-static int mc_common_render_frame(struct ngl_node *node, struct sxplayer_frame *frame, float *matrix)
-{
-    struct texture_priv *s = node->priv_data;
-    struct media_priv *media = s->data_src->priv_data;
-    AVMediaCodecBuffer *buffer = (AVMediaCodecBuffer *)frame->data;
-
-    NGLI_ALIGNED_MAT(flip_matrix) = {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f,-1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 1.0f,
-    };
-
-    ngli_android_surface_render_buffer(media->android_surface, buffer, matrix);
-    ngli_mat4_mul(matrix, matrix, flip_matrix);
-
-    ngli_texture_set_dimensions(&media->android_texture, frame->width, frame->height, 0);
-
-    return 0;
-}
-
-static int mc_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+static int mc_sync_frame(struct ngl_node *node)
 {
     struct texture_priv *s = node->priv_data;
     struct hwupload_mc *mc = s->hwupload_priv_data;
     struct media_priv *media = s->data_src->priv_data;
 
+    if (!s->hwupload_pending_width)
+        return 0;
+
     NGLI_ALIGNED_MAT(matrix) = NGLI_MAT4_IDENTITY;
-    int ret = mc_common_render_frame(node, frame, matrix);
-    if (ret < 0)
+    const int width = s->hwupload_pending_width;
+    const int height = s->hwupload_pending_height;
+    int ret = mc_common_acquire_frame(node, matrix);
+    if (ret <= 0)
         return ret;
 
-    if (!ngli_texture_match_dimensions(&s->texture, frame->width, frame->height, 0)) {
+    if (!ngli_texture_match_dimensions(&s->texture, width, height, 0)) {
         mc_uninit(node);
-        ret = mc_init(node, frame);
+        struct sxplayer_frame frame = {.width = width, .height = height};
+        ret = mc_init(node, &frame);
         if (ret < 0)
             return ret;
     }
@@ -123,6 +157,15 @@ static int mc_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
     return 0;
 }
 
+static int mc_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    int ret = mc_common_render_frame(node, frame);
+    if (ret < 0)
+        return ret;
+
+    return mc_sync_frame(node);
+}
+
 static int mc_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -136,26 +179,35 @@ static int mc_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
     const GLint min_filter = ngli_texture_get_gl_min_filter(params->min_filter, params->mipmap_filter);
     const GLint mag_filter = ngli_texture_get_gl_mag_filter(params->mag_filter);
 
-    ngli_glBindTexture(gl, target, id);
+    ngli_glstate_bind_texture(gl, target, id);
     ngli_glTexParameteri(gl, target, GL_TEXTURE_MIN_FILTER, min_filter);
     ngli_glTexParameteri(gl, target, GL_TEXTURE_MAG_FILTER, mag_filter);
-    ngli_glBindTexture(gl, target, 0);
+    ngli_glstate_bind_texture(gl, target, 0);
 
     ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_MEDIACODEC, &media->android_texture);
 
     return 0;
 }
 
-static int mc_dr_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+static int mc_dr_sync_frame(struct ngl_node *node)
 {
     struct texture_priv *s = node->priv_data;
     struct image *image = &s->image;
 
-    int ret = mc_common_render_frame(node, frame, image->coordinates_matrix);
+    if (!s->hwupload_pending_width)
+        return 0;
+
+    int ret = mc_common_acquire_frame(node, image->coordinates_matrix);
+    return ret < 0 ? ret : 0;
+}
+
+static int mc_dr_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    int ret = mc_common_render_frame(node, frame);
     if (ret < 0)
         return ret;
 
-    return 0;
+    return mc_dr_sync_frame(node);
 }
 
 static const struct hwmap_class hwmap_mc_class = {
@@ -163,6 +215,7 @@ static const struct hwmap_class hwmap_mc_class = {
     .priv_size = sizeof(struct hwupload_mc),
     .init      = mc_init,
     .map_frame = mc_map_frame,
+    .sync_frame = mc_sync_frame,
     .uninit    = mc_uninit,
 };
 
@@ -170,6 +223,7 @@ static const struct hwmap_class hwmap_mc_dr_class = {
     .name      = "mediacodec (oes zero-copy)",
     .init      = mc_dr_init,
     .map_frame = mc_dr_map_frame,
+    .sync_frame = mc_dr_sync_frame,
 };
 
 static const struct hwmap_class *mc_get_hwmap(struct ngl_node *node, struct sxplayer_frame *frame)
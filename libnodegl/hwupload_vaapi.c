@@ -17,23 +17,35 @@
 #include "nodes.h"
 #include "utils.h"
 
+/*
+ * The decoder cycles through a small pool of surfaces, so the exported
+ * surfaces are kept mapped instead of being exported again for every frame
+ */
+#define NB_CACHED_SURFACES 32
+
+struct vaapi_surface {
+    VASurfaceID id;
+    int width;
+    int height;
+    int64_t last_use;
+    VADRMPRIMESurfaceDescriptor descriptor;
+    EGLImageKHR egl_images[2];
+    struct texture planes[2];
+};
+
 struct hwupload_vaapi {
     struct sxplayer_frame *frame;
     struct hwconv hwconv;
-    struct texture planes[2];
-
-    EGLImageKHR egl_images[2];
-
-    VADRMPRIMESurfaceDescriptor surface_descriptor;
-    int surface_acquired;
+    struct vaapi_surface surfaces[NB_CACHED_SURFACES];
+    int nb_surfaces;
+    int64_t use_count;
+    struct vaapi_surface *surface;
 };
 
 static int vaapi_common_init(struct ngl_node *node, struct sxplayer_frame *frame)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct glcontext *gl = ctx->glcontext;
-    struct texture_priv *s = node->priv_data;
-    struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
 
     if (!(gl->features & (NGLI_FEATURE_OES_EGL_IMAGE |
                           NGLI_FEATURE_EGL_IMAGE_BASE_KHR |
@@ -42,110 +54,62 @@ static int vaapi_common_init(struct ngl_node *node, struct sxplayer_frame *frame
         return -1;
     }
 
-    for (int i = 0; i < 2; i++) {
-        const struct texture_params *params = &s->params;
-
-        int format = i == 0 ? NGLI_FORMAT_R8_UNORM : NGLI_FORMAT_R8G8_UNORM;
-
-        struct texture *plane = &vaapi->planes[i];
-        const struct texture_params plane_params = {
-            .dimensions = 2,
-            .format = format,
-            .min_filter = params->min_filter,
-            .mag_filter = params->mag_filter,
-            .mipmap_filter = NGLI_MIPMAP_FILTER_NONE,
-            .wrap_s = params->wrap_s,
-            .wrap_t = params->wrap_t,
-            .wrap_r = params->wrap_r,
-            .access = params->access,
-            .external_storage = 1,
-        };
-
-        int ret = ngli_texture_init(plane, ctx, &plane_params);
-        if (ret < 0)
-            return ret;
-    }
-
     return 0;
 }
 
-static void vaapi_common_uninit(struct ngl_node *node)
+static void surface_reset(struct glcontext *gl, struct vaapi_surface *surface)
 {
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
-    struct texture_priv *s = node->priv_data;
-    struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
-
-    for (int i = 0; i < 2; i++)
-        ngli_texture_reset(&vaapi->planes[i]);
-
-    if (vaapi->surface_acquired) {
-        for (int i = 0; i < 2; i++) {
-            if (vaapi->egl_images[i]) {
-                ngli_eglDestroyImageKHR(gl, vaapi->egl_images[i]);
-                vaapi->egl_images[i] = NULL;
-            }
-        }
-        for (int i = 0; i < vaapi->surface_descriptor.num_objects; i++) {
-            close(vaapi->surface_descriptor.objects[i].fd);
-        }
-        vaapi->surface_acquired = 0;
+    for (int i = 0; i < 2; i++) {
+        ngli_texture_reset(&surface->planes[i]);
+        if (surface->egl_images[i])
+            ngli_eglDestroyImageKHR(gl, surface->egl_images[i]);
     }
+    for (int i = 0; i < surface->descriptor.num_objects; i++)
+        close(surface->descriptor.objects[i].fd);
+    memset(surface, 0, sizeof(*surface));
+}
 
-    ngli_hwconv_reset(&vaapi->hwconv);
-    ngli_texture_reset(&s->texture);
-
-    sxplayer_release_frame(vaapi->frame);
-    vaapi->frame = NULL;
+static void surface_cache_reset(struct glcontext *gl, struct hwupload_vaapi *vaapi)
+{
+    for (int i = 0; i < vaapi->nb_surfaces; i++)
+        surface_reset(gl, &vaapi->surfaces[i]);
+    vaapi->nb_surfaces = 0;
+    vaapi->surface = NULL;
 }
 
-static int vaapi_common_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+static int surface_init(struct ngl_node *node, struct vaapi_surface *surface,
+                        struct sxplayer_frame *frame, VASurfaceID surface_id)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct glcontext *gl = ctx->glcontext;
     struct texture_priv *s = node->priv_data;
-    struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
-
-    sxplayer_release_frame(vaapi->frame);
-    vaapi->frame = frame;
 
-    if (vaapi->surface_acquired) {
-        for (int i = 0; i < 2; i++) {
-            if (vaapi->egl_images[i]) {
-                ngli_eglDestroyImageKHR(gl, vaapi->egl_images[i]);
-                vaapi->egl_images[i] = NULL;
-            }
-        }
-        for (int i = 0; i < vaapi->surface_descriptor.num_objects; i++) {
-            close(vaapi->surface_descriptor.objects[i].fd);
-        }
-        vaapi->surface_acquired = 0;
-    }
+    surface->id = surface_id;
+    surface->width = frame->width;
+    surface->height = frame->height;
 
-    VASurfaceID surface_id = (VASurfaceID)(intptr_t)frame->data;
     VAStatus status = vaExportSurfaceHandle(ctx->va_display,
                                             surface_id,
                                             VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
                                             VA_EXPORT_SURFACE_READ_ONLY |
                                             VA_EXPORT_SURFACE_SEPARATE_LAYERS,
-                                            &vaapi->surface_descriptor);
+                                            &surface->descriptor);
     if (status != VA_STATUS_SUCCESS) {
         LOG(ERROR, "failed to export vaapi surface handle: 0x%x", status);
         return -1;
     }
-    vaapi->surface_acquired = 1;
 
-    if (vaapi->surface_descriptor.fourcc != VA_FOURCC_NV12 &&
-        vaapi->surface_descriptor.fourcc != VA_FOURCC_P010 &&
-        vaapi->surface_descriptor.fourcc != VA_FOURCC_P016) {
-        LOG(ERROR, "unsupported vaapi surface format: 0x%x", vaapi->surface_descriptor.fourcc);
+    if (surface->descriptor.fourcc != VA_FOURCC_NV12 &&
+        surface->descriptor.fourcc != VA_FOURCC_P010 &&
+        surface->descriptor.fourcc != VA_FOURCC_P016) {
+        LOG(ERROR, "unsupported vaapi surface format: 0x%x", surface->descriptor.fourcc);
         return -1;
     }
 
-    int num_layers = vaapi->surface_descriptor.num_layers;
-    if (num_layers > NGLI_ARRAY_NB(vaapi->egl_images)) {
-        LOG(WARNING, "vaapi layer count (%d) exceeds plane count (%d)", num_layers, NGLI_ARRAY_NB(vaapi->egl_images));
-        num_layers = NGLI_ARRAY_NB(vaapi->egl_images);
+    int num_layers = surface->descriptor.num_layers;
+    if (num_layers > NGLI_ARRAY_NB(surface->egl_images)) {
+        LOG(WARNING, "vaapi layer count (%d) exceeds plane count (%d)", num_layers, NGLI_ARRAY_NB(surface->egl_images));
+        num_layers = NGLI_ARRAY_NB(surface->egl_images);
     }
 
     for (int i = 0; i < num_layers; i++) {
@@ -159,47 +123,137 @@ static int vaapi_common_map_frame(struct ngl_node *node, struct sxplayer_frame *
     attribs[nb_attribs] = EGL_NONE;                           \
 } while(0)
 
-#define ADD_PLANE_ATTRIBS(plane) do {                                                \
-    uint32_t object_index = vaapi->surface_descriptor.layers[i].object_index[plane]; \
-    ADD_ATTRIB(EGL_DMA_BUF_PLANE ## plane ## _FD_EXT,                                \
-               vaapi->surface_descriptor.objects[object_index].fd);                  \
-    ADD_ATTRIB(EGL_DMA_BUF_PLANE ## plane ## _OFFSET_EXT,                            \
-               vaapi->surface_descriptor.layers[i].offset[plane]);                   \
-    ADD_ATTRIB(EGL_DMA_BUF_PLANE ## plane ## _PITCH_EXT,                             \
-               vaapi->surface_descriptor.layers[i].pitch[plane]);                    \
+#define ADD_PLANE_ATTRIBS(plane) do {                                           \
+    uint32_t object_index = surface->descriptor.layers[i].object_index[plane];  \
+    ADD_ATTRIB(EGL_DMA_BUF_PLANE ## plane ## _FD_EXT,                           \
+               surface->descriptor.objects[object_index].fd);                   \
+    ADD_ATTRIB(EGL_DMA_BUF_PLANE ## plane ## _OFFSET_EXT,                       \
+               surface->descriptor.layers[i].offset[plane]);                    \
+    ADD_ATTRIB(EGL_DMA_BUF_PLANE ## plane ## _PITCH_EXT,                        \
+               surface->descriptor.layers[i].pitch[plane]);                     \
 } while (0)
 
         int width = i == 0 ? frame->width : (frame->width + 1) >> 1;
         int height = i == 0 ? frame->height : (frame->height + 1) >> 1;
 
-        ADD_ATTRIB(EGL_LINUX_DRM_FOURCC_EXT, vaapi->surface_descriptor.layers[i].drm_format);
+        ADD_ATTRIB(EGL_LINUX_DRM_FOURCC_EXT, surface->descriptor.layers[i].drm_format);
         ADD_ATTRIB(EGL_WIDTH,  width);
         ADD_ATTRIB(EGL_HEIGHT, height);
 
         ADD_PLANE_ATTRIBS(0);
-        if (vaapi->surface_descriptor.layers[i].num_planes > 1)
+        if (surface->descriptor.layers[i].num_planes > 1)
             ADD_PLANE_ATTRIBS(1);
-        if (vaapi->surface_descriptor.layers[i].num_planes > 2)
+        if (surface->descriptor.layers[i].num_planes > 2)
             ADD_PLANE_ATTRIBS(2);
-        if (vaapi->surface_descriptor.layers[i].num_planes > 3)
+        if (surface->descriptor.layers[i].num_planes > 3)
             ADD_PLANE_ATTRIBS(3);
 
-        vaapi->egl_images[i] = ngli_eglCreateImageKHR(gl,
-                                                      EGL_NO_CONTEXT,
-                                                      EGL_LINUX_DMA_BUF_EXT,
-                                                      NULL,
-                                                      attribs);
-        if (!vaapi->egl_images[i]) {
+        surface->egl_images[i] = ngli_eglCreateImageKHR(gl,
+                                                        EGL_NO_CONTEXT,
+                                                        EGL_LINUX_DMA_BUF_EXT,
+                                                        NULL,
+                                                        attribs);
+        if (!surface->egl_images[i]) {
             LOG(ERROR, "failed to create egl image");
             return -1;
         }
 
-        struct texture *plane = &vaapi->planes[i];
+        const struct texture_params *params = &s->params;
+        const struct texture_params plane_params = {
+            .dimensions = 2,
+            .format = i == 0 ? NGLI_FORMAT_R8_UNORM : NGLI_FORMAT_R8G8_UNORM,
+            .min_filter = params->min_filter,
+            .mag_filter = params->mag_filter,
+            .mipmap_filter = NGLI_MIPMAP_FILTER_NONE,
+            .wrap_s = params->wrap_s,
+            .wrap_t = params->wrap_t,
+            .wrap_r = params->wrap_r,
+            .access = params->access,
+            .external_storage = 1,
+        };
+
+        struct texture *plane = &surface->planes[i];
+        int ret = ngli_texture_init(plane, ctx, &plane_params);
+        if (ret < 0)
+            return ret;
         ngli_texture_set_dimensions(plane, width, height, 0);
 
-        ngli_glBindTexture(gl, plane->target, plane->id);
-        ngli_glEGLImageTargetTexture2DOES(gl, plane->target, vaapi->egl_images[i]);
+        ngli_glstate_bind_texture(gl, plane->target, plane->id);
+        ngli_glEGLImageTargetTexture2DOES(gl, plane->target, surface->egl_images[i]);
+    }
+
+    return 0;
+}
+
+static struct vaapi_surface *get_surface(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
+
+    const VASurfaceID surface_id = (VASurfaceID)(intptr_t)frame->data;
+    struct vaapi_surface *lru = NULL;
+    for (int i = 0; i < vaapi->nb_surfaces; i++) {
+        struct vaapi_surface *surface = &vaapi->surfaces[i];
+        if (surface->id == surface_id) {
+            /* A change of dimensions means the decoder allocated a new pool */
+            if (surface->width != frame->width || surface->height != frame->height) {
+                surface_cache_reset(gl, vaapi);
+                lru = NULL;
+                break;
+            }
+            surface->last_use = ++vaapi->use_count;
+            return surface;
+        }
+        if (!lru || surface->last_use < lru->last_use)
+            lru = surface;
+    }
+
+    struct vaapi_surface *surface = lru;
+    if (vaapi->nb_surfaces < NB_CACHED_SURFACES)
+        surface = &vaapi->surfaces[vaapi->nb_surfaces++];
+    else
+        surface_reset(gl, surface);
+
+    int ret = surface_init(node, surface, frame, surface_id);
+    if (ret < 0) {
+        surface_reset(gl, surface);
+        *surface = vaapi->surfaces[--vaapi->nb_surfaces];
+        memset(&vaapi->surfaces[vaapi->nb_surfaces], 0, sizeof(*surface));
+        return NULL;
     }
+    surface->last_use = ++vaapi->use_count;
+    return surface;
+}
+
+static void vaapi_common_uninit(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
+
+    surface_cache_reset(gl, vaapi);
+
+    ngli_hwconv_reset(&vaapi->hwconv);
+    ngli_texture_reset(&s->texture);
+
+    ngli_node_media_release_frame(s->data_src, vaapi->frame);
+    vaapi->frame = NULL;
+}
+
+static int vaapi_common_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
+
+    ngli_node_media_release_frame(s->data_src, vaapi->frame);
+    vaapi->frame = frame;
+
+    vaapi->surface = get_surface(node, frame);
+    if (!vaapi->surface)
+        return -1;
 
     return 0;
 }
@@ -261,7 +315,7 @@ static int vaapi_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
             return ret;
     }
 
-    ret = ngli_hwconv_convert(&vaapi->hwconv, vaapi->planes, NULL);
+    ret = ngli_hwconv_convert(&vaapi->hwconv, vaapi->surface->planes, NULL);
     if (ret < 0)
         return ret;
 
@@ -272,15 +326,22 @@ static int vaapi_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
 }
 
 static int vaapi_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    return vaapi_common_init(node, frame);
+}
+
+static int vaapi_dr_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
 {
     struct texture_priv *s = node->priv_data;
     struct hwupload_vaapi *vaapi = s->hwupload_priv_data;
 
-    int ret = vaapi_common_init(node, frame);
+    int ret = vaapi_common_map_frame(node, frame);
     if (ret < 0)
         return ret;
 
-    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_NV12, &vaapi->planes[0], &vaapi->planes[1]);
+    /* Each cached surface has its own plane textures */
+    struct texture *planes = vaapi->surface->planes;
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_NV12, &planes[0], &planes[1]);
 
     return 0;
 }
@@ -299,7 +360,7 @@ static const struct hwmap_class hwmap_vaapi_dr_class = {
     .flags     = HWMAP_FLAG_FRAME_OWNER,
     .priv_size = sizeof(struct hwupload_vaapi),
     .init      = vaapi_dr_init,
-    .map_frame = vaapi_common_map_frame,
+    .map_frame = vaapi_dr_map_frame,
     .uninit    = vaapi_common_uninit,
 };
 
@@ -37,10 +37,27 @@
 #include "nodegl.h"
 #include "nodes.h"
 
+/*
+ * The decoder recycles the IOSurfaces of its pool: each of them keeps its
+ * own plane textures bound instead of being bound again for every frame
+ */
+#define NB_CACHED_SURFACES 16
+
+struct vt_surface {
+    IOSurfaceRef surface;
+    int width;
+    int height;
+    int64_t last_use;
+    struct texture planes[2];
+};
+
 struct hwupload_vt_darwin {
     struct sxplayer_frame *frame;
     struct hwconv hwconv;
-    struct texture planes[2];
+    struct vt_surface surfaces[NB_CACHED_SURFACES];
+    int nb_surfaces;
+    int64_t use_count;
+    struct vt_surface *surface;
 };
 
 static int vt_get_data_format(struct sxplayer_frame *frame)
@@ -59,14 +76,109 @@ static int vt_get_data_format(struct sxplayer_frame *frame)
     }
 }
 
-static int vt_darwin_common_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+static void surface_reset(struct vt_surface *surface)
+{
+    for (int i = 0; i < 2; i++)
+        ngli_texture_reset(&surface->planes[i]);
+    if (surface->surface)
+        CFRelease(surface->surface);
+    memset(surface, 0, sizeof(*surface));
+}
+
+static void surface_cache_reset(struct hwupload_vt_darwin *vt)
+{
+    for (int i = 0; i < vt->nb_surfaces; i++)
+        surface_reset(&vt->surfaces[i]);
+    vt->nb_surfaces = 0;
+    vt->surface = NULL;
+}
+
+static int surface_init(struct ngl_node *node, struct vt_surface *surface, IOSurfaceRef iosurface)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct glcontext *gl = ctx->glcontext;
+
+    /* Retained so the cache entry can not match another surface */
+    surface->surface = (IOSurfaceRef)CFRetain(iosurface);
+    surface->width = IOSurfaceGetWidth(iosurface);
+    surface->height = IOSurfaceGetHeight(iosurface);
+
+    for (int i = 0; i < 2; i++) {
+        struct texture *plane = &surface->planes[i];
+        struct texture_params plane_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+        plane_params.format = i == 0 ? NGLI_FORMAT_R8_UNORM : NGLI_FORMAT_R8G8_UNORM;
+        plane_params.rectangle = 1;
+        plane_params.external_storage = 1;
+
+        int ret = ngli_texture_init(plane, ctx, &plane_params);
+        if (ret < 0)
+            return ret;
+
+        ngli_glstate_bind_texture(gl, plane->target, plane->id);
+
+        int width = IOSurfaceGetWidthOfPlane(iosurface, i);
+        int height = IOSurfaceGetHeightOfPlane(iosurface, i);
+        ngli_texture_set_dimensions(plane, width, height, 0);
+
+        CGLError err = CGLTexImageIOSurface2D(CGLGetCurrentContext(), plane->target,
+                                              plane->internal_format, width, height,
+                                              plane->format, plane->format_type, iosurface, i);
+        ngli_glstate_bind_texture(gl, GL_TEXTURE_RECTANGLE, 0);
+        if (err != kCGLNoError) {
+            LOG(ERROR, "could not bind IOSurface plane %d to texture %d: %d", i, plane->id, err);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static struct vt_surface *get_surface(struct ngl_node *node, IOSurfaceRef iosurface)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload_vt_darwin *vt = s->hwupload_priv_data;
+
+    struct vt_surface *lru = NULL;
+    for (int i = 0; i < vt->nb_surfaces; i++) {
+        struct vt_surface *surface = &vt->surfaces[i];
+        if (surface->surface == iosurface) {
+            /* A change of dimensions means the decoder allocated a new pool */
+            if (surface->width != IOSurfaceGetWidth(iosurface) ||
+                surface->height != IOSurfaceGetHeight(iosurface)) {
+                surface_cache_reset(vt);
+                lru = NULL;
+                break;
+            }
+            surface->last_use = ++vt->use_count;
+            return surface;
+        }
+        if (!lru || surface->last_use < lru->last_use)
+            lru = surface;
+    }
+
+    struct vt_surface *surface = lru;
+    if (vt->nb_surfaces < NB_CACHED_SURFACES)
+        surface = &vt->surfaces[vt->nb_surfaces++];
+    else
+        surface_reset(surface);
+
+    int ret = surface_init(node, surface, iosurface);
+    if (ret < 0) {
+        surface_reset(surface);
+        *surface = vt->surfaces[--vt->nb_surfaces];
+        memset(&vt->surfaces[vt->nb_surfaces], 0, sizeof(*surface));
+        return NULL;
+    }
+    surface->last_use = ++vt->use_count;
+    return surface;
+}
+
+static int vt_darwin_common_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
     struct texture_priv *s = node->priv_data;
     struct hwupload_vt_darwin *vt = s->hwupload_priv_data;
 
-    sxplayer_release_frame(vt->frame);
+    ngli_node_media_release_frame(s->data_src, vt->frame);
     vt->frame = frame;
 
     CVPixelBufferRef cvpixbuf = (CVPixelBufferRef)frame->data;
@@ -82,25 +194,9 @@ static int vt_darwin_common_map_frame(struct ngl_node *node, struct sxplayer_fra
         return -1;
     }
 
-    for (int i = 0; i < 2; i++) {
-        struct texture *plane = &vt->planes[i];
-
-        ngli_glBindTexture(gl, plane->target, plane->id);
-
-        int width = IOSurfaceGetWidthOfPlane(surface, i);
-        int height = IOSurfaceGetHeightOfPlane(surface, i);
-        ngli_texture_set_dimensions(plane, width, height, 0);
-
-        CGLError err = CGLTexImageIOSurface2D(CGLGetCurrentContext(), plane->target,
-                                              plane->internal_format, width, height,
-                                              plane->format, plane->format_type, surface, i);
-        if (err != kCGLNoError) {
-            LOG(ERROR, "could not bind IOSurface plane %d to texture %d: %d", i, s->texture.id, err);
-            return -1;
-        }
-
-        ngli_glBindTexture(gl, GL_TEXTURE_RECTANGLE, 0);
-    }
+    vt->surface = get_surface(node, surface);
+    if (!vt->surface)
+        return -1;
 
     return 0;
 }
@@ -126,18 +222,6 @@ static int vt_darwin_init(struct ngl_node *node, struct sxplayer_frame * frame)
 
     ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
 
-    for (int i = 0; i < 2; i++) {
-        struct texture *plane = &vt->planes[i];
-        struct texture_params plane_params = NGLI_TEXTURE_PARAM_DEFAULTS;
-        plane_params.format = i == 0 ? NGLI_FORMAT_R8_UNORM : NGLI_FORMAT_R8G8_UNORM;
-        plane_params.rectangle = 1;
-        plane_params.external_storage = 1;
-
-        int ret = ngli_texture_init(plane, ctx, &plane_params);
-        if (ret < 0)
-            return ret;
-    }
-
     return 0;
 }
 
@@ -169,7 +253,7 @@ static int vt_darwin_map_frame(struct ngl_node *node, struct sxplayer_frame *fra
             return ret;
     }
 
-    ngli_hwconv_convert(&vt->hwconv, vt->planes, NULL);
+    ngli_hwconv_convert(&vt->hwconv, vt->surface->planes, NULL);
 
     if (ngli_texture_has_mipmap(&s->texture))
         ngli_texture_generate_mipmap(&s->texture);
@@ -185,32 +269,29 @@ static void vt_darwin_uninit(struct ngl_node *node)
     ngli_hwconv_reset(&vt->hwconv);
     ngli_texture_reset(&s->texture);
 
-    for (int i = 0; i < 2; i++)
-        ngli_texture_reset(&vt->planes[i]);
+    surface_cache_reset(vt);
 
-    sxplayer_release_frame(vt->frame);
+    ngli_node_media_release_frame(s->data_src, vt->frame);
     vt->frame = NULL;
 }
 
 static int vt_darwin_dr_init(struct ngl_node *node, struct sxplayer_frame * frame)
 {
-    struct ngl_ctx *ctx = node->ctx;
+    return 0;
+}
+
+static int vt_darwin_dr_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
     struct texture_priv *s = node->priv_data;
     struct hwupload_vt_darwin *vt = s->hwupload_priv_data;
 
-    for (int i = 0; i < 2; i++) {
-        struct texture *plane = &vt->planes[i];
-        struct texture_params plane_params = NGLI_TEXTURE_PARAM_DEFAULTS;
-        plane_params.format = i == 0 ? NGLI_FORMAT_R8_UNORM : NGLI_FORMAT_R8G8_UNORM;
-        plane_params.rectangle = 1;
-        plane_params.external_storage = 1;
-
-        int ret = ngli_texture_init(plane, ctx, &plane_params);
-        if (ret < 0)
-            return ret;
-    }
+    int ret = vt_darwin_common_map_frame(node, frame);
+    if (ret < 0)
+        return ret;
 
-    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_NV12_RECTANGLE, &vt->planes[0], &vt->planes[1]);
+    /* Each cached surface has its own plane textures */
+    struct texture *planes = vt->surface->planes;
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_NV12_RECTANGLE, &planes[0], &planes[1]);
 
     return 0;
 }
@@ -220,10 +301,9 @@ static void vt_darwin_dr_uninit(struct ngl_node *node)
     struct texture_priv *s = node->priv_data;
     struct hwupload_vt_darwin *vt = s->hwupload_priv_data;
 
-    for (int i = 0; i < 2; i++)
-        ngli_texture_reset(&vt->planes[i]);
+    surface_cache_reset(vt);
 
-    sxplayer_release_frame(vt->frame);
+    ngli_node_media_release_frame(s->data_src, vt->frame);
     vt->frame = NULL;
 }
 
@@ -232,7 +312,7 @@ static const struct hwmap_class hwmap_vt_darwin_dr_class = {
     .flags     = HWMAP_FLAG_FRAME_OWNER,
     .priv_size = sizeof(struct hwupload_vt_darwin),
     .init      = vt_darwin_dr_init,
-    .map_frame = vt_darwin_common_map_frame,
+    .map_frame = vt_darwin_dr_map_frame,
     .uninit    = vt_darwin_dr_uninit,
 };
 
@@ -95,6 +95,8 @@ static int vt_ios_common_map_plane(struct ngl_node *node, CVPixelBufferRef cvpix
     struct texture *plane = &vt->planes[index];
     const struct texture_params *plane_params = &plane->params;
 
+    /* The texture name may be reused by the next texture of the cache */
+    ngli_glstate_forget_texture(gl, plane->id);
     NGLI_CFRELEASE(vt->ios_textures[index]);
 
     int width  = CVPixelBufferGetWidthOfPlane(cvpixbuf, index);
@@ -125,12 +127,12 @@ static int vt_ios_common_map_plane(struct ngl_node *node, CVPixelBufferRef cvpix
     const GLint wrap_s = ngli_texture_get_gl_wrap(plane_params->wrap_s);
     const GLint wrap_t = ngli_texture_get_gl_wrap(plane_params->wrap_t);
 
-    ngli_glBindTexture(gl, GL_TEXTURE_2D, id);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, id);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t);
-    ngli_glBindTexture(gl, GL_TEXTURE_2D, 0);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
 
     ngli_texture_set_id(plane, id);
     ngli_texture_set_dimensions(plane, width, height, 0);
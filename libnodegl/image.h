@@ -40,6 +40,7 @@ struct image {
     int nb_planes;
     NGLI_ALIGNED_MAT(coordinates_matrix);
     double ts;
+    double age; /* time elapsed since the reception of a live frame */
 };
 
 void ngli_image_init(struct image *s, enum image_layout layout, ...);
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "imagecache.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+enum {
+    STATE_DECODING,
+    STATE_READY,
+    STATE_FAILED,
+};
+
+static int64_t get_image_size(const struct imagecache_image *image)
+{
+    return (int64_t)image->width * image->height * image->bytes_per_pixel;
+}
+
+static void free_priv(struct imagecache *s, struct imagecache_entry *entry)
+{
+    if (!entry->priv)
+        return;
+    ngli_assert(!entry->priv_refcount);
+    s->free_priv(s->user_arg, entry->priv);
+    entry->priv = NULL;
+}
+
+static void free_entry(void *user_arg, void *data)
+{
+    struct imagecache *s = user_arg;
+    struct imagecache_entry *entry = data;
+    free_priv(s, entry);
+    ngli_free(entry->image.data);
+    ngli_free(entry->key);
+    ngli_free(entry);
+}
+
+int ngli_imagecache_init(struct imagecache *s, int64_t max_size,
+                         void (*free_priv)(void *user_arg, void *priv), void *user_arg)
+{
+    s->entries = ngli_hmap_create();
+    if (!s->entries)
+        return NGL_ERROR_MEMORY;
+    ngli_hmap_set_free(s->entries, free_entry, s);
+
+    if (pthread_mutex_init(&s->lock, NULL)) {
+        ngli_hmap_freep(&s->entries);
+        return NGL_ERROR_EXTERNAL;
+    }
+    if (pthread_cond_init(&s->cond, NULL)) {
+        pthread_mutex_destroy(&s->lock);
+        ngli_hmap_freep(&s->entries);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    s->max_size = max_size;
+    s->free_priv = free_priv;
+    s->user_arg = user_arg;
+    return 0;
+}
+
+/* Must be called with the lock held */
+static int remove_entry(struct imagecache *s, struct imagecache_entry *entry)
+{
+    return ngli_hmap_set(s->entries, entry->key, NULL);
+}
+
+static struct imagecache_entry *create_entry(struct imagecache *s, char *key)
+{
+    struct imagecache_entry *entry = ngli_calloc(1, sizeof(*entry));
+    if (!entry)
+        return NULL;
+    entry->key = key;
+    entry->refcount = 1;
+    entry->state = STATE_DECODING;
+    if (ngli_hmap_set(s->entries, key, entry) < 0) {
+        ngli_free(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+int ngli_imagecache_get(struct imagecache *s, const char *filename, const char *options,
+                        imagecache_decode_func decode, void *arg,
+                        struct imagecache_entry **entryp)
+{
+    struct stat st;
+    if (stat(filename, &st)) {
+        LOG(ERROR, "could not stat '%s'", filename);
+        return NGL_ERROR_IO;
+    }
+
+    char *key = ngli_asprintf("%lld %lld %s %s", (long long)st.st_mtime, (long long)st.st_size,
+                              options ? options : "", filename);
+    if (!key)
+        return NGL_ERROR_MEMORY;
+
+    pthread_mutex_lock(&s->lock);
+
+    struct imagecache_entry *entry = ngli_hmap_get(s->entries, key);
+    if (entry) {
+        ngli_free(key);
+        entry->refcount++;
+        while (entry->state == STATE_DECODING)
+            pthread_cond_wait(&s->cond, &s->lock);
+        const int failed = entry->state == STATE_FAILED;
+        pthread_mutex_unlock(&s->lock);
+        if (failed) {
+            ngli_imagecache_release(s, &entry);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        *entryp = entry;
+        return 0;
+    }
+
+    entry = create_entry(s, key);
+    if (!entry) {
+        pthread_mutex_unlock(&s->lock);
+        ngli_free(key);
+        return NGL_ERROR_MEMORY;
+    }
+
+    /* The other lookups of the image wait for its decoding without the lock */
+    pthread_mutex_unlock(&s->lock);
+    struct imagecache_image image = {0};
+    int ret = decode(arg, filename, &image);
+    pthread_mutex_lock(&s->lock);
+
+    if (ret >= 0) {
+        entry->image = image;
+        entry->state = STATE_READY;
+    } else {
+        ngli_free(image.data);
+        entry->state = STATE_FAILED;
+    }
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+
+    if (ret < 0) {
+        LOG(ERROR, "could not decode image '%s'", filename);
+        ngli_imagecache_release(s, &entry);
+        return ret;
+    }
+
+    *entryp = entry;
+    return 0;
+}
+
+/* Must be called with the lock held */
+static void trim(struct imagecache *s)
+{
+    for (;;) {
+        int64_t unused_size = 0;
+        struct imagecache_entry *lru = NULL;
+        const struct hmap_entry *e = NULL;
+        while ((e = ngli_hmap_next(s->entries, e))) {
+            struct imagecache_entry *entry = e->data;
+            if (entry->refcount)
+                continue;
+            unused_size += get_image_size(&entry->image);
+            if (!lru || entry->last_use < lru->last_use)
+                lru = entry;
+        }
+        if (!lru || unused_size <= s->max_size)
+            return;
+        remove_entry(s, lru);
+    }
+}
+
+void ngli_imagecache_release(struct imagecache *s, struct imagecache_entry **entryp)
+{
+    struct imagecache_entry *entry = *entryp;
+    if (!entry)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    if (!--entry->refcount) {
+        if (entry->state == STATE_FAILED) {
+            remove_entry(s, entry);
+        } else {
+            entry->last_use = ++s->clock;
+            trim(s);
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+    *entryp = NULL;
+}
+
+void *ngli_imagecache_ref_priv(struct imagecache *s, struct imagecache_entry *entry)
+{
+    entry->priv_refcount++;
+    return entry->priv;
+}
+
+void ngli_imagecache_unref_priv(struct imagecache *s, struct imagecache_entry *entry)
+{
+    ngli_assert(entry->priv_refcount > 0);
+    entry->priv_refcount--;
+    entry->priv_last_use = ++s->clock;
+}
+
+int ngli_imagecache_drop_priv(struct imagecache *s)
+{
+    pthread_mutex_lock(&s->lock);
+    struct imagecache_entry *lru = NULL;
+    const struct hmap_entry *e = NULL;
+    while ((e = ngli_hmap_next(s->entries, e))) {
+        struct imagecache_entry *entry = e->data;
+        if (entry->priv && !entry->priv_refcount &&
+            (!lru || entry->priv_last_use < lru->priv_last_use))
+            lru = entry;
+    }
+    if (lru)
+        free_priv(s, lru);
+    pthread_mutex_unlock(&s->lock);
+    return lru != NULL;
+}
+
+void ngli_imagecache_drop_privs(struct imagecache *s)
+{
+    if (!s->entries)
+        return;
+    pthread_mutex_lock(&s->lock);
+    const struct hmap_entry *e = NULL;
+    while ((e = ngli_hmap_next(s->entries, e)))
+        free_priv(s, e->data);
+    pthread_mutex_unlock(&s->lock);
+}
+
+void ngli_imagecache_reset(struct imagecache *s)
+{
+    if (!s->entries)
+        return;
+    ngli_hmap_freep(&s->entries);
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    memset(s, 0, sizeof(*s));
+}
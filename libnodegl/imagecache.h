@@ -0,0 +1,104 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "hmap.h"
+
+/* Decoded pixels, tightly packed rows of width * bytes_per_pixel bytes */
+struct imagecache_image {
+    int width;
+    int height;
+    int format;     /* NGLI_FORMAT_* */
+    int bytes_per_pixel;
+    uint8_t *data;  /* allocated by the decode function, freed by the cache */
+};
+
+typedef int (*imagecache_decode_func)(void *arg, const char *filename, struct imagecache_image *image);
+
+struct imagecache_entry {
+    char *key;
+    int refcount;
+    int state;
+    struct imagecache_image image;
+    int64_t last_use;
+
+    /* Uploaded version of the image, managed by the user of the cache */
+    void *priv;
+    int priv_refcount;
+    int64_t priv_last_use;
+};
+
+/*
+ * Still images decoded once and shared by every user of the same file,
+ * whatever the scene it belongs to. The entries are keyed by the path of
+ * the file, its modification time and size, and the decoding options:
+ * editing the file on disk makes the next lookup decode it again.
+ *
+ * The lookups may run concurrently from any thread: a lookup of an image
+ * being decoded by another thread waits for its completion instead of
+ * decoding it again. The images not referenced anymore are kept, least
+ * recently used first out, within max_size bytes of pixels.
+ *
+ * Each entry can also hold a private object (typically the GPU texture of
+ * the image), released with free_priv when the entry is evicted. The
+ * functions handling it are not thread-safe and are meant to be called
+ * from the rendering thread only.
+ */
+struct imagecache {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct hmap *entries;
+    int64_t max_size;
+    int64_t clock;
+    void (*free_priv)(void *user_arg, void *priv);
+    void *user_arg;
+};
+
+int ngli_imagecache_init(struct imagecache *s, int64_t max_size,
+                         void (*free_priv)(void *user_arg, void *priv), void *user_arg);
+
+int ngli_imagecache_get(struct imagecache *s, const char *filename, const char *options,
+                        imagecache_decode_func decode, void *arg,
+                        struct imagecache_entry **entryp);
+
+void ngli_imagecache_release(struct imagecache *s, struct imagecache_entry **entryp);
+
+/* Reference the private object of an entry, which is NULL until set by the caller */
+void *ngli_imagecache_ref_priv(struct imagecache *s, struct imagecache_entry *entry);
+void ngli_imagecache_unref_priv(struct imagecache *s, struct imagecache_entry *entry);
+
+/*
+ * Free the least recently used private object not referenced anymore,
+ * returns 0 if there is none
+ */
+int ngli_imagecache_drop_priv(struct imagecache *s);
+
+/* Free all the private objects, which must not be referenced anymore */
+void ngli_imagecache_drop_privs(struct imagecache *s);
+
+void ngli_imagecache_reset(struct imagecache *s);
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <pthread.h>
+
+#include "jobpool.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+struct jobpool {
+    pthread_t *threads;
+    int nb_threads;
+    int nb_spawned;
+    int priority;
+    uint64_t affinity;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond_jobs;
+    pthread_cond_t cond_done;
+    int quit;
+
+    /* Current batch, protected by lock */
+    unsigned batch_id;
+    jobpool_func_type func;
+    void *arg;
+    int nb_jobs;
+    int next_job;
+    int chunk_size;
+    int nb_done;
+    int ret;
+};
+
+/*
+ * Process the jobs of the current batch until none is left. Must be called
+ * with the lock held.
+ */
+static void run_jobs(struct jobpool *s)
+{
+    while (s->next_job < s->nb_jobs) {
+        const int start = s->next_job;
+        const int end = NGLI_MIN(start + s->chunk_size, s->nb_jobs);
+        s->next_job = end;
+
+        const jobpool_func_type func = s->func;
+        void *arg = s->arg;
+        pthread_mutex_unlock(&s->lock);
+
+        int ret = 0;
+        for (int i = start; i < end; i++) {
+            int job_ret = func(arg, i);
+            if (job_ret < 0 && !ret)
+                ret = job_ret;
+        }
+
+        pthread_mutex_lock(&s->lock);
+        if (ret < 0 && !s->ret)
+            s->ret = ret;
+        s->nb_done += end - start;
+        if (s->nb_done == s->nb_jobs)
+            pthread_cond_signal(&s->cond_done);
+    }
+}
+
+static void *worker_thread(void *arg)
+{
+    struct jobpool *s = arg;
+
+    ngli_thread_set_name("ngl-jobs");
+    if (s->priority || s->affinity)
+        ngli_thread_set_priority(s->priority, s->affinity);
+
+    pthread_mutex_lock(&s->lock);
+    unsigned batch_id = s->batch_id;
+    for (;;) {
+        while (!s->quit && s->batch_id == batch_id)
+            pthread_cond_wait(&s->cond_jobs, &s->lock);
+        if (s->quit)
+            break;
+        batch_id = s->batch_id;
+        run_jobs(s);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+
+struct jobpool *ngli_jobpool_create(int nb_threads, int priority, uint64_t affinity)
+{
+    if (nb_threads < 1)
+        return NULL;
+
+    struct jobpool *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+
+    s->nb_threads = nb_threads;
+    s->priority = priority;
+    s->affinity = affinity;
+    s->threads = ngli_calloc(nb_threads, sizeof(*s->threads));
+    if (!s->threads) {
+        ngli_free(s);
+        return NULL;
+    }
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond_jobs, NULL);
+    pthread_cond_init(&s->cond_done, NULL);
+
+    for (int i = 0; i < nb_threads - 1; i++) {
+        if (pthread_create(&s->threads[i], NULL, worker_thread, s)) {
+            LOG(ERROR, "unable to create job thread %d", i);
+            ngli_jobpool_freep(&s);
+            return NULL;
+        }
+        s->nb_spawned++;
+    }
+
+    return s;
+}
+
+int ngli_jobpool_get_nb_threads(const struct jobpool *s)
+{
+    return s->nb_threads;
+}
+
+void ngli_jobpool_start(struct jobpool *s, jobpool_func_type func, void *arg, int nb_jobs)
+{
+    if (nb_jobs <= 0)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    ngli_assert(!s->nb_jobs);
+    s->batch_id++;
+    s->func = func;
+    s->arg = arg;
+    s->nb_jobs = nb_jobs;
+    s->next_job = 0;
+    s->nb_done = 0;
+    s->ret = 0;
+
+    /* Several chunks per thread so the fastest threads can take over */
+    s->chunk_size = NGLI_MAX(nb_jobs / (s->nb_threads * 4), 1);
+
+    pthread_cond_broadcast(&s->cond_jobs);
+    pthread_mutex_unlock(&s->lock);
+}
+
+int ngli_jobpool_wait(struct jobpool *s)
+{
+    pthread_mutex_lock(&s->lock);
+    if (!s->nb_jobs) {
+        pthread_mutex_unlock(&s->lock);
+        return 0;
+    }
+
+    run_jobs(s);
+    while (s->nb_done < s->nb_jobs)
+        pthread_cond_wait(&s->cond_done, &s->lock);
+
+    const int ret = s->ret;
+    s->func = NULL;
+    s->arg = NULL;
+    s->nb_jobs = 0;
+    pthread_mutex_unlock(&s->lock);
+
+    return ret;
+}
+
+int ngli_jobpool_run(struct jobpool *s, jobpool_func_type func, void *arg, int nb_jobs)
+{
+    ngli_jobpool_start(s, func, arg, nb_jobs);
+    return ngli_jobpool_wait(s);
+}
+
+void ngli_jobpool_freep(struct jobpool **sp)
+{
+    struct jobpool *s = *sp;
+    if (!s)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    s->quit = 1;
+    pthread_cond_broadcast(&s->cond_jobs);
+    pthread_mutex_unlock(&s->lock);
+
+    for (int i = 0; i < s->nb_spawned; i++)
+        pthread_join(s->threads[i], NULL);
+
+    pthread_cond_destroy(&s->cond_done);
+    pthread_cond_destroy(&s->cond_jobs);
+    pthread_mutex_destroy(&s->lock);
+    ngli_free(s->threads);
+    ngli_free(s);
+    *sp = NULL;
+}
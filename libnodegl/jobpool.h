@@ -0,0 +1,70 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef JOBPOOL_H
+#define JOBPOOL_H
+
+#include <stdint.h>
+
+/*
+ * Pool of threads running batches of independent jobs. The jobs of a batch
+ * are taken in small chunks by whichever thread is free first, the calling
+ * thread included, so an unbalanced batch is spread over the whole pool.
+ */
+struct jobpool;
+
+typedef int (*jobpool_func_type)(void *arg, int index);
+
+/*
+ * Create a pool running the batches on nb_threads threads, the calling
+ * thread included (nb_threads - 1 threads are actually spawned). The
+ * spawned threads get the given scheduling priority and CPU affinity (see
+ * ngli_thread_set_priority()).
+ */
+struct jobpool *ngli_jobpool_create(int nb_threads, int priority, uint64_t affinity);
+
+int ngli_jobpool_get_nb_threads(const struct jobpool *s);
+
+/*
+ * Start calling func(arg, i) for every i in [0, nb_jobs) on the pool threads
+ * and return without waiting. Only one batch can be running at a time, and
+ * arg must remain valid until ngli_jobpool_wait() returns.
+ */
+void ngli_jobpool_start(struct jobpool *s, jobpool_func_type func, void *arg, int nb_jobs);
+
+/*
+ * Help processing the jobs of the started batch which are not taken yet and
+ * wait for all of them to return. The first error returned by a job is
+ * returned, after the whole batch has been processed. Return 0 if no batch
+ * is running.
+ */
+int ngli_jobpool_wait(struct jobpool *s);
+
+/*
+ * Run a batch of jobs on the pool, the calling thread included, and wait
+ * for it to complete (equivalent to ngli_jobpool_start() followed by
+ * ngli_jobpool_wait()).
+ */
+int ngli_jobpool_run(struct jobpool *s, jobpool_func_type func, void *arg, int nb_jobs);
+
+void ngli_jobpool_freep(struct jobpool **sp);
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "format.h"
+#include "glincludes.h"
+#include "ktx.h"
+#include "log.h"
+#include "nodegl.h"
+#include "utils.h"
+
+static const uint8_t ktx1_identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const uint8_t ktx2_identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+#define KTX1_HEADER_SIZE (12 + 13 * 4)
+#define KTX2_HEADER_SIZE (12 + 13 * 4 + 2 * 8)
+#define KTX2_LEVEL_SIZE  (3 * 8)
+
+static const struct {
+    GLint internal_format;
+    int format;
+} ktx1_formats[] = {
+    {GL_RGBA8,                                    NGLI_FORMAT_R8G8B8A8_UNORM},
+    {GL_SRGB8_ALPHA8,                             NGLI_FORMAT_R8G8B8A8_SRGB},
+    {GL_COMPRESSED_RGB8_ETC2,                     NGLI_FORMAT_ETC2_R8G8B8_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB8_ETC2,                    NGLI_FORMAT_ETC2_R8G8B8_SRGB_BLOCK},
+    {GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, NGLI_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK},
+    {GL_COMPRESSED_RGBA8_ETC2_EAC,                NGLI_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC,         NGLI_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK},
+    {GL_COMPRESSED_R11_EAC,                       NGLI_FORMAT_EAC_R11_UNORM_BLOCK},
+    {GL_COMPRESSED_RG11_EAC,                      NGLI_FORMAT_EAC_R11G11_UNORM_BLOCK},
+    {GL_COMPRESSED_RGBA_ASTC_4x4_KHR,             NGLI_FORMAT_ASTC_4x4_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR,     NGLI_FORMAT_ASTC_4x4_SRGB_BLOCK},
+    {GL_COMPRESSED_RGBA_ASTC_5x5_KHR,             NGLI_FORMAT_ASTC_5x5_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR,     NGLI_FORMAT_ASTC_5x5_SRGB_BLOCK},
+    {GL_COMPRESSED_RGBA_ASTC_6x6_KHR,             NGLI_FORMAT_ASTC_6x6_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR,     NGLI_FORMAT_ASTC_6x6_SRGB_BLOCK},
+    {GL_COMPRESSED_RGBA_ASTC_8x8_KHR,             NGLI_FORMAT_ASTC_8x8_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR,     NGLI_FORMAT_ASTC_8x8_SRGB_BLOCK},
+    {GL_COMPRESSED_RGB_S3TC_DXT1_EXT,             NGLI_FORMAT_BC1_RGB_UNORM_BLOCK},
+    {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,            NGLI_FORMAT_BC1_RGBA_UNORM_BLOCK},
+    {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,            NGLI_FORMAT_BC2_UNORM_BLOCK},
+    {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,            NGLI_FORMAT_BC3_UNORM_BLOCK},
+    {GL_COMPRESSED_RED_RGTC1,                     NGLI_FORMAT_BC4_UNORM_BLOCK},
+    {GL_COMPRESSED_RG_RGTC2,                      NGLI_FORMAT_BC5_UNORM_BLOCK},
+    {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,       NGLI_FORMAT_BC6H_UFLOAT_BLOCK},
+    {GL_COMPRESSED_RGBA_BPTC_UNORM,               NGLI_FORMAT_BC7_UNORM_BLOCK},
+    {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,         NGLI_FORMAT_BC7_SRGB_BLOCK},
+};
+
+/* KTX2 identifies the formats with their VkFormat value */
+static const struct {
+    uint32_t vk_format;
+    int format;
+} ktx2_formats[] = {
+    {37,  NGLI_FORMAT_R8G8B8A8_UNORM},
+    {43,  NGLI_FORMAT_R8G8B8A8_SRGB},
+    {131, NGLI_FORMAT_BC1_RGB_UNORM_BLOCK},
+    {133, NGLI_FORMAT_BC1_RGBA_UNORM_BLOCK},
+    {135, NGLI_FORMAT_BC2_UNORM_BLOCK},
+    {137, NGLI_FORMAT_BC3_UNORM_BLOCK},
+    {139, NGLI_FORMAT_BC4_UNORM_BLOCK},
+    {141, NGLI_FORMAT_BC5_UNORM_BLOCK},
+    {143, NGLI_FORMAT_BC6H_UFLOAT_BLOCK},
+    {145, NGLI_FORMAT_BC7_UNORM_BLOCK},
+    {146, NGLI_FORMAT_BC7_SRGB_BLOCK},
+    {147, NGLI_FORMAT_ETC2_R8G8B8_UNORM_BLOCK},
+    {148, NGLI_FORMAT_ETC2_R8G8B8_SRGB_BLOCK},
+    {149, NGLI_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK},
+    {151, NGLI_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK},
+    {152, NGLI_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK},
+    {153, NGLI_FORMAT_EAC_R11_UNORM_BLOCK},
+    {155, NGLI_FORMAT_EAC_R11G11_UNORM_BLOCK},
+    {157, NGLI_FORMAT_ASTC_4x4_UNORM_BLOCK},
+    {158, NGLI_FORMAT_ASTC_4x4_SRGB_BLOCK},
+    {161, NGLI_FORMAT_ASTC_5x5_UNORM_BLOCK},
+    {162, NGLI_FORMAT_ASTC_5x5_SRGB_BLOCK},
+    {165, NGLI_FORMAT_ASTC_6x6_UNORM_BLOCK},
+    {166, NGLI_FORMAT_ASTC_6x6_SRGB_BLOCK},
+    {171, NGLI_FORMAT_ASTC_8x8_UNORM_BLOCK},
+    {172, NGLI_FORMAT_ASTC_8x8_SRGB_BLOCK},
+};
+
+static uint32_t read_u32(const uint8_t *p, int swap)
+{
+    return swap ? (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]
+                : (uint32_t)p[3] << 24 | p[2] << 16 | p[1] << 8 | p[0];
+}
+
+static uint64_t read_u64(const uint8_t *p)
+{
+    return (uint64_t)read_u32(p + 4, 0) << 32 | read_u32(p, 0);
+}
+
+int ngli_ktx_probe(const uint8_t *data, int size)
+{
+    return size >= (int)sizeof(ktx1_identifier) &&
+           (!memcmp(data, ktx1_identifier, sizeof(ktx1_identifier)) ||
+            !memcmp(data, ktx2_identifier, sizeof(ktx2_identifier)));
+}
+
+static int check_image(struct ktx *s, uint32_t width, uint32_t height, uint32_t depth,
+                       uint32_t nb_layers, uint32_t nb_faces, uint32_t nb_levels)
+{
+    if (!width || !height || width > INT32_MAX || height > INT32_MAX) {
+        LOG(ERROR, "invalid KTX image dimensions %ux%u", width, height);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    if (depth > 1 || nb_layers > 1 || nb_faces != 1) {
+        LOG(ERROR, "only single 2D images are supported in KTX files");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    if (nb_levels > NGLI_KTX_MAX_LEVELS) {
+        LOG(ERROR, "KTX image has too many mipmap levels (%u > %d)", nb_levels, NGLI_KTX_MAX_LEVELS);
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    }
+
+    s->width = width;
+    s->height = height;
+    /* No level means the mipmaps are expected to be generated */
+    s->nb_levels = NGLI_MAX(nb_levels, 1);
+    return 0;
+}
+
+static int set_level(struct ktx *s, int level, const uint8_t *data, int size, uint64_t offset, uint64_t length)
+{
+    const int width  = NGLI_MAX(s->width  >> level, 1);
+    const int height = NGLI_MAX(s->height >> level, 1);
+    if (offset > (uint64_t)size || length > (uint64_t)size - offset ||
+        length < ngli_format_get_image_size(s->format, width, height)) {
+        LOG(ERROR, "KTX image level %d is truncated", level);
+        return NGL_ERROR_INVALID_DATA;
+    }
+    s->levels[level].data = data + offset;
+    s->levels[level].size = length;
+    return 0;
+}
+
+static int parse_ktx1(struct ktx *s, const uint8_t *data, int size)
+{
+    if (size < KTX1_HEADER_SIZE) {
+        LOG(ERROR, "KTX header is truncated");
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    const uint8_t *p = data + sizeof(ktx1_identifier);
+    const uint32_t endianness = read_u32(p, 0);
+    if (endianness != 0x04030201 && endianness != 0x01020304) {
+        LOG(ERROR, "invalid KTX endianness 0x%08x", endianness);
+        return NGL_ERROR_INVALID_DATA;
+    }
+    const int swap = endianness == 0x01020304;
+
+    const uint32_t internal_format = read_u32(p + 4 * 4, swap);
+    const uint32_t width           = read_u32(p + 4 * 6, swap);
+    const uint32_t height          = read_u32(p + 4 * 7, swap);
+    const uint32_t depth           = read_u32(p + 4 * 8, swap);
+    const uint32_t nb_layers       = read_u32(p + 4 * 9, swap);
+    const uint32_t nb_faces        = read_u32(p + 4 * 10, swap);
+    const uint32_t nb_levels       = read_u32(p + 4 * 11, swap);
+    const uint32_t kvd_size        = read_u32(p + 4 * 12, swap);
+
+    s->format = NGLI_FORMAT_UNDEFINED;
+    for (int i = 0; i < NGLI_ARRAY_NB(ktx1_formats); i++) {
+        if (ktx1_formats[i].internal_format == internal_format) {
+            s->format = ktx1_formats[i].format;
+            break;
+        }
+    }
+    if (s->format == NGLI_FORMAT_UNDEFINED) {
+        LOG(ERROR, "unsupported KTX internal format 0x%x", internal_format);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    int ret = check_image(s, width, height, depth, nb_layers, nb_faces, nb_levels);
+    if (ret < 0)
+        return ret;
+
+    /* Each level image is prefixed by its size and padded to 4 bytes */
+    uint64_t offset = (uint64_t)KTX1_HEADER_SIZE + kvd_size;
+    for (int i = 0; i < s->nb_levels; i++) {
+        if (offset + 4 > (uint64_t)size) {
+            LOG(ERROR, "KTX image level %d is missing", i);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        const uint32_t image_size = read_u32(data + offset, swap);
+        ret = set_level(s, i, data, size, offset + 4, image_size);
+        if (ret < 0)
+            return ret;
+        offset += 4 + NGLI_ALIGN((uint64_t)image_size, 4);
+    }
+
+    return 0;
+}
+
+static int parse_ktx2(struct ktx *s, const uint8_t *data, int size)
+{
+    if (size < KTX2_HEADER_SIZE) {
+        LOG(ERROR, "KTX2 header is truncated");
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    const uint8_t *p = data + sizeof(ktx2_identifier);
+    const uint32_t vk_format        = read_u32(p, 0);
+    const uint32_t width            = read_u32(p + 4 * 2, 0);
+    const uint32_t height           = read_u32(p + 4 * 3, 0);
+    const uint32_t depth            = read_u32(p + 4 * 4, 0);
+    const uint32_t nb_layers        = read_u32(p + 4 * 5, 0);
+    const uint32_t nb_faces         = read_u32(p + 4 * 6, 0);
+    const uint32_t nb_levels        = read_u32(p + 4 * 7, 0);
+    const uint32_t supercompression = read_u32(p + 4 * 8, 0);
+
+    if (supercompression) {
+        LOG(ERROR, "unsupported KTX2 supercompression scheme %u", supercompression);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    s->format = NGLI_FORMAT_UNDEFINED;
+    for (int i = 0; i < NGLI_ARRAY_NB(ktx2_formats); i++) {
+        if (ktx2_formats[i].vk_format == vk_format) {
+            s->format = ktx2_formats[i].format;
+            break;
+        }
+    }
+    if (s->format == NGLI_FORMAT_UNDEFINED) {
+        LOG(ERROR, "unsupported KTX2 format %u", vk_format);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    int ret = check_image(s, width, height, depth, nb_layers, nb_faces, nb_levels);
+    if (ret < 0)
+        return ret;
+
+    if (size < KTX2_HEADER_SIZE + s->nb_levels * KTX2_LEVEL_SIZE) {
+        LOG(ERROR, "KTX2 level index is truncated");
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    const uint8_t *level_index = data + KTX2_HEADER_SIZE;
+    for (int i = 0; i < s->nb_levels; i++) {
+        const uint8_t *entry = level_index + i * KTX2_LEVEL_SIZE;
+        ret = set_level(s, i, data, size, read_u64(entry), read_u64(entry + 8));
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+int ngli_ktx_parse(struct ktx *s, const uint8_t *data, int size)
+{
+    memset(s, 0, sizeof(*s));
+
+    if (!ngli_ktx_probe(data, size)) {
+        LOG(ERROR, "data is not a KTX file");
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    int ret = !memcmp(data, ktx1_identifier, sizeof(ktx1_identifier)) ? parse_ktx1(s, data, size)
+                                                                       : parse_ktx2(s, data, size);
+    if (ret < 0)
+        memset(s, 0, sizeof(*s));
+    return ret;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef KTX_H
+#define KTX_H
+
+#include <stdint.h>
+
+#define NGLI_KTX_MAX_LEVELS 16
+
+struct ktx_level {
+    const uint8_t *data;
+    int size;
+};
+
+/*
+ * Description of a 2D image stored in a KTX (version 1 or 2) container. The
+ * levels point into the parsed data, which must outlive this structure.
+ */
+struct ktx {
+    int format; // any of NGLI_FORMAT_*
+    int width;
+    int height;
+    int nb_levels;
+    struct ktx_level levels[NGLI_KTX_MAX_LEVELS];
+};
+
+/*
+ * Return whether the data starts with a KTX or KTX2 file identifier.
+ */
+int ngli_ktx_probe(const uint8_t *data, int size);
+
+/*
+ * Only 2D images without supercompression are supported, in one of the
+ * compressed formats or as 8-bit RGBA.
+ */
+int ngli_ktx_parse(struct ktx *s, const uint8_t *data, int size);
+
+#endif
@@ -24,6 +24,7 @@
 #include <math.h>
 
 #include "math_utils.h"
+#include "utils.h"
 
 static const float zvec[4];
 
@@ -150,6 +151,13 @@ void ngli_vec4_lerp(float *dst, const float *v1, const float *v2, float c)
     dst[3] = v1[3] + c*(v2[3] - v1[3]);
 }
 
+void ngli_mix_f32_c(float *dst, const float *v1, const float *v2, float c, int count)
+{
+    const float ic = 1.0f - c;
+    for (int i = 0; i < count; i++)
+        dst[i] = v1[i]*ic + v2[i]*c;
+}
+
 void ngli_mat3_from_mat4(float *dst, const float *m)
 {
     memcpy(dst,     m,     3 * sizeof(*m));
@@ -214,7 +222,7 @@ void ngli_mat3_adjugate(float *dst, const float* m)
     memcpy(dst, tmp, sizeof(tmp));
 }
 
-void ngli_mat3_inverse(float *dst, const float *m)
+void ngli_mat3_inverse_c(float *dst, const float *m)
 {
     float a[3*3];
     float det = ngli_mat3_determinant(m);
@@ -451,9 +459,60 @@ void ngli_mat4_scale(float *dst, float x, float y, float z)
     dst[15] =  1.0f;
 }
 
+/*
+ * The box can only be rejected if all its corners are on the outer side of
+ * the same clip plane, so some boxes crossing the edges of the volume while
+ * being outside of it are not detected
+ */
+int ngli_mat4_box_outside_clip(const float *matrix, const float *box_min, const float *box_max)
+{
+    int outside = 0x3f;
+    for (int i = 0; i < 8; i++) {
+        const NGLI_ALIGNED_VEC(corner) = {
+            i & 1 ? box_max[0] : box_min[0],
+            i & 2 ? box_max[1] : box_min[1],
+            i & 4 ? box_max[2] : box_min[2],
+            1.0f,
+        };
+        NGLI_ALIGNED_VEC(clip);
+        ngli_mat4_mul_vec4(clip, matrix, corner);
+
+        const float w = clip[3];
+        int planes = 0;
+        for (int j = 0; j < 3; j++) {
+            if (clip[j] < -w) planes |= 1 << (j * 2);
+            if (clip[j] >  w) planes |= 1 << (j * 2 + 1);
+        }
+        outside &= planes;
+        if (!outside)
+            return 0;
+    }
+    return 1;
+}
+
+float ngli_mat4_box_min_depth(const float *matrix, const float *box_min, const float *box_max)
+{
+    float min_depth = 1.0f;
+    for (int i = 0; i < 8; i++) {
+        const NGLI_ALIGNED_VEC(corner) = {
+            i & 1 ? box_max[0] : box_min[0],
+            i & 2 ? box_max[1] : box_min[1],
+            i & 4 ? box_max[2] : box_min[2],
+            1.0f,
+        };
+        NGLI_ALIGNED_VEC(clip);
+        ngli_mat4_mul_vec4(clip, matrix, corner);
+
+        if (clip[3] <= 0.0f)
+            return -1.0f;
+        min_depth = NGLI_MIN(min_depth, clip[2] / clip[3]);
+    }
+    return NGLI_MAX(min_depth, -1.0f);
+}
+
 #define COS_ALPHA_THRESHOLD 0.9995f
 
-void ngli_quat_slerp(float *dst, const float *q1, const float *q2, float t)
+void ngli_quat_slerp_c(float *dst, const float *q1, const float *q2, float t)
 {
     float tmp_q1[4];
     const float *tmp_q1p = q1;
@@ -491,3 +550,24 @@ void ngli_quat_slerp(float *dst, const float *q1, const float *q2, float t)
     ngli_vec4_scale(tmp2, tmp, sin(theta));
     ngli_vec4_add(dst, tmp1, tmp2);
 }
+
+#define PAD_VEC4(size) do {                                                 \
+    for (int i = 0; i < count; i++) {                                       \
+        memcpy(d + i * 16, s + i * size, size);                             \
+        memset(d + i * 16 + size, 0, 16 - size);                            \
+    }                                                                       \
+} while (0)
+
+void ngli_pad_vec4_c(void *dst, const void *src, int size, int count)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    /* Constant sizes for the copies to be inlined */
+    switch (size) {
+    case 4:  PAD_VEC4(4);  break;
+    case 8:  PAD_VEC4(8);  break;
+    case 12: PAD_VEC4(12); break;
+    default: ngli_assert(0);
+    }
+}
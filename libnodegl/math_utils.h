@@ -44,12 +44,14 @@ void ngli_vec4_norm(float *dst, const float *v);
 void ngli_vec4_scale(float *dst, const float *v, float s);
 void ngli_vec4_sub(float *dst, const float *v1, const float *v2);
 
+void ngli_mix_f32_c(float *dst, const float *v1, const float *v2, float c, int count);
+
 void ngli_mat3_from_mat4(float *dst, const float *m);
 void ngli_mat3_mul_scalar(float *dst, const float *m, float s);
 void ngli_mat3_transpose(float *dst, const float *m);
 float ngli_mat3_determinant(const float *m);
 void ngli_mat3_adjugate(float *dst, const float* m);
-void ngli_mat3_inverse(float *dst, const float *m);
+void ngli_mat3_inverse_c(float *dst, const float *m);
 
 #define NGLI_MAT4_IDENTITY {1.0f, 0.0f, 0.0f, 0.0f, \
                             0.0f, 1.0f, 0.0f, 0.0f, \
@@ -67,19 +69,60 @@ void ngli_mat4_rotate_from_quat(float *dst, const float *quat);
 void ngli_mat4_translate(float *dst, float x, float y, float z);
 void ngli_mat4_scale(float *dst, float x, float y, float z);
 
+/*
+ * Return whether the axis-aligned box delimited by box_min and box_max is
+ * entirely outside the clip volume once transformed by matrix (typically a
+ * projection times a modelview matrix)
+ */
+int ngli_mat4_box_outside_clip(const float *matrix, const float *box_min, const float *box_max);
+
+/*
+ * Return the smallest normalized device depth of the corners of the box once
+ * transformed by matrix, -1 if the box crosses the w = 0 plane
+ */
+float ngli_mat4_box_min_depth(const float *matrix, const float *box_min, const float *box_max);
+
+void ngli_quat_slerp_c(float *dst, const float *q1, const float *q2, float t);
+
+/*
+ * Copy count elements of size bytes (4, 8 or 12) into consecutive 16 bytes
+ * slots, as laid out in the std140 arrays and the std430 arrays of vec3; the
+ * padding of each slot is zeroed
+ */
+void ngli_pad_vec4_c(void *dst, const void *src, int size, int count);
+
 /* Arch specific versions */
 
 #ifdef ARCH_AARCH64
+# define ngli_mat3_inverse      ngli_mat3_inverse_c
 # define ngli_mat4_mul          ngli_mat4_mul_aarch64
 # define ngli_mat4_mul_vec4     ngli_mat4_mul_vec4_aarch64
+# define ngli_mix_f32           ngli_mix_f32_aarch64
+# define ngli_pad_vec4          ngli_pad_vec4_c
+# define ngli_quat_slerp        ngli_quat_slerp_c
+#elif defined(ARCH_X86_64)
+# define ngli_mat3_inverse      ngli_mat3_inverse_sse
+# define ngli_mat4_mul          ngli_mat4_mul_c
+# define ngli_mat4_mul_vec4     ngli_mat4_mul_vec4_c
+# define ngli_mix_f32           ngli_mix_f32_sse
+# define ngli_pad_vec4          ngli_pad_vec4_sse
+# define ngli_quat_slerp        ngli_quat_slerp_sse
 #else
+# define ngli_mat3_inverse      ngli_mat3_inverse_c
 # define ngli_mat4_mul          ngli_mat4_mul_c
 # define ngli_mat4_mul_vec4     ngli_mat4_mul_vec4_c
+# define ngli_mix_f32           ngli_mix_f32_c
+# define ngli_pad_vec4          ngli_pad_vec4_c
+# define ngli_quat_slerp        ngli_quat_slerp_c
 #endif
 
 void ngli_mat4_mul_aarch64(float *dst, const float *m1, const float *m2);
 void ngli_mat4_mul_vec4_aarch64(float *dst, const float *m, const float *v);
+void ngli_mix_f32_aarch64(float *dst, const float *v1, const float *v2, float c, int count);
 
-void ngli_quat_slerp(float *dst, const float *q1, const float *q2, float t);
+void ngli_mat3_inverse_sse(float *dst, const float *m);
+void ngli_mix_f32_sse(float *dst, const float *v1, const float *v2, float c, int count);
+void ngli_pad_vec4_sse(void *dst, const void *src, int size, int count);
+void ngli_quat_slerp_sse(float *dst, const float *q1, const float *q2, float t);
 
 #endif
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include "math_utils.h"
+
+void ngli_mix_f32_sse(float *dst, const float *v1, const float *v2, float c, int count)
+{
+    const float ic = 1.0f - c;
+    const __m128 c4  = _mm_set1_ps(c);
+    const __m128 ic4 = _mm_set1_ps(ic);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a0 = _mm_loadu_ps(v1 + i);
+        const __m128 a1 = _mm_loadu_ps(v1 + i + 4);
+        const __m128 b0 = _mm_loadu_ps(v2 + i);
+        const __m128 b1 = _mm_loadu_ps(v2 + i + 4);
+        _mm_storeu_ps(dst + i,     _mm_add_ps(_mm_mul_ps(a0, ic4), _mm_mul_ps(b0, c4)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_mul_ps(a1, ic4), _mm_mul_ps(b1, c4)));
+    }
+    for (; i < count; i++)
+        dst[i] = v1[i]*ic + v2[i]*c;
+}
+
+void ngli_pad_vec4_sse(void *dst, const void *src, int size, int count)
+{
+    /* The elements are only moved around, never computed, so integers are
+     * safely handled as floats */
+    float *d = dst;
+    const float *s = src;
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    if (size == 4) {
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v  = _mm_loadu_ps(s + i);
+            const __m128 lo = _mm_unpacklo_ps(v, zero);
+            const __m128 hi = _mm_unpackhi_ps(v, zero);
+            _mm_storeu_ps(d + i * 4,      _mm_movelh_ps(lo, zero));
+            _mm_storeu_ps(d + i * 4 + 4,  _mm_movehl_ps(zero, lo));
+            _mm_storeu_ps(d + i * 4 + 8,  _mm_movelh_ps(hi, zero));
+            _mm_storeu_ps(d + i * 4 + 12, _mm_movehl_ps(zero, hi));
+        }
+    } else if (size == 8) {
+        for (; i + 2 <= count; i += 2) {
+            const __m128 v = _mm_loadu_ps(s + i * 2);
+            _mm_storeu_ps(d + i * 4,     _mm_movelh_ps(v, zero));
+            _mm_storeu_ps(d + i * 4 + 4, _mm_movehl_ps(zero, v));
+        }
+    } else if (size == 12) {
+        const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        /* The load of the last element would read past the source */
+        for (; i + 1 < count; i++)
+            _mm_storeu_ps(d + i * 4, _mm_and_ps(_mm_loadu_ps(s + i * 3), mask));
+    }
+    ngli_pad_vec4_c(d + i * 4, (const uint8_t *)src + i * size, size, count - i);
+}
+
+#define SHUFFLE_YZX(v) _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1))
+#define SHUFFLE_ZXY(v) _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2))
+
+static inline __m128 cross(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(SHUFFLE_YZX(a), SHUFFLE_ZXY(b)),
+                      _mm_mul_ps(SHUFFLE_ZXY(a), SHUFFLE_YZX(b)));
+}
+
+/*
+ * The rows of the inverse are the cross products of the columns of the
+ * matrix (the adjugate) divided by the determinant, which is the triple
+ * product of the columns.
+ */
+void ngli_mat3_inverse_sse(float *dst, const float *m)
+{
+    const __m128 a = _mm_setr_ps(m[0], m[1], m[2], 0.0f);
+    const __m128 b = _mm_setr_ps(m[3], m[4], m[5], 0.0f);
+    const __m128 c = _mm_setr_ps(m[6], m[7], m[8], 0.0f);
+
+    __m128 r0 = cross(b, c);
+    __m128 r1 = cross(c, a);
+    __m128 r2 = cross(a, b);
+
+    const __m128 d = _mm_mul_ps(a, r0);
+    const float det = _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(d, SHUFFLE_YZX(d)), SHUFFLE_ZXY(d)));
+    if (det == 0.0f) {
+        memmove(dst, m, 3 * 3 * sizeof(*m));
+        return;
+    }
+
+    const __m128 inv_det = _mm_set1_ps(1.0f / det);
+    r0 = _mm_mul_ps(r0, inv_det);
+    r1 = _mm_mul_ps(r1, inv_det);
+    r2 = _mm_mul_ps(r2, inv_det);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    float tmp[4];
+    _mm_storeu_ps(dst,     r0);
+    _mm_storeu_ps(dst + 3, r1);
+    _mm_storeu_ps(tmp,     r2);
+    memcpy(dst + 6, tmp, 3 * sizeof(*dst));
+}
+
+static inline float dot4(__m128 a, __m128 b)
+{
+    const __m128 m = _mm_mul_ps(a, b);
+    const __m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+static inline __m128 norm4(__m128 v)
+{
+    const float l = sqrtf(dot4(v, v));
+    return l == 0.0f ? _mm_setzero_ps() : _mm_div_ps(v, _mm_set1_ps(l));
+}
+
+#define COS_ALPHA_THRESHOLD 0.9995f
+
+void ngli_quat_slerp_sse(float *dst, const float *q1, const float *q2, float t)
+{
+    __m128 v1 = _mm_loadu_ps(q1);
+    const __m128 v2 = _mm_loadu_ps(q2);
+
+    float cos_alpha = dot4(v1, v2);
+
+    if (cos_alpha < 0.0f) {
+        cos_alpha = -cos_alpha;
+        v1 = _mm_sub_ps(_mm_setzero_ps(), v1);
+    }
+
+    if (cos_alpha > COS_ALPHA_THRESHOLD) {
+        const __m128 t4 = _mm_set1_ps(t);
+        const __m128 r = _mm_add_ps(v1, _mm_mul_ps(_mm_sub_ps(v2, v1), t4));
+        _mm_storeu_ps(dst, norm4(r));
+        return;
+    }
+
+    if (cos_alpha > 1.0f)
+        cos_alpha = 1.0f;
+
+    const float alpha = acosf(cos_alpha);
+    const float theta = alpha * t;
+
+    const __m128 ortho = norm4(_mm_sub_ps(v2, _mm_mul_ps(v1, _mm_set1_ps(cos_alpha))));
+    const __m128 r = _mm_add_ps(_mm_mul_ps(v1, _mm_set1_ps(cosf(theta))),
+                                _mm_mul_ps(ortho, _mm_set1_ps(sinf(theta))));
+    _mm_storeu_ps(dst, r);
+}
@@ -23,6 +23,7 @@
 #define _POSIX_C_SOURCE 200809L // posix_memalign()
 #endif
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -112,3 +113,198 @@ void ngli_free_aligned(void *ptr)
     free(ptr);
 #endif
 }
+
+struct tag_header {
+    size_t size;
+    int tag;
+};
+
+#define TAG_HEADER_SIZE NGLI_ALIGN(sizeof(struct tag_header), NGLI_ALIGN_VAL)
+
+static int64_t memory_live[NGLI_MEMTAG_NB];
+static int64_t memory_peak[NGLI_MEMTAG_NB];
+
+static void account(int tag, int64_t delta)
+{
+    const int64_t live = __atomic_add_fetch(&memory_live[tag], delta, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&memory_peak[tag], __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&memory_peak[tag], &peak, live, 1,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static struct tag_header *get_tag_header(void *ptr)
+{
+    return (struct tag_header *)((uint8_t *)ptr - TAG_HEADER_SIZE);
+}
+
+void *ngli_malloc_tagged(size_t size, int tag)
+{
+    if (size > SIZE_MAX - TAG_HEADER_SIZE)
+        return NULL;
+    struct tag_header *header = ngli_malloc_aligned(TAG_HEADER_SIZE + size);
+    if (!header)
+        return NULL;
+    header->size = size;
+    header->tag = tag;
+    account(tag, size);
+    return (uint8_t *)header + TAG_HEADER_SIZE;
+}
+
+void *ngli_calloc_tagged(size_t n, size_t size, int tag)
+{
+    if (size && n > SIZE_MAX / size)
+        return NULL;
+    void *ptr = ngli_malloc_tagged(n * size, tag);
+    if (!ptr)
+        return NULL;
+    memset(ptr, 0, n * size);
+    return ptr;
+}
+
+/*
+ * The data is always moved: a realloc() would not preserve the alignment
+ */
+void *ngli_realloc_tagged(void *ptr, size_t size, int tag)
+{
+    if (!ptr)
+        return ngli_malloc_tagged(size, tag);
+    void *new_ptr = ngli_malloc_tagged(size, tag);
+    if (!new_ptr)
+        return NULL;
+    memcpy(new_ptr, ptr, NGLI_MIN(size, get_tag_header(ptr)->size));
+    ngli_free_tagged(ptr);
+    return new_ptr;
+}
+
+void ngli_free_tagged(void *ptr)
+{
+    if (!ptr)
+        return;
+    struct tag_header *header = get_tag_header(ptr);
+    account(header->tag, -(int64_t)header->size);
+    ngli_free_aligned(header);
+}
+
+void ngli_memory_get_usage(int64_t *live, int64_t *peak)
+{
+    for (int i = 0; i < NGLI_MEMTAG_NB; i++) {
+        live[i] = __atomic_load_n(&memory_live[i], __ATOMIC_RELAXED);
+        peak[i] = __atomic_load_n(&memory_peak[i], __ATOMIC_RELAXED);
+    }
+}
+
+struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+};
+
+struct arena {
+    struct arena_block *blocks; // the first one is the block being filled
+    size_t block_size;
+    int tag;
+    int refcount;
+};
+
+#define BLOCK_HEADER_SIZE NGLI_ALIGN(sizeof(struct arena_block), NGLI_ALIGN_VAL)
+
+struct arena *ngli_arena_create(size_t block_size, int tag)
+{
+    struct arena *arena = ngli_calloc(1, sizeof(*arena));
+    if (!arena)
+        return NULL;
+    arena->block_size = block_size;
+    arena->tag = tag;
+    arena->refcount = 1;
+    return arena;
+}
+
+static struct arena_block *new_block(size_t size, int tag)
+{
+    struct arena_block *block = ngli_malloc_tagged(BLOCK_HEADER_SIZE + size, tag);
+    if (!block)
+        return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void *ngli_arena_alloc(struct arena *arena, size_t size)
+{
+    size = NGLI_ALIGN(size, NGLI_ALIGN_VAL);
+
+    struct arena_block *block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        /*
+         * The large allocations get a block of their own, inserted after the
+         * current one so it can keep being filled
+         */
+        if (size > arena->block_size / 4 && block) {
+            struct arena_block *large = new_block(size, arena->tag);
+            if (!large)
+                return NULL;
+            large->used = size;
+            large->next = block->next;
+            block->next = large;
+            return (uint8_t *)large + BLOCK_HEADER_SIZE;
+        }
+
+        block = new_block(NGLI_MAX(size, arena->block_size), arena->tag);
+        if (!block)
+            return NULL;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    void *ptr = (uint8_t *)block + BLOCK_HEADER_SIZE + block->used;
+    block->used += size;
+    return ptr;
+}
+
+void ngli_arena_reset(struct arena *arena)
+{
+    struct arena_block *block = arena->blocks;
+    if (!block)
+        return;
+
+    if (!block->next) {
+        block->used = 0;
+        return;
+    }
+
+    size_t total_size = 0;
+    while (block) {
+        struct arena_block *next = block->next;
+        total_size += block->size;
+        ngli_free_tagged(block);
+        block = next;
+    }
+
+    /* On failure, the next allocation will simply try again */
+    arena->blocks = new_block(total_size, arena->tag);
+}
+
+struct arena *ngli_arena_ref(struct arena *arena)
+{
+    arena->refcount++;
+    return arena;
+}
+
+void ngli_arena_unrefp(struct arena **arenap)
+{
+    struct arena *arena = *arenap;
+    if (!arena)
+        return;
+    if (arena->refcount-- == 1) {
+        struct arena_block *block = arena->blocks;
+        while (block) {
+            struct arena_block *next = block->next;
+            ngli_free_tagged(block);
+            block = next;
+        }
+        ngli_free(arena);
+    }
+    *arenap = NULL;
+}
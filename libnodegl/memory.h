@@ -23,6 +23,7 @@
 #define MEMORY_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 void *ngli_malloc(size_t size);
 void *ngli_calloc(size_t n, size_t size);
@@ -33,4 +34,49 @@ void *ngli_realloc(void *ptr, size_t size);
 void ngli_free(void *ptr);
 void ngli_free_aligned(void *ptr);
 
+/*
+ * Tagged allocations, accounted in the live and peak usage of their
+ * category. The memory is aligned on NGLI_ALIGN_VAL and must be released
+ * with ngli_free_tagged(); it must never be handed over to the API user.
+ */
+enum {
+    NGLI_MEMTAG_NODES,
+    NGLI_MEMTAG_BUFFERS,
+    NGLI_MEMTAG_DRAWING,
+    NGLI_MEMTAG_NB
+};
+
+void *ngli_malloc_tagged(size_t size, int tag);
+void *ngli_calloc_tagged(size_t n, size_t size, int tag);
+void *ngli_realloc_tagged(void *ptr, size_t size, int tag);
+void ngli_free_tagged(void *ptr);
+
+/*
+ * Get the live and peak usage of every category since the start of the
+ * process, in bytes (arrays of NGLI_MEMTAG_NB elements)
+ */
+void ngli_memory_get_usage(int64_t *live, int64_t *peak);
+
+/*
+ * Reference counted arena, from which blocks of memory are allocated
+ * contiguously and only released all at once when the last reference is
+ * dropped. The allocations are aligned on NGLI_ALIGN_VAL, and the blocks are
+ * accounted in the category of the arena.
+ */
+struct arena;
+
+struct arena *ngli_arena_create(size_t block_size, int tag);
+void *ngli_arena_alloc(struct arena *arena, size_t size);
+
+/*
+ * Forget all the allocations of the arena while keeping its memory, so it
+ * can serve as a scratch allocator rewound at a regular interval (typically
+ * every frame). If the allocations did not fit in a single block, the
+ * blocks are merged into one large enough to hold them all next time.
+ */
+void ngli_arena_reset(struct arena *arena);
+
+struct arena *ngli_arena_ref(struct arena *arena);
+void ngli_arena_unrefp(struct arena **arenap);
+
 #endif
@@ -0,0 +1,620 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Micro benchmarks of the core containers, the math kernels, the animations
+ * and the (de)serialization. Each benchmark is calibrated to run for about
+ * SAMPLE_TIME per sample, then sampled NB_SAMPLES times: the median time per
+ * operation is the reference value, the spread of the samples tells how
+ * much it can be trusted.
+ *
+ * Usage: microbench [-o output.json] [filter]
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "animation.h"
+#include "darray.h"
+#include "hmap.h"
+#include "math_utils.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "params.h"
+#include "utils.h"
+
+#define SAMPLE_TIME 20000 /* microseconds */
+#define NB_SAMPLES  11
+#define MAX_RESULTS 128
+
+/* Run at least nb_ops operations and return how many were actually run */
+typedef int64_t (*bench_func_type)(void *arg, int64_t nb_ops);
+
+struct result {
+    char name[64];
+    int64_t nb_ops;     /* per sample */
+    double min;         /* nanoseconds per operation */
+    double median;
+    double mean;
+    double stddev;
+    double bytes_per_op;
+};
+
+static struct result results[MAX_RESULTS];
+static int nb_results;
+static const char *filter;
+
+/* Written by the benchmarks so their computations are never optimized out */
+static volatile uintptr_t sink;
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double da = *(const double *)a;
+    const double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static int64_t time_ops(bench_func_type func, void *arg, int64_t *nb_opsp)
+{
+    const int64_t start = ngli_gettime();
+    *nb_opsp = func(arg, *nb_opsp);
+    return ngli_gettime() - start;
+}
+
+static void bench(const char *name, bench_func_type func, void *arg, double bytes_per_op)
+{
+    if (filter && !strstr(name, filter))
+        return;
+    ngli_assert(nb_results < MAX_RESULTS);
+
+    /* The calibration also warms up the caches and the branch predictors */
+    int64_t nb_ops = 1;
+    while (time_ops(func, arg, &nb_ops) < SAMPLE_TIME / 4)
+        nb_ops *= 2;
+    nb_ops *= 4;
+
+    double samples[NB_SAMPLES];
+    for (int i = 0; i < NB_SAMPLES; i++) {
+        int64_t nb_ops_run = nb_ops;
+        samples[i] = time_ops(func, arg, &nb_ops_run) * 1000. / nb_ops_run;
+    }
+    qsort(samples, NB_SAMPLES, sizeof(*samples), cmp_double);
+
+    struct result *r = &results[nb_results++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->nb_ops = nb_ops;
+    r->min = samples[0];
+    r->median = samples[NB_SAMPLES / 2];
+    r->bytes_per_op = bytes_per_op;
+    for (int i = 0; i < NB_SAMPLES; i++)
+        r->mean += samples[i];
+    r->mean /= NB_SAMPLES;
+    for (int i = 0; i < NB_SAMPLES; i++)
+        r->stddev += (samples[i] - r->mean) * (samples[i] - r->mean);
+    r->stddev = sqrt(r->stddev / (NB_SAMPLES - 1));
+
+    printf("%-40s %12.2fns/op  min %10.2fns  +/- %5.1f%%", r->name, r->median, r->min,
+           r->mean ? r->stddev * 100. / r->mean : 0.);
+    if (bytes_per_op)
+        printf("  %9.1fMB/s", bytes_per_op * 1000. / r->median);
+    printf("\n");
+}
+
+/*
+ * Containers
+ */
+struct container_arg {
+    int size;
+    char **keys;
+    struct darray darray;
+    struct hmap *hmap;
+};
+
+static int64_t bench_darray_push(void *arg, int64_t nb_ops)
+{
+    struct container_arg *s = arg;
+    int64_t i;
+    for (i = 0; i < nb_ops; i += s->size) {
+        ngli_darray_init(&s->darray, sizeof(int), 0);
+        for (int j = 0; j < s->size; j++)
+            ngli_darray_push(&s->darray, &j);
+        sink += ngli_darray_count(&s->darray);
+        ngli_darray_reset(&s->darray);
+    }
+    return i;
+}
+
+static int64_t bench_darray_get(void *arg, int64_t nb_ops)
+{
+    struct container_arg *s = arg;
+    uint32_t index = 0;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        /* Pseudo random accesses, so the whole array is visited */
+        index = index * 1664525 + 1013904223;
+        sink += *(int *)ngli_darray_get(&s->darray, index % s->size);
+    }
+    return nb_ops;
+}
+
+static int64_t bench_hmap_set(void *arg, int64_t nb_ops)
+{
+    struct container_arg *s = arg;
+    int64_t i;
+    for (i = 0; i < nb_ops; i += s->size) {
+        struct hmap *hmap = ngli_hmap_create();
+        ngli_assert(hmap);
+        for (int j = 0; j < s->size; j++)
+            ngli_hmap_set(hmap, s->keys[j], s->keys[j]);
+        sink += ngli_hmap_count(hmap);
+        ngli_hmap_freep(&hmap);
+    }
+    return i;
+}
+
+static int64_t bench_hmap_get(void *arg, int64_t nb_ops)
+{
+    struct container_arg *s = arg;
+    uint32_t index = 0;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        index = index * 1664525 + 1013904223;
+        sink += (uintptr_t)ngli_hmap_get(s->hmap, s->keys[index % s->size]);
+    }
+    return nb_ops;
+}
+
+static void bench_containers(void)
+{
+    static const int sizes[] = {16, 1024, 65536};
+
+    for (int i = 0; i < NGLI_ARRAY_NB(sizes); i++) {
+        struct container_arg s = {.size = sizes[i]};
+        char name[64];
+
+        s.keys = ngli_calloc(s.size, sizeof(*s.keys));
+        ngli_assert(s.keys);
+        for (int j = 0; j < s.size; j++) {
+            s.keys[j] = ngli_asprintf("key_%d", j);
+            ngli_assert(s.keys[j]);
+        }
+
+        snprintf(name, sizeof(name), "darray_push/%d", s.size);
+        bench(name, bench_darray_push, &s, 0);
+
+        ngli_darray_init(&s.darray, sizeof(int), 0);
+        for (int j = 0; j < s.size; j++)
+            ngli_assert(ngli_darray_push(&s.darray, &j));
+        snprintf(name, sizeof(name), "darray_get/%d", s.size);
+        bench(name, bench_darray_get, &s, 0);
+        ngli_darray_reset(&s.darray);
+
+        snprintf(name, sizeof(name), "hmap_set/%d", s.size);
+        bench(name, bench_hmap_set, &s, 0);
+
+        s.hmap = ngli_hmap_create();
+        ngli_assert(s.hmap);
+        for (int j = 0; j < s.size; j++)
+            ngli_assert(ngli_hmap_set(s.hmap, s.keys[j], s.keys[j]) >= 0);
+        snprintf(name, sizeof(name), "hmap_get/%d", s.size);
+        bench(name, bench_hmap_get, &s, 0);
+        ngli_hmap_freep(&s.hmap);
+
+        for (int j = 0; j < s.size; j++)
+            ngli_free(s.keys[j]);
+        ngli_free(s.keys);
+    }
+}
+
+/*
+ * Math kernels: the output of each call is fed back as an input of the next
+ * one so the calls can not be overlapped. The matrix is a rotation so the
+ * values never drift towards infinities or denormals.
+ */
+static const NGLI_ALIGNED_MAT(mat_a) = {
+    0.866025f, 0.5f,      0.0f, 0.0f,
+   -0.5f,      0.866025f, 0.0f, 0.0f,
+    0.0f,      0.0f,      1.0f, 0.0f,
+    0.1f,      0.2f,      0.3f, 1.0f,
+};
+
+static const float quat_a[4] = {0.5f, 0.5f, 0.5f, 0.5f};
+
+static int64_t bench_mat4_mul_c(void *arg, int64_t nb_ops)
+{
+    NGLI_ALIGNED_MAT(out);
+    memcpy(out, mat_a, sizeof(out));
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_mat4_mul_c(out, mat_a, out);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_mat4_mul(void *arg, int64_t nb_ops)
+{
+    NGLI_ALIGNED_MAT(out);
+    memcpy(out, mat_a, sizeof(out));
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_mat4_mul(out, mat_a, out);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_mat4_mul_vec4_c(void *arg, int64_t nb_ops)
+{
+    NGLI_ALIGNED_VEC(out) = {1.0f, 2.0f, 3.0f, 1.0f};
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_mat4_mul_vec4_c(out, mat_a, out);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_mat4_mul_vec4(void *arg, int64_t nb_ops)
+{
+    NGLI_ALIGNED_VEC(out) = {1.0f, 2.0f, 3.0f, 1.0f};
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_mat4_mul_vec4(out, mat_a, out);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_mat3_inverse_c(void *arg, int64_t nb_ops)
+{
+    float out[3*3];
+    ngli_mat3_from_mat4(out, mat_a);
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_mat3_inverse_c(out, out);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_mat3_inverse(void *arg, int64_t nb_ops)
+{
+    float out[3*3];
+    ngli_mat3_from_mat4(out, mat_a);
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_mat3_inverse(out, out);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_quat_slerp_c(void *arg, int64_t nb_ops)
+{
+    float out[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_quat_slerp_c(out, out, quat_a, 0.3f);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static int64_t bench_quat_slerp(void *arg, int64_t nb_ops)
+{
+    float out[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    for (int64_t i = 0; i < nb_ops; i++)
+        ngli_quat_slerp(out, out, quat_a, 0.3f);
+    sink += (uintptr_t)out[0];
+    return nb_ops;
+}
+
+static void bench_math(void)
+{
+    bench("mat4_mul/c",         bench_mat4_mul_c,       NULL, 0);
+    bench("mat4_mul/arch",      bench_mat4_mul,         NULL, 0);
+    bench("mat4_mul_vec4/c",    bench_mat4_mul_vec4_c,  NULL, 0);
+    bench("mat4_mul_vec4/arch", bench_mat4_mul_vec4,    NULL, 0);
+    bench("mat3_inverse/c",     bench_mat3_inverse_c,   NULL, 0);
+    bench("mat3_inverse/arch",  bench_mat3_inverse,     NULL, 0);
+    bench("quat_slerp/c",       bench_quat_slerp_c,     NULL, 0);
+    bench("quat_slerp/arch",    bench_quat_slerp,       NULL, 0);
+}
+
+/*
+ * Animations
+ */
+struct anim_arg {
+    struct ngl_node *anim;
+    int nb_kfs;
+    int random;
+};
+
+static int64_t bench_anim_evaluate(void *arg, int64_t nb_ops)
+{
+    struct anim_arg *s = arg;
+    uint32_t index = 0;
+    float value = 0.f;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        double t;
+        if (s->random) {
+            index = index * 1664525 + 1013904223;
+            t = index % (s->nb_kfs * 16) / 16.;
+        } else {
+            t = i % (s->nb_kfs * 16) / 16.;
+        }
+        ngl_anim_evaluate(s->anim, &value, t);
+    }
+    sink += (uintptr_t)value;
+    return nb_ops;
+}
+
+static void bench_animations(void)
+{
+    static const int nb_kfs[] = {4, 256, 16384};
+
+    for (int i = 0; i < NGLI_ARRAY_NB(nb_kfs); i++) {
+        struct ngl_node *anim = ngl_node_create(NGL_NODE_ANIMATEDFLOAT);
+        ngli_assert(anim);
+        for (int j = 0; j < nb_kfs[i]; j++) {
+            struct ngl_node *kf = ngl_node_create(NGL_NODE_ANIMKEYFRAMEFLOAT, (double)j, (double)(j & 7));
+            ngli_assert(kf);
+            if (j & 1)
+                ngli_assert(ngl_node_param_set(kf, "easing", "exp_in_out") >= 0);
+            ngli_assert(ngl_node_param_add(anim, "keyframes", 1, &kf) >= 0);
+            ngl_node_unrefp(&kf);
+        }
+
+        char name[64];
+        struct anim_arg s = {.anim = anim, .nb_kfs = nb_kfs[i]};
+        snprintf(name, sizeof(name), "anim_evaluate/%d/sequential", nb_kfs[i]);
+        bench(name, bench_anim_evaluate, &s, 0);
+        s.random = 1;
+        snprintf(name, sizeof(name), "anim_evaluate/%d/random", nb_kfs[i]);
+        bench(name, bench_anim_evaluate, &s, 0);
+
+        ngl_node_unrefp(&anim);
+    }
+}
+
+/*
+ * Parameters lookup
+ */
+struct params_arg {
+    const struct ngl_node *node;
+    const char *key;
+};
+
+static int64_t bench_params_find(void *arg, int64_t nb_ops)
+{
+    struct params_arg *s = arg;
+    for (int64_t i = 0; i < nb_ops; i++)
+        sink += (uintptr_t)ngli_params_find(s->node->class->params, s->key);
+    return nb_ops;
+}
+
+static int64_t bench_node_param_find(void *arg, int64_t nb_ops)
+{
+    struct params_arg *s = arg;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        uint8_t *base_ptr;
+        sink += (uintptr_t)ngli_node_param_find(s->node, s->key, &base_ptr);
+    }
+    return nb_ops;
+}
+
+static void bench_params(void)
+{
+    struct ngl_node *geometry = ngl_node_create(NGL_NODE_QUAD);
+    struct ngl_node *render = ngl_node_create(NGL_NODE_RENDER, geometry);
+    ngli_assert(geometry && render);
+
+    /* The first and the last parameters of the class */
+    const struct node_param *params = render->class->params;
+    const struct node_param *last = params;
+    while (last[1].key)
+        last++;
+
+    struct params_arg first_arg = {.node = render, .key = params[0].key};
+    struct params_arg last_arg  = {.node = render, .key = last->key};
+    bench("params_find/first",     bench_params_find,     &first_arg, 0);
+    bench("params_find/last",      bench_params_find,     &last_arg,  0);
+    bench("node_param_find/first", bench_node_param_find, &first_arg, 0);
+    bench("node_param_find/last",  bench_node_param_find, &last_arg,  0);
+
+    ngl_node_unrefp(&render);
+    ngl_node_unrefp(&geometry);
+}
+
+/*
+ * Serialization, on a synthetic scene of nb_renders renders sharing their
+ * program and geometry, each with a transform and its own uniforms
+ */
+static const char *fragment =
+    "void main()\n"
+    "{\n"
+    "    ngl_out_color = color * factor;\n"
+    "}\n";
+
+static struct ngl_node *make_scene(int nb_renders)
+{
+    struct ngl_node *group = ngl_node_create(NGL_NODE_GROUP);
+    struct ngl_node *geometry = ngl_node_create(NGL_NODE_QUAD);
+    struct ngl_node *program = ngl_node_create(NGL_NODE_PROGRAM);
+    ngli_assert(group && geometry && program);
+    ngli_assert(ngl_node_param_set(program, "fragment", fragment) >= 0);
+
+    for (int i = 0; i < nb_renders; i++) {
+        struct ngl_node *render = ngl_node_create(NGL_NODE_RENDER, geometry);
+        struct ngl_node *color = ngl_node_create(NGL_NODE_UNIFORMVEC4);
+        struct ngl_node *factor = ngl_node_create(NGL_NODE_UNIFORMFLOAT);
+        ngli_assert(render && color && factor);
+
+        const float rgba[4] = {i / (float)nb_renders, 0.5f, 0.25f, 1.0f};
+        ngli_assert(ngl_node_param_set(color, "value", rgba) >= 0);
+        ngli_assert(ngl_node_param_set(factor, "value", 1.0 + i) >= 0);
+        ngli_assert(ngl_node_param_set(render, "program", program) >= 0);
+        ngli_assert(ngl_node_param_set(render, "uniforms", "color", color) >= 0);
+        ngli_assert(ngl_node_param_set(render, "uniforms", "factor", factor) >= 0);
+
+        struct ngl_node *translate = ngl_node_create(NGL_NODE_TRANSLATE, render);
+        ngli_assert(translate);
+        const float vector[3] = {i * 0.01f, 0.0f, 0.0f};
+        ngli_assert(ngl_node_param_set(translate, "vector", vector) >= 0);
+        ngli_assert(ngl_node_param_add(group, "children", 1, &translate) >= 0);
+
+        ngl_node_unrefp(&translate);
+        ngl_node_unrefp(&factor);
+        ngl_node_unrefp(&color);
+        ngl_node_unrefp(&render);
+    }
+
+    ngl_node_unrefp(&program);
+    ngl_node_unrefp(&geometry);
+    return group;
+}
+
+struct serialize_arg {
+    struct ngl_node *scene;
+    char *text;
+    void *binary;
+    size_t binary_size;
+};
+
+static int64_t bench_serialize(void *arg, int64_t nb_ops)
+{
+    struct serialize_arg *s = arg;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        char *text = ngl_node_serialize(s->scene);
+        ngli_assert(text);
+        sink += (uintptr_t)text[0];
+        free(text);
+    }
+    return nb_ops;
+}
+
+static int64_t bench_deserialize(void *arg, int64_t nb_ops)
+{
+    struct serialize_arg *s = arg;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        struct ngl_node *scene = ngl_node_deserialize(s->text);
+        ngli_assert(scene);
+        ngl_node_unrefp(&scene);
+    }
+    return nb_ops;
+}
+
+static int64_t bench_serialize_binary(void *arg, int64_t nb_ops)
+{
+    struct serialize_arg *s = arg;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        size_t size;
+        void *data = ngl_node_serialize_binary(s->scene, &size);
+        ngli_assert(data);
+        sink += size;
+        free(data);
+    }
+    return nb_ops;
+}
+
+static int64_t bench_deserialize_binary(void *arg, int64_t nb_ops)
+{
+    struct serialize_arg *s = arg;
+    for (int64_t i = 0; i < nb_ops; i++) {
+        struct ngl_node *scene = ngl_node_deserialize_binary(s->binary, s->binary_size);
+        ngli_assert(scene);
+        ngl_node_unrefp(&scene);
+    }
+    return nb_ops;
+}
+
+static void bench_serialization(void)
+{
+    static const int nb_renders[] = {10, 1000};
+
+    for (int i = 0; i < NGLI_ARRAY_NB(nb_renders); i++) {
+        struct serialize_arg s = {.scene = make_scene(nb_renders[i])};
+        s.text = ngl_node_serialize(s.scene);
+        s.binary = ngl_node_serialize_binary(s.scene, &s.binary_size);
+        ngli_assert(s.text && s.binary);
+
+        char name[64];
+        const double text_size = strlen(s.text);
+        snprintf(name, sizeof(name), "serialize/%d", nb_renders[i]);
+        bench(name, bench_serialize, &s, text_size);
+        snprintf(name, sizeof(name), "deserialize/%d", nb_renders[i]);
+        bench(name, bench_deserialize, &s, text_size);
+        snprintf(name, sizeof(name), "serialize_binary/%d", nb_renders[i]);
+        bench(name, bench_serialize_binary, &s, s.binary_size);
+        snprintf(name, sizeof(name), "deserialize_binary/%d", nb_renders[i]);
+        bench(name, bench_deserialize_binary, &s, s.binary_size);
+
+        free(s.binary);
+        free(s.text);
+        ngl_node_unrefp(&s.scene);
+    }
+}
+
+static int write_json(const char *filename)
+{
+    FILE *fp = strcmp(filename, "-") ? fopen(filename, "w") : stdout;
+    if (!fp) {
+        fprintf(stderr, "unable to open %s\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"sample_time_us\": %d,\n", SAMPLE_TIME);
+    fprintf(fp, "  \"nb_samples\": %d,\n", NB_SAMPLES);
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (int i = 0; i < nb_results; i++) {
+        const struct result *r = &results[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"ops_per_sample\": %" PRId64 ", "
+                "\"median_ns\": %.3f, \"min_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f",
+                r->name, r->nb_ops, r->median, r->min, r->mean, r->stddev);
+        if (r->bytes_per_op)
+            fprintf(fp, ", \"bytes_per_op\": %.0f, \"mb_per_s\": %.3f",
+                    r->bytes_per_op, r->bytes_per_op * 1000. / r->median);
+        fprintf(fp, "}%s\n", i < nb_results - 1 ? "," : "");
+    }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+
+    if (fp != stdout && fclose(fp)) {
+        fprintf(stderr, "unable to write %s\n", filename);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [-o output.json] [filter]\n", argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    ngl_log_set_min_level(NGL_LOG_WARNING);
+
+    bench_containers();
+    bench_math();
+    bench_animations();
+    bench_params();
+    bench_serialization();
+
+    return output ? write_json(output) : 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "log.h"
+#include "multiview.h"
+#include "nodegl.h"
+
+static const char *skip_spaces(const char *p)
+{
+    while (*p && isspace(*p))
+        p++;
+    return p;
+}
+
+/* The view index is only available from GLSL 1.50 and ESSL 3.00 */
+static int has_view_id(const char *src)
+{
+    const char *p = strstr(src, "#version");
+    if (!p)
+        return 0;
+    p = skip_spaces(p + strlen("#version"));
+    const int version = atoi(p);
+    while (isdigit(*p))
+        p++;
+    const int es = version == 100 || !strncmp(skip_spaces(p), "es", 2);
+    return es ? version >= 300 : version >= 150;
+}
+
+/* Same as the insertion point of the texvideo preprocessing */
+static const char *get_insert_point(const char *src)
+{
+    const char *p = src;
+    for (;;) {
+        const char *line = skip_spaces(p);
+        if (strncmp(line, "#version", 8) && strncmp(line, "#extension", 10))
+            return line;
+        const char *eol = strchr(line, '\n');
+        if (!eol)
+            return line + strlen(line);
+        p = eol + 1;
+    }
+}
+
+int ngli_multiview_preprocess(const char *src, int nb_views, char **dstp)
+{
+    *dstp = NULL;
+
+    if (!has_view_id(src)) {
+        LOG(ERROR, "multiview rendering requires a vertex shader of GLSL 1.50 or ESSL 3.00 at least");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NGL_ERROR_MEMORY;
+
+    const char *header_end = get_insert_point(src);
+    ngli_bstr_print(b, "%.*s", (int)(header_end - src), src);
+    ngli_bstr_print(b, "#extension GL_OVR_multiview : require\n"
+                       "layout(num_views = %d) in;\n"
+                       "uniform mat4 ngl_view_matrices[%d];\n"
+                       "#define ngl_view_matrix ngl_view_matrices[int(gl_ViewID_OVR)]\n"
+                       "%s", nb_views, nb_views, header_end);
+
+    *dstp = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return *dstp ? 0 : NGL_ERROR_MEMORY;
+}
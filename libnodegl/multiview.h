@@ -0,0 +1,35 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef MULTIVIEW_H
+#define MULTIVIEW_H
+
+/*
+ * Declare the views of a vertex shader source rendering nb_views views at
+ * once (OVR_multiview): ngl_view_matrices holds the view matrix of each view,
+ * and ngl_view_matrix is the one of the view being rendered, to be applied
+ * between the projection and the modelview matrices.
+ *
+ * On success, *dstp is set to the newly allocated shader source.
+ */
+int ngli_multiview_preprocess(const char *src, int nb_views, char **dstp);
+
+#endif
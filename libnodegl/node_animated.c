@@ -75,48 +75,48 @@ static const struct node_param animatedquat_params[] = {
 };
 
 static void mix_time(void *user_arg, void *dst,
-                     const struct animkeyframe_priv *kf0,
-                     const struct animkeyframe_priv *kf1,
+                     const struct animation_value *v0,
+                     const struct animation_value *v1,
                      double ratio)
 {
     double *dstd = dst;
-    dstd[0] = NGLI_MIX(kf0->scalar, kf1->scalar, ratio);
+    dstd[0] = NGLI_MIX(v0->scalar, v1->scalar, ratio);
 }
 
 static void mix_float(void *user_arg, void *dst,
-                      const struct animkeyframe_priv *kf0,
-                      const struct animkeyframe_priv *kf1,
+                      const struct animation_value *v0,
+                      const struct animation_value *v1,
                       double ratio)
 {
     float *dstd = dst;
-    dstd[0] = NGLI_MIX(kf0->scalar, kf1->scalar, ratio);
+    dstd[0] = NGLI_MIX(v0->scalar, v1->scalar, ratio);
 }
 
 static void mix_quat(void *user_arg, void *dst,
-                     const struct animkeyframe_priv *kf0,
-                     const struct animkeyframe_priv *kf1,
+                     const struct animation_value *v0,
+                     const struct animation_value *v1,
                      double ratio)
 {
-    ngli_quat_slerp(dst, kf0->value, kf1->value, ratio);
+    ngli_quat_slerp(dst, v0->value, v1->value, ratio);
 }
 
 static void mix_vector(void *user_arg, void *dst,
-                       const struct animkeyframe_priv *kf0,
-                       const struct animkeyframe_priv *kf1,
+                       const struct animation_value *v0,
+                       const struct animation_value *v1,
                        double ratio, int len)
 {
     float *dstf = dst;
     for (int i = 0; i < len; i++)
-        dstf[i] = NGLI_MIX(kf0->value[i], kf1->value[i], ratio);
+        dstf[i] = NGLI_MIX(v0->value[i], v1->value[i], ratio);
 }
 
 #define DECLARE_VEC_MIX_FUNC(len)                               \
 static void mix_vec##len(void *user_arg, void *dst,             \
-                         const struct animkeyframe_priv *kf0,   \
-                         const struct animkeyframe_priv *kf1,   \
+                         const struct animation_value *v0,      \
+                         const struct animation_value *v1,      \
                          double ratio)                          \
 {                                                               \
-    return mix_vector(user_arg, dst, kf0, kf1, ratio, len);     \
+    return mix_vector(user_arg, dst, v0, v1, ratio, len);       \
 }
 
 DECLARE_VEC_MIX_FUNC(2)
@@ -124,21 +124,21 @@ DECLARE_VEC_MIX_FUNC(3)
 DECLARE_VEC_MIX_FUNC(4)
 
 static void cpy_time(void *user_arg, void *dst,
-                     const struct animkeyframe_priv *kf)
+                     const struct animation_value *v)
 {
-    memcpy(dst, &kf->scalar, sizeof(kf->scalar));
+    memcpy(dst, &v->scalar, sizeof(v->scalar));
 }
 
 static void cpy_scalar(void *user_arg, void *dst,
-                       const struct animkeyframe_priv *kf)
+                       const struct animation_value *v)
 {
-    *(float *)dst = kf->scalar;  // double → float
+    *(float *)dst = v->scalar;  // double → float
 }
 
 static void cpy_values(void *user_arg, void *dst,
-                       const struct animkeyframe_priv *kf)
+                       const struct animation_value *v)
 {
-    memcpy(dst, kf->value, sizeof(kf->value));
+    memcpy(dst, v->value, sizeof(v->value));
 }
 
 static ngli_animation_mix_func_type get_mix_func(int node_class)
@@ -167,27 +167,28 @@ static ngli_animation_cpy_func_type get_cpy_func(int node_class)
     return NULL;
 }
 
-int ngl_anim_evaluate(struct ngl_node *node, void *dst, double t)
+static int get_eval_size(int node_class)
 {
-    if (node->class->id != NGL_NODE_ANIMATEDFLOAT &&
-        node->class->id != NGL_NODE_ANIMATEDVEC2 &&
-        node->class->id != NGL_NODE_ANIMATEDVEC3 &&
-        node->class->id != NGL_NODE_ANIMATEDVEC4)
-        return NGL_ERROR_INVALID_ARG;
+    switch (node_class) {
+        case NGL_NODE_ANIMATEDTIME:  return sizeof(double);
+        case NGL_NODE_ANIMATEDFLOAT: return sizeof(float);
+        case NGL_NODE_ANIMATEDVEC2:  return sizeof(float) * 2;
+        case NGL_NODE_ANIMATEDVEC3:  return sizeof(float) * 3;
+        case NGL_NODE_ANIMATEDVEC4:  return sizeof(float) * 4;
+    }
+    return 0;
+}
 
+static int init_anim_eval(struct ngl_node *node)
+{
     struct variable_priv *s = node->priv_data;
     if (!s->nb_animkf)
         return NGL_ERROR_INVALID_ARG;
 
-    if (!s->anim_eval.kfs) {
-        int ret = ngli_animation_init(&s->anim_eval, NULL,
-                                      s->animkf, s->nb_animkf,
-                                      get_mix_func(node->class->id),
-                                      get_cpy_func(node->class->id));
-        if (ret < 0)
-            return ret;
-    }
+    if (s->anim_eval.nb_kfs)
+        return 0;
 
+    /* The key frames are compiled by the animation, and need their easings first */
     struct animkeyframe_priv *kf0 = s->animkf[0]->priv_data;
     if (!kf0->function) {
         for (int i = 0; i < s->nb_animkf; i++) {
@@ -197,17 +198,114 @@ int ngl_anim_evaluate(struct ngl_node *node, void *dst, double t)
         }
     }
 
+    return ngli_animation_init(&s->anim_eval, NULL,
+                               s->animkf, s->nb_animkf,
+                               get_mix_func(node->class->id),
+                               get_cpy_func(node->class->id));
+}
+
+int ngl_anim_evaluate(struct ngl_node *node, void *dst, double t)
+{
+    if (node->class->id != NGL_NODE_ANIMATEDFLOAT &&
+        node->class->id != NGL_NODE_ANIMATEDVEC2 &&
+        node->class->id != NGL_NODE_ANIMATEDVEC3 &&
+        node->class->id != NGL_NODE_ANIMATEDVEC4)
+        return NGL_ERROR_INVALID_ARG;
+
+    int ret = init_anim_eval(node);
+    if (ret < 0)
+        return ret;
+
+    struct variable_priv *s = node->priv_data;
     return ngli_animation_evaluate(&s->anim_eval, dst, t);
 }
 
+int ngl_anim_evaluate_batch(struct ngl_node *node, void *dst, const double *times, int nb_times)
+{
+    const int eval_size = get_eval_size(node->class->id);
+    if (!eval_size || nb_times < 0)
+        return NGL_ERROR_INVALID_ARG;
+
+    int ret = init_anim_eval(node);
+    if (ret < 0)
+        return ret;
+
+    struct variable_priv *s = node->priv_data;
+    return ngli_animation_evaluate_batch(&s->anim_eval, dst, eval_size, times, nb_times);
+}
+
+static int is_float_based(const struct ngl_node *node)
+{
+    const int id = node->class->id;
+    return id == NGL_NODE_ANIMATEDFLOAT || id == NGL_NODE_ANIMATEDVEC2 ||
+           id == NGL_NODE_ANIMATEDVEC3  || id == NGL_NODE_ANIMATEDVEC4;
+}
+
+static int is_constant(const struct ngl_node *node)
+{
+    const struct variable_priv *s = node->priv_data;
+    if (!is_float_based(node))
+        return 0;
+    if (!s->nb_animkf)
+        return 0;
+    const struct animkeyframe_priv *kf0 = s->animkf[0]->priv_data;
+    for (int i = 1; i < s->nb_animkf; i++) {
+        const struct animkeyframe_priv *kf = s->animkf[i]->priv_data;
+        if (kf->scalar != kf0->scalar || memcmp(kf->value, kf0->value, sizeof(kf->value)))
+            return 0;
+    }
+    return 1;
+}
+
 static int animation_init(struct ngl_node *node)
 {
     struct variable_priv *s = node->priv_data;
     s->dynamic = 1;
-    return ngli_animation_init(&s->anim, NULL,
-                               s->animkf, s->nb_animkf,
-                               get_mix_func(node->class->id),
-                               get_cpy_func(node->class->id));
+    int ret = ngli_animation_init(&s->anim, NULL,
+                                  s->animkf, s->nb_animkf,
+                                  get_mix_func(node->class->id),
+                                  get_cpy_func(node->class->id));
+    if (ret < 0)
+        return ret;
+
+    /*
+     * An animation whose keyframes all hold the same value is evaluated
+     * once, and then behaves like a plain uniform.
+     */
+    if (node->ctx->config.optimize_graph && is_constant(node)) {
+        ret = ngli_animation_evaluate(&s->anim, s->data, 0);
+        if (ret < 0)
+            return ret;
+        s->dynamic = 0;
+        s->constant = 1;
+        return 0;
+    }
+
+    /* Baked once the whole scene is initialized, see ngli_node_attach_ctx() */
+    const int *bake_rate = node->ctx->config.animation_bake_rate;
+    if (bake_rate[0] > 0 && bake_rate[1] > 0 && is_float_based(node)) {
+        const struct animation_bake bake = {
+            .anim     = &s->anim,
+            .nb_comps = s->data_size / sizeof(float),
+        };
+        if (!ngli_darray_push(&node->ctx->animation_bakes, &bake))
+            return NGL_ERROR_MEMORY;
+    }
+    return 0;
+}
+
+static void animation_uninit(struct ngl_node *node)
+{
+    struct variable_priv *s = node->priv_data;
+    ngli_animation_reset(&s->anim);
+    ngli_animation_reset(&s->anim_eval);
+}
+
+/* The evaluations out of a context may have compiled the key frames */
+static void animation_free(struct ngl_node *node)
+{
+    struct variable_priv *s = node->priv_data;
+    ngli_animation_reset(&s->anim_eval);
 }
 
 #define DECLARE_INIT_FUNC(suffix, class_data, class_data_size, class_data_type) \
@@ -268,7 +366,15 @@ static int animatedquat_init(struct ngl_node *node)
 static int animation_update(struct ngl_node *node, double t)
 {
     struct variable_priv *s = node->priv_data;
-    return ngli_animation_evaluate(&s->anim, s->data, t);
+    if (s->constant)
+        return 0;
+    uint8_t prev[sizeof(s->matrix)];
+    memcpy(prev, s->data, s->data_size);
+    int ret = ngli_animation_evaluate(&s->anim, s->data, t);
+    if (ret < 0)
+        return ret;
+    ngli_node_restrict_next_change(node, ngli_animation_get_next_change(&s->anim, t));
+    return memcmp(prev, s->data, s->data_size) != 0;
 }
 
 #define animatedtime_update  animation_update
@@ -280,21 +386,28 @@ static int animation_update(struct ngl_node *node, double t)
 static int animatedquat_update(struct ngl_node *node, double t)
 {
     struct variable_priv *s = node->priv_data;
+    float prev[4];
+    memcpy(prev, s->vector, sizeof(prev));
     int ret = ngli_animation_evaluate(&s->anim, s->vector, t);
     if (ret < 0)
         return ret;
+    ngli_node_restrict_next_change(node, ngli_animation_get_next_change(&s->anim, t));
     if (s->as_mat4)
         ngli_mat4_rotate_from_quat(s->matrix, s->vector);
-    return 0;
+    return memcmp(prev, s->vector, sizeof(prev)) != 0;
 }
 
 #define DEFINE_ANIMATED_CLASS(class_id, class_name, type)       \
 const struct node_class ngli_animated##type##_class = {         \
     .id        = class_id,                                      \
     .category  = NGLI_NODE_CATEGORY_UNIFORM,                    \
+    .flags     = NGLI_NODE_FLAG_CPU_UPDATE |                    \
+                 NGLI_NODE_FLAG_REPORTS_CHANGES,                \
     .name      = class_name,                                    \
     .init      = animated##type##_init,                         \
     .update    = animated##type##_update,                       \
+    .uninit    = animation_uninit,                              \
+    .free      = animation_free,                                \
     .priv_size = sizeof(struct variable_priv),                  \
     .params    = animated##type##_params,                       \
     .file      = __FILE__,                                      \
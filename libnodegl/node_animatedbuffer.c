@@ -35,28 +35,51 @@ static const struct node_param animatedbuffer_params[] = {
                   .node_types=(const int[]){NGL_NODE_ANIMKEYFRAMEBUFFER, -1},
                   .flags=PARAM_FLAG_DOT_DISPLAY_PACKED,
                   .desc=NGLI_DOCSTRING("key frame buffers to interpolate from")},
+    {"gpu_interpolation", PARAM_TYPE_BOOL, OFFSET(gpu_interpolation), {.i64=0},
+                          .desc=NGLI_DOCSTRING("upload all the key frame buffers once and let the vertex shader "
+                                               "interpolate between them: used as the `<name>` vertex attribute, "
+                                               "the buffer is exposed as the `<name>_kf0` and `<name>_kf1` "
+                                               "attributes along with the `<name>_ratio` float uniform, to be "
+                                               "mixed by the shader; the buffer can then only be used as a vertex attribute")},
     {NULL}
 };
 
 static void mix_buffer(void *user_arg, void *dst,
-                       const struct animkeyframe_priv *kf0,
-                       const struct animkeyframe_priv *kf1,
+                       const struct animation_value *v0,
+                       const struct animation_value *v1,
                        double ratio)
 {
-    float *dstf = dst;
     const struct buffer_priv *s = user_arg;
-    const float *d1 = (const float *)kf0->data;
-    const float *d2 = (const float *)kf1->data;
-    for (int k = 0; k < s->count; k++)
-        for (int i = 0; i < s->data_comp; i++)
-            dstf[k*s->data_comp + i] = NGLI_MIX(d1[k*s->data_comp + i], d2[k*s->data_comp + i], ratio);
+    const float *d1 = (const float *)v0->data;
+    const float *d2 = (const float *)v1->data;
+    ngli_mix_f32(dst, d1, d2, ratio, s->count * s->data_comp);
 }
 
 static void cpy_buffer(void *user_arg, void *dst,
-                       const struct animkeyframe_priv *kf)
+                       const struct animation_value *v)
 {
     const struct buffer_priv *s = user_arg;
-    memcpy(dst, kf->data, s->data_size);
+    memcpy(dst, v->data, s->data_size);
+}
+
+static void mix_pair(void *user_arg, void *dst,
+                     const struct animation_value *v0,
+                     const struct animation_value *v1,
+                     double ratio)
+{
+    struct buffer_priv *s = user_arg;
+    s->kf_pair[0] = s->anim.current_kf;
+    s->kf_pair[1] = s->anim.current_kf + 1;
+    s->kf_ratio = ratio;
+}
+
+static void cpy_pair(void *user_arg, void *dst,
+                     const struct animation_value *v)
+{
+    struct buffer_priv *s = user_arg;
+    const int index = v == s->anim.values ? 0 : s->nb_animkf - 1;
+    s->kf_pair[0] = s->kf_pair[1] = index;
+    s->kf_ratio = 0.f;
 }
 
 static int animatedbuffer_update(struct ngl_node *node, double t)
@@ -65,6 +88,29 @@ static int animatedbuffer_update(struct ngl_node *node, double t)
     return ngli_animation_evaluate(&s->anim, s->data, t);
 }
 
+/*
+ * With the GPU interpolation, the key frames are laid out one after the
+ * other in the data, which is uploaded once: only the pair of key frames
+ * and the ratio between them are evaluated at every update.
+ */
+static int init_gpu_interpolation(struct buffer_priv *s)
+{
+    const int kf_size = s->count * s->data_stride;
+    s->data = ngli_calloc_tagged(s->nb_animkf, kf_size, NGLI_MEMTAG_BUFFERS);
+    if (!s->data)
+        return NGL_ERROR_MEMORY;
+    s->data_size = s->nb_animkf * kf_size;
+
+    for (int i = 0; i < s->nb_animkf; i++) {
+        const struct animkeyframe_priv *kf = s->animkf[i]->priv_data;
+        memcpy(s->data + i * kf_size, kf->data, kf_size);
+    }
+
+    s->dynamic = 0;
+    s->usage = NGLI_BUFFER_USAGE_STATIC;
+    return 0;
+}
+
 static int animatedbuffer_init(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
@@ -76,7 +122,8 @@ static int animatedbuffer_init(struct ngl_node *node)
 
     int ret = ngli_animation_init(&s->anim, s,
                                   s->animkf, s->nb_animkf,
-                                  mix_buffer, cpy_buffer);
+                                  s->gpu_interpolation ? mix_pair : mix_buffer,
+                                  s->gpu_interpolation ? cpy_pair : cpy_buffer);
     if (ret < 0)
         return ret;
 
@@ -102,7 +149,10 @@ static int animatedbuffer_init(struct ngl_node *node)
     if (!s->count)
         return NGL_ERROR_INVALID_ARG;
 
-    s->data = ngli_calloc(s->count, s->data_stride);
+    if (s->gpu_interpolation)
+        return init_gpu_interpolation(s);
+
+    s->data = ngli_calloc_tagged(s->count, s->data_stride, NGLI_MEMTAG_BUFFERS);
     if (!s->data)
         return NGL_ERROR_MEMORY;
     s->data_size = s->count * s->data_stride;
@@ -114,7 +164,8 @@ static void animatedbuffer_uninit(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
 
-    ngli_free(s->data);
+    ngli_animation_reset(&s->anim);
+    ngli_free_tagged(s->data);
     s->data = NULL;
 }
 
@@ -27,6 +27,7 @@
 
 #include "bstr.h"
 #include "log.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "math_utils.h"
@@ -86,6 +87,9 @@ static const struct node_param animkeyframe##id##_params[] = {
                              .desc=NGLI_DOCSTRING("starting offset of the truncation of the easing")},  \
     {"easing_end_offset",    PARAM_TYPE_DBL, OFFSET(offsets[1]), {.dbl=1},                              \
                              .desc=NGLI_DOCSTRING("ending offset of the truncation of the easing")},    \
+    {"easing_lut_size",      PARAM_TYPE_INT, OFFSET(lut_size), {.i64=0},                                \
+                             .desc=NGLI_DOCSTRING("number of samples of the lookup table "              \
+                                                  "approximating the easing, 0 to disable")},           \
     {NULL}                                                                                              \
 }
 
@@ -335,6 +339,8 @@ static const struct {
     [EASING_BACK_OUT_IN]      = {back_out_in,            NULL},
 };
 
+#define MAX_LUT_SIZE (1 << 16)
+
 static int animkeyframe_init(struct ngl_node *node)
 {
     struct animkeyframe_priv *s = node->priv_data;
@@ -378,9 +384,44 @@ static int animkeyframe_init(struct ngl_node *node)
         s->boundaries[1] = s->function(s->offsets[1], s->nb_args, s->args);
     }
 
+    ngli_free(s->lut);
+    s->lut = NULL;
+
+    /*
+     * The lookup table is only used within a rendering context since there
+     * is no uninit outside of it (ngl_anim_evaluate() uses the exact easing)
+     */
+    if (s->lut_size && node->ctx) {
+        if (s->lut_size < 2 || s->lut_size > MAX_LUT_SIZE) {
+            LOG(ERROR, "easing lookup table size must be 0 or in [2,%d]", MAX_LUT_SIZE);
+            return NGL_ERROR_INVALID_ARG;
+        }
+
+        s->lut = ngli_calloc(s->lut_size, sizeof(*s->lut));
+        if (!s->lut)
+            return NGL_ERROR_MEMORY;
+
+        for (int i = 0; i < s->lut_size; i++) {
+            double x = i / (double)(s->lut_size - 1);
+            if (s->scale_boundaries)
+                x = NGLI_MIX(s->offsets[0], s->offsets[1], x);
+            double v = s->function(x, s->nb_args, s->args);
+            if (s->scale_boundaries)
+                v = (v - s->boundaries[0]) / (s->boundaries[1] - s->boundaries[0]);
+            s->lut[i] = v;
+        }
+    }
+
     return 0;
 }
 
+static void animkeyframe_uninit(struct ngl_node *node)
+{
+    struct animkeyframe_priv *s = node->priv_data;
+    ngli_free(s->lut);
+    s->lut = NULL;
+}
+
 static char *animkeyframe_info_str(const struct ngl_node *node)
 {
     const struct animkeyframe_priv *s = node->priv_data;
@@ -469,6 +510,7 @@ const struct node_class ngli_animkeyframe##type##_class = { \
     .id        = class_id,                                  \
     .name      = class_name,                                \
     .init      = animkeyframe_init,                         \
+    .uninit    = animkeyframe_uninit,                       \
     .info_str  = animkeyframe_info_str,                     \
     .priv_size = sizeof(struct animkeyframe_priv),          \
     .params    = animkeyframe##type##_params,               \
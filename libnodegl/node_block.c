@@ -23,22 +23,21 @@
 #include <stddef.h>
 
 #include "buffer.h"
+#include "glcontext.h"
 #include "log.h"
+#include "math_utils.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 
-enum {
-    LAYOUT_STD140,
-    LAYOUT_STD430,
-    NB_LAYOUTS
-};
-
 static const struct param_choices layout_choices = {
     .name = "memory_layout",
     .consts = {
-        {"std140", LAYOUT_STD140, .desc=NGLI_DOCSTRING("standard uniform block memory layout 140")},
-        {"std430", LAYOUT_STD430, .desc=NGLI_DOCSTRING("standard uniform block memory layout 430")},
+        {"std140", NGLI_BLOCK_LAYOUT_STD140, .desc=NGLI_DOCSTRING("standard uniform block memory layout 140")},
+        {"std430", NGLI_BLOCK_LAYOUT_STD430, .desc=NGLI_DOCSTRING("standard uniform block memory layout 430")},
+        {"interleaved", NGLI_BLOCK_LAYOUT_INTERLEAVED,
+                        .desc=NGLI_DOCSTRING("elements of the buffer fields interleaved in a single vertex buffer, "
+                                             "only usable by the fields referenced as vertex attributes")},
         {NULL}
     }
 };
@@ -59,7 +58,33 @@ static const struct param_choices layout_choices = {
                                           NGL_NODE_BUFFERUIVEC2,        \
                                           NGL_NODE_BUFFERUIVEC3,        \
                                           NGL_NODE_BUFFERUIVEC4,        \
-                                          NGL_NODE_BUFFERMAT4
+                                          NGL_NODE_BUFFERMAT4,          \
+                                          NGL_NODE_SKIN,                \
+                                          FIELD_TYPES_VERTEX_BUFFER_LIST
+
+/* Only allowed in interleaved blocks */
+#define FIELD_TYPES_VERTEX_BUFFER_LIST    NGL_NODE_BUFFERHALF,          \
+                                          NGL_NODE_BUFFERHVEC2,         \
+                                          NGL_NODE_BUFFERHVEC3,         \
+                                          NGL_NODE_BUFFERHVEC4,         \
+                                          NGL_NODE_BUFFERBYTE,          \
+                                          NGL_NODE_BUFFERBVEC2,         \
+                                          NGL_NODE_BUFFERBVEC3,         \
+                                          NGL_NODE_BUFFERBVEC4,         \
+                                          NGL_NODE_BUFFERUBYTE,         \
+                                          NGL_NODE_BUFFERUBVEC2,        \
+                                          NGL_NODE_BUFFERUBVEC3,        \
+                                          NGL_NODE_BUFFERUBVEC4,        \
+                                          NGL_NODE_BUFFERSHORT,         \
+                                          NGL_NODE_BUFFERSVEC2,         \
+                                          NGL_NODE_BUFFERSVEC3,         \
+                                          NGL_NODE_BUFFERSVEC4,         \
+                                          NGL_NODE_BUFFERUSHORT,        \
+                                          NGL_NODE_BUFFERUSVEC2,        \
+                                          NGL_NODE_BUFFERUSVEC3,        \
+                                          NGL_NODE_BUFFERUSVEC4,        \
+                                          NGL_NODE_BUFFERPACK10,        \
+                                          NGL_NODE_BUFFERUPACK10
 
 #define FIELD_TYPES_UNIFORMS_LIST         NGL_NODE_UNIFORMFLOAT,        \
                                           NGL_NODE_UNIFORMVEC2,         \
@@ -73,7 +98,13 @@ static const struct param_choices layout_choices = {
                                           NGL_NODE_STREAMEDVEC2,        \
                                           NGL_NODE_STREAMEDVEC3,        \
                                           NGL_NODE_STREAMEDVEC4,        \
-                                          NGL_NODE_STREAMEDMAT4
+                                          NGL_NODE_STREAMEDMAT4,        \
+                                          NGL_NODE_STREAMEDFILEINT,     \
+                                          NGL_NODE_STREAMEDFILEFLOAT,   \
+                                          NGL_NODE_STREAMEDFILEVEC2,    \
+                                          NGL_NODE_STREAMEDFILEVEC3,    \
+                                          NGL_NODE_STREAMEDFILEVEC4,    \
+                                          NGL_NODE_STREAMEDFILEMAT4
 
 #define FIELD_TYPES_LIST (const int[]){FIELD_TYPES_BUFFER_LIST, FIELD_TYPES_UNIFORMS_LIST, -1}
 
@@ -82,12 +113,74 @@ static const struct node_param block_params[] = {
     {"fields", PARAM_TYPE_NODELIST, OFFSET(fields),
                .node_types=FIELD_TYPES_LIST,
                .desc=NGLI_DOCSTRING("block fields defined in the graphic program")},
-    {"layout", PARAM_TYPE_SELECT, OFFSET(layout), {.i64=LAYOUT_STD140},
+    {"layout", PARAM_TYPE_SELECT, OFFSET(layout), {.i64=NGLI_BLOCK_LAYOUT_STD140},
                .choices=&layout_choices,
                .desc=NGLI_DOCSTRING("memory layout set in the graphic program")},
     {NULL}
 };
 
+/*
+ * Copy the block content into dst, the direct fields being taken from their
+ * own data
+ */
+static void write_block_data(const struct block_priv *s, uint8_t *dst)
+{
+    int pos = 0;
+    for (int i = 0; i < s->nb_fields; i++) {
+        const struct block_field_info *fi = &s->field_info[i];
+        if (!fi->direct)
+            continue;
+        const struct buffer_priv *buffer = s->fields[i]->priv_data;
+        memcpy(dst + pos, s->data + pos, fi->offset - pos);
+        memcpy(dst + fi->offset, buffer->data, fi->size);
+        pos = fi->offset + fi->size;
+    }
+    memcpy(dst + pos, s->data + pos, s->data_size - pos);
+}
+
+static int upload_block_data(struct ngl_node *node, int forced)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct block_priv *s = node->priv_data;
+
+    /* A new region of a persistently mapped buffer needs the whole content */
+    if (s->buffer.persistent) {
+        write_block_data(s, ngli_buffer_renew(&s->buffer));
+        ctx->stats.uploaded_bytes += s->data_size;
+        return 0;
+    }
+
+    int start = 0, end = 0;
+    if (forced) {
+        end = s->data_size;
+        int ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+        if (ret < 0)
+            return ret;
+    } else if (s->has_changed) {
+        start = s->changed_start;
+        end = s->changed_end;
+        int ret = ngli_buffer_upload_range(&s->buffer, s->data, start, end - start);
+        if (ret < 0)
+            return ret;
+    }
+
+    /* The direct fields changed or overwritten by the stale block data */
+    for (int i = 0; i < s->nb_fields; i++) {
+        const struct block_field_info *fi = &s->field_info[i];
+        if (!fi->direct)
+            continue;
+        const struct buffer_priv *buffer = s->fields[i]->priv_data;
+        const int overwritten = fi->offset < end && fi->offset + fi->size > start;
+        if (!overwritten && !buffer->dynamic)
+            continue;
+        int ret = ngli_buffer_upload_at(&s->buffer, buffer->data, fi->offset, fi->size);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 int ngli_node_block_ref(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -98,10 +191,12 @@ int ngli_node_block_ref(struct ngl_node *node)
         if (ret < 0)
             return ret;
 
-        ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+        ret = upload_block_data(node, 1);
         if (ret < 0)
             return ret;
 
+        ngli_glcontext_set_object_label(ctx->glcontext, GL_BUFFER, s->buffer.id, node->label);
+
         s->buffer_last_upload_time = -1.;
     }
 
@@ -121,12 +216,13 @@ int ngli_node_block_upload(struct ngl_node *node)
 {
     struct block_priv *s = node->priv_data;
 
-    if (s->has_changed && s->buffer_last_upload_time != node->last_update_time) {
-        int ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+    if ((s->has_changed || s->direct_changed) && s->buffer_last_upload_time != node->last_update_time) {
+        int ret = upload_block_data(node, 0);
         if (ret < 0)
             return ret;
         s->buffer_last_upload_time = node->last_update_time;
         s->has_changed = 0;
+        s->direct_changed = 0;
     }
 
     return 0;
@@ -136,22 +232,23 @@ static int get_buffer_stride(const struct ngl_node *node, int layout)
 {
     switch (node->class->id) {
         case NGL_NODE_ANIMATEDBUFFERFLOAT:
-        case NGL_NODE_BUFFERFLOAT:          return sizeof(float) * (layout == LAYOUT_STD140 ? 4 : 1);
+        case NGL_NODE_BUFFERFLOAT:          return sizeof(float) * (layout == NGLI_BLOCK_LAYOUT_STD140 ? 4 : 1);
         case NGL_NODE_ANIMATEDBUFFERVEC2:
-        case NGL_NODE_BUFFERVEC2:           return sizeof(float) * (layout == LAYOUT_STD140 ? 4 : 2);
+        case NGL_NODE_BUFFERVEC2:           return sizeof(float) * (layout == NGLI_BLOCK_LAYOUT_STD140 ? 4 : 2);
         case NGL_NODE_ANIMATEDBUFFERVEC3:
         case NGL_NODE_BUFFERVEC3:
         case NGL_NODE_ANIMATEDBUFFERVEC4:
         case NGL_NODE_BUFFERVEC4:           return sizeof(float) * 4;
         case NGL_NODE_BUFFERINT:
-        case NGL_NODE_BUFFERUINT:           return sizeof(int) * (layout == LAYOUT_STD140 ? 4 : 1);
+        case NGL_NODE_BUFFERUINT:           return sizeof(int) * (layout == NGLI_BLOCK_LAYOUT_STD140 ? 4 : 1);
         case NGL_NODE_BUFFERIVEC2:
-        case NGL_NODE_BUFFERUIVEC2:         return sizeof(int) * (layout == LAYOUT_STD140 ? 4 : 2);
+        case NGL_NODE_BUFFERUIVEC2:         return sizeof(int) * (layout == NGLI_BLOCK_LAYOUT_STD140 ? 4 : 2);
         case NGL_NODE_BUFFERIVEC3:
         case NGL_NODE_BUFFERUIVEC3:
         case NGL_NODE_BUFFERIVEC4:
         case NGL_NODE_BUFFERUIVEC4:         return sizeof(int) * 4;
-        case NGL_NODE_BUFFERMAT4:           return sizeof(float) * 4 * 4;
+        case NGL_NODE_BUFFERMAT4:
+        case NGL_NODE_SKIN:                 return sizeof(float) * 4 * 4;
     }
     return 0;
 }
@@ -172,16 +269,22 @@ static int get_node_size(const struct ngl_node *node, int layout)
 {
     switch (node->class->id) {
         case NGL_NODE_STREAMEDFLOAT:
+        case NGL_NODE_STREAMEDFILEFLOAT:
         case NGL_NODE_UNIFORMFLOAT:         return sizeof(float) * 1;
         case NGL_NODE_STREAMEDVEC2:
+        case NGL_NODE_STREAMEDFILEVEC2:
         case NGL_NODE_UNIFORMVEC2:          return sizeof(float) * 2;
         case NGL_NODE_STREAMEDVEC3:
+        case NGL_NODE_STREAMEDFILEVEC3:
         case NGL_NODE_UNIFORMVEC3:          return sizeof(float) * 3;
         case NGL_NODE_STREAMEDVEC4:
+        case NGL_NODE_STREAMEDFILEVEC4:
         case NGL_NODE_UNIFORMVEC4:          return sizeof(float) * 4;
         case NGL_NODE_STREAMEDMAT4:
+        case NGL_NODE_STREAMEDFILEMAT4:
         case NGL_NODE_UNIFORMMAT4:          return sizeof(float) * 4 * 4;
         case NGL_NODE_STREAMEDINT:
+        case NGL_NODE_STREAMEDFILEINT:
         case NGL_NODE_UNIFORMINT:           return sizeof(int);
         case NGL_NODE_UNIFORMQUAT:          return get_quat_size(node, layout);
         default:                            return get_buffer_size(node, layout);
@@ -192,18 +295,25 @@ static int get_node_align(const struct ngl_node *node, int layout)
 {
     switch (node->class->id) {
         case NGL_NODE_STREAMEDFLOAT:
+        case NGL_NODE_STREAMEDFILEFLOAT:
         case NGL_NODE_UNIFORMFLOAT:         return sizeof(float) * 1;
         case NGL_NODE_STREAMEDVEC2:
+        case NGL_NODE_STREAMEDFILEVEC2:
         case NGL_NODE_UNIFORMVEC2:          return sizeof(float) * 2;
         case NGL_NODE_STREAMEDVEC3:
+        case NGL_NODE_STREAMEDFILEVEC3:
         case NGL_NODE_UNIFORMVEC3:
         case NGL_NODE_STREAMEDVEC4:
+        case NGL_NODE_STREAMEDFILEVEC4:
         case NGL_NODE_UNIFORMVEC4:
         case NGL_NODE_STREAMEDMAT4:
+        case NGL_NODE_STREAMEDFILEMAT4:
         case NGL_NODE_UNIFORMMAT4:
         case NGL_NODE_UNIFORMQUAT:
-        case NGL_NODE_BUFFERMAT4:           return sizeof(float) * 4;
+        case NGL_NODE_BUFFERMAT4:
+        case NGL_NODE_SKIN:                 return sizeof(float) * 4;
         case NGL_NODE_STREAMEDINT:
+        case NGL_NODE_STREAMEDFILEINT:
         case NGL_NODE_UNIFORMINT:           return sizeof(int);
         default:                            return get_buffer_stride(node, layout);
     }
@@ -237,6 +347,8 @@ static void update_buffer_field(uint8_t *dst,
     const struct buffer_priv *buffer = node->priv_data;
     if (buffer->data_stride == fi->stride)
         memcpy(dst, buffer->data, fi->size);
+    else if (fi->stride == 16 && buffer->data_stride % 4 == 0)
+        ngli_pad_vec4(dst, buffer->data, buffer->data_stride, buffer->count);
     else
         for (int i = 0; i < buffer->count; i++)
             memcpy(dst + i * fi->stride, buffer->data + i * buffer->data_stride, buffer->data_stride);
@@ -259,36 +371,26 @@ static void update_block_data(struct block_priv *s, int forced)
         const struct block_field_info *fi = &s->field_info[i];
         if (!forced && !field_funcs[fi->is_array ? IS_ARRAY : IS_SINGLE].has_changed(field_node))
             continue;
+        if (fi->direct) {
+            s->direct_changed = 1;
+            continue;
+        }
         field_funcs[fi->is_array ? IS_ARRAY : IS_SINGLE].update_data(s->data + fi->offset, field_node, fi);
-        s->has_changed = 1; // TODO: only re-upload the changing data segments
+        if (!s->has_changed) {
+            s->changed_start = fi->offset;
+            s->changed_end = fi->offset + fi->size;
+        } else {
+            s->changed_start = NGLI_MIN(s->changed_start, fi->offset);
+            s->changed_end = NGLI_MAX(s->changed_end, fi->offset + fi->size);
+        }
+        s->has_changed = 1;
     }
 }
 
-#define FEATURES_STD140 (NGLI_FEATURE_UNIFORM_BUFFER_OBJECT | NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT)
-#define FEATURES_STD430 (NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT)
-
-static int block_init(struct ngl_node *node)
+static int init_std_fields(struct ngl_node *node)
 {
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct block_priv *s = node->priv_data;
 
-    if (s->layout == LAYOUT_STD140 && !(gl->features & FEATURES_STD140)) {
-        LOG(ERROR, "std140 blocks are not supported by this context");
-        return NGL_ERROR_UNSUPPORTED;
-    }
-
-    if (s->layout == LAYOUT_STD430 && !(gl->features & FEATURES_STD430)) {
-        LOG(ERROR, "std430 blocks are not supported by this context");
-        return NGL_ERROR_UNSUPPORTED;
-    }
-
-    s->field_info = ngli_calloc(s->nb_fields, sizeof(*s->field_info));
-    if (!s->field_info)
-        return NGL_ERROR_MEMORY;
-
-    s->usage = NGLI_BUFFER_USAGE_STATIC;
-
     s->data_size = 0;
     for (int i = 0; i < s->nb_fields; i++) {
         const struct ngl_node *field_node = s->fields[i];
@@ -296,7 +398,10 @@ static int block_init(struct ngl_node *node)
         const int size   = get_node_size(field_node, s->layout);
         const int align  = get_node_align(field_node, s->layout);
 
-        ngli_assert(align);
+        if (!align) {
+            LOG(ERROR, "%s can only be used in interleaved blocks", field_node->class->name);
+            return NGL_ERROR_INVALID_ARG;
+        }
 
         const int remain = s->data_size % align;
         const int offset = s->data_size + (remain ? align - remain : 0);
@@ -309,14 +414,127 @@ static int block_init(struct ngl_node *node)
         fi->size    = size;
         fi->stride  = get_buffer_stride(field_node, s->layout);
         fi->offset  = offset;
+        if (is_array) {
+            const struct buffer_priv *buffer = field_node->priv_data;
+            fi->direct = fi->size && fi->stride == buffer->data_stride;
+        }
 
         s->data_size = offset + fi->size;
         LOG(DEBUG, "%s.field[%d]: %s offset=%d size=%d stride=%d",
             node->label, i, field_node->label, fi->offset, fi->size, fi->stride);
     }
 
+    return 0;
+}
+
+/*
+ * The elements of all the fields are packed one after the other (aligned on
+ * 4 bytes as recommended for vertex attributes), so every element shares the
+ * same stride and each field only differs in its offset
+ */
+static int init_interleaved_fields(struct ngl_node *node)
+{
+    struct block_priv *s = node->priv_data;
+
+    int count = 0;
+    int stride = 0;
+    for (int i = 0; i < s->nb_fields; i++) {
+        const struct ngl_node *field_node = s->fields[i];
+        if (field_node->class->category != NGLI_NODE_CATEGORY_BUFFER ||
+            field_node->class->id == NGL_NODE_BUFFERMAT4 ||
+            field_node->class->id == NGL_NODE_SKIN) {
+            LOG(ERROR, "%s can not be used in interleaved blocks", field_node->class->name);
+            return NGL_ERROR_INVALID_ARG;
+        }
+
+        const struct buffer_priv *buffer = field_node->priv_data;
+        if (i && buffer->count != count) {
+            LOG(ERROR, "%s.field[%d] count (%d) does not match the count of the other fields (%d)",
+                node->label, i, buffer->count, count);
+            return NGL_ERROR_INVALID_ARG;
+        }
+        count = buffer->count;
+
+        if (has_changed_buffer(field_node))
+            s->usage = NGLI_BUFFER_USAGE_DYNAMIC;
+
+        struct block_field_info *fi = &s->field_info[i];
+        fi->is_array = 1;
+        fi->offset  = stride;
+        stride += NGLI_ALIGN(buffer->data_stride, 4);
+    }
+
+    for (int i = 0; i < s->nb_fields; i++) {
+        const struct buffer_priv *buffer = s->fields[i]->priv_data;
+        struct block_field_info *fi = &s->field_info[i];
+        fi->stride = stride;
+        fi->size   = (count - 1) * stride + buffer->data_stride;
+        fi->direct = count && stride == buffer->data_stride;
+        LOG(DEBUG, "%s.field[%d]: %s offset=%d size=%d stride=%d",
+            node->label, i, s->fields[i]->label, fi->offset, fi->size, fi->stride);
+    }
+
+    s->data_size = count * stride;
+    return 0;
+}
+
+#define FEATURES_STD140 (NGLI_FEATURE_UNIFORM_BUFFER_OBJECT | NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT)
+#define FEATURES_STD430 (NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT)
+
+static int block_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct block_priv *s = node->priv_data;
+
+    if (s->layout == NGLI_BLOCK_LAYOUT_STD140 && !(gl->features & FEATURES_STD140)) {
+        LOG(ERROR, "std140 blocks are not supported by this context");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    if (s->layout == NGLI_BLOCK_LAYOUT_STD430 && !(gl->features & FEATURES_STD430)) {
+        LOG(ERROR, "std430 blocks are not supported by this context");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    for (int i = 0; i < s->nb_fields; i++) {
+        const struct ngl_node *field_node = s->fields[i];
+        if (field_node->class->category == NGLI_NODE_CATEGORY_UNIFORM) {
+            const struct variable_priv *variable = field_node->priv_data;
+            if (variable->gpu_lookup) {
+                LOG(ERROR, "stream %s looked up on the GPU can not be used as a block field",
+                    field_node->label);
+                return NGL_ERROR_INVALID_USAGE;
+            }
+            continue;
+        }
+        if (field_node->class->category != NGLI_NODE_CATEGORY_BUFFER)
+            continue;
+        const struct buffer_priv *buffer = field_node->priv_data;
+        if (buffer->gpu_interpolation) {
+            LOG(ERROR, "buffer %s interpolated on the GPU can not be used as a block field",
+                field_node->label);
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        if (buffer->gpu_only) {
+            LOG(ERROR, "GPU-only buffer %s can not be used as a block field", field_node->label);
+            return NGL_ERROR_INVALID_USAGE;
+        }
+    }
+
+    s->field_info = ngli_calloc(s->nb_fields, sizeof(*s->field_info));
+    if (!s->field_info)
+        return NGL_ERROR_MEMORY;
+
+    s->usage = NGLI_BUFFER_USAGE_STATIC;
+
+    int ret = s->layout == NGLI_BLOCK_LAYOUT_INTERLEAVED ? init_interleaved_fields(node)
+                                                         : init_std_fields(node);
+    if (ret < 0)
+        return ret;
+
     LOG(DEBUG, "total %s size: %d", node->label, s->data_size);
-    s->data = ngli_calloc(1, s->data_size);
+    s->data = ngli_calloc_tagged(1, s->data_size, NGLI_MEMTAG_BUFFERS);
     if (!s->data)
         return NGL_ERROR_MEMORY;
 
@@ -344,12 +562,13 @@ static void block_uninit(struct ngl_node *node)
     struct block_priv *s = node->priv_data;
 
     ngli_free(s->field_info);
-    ngli_free(s->data);
+    ngli_free_tagged(s->data);
 }
 
 const struct node_class ngli_block_class = {
     .id        = NGL_NODE_BLOCK,
     .category  = NGLI_NODE_CATEGORY_BLOCK,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "Block",
     .init      = block_init,
     .update    = block_update,
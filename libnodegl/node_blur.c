@@ -0,0 +1,618 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "format.h"
+#include "gctx.h"
+#include "glcontext.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "pass.h"
+#include "pipeline.h"
+#include "program.h"
+#include "rendertarget.h"
+#include "texture.h"
+#include "topology.h"
+#include "tracemarker.h"
+#include "type.h"
+#include "utils.h"
+
+#define MAX_LEVELS 8
+#define MAX_RADIUS 32  /* Gaussian taps on each side, in texels of the blurred level */
+#define TILE_SIZE 128  /* texels written by a compute work group */
+
+#define VERTEX_DATA                                                              \
+    "#version 100"                                                          "\n" \
+    "precision highp float;"                                                "\n" \
+    "attribute vec4 position;"                                              "\n" \
+    "varying vec2 tex_coord;"                                               "\n" \
+    "void main()"                                                           "\n" \
+    "{"                                                                     "\n" \
+    "    gl_Position = vec4(position.xy, 0.0, 1.0);"                        "\n" \
+    "    tex_coord = position.zw;"                                          "\n" \
+    "}"
+
+/* Dual filter: the center and the 4 diagonal neighbours of the source texel */
+#define DOWN_FRAGMENT_DATA                                                       \
+    "#version 100"                                                          "\n" \
+    "precision highp float;"                                                "\n" \
+    "uniform sampler2D src;"                                                "\n" \
+    "uniform vec2 half_texel;"                                              "\n" \
+    "varying vec2 tex_coord;"                                               "\n" \
+    "void main(void)"                                                       "\n" \
+    "{"                                                                     "\n" \
+    "    vec2 h = half_texel;"                                              "\n" \
+    "    vec4 sum = texture2D(src, tex_coord) * 4.0;"                       "\n" \
+    "    sum += texture2D(src, tex_coord - h);"                             "\n" \
+    "    sum += texture2D(src, tex_coord + h);"                             "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(h.x, -h.y));"               "\n" \
+    "    sum += texture2D(src, tex_coord - vec2(h.x, -h.y));"               "\n" \
+    "    gl_FragColor = sum / 8.0;"                                         "\n" \
+    "}"
+
+/* Dual filter: a tent over the 8 neighbours of the source texel */
+#define UP_FRAGMENT_DATA                                                         \
+    "#version 100"                                                          "\n" \
+    "precision highp float;"                                                "\n" \
+    "uniform sampler2D src;"                                                "\n" \
+    "uniform vec2 half_texel;"                                              "\n" \
+    "varying vec2 tex_coord;"                                               "\n" \
+    "void main(void)"                                                       "\n" \
+    "{"                                                                     "\n" \
+    "    vec2 h = half_texel;"                                              "\n" \
+    "    vec4 sum = texture2D(src, tex_coord + vec2(-h.x * 2.0, 0.0));"     "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(0.0, h.y * 2.0));"          "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(h.x * 2.0, 0.0));"          "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(0.0, -h.y * 2.0));"         "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(-h.x, h.y)) * 2.0;"         "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(h.x, h.y)) * 2.0;"          "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(h.x, -h.y)) * 2.0;"         "\n" \
+    "    sum += texture2D(src, tex_coord + vec2(-h.x, -h.y)) * 2.0;"        "\n" \
+    "    gl_FragColor = sum / 12.0;"                                        "\n" \
+    "}"
+
+/* Fallback of the separable Gaussian pass, one direction per draw */
+#define BLUR_FRAGMENT_DATA                                                       \
+    "#version 100"                                                          "\n" \
+    "#define MAX_RADIUS %d"                                                 "\n" \
+    "precision highp float;"                                                "\n" \
+    "uniform sampler2D src;"                                                "\n" \
+    "uniform vec2 direction;"                                               "\n" \
+    "uniform int radius;"                                                   "\n" \
+    "uniform float sigma;"                                                  "\n" \
+    "varying vec2 tex_coord;"                                               "\n" \
+    "void main(void)"                                                       "\n" \
+    "{"                                                                     "\n" \
+    "    vec4 sum = texture2D(src, tex_coord);"                             "\n" \
+    "    float weights = 1.0;"                                              "\n" \
+    "    for (int i = 1; i <= MAX_RADIUS; i++) {"                           "\n" \
+    "        if (i > radius)"                                               "\n" \
+    "            break;"                                                    "\n" \
+    "        float w = exp(-float(i * i) / (2.0 * sigma * sigma));"         "\n" \
+    "        vec2 offset = direction * float(i);"                           "\n" \
+    "        sum += (texture2D(src, tex_coord - offset) +"                  "\n" \
+    "                texture2D(src, tex_coord + offset)) * w;"              "\n" \
+    "        weights += 2.0 * w;"                                           "\n" \
+    "    }"                                                                 "\n" \
+    "    gl_FragColor = sum / weights;"                                     "\n" \
+    "}"
+
+/*
+ * Separable Gaussian pass: each work group loads a line segment of the
+ * source and its apron in shared memory once, instead of fetching every
+ * tap from the texture. The source is sampled at the texel centers of the
+ * destination, so it may have any size.
+ */
+static const char blur_compute_data[] =
+    "#version %s\n"
+    "#define TILE_SIZE %d\n"
+    "#define MAX_RADIUS %d\n"
+    "precision highp float;\n"
+    "layout(local_size_x = TILE_SIZE) in;\n"
+    "uniform highp sampler2D src;\n"
+    "layout(%s, binding = 0) writeonly uniform highp image2D dst;\n"
+    "uniform vec2 direction;\n"
+    "uniform int radius;\n"
+    "uniform float sigma;\n"
+    "shared vec4 line[TILE_SIZE + 2 * MAX_RADIUS];\n"
+    "\n"
+    "void main(void)\n"
+    "{\n"
+    "    ivec2 size = imageSize(dst);\n"
+    "    ivec2 along = ivec2(direction);\n"
+    "    ivec2 across = ivec2(1) - along;\n"
+    "    int len = along.x * size.x + along.y * size.y;\n"
+    "    int start = int(gl_WorkGroupID.x) * TILE_SIZE;\n"
+    "    int lid = int(gl_LocalInvocationID.x);\n"
+    "    ivec2 origin = across * int(gl_WorkGroupID.y);\n"
+    "\n"
+    "    for (int i = lid; i < TILE_SIZE + 2 * MAX_RADIUS; i += TILE_SIZE) {\n"
+    "        int pos = clamp(start + i - MAX_RADIUS, 0, len - 1);\n"
+    "        vec2 coord = (vec2(origin + along * pos) + 0.5) / vec2(size);\n"
+    "        line[i] = textureLod(src, coord, 0.0);\n"
+    "    }\n"
+    "    memoryBarrierShared();\n"
+    "    barrier();\n"
+    "\n"
+    "    int pos = start + lid;\n"
+    "    if (pos >= len)\n"
+    "        return;\n"
+    "    int center = lid + MAX_RADIUS;\n"
+    "    vec4 sum = line[center];\n"
+    "    float weights = 1.0;\n"
+    "    for (int i = 1; i <= radius; i++) {\n"
+    "        float w = exp(-float(i * i) / (2.0 * sigma * sigma));\n"
+    "        sum += (line[center - i] + line[center + i]) * w;\n"
+    "        weights += 2.0 * w;\n"
+    "    }\n"
+    "    imageStore(dst, origin + along * pos, sum / weights);\n"
+    "}\n";
+
+struct blur_pass {
+    struct program program;
+    struct pipeline pipeline;
+    int src_index;
+    int half_texel_index;
+    int direction_index;
+    int radius_index;
+    int sigma_index;
+};
+
+/*
+ * The source is halved nb_levels times with the dual filter, the smallest
+ * level is blurred with the separable Gaussian, then upsampled back up to
+ * the destination: most of the blur happens at a fraction of the
+ * resolution, for a cost barely depending on the radius.
+ */
+struct blur_priv {
+    struct ngl_node *source;
+    struct ngl_node *destination;
+    double radius;
+    int nb_levels;
+
+    int use_compute;
+    struct texture levels[MAX_LEVELS + 1]; /* levels[0] is unused, level_rts[0] targets the destination */
+    struct rendertarget level_rts[MAX_LEVELS + 1];
+    struct texture tmp;
+    struct rendertarget tmp_rt;
+    struct buffer vertices;
+    struct blur_pass down;
+    struct blur_pass up;
+    struct blur_pass blur_h;
+    struct blur_pass blur_v;
+};
+
+#define OFFSET(x) offsetof(struct blur_priv, x)
+static const struct node_param blur_params[] = {
+    {"source", PARAM_TYPE_NODE, OFFSET(source), .flags=PARAM_FLAG_CONSTRUCTOR,
+               .node_types=(const int[]){NGL_NODE_TEXTURE2D, -1},
+               .desc=NGLI_DOCSTRING("texture to blur")},
+    {"destination", PARAM_TYPE_NODE, OFFSET(destination), .flags=PARAM_FLAG_CONSTRUCTOR,
+                    .node_types=(const int[]){NGL_NODE_TEXTURE2D, -1},
+                    .desc=NGLI_DOCSTRING("texture receiving the blurred source")},
+    {"radius", PARAM_TYPE_DBL, OFFSET(radius), {.dbl=8.0},
+               .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+               .desc=NGLI_DOCSTRING("radius of the Gaussian kernel in pixels of the destination")},
+    {"levels", PARAM_TYPE_INT, OFFSET(nb_levels), {.i64=2},
+               .desc=NGLI_DOCSTRING("number of times the source is halved before the Gaussian blur, "
+                                    "each level also widening the blur")},
+    {NULL}
+};
+
+static int blur_init(struct ngl_node *node)
+{
+    struct blur_priv *s = node->priv_data;
+
+    const struct texture_priv *dst_priv = s->destination->priv_data;
+    if (dst_priv->data_src) {
+        LOG(ERROR, "the destination texture cannot have a data source");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (s->destination == s->source) {
+        LOG(ERROR, "the source and destination textures must differ");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    /* The passes sample the first plane of the source with a sampler2D */
+    struct texture_priv *src_priv = s->source->priv_data;
+    src_priv->supported_image_layouts &= 1 << NGLI_IMAGE_LAYOUT_DEFAULT;
+
+    if (s->nb_levels < 0 || s->nb_levels > MAX_LEVELS) {
+        LOG(ERROR, "the number of levels (%d) must be in [0,%d]", s->nb_levels, MAX_LEVELS);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    return 0;
+}
+
+static const char *get_image_format(int format)
+{
+    switch (format) {
+    case NGLI_FORMAT_R8G8B8A8_UNORM:      return "rgba8";
+    case NGLI_FORMAT_R16G16B16A16_SFLOAT: return "rgba16f";
+    case NGLI_FORMAT_R32G32B32A32_SFLOAT: return "rgba32f";
+    default:                              return NULL;
+    }
+}
+
+static int init_target(struct ngl_node *node, struct texture *texture, struct rendertarget *rt,
+                       const struct texture_params *dst_params, int width, int height)
+{
+    struct ngl_ctx *ctx = node->ctx;
+
+    if (dst_params) {
+        struct texture_params params = NGLI_TEXTURE_PARAM_DEFAULTS;
+        params.format = dst_params->format;
+        params.width = width;
+        params.height = height;
+        params.min_filter = NGLI_FILTER_LINEAR;
+        params.mag_filter = NGLI_FILTER_LINEAR;
+        params.wrap_s = NGLI_WRAP_CLAMP_TO_EDGE;
+        params.wrap_t = NGLI_WRAP_CLAMP_TO_EDGE;
+        params.access = NGLI_ACCESS_READ_WRITE;
+        int ret = ngli_texture_init(texture, ctx, &params);
+        if (ret < 0)
+            return ret;
+    }
+
+    const struct texture *attachment = texture;
+    struct rendertarget_params rt_params = {
+        .width = texture->params.width,
+        .height = texture->params.height,
+        .nb_attachments = 1,
+        .attachments = &attachment,
+    };
+    return ngli_rendertarget_init(rt, ctx, &rt_params);
+}
+
+static int init_fragment_pass(struct ngl_node *node, struct blur_pass *pass, const char *fragment)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct blur_priv *s = node->priv_data;
+
+    int ret = ngli_program_init(&pass->program, ctx, VERTEX_DATA, fragment, NULL);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "half_texel", .type = NGLI_TYPE_VEC2,  .count = 1},
+        {.name = "direction",  .type = NGLI_TYPE_VEC2,  .count = 1},
+        {.name = "radius",     .type = NGLI_TYPE_INT,   .count = 1},
+        {.name = "sigma",      .type = NGLI_TYPE_FLOAT, .count = 1},
+    };
+
+    const struct pipeline_texture textures[] = {
+        {.name = "src"},
+    };
+
+    const struct pipeline_attribute attributes[] = {
+        {.name = "position", .format = NGLI_FORMAT_R32G32B32A32_SFLOAT, .stride = 4 * 4, .buffer = &s->vertices},
+    };
+
+    const struct pipeline_params pipeline_params = {
+        .type          = NGLI_PIPELINE_TYPE_GRAPHICS,
+        .program       = &pass->program,
+        .textures      = textures,
+        .nb_textures   = NGLI_ARRAY_NB(textures),
+        .uniforms      = uniforms,
+        .nb_uniforms   = NGLI_ARRAY_NB(uniforms),
+        .attributes    = attributes,
+        .nb_attributes = NGLI_ARRAY_NB(attributes),
+        .graphics      = {
+            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN,
+            .nb_vertices = 4,
+        },
+    };
+
+    ret = ngli_pipeline_init(&pass->pipeline, ctx, &pipeline_params);
+    if (ret < 0)
+        return ret;
+
+    pass->src_index = ngli_pipeline_get_texture_index(&pass->pipeline, "src");
+    pass->half_texel_index = ngli_pipeline_get_uniform_index(&pass->pipeline, "half_texel");
+    pass->direction_index = ngli_pipeline_get_uniform_index(&pass->pipeline, "direction");
+    pass->radius_index = ngli_pipeline_get_uniform_index(&pass->pipeline, "radius");
+    pass->sigma_index = ngli_pipeline_get_uniform_index(&pass->pipeline, "sigma");
+    return 0;
+}
+
+static int init_compute_pass(struct ngl_node *node, struct blur_pass *pass, const float *direction,
+                             struct texture *dst)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    const char *version = gl->backend == NGL_BACKEND_OPENGLES ? "310 es" : "430";
+    const char *image_format = get_image_format(dst->params.format);
+    char *compute = ngli_asprintf(blur_compute_data, version, TILE_SIZE, MAX_RADIUS, image_format);
+    if (!compute)
+        return NGL_ERROR_MEMORY;
+
+    int ret = ngli_program_init(&pass->program, ctx, NULL, NULL, compute);
+    ngli_free(compute);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "direction", .type = NGLI_TYPE_VEC2,  .count = 1, .data = direction},
+        {.name = "radius",    .type = NGLI_TYPE_INT,   .count = 1},
+        {.name = "sigma",     .type = NGLI_TYPE_FLOAT, .count = 1},
+    };
+
+    const struct pipeline_texture textures[] = {
+        {.name = "src"},
+        {.name = "dst", .texture = dst},
+    };
+
+    /* One work group per segment of TILE_SIZE texels of each line */
+    const int width = dst->params.width;
+    const int height = dst->params.height;
+    const int length = direction[0] ? width : height;
+    const int nb_lines = direction[0] ? height : width;
+    const struct pipeline_params pipeline_params = {
+        .type        = NGLI_PIPELINE_TYPE_COMPUTE,
+        .program     = &pass->program,
+        .textures    = textures,
+        .nb_textures = NGLI_ARRAY_NB(textures),
+        .uniforms    = uniforms,
+        .nb_uniforms = NGLI_ARRAY_NB(uniforms),
+        .compute     = {
+            .nb_group_x = (length + TILE_SIZE - 1) / TILE_SIZE,
+            .nb_group_y = nb_lines,
+            .nb_group_z = 1,
+            .barriers   = NGLI_BARRIER_TEXTURE_FETCH_BIT |
+                          NGLI_BARRIER_IMAGE_ACCESS_BIT  |
+                          NGLI_BARRIER_FRAMEBUFFER_BIT,
+        },
+    };
+
+    ret = ngli_pipeline_init(&pass->pipeline, ctx, &pipeline_params);
+    if (ret < 0)
+        return ret;
+
+    pass->src_index = ngli_pipeline_get_texture_index(&pass->pipeline, "src");
+    pass->half_texel_index = -1;
+    pass->direction_index = -1;
+    pass->radius_index = ngli_pipeline_get_uniform_index(&pass->pipeline, "radius");
+    pass->sigma_index = ngli_pipeline_get_uniform_index(&pass->pipeline, "sigma");
+    return 0;
+}
+
+static int blur_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct blur_priv *s = node->priv_data;
+    struct texture_priv *dst_priv = s->destination->priv_data;
+    struct texture *dst = &dst_priv->texture;
+    const struct texture_params *dst_params = &dst->params;
+
+    /* The intermediate levels come from the texture pool of the context */
+    int width = dst_params->width;
+    int height = dst_params->height;
+    for (int i = 1; i <= s->nb_levels; i++) {
+        width = NGLI_MAX(width / 2, 1);
+        height = NGLI_MAX(height / 2, 1);
+        int ret = init_target(node, &s->levels[i], &s->level_rts[i], dst_params, width, height);
+        if (ret < 0)
+            return ret;
+    }
+    int ret = init_target(node, dst, &s->level_rts[0], NULL, 0, 0);
+    if (ret < 0)
+        return ret;
+    ret = init_target(node, &s->tmp, &s->tmp_rt, dst_params, width, height);
+    if (ret < 0)
+        return ret;
+
+    static const float vertices[] = {
+        -1.0f, -1.0f, 0.0f, 0.0f,
+         1.0f, -1.0f, 1.0f, 0.0f,
+         1.0f,  1.0f, 1.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f, 1.0f,
+    };
+    ret = ngli_buffer_init(&s->vertices, ctx, sizeof(vertices), NGLI_BUFFER_USAGE_STATIC);
+    if (ret < 0)
+        return ret;
+    ret = ngli_buffer_upload(&s->vertices, vertices, sizeof(vertices));
+    if (ret < 0)
+        return ret;
+
+    if ((ret = init_fragment_pass(node, &s->down, DOWN_FRAGMENT_DATA)) < 0 ||
+        (ret = init_fragment_pass(node, &s->up, UP_FRAGMENT_DATA)) < 0)
+        return ret;
+
+    /* The compute pass writes the blurred level as an image */
+    s->use_compute = (gl->features & NGLI_FEATURE_COMPUTE_SHADER_ALL) == NGLI_FEATURE_COMPUTE_SHADER_ALL &&
+                     get_image_format(dst_params->format);
+    if (s->use_compute) {
+        static const float horizontal[2] = {1.f, 0.f};
+        static const float vertical[2] = {0.f, 1.f};
+        struct texture *blurred = s->nb_levels ? &s->levels[s->nb_levels] : dst;
+        if ((ret = init_compute_pass(node, &s->blur_h, horizontal, &s->tmp)) < 0 ||
+            (ret = init_compute_pass(node, &s->blur_v, vertical, blurred)) < 0)
+            return ret;
+    } else {
+        char *fragment = ngli_asprintf(BLUR_FRAGMENT_DATA, MAX_RADIUS);
+        if (!fragment)
+            return NGL_ERROR_MEMORY;
+        ret = init_fragment_pass(node, &s->blur_h, fragment);
+        ngli_free(fragment);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int blur_update(struct ngl_node *node, double t)
+{
+    struct blur_priv *s = node->priv_data;
+    int ret = ngli_node_update(s->source, t);
+    if (ret < 0)
+        return ret;
+    return ngli_node_update(s->destination, t);
+}
+
+static void exec_fragment_pass(struct ngl_node *node, struct blur_pass *pass,
+                               struct texture *src, struct rendertarget *rt)
+{
+    struct ngl_ctx *ctx = node->ctx;
+
+    ngli_gctx_set_rendertarget(ctx, rt);
+    const int vp[4] = {0, 0, rt->width, rt->height};
+    ngli_gctx_set_viewport(ctx, vp);
+
+    /* Every pass overwrites the whole target */
+    ngli_gctx_load_attachments(ctx, NGLI_LOAD_OP_DONT_CARE, NGLI_LOAD_OP_DONT_CARE);
+
+    const float half_texel[2] = {0.5f / src->params.width, 0.5f / src->params.height};
+    ngli_pipeline_update_texture(&pass->pipeline, pass->src_index, src);
+    ngli_pipeline_update_uniform(&pass->pipeline, pass->half_texel_index, half_texel);
+    ngli_pipeline_exec(&pass->pipeline);
+}
+
+static void exec_blur(struct ngl_node *node, struct texture *src,
+                      struct texture *dst, struct rendertarget *dst_rt)
+{
+    struct blur_priv *s = node->priv_data;
+
+    /* The Gaussian covers 3 standard deviations of the remaining radius */
+    const float level_radius = s->radius / (1 << s->nb_levels);
+    const int radius = NGLI_MIN((int)ceilf(level_radius), MAX_RADIUS);
+    const float sigma = NGLI_MAX(level_radius / 3.f, 1e-3f);
+
+    if (s->use_compute) {
+        struct blur_pass *passes[] = {&s->blur_h, &s->blur_v};
+        struct texture *srcs[] = {src, &s->tmp};
+        for (int i = 0; i < NGLI_ARRAY_NB(passes); i++) {
+            struct blur_pass *pass = passes[i];
+            ngli_pipeline_update_texture(&pass->pipeline, pass->src_index, srcs[i]);
+            ngli_pipeline_update_uniform(&pass->pipeline, pass->radius_index, &radius);
+            ngli_pipeline_update_uniform(&pass->pipeline, pass->sigma_index, &sigma);
+            ngli_pipeline_exec(&pass->pipeline);
+        }
+        return;
+    }
+
+    struct blur_pass *pass = &s->blur_h;
+    ngli_pipeline_update_uniform(&pass->pipeline, pass->radius_index, &radius);
+    ngli_pipeline_update_uniform(&pass->pipeline, pass->sigma_index, &sigma);
+
+    const float horizontal[2] = {1.f / s->tmp.params.width, 0.f};
+    ngli_pipeline_update_uniform(&pass->pipeline, pass->direction_index, horizontal);
+    exec_fragment_pass(node, pass, src, &s->tmp_rt);
+
+    const float vertical[2] = {0.f, 1.f / dst->params.height};
+    ngli_pipeline_update_uniform(&pass->pipeline, pass->direction_index, vertical);
+    exec_fragment_pass(node, pass, &s->tmp, dst_rt);
+}
+
+static void blur_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct blur_priv *s = node->priv_data;
+
+    /* The destination does not depend on the output and is shared by all of them */
+    if (ctx->drawing_outputs)
+        return;
+
+    /* The pending draws target the previous render target */
+    ngli_pass_flush_draw_list(ctx);
+
+    NGLI_TRACEMARKER_BEGIN(blur, node->label);
+    struct rendertarget *prev_rt = ngli_gctx_get_rendertarget(ctx);
+    int prev_vp[4] = {0};
+    ngli_gctx_get_viewport(ctx, prev_vp);
+
+    struct texture_priv *src_priv = s->source->priv_data;
+    struct texture_priv *dst_priv = s->destination->priv_data;
+    struct texture *src = src_priv->image.planes[0];
+    struct texture *dst = &dst_priv->texture;
+
+    struct texture *level = src;
+    for (int i = 1; i <= s->nb_levels; i++) {
+        exec_fragment_pass(node, &s->down, level, &s->level_rts[i]);
+        level = &s->levels[i];
+    }
+
+    if (s->nb_levels) {
+        const int last = s->nb_levels;
+        exec_blur(node, level, level, &s->level_rts[last]);
+        for (int i = last; i > 0; i--)
+            exec_fragment_pass(node, &s->up, &s->levels[i], &s->level_rts[i - 1]);
+    } else {
+        exec_blur(node, src, dst, &s->level_rts[0]);
+    }
+
+    ngli_gctx_set_rendertarget(ctx, prev_rt);
+    ngli_gctx_set_viewport(ctx, prev_vp);
+
+    /* The mipmaps are only generated once the texture is sampled */
+    ngli_texture_invalidate_mipmap(dst);
+    dst_priv->last_rtt = node;
+    dst_priv->write_gen = ++ctx->gpu_write_gen;
+    memcpy(dst_priv->image.coordinates_matrix, src_priv->image.coordinates_matrix,
+           sizeof(dst_priv->image.coordinates_matrix));
+    NGLI_TRACEMARKER_END(blur);
+}
+
+static void reset_pass(struct blur_pass *pass)
+{
+    ngli_pipeline_reset(&pass->pipeline);
+    ngli_program_reset(&pass->program);
+}
+
+static void blur_release(struct ngl_node *node)
+{
+    struct blur_priv *s = node->priv_data;
+
+    reset_pass(&s->down);
+    reset_pass(&s->up);
+    reset_pass(&s->blur_h);
+    reset_pass(&s->blur_v);
+    ngli_buffer_reset(&s->vertices);
+    for (int i = 0; i <= MAX_LEVELS; i++) {
+        ngli_rendertarget_reset(&s->level_rts[i]);
+        ngli_texture_reset(&s->levels[i]);
+    }
+    ngli_rendertarget_reset(&s->tmp_rt);
+    ngli_texture_reset(&s->tmp);
+}
+
+const struct node_class ngli_blur_class = {
+    .id        = NGL_NODE_BLUR,
+    .name      = "Blur",
+    .init      = blur_init,
+    .prefetch  = blur_prefetch,
+    .update    = blur_update,
+    .draw      = blur_draw,
+    .release   = blur_release,
+    .priv_size = sizeof(struct blur_priv),
+    .params    = blur_params,
+    .file      = __FILE__,
+};
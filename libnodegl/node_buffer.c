@@ -20,18 +20,36 @@
  */
 
 #include <fcntl.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef TARGET_MINGW_W64
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 #include "buffer.h"
+#include "glcontext.h"
 #include "log.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "readback.h"
 #include "type.h"
+#include "utils.h"
+
+/*
+ * The file-backed buffers are uploaded in slices of this size so the driver
+ * never has to stage a copy of the whole file at once
+ */
+#define UPLOAD_CHUNK_SIZE (4 << 20)
 
 #define OFFSET(x) offsetof(struct buffer_priv, x)
 static const struct node_param buffer_params[] = {
@@ -46,9 +64,98 @@ static const struct node_param buffer_params[] = {
                .desc=NGLI_DOCSTRING("reference a field from the given block")},
     {"block_field", PARAM_TYPE_INT, OFFSET(block_field),
                     .desc=NGLI_DOCSTRING("field index in `block`")},
+    {"gpu_only", PARAM_TYPE_BOOL, OFFSET(gpu_only),
+                 .desc=NGLI_DOCSTRING("release the CPU copy of the data once uploaded to the GPU and only read it "
+                                      "back when the GPU buffer has to be recreated; while in use, the data can not "
+                                      "be accessed on the CPU (uniform, block field, texture data source, stream "
+                                      "not looked up on the GPU, serialization or user access). The pages of a "
+                                      "file are always released after the upload")},
     {NULL}
 };
 
+/*
+ * Mappings must start at a multiple of the page size (or of the allocation
+ * granularity on Windows), so the data at a file offset is accessed through
+ * a mapping starting at the closest aligned offset before it
+ */
+static int get_map_delta(int64_t offset)
+{
+#ifdef TARGET_MINGW_W64
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const int64_t alignment = info.dwAllocationGranularity;
+#else
+    const int64_t alignment = sysconf(_SC_PAGESIZE);
+#endif
+    return offset % alignment;
+}
+
+static void *map_file(int fd, int64_t offset, int size)
+{
+    const int delta = get_map_delta(offset);
+    const int64_t start = offset - delta;
+#ifdef TARGET_MINGW_W64
+    HANDLE file = (HANDLE)_get_osfhandle(fd);
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+        return NULL;
+    /* The view keeps a reference on the mapping object */
+    uint8_t *data = MapViewOfFile(mapping, FILE_MAP_READ, start >> 32, start & 0xffffffff, size + delta);
+    CloseHandle(mapping);
+    return data ? data + delta : NULL;
+#else
+    uint8_t *data = mmap(NULL, size + delta, PROT_READ, MAP_PRIVATE, fd, start);
+    return data == MAP_FAILED ? NULL : data + delta;
+#endif
+}
+
+static void unmap_file(uint8_t *data, int64_t offset, int size)
+{
+    const int delta = get_map_delta(offset);
+#ifdef TARGET_MINGW_W64
+    UnmapViewOfFile(data - delta);
+#else
+    munmap(data - delta, size + delta);
+#endif
+}
+
+/*
+ * Drop the pages of the mapping from the process memory: they are read
+ * back from the file if the data is accessed again on the CPU
+ */
+static void release_file_pages(uint8_t *data, int64_t offset, int size)
+{
+#ifdef TARGET_MINGW_W64
+    /* Unlocking pages that are not locked removes them from the working set */
+    VirtualUnlock(data, size);
+#elif defined(MADV_DONTNEED)
+    const int delta = get_map_delta(offset);
+    madvise(data - delta, size + delta, MADV_DONTNEED);
+#endif
+}
+
+static int upload_file_data(struct buffer_priv *s, int offset, int size)
+{
+    for (int end = offset + size; offset < end; offset += UPLOAD_CHUNK_SIZE) {
+        const int chunk_size = NGLI_MIN(end - offset, UPLOAD_CHUNK_SIZE);
+        int ret = ngli_buffer_upload_range(&s->buffer, s->data, offset, chunk_size);
+        if (ret < 0)
+            return ret;
+        release_file_pages(s->data + offset, s->file_offset + offset, chunk_size);
+    }
+    return 0;
+}
+
+/*
+ * Reading the data back requires mapping the buffer, and the data of a
+ * file can already be dropped from the process memory after the upload
+ */
+static int can_release_data(const struct ngl_ctx *ctx, const struct buffer_priv *s)
+{
+    const struct glcontext *gl = ctx->glcontext;
+    return s->gpu_only && !s->filename && (gl->features & NGLI_FEATURE_MAP_BUFFER_RANGE);
+}
+
 int ngli_node_buffer_ref(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -58,20 +165,66 @@ int ngli_node_buffer_ref(struct ngl_node *node)
         return ngli_node_block_ref(s->block);
 
     if (s->buffer_refcount++ == 0) {
+        if (!s->data && !s->filename) {
+            LOG(ERROR, "the data of %s has been lost", node->label);
+            return NGL_ERROR_MEMORY;
+        }
+
         int ret = ngli_buffer_init(&s->buffer, ctx, s->data_size, s->usage);
         if (ret < 0)
             return ret;
 
-        ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
-        if (ret < 0)
-            return ret;
+        /* The dynamic buffers are uploaded again at their first update */
+        if (!s->dynamic) {
+            ret = ngli_node_defer_upload(node, s->data_size);
+            if (ret < 0)
+                return ret;
+            s->upload_offset = 0;
+        }
+
+        if (!ret) {
+            ret = s->filename ? upload_file_data(s, 0, s->data_size)
+                              : ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+            if (ret < 0)
+                return ret;
+        }
+
+        ngli_glcontext_set_object_label(ctx->glcontext, GL_BUFFER, s->buffer.id, node->label);
 
         s->buffer_last_upload_time = -1.;
+        s->nb_changed_ranges = 0;
+
+        if (!node->pending_upload_size && can_release_data(ctx, s)) {
+            ngli_free_tagged(s->data);
+            s->data = NULL;
+        }
     }
 
     return 0;
 }
 
+/*
+ * The released data is read back before its GPU buffer goes away, so it can
+ * be uploaded again, or serialized once the node is detached
+ */
+static void restore_data(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+
+    s->data = ngli_malloc_tagged(s->data_size, NGLI_MEMTAG_BUFFERS);
+    if (!s->data) {
+        LOG(ERROR, "could not allocate the data of %s", node->label);
+        return;
+    }
+
+    int ret = ngli_buffer_download(&s->buffer, s->data, s->data_size);
+    if (ret < 0) {
+        LOG(ERROR, "could not read back the data of %s", node->label);
+        ngli_free_tagged(s->data);
+        s->data = NULL;
+    }
+}
+
 void ngli_node_buffer_unref(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
@@ -80,8 +233,12 @@ void ngli_node_buffer_unref(struct ngl_node *node)
         return ngli_node_block_unref(s->block);
 
     ngli_assert(s->buffer_refcount);
-    if (s->buffer_refcount-- == 1)
+    if (s->buffer_refcount-- == 1) {
+        ngli_node_cancel_upload(node);
+        if (!s->data && can_release_data(node->ctx, s))
+            restore_data(node);
         ngli_buffer_reset(&s->buffer);
+    }
 }
 
 int ngli_node_buffer_upload(struct ngl_node *node)
@@ -91,16 +248,79 @@ int ngli_node_buffer_upload(struct ngl_node *node)
     if (s->block)
         return ngli_node_block_upload(s->block);
 
+    int ret = ngli_node_finish_upload(node);
+    if (ret < 0)
+        return ret;
+
     if (s->dynamic && s->buffer_last_upload_time != node->last_update_time) {
-        int ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+        ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
         if (ret < 0)
             return ret;
         s->buffer_last_upload_time = node->last_update_time;
+        s->nb_changed_ranges = 0;
+    }
+
+    if (s->nb_changed_ranges) {
+        for (int i = 0; i < s->nb_changed_ranges; i++) {
+            const int *range = s->changed_ranges[i];
+            ret = ngli_buffer_upload_range(&s->buffer, s->data, range[0], range[1] - range[0]);
+            if (ret < 0)
+                return ret;
+        }
+        s->nb_changed_ranges = 0;
+        node->ctx->frame_changed = 1;
     }
 
     return 0;
 }
 
+static void mark_changed(struct buffer_priv *s, int start, int end)
+{
+    int ranges[NGLI_BUFFER_MAX_CHANGED_RANGES + 1][2];
+    int nb_ranges = 0;
+    int inserted = 0;
+
+    /* Insert the new range, absorbing the ranges it overlaps or touches */
+    for (int i = 0; i < s->nb_changed_ranges; i++) {
+        const int *range = s->changed_ranges[i];
+        if (range[1] < start) {
+            memcpy(ranges[nb_ranges++], range, sizeof(*ranges));
+        } else if (range[0] > end) {
+            if (!inserted) {
+                ranges[nb_ranges][0] = start;
+                ranges[nb_ranges][1] = end;
+                nb_ranges++;
+                inserted = 1;
+            }
+            memcpy(ranges[nb_ranges++], range, sizeof(*ranges));
+        } else {
+            start = NGLI_MIN(start, range[0]);
+            end   = NGLI_MAX(end, range[1]);
+        }
+    }
+    if (!inserted) {
+        ranges[nb_ranges][0] = start;
+        ranges[nb_ranges][1] = end;
+        nb_ranges++;
+    }
+
+    /* Merge the two closest ranges if there is no room left */
+    if (nb_ranges > NGLI_BUFFER_MAX_CHANGED_RANGES) {
+        int merge_index = 0;
+        for (int i = 1; i < nb_ranges - 1; i++) {
+            if (ranges[i + 1][0] - ranges[i][1] < ranges[merge_index + 1][0] - ranges[merge_index][1])
+                merge_index = i;
+        }
+        ranges[merge_index][1] = ranges[merge_index + 1][1];
+        memmove(ranges[merge_index + 1], ranges[merge_index + 2],
+                (nb_ranges - merge_index - 2) * sizeof(*ranges));
+        nb_ranges--;
+    }
+
+    memcpy(s->changed_ranges, ranges, nb_ranges * sizeof(*ranges));
+    s->nb_changed_ranges = nb_ranges;
+}
+
 static int buffer_init_from_data(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
@@ -134,8 +354,19 @@ static int buffer_init_from_filename(struct ngl_node *node)
         LOG(ERROR, "could not seek in '%s'", s->filename);
         return NGL_ERROR_IO;
     }
-    s->data_size = filesize;
-    s->count = s->count ? s->count : s->data_size / s->data_stride;
+
+    if (s->file_offset) {
+        /* The data is a slice of a larger file, such as a Mesh attribute */
+        s->data_size = s->count * s->data_stride;
+        if (s->file_offset + s->data_size > filesize) {
+            LOG(ERROR, "'%s' is too small to hold %d elements at offset %" PRId64,
+                s->filename, s->count, s->file_offset);
+            return NGL_ERROR_INVALID_DATA;
+        }
+    } else {
+        s->data_size = filesize;
+        s->count = s->count ? s->count : s->data_size / s->data_stride;
+    }
 
     if (s->data_size != s->count * s->data_stride) {
         LOG(ERROR,
@@ -146,18 +377,18 @@ static int buffer_init_from_filename(struct ngl_node *node)
         return NGL_ERROR_INVALID_DATA;
     }
 
-    s->data = ngli_calloc(s->count, s->data_stride);
-    if (!s->data)
-        return NGL_ERROR_MEMORY;
-
-    ssize_t n = read(s->fd, s->data, s->data_size);
-    if (n < 0) {
-        LOG(ERROR, "could not read '%s': %zd", s->filename, n);
-        return NGL_ERROR_IO;
+    if (!s->data_size) {
+        LOG(ERROR, "'%s' is empty", s->filename);
+        return NGL_ERROR_INVALID_DATA;
     }
 
-    if (n != s->data_size) {
-        LOG(ERROR, "read %zd bytes does not match expected size of %d bytes", n, s->data_size);
+    /*
+     * The file is mapped instead of read into memory: the pages are loaded
+     * on demand while uploading and can be dropped once the GPU has its copy
+     */
+    s->data = map_file(s->fd, s->file_offset, s->data_size);
+    if (!s->data) {
+        LOG(ERROR, "could not map '%s'", s->filename);
         return NGL_ERROR_IO;
     }
 
@@ -170,7 +401,7 @@ static int buffer_init_from_count(struct ngl_node *node)
 
     s->count = s->count ? s->count : 1;
     s->data_size = s->count * s->data_stride;
-    s->data = ngli_calloc(s->count, s->data_stride);
+    s->data = ngli_calloc_tagged(s->count, s->data_stride, NGLI_MEMTAG_BUFFERS);
     if (!s->data)
         return NGL_ERROR_MEMORY;
 
@@ -208,10 +439,20 @@ static int buffer_init_from_block(struct ngl_node *node)
     return 0;
 }
 
-static int buffer_init(struct ngl_node *node)
+/* The data of a block field is only known once the block is initialized */
+static int buffer_cpu_init(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
 
+    if (s->data_ref) {
+        if (s->data || s->filename || s->block) {
+            LOG(ERROR, "wrapped data can not be used with data, filename or block");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        s->data = s->data_ref;
+        s->data_size = s->data_ref_size;
+    }
+
     if (s->data && s->filename) {
         LOG(ERROR,
             "data and filename option cannot be set at the same time");
@@ -223,6 +464,11 @@ static int buffer_init(struct ngl_node *node)
         return NGL_ERROR_INVALID_ARG;
     }
 
+    if (s->gpu_only && (s->block || s->data_ref)) {
+        LOG(ERROR, "the data of a block field or of wrapped memory can not be GPU-only");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
     if (node->class->id == NGL_NODE_BUFFERMAT4) {
         s->data_comp = 4 * 4;
         s->data_stride = s->data_comp * sizeof(float);
@@ -238,17 +484,24 @@ static int buffer_init(struct ngl_node *node)
     if (s->filename)
         return buffer_init_from_filename(node);
     if (s->block)
-        return buffer_init_from_block(node);
+        return 0;
 
     return buffer_init_from_count(node);
 }
 
+static int buffer_init(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+    return s->block ? buffer_init_from_block(node) : 0;
+}
+
 static void buffer_uninit(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
 
     if (s->filename) {
-        ngli_free(s->data);
+        if (s->data)
+            unmap_file(s->data, s->file_offset, s->data_size);
         s->data = NULL;
         s->data_size = 0;
 
@@ -258,27 +511,251 @@ static void buffer_uninit(struct ngl_node *node)
                 LOG(ERROR, "could not properly close '%s'", s->filename);
             }
         }
-    } else if (s->block) {
+    } else if (s->block || s->data_ref) {
         /* Prevent the param API to free a non-owned pointer */
         s->data = NULL;
         s->data_size = 0;
     }
+    s->mapped = 0;
+}
+
+static int check_user_buffer(const struct ngl_node *node)
+{
+    if (node->class->params != buffer_params) {
+        LOG(ERROR, "%s is not a buffer node with user data", node->class->name);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    const struct buffer_priv *s = node->priv_data;
+    if (s->gpu_only) {
+        LOG(ERROR, "the data of %s is only kept on the GPU", node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (s->filename || s->block) {
+        LOG(ERROR, "the data of %s is backed by a %s", node->label, s->filename ? "file" : "block");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (s->mapped) {
+        LOG(ERROR, "%s is currently mapped", node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    return 0;
+}
+
+int ngl_node_buffer_wrap_data(struct ngl_node *node, int size, void *data)
+{
+    int ret = check_user_buffer(node);
+    if (ret < 0)
+        return ret;
+
+    struct buffer_priv *s = node->priv_data;
+
+    if (!data) {
+        /* Take back the ownership with a copy of the wrapped memory */
+        if (!s->data_ref)
+            return 0;
+        uint8_t *copy = ngli_malloc_tagged(s->data_ref_size, NGLI_MEMTAG_BUFFERS);
+        if (!copy)
+            return NGL_ERROR_MEMORY;
+        memcpy(copy, s->data_ref, s->data_ref_size);
+        if (!node->ctx)
+            ngli_free_tagged(s->data);
+        s->data = copy;
+        s->data_size = s->data_ref_size;
+        s->data_ref = NULL;
+        s->data_ref_size = 0;
+        return 0;
+    }
+
+    if (size <= 0) {
+        LOG(ERROR, "invalid wrapped data size %d", size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (node->ctx) {
+        /* The GPU buffer is already allocated and can not be resized */
+        if (size != s->data_size) {
+            LOG(ERROR, "%s data size (%d) can not be live changed to %d",
+                node->label, s->data_size, size);
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        if (!s->data_ref)
+            ngli_free_tagged(s->data);
+        s->data = data;
+        mark_changed(s, 0, size);
+    } else {
+        if (!s->data_ref)
+            ngli_free_tagged(s->data);
+        s->data = NULL;
+        s->data_size = 0;
+    }
+
+    s->data_ref = data;
+    s->data_ref_size = size;
+    return 0;
+}
+
+int ngl_node_buffer_map(struct ngl_node *node, int offset, int size, void **datap)
+{
+    *datap = NULL;
+
+    int ret = check_user_buffer(node);
+    if (ret < 0)
+        return ret;
+
+    struct buffer_priv *s = node->priv_data;
+    uint8_t *data = node->ctx ? s->data : s->data_ref ? s->data_ref : s->data;
+    const int data_size = node->ctx ? s->data_size : s->data_ref ? s->data_ref_size : s->data_size;
+    if (!data) {
+        LOG(ERROR, "%s has no data to map", node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (offset < 0 || size <= 0 || size > data_size - offset) {
+        LOG(ERROR, "range [%d,%d[ is out of the %s data (%d bytes)",
+            offset, offset + size, node->label, data_size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    s->mapped = 1;
+    s->map_start = offset;
+    s->map_end = offset + size;
+    *datap = data + offset;
+    return 0;
+}
+
+int ngl_node_buffer_unmap(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+
+    if (node->class->params != buffer_params || !s->mapped) {
+        LOG(ERROR, "%s is not mapped", node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    /* The whole data is uploaded when the GPU buffer gets created */
+    if (node->ctx && s->buffer_refcount)
+        mark_changed(s, s->map_start, s->map_end);
+    s->mapped = 0;
+    return 0;
+}
+
+int ngl_node_buffer_update(struct ngl_node *node, int offset, int count, const void *data)
+{
+    int ret = check_user_buffer(node);
+    if (ret < 0)
+        return ret;
+
+    struct buffer_priv *s = node->priv_data;
+    if (!node->ctx) {
+        LOG(ERROR, "%s must be attached to a context to be updated", node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (offset < 0 || offset >= s->count || count <= 0 || count > s->count) {
+        LOG(ERROR, "%d elements at %d can not be updated in %s (%d elements)",
+            count, offset, node->label, s->count);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    /* The elements going past the end wrap around to the start */
+    const int head_count = NGLI_MIN(count, s->count - offset);
+    const int tail_count = count - head_count;
+    const int start = offset * s->data_stride;
+    const int head_size = head_count * s->data_stride;
+    const int tail_size = tail_count * s->data_stride;
+    memcpy(s->data + start, data, head_size);
+    if (tail_size)
+        memcpy(s->data, (const uint8_t *)data + head_size, tail_size);
+
+    node->ctx->scene_hash_valid = 0;
+
+    /* The whole data is uploaded when the GPU buffer gets created */
+    if (s->buffer_refcount) {
+        mark_changed(s, start, start + head_size);
+        if (tail_size)
+            mark_changed(s, 0, tail_size);
+    }
+    return 0;
+}
+
+int ngl_node_buffer_read_async(struct ngl_node *node, int offset, int size,
+                               ngl_buffer_read_callback_type callback, void *user_arg)
+{
+    if (node->class->category != NGLI_NODE_CATEGORY_BUFFER && node->class->id != NGL_NODE_BLOCK) {
+        LOG(ERROR, "%s is not a buffer or a block node", node->class->name);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    struct ngl_ctx *ctx = node->ctx;
+    if (!ctx) {
+        LOG(ERROR, "%s must be attached to a context to be read", node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    const uint64_t features = NGLI_FEATURE_SYNC | NGLI_FEATURE_MAP_BUFFER_RANGE | NGLI_FEATURE_COPY_BUFFER;
+    if ((ctx->glcontext->features & features) != features) {
+        LOG(ERROR, "context does not support the asynchronous read of buffers");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    const int data_size = node->class->id == NGL_NODE_BLOCK ? ((struct block_priv *)node->priv_data)->data_size
+                                                            : ((struct buffer_priv *)node->priv_data)->data_size;
+    if (offset < 0 || size <= 0 || size > data_size - offset) {
+        LOG(ERROR, "range [%d,%d[ is out of the %s data (%d bytes)",
+            offset, offset + size, node->label, data_size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (!callback) {
+        LOG(ERROR, "a callback is required to read %s", node->label);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    return ngli_readback_queue(ctx, node, offset, size, callback, user_arg);
+}
+
+static int64_t buffer_upload(struct ngl_node *node, int64_t max_size)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct buffer_priv *s = node->priv_data;
+
+    const int size = (int)NGLI_MIN(max_size, s->data_size - s->upload_offset);
+    int ret = s->filename ? upload_file_data(s, s->upload_offset, size)
+                          : ngli_buffer_upload_range(&s->buffer, s->data, s->upload_offset, size);
+    if (ret < 0)
+        return ret;
+    s->upload_offset += size;
+
+    if (s->upload_offset < s->data_size)
+        return s->data_size - s->upload_offset;
+
+    if (can_release_data(ctx, s)) {
+        ngli_free_tagged(s->data);
+        s->data = NULL;
+    }
+    return 0;
 }
 
 #define DEFINE_BUFFER_CLASS(class_id, class_name, type, format, dtype) \
-static int buffer##type##_init(struct ngl_node *node)           \
+static int buffer##type##_cpu_init(struct ngl_node *node)       \
 {                                                               \
     struct buffer_priv *s = node->priv_data;                    \
     s->data_format = format;                                    \
     s->data_type = dtype;                                       \
-    return buffer_init(node);                                   \
+    return buffer_cpu_init(node);                               \
 }                                                               \
                                                                 \
 const struct node_class ngli_buffer##type##_class = {           \
     .id        = class_id,                                      \
     .category  = NGLI_NODE_CATEGORY_BUFFER,                     \
     .name      = class_name,                                    \
-    .init      = buffer##type##_init,                           \
+    .cpu_init  = buffer##type##_cpu_init,                       \
+    .init      = buffer_init,                                   \
+    .upload    = buffer_upload,                                 \
     .uninit    = buffer_uninit,                                 \
     .priv_size = sizeof(struct buffer_priv),                    \
     .params    = buffer_params,                                 \
@@ -316,3 +793,9 @@ DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERVEC2,   "BufferVec2",   vec2,   NGLI_FORMAT_R
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERVEC3,   "BufferVec3",   vec3,   NGLI_FORMAT_R32G32B32_SFLOAT,    NGLI_TYPE_VEC3)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERVEC4,   "BufferVec4",   vec4,   NGLI_FORMAT_R32G32B32A32_SFLOAT, NGLI_TYPE_VEC4)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERMAT4,   "BufferMat4",   mat4,   NGLI_FORMAT_R32G32B32A32_SFLOAT, NGLI_TYPE_MAT4)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHALF,   "BufferHalf",   half,   NGLI_FORMAT_R16_SFLOAT,          NGLI_TYPE_NONE)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHVEC2,  "BufferHVec2",  hvec2,  NGLI_FORMAT_R16G16_SFLOAT,       NGLI_TYPE_NONE)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHVEC3,  "BufferHVec3",  hvec3,  NGLI_FORMAT_R16G16B16_SFLOAT,    NGLI_TYPE_NONE)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHVEC4,  "BufferHVec4",  hvec4,  NGLI_FORMAT_R16G16B16A16_SFLOAT, NGLI_TYPE_NONE)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERPACK10, "BufferPack10", pack10, NGLI_FORMAT_A2B10G10R10_SNORM_PACK32, NGLI_TYPE_NONE)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERUPACK10, "BufferUPack10", upack10, NGLI_FORMAT_A2B10G10R10_UNORM_PACK32, NGLI_TYPE_NONE)
@@ -60,6 +60,7 @@ struct camera_priv {
     float ground[3];
 
     NGLI_ALIGNED_MAT(modelview_matrix);
+    uint64_t modelview_version;
     NGLI_ALIGNED_MAT(projection_matrix);
 };
 
@@ -131,6 +132,8 @@ static int camera_init(struct ngl_node *node)
     s->center_transform_matrix = ngli_get_last_transformation_matrix(s->center_transform);
     s->up_transform_matrix     = ngli_get_last_transformation_matrix(s->up_transform);
 
+    s->modelview_version = 0;
+
     return 0;
 }
 
@@ -151,10 +154,12 @@ static int camera_update(struct ngl_node *node, double t)
         int ret = ngli_node_update(s->what##_transform, t);                 \
         if (ret < 0)                                                        \
             return ret;                                                     \
-        if (!ngli_darray_push(&ctx->modelview_matrix_stack, id_matrix))     \
-            return NGL_ERROR_MEMORY;                                        \
+        ret = ngli_modelview_push(ctx, id_matrix,                           \
+                                  NGLI_MODELVIEW_VERSION_IDENTITY);         \
+        if (ret < 0)                                                        \
+            return ret;                                                     \
         ngli_node_draw(s->what##_transform);                                \
-        ngli_darray_pop(&ctx->modelview_matrix_stack);                      \
+        ngli_modelview_pop(ctx);                                            \
         const float *matrix = s->what##_transform_matrix;                   \
         if (matrix)                                                         \
             ngli_mat4_mul_vec4(what, matrix, what);                         \
@@ -171,7 +176,12 @@ static int camera_update(struct ngl_node *node, double t)
         ngli_vec3_cross(up, up, s->ground);
     }
 
-    ngli_mat4_look_at(s->modelview_matrix, eye, center, up);
+    NGLI_ALIGNED_MAT(modelview_matrix);
+    ngli_mat4_look_at(modelview_matrix, eye, center, up);
+    if (!s->modelview_version || memcmp(s->modelview_matrix, modelview_matrix, sizeof(modelview_matrix))) {
+        memcpy(s->modelview_matrix, modelview_matrix, sizeof(s->modelview_matrix));
+        s->modelview_version = ngli_modelview_new_version(ctx);
+    }
 
     if (s->fov_anim) {
         struct ngl_node *anim_node = s->fov_anim;
@@ -208,18 +218,23 @@ static void camera_draw(struct ngl_node *node)
     struct ngl_ctx *ctx = node->ctx;
     struct camera_priv *s = node->priv_data;
 
-    if (!ngli_darray_push(&ctx->modelview_matrix_stack, s->modelview_matrix) ||
-        !ngli_darray_push(&ctx->projection_matrix_stack, s->projection_matrix))
+    if (ngli_modelview_push(ctx, s->modelview_matrix, s->modelview_version) < 0)
+        return;
+    if (!ngli_darray_push(&ctx->projection_matrix_stack, s->projection_matrix)) {
+        ngli_modelview_pop(ctx);
         return;
+    }
 
     ngli_node_draw(s->child);
 
-    ngli_darray_pop(&ctx->modelview_matrix_stack);
+    ngli_modelview_pop(ctx);
     ngli_darray_pop(&ctx->projection_matrix_stack);
 }
 
 const struct node_class ngli_camera_class = {
     .id        = NGL_NODE_CAMERA,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Camera",
     .init      = camera_init,
     .update    = camera_update,
@@ -0,0 +1,377 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L // O_CLOEXEC, struct timeval
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(TARGET_LINUX) && defined(HAVE_GLPLATFORM_EGL)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+#include <linux/videodev2.h>
+#define HAVE_V4L2
+#endif
+
+#include "glincludes.h"
+#include "image.h"
+#include "log.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "texture.h"
+#include "utils.h"
+
+#define OFFSET(x) offsetof(struct capturedevice_priv, x)
+static const struct node_param capturedevice_params[] = {
+    {"device",     PARAM_TYPE_STR, OFFSET(device), {.str="/dev/video0"},
+                   .desc=NGLI_DOCSTRING("path to the capture device")},
+    {"width",      PARAM_TYPE_INT, OFFSET(width), {.i64=1280},
+                   .desc=NGLI_DOCSTRING("requested capture width, the device may adjust it")},
+    {"height",     PARAM_TYPE_INT, OFFSET(height), {.i64=720},
+                   .desc=NGLI_DOCSTRING("requested capture height, the device may adjust it")},
+    {"nb_buffers", PARAM_TYPE_INT, OFFSET(nb_buffers), {.i64=4},
+                   .desc=NGLI_DOCSTRING("number of buffers shared with the capture driver")},
+    {NULL}
+};
+
+#if defined(HAVE_V4L2)
+
+/* Defined here since the DRM headers are not a build requirement */
+#define DRM_FORMAT_R8   NGLI_FOURCC('R', '8', ' ', ' ')
+#define DRM_FORMAT_GR88 NGLI_FOURCC('G', 'R', '8', '8')
+
+static int xioctl(int fd, unsigned long request, void *arg)
+{
+    int ret;
+    do {
+        ret = ioctl(fd, request, arg);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+static int queue_buffer(struct capturedevice_priv *s, int index)
+{
+    struct v4l2_buffer buf = {
+        .type   = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP,
+        .index  = index,
+    };
+    if (xioctl(s->fd, VIDIOC_QBUF, &buf) < 0) {
+        LOG(ERROR, "could not queue capture buffer %d: %s", index, strerror(errno));
+        return NGL_ERROR_IO;
+    }
+    return 0;
+}
+
+static int capturedevice_init(struct ngl_node *node)
+{
+    struct capturedevice_priv *s = node->priv_data;
+
+    s->fd = -1;
+    s->current = -1;
+    for (int i = 0; i < NGLI_CAPTUREDEVICE_MAX_BUFFERS; i++)
+        s->buffers[i].fd = -1;
+
+    if (s->nb_buffers < 2 || s->nb_buffers > NGLI_CAPTUREDEVICE_MAX_BUFFERS) {
+        LOG(ERROR, "the number of buffers must be in [2,%d]", NGLI_CAPTUREDEVICE_MAX_BUFFERS);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    s->fd = open(s->device, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (s->fd < 0) {
+        LOG(ERROR, "could not open %s: %s", s->device, strerror(errno));
+        return NGL_ERROR_IO;
+    }
+
+    struct v4l2_capability cap = {0};
+    if (xioctl(s->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        LOG(ERROR, "%s is not a V4L2 device", s->device);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+    const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+        LOG(ERROR, "%s does not support video capture streaming", s->device);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    struct v4l2_format fmt = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .fmt.pix = {
+            .width       = s->width,
+            .height      = s->height,
+            .pixelformat = V4L2_PIX_FMT_NV12,
+            .field       = V4L2_FIELD_NONE,
+        },
+    };
+    if (xioctl(s->fd, VIDIOC_S_FMT, &fmt) < 0 || fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_NV12) {
+        LOG(ERROR, "%s does not support NV12 capture", s->device);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+    if (fmt.fmt.pix.width != s->width || fmt.fmt.pix.height != s->height)
+        LOG(WARNING, "capture size adjusted by the device from %dx%d to %dx%d",
+            s->width, s->height, fmt.fmt.pix.width, fmt.fmt.pix.height);
+    s->width  = fmt.fmt.pix.width;
+    s->height = fmt.fmt.pix.height;
+    s->pitch  = fmt.fmt.pix.bytesperline;
+
+    struct v4l2_requestbuffers req = {
+        .count  = s->nb_buffers,
+        .type   = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+    if (xioctl(s->fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        LOG(ERROR, "could not allocate the capture buffers of %s", s->device);
+        return NGL_ERROR_MEMORY;
+    }
+    s->nb_allocated = NGLI_MIN(req.count, NGLI_CAPTUREDEVICE_MAX_BUFFERS);
+
+    /* The buffers are shared with the GPU instead of being mapped in memory */
+    for (int i = 0; i < s->nb_allocated; i++) {
+        struct v4l2_exportbuffer expbuf = {
+            .type  = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+            .index = i,
+            .flags = O_RDONLY | O_CLOEXEC,
+        };
+        if (xioctl(s->fd, VIDIOC_EXPBUF, &expbuf) < 0) {
+            LOG(ERROR, "could not export capture buffer %d as dma-buf: %s", i, strerror(errno));
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        s->buffers[i].fd = expbuf.fd;
+    }
+
+    return 0;
+}
+
+static void buffer_reset(struct glcontext *gl, struct capturedevice_buffer *buffer)
+{
+    for (int i = 0; i < 2; i++) {
+        ngli_texture_reset(&buffer->planes[i]);
+        if (buffer->egl_images[i])
+            ngli_eglDestroyImageKHR(gl, buffer->egl_images[i]);
+        buffer->egl_images[i] = NULL;
+    }
+}
+
+static int buffer_import(struct ngl_node *node, struct capturedevice_buffer *buffer)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct capturedevice_priv *s = node->priv_data;
+
+    for (int i = 0; i < 2; i++) {
+        const int width  = i == 0 ? s->width  : (s->width  + 1) >> 1;
+        const int height = i == 0 ? s->height : (s->height + 1) >> 1;
+        const EGLint attribs[] = {
+            EGL_LINUX_DRM_FOURCC_EXT,      i == 0 ? DRM_FORMAT_R8 : DRM_FORMAT_GR88,
+            EGL_WIDTH,                     width,
+            EGL_HEIGHT,                    height,
+            EGL_DMA_BUF_PLANE0_FD_EXT,     buffer->fd,
+            EGL_DMA_BUF_PLANE0_OFFSET_EXT, i == 0 ? 0 : s->pitch * s->height,
+            EGL_DMA_BUF_PLANE0_PITCH_EXT,  s->pitch,
+            EGL_NONE
+        };
+
+        buffer->egl_images[i] = ngli_eglCreateImageKHR(gl,
+                                                       EGL_NO_CONTEXT,
+                                                       EGL_LINUX_DMA_BUF_EXT,
+                                                       NULL,
+                                                       attribs);
+        if (!buffer->egl_images[i]) {
+            LOG(ERROR, "failed to create egl image");
+            return -1;
+        }
+
+        const struct texture_params plane_params = {
+            .dimensions = 2,
+            .format = i == 0 ? NGLI_FORMAT_R8_UNORM : NGLI_FORMAT_R8G8_UNORM,
+            .min_filter = NGLI_FILTER_LINEAR,
+            .mag_filter = NGLI_FILTER_LINEAR,
+            .mipmap_filter = NGLI_MIPMAP_FILTER_NONE,
+            .wrap_s = NGLI_WRAP_CLAMP_TO_EDGE,
+            .wrap_t = NGLI_WRAP_CLAMP_TO_EDGE,
+            .wrap_r = NGLI_WRAP_CLAMP_TO_EDGE,
+            .external_storage = 1,
+        };
+
+        struct texture *plane = &buffer->planes[i];
+        int ret = ngli_texture_init(plane, ctx, &plane_params);
+        if (ret < 0)
+            return ret;
+        ngli_texture_set_dimensions(plane, width, height, 0);
+
+        ngli_glstate_bind_texture(gl, plane->target, plane->id);
+        ngli_glEGLImageTargetTexture2DOES(gl, plane->target, buffer->egl_images[i]);
+    }
+
+    return 0;
+}
+
+static int capturedevice_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct capturedevice_priv *s = node->priv_data;
+
+    if (!(gl->features & (NGLI_FEATURE_OES_EGL_IMAGE |
+                          NGLI_FEATURE_EGL_IMAGE_BASE_KHR |
+                          NGLI_FEATURE_EGL_EXT_IMAGE_DMA_BUF_IMPORT))) {
+        LOG(ERROR, "context does not support required extensions for dma-buf import");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    for (int i = 0; i < s->nb_allocated; i++) {
+        int ret = buffer_import(node, &s->buffers[i]);
+        if (ret < 0)
+            return ret;
+        ret = queue_buffer(s, i);
+        if (ret < 0)
+            return ret;
+    }
+
+    const enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(s->fd, VIDIOC_STREAMON, (void *)&type) < 0) {
+        LOG(ERROR, "could not start the capture of %s: %s", s->device, strerror(errno));
+        return NGL_ERROR_IO;
+    }
+    s->streaming = 1;
+
+    return 0;
+}
+
+static int capturedevice_update(struct ngl_node *node, double t)
+{
+    struct capturedevice_priv *s = node->priv_data;
+
+    /* The next frame of the device can arrive at any time */
+    ngli_node_restrict_next_change(node, t);
+
+    /*
+     * Drain the completed buffers down to the most recent one: the older
+     * frames are given back to the driver without ever being displayed
+     */
+    for (;;) {
+        struct v4l2_buffer buf = {
+            .type   = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+            .memory = V4L2_MEMORY_MMAP,
+        };
+        if (xioctl(s->fd, VIDIOC_DQBUF, &buf) < 0) {
+            if (errno == EAGAIN)
+                break;
+            LOG(ERROR, "could not dequeue capture buffer: %s", strerror(errno));
+            return NGL_ERROR_IO;
+        }
+
+        if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+            int ret = queue_buffer(s, buf.index);
+            if (ret < 0)
+                return ret;
+            continue;
+        }
+
+        if (s->current >= 0) {
+            int ret = queue_buffer(s, s->current);
+            if (ret < 0)
+                return ret;
+        }
+        s->current = buf.index;
+        s->image.ts = buf.timestamp.tv_sec + buf.timestamp.tv_usec / 1000000.;
+    }
+
+    if (s->current < 0)
+        return 0;
+
+    const double ts = s->image.ts;
+    s->planes = s->buffers[s->current].planes;
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_NV12, &s->planes[0], &s->planes[1]);
+    s->image.ts = ts;
+
+    return 0;
+}
+
+static void capturedevice_release(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct capturedevice_priv *s = node->priv_data;
+
+    /* Stopping the stream gives all the buffers back to the application */
+    if (s->streaming) {
+        const enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(s->fd, VIDIOC_STREAMOFF, (void *)&type) < 0)
+            LOG(ERROR, "could not stop the capture of %s: %s", s->device, strerror(errno));
+        s->streaming = 0;
+    }
+    s->current = -1;
+    s->planes = NULL;
+    ngli_image_reset(&s->image);
+
+    for (int i = 0; i < s->nb_allocated; i++)
+        buffer_reset(gl, &s->buffers[i]);
+}
+
+static void capturedevice_uninit(struct ngl_node *node)
+{
+    struct capturedevice_priv *s = node->priv_data;
+
+    for (int i = 0; i < s->nb_allocated; i++)
+        if (s->buffers[i].fd >= 0)
+            close(s->buffers[i].fd);
+
+    if (s->fd >= 0) {
+        struct v4l2_requestbuffers req = {
+            .count  = 0,
+            .type   = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+            .memory = V4L2_MEMORY_MMAP,
+        };
+        xioctl(s->fd, VIDIOC_REQBUFS, &req);
+        close(s->fd);
+    }
+}
+
+#else
+
+static int capturedevice_init(struct ngl_node *node)
+{
+    LOG(ERROR, "capture devices are not supported on this platform");
+    return NGL_ERROR_UNSUPPORTED;
+}
+
+#endif
+
+const struct node_class ngli_capturedevice_class = {
+    .id        = NGL_NODE_CAPTUREDEVICE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
+    .name      = "CaptureDevice",
+    .init      = capturedevice_init,
+#if defined(HAVE_V4L2)
+    .prefetch  = capturedevice_prefetch,
+    .update    = capturedevice_update,
+    .release   = capturedevice_release,
+    .uninit    = capturedevice_uninit,
+#endif
+    .priv_size = sizeof(struct capturedevice_priv),
+    .params    = capturedevice_params,
+    .file      = __FILE__,
+};
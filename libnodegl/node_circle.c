@@ -39,9 +39,8 @@ static const struct node_param circle_params[] = {
     {NULL}
 };
 
-static int circle_init(struct ngl_node *node)
+static int circle_cpu_init(struct ngl_node *node)
 {
-    int ret = -1;
     struct geometry_priv *s = node->priv_data;
 
     if (s->npoints < 3) {
@@ -50,13 +49,12 @@ static int circle_init(struct ngl_node *node)
     }
     const int nb_vertices = s->npoints + 2;
 
-    float *vertices  = ngli_calloc(nb_vertices, sizeof(*vertices)  * 3);
-    float *uvcoords  = ngli_calloc(nb_vertices, sizeof(*uvcoords)  * 2);
-    float *normals   = ngli_calloc(nb_vertices, sizeof(*normals)   * 3);
+    float *vertices = s->circle_vertices = ngli_calloc(nb_vertices, sizeof(*vertices) * 3);
+    float *uvcoords = s->circle_uvcoords = ngli_calloc(nb_vertices, sizeof(*uvcoords) * 2);
+    float *normals  = s->circle_normals  = ngli_calloc(nb_vertices, sizeof(*normals)  * 3);
 
     if (!vertices || !uvcoords || !normals)
-        goto end;
-
+        return NGL_ERROR_MEMORY;
 
     int i;
     const double step = 2.0 * M_PI / s->npoints;
@@ -82,57 +80,68 @@ static int circle_init(struct ngl_node *node)
     for (int i = 1; i < nb_vertices; i++)
         memcpy(normals + (i * 3), normals, 3 * sizeof(*normals));
 
+    return 0;
+}
+
+static void free_circle_data(struct geometry_priv *s)
+{
+    ngli_free(s->circle_vertices);
+    ngli_free(s->circle_uvcoords);
+    ngli_free(s->circle_normals);
+    s->circle_vertices = s->circle_uvcoords = s->circle_normals = NULL;
+}
+
+static int circle_init(struct ngl_node *node)
+{
+    int ret = -1;
+    struct geometry_priv *s = node->priv_data;
+    const int nb_vertices = s->npoints + 2;
+
     s->vertices_buffer = ngli_node_geometry_generate_buffer(node->ctx,
                                                             NGL_NODE_BUFFERVEC3,
                                                             nb_vertices,
-                                                            nb_vertices * sizeof(*vertices) * 3,
-                                                            vertices);
+                                                            nb_vertices * sizeof(float) * 3,
+                                                            s->circle_vertices);
 
     s->uvcoords_buffer = ngli_node_geometry_generate_buffer(node->ctx,
                                                             NGL_NODE_BUFFERVEC2,
                                                             nb_vertices,
-                                                            nb_vertices * sizeof(*uvcoords) * 2,
-                                                            uvcoords);
+                                                            nb_vertices * sizeof(float) * 2,
+                                                            s->circle_uvcoords);
 
     s->normals_buffer = ngli_node_geometry_generate_buffer(node->ctx,
                                                            NGL_NODE_BUFFERVEC3,
                                                            nb_vertices,
-                                                           nb_vertices * sizeof(*normals) * 3,
-                                                           normals);
+                                                           nb_vertices * sizeof(float) * 3,
+                                                           s->circle_normals);
 
     if (!s->vertices_buffer || !s->uvcoords_buffer || !s->normals_buffer)
         goto end;
 
     s->topology = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+    ngli_node_geometry_compute_bounds(s);
 
     ret = 0;
 
 end:
-    ngli_free(vertices);
-    ngli_free(uvcoords);
-    ngli_free(normals);
+    free_circle_data(s);
     return ret;
 }
 
-#define NODE_UNREFP(node) do {                    \
-    if (node) {                                   \
-        ngli_node_detach_ctx(node, node->ctx);    \
-        ngl_node_unrefp(&node);                   \
-    }                                             \
-} while (0)
-
 static void circle_uninit(struct ngl_node *node)
 {
     struct geometry_priv *s = node->priv_data;
 
-    NODE_UNREFP(s->vertices_buffer);
-    NODE_UNREFP(s->uvcoords_buffer);
-    NODE_UNREFP(s->normals_buffer);
+    free_circle_data(s);
+    ngli_node_geometry_release_buffer(&s->vertices_buffer);
+    ngli_node_geometry_release_buffer(&s->uvcoords_buffer);
+    ngli_node_geometry_release_buffer(&s->normals_buffer);
 }
 
 const struct node_class ngli_circle_class = {
     .id        = NGL_NODE_CIRCLE,
     .name      = "Circle",
+    .cpu_init  = circle_cpu_init,
     .init      = circle_init,
     .uninit    = circle_uninit,
     .priv_size = sizeof(struct geometry_priv),
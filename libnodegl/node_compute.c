@@ -29,6 +29,8 @@
 #include "nodegl.h"
 #include "nodes.h"
 #include "pass.h"
+#include "pipeline.h"
+#include "tracemarker.h"
 #include "utils.h"
 
 struct compute_priv {
@@ -39,6 +41,8 @@ struct compute_priv {
     struct hmap *textures;
     struct hmap *uniforms;
     struct hmap *blocks;
+    struct ngl_node *indirect_buffer;
+    int barriers;
 
     struct pass pass;
 };
@@ -49,26 +53,50 @@ struct compute_priv {
 #define PROGRAMS_TYPES_LIST (const int[]){NGL_NODE_COMPUTEPROGRAM,  \
                                           -1}
 
-#define UNIFORMS_TYPES_LIST (const int[]){NGL_NODE_UNIFORMFLOAT,    \
-                                          NGL_NODE_UNIFORMVEC2,     \
-                                          NGL_NODE_UNIFORMVEC3,     \
-                                          NGL_NODE_UNIFORMVEC4,     \
-                                          NGL_NODE_UNIFORMQUAT,     \
-                                          NGL_NODE_UNIFORMINT,      \
-                                          NGL_NODE_UNIFORMMAT4,     \
-                                          NGL_NODE_ANIMATEDFLOAT,   \
-                                          NGL_NODE_ANIMATEDVEC2,    \
-                                          NGL_NODE_ANIMATEDVEC3,    \
-                                          NGL_NODE_ANIMATEDVEC4,    \
-                                          NGL_NODE_ANIMATEDQUAT,    \
-                                          NGL_NODE_STREAMEDINT,     \
-                                          NGL_NODE_STREAMEDFLOAT,   \
-                                          NGL_NODE_STREAMEDVEC2,    \
-                                          NGL_NODE_STREAMEDVEC3,    \
-                                          NGL_NODE_STREAMEDVEC4,    \
-                                          NGL_NODE_STREAMEDMAT4,    \
+#define UNIFORMS_TYPES_LIST (const int[]){NGL_NODE_UNIFORMFLOAT,      \
+                                          NGL_NODE_UNIFORMVEC2,       \
+                                          NGL_NODE_UNIFORMVEC3,       \
+                                          NGL_NODE_UNIFORMVEC4,       \
+                                          NGL_NODE_UNIFORMQUAT,       \
+                                          NGL_NODE_UNIFORMINT,        \
+                                          NGL_NODE_UNIFORMMAT4,       \
+                                          NGL_NODE_ANIMATEDFLOAT,     \
+                                          NGL_NODE_ANIMATEDVEC2,      \
+                                          NGL_NODE_ANIMATEDVEC3,      \
+                                          NGL_NODE_ANIMATEDVEC4,      \
+                                          NGL_NODE_ANIMATEDQUAT,      \
+                                          NGL_NODE_STREAMEDINT,       \
+                                          NGL_NODE_STREAMEDFLOAT,     \
+                                          NGL_NODE_STREAMEDVEC2,      \
+                                          NGL_NODE_STREAMEDVEC3,      \
+                                          NGL_NODE_STREAMEDVEC4,      \
+                                          NGL_NODE_STREAMEDMAT4,      \
+                                          NGL_NODE_STREAMEDFILEINT,   \
+                                          NGL_NODE_STREAMEDFILEFLOAT, \
+                                          NGL_NODE_STREAMEDFILEVEC2,  \
+                                          NGL_NODE_STREAMEDFILEVEC3,  \
+                                          NGL_NODE_STREAMEDFILEVEC4,  \
+                                          NGL_NODE_STREAMEDFILEMAT4,  \
                                           -1}
 
+static const struct param_choices barrier_choices = {
+    .name = "barrier",
+    .consts = {
+        {"vertex_attrib",  NGLI_BARRIER_VERTEX_ATTRIB_BIT,  .desc=NGLI_DOCSTRING("vertex attributes sourced from buffers")},
+        {"element_array",  NGLI_BARRIER_ELEMENT_ARRAY_BIT,  .desc=NGLI_DOCSTRING("geometry indices sourced from buffers")},
+        {"uniform",        NGLI_BARRIER_UNIFORM_BIT,        .desc=NGLI_DOCSTRING("uniform blocks sourced from buffers")},
+        {"texture_fetch",  NGLI_BARRIER_TEXTURE_FETCH_BIT,  .desc=NGLI_DOCSTRING("textures sampled in shaders")},
+        {"image_access",   NGLI_BARRIER_IMAGE_ACCESS_BIT,   .desc=NGLI_DOCSTRING("images loaded and stored in shaders")},
+        {"command",        NGLI_BARRIER_COMMAND_BIT,        .desc=NGLI_DOCSTRING("indirect commands sourced from buffers")},
+        {"buffer_update",  NGLI_BARRIER_BUFFER_UPDATE_BIT,  .desc=NGLI_DOCSTRING("buffers read back or updated")},
+        {"texture_update", NGLI_BARRIER_TEXTURE_UPDATE_BIT, .desc=NGLI_DOCSTRING("textures read back or updated")},
+        {"framebuffer",    NGLI_BARRIER_FRAMEBUFFER_BIT,    .desc=NGLI_DOCSTRING("textures rendered to")},
+        {"storage",        NGLI_BARRIER_STORAGE_BIT,        .desc=NGLI_DOCSTRING("storage blocks accessed in shaders")},
+        {"pixel_buffer",   NGLI_BARRIER_PIXEL_BUFFER_BIT,   .desc=NGLI_DOCSTRING("textures updated from block fields")},
+        {NULL}
+    }
+};
+
 #define OFFSET(x) offsetof(struct compute_priv, x)
 static const struct node_param compute_params[] = {
     {"nb_group_x", PARAM_TYPE_INT,      OFFSET(nb_group_x), .flags=PARAM_FLAG_CONSTRUCTOR,
@@ -85,6 +113,17 @@ static const struct node_param compute_params[] = {
                    .desc=NGLI_DOCSTRING("uniforms made accessible to the compute `program`")},
     {"blocks",     PARAM_TYPE_NODEDICT, OFFSET(blocks),     .node_types=(const int[]){NGL_NODE_BLOCK, -1},
                    .desc=NGLI_DOCSTRING("input and output blocks made accessible to the compute `program`")},
+    {"indirect_buffer", PARAM_TYPE_NODE, OFFSET(indirect_buffer),
+                   .node_types=(const int[]){NGL_NODE_BUFFERUIVEC3, -1},
+                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
+                   .desc=NGLI_DOCSTRING("buffer from which the number of work groups is read, instead of `nb_group_x`, "
+                                        "`nb_group_y` and `nb_group_z`; it can reference a `Block` field written by "
+                                        "a previous compute declaring a `command` barrier")},
+    {"barriers",   PARAM_TYPE_FLAGS,    OFFSET(barriers),   {.i64=-1},
+                   .choices=&barrier_choices,
+                   .desc=NGLI_DOCSTRING("operations that must observe the writes of the compute, issued as a memory "
+                                        "barrier after the dispatch; all of them when unset, none with `0` to batch "
+                                        "independent computes under the barrier of the last one")},
     {NULL}
 };
 
@@ -101,6 +140,8 @@ static int compute_init(struct ngl_node *node)
         .nb_group_x = s->nb_group_x,
         .nb_group_y = s->nb_group_y,
         .nb_group_z = s->nb_group_z,
+        .indirect_buffer = s->indirect_buffer,
+        .barriers = s->barriers,
     };
     return ngli_pass_init(&s->pass, ctx, &params);
 }
@@ -119,8 +160,17 @@ static int compute_update(struct ngl_node *node, double t)
 
 static void compute_draw(struct ngl_node *node)
 {
+    /* The dispatch results are shared by all the outputs */
+    if (node->ctx->drawing_outputs)
+        return;
+
     struct compute_priv *s = node->priv_data;
+    NGLI_TRACEMARKER_BEGIN(compute, node->label);
     ngli_pass_exec(&s->pass);
+    NGLI_TRACEMARKER_END(compute);
+
+    /* The resources written by the shader are not tracked individually */
+    node->ctx->compute_write_gen = ++node->ctx->gpu_write_gen;
 }
 
 const struct node_class ngli_compute_class = {
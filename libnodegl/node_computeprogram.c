@@ -40,7 +40,7 @@ static int computeprogram_init(struct ngl_node *node)
     struct ngl_ctx *ctx = node->ctx;
     struct program_priv *s = node->priv_data;
 
-    return ngli_program_init(&s->program, ctx, NULL, NULL, s->compute);
+    return ngli_program_submit(&s->program, ctx, NULL, NULL, s->compute);
 }
 
 static void computeprogram_uninit(struct ngl_node *node)
@@ -19,16 +19,43 @@
  * under the License.
  */
 
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "hmap.h"
 #include "log.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "topology.h"
+#include "utils.h"
+#include "vertexcache.h"
 
-struct ngl_node *ngli_node_geometry_generate_buffer(struct ngl_ctx *ctx, int type, int count, int size, void *data)
+struct geometry_buffer {
+    char *key;
+    struct ngl_node *node;
+    int refcount;
+};
+
+static uint64_t hash_data(const uint8_t *data, int size)
+{
+    /* FNV-1a */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static char *get_buffer_key(int type, int count, int size, const void *data)
+{
+    return ngli_asprintf("%d:%d:%d:%016" PRIx64, type, count, size, hash_data(data, size));
+}
+
+static struct ngl_node *create_buffer(struct ngl_ctx *ctx, int type, int count, int size, void *data)
 {
     struct ngl_node *node = ngl_node_create(type, count);
     if (!node)
@@ -48,6 +75,125 @@ fail:
     return NULL;
 }
 
+static void release_buffer(struct ngl_node **nodep)
+{
+    struct ngl_node *node = *nodep;
+    if (!node)
+        return;
+    ngli_node_detach_ctx(node, node->ctx);
+    ngl_node_unrefp(nodep);
+}
+
+struct ngl_node *ngli_node_geometry_generate_buffer(struct ngl_ctx *ctx, int type, int count, int size, void *data)
+{
+    if (!data)
+        return create_buffer(ctx, type, count, size, data);
+
+    char *key = get_buffer_key(type, count, size, data);
+    if (!key)
+        return NULL;
+
+    if (!ctx->geometry_buffer_pool) {
+        ctx->geometry_buffer_pool = ngli_hmap_create();
+        if (!ctx->geometry_buffer_pool) {
+            ngli_free(key);
+            return NULL;
+        }
+    }
+
+    struct geometry_buffer *shared = ngli_hmap_get(ctx->geometry_buffer_pool, key);
+    if (shared) {
+        ngli_free(key);
+        const struct buffer_priv *buffer = shared->node->priv_data;
+        /* A hash collision leaves the buffer unshared */
+        if (buffer->data_size != size || memcmp(buffer->data, data, size))
+            return create_buffer(ctx, type, count, size, data);
+        shared->refcount++;
+        return shared->node;
+    }
+
+    shared = ngli_calloc(1, sizeof(*shared));
+    if (!shared) {
+        ngli_free(key);
+        return NULL;
+    }
+    shared->key = key;
+    shared->refcount = 1;
+    shared->node = create_buffer(ctx, type, count, size, data);
+    if (!shared->node || ngli_hmap_set(ctx->geometry_buffer_pool, key, shared) < 0) {
+        release_buffer(&shared->node);
+        ngli_free(shared->key);
+        ngli_free(shared);
+        return NULL;
+    }
+    return shared->node;
+}
+
+void ngli_node_geometry_release_buffer(struct ngl_node **nodep)
+{
+    struct ngl_node *node = *nodep;
+    if (!node)
+        return;
+
+    struct ngl_ctx *ctx = node->ctx;
+    const struct buffer_priv *buffer = node->priv_data;
+    struct geometry_buffer *shared = NULL;
+    if (ctx->geometry_buffer_pool && buffer->data) {
+        char *key = get_buffer_key(node->class->id, buffer->count, buffer->data_size, buffer->data);
+        if (key) {
+            shared = ngli_hmap_get(ctx->geometry_buffer_pool, key);
+            ngli_free(key);
+        }
+    }
+
+    if (!shared || shared->node != node) {
+        release_buffer(nodep);
+        return;
+    }
+
+    *nodep = NULL;
+    if (--shared->refcount)
+        return;
+
+    ngli_hmap_set(ctx->geometry_buffer_pool, shared->key, NULL);
+    release_buffer(&shared->node);
+    ngli_free(shared->key);
+    ngli_free(shared);
+    if (!ngli_hmap_count(ctx->geometry_buffer_pool))
+        ngli_hmap_freep(&ctx->geometry_buffer_pool);
+}
+
+/*
+ * The bounds are computed once, so they are only available when the
+ * vertices can not change after the initialization
+ */
+void ngli_node_geometry_compute_bounds(struct geometry_priv *s)
+{
+    s->has_bounds = 0;
+
+    /* The skinned vertices are only positioned by the vertex shader */
+    const struct ngl_node *vertices_node = s->vertices_buffer;
+    if (vertices_node->class->id != NGL_NODE_BUFFERVEC3 || s->joints_buffer)
+        return;
+
+    const struct buffer_priv *vertices = vertices_node->priv_data;
+    if (vertices->block || !vertices->data || !vertices->count)
+        return;
+
+    const uint8_t *data = vertices->data;
+    memcpy(s->bounds_min, data, sizeof(s->bounds_min));
+    memcpy(s->bounds_max, data, sizeof(s->bounds_max));
+    for (int i = 1; i < vertices->count; i++) {
+        float v[3];
+        memcpy(v, data + i * vertices->data_stride, sizeof(v));
+        for (int j = 0; j < 3; j++) {
+            s->bounds_min[j] = NGLI_MIN(s->bounds_min[j], v[j]);
+            s->bounds_max[j] = NGLI_MAX(s->bounds_max[j], v[j]);
+        }
+    }
+    s->has_bounds = 1;
+}
+
 static const struct param_choices topology_choices = {
     .name = "topology",
     .consts = {
@@ -64,15 +210,35 @@ static const struct param_choices topology_choices = {
 #define TEXCOORDS_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,            \
                                            NGL_NODE_BUFFERVEC2,             \
                                            NGL_NODE_BUFFERVEC3,             \
+                                           NGL_NODE_BUFFERHALF,             \
+                                           NGL_NODE_BUFFERHVEC2,            \
+                                           NGL_NODE_BUFFERHVEC3,            \
+                                           NGL_NODE_BUFFERUSHORT,           \
+                                           NGL_NODE_BUFFERUSVEC2,           \
+                                           NGL_NODE_BUFFERUSVEC3,           \
                                            NGL_NODE_ANIMATEDBUFFERFLOAT,    \
                                            NGL_NODE_ANIMATEDBUFFERVEC2,     \
                                            NGL_NODE_ANIMATEDBUFFERVEC3,     \
                                            -1}
 
+#define NORMALS_TYPES_LIST (const int[]){NGL_NODE_BUFFERVEC3,               \
+                                         NGL_NODE_BUFFERHVEC3,              \
+                                         NGL_NODE_BUFFERSVEC3,              \
+                                         NGL_NODE_BUFFERPACK10,             \
+                                         NGL_NODE_ANIMATEDBUFFERVEC3,       \
+                                         -1}
+
+#define JOINTS_TYPES_LIST (const int[]){NGL_NODE_BUFFERVEC4, -1}
+
+#define WEIGHTS_TYPES_LIST (const int[]){NGL_NODE_BUFFERVEC4,               \
+                                         NGL_NODE_BUFFERUBVEC4,             \
+                                         NGL_NODE_BUFFERUSVEC4,             \
+                                         -1}
+
 #define OFFSET(x) offsetof(struct geometry_priv, x)
 static const struct node_param geometry_params[] = {
     {"vertices",  PARAM_TYPE_NODE, OFFSET(vertices_buffer),
-                  .node_types=(const int[]){NGL_NODE_BUFFERVEC3, NGL_NODE_ANIMATEDBUFFERVEC3, -1},
+                  .node_types=(const int[]){NGL_NODE_BUFFERVEC3, NGL_NODE_BUFFERHVEC3, NGL_NODE_ANIMATEDBUFFERVEC3, -1},
                   .flags=PARAM_FLAG_CONSTRUCTOR | PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("vertice coordinates defining the geometry")},
     {"uvcoords",  PARAM_TYPE_NODE, OFFSET(uvcoords_buffer),
@@ -80,9 +246,19 @@ static const struct node_param geometry_params[] = {
                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("coordinates used for UV mapping of each `vertices`")},
     {"normals",   PARAM_TYPE_NODE, OFFSET(normals_buffer),
-                  .node_types=(const int[]){NGL_NODE_BUFFERVEC3, NGL_NODE_ANIMATEDBUFFERVEC3, -1},
+                  .node_types=NORMALS_TYPES_LIST,
                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("normal vectors of each `vertices`")},
+    {"joints",    PARAM_TYPE_NODE, OFFSET(joints_buffer),
+                  .node_types=JOINTS_TYPES_LIST,
+                  .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
+                  .desc=NGLI_DOCSTRING("indices of the 4 joints of a `Skin` influencing each `vertices`, "
+                                       "exposed as the `ngl_joints` attribute")},
+    {"weights",   PARAM_TYPE_NODE, OFFSET(weights_buffer),
+                  .node_types=WEIGHTS_TYPES_LIST,
+                  .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
+                  .desc=NGLI_DOCSTRING("influence of each of the `joints` on each `vertices`, "
+                                       "exposed as the `ngl_weights` attribute")},
     {"indices",   PARAM_TYPE_NODE, OFFSET(indices_buffer),
                   .node_types=(const int[]){NGL_NODE_BUFFERUSHORT, NGL_NODE_BUFFERUINT, -1},
                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
@@ -90,9 +266,74 @@ static const struct node_param geometry_params[] = {
     {"topology",  PARAM_TYPE_SELECT, OFFSET(topology), {.i64=NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST},
                   .choices=&topology_choices,
                   .desc=NGLI_DOCSTRING("primitive topology")},
+    {"optimize_indices", PARAM_TYPE_BOOL, OFFSET(optimize_indices), {.i64=0},
+                  .desc=NGLI_DOCSTRING("reorder the triangles of the `indices` at initialization for the GPU vertex cache "
+                                       "(only for the `triangle_list` topology with static in-memory indices)")},
     {NULL}
 };
 
+/*
+ * The triangles are reordered in place in the indices buffer data, before it
+ * is uploaded: the set of triangles is unchanged, so the other users of the
+ * buffer are not affected
+ */
+static int optimize_indices(struct ngl_node *node)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    if (!s->indices_buffer || s->topology != NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) {
+        LOG(ERROR, "indices optimization requires indices with a triangle_list topology");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    struct buffer_priv *indices = s->indices_buffer->priv_data;
+    if (!indices->data || indices->filename || indices->block || indices->data_ref || indices->dynamic) {
+        LOG(WARNING, "only static in-memory indices can be optimized, keeping the original order");
+        return 0;
+    }
+
+    /* A trailing incomplete triangle is left as is */
+    const int nb_indices = indices->count - indices->count % 3;
+    const struct buffer_priv *vertices = s->vertices_buffer->priv_data;
+    uint32_t *src = ngli_malloc(nb_indices * sizeof(*src));
+    uint32_t *dst = ngli_malloc(nb_indices * sizeof(*dst));
+    int ret = NGL_ERROR_MEMORY;
+    if (!src || !dst)
+        goto end;
+
+    const int is_short = s->indices_buffer->class->id == NGL_NODE_BUFFERUSHORT;
+    if (is_short) {
+        const uint16_t *data = (const uint16_t *)indices->data;
+        for (int i = 0; i < nb_indices; i++)
+            src[i] = data[i];
+    } else {
+        memcpy(src, indices->data, nb_indices * sizeof(*src));
+    }
+
+    ret = ngli_vertexcache_optimize(dst, src, nb_indices, vertices->count);
+    if (ret < 0) {
+        LOG(ERROR, "could not optimize the indices");
+        goto end;
+    }
+
+    LOG(DEBUG, "ACMR: %f -> %f",
+        ngli_vertexcache_get_acmr(src, nb_indices, 32),
+        ngli_vertexcache_get_acmr(dst, nb_indices, 32));
+
+    if (is_short) {
+        uint16_t *data = (uint16_t *)indices->data;
+        for (int i = 0; i < nb_indices; i++)
+            data[i] = dst[i];
+    } else {
+        memcpy(indices->data, dst, nb_indices * sizeof(*dst));
+    }
+
+end:
+    ngli_free(src);
+    ngli_free(dst);
+    return ret;
+}
+
 static int geometry_init(struct ngl_node *node)
 {
     struct geometry_priv *s = node->priv_data;
@@ -121,6 +362,32 @@ static int geometry_init(struct ngl_node *node)
         }
     }
 
+    if (!s->joints_buffer != !s->weights_buffer) {
+        LOG(ERROR, "joints and weights must be set together");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (s->joints_buffer) {
+        const struct buffer_priv *joints = s->joints_buffer->priv_data;
+        const struct buffer_priv *weights = s->weights_buffer->priv_data;
+        if (joints->count != vertices->count || weights->count != vertices->count) {
+            LOG(ERROR,
+                "joints count (%d) and weights count (%d) do not match vertices count (%d)",
+                joints->count,
+                weights->count,
+                vertices->count);
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    if (s->optimize_indices) {
+        int ret = optimize_indices(node);
+        if (ret < 0)
+            return ret;
+    }
+
+    ngli_node_geometry_compute_bounds(s);
+
     return 0;
 }
 
@@ -144,11 +411,21 @@ static int geometry_update(struct ngl_node *node, double t)
             return ret;
     }
 
+    if (s->joints_buffer) {
+        ret = ngli_node_update(s->joints_buffer, t);
+        if (ret < 0)
+            return ret;
+        ret = ngli_node_update(s->weights_buffer, t);
+        if (ret < 0)
+            return ret;
+    }
+
     return 0;
 }
 
 const struct node_class ngli_geometry_class = {
     .id        = NGL_NODE_GEOMETRY,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "Geometry",
     .init      = geometry_init,
     .update    = geometry_update,
@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "glincludes.h"
+#include "glstate.h"
 #include "graphicconfig.h"
 #include "log.h"
 #include "nodegl.h"
@@ -62,7 +63,11 @@ struct graphicconfig_priv {
     float scissor[4];
     int use_scissor;
 
+    /* Configuration (and its GL state) resolved for the last parent one */
+    int resolved;
+    struct graphicconfig parent;
     struct graphicconfig graphicconfig;
+    struct glstate glstate;
 };
 
 #define DEFAULT_SCISSOR {-1.0f, -1.0f, -1.0f, -1.0f}
@@ -241,52 +246,66 @@ static int graphicconfig_update(struct ngl_node *node, double t)
 
 #define COPY_PARAM(name) do {        \
     if (s->name != -1) {             \
-        pending->name = s->name;     \
+        gc->name = s->name;          \
     }                                \
 } while (0)                          \
 
+static void resolve_config(struct graphicconfig_priv *s, const struct graphicconfig *parent)
+{
+    struct graphicconfig *gc = &s->graphicconfig;
+
+    s->parent = *parent;
+    *gc = *parent;
+
+    COPY_PARAM(blend);
+    COPY_PARAM(blend_dst_factor);
+    COPY_PARAM(blend_src_factor);
+    COPY_PARAM(blend_dst_factor_a);
+    COPY_PARAM(blend_src_factor_a);
+    COPY_PARAM(blend_op);
+    COPY_PARAM(blend_op_a);
+
+    COPY_PARAM(color_write_mask);
+
+    COPY_PARAM(depth_test);
+    COPY_PARAM(depth_write_mask);
+    COPY_PARAM(depth_func);
+
+    COPY_PARAM(stencil_test);
+    COPY_PARAM(stencil_write_mask);
+    COPY_PARAM(stencil_func);
+    COPY_PARAM(stencil_ref);
+    COPY_PARAM(stencil_read_mask);
+    COPY_PARAM(stencil_fail);
+    COPY_PARAM(stencil_depth_fail);
+    COPY_PARAM(stencil_depth_pass);
+
+    COPY_PARAM(cull_face);
+    COPY_PARAM(cull_face_mode);
+
+    COPY_PARAM(scissor_test);
+    if (s->use_scissor) {
+        for (int i = 0; i < 4; i++)
+            gc->scissor[i] = s->scissor[i];
+    }
+
+    memset(&s->glstate, 0, sizeof(s->glstate));
+    ngli_glstate_resolve(&s->glstate, gc);
+    s->resolved = 1;
+}
+
 static void honor_config(struct ngl_node *node, int restore)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct graphicconfig_priv *s = node->priv_data;
 
     if (restore) {
-        ctx->graphicconfig = s->graphicconfig;
+        ngli_glstate_set_pending(ctx, &s->parent, NULL);
     } else {
-        struct graphicconfig *pending = &ctx->graphicconfig;
-        s->graphicconfig = *pending;
-
-        COPY_PARAM(blend);
-        COPY_PARAM(blend_dst_factor);
-        COPY_PARAM(blend_src_factor);
-        COPY_PARAM(blend_dst_factor_a);
-        COPY_PARAM(blend_src_factor_a);
-        COPY_PARAM(blend_op);
-        COPY_PARAM(blend_op_a);
-
-        COPY_PARAM(color_write_mask);
-
-        COPY_PARAM(depth_test);
-        COPY_PARAM(depth_write_mask);
-        COPY_PARAM(depth_func);
-
-        COPY_PARAM(stencil_test);
-        COPY_PARAM(stencil_write_mask);
-        COPY_PARAM(stencil_func);
-        COPY_PARAM(stencil_ref);
-        COPY_PARAM(stencil_read_mask);
-        COPY_PARAM(stencil_fail);
-        COPY_PARAM(stencil_depth_fail);
-        COPY_PARAM(stencil_depth_pass);
-
-        COPY_PARAM(cull_face);
-        COPY_PARAM(cull_face_mode);
-
-        COPY_PARAM(scissor_test);
-        if (s->use_scissor) {
-            for (int i = 0; i < 4; i++)
-                pending->scissor[i] = s->scissor[i];
-        }
+        /* The parent configuration is usually the same from one frame to another */
+        if (!s->resolved || memcmp(&s->parent, &ctx->graphicconfig, sizeof(s->parent)))
+            resolve_config(s, &ctx->graphicconfig);
+        ngli_glstate_set_pending(ctx, &s->graphicconfig, &s->glstate);
     }
 }
 
@@ -300,8 +319,16 @@ static void graphicconfig_draw(struct ngl_node *node)
     honor_config(node, 1);
 }
 
+int ngli_node_graphicconfig_tests_depth(const struct ngl_node *node)
+{
+    const struct graphicconfig_priv *s = node->priv_data;
+    return s->depth_test == 1 || s->stencil_test == 1;
+}
+
 const struct node_class ngli_graphicconfig_class = {
     .id        = NGL_NODE_GRAPHICCONFIG,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "GraphicConfig",
     .init      = graphicconfig_init,
     .update    = graphicconfig_update,
@@ -22,25 +22,71 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include "darray.h"
+#include "log.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "pass.h"
 
 struct group_priv {
     struct ngl_node **children;
     int nb_children;
+    int sort_draws;
+    int frozen;
+    int depth_sort;
+    int depth_prepass;
+
+    /* Draws of the children, only valid for the parent state they were recorded with */
+    int frozen_recorded;
+    struct darray frozen_items;
+    NGLI_ALIGNED_MAT(frozen_modelview_matrix);
+    NGLI_ALIGNED_MAT(frozen_projection_matrix);
+    struct graphicconfig frozen_graphicconfig;
+    int frozen_depth_flags[2];
+    int frozen_live_change_gen;
 };
 
 #define OFFSET(x) offsetof(struct group_priv, x)
 static const struct node_param group_params[] = {
     {"children", PARAM_TYPE_NODELIST, OFFSET(children),
                  .desc=NGLI_DOCSTRING("a set of scenes")},
+    {"sort_draws", PARAM_TYPE_BOOL, OFFSET(sort_draws), {.i64=0},
+                   .desc=NGLI_DOCSTRING("reorder the draws of the children to reduce the graphic state changes, "
+                                        "only the opaque draws relying on the depth test are affected; "
+                                        "consecutive compatible draws using `ngl_instance_modelview_matrix` "
+                                        "are also merged into instanced draws")},
+    {"frozen", PARAM_TYPE_BOOL, OFFSET(frozen), {.i64=0},
+               .desc=NGLI_DOCSTRING("record the draws of the children once and replay them without updating "
+                                    "nor drawing the children again, which must thus be static; the draws are "
+                                    "recorded again when the parent transforms or graphic configuration change, "
+                                    "or when a parameter is live changed. The draws are reordered as with "
+                                    "`sort_draws`")},
+    {"depth_sort", PARAM_TYPE_BOOL, OFFSET(depth_sort), {.i64=0},
+                   .desc=NGLI_DOCSTRING("with `sort_draws` or `frozen`, sort the opaque draws front to back "
+                                        "instead of by state so the depth test discards the hidden fragments "
+                                        "early, and move the blended draws relying on the depth test after "
+                                        "them; also applies to the nested groups")},
+    {"depth_prepass", PARAM_TYPE_BOOL, OFFSET(depth_prepass), {.i64=0},
+                      .desc=NGLI_DOCSTRING("with `depth_sort`, render the depth of the opaque draws first, then "
+                                           "shade them with an equal depth test so every pixel is only shaded "
+                                           "once; only worth it with expensive fragment shaders")},
     {NULL}
 };
 
+static int group_init(struct ngl_node *node)
+{
+    struct group_priv *s = node->priv_data;
+    ngli_darray_init(&s->frozen_items, sizeof(struct draw_item), 1);
+    return 0;
+}
+
 static int group_update(struct ngl_node *node, double t)
 {
     struct group_priv *s = node->priv_data;
 
+    if (s->frozen_recorded && s->frozen_live_change_gen == node->ctx->live_change_gen)
+        return 0;
+
     for (int i = 0; i < s->nb_children; i++) {
         struct ngl_node *child = s->children[i];
         int ret = ngli_node_update(child, t);
@@ -51,20 +97,142 @@ static int group_update(struct ngl_node *node, double t)
     return 0;
 }
 
-static void group_draw(struct ngl_node *node)
+static int frozen_items_valid(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct group_priv *s = node->priv_data;
+
+    if (!s->frozen_recorded || s->frozen_live_change_gen != ctx->live_change_gen)
+        return 0;
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+    return !memcmp(s->frozen_modelview_matrix, modelview->matrix, sizeof(s->frozen_modelview_matrix)) &&
+           !memcmp(s->frozen_projection_matrix, projection_matrix, sizeof(s->frozen_projection_matrix)) &&
+           !memcmp(&s->frozen_graphicconfig, &ctx->graphicconfig, sizeof(s->frozen_graphicconfig)) &&
+           s->frozen_depth_flags[0] == ctx->draw_list_depth_sort &&
+           s->frozen_depth_flags[1] == ctx->draw_list_depth_prepass;
+}
+
+static void record_frozen_items(struct ngl_node *node, int start)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct group_priv *s = node->priv_data;
+
+    const struct draw_item *items = ngli_darray_data(&ctx->draw_items);
+    for (int i = start; i < ngli_darray_count(&ctx->draw_items); i++) {
+        if (!ngli_darray_push(&s->frozen_items, &items[i])) {
+            s->frozen_items.count = 0;
+            return;
+        }
+    }
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+    memcpy(s->frozen_modelview_matrix, modelview->matrix, sizeof(s->frozen_modelview_matrix));
+    memcpy(s->frozen_projection_matrix, projection_matrix, sizeof(s->frozen_projection_matrix));
+    s->frozen_graphicconfig = ctx->graphicconfig;
+    s->frozen_depth_flags[0] = ctx->draw_list_depth_sort;
+    s->frozen_depth_flags[1] = ctx->draw_list_depth_prepass;
+    s->frozen_live_change_gen = ctx->live_change_gen;
+    s->frozen_recorded = 1;
+}
+
+static void frozen_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct group_priv *s = node->priv_data;
+
+    ngli_pass_begin_draw_list(ctx);
+
+    if (frozen_items_valid(node)) {
+        const struct draw_item *items = ngli_darray_data(&s->frozen_items);
+        for (int i = 0; i < ngli_darray_count(&s->frozen_items); i++) {
+            struct draw_item *item = ngli_darray_push(&ctx->draw_items, &items[i]);
+            if (!item)
+                break;
+            item->index = ngli_darray_count(&ctx->draw_items) - 1;
+            ctx->nb_pass_execs++;
+        }
+        ngli_pass_end_draw_list(ctx);
+        return;
+    }
+
+    s->frozen_recorded = 0;
+    s->frozen_items.count = 0;
+
+    const int start = ngli_darray_count(&ctx->draw_items);
+    const int nb_pass_execs = ctx->nb_pass_execs;
     for (int i = 0; i < s->nb_children; i++) {
         struct ngl_node *child = s->children[i];
         ngli_node_draw(child);
     }
+
+    /*
+     * The recording is only usable if every pass executed by the children
+     * ended up in the draw list: a pass not ready yet or a node flushing the
+     * draw list (such as a RenderToTexture) makes it retried on the next frame
+     */
+    const int nb_items = ngli_darray_count(&ctx->draw_items) - start;
+    if (nb_items == ctx->nb_pass_execs - nb_pass_execs)
+        record_frozen_items(node, start);
+    else
+        LOG(DEBUG, "%s: the draws of the children could not be recorded", node->label);
+
+    ngli_pass_end_draw_list(ctx);
+}
+
+static void group_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct group_priv *s = node->priv_data;
+
+    /* The recorded draws of a frozen group do not tell where they land */
+    if (ctx->damage_pass) {
+        for (int i = 0; i < s->nb_children; i++)
+            ngli_node_draw(s->children[i]);
+        return;
+    }
+
+    const int depth_sort = ctx->draw_list_depth_sort;
+    const int depth_prepass = ctx->draw_list_depth_prepass;
+    ctx->draw_list_depth_sort |= s->depth_sort;
+    ctx->draw_list_depth_prepass |= s->depth_prepass;
+
+    if (s->frozen) {
+        frozen_draw(node);
+    } else {
+        if (s->sort_draws)
+            ngli_pass_begin_draw_list(ctx);
+
+        for (int i = 0; i < s->nb_children; i++) {
+            struct ngl_node *child = s->children[i];
+            ngli_node_draw(child);
+        }
+
+        if (s->sort_draws)
+            ngli_pass_end_draw_list(ctx);
+    }
+
+    ctx->draw_list_depth_sort = depth_sort;
+    ctx->draw_list_depth_prepass = depth_prepass;
+}
+
+static void group_uninit(struct ngl_node *node)
+{
+    struct group_priv *s = node->priv_data;
+    ngli_darray_reset(&s->frozen_items);
 }
 
 const struct node_class ngli_group_class = {
     .id        = NGL_NODE_GROUP,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Group",
+    .init      = group_init,
     .update    = group_update,
     .draw      = group_draw,
+    .uninit    = group_uninit,
     .priv_size = sizeof(struct group_priv),
     .params    = group_params,
     .file      = __FILE__,
@@ -19,22 +19,71 @@
  * under the License.
  */
 
-#include <fcntl.h>
 #include <inttypes.h>
 #include <math.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <unistd.h>
 
+#include "bstr.h"
+#include "csvwriter.h"
+#include "fontatlas.h"
+#include "gctx.h"
+#include "gputimer.h"
 #include "hmap.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "log.h"
 #include "drawutils.h"
+#include "pipeline.h"
+#include "program.h"
+#include "rendertarget.h"
+#include "topology.h"
+#include "type.h"
+
+struct hud_priv {
+    struct ngl_node *child;
+    int measure_window;
+    int refresh_rate[2];
+    char *export_filename;
+    float bg_color[4];
+    int aspect_ratio[2];
+
+    struct darray widgets;
+    uint32_t bg_color_u32;
+    struct csvwriter *csvwriter;
+    int64_t *csv_values;
+    int width, height;
+    double refresh_rate_interval;
+    double last_refresh_time;
+    int need_refresh;
+
+    /* Rendering of the widgets on the GPU */
+    int need_render;        // widgets refreshed since the last rendering
+    float canvas_size[2];
+    float bg_color_rgba[4]; // bg_color with the precision of the canvas
+    uint8_t *history_data;  // copy of the history texture
+    int history_w, history_h;
+    float history_size[2];
+    struct texture history;
+    struct program graph_program;
+    struct buffer quad;
+    struct pipeline graph_pipeline;
+    int rect_index;
+    int graph_rect_index;
+    int colors_index;
+    int graph_index;
+    int ring_size_index;
+    int block_index;
+    struct fontatlas *atlas;
+    float *glyphs_data;
+    int nb_glyphs;
+    int max_glyphs;
+    struct program text_program;
+    struct buffer glyphs;
+    struct pipeline text_pipeline;
+};
 
 #define OFFSET(x) offsetof(struct hud_priv, x)
 static const struct node_param hud_params[] = {
@@ -56,6 +105,8 @@ static const struct node_param hud_params[] = {
 #define WIDGET_PADDING 4
 #define WIDGET_MARGIN  2
 
+#define MAX_GRAPHS 7 /* maximum number of data graphs in a widget, also set in the graph shader */
+
 #define LATENCY_WIDGET_TEXT_LEN     20
 #define MEMORY_WIDGET_TEXT_LEN      25
 #define ACTIVITY_WIDGET_TEXT_LEN    12
@@ -71,12 +122,20 @@ enum {
     NB_LATENCY
 };
 
+enum {
+    TIMER_UPDATE,
+    TIMER_DRAW,
+    NB_TIMERS
+};
+
 enum {
     MEMORY_BUFFERS_CPU,
     MEMORY_BUFFERS_GPU,
     MEMORY_BLOCKS_CPU,
     MEMORY_BLOCKS_GPU,
     MEMORY_TEXTURES,
+    MEMORY_NODES_CPU,
+    MEMORY_DRAWING_CPU,
     NB_MEMORY
 };
 
@@ -174,6 +233,17 @@ static const struct {
         .node_types=(const int[]){NGL_NODE_TEXTURE2D, NGL_NODE_TEXTURE3D, -1},
         .color=0xFF3232FF,
     },
+    /* Tagged allocations of the whole process, not only of the HUD scene */
+    [MEMORY_NODES_CPU] = {
+        .label="Nodes CPU",
+        .node_types=(const int[]){-1},
+        .color=0xFF9632FF,
+    },
+    [MEMORY_DRAWING_CPU] = {
+        .label="Drawing CPU",
+        .node_types=(const int[]){-1},
+        .color=0x32D6FFFF,
+    },
 };
 
 static const struct activity_spec {
@@ -252,13 +322,8 @@ struct latency_measure {
 
 struct widget_latency {
     struct latency_measure measures[NB_LATENCY];
-
-    GLuint query;
-    void (*glGenQueries)(const struct glcontext *gl, GLsizei n, GLuint * ids);
-    void (*glDeleteQueries)(const struct glcontext *gl, GLsizei n, const GLuint * ids);
-    void (*glBeginQuery)(const struct glcontext *gl, GLenum target, GLuint id);
-    void (*glEndQuery)(const struct glcontext *gl, GLenum target);
-    void (*glGetQueryObjectui64v)(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 *params);
+    int timer_query;
+    struct gputimer timers[NB_TIMERS];
 };
 
 struct widget_memory {
@@ -284,27 +349,32 @@ struct widget {
     struct data_graph *data_graph;
     const void *user_data;
     void *priv_data;
+
+    int history_row;            // history row of the first data graph
+    int history_valid;          // history rows encoded with the current range
+    int64_t graph_min;          // range of the graphs
+    int64_t graph_max;
+    int graph_visible;
+    int block_graph;
+    float colors[MAX_GRAPHS][4];
 };
 
 struct widget_spec {
     int text_cols, text_rows;
     int graph_w, graph_h;
     int nb_data_graph;
+    int nb_csv_columns;
     size_t priv_size;
     int (*init)(struct ngl_node *node, struct widget *widget);
     void (*make_stats)(struct ngl_node *node, struct widget *widget);
     void (*draw)(struct ngl_node *node, struct widget *widget);
     void (*csv_header)(struct ngl_node *node, struct widget *widget, struct bstr *dst);
-    void (*csv_report)(struct ngl_node *node, struct widget *widget, struct bstr *dst);
+    void (*csv_report)(struct ngl_node *node, struct widget *widget, int64_t *dst);
     void (*uninit)(struct ngl_node *node, struct widget *widget);
 };
 
 /* Widget init */
 
-static void noop(const struct glcontext *gl, ...)
-{
-}
-
 static int widget_latency_init(struct ngl_node *node, struct widget *widget)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -312,28 +382,15 @@ static int widget_latency_init(struct ngl_node *node, struct widget *widget)
     struct hud_priv *s = node->priv_data;
     struct widget_latency *priv = widget->priv_data;
 
-    if (gl->features & NGLI_FEATURE_TIMER_QUERY) {
-        priv->glGenQueries          = ngli_glGenQueries;
-        priv->glDeleteQueries       = ngli_glDeleteQueries;
-        priv->glBeginQuery          = ngli_glBeginQuery;
-        priv->glEndQuery            = ngli_glEndQuery;
-        priv->glGetQueryObjectui64v = ngli_glGetQueryObjectui64v;
-    } else if (gl->features & NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY) {
-        priv->glGenQueries          = ngli_glGenQueriesEXT;
-        priv->glDeleteQueries       = ngli_glDeleteQueriesEXT;
-        priv->glBeginQuery          = ngli_glBeginQueryEXT;
-        priv->glEndQuery            = ngli_glEndQueryEXT;
-        priv->glGetQueryObjectui64v = ngli_glGetQueryObjectui64vEXT;
-    } else {
-        priv->glGenQueries          = (void *)noop;
-        priv->glDeleteQueries       = (void *)noop;
-        priv->glBeginQuery          = (void *)noop;
-        priv->glEndQuery            = (void *)noop;
-        priv->glGetQueryObjectui64v = (void *)noop;
+    priv->timer_query = 1;
+    for (int i = 0; i < NB_TIMERS; i++) {
+        int ret = ngli_gputimer_init(&priv->timers[i], gl);
+        if (ret == NGL_ERROR_UNSUPPORTED)
+            priv->timer_query = 0;
+        else if (ret < 0)
+            return ret;
     }
 
-    priv->glGenQueries(gl, 1, &priv->query);
-
     ngli_assert(NB_LATENCY == NGLI_ARRAY_NB(priv->measures));
 
     s->measure_window = NGLI_MAX(s->measure_window, 1);
@@ -446,74 +503,66 @@ static int widget_latency_update(struct ngl_node *node, struct widget *widget, d
     struct hud_priv *s = node->priv_data;
     struct ngl_node *child = s->child;
 
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct widget_latency *priv = widget->priv_data;
 
-    int timer_active = ctx->timer_active;
-    if (timer_active) {
-        LOG(WARNING, "GPU timings will not be available when using multiple HUD "
-                     "in the same graph due to GL limitations");
-    } else {
-        ctx->timer_active = 1;
-        priv->glBeginQuery(gl, GL_TIME_ELAPSED, priv->query);
-    }
+    struct gputimer *timer = &priv->timers[TIMER_UPDATE];
+    int64_t gpu_tupdate;
+    while (ngli_gputimer_read(timer, &gpu_tupdate))
+        register_time(s, &priv->measures[LATENCY_UPDATE_GPU], gpu_tupdate);
+
+    ngli_gputimer_begin(timer);
 
     int64_t update_start = ngli_gettime();
     ret = ngli_node_update(child, t);
     int64_t update_end = ngli_gettime();
 
-    GLuint64 gpu_tupdate = 0;
-    if (!timer_active) {
-        priv->glEndQuery(gl, GL_TIME_ELAPSED);
-        priv->glGetQueryObjectui64v(gl, priv->query, GL_QUERY_RESULT, &gpu_tupdate);
-        ctx->timer_active = 0;
-    }
+    ngli_gputimer_end(timer);
 
     register_time(s, &priv->measures[LATENCY_UPDATE_CPU], update_end - update_start);
-    register_time(s, &priv->measures[LATENCY_UPDATE_GPU], gpu_tupdate);
+    if (!priv->timer_query)
+        register_time(s, &priv->measures[LATENCY_UPDATE_GPU], 0);
 
     return ret;
 }
 
 /* Widget make stats */
 
+static void register_total_time(struct hud_priv *s, struct widget_latency *priv,
+                                int total_id, int update_id, int64_t tdraw)
+{
+    const struct latency_measure *up = &priv->measures[update_id];
+    const int last_up_pos = (up->pos ? up->pos : s->measure_window) - 1;
+    register_time(s, &priv->measures[total_id], tdraw + up->times[last_up_pos]);
+}
+
 static void widget_latency_make_stats(struct ngl_node *node, struct widget *widget)
 {
     struct hud_priv *s = node->priv_data;
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct widget_latency *priv = widget->priv_data;
 
-    int timer_active = ctx->timer_active;
-    if (!timer_active) {
-        ctx->timer_active = 1;
-        priv->glBeginQuery(gl, GL_TIME_ELAPSED, priv->query);
+    struct gputimer *timer = &priv->timers[TIMER_DRAW];
+    int64_t gpu_tdraw;
+    while (ngli_gputimer_read(timer, &gpu_tdraw)) {
+        register_time(s, &priv->measures[LATENCY_DRAW_GPU], gpu_tdraw);
+        register_total_time(s, priv, LATENCY_TOTAL_GPU, LATENCY_UPDATE_GPU, gpu_tdraw);
     }
 
+    ngli_gputimer_begin(timer);
+
     const int64_t draw_start = ngli_gettime();
     ngli_node_draw(s->child);
     const int64_t draw_end = ngli_gettime();
 
-    GLuint64 gpu_tdraw = 0;
-    if (!timer_active) {
-        priv->glEndQuery(gl, GL_TIME_ELAPSED);
-        priv->glGetQueryObjectui64v(gl, priv->query, GL_QUERY_RESULT, &gpu_tdraw);
-        ctx->timer_active = 0;
-    }
+    ngli_gputimer_end(timer);
 
     int64_t cpu_tdraw = draw_end - draw_start;
     register_time(s, &priv->measures[LATENCY_DRAW_CPU], cpu_tdraw);
-    register_time(s, &priv->measures[LATENCY_DRAW_GPU], gpu_tdraw);
-
-    const struct latency_measure *cpu_up = &priv->measures[LATENCY_UPDATE_CPU];
-    const struct latency_measure *gpu_up = &priv->measures[LATENCY_UPDATE_GPU];
-    const int last_cpu_up_pos = (cpu_up->pos ? cpu_up->pos : s->measure_window) - 1;
-    const int last_gpu_up_pos = (gpu_up->pos ? gpu_up->pos : s->measure_window) - 1;
-    const int64_t cpu_tupdate = cpu_up->times[last_cpu_up_pos];
-    const int64_t gpu_tupdate = gpu_up->times[last_gpu_up_pos];
-    register_time(s, &priv->measures[LATENCY_TOTAL_CPU], cpu_tdraw + cpu_tupdate);
-    register_time(s, &priv->measures[LATENCY_TOTAL_GPU], gpu_tdraw + gpu_tupdate);
+    register_total_time(s, priv, LATENCY_TOTAL_CPU, LATENCY_UPDATE_CPU, cpu_tdraw);
+
+    if (!priv->timer_query) {
+        register_time(s, &priv->measures[LATENCY_DRAW_GPU], 0);
+        register_time(s, &priv->measures[LATENCY_TOTAL_GPU], 0);
+    }
 }
 
 static void widget_memory_make_stats(struct ngl_node *node, struct widget *widget)
@@ -526,7 +575,7 @@ static void widget_memory_make_stats(struct ngl_node *node, struct widget *widge
     for (int i = 0; i < ngli_darray_count(nodes_buf_array_cpu); i++) {
         const struct ngl_node *buf_node = nodes_buf_cpu[i];
         const struct buffer_priv *buffer = buf_node->priv_data;
-        priv->sizes[MEMORY_BUFFERS_CPU] += buffer->block ? 0 : buffer->data_size;
+        priv->sizes[MEMORY_BUFFERS_CPU] += buffer->block || !buffer->data ? 0 : buffer->data_size;
     }
 
     struct darray *nodes_buf_array_gpu = &priv->nodes[MEMORY_BUFFERS_GPU];
@@ -565,6 +614,11 @@ static void widget_memory_make_stats(struct ngl_node *node, struct widget *widge
         priv->sizes[MEMORY_TEXTURES] += ngli_image_get_memory_size(&texture->image)
                                       * tex_node->is_active;
     }
+
+    int64_t live[NGLI_MEMTAG_NB], peak[NGLI_MEMTAG_NB];
+    ngli_memory_get_usage(live, peak);
+    priv->sizes[MEMORY_NODES_CPU] = live[NGLI_MEMTAG_NODES];
+    priv->sizes[MEMORY_DRAWING_CPU] = live[NGLI_MEMTAG_DRAWING];
 }
 
 static void widget_activity_make_stats(struct ngl_node *node, struct widget *widget)
@@ -589,94 +643,108 @@ static void widget_drawcall_make_stats(struct ngl_node *node, struct widget *wid
 
 /* Draw utils */
 
-static inline uint8_t *set_color(uint8_t *p, uint32_t rgba)
+static void set_graph_color(struct widget *widget, int graph, uint32_t rgba)
 {
-    p[0] = rgba >> 24;
-    p[1] = rgba >> 16 & 0xff;
-    p[2] = rgba >>  8 & 0xff;
-    p[3] = rgba       & 0xff;
-    return p + 4;
+    float *color = widget->colors[graph];
+    color[0] = (rgba >> 24)        / 255.f;
+    color[1] = (rgba >> 16 & 0xff) / 255.f;
+    color[2] = (rgba >>  8 & 0xff) / 255.f;
+    color[3] = (rgba       & 0xff) / 255.f;
 }
 
-static inline int get_pixel_pos(struct hud_priv *s, int px, int py)
+/*
+ * The graphs are drawn on the GPU from the pixel heights of their values,
+ * kept in the history texture: every data graph has its own row, used as a
+ * ring buffer like its values. Only the column of the latest values is
+ * uploaded, unless the vertical range of the graphs changed.
+ */
+static void update_graphs(struct hud_priv *s, struct widget *widget, int nb_data_graph,
+                          int64_t graph_min, int64_t graph_max, int block)
 {
-    return (py * s->canvas.w + px) * 4;
-}
+    const int nb_values = widget->data_graph[0].nb_values;
 
-static int clip(int x, int min, int max)
-{
-    if (x < min)
-        return min;
-    if (x > max)
-        return max;
-    return x;
-}
+    widget->block_graph = block;
+    widget->graph_visible = graph_max != graph_min;
+    if (!widget->graph_visible) {
+        widget->history_valid = 0;
+        return;
+    }
+
+    const int full = !widget->history_valid || graph_min != widget->graph_min || graph_max != widget->graph_max;
+    const int x = full ? 0 : (widget->data_graph[0].pos - 1 + nb_values) % nb_values;
+    const int w = full ? nb_values : 1;
 
-static void draw_block_graph(struct hud_priv *s,
-                             const struct data_graph *d,
-                             const struct rect *rect,
-                             int64_t graph_min, int64_t graph_max,
-                             const uint32_t c)
-{
     const int64_t graph_h = graph_max - graph_min;
-    const float vscale = (float)rect->h / graph_h;
-    const int start = (d->pos - d->count + d->nb_values) % d->nb_values;
-
-    for (int k = 0; k < d->count; k++) {
-        const int64_t v = d->values[(start + k) % d->nb_values];
-        const int h = (v - graph_min) * vscale;
-        const int y = clip(rect->h - h, 0, rect->h);
-        uint8_t *p = s->canvas.buf + get_pixel_pos(s, rect->x + k, rect->y + y);
-
-        for (int z = 0; z < h; z++) {
-            set_color(p, c);
-            p += s->canvas.w * 4;
+    const float vscale = (float)widget->graph_rect.h / graph_h;
+    for (int i = 0; i < nb_data_graph; i++) {
+        const struct data_graph *d = &widget->data_graph[i];
+        uint8_t *p = s->history_data + ((widget->history_row + i) * s->history_w + x) * 4;
+        for (int k = 0; k < w; k++) {
+            const int h = (d->values[x + k] - graph_min) * vscale;
+            p[k * 4] = NGLI_MIN(NGLI_MAX(h, 0), 255);
         }
     }
+    ngli_texture_upload_region(&s->history, s->history_data, 0, x, widget->history_row, w, nb_data_graph);
+
+    widget->graph_min = graph_min;
+    widget->graph_max = graph_max;
+    widget->history_valid = 1;
 }
 
-static void draw_line_graph(struct hud_priv *s,
-                            const struct data_graph *d,
-                            const struct rect *rect,
-                            int64_t graph_min, int64_t graph_max,
-                            const uint32_t c)
+static void draw_block_graph(struct hud_priv *s, struct widget *widget,
+                             int64_t graph_min, int64_t graph_max, uint32_t c)
 {
-    const int64_t graph_h = graph_max - graph_min;
-    const float vscale = (float)rect->h / graph_h;
-    const int start = (d->pos - d->count + d->nb_values) % d->nb_values;
-    int prev_y;
-
-    for (int k = 0; k < d->count; k++) {
-        const int64_t v = d->values[(start + k) % d->nb_values];
-        const int h = (v - graph_min) * vscale;
-        const int y = clip(rect->h - 1 - h, 0, rect->h - 1);
-        uint8_t *p = s->canvas.buf + get_pixel_pos(s, rect->x + k, rect->y + y);
-
-        set_color(p, c);
-        if (k) {
-            const int sign = prev_y < y ? 1 : -1;
-            const int column_h = abs(prev_y - y);
-            uint8_t *p = s->canvas.buf + get_pixel_pos(s, rect->x + k, rect->y + prev_y);
-            for (int z = 0; z < column_h; z++) {
-                set_color(p, c);
-                p += sign * s->canvas.w * 4;
-            }
-        }
-        prev_y = y;
-    }
+    set_graph_color(widget, 0, c);
+    update_graphs(s, widget, 1, graph_min, graph_max, 1);
 }
 
-static void print_text(struct hud_priv *s, int x, int y, const char *buf, const uint32_t c)
+static void draw_line_graphs(struct hud_priv *s, struct widget *widget, int nb_data_graph,
+                             int64_t graph_min, int64_t graph_max)
 {
-    ngli_drawutils_print(&s->canvas, x, y, buf, c);
+    update_graphs(s, widget, nb_data_graph, graph_min, graph_max, 0);
 }
 
-static void widgets_clear(struct hud_priv *s)
+/* Every glyph is a quad of 2 triangles, with interleaved position (canvas
+ * pixels), texture coordinates and color */
+#define GLYPH_NB_VERTICES 6
+#define GLYPH_VERTEX_SIZE 8
+
+static void print_text(struct hud_priv *s, int x, int y, const char *buf, const uint32_t c)
 {
-    struct darray *widgets_array = &s->widgets;
-    struct widget *widgets = ngli_darray_data(widgets_array);
-    for (int i = 0; i < ngli_darray_count(widgets_array); i++)
-        ngli_drawutils_draw_rect(&s->canvas, &widgets[i].rect, s->bg_color_u32);
+    float color[4];
+    color[0] = (c >> 24)        / 255.f;
+    color[1] = (c >> 16 & 0xff) / 255.f;
+    color[2] = (c >>  8 & 0xff) / 255.f;
+    color[3] = (c       & 0xff) / 255.f;
+
+    int px = x, py = y;
+    for (int i = 0; buf[i]; i++) {
+        if (buf[i] == '\n') {
+            px = x;
+            py += NGLI_FONT_H;
+            continue;
+        }
+        if (buf[i] != ' ' && s->nb_glyphs < s->max_glyphs) {
+            float uv[4];
+            ngli_fontatlas_get_glyph_coords(buf[i], uv);
+            const float corners[4][4] = {
+                {px,               py,               uv[0], uv[1]},
+                {px + NGLI_FONT_W, py,               uv[2], uv[1]},
+                {px + NGLI_FONT_W, py + NGLI_FONT_H, uv[2], uv[3]},
+                {px,               py + NGLI_FONT_H, uv[0], uv[3]},
+            };
+            static const int triangles[GLYPH_NB_VERTICES] = {0, 1, 2, 0, 2, 3};
+
+            float *vertex = s->glyphs_data + s->nb_glyphs * GLYPH_NB_VERTICES * GLYPH_VERTEX_SIZE;
+            for (int k = 0; k < GLYPH_NB_VERTICES; k++) {
+                memcpy(vertex, corners[triangles[k]], sizeof(corners[0]));
+                memcpy(vertex + 4, color, sizeof(color));
+                vertex += GLYPH_VERTEX_SIZE;
+            }
+            s->nb_glyphs++;
+        }
+        px += NGLI_FONT_W;
+    }
 }
 
 /* Widget draw */
@@ -713,6 +781,8 @@ static void register_graph_value(struct data_graph *d, int64_t v)
 static int64_t get_latency_avg(const struct widget_latency *priv, int id)
 {
     const struct latency_measure *m = &priv->measures[id];
+    if (!m->count) // the GPU timings are read back a few frames later
+        return 0;
     return m->total_times / m->count / (latency_specs[id].unit == 'u' ? 1 : 1000);
 }
 
@@ -728,6 +798,7 @@ static void widget_latency_draw(struct ngl_node *node, struct widget *widget)
         snprintf(buf, sizeof(buf), "%s %5" PRId64 "usec", latency_specs[i].label, t);
         print_text(s, widget->text_x, widget->text_y + i * NGLI_FONT_H, buf, latency_specs[i].color);
         register_graph_value(&widget->data_graph[i], t);
+        set_graph_color(widget, i, latency_specs[i].color);
     }
 
     int64_t graph_min = widget->data_graph[0].min;
@@ -737,12 +808,7 @@ static void widget_latency_draw(struct ngl_node *node, struct widget *widget)
         graph_max = NGLI_MAX(graph_max, widget->data_graph[i].max);
     }
 
-    const int64_t graph_h = graph_max - graph_min;
-    if (graph_h) {
-        for (int i = 0; i < NB_LATENCY; i++)
-            draw_line_graph(s, &widget->data_graph[i], &widget->graph_rect,
-                            graph_min, graph_max, latency_specs[i].color);
-    }
+    draw_line_graphs(s, widget, NB_LATENCY, graph_min, graph_max);
 }
 
 static void widget_memory_draw(struct ngl_node *node, struct widget *widget)
@@ -766,6 +832,7 @@ static void widget_memory_draw(struct ngl_node *node, struct widget *widget)
             snprintf(buf, sizeof(buf), "%-12s %"PRIu64"G", label, size / (1024 * 1024 * 1024));
         print_text(s, widget->text_x, widget->text_y + i * NGLI_FONT_H, buf, color);
         register_graph_value(&widget->data_graph[i], size);
+        set_graph_color(widget, i, color);
     }
 
     int64_t graph_min = widget->data_graph[0].min;
@@ -775,12 +842,7 @@ static void widget_memory_draw(struct ngl_node *node, struct widget *widget)
         graph_max = NGLI_MAX(graph_max, widget->data_graph[i].max);
     }
 
-    const int64_t graph_h = graph_max - graph_min;
-    if (graph_h) {
-        for (int i = 0; i < NB_MEMORY; i++)
-            draw_line_graph(s, &widget->data_graph[i], &widget->graph_rect,
-                            graph_min, graph_max, memory_specs[i].color);
-    }
+    draw_line_graphs(s, widget, NB_MEMORY, graph_min, graph_max);
 }
 
 static void widget_activity_draw(struct ngl_node *node, struct widget *widget)
@@ -797,7 +859,7 @@ static void widget_activity_draw(struct ngl_node *node, struct widget *widget)
 
     struct data_graph *d = &widget->data_graph[0];
     register_graph_value(d, priv->nb_actives);
-    draw_block_graph(s, d, &widget->graph_rect, d->amin, d->amax, color);
+    draw_block_graph(s, widget, d->amin, d->amax, color);
 }
 
 static void widget_drawcall_draw(struct ngl_node *node, struct widget *widget)
@@ -814,7 +876,7 @@ static void widget_drawcall_draw(struct ngl_node *node, struct widget *widget)
 
     struct data_graph *d = &widget->data_graph[0];
     register_graph_value(d, priv->nb_draws);
-    draw_block_graph(s, d, &widget->graph_rect, d->amin, d->amax, color);
+    draw_block_graph(s, widget, d->amin, d->amax, color);
 }
 
 /* Widget CSV header */
@@ -845,47 +907,43 @@ static void widget_drawcall_csv_header(struct ngl_node *node, struct widget *wid
 
 /* Widget CSV report */
 
-static void widget_latency_csv_report(struct ngl_node *node, struct widget *widget, struct bstr *dst)
+static void widget_latency_csv_report(struct ngl_node *node, struct widget *widget, int64_t *dst)
 {
     const struct widget_latency *priv = widget->priv_data;
-    for (int i = 0; i < NB_LATENCY; i++) {
-        const int64_t t = get_latency_avg(priv, i);
-        ngli_bstr_print(dst, "%s%"PRId64, i ? "," : "", t);
-    }
+    for (int i = 0; i < NB_LATENCY; i++)
+        dst[i] = get_latency_avg(priv, i);
 }
 
-static void widget_memory_csv_report(struct ngl_node *node, struct widget *widget, struct bstr *dst)
+static void widget_memory_csv_report(struct ngl_node *node, struct widget *widget, int64_t *dst)
 {
     const struct widget_memory *priv = widget->priv_data;
-    for (int i = 0; i < NB_MEMORY; i++) {
-        const uint64_t size = priv->sizes[i];
-        ngli_bstr_print(dst, "%s%"PRIu64, i ? "," : "", size);
-    }
+    for (int i = 0; i < NB_MEMORY; i++)
+        dst[i] = priv->sizes[i];
 }
 
-static void widget_activity_csv_report(struct ngl_node *node, struct widget *widget, struct bstr *dst)
+static void widget_activity_csv_report(struct ngl_node *node, struct widget *widget, int64_t *dst)
 {
     const struct widget_activity *priv = widget->priv_data;
-    ngli_bstr_print(dst, "%d,%d", priv->nb_actives, priv->nodes.count);
+    dst[0] = priv->nb_actives;
+    dst[1] = priv->nodes.count;
 }
 
-static void widget_drawcall_csv_report(struct ngl_node *node, struct widget *widget, struct bstr *dst)
+static void widget_drawcall_csv_report(struct ngl_node *node, struct widget *widget, int64_t *dst)
 {
     const struct widget_drawcall *priv = widget->priv_data;
-    ngli_bstr_print(dst, "%d", priv->nb_draws);
+    dst[0] = priv->nb_draws;
 }
 
 /* Widget uninit */
 
 static void widget_latency_uninit(struct ngl_node *node, struct widget *widget)
 {
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct widget_latency *priv = widget->priv_data;
 
     for (int i = 0; i < NB_LATENCY; i++)
         ngli_free(priv->measures[i].times);
-    priv->glDeleteQueries(gl, 1, &priv->query);
+    for (int i = 0; i < NB_TIMERS; i++)
+        ngli_gputimer_reset(&priv->timers[i]);
 }
 
 static void widget_memory_uninit(struct ngl_node *node, struct widget *widget)
@@ -909,56 +967,60 @@ static void widget_drawcall_uninit(struct ngl_node *node, struct widget *widget)
 
 static const struct widget_spec widget_specs[] = {
     [WIDGET_LATENCY] = {
-        .text_cols     = LATENCY_WIDGET_TEXT_LEN,
-        .text_rows     = NB_LATENCY,
-        .graph_w       = 320,
-        .nb_data_graph = NB_LATENCY,
-        .priv_size     = sizeof(struct widget_latency),
-        .init          = widget_latency_init,
-        .make_stats    = widget_latency_make_stats,
-        .draw          = widget_latency_draw,
-        .csv_header    = widget_latency_csv_header,
-        .csv_report    = widget_latency_csv_report,
-        .uninit        = widget_latency_uninit,
+        .text_cols      = LATENCY_WIDGET_TEXT_LEN,
+        .text_rows      = NB_LATENCY,
+        .graph_w        = 320,
+        .nb_data_graph  = NB_LATENCY,
+        .nb_csv_columns = NB_LATENCY,
+        .priv_size      = sizeof(struct widget_latency),
+        .init           = widget_latency_init,
+        .make_stats     = widget_latency_make_stats,
+        .draw           = widget_latency_draw,
+        .csv_header     = widget_latency_csv_header,
+        .csv_report     = widget_latency_csv_report,
+        .uninit         = widget_latency_uninit,
     },
     [WIDGET_MEMORY] = {
-        .text_cols     = MEMORY_WIDGET_TEXT_LEN,
-        .text_rows     = NB_MEMORY,
-        .graph_h       = 50,
-        .nb_data_graph = NB_MEMORY,
-        .priv_size     = sizeof(struct widget_memory),
-        .init          = widget_memory_init,
-        .make_stats    = widget_memory_make_stats,
-        .draw          = widget_memory_draw,
-        .csv_header    = widget_memory_csv_header,
-        .csv_report    = widget_memory_csv_report,
-        .uninit        = widget_memory_uninit,
+        .text_cols      = MEMORY_WIDGET_TEXT_LEN,
+        .text_rows      = NB_MEMORY,
+        .graph_h        = 50,
+        .nb_data_graph  = NB_MEMORY,
+        .nb_csv_columns = NB_MEMORY,
+        .priv_size      = sizeof(struct widget_memory),
+        .init           = widget_memory_init,
+        .make_stats     = widget_memory_make_stats,
+        .draw           = widget_memory_draw,
+        .csv_header     = widget_memory_csv_header,
+        .csv_report     = widget_memory_csv_report,
+        .uninit         = widget_memory_uninit,
     },
     [WIDGET_ACTIVITY] = {
-        .text_cols     = ACTIVITY_WIDGET_TEXT_LEN,
-        .text_rows     = 2,
-        .graph_h       = 40,
-        .nb_data_graph = 1,
-        .priv_size     = sizeof(struct widget_activity),
-        .init          = widget_activity_init,
-        .make_stats    = widget_activity_make_stats,
-        .draw          = widget_activity_draw,
-        .csv_header    = widget_activity_csv_header,
-        .csv_report    = widget_activity_csv_report,
-        .uninit        = widget_activity_uninit,
+        .text_cols      = ACTIVITY_WIDGET_TEXT_LEN,
+        .text_rows      = 2,
+        .graph_h        = 40,
+        .nb_data_graph  = 1,
+        .nb_csv_columns = 2,
+        .priv_size      = sizeof(struct widget_activity),
+        .init           = widget_activity_init,
+        .make_stats     = widget_activity_make_stats,
+        .draw           = widget_activity_draw,
+        .csv_header     = widget_activity_csv_header,
+        .csv_report     = widget_activity_csv_report,
+        .uninit         = widget_activity_uninit,
     },
     [WIDGET_DRAWCALL]  = {
-        .text_cols     = DRAWCALL_WIDGET_TEXT_LEN,
-        .text_rows     = 2,
-        .graph_h       = 40,
-        .nb_data_graph = 1,
-        .priv_size     = sizeof(struct widget_drawcall),
-        .init          = widget_drawcall_init,
-        .make_stats    = widget_drawcall_make_stats,
-        .draw          = widget_drawcall_draw,
-        .csv_header    = widget_drawcall_csv_header,
-        .csv_report    = widget_drawcall_csv_report,
-        .uninit        = widget_drawcall_uninit,
+        .text_cols      = DRAWCALL_WIDGET_TEXT_LEN,
+        .text_rows      = 2,
+        .graph_h        = 40,
+        .nb_data_graph  = 1,
+        .nb_csv_columns = 1,
+        .priv_size      = sizeof(struct widget_drawcall),
+        .init           = widget_drawcall_init,
+        .make_stats     = widget_drawcall_make_stats,
+        .draw           = widget_drawcall_draw,
+        .csv_header     = widget_drawcall_csv_header,
+        .csv_report     = widget_drawcall_csv_report,
+        .uninit         = widget_drawcall_uninit,
     },
 };
 
@@ -983,15 +1045,15 @@ static inline int get_widget_height(enum widget_type type)
 static int create_widget(struct hud_priv *s, enum widget_type type, const void *user_data, int x, int y)
 {
     if (x < 0)
-        x = s->canvas.w + x;
+        x = s->width + x;
     if (y < 0)
-        y = s->canvas.h + y;
+        y = s->height + y;
 
     const struct widget_spec *spec = &widget_specs[type];
 
     ngli_assert(spec->text_cols && spec->text_rows);
     ngli_assert(spec->graph_w ^ spec->graph_h);
-    ngli_assert(spec->nb_data_graph);
+    ngli_assert(spec->nb_data_graph && spec->nb_data_graph <= MAX_GRAPHS);
 
     const int horizontal_layout = !spec->graph_h;
     struct widget widget = {
@@ -1025,6 +1087,11 @@ static int create_widget(struct hud_priv *s, enum widget_type type, const void *
     if (!widgetp->priv_data)
         return NGL_ERROR_MEMORY;
 
+    widgetp->history_row = s->history_h;
+    s->history_h += spec->nb_data_graph;
+    s->history_w = NGLI_MAX(s->history_w, widgetp->graph_rect.w);
+    s->max_glyphs += spec->text_cols * spec->text_rows;
+
     widgetp->data_graph = ngli_calloc(spec->nb_data_graph, sizeof(*widgetp->data_graph));
     if (!widgetp->data_graph)
         return NGL_ERROR_MEMORY;
@@ -1064,11 +1131,11 @@ static int widgets_init(struct ngl_node *node)
     /* Compute buffer dimensions according to user specified aspect ratio and
      * minimal dimensions */
     const int *ar = s->aspect_ratio;
-    s->canvas.w = min_width;
-    s->canvas.h = min_width * ar[1] / ar[0];
-    if (s->canvas.h < min_height) {
-        s->canvas.w = min_height * ar[0] / ar[1];
-        s->canvas.h = min_height;
+    s->width = min_width;
+    s->height = min_width * ar[1] / ar[0];
+    if (s->height < min_height) {
+        s->width = min_height * ar[0] / ar[1];
+        s->height = min_height;
     }
 
     /* Latency widget in the top-left */
@@ -1163,61 +1230,60 @@ static void widgets_draw(struct ngl_node *node)
     }
 }
 
+/* Rows of the export waiting to be written by the writer thread */
+#define CSV_RING_CAPACITY 1024
+
 static int widgets_csv_header(struct ngl_node *node)
 {
     struct hud_priv *s = node->priv_data;
 
-    s->fd_export = open(s->export_filename, O_CREAT | O_WRONLY | O_TRUNC, 0644);
-    if (s->fd_export == -1) {
-        LOG(ERROR, "unable to open \"%s\" for writing", s->export_filename);
-        return NGL_ERROR_IO;
-    }
-
-    s->csv_line = ngli_bstr_create();
-    if (!s->csv_line)
+    struct bstr *header = ngli_bstr_create();
+    if (!header)
         return NGL_ERROR_MEMORY;
 
-    ngli_bstr_print(s->csv_line, "time,");
+    ngli_bstr_print(header, "time,");
 
+    int nb_columns = 0;
     struct darray *widgets_array = &s->widgets;
     struct widget *widgets = ngli_darray_data(widgets_array);
     for (int i = 0; i < ngli_darray_count(widgets_array); i++) {
         struct widget *widget = &widgets[i];
-        ngli_bstr_print(s->csv_line, i ? "," : "");
-        widget_specs[widget->type].csv_header(node, widget, s->csv_line);
+        ngli_bstr_print(header, i ? "," : "");
+        widget_specs[widget->type].csv_header(node, widget, header);
+        nb_columns += widget_specs[widget->type].nb_csv_columns;
     }
 
-    ngli_bstr_print(s->csv_line, "\n");
-
-    const int len = ngli_bstr_len(s->csv_line);
-    ssize_t n = write(s->fd_export, ngli_bstr_strptr(s->csv_line), len);
-    if (n != len) {
-        LOG(ERROR, "unable to write CSV header");
+    s->csvwriter = ngli_csvwriter_create(s->export_filename, ngli_bstr_strptr(header),
+                                         nb_columns, CSV_RING_CAPACITY);
+    ngli_bstr_freep(&header);
+    if (!s->csvwriter)
         return NGL_ERROR_IO;
-    }
+
+    s->csv_values = ngli_calloc(nb_columns, sizeof(*s->csv_values));
+    if (!s->csv_values)
+        return NGL_ERROR_MEMORY;
 
     return 0;
 }
 
+/*
+ * Only the raw values are collected here, the formatting and the file
+ * writes happen in the CSV writer thread
+ */
 static void widgets_csv_report(struct ngl_node *node)
 {
     struct hud_priv *s = node->priv_data;
 
-    ngli_bstr_clear(s->csv_line);
-    /* Quoting to prevent locale issues with float printing */
-    ngli_bstr_print(s->csv_line, "\"%f\"", s->last_refresh_time);
-
+    int64_t *dst = s->csv_values;
     struct darray *widgets_array = &s->widgets;
     struct widget *widgets = ngli_darray_data(widgets_array);
     for (int i = 0; i < ngli_darray_count(widgets_array); i++) {
-        ngli_bstr_print(s->csv_line, ",");
         struct widget *widget = &widgets[i];
-        widget_specs[widget->type].csv_report(node, widget, s->csv_line);
+        widget_specs[widget->type].csv_report(node, widget, dst);
+        dst += widget_specs[widget->type].nb_csv_columns;
     }
-    ngli_bstr_print(s->csv_line, "\n");
 
-    const int len = ngli_bstr_len(s->csv_line);
-    write(s->fd_export, ngli_bstr_strptr(s->csv_line), len);
+    ngli_csvwriter_push(s->csvwriter, s->last_refresh_time, s->csv_values);
 }
 
 static void free_widget(struct widget *widget)
@@ -1246,16 +1312,26 @@ static int hud_init(struct ngl_node *node)
     struct hud_priv *s = node->priv_data;
 
     s->bg_color_u32 = NGLI_COLOR_VEC4_TO_U32(s->bg_color);
+    for (int i = 0; i < 4; i++)
+        s->bg_color_rgba[i] = (s->bg_color_u32 >> (24 - i * 8) & 0xff) / 255.f;
 
     int ret = widgets_init(node);
     if (ret < 0)
         return ret;
 
-    s->canvas.buf = ngli_calloc(s->canvas.w * s->canvas.h, 4);
-    if (!s->canvas.buf)
+    s->canvas_size[0] = s->width;
+    s->canvas_size[1] = s->height;
+    s->history_size[0] = s->history_w;
+    s->history_size[1] = s->history_h;
+
+    s->history_data = ngli_calloc_tagged(s->history_w * s->history_h, 4, NGLI_MEMTAG_DRAWING);
+    if (!s->history_data)
         return NGL_ERROR_MEMORY;
 
-    widgets_clear(s);
+    s->glyphs_data = ngli_calloc_tagged(s->max_glyphs * GLYPH_NB_VERTICES * GLYPH_VERTEX_SIZE, sizeof(*s->glyphs_data),
+                                        NGLI_MEMTAG_DRAWING);
+    if (!s->glyphs_data)
+        return NGL_ERROR_MEMORY;
 
     if (s->refresh_rate[1])
         s->refresh_rate_interval = s->refresh_rate[0] / (double)s->refresh_rate[1];
@@ -1270,6 +1346,261 @@ static int hud_init(struct ngl_node *node)
     return 0;
 }
 
+static const char * const graph_vertex_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "attribute vec2 position;"                                              "\n"
+    "uniform vec2 canvas_size;"                                             "\n"
+    "uniform vec4 rect;"                                                    "\n"
+    "varying vec2 var_position;"                                            "\n"
+    "void main()"                                                           "\n"
+    "{"                                                                     "\n"
+    "    var_position = rect.xy + position * rect.zw;"                      "\n"
+    "    gl_Position = vec4(var_position / canvas_size * 2.0 - 1.0, 0.0, 1.0);" "\n"
+    "}";
+
+/*
+ * Same drawing as the original CPU rasterization of the graphs: for every
+ * column, the block graphs fill the pixels below the value while the line
+ * graphs join the value to the previous one. The graph field holds the
+ * history row of the first data graph, the number of data graphs, the
+ * history column of the oldest value and the number of values.
+ */
+static const char * const graph_fragment_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "#define MAX_GRAPHS 7"                                                  "\n"
+    "uniform sampler2D history;"                                            "\n"
+    "uniform vec2 history_size;"                                            "\n"
+    "uniform vec4 graph_rect;"                                              "\n"
+    "uniform vec4 bg_color;"                                                "\n"
+    "uniform vec4 colors[MAX_GRAPHS];"                                      "\n"
+    "uniform vec4 graph;"                                                   "\n"
+    "uniform float ring_size;"                                              "\n"
+    "uniform float block;"                                                  "\n"
+    "varying vec2 var_position;"                                            "\n"
+    "float get_y(float row, float x, float h)"                              "\n"
+    "{"                                                                     "\n"
+    "    float column = mod(graph.z + x, ring_size);"                       "\n"
+    "    vec2 uv = (vec2(column, row) + 0.5) / history_size;"               "\n"
+    "    float value_h = floor(texture2D(history, uv).r * 255.0 + 0.5);"    "\n"
+    "    return h - value_h;"                                               "\n"
+    "}"                                                                     "\n"
+    "void main(void)"                                                       "\n"
+    "{"                                                                     "\n"
+    "    gl_FragColor = bg_color;"                                          "\n"
+    "    vec2 p = floor(var_position - graph_rect.xy);"                     "\n"
+    "    if (p.x < 0.0 || p.y < 0.0 || p.x >= min(graph_rect.z, graph.w) || p.y >= graph_rect.w)" "\n"
+    "        return;"                                                       "\n"
+    "    float h = graph_rect.w;"                                           "\n"
+    "    for (int i = 0; i < MAX_GRAPHS; i++) {"                            "\n"
+    "        if (float(i) >= graph.y)"                                      "\n"
+    "            break;"                                                    "\n"
+    "        float row = graph.x + float(i);"                               "\n"
+    "        float y = get_y(row, p.x, h);"                                 "\n"
+    "        if (block > 0.5) {"                                            "\n"
+    "            if (p.y >= y)"                                             "\n"
+    "                gl_FragColor = colors[i];"                             "\n"
+    "            continue;"                                                 "\n"
+    "        }"                                                             "\n"
+    "        y = clamp(y - 1.0, 0.0, h - 1.0);"                             "\n"
+    "        float prev_y = p.x > 0.0 ? clamp(get_y(row, p.x - 1.0, h) - 1.0, 0.0, h - 1.0) : y;" "\n"
+    "        if (p.y >= min(y, prev_y) && p.y <= max(y, prev_y))"           "\n"
+    "            gl_FragColor = colors[i];"                                 "\n"
+    "    }"                                                                 "\n"
+    "}";
+
+static const char * const text_vertex_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "attribute vec2 position;"                                              "\n"
+    "attribute vec2 uvcoord;"                                               "\n"
+    "attribute vec4 color;"                                                 "\n"
+    "uniform vec2 canvas_size;"                                             "\n"
+    "varying vec2 var_uvcoord;"                                             "\n"
+    "varying vec4 var_color;"                                               "\n"
+    "void main()"                                                           "\n"
+    "{"                                                                     "\n"
+    "    gl_Position = vec4(position / canvas_size * 2.0 - 1.0, 0.0, 1.0);" "\n"
+    "    var_uvcoord = uvcoord;"                                            "\n"
+    "    var_color = color;"                                                "\n"
+    "}";
+
+static const char * const text_fragment_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "uniform sampler2D tex;"                                                "\n"
+    "varying vec2 var_uvcoord;"                                             "\n"
+    "varying vec4 var_color;"                                               "\n"
+    "void main(void)"                                                       "\n"
+    "{"                                                                     "\n"
+    "    if (texture2D(tex, var_uvcoord).a < 0.5)"                          "\n"
+    "        discard;"                                                      "\n"
+    "    gl_FragColor = var_color;"                                         "\n"
+    "}";
+
+static int init_graph_pipeline(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct hud_priv *s = node->priv_data;
+
+    int ret = ngli_program_init(&s->graph_program, ctx, graph_vertex_data, graph_fragment_data, NULL);
+    if (ret < 0)
+        return ret;
+
+    static const float quad[] = {0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f, 1.f};
+    ret = ngli_buffer_init(&s->quad, ctx, sizeof(quad), NGLI_BUFFER_USAGE_STATIC);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_buffer_upload(&s->quad, quad, sizeof(quad));
+    if (ret < 0)
+        return ret;
+
+    struct texture_params params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    params.width = s->history_w;
+    params.height = s->history_h;
+    ret = ngli_texture_init(&s->history, ctx, &params);
+    if (ret < 0)
+        return ret;
+
+    /* The history of the graphs survives the release of the GPU resources */
+    ret = ngli_texture_upload(&s->history, s->history_data, 0);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "canvas_size",  .type = NGLI_TYPE_VEC2,  .count = 1, .data = s->canvas_size},
+        {.name = "history_size", .type = NGLI_TYPE_VEC2,  .count = 1, .data = s->history_size},
+        {.name = "bg_color",     .type = NGLI_TYPE_VEC4,  .count = 1, .data = s->bg_color_rgba},
+        {.name = "rect",         .type = NGLI_TYPE_VEC4,  .count = 1, .data = NULL},
+        {.name = "graph_rect",   .type = NGLI_TYPE_VEC4,  .count = 1, .data = NULL},
+        {.name = "colors",       .type = NGLI_TYPE_VEC4,  .count = MAX_GRAPHS, .data = NULL},
+        {.name = "graph",        .type = NGLI_TYPE_VEC4,  .count = 1, .data = NULL},
+        {.name = "ring_size",    .type = NGLI_TYPE_FLOAT, .count = 1, .data = NULL},
+        {.name = "block",        .type = NGLI_TYPE_FLOAT, .count = 1, .data = NULL},
+    };
+
+    const struct pipeline_texture textures[] = {
+        {.name = "history", .texture = &s->history},
+    };
+
+    const struct pipeline_attribute attributes[] = {
+        {.name = "position", .format = NGLI_FORMAT_R32G32_SFLOAT, .stride = 2 * 4, .buffer = &s->quad},
+    };
+
+    struct pipeline_params pipeline_params = {
+        .type          = NGLI_PIPELINE_TYPE_GRAPHICS,
+        .program       = &s->graph_program,
+        .textures      = textures,
+        .nb_textures   = NGLI_ARRAY_NB(textures),
+        .uniforms      = uniforms,
+        .nb_uniforms   = NGLI_ARRAY_NB(uniforms),
+        .attributes    = attributes,
+        .nb_attributes = NGLI_ARRAY_NB(attributes),
+        .graphics      = {
+            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN,
+            .nb_vertices = 4,
+        },
+    };
+
+    ret = ngli_pipeline_init(&s->graph_pipeline, ctx, &pipeline_params);
+    if (ret < 0)
+        return ret;
+
+    s->rect_index       = ngli_pipeline_get_uniform_index(&s->graph_pipeline, "rect");
+    s->graph_rect_index = ngli_pipeline_get_uniform_index(&s->graph_pipeline, "graph_rect");
+    s->colors_index     = ngli_pipeline_get_uniform_index(&s->graph_pipeline, "colors");
+    s->graph_index      = ngli_pipeline_get_uniform_index(&s->graph_pipeline, "graph");
+    s->ring_size_index  = ngli_pipeline_get_uniform_index(&s->graph_pipeline, "ring_size");
+    s->block_index      = ngli_pipeline_get_uniform_index(&s->graph_pipeline, "block");
+
+    return 0;
+}
+
+static int upload_glyphs(struct hud_priv *s)
+{
+    const int nb_vertices = s->nb_glyphs * GLYPH_NB_VERTICES;
+    s->text_pipeline.graphics.nb_vertices = nb_vertices;
+    if (!nb_vertices)
+        return 0;
+    return ngli_buffer_upload(&s->glyphs, s->glyphs_data, nb_vertices * GLYPH_VERTEX_SIZE * sizeof(float));
+}
+
+static int init_text_pipeline(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct hud_priv *s = node->priv_data;
+
+    int ret = ngli_fontatlas_acquire(ctx, NGLI_FILTER_NEAREST, NGLI_FILTER_NEAREST,
+                                     NGLI_MIPMAP_FILTER_NONE, &s->atlas);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_program_init(&s->text_program, ctx, text_vertex_data, text_fragment_data, NULL);
+    if (ret < 0)
+        return ret;
+
+    const int size = s->max_glyphs * GLYPH_NB_VERTICES * GLYPH_VERTEX_SIZE * sizeof(float);
+    ret = ngli_buffer_init(&s->glyphs, ctx, size, NGLI_BUFFER_USAGE_DYNAMIC);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "canvas_size", .type = NGLI_TYPE_VEC2, .count = 1, .data = s->canvas_size},
+    };
+
+    const struct pipeline_texture textures[] = {
+        {.name = "tex", .texture = &s->atlas->texture},
+    };
+
+    const int stride = GLYPH_VERTEX_SIZE * sizeof(float);
+    const struct pipeline_attribute attributes[] = {
+        {.name = "position", .format = NGLI_FORMAT_R32G32_SFLOAT,       .stride = stride, .offset = 0,     .buffer = &s->glyphs},
+        {.name = "uvcoord",  .format = NGLI_FORMAT_R32G32_SFLOAT,       .stride = stride, .offset = 2 * 4, .buffer = &s->glyphs},
+        {.name = "color",    .format = NGLI_FORMAT_R32G32B32A32_SFLOAT, .stride = stride, .offset = 4 * 4, .buffer = &s->glyphs},
+    };
+
+    struct pipeline_params pipeline_params = {
+        .type          = NGLI_PIPELINE_TYPE_GRAPHICS,
+        .program       = &s->text_program,
+        .textures      = textures,
+        .nb_textures   = NGLI_ARRAY_NB(textures),
+        .uniforms      = uniforms,
+        .nb_uniforms   = NGLI_ARRAY_NB(uniforms),
+        .attributes    = attributes,
+        .nb_attributes = NGLI_ARRAY_NB(attributes),
+        .graphics      = {
+            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            .nb_vertices = 0,
+        },
+    };
+
+    ret = ngli_pipeline_init(&s->text_pipeline, ctx, &pipeline_params);
+    if (ret < 0)
+        return ret;
+
+    /* The text of the last refresh survives the release of the GPU resources */
+    return upload_glyphs(s);
+}
+
+static int hud_prefetch(struct ngl_node *node)
+{
+    struct hud_priv *s = node->priv_data;
+
+    int ret = init_graph_pipeline(node);
+    if (ret < 0)
+        return ret;
+
+    ret = init_text_pipeline(node);
+    if (ret < 0)
+        return ret;
+
+    s->need_render = 1;
+    return 0;
+}
+
 static int hud_update(struct ngl_node *node, double t)
 {
     struct hud_priv *s = node->priv_data;
@@ -1291,29 +1622,129 @@ static void hud_draw(struct ngl_node *node)
     if (s->need_refresh) {
         if (s->export_filename)
             widgets_csv_report(node);
-        widgets_clear(s);
+        s->nb_glyphs = 0;
         widgets_draw(node);
+        upload_glyphs(s);
+        s->need_render = 1;
     }
 }
 
+void ngli_node_hud_get_dimensions(const struct ngl_node *node, int *width, int *height)
+{
+    const struct hud_priv *s = node->priv_data;
+    *width = s->width;
+    *height = s->height;
+}
+
+int ngli_node_hud_render(struct ngl_node *node, struct rendertarget *rt, int force)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct hud_priv *s = node->priv_data;
+
+    if (!s->need_render && !force)
+        return 0;
+    s->need_render = 0;
+
+    struct rendertarget *prev_rt = ngli_gctx_get_rendertarget(ctx);
+    ngli_gctx_set_rendertarget(ctx, rt);
+
+    int prev_vp[4] = {0};
+    ngli_gctx_get_viewport(ctx, prev_vp);
+
+    const int vp[4] = {0, 0, rt->width, rt->height};
+    ngli_gctx_set_viewport(ctx, vp);
+
+    /* The widgets are opaque and do not overlap: the state of the scene
+     * (blending, scissor, write masks) must not apply */
+    const struct graphicconfig parent = ctx->graphicconfig;
+    struct graphicconfig graphicconfig;
+    ngli_graphicconfig_init(&graphicconfig);
+    ngli_glstate_set_pending(ctx, &graphicconfig, NULL);
+    ngli_honor_pending_glstate(ctx);
+
+    /* The canvas is transparent outside of the widgets */
+    float prev_clear_color[4] = {0};
+    ngli_gctx_get_clear_color(ctx, prev_clear_color);
+    static const float transparent[4] = {0};
+    ngli_gctx_set_clear_color(ctx, transparent);
+    ngli_gctx_load_attachments(ctx, NGLI_LOAD_OP_CLEAR, NGLI_LOAD_OP_DONT_CARE);
+
+    struct darray *widgets_array = &s->widgets;
+    struct widget *widgets = ngli_darray_data(widgets_array);
+    for (int i = 0; i < ngli_darray_count(widgets_array); i++) {
+        const struct widget *widget = &widgets[i];
+        const struct data_graph *d = &widget->data_graph[0];
+        const int nb_graphs = widget->graph_visible ? widget_specs[widget->type].nb_data_graph : 0;
+        const struct rect *r = &widget->rect;
+        const struct rect *g = &widget->graph_rect;
+        const float rect[4] = {r->x, r->y, r->w, r->h};
+        const float graph_rect[4] = {g->x, g->y, g->w, g->h};
+        const float graph[4] = {
+            widget->history_row,
+            nb_graphs,
+            (d->pos - d->count + d->nb_values) % d->nb_values,
+            d->count,
+        };
+        const float ring_size = d->nb_values;
+        const float block = widget->block_graph;
+
+        struct pipeline *pipeline = &s->graph_pipeline;
+        ngli_pipeline_update_uniform(pipeline, s->rect_index, rect);
+        ngli_pipeline_update_uniform(pipeline, s->graph_rect_index, graph_rect);
+        ngli_pipeline_update_uniform(pipeline, s->colors_index, widget->colors);
+        ngli_pipeline_update_uniform(pipeline, s->graph_index, graph);
+        ngli_pipeline_update_uniform(pipeline, s->ring_size_index, &ring_size);
+        ngli_pipeline_update_uniform(pipeline, s->block_index, &block);
+        ngli_pipeline_exec(pipeline);
+    }
+
+    if (s->text_pipeline.graphics.nb_vertices)
+        ngli_pipeline_exec(&s->text_pipeline);
+
+    ngli_gctx_set_clear_color(ctx, prev_clear_color);
+    ngli_glstate_set_pending(ctx, &parent, NULL);
+    ngli_gctx_set_rendertarget(ctx, prev_rt);
+    ngli_gctx_set_viewport(ctx, prev_vp);
+
+    return 1;
+}
+
+static void hud_release(struct ngl_node *node)
+{
+    struct hud_priv *s = node->priv_data;
+
+    ngli_pipeline_reset(&s->text_pipeline);
+    ngli_buffer_reset(&s->glyphs);
+    ngli_program_reset(&s->text_program);
+    ngli_fontatlas_release(node->ctx, &s->atlas);
+    ngli_pipeline_reset(&s->graph_pipeline);
+    ngli_texture_reset(&s->history);
+    ngli_buffer_reset(&s->quad);
+    ngli_program_reset(&s->graph_program);
+}
+
 static void hud_uninit(struct ngl_node *node)
 {
     struct hud_priv *s = node->priv_data;
 
     widgets_uninit(node);
-    ngli_free(s->canvas.buf);
-    if (s->export_filename) {
-        close(s->fd_export);
-        ngli_bstr_freep(&s->csv_line);
-    }
+    ngli_free_tagged(s->history_data);
+    ngli_free_tagged(s->glyphs_data);
+    const int nb_dropped = ngli_csvwriter_close(&s->csvwriter);
+    if (nb_dropped > 0)
+        LOG(WARNING, "%d rows could not be exported to \"%s\" in time and were dropped",
+            nb_dropped, s->export_filename);
+    ngli_free(s->csv_values);
 }
 
 const struct node_class ngli_hud_class = {
     .id        = NGL_NODE_HUD,
     .name      = "HUD",
     .init      = hud_init,
+    .prefetch  = hud_prefetch,
     .update    = hud_update,
     .draw      = hud_draw,
+    .release   = hud_release,
     .uninit    = hud_uninit,
     .priv_size = sizeof(struct hud_priv),
     .params    = hud_params,
@@ -29,12 +29,13 @@ static void identity_draw(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct identity *s = node->priv_data;
-    float *matrix = ngli_darray_tail(&ctx->modelview_matrix_stack);
-    memcpy(s->modelview_matrix, matrix, sizeof(s->modelview_matrix));
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    memcpy(s->modelview_matrix, modelview->matrix, sizeof(s->modelview_matrix));
 }
 
 const struct node_class ngli_identity_class = {
     .id        = NGL_NODE_IDENTITY,
+    .flags     = NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Identity",
     .draw      = identity_draw,
     .priv_size = sizeof(struct identity),
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <math.h>
+#include <stddef.h>
+
+#include "damage.h"
+#include "darray.h"
+#include "gctx.h"
+#include "log.h"
+#include "math_utils.h"
+#include "nodegl.h"
+#include "nodes.h"
+
+enum {
+    LOD_METRIC_COVERAGE,
+    LOD_METRIC_DISTANCE,
+};
+
+struct levelofdetail_priv {
+    struct ngl_node **children;
+    int nb_children;
+    double *thresholds;
+    int nb_thresholds;
+    int metric;
+    float bounding_box_min[3];
+    float bounding_box_max[3];
+
+    int level;
+    int next_level;
+};
+
+static const struct param_choices metric_choices = {
+    .name = "lod_metric",
+    .consts = {
+        {"coverage", LOD_METRIC_COVERAGE, .desc=NGLI_DOCSTRING("fraction of the viewport area covered by "
+                                                               "the projected bounding box")},
+        {"distance", LOD_METRIC_DISTANCE, .desc=NGLI_DOCSTRING("distance from the eye to the center of "
+                                                               "the bounding box")},
+        {NULL}
+    }
+};
+
+#define OFFSET(x) offsetof(struct levelofdetail_priv, x)
+static const struct node_param levelofdetail_params[] = {
+    {"children", PARAM_TYPE_NODELIST, OFFSET(children),
+                 .desc=NGLI_DOCSTRING("versions of a scene, from the most to the least detailed")},
+    {"thresholds", PARAM_TYPE_DBLLIST, OFFSET(thresholds),
+                   .desc=NGLI_DOCSTRING("one threshold per child but the last: a child is selected if the "
+                                        "coverage is above (or the distance below) its threshold, and the "
+                                        "last child otherwise")},
+    {"metric", PARAM_TYPE_SELECT, OFFSET(metric), {.i64=LOD_METRIC_COVERAGE},
+               .choices=&metric_choices,
+               .desc=NGLI_DOCSTRING("measure of the scene compared against the thresholds")},
+    {"bounding_box_min", PARAM_TYPE_VEC3, OFFSET(bounding_box_min), {.vec={-1.0f, -1.0f, -1.0f}},
+                         .desc=NGLI_DOCSTRING("minimum corner of the box bounding every child")},
+    {"bounding_box_max", PARAM_TYPE_VEC3, OFFSET(bounding_box_max), {.vec={1.0f, 1.0f, 1.0f}},
+                         .desc=NGLI_DOCSTRING("maximum corner of the box bounding every child")},
+    {NULL}
+};
+
+static int levelofdetail_init(struct ngl_node *node)
+{
+    struct levelofdetail_priv *s = node->priv_data;
+
+    if (!s->nb_children) {
+        LOG(ERROR, "at least one child is required");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (s->nb_thresholds != s->nb_children - 1) {
+        LOG(ERROR, "%d thresholds are required for %d children, got %d",
+            s->nb_children - 1, s->nb_children, s->nb_thresholds);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    for (int i = 1; i < s->nb_thresholds; i++) {
+        const int ordered = s->metric == LOD_METRIC_COVERAGE ? s->thresholds[i] <= s->thresholds[i - 1]
+                                                             : s->thresholds[i] >= s->thresholds[i - 1];
+        if (!ordered) {
+            LOG(ERROR, "the thresholds must be %s",
+                s->metric == LOD_METRIC_COVERAGE ? "decreasing" : "increasing");
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    /* The cheapest child is used until the scene has been measured */
+    s->level = s->nb_children - 1;
+    s->next_level = s->level;
+    return 0;
+}
+
+/*
+ * The matrices are only known while drawing, so the level measured at a
+ * frame is only activated at the next one: this gives the visit a chance to
+ * release the previous child and prefetch the new one.
+ */
+static int levelofdetail_visit(struct ngl_node *node, int is_active, double t)
+{
+    struct levelofdetail_priv *s = node->priv_data;
+
+    s->level = s->next_level;
+    for (int i = 0; i < s->nb_children; i++) {
+        struct ngl_node *child = s->children[i];
+        const int child_active = is_active && i == s->level;
+        int ret = ngli_node_visit(child, child_active, t);
+        if (ret < 0)
+            return ret;
+        if (child_active)
+            ngli_node_restrict_activity_bounds(node, child->activity_bounds[0],
+                                                     child->activity_bounds[1]);
+    }
+
+    return 0;
+}
+
+static int levelofdetail_update(struct ngl_node *node, double t)
+{
+    struct levelofdetail_priv *s = node->priv_data;
+    return ngli_node_update(s->children[s->level], t);
+}
+
+static double measure(struct levelofdetail_priv *s, struct ngl_ctx *ctx)
+{
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+
+    if (s->metric == LOD_METRIC_DISTANCE) {
+        const float center[4] = {
+            (s->bounding_box_min[0] + s->bounding_box_max[0]) * .5f,
+            (s->bounding_box_min[1] + s->bounding_box_max[1]) * .5f,
+            (s->bounding_box_min[2] + s->bounding_box_max[2]) * .5f,
+            1.f,
+        };
+        NGLI_ALIGNED_VEC(eye);
+        ngli_mat4_mul_vec4(eye, modelview->matrix, center);
+        return ngli_vec3_length(eye);
+    }
+
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+    NGLI_ALIGNED_MAT(matrix);
+    ngli_mat4_mul(matrix, projection_matrix, modelview->matrix);
+
+    int viewport[4];
+    ngli_gctx_get_viewport(ctx, viewport);
+
+    /* A box crossing the plane of the eye is as close as it can be */
+    int rect[4];
+    if (!ngli_damage_project_box(matrix, s->bounding_box_min, s->bounding_box_max, viewport, rect))
+        return 1.0;
+    return (double)rect[2] * rect[3] / ((double)viewport[2] * viewport[3]);
+}
+
+static int select_level(const struct levelofdetail_priv *s, double value)
+{
+    for (int i = 0; i < s->nb_thresholds; i++) {
+        const int selected = s->metric == LOD_METRIC_COVERAGE ? value >= s->thresholds[i]
+                                                              : value < s->thresholds[i];
+        if (selected)
+            return i;
+    }
+    return s->nb_children - 1;
+}
+
+static void levelofdetail_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct levelofdetail_priv *s = node->priv_data;
+
+    /* The additional outputs reuse the decision of the main target */
+    if (!ctx->drawing_outputs) {
+        const int level = select_level(s, measure(s, ctx));
+        if (level != s->next_level) {
+            s->next_level = level;
+            /* The activity of the graph must be checked again */
+            ctx->activity_gen++;
+        }
+    }
+
+    ngli_node_draw(s->children[s->level]);
+}
+
+const struct node_class ngli_levelofdetail_class = {
+    .id        = NGL_NODE_LEVELOFDETAIL,
+    .name      = "LevelOfDetail",
+    .init      = levelofdetail_init,
+    .visit     = levelofdetail_visit,
+    .update    = levelofdetail_update,
+    .draw      = levelofdetail_draw,
+    .priv_size = sizeof(struct levelofdetail_priv),
+    .params    = levelofdetail_params,
+    .file      = __FILE__,
+};
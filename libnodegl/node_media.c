@@ -19,6 +19,8 @@
  * under the License.
  */
 
+#include <float.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -28,8 +30,14 @@
 #include <libavcodec/mediacodec.h>
 #endif
 
+#include "audiofft.h"
+#include "bstr.h"
+#include "darray.h"
 #include "glincludes.h"
+#include "hmap.h"
+#include "imagecache.h"
 #include "log.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 
@@ -45,6 +53,15 @@ static const struct param_choices sxplayer_log_level_choices = {
     }
 };
 
+static const struct param_choices sw_pix_fmt_choices = {
+    .name = "sw_pix_fmt",
+    .consts = {
+        {"rgba", SXPLAYER_PIXFMT_RGBA, .desc=NGLI_DOCSTRING("RGBA converted by sxplayer on the CPU")},
+        {"nv12", SXPLAYER_PIXFMT_NV12, .desc=NGLI_DOCSTRING("NV12 planes uploaded as is and converted by the GPU")},
+        {NULL}
+    }
+};
+
 #define OFFSET(x) offsetof(struct media_priv, x)
 static const struct node_param media_params[] = {
     {"filename", PARAM_TYPE_STR, OFFSET(filename), {.str=NULL}, PARAM_FLAG_CONSTRUCTOR,
@@ -67,6 +84,36 @@ static const struct node_param media_params[] = {
                        .desc=NGLI_DOCSTRING("maximum number of pixels per frame")},
     {"stream_idx",     PARAM_TYPE_INT, OFFSET(stream_idx),     {.i64=-1},
                        .desc=NGLI_DOCSTRING("force a stream number instead of picking the \"best\" one")},
+    {"lookahead",      PARAM_TYPE_INT, OFFSET(lookahead),      {.i64=0},
+                       .desc=NGLI_DOCSTRING("number of frames decoded ahead by a dedicated thread once the media is prefetched, "
+                                            "0 to fetch the frames synchronously during the update (unsupported on Android)")},
+    {"async_surface",  PARAM_TYPE_BOOL, OFFSET(async_surface), {.i64=0},
+                       .desc=NGLI_DOCSTRING("on Android, do not wait for the decoded frames to reach the surface: "
+                                            "a frame not available yet is displayed by a later draw, "
+                                            "which suits the realtime playback but not the exports")},
+    {"sw_pix_fmt",     PARAM_TYPE_SELECT, OFFSET(sw_pix_fmt), {.i64=SXPLAYER_PIXFMT_RGBA},
+                       .choices=&sw_pix_fmt_choices,
+                       .desc=NGLI_DOCSTRING("pixel format of the software decoded frames")},
+    {"frame_cache",    PARAM_TYPE_INT, OFFSET(frame_cache),    {.i64=0},
+                       .desc=NGLI_DOCSTRING("maximum number of uploaded frames kept to serve the scrubbing without decoding, "
+                                            "within the GPU memory budget (RGBA and BGRA software decoded frames only)")},
+    {"live",           PARAM_TYPE_BOOL, OFFSET(live),          {.i64=0},
+                       .desc=NGLI_DOCSTRING("live source: the frames are decoded by a dedicated thread as they arrive, "
+                                            "the most recent one is displayed regardless of the time and the late ones "
+                                            "are dropped; the time elapsed since the reception of the displayed frame "
+                                            "is exposed to the shaders through the `<name>_age` texture uniform")},
+    {"audio_fft",      PARAM_TYPE_BOOL, OFFSET(audio_fft),     {.i64=0},
+                       .desc=NGLI_DOCSTRING("with `audio_tex`, upload the raw audio samples and compute their spectrum "
+                                            "with a compute shader instead of the CPU; the texture is `audio_nb_bins` "
+                                            "wide, its 2 first rows are the waves and the 2 next ones the amplitudes")},
+    {"audio_nb_bins",  PARAM_TYPE_INT, OFFSET(audio_nb_bins),  {.i64=256},
+                       .desc=NGLI_DOCSTRING("number of frequency bins of the GPU spectrum, a power of two")},
+    {"audio_smoothing", PARAM_TYPE_DBL, OFFSET(audio_smoothing), {.dbl=0.0},
+                        .desc=NGLI_DOCSTRING("weight of the previous amplitudes in the GPU spectrum, in [0,1)")},
+    {"still",          PARAM_TYPE_BOOL, OFFSET(still),         {.i64=0},
+                       .desc=NGLI_DOCSTRING("still image: its first frame is decoded once to RGBA without creating a player, "
+                                            "and shared with its texture by all the still media of the context reading "
+                                            "the same file")},
     {NULL}
 };
 
@@ -84,8 +131,8 @@ static void callback_sxplayer_log(void *arg, int level, const char *filename, in
     if (level < 0 || level >= NGLI_ARRAY_NB(log_levels))
         return;
 
-    struct media_priv *s = arg;
-    if (level < s->sxplayer_min_level)
+    const int *min_level = arg;
+    if (level < *min_level)
         return;
 
     char buf[512];
@@ -95,7 +142,223 @@ static void callback_sxplayer_log(void *arg, int level, const char *filename, in
                        "[SXPLAYER %s:%d %s] %s", filename, ln, fn, buf);
 }
 
-static int media_init(struct ngl_node *node)
+static void set_thread_priority(const struct media_priv *s)
+{
+    if (s->thread_priority || s->thread_affinity)
+        ngli_thread_set_priority(s->thread_priority, s->thread_affinity);
+}
+
+static void *lookahead_thread(void *arg)
+{
+    struct media_priv *s = arg;
+
+    set_thread_priority(s);
+
+    pthread_mutex_lock(&s->lookahead_lock);
+    for (;;) {
+        while (s->lookahead_running && (s->lookahead_eof || s->lookahead_count == s->lookahead))
+            pthread_cond_wait(&s->lookahead_cond, &s->lookahead_lock);
+        if (!s->lookahead_running)
+            break;
+
+        pthread_mutex_unlock(&s->lookahead_lock);
+        struct sxplayer_frame *frame = sxplayer_get_next_frame(s->player);
+        pthread_mutex_lock(&s->lookahead_lock);
+
+        if (frame) {
+            const int index = (s->lookahead_head + s->lookahead_count) % NGLI_MEDIA_MAX_LOOKAHEAD;
+            s->lookahead_queue[index] = frame;
+            s->lookahead_count++;
+        } else {
+            s->lookahead_eof = 1;
+        }
+        pthread_cond_broadcast(&s->lookahead_cond);
+    }
+    pthread_mutex_unlock(&s->lookahead_lock);
+
+    return NULL;
+}
+
+static void lookahead_start(struct media_priv *s)
+{
+    s->lookahead_running = 1;
+    s->lookahead_eof = 0;
+    if (pthread_create(&s->lookahead_tid, NULL, lookahead_thread, s)) {
+        LOG(WARNING, "could not create look-ahead thread, frames will be fetched synchronously");
+        s->lookahead_running = 0;
+    }
+}
+
+static void lookahead_stop(struct media_priv *s)
+{
+    if (!s->lookahead_running)
+        return;
+
+    pthread_mutex_lock(&s->lookahead_lock);
+    s->lookahead_running = 0;
+    pthread_cond_broadcast(&s->lookahead_cond);
+    pthread_mutex_unlock(&s->lookahead_lock);
+    pthread_join(s->lookahead_tid, NULL);
+
+    while (s->lookahead_count) {
+        sxplayer_release_frame(s->lookahead_queue[s->lookahead_head]);
+        s->lookahead_head = (s->lookahead_head + 1) % NGLI_MEDIA_MAX_LOOKAHEAD;
+        s->lookahead_count--;
+    }
+    s->lookahead_head = 0;
+}
+
+/*
+ * A live source is decoded as fast as its frames arrive. The update only
+ * picks the most recent frame without ever waiting for the decoder, a frame
+ * replaced before being picked is dropped.
+ */
+static void *live_thread(void *arg)
+{
+    struct media_priv *s = arg;
+
+    set_thread_priority(s);
+
+    pthread_mutex_lock(&s->live_lock);
+    while (s->live_running) {
+        pthread_mutex_unlock(&s->live_lock);
+        struct sxplayer_frame *frame = sxplayer_get_next_frame(s->player);
+        const int64_t now = ngli_gettime();
+        pthread_mutex_lock(&s->live_lock);
+
+        if (!frame) {
+            LOG(INFO, "end of live stream %s", s->filename);
+            break;
+        }
+
+        if (s->live_frame) {
+            sxplayer_release_frame(s->live_frame);
+            s->live_nb_dropped++;
+        }
+        s->live_frame = frame;
+        s->live_frame_time = now;
+    }
+    pthread_mutex_unlock(&s->live_lock);
+
+    return NULL;
+}
+
+static void live_start(struct media_priv *s)
+{
+    s->live_running = 1;
+    s->live_nb_dropped = 0;
+    s->live_displayed_time = 0;
+    if (pthread_create(&s->live_tid, NULL, live_thread, s)) {
+        LOG(ERROR, "could not create live decoding thread");
+        s->live_running = 0;
+    }
+}
+
+/* Joining waits for the completion of the frame being decoded, if any */
+static void live_stop(struct media_priv *s)
+{
+    if (!s->live_running)
+        return;
+
+    pthread_mutex_lock(&s->live_lock);
+    s->live_running = 0;
+    pthread_mutex_unlock(&s->live_lock);
+    pthread_join(s->live_tid, NULL);
+
+    sxplayer_release_frame(s->live_frame);
+    s->live_frame = NULL;
+    if (s->live_nb_dropped)
+        LOG(DEBUG, "%d late frames dropped from live stream %s", s->live_nb_dropped, s->filename);
+}
+
+static struct sxplayer_frame *live_get_frame(struct media_priv *s)
+{
+    pthread_mutex_lock(&s->live_lock);
+    struct sxplayer_frame *frame = s->live_frame;
+    s->live_frame = NULL;
+    if (frame)
+        s->live_displayed_time = s->live_frame_time;
+    pthread_mutex_unlock(&s->live_lock);
+    return frame;
+}
+
+/*
+ * Seeking beyond this distance past the most recent decoded frame restarts
+ * the decoding at the requested time instead of decoding every frame in
+ * between.
+ */
+#define LOOKAHEAD_MAX_SKIP 1.0
+
+static struct sxplayer_frame *lookahead_get_frame(struct media_priv *s, double media_time)
+{
+    pthread_mutex_lock(&s->lookahead_lock);
+
+    const int newest = (s->lookahead_head + s->lookahead_count - 1) % NGLI_MEDIA_MAX_LOOKAHEAD;
+    const double newest_ts = s->lookahead_count ? s->lookahead_queue[newest]->ts : s->lookahead_last_ts;
+    const int resync = s->lookahead_delivered && (media_time < s->lookahead_last_ts ||
+                                                  media_time > newest_ts + LOOKAHEAD_MAX_SKIP);
+    if (resync) {
+        pthread_mutex_unlock(&s->lookahead_lock);
+        TRACE("time jump to %g, restart look-ahead decoding", media_time);
+        lookahead_stop(s);
+        struct sxplayer_frame *frame = sxplayer_get_frame(s->player, media_time);
+        if (frame) {
+            s->lookahead_delivered = 1;
+            s->lookahead_last_ts = frame->ts;
+        }
+        lookahead_start(s);
+        return frame;
+    }
+
+    /* Pick the most recent decoded frame not after the requested time, which
+     * may require waiting for the decoding of the next frame to know it */
+    struct sxplayer_frame *frame = NULL;
+    for (;;) {
+        while (!s->lookahead_count && !s->lookahead_eof)
+            pthread_cond_wait(&s->lookahead_cond, &s->lookahead_lock);
+        if (!s->lookahead_count)
+            break;
+
+        struct sxplayer_frame *next = s->lookahead_queue[s->lookahead_head];
+        if (next->ts > media_time && (frame || s->lookahead_delivered))
+            break;
+
+        sxplayer_release_frame(frame);
+        frame = next;
+        s->lookahead_head = (s->lookahead_head + 1) % NGLI_MEDIA_MAX_LOOKAHEAD;
+        s->lookahead_count--;
+        pthread_cond_broadcast(&s->lookahead_cond);
+
+        if (!s->lookahead_delivered && frame->ts > media_time)
+            break;
+    }
+
+    if (frame) {
+        s->lookahead_delivered = 1;
+        s->lookahead_last_ts = frame->ts;
+    }
+
+    pthread_mutex_unlock(&s->lookahead_lock);
+    return frame;
+}
+
+/*
+ * Media time of the next decoded frame, DBL_MAX after the last one, or
+ * media_time if it is not known yet
+ */
+static double lookahead_get_next_time(struct media_priv *s, double media_time)
+{
+    pthread_mutex_lock(&s->lookahead_lock);
+    double next_time = media_time;
+    if (s->lookahead_count)
+        next_time = s->lookahead_queue[s->lookahead_head]->ts;
+    else if (s->lookahead_eof)
+        next_time = DBL_MAX;
+    pthread_mutex_unlock(&s->lookahead_lock);
+    return NGLI_MAX(next_time, media_time);
+}
+
+static int player_init(struct ngl_node *node)
 {
     struct media_priv *s = node->priv_data;
 
@@ -103,7 +366,7 @@ static int media_init(struct ngl_node *node)
     if (!s->player)
         return NGL_ERROR_MEMORY;
 
-    sxplayer_set_log_callback(s->player, s, callback_sxplayer_log);
+    sxplayer_set_log_callback(s->player, &s->sxplayer_min_level, callback_sxplayer_log);
 
     struct ngl_node *anim_node = s->anim;
     if (anim_node) {
@@ -131,14 +394,14 @@ static int media_init(struct ngl_node *node)
 
     sxplayer_set_option(s->player, "stream_idx", s->stream_idx);
 
-    sxplayer_set_option(s->player, "sw_pix_fmt", SXPLAYER_PIXFMT_RGBA);
+    sxplayer_set_option(s->player, "sw_pix_fmt", s->sw_pix_fmt);
 #if defined(TARGET_IPHONE) || defined(TARGET_DARWIN)
     sxplayer_set_option(s->player, "vt_pix_fmt", "nv12");
 #endif
 
     if (s->audio_tex) {
         sxplayer_set_option(s->player, "avselect", SXPLAYER_SELECT_AUDIO);
-        sxplayer_set_option(s->player, "audio_texture", 1);
+        sxplayer_set_option(s->player, "audio_texture", !s->audio_fft);
         return 0;
     }
 
@@ -161,11 +424,27 @@ static int media_init(struct ngl_node *node)
     if (ret < 0)
         return ret;
 
-    s->android_handlerthread = ngli_android_handlerthread_new();
-    if (!s->android_handlerthread)
-        return NGL_ERROR_MEMORY;
+    /* Import the decoded hardware buffers directly when possible (API 26+) */
+    if (ngli_android_imagereader_is_supported(ctx->glcontext)) {
+        s->android_imagereader = ngli_android_imagereader_new(ctx->glcontext, s->android_texture.id);
+        if (s->android_imagereader) {
+            void *android_surface = ngli_android_imagereader_get_surface(s->android_imagereader);
+            sxplayer_set_option(s->player, "opaque", &android_surface);
+            return 0;
+        }
+        LOG(WARNING, "could not create image reader, falling back on SurfaceTexture");
+    }
+
+    /* A single thread services the frame-available callbacks of all the
+     * media, each listener dispatching to its own surface */
+    if (!ctx->android_handlerthread) {
+        ctx->android_handlerthread = ngli_android_handlerthread_new(ctx->config.thread_priority,
+                                                                    ctx->config.thread_affinity);
+        if (!ctx->android_handlerthread)
+            return NGL_ERROR_MEMORY;
+    }
 
-    void *handler = ngli_android_handlerthread_get_native_handler(s->android_handlerthread);
+    void *handler = ngli_android_handlerthread_get_native_handler(ctx->android_handlerthread);
     if (!handler)
         return NGL_ERROR_EXTERNAL;
 
@@ -186,16 +465,607 @@ static int media_init(struct ngl_node *node)
     return 0;
 }
 
+/*
+ * Media nodes reading the same file with the same options and the same time
+ * remapping always request the same media times: they share a single player
+ * (and thus a single decoder) registered in the context media pool, and the
+ * decoded frames.
+ */
+struct shared_frame {
+    struct sxplayer_frame *frame;
+    int refcount;
+};
+
+struct media_shared {
+    char *key;
+    int refcount;
+    int nb_started;
+    int sxplayer_min_level;
+    struct sxplayer_ctx *player;
+    struct darray frames;          /* shared_frame referenced by the nodes */
+    struct sxplayer_frame *frame;  /* current player frame, also referenced by the cache */
+    int frame_id;
+    double frame_time;
+    int has_frame_time;
+};
+
+static char *get_shared_key(const struct media_priv *s)
+{
+#if defined(TARGET_ANDROID)
+    /* Every node renders to its own MediaCodec surface */
+    return NULL;
+#else
+    if (s->lookahead || s->live)
+        return NULL;
+
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+
+    ngli_bstr_print(b, "%d %d %d %d %d %d %d %d %d", s->sxplayer_min_level, s->audio_tex, s->audio_fft,
+                    s->max_nb_packets, s->max_nb_frames, s->max_nb_sink, s->max_pixels,
+                    s->stream_idx, s->sw_pix_fmt);
+    if (s->anim) {
+        const struct variable_priv *anim = s->anim->priv_data;
+        for (int i = 0; i < anim->nb_animkf; i++) {
+            const struct animkeyframe_priv *kf = anim->animkf[i]->priv_data;
+            ngli_bstr_print(b, " %a:%a:%d", kf->time, kf->scalar, kf->easing);
+        }
+    }
+    ngli_bstr_print(b, " %s", s->filename);
+
+    char *key = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return key;
+#endif
+}
+
+static struct shared_frame *shared_find_frame(struct media_shared *shared,
+                                              const struct sxplayer_frame *frame)
+{
+    struct shared_frame *frames = ngli_darray_data(&shared->frames);
+    for (int i = 0; i < ngli_darray_count(&shared->frames); i++)
+        if (frames[i].frame == frame)
+            return &frames[i];
+    return NULL;
+}
+
+static void shared_ref_frame(struct media_shared *shared, struct sxplayer_frame *frame)
+{
+    struct shared_frame *shared_frame = shared_find_frame(shared, frame);
+    if (shared_frame) {
+        shared_frame->refcount++;
+        return;
+    }
+    const struct shared_frame new_frame = {.frame = frame, .refcount = 1};
+    if (!ngli_darray_push(&shared->frames, &new_frame))
+        LOG(ERROR, "could not track shared media frame");
+}
+
+static void shared_unref_frame(struct media_shared *shared, struct sxplayer_frame *frame)
+{
+    struct shared_frame *shared_frame = shared_find_frame(shared, frame);
+    if (!shared_frame) {
+        sxplayer_release_frame(frame);
+        return;
+    }
+    if (--shared_frame->refcount)
+        return;
+    sxplayer_release_frame(frame);
+    const struct shared_frame *last = ngli_darray_tail(&shared->frames);
+    *shared_frame = *last;
+    ngli_darray_pop(&shared->frames);
+}
+
+static void shared_reset_frame(struct media_shared *shared)
+{
+    if (shared->frame) {
+        shared_unref_frame(shared, shared->frame);
+        shared->frame = NULL;
+    }
+    shared->has_frame_time = 0;
+}
+
+static struct sxplayer_frame *shared_get_frame(struct media_priv *s, double media_time)
+{
+    struct media_shared *shared = s->shared;
+
+    if (!shared->has_frame_time || shared->frame_time != media_time) {
+        struct sxplayer_frame *frame = sxplayer_get_frame(shared->player, media_time);
+        if (frame) {
+            shared_reset_frame(shared);
+            shared_ref_frame(shared, frame);
+            shared->frame = frame;
+            shared->frame_id++;
+        }
+        shared->frame_time = media_time;
+        shared->has_frame_time = 1;
+    }
+
+    /* Every node gets each new frame once, like with its own player */
+    if (!shared->frame || s->shared_frame_id == shared->frame_id)
+        return NULL;
+    s->shared_frame_id = shared->frame_id;
+    shared_ref_frame(shared, shared->frame);
+    return shared->frame;
+}
+
+static void release_frame(struct media_priv *s, struct sxplayer_frame *frame)
+{
+    if (!frame)
+        return;
+    if (s->shared)
+        shared_unref_frame(s->shared, frame);
+    else
+        sxplayer_release_frame(frame);
+}
+
+void ngli_node_media_release_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    release_frame(node->priv_data, frame);
+}
+
+/*
+ * An entry is known to be displayed between its timestamp and the latest
+ * media time at which sxplayer did not return a newer frame: within this
+ * range, the frame is served from the cache without querying sxplayer.
+ */
+static struct media_cache_entry *cache_lookup(struct media_priv *s, double media_time)
+{
+    for (int i = 0; i < s->frame_cache; i++) {
+        struct media_cache_entry *entry = &s->cache[i];
+        if (entry->used && media_time >= entry->ts && media_time <= entry->max_time)
+            return entry;
+    }
+    return NULL;
+}
+
+static void cache_evict(struct media_cache_entry *entry)
+{
+    ngli_texture_reset(&entry->texture);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static void cache_reset(struct media_priv *s)
+{
+    if (!s->cache)
+        return;
+    for (int i = 0; i < s->frame_cache; i++)
+        cache_evict(&s->cache[i]);
+    s->cache_current = s->cache_player = NULL;
+}
+
+/*
+ * Take over the texture holding the frame just uploaded. The texture of the
+ * least recently used entry is handed back so the next upload can reuse it.
+ */
+struct texture *ngli_node_media_cache_texture(struct ngl_node *node, struct texture *texture, double ts)
+{
+    struct media_priv *s = node->priv_data;
+    if (!s->frame_cache)
+        return NULL;
+
+    struct media_cache_entry *slot = NULL;
+    for (int i = 0; i < s->frame_cache; i++) {
+        struct media_cache_entry *entry = &s->cache[i];
+        if (!entry->used) {
+            slot = entry;
+            break;
+        }
+        if (!slot || entry->last_use < slot->last_use)
+            slot = entry;
+    }
+
+    const struct texture tmp = slot->texture;
+    slot->texture = *texture;
+    *texture = tmp;
+    slot->used = 1;
+    slot->ts = ts;
+    slot->max_time = NGLI_MAX(ts, s->cache_time);
+    slot->last_use = ++s->cache_clock;
+    s->cache_current = s->cache_player = slot;
+
+    struct ngl_ctx *ctx = node->ctx;
+    while (ngli_node_exceeds_memory_budget(ctx)) {
+        struct media_cache_entry *lru = NULL;
+        for (int i = 0; i < s->frame_cache; i++) {
+            struct media_cache_entry *entry = &s->cache[i];
+            if (entry->used && entry != slot && (!lru || entry->last_use < lru->last_use))
+                lru = entry;
+        }
+        if (!lru)
+            break;
+        cache_evict(lru);
+    }
+
+    return &slot->texture;
+}
+
+static int shared_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct media_priv *s = node->priv_data;
+
+    char *key = get_shared_key(s);
+    if (!key)
+        return player_init(node);
+
+    if (!ctx->media_pool) {
+        ctx->media_pool = ngli_hmap_create();
+        if (!ctx->media_pool) {
+            ngli_free(key);
+            return NGL_ERROR_MEMORY;
+        }
+    }
+
+    struct media_shared *shared = ngli_hmap_get(ctx->media_pool, key);
+    if (shared) {
+        ngli_free(key);
+        LOG(DEBUG, "share player of %s", s->filename);
+        shared->refcount++;
+        s->shared = shared;
+        s->player = shared->player;
+        return 0;
+    }
+
+    shared = ngli_calloc(1, sizeof(*shared));
+    if (!shared) {
+        ngli_free(key);
+        return NGL_ERROR_MEMORY;
+    }
+    shared->key = key;
+    shared->refcount = 1;
+    shared->sxplayer_min_level = s->sxplayer_min_level;
+    ngli_darray_init(&shared->frames, sizeof(struct shared_frame), 0);
+
+    int ret = ngli_hmap_set(ctx->media_pool, key, shared);
+    if (ret < 0) {
+        ngli_free(shared->key);
+        ngli_free(shared);
+        return ret;
+    }
+    s->shared = shared;
+
+    ret = player_init(node);
+    shared->player = s->player;
+    if (ret < 0)
+        return ret;
+
+    /* The shared player outlives the node which created it */
+    sxplayer_set_log_callback(shared->player, &shared->sxplayer_min_level, callback_sxplayer_log);
+
+    return 0;
+}
+
+/*
+ * The decoding session of a player (possibly a hardware one) is created when
+ * the player starts and destroyed when it stops. Instead of being stopped,
+ * the players of the released media keep running in a pool of the context (up
+ * to ngl_config.decoder_pool_size, the oldest being stopped first) so that
+ * prefetching the same media again only costs a seek.
+ */
+static void park_player(struct ngl_ctx *ctx, struct sxplayer_ctx *player)
+{
+    const int pool_size = ctx->config.decoder_pool_size;
+    if (!pool_size || !ngli_darray_push(&ctx->parked_players, &player)) {
+        sxplayer_stop(player);
+        return;
+    }
+
+    struct darray *parked = &ctx->parked_players;
+    struct sxplayer_ctx **players = ngli_darray_data(parked);
+    const int nb_players = ngli_darray_count(parked);
+    const int nb_stopped = NGLI_MAX(nb_players - pool_size, 0);
+    for (int i = 0; i < nb_stopped; i++)
+        sxplayer_stop(players[i]);
+    memmove(players, players + nb_stopped, (nb_players - nb_stopped) * sizeof(*players));
+    parked->count -= nb_stopped;
+}
+
+/* Returns whether the player was parked, and is thus still running */
+static int unpark_player(struct ngl_ctx *ctx, struct sxplayer_ctx *player)
+{
+    struct darray *parked = &ctx->parked_players;
+    struct sxplayer_ctx **players = ngli_darray_data(parked);
+    const int nb_players = ngli_darray_count(parked);
+    for (int i = 0; i < nb_players; i++) {
+        if (players[i] == player) {
+            memmove(&players[i], &players[i + 1], (nb_players - i - 1) * sizeof(*players));
+            parked->count--;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void shared_uninit(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct media_priv *s = node->priv_data;
+    struct media_shared *shared = s->shared;
+
+    s->shared = NULL;
+    s->player = NULL;
+    if (--shared->refcount)
+        return;
+
+    /* Frames still referenced by the textures are released directly */
+    shared_reset_frame(shared);
+    ngli_darray_reset(&shared->frames);
+    unpark_player(ctx, shared->player);
+    sxplayer_free(&shared->player);
+
+    ngli_hmap_set(ctx->media_pool, shared->key, NULL);
+    ngli_free(shared->key);
+    ngli_free(shared);
+    if (!ngli_hmap_count(ctx->media_pool))
+        ngli_hmap_freep(&ctx->media_pool);
+}
+
+/*
+ * A still image only needs its first frame: it is decoded by a short-lived
+ * software player instead of a player running for the lifetime of the node.
+ */
+static int decode_still_image(void *arg, const char *filename, struct imagecache_image *image)
+{
+    const struct media_priv *s = arg;
+
+    struct sxplayer_ctx *player = sxplayer_create(filename);
+    if (!player)
+        return NGL_ERROR_MEMORY;
+
+    sxplayer_set_log_callback(player, (void *)&s->sxplayer_min_level, callback_sxplayer_log);
+    if (s->max_pixels)
+        sxplayer_set_option(player, "max_pixels", s->max_pixels);
+    sxplayer_set_option(player, "stream_idx", s->stream_idx);
+    sxplayer_set_option(player, "auto_hwaccel", 0);
+    sxplayer_set_option(player, "sw_pix_fmt", SXPLAYER_PIXFMT_RGBA);
+
+    int ret = 0;
+    struct sxplayer_frame *frame = sxplayer_get_frame(player, 0);
+    if (!frame) {
+        ret = NGL_ERROR_INVALID_DATA;
+        goto end;
+    }
+    if (frame->pix_fmt != SXPLAYER_PIXFMT_RGBA && frame->pix_fmt != SXPLAYER_PIXFMT_BGRA) {
+        LOG(ERROR, "unexpected pixel format %d for still image %s", frame->pix_fmt, filename);
+        ret = NGL_ERROR_UNSUPPORTED;
+        goto end;
+    }
+
+    image->width = frame->width;
+    image->height = frame->height;
+    image->format = frame->pix_fmt == SXPLAYER_PIXFMT_RGBA ? NGLI_FORMAT_R8G8B8A8_UNORM
+                                                           : NGLI_FORMAT_B8G8R8A8_UNORM;
+    image->bytes_per_pixel = 4;
+    const int linesize = frame->width * image->bytes_per_pixel;
+    image->data = ngli_malloc((int64_t)linesize * frame->height);
+    if (!image->data) {
+        ret = NGL_ERROR_MEMORY;
+        goto end;
+    }
+    for (int y = 0; y < frame->height; y++)
+        memcpy(image->data + y * linesize, frame->data + y * frame->linesize, linesize);
+
+end:
+    sxplayer_release_frame(frame);
+    sxplayer_free(&player);
+    return ret;
+}
+
+struct still_texture {
+    struct texture_params params;
+    struct texture texture;
+};
+
+void ngli_node_media_free_still_texture(void *user_arg, void *priv)
+{
+    struct still_texture *still_texture = priv;
+    ngli_texture_reset(&still_texture->texture);
+    ngli_free(still_texture);
+}
+
+static void trim_still_textures(struct ngl_ctx *ctx)
+{
+    while (ngli_node_exceeds_memory_budget(ctx) && ngli_imagecache_drop_priv(&ctx->image_cache))
+        ;
+}
+
+/*
+ * The texture of a still image is uploaded once and shared by the textures
+ * sampling it with the same parameters; it is kept once unreferenced, within
+ * the GPU memory budget. A texture with other parameters gets no shared
+ * texture and uploads its own copy of the image.
+ */
+int ngli_node_media_ref_still_texture(struct ngl_node *node, const struct texture_params *params,
+                                      struct texture **texturep)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct media_priv *s = node->priv_data;
+    struct imagecache_entry *entry = s->still_entry;
+    const struct imagecache_image *image = &entry->image;
+
+    struct texture_params texture_params = *params;
+    texture_params.format = image->format;
+    texture_params.width = image->width;
+    texture_params.height = image->height;
+
+    struct still_texture *still_texture = entry->priv;
+    if (still_texture) {
+        if (memcmp(&still_texture->params, &texture_params, sizeof(texture_params))) {
+            *texturep = NULL;
+            return 0;
+        }
+        ngli_imagecache_ref_priv(&ctx->image_cache, entry);
+        *texturep = &still_texture->texture;
+        return 0;
+    }
+
+    still_texture = ngli_calloc(1, sizeof(*still_texture));
+    if (!still_texture)
+        return NGL_ERROR_MEMORY;
+    still_texture->params = texture_params;
+
+    int ret = ngli_texture_init(&still_texture->texture, ctx, &texture_params);
+    if (ret >= 0)
+        ret = ngli_texture_upload(&still_texture->texture, image->data, 0);
+    if (ret < 0) {
+        ngli_node_media_free_still_texture(NULL, still_texture);
+        return ret;
+    }
+
+    entry->priv = still_texture;
+    ngli_imagecache_ref_priv(&ctx->image_cache, entry);
+    trim_still_textures(ctx);
+    *texturep = &still_texture->texture;
+    return 0;
+}
+
+void ngli_node_media_unref_still_texture(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct media_priv *s = node->priv_data;
+    ngli_imagecache_unref_priv(&ctx->image_cache, s->still_entry);
+    trim_still_textures(ctx);
+}
+
+static int still_cpu_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct media_priv *s = node->priv_data;
+
+    if (s->audio_tex || s->live || s->lookahead || s->frame_cache) {
+        LOG(ERROR, "still images can not be used with %s",
+            s->audio_tex ? "audio" : s->live ? "a live source" :
+            s->lookahead ? "look-ahead decoding" : "a frame cache");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    char options[32];
+    snprintf(options, sizeof(options), "%d %d", s->max_pixels, s->stream_idx);
+    return ngli_imagecache_get(&ctx->image_cache, s->filename, options,
+                               decode_still_image, s, &s->still_entry);
+}
+
+static int media_cpu_init(struct ngl_node *node)
+{
+    struct media_priv *s = node->priv_data;
+
+    if (s->still)
+        return still_cpu_init(node);
+
+    if (s->lookahead < 0 || s->lookahead > NGLI_MEDIA_MAX_LOOKAHEAD) {
+        LOG(ERROR, "look-ahead must be in [0,%d]: %d", NGLI_MEDIA_MAX_LOOKAHEAD, s->lookahead);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (s->frame_cache < 0) {
+        LOG(ERROR, "frame cache size must be positive: %d", s->frame_cache);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+#if defined(TARGET_ANDROID)
+    if (s->live) {
+        LOG(ERROR, "live sources are not supported with MediaCodec surfaces");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+#endif
+
+    if (s->live && (s->anim || s->lookahead || s->frame_cache)) {
+        LOG(ERROR, "live sources can not be used with %s",
+            s->anim ? "a time remapping" : s->lookahead ? "look-ahead decoding" : "a frame cache");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (s->live) {
+        /* Keep the latency at its minimum */
+        s->max_nb_packets = s->max_nb_frames = s->max_nb_sink = 1;
+        pthread_mutex_init(&s->live_lock, NULL);
+    }
+
+    if (s->audio_fft) {
+        if (!s->audio_tex) {
+            LOG(ERROR, "the GPU audio spectrum requires audio_tex");
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        if (s->audio_nb_bins < NGLI_AUDIOFFT_MIN_BINS || s->audio_nb_bins > NGLI_AUDIOFFT_MAX_BINS ||
+            (s->audio_nb_bins & (s->audio_nb_bins - 1))) {
+            LOG(ERROR, "the number of audio bins must be a power of two in [%d,%d]",
+                NGLI_AUDIOFFT_MIN_BINS, NGLI_AUDIOFFT_MAX_BINS);
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (s->audio_smoothing < 0. || s->audio_smoothing >= 1.) {
+            LOG(ERROR, "the audio smoothing must be in [0,1)");
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    if (s->frame_cache && (s->audio_tex || s->lookahead)) {
+        LOG(ERROR, "frame cache is not supported with %s", s->audio_tex ? "audio" : "look-ahead decoding");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    if (s->frame_cache) {
+        s->cache = ngli_calloc(s->frame_cache, sizeof(*s->cache));
+        if (!s->cache)
+            return NGL_ERROR_MEMORY;
+    }
+
+#if defined(TARGET_ANDROID)
+    if (s->lookahead) {
+        LOG(WARNING, "look-ahead decoding is not supported with MediaCodec surfaces, disabling it");
+        s->lookahead = 0;
+    }
+#endif
+
+    if (s->lookahead) {
+        pthread_mutex_init(&s->lookahead_lock, NULL);
+        pthread_cond_init(&s->lookahead_cond, NULL);
+    }
+
+    return 0;
+}
+
+static int media_init(struct ngl_node *node)
+{
+    struct media_priv *s = node->priv_data;
+    if (s->still)
+        return 0;
+    return shared_init(node);
+}
+
 static int media_prefetch(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct media_priv *s = node->priv_data;
-    sxplayer_start(s->player);
+    if (s->still) {
+        s->still_delivered = 0;
+        return 0;
+    }
+    s->thread_priority = ctx->config.thread_priority;
+    s->thread_affinity = ctx->config.thread_affinity;
+    if (s->shared) {
+        s->shared_frame_id = 0;
+        if (s->shared->nb_started++)
+            return 0;
+    }
+    if (unpark_player(ctx, s->player))
+        LOG(DEBUG, "reuse running player of %s", s->filename);
+    else
+        sxplayer_start(s->player);
+    if (s->lookahead) {
+        s->lookahead_delivered = 0;
+        lookahead_start(s);
+    }
+    if (s->live)
+        live_start(s);
     return 0;
 }
 
 static const char * const pix_fmt_names[] = {
     [SXPLAYER_PIXFMT_RGBA]       = "rgba",
     [SXPLAYER_PIXFMT_BGRA]       = "bgra",
+    [SXPLAYER_PIXFMT_NV12]       = "nv12",
     [SXPLAYER_PIXFMT_VT]         = "vt",
     [SXPLAYER_PIXFMT_MEDIACODEC] = "mediacodec",
     [SXPLAYER_PIXFMT_VAAPI]      = "vaapi",
@@ -207,6 +1077,30 @@ static int media_update(struct ngl_node *node, double t)
     struct ngl_node *anim_node = s->anim;
     double media_time = t;
 
+    if (s->still) {
+        const int changed = !s->still_delivered;
+        s->still_delivered = 1;
+        return changed;
+    }
+
+    if (s->live) {
+        ngli_node_restrict_next_change(node, t);
+        struct sxplayer_frame *frame = live_get_frame(s);
+        if (!frame)
+            return 0;
+        release_frame(s, s->frame);
+        s->frame = frame;
+        TRACE("got live frame with ts=%f", frame->ts);
+        return 1;
+    }
+
+    /*
+     * The media time is either t shifted by time_offset, or remapped by an
+     * animation with several key frames which then reports by itself when it
+     * changes
+     */
+    double time_offset = 0.;
+    int remapped = 0;
     if (anim_node) {
         struct variable_priv *anim = anim_node->priv_data;
 
@@ -216,7 +1110,9 @@ static int media_update(struct ngl_node *node, double t)
 
             if (anim->nb_animkf == 1) {
                 media_time = NGLI_MAX(0, t - kf0->time);
+                time_offset = kf0->time;
             } else {
+                remapped = 1;
                 int ret = ngli_node_update(anim_node, t);
                 if (ret < 0)
                     return ret;
@@ -231,10 +1127,31 @@ static int media_update(struct ngl_node *node, double t)
         }
     }
 
-    sxplayer_release_frame(s->frame);
+    /* The time of the next frame is only known from the look-ahead queue */
+    const int lookahead_next = !remapped && t >= time_offset &&
+                               s->lookahead_running && !s->shared && !s->frame_cache;
+    if (!remapped && !lookahead_next)
+        ngli_node_restrict_next_change(node, NGLI_MAX(t, time_offset));
+
+    if (s->frame_cache) {
+        struct media_cache_entry *entry = cache_lookup(s, media_time);
+        if (entry) {
+            TRACE("serve frame with ts=%f from the cache of %s at t=%g", entry->ts, node->label, media_time);
+            release_frame(s, s->frame);
+            s->frame = NULL;
+            entry->last_use = ++s->cache_clock;
+            const int changed = entry != s->cache_current;
+            s->cache_current = entry;
+            return changed;
+        }
+    }
+
+    release_frame(s, s->frame);
 
     TRACE("get frame from %s at t=%g", node->label, media_time);
-    struct sxplayer_frame *frame = sxplayer_get_frame(s->player, media_time);
+    struct sxplayer_frame *frame = s->shared            ? shared_get_frame(s, media_time)
+                                 : s->lookahead_running ? lookahead_get_frame(s, media_time)
+                                 : sxplayer_get_frame(s->player, media_time);
     if (frame) {
         const char *pix_fmt_str = frame->pix_fmt >= 0 &&
                                   frame->pix_fmt < NGLI_ARRAY_NB(pix_fmt_names) ? pix_fmt_names[frame->pix_fmt]
@@ -254,32 +1171,83 @@ static int media_update(struct ngl_node *node, double t)
               pix_fmt_str, frame->ts);
     }
     s->frame = frame;
-    return 0;
+
+    if (lookahead_next)
+        ngli_node_restrict_next_change(node, lookahead_get_next_time(s, media_time) + time_offset);
+
+    if (s->frame_cache) {
+        s->cache_time = media_time;
+        /* No new frame: sxplayer keeps displaying the last one it returned */
+        struct media_cache_entry *entry = s->cache_player;
+        if (!frame && entry) {
+            entry->max_time = NGLI_MAX(entry->max_time, media_time);
+            entry->last_use = ++s->cache_clock;
+            const int changed = entry != s->cache_current;
+            s->cache_current = entry;
+            return changed;
+        }
+        s->cache_current = s->cache_player = NULL;
+    }
+
+    return frame != NULL;
 }
 
 static void media_release(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct media_priv *s = node->priv_data;
-    sxplayer_release_frame(s->frame);
+    if (s->still)
+        return;
+    lookahead_stop(s);
+    live_stop(s);
+    release_frame(s, s->frame);
     s->frame = NULL;
-    sxplayer_stop(s->player);
+    cache_reset(s);
+    if (s->shared) {
+        if (--s->shared->nb_started)
+            return;
+        shared_reset_frame(s->shared);
+    }
+    park_player(ctx, s->player);
 }
 
 static void media_uninit(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct media_priv *s = node->priv_data;
-    sxplayer_free(&s->player);
+    if (s->still) {
+        ngli_imagecache_release(&ctx->image_cache, &s->still_entry);
+        return;
+    }
+    lookahead_stop(s);
+    live_stop(s);
+    cache_reset(s);
+    ngli_free(s->cache);
+    if (s->shared) {
+        shared_uninit(node);
+    } else {
+        unpark_player(ctx, s->player);
+        sxplayer_free(&s->player);
+    }
+    if (s->lookahead) {
+        pthread_mutex_destroy(&s->lookahead_lock);
+        pthread_cond_destroy(&s->lookahead_cond);
+    }
+    if (s->live)
+        pthread_mutex_destroy(&s->live_lock);
 
 #if defined(TARGET_ANDROID)
     ngli_android_surface_free(&s->android_surface);
-    ngli_android_handlerthread_free(&s->android_handlerthread);
+    ngli_android_imagereader_free(&s->android_imagereader);
     ngli_texture_reset(&s->android_texture);
 #endif
 }
 
 const struct node_class ngli_media_class = {
     .id        = NGL_NODE_MEDIA,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "Media",
+    .cpu_init  = media_cpu_init,
     .init      = media_init,
     .prefetch  = media_prefetch,
     .update    = media_update,
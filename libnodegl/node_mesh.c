@@ -0,0 +1,213 @@
+/*
+ * Copyright 2017 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "topology.h"
+#include "utils.h"
+
+/*
+ * Mesh file layout, all the fields being little-endian:
+ *
+ *   header (64 bytes):
+ *     char     magic[4]        "NGLM"
+ *     uint32_t version         1
+ *     uint32_t nb_vertices
+ *     uint32_t nb_indices
+ *     uint32_t flags           MESH_FLAG_* for the optional attributes
+ *     float    bounds_min[3]   object space bounding box of the vertices
+ *     float    bounds_max[3]
+ *     uint32_t reserved[5]
+ *   float    vertices[nb_vertices][3]
+ *   float    uvcoords[nb_vertices][2]  (if MESH_FLAG_UVCOORDS)
+ *   float    normals[nb_vertices][3]   (if MESH_FLAG_NORMALS)
+ *   uint32_t indices[nb_indices]       (triangle list)
+ */
+#define MESH_MAGIC "NGLM"
+#define MESH_VERSION 1
+#define MESH_HEADER_SIZE 64
+#define MESH_FLAG_UVCOORDS (1 << 0)
+#define MESH_FLAG_NORMALS  (1 << 1)
+
+struct mesh_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t nb_vertices;
+    uint32_t nb_indices;
+    uint32_t flags;
+    float bounds_min[3];
+    float bounds_max[3];
+    uint32_t reserved[5];
+};
+
+NGLI_STATIC_ASSERT(mesh_header_size, sizeof(struct mesh_header) == MESH_HEADER_SIZE);
+
+#define OFFSET(x) offsetof(struct geometry_priv, x)
+static const struct node_param mesh_params[] = {
+    {"filename", PARAM_TYPE_STR, OFFSET(filename), .flags=PARAM_FLAG_CONSTRUCTOR,
+                 .desc=NGLI_DOCSTRING("path to the binary mesh file, as written by `pynodegl_utils.misc.write_mesh()`")},
+    {NULL}
+};
+
+static int read_header(const char *filename, struct mesh_header *header, int64_t *file_size)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        LOG(ERROR, "could not open '%s'", filename);
+        return NGL_ERROR_IO;
+    }
+
+    int ret = 0;
+    if (fread(header, sizeof(*header), 1, fp) != 1 || fseek(fp, 0, SEEK_END) < 0) {
+        LOG(ERROR, "could not read the header of '%s'", filename);
+        ret = NGL_ERROR_INVALID_DATA;
+    } else {
+        *file_size = ftell(fp);
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+/*
+ * The attributes are file-backed buffers mapping their slice of the file:
+ * nothing is read at init, the pages are only loaded while uploading
+ */
+static struct ngl_node *create_buffer(struct ngl_node *node, int type, int count, int64_t offset)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    struct ngl_node *buffer = ngl_node_create(type);
+    if (!buffer)
+        return NULL;
+
+    ngl_node_param_set(buffer, "count", count);
+    ngl_node_param_set(buffer, "filename", s->filename);
+    struct buffer_priv *buffer_priv = buffer->priv_data;
+    buffer_priv->file_offset = offset;
+
+    int ret = ngli_node_attach_ctx(buffer, node->ctx);
+    if (ret < 0) {
+        ngli_node_detach_ctx(buffer, node->ctx);
+        ngl_node_unrefp(&buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+static void release_buffer(struct ngl_node **nodep)
+{
+    struct ngl_node *node = *nodep;
+    if (!node)
+        return;
+    ngli_node_detach_ctx(node, node->ctx);
+    ngl_node_unrefp(nodep);
+}
+
+static int mesh_init(struct ngl_node *node)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    struct mesh_header header;
+    int64_t file_size;
+    int ret = read_header(s->filename, &header, &file_size);
+    if (ret < 0)
+        return ret;
+
+    if (memcmp(header.magic, MESH_MAGIC, sizeof(header.magic)) || header.version != MESH_VERSION) {
+        LOG(ERROR, "'%s' is not a version %d mesh file", s->filename, MESH_VERSION);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    const int64_t nb_vertices = header.nb_vertices;
+    const int64_t nb_indices = header.nb_indices;
+    const int has_uvcoords = header.flags & MESH_FLAG_UVCOORDS;
+    const int has_normals = header.flags & MESH_FLAG_NORMALS;
+    const int64_t vertices_offset = MESH_HEADER_SIZE;
+    const int64_t uvcoords_offset = vertices_offset + nb_vertices * 3 * sizeof(float);
+    const int64_t normals_offset  = uvcoords_offset + (has_uvcoords ? nb_vertices * 2 * sizeof(float) : 0);
+    const int64_t indices_offset  = normals_offset  + (has_normals  ? nb_vertices * 3 * sizeof(float) : 0);
+    const int64_t end_offset      = indices_offset  + nb_indices * sizeof(uint32_t);
+
+    if (!nb_vertices || !nb_indices || nb_indices % 3 || end_offset > file_size ||
+        nb_vertices * 3 * sizeof(float) > INT_MAX || nb_indices * sizeof(uint32_t) > INT_MAX) {
+        LOG(ERROR, "invalid mesh in '%s' (%" PRId64 " vertices, %" PRId64 " indices, %" PRId64 " bytes)",
+            s->filename, nb_vertices, nb_indices, file_size);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    s->vertices_buffer = create_buffer(node, NGL_NODE_BUFFERVEC3, nb_vertices, vertices_offset);
+    if (!s->vertices_buffer)
+        return NGL_ERROR_MEMORY;
+
+    if (has_uvcoords) {
+        s->uvcoords_buffer = create_buffer(node, NGL_NODE_BUFFERVEC2, nb_vertices, uvcoords_offset);
+        if (!s->uvcoords_buffer)
+            return NGL_ERROR_MEMORY;
+    }
+
+    if (has_normals) {
+        s->normals_buffer = create_buffer(node, NGL_NODE_BUFFERVEC3, nb_vertices, normals_offset);
+        if (!s->normals_buffer)
+            return NGL_ERROR_MEMORY;
+    }
+
+    s->indices_buffer = create_buffer(node, NGL_NODE_BUFFERUINT, nb_indices, indices_offset);
+    if (!s->indices_buffer)
+        return NGL_ERROR_MEMORY;
+
+    s->topology = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    /* The bounds come from the header so the vertices are not read at init */
+    memcpy(s->bounds_min, header.bounds_min, sizeof(s->bounds_min));
+    memcpy(s->bounds_max, header.bounds_max, sizeof(s->bounds_max));
+    s->has_bounds = 1;
+
+    return 0;
+}
+
+static void mesh_uninit(struct ngl_node *node)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    release_buffer(&s->vertices_buffer);
+    release_buffer(&s->uvcoords_buffer);
+    release_buffer(&s->normals_buffer);
+    release_buffer(&s->indices_buffer);
+}
+
+const struct node_class ngli_mesh_class = {
+    .id        = NGL_NODE_MESH,
+    .name      = "Mesh",
+    .init      = mesh_init,
+    .uninit    = mesh_uninit,
+    .priv_size = sizeof(struct geometry_priv),
+    .params    = mesh_params,
+    .file      = __FILE__,
+};
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+
+#include "glcontext.h"
+#include "glincludes.h"
+#include "glstate.h"
+#include "graphicconfig.h"
+#include "log.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "pass.h"
+
+struct occlusioncull_priv {
+    struct ngl_node *child;
+    struct ngl_node *proxy;
+
+    GLuint query;
+    int query_pending;
+    int visible;
+};
+
+#define OFFSET(x) offsetof(struct occlusioncull_priv, x)
+static const struct node_param occlusioncull_params[] = {
+    {"child", PARAM_TYPE_NODE, OFFSET(child),
+              .flags=PARAM_FLAG_CONSTRUCTOR,
+              .desc=NGLI_DOCSTRING("scene to be rendered only while the proxy is visible; the visibility is "
+                                   "known from a previous frame, so the scene appears one or more frames after "
+                                   "being uncovered")},
+    {"proxy", PARAM_TYPE_NODE, OFFSET(proxy),
+              .flags=PARAM_FLAG_CONSTRUCTOR,
+              .desc=NGLI_DOCSTRING("cheap scene covering the bounds of `child` (typically a `Render` of its "
+                                   "bounding geometry), drawn without writing any color, depth or stencil "
+                                   "to test its visibility against the depth of what is already rendered")},
+    {NULL}
+};
+
+static int occlusioncull_init(struct ngl_node *node)
+{
+    struct occlusioncull_priv *s = node->priv_data;
+    s->visible = 1;
+    return 0;
+}
+
+static int occlusioncull_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct occlusioncull_priv *s = node->priv_data;
+
+    if (!(gl->features & NGLI_FEATURE_OCCLUSION_QUERY)) {
+        LOG(WARNING, "context does not support occlusion queries, the child will always be rendered");
+        return 0;
+    }
+
+    ngli_glGenQueries(gl, 1, &s->query);
+    s->query_pending = 0;
+    s->visible = 1;
+    return 0;
+}
+
+/*
+ * The query result is only read once available so the CPU never waits for
+ * the GPU: the visibility used for a frame is the one of a previous frame.
+ */
+static void poll_query(struct occlusioncull_priv *s, struct glcontext *gl)
+{
+    GLuint available = 0;
+    ngli_glGetQueryObjectuiv(gl, s->query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return;
+
+    GLuint samples_passed = 0;
+    ngli_glGetQueryObjectuiv(gl, s->query, GL_QUERY_RESULT, &samples_passed);
+    s->visible = samples_passed != 0;
+    s->query_pending = 0;
+}
+
+static void run_query(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct occlusioncull_priv *s = node->priv_data;
+
+    const struct graphicconfig parent = ctx->graphicconfig;
+    struct graphicconfig graphicconfig = parent;
+    graphicconfig.color_write_mask = 0;
+    graphicconfig.depth_write_mask = 0;
+    graphicconfig.stencil_write_mask = 0;
+
+    /* The query must only cover the draws of the proxy */
+    ngli_pass_flush_draw_list(ctx);
+    ngli_glstate_set_pending(ctx, &graphicconfig, NULL);
+    ngli_glBeginQuery(gl, GL_ANY_SAMPLES_PASSED, s->query);
+    ngli_node_draw(s->proxy);
+    ngli_pass_flush_draw_list(ctx);
+    ngli_glEndQuery(gl, GL_ANY_SAMPLES_PASSED);
+    ngli_glstate_set_pending(ctx, &parent, NULL);
+
+    s->query_pending = 1;
+}
+
+static int occlusioncull_update(struct ngl_node *node, double t)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct occlusioncull_priv *s = node->priv_data;
+
+    if (s->query_pending)
+        poll_query(s, ctx->glcontext);
+
+    int ret = ngli_node_update(s->proxy, t);
+    if (ret < 0)
+        return ret;
+
+    /* The child is only updated for the frames it is drawn */
+    if (!s->visible)
+        return 0;
+
+    return ngli_node_update(s->child, t);
+}
+
+static void occlusioncull_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct occlusioncull_priv *s = node->priv_data;
+
+    /* A new query is only issued once the previous result has been read,
+     * and the additional outputs reuse the decision of the main target */
+    if (s->query && !s->query_pending && !ctx->drawing_outputs)
+        run_query(node);
+
+    if (s->visible)
+        ngli_node_draw(s->child);
+}
+
+static void occlusioncull_release(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct occlusioncull_priv *s = node->priv_data;
+
+    if (s->query)
+        ngli_glDeleteQueries(gl, 1, &s->query);
+    s->query = 0;
+    s->query_pending = 0;
+    s->visible = 1;
+}
+
+const struct node_class ngli_occlusioncull_class = {
+    .id        = NGL_NODE_OCCLUSIONCULL,
+    .name      = "OcclusionCull",
+    .init      = occlusioncull_init,
+    .prefetch  = occlusioncull_prefetch,
+    .update    = occlusioncull_update,
+    .draw      = occlusioncull_draw,
+    .release   = occlusioncull_release,
+    .priv_size = sizeof(struct occlusioncull_priv),
+    .params    = occlusioncull_params,
+    .file      = __FILE__,
+};
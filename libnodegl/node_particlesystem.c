@@ -0,0 +1,612 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "buffer.h"
+#include "format.h"
+#include "glcontext.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "pass.h"
+#include "pipeline.h"
+#include "program.h"
+#include "topology.h"
+#include "tracemarker.h"
+#include "type.h"
+#include "utils.h"
+
+#define GROUP_SIZE 64
+
+#define PARTICLE_SIZE (2 * 4 * sizeof(float)) /* position and age, velocity and lifetime */
+#define INSTANCE_SIZE (4 * sizeof(float))     /* position and normalized age */
+#define STATE_SIZE    (12 * sizeof(uint32_t))
+
+/*
+ * The indices buffer holds the dead list (the free particle slots) followed
+ * by the two alive lists, used in turn as the source and the destination of
+ * the simulation. The state starts with the draw command, whose instance
+ * count is also the number of particles in the current alive list, followed
+ * by the dispatch command of the simulation.
+ */
+#define COMPUTE_HEADER                                                               \
+    "#version %s\n"                                                                  \
+    "#define MAX_PARTICLES %du\n"                                                    \
+    "precision highp float;\n"                                                       \
+    "layout(local_size_x = %d) in;\n"                                                \
+    "struct particle {\n"                                                            \
+    "    vec4 position;\n"                                                           \
+    "    vec4 velocity;\n"                                                           \
+    "};\n"                                                                           \
+    "layout(std430, binding = 0) buffer particles_block {\n"                         \
+    "    particle particles[];\n"                                                    \
+    "};\n"                                                                           \
+    "layout(std430, binding = 1) buffer indices_block {\n"                           \
+    "    uint indices[];\n"                                                          \
+    "};\n"                                                                           \
+    "layout(std430, binding = 2) buffer state_block {\n"                             \
+    "    uint draw_command[4];\n"                                                    \
+    "    uint dispatch_command[3];\n"                                                \
+    "    int nb_dead;\n"                                                             \
+    "    uint nb_alive_in;\n"                                                        \
+    "};\n"                                                                           \
+    "layout(std430, binding = 3) writeonly buffer instances_block {\n"               \
+    "    vec4 instances[];\n"                                                        \
+    "};\n"                                                                           \
+    "uniform int src;\n"                                                             \
+    "uint get_alive_offset(int list) { return MAX_PARTICLES * uint(1 + list); }\n"
+
+static const char reset_compute_data[] =
+    COMPUTE_HEADER
+    "void main(void)\n"
+    "{\n"
+    "    uint id = gl_GlobalInvocationID.x;\n"
+    "    if (id == 0u) {\n"
+    "        draw_command[0] = 4u;\n"
+    "        draw_command[1] = 0u;\n"
+    "        draw_command[2] = 0u;\n"
+    "        draw_command[3] = 0u;\n"
+    "        dispatch_command[0] = 0u;\n"
+    "        dispatch_command[1] = 1u;\n"
+    "        dispatch_command[2] = 1u;\n"
+    "        nb_dead = int(MAX_PARTICLES);\n"
+    "        nb_alive_in = 0u;\n"
+    "    }\n"
+    "    if (id < MAX_PARTICLES)\n"
+    "        indices[id] = MAX_PARTICLES - 1u - id;\n"
+    "}\n";
+
+/*
+ * A particle slot is popped from the dead list for each emission, the
+ * emissions exceeding the free slots being dropped
+ */
+static const char emit_compute_data[] =
+    COMPUTE_HEADER
+    "uniform int nb_emit;\n"
+    "uniform int seed;\n"
+    "uniform float lifetime;\n"
+    "uniform vec3 emitter;\n"
+    "uniform vec3 emitter_size;\n"
+    "uniform vec3 velocity;\n"
+    "uniform float velocity_spread;\n"
+    "uint hash(uint x)\n"
+    "{\n"
+    "    x ^= x >> 16;\n"
+    "    x *= 0x7feb352du;\n"
+    "    x ^= x >> 15;\n"
+    "    x *= 0x846ca68bu;\n"
+    "    x ^= x >> 16;\n"
+    "    return x;\n"
+    "}\n"
+    "vec3 random3(inout uint state)\n"
+    "{\n"
+    "    vec3 r;\n"
+    "    for (int i = 0; i < 3; i++) {\n"
+    "        state = hash(state);\n"
+    "        r[i] = float(state >> 8) / 16777216.0;\n"
+    "    }\n"
+    "    return r;\n"
+    "}\n"
+    "void main(void)\n"
+    "{\n"
+    "    uint id = gl_GlobalInvocationID.x;\n"
+    "    if (id >= uint(nb_emit))\n"
+    "        return;\n"
+    "    int nb = atomicAdd(nb_dead, -1);\n"
+    "    if (nb <= 0) {\n"
+    "        atomicAdd(nb_dead, 1);\n"
+    "        return;\n"
+    "    }\n"
+    "    uint index = indices[nb - 1];\n"
+    "    uint state = hash(id ^ (uint(seed) * 0x9e3779b9u));\n"
+    "    vec3 position = emitter + (random3(state) - 0.5) * emitter_size;\n"
+    "    vec3 speed = velocity + (random3(state) * 2.0 - 1.0) * velocity_spread;\n"
+    "    particles[index].position = vec4(position, 0.0);\n"
+    "    particles[index].velocity = vec4(speed, lifetime);\n"
+    "    uint slot = atomicAdd(draw_command[1], 1u);\n"
+    "    indices[get_alive_offset(src) + slot] = index;\n"
+    "}\n";
+
+/* The simulation is dispatched indirectly over the source alive list */
+static const char prepare_compute_data[] =
+    COMPUTE_HEADER
+    "void main(void)\n"
+    "{\n"
+    "    if (gl_GlobalInvocationID.x != 0u)\n"
+    "        return;\n"
+    "    nb_alive_in = draw_command[1];\n"
+    "    dispatch_command[0] = (nb_alive_in + uint(%d) - 1u) / uint(%d);\n"
+    "    draw_command[1] = 0u;\n"
+    "}\n";
+
+/*
+ * The particles reaching the end of their life go back to the dead list,
+ * the others are compacted into the destination alive list along with the
+ * instance data of the draw
+ */
+static const char simulate_compute_data[] =
+    COMPUTE_HEADER
+    "uniform float dt;\n"
+    "uniform vec3 gravity;\n"
+    "void main(void)\n"
+    "{\n"
+    "    uint id = gl_GlobalInvocationID.x;\n"
+    "    if (id >= nb_alive_in)\n"
+    "        return;\n"
+    "    uint index = indices[get_alive_offset(src) + id];\n"
+    "    particle p = particles[index];\n"
+    "    float age = p.position.w + dt;\n"
+    "    float life = p.velocity.w;\n"
+    "    if (age >= life) {\n"
+    "        indices[atomicAdd(nb_dead, 1)] = index;\n"
+    "        return;\n"
+    "    }\n"
+    "    vec3 speed = p.velocity.xyz + gravity * dt;\n"
+    "    vec3 position = p.position.xyz + speed * dt;\n"
+    "    particles[index].position = vec4(position, age);\n"
+    "    particles[index].velocity = vec4(speed, life);\n"
+    "    uint slot = atomicAdd(draw_command[1], 1u);\n"
+    "    indices[get_alive_offset(1 - src) + slot] = index;\n"
+    "    instances[slot] = vec4(position, age / life);\n"
+    "}\n";
+
+/* Each particle is a quad facing the camera */
+static const char * const vertex_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "attribute vec2 corner;"                                                "\n"
+    "attribute vec4 particle;"                                              "\n"
+    "uniform mat4 modelview_matrix;"                                        "\n"
+    "uniform mat4 projection_matrix;"                                       "\n"
+    "uniform float size;"                                                   "\n"
+    "uniform vec4 color_start;"                                             "\n"
+    "uniform vec4 color_end;"                                               "\n"
+    "varying vec2 var_corner;"                                              "\n"
+    "varying vec4 var_color;"                                               "\n"
+    "void main()"                                                           "\n"
+    "{"                                                                     "\n"
+    "    vec4 center = modelview_matrix * vec4(particle.xyz, 1.0);"         "\n"
+    "    gl_Position = projection_matrix * (center + vec4(corner * size, 0.0, 0.0));" "\n"
+    "    var_corner = corner;"                                              "\n"
+    "    var_color = mix(color_start, color_end, particle.w);"              "\n"
+    "}";
+
+static const char * const fragment_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "varying vec2 var_corner;"                                              "\n"
+    "varying vec4 var_color;"                                               "\n"
+    "void main(void)"                                                       "\n"
+    "{"                                                                     "\n"
+    "    float coverage = 1.0 - smoothstep(0.5, 1.0, length(var_corner));"  "\n"
+    "    gl_FragColor = vec4(var_color.rgb, var_color.a * coverage);"       "\n"
+    "}";
+
+struct compute_pass {
+    struct program program;
+    struct pipeline pipeline;
+};
+
+struct particlesystem_priv {
+    int max_particles;
+    double rate;
+    double lifetime;
+    float emitter[3];
+    float emitter_size[3];
+    float velocity[3];
+    double velocity_spread;
+    float gravity[3];
+    double size;
+    float color_start[4];
+    float color_end[4];
+
+    double time;
+    double sim_time;
+    int started;
+    double emit_remainder;
+    int src;
+    int seed;
+    int nb_emit;
+    float dt;
+    float lifetime_f;
+    float velocity_spread_f;
+    float size_f;
+
+    struct buffer particles;
+    struct buffer indices;
+    struct buffer state;
+    struct buffer instances;
+    struct buffer corners;
+    struct compute_pass reset;
+    struct compute_pass emit;
+    struct compute_pass prepare;
+    struct compute_pass simulate;
+    struct program program;
+    struct pipeline pipeline;
+
+    int modelview_matrix_index;
+    int projection_matrix_index;
+};
+
+#define OFFSET(x) offsetof(struct particlesystem_priv, x)
+static const struct node_param particlesystem_params[] = {
+    {"max_particles",   PARAM_TYPE_INT, OFFSET(max_particles), {.i64=65536},
+                        .desc=NGLI_DOCSTRING("maximum number of particles alive at the same time, "
+                                             "the emissions beyond it being dropped")},
+    {"rate",            PARAM_TYPE_DBL, OFFSET(rate), {.dbl=1000.0},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("number of particles emitted per second")},
+    {"lifetime",        PARAM_TYPE_DBL, OFFSET(lifetime), {.dbl=2.0},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("time in seconds a particle stays alive")},
+    {"emitter",         PARAM_TYPE_VEC3, OFFSET(emitter), {.vec={0.0, 0.0, 0.0}},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("center of the box the particles are emitted from")},
+    {"emitter_size",    PARAM_TYPE_VEC3, OFFSET(emitter_size), {.vec={0.0, 0.0, 0.0}},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("dimensions of the box the particles are emitted from")},
+    {"velocity",        PARAM_TYPE_VEC3, OFFSET(velocity), {.vec={0.0, 1.0, 0.0}},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("initial velocity of the particles, in units per second")},
+    {"velocity_spread", PARAM_TYPE_DBL, OFFSET(velocity_spread), {.dbl=0.5},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("maximum random deviation of each component of the initial velocity")},
+    {"gravity",         PARAM_TYPE_VEC3, OFFSET(gravity), {.vec={0.0, -1.0, 0.0}},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("acceleration applied to the particles, in units per second squared")},
+    {"size",            PARAM_TYPE_DBL, OFFSET(size), {.dbl=0.02},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("radius of the particles")},
+    {"color_start",     PARAM_TYPE_VEC4, OFFSET(color_start), {.vec={1.0, 1.0, 1.0, 1.0}},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("color of the particles when emitted")},
+    {"color_end",       PARAM_TYPE_VEC4, OFFSET(color_end), {.vec={1.0, 1.0, 1.0, 0.0}},
+                        .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                        .desc=NGLI_DOCSTRING("color of the particles at the end of their life")},
+    {NULL}
+};
+
+#define FEATURES_PARTICLES (NGLI_FEATURE_COMPUTE_SHADER_ALL | \
+                            NGLI_FEATURE_DRAW_INDIRECT      | \
+                            NGLI_FEATURE_INSTANCED_ARRAY)
+
+static int particlesystem_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct particlesystem_priv *s = node->priv_data;
+
+    if ((gl->features & FEATURES_PARTICLES) != FEATURES_PARTICLES) {
+        LOG(ERROR, "context does not support compute shaders along with indirect and instanced draws");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    if (s->max_particles < 1) {
+        LOG(ERROR, "the maximum number of particles must be at least 1");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    return 0;
+}
+
+static int init_compute_pass(struct ngl_node *node, struct compute_pass *pass, const char *compute_data,
+                             const struct pipeline_uniform *uniforms, int nb_uniforms, int indirect,
+                             int barriers)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct particlesystem_priv *s = node->priv_data;
+
+    const char *version = gl->backend == NGL_BACKEND_OPENGLES ? "310 es" : "430";
+    char *compute = ngli_asprintf(compute_data, version, s->max_particles, GROUP_SIZE, GROUP_SIZE, GROUP_SIZE);
+    if (!compute)
+        return NGL_ERROR_MEMORY;
+
+    int ret = ngli_program_init(&pass->program, ctx, NULL, NULL, compute);
+    ngli_free(compute);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_buffer buffers[] = {
+        {.name = "particles_block", .buffer = &s->particles},
+        {.name = "indices_block",   .buffer = &s->indices},
+        {.name = "state_block",     .buffer = &s->state},
+        {.name = "instances_block", .buffer = &s->instances},
+    };
+
+    const struct pipeline_params pipeline_params = {
+        .type        = NGLI_PIPELINE_TYPE_COMPUTE,
+        .program     = &pass->program,
+        .uniforms    = uniforms,
+        .nb_uniforms = nb_uniforms,
+        .buffers     = buffers,
+        .nb_buffers  = NGLI_ARRAY_NB(buffers),
+        .compute     = {
+            .nb_group_x      = 1,
+            .nb_group_y      = 1,
+            .nb_group_z      = 1,
+            .indirect_buffer = indirect ? &s->state : NULL,
+            .indirect_offset = 4 * sizeof(uint32_t),
+            .barriers        = barriers,
+        },
+    };
+
+    return ngli_pipeline_init(&pass->pipeline, ctx, &pipeline_params);
+}
+
+static int init_compute_passes(struct ngl_node *node)
+{
+    struct particlesystem_priv *s = node->priv_data;
+
+    /* The uniforms are read back at every execution so they can be live changed */
+    const struct pipeline_uniform emit_uniforms[] = {
+        {.name = "src",             .type = NGLI_TYPE_INT,   .count = 1, .data = &s->src},
+        {.name = "nb_emit",         .type = NGLI_TYPE_INT,   .count = 1, .data = &s->nb_emit},
+        {.name = "seed",            .type = NGLI_TYPE_INT,   .count = 1, .data = &s->seed},
+        {.name = "lifetime",        .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->lifetime_f},
+        {.name = "emitter",         .type = NGLI_TYPE_VEC3,  .count = 1, .data = s->emitter},
+        {.name = "emitter_size",    .type = NGLI_TYPE_VEC3,  .count = 1, .data = s->emitter_size},
+        {.name = "velocity",        .type = NGLI_TYPE_VEC3,  .count = 1, .data = s->velocity},
+        {.name = "velocity_spread", .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->velocity_spread_f},
+    };
+
+    const struct pipeline_uniform simulate_uniforms[] = {
+        {.name = "src",     .type = NGLI_TYPE_INT,   .count = 1, .data = &s->src},
+        {.name = "dt",      .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->dt},
+        {.name = "gravity", .type = NGLI_TYPE_VEC3,  .count = 1, .data = s->gravity},
+    };
+
+    /* The draw and dispatch commands are written by the passes preceding their use */
+    int ret;
+    if ((ret = init_compute_pass(node, &s->reset, reset_compute_data, NULL, 0, 0,
+                                 NGLI_BARRIER_STORAGE_BIT | NGLI_BARRIER_COMMAND_BIT)) < 0 ||
+        (ret = init_compute_pass(node, &s->emit, emit_compute_data,
+                                 emit_uniforms, NGLI_ARRAY_NB(emit_uniforms), 0,
+                                 NGLI_BARRIER_STORAGE_BIT)) < 0 ||
+        (ret = init_compute_pass(node, &s->prepare, prepare_compute_data, NULL, 0, 0,
+                                 NGLI_BARRIER_STORAGE_BIT | NGLI_BARRIER_COMMAND_BIT)) < 0 ||
+        (ret = init_compute_pass(node, &s->simulate, simulate_compute_data,
+                                 simulate_uniforms, NGLI_ARRAY_NB(simulate_uniforms), 1,
+                                 NGLI_BARRIER_STORAGE_BIT | NGLI_BARRIER_COMMAND_BIT |
+                                 NGLI_BARRIER_VERTEX_ATTRIB_BIT)) < 0)
+        return ret;
+
+    s->reset.pipeline.compute.nb_group_x = (s->max_particles + GROUP_SIZE - 1) / GROUP_SIZE;
+    return 0;
+}
+
+static int init_draw_pipeline(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct particlesystem_priv *s = node->priv_data;
+
+    int ret = ngli_program_init(&s->program, ctx, vertex_data, fragment_data, NULL);
+    if (ret < 0)
+        return ret;
+
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "modelview_matrix",  .type = NGLI_TYPE_MAT4,  .count = 1, .data = NULL},
+        {.name = "projection_matrix", .type = NGLI_TYPE_MAT4,  .count = 1, .data = NULL},
+        {.name = "size",              .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->size_f},
+        {.name = "color_start",       .type = NGLI_TYPE_VEC4,  .count = 1, .data = s->color_start},
+        {.name = "color_end",         .type = NGLI_TYPE_VEC4,  .count = 1, .data = s->color_end},
+    };
+
+    const struct pipeline_attribute attributes[] = {
+        {.name = "corner",   .format = NGLI_FORMAT_R32G32_SFLOAT,       .stride = 2 * 4, .buffer = &s->corners},
+        {.name = "particle", .format = NGLI_FORMAT_R32G32B32A32_SFLOAT, .stride = INSTANCE_SIZE,
+                             .rate = 1, .buffer = &s->instances},
+    };
+
+    /* The instance count is the number of alive particles, only known by the GPU */
+    const struct pipeline_params pipeline_params = {
+        .type          = NGLI_PIPELINE_TYPE_GRAPHICS,
+        .program       = &s->program,
+        .uniforms      = uniforms,
+        .nb_uniforms   = NGLI_ARRAY_NB(uniforms),
+        .attributes    = attributes,
+        .nb_attributes = NGLI_ARRAY_NB(attributes),
+        .graphics      = {
+            .topology          = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+            .nb_vertices       = 4,
+            .indirect_buffer   = &s->state,
+            .indirect_offset   = 0,
+            .nb_indirect_draws = 1,
+        },
+    };
+
+    ret = ngli_pipeline_init(&s->pipeline, ctx, &pipeline_params);
+    if (ret < 0)
+        return ret;
+
+    s->modelview_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "modelview_matrix");
+    s->projection_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "projection_matrix");
+    return 0;
+}
+
+static int particlesystem_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct particlesystem_priv *s = node->priv_data;
+    const int n = s->max_particles;
+
+    static const float corners[] = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f,
+    };
+
+    int ret;
+    if ((ret = ngli_buffer_init(&s->particles, ctx, n * PARTICLE_SIZE, NGLI_BUFFER_USAGE_STATIC)) < 0 ||
+        (ret = ngli_buffer_init(&s->indices, ctx, 3 * n * sizeof(uint32_t), NGLI_BUFFER_USAGE_STATIC)) < 0 ||
+        (ret = ngli_buffer_init(&s->state, ctx, STATE_SIZE, NGLI_BUFFER_USAGE_STATIC)) < 0 ||
+        (ret = ngli_buffer_init(&s->instances, ctx, n * INSTANCE_SIZE, NGLI_BUFFER_USAGE_STATIC)) < 0 ||
+        (ret = ngli_buffer_init(&s->corners, ctx, sizeof(corners), NGLI_BUFFER_USAGE_STATIC)) < 0 ||
+        (ret = ngli_buffer_upload(&s->corners, corners, sizeof(corners))) < 0)
+        return ret;
+
+    if ((ret = init_compute_passes(node)) < 0 ||
+        (ret = init_draw_pipeline(node)) < 0)
+        return ret;
+
+    /* The system restarts from scratch at its next draw */
+    s->started = 0;
+    return 0;
+}
+
+static int particlesystem_update(struct ngl_node *node, double t)
+{
+    struct particlesystem_priv *s = node->priv_data;
+    s->time = t;
+    return 0;
+}
+
+/*
+ * The number of particles to emit is the only information sent by the CPU:
+ * the simulation and the draw only depend on counters living on the GPU, so
+ * the CPU cost does not depend on the number of particles
+ */
+static void simulate(struct ngl_node *node)
+{
+    struct particlesystem_priv *s = node->priv_data;
+
+    /* The simulation can not go back in time, it restarts instead */
+    if (!s->started || s->time < s->sim_time) {
+        ngli_pipeline_exec(&s->reset.pipeline);
+        s->started = 1;
+        s->sim_time = s->time;
+        s->emit_remainder = 0.0;
+        s->src = 0;
+        return;
+    }
+
+    const double dt = s->time - s->sim_time;
+    if (dt == 0.0)
+        return;
+    s->sim_time = s->time;
+
+    s->emit_remainder += NGLI_MAX(s->rate, 0.0) * dt;
+    const double nb_emit = floor(s->emit_remainder);
+    s->emit_remainder -= nb_emit;
+    s->nb_emit = (int)NGLI_MIN(nb_emit, (double)s->max_particles);
+    if (s->nb_emit) {
+        s->seed++;
+        s->lifetime_f = s->lifetime;
+        s->velocity_spread_f = s->velocity_spread;
+        s->emit.pipeline.compute.nb_group_x = (s->nb_emit + GROUP_SIZE - 1) / GROUP_SIZE;
+        ngli_pipeline_exec(&s->emit.pipeline);
+    }
+
+    s->dt = dt;
+    ngli_pipeline_exec(&s->prepare.pipeline);
+    ngli_pipeline_exec(&s->simulate.pipeline);
+    s->src ^= 1;
+}
+
+static void particlesystem_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct particlesystem_priv *s = node->priv_data;
+
+    /* Same as the Shape node, the particles are drawn outside the draw lists */
+    ngli_pass_flush_draw_list(ctx);
+    ctx->nb_pass_execs++;
+
+    NGLI_TRACEMARKER_BEGIN(particlesystem, node->label);
+    simulate(node);
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+
+    s->size_f = s->size;
+    ngli_pipeline_update_uniform(&s->pipeline, s->modelview_matrix_index, modelview->matrix);
+    ngli_pipeline_update_uniform(&s->pipeline, s->projection_matrix_index, projection_matrix);
+    ngli_pipeline_exec(&s->pipeline);
+    NGLI_TRACEMARKER_END(particlesystem);
+}
+
+static void reset_compute_pass(struct compute_pass *pass)
+{
+    ngli_pipeline_reset(&pass->pipeline);
+    ngli_program_reset(&pass->program);
+}
+
+static void particlesystem_release(struct ngl_node *node)
+{
+    struct particlesystem_priv *s = node->priv_data;
+
+    ngli_pipeline_reset(&s->pipeline);
+    ngli_program_reset(&s->program);
+    reset_compute_pass(&s->reset);
+    reset_compute_pass(&s->emit);
+    reset_compute_pass(&s->prepare);
+    reset_compute_pass(&s->simulate);
+    ngli_buffer_reset(&s->corners);
+    ngli_buffer_reset(&s->instances);
+    ngli_buffer_reset(&s->state);
+    ngli_buffer_reset(&s->indices);
+    ngli_buffer_reset(&s->particles);
+}
+
+int64_t ngli_node_particlesystem_estimate_memory(const struct ngl_node *node)
+{
+    const struct particlesystem_priv *s = node->priv_data;
+    const int64_t n = s->max_particles;
+    return n * (PARTICLE_SIZE + 3 * sizeof(uint32_t) + INSTANCE_SIZE) + STATE_SIZE;
+}
+
+const struct node_class ngli_particlesystem_class = {
+    .id        = NGL_NODE_PARTICLESYSTEM,
+    .name      = "ParticleSystem",
+    .init      = particlesystem_init,
+    .prefetch  = particlesystem_prefetch,
+    .update    = particlesystem_update,
+    .draw      = particlesystem_draw,
+    .release   = particlesystem_release,
+    .priv_size = sizeof(struct particlesystem_priv),
+    .params    = particlesystem_params,
+    .file      = __FILE__,
+};
@@ -24,10 +24,14 @@
 #include <string.h>
 #include "bstr.h"
 #include "default_shaders.h"
+#include "fbfetch.h"
 #include "log.h"
+#include "memory.h"
+#include "multiview.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "program.h"
+#include "texvideo.h"
 
 #define OFFSET(x) offsetof(struct program_priv, x)
 static const struct node_param program_params[] = {
@@ -35,17 +39,93 @@ static const struct node_param program_params[] = {
                  .desc=NGLI_DOCSTRING("vertex shader")},
     {"fragment", PARAM_TYPE_STR, OFFSET(fragment), {.str=NULL},
                  .desc=NGLI_DOCSTRING("fragment shader")},
+    {"nb_views", PARAM_TYPE_INT, OFFSET(nb_views), {.i64=1},
+                 .desc=NGLI_DOCSTRING("number of views rendered at once by the vertex shader, "
+                                      "which applies `ngl_view_matrix` to select its view (see `StereoCamera`)")},
     {NULL}
 };
 
-static int program_init(struct ngl_node *node)
+static int program_submit(struct ngl_node *node, struct program *program,
+                          struct uniformpack_constant *constants, int nb_constants)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct program_priv *s = node->priv_data;
-    const char *vertex = s->vertex ? s->vertex : ngli_get_default_shader(NGLI_PROGRAM_SHADER_VERT);
+
+    if (node->class->id == NGL_NODE_COMPUTEPROGRAM)
+        return ngli_program_submit_specialized(program, ctx, NULL, NULL, s->compute, constants, nb_constants);
+
     const char *fragment = s->fragment ? s->fragment : ngli_get_default_shader(NGLI_PROGRAM_SHADER_FRAG);
+    const char *vertex = s->vertex;
+    char *default_vertex = NULL;
+    if (!vertex) {
+        default_vertex = ngli_get_default_vertex_shader(fragment);
+        if (!default_vertex)
+            return NGL_ERROR_MEMORY;
+        vertex = default_vertex;
+    }
+
+    char *multiview_vertex = NULL;
+    char *texvideo_fragment = NULL;
+    char *fbfetch_fragment = NULL;
+    int ret = 0;
+    if (s->nb_views > 1) {
+        ret = ngli_multiview_preprocess(vertex, s->nb_views, &multiview_vertex);
+        if (ret < 0)
+            goto end;
+        vertex = multiview_vertex;
+    }
+
+    ret = ngli_texvideo_preprocess(ctx->glcontext, fragment, &texvideo_fragment);
+    if (ret < 0)
+        goto end;
+    if (texvideo_fragment)
+        fragment = texvideo_fragment;
+
+    ret = ngli_fbfetch_preprocess(ctx->glcontext, fragment, &fbfetch_fragment);
+    if (ret < 0)
+        goto end;
+    if (fbfetch_fragment)
+        fragment = fbfetch_fragment;
+
+    ret = ngli_program_submit_specialized(program, ctx, vertex, fragment, NULL, constants, nb_constants);
+
+end:
+    ngli_free(fbfetch_fragment);
+    ngli_free(texvideo_fragment);
+    ngli_free(multiview_vertex);
+    ngli_free(default_vertex);
+    return ret;
+}
+
+int ngli_node_program_specialize(struct ngl_node *node, struct program *program,
+                                 struct uniformpack_constant *constants, int nb_constants)
+{
+    return program_submit(node, program, constants, nb_constants);
+}
+
+static int program_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct program_priv *s = node->priv_data;
+
+    if (s->nb_views < 1) {
+        LOG(ERROR, "invalid number of views: %d", s->nb_views);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (s->nb_views > 1) {
+        if (!(gl->features & NGLI_FEATURE_OVR_MULTIVIEW)) {
+            LOG(ERROR, "context does not support multiview rendering");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (!s->vertex) {
+            LOG(ERROR, "multiview rendering requires a vertex shader");
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
 
-    return ngli_program_init(&s->program, ctx, vertex, fragment, NULL);
+    return program_submit(node, &s->program, NULL, 0);
 }
 
 static void program_uninit(struct ngl_node *node)
@@ -24,8 +24,10 @@
 #include <string.h>
 #include <limits.h>
 
+#include "gctx.h"
 #include "hmap.h"
 #include "log.h"
+#include "math_utils.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "pass.h"
@@ -41,6 +43,9 @@ struct render_priv {
     struct hmap *attributes;
     struct hmap *instance_attributes;
     int nb_instances;
+    int frustum_culling;
+    struct ngl_node *indirect_buffer;
+    int nb_indirect_draws;
 
     struct pass pass;
 };
@@ -48,33 +53,40 @@ struct render_priv {
 #define TEXTURES_TYPES_LIST (const int[]){NGL_NODE_TEXTURE2D,       \
                                           NGL_NODE_TEXTURE3D,       \
                                           NGL_NODE_TEXTURECUBE,     \
+                                          NGL_NODE_VIRTUALTEXTURE,  \
                                           -1}
 
 #define PROGRAMS_TYPES_LIST (const int[]){NGL_NODE_PROGRAM,         \
                                           -1}
 
-#define UNIFORMS_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,     \
-                                          NGL_NODE_BUFFERVEC2,      \
-                                          NGL_NODE_BUFFERVEC3,      \
-                                          NGL_NODE_BUFFERVEC4,      \
-                                          NGL_NODE_UNIFORMFLOAT,    \
-                                          NGL_NODE_UNIFORMVEC2,     \
-                                          NGL_NODE_UNIFORMVEC3,     \
-                                          NGL_NODE_UNIFORMVEC4,     \
-                                          NGL_NODE_UNIFORMQUAT,     \
-                                          NGL_NODE_UNIFORMINT,      \
-                                          NGL_NODE_UNIFORMMAT4,     \
-                                          NGL_NODE_ANIMATEDFLOAT,   \
-                                          NGL_NODE_ANIMATEDVEC2,    \
-                                          NGL_NODE_ANIMATEDVEC3,    \
-                                          NGL_NODE_ANIMATEDVEC4,    \
-                                          NGL_NODE_ANIMATEDQUAT,    \
-                                          NGL_NODE_STREAMEDINT,     \
-                                          NGL_NODE_STREAMEDFLOAT,   \
-                                          NGL_NODE_STREAMEDVEC2,    \
-                                          NGL_NODE_STREAMEDVEC3,    \
-                                          NGL_NODE_STREAMEDVEC4,    \
-                                          NGL_NODE_STREAMEDMAT4,    \
+#define UNIFORMS_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,       \
+                                          NGL_NODE_BUFFERVEC2,        \
+                                          NGL_NODE_BUFFERVEC3,        \
+                                          NGL_NODE_BUFFERVEC4,        \
+                                          NGL_NODE_UNIFORMFLOAT,      \
+                                          NGL_NODE_UNIFORMVEC2,       \
+                                          NGL_NODE_UNIFORMVEC3,       \
+                                          NGL_NODE_UNIFORMVEC4,       \
+                                          NGL_NODE_UNIFORMQUAT,       \
+                                          NGL_NODE_UNIFORMINT,        \
+                                          NGL_NODE_UNIFORMMAT4,       \
+                                          NGL_NODE_ANIMATEDFLOAT,     \
+                                          NGL_NODE_ANIMATEDVEC2,      \
+                                          NGL_NODE_ANIMATEDVEC3,      \
+                                          NGL_NODE_ANIMATEDVEC4,      \
+                                          NGL_NODE_ANIMATEDQUAT,      \
+                                          NGL_NODE_STREAMEDINT,       \
+                                          NGL_NODE_STREAMEDFLOAT,     \
+                                          NGL_NODE_STREAMEDVEC2,      \
+                                          NGL_NODE_STREAMEDVEC3,      \
+                                          NGL_NODE_STREAMEDVEC4,      \
+                                          NGL_NODE_STREAMEDMAT4,      \
+                                          NGL_NODE_STREAMEDFILEINT,   \
+                                          NGL_NODE_STREAMEDFILEFLOAT, \
+                                          NGL_NODE_STREAMEDFILEVEC2,  \
+                                          NGL_NODE_STREAMEDFILEVEC3,  \
+                                          NGL_NODE_STREAMEDFILEVEC4,  \
+                                          NGL_NODE_STREAMEDFILEMAT4,  \
                                           -1}
 
 #define ATTRIBUTES_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,   \
@@ -82,10 +94,33 @@ struct render_priv {
                                             NGL_NODE_BUFFERVEC3,    \
                                             NGL_NODE_BUFFERVEC4,    \
                                             NGL_NODE_BUFFERMAT4,    \
+                                            NGL_NODE_BUFFERHALF,    \
+                                            NGL_NODE_BUFFERHVEC2,   \
+                                            NGL_NODE_BUFFERHVEC3,   \
+                                            NGL_NODE_BUFFERHVEC4,   \
+                                            NGL_NODE_BUFFERBYTE,    \
+                                            NGL_NODE_BUFFERBVEC2,   \
+                                            NGL_NODE_BUFFERBVEC3,   \
+                                            NGL_NODE_BUFFERBVEC4,   \
+                                            NGL_NODE_BUFFERUBYTE,   \
+                                            NGL_NODE_BUFFERUBVEC2,  \
+                                            NGL_NODE_BUFFERUBVEC3,  \
+                                            NGL_NODE_BUFFERUBVEC4,  \
+                                            NGL_NODE_BUFFERSHORT,   \
+                                            NGL_NODE_BUFFERSVEC2,   \
+                                            NGL_NODE_BUFFERSVEC3,   \
+                                            NGL_NODE_BUFFERSVEC4,   \
+                                            NGL_NODE_BUFFERUSHORT,  \
+                                            NGL_NODE_BUFFERUSVEC2,  \
+                                            NGL_NODE_BUFFERUSVEC3,  \
+                                            NGL_NODE_BUFFERUSVEC4,  \
+                                            NGL_NODE_BUFFERPACK10,  \
+                                            NGL_NODE_BUFFERUPACK10, \
                                             -1}
 
 #define GEOMETRY_TYPES_LIST (const int[]){NGL_NODE_CIRCLE,          \
                                           NGL_NODE_GEOMETRY,        \
+                                          NGL_NODE_MESH,            \
                                           NGL_NODE_QUAD,            \
                                           NGL_NODE_TRIANGLE,        \
                                           -1}
@@ -115,6 +150,19 @@ static const struct node_param render_params[] = {
                  .desc=NGLI_DOCSTRING("per instance extra vertex attributes made accessible to the `program`")},
     {"nb_instances", PARAM_TYPE_INT, OFFSET(nb_instances),
                  .desc=NGLI_DOCSTRING("number of instances to draw")},
+    {"frustum_culling", PARAM_TYPE_BOOL, OFFSET(frustum_culling), {.i64=0},
+                 .desc=NGLI_DOCSTRING("skip the draw when the bounding box of the `geometry` is outside the view, "
+                                      "assuming the `program` does not move the vertices out of it")},
+    {"indirect_buffer", PARAM_TYPE_NODE, OFFSET(indirect_buffer),
+                 .node_types=(const int[]){NGL_NODE_BUFFERUINT, NGL_NODE_BUFFERUIVEC4, -1},
+                 .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
+                 .desc=NGLI_DOCSTRING("buffer from which the draw commands are read, instead of drawing all the vertices "
+                                      "`nb_instances` times: 4 unsigned integers (count, instance count, first vertex, "
+                                      "base instance) per command, or 5 (count, instance count, first index, base vertex, "
+                                      "base instance) if the `geometry` has indices; it can reference a `Block` field "
+                                      "written by a previous compute declaring a `command` barrier")},
+    {"nb_indirect_draws", PARAM_TYPE_INT, OFFSET(nb_indirect_draws), {.i64=1},
+                 .desc=NGLI_DOCSTRING("number of draw commands to read from the `indirect_buffer`")},
     {NULL}
 };
 
@@ -132,6 +180,8 @@ static int render_init(struct ngl_node *node)
         .attributes = s->attributes,
         .instance_attributes = s->instance_attributes,
         .nb_instances = s->nb_instances,
+        .nb_indirect_draws = s->nb_indirect_draws,
+        .indirect_buffer = s->indirect_buffer,
     };
     return ngli_pass_init(&s->pass, ctx, &params);
 }
@@ -142,20 +192,97 @@ static void render_uninit(struct ngl_node *node)
     ngli_pass_uninit(&s->pass);
 }
 
+/*
+ * The output of the render changes with any of the nodes it reads, which
+ * report their changes to the context while they are updated
+ */
 static int render_update(struct ngl_node *node, double t)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct render_priv *s = node->priv_data;
-    return ngli_pass_update(&s->pass, t);
+    const int frame_changed = ctx->frame_changed;
+    ctx->frame_changed = 0;
+    int ret = ngli_pass_update(&s->pass, t);
+    const int changed = ctx->frame_changed;
+    ctx->frame_changed |= frame_changed;
+    if (ret < 0)
+        return ret;
+    return changed;
+}
+
+/*
+ * Instances are expected to be laid out differently by the program so they
+ * are never culled, and neither are the indirect draws since the GPU decides
+ * what they cover
+ */
+static int is_culled(const struct render_priv *s, struct ngl_ctx *ctx)
+{
+    const struct geometry_priv *geometry = s->geometry->priv_data;
+    if (!geometry->has_bounds || s->nb_instances > 1 || s->instance_attributes || s->indirect_buffer)
+        return 0;
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+    NGLI_ALIGNED_MAT(matrix);
+    ngli_mat4_mul(matrix, projection_matrix, modelview->matrix);
+    return ngli_mat4_box_outside_clip(matrix, geometry->bounds_min, geometry->bounds_max);
+}
+
+/*
+ * The bounding box of the geometry only locates the draw if the program is
+ * the default one, or if it is known not to move the vertices out of it
+ */
+static void register_damage(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct render_priv *s = node->priv_data;
+
+    if (!s->pass.ready)
+        return;
+
+    /* The scissor of the scene would override the one of the damage */
+    if (ctx->graphicconfig.scissor_test) {
+        ngli_damage_set_full(&ctx->damage);
+        return;
+    }
+
+    int viewport[4];
+    ngli_gctx_get_viewport(ctx, viewport);
+
+    int rect[4];
+    memcpy(rect, viewport, sizeof(rect));
+    const struct geometry_priv *geometry = s->geometry->priv_data;
+    if (geometry->has_bounds && (!s->program || s->frustum_culling) &&
+        s->nb_instances <= 1 && !s->instance_attributes && !s->indirect_buffer) {
+        const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+        const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+        NGLI_ALIGNED_MAT(matrix);
+        ngli_mat4_mul(matrix, projection_matrix, modelview->matrix);
+        if (!ngli_damage_project_box(matrix, geometry->bounds_min, geometry->bounds_max, viewport, rect))
+            memcpy(rect, viewport, sizeof(rect));
+    }
+
+    const int changed = node->change_gen == ctx->update_gen;
+    if (ngli_damage_add_draw(&ctx->damage, node, rect, changed) < 0)
+        ngli_damage_set_full(&ctx->damage);
 }
 
 static void render_draw(struct ngl_node *node)
 {
     struct render_priv *s = node->priv_data;
+    if (s->frustum_culling && is_culled(s, node->ctx))
+        return;
+    if (node->ctx->damage_pass) {
+        register_damage(node);
+        return;
+    }
     ngli_pass_exec(&s->pass);
 }
 
 const struct node_class ngli_render_class = {
     .id        = NGL_NODE_RENDER,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Render",
     .init      = render_init,
     .uninit    = render_uninit,
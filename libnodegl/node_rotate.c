@@ -56,6 +56,7 @@ static void update_trf_matrix(struct ngl_node *node, float deg_angle)
         ngli_mat4_translate(transm, -a[0], -a[1], -a[2]);
         ngli_mat4_mul(matrix, matrix, transm);
     }
+    ngli_transform_invalidate(trf);
 }
 
 static int rotate_init(struct ngl_node *node)
@@ -68,9 +69,12 @@ static int rotate_init(struct ngl_node *node)
     }
     s->use_anchor = memcmp(s->anchor, zvec, sizeof(zvec));
     ngli_vec3_norm(s->normed_axis, s->axis);
-    if (!s->anim)
+    const struct variable_priv *anim = s->anim ? s->anim->priv_data : NULL;
+    if (!anim)
         update_trf_matrix(node, s->angle);
-    return 0;
+    else if (anim->constant)
+        update_trf_matrix(node, anim->scalar);
+    return ngli_transform_init(node, anim && !anim->constant);
 }
 
 static int update_angle(struct ngl_node *node)
@@ -89,7 +93,7 @@ static int rotate_update(struct ngl_node *node, double t)
     struct rotate_priv *s = node->priv_data;
     struct transform_priv *trf = &s->trf;
     struct ngl_node *child = trf->child;
-    if (s->anim) {
+    if (trf->animated) {
         struct ngl_node *anim_node = s->anim;
         struct variable_priv *anim = anim_node->priv_data;
         int ret = ngli_node_update(anim_node, t);
@@ -114,7 +118,7 @@ static const struct node_param rotate_params[] = {
     {"anchor", PARAM_TYPE_VEC3, OFFSET(anchor), {.vec={0.0, 0.0, 0.0}},
                .desc=NGLI_DOCSTRING("vector to the center point of the rotation")},
     {"anim",   PARAM_TYPE_NODE, OFFSET(anim),
-               .node_types=(const int[]){NGL_NODE_ANIMATEDFLOAT, NGL_NODE_STREAMEDFLOAT, -1},
+               .node_types=(const int[]){NGL_NODE_ANIMATEDFLOAT, NGL_NODE_STREAMEDFLOAT, NGL_NODE_STREAMEDFILEFLOAT, -1},
                .desc=NGLI_DOCSTRING("`angle` animation")},
     {NULL}
 };
@@ -123,6 +127,8 @@ NGLI_STATIC_ASSERT(trf_on_top_of_rotate, OFFSET(trf) == 0);
 
 const struct node_class ngli_rotate_class = {
     .id        = NGL_NODE_ROTATE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Rotate",
     .init      = rotate_init,
     .update    = rotate_update,
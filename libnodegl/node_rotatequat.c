@@ -53,6 +53,7 @@ static void update_trf_matrix(struct ngl_node *node, const float *quat)
         ngli_mat4_translate(transm, -a[0], -a[1], -a[2]);
         ngli_mat4_mul(matrix, matrix, transm);
     }
+    ngli_transform_invalidate(trf);
 }
 
 static int rotatequat_init(struct ngl_node *node)
@@ -60,9 +61,12 @@ static int rotatequat_init(struct ngl_node *node)
     struct rotatequat_priv *s = node->priv_data;
     static const float zvec[3] = {0};
     s->use_anchor = memcmp(s->anchor, zvec, sizeof(zvec));
-    if (!s->anim)
+    const struct variable_priv *anim = s->anim ? s->anim->priv_data : NULL;
+    if (!anim)
         update_trf_matrix(node, s->quat);
-    return 0;
+    else if (anim->constant)
+        update_trf_matrix(node, anim->vector);
+    return ngli_transform_init(node, anim && !anim->constant);
 }
 
 static int update_quat(struct ngl_node *node)
@@ -81,7 +85,7 @@ static int rotatequat_update(struct ngl_node *node, double t)
     struct rotatequat_priv *s = node->priv_data;
     struct transform_priv *trf = &s->trf;
     struct ngl_node *child = trf->child;
-    if (s->anim) {
+    if (trf->animated) {
         struct ngl_node *anim_node = s->anim;
         struct variable_priv *anim = anim_node->priv_data;
         int ret = ngli_node_update(anim_node, t);
@@ -113,6 +117,8 @@ NGLI_STATIC_ASSERT(trf_on_top_of_rotatequat, OFFSET(trf) == 0);
 
 const struct node_class ngli_rotatequat_class = {
     .id        = NGL_NODE_ROTATEQUAT,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "RotateQuat",
     .init      = rotatequat_init,
     .update    = rotatequat_update,
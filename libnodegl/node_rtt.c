@@ -24,13 +24,41 @@
 #include <string.h>
 
 #include "rendertarget.h"
+#include "bstr.h"
 #include "format.h"
+#include "graphicconfig.h"
 #include "gctx.h"
+#include "glcontext.h"
+#include "hmap.h"
 #include "log.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "pass.h"
+#include "tracemarker.h"
 #include "utils.h"
 
+/*
+ * The multisample render targets are only live during the draw of their
+ * RenderToTexture node and resolved into the destination textures right
+ * after, so the RTT nodes sharing the same attachment properties draw into
+ * a common set of targets: a target is held from the start of the draw to the
+ * resolve and can be reused by any later RTT, only the nested RTTs (drawing
+ * while another one holds a target) need additional ones.
+ */
+struct rtt_ms_target {
+    int in_use;
+    struct rendertarget rt;
+    struct darray colors;
+    struct texture depth;
+};
+
+struct rtt_ms_shared {
+    char *key;
+    int refcount;
+    struct darray targets; /* struct rtt_ms_target * */
+};
+
 struct rtt_priv {
     struct ngl_node *child;
     struct ngl_node **color_textures;
@@ -40,18 +68,39 @@ struct rtt_priv {
     float clear_color[4];
     int features;
     int vflip;
+    int color_load_op;
+    int depth_stencil_load_op;
+    int precision;
 
     int use_clear_color;
-    int invalidate_depth_stencil;
+    int depth_stencil_store_op;
+    int ms_store_op;
     int width;
     int height;
 
     struct rendertarget rt;
     struct texture rt_depth;
 
-    struct rendertarget rt_ms;
-    struct darray rt_ms_colors;
-    struct texture rt_ms_depth;
+    int depth_format;
+    int implicit_ms;
+    struct rtt_ms_shared *ms_shared;
+
+    /* Formats and buffers picked by the precision */
+    int rtt_format;
+    int depth_dropped;
+    int64_t saved_memory;
+    int stats_accounted;
+
+    /* Signature of the content of the textures */
+    int cache_enabled;
+    int content_valid;
+    int child_changed;
+    struct darray texture_reads; /* struct ngl_node *, sampled by the child */
+    int live_change_gen;
+    int gpu_write_gen;
+    float modelview_matrix[16];
+    float projection_matrix[16];
+    struct graphicconfig graphicconfig;
 };
 
 #define DEFAULT_CLEAR_COLOR {-1.0f, -1.0f, -1.0f, -1.0f}
@@ -69,6 +118,46 @@ static const struct param_choices feature_choices = {
     }
 };
 
+static const struct param_choices load_op_choices = {
+    .name = "load_op",
+    .consts = {
+        {"clear",     NGLI_LOAD_OP_CLEAR,     .desc=NGLI_DOCSTRING("cleared at the beginning of the draw")},
+        {"load",      NGLI_LOAD_OP_LOAD,      .desc=NGLI_DOCSTRING("content of the previous draw preserved")},
+        {"dont_care", NGLI_LOAD_OP_DONT_CARE, .desc=NGLI_DOCSTRING("undefined content, the scene is expected to overwrite every pixel")},
+        {NULL}
+    }
+};
+
+enum {
+    PRECISION_DECLARED,
+    PRECISION_LDR,
+    PRECISION_LDR10,
+    PRECISION_HDR_OPAQUE,
+    PRECISION_HDR,
+};
+
+static const struct param_choices precision_choices = {
+    .name = "precision",
+    .consts = {
+        {"declared",   PRECISION_DECLARED,   .desc=NGLI_DOCSTRING("formats of the color textures and features used as declared")},
+        {"ldr",        PRECISION_LDR,        .desc=NGLI_DOCSTRING("8-bit unsigned normalized RGBA, for colors within [0,1]")},
+        {"ldr10",      PRECISION_LDR10,      .desc=NGLI_DOCSTRING("10-bit unsigned normalized RGB with a 2-bit alpha, for smooth gradients within [0,1]")},
+        {"hdr_opaque", PRECISION_HDR_OPAQUE, .desc=NGLI_DOCSTRING("11 and 10-bit unsigned float RGB without alpha, for positive colors beyond 1")},
+        {"hdr",        PRECISION_HDR,        .desc=NGLI_DOCSTRING("16-bit float RGBA, for colors beyond [0,1] with alpha")},
+        {NULL}
+    }
+};
+
+static const struct {
+    int format;
+    int stats_index;
+} precision_formats[] = {
+    [PRECISION_LDR]        = {NGLI_FORMAT_R8G8B8A8_UNORM,           NGL_STATS_RTT_FORMAT_R8G8B8A8_UNORM},
+    [PRECISION_LDR10]      = {NGLI_FORMAT_A2B10G10R10_UNORM_PACK32, NGL_STATS_RTT_FORMAT_A2B10G10R10_UNORM},
+    [PRECISION_HDR_OPAQUE] = {NGLI_FORMAT_B10G11R11_UFLOAT_PACK32,  NGL_STATS_RTT_FORMAT_B10G11R11_UFLOAT},
+    [PRECISION_HDR]        = {NGLI_FORMAT_R16G16B16A16_SFLOAT,      NGL_STATS_RTT_FORMAT_R16G16B16A16_SFLOAT},
+};
+
 #define OFFSET(x) offsetof(struct rtt_priv, x)
 static const struct node_param rtt_params[] = {
     {"child",         PARAM_TYPE_NODE, OFFSET(child),
@@ -90,13 +179,50 @@ static const struct node_param rtt_params[] = {
                       .desc=NGLI_DOCSTRING("framebuffer feature mask")},
     {"vflip",         PARAM_TYPE_BOOL, OFFSET(vflip), {.i64=1},
                       .desc=NGLI_DOCSTRING("apply a vertical flip to `color_texture` and `depth_texture` transformation matrices to match the `node.gl` uv coordinates system")},
+    {"color_load_op", PARAM_TYPE_SELECT, OFFSET(color_load_op), {.i64=NGLI_LOAD_OP_CLEAR},
+                      .choices=&load_op_choices,
+                      .desc=NGLI_DOCSTRING("operation applied to the color attachments at the beginning of the draw")},
+    {"depth_stencil_load_op", PARAM_TYPE_SELECT, OFFSET(depth_stencil_load_op), {.i64=NGLI_LOAD_OP_CLEAR},
+                      .choices=&load_op_choices,
+                      .desc=NGLI_DOCSTRING("operation applied to the depth and stencil attachments at the beginning of the draw")},
+    {"precision",     PARAM_TYPE_SELECT, OFFSET(precision), {.i64=PRECISION_DECLARED},
+                      .choices=&precision_choices,
+                      .desc=NGLI_DOCSTRING("precision needed by the content of the color textures, picking their format "
+                                           "instead of the declared one; any other value than `declared` also drops the "
+                                           "depth and stencil buffer requested by `features` if the scene never tests them")},
     {NULL}
 };
 
+/* The reduced formats must be renderable, the declared ones are kept otherwise */
+static int get_precision_format(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    const struct rtt_priv *s = node->priv_data;
+
+    if (s->precision == PRECISION_DECLARED)
+        return NGLI_FORMAT_UNDEFINED;
+
+    int supported = 1;
+    if (s->precision == PRECISION_LDR10)
+        supported = gl->backend != NGL_BACKEND_OPENGLES || gl->version >= 300;
+    else if (s->precision == PRECISION_HDR_OPAQUE || s->precision == PRECISION_HDR)
+        supported = (gl->features & NGLI_FEATURE_COLOR_BUFFER_FLOAT) != 0;
+    if (!supported) {
+        LOG(WARNING, "the format of the requested precision can not be rendered to by this context, "
+            "the declared formats of the color textures are used instead");
+        return NGLI_FORMAT_UNDEFINED;
+    }
+
+    return precision_formats[s->precision].format;
+}
+
 static int rtt_init(struct ngl_node *node)
 {
     struct rtt_priv *s = node->priv_data;
 
+    ngli_darray_init(&s->texture_reads, sizeof(struct ngl_node *), 0);
+
     for (int i = 0; i < s->nb_color_textures; i++) {
         const struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
         if (texture_priv->data_src) {
@@ -113,19 +239,49 @@ static int rtt_init(struct ngl_node *node)
         }
     }
 
+    /* The no_clear feature is an alias for loading all the attachments */
+    if (s->features & FEATURE_NO_CLEAR) {
+        s->color_load_op = NGLI_LOAD_OP_LOAD;
+        s->depth_stencil_load_op = NGLI_LOAD_OP_LOAD;
+    }
+
     static const float clear_color[4] = DEFAULT_CLEAR_COLOR;
     s->use_clear_color = memcmp(s->clear_color, clear_color, sizeof(s->clear_color));
 
+    s->rtt_format = get_precision_format(node);
+    for (int i = 0; i < s->nb_color_textures; i++) {
+        struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
+        texture_priv->rtt_format = s->rtt_format;
+    }
+
     return 0;
 }
 
-static int create_ms_rendertarget(struct ngl_node *node, int depth_format)
+static void ms_target_freep(struct rtt_ms_target **targetp)
+{
+    struct rtt_ms_target *target = *targetp;
+    if (!target)
+        return;
+
+    ngli_rendertarget_reset(&target->rt);
+    struct texture *colors = ngli_darray_data(&target->colors);
+    for (int i = 0; i < ngli_darray_count(&target->colors); i++)
+        ngli_texture_reset(&colors[i]);
+    ngli_darray_reset(&target->colors);
+    ngli_texture_reset(&target->depth);
+    ngli_free(target);
+    *targetp = NULL;
+}
+
+static struct rtt_ms_target *ms_target_create(struct ngl_node *node)
 {
-    int ret = 0;
     struct ngl_ctx *ctx = node->ctx;
     struct rtt_priv *s = node->priv_data;
 
-    ngli_darray_init(&s->rt_ms_colors, sizeof(struct texture), 0);
+    struct rtt_ms_target *target = ngli_calloc(1, sizeof(*target));
+    if (!target)
+        return NULL;
+    ngli_darray_init(&target->colors, sizeof(struct texture), 0);
 
     struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
     attachment_params.width = s->width;
@@ -141,32 +297,39 @@ static int create_ms_rendertarget(struct ngl_node *node, int depth_format)
         const struct texture_params *params = &texture->params;
         const int n = params->cubemap ? 6 : 1;
         for (int i = 0; i < n; i++) {
-            struct texture *ms_texture = ngli_darray_push(&s->rt_ms_colors, NULL);
-            if (!ms_texture) {
-                ret = NGL_ERROR_MEMORY;
-                goto end;
-            }
+            struct texture *ms_texture = ngli_darray_push(&target->colors, NULL);
+            if (!ms_texture)
+                goto fail;
+            memset(ms_texture, 0, sizeof(*ms_texture));
+        }
+    }
+
+    struct texture *colors = ngli_darray_data(&target->colors);
+    int index = 0;
+    for (int i = 0; i < s->nb_color_textures; i++) {
+        const struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
+        const struct texture *texture = &texture_priv->texture;
+        const struct texture_params *params = &texture->params;
+        const int n = params->cubemap ? 6 : 1;
+        for (int i = 0; i < n; i++) {
+            struct texture *ms_texture = &colors[index++];
             attachment_params.format = params->format;
-            ret = ngli_texture_init(ms_texture, ctx, &attachment_params);
+            int ret = ngli_texture_init(ms_texture, ctx, &attachment_params);
             if (ret < 0)
-                goto end;
-            if (!ngli_darray_push(&attachments, &ms_texture)) {
-                ret = NGL_ERROR_MEMORY;
-                goto end;
-            }
+                goto fail;
+            if (!ngli_darray_push(&attachments, &ms_texture))
+                goto fail;
         }
     }
 
-    if (depth_format != NGLI_FORMAT_UNDEFINED) {
-        attachment_params.format = depth_format;
-        ret = ngli_texture_init(&s->rt_ms_depth, ctx, &attachment_params);
+    if (s->depth_format != NGLI_FORMAT_UNDEFINED) {
+        attachment_params.format = s->depth_format;
+        int ret = ngli_texture_init(&target->depth, ctx, &attachment_params);
         if (ret < 0)
-            goto end;
-        struct texture *rt_ms_depth = &s->rt_ms_depth;
-        if (!ngli_darray_push(&attachments, &rt_ms_depth)) {
-            ret = NGL_ERROR_MEMORY;
-            goto end;
-        }
+            goto fail;
+        struct texture *depth = &target->depth;
+        if (!ngli_darray_push(&attachments, &depth))
+            goto fail;
     }
 
     struct rendertarget_params rt_params = {
@@ -175,62 +338,247 @@ static int create_ms_rendertarget(struct ngl_node *node, int depth_format)
         .nb_attachments = ngli_darray_count(&attachments),
         .attachments = ngli_darray_data(&attachments),
     };
-    ret = ngli_rendertarget_init(&s->rt_ms, ctx, &rt_params);
+    int ret = ngli_rendertarget_init(&target->rt, ctx, &rt_params);
     if (ret < 0)
-        goto end;
+        goto fail;
 
-end:
     ngli_darray_reset(&attachments);
-    return ret;
+    return target;
+
+fail:
+    ngli_darray_reset(&attachments);
+    ms_target_freep(&target);
+    return NULL;
 }
 
-static int rtt_prefetch(struct ngl_node *node)
+static struct rendertarget *ms_target_acquire(struct ngl_node *node)
 {
-    int ret = 0;
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct rtt_priv *s = node->priv_data;
+    struct rtt_ms_shared *shared = s->ms_shared;
 
-    if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT) && s->samples > 0) {
-        LOG(WARNING, "context does not support the framebuffer object feature, "
-            "multisample anti-aliasing will be disabled");
-        s->samples = 0;
+    struct rtt_ms_target **targets = ngli_darray_data(&shared->targets);
+    for (int i = 0; i < ngli_darray_count(&shared->targets); i++) {
+        if (!targets[i]->in_use) {
+            targets[i]->in_use = 1;
+            return &targets[i]->rt;
+        }
     }
 
-    if (!s->nb_color_textures) {
-        LOG(ERROR, "at least one color texture must be specified");
-        return NGL_ERROR_INVALID_ARG;
+    struct rtt_ms_target *target = ms_target_create(node);
+    if (!target)
+        return NULL;
+    if (!ngli_darray_push(&shared->targets, &target)) {
+        ms_target_freep(&target);
+        return NULL;
+    }
+    target->in_use = 1;
+    return &target->rt;
+}
+
+static void ms_target_release(struct ngl_node *node, struct rendertarget *rt)
+{
+    struct rtt_priv *s = node->priv_data;
+    struct rtt_ms_shared *shared = s->ms_shared;
+
+    struct rtt_ms_target **targets = ngli_darray_data(&shared->targets);
+    for (int i = 0; i < ngli_darray_count(&shared->targets); i++) {
+        if (&targets[i]->rt == rt) {
+            targets[i]->in_use = 0;
+            return;
+        }
     }
+}
 
+static char *get_ms_shared_key(const struct ngl_node *node)
+{
+    const struct rtt_priv *s = node->priv_data;
+
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+
+    ngli_bstr_print(b, "%dx%d:%d:%d", s->width, s->height, s->samples, s->depth_format);
     for (int i = 0; i < s->nb_color_textures; i++) {
         const struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
-        const struct texture *texture = &texture_priv->texture;
-        const struct texture_params *params = &texture->params;
-        if (i == 0) {
-            s->width = params->width;
-            s->height = params->height;
-        } else if (s->width != params->width || s->height != params->height) {
-            LOG(ERROR, "all color texture dimensions do not match %dx%d != %dx%d",
-            s->width, s->height, params->width, params->height);
-            return NGL_ERROR_INVALID_ARG;
+        const struct texture_params *params = &texture_priv->texture.params;
+        ngli_bstr_print(b, ":%d%s", params->format, params->cubemap ? "c" : "");
+    }
+
+    /* The content of loaded targets must be preserved between draws */
+    if (s->ms_store_op == NGLI_STORE_OP_STORE)
+        ngli_bstr_print(b, ":%p", node);
+
+    char *key = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return key;
+}
+
+static int ms_shared_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct rtt_priv *s = node->priv_data;
+
+    char *key = get_ms_shared_key(node);
+    if (!key)
+        return NGL_ERROR_MEMORY;
+
+    if (!ctx->rtt_ms_pool) {
+        ctx->rtt_ms_pool = ngli_hmap_create();
+        if (!ctx->rtt_ms_pool) {
+            ngli_free(key);
+            return NGL_ERROR_MEMORY;
         }
     }
 
-    if (s->depth_texture) {
-        const struct texture_priv *depth_texture_priv = s->depth_texture->priv_data;
-        const struct texture *depth_texture = &depth_texture_priv->texture;
-        const struct texture_params *depth_texture_params = &depth_texture->params;
-        if (s->width != depth_texture_params->width || s->height != depth_texture_params->height) {
-            LOG(ERROR, "color and depth texture dimensions do not match: %dx%d != %dx%d",
-                s->width, s->height, depth_texture_params->width, depth_texture_params->height);
-            return NGL_ERROR_INVALID_ARG;
+    struct rtt_ms_shared *shared = ngli_hmap_get(ctx->rtt_ms_pool, key);
+    if (shared) {
+        ngli_free(key);
+        shared->refcount++;
+        s->ms_shared = shared;
+        return 0;
+    }
+
+    shared = ngli_calloc(1, sizeof(*shared));
+    if (!shared) {
+        ngli_free(key);
+        return NGL_ERROR_MEMORY;
+    }
+    shared->key = key;
+    shared->refcount = 1;
+    ngli_darray_init(&shared->targets, sizeof(struct rtt_ms_target *), 0);
+
+    int ret = ngli_hmap_set(ctx->rtt_ms_pool, key, shared);
+    if (ret < 0) {
+        ngli_free(shared->key);
+        ngli_free(shared);
+        return ret;
+    }
+    s->ms_shared = shared;
+
+    /* Allocate the first target upfront so the common case does not
+     * allocate anything at draw time */
+    struct rendertarget *rt = ms_target_acquire(node);
+    if (!rt)
+        return NGL_ERROR_MEMORY;
+    ms_target_release(node, rt);
+
+    return 0;
+}
+
+static void ms_shared_uninit(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct rtt_priv *s = node->priv_data;
+    struct rtt_ms_shared *shared = s->ms_shared;
+
+    if (!shared)
+        return;
+
+    s->ms_shared = NULL;
+    if (--shared->refcount)
+        return;
+
+    struct rtt_ms_target **targets = ngli_darray_data(&shared->targets);
+    for (int i = 0; i < ngli_darray_count(&shared->targets); i++)
+        ms_target_freep(&targets[i]);
+    ngli_darray_reset(&shared->targets);
+
+    ngli_hmap_set(ctx->rtt_ms_pool, shared->key, NULL);
+    ngli_free(shared->key);
+    ngli_free(shared);
+    if (!ngli_hmap_count(ctx->rtt_ms_pool))
+        ngli_hmap_freep(&ctx->rtt_ms_pool);
+}
+
+static int get_features_depth_format(const struct rtt_priv *s)
+{
+    if (s->features & FEATURE_STENCIL)
+        return NGLI_FORMAT_D24_UNORM_S8_UINT;
+    if (s->features & FEATURE_DEPTH)
+        return NGLI_FORMAT_D16_UNORM;
+    return NGLI_FORMAT_UNDEFINED;
+}
+
+/*
+ * Only the GraphicConfig nodes enable the depth and stencil tests, and the
+ * nested render targets draw into their own buffers
+ */
+static int scene_tests_depth(const struct ngl_node *node)
+{
+    if (node->class->id == NGL_NODE_GRAPHICCONFIG && ngli_node_graphicconfig_tests_depth(node))
+        return 1;
+    if (node->class->id == NGL_NODE_RENDERTOTEXTURE || node->class->id == NGL_NODE_STEREOCAMERA)
+        return 0;
+
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++)
+        if (scene_tests_depth(children[i]))
+            return 1;
+    return 0;
+}
+
+static int can_drop_depth(const struct rtt_priv *s)
+{
+    return s->precision != PRECISION_DECLARED && !s->depth_texture &&
+           get_features_depth_format(s) != NGLI_FORMAT_UNDEFINED &&
+           !scene_tests_depth(s->child);
+}
+
+static int64_t get_saved_memory(const struct ngl_node *node)
+{
+    const struct rtt_priv *s = node->priv_data;
+
+    /* The multisample render target duplicates every attachment */
+    const int nb_samples = s->samples > 0 ? s->samples : 1;
+    const int nb_ms_samples = s->samples > 0 && !s->implicit_ms ? s->samples : 0;
+
+    int64_t saved_memory = 0;
+    if (s->rtt_format != NGLI_FORMAT_UNDEFINED) {
+        for (int i = 0; i < s->nb_color_textures; i++) {
+            const struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
+            const struct texture_params *params = &texture_priv->params;
+            const int nb_layers = params->cubemap ? 6 : 1;
+            const int64_t declared_size = ngli_format_get_image_size(params->format, s->width, s->height);
+            const int64_t size = ngli_format_get_image_size(s->rtt_format, s->width, s->height);
+            saved_memory += (declared_size - size) * nb_layers * (1 + nb_ms_samples);
         }
     }
+    if (s->depth_dropped)
+        saved_memory += ngli_format_get_image_size(get_features_depth_format(s), s->width, s->height) * nb_samples;
+    return saved_memory;
+}
+
+static void update_stats(struct ngl_node *node, int accounted)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct rtt_priv *s = node->priv_data;
+    struct ngl_stats *stats = &ctx->stats;
+
+    if (s->stats_accounted == accounted)
+        return;
+    s->stats_accounted = accounted;
+
+    const int sign = accounted ? 1 : -1;
+    if (s->rtt_format != NGLI_FORMAT_UNDEFINED)
+        stats->nb_rtt_formats[precision_formats[s->precision].stats_index] += sign * s->nb_color_textures;
+    stats->nb_rtt_dropped_depths += sign * s->depth_dropped;
+    stats->rtt_saved_memory += sign * s->saved_memory;
+}
+
+static int init_targets(struct ngl_node *node)
+{
+    int ret = 0;
+    struct ngl_ctx *ctx = node->ctx;
+    struct rtt_priv *s = node->priv_data;
 
     struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
     attachment_params.width = s->width;
     attachment_params.height = s->height;
     attachment_params.usage = NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY;
+    if (s->implicit_ms) {
+        attachment_params.samples = s->samples;
+        attachment_params.usage |= NGLI_TEXTURE_USAGE_IMPLICIT_MULTISAMPLE;
+    }
 
     struct darray attachments;
     ngli_darray_init(&attachments, sizeof(struct texture *), 0);
@@ -254,12 +602,12 @@ static int rtt_prefetch(struct ngl_node *node)
             goto end;
         }
     } else {
-        if (s->features & FEATURE_STENCIL)
-            depth_format = NGLI_FORMAT_D24_UNORM_S8_UINT;
-        else if (s->features & FEATURE_DEPTH)
-            depth_format = NGLI_FORMAT_D16_UNORM;
+        if (!s->depth_dropped)
+            depth_format = get_features_depth_format(s);
 
-        if (depth_format != NGLI_FORMAT_UNDEFINED) {
+        /* With multisampling, the depth and stencil are only needed in the
+         * multisample render target */
+        if (depth_format != NGLI_FORMAT_UNDEFINED && (!s->samples || s->implicit_ms)) {
             struct texture *rt_depth = &s->rt_depth;
             attachment_params.format = depth_format;
             ret = ngli_texture_init(rt_depth, ctx, &attachment_params);
@@ -269,27 +617,115 @@ static int rtt_prefetch(struct ngl_node *node)
                 ret = NGL_ERROR_MEMORY;
                 goto end;
             }
-            if (!(s->features & FEATURE_NO_CLEAR))
-                s->invalidate_depth_stencil = 1;
         }
+        /* The internal depth/stencil buffer can not be read by anyone */
+        if (s->depth_stencil_load_op != NGLI_LOAD_OP_LOAD)
+            s->depth_stencil_store_op = NGLI_STORE_OP_DONT_CARE;
     }
+    s->depth_format = depth_format;
+
+    /* Once resolved, the multisample attachments are discarded unless the
+     * next draw loads them */
+    s->ms_store_op = s->color_load_op == NGLI_LOAD_OP_LOAD || s->depth_stencil_load_op == NGLI_LOAD_OP_LOAD
+                   ? NGLI_STORE_OP_STORE : NGLI_STORE_OP_DONT_CARE;
+
+    /* A loaded attachment makes every draw depend on the previous one */
+    s->cache_enabled = s->color_load_op != NGLI_LOAD_OP_LOAD && s->depth_stencil_load_op != NGLI_LOAD_OP_LOAD;
+    s->content_valid = 0;
 
     struct rendertarget_params rt_params = {
         .width = s->width,
         .height = s->height,
         .nb_attachments = ngli_darray_count(&attachments),
         .attachments = ngli_darray_data(&attachments),
+        .implicit_samples = s->implicit_ms ? s->samples : 0,
     };
     ret = ngli_rendertarget_init(&s->rt, ctx, &rt_params);
     if (ret < 0)
         goto end;
+    ngli_glcontext_set_object_label(ctx->glcontext, GL_FRAMEBUFFER, s->rt.id, node->label);
 
-    if (s->samples > 0) {
-        ret = create_ms_rendertarget(node, depth_format);
+    if (s->samples > 0 && !s->implicit_ms) {
+        ret = ms_shared_init(node);
         if (ret < 0)
             goto end;
     }
 
+end:
+    ngli_darray_reset(&attachments);
+    return ret;
+}
+
+static void release_targets(struct ngl_node *node)
+{
+    struct rtt_priv *s = node->priv_data;
+
+    ngli_rendertarget_reset(&s->rt);
+    ngli_texture_reset(&s->rt_depth);
+    ms_shared_uninit(node);
+}
+
+static int rtt_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct rtt_priv *s = node->priv_data;
+
+    if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT) && s->samples > 0) {
+        LOG(WARNING, "context does not support the framebuffer object feature, "
+            "multisample anti-aliasing will be disabled");
+        s->samples = 0;
+    }
+
+    if (!s->nb_color_textures) {
+        LOG(ERROR, "at least one color texture must be specified");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < s->nb_color_textures; i++) {
+        const struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
+        const struct texture *texture = &texture_priv->texture;
+        const struct texture_params *params = &texture->params;
+        if (i == 0) {
+            s->width = params->width;
+            s->height = params->height;
+        } else if (s->width != params->width || s->height != params->height) {
+            LOG(ERROR, "all color texture dimensions do not match %dx%d != %dx%d",
+            s->width, s->height, params->width, params->height);
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    if (s->depth_texture) {
+        const struct texture_priv *depth_texture_priv = s->depth_texture->priv_data;
+        const struct texture *depth_texture = &depth_texture_priv->texture;
+        const struct texture_params *depth_texture_params = &depth_texture->params;
+        if (s->width != depth_texture_params->width || s->height != depth_texture_params->height) {
+            LOG(ERROR, "color and depth texture dimensions do not match: %dx%d != %dx%d",
+                s->width, s->height, depth_texture_params->width, depth_texture_params->height);
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    /* On tile-based GPUs, a single color texture can be rendered with
+     * multisampling directly: the samples stay in the tile memory and are
+     * resolved when the tiles are written, without any multisample buffer */
+    s->implicit_ms = 0;
+    if (s->samples > 0 && (gl->features & NGLI_FEATURE_MULTISAMPLED_RENDER_TO_TEXTURE) &&
+        s->samples <= gl->max_samples && s->nb_color_textures == 1 && !s->depth_texture) {
+        const struct texture_priv *texture_priv = s->color_textures[0]->priv_data;
+        s->implicit_ms = !texture_priv->texture.params.cubemap;
+    }
+
+    s->depth_dropped = can_drop_depth(s);
+
+    int ret = init_targets(node);
+    if (ret < 0)
+        return ret;
+
+    s->saved_memory = get_saved_memory(node);
+    update_stats(node, 1);
+
     if (s->vflip) {
         /* flip vertically the color and depth textures so the coordinates
          * match how the uv coordinates system works */
@@ -308,17 +744,68 @@ static int rtt_prefetch(struct ngl_node *node)
         }
     }
 
-end:
-    ngli_darray_reset(&attachments);
-    return ret;
+    return 0;
 }
 
+/*
+ * The depth and stencil tests can also be enabled by the parents of the node,
+ * which are only known at draw time
+ */
+static int restore_depth(struct ngl_node *node)
+{
+    struct rtt_priv *s = node->priv_data;
+
+    LOG(DEBUG, "depth or stencil test inherited by %s, restoring its depth and stencil buffer", node->label);
+
+    update_stats(node, 0);
+    release_targets(node);
+    s->depth_dropped = 0;
+    int ret = init_targets(node);
+    if (ret < 0) {
+        release_targets(node);
+        s->depth_dropped = 1;
+        return ret;
+    }
+    s->saved_memory = get_saved_memory(node);
+    update_stats(node, 1);
+    return 0;
+}
+
+/*
+ * The content of the textures only changes with the child scene, which
+ * reports its changes to the context while it is updated, and with the
+ * textures it samples, which are collected at the same time.
+ */
 static int rtt_update(struct ngl_node *node, double t)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct rtt_priv *s = node->priv_data;
+
+    struct darray *parent_texture_reads = ctx->texture_reads;
+    s->texture_reads.count = 0;
+    ctx->texture_reads = &s->texture_reads;
+
+    const int frame_changed = ctx->frame_changed;
+    ctx->frame_changed = 0;
     int ret = ngli_node_update(s->child, t);
+    const int changed = ctx->frame_changed;
+    ctx->frame_changed |= frame_changed;
+
+    /* The content of a parent RTT also depends on the textures of its
+     * nested RTTs */
+    ctx->texture_reads = parent_texture_reads;
     if (ret < 0)
         return ret;
+    if (parent_texture_reads) {
+        struct ngl_node **textures = ngli_darray_data(&s->texture_reads);
+        for (int i = 0; i < ngli_darray_count(&s->texture_reads); i++) {
+            ret = ngli_node_record_texture_read(ctx, textures[i]);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
+    s->child_changed |= changed;
 
     for (int i = 0; i < s->nb_color_textures; i++) {
         ret = ngli_node_update(s->color_textures[i], t);
@@ -332,7 +819,74 @@ static int rtt_update(struct ngl_node *node, double t)
             return ret;
     }
 
-    return 0;
+    return changed;
+}
+
+static int owns_texture(const struct ngl_node *node, const struct ngl_node *texture)
+{
+    const struct texture_priv *texture_priv = texture->priv_data;
+    return texture_priv->last_rtt == node;
+}
+
+/*
+ * The child is only drawn again if the content of the textures could differ
+ * from the previous draw: besides the changes of the child scene, the draw
+ * depends on the transforms and graphic states inherited from the parents,
+ * on the live changes, and on the resources written by the GPU since then.
+ */
+static int content_cached(const struct ngl_node *node)
+{
+    const struct ngl_ctx *ctx = node->ctx;
+    const struct rtt_priv *s = node->priv_data;
+
+    if (!s->cache_enabled || !s->content_valid || s->child_changed ||
+        s->live_change_gen != ctx->live_change_gen ||
+        s->gpu_write_gen < ctx->compute_write_gen ||
+        memcmp(s->modelview_matrix, ngli_darray_tail(&ctx->modelview_matrix_stack), sizeof(s->modelview_matrix)) ||
+        memcmp(s->projection_matrix, ngli_darray_tail(&ctx->projection_matrix_stack), sizeof(s->projection_matrix)) ||
+        memcmp(&s->graphicconfig, &ctx->graphicconfig, sizeof(s->graphicconfig)))
+        return 0;
+
+    for (int i = 0; i < s->nb_color_textures; i++)
+        if (!owns_texture(node, s->color_textures[i]))
+            return 0;
+    if (s->depth_texture && !owns_texture(node, s->depth_texture))
+        return 0;
+
+    /* Sampling its own textures is a feedback loop, never stable */
+    struct ngl_node **textures = ngli_darray_data(&s->texture_reads);
+    for (int i = 0; i < ngli_darray_count(&s->texture_reads); i++) {
+        const struct texture_priv *texture_priv = textures[i]->priv_data;
+        if (texture_priv->write_gen > s->gpu_write_gen || texture_priv->last_rtt == node)
+            return 0;
+    }
+
+    return 1;
+}
+
+static void save_content_signature(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct rtt_priv *s = node->priv_data;
+
+    s->content_valid = 1;
+    s->child_changed = 0;
+    s->live_change_gen = ctx->live_change_gen;
+    s->gpu_write_gen = ++ctx->gpu_write_gen;
+    memcpy(s->modelview_matrix, ngli_darray_tail(&ctx->modelview_matrix_stack), sizeof(s->modelview_matrix));
+    memcpy(s->projection_matrix, ngli_darray_tail(&ctx->projection_matrix_stack), sizeof(s->projection_matrix));
+    s->graphicconfig = ctx->graphicconfig;
+
+    for (int i = 0; i < s->nb_color_textures; i++) {
+        struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
+        texture_priv->last_rtt = node;
+        texture_priv->write_gen = s->gpu_write_gen;
+    }
+    if (s->depth_texture) {
+        struct texture_priv *texture_priv = s->depth_texture->priv_data;
+        texture_priv->last_rtt = node;
+        texture_priv->write_gen = s->gpu_write_gen;
+    }
 }
 
 static void rtt_draw(struct ngl_node *node)
@@ -340,7 +894,35 @@ static void rtt_draw(struct ngl_node *node)
     struct ngl_ctx *ctx = node->ctx;
     struct rtt_priv *s = node->priv_data;
 
-    struct rendertarget *rt = s->samples > 0 ? &s->rt_ms : &s->rt;
+    /* The textures do not depend on the output and are shared by all of them */
+    if (ctx->drawing_outputs)
+        return;
+
+    if (content_cached(node))
+        return;
+
+    if (s->depth_dropped && (ctx->graphicconfig.depth_test || ctx->graphicconfig.stencil_test)) {
+        int ret = restore_depth(node);
+        if (ret < 0) {
+            LOG(ERROR, "could not restore the depth and stencil buffer of %s", node->label);
+            return;
+        }
+    }
+
+    /* The pending draws target the previous render target */
+    ngli_pass_flush_draw_list(ctx);
+
+    NGLI_TRACEMARKER_BEGIN(rtt, node->label);
+    struct rendertarget *rt = &s->rt;
+    struct rendertarget *rt_ms = NULL;
+    if (s->samples > 0 && !s->implicit_ms) {
+        rt_ms = ms_target_acquire(node);
+        if (!rt_ms)
+            LOG(ERROR, "could not allocate multisample render target, "
+                "multisample anti-aliasing will be disabled for this draw");
+        else
+            rt = rt_ms;
+    }
     struct rendertarget *prev_rt = ngli_gctx_get_rendertarget(ctx);
     ngli_gctx_set_rendertarget(ctx, rt);
 
@@ -356,18 +938,20 @@ static void rtt_draw(struct ngl_node *node)
         ngli_gctx_set_clear_color(ctx, s->clear_color);
     }
 
-    if (!(s->features & FEATURE_NO_CLEAR)) {
-        ngli_gctx_clear_color(ctx);
-        ngli_gctx_clear_depth_stencil(ctx);
-    }
+    ngli_gctx_load_attachments(ctx, s->color_load_op, s->depth_stencil_load_op);
 
     ngli_node_draw(s->child);
+    ngli_pass_flush_draw_list(ctx);
 
-    if (s->samples > 0)
-        ngli_rendertarget_blit(rt, &s->rt, 0);
+    if (rt_ms) {
+        ngli_rendertarget_blit(rt_ms, &s->rt, 0);
+        ngli_gctx_store_attachments(ctx, s->ms_store_op, s->ms_store_op);
+    } else {
+        ngli_gctx_store_attachments(ctx, NGLI_STORE_OP_STORE, s->depth_stencil_store_op);
+    }
 
-    if (s->invalidate_depth_stencil)
-        ngli_gctx_invalidate_depth_stencil(ctx);
+    if (rt_ms)
+        ms_target_release(node, rt_ms);
 
     ngli_gctx_set_rendertarget(ctx, prev_rt);
     ngli_gctx_set_viewport(ctx, prev_vp);
@@ -375,37 +959,77 @@ static void rtt_draw(struct ngl_node *node)
     if (s->use_clear_color)
         ngli_gctx_set_clear_color(ctx, prev_clear_color);
 
+    /* The mipmaps are only generated once the textures are sampled */
     for (int i = 0; i < s->nb_color_textures; i++) {
         struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
-        struct texture *texture = &texture_priv->texture;
-        if (ngli_texture_has_mipmap(texture))
-            ngli_texture_generate_mipmap(texture);
+        ngli_texture_invalidate_mipmap(&texture_priv->texture);
     }
+
+    save_content_signature(node);
+    NGLI_TRACEMARKER_END(rtt);
 }
 
 static void rtt_release(struct ngl_node *node)
 {
     struct rtt_priv *s = node->priv_data;
 
-    ngli_rendertarget_reset(&s->rt);
-    ngli_texture_reset(&s->rt_depth);
+    release_targets(node);
+    s->content_valid = 0;
+    update_stats(node, 0);
+}
+
+int64_t ngli_node_rtt_estimate_memory(const struct ngl_node *node)
+{
+    const struct rtt_priv *s = node->priv_data;
+    if (!s->nb_color_textures)
+        return 0;
 
-    ngli_rendertarget_reset(&s->rt_ms);
-    struct texture *rt_ms_colors = ngli_darray_data(&s->rt_ms_colors);
-    for (int i = 0; i < ngli_darray_count(&s->rt_ms_colors); i++)
-        ngli_texture_reset(&rt_ms_colors[i]);
-    ngli_darray_reset(&s->rt_ms_colors);
-    ngli_texture_reset(&s->rt_ms_depth);
+    const struct texture_priv *texture_priv = s->color_textures[0]->priv_data;
+    const int width = texture_priv->params.width;
+    const int height = texture_priv->params.height;
+
+    const int depth_format = get_features_depth_format(s);
+    const int64_t depth_size = s->depth_texture || depth_format == NGLI_FORMAT_UNDEFINED || can_drop_depth(s)
+                             ? 0 : ngli_format_get_image_size(depth_format, width, height);
+    if (!s->samples)
+        return depth_size;
+
+    /* Without the tile-based implicit multisampling, every attachment is
+     * duplicated in the multisample render target */
+    int64_t ms_size = depth_size;
+    for (int i = 0; i < s->nb_color_textures; i++) {
+        const struct texture_priv *color_priv = s->color_textures[i]->priv_data;
+        const int format = s->rtt_format != NGLI_FORMAT_UNDEFINED ? s->rtt_format : color_priv->params.format;
+        ms_size += ngli_format_get_image_size(format, width, height);
+    }
+    if (s->depth_texture) {
+        const struct texture_priv *depth_priv = s->depth_texture->priv_data;
+        ms_size += ngli_format_get_image_size(depth_priv->params.format, width, height);
+    }
+    return ms_size * s->samples;
+}
+
+static void rtt_uninit(struct ngl_node *node)
+{
+    struct rtt_priv *s = node->priv_data;
+    ngli_darray_reset(&s->texture_reads);
+
+    for (int i = 0; i < s->nb_color_textures; i++) {
+        struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
+        texture_priv->rtt_format = NGLI_FORMAT_UNDEFINED;
+    }
 }
 
 const struct node_class ngli_rtt_class = {
     .id        = NGL_NODE_RENDERTOTEXTURE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "RenderToTexture",
     .init      = rtt_init,
     .prefetch  = rtt_prefetch,
     .update    = rtt_update,
     .draw      = rtt_draw,
     .release   = rtt_release,
+    .uninit    = rtt_uninit,
     .priv_size = sizeof(struct rtt_priv),
     .params    = rtt_params,
     .file      = __FILE__,
@@ -52,6 +52,7 @@ static void update_trf_matrix(struct ngl_node *node, const float *f)
         ngli_mat4_translate(tm, -a[0], -a[1], -a[2]);
         ngli_mat4_mul(matrix, matrix, tm);
     }
+    ngli_transform_invalidate(trf);
 }
 
 static int scale_init(struct ngl_node *node)
@@ -59,9 +60,12 @@ static int scale_init(struct ngl_node *node)
     struct scale_priv *s = node->priv_data;
     static const float zero_anchor[3] = {0};
     s->use_anchor = memcmp(s->anchor, zero_anchor, sizeof(s->anchor));
-    if (!s->anim)
+    const struct variable_priv *anim = s->anim ? s->anim->priv_data : NULL;
+    if (!anim)
         update_trf_matrix(node, s->factors);
-    return 0;
+    else if (anim->constant)
+        update_trf_matrix(node, anim->vector);
+    return ngli_transform_init(node, anim && !anim->constant);
 }
 
 static int update_factors(struct ngl_node *node)
@@ -80,7 +84,7 @@ static int scale_update(struct ngl_node *node, double t)
     struct scale_priv *s = node->priv_data;
     struct transform_priv *trf = &s->trf;
     struct ngl_node *child = trf->child;
-    if (s->anim) {
+    if (trf->animated) {
         struct ngl_node *anim_node = s->anim;
         struct variable_priv *anim = anim_node->priv_data;
         int ret = ngli_node_update(anim_node, t);
@@ -112,6 +116,8 @@ NGLI_STATIC_ASSERT(trf_on_top_of_scale, OFFSET(trf) == 0);
 
 const struct node_class ngli_scale_class = {
     .id        = NGL_NODE_SCALE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Scale",
     .init      = scale_init,
     .update    = scale_update,
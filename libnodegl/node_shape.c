@@ -0,0 +1,294 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "format.h"
+#include "log.h"
+#include "math_utils.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "pass.h"
+#include "pipeline.h"
+#include "program.h"
+#include "topology.h"
+#include "type.h"
+#include "utils.h"
+
+#define SHAPE_RECTANGLE 0
+#define SHAPE_ELLIPSE   1
+
+struct shape_priv {
+    int shape;
+    float color[4];
+    float box_corner[3];
+    float box_width[3];
+    float box_height[3];
+    double corner_radius;
+    double stroke_width;
+
+    float half_size[2];
+    float radius;
+    float stroke;
+    struct program program;
+    struct buffer vertices;
+    struct buffer coords;
+    struct pipeline pipeline;
+
+    int modelview_matrix_index;
+    int projection_matrix_index;
+};
+
+static const struct param_choices shape_choices = {
+    .name = "shape",
+    .consts = {
+        {"rectangle", SHAPE_RECTANGLE, .desc=NGLI_DOCSTRING("rectangle, with rounded corners if `corner_radius` is set")},
+        {"ellipse",   SHAPE_ELLIPSE,   .desc=NGLI_DOCSTRING("ellipse inscribed in the box (a circle if the box is a square)")},
+        {NULL}
+    }
+};
+
+#define OFFSET(x) offsetof(struct shape_priv, x)
+static const struct node_param shape_params[] = {
+    {"shape",         PARAM_TYPE_SELECT, OFFSET(shape), {.i64=SHAPE_RECTANGLE},
+                      .choices=&shape_choices,
+                      .desc=NGLI_DOCSTRING("shape drawn in the box")},
+    {"color",         PARAM_TYPE_VEC4, OFFSET(color), {.vec={1.0, 1.0, 1.0, 1.0}},
+                      .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                      .desc=NGLI_DOCSTRING("shape color")},
+    {"box_corner",    PARAM_TYPE_VEC3, OFFSET(box_corner), {.vec={-1.0, -1.0, 0.0}},
+                      .desc=NGLI_DOCSTRING("origin coordinates of `box_width` and `box_height` vectors")},
+    {"box_width",     PARAM_TYPE_VEC3, OFFSET(box_width), {.vec={2.0, 0.0, 0.0}},
+                      .desc=NGLI_DOCSTRING("box width vector")},
+    {"box_height",    PARAM_TYPE_VEC3, OFFSET(box_height), {.vec={0.0, 2.0, 0.0}},
+                      .desc=NGLI_DOCSTRING("box height vector")},
+    {"corner_radius", PARAM_TYPE_DBL, OFFSET(corner_radius), {.dbl=0.0},
+                      .desc=NGLI_DOCSTRING("radius of the rectangle corners, in the unit of the box vectors")},
+    {"stroke_width",  PARAM_TYPE_DBL, OFFSET(stroke_width), {.dbl=0.0},
+                      .desc=NGLI_DOCSTRING("width of the outline drawn inside the shape edge, "
+                                           "in the unit of the box vectors (`0` fills the shape)")},
+    {NULL}
+};
+
+static const char * const vertex_data =
+    "#version 100"                                                          "\n"
+    "precision highp float;"                                                "\n"
+    "attribute vec4 position;"                                              "\n"
+    "attribute vec2 coord;"                                                 "\n"
+    "uniform mat4 modelview_matrix;"                                        "\n"
+    "uniform mat4 projection_matrix;"                                       "\n"
+    "varying vec2 var_coord;"                                               "\n"
+    "void main()"                                                           "\n"
+    "{"                                                                     "\n"
+    "    gl_Position = projection_matrix * modelview_matrix * position;"    "\n"
+    "    var_coord = coord;"                                                "\n"
+    "}";
+
+/*
+ * The fragment shaders evaluate the signed distance to the shape edge (in the
+ * box unit, relative to the box center) and derive the pixel coverage from its
+ * screen-space derivatives, which gives an antialiasing independent of the
+ * resolution and of multisampling
+ */
+#define FRAGMENT_HEADER                                                     \
+    "#version 100"                                                          "\n" \
+    "#extension GL_OES_standard_derivatives : enable"                       "\n" \
+    "precision highp float;"                                                "\n" \
+    "uniform vec4 color;"                                                   "\n" \
+    "uniform vec2 half_size;"                                               "\n" \
+    "uniform float radius;"                                                 "\n" \
+    "uniform float stroke;"                                                 "\n" \
+    "varying vec2 var_coord;"                                               "\n"
+
+#define FRAGMENT_MAIN                                                       \
+    "void main(void)"                                                       "\n" \
+    "{"                                                                     "\n" \
+    "    float d = get_distance(var_coord);"                                "\n" \
+    "    if (stroke > 0.0)"                                                 "\n" \
+    "        d = abs(d + stroke * 0.5) - stroke * 0.5;"                     "\n" \
+    "    float w = max(length(vec2(dFdx(d), dFdy(d))), 1e-6);"              "\n" \
+    "    float coverage = clamp(0.5 - d / w, 0.0, 1.0);"                    "\n" \
+    "    gl_FragColor = vec4(color.rgb, color.a * coverage);"               "\n" \
+    "}"
+
+static const char * const fragment_rectangle_data =
+    FRAGMENT_HEADER
+    "float get_distance(vec2 p)"                                            "\n"
+    "{"                                                                     "\n"
+    "    vec2 q = abs(p) - half_size + radius;"                             "\n"
+    "    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;"    "\n"
+    "}"                                                                     "\n"
+    FRAGMENT_MAIN;
+
+/* Distance approximated with the first order expansion of the implicit equation */
+static const char * const fragment_ellipse_data =
+    FRAGMENT_HEADER
+    "float get_distance(vec2 p)"                                            "\n"
+    "{"                                                                     "\n"
+    "    float k0 = length(p / half_size);"                                 "\n"
+    "    float k1 = length(p / (half_size * half_size));"                   "\n"
+    "    if (k1 < 1e-6)"                                                    "\n"
+    "        return -min(half_size.x, half_size.y);"                        "\n"
+    "    return k0 * (k0 - 1.0) / k1;"                                      "\n"
+    "}"                                                                     "\n"
+    FRAGMENT_MAIN;
+
+static int init_buffers(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct shape_priv *s = node->priv_data;
+
+    const float *c = s->box_corner;
+    const float *w = s->box_width;
+    const float *h = s->box_height;
+    const float vertices[] = {
+        c[0],               c[1],               c[2],
+        c[0] + w[0],        c[1] + w[1],        c[2] + w[2],
+        c[0] + h[0],        c[1] + h[1],        c[2] + h[2],
+        c[0] + w[0] + h[0], c[1] + w[1] + h[1], c[2] + w[2] + h[2],
+    };
+
+    const float hw = s->half_size[0];
+    const float hh = s->half_size[1];
+    const float coords[] = {
+        -hw, -hh,
+         hw, -hh,
+        -hw,  hh,
+         hw,  hh,
+    };
+
+    int ret = ngli_buffer_init(&s->vertices, ctx, sizeof(vertices), NGLI_BUFFER_USAGE_STATIC);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_buffer_upload(&s->vertices, vertices, sizeof(vertices));
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_buffer_init(&s->coords, ctx, sizeof(coords), NGLI_BUFFER_USAGE_STATIC);
+    if (ret < 0)
+        return ret;
+
+    return ngli_buffer_upload(&s->coords, coords, sizeof(coords));
+}
+
+static int shape_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct shape_priv *s = node->priv_data;
+
+    s->half_size[0] = ngli_vec3_length(s->box_width) / 2.f;
+    s->half_size[1] = ngli_vec3_length(s->box_height) / 2.f;
+    const float max_radius = NGLI_MIN(s->half_size[0], s->half_size[1]);
+
+    if (s->corner_radius < 0.0 || s->stroke_width < 0.0) {
+        LOG(ERROR, "corner radius and stroke width can not be negative");
+        return NGL_ERROR_INVALID_ARG;
+    }
+    s->radius = NGLI_MIN(s->corner_radius, max_radius);
+    s->stroke = s->stroke_width;
+
+    int ret = init_buffers(node);
+    if (ret < 0)
+        return ret;
+
+    const char *fragment_data = s->shape == SHAPE_ELLIPSE ? fragment_ellipse_data : fragment_rectangle_data;
+    ret = ngli_program_init(&s->program, ctx, vertex_data, fragment_data, NULL);
+    if (ret < 0)
+        return ret;
+
+    /* The color is read back at every draw so it can be live changed */
+    const struct pipeline_uniform uniforms[] = {
+        {.name = "modelview_matrix",  .type = NGLI_TYPE_MAT4,  .count = 1, .data = NULL},
+        {.name = "projection_matrix", .type = NGLI_TYPE_MAT4,  .count = 1, .data = NULL},
+        {.name = "color",             .type = NGLI_TYPE_VEC4,  .count = 1, .data = s->color},
+        {.name = "half_size",         .type = NGLI_TYPE_VEC2,  .count = 1, .data = s->half_size},
+        {.name = "radius",            .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->radius},
+        {.name = "stroke",            .type = NGLI_TYPE_FLOAT, .count = 1, .data = &s->stroke},
+    };
+
+    const struct pipeline_attribute attributes[] = {
+        {.name = "position", .format = NGLI_FORMAT_R32G32B32_SFLOAT, .stride = 3 * 4, .buffer = &s->vertices},
+        {.name = "coord",    .format = NGLI_FORMAT_R32G32_SFLOAT,    .stride = 2 * 4, .buffer = &s->coords},
+    };
+
+    struct pipeline_params pipeline_params = {
+        .type          = NGLI_PIPELINE_TYPE_GRAPHICS,
+        .program       = &s->program,
+        .uniforms      = uniforms,
+        .nb_uniforms   = NGLI_ARRAY_NB(uniforms),
+        .attributes    = attributes,
+        .nb_attributes = NGLI_ARRAY_NB(attributes),
+        .graphics      = {
+            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+            .nb_vertices = 4,
+        }
+    };
+
+    ret = ngli_pipeline_init(&s->pipeline, ctx, &pipeline_params);
+    if (ret < 0)
+        return ret;
+
+    s->modelview_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "modelview_matrix");
+    s->projection_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "projection_matrix");
+
+    return 0;
+}
+
+static void shape_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct shape_priv *s = node->priv_data;
+
+    /* Same as the Text node, the shape is drawn outside the draw lists */
+    ngli_pass_flush_draw_list(ctx);
+    ctx->nb_pass_execs++;
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+
+    ngli_pipeline_update_uniform(&s->pipeline, s->modelview_matrix_index, modelview->matrix);
+    ngli_pipeline_update_uniform(&s->pipeline, s->projection_matrix_index, projection_matrix);
+
+    ngli_pipeline_exec(&s->pipeline);
+}
+
+static void shape_uninit(struct ngl_node *node)
+{
+    struct shape_priv *s = node->priv_data;
+    ngli_pipeline_reset(&s->pipeline);
+    ngli_buffer_reset(&s->vertices);
+    ngli_buffer_reset(&s->coords);
+    ngli_program_reset(&s->program);
+}
+
+const struct node_class ngli_shape_class = {
+    .id        = NGL_NODE_SHAPE,
+    .name      = "Shape",
+    .init      = shape_init,
+    .draw      = shape_draw,
+    .uninit    = shape_uninit,
+    .priv_size = sizeof(struct shape_priv),
+    .params    = shape_params,
+    .file      = __FILE__,
+};
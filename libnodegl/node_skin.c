@@ -0,0 +1,170 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "darray.h"
+#include "format.h"
+#include "log.h"
+#include "math_utils.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "transforms.h"
+#include "type.h"
+
+#define SKELETON_TYPES_LIST (const int[]){NGL_NODE_ROTATE,    \
+                                          NGL_NODE_ROTATEQUAT,\
+                                          NGL_NODE_TRANSFORM, \
+                                          NGL_NODE_TRANSLATE, \
+                                          NGL_NODE_SCALE,     \
+                                          NGL_NODE_GROUP,     \
+                                          -1}
+
+#define OFFSET(x) offsetof(struct buffer_priv, x)
+static const struct node_param skin_params[] = {
+    {"skeleton",  PARAM_TYPE_NODE, OFFSET(skeleton), .flags=PARAM_FLAG_CONSTRUCTOR,
+                  .node_types=SKELETON_TYPES_LIST,
+                  .desc=NGLI_DOCSTRING("joint hierarchy, made of transforms and groups, in which each joint "
+                                       "is marked by an `Identity` node")},
+    {"joints",    PARAM_TYPE_NODELIST, OFFSET(joints),
+                  .node_types=(const int[]){NGL_NODE_IDENTITY, -1},
+                  .desc=NGLI_DOCSTRING("`Identity` nodes of the `skeleton` marking the joints, "
+                                       "in the order of the joint indices of the vertices")},
+    {"inverse_bind_matrices", PARAM_TYPE_NODE, OFFSET(inverse_bind_matrices),
+                  .node_types=(const int[]){NGL_NODE_BUFFERMAT4, -1},
+                  .desc=NGLI_DOCSTRING("matrices bringing the vertices from the model space to the space "
+                                       "of each joint in its bind pose, identities if not set")},
+    {NULL}
+};
+
+static int has_joint(const struct ngl_node *node, const struct ngl_node *joint)
+{
+    if (node == joint)
+        return 1;
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++)
+        if (has_joint(children[i], joint))
+            return 1;
+    return 0;
+}
+
+static int skin_init(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+
+    if (!s->nb_joints) {
+        LOG(ERROR, "at least one joint must be specified");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < s->nb_joints; i++) {
+        if (!has_joint(s->skeleton, s->joints[i])) {
+            LOG(ERROR, "joint %d (%s) is not part of the skeleton", i, s->joints[i]->label);
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    if (s->inverse_bind_matrices) {
+        const struct buffer_priv *ibm = s->inverse_bind_matrices->priv_data;
+        if (ibm->count != s->nb_joints) {
+            LOG(ERROR, "inverse bind matrices count (%d) does not match the number of joints (%d)",
+                ibm->count, s->nb_joints);
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (!ibm->data || ibm->block || ibm->gpu_only) {
+            LOG(ERROR, "the inverse bind matrices must be held in memory");
+            return NGL_ERROR_INVALID_ARG;
+        }
+    }
+
+    s->count = s->nb_joints;
+    s->data_format = NGLI_FORMAT_R32G32B32A32_SFLOAT;
+    s->data_type = NGLI_TYPE_MAT4;
+    s->data_comp = 4 * 4;
+    s->data_stride = s->data_comp * sizeof(float);
+    s->data_size = s->count * s->data_stride;
+    s->data = ngli_calloc_tagged(s->count, s->data_stride, NGLI_MEMTAG_BUFFERS);
+    if (!s->data)
+        return NGL_ERROR_MEMORY;
+    s->dynamic = 1;
+    s->usage = NGLI_BUFFER_USAGE_DYNAMIC;
+    return 0;
+}
+
+/*
+ * The skeleton is drawn from the identity, like the transformation chains of
+ * the camera, so that each joint Identity node captures the matrix bringing
+ * its space to the space of the skeleton root
+ */
+static int skin_update(struct ngl_node *node, double t)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct buffer_priv *s = node->priv_data;
+    static const NGLI_ALIGNED_MAT(id_matrix) = NGLI_MAT4_IDENTITY;
+
+    int ret = ngli_node_update(s->skeleton, t);
+    if (ret < 0)
+        return ret;
+    ret = ngli_modelview_push(ctx, id_matrix, NGLI_MODELVIEW_VERSION_IDENTITY);
+    if (ret < 0)
+        return ret;
+    ngli_node_draw(s->skeleton);
+    ngli_modelview_pop(ctx);
+
+    const struct buffer_priv *ibm = s->inverse_bind_matrices ? s->inverse_bind_matrices->priv_data : NULL;
+    for (int i = 0; i < s->nb_joints; i++) {
+        const struct identity *joint = s->joints[i]->priv_data;
+        uint8_t *dst = s->data + i * s->data_stride;
+        if (ibm) {
+            NGLI_ALIGNED_MAT(ibm_matrix);
+            NGLI_ALIGNED_MAT(joint_matrix);
+            memcpy(ibm_matrix, ibm->data + i * ibm->data_stride, sizeof(ibm_matrix));
+            ngli_mat4_mul(joint_matrix, joint->modelview_matrix, ibm_matrix);
+            memcpy(dst, joint_matrix, sizeof(joint_matrix));
+        } else {
+            memcpy(dst, joint->modelview_matrix, sizeof(joint->modelview_matrix));
+        }
+    }
+
+    return 0;
+}
+
+static void skin_uninit(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+
+    ngli_free_tagged(s->data);
+    s->data = NULL;
+}
+
+const struct node_class ngli_skin_class = {
+    .id        = NGL_NODE_SKIN,
+    .category  = NGLI_NODE_CATEGORY_BUFFER,
+    .name      = "Skin",
+    .init      = skin_init,
+    .update    = skin_update,
+    .uninit    = skin_uninit,
+    .priv_size = sizeof(struct buffer_priv),
+    .params    = skin_params,
+    .file      = __FILE__,
+};
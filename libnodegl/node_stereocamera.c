@@ -0,0 +1,208 @@
+/*
+ * Copyright 2016 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "gctx.h"
+#include "log.h"
+#include "math_utils.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "pass.h"
+#include "rendertarget.h"
+#include "texture.h"
+
+#define NB_EYES 2
+
+struct stereocamera_priv {
+    struct ngl_node *child;
+    double eye_separation;
+    int width;
+    int height;
+
+    int eye_width;
+    int eye_height;
+    struct texture color;
+    struct texture depth;
+    struct rendertarget rt;               /* both eyes, rendered at once */
+    struct rendertarget eye_rts[NB_EYES]; /* one layer of the color, read by the blits */
+    float view_matrices[NB_EYES * 4 * 4];
+};
+
+#define OFFSET(x) offsetof(struct stereocamera_priv, x)
+static const struct node_param stereocamera_params[] = {
+    {"child", PARAM_TYPE_NODE, OFFSET(child), .flags=PARAM_FLAG_CONSTRUCTOR,
+              .desc=NGLI_DOCSTRING("scene to render for both eyes, its programs rendering 2 views")},
+    {"eye_separation", PARAM_TYPE_DBL, OFFSET(eye_separation), {.dbl=0.064},
+                       .desc=NGLI_DOCSTRING("distance between the eyes, in the view space units")},
+    {"width", PARAM_TYPE_INT, OFFSET(width),
+              .desc=NGLI_DOCSTRING("width of the rendering of each eye, half of the viewport width if unset")},
+    {"height", PARAM_TYPE_INT, OFFSET(height),
+               .desc=NGLI_DOCSTRING("height of the rendering of each eye, the viewport height if unset")},
+    {NULL}
+};
+
+static int stereocamera_init(struct ngl_node *node)
+{
+    struct stereocamera_priv *s = node->priv_data;
+
+    if (s->width < 0 || s->height < 0) {
+        LOG(ERROR, "invalid eye dimensions %dx%d", s->width, s->height);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    /*
+     * The eyes look in parallel directions: the view matrices shift the
+     * scene by half the separation, in the opposite direction of each eye
+     */
+    for (int i = 0; i < NB_EYES; i++) {
+        float *view_matrix = s->view_matrices + i * 4 * 4;
+        ngli_mat4_identity(view_matrix);
+        view_matrix[12] = (i ? -0.5f : 0.5f) * s->eye_separation;
+    }
+
+    return 0;
+}
+
+static int stereocamera_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct stereocamera_priv *s = node->priv_data;
+
+    if (!(gl->features & NGLI_FEATURE_OVR_MULTIVIEW)) {
+        LOG(ERROR, "context does not support multiview rendering");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    s->eye_width = s->width ? s->width : NGLI_MAX(ctx->viewport[2] / NB_EYES, 1);
+    s->eye_height = s->height ? s->height : NGLI_MAX(ctx->viewport[3], 1);
+
+    /* The multiview attachments can only be layers of 2D array textures */
+    struct texture_params params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    params.width = s->eye_width;
+    params.height = s->eye_height;
+    params.depth = NB_EYES;
+    params.array = 1;
+    params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    int ret = ngli_texture_init(&s->color, ctx, &params);
+    if (ret < 0)
+        return ret;
+
+    params.format = NGLI_FORMAT_D16_UNORM;
+    ret = ngli_texture_init(&s->depth, ctx, &params);
+    if (ret < 0)
+        return ret;
+
+    const struct texture *attachments[] = {&s->color, &s->depth};
+    struct rendertarget_params rt_params = {
+        .width = s->eye_width,
+        .height = s->eye_height,
+        .nb_attachments = NGLI_ARRAY_NB(attachments),
+        .attachments = attachments,
+        .nb_views = NB_EYES,
+    };
+    ret = ngli_rendertarget_init(&s->rt, ctx, &rt_params);
+    if (ret < 0)
+        return ret;
+
+    const struct texture *eye_attachments[] = {&s->color};
+    for (int i = 0; i < NB_EYES; i++) {
+        struct rendertarget_params eye_rt_params = {
+            .width = s->eye_width,
+            .height = s->eye_height,
+            .nb_attachments = NGLI_ARRAY_NB(eye_attachments),
+            .attachments = eye_attachments,
+            .layer = i,
+        };
+        ret = ngli_rendertarget_init(&s->eye_rts[i], ctx, &eye_rt_params);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int stereocamera_update(struct ngl_node *node, double t)
+{
+    struct stereocamera_priv *s = node->priv_data;
+    return ngli_node_update(s->child, t);
+}
+
+static void stereocamera_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct stereocamera_priv *s = node->priv_data;
+
+    /* The pending draws target the previous render target */
+    ngli_pass_flush_draw_list(ctx);
+
+    struct rendertarget *prev_rt = ngli_gctx_get_rendertarget(ctx);
+    const float *prev_view_matrices = ctx->view_matrices;
+    int prev_vp[4] = {0};
+    ngli_gctx_get_viewport(ctx, prev_vp);
+
+    ngli_gctx_set_rendertarget(ctx, &s->rt);
+    ctx->view_matrices = s->view_matrices;
+    const int vp[4] = {0, 0, s->eye_width, s->eye_height};
+    ngli_gctx_set_viewport(ctx, vp);
+
+    ngli_gctx_load_attachments(ctx, NGLI_LOAD_OP_CLEAR, NGLI_LOAD_OP_CLEAR);
+    ngli_node_draw(s->child);
+    ngli_pass_flush_draw_list(ctx);
+    ngli_gctx_store_attachments(ctx, NGLI_STORE_OP_STORE, NGLI_STORE_OP_DONT_CARE);
+
+    ngli_gctx_set_rendertarget(ctx, prev_rt);
+    ctx->view_matrices = prev_view_matrices;
+    ngli_gctx_set_viewport(ctx, prev_vp);
+
+    /* Side by side in the viewport: the left eye on the left half */
+    const int half_width = prev_vp[2] / NB_EYES;
+    for (int i = 0; i < NB_EYES; i++) {
+        const int rect[4] = {prev_vp[0] + i * half_width, prev_vp[1], half_width, prev_vp[3]};
+        ngli_rendertarget_blit_rect(&s->eye_rts[i], rect);
+    }
+}
+
+static void stereocamera_release(struct ngl_node *node)
+{
+    struct stereocamera_priv *s = node->priv_data;
+
+    for (int i = 0; i < NB_EYES; i++)
+        ngli_rendertarget_reset(&s->eye_rts[i]);
+    ngli_rendertarget_reset(&s->rt);
+    ngli_texture_reset(&s->depth);
+    ngli_texture_reset(&s->color);
+}
+
+const struct node_class ngli_stereocamera_class = {
+    .id        = NGL_NODE_STEREOCAMERA,
+    .name      = "StereoCamera",
+    .init      = stereocamera_init,
+    .prefetch  = stereocamera_prefetch,
+    .update    = stereocamera_update,
+    .draw      = stereocamera_draw,
+    .release   = stereocamera_release,
+    .priv_size = sizeof(struct stereocamera_priv),
+    .params    = stereocamera_params,
+    .file      = __FILE__,
+};
@@ -27,7 +27,9 @@
 #include "log.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "timeindex.h"
 #include "type.h"
+#include "utils.h"
 
 #define OFFSET(x) offsetof(struct variable_priv, x)
 
@@ -44,6 +46,13 @@ static const struct node_param streamed##name##_params[] = {
     {"time_anim",  PARAM_TYPE_NODE, OFFSET(time_anim),                                                    \
                    .node_types=(const int[]){NGL_NODE_ANIMATEDTIME, -1},                                  \
                    .desc=NGLI_DOCSTRING("time remapping animation (must use a `linear` interpolation)")}, \
+    {"gpu_lookup", PARAM_TYPE_BOOL, OFFSET(gpu_lookup), {.i64=0},                                         \
+                   .desc=NGLI_DOCSTRING("upload the whole `buffer` once and let the shader read the "     \
+                                        "current sample: used as the `<name>` uniform, the stream is "    \
+                                        "exposed as the `<name>_data` std430 storage block, the "        \
+                                        "`<name>_index` int uniform holding the current sample index, "  \
+                                        "and the `<name>_ratio` float uniform holding the progress "     \
+                                        "toward the next sample")},                                       \
     {NULL}                                                                                                \
 };
 
@@ -54,6 +63,23 @@ DECLARE_STREAMED_PARAMS(vec3,  NGL_NODE_BUFFERVEC3)
 DECLARE_STREAMED_PARAMS(vec4,  NGL_NODE_BUFFERVEC4)
 DECLARE_STREAMED_PARAMS(mat4,  NGL_NODE_BUFFERMAT4)
 
+static const struct node_param streamedfile_params[] = {
+    {"filename",   PARAM_TYPE_STR, OFFSET(filename), .flags=PARAM_FLAG_CONSTRUCTOR,
+                   .desc=NGLI_DOCSTRING("chunked timeline file containing the timestamped data to stream")},
+    {"timebase",   PARAM_TYPE_RATIONAL, OFFSET(timebase), {.r={1, 1000000}},
+                   .desc=NGLI_DOCSTRING("time base in which the timestamps of the file are represented")},
+    {"time_anim",  PARAM_TYPE_NODE, OFFSET(time_anim),
+                   .node_types=(const int[]){NGL_NODE_ANIMATEDTIME, -1},
+                   .desc=NGLI_DOCSTRING("time remapping animation (must use a `linear` interpolation)")},
+    {NULL}
+};
+
+static double get_timestamp(const void *arg, int index)
+{
+    const int64_t *timestamps = arg;
+    return timestamps[index];
+}
+
 static int get_data_index(const struct ngl_node *node, int start, int64_t t64)
 {
     const struct variable_priv *s = node->priv_data;
@@ -61,17 +87,30 @@ static int get_data_index(const struct ngl_node *node, int start, int64_t t64)
     const int64_t *timestamps = (int64_t *)timestamps_priv->data;
     const int nb_timestamps = timestamps_priv->count;
 
-    int ret = -1;
-    for (int i = start; i < nb_timestamps; i++) {
-        const int64_t ts = timestamps[i];
-        if (ts > t64)
-            break;
-        ret = i;
-    }
-    return ret;
+    return ngli_timeindex_search(timestamps, nb_timestamps, start, t64, get_timestamp);
 }
 
-static int streamed_update(struct ngl_node *node, double t)
+/*
+ * Progress of the stream time between the sample at `index` and the next
+ * one, so that the shader can interpolate between them.
+ */
+static float get_lookup_ratio(const struct ngl_node *node, int index, int64_t t64)
+{
+    const struct variable_priv *s = node->priv_data;
+    const struct buffer_priv *timestamps_priv = s->timestamps->priv_data;
+    const int64_t *timestamps = (int64_t *)timestamps_priv->data;
+
+    if (index + 1 >= timestamps_priv->count)
+        return 0.f;
+
+    const int64_t ts0 = timestamps[index];
+    const int64_t ts1 = timestamps[index + 1];
+    if (t64 <= ts0 || ts1 == ts0)
+        return 0.f;
+    return NGLI_MIN((t64 - ts0) / (double)(ts1 - ts0), 1.);
+}
+
+static int get_stream_time(struct ngl_node *node, double t, int64_t *t64)
 {
     struct variable_priv *s = node->priv_data;
     struct ngl_node *time_anim = s->time_anim;
@@ -99,20 +138,70 @@ static int streamed_update(struct ngl_node *node, double t)
         }
     }
 
-    const int64_t t64 = llrint(rt * s->timebase[1] / (double)s->timebase[0]);
-    int index = get_data_index(node, s->last_index, t64);
-    if (index < 0) {
-        index = get_data_index(node, 0, t64);
-        if (index < 0) // the requested time `t` is before the first user timestamp
-            index = 0;
+    *t64 = llrint(rt * s->timebase[1] / (double)s->timebase[0]);
+    return 0;
+}
+
+/*
+ * A time remapping animation with several key frames reports by itself when
+ * the stream time changes, otherwise the stream time follows t and the data
+ * changes at the next timestamp (if known)
+ */
+static void restrict_next_change(struct ngl_node *node, double t, int64_t next_t64)
+{
+    const struct variable_priv *s = node->priv_data;
+    const struct ngl_node *time_anim = s->time_anim;
+    if (time_anim) {
+        const struct variable_priv *anim = time_anim->priv_data;
+        if (anim->nb_animkf > 1)
+            return;
+        if (anim->nb_animkf == 1) {
+            ngli_node_restrict_next_change(node, t);
+            return;
+        }
     }
+    if (next_t64 < 0)
+        ngli_node_restrict_next_change(node, t);
+    else if (next_t64 < INT64_MAX)
+        ngli_node_restrict_next_change(node, NGLI_MAX(next_t64 * s->timebase[0] / (double)s->timebase[1], t));
+}
+
+static int streamed_update(struct ngl_node *node, double t)
+{
+    struct variable_priv *s = node->priv_data;
+
+    int64_t t64;
+    int ret = get_stream_time(node, t, &t64);
+    if (ret < 0)
+        return ret;
+
+    int index = get_data_index(node, s->last_index, t64);
+    if (index < 0) // the requested time `t` is before the first user timestamp
+        index = 0;
+    const int changed = index != s->last_index;
     s->last_index = index;
 
+    const struct buffer_priv *timestamps_priv = s->timestamps->priv_data;
+    const int64_t *timestamps = (int64_t *)timestamps_priv->data;
+    int64_t next_t64 = INT64_MAX;
+    if (s->gpu_lookup)
+        next_t64 = -1; /* interpolated between the timestamps */
+    else if (index + 1 < timestamps_priv->count)
+        next_t64 = timestamps[index + 1];
+    restrict_next_change(node, t, next_t64);
+
+    if (s->gpu_lookup) {
+        const float ratio = get_lookup_ratio(node, index, t64);
+        const int ratio_changed = ratio != s->lookup_ratio;
+        s->lookup_ratio = ratio;
+        return changed || ratio_changed;
+    }
+
     const struct buffer_priv *buffer_priv = s->buffer->priv_data;
     const uint8_t *datap = buffer_priv->data + buffer_priv->data_stride * index;
     memcpy(s->data, datap, s->data_size);
 
-    return 0;
+    return changed;
 }
 
 static int check_timestamps_buffer(const struct ngl_node *node)
@@ -159,6 +248,26 @@ static int streamed_init(struct ngl_node *node)
         return NGL_ERROR_INVALID_ARG;
     }
 
+    if (s->gpu_lookup) {
+        const struct buffer_priv *buffer_priv = s->buffer->priv_data;
+        if (buffer_priv->block) {
+            LOG(ERROR, "buffer looked up on the GPU can not be a block field");
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        /* std430 pads the vec3 array elements to 16 bytes */
+        if (s->data_type == NGLI_TYPE_VEC3) {
+            LOG(ERROR, "vec3 streams can not be looked up on the GPU");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+    }
+
+    const struct buffer_priv *timestamps_priv = s->timestamps->priv_data;
+    const struct buffer_priv *buffer_priv = s->buffer->priv_data;
+    if (timestamps_priv->gpu_only || (buffer_priv->gpu_only && !s->gpu_lookup)) {
+        LOG(ERROR, "GPU-only buffers can only be used as stream data looked up on the GPU");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
     return check_timestamps_buffer(node);
 }
 
@@ -184,6 +293,7 @@ DECLARE_STREAMED_INIT(mat4,  s->matrix,  sizeof(s->matrix),      NGLI_TYPE_MAT4)
 const struct node_class ngli_streamed##class_suffix##_class = {             \
     .id        = class_id,                                                  \
     .category  = NGLI_NODE_CATEGORY_UNIFORM,                                \
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,                            \
     .name      = class_name,                                                \
     .init      = streamed##class_suffix##_init,                             \
     .update    = streamed_update,                                           \
@@ -198,3 +308,81 @@ DECLARE_STREAMED_CLASS(NGL_NODE_STREAMEDVEC2,  "StreamedVec2",  vec2)
 DECLARE_STREAMED_CLASS(NGL_NODE_STREAMEDVEC3,  "StreamedVec3",  vec3)
 DECLARE_STREAMED_CLASS(NGL_NODE_STREAMEDVEC4,  "StreamedVec4",  vec4)
 DECLARE_STREAMED_CLASS(NGL_NODE_STREAMEDMAT4,  "StreamedMat4",  mat4)
+
+static int streamedfile_update(struct ngl_node *node, double t)
+{
+    struct variable_priv *s = node->priv_data;
+
+    int64_t t64;
+    int ret = get_stream_time(node, t, &t64);
+    if (ret < 0)
+        return ret;
+
+    /* The next timestamp of the timeline is not known ahead */
+    restrict_next_change(node, t, -1);
+
+    uint8_t prev[sizeof(s->matrix)];
+    memcpy(prev, s->data, s->data_size);
+    ret = ngli_timeline_get(&s->timeline, t64, s->data);
+    if (ret < 0)
+        return ret;
+    return memcmp(prev, s->data, s->data_size) != 0;
+}
+
+static int streamedfile_init(struct ngl_node *node)
+{
+    struct variable_priv *s = node->priv_data;
+
+    if (!s->timebase[1]) {
+        LOG(ERROR, "invalid timebase: %d/%d", s->timebase[0], s->timebase[1]);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    return ngli_timeline_init(&s->timeline, s->filename, s->data_size);
+}
+
+static void streamedfile_uninit(struct ngl_node *node)
+{
+    struct variable_priv *s = node->priv_data;
+    ngli_timeline_reset(&s->timeline);
+}
+
+#define DECLARE_STREAMEDFILE_INIT(suffix, class_data, class_data_size, class_data_type) \
+static int streamedfile##suffix##_init(struct ngl_node *node)                           \
+{                                                                                       \
+    struct variable_priv *s = node->priv_data;                                          \
+    s->data = class_data;                                                               \
+    s->data_size = class_data_size;                                                     \
+    s->data_type = class_data_type;                                                     \
+    s->dynamic = 1;                                                                     \
+    return streamedfile_init(node);                                                     \
+}                                                                                       \
+
+DECLARE_STREAMEDFILE_INIT(int,   &s->ival,   sizeof(s->ival),        NGLI_TYPE_INT)
+DECLARE_STREAMEDFILE_INIT(float, &s->scalar, sizeof(s->scalar),      NGLI_TYPE_FLOAT)
+DECLARE_STREAMEDFILE_INIT(vec2,  s->vector,  2 * sizeof(*s->vector), NGLI_TYPE_VEC2)
+DECLARE_STREAMEDFILE_INIT(vec3,  s->vector,  3 * sizeof(*s->vector), NGLI_TYPE_VEC3)
+DECLARE_STREAMEDFILE_INIT(vec4,  s->vector,  4 * sizeof(*s->vector), NGLI_TYPE_VEC4)
+DECLARE_STREAMEDFILE_INIT(mat4,  s->matrix,  sizeof(s->matrix),      NGLI_TYPE_MAT4)
+
+#define DECLARE_STREAMEDFILE_CLASS(class_id, class_name, class_suffix)      \
+const struct node_class ngli_streamedfile##class_suffix##_class = {         \
+    .id        = class_id,                                                  \
+    .category  = NGLI_NODE_CATEGORY_UNIFORM,                                \
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,                            \
+    .name      = class_name,                                                \
+    .init      = streamedfile##class_suffix##_init,                         \
+    .update    = streamedfile_update,                                       \
+    .uninit    = streamedfile_uninit,                                       \
+    .priv_size = sizeof(struct variable_priv),                              \
+    .params    = streamedfile_params,                                       \
+    .params_id = "StreamedFile",                                            \
+    .file      = __FILE__,                                                  \
+};                                                                          \
+
+DECLARE_STREAMEDFILE_CLASS(NGL_NODE_STREAMEDFILEINT,   "StreamedFileInt",   int)
+DECLARE_STREAMEDFILE_CLASS(NGL_NODE_STREAMEDFILEFLOAT, "StreamedFileFloat", float)
+DECLARE_STREAMEDFILE_CLASS(NGL_NODE_STREAMEDFILEVEC2,  "StreamedFileVec2",  vec2)
+DECLARE_STREAMEDFILE_CLASS(NGL_NODE_STREAMEDFILEVEC3,  "StreamedFileVec3",  vec3)
+DECLARE_STREAMEDFILE_CLASS(NGL_NODE_STREAMEDFILEVEC4,  "StreamedFileVec4",  vec4)
+DECLARE_STREAMEDFILE_CLASS(NGL_NODE_STREAMEDFILEMAT4,  "StreamedFileMat4",  mat4)
@@ -24,7 +24,9 @@
 
 #include "memory.h"
 #include "nodes.h"
+#include "pass.h"
 #include "drawutils.h"
+#include "fontatlas.h"
 #include "log.h"
 #include "math_utils.h"
 #include "pipeline.h"
@@ -33,6 +35,9 @@
 #include "topology.h"
 #include "utils.h"
 
+/* Maximum number of quads of a text: one per glyph and per line, plus the 4 margins */
+#define MAX_QUADS(nb_chars) (2 * (nb_chars) + 5)
+
 struct text_priv {
     char *text;
     float fg_color[4];
@@ -48,11 +53,14 @@ struct text_priv {
     int mag_filter;
     int mipmap_filter;
 
-    struct texture texture;
-    struct canvas canvas;
+    struct fontatlas *atlas;
     struct program program;
     struct buffer vertices;
     struct buffer uvcoords;
+    int max_quads;
+    float *vertices_data;
+    float *uvcoords_data;
+    int live_changed;
     struct pipeline pipeline;
 
     int modelview_matrix_index;
@@ -87,13 +95,23 @@ static const struct param_choices halign_choices = {
     }
 };
 
+static int set_live_changed(struct ngl_node *node)
+{
+    struct text_priv *s = node->priv_data;
+    s->live_changed = 1;
+    return 0;
+}
+
 #define OFFSET(x) offsetof(struct text_priv, x)
 static const struct node_param text_params[] = {
-    {"text",         PARAM_TYPE_STR, OFFSET(text), .flags=PARAM_FLAG_CONSTRUCTOR,
+    {"text",         PARAM_TYPE_STR, OFFSET(text), .flags=PARAM_FLAG_CONSTRUCTOR | PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                     .update_func=set_live_changed,
                      .desc=NGLI_DOCSTRING("text string to rasterize")},
     {"fg_color",     PARAM_TYPE_VEC4, OFFSET(fg_color), {.vec={1.0, 1.0, 1.0, 1.0}},
+                     .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
                      .desc=NGLI_DOCSTRING("foreground text color")},
     {"bg_color",     PARAM_TYPE_VEC4, OFFSET(bg_color), {.vec={0.0, 0.0, 0.0, 0.8}},
+                     .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
                      .desc=NGLI_DOCSTRING("background text color")},
     {"box_corner",   PARAM_TYPE_VEC3, OFFSET(box_corner), {.vec={-1.0, -1.0, 0.0}},
                      .desc=NGLI_DOCSTRING("origin coordinates of `box_width` and `box_height` vectors")},
@@ -115,38 +133,111 @@ static const struct node_param text_params[] = {
                      .desc=NGLI_DOCSTRING("box aspect ratio")},
     {"min_filter",   PARAM_TYPE_SELECT, OFFSET(min_filter), {.i64=NGLI_FILTER_LINEAR},
                      .choices=&ngli_filter_choices,
-                     .desc=NGLI_DOCSTRING("rasterized text texture minifying function")},
+                     .desc=NGLI_DOCSTRING("glyph atlas texture minifying function")},
     {"mag_filter",   PARAM_TYPE_SELECT, OFFSET(mag_filter), {.i64=NGLI_FILTER_NEAREST},
                      .choices=&ngli_filter_choices,
-                     .desc=NGLI_DOCSTRING("rasterized text texture magnification function")},
+                     .desc=NGLI_DOCSTRING("glyph atlas texture magnification function")},
     {"mipmap_filter", PARAM_TYPE_SELECT, OFFSET(mipmap_filter), {.i64=NGLI_MIPMAP_FILTER_LINEAR},
                       .choices=&ngli_mipmap_filter_choices,
-                      .desc=NGLI_DOCSTRING("rasterized text texture minifying mipmap function")},
+                      .desc=NGLI_DOCSTRING("glyph atlas texture minifying mipmap function")},
     {NULL}
 };
 
-static void set_canvas_dimensions(struct canvas *canvas, const char *s)
+static void get_text_dimensions(const char *s, int *nb_cols, int *nb_rows, int *nb_chars)
 {
-    canvas->w = 0;
-    canvas->h = NGLI_FONT_H;
-    int cur_w = 0;
+    int cur_cols = 0;
+    *nb_cols = 0;
+    *nb_rows = 1;
+    *nb_chars = 0;
     for (int i = 0; s[i]; i++) {
         if (s[i] == '\n') {
-            cur_w = 0;
-            canvas->h += NGLI_FONT_H;
+            cur_cols = 0;
+            (*nb_rows)++;
         } else {
-            cur_w += NGLI_FONT_W;
-            canvas->w = NGLI_MAX(canvas->w, cur_w);
+            cur_cols++;
+            (*nb_chars)++;
+            *nb_cols = NGLI_MAX(*nb_cols, cur_cols);
         }
     }
 }
 
-static int prepare_canvas(struct text_priv *s)
+struct layout {
+    int w, h;   // canvas dimensions, in font pixels, mapped to the box
+    int tx, ty; // position of the text in the canvas
+    float *vertices;
+    float *uvcoords;
+    int nb_quads;
+};
+
+/*
+ * Add the quad covering the canvas pixels [x0,x1]x[y0,y1], textured with the
+ * atlas region [u0,u1]x[v0,v1]; the part outside of the canvas is clipped
+ */
+static void add_quad(struct layout *l, const struct text_priv *s,
+                     float x0, float y0, float x1, float y1,
+                     float u0, float v0, float u1, float v1)
+{
+    const float cx0 = NGLI_MAX(x0, 0.f), cx1 = NGLI_MIN(x1, (float)l->w);
+    const float cy0 = NGLI_MAX(y0, 0.f), cy1 = NGLI_MIN(y1, (float)l->h);
+    if (cx0 >= cx1 || cy0 >= cy1)
+        return;
+
+    const float cu0 = u0 + (u1 - u0) * (cx0 - x0) / (x1 - x0);
+    const float cu1 = u0 + (u1 - u0) * (cx1 - x0) / (x1 - x0);
+    const float cv0 = v0 + (v1 - v0) * (cy0 - y0) / (y1 - y0);
+    const float cv1 = v0 + (v1 - v0) * (cy1 - y0) / (y1 - y0);
+
+    const float corners[4][4] = {
+        {cx0, cy0, cu0, cv0},
+        {cx1, cy0, cu1, cv0},
+        {cx1, cy1, cu1, cv1},
+        {cx0, cy1, cu0, cv1},
+    };
+    static const int triangles[] = {0, 1, 2, 0, 2, 3};
+
+    float *vertices = l->vertices + l->nb_quads * 6 * 3;
+    float *uvcoords = l->uvcoords + l->nb_quads * 6 * 2;
+    for (int i = 0; i < NGLI_ARRAY_NB(triangles); i++) {
+        const float *corner = corners[triangles[i]];
+        const float x = corner[0] / l->w;
+        const float y = 1.f - corner[1] / l->h;
+        for (int k = 0; k < 3; k++)
+            *vertices++ = s->box_corner[k] + s->box_width[k] * x + s->box_height[k] * y;
+        *uvcoords++ = corner[2];
+        *uvcoords++ = corner[3];
+    }
+    l->nb_quads++;
+}
+
+static void add_glyph(struct layout *l, const struct text_priv *s, int x, int y, int w, char c)
+{
+    float coords[4];
+    ngli_fontatlas_get_glyph_coords(c, coords);
+    add_quad(l, s, x, y, x + w, y + NGLI_FONT_H, coords[0], coords[1], coords[2], coords[3]);
+}
+
+static void add_background(struct layout *l, const struct text_priv *s, float x0, float y0, float x1, float y1)
+{
+    /* Any pixel of the transparent border of the first cell */
+    static const float u = 0.5f / NGLI_FONTATLAS_W, v = 0.5f / NGLI_FONTATLAS_H;
+    add_quad(l, s, x0, y0, x1, y1, u, v, u, v);
+}
+
+/*
+ * Lay the text out the same way it used to be rasterized: the text and its
+ * padding are extended to match the box aspect ratio, then scaled according
+ * to the font scale. The canvas is covered by non-overlapping quads (glyphs,
+ * end of lines, margins) so no blending or depth test issue can arise.
+ */
+static void layout_text(struct text_priv *s, struct layout *l)
 {
-    /* Set canvas dimensions according to text (and user padding settings) */
-    set_canvas_dimensions(&s->canvas, s->text);
-    s->canvas.w += 2 * s->padding;
-    s->canvas.h += 2 * s->padding;
+    int nb_cols, nb_rows, nb_chars;
+    get_text_dimensions(s->text, &nb_cols, &nb_rows, &nb_chars);
+
+    const int text_w = nb_cols * NGLI_FONT_W;
+    const int text_h = nb_rows * NGLI_FONT_H;
+    int w = text_w + 2 * s->padding;
+    int h = text_h + 2 * s->padding;
 
     /* Pad it to match container ratio */
     const float box_width_len  = ngli_vec3_length(s->box_width);
@@ -154,35 +245,65 @@ static int prepare_canvas(struct text_priv *s)
     static const int default_ar[2] = {1, 1};
     const int *ar = s->aspect_ratio[1] ? s->aspect_ratio : default_ar;
     const float box_ratio = ar[0] * box_width_len / (float)(ar[1] * box_height_len);
-    const float tex_ratio = s->canvas.w / (float)s->canvas.h;
-    const int aspect_padw = (tex_ratio < box_ratio ? s->canvas.h * box_ratio - s->canvas.w : 0);
-    const int aspect_padh = (tex_ratio < box_ratio ? 0 : s->canvas.w / box_ratio - s->canvas.h);
+    const float tex_ratio = w / (float)h;
+    const int aspect_padw = (tex_ratio < box_ratio ? h * box_ratio - w : 0);
+    const int aspect_padh = (tex_ratio < box_ratio ? 0 : w / box_ratio - h);
 
     /* Adjust canvas size to impact text size */
-    const int texw = (s->canvas.w + aspect_padw) / s->font_scale;
-    const int texh = (s->canvas.h + aspect_padh) / s->font_scale;
-    const int padw = texw - s->canvas.w;
-    const int padh = texh - s->canvas.h;
-    s->canvas.w = NGLI_MAX(1, texw);
-    s->canvas.h = NGLI_MAX(1, texh);
+    const int texw = (w + aspect_padw) / s->font_scale;
+    const int texh = (h + aspect_padh) / s->font_scale;
+    const int padw = texw - w;
+    const int padh = texh - h;
+    l->w = NGLI_MAX(1, texw);
+    l->h = NGLI_MAX(1, texh);
 
     /* Adjust text position according to alignment settings */
-    const int tx = (s->halign == HALIGN_CENTER ? padw / 2 :
-                    s->halign == HALIGN_RIGHT  ? padw     :
-                    0) + s->padding;
-    const int ty = (s->valign == VALIGN_CENTER ? padh / 2 :
-                    s->valign == VALIGN_BOTTOM ? padh     :
-                    0) + s->padding;
-
-    /* Allocate, draw background, print text */
-    s->canvas.buf = ngli_calloc(s->canvas.w * s->canvas.h, sizeof(*s->canvas.buf) * 4);
-    if (!s->canvas.buf)
+    l->tx = (s->halign == HALIGN_CENTER ? padw / 2 :
+             s->halign == HALIGN_RIGHT  ? padw     :
+             0) + s->padding;
+    l->ty = (s->valign == VALIGN_CENTER ? padh / 2 :
+             s->valign == VALIGN_BOTTOM ? padh     :
+             0) + s->padding;
+
+    /* Margins */
+    const int tx = l->tx, ty = l->ty;
+    add_background(l, s, 0, 0, l->w, ty);
+    add_background(l, s, 0, ty + text_h, l->w, l->h);
+    add_background(l, s, 0, ty, tx, ty + text_h);
+    add_background(l, s, tx + text_w, ty, l->w, ty + text_h);
+
+    /* Glyphs, and background of the end of the shorter lines */
+    int x = tx, y = ty;
+    for (int i = 0; ; i++) {
+        const char c = s->text[i];
+        if (!c || c == '\n') {
+            add_background(l, s, x, y, tx + text_w, y + NGLI_FONT_H);
+            if (!c)
+                break;
+            x = tx;
+            y += NGLI_FONT_H;
+            continue;
+        }
+        add_glyph(l, s, x, y, NGLI_FONT_W, c);
+        x += NGLI_FONT_W;
+    }
+}
+
+static int alloc_quads(struct text_priv *s, int max_quads)
+{
+    float *vertices = ngli_realloc_tagged(s->vertices_data, max_quads * 6 * 3 * sizeof(*vertices),
+                                          NGLI_MEMTAG_DRAWING);
+    if (!vertices)
         return NGL_ERROR_MEMORY;
-    const uint32_t fg = NGLI_COLOR_VEC4_TO_U32(s->fg_color);
-    const uint32_t bg = NGLI_COLOR_VEC4_TO_U32(s->bg_color);
-    struct rect rect = {.w = s->canvas.w, .h = s->canvas.h};
-    ngli_drawutils_draw_rect(&s->canvas, &rect, bg);
-    ngli_drawutils_print(&s->canvas, tx, ty, s->text, fg);
+    s->vertices_data = vertices;
+
+    float *uvcoords = ngli_realloc_tagged(s->uvcoords_data, max_quads * 6 * 2 * sizeof(*uvcoords),
+                                          NGLI_MEMTAG_DRAWING);
+    if (!uvcoords)
+        return NGL_ERROR_MEMORY;
+    s->uvcoords_data = uvcoords;
+
+    s->max_quads = max_quads;
     return 0;
 }
 
@@ -204,76 +325,42 @@ static const char * const fragment_data =
     "#version 100"                                                          "\n"
     "precision highp float;"                                                "\n"
     "uniform sampler2D tex;"                                                "\n"
+    "uniform vec4 fg_color;"                                                "\n"
+    "uniform vec4 bg_color;"                                                "\n"
     "varying vec2 var_tex_coord;"                                           "\n"
     "void main(void)"                                                       "\n"
     "{"                                                                     "\n"
-    "    gl_FragColor = texture2D(tex, var_tex_coord);"                     "\n"
+    "    float a = texture2D(tex, var_tex_coord).a;"                        "\n"
+    "    gl_FragColor = mix(bg_color, fg_color, a);"                        "\n"
     "}";
 
-#define C(index) s->box_corner[index]
-#define W(index) s->box_width[index]
-#define H(index) s->box_height[index]
-
-static int text_init(struct ngl_node *node)
+static int init_pipeline(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct text_priv *s = node->priv_data;
 
-    int ret = prepare_canvas(s);
-    if (ret < 0)
-        return ret;
-
-    const float vertices[] = {
-        C(0),               C(1),               C(2),
-        C(0) + W(0),        C(1) + W(1),        C(2) + W(2),
-        C(0) + H(0) + W(0), C(1) + H(1) + W(1), C(2) + H(2) + W(2),
-        C(0) + H(0),        C(1) + H(1),        C(2) + H(2),
-    };
-
-    static const float uvs[] = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 0.0};
-
-    ret = ngli_program_init(&s->program, ctx, vertex_data, fragment_data, NULL);
-    if (ret < 0)
-        return ret;
-
-    ret = ngli_buffer_init(&s->vertices, ctx, sizeof(vertices), NGLI_BUFFER_USAGE_STATIC);
-    if (ret < 0)
-        return ret;
-
-    ret = ngli_buffer_upload(&s->vertices, vertices, sizeof(vertices));
-    if (ret < 0)
-        return ret;
-
-    ret = ngli_buffer_init(&s->uvcoords, ctx, sizeof(uvs), NGLI_BUFFER_USAGE_STATIC);
-    if (ret < 0)
-        return ret;
-
-    ret = ngli_buffer_upload(&s->uvcoords, uvs, sizeof(uvs));
-    if (ret < 0)
-        return ret;
+    ngli_pipeline_reset(&s->pipeline);
+    ngli_buffer_reset(&s->vertices);
+    ngli_buffer_reset(&s->uvcoords);
 
-    struct texture_params tex_params = NGLI_TEXTURE_PARAM_DEFAULTS;
-    tex_params.width = s->canvas.w;
-    tex_params.height = s->canvas.h;
-    tex_params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
-    tex_params.min_filter = s->min_filter;
-    tex_params.mag_filter = s->mag_filter;
-    tex_params.mipmap_filter = s->mipmap_filter;
-    ret = ngli_texture_init(&s->texture, ctx, &tex_params);
+    int ret = ngli_buffer_init(&s->vertices, ctx, s->max_quads * 6 * 3 * sizeof(float), NGLI_BUFFER_USAGE_DYNAMIC);
     if (ret < 0)
         return ret;
 
-    ret = ngli_texture_upload(&s->texture, s->canvas.buf, 0);
+    ret = ngli_buffer_init(&s->uvcoords, ctx, s->max_quads * 6 * 2 * sizeof(float), NGLI_BUFFER_USAGE_DYNAMIC);
     if (ret < 0)
         return ret;
 
+    /* The colors are read back at every draw so they can be live changed */
     const struct pipeline_uniform uniforms[] = {
         {.name = "modelview_matrix",  .type = NGLI_TYPE_MAT4, .count = 1, .data = NULL},
         {.name = "projection_matrix", .type = NGLI_TYPE_MAT4, .count = 1, .data = NULL},
+        {.name = "fg_color",          .type = NGLI_TYPE_VEC4, .count = 1, .data = s->fg_color},
+        {.name = "bg_color",          .type = NGLI_TYPE_VEC4, .count = 1, .data = s->bg_color},
     };
 
     const struct pipeline_texture textures[] = {
-        {.name  = "tex", .texture = &s->texture},
+        {.name  = "tex", .texture = &s->atlas->texture},
     };
 
     const struct pipeline_attribute attributes[] = {
@@ -291,8 +378,8 @@ static int text_init(struct ngl_node *node)
         .attributes    = attributes,
         .nb_attributes = NGLI_ARRAY_NB(attributes),
         .graphics      = {
-            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN,
-            .nb_vertices = 4,
+            .topology    = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            .nb_vertices = 0,
         }
     };
 
@@ -306,15 +393,88 @@ static int text_init(struct ngl_node *node)
     return 0;
 }
 
+/*
+ * Only the glyph quads are uploaded when the text changes; the buffers (and
+ * thus the pipeline) are only reallocated when the text gets longer than any
+ * of the previous ones
+ */
+static int upload_text(struct ngl_node *node)
+{
+    struct text_priv *s = node->priv_data;
+
+    const int max_quads = MAX_QUADS(strlen(s->text));
+    if (max_quads > s->max_quads) {
+        int ret = alloc_quads(s, max_quads);
+        if (ret < 0)
+            return ret;
+        ret = init_pipeline(node);
+        if (ret < 0)
+            return ret;
+    }
+
+    struct layout layout = {
+        .vertices = s->vertices_data,
+        .uvcoords = s->uvcoords_data,
+    };
+    layout_text(s, &layout);
+
+    const int nb_vertices = layout.nb_quads * 6;
+    if (nb_vertices) {
+        int ret = ngli_buffer_upload(&s->vertices, s->vertices_data, nb_vertices * 3 * sizeof(float));
+        if (ret < 0)
+            return ret;
+        ret = ngli_buffer_upload(&s->uvcoords, s->uvcoords_data, nb_vertices * 2 * sizeof(float));
+        if (ret < 0)
+            return ret;
+    }
+    s->pipeline.graphics.nb_vertices = nb_vertices;
+    s->live_changed = 0;
+
+    return 0;
+}
+
+static int text_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct text_priv *s = node->priv_data;
+
+    int ret = ngli_fontatlas_acquire(ctx, s->min_filter, s->mag_filter, s->mipmap_filter, &s->atlas);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_program_init(&s->program, ctx, vertex_data, fragment_data, NULL);
+    if (ret < 0)
+        return ret;
+
+    return upload_text(node);
+}
+
+static int text_update(struct ngl_node *node, double t)
+{
+    struct text_priv *s = node->priv_data;
+    return s->live_changed ? upload_text(node) : 0;
+}
+
 static void text_draw(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct text_priv *s = node->priv_data;
 
-    const float *modelview_matrix  = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    if (!s->pipeline.graphics.nb_vertices)
+        return;
+
+    /*
+     * The text is not part of the draw lists so the pending draws go first;
+     * it is also accounted as a draw missing from the list so a frozen Group
+     * does not replay its children without it
+     */
+    ngli_pass_flush_draw_list(ctx);
+    ctx->nb_pass_execs++;
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
     const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
 
-    ngli_pipeline_update_uniform(&s->pipeline, s->modelview_matrix_index, modelview_matrix);
+    ngli_pipeline_update_uniform(&s->pipeline, s->modelview_matrix_index, modelview->matrix);
     ngli_pipeline_update_uniform(&s->pipeline, s->projection_matrix_index, projection_matrix);
 
     ngli_pipeline_exec(&s->pipeline);
@@ -324,17 +484,23 @@ static void text_uninit(struct ngl_node *node)
 {
     struct text_priv *s = node->priv_data;
     ngli_pipeline_reset(&s->pipeline);
-    ngli_texture_reset(&s->texture);
     ngli_buffer_reset(&s->vertices);
     ngli_buffer_reset(&s->uvcoords);
     ngli_program_reset(&s->program);
-    ngli_free(s->canvas.buf);
+    ngli_fontatlas_release(node->ctx, &s->atlas);
+    ngli_free_tagged(s->vertices_data);
+    ngli_free_tagged(s->uvcoords_data);
+    s->vertices_data = NULL;
+    s->uvcoords_data = NULL;
+    s->max_quads = 0;
 }
 
 const struct node_class ngli_text_class = {
     .id        = NGL_NODE_TEXT,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "Text",
     .init      = text_init,
+    .update    = text_update,
     .draw      = text_draw,
     .uninit    = text_uninit,
     .priv_size = sizeof(struct text_priv),
@@ -25,13 +25,18 @@
 #include <sxplayer.h>
 
 #include "format.h"
+#include "glcontext.h"
 #include "glincludes.h"
+#include "hwconv.h"
 #include "hwupload.h"
+#include "ktx.h"
 #include "log.h"
 #include "math_utils.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "texture.h"
+#include "tracemarker.h"
 
 const struct param_choices ngli_mipmap_filter_choices = {
     .name = "mipmap_filter",
@@ -43,6 +48,15 @@ const struct param_choices ngli_mipmap_filter_choices = {
     }
 };
 
+static const struct param_choices mipmap_generation_choices = {
+    .name = "mipmap_generation",
+    .consts = {
+        {"driver", NGLI_MIPMAP_GENERATION_DRIVER, .desc=NGLI_DOCSTRING("let the driver generate the mipmaps")},
+        {"blit",   NGLI_MIPMAP_GENERATION_BLIT,   .desc=NGLI_DOCSTRING("downsample each level with a linear blit")},
+        {NULL}
+    }
+};
+
 const struct param_choices ngli_filter_choices = {
     .name = "filter",
     .consts = {
@@ -180,6 +194,7 @@ static const struct param_choices format_choices = {
 
 
 #define DATA_SRC_TYPES_LIST_2D (const int[]){NGL_NODE_MEDIA,                   \
+                                             NGL_NODE_CAPTUREDEVICE,           \
                                              NGL_NODE_HUD,                     \
                                              BUFFER_NODES                      \
                                              -1}
@@ -203,6 +218,9 @@ static const struct node_param texture2d_params[] = {
     {"mipmap_filter", PARAM_TYPE_SELECT, OFFSET(params.mipmap_filter), {.i64=NGLI_MIPMAP_FILTER_NONE},
                       .choices=&ngli_mipmap_filter_choices,
                       .desc=NGLI_DOCSTRING("texture minifying mipmap function")},
+    {"mipmap_generation", PARAM_TYPE_SELECT, OFFSET(params.mipmap_generation), {.i64=NGLI_MIPMAP_GENERATION_DRIVER},
+                          .choices=&mipmap_generation_choices,
+                          .desc=NGLI_DOCSTRING("mipmap generation method used when the texture is rendered to")},
     {"wrap_s", PARAM_TYPE_SELECT, OFFSET(params.wrap_s), {.i64=NGLI_WRAP_CLAMP_TO_EDGE}, .choices=&wrap_choices,
                .desc=NGLI_DOCSTRING("wrap parameter for the texture on the s dimension (horizontal)")},
     {"wrap_t", PARAM_TYPE_SELECT, OFFSET(params.wrap_t), {.i64=NGLI_WRAP_CLAMP_TO_EDGE}, .choices=&wrap_choices,
@@ -210,7 +228,8 @@ static const struct node_param texture2d_params[] = {
     {"access", PARAM_TYPE_FLAGS, OFFSET(params.access), {.i64=NGLI_ACCESS_READ_WRITE}, .choices=&access_choices,
                .desc=NGLI_DOCSTRING("texture access (only honored by the `Compute` node)")},
     {"data_src", PARAM_TYPE_NODE, OFFSET(data_src), .node_types=DATA_SRC_TYPES_LIST_2D,
-                 .desc=NGLI_DOCSTRING("data source")},
+                 .desc=NGLI_DOCSTRING("data source, a `BufferUByte` holding a KTX or KTX2 file sets the "
+                                      "(possibly compressed) format, dimensions and mipmap levels")},
     {"direct_rendering", PARAM_TYPE_BOOL, OFFSET(direct_rendering), {.i64=1},
                          .desc=NGLI_DOCSTRING("whether direct rendering is allowed or not for media playback")},
     {NULL}
@@ -257,6 +276,9 @@ static const struct node_param texturecube_params[] = {
     {"mipmap_filter", PARAM_TYPE_SELECT, OFFSET(params.mipmap_filter), {.i64=NGLI_MIPMAP_FILTER_NONE},
                       .choices=&ngli_mipmap_filter_choices,
                       .desc=NGLI_DOCSTRING("texture minifying mipmap function")},
+    {"mipmap_generation", PARAM_TYPE_SELECT, OFFSET(params.mipmap_generation), {.i64=NGLI_MIPMAP_GENERATION_DRIVER},
+                          .choices=&mipmap_generation_choices,
+                          .desc=NGLI_DOCSTRING("mipmap generation method used when the texture is rendered to")},
     {"wrap_s", PARAM_TYPE_SELECT, OFFSET(params.wrap_s), {.i64=NGLI_WRAP_CLAMP_TO_EDGE}, .choices=&wrap_choices,
                .desc=NGLI_DOCSTRING("wrap parameter for the texture on the s dimension (horizontal)")},
     {"wrap_t", PARAM_TYPE_SELECT, OFFSET(params.wrap_t), {.i64=NGLI_WRAP_CLAMP_TO_EDGE}, .choices=&wrap_choices,
@@ -270,10 +292,137 @@ static const struct node_param texturecube_params[] = {
     {NULL}
 };
 
+static int texture_prefetch_ktx(struct ngl_node *node, const struct buffer_priv *buffer)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct texture_params *params = &s->params;
+
+    struct ktx ktx;
+    int ret = ngli_ktx_parse(&ktx, buffer->data, buffer->data_size);
+    if (ret < 0)
+        return ret;
+
+    params->format = ktx.format;
+    params->width = ktx.width;
+    params->height = ktx.height;
+    params->mipmap_levels = ktx.nb_levels;
+
+    ret = ngli_texture_init(&s->texture, ctx, params);
+    if (ret < 0)
+        return ret;
+
+    if (ngli_format_is_compressed(ktx.format)) {
+        for (int i = 0; i < ktx.nb_levels; i++) {
+            const struct ktx_level *level = &ktx.levels[i];
+            ret = ngli_texture_upload_compressed(&s->texture, i, level->data, level->size);
+            if (ret < 0)
+                return ret;
+        }
+    } else {
+        ret = ngli_texture_upload(&s->texture, ktx.levels[0].data, 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+
+    return 0;
+}
+
+/*
+ * A buffer referencing a block field can be written by a compute: the
+ * texture is then copied from the block buffer on the GPU, at the first draw
+ * sampling it after each write, instead of being uploaded from the CPU data
+ */
+static int texture_prefetch_block_field(struct ngl_node *node, const struct buffer_priv *buffer)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct texture_params *params = &s->params;
+    const struct block_priv *block = buffer->block->priv_data;
+    const struct block_field_info *fi = &block->field_info[buffer->block_field];
+
+    params->format = buffer->data_format;
+    const int bytes_per_pixel = ngli_format_get_bytes_per_pixel(params->format);
+    if (fi->stride != bytes_per_pixel) {
+        LOG(ERROR, "the block field elements (%d bytes apart) are not packed as "
+            "the texels (%d bytes), a std430 layout may be required",
+            fi->stride, bytes_per_pixel);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    int ret = ngli_node_buffer_ref(s->data_src);
+    if (ret < 0)
+        return ret;
+    s->block_src = 1;
+
+    ret = ngli_texture_init(&s->texture, ctx, params);
+    if (ret < 0)
+        return ret;
+
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+
+    s->block_copy_gen = -1;
+    return 0;
+}
+
+void ngli_node_texture_copy_block_field(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+
+    if (!s->block_src)
+        return;
+
+    const struct buffer_priv *buffer = s->data_src->priv_data;
+    const struct block_priv *block = buffer->block->priv_data;
+    if (s->block_copy_gen >= ctx->compute_write_gen &&
+        s->block_upload_time == block->buffer_last_upload_time)
+        return;
+
+    const struct block_field_info *fi = &block->field_info[buffer->block_field];
+    ngli_texture_upload_from_buffer(&s->texture, block->buffer.id, block->buffer.offset + fi->offset, 0);
+    s->block_upload_time = block->buffer_last_upload_time;
+    s->block_copy_gen = s->write_gen = ++ctx->gpu_write_gen;
+}
+
+static int texture_prefetch_still(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct texture_params *params = &s->params;
+    const struct media_priv *media = s->data_src->priv_data;
+    const struct imagecache_image *image = &media->still_entry->image;
+
+    struct texture *texture = NULL;
+    int ret = ngli_node_media_ref_still_texture(s->data_src, params, &texture);
+    if (ret < 0)
+        return ret;
+
+    params->format = image->format;
+    params->width = image->width;
+    params->height = image->height;
+
+    if (texture) {
+        s->still_texture_ref = 1;
+        ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, texture);
+        return 0;
+    }
+
+    ret = ngli_texture_init(&s->texture, ctx, params);
+    if (ret < 0)
+        return ret;
+    ret = ngli_texture_upload(&s->texture, image->data, 0);
+    if (ret < 0)
+        return ret;
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+    return 0;
+}
+
 static int texture_prefetch(struct ngl_node *node, int dimensions, int cubemap)
 {
     struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct texture_priv *s = node->priv_data;
     struct texture_params *params = &s->params;
 
@@ -284,22 +433,21 @@ static int texture_prefetch(struct ngl_node *node, int dimensions, int cubemap)
         params->cubemap = 1;
     }
 
-    if (gl->features & NGLI_FEATURE_TEXTURE_STORAGE)
-        params->immutable = 1;
-
     const uint8_t *data = NULL;
+    int packable = 0;
+    int deferrable = 0;
 
     if (s->data_src) {
         switch (s->data_src->class->id) {
-        case NGL_NODE_HUD: {
-            struct texture_priv *s = node->priv_data;
-            struct hud_priv *hud = s->data_src->priv_data;
+        case NGL_NODE_HUD:
             params->format = NGLI_FORMAT_R8G8B8A8_UNORM;
-            params->width = hud->canvas.w;
-            params->height = hud->canvas.h;
+            ngli_node_hud_get_dimensions(s->data_src, &params->width, &params->height);
             break;
+        case NGL_NODE_MEDIA: {
+            const struct media_priv *media = s->data_src->priv_data;
+            return media->still ? texture_prefetch_still(node) : 0;
         }
-        case NGL_NODE_MEDIA:
+        case NGL_NODE_CAPTUREDEVICE:
             return 0;
         case NGL_NODE_ANIMATEDBUFFERFLOAT:
         case NGL_NODE_ANIMATEDBUFFERVEC2:
@@ -335,6 +483,20 @@ static int texture_prefetch(struct ngl_node *node, int dimensions, int cubemap)
         case NGL_NODE_BUFFERVEC4: {
             struct buffer_priv *buffer = s->data_src->priv_data;
 
+            if (buffer->gpu_interpolation) {
+                LOG(ERROR, "buffer interpolated on the GPU can not be used as a texture data source");
+                return NGL_ERROR_INVALID_USAGE;
+            }
+
+            if (buffer->gpu_only) {
+                LOG(ERROR, "GPU-only buffer can not be used as a texture data source");
+                return NGL_ERROR_INVALID_USAGE;
+            }
+
+            if (params->dimensions == 2 && s->data_src->class->id == NGL_NODE_BUFFERUBYTE && !buffer->block &&
+                ngli_ktx_probe(buffer->data, buffer->data_size))
+                return texture_prefetch_ktx(node, buffer);
+
             if (params->dimensions == 2) {
                 if (buffer->count != params->width * params->height) {
                     LOG(ERROR, "dimensions (%dx%d) do not match buffer count (%d),"
@@ -352,8 +514,14 @@ static int texture_prefetch(struct ngl_node *node, int dimensions, int cubemap)
                     params->height = params->depth = 1;
                 }
             }
+            if (buffer->block)
+                return texture_prefetch_block_field(node, buffer);
+
             data = buffer->data;
             params->format = buffer->data_format;
+            /* The dynamic buffers are uploaded again at every update */
+            packable = s->packable && !buffer->dynamic;
+            deferrable = params->dimensions == 2 && !buffer->dynamic;
             break;
         }
         default:
@@ -361,47 +529,205 @@ static int texture_prefetch(struct ngl_node *node, int dimensions, int cubemap)
         }
     }
 
-    int ret = ngli_texture_init(&s->texture, ctx, params);
-    if (ret < 0)
-        return ret;
+    if (packable) {
+        int ret = ngli_textureatlas_add(&ctx->texture_atlas, params, data, &s->atlas_region);
+        if (ret < 0)
+            return ret;
+        if (s->atlas_region.page) {
+            ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->atlas_region.page->texture);
+            ngli_textureatlas_get_coordinates_matrix(&s->atlas_region, s->image.coordinates_matrix);
+            return 0;
+        }
+    }
+
+    /* The format picked by a RenderToTexture is not a user parameter */
+    struct texture_params texture_params = *params;
+    if (s->rtt_format != NGLI_FORMAT_UNDEFINED)
+        texture_params.format = s->rtt_format;
 
-    ret = ngli_texture_upload(&s->texture, data, 0);
+    int ret = ngli_texture_init(&s->texture, ctx, &texture_params);
     if (ret < 0)
         return ret;
 
+    if (deferrable) {
+        const int64_t size = ngli_format_get_image_size(params->format, params->width, params->height);
+        ret = ngli_node_defer_upload(node, size);
+        if (ret < 0)
+            return ret;
+        s->upload_row = 0;
+    }
+
+    if (!ret) {
+        ret = ngli_texture_upload(&s->texture, data, 0);
+        if (ret < 0)
+            return ret;
+    }
+
     ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
 
     return 0;
 }
 
+/* The rows of the buffer data are uploaded in order, at least one per call */
+static int64_t texture_upload(struct ngl_node *node, int64_t max_size)
+{
+    struct texture_priv *s = node->priv_data;
+    const struct texture_params *params = &s->params;
+    const struct buffer_priv *buffer = s->data_src->priv_data;
+
+    const int64_t row_size = ngli_format_get_image_size(params->format, params->width, 1);
+    const int nb_rows_left = params->height - s->upload_row;
+    const int nb_rows = (int)NGLI_MIN(NGLI_MAX(max_size / row_size, 1), nb_rows_left);
+    int ret = ngli_texture_upload_rows(&s->texture, buffer->data, 0, s->upload_row, nb_rows);
+    if (ret < 0)
+        return ret;
+    s->upload_row += nb_rows;
+
+    return (params->height - s->upload_row) * row_size;
+}
+
+static void texture_set_label(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    ngli_glcontext_set_object_label(ctx->glcontext, GL_TEXTURE, s->texture.id, node->label);
+}
+
 #define TEXTURE_PREFETCH(name, dim, cubemap)                \
 static int texture##name##_prefetch(struct ngl_node *node)  \
 {                                                           \
-    return texture_prefetch(node, dim, cubemap);            \
+    int ret = texture_prefetch(node, dim, cubemap);         \
+    if (ret < 0)                                            \
+        return ret;                                         \
+    texture_set_label(node);                                \
+    return 0;                                               \
 }
 
 TEXTURE_PREFETCH(2d,   2, 0)
 TEXTURE_PREFETCH(3d,   3, 0)
 TEXTURE_PREFETCH(cube, 3, 1)
 
-static void handle_hud_frame(struct ngl_node *node)
+static int handle_hud_frame(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct texture_priv *s = node->priv_data;
-    struct texture_params *params = &s->params;
-    struct hud_priv *hud = s->data_src->priv_data;
-    const uint8_t *data = hud->canvas.buf;
 
-    params->width = hud->canvas.w;
-    params->height = hud->canvas.h;
+    /* The widgets are rendered directly into the texture */
+    int force = 0;
+    if (!s->hud_rt) {
+        s->hud_rt = ngli_calloc(1, sizeof(*s->hud_rt));
+        if (!s->hud_rt)
+            return NGL_ERROR_MEMORY;
+
+        const struct texture *attachments[] = {&s->texture};
+        struct rendertarget_params rt_params = {
+            .width = s->params.width,
+            .height = s->params.height,
+            .nb_attachments = NGLI_ARRAY_NB(attachments),
+            .attachments = attachments,
+        };
+        int ret = ngli_rendertarget_init(s->hud_rt, ctx, &rt_params);
+        if (ret < 0) {
+            ngli_free(s->hud_rt);
+            s->hud_rt = NULL;
+            return ret;
+        }
+
+        /* The texture content is undefined until the first rendering */
+        force = 1;
+    }
+
+    if (ngli_node_hud_render(s->data_src, s->hud_rt, force) && ngli_texture_has_mipmap(&s->texture))
+        ngli_texture_generate_mipmap(&s->texture);
 
-    ngli_texture_upload(&s->texture, data, 0);
+    return 0;
 }
 
 static void handle_media_frame(struct ngl_node *node)
 {
+    struct texture_priv *s = node->priv_data;
+    struct media_priv *media = s->data_src->priv_data;
+
+    /* The image of a still media is set at prefetch */
+    if (media->still)
+        return;
+
+    /* The frame to display is served from the media frame cache */
+    struct media_cache_entry *entry = media->cache_current;
+    if (!media->frame && entry) {
+        ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &entry->texture);
+        s->image.ts = entry->ts;
+        return;
+    }
+
+    NGLI_TRACEMARKER_BEGIN(upload, "ngl hwupload");
     int ret = ngli_hwupload_upload_frame(node);
-    if (ret < 0)
+    NGLI_TRACEMARKER_END(upload);
+    if (ret < 0) {
         LOG(ERROR, "could not map media frame");
+        return;
+    }
+
+    const struct hwmap_class *hwmap_class = s->hwupload_map_class;
+    if (media->frame_cache && hwmap_class && (hwmap_class->flags & HWMAP_FLAG_CACHEABLE)) {
+        const double ts = s->image.ts;
+        struct texture *texture = ngli_node_media_cache_texture(s->data_src, &s->texture, ts);
+        ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, texture);
+        s->image.ts = ts;
+    }
+
+    if (media->live && media->live_displayed_time)
+        s->image.age = (ngli_gettime() - media->live_displayed_time) / 1000000.;
+}
+
+static int handle_capture_frame(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct capturedevice_priv *capture = s->data_src->priv_data;
+
+    if (!capture->planes)
+        return 0;
+
+    /* The planes imported from the capture buffers are sampled directly */
+    const int direct_rendering = (s->supported_image_layouts & (1 << NGLI_IMAGE_LAYOUT_NV12)) &&
+                                 !s->params.mipmap_filter;
+    if (direct_rendering) {
+        s->image = capture->image;
+        return 0;
+    }
+
+    if (!s->capture_hwconv) {
+        struct texture_params params = s->params;
+        params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+        params.width  = capture->width;
+        params.height = capture->height;
+
+        int ret = ngli_texture_init(&s->texture, ctx, &params);
+        if (ret < 0)
+            return ret;
+
+        s->capture_hwconv = ngli_calloc(1, sizeof(*s->capture_hwconv));
+        if (!s->capture_hwconv)
+            return NGL_ERROR_MEMORY;
+
+        ret = ngli_hwconv_init(s->capture_hwconv, ctx, &s->texture, NGLI_IMAGE_LAYOUT_NV12);
+        if (ret < 0)
+            return ret;
+
+        ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+    }
+
+    int ret = ngli_hwconv_convert(s->capture_hwconv, capture->planes, NULL);
+    if (ret < 0)
+        return ret;
+
+    if (ngli_texture_has_mipmap(&s->texture))
+        ngli_texture_generate_mipmap(&s->texture);
+
+    s->image.ts = capture->image.ts;
+
+    return 0;
 }
 
 static void handle_buffer_frame(struct ngl_node *node)
@@ -427,11 +753,18 @@ static int texture_update(struct ngl_node *node, double t)
 
     switch (s->data_src->class->id) {
         case NGL_NODE_HUD:
-            handle_hud_frame(node);
+            ret = handle_hud_frame(node);
+            if (ret < 0)
+                return ret;
             break;
         case NGL_NODE_MEDIA:
             handle_media_frame(node);
             break;
+        case NGL_NODE_CAPTUREDEVICE:
+            ret = handle_capture_frame(node);
+            if (ret < 0)
+                return ret;
+            break;
         case NGL_NODE_ANIMATEDBUFFERFLOAT:
         case NGL_NODE_ANIMATEDBUFFERVEC2:
         case NGL_NODE_ANIMATEDBUFFERVEC3:
@@ -450,15 +783,38 @@ static void texture_release(struct ngl_node *node)
 {
     struct texture_priv *s = node->priv_data;
 
+    ngli_node_cancel_upload(node);
+
     ngli_hwupload_uninit(node);
+    if (s->capture_hwconv) {
+        ngli_hwconv_reset(s->capture_hwconv);
+        ngli_free(s->capture_hwconv);
+        s->capture_hwconv = NULL;
+    }
+    if (s->hud_rt) {
+        ngli_rendertarget_reset(s->hud_rt);
+        ngli_free(s->hud_rt);
+        s->hud_rt = NULL;
+    }
+    ngli_textureatlas_remove(&node->ctx->texture_atlas, &s->atlas_region);
+    if (s->still_texture_ref) {
+        ngli_node_media_unref_still_texture(s->data_src);
+        s->still_texture_ref = 0;
+    }
+    if (s->block_src) {
+        ngli_node_buffer_unref(s->data_src);
+        s->block_src = 0;
+    }
     ngli_texture_reset(&s->texture);
     ngli_image_reset(&s->image);
 }
 
 static int texture2d_init(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct texture_priv *s = node->priv_data;
     s->supported_image_layouts = s->direct_rendering ? -1 : (1 << NGLI_IMAGE_LAYOUT_DEFAULT);
+    s->packable = ctx->config.texture_atlas;
     return 0;
 }
 
@@ -489,10 +845,12 @@ static int texturecube_init(struct ngl_node *node)
 const struct node_class ngli_texture2d_class = {
     .id        = NGL_NODE_TEXTURE2D,
     .category  = NGLI_NODE_CATEGORY_TEXTURE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "Texture2D",
     .init      = texture2d_init,
     .prefetch  = texture2d_prefetch,
     .update    = texture_update,
+    .upload    = texture_upload,
     .release   = texture_release,
     .priv_size = sizeof(struct texture_priv),
     .params    = texture2d_params,
@@ -502,6 +860,7 @@ const struct node_class ngli_texture2d_class = {
 const struct node_class ngli_texture3d_class = {
     .id        = NGL_NODE_TEXTURE3D,
     .category  = NGLI_NODE_CATEGORY_TEXTURE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "Texture3D",
     .init      = texture3d_init,
     .prefetch  = texture3d_prefetch,
@@ -515,6 +874,7 @@ const struct node_class ngli_texture3d_class = {
 const struct node_class ngli_texturecube_class = {
     .id        = NGL_NODE_TEXTURECUBE,
     .category  = NGLI_NODE_CATEGORY_TEXTURE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
     .name      = "TextureCube",
     .init      = texturecube_init,
     .prefetch  = texturecube_prefetch,
@@ -27,6 +27,8 @@
 #include "nodegl.h"
 #include "nodes.h"
 #include "params.h"
+#include "timeindex.h"
+#include "utils.h"
 
 struct timerangefilter_priv {
     struct ngl_node *child;
@@ -35,8 +37,10 @@ struct timerangefilter_priv {
     int current_range;
     double prefetch_time;
     double max_idle_time;
+    int adaptive_prefetch;
 
     int drawme;
+    int64_t idle_since;
 };
 
 #define RANGES_TYPES_LIST (const int[]){NGL_NODE_TIMERANGEMODEONCE,     \
@@ -56,6 +60,10 @@ static const struct node_param timerangefilter_params[] = {
                       .desc=NGLI_DOCSTRING("`child` is prefetched `prefetch_time` seconds in advance")},
     {"max_idle_time", PARAM_TYPE_DBL, OFFSET(max_idle_time), {.dbl=4.0},
                       .desc=NGLI_DOCSTRING("`child` will not be released if it is required in the next incoming `max_idle_time` seconds")},
+    {"adaptive_prefetch", PARAM_TYPE_BOOL, OFFSET(adaptive_prefetch), {.i64=0},
+                          .desc=NGLI_DOCSTRING("once `child` has been started, derive the prefetch advance from its measured "
+                                               "startup cost instead of `prefetch_time` (bounded by half of `max_idle_time`), "
+                                               "and delay its prefetch by a few frames if other prefetches already fill the frame")},
     {NULL}
 };
 
@@ -88,17 +96,11 @@ static int timerangefilter_init(struct ngl_node *node)
     return 0;
 }
 
-static int get_rr_id(const struct timerangefilter_priv *s, int start, double t)
+static double get_rr_time(const void *arg, int index)
 {
-    int ret = -1;
-
-    for (int i = start; i < s->nb_ranges; i++) {
-        const struct timerangemode_priv *rr = s->ranges[i]->priv_data;
-        if (rr->start_time > t)
-            break;
-        ret = i;
-    }
-    return ret;
+    struct ngl_node * const *ranges = arg;
+    const struct timerangemode_priv *rr = ranges[index]->priv_data;
+    return rr->start_time;
 }
 
 static int update_rr_state(struct timerangefilter_priv *s, double t)
@@ -106,13 +108,7 @@ static int update_rr_state(struct timerangefilter_priv *s, double t)
     if (!s->nb_ranges)
         return NGL_ERROR_INVALID_ARG;
 
-    int rr_id = get_rr_id(s, s->current_range, t);
-    if (rr_id < 0) {
-        // range not found, probably backward in time so look from the
-        // start
-        // TODO: look for rr using bsearch?
-        rr_id = get_rr_id(s, 0, t);
-    }
+    const int rr_id = ngli_timeindex_search(s->ranges, s->nb_ranges, s->current_range, t, get_rr_time);
 
     if (rr_id >= 0) {
         if (s->current_range != rr_id) {
@@ -131,6 +127,22 @@ static int update_rr_state(struct timerangefilter_priv *s, double t)
     return rr_id;
 }
 
+/*
+ * The startup of the subtree must be hidden even if it happens a few frames
+ * late (see ngli_node_schedule_prefetch()), and the decoders keep working
+ * asynchronously after it, hence the large margin over the measured cost
+ */
+#define MIN_PREFETCH_TIME 0.25
+#define PREFETCH_COST_FACTOR 8
+
+static double get_prefetch_time(const struct timerangefilter_priv *s, int64_t startup_cost)
+{
+    if (!s->adaptive_prefetch || !startup_cost)
+        return s->prefetch_time;
+    const double prefetch_time = MIN_PREFETCH_TIME + PREFETCH_COST_FACTOR * startup_cost / 1000000.;
+    return NGLI_MIN(prefetch_time, s->max_idle_time / 2.);
+}
+
 static int timerangefilter_visit(struct ngl_node *node, int is_active, double t)
 {
     struct timerangefilter_priv *s = node->priv_data;
@@ -141,40 +153,85 @@ static int timerangefilter_visit(struct ngl_node *node, int is_active, double t)
      * parent is dead, the children are likely dead as well. However, a living
      * children from a dead parent can be revealed by another living branch.
      */
+    int kept_idle = 0;
     if (is_active) {
         const int rr_id = update_rr_state(s, t);
 
         if (rr_id >= 0) {
             struct ngl_node *rr = s->ranges[rr_id];
+            const struct timerangemode_priv *cur = rr->priv_data;
 
             s->current_range = rr_id;
 
+            /*
+             * Time interval in which the decision taken below is guaranteed
+             * to be the same, allowing the visit to be skipped.
+             */
+            double start = cur->start_time;
+            double end = DBL_MAX;
+            if (rr_id < s->nb_ranges - 1) {
+                const struct timerangemode_priv *next = s->ranges[rr_id + 1]->priv_data;
+                end = next->start_time;
+            }
+
             if (rr->class->id == NGL_NODE_TIMERANGEMODENOOP) {
                 is_active = 0;
 
                 if (rr_id < s->nb_ranges - 1) {
                     // We assume here the next range requires the node started
                     // as the current one doesn't.
-                    const struct timerangemode_priv *next = s->ranges[rr_id + 1]->priv_data;
-                    const double next_use_in = next->start_time - t;
-
-                    if (next_use_in <= s->prefetch_time) {
+                    const double next_start_time = end;
+                    const double next_use_in = next_start_time - t;
+                    const int64_t startup_cost = s->adaptive_prefetch ? ngli_node_get_startup_cost(child) : 0;
+                    const double prefetch_time = get_prefetch_time(s, startup_cost);
+
+                    if (next_use_in <= prefetch_time && !child->is_active && s->adaptive_prefetch &&
+                        next_use_in > prefetch_time / 2. &&
+                        !ngli_node_schedule_prefetch(node->ctx, startup_cost)) {
+                        TRACE("prefetch of %s delayed, the frame already has its share of prefetches",
+                              child->label);
+
+                        // Try again on the next frame
+                        start = end = t;
+                    } else if (next_use_in <= prefetch_time) {
                         TRACE("next use of %s in %g (< %g), mark as active",
-                              child->label, next_use_in, s->prefetch_time);
+                              child->label, next_use_in, prefetch_time);
 
                         // The node will actually be needed soon, so we need to
                         // start it if necessary.
                         is_active = 1;
-                    } else if (next_use_in <= s->max_idle_time && child->is_active) {
-                        TRACE("%s not currently needed but will be soon %g (< %g), keep as active",
-                              child->label, next_use_in, s->max_idle_time);
-
-                        // The node will be needed in a slight amount of time;
-                        // a bit longer than a prefetch period so we don't need
-                        // to start it, but in the case where it's actually
-                        // already active it's not worth releasing it to start
-                        // it again soon after, so we keep it active.
-                        is_active = 1;
+                        start = next_start_time - prefetch_time;
+                    } else if (next_use_in <= s->max_idle_time) {
+                        start = next_start_time - s->max_idle_time;
+                        end = next_start_time - prefetch_time;
+
+                        if (child->is_active) {
+                            if (!s->idle_since)
+                                s->idle_since = ngli_gettime();
+                            int ret = ngli_node_keep_idle(node, s->idle_since);
+                            if (ret < 0)
+                                return ret;
+                            if (ret) {
+                                TRACE("%s not currently needed but will be soon %g (< %g), keep as active",
+                                      child->label, next_use_in, s->max_idle_time);
+
+                                // The node will be needed in a slight amount of time;
+                                // a bit longer than a prefetch period so we don't need
+                                // to start it, but in the case where it's actually
+                                // already active it's not worth releasing it to start
+                                // it again soon after, so we keep it active.
+                                is_active = 1;
+                                kept_idle = 1;
+
+                                // The memory budget may require releasing it
+                                // at any time, so it must be visited at every
+                                // frame
+                                if (node->ctx->config.gpu_memory_budget > 0)
+                                    start = end = t;
+                            }
+                        }
+                    } else {
+                        end = next_start_time - s->max_idle_time;
                     }
                 }
             } else if (rr->class->id == NGL_NODE_TIMERANGEMODEONCE) {
@@ -184,40 +241,88 @@ static int timerangefilter_visit(struct ngl_node *node, int is_active, double t)
                 if (!child->is_active) {
                     struct timerangemode_priv *rro = rr->priv_data;
                     rro->updated = 0;
+                    start = end = t;
                 }
             }
+
+            ngli_node_restrict_activity_bounds(node, start, end);
+        } else if (s->nb_ranges) {
+            const struct timerangemode_priv *first = s->ranges[0]->priv_data;
+            ngli_node_restrict_activity_bounds(node, -DBL_MAX, first->start_time);
         }
     }
 
-    return ngli_node_visit(child, is_active, t);
+    if (!kept_idle)
+        s->idle_since = 0;
+
+    int ret = ngli_node_visit(child, is_active, t);
+    if (ret < 0)
+        return ret;
+
+    if (is_active)
+        ngli_node_restrict_activity_bounds(node, child->activity_bounds[0],
+                                                 child->activity_bounds[1]);
+
+    return 0;
 }
 
 static int timerangefilter_update(struct ngl_node *node, double t)
 {
     struct timerangefilter_priv *s = node->priv_data;
 
+    const int prev_drawme = s->drawme;
     s->drawme = 0;
 
     const int rr_id = update_rr_state(s, t);
+    if (s->nb_ranges && rr_id + 1 < s->nb_ranges) {
+        const struct timerangemode_priv *next = s->ranges[rr_id + 1]->priv_data;
+        ngli_node_restrict_next_change(node, next->start_time);
+    }
+
+    int once = 0;
     if (rr_id >= 0) {
         struct ngl_node *rr = s->ranges[rr_id];
 
         if (rr->class->id == NGL_NODE_TIMERANGEMODENOOP)
-            return 0;
+            return prev_drawme;
 
         if (rr->class->id == NGL_NODE_TIMERANGEMODEONCE) {
             struct timerangemode_priv *rro = rr->priv_data;
             if (rro->updated)
-                return 0;
+                return prev_drawme;
             t = rro->render_time;
             rro->updated = 1;
+            once = 1;
         }
     }
 
     s->drawme = 1;
 
+    /* The child of a once range is frozen until the next range */
+    struct ngl_ctx *ctx = node->ctx;
+    const double next_change_time = ctx->next_change_time;
     struct ngl_node *child = s->child;
-    return ngli_node_update(child, t);
+    int ret = ngli_node_update(child, t);
+    if (ret < 0)
+        return ret;
+    if (once)
+        ctx->next_change_time = next_change_time;
+    return !prev_drawme;
+}
+
+int ngli_node_timerangefilter_draws_child(const struct ngl_node *node, double t)
+{
+    const struct timerangefilter_priv *s = node->priv_data;
+
+    /* Same as the update, the child is drawn before the first range */
+    const struct ngl_node *rr = NULL;
+    for (int i = 0; i < s->nb_ranges; i++) {
+        const struct timerangemode_priv *trm = s->ranges[i]->priv_data;
+        if (trm->start_time > t)
+            break;
+        rr = s->ranges[i];
+    }
+    return !rr || rr->class->id != NGL_NODE_TIMERANGEMODENOOP;
 }
 
 static void timerangefilter_draw(struct ngl_node *node)
@@ -235,6 +340,8 @@ static void timerangefilter_draw(struct ngl_node *node)
 
 const struct node_class ngli_timerangefilter_class = {
     .id        = NGL_NODE_TIMERANGEFILTER,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "TimeRangeFilter",
     .init      = timerangefilter_init,
     .visit     = timerangefilter_visit,
@@ -27,16 +27,29 @@
 #include "math_utils.h"
 #include "transforms.h"
 
+static int update_matrix(struct ngl_node *node)
+{
+    ngli_transform_invalidate(node->priv_data);
+    return 0;
+}
+
 #define OFFSET(x) offsetof(struct transform_priv, x)
 static const struct node_param transform_params[] = {
     {"child",  PARAM_TYPE_NODE, OFFSET(child), .flags=PARAM_FLAG_CONSTRUCTOR,
                .desc=NGLI_DOCSTRING("scene to apply the transform to")},
     {"matrix", PARAM_TYPE_MAT4, OFFSET(matrix), {.mat=NGLI_MAT4_IDENTITY},
                .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+               .update_func=update_matrix,
                .desc=NGLI_DOCSTRING("transformation matrix")},
     {NULL}
 };
 
+static int transform_init(struct ngl_node *node)
+{
+    ngli_transform_invalidate(node->priv_data);
+    return ngli_transform_init(node, 0);
+}
+
 static int transform_update(struct ngl_node *node, double t)
 {
     struct transform_priv *s = node->priv_data;
@@ -46,7 +59,10 @@ static int transform_update(struct ngl_node *node, double t)
 
 const struct node_class ngli_transform_class = {
     .id        = NGL_NODE_TRANSFORM,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Transform",
+    .init      = transform_init,
     .update    = transform_update,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct transform_priv),
@@ -38,6 +38,7 @@ static void update_trf_matrix(struct ngl_node *node, const float *vec)
     struct translate_priv *s = node->priv_data;
     struct transform_priv *trf = &s->trf;
     ngli_mat4_translate(trf->matrix, vec[0], vec[1], vec[2]);
+    ngli_transform_invalidate(trf);
 }
 
 static int update_vector(struct ngl_node *node)
@@ -54,9 +55,12 @@ static int update_vector(struct ngl_node *node)
 static int translate_init(struct ngl_node *node)
 {
     struct translate_priv *s = node->priv_data;
-    if (!s->anim)
+    const struct variable_priv *anim = s->anim ? s->anim->priv_data : NULL;
+    if (!anim)
         update_trf_matrix(node, s->vector);
-    return 0;
+    else if (anim->constant)
+        update_trf_matrix(node, anim->vector);
+    return ngli_transform_init(node, anim && !anim->constant);
 }
 
 static int translate_update(struct ngl_node *node, double t)
@@ -64,7 +68,7 @@ static int translate_update(struct ngl_node *node, double t)
     struct translate_priv *s = node->priv_data;
     struct transform_priv *trf = &s->trf;
     struct ngl_node *child = trf->child;
-    if (s->anim) {
+    if (trf->animated) {
         struct ngl_node *anim_node = s->anim;
         struct variable_priv *anim = anim_node->priv_data;
         int ret = ngli_node_update(anim_node, t);
@@ -94,6 +98,8 @@ NGLI_STATIC_ASSERT(trf_on_top_of_translate, OFFSET(trf) == 0);
 
 const struct node_class ngli_translate_class = {
     .id        = NGL_NODE_TRANSLATE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "Translate",
     .init      = translate_init,
     .update    = translate_update,
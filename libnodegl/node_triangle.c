@@ -87,24 +87,18 @@ static int triangle_init(struct ngl_node *node)
         return NGL_ERROR_MEMORY;
 
     s->topology = NGLI_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    ngli_node_geometry_compute_bounds(s);
 
     return 0;
 }
 
-#define NODE_UNREFP(node) do {                    \
-    if (node) {                                   \
-        ngli_node_detach_ctx(node, node->ctx);    \
-        ngl_node_unrefp(&node);                   \
-    }                                             \
-} while (0)
-
 static void triangle_uninit(struct ngl_node *node)
 {
     struct geometry_priv *s = node->priv_data;
 
-    NODE_UNREFP(s->vertices_buffer);
-    NODE_UNREFP(s->uvcoords_buffer);
-    NODE_UNREFP(s->normals_buffer);
+    ngli_node_geometry_release_buffer(&s->vertices_buffer);
+    ngli_node_geometry_release_buffer(&s->uvcoords_buffer);
+    ngli_node_geometry_release_buffer(&s->normals_buffer);
 }
 
 const struct node_class ngli_triangle_class = {
@@ -40,6 +40,10 @@ static int set_live_changed(struct ngl_node *node)
         LOG(ERROR, "updating data on a dynamic uniform is unsupported");
         return NGL_ERROR_INVALID_USAGE;
     }
+    if (s->specialized) {
+        LOG(ERROR, "updating data on a uniform specialized into a program is unsupported");
+        return NGL_ERROR_INVALID_USAGE;
+    }
     s->live_changed = 1;
     return 0;
 }
@@ -172,10 +176,11 @@ static int uniformmat4_update(struct ngl_node *node, double t)
         if (ret < 0)
             return ret;
         static const NGLI_ALIGNED_MAT(id_matrix) = NGLI_MAT4_IDENTITY;
-        if (!ngli_darray_push(&ctx->modelview_matrix_stack, id_matrix))
-            return NGL_ERROR_MEMORY;
+        ret = ngli_modelview_push(ctx, id_matrix, NGLI_MODELVIEW_VERSION_IDENTITY);
+        if (ret < 0)
+            return ret;
         ngli_node_draw(s->transform);
-        ngli_darray_pop(&ctx->modelview_matrix_stack);
+        ngli_modelview_pop(ctx);
         if (s->transform_matrix)
             memcpy(s->matrix, s->transform_matrix, sizeof(s->matrix));
     }
@@ -270,6 +275,7 @@ static int uniformmat4_init(struct ngl_node *node)
 const struct node_class ngli_uniform##type##_class = {          \
     .id        = class_id,                                      \
     .category  = NGLI_NODE_CATEGORY_UNIFORM,                    \
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,                \
     .name      = class_name,                                    \
     .init      = uniform##type##_init,                          \
     .update    = uniform##type##_update,                        \
@@ -27,6 +27,10 @@
 struct userswitch {
     struct ngl_node *child;
     int enabled;
+    int keep_resident;
+    double standby_update_interval;
+
+    double last_standby_update;
 };
 
 #define OFFSET(x) offsetof(struct userswitch, x)
@@ -37,19 +41,66 @@ static const struct node_param userswitch_params[] = {
     {"enabled", PARAM_TYPE_BOOL, OFFSET(enabled), {.i64=1},
                .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
                .desc=NGLI_DOCSTRING("set if the scene should be rendered")},
+    {"keep_resident", PARAM_TYPE_BOOL, OFFSET(keep_resident), {.i64=0},
+                      .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                      .desc=NGLI_DOCSTRING("keep the resources of the scene allocated while it is disabled, "
+                                           "so enabling it again is instant")},
+    {"standby_update_interval", PARAM_TYPE_DBL, OFFSET(standby_update_interval), {.dbl=0.0},
+                                .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+                                .desc=NGLI_DOCSTRING("if `keep_resident` is set, the disabled scene is still updated "
+                                                     "every `standby_update_interval` seconds (never if 0)")},
     {NULL}
 };
 
+static int userswitch_init(struct ngl_node *node)
+{
+    struct userswitch *s = node->priv_data;
+    s->last_standby_update = -1.;
+    return 0;
+}
+
 static int userswitch_visit(struct ngl_node *node, int is_active, double t)
 {
     struct userswitch *s = node->priv_data;
-    return ngli_node_visit(s->child, is_active && s->enabled, t);
+    struct ngl_node *child = s->child;
+
+    is_active = is_active && (s->enabled || s->keep_resident);
+    int ret = ngli_node_visit(child, is_active, t);
+    if (ret < 0)
+        return ret;
+
+    if (is_active)
+        ngli_node_restrict_activity_bounds(node, child->activity_bounds[0],
+                                                 child->activity_bounds[1]);
+
+    return 0;
 }
 
 static int userswitch_update(struct ngl_node *node, double t)
 {
     struct userswitch *s = node->priv_data;
-    return s->enabled ? ngli_node_update(s->child, t) : 0;
+
+    if (s->enabled)
+        return ngli_node_update(s->child, t);
+
+    if (!s->keep_resident || s->standby_update_interval <= 0.)
+        return 0;
+
+    /* Only a seek backward or the end of the interval trigger an update */
+    if (s->last_standby_update >= 0. && t >= s->last_standby_update &&
+        t - s->last_standby_update < s->standby_update_interval) {
+        ngli_node_restrict_next_change(node, s->last_standby_update + s->standby_update_interval);
+        return 0;
+    }
+
+    /* The disabled scene does not change before its next standby update */
+    struct ngl_ctx *ctx = node->ctx;
+    const double next_change_time = ctx->next_change_time;
+    s->last_standby_update = t;
+    int ret = ngli_node_update(s->child, t);
+    ctx->next_change_time = next_change_time;
+    ngli_node_restrict_next_change(node, t + s->standby_update_interval);
+    return ret;
 }
 
 static void userswitch_draw(struct ngl_node *node)
@@ -61,7 +112,10 @@ static void userswitch_draw(struct ngl_node *node)
 
 const struct node_class ngli_userswitch_class = {
     .id        = NGL_NODE_USERSWITCH,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES |
+                 NGLI_NODE_FLAG_DAMAGE_AWARE,
     .name      = "UserSwitch",
+    .init      = userswitch_init,
     .visit     = userswitch_visit,
     .update    = userswitch_update,
     .draw      = userswitch_draw,
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "format.h"
+#include "glcontext.h"
+#include "log.h"
+#include "math_utils.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "texture.h"
+#include "tilepyramid.h"
+#include "utils.h"
+
+struct tile_slot {
+    int level;
+    int x;
+    int y;
+};
+
+/*
+ * The physical texture is a toroidal cache of cache_size x cache_size tiles:
+ * the tile (x, y) of the current level always lives in the slot
+ * (x % cache_size, y % cache_size), so panning only pages in the tiles
+ * entering the region and the repeat wrapping maps the image coordinates to
+ * the slots.
+ */
+struct virtualtexture_priv {
+    struct texture_priv texture; /* first, as the passes see the node as a Texture2D */
+    const char *filename;
+    int width;
+    int height;
+    int tile_size;
+    int cache_size;
+    const char *pyramid_filename;
+    float region[4];
+
+    int live_changed;
+    int viewport[2];
+    struct tilepyramid pyramid;
+    struct tile_slot *slots;
+    uint8_t *tile_data;
+};
+
+static int set_live_changed(struct ngl_node *node)
+{
+    struct virtualtexture_priv *s = node->priv_data;
+    s->live_changed = 1;
+    return 0;
+}
+
+#define OFFSET(x) offsetof(struct virtualtexture_priv, x)
+static const struct node_param virtualtexture_params[] = {
+    {"min_filter", PARAM_TYPE_SELECT, OFFSET(texture.params.min_filter), {.i64=NGLI_FILTER_LINEAR},
+                   .choices=&ngli_filter_choices,
+                   .desc=NGLI_DOCSTRING("texture minifying function")},
+    {"mag_filter", PARAM_TYPE_SELECT, OFFSET(texture.params.mag_filter), {.i64=NGLI_FILTER_LINEAR},
+                   .choices=&ngli_filter_choices,
+                   .desc=NGLI_DOCSTRING("texture magnification function")},
+    {"filename", PARAM_TYPE_STR, OFFSET(filename),
+                 .desc=NGLI_DOCSTRING("raw RGBA8 pixels of the image, row by row")},
+    {"width", PARAM_TYPE_INT, OFFSET(width),
+              .desc=NGLI_DOCSTRING("width of the image")},
+    {"height", PARAM_TYPE_INT, OFFSET(height),
+               .desc=NGLI_DOCSTRING("height of the image")},
+    {"tile_size", PARAM_TYPE_INT, OFFSET(tile_size), {.i64=256},
+                  .desc=NGLI_DOCSTRING("width and height of the tiles")},
+    {"cache_size", PARAM_TYPE_INT, OFFSET(cache_size), {.i64=8},
+                   .desc=NGLI_DOCSTRING("number of tiles on each side of the physical texture")},
+    {"pyramid_filename", PARAM_TYPE_STR, OFFSET(pyramid_filename),
+                         .desc=NGLI_DOCSTRING("file holding the tiles of the mip pyramid, built from the "
+                                              "image if needed (`<filename>.pyramid` by default)")},
+    {"region", PARAM_TYPE_VEC4, OFFSET(region), {.vec={0.0f, 0.0f, 1.0f, 1.0f}},
+               .flags=PARAM_FLAG_ALLOW_LIVE_CHANGE,
+               .update_func=set_live_changed,
+               .desc=NGLI_DOCSTRING("visible part of the image (x, y, width, height in normalized "
+                                    "image coordinates), mapped to the texture coordinates and "
+                                    "displayed over the viewport")},
+    {NULL}
+};
+
+static int virtualtexture_init(struct ngl_node *node)
+{
+    struct virtualtexture_priv *s = node->priv_data;
+
+    if (!s->filename) {
+        LOG(ERROR, "filename must be set");
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (s->tile_size <= 0 || s->cache_size < 2) {
+        LOG(ERROR, "invalid tile size (%d) or cache size (%d)", s->tile_size, s->cache_size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    s->texture.supported_image_layouts = 1 << NGLI_IMAGE_LAYOUT_DEFAULT;
+    return 0;
+}
+
+static int virtualtexture_prefetch(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct virtualtexture_priv *s = node->priv_data;
+    struct texture_params *params = &s->texture.params;
+
+    char *pyramid_filename = s->pyramid_filename ? ngli_strdup(s->pyramid_filename)
+                                                 : ngli_asprintf("%s.pyramid", s->filename);
+    if (!pyramid_filename)
+        return NGL_ERROR_MEMORY;
+    int ret = ngli_tilepyramid_init(&s->pyramid, pyramid_filename, s->filename,
+                                    s->width, s->height, s->tile_size);
+    ngli_free(pyramid_filename);
+    if (ret < 0)
+        return ret;
+
+    const int nb_slots = s->cache_size * s->cache_size;
+    s->slots = ngli_calloc(nb_slots, sizeof(*s->slots));
+    s->tile_data = ngli_malloc((int64_t)s->tile_size * s->tile_size * NGLI_TILEPYRAMID_PIXEL_SIZE);
+    if (!s->slots || !s->tile_data)
+        return NGL_ERROR_MEMORY;
+    for (int i = 0; i < nb_slots; i++)
+        s->slots[i].level = -1;
+
+    params->dimensions = 2;
+    params->format = NGLI_FORMAT_R8G8B8A8_UNORM;
+    params->width = s->cache_size * s->tile_size;
+    params->height = s->cache_size * s->tile_size;
+    params->wrap_s = NGLI_WRAP_REPEAT;
+    params->wrap_t = NGLI_WRAP_REPEAT;
+    ret = ngli_texture_init(&s->texture.texture, ctx, params);
+    if (ret < 0)
+        return ret;
+    ngli_glcontext_set_object_label(ctx->glcontext, GL_TEXTURE, s->texture.texture.id, node->label);
+
+    ngli_image_init(&s->texture.image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture.texture);
+    s->live_changed = 1;
+    return 0;
+}
+
+/* Range of the tiles holding the texels sampled over [start, start+size] */
+static void get_tile_range(int level_size, int tile_size, int nb_tiles, float start, float size, int *range)
+{
+    const float pos = start * level_size;
+    const float end = (start + size) * level_size;
+    range[0] = NGLI_MAX((int)floorf((pos - 1.f) / tile_size), 0);
+    range[1] = NGLI_MIN((int)floorf((end + 1.f) / tile_size), nb_tiles - 1);
+}
+
+/*
+ * The finest level with less than 2 texels per pixel, or a coarser one if
+ * the tiles covering the region do not fit in the cache
+ */
+static int select_level(const struct virtualtexture_priv *s, const float *region, int *range_x, int *range_y)
+{
+    const struct tilepyramid *pyramid = &s->pyramid;
+    int i = 0;
+    for (; i < pyramid->nb_levels; i++) {
+        const struct tilepyramid_level *level = &pyramid->levels[i];
+        get_tile_range(level->width, s->tile_size, level->nb_tiles_x, region[0], region[2], range_x);
+        get_tile_range(level->height, s->tile_size, level->nb_tiles_y, region[1], region[3], range_y);
+        if (region[2] * level->width < 2.f * s->viewport[0] &&
+            region[3] * level->height < 2.f * s->viewport[1] &&
+            range_x[1] - range_x[0] < s->cache_size &&
+            range_y[1] - range_y[0] < s->cache_size)
+            break;
+    }
+    /* The last level fits in a single tile */
+    return NGLI_MIN(i, pyramid->nb_levels - 1);
+}
+
+static int virtualtexture_update(struct ngl_node *node, double t)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct virtualtexture_priv *s = node->priv_data;
+
+    const int viewport_width = NGLI_MAX(ctx->viewport[2], 1);
+    const int viewport_height = NGLI_MAX(ctx->viewport[3], 1);
+    if (!s->live_changed && s->viewport[0] == viewport_width && s->viewport[1] == viewport_height)
+        return 0;
+    s->live_changed = 0;
+    s->viewport[0] = viewport_width;
+    s->viewport[1] = viewport_height;
+
+    float region[4];
+    region[0] = NGLI_MIN(NGLI_MAX(s->region[0], 0.f), 1.f);
+    region[1] = NGLI_MIN(NGLI_MAX(s->region[1], 0.f), 1.f);
+    region[2] = NGLI_MIN(NGLI_MAX(s->region[2], 0.f), 1.f - region[0]);
+    region[3] = NGLI_MIN(NGLI_MAX(s->region[3], 0.f), 1.f - region[1]);
+
+    int range_x[2] = {0}, range_y[2] = {0};
+    const int level_index = select_level(s, region, range_x, range_y);
+    const struct tilepyramid_level *level = &s->pyramid.levels[level_index];
+
+    /* Only the tiles missing from the cache are paged in */
+    int changed = 0;
+    const int tile_size = s->tile_size;
+    for (int y = range_y[0]; y <= range_y[1]; y++) {
+        for (int x = range_x[0]; x <= range_x[1]; x++) {
+            const int slot_x = x % s->cache_size;
+            const int slot_y = y % s->cache_size;
+            struct tile_slot *slot = &s->slots[slot_y * s->cache_size + slot_x];
+            if (slot->level == level_index && slot->x == x && slot->y == y)
+                continue;
+            int ret = ngli_tilepyramid_read_tile(&s->pyramid, level_index, x, y, s->tile_data);
+            if (ret < 0) {
+                LOG(ERROR, "could not read the tile (%d, %d) of level %d", x, y, level_index);
+                return ret;
+            }
+            ret = ngli_texture_upload_sub_image(&s->texture.texture, s->tile_data, 0,
+                                                slot_x * tile_size, slot_y * tile_size,
+                                                tile_size, tile_size);
+            if (ret < 0)
+                return ret;
+            *slot = (struct tile_slot){.level = level_index, .x = x, .y = y};
+            changed = 1;
+        }
+    }
+
+    /* The texture coordinates [0,1] map to the region, in texels of the level */
+    const float scale_x = level->width / (float)(s->cache_size * tile_size);
+    const float scale_y = level->height / (float)(s->cache_size * tile_size);
+    NGLI_ALIGNED_MAT(matrix) = NGLI_MAT4_IDENTITY;
+    matrix[0]  = region[2] * scale_x;
+    matrix[5]  = region[3] * scale_y;
+    matrix[12] = region[0] * scale_x;
+    matrix[13] = region[1] * scale_y;
+    float *coordinates_matrix = s->texture.image.coordinates_matrix;
+    if (memcmp(coordinates_matrix, matrix, sizeof(matrix))) {
+        memcpy(coordinates_matrix, matrix, sizeof(matrix));
+        changed = 1;
+    }
+
+    return changed;
+}
+
+static void virtualtexture_release(struct ngl_node *node)
+{
+    struct virtualtexture_priv *s = node->priv_data;
+
+    ngli_tilepyramid_reset(&s->pyramid);
+    ngli_free(s->slots);
+    s->slots = NULL;
+    ngli_free(s->tile_data);
+    s->tile_data = NULL;
+    ngli_texture_reset(&s->texture.texture);
+    ngli_image_reset(&s->texture.image);
+}
+
+const struct node_class ngli_virtualtexture_class = {
+    .id        = NGL_NODE_VIRTUALTEXTURE,
+    .category  = NGLI_NODE_CATEGORY_TEXTURE,
+    .flags     = NGLI_NODE_FLAG_REPORTS_CHANGES,
+    .name      = "VirtualTexture",
+    .init      = virtualtexture_init,
+    .prefetch  = virtualtexture_prefetch,
+    .update    = virtualtexture_update,
+    .release   = virtualtexture_release,
+    .priv_size = sizeof(struct virtualtexture_priv),
+    .params    = virtualtexture_params,
+    .file      = __FILE__,
+};
@@ -33,6 +33,7 @@
                                               NODEGL_VERSION_MICRO)
 
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -106,6 +107,7 @@ struct ngl_node;
 #define NGL_NODE_ANIMKEYFRAMEVEC4       NGLI_FOURCC('A','K','F','4')
 #define NGL_NODE_ANIMKEYFRAMEQUAT       NGLI_FOURCC('A','K','F','Q')
 #define NGL_NODE_BLOCK                  NGLI_FOURCC('B','l','c','k')
+#define NGL_NODE_BLUR                   NGLI_FOURCC('B','l','u','r')
 #define NGL_NODE_BUFFERBYTE             NGLI_FOURCC('B','s','b','1')
 #define NGL_NODE_BUFFERBVEC2            NGLI_FOURCC('B','s','b','2')
 #define NGL_NODE_BUFFERBVEC3            NGLI_FOURCC('B','s','b','3')
@@ -136,7 +138,14 @@ struct ngl_node;
 #define NGL_NODE_BUFFERVEC3             NGLI_FOURCC('B','f','v','3')
 #define NGL_NODE_BUFFERVEC4             NGLI_FOURCC('B','f','v','4')
 #define NGL_NODE_BUFFERMAT4             NGLI_FOURCC('B','f','m','4')
+#define NGL_NODE_BUFFERHALF             NGLI_FOURCC('B','h','v','1')
+#define NGL_NODE_BUFFERHVEC2            NGLI_FOURCC('B','h','v','2')
+#define NGL_NODE_BUFFERHVEC3            NGLI_FOURCC('B','h','v','3')
+#define NGL_NODE_BUFFERHVEC4            NGLI_FOURCC('B','h','v','4')
+#define NGL_NODE_BUFFERPACK10           NGLI_FOURCC('B','s','p','4')
+#define NGL_NODE_BUFFERUPACK10          NGLI_FOURCC('B','u','p','4')
 #define NGL_NODE_CAMERA                 NGLI_FOURCC('C','m','r','a')
+#define NGL_NODE_CAPTUREDEVICE          NGLI_FOURCC('C','a','p','D')
 #define NGL_NODE_CIRCLE                 NGLI_FOURCC('C','r','c','l')
 #define NGL_NODE_COMPUTE                NGLI_FOURCC('C','p','t',' ')
 #define NGL_NODE_COMPUTEPROGRAM         NGLI_FOURCC('C','p','t','P')
@@ -145,7 +154,11 @@ struct ngl_node;
 #define NGL_NODE_GROUP                  NGLI_FOURCC('G','r','p',' ')
 #define NGL_NODE_HUD                    NGLI_FOURCC('H','U','D',' ')
 #define NGL_NODE_IDENTITY               NGLI_FOURCC('I','d',' ',' ')
+#define NGL_NODE_LEVELOFDETAIL          NGLI_FOURCC('L','O','D',' ')
 #define NGL_NODE_MEDIA                  NGLI_FOURCC('M','d','i','a')
+#define NGL_NODE_MESH                   NGLI_FOURCC('M','e','s','h')
+#define NGL_NODE_OCCLUSIONCULL          NGLI_FOURCC('O','c','C','l')
+#define NGL_NODE_PARTICLESYSTEM         NGLI_FOURCC('P','r','t','S')
 #define NGL_NODE_PROGRAM                NGLI_FOURCC('P','r','g','m')
 #define NGL_NODE_QUAD                   NGLI_FOURCC('Q','u','a','d')
 #define NGL_NODE_RENDER                 NGLI_FOURCC('R','n','d','r')
@@ -153,12 +166,21 @@ struct ngl_node;
 #define NGL_NODE_ROTATE                 NGLI_FOURCC('T','R','o','t')
 #define NGL_NODE_ROTATEQUAT             NGLI_FOURCC('T','R','o','Q')
 #define NGL_NODE_SCALE                  NGLI_FOURCC('T','s','c','l')
+#define NGL_NODE_SHAPE                  NGLI_FOURCC('S','h','p','e')
+#define NGL_NODE_SKIN                   NGLI_FOURCC('S','k','i','n')
+#define NGL_NODE_STEREOCAMERA           NGLI_FOURCC('S','t','C','m')
 #define NGL_NODE_STREAMEDINT            NGLI_FOURCC('S','t','i','1')
 #define NGL_NODE_STREAMEDFLOAT          NGLI_FOURCC('S','t','f','1')
 #define NGL_NODE_STREAMEDVEC2           NGLI_FOURCC('S','t','f','2')
 #define NGL_NODE_STREAMEDVEC3           NGLI_FOURCC('S','t','f','3')
 #define NGL_NODE_STREAMEDVEC4           NGLI_FOURCC('S','t','f','4')
 #define NGL_NODE_STREAMEDMAT4           NGLI_FOURCC('S','t','m','4')
+#define NGL_NODE_STREAMEDFILEINT        NGLI_FOURCC('S','F','i','1')
+#define NGL_NODE_STREAMEDFILEFLOAT      NGLI_FOURCC('S','F','f','1')
+#define NGL_NODE_STREAMEDFILEVEC2       NGLI_FOURCC('S','F','f','2')
+#define NGL_NODE_STREAMEDFILEVEC3       NGLI_FOURCC('S','F','f','3')
+#define NGL_NODE_STREAMEDFILEVEC4       NGLI_FOURCC('S','F','f','4')
+#define NGL_NODE_STREAMEDFILEMAT4       NGLI_FOURCC('S','F','m','4')
 #define NGL_NODE_TEXT                   NGLI_FOURCC('T','e','x','t')
 #define NGL_NODE_TEXTURE2D              NGLI_FOURCC('T','e','x','2')
 #define NGL_NODE_TEXTURE3D              NGLI_FOURCC('T','e','x','3')
@@ -178,6 +200,7 @@ struct ngl_node;
 #define NGL_NODE_UNIFORMVEC4            NGLI_FOURCC('U','n','f','4')
 #define NGL_NODE_UNIFORMQUAT            NGLI_FOURCC('U','n','Q','t')
 #define NGL_NODE_USERSWITCH             NGLI_FOURCC('U','S','c','h')
+#define NGL_NODE_VIRTUALTEXTURE         NGLI_FOURCC('V','T','e','x')
 
 /**
  * Return error codes.
@@ -259,6 +282,11 @@ int ngl_node_param_add(struct ngl_node *node, const char *key,
  * If the type of the parameter is node based, the reference counter of the
  * passed node will be incremented.
  *
+ * Once the node is associated with a context, the live changes of the
+ * parameters having a handle (see ngl_node_param_handle()) are queued and
+ * applied before the next draw, so they can be made from any thread (even
+ * during an asynchronous draw); the value is still checked immediately.
+ *
  * @param node      pointer to the target node
  * @param key       string identifying the parameter
  * @param ...       the value in parameter type
@@ -267,6 +295,151 @@ int ngl_node_param_add(struct ngl_node *node, const char *key,
  */
 int ngl_node_param_set(struct ngl_node *node, const char *key, ...);
 
+/**
+ * Get a handle on a live changeable parameter, to be used with
+ * ngl_params_update().
+ *
+ * The handle only depends on the type of the node, so it can be used for any
+ * node of the same type. Node, list, dict and data parameters have no handle.
+ *
+ * @param node  pointer to the target node
+ * @param key   string identifying the parameter
+ *
+ * @return a handle (>= 0) on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_param_handle(struct ngl_node *node, const char *key);
+
+/**
+ * Parameter update for ngl_params_update().
+ */
+struct ngl_param_update {
+    struct ngl_node *node;
+    int handle;             /* handle returned by ngl_node_param_handle() */
+    union {
+        int i;              /* int, bool, select and flags (integer value of the constants) */
+        int64_t i64;
+        double dbl;
+        float vec[16];      /* vec2, vec3, vec4 and mat4 */
+        int r[2];           /* rational */
+        const char *str;    /* string */
+    } value;
+};
+
+/**
+ * Make a Buffer* node use the specified memory as data instead of a copy.
+ *
+ * The memory must remain valid and must not be freed or moved until it is
+ * unwrapped, which is done by calling this function again with NULL data: the
+ * node then takes a copy of the wrapped memory. Between two draws, the memory
+ * can be modified through ngl_node_buffer_map() for the changes to be
+ * uploaded.
+ *
+ * Once the node is attached to a context, the size of the data can not be
+ * changed anymore.
+ *
+ * @param node  pointer to the target Buffer* node, which must not be defined
+ *              by a filename or a block
+ * @param size  size of the memory in bytes
+ * @param data  pointer to the memory to wrap, or NULL to unwrap
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_buffer_wrap_data(struct ngl_node *node, int size, void *data);
+
+/**
+ * Map a range of the data of a Buffer* node for writing.
+ *
+ * The written range is uploaded to the GPU at the next draw following the
+ * ngl_node_buffer_unmap() call. No draw must be in progress while the data
+ * is mapped (see ngl_draw_async() and ngl_wait()).
+ *
+ * Only the direct uses of the buffer (vertex attributes, indices and
+ * indirect draws) are updated: blocks and textures using the buffer as
+ * source keep the data they were initialized with.
+ *
+ * @param node    pointer to the target Buffer* node, which must not be
+ *                defined by a filename or a block
+ * @param offset  offset of the range in bytes
+ * @param size    size of the range in bytes
+ * @param datap   pointer to the returned address of the range
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_buffer_map(struct ngl_node *node, int offset, int size, void **datap);
+
+/**
+ * Unmap the data of a Buffer* node previously mapped with
+ * ngl_node_buffer_map(), scheduling the upload of the mapped range.
+ *
+ * @param node  pointer to the mapped Buffer* node
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_buffer_unmap(struct ngl_node *node);
+
+/**
+ * Update a range of elements of a Buffer* node attached to a context.
+ *
+ * The data is copied and only the updated ranges are uploaded to the GPU at
+ * the next draw. The elements going past the end of the buffer wrap around
+ * to its start, so a buffer can be used as a ring where new elements
+ * overwrite the oldest ones without moving the data: the shaders then
+ * locate the oldest element with the position of the next update. No draw
+ * must be in progress during the update (see ngl_draw_async() and
+ * ngl_wait()).
+ *
+ * The same restrictions as ngl_node_buffer_map() apply to the uses of the
+ * buffer being updated.
+ *
+ * @param node    pointer to the target Buffer* node, which must not be
+ *                defined by a filename or a block
+ * @param offset  index of the first element to update
+ * @param count   number of elements to update, not larger than the number
+ *                of elements of the buffer
+ * @param data    pointer to the count elements
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_buffer_update(struct ngl_node *node, int offset, int count, const void *data);
+
+/**
+ * Asynchronous buffer read callback prototype.
+ *
+ * @param user_arg  opaque user argument given to ngl_node_buffer_read_async()
+ * @param ret       0 on success, NGL_ERROR_* (< 0) if the data could not be
+ *                  read, in which case data is NULL
+ * @param data      pointer to the data read, only valid during the callback
+ * @param size      size of the data in bytes
+ */
+typedef void (*ngl_buffer_read_callback_type)(void *user_arg, int ret, const void *data, int size);
+
+/**
+ * Read back the GPU data of a Buffer* or Block node, typically written by a
+ * Compute node, without stalling the rendering.
+ *
+ * The data is copied on the GPU at the end of the next draw, once the whole
+ * scene has been drawn, and delivered to the callback from the rendering
+ * thread at the end of the first draw where the copy is complete, without
+ * ever waiting for it. The reads are delivered in request order, the
+ * remaining ones by ngl_wait() and ngl_freep(). The read fails if the node
+ * has no GPU data at the time of the copy (because it is not used by the
+ * scene anymore, or because it is a field of a Block, in which case the
+ * Block must be read instead).
+ *
+ * This function can be called from any thread.
+ *
+ * @param node      pointer to the Buffer* or Block node to read, attached
+ *                  to a context
+ * @param offset    offset of the range to read in bytes
+ * @param size      size of the range to read in bytes
+ * @param callback  callback receiving the data
+ * @param user_arg  opaque user argument to be forwarded to the callback
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_buffer_read_async(struct ngl_node *node, int offset, int size,
+                               ngl_buffer_read_callback_type callback, void *user_arg);
+
 /**
  * Serialize in Graphviz format (.dot) a node graph.
  *
@@ -287,6 +460,47 @@ char *ngl_node_dot(const struct ngl_node *node);
  */
 char *ngl_node_serialize(const struct ngl_node *node);
 
+/**
+ * Serialization write callback prototype.
+ *
+ * @param user_arg  opaque user argument given to ngl_node_serialize_to()
+ * @param data      chunk of the serialized scene, only valid during the
+ *                  callback and not nul-terminated
+ * @param size      size of the chunk in bytes
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error, which aborts the
+ *         serialization
+ */
+typedef int (*ngl_serialize_callback_type)(void *user_arg, const char *data, int size);
+
+/**
+ * Serialize in node.gl format (.ngl), handing the output in chunks to a
+ * callback while the graph is walked.
+ *
+ * Unlike ngl_node_serialize(), the scene is never held in memory as a
+ * whole, so the peak memory does not depend on the size of the data
+ * buffers it embeds.
+ *
+ * @param write_func  callback receiving the chunks, in order
+ * @param user_arg    opaque user argument passed to the callback
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ *
+ * @see ngl_node_serialize_to_file()
+ */
+int ngl_node_serialize_to(const struct ngl_node *node,
+                          ngl_serialize_callback_type write_func, void *user_arg);
+
+/**
+ * Serialize in node.gl format (.ngl) into a file, which is streamed as
+ * with ngl_node_serialize_to(). The file is removed on error.
+ *
+ * @param filename  path to the file to create or overwrite
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_node_serialize_to_file(const struct ngl_node *node, const char *filename);
+
 /**
  * De-serialize a scene.
  *
@@ -298,6 +512,69 @@ char *ngl_node_serialize(const struct ngl_node *node);
  */
 struct ngl_node *ngl_node_deserialize(const char *s);
 
+/**
+ * De-serialize a scene read from a file descriptor, in the node.gl text or
+ * binary format.
+ *
+ * The text format is parsed while it is read, one line at a time, so only
+ * the line being parsed is held in memory. The large data payloads are
+ * decoded by several threads.
+ *
+ * The file descriptor is read until its end and is not closed.
+ *
+ * Must be destroyed using ngl_node_unrefp().
+ *
+ * @param fd  file descriptor to read the serialized scene from
+ *
+ * @return a pointer to the de-serialized node graph or NULL on error
+ *
+ * @see ngl_node_deserialize_file()
+ */
+struct ngl_node *ngl_node_deserialize_fd(int fd);
+
+/**
+ * De-serialize a scene file, in the node.gl text or binary format.
+ *
+ * Must be destroyed using ngl_node_unrefp().
+ *
+ * @param filename  path to the serialized scene
+ *
+ * @return a pointer to the de-serialized node graph or NULL on error
+ *
+ * @see ngl_node_deserialize_fd()
+ */
+struct ngl_node *ngl_node_deserialize_file(const char *filename);
+
+/**
+ * Serialize in the node.gl binary format.
+ *
+ * Unlike the text format, the values are stored as-is and the data buffers
+ * are not encoded, which makes the deserialization of large scenes mostly a
+ * matter of copying memory.
+ *
+ * Must be destroyed using free().
+ *
+ * @param sizep  pointer to the size of the returned data
+ *
+ * @return an allocated memory area in node.gl binary format or NULL on error
+ */
+void *ngl_node_serialize_binary(const struct ngl_node *node, size_t *sizep);
+
+/**
+ * De-serialize a scene in the node.gl binary format.
+ *
+ * The data is not referenced after this call returns, so it can typically
+ * be a temporary memory mapping of a file.
+ *
+ * Must be destroyed using ngl_node_unrefp().
+ *
+ * @param data  memory area in node.gl binary format
+ * @param size  size of the memory area
+ *
+ * @return a pointer to the de-serialized node graph or NULL on error
+ */
+struct ngl_node *ngl_node_deserialize_binary(const void *data, size_t size);
+
 /**
  * Platform-specific identifiers
  */
@@ -319,6 +596,98 @@ enum {
     NGL_BACKEND_OPENGLES,
 };
 
+/**
+ * Render target attachment load operations, defining the content of the
+ * attachments at the beginning of a frame
+ */
+enum {
+    NGL_LOAD_OP_CLEAR,     /* Cleared with the clear color (or depth/stencil clear values) */
+    NGL_LOAD_OP_LOAD,      /* Content of the previous frame preserved */
+    NGL_LOAD_OP_DONT_CARE, /* Undefined, every pixel is expected to be overwritten */
+};
+
+/**
+ * Render target attachment store operations, defining whether the content of
+ * the attachments must be kept at the end of a frame
+ */
+enum {
+    NGL_STORE_OP_STORE,     /* Content preserved */
+    NGL_STORE_OP_DONT_CARE, /* Content discarded */
+};
+
+/**
+ * Scheduling priorities of the threads of a context
+ */
+enum {
+    NGL_THREAD_PRIORITY_DEFAULT,  /* Priority of the platform */
+    NGL_THREAD_PRIORITY_DISPLAY,  /* Priority of the threads producing the
+                                     display: nice value of -4 on Linux and
+                                     Android (THREAD_PRIORITY_DISPLAY),
+                                     user-interactive QoS class on Darwin
+                                     and highest priority on Windows */
+    NGL_THREAD_PRIORITY_REALTIME, /* Real-time scheduling: SCHED_FIFO on
+                                     Linux and Android and time-critical
+                                     priority on Windows. Falls back on
+                                     NGL_THREAD_PRIORITY_DISPLAY if the
+                                     process is not allowed to use it, and
+                                     on Darwin. */
+};
+
+/**
+ * Pixel formats of the offscreen captures. The YUV formats use the BT.709
+ * limited range coefficients and a 4:2:0 chroma subsampling.
+ */
+enum {
+    NGL_CAPTURE_FORMAT_RGBA, /* Packed 8-bit RGBA, width * height * 4 bytes */
+    NGL_CAPTURE_FORMAT_NV12, /* 8-bit Y plane followed by the interleaved UV plane, width * height * 3 / 2 bytes */
+    NGL_CAPTURE_FORMAT_I420, /* 8-bit Y, U and V planes, width * height * 3 / 2 bytes */
+    NGL_CAPTURE_FORMAT_P010, /* 16-bit little-endian NV12 layout holding 10-bit samples in the high bits,
+                                width * height * 3 bytes */
+};
+
+/**
+ * Linux dma-buf description, used as an offscreen capture target
+ */
+struct ngl_dmabuf {
+    int fd;          /* dma-buf file descriptor */
+    int offset;      /* Offset in bytes of the first pixel in the buffer */
+    int pitch;       /* Size in bytes of a line */
+    uint32_t fourcc; /* DRM format fourcc of the 32-bit RGBA pixel layout
+                        (typically DRM_FORMAT_ABGR8888 for RGBA bytes) */
+};
+
+/**
+ * Additional offscreen output of a node.gl context
+ */
+struct ngl_output {
+    int width;                  /* Output width */
+    int height;                 /* Output height */
+    uint8_t *capture_buffer;    /* RGBA buffer of width x height x 4 bytes
+                                   receiving each frame drawn */
+};
+
+/**
+ * Opaque structure identifying a group of node.gl contexts sharing their
+ * resources, see ngl_config.share_group
+ */
+struct ngl_share_group;
+
+/**
+ * Allocate a new share group.
+ *
+ * Must be released using ngl_share_group_freep(), which can be called
+ * while contexts are still configured with it: the group is destroyed once
+ * the last of them is freed.
+ *
+ * @return a pointer to the share group, or NULL on error
+ */
+struct ngl_share_group *ngl_share_group_create(void);
+
+/**
+ * Release the reference on the share group and reset the pointer to NULL.
+ */
+void ngl_share_group_freep(struct ngl_share_group **sp);
+
 /**
  * node.gl configuration
  */
@@ -329,10 +698,21 @@ struct ngl_config {
 
     uintptr_t display; /* A native display handle */
 
-    uintptr_t window;  /* A native window handle */
+    uintptr_t window;  /* A native window handle. With offscreen rendering
+                          on iOS and macOS, an optional CVPixelBufferRef
+                          (32BGRA and IOSurface-backed on macOS) every frame
+                          is rendered into without any CPU copy. */
 
     uintptr_t handle;  /* A native OpenGL context handle */
 
+    int device;        /* Linux offscreen rendering without display handle
+                          only: number (starting at 1) of the EGL device to
+                          render on without any display server, useful to
+                          spread the rendering over several GPUs. 0 (the
+                          default) selects the first device if the platform
+                          supports it, and falls back on the X11 display
+                          otherwise. */
+
     int swap_interval; /* Specifies the minimum number of video frames that are
                           displayed before a buffer swap will occur. -1 can be
                           used to use the default system implementation value.
@@ -355,9 +735,507 @@ struct ngl_config {
 
     float clear_color[4]; /* Clear color (red, green, blue, alpha) */
 
-    uint8_t *capture_buffer; /* RGBA offscreen capture buffer. If allocated,
-                                its size must be at least width * height * 4
-                                bytes. */
+    uint8_t *capture_buffer; /* Offscreen capture buffer. If allocated, its
+                                size must be at least the size of a
+                                capture_width x capture_height frame in the
+                                capture_format (width * height * 4 bytes by
+                                default). */
+
+    void (*capture_callback)(void *user_arg, const uint8_t *data);
+                             /* Asynchronous offscreen capture callback,
+                                mutually exclusive with capture_buffer. If
+                                set, the pixels (in the capture_format and
+                                capture dimensions) of every drawn frame are read back without
+                                stalling the rendering and delivered in draw
+                                order, one or more frames later, from the
+                                rendering thread. The data pointer is only
+                                valid during the callback. The remaining
+                                frames are delivered by ngl_wait(), on
+                                reconfiguration and on ngl_freep(). */
+
+    void *capture_user_arg;  /* User argument passed to capture_callback */
+
+    struct ngl_dmabuf *capture_dmabuf; /* Linux offscreen capture target,
+                                          mutually exclusive with
+                                          capture_buffer and capture_callback.
+                                          If set, every frame is rendered into
+                                          this width x height dma-buf (for
+                                          example exported from a VA surface)
+                                          without any CPU copy. The structure
+                                          and its file descriptor are only
+                                          used (and thus must only be valid)
+                                          during ngl_configure(). */
+
+    void *capture_hardware_buffer; /* Android (API 26+) offscreen capture
+                                      target, mutually exclusive with
+                                      capture_buffer, capture_callback and
+                                      capture_dmabuf. If set, every frame is
+                                      rendered into this width x height
+                                      R8G8B8A8 AHardwareBuffer (allocated with
+                                      the GPU color output usage) without any
+                                      CPU copy. The buffer is acquired until
+                                      the next reconfiguration or
+                                      ngl_freep(). */
+
+    void *capture_d3d11_texture; /* Windows offscreen capture target,
+                                    mutually exclusive with capture_buffer,
+                                    capture_callback, capture_dmabuf and
+                                    capture_hardware_buffer. If set, every
+                                    frame is rendered into this width x
+                                    height DXGI_FORMAT_R8G8B8A8_UNORM
+                                    ID3D11Texture2D (created with the render
+                                    target bind flag) without any CPU copy,
+                                    through WGL_NV_DX_interop2. The texture
+                                    is referenced until the next
+                                    reconfiguration or ngl_freep(). */
+
+    int capture_format; /* Pixel format (any of NGL_CAPTURE_FORMAT_*) of
+                           the frames delivered to capture_buffer and
+                           capture_callback. The conversion runs on the GPU
+                           before the read back. The YUV formats require
+                           capture dimensions multiple of 4. Defaults to
+                           NGL_CAPTURE_FORMAT_RGBA. */
+
+    int capture_width;  /* Dimensions of the frames delivered to */
+    int capture_height; /* capture_buffer and capture_callback, scaled on
+                           the GPU before the read back. 0 (the default)
+                           selects the context width and height. */
+
+    int texture_pool_size; /* Maximum amount of memory, in MB, used to keep
+                              the released textures around so they can be
+                              recycled by later textures of the same
+                              properties instead of being reallocated. 0
+                              selects the default size (64MB), a negative
+                              value disables the pool. */
+
+    int color_load_op;          /* Load operation (any of NGL_LOAD_OP_*)
+                                   applied to the color buffer at the
+                                   beginning of each frame */
+
+    int depth_stencil_load_op;  /* Load operation (any of NGL_LOAD_OP_*)
+                                   applied to the depth and stencil buffers
+                                   at the beginning of each frame */
+
+    int depth_stencil_store_op; /* Store operation (any of NGL_STORE_OP_*)
+                                   applied to the depth and stencil buffers
+                                   at the end of each frame. Discarding them
+                                   saves a memory write back on tile-based
+                                   GPUs. */
+
+    const char *program_cache_dir; /* Directory where the linked program
+                                      binaries are stored and loaded back
+                                      from in later sessions, skipping the
+                                      shader compilation. It must exist and
+                                      be writable. Only used if supported
+                                      by the driver. The capabilities
+                                      probed from the driver are cached
+                                      there as well, which speeds up the
+                                      context creation. */
+
+    struct ngl_share_group *share_group; /* Group of contexts (typically
+                                            the several views of an
+                                            application) sharing the
+                                            linked program binaries: a
+                                            program is then only compiled
+                                            by the first context of the
+                                            group using it. Only used if
+                                            supported by the driver. */
+
+    int async_programs; /* Whether the Program and ComputeProgram shaders
+                           are compiled asynchronously. The programs of a
+                           scene are then all submitted to the driver by
+                           ngl_set_scene() and the nodes using them are not
+                           drawn until they are ready, which spreads the
+                           compilation over the first frames instead of
+                           stalling the scene loading. The builds only run
+                           in the background if the driver supports
+                           KHR_parallel_shader_compile. */
+
+    int target_frame_time; /* GPU time budget of a frame, in microseconds.
+                              If set, the offscreen rendering resolution is
+                              progressively lowered (and the multisample
+                              anti-aliasing disabled) while the GPU frame
+                              time exceeds it, and raised back when the load
+                              allows it. The frames are upscaled to the
+                              configured dimensions when captured. Only
+                              honored for offscreen rendering, and if the
+                              context supports timer queries. Defaults to 0
+                              (disabled). */
+
+    int release_delay; /* Delay, in milliseconds, before the resources of
+                          the nodes becoming inactive are released. A node
+                          active again within that delay is reused as is,
+                          which avoids reallocating the same resources over
+                          and over when scrubbing back and forth around the
+                          boundaries of a time range. Defaults to 0 (the
+                          resources are released as soon as the nodes are
+                          inactive). */
+
+    int release_memory_limit; /* Amount of GPU memory, in MB, above which the
+                                 nodes waiting for their release_delay to
+                                 expire are released early, the oldest
+                                 first. 0 disables the limit. */
+
+    int decoder_pool_size; /* Number of players of the released Media nodes
+                              kept running, along with their (possibly
+                              hardware) decoding session, instead of being
+                              stopped. Prefetching one of these media again
+                              (or another Media sharing its player) then
+                              skips the creation of a new decoding session,
+                              which is typically the most expensive part of
+                              starting a clip with a hardware decoder. The
+                              least recently released players are stopped
+                              first. Defaults to 0 (the players are stopped
+                              on release). */
+
+    int gpu_memory_budget; /* Amount of GPU memory, in MB, the scene is
+                              expected to fit in. While the memory in use
+                              exceeds it, the deferred releases are honored
+                              right away and the TimeRangeFilter children
+                              kept alive while idle (see max_idle_time) are
+                              released, one per frame, starting with the
+                              one idle for the longest time. 0 (the
+                              default) disables the budget. */
+
+    int prefetch_upload_budget; /* Amount of data, in KB, uploaded to the GPU
+                                   per frame by the prefetches. The textures
+                                   and buffers prefetched ahead of time (see
+                                   the TimeRangeFilter prefetch_time) which
+                                   do not fit in it are uploaded by chunks
+                                   over the next frames, and entirely as
+                                   soon as they are needed for a draw. 0
+                                   (the default) disables the budget. */
+
+    int nb_update_threads; /* Number of threads the CPU-only node updates
+                              (such as the animations) are spread over, the
+                              rendering thread included. The other updates
+                              still run on the rendering thread, after them.
+                              The CPU-only part of the initialization of the
+                              nodes of a scene (such as the generation of the
+                              geometries and the conversion of the buffers)
+                              is spread over the same threads. 0 or 1 (the
+                              default) keeps all the updates on the
+                              rendering thread. */
+
+    int pipelined_updates; /* Whether the CPU-only updates of a frame run in
+                              the background, during the presentation of
+                              the previous frame and until the next
+                              ngl_draw() call. This costs one frame of
+                              latency: ngl_draw() then draws the time
+                              requested by the previous call (its own time
+                              for the first call). Requires
+                              nb_update_threads to be greater than 1. */
+
+    int upload_thread; /* Whether the frames of the Media nodes are uploaded
+                          into their textures by a dedicated thread owning
+                          a GL context shared with the rendering one,
+                          instead of by the rendering thread. The
+                          rendering context only waits for an upload (on
+                          the GPU side) before the first draw sampling the
+                          texture, so the transfers run concurrently with
+                          the rest of the frame. Only the software decoded
+                          RGBA, BGRA and NV12 frames (the latter sampled
+                          without conversion) and the audio frames without
+                          FFT of the Media without a frame_cache are
+                          concerned. Only supported with
+                          EGL and on contexts supporting fences, the
+                          uploads stay on the rendering thread otherwise.
+                          Can not be changed by a reconfiguration.
+                          Defaults to 0 (disabled). */
+
+    int thread_priority; /* Scheduling priority (any of
+                            NGL_THREAD_PRIORITY_*) of the rendering thread,
+                            of the update threads and of the media decoding
+                            threads. Raising the priority of the rendering
+                            thread may require privileges, a warning is
+                            logged if they are missing. */
+
+    uint64_t thread_affinity; /* Mask of the CPU cores (bit N for the core
+                                 N) the threads of thread_priority are
+                                 allowed to run on, typically the big cores
+                                 of a big.LITTLE CPU. Only honored on Linux,
+                                 Android and Windows. 0 (the default) keeps
+                                 the threads on any core. */
+
+    int skip_idle_frames; /* Whether ngl_draw() skips the rendering (and
+                             the capture and swap of the buffers) when
+                             nothing changed since the last frame drawn:
+                             same scene state, no parameter or buffer
+                             change, and no node with a time-dependent
+                             output. The frame skipped is reported by the
+                             frame_reused field of the stats. */
+
+    int damage_tracking; /* Whether ngl_draw() locates the area of the
+                            frame which changed since the previous one, to
+                            only clear and redraw that area and hint the
+                            presentation with it. The area is located from
+                            the bounding boxes of the geometries drawn with
+                            the default program (or with frustum_culling
+                            enabled); any other draw is assumed to cover
+                            the whole viewport. The scenes with
+                            RenderToTexture, Compute, Text or HUD nodes,
+                            with a scissor, or with additional outputs are
+                            always fully redrawn. Only effective with
+                            offscreen rendering, or on EGL windows
+                            supporting EGL_EXT_buffer_age or
+                            EGL_KHR_partial_update. The area redrawn is
+                            reported by the redraw_region field of the
+                            stats. */
+
+    const char *frame_cache_dir; /* Directory where the frames delivered to
+                                    capture_buffer are stored and loaded
+                                    back from, in this and later sessions:
+                                    ngl_draw() then delivers the frame of a
+                                    time already rendered without
+                                    rendering it again. The frames are
+                                    identified by the serialized scene
+                                    (with its live changes), the time and
+                                    the capture dimensions and format; the
+                                    media and images are only identified
+                                    by their file path, and the scenes
+                                    must render the same frame for the
+                                    same time (no HUD). It must exist and
+                                    be writable. Only used with
+                                    capture_buffer, without
+                                    pipelined_updates nor additional
+                                    outputs. The frames delivered from the
+                                    cache are reported by the
+                                    frame_cached field of the stats. */
+
+    int frame_cache_size; /* Maximum amount of disk space, in MB, used by
+                             the frames of frame_cache_dir, the least
+                             recently used frames being removed first. 0
+                             selects the default size (1024MB). */
+
+    int pack_uniforms; /* Whether the uniforms of the programs (the builtin
+                          matrices included) are packed into a std140
+                          uniform block, filled before every draw from a
+                          uniform buffer ring renewed every frame, instead
+                          of being uploaded with individual glUniform*()
+                          calls. Only the shaders targeting a GLSL version
+                          with uniform blocks (300 es, or 140 on desktop)
+                          are concerned, as long as their uniform
+                          declarations are global, single, and not
+                          conditionally compiled; the other shaders are
+                          used as is. The samplers and images are never
+                          packed. Can not be changed by a reconfiguration.
+                          Defaults to 0 (disabled). */
+
+    int specialize_uniforms; /* Whether the values of the non-animated
+                                UniformFloat, UniformVec*, UniformQuat (not
+                                as_mat4) and UniformInt nodes (and of the
+                                constant animations folded by
+                                optimize_graph) are compiled into the
+                                shaders of the Program and ComputeProgram
+                                nodes as constants, so the drivers can fold
+                                them and no upload is needed. Each pass
+                                then gets its own program, shared with the
+                                passes using the same program and values.
+                                The live changes of the specialized
+                                uniforms are rejected. Only the global,
+                                single and non-array declarations are
+                                replaced. Can not be changed by a
+                                reconfiguration. Defaults to 0
+                                (disabled). */
+
+    int bindless_textures; /* Whether the textures are sampled through
+                              bindless handles (GL_ARB_bindless_texture)
+                              instead of being bound to texture units
+                              before every draw, which also lifts the
+                              limit on the number of textures of a
+                              program. Only available on desktop OpenGL,
+                              and only the programs whose shaders all
+                              target GLSL >= 400 are concerned. Only the
+                              immutable textures get a handle, the others
+                              are still bound to texture units. The
+                              textures with a handle are resident until
+                              they are released and are not recycled.
+                              Can not be changed by a reconfiguration.
+                              Defaults to 0 (disabled). */
+
+    int texture_atlas; /* Whether the small Texture2D nodes (up to 256x256)
+                          with a static buffer data source, no mipmapping
+                          and a clamp to edge wrapping are packed into
+                          shared atlas textures, one per format and
+                          filtering combination, instead of getting their
+                          own texture. The coordinates matrix of the
+                          texture addresses its region of the atlas, so a
+                          texture is only packed if all the programs
+                          sampling it use the <name>_coord_matrix uniform
+                          along with a sampler2D, and never access it as
+                          an image. Can not be changed by a
+                          reconfiguration. Defaults to 0 (disabled). */
+
+    int optimize_graph; /* Whether the scene graph is optimized when it is
+                           attached to the context. The chains of
+                           non-animated transforms are drawn as a single
+                           transform with their combined matrix, and the
+                           AnimatedFloat and AnimatedVec* nodes whose
+                           keyframes all hold the same value are evaluated
+                           once and then handled as plain uniforms. The
+                           graph itself is left untouched, but the
+                           combined matrices may differ from the chained
+                           products by a rounding error. Can not be
+                           changed by a reconfiguration. Defaults to 0
+                           (disabled). */
+
+    int animation_bake_rate[2]; /* Rate, as a rational number of samples per
+                                   second, at which the AnimatedFloat and
+                                   AnimatedVec* nodes are sampled from their
+                                   first to their last key frame when the
+                                   scene is attached to the context. The
+                                   animations are then evaluated by linearly
+                                   interpolating between the two nearest
+                                   samples, which is exact at the sampling
+                                   times: the rate is typically the one of
+                                   the exported frames. The sampling is
+                                   spread over the nb_update_threads
+                                   threads. Can not be changed by a
+                                   reconfiguration. Defaults to {0, 0}
+                                   (disabled). */
+
+    int debug; /* Whether the messages of the GL debug output (KHR_debug) are
+                  reported through the log. They are delivered
+                  asynchronously, possibly from a driver thread, at a log
+                  level matching their severity (the notifications are
+                  filtered out), and the GL objects of the Texture*,
+                  Buffer*, Block and RenderToTexture nodes are labeled with
+                  the node labels. The GL errors are also checked (which
+                  stalls the driver) at the end of every frame, which is
+                  otherwise skipped. The debug output requires OpenGL 4.3,
+                  OpenGL ES 3.2 or GL_KHR_debug. Defaults to 0
+                  (disabled). */
+
+    const struct ngl_output *outputs; /* Additional offscreen outputs. The
+                                         scene is visited, prefetched and
+                                         updated once per frame, and then
+                                         drawn into the main target and into
+                                         each output, with the configured
+                                         viewport scaled to the output
+                                         dimensions. The RenderToTexture
+                                         and Compute nodes are only drawn
+                                         once per frame, their results being
+                                         shared by all the outputs. Only
+                                         supported with offscreen rendering.
+                                         The array is only used during
+                                         ngl_configure(), but the capture
+                                         buffers must remain valid until the
+                                         next configuration. */
+
+    int nb_outputs; /* Number of elements in outputs */
+};
+
+/**
+ * GPU memory categories, used as index in ngl_stats.memory
+ */
+enum {
+    NGL_STATS_MEMORY_BUFFERS,       /* Buffers (vertices, indices, blocks, ...) */
+    NGL_STATS_MEMORY_TEXTURES,      /* Textures in use */
+    NGL_STATS_MEMORY_RENDERBUFFERS, /* Render buffers (depth, stencil and
+                                       multisample attachments) */
+    NGL_STATS_MEMORY_TEXTURE_POOL,  /* Released textures kept for recycling */
+    NGL_STATS_MEMORY_NB
+};
+
+/**
+ * CPU memory categories, used as index in ngl_stats.cpu_memory and
+ * ngl_stats.cpu_memory_peak
+ */
+enum {
+    NGL_STATS_CPU_MEMORY_NODES,     /* Nodes and their private data */
+    NGL_STATS_CPU_MEMORY_BUFFERS,   /* Data of the buffers, animated buffers,
+                                       blocks and buffer key frames */
+    NGL_STATS_CPU_MEMORY_DRAWING,   /* Geometry and pixels of the texts, the
+                                       HUD and the font atlases */
+    NGL_STATS_CPU_MEMORY_NB
+};
+
+/**
+ * Formats picked for the color textures by the precision of the
+ * RenderToTexture nodes, used as index in ngl_stats.nb_rtt_formats
+ */
+enum {
+    NGL_STATS_RTT_FORMAT_R8G8B8A8_UNORM,         /* ldr precision */
+    NGL_STATS_RTT_FORMAT_A2B10G10R10_UNORM,      /* ldr10 precision */
+    NGL_STATS_RTT_FORMAT_B10G11R11_UFLOAT,       /* hdr_opaque precision */
+    NGL_STATS_RTT_FORMAT_R16G16B16A16_SFLOAT,    /* hdr precision */
+    NGL_STATS_RTT_FORMAT_NB
+};
+
+/**
+ * Statistics of the last frame drawn by a node.gl context
+ */
+struct ngl_stats {
+    int64_t cpu_time;         /* Time spent by the CPU in the last draw, in
+                                 microseconds */
+    int64_t gpu_time;         /* GPU time of the most recent frame whose
+                                 measure is available (typically a few
+                                 frames behind), in microseconds, or -1 if
+                                 not supported */
+    int nb_draws;             /* Number of draw calls */
+    int nb_dispatches;        /* Number of compute dispatches */
+    int nb_texture_binds;     /* Number of textures (and images) bound to the
+                                 draws and dispatches */
+    int64_t uploaded_bytes;   /* Number of bytes uploaded to buffers and
+                                 textures */
+    int64_t memory[NGL_STATS_MEMORY_NB]; /* GPU memory currently allocated by
+                                            category, in bytes */
+    int64_t visit_time;       /* Time spent visiting the graph (activity
+                                 check), in microseconds */
+    int64_t prefetch_time;    /* Time spent releasing and prefetching the
+                                 nodes resources, in microseconds */
+    int64_t update_time;      /* Time spent updating the nodes, in
+                                 microseconds */
+    int64_t draw_time;        /* Time spent submitting the draw commands, in
+                                 microseconds */
+    int64_t capture_time;     /* Time spent capturing the frame, in
+                                 microseconds */
+    int64_t swap_time;        /* Time spent swapping the buffers, in
+                                 microseconds */
+    int64_t display_period;   /* Estimated refresh period of the display, in
+                                 microseconds, or 0 if unknown (offscreen
+                                 rendering, swap interval of 0, or not
+                                 enough frames presented yet) */
+    int nb_late_frames;       /* Number of frames presented after missing at
+                                 least one display refresh, since the
+                                 context has been configured */
+    int nb_dropped_frames;    /* Number of display refreshes missed, since
+                                 the context has been configured */
+    int frame_reused;         /* Whether the last ngl_draw() skipped the
+                                 rendering because the frame was identical
+                                 to the previous one (see skip_idle_frames) */
+    int frame_cached;         /* Whether the last ngl_draw() delivered the
+                                 frame from the frame cache instead of
+                                 rendering it (see frame_cache_dir) */
+    int redraw_region[4];     /* Area of the viewport redrawn by the last
+                                 ngl_draw() (x, y, width, height from the
+                                 bottom left corner), smaller than the
+                                 viewport if only its damage has been
+                                 redrawn (see damage_tracking) */
+    int64_t cpu_memory[NGL_STATS_CPU_MEMORY_NB];      /* CPU memory currently
+                                                         allocated by category,
+                                                         in bytes, shared by
+                                                         all the contexts and
+                                                         nodes of the process */
+    int64_t cpu_memory_peak[NGL_STATS_CPU_MEMORY_NB]; /* Highest CPU memory
+                                                         allocated by category
+                                                         since the start of
+                                                         the process, in
+                                                         bytes */
+    int nb_rtt_formats[NGL_STATS_RTT_FORMAT_NB]; /* Color textures of the
+                                                    prefetched RenderToTexture
+                                                    nodes allocated in the
+                                                    format picked by their
+                                                    precision, by format */
+    int nb_rtt_dropped_depths; /* Prefetched RenderToTexture nodes whose
+                                  depth and stencil buffer is dropped by
+                                  their precision because their scene never
+                                  tests them */
+    int64_t rtt_saved_memory;  /* GPU memory saved by the precision of the
+                                  prefetched RenderToTexture nodes compared
+                                  to their declared formats and features, in
+                                  bytes (negative if larger formats were
+                                  picked) */
 };
 
 /**
@@ -416,6 +1294,68 @@ int ngl_configure(struct ngl_ctx *s, struct ngl_config *config);
  */
 int ngl_set_scene(struct ngl_ctx *s, struct ngl_node *scene);
 
+/**
+ * Update the scene associated with a node.gl context to match a new scene,
+ * reusing the current nodes and their graphics resources when possible.
+ *
+ * The two graphs are compared node by node: if they only differ by live
+ * changeable parameters, these parameters are updated in the current scene
+ * and the new scene is left unused (it is not associated with the context).
+ * Otherwise, this function behaves like ngl_set_scene().
+ *
+ * Typically used to reload a scene rebuilt from scratch (for instance
+ * de-serialized again after an edit) without reinitializing it.
+ *
+ * @param s      pointer to the configured node.gl context
+ * @param scene  pointer to the new scene
+ *
+ * @note as the new scene may be left unused, live changes must then be made
+ *       on the nodes of the scene previously associated with the context.
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_update_scene(struct ngl_ctx *s, struct ngl_node *scene);
+
+/**
+ * Schedule a set of live changes of parameters, applied all at once before
+ * the next draw.
+ *
+ * The updates are all checked before any of them is scheduled, and are then
+ * applied in order, without looking the parameters up by name nor parsing
+ * their values. Like ngl_node_param_set(), this function can be called from
+ * any thread, including while an asynchronous draw is in progress.
+ *
+ * @param s           pointer to the configured node.gl context
+ * @param updates     array of nb_updates updates, whose nodes must be
+ *                    associated with the context; the strings are copied
+ * @param nb_updates  number of updates
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_params_update(struct ngl_ctx *s, const struct ngl_param_update *updates, int nb_updates);
+
+/**
+ * Initialize a scene ahead of its association with a node.gl context.
+ *
+ * All the nodes of the scene are initialized (programs, textures, buffers,
+ * media, ...) while the current scene keeps being the one drawn. A following
+ * ngl_set_scene() call with the same scene then switches to it without any
+ * initialization, and the nodes shared with the previous scene are kept
+ * instead of being released and initialized again.
+ *
+ * The reference counter of the root node is incremented until it is set
+ * with ngl_set_scene() or another scene is prepared. Only one scene can be
+ * prepared at a time; scene=NULL releases the currently prepared one.
+ *
+ * @param s      pointer to the configured node.gl context
+ * @param scene  pointer to the scene
+ *
+ * @note node.gl context must to be configured before calling this function.
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_prepare_scene(struct ngl_ctx *s, struct ngl_node *scene);
+
 /**
  * Draw at the specified time.
  *
@@ -428,6 +1368,95 @@ int ngl_set_scene(struct ngl_ctx *s, struct ngl_node *scene);
  */
 int ngl_draw(struct ngl_ctx *s, double t);
 
+/**
+ * Draw the scene at several times into an atlas of tiles, typically to
+ * generate the thumbnails of a timeline.
+ *
+ * Each tile has the dimensions of the offscreen context, and the tiles are
+ * laid out in rows of nb_columns, following the order of the times. This is
+ * much cheaper than separate ngl_draw() calls: the times are drawn in
+ * increasing order, the resources of the nodes are kept prefetched during
+ * the whole batch, and the atlas is read back once all the tiles are drawn.
+ *
+ * The capture configuration, the viewport and the additional outputs of the
+ * context are not used by the batch.
+ *
+ * @param s             pointer to the configured offscreen node.gl context
+ * @param times         array of target draw times in seconds
+ * @param nb_times      number of times (and tiles)
+ * @param atlas         RGBA buffer receiving the atlas, of
+ *                      (width x nb_columns) x (height x nb_rows) x 4 bytes
+ *                      with nb_rows = ceil(nb_times / nb_columns)
+ * @param nb_columns    number of tiles per row
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_draw_batch(struct ngl_ctx *s, const double *times, int nb_times,
+                   uint8_t *atlas, int nb_columns);
+
+/**
+ * Warm up progress callback, called from the rendering thread with the
+ * fraction (between 0 and 1) of the range warmed up so far.
+ */
+typedef void (*ngl_warmup_callback_type)(void *user_arg, double progress);
+
+/**
+ * Prepare the scene to be drawn over a range of times, typically before
+ * starting the playback at t_start, so the first frames do not absorb the
+ * initialization of the nodes.
+ *
+ * The activity of the scene is followed over the range (without drawing
+ * anything): every node active at some point of the range is initialized
+ * and prefetched (programs compiled, textures and buffers allocated, media
+ * decoders started), and the updates of t_start run (first frames decoded
+ * and uploaded). The nodes are then kept ready, even while inactive, as long
+ * as the drawn times remain in the range. The warm up stops early once the
+ * GPU memory budget (see gpu_memory_budget) is reached.
+ *
+ * @param s            pointer to the configured node.gl context
+ * @param t_start      start time of the range in seconds
+ * @param duration     duration of the range in seconds
+ * @param progress_cb  optional progress callback
+ * @param user_arg     user argument passed to progress_cb
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_warmup(struct ngl_ctx *s, double t_start, double duration,
+               ngl_warmup_callback_type progress_cb, void *user_arg);
+
+/**
+ * Queue a draw at the specified time without waiting for its completion.
+ *
+ * Up to a few draws can be queued at the same time; if the queue is full,
+ * this function blocks until a slot is available. Any other ngl_* call on the
+ * context (ngl_draw(), ngl_set_scene(), ...) is serialized after the queued
+ * draws.
+ *
+ * The scene must not be altered (including live parameter changes) and the
+ * capture buffer must not be accessed until ngl_wait() returns.
+ *
+ * @param s     pointer to the configured node.gl context
+ * @param t     target draw time in seconds
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ *
+ * @see ngl_wait()
+ */
+int ngl_draw_async(struct ngl_ctx *s, double t);
+
+/**
+ * Wait for all the draws queued with ngl_draw_async() to complete.
+ *
+ * If an asynchronous capture callback is configured, the frames still pending
+ * are delivered to it before this function returns.
+ *
+ * @param s     pointer to the node.gl context
+ *
+ * @return 0 on success, or the first error (NGL_ERROR_* < 0) raised by one
+ *         of the queued draws since the last call to ngl_wait()
+ */
+int ngl_wait(struct ngl_ctx *s);
+
 /**
  * Serialize the current scene in Graphviz format (.dot) a node graph at the
  * specified time. Non active nodes will be grayed.
@@ -440,6 +1469,169 @@ int ngl_draw(struct ngl_ctx *s, double t);
  */
 char *ngl_dot(struct ngl_ctx *s, double t);
 
+/**
+ * Cost metrics coloring the nodes in ngl_dot_cost()
+ */
+enum {
+    NGL_DOT_COST_CPU,       /* CPU time spent updating and drawing the node */
+    NGL_DOT_COST_GPU,       /* GPU time of the node draws */
+    NGL_DOT_COST_MEMORY,    /* GPU memory of the node data */
+    NGL_DOT_COST_NB
+};
+
+/**
+ * Serialize the current scene in Graphviz format (.dot) like ngl_dot(), with
+ * every node annotated with its cost instead of its parameters:
+ * - the CPU time spent updating and drawing it, and the GPU time of its
+ *   draws, per frame on average since ngl_profile_start() and without the
+ *   time spent in its children
+ * - the GPU memory of its data
+ * - the number of draw calls issued by its subtree in the last frame
+ *
+ * The nodes are colored from green to red according to their share of the
+ * highest cost of the selected metric. The scene is not drawn: the costs are
+ * the ones measured by the profile being recorded, which must have been
+ * started with ngl_profile_start(), and is not stopped.
+ *
+ * Must be destroyed using free().
+ *
+ * @param s         pointer to the node.gl context
+ * @param metric    cost metric coloring the nodes (NGL_DOT_COST_*)
+ *
+ * @return an allocated string in dot format or NULL on error
+ *
+ * @see ngl_profile_start()
+ */
+char *ngl_dot_cost(struct ngl_ctx *s, int metric);
+
+/**
+ * Resources required by the scene at a given time, as estimated by
+ * ngl_analyze()
+ */
+struct ngl_analysis {
+    double t;
+    int nb_active_nodes;      /* Number of nodes active (used, prefetched or
+                                 kept ready for a next use) */
+    int nb_draws;             /* Number of draw calls of the active branches,
+                                 an upper bound (the occlusion culling, levels
+                                 of detail, merged draws and cached render
+                                 targets are not accounted) */
+    int nb_dispatches;        /* Number of compute dispatches */
+    int64_t memory;           /* GPU memory of the active textures, buffers
+                                 and render targets, in bytes */
+    int nb_unknown_sizes;     /* Number of active textures whose dimensions
+                                 are only known once their data is decoded
+                                 (media, images), not accounted in memory */
+    int nb_prefetches;        /* Number of nodes becoming active since the
+                                 previous time */
+    int64_t prefetch_memory;  /* GPU memory allocated by the nodes becoming
+                                 active, in bytes */
+};
+
+/**
+ * Estimate the resources required by the current scene at each of the
+ * specified times, without drawing it nor allocating anything: the scene is
+ * visited at each time to decide the activity of its nodes (following the
+ * time ranges, prefetch and idle times as a draw would), and the GPU memory
+ * is estimated from the parameters of the active textures, buffers and
+ * render targets.
+ *
+ * The times must be increasing; the transitions between two consecutive
+ * times are the prefetches a playback would do. The states of the scene
+ * resources are left untouched.
+ *
+ * @param s         pointer to the node.gl context
+ * @param times     increasing times to analyze the scene at
+ * @param nb_times  number of times
+ * @param analysis  array of nb_times entries filled with the estimations
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_analyze(struct ngl_ctx *s, const double *times, int nb_times, struct ngl_analysis *analysis);
+
+/**
+ * Get the statistics of the last frame drawn. They are always collected, at a
+ * negligible cost.
+ *
+ * @param s         pointer to the node.gl context
+ * @param stats     pointer to the statistics to fill
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_get_stats(struct ngl_ctx *s, struct ngl_stats *stats);
+
+/**
+ * Predict the delay before a frame drawn now gets displayed, from the
+ * presentation times of the previous frames and the estimated refresh period
+ * of the display. Drawing the scene at the time it will be displayed instead
+ * of the time the draw starts keeps the animations smooth when the rendering
+ * time changes or skips a refresh.
+ *
+ * Without a known refresh period (offscreen rendering, swap interval of 0,
+ * first frames), the delay is the average rendering time.
+ *
+ * @param s         pointer to the node.gl context
+ * @param delayp    pointer to the predicted delay in microseconds
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_predict_display_delay(struct ngl_ctx *s, int64_t *delayp);
+
+/**
+ * Get the earliest time at which the scene may differ from the last frame
+ * drawn, to skip the draws until then in slowly changing scenes (slideshows,
+ * holds between animations, low frame rate medias, ...). The time is
+ * reported by the nodes updated by the last ngl_draw(): the next key frame of
+ * an animation holding its value, the next time range of a TimeRangeFilter,
+ * the next decoded frame of a Media, ... A node changing continuously (an
+ * animation between two different key frames, a node unable to tell)
+ * reports the time of the last frame drawn, meaning that every frame needs to
+ * be drawn.
+ *
+ * The time is only valid for a playback going forward from the last frame
+ * drawn, and as long as the scene and its parameters are left untouched;
+ * a frame drawn from the frame cache or any change since the last
+ * ngl_draw() makes it -DBL_MAX, meaning the next frame needs to be drawn
+ * whatever its time.
+ *
+ * @param s     pointer to the node.gl context
+ * @param tp    pointer to the next change time, DBL_MAX if the scene never
+ *              changes anymore
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ *
+ * @see ngl_config.skip_idle_frames
+ */
+int ngl_get_next_change_time(struct ngl_ctx *s, double *tp);
+
+/**
+ * Start recording the time spent in every node of the scene, for each of
+ * the visit, prefetch, update and draw operations on the CPU, and for each
+ * Render, Compute and RenderToTexture on the GPU (when timer queries are
+ * supported). A profile already being recorded is discarded.
+ *
+ * @param s     pointer to the node.gl context
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ *
+ * @see ngl_profile_stop()
+ */
+int ngl_profile_start(struct ngl_ctx *s);
+
+/**
+ * Stop the profile recording started with ngl_profile_start() and export it
+ * in the Chrome trace event JSON format, which can be loaded in
+ * chrome://tracing or in the Perfetto UI.
+ *
+ * The trace must be destroyed using free().
+ *
+ * @param s         pointer to the node.gl context
+ * @param tracep    pointer to the trace string pointer to be set
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_profile_stop(struct ngl_ctx *s, char **tracep);
+
 /**
  * Destroy a node.gl context. The passed context pointer will also be set to
  * NULL.
@@ -463,6 +1655,22 @@ void ngl_freep(struct ngl_ctx **ss);
  */
 int ngl_anim_evaluate(struct ngl_node *anim, void *dst, double t);
 
+/**
+ * Evaluate an animation at multiple times at once, typically for offline
+ * export. Sampling the times in increasing order is the fastest.
+ *
+ * @param anim      the animation node can be any of AnimatedTime,
+ *                  AnimatedFloat, AnimatedVec2, AnimatedVec3, or AnimatedVec4
+ * @param dst       pointer to the destination for the interpolated values,
+ *                  needs to hold nb_times consecutive values of the type of
+ *                  anim (see ngl_anim_evaluate(), AnimatedTime is double[1])
+ * @param times     the target times at which to interpolate the values
+ * @param nb_times  the number of elements in times
+ *
+ * @return 0 on success, NGL_ERROR_* (< 0) on error
+ */
+int ngl_anim_evaluate_batch(struct ngl_node *anim, void *dst, const double *times, int nb_times);
+
 /**
  * Evaluate an easing at a given time t
  *
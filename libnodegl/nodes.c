@@ -19,6 +19,8 @@
  * under the License.
  */
 
+#include <float.h>
+#include <inttypes.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -56,23 +58,23 @@ const struct node_param ngli_base_node_params[] = {
     {NULL}
 };
 
-static void *aligned_allocz(size_t size)
-{
-    void *ptr = ngli_malloc_aligned(size);
-    if (!ptr)
-        return NULL;
-    memset(ptr, 0, size);
-    return ptr;
-}
-
-static struct ngl_node *node_create(const struct node_class *class)
+static struct ngl_node *node_create(const struct node_class *class, struct arena *arena)
 {
     struct ngl_node *node;
     const size_t node_size = NGLI_ALIGN(sizeof(*node), NGLI_ALIGN_VAL);
-
-    node = aligned_allocz(node_size + class->priv_size);
-    if (!node)
-        return NULL;
+    const size_t size = node_size + class->priv_size;
+
+    if (arena) {
+        node = ngli_arena_alloc(arena, size);
+        if (!node)
+            return NULL;
+        memset(node, 0, size);
+        node->arena = ngli_arena_ref(arena);
+    } else {
+        node = ngli_calloc_tagged(1, size, NGLI_MEMTAG_NODES);
+        if (!node)
+            return NULL;
+    }
     node->priv_data = ((uint8_t *)node) + node_size;
 
     /* Make sure the node and its private data are properly aligned */
@@ -113,9 +115,11 @@ int ngli_is_default_label(const char *class_name, const char *str)
     return 1;
 }
 
+#define CLASS_LIST(type_name, class) extern const struct node_class class;
+NODE_MAP_TYPE2CLASS(CLASS_LIST)
+
 #define REGISTER_NODE(type_name, class)         \
     case type_name: {                           \
-        extern const struct node_class class;   \
         ngli_assert(class.id == type_name);     \
         return &class;                          \
     }                                           \
@@ -128,7 +132,98 @@ static const struct node_class *get_node_class(int type)
     return NULL;
 }
 
-struct ngl_node *ngli_node_create_noconstructor(int type)
+/*
+ * The params of every class are indexed in an open addressing hash table,
+ * built for all the classes at once on the first lookup. A slot holds the
+ * index of a param in the class params plus one, 0 marking an empty slot.
+ */
+struct param_index {
+    int nb_params;
+    uint32_t mask;
+    int16_t *slots;
+};
+
+#define CLASS_ENUM(type_name, class) CLASS_INDEX_##class,
+enum {
+    NODE_MAP_TYPE2CLASS(CLASS_ENUM)
+    NB_NODE_CLASSES
+};
+
+#define CLASS_INDEX_CASE(type_name, class) case type_name: return CLASS_INDEX_##class;
+
+static int get_class_index(int type)
+{
+    switch (type) {
+        NODE_MAP_TYPE2CLASS(CLASS_INDEX_CASE)
+    }
+    return -1;
+}
+
+static struct param_index param_indexes[NB_NODE_CLASSES];
+static pthread_once_t param_indexes_once = PTHREAD_ONCE_INIT;
+
+static uint32_t hash_key(const char *key)
+{
+    uint32_t hash = 0x811c9dc5;
+    for (int i = 0; key[i]; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+#define CLASS_COMMALIST(type_name, class) &class,
+
+static void build_param_indexes(void)
+{
+    static const struct node_class * const node_classes[] = {
+        NODE_MAP_TYPE2CLASS(CLASS_COMMALIST)
+    };
+
+    for (int i = 0; i < NB_NODE_CLASSES; i++) {
+        const struct node_param *params = node_classes[i]->params;
+        struct param_index *index = &param_indexes[i];
+        while (params && params[index->nb_params].key)
+            index->nb_params++;
+
+        /* At most half of the slots are used so the probe sequences remain short */
+        uint32_t size = 1;
+        while (size < 2 * index->nb_params)
+            size <<= 1;
+
+        /* On allocation failure, the lookups fall back on a linear search */
+        index->slots = ngli_calloc(size, sizeof(*index->slots));
+        if (!index->slots)
+            continue;
+        index->mask = size - 1;
+
+        for (int id = 0; id < index->nb_params; id++) {
+            uint32_t slot = hash_key(params[id].key) & index->mask;
+            while (index->slots[slot])
+                slot = (slot + 1) & index->mask;
+            index->slots[slot] = id + 1;
+        }
+    }
+}
+
+static const struct node_param *find_class_param(const struct node_class *class, const char *key)
+{
+    pthread_once(&param_indexes_once, build_param_indexes);
+
+    const struct node_param *params = class->params;
+    const struct param_index *index = &param_indexes[get_class_index(class->id)];
+    if (!index->slots)
+        return ngli_params_find(params, key);
+
+    for (uint32_t slot = hash_key(key) & index->mask; index->slots[slot]; slot = (slot + 1) & index->mask) {
+        const struct node_param *par = &params[index->slots[slot] - 1];
+        if (!strcmp(par->key, key))
+            return par;
+    }
+    return NULL;
+}
+
+struct ngl_node *ngli_node_create_noconstructor(int type, struct arena *arena)
 {
     const struct node_class *class = get_node_class(type);
     if (!class) {
@@ -136,7 +231,7 @@ struct ngl_node *ngli_node_create_noconstructor(int type)
         return NULL;
     }
 
-    struct ngl_node *node = node_create(class);
+    struct ngl_node *node = node_create(class, arena);
     if (!node)
         return NULL;
 
@@ -157,7 +252,7 @@ struct ngl_node *ngli_node_create_noconstructor(int type)
 
 struct ngl_node *ngl_node_create(int type, ...)
 {
-    struct ngl_node *node = ngli_node_create_noconstructor(type);
+    struct ngl_node *node = ngli_node_create_noconstructor(type, NULL);
     if (!node)
         return NULL;
 
@@ -190,6 +285,24 @@ static void node_release(struct ngl_node *node)
     node->last_update_time = -1.;
 }
 
+static void cancel_deferred_release(struct ngl_node *node)
+{
+    if (!node->release_deadline)
+        return;
+
+    struct darray *deferred = &node->ctx->deferred_releases;
+    struct ngl_node **nodes = ngli_darray_data(deferred);
+    const int nb_nodes = ngli_darray_count(deferred);
+    for (int i = 0; i < nb_nodes; i++) {
+        if (nodes[i] == node) {
+            memmove(&nodes[i], &nodes[i + 1], (nb_nodes - i - 1) * sizeof(*nodes));
+            deferred->count--;
+            break;
+        }
+    }
+    node->release_deadline = 0;
+}
+
 /*
  * Reset every field of the private data which is not a parameter. This allows
  * the init() to always be called in a clean state.
@@ -216,7 +329,7 @@ static void node_uninit(struct ngl_node *node)
         return;
 
     ngli_assert(node->ctx);
-    ngli_darray_reset(&node->children);
+    cancel_deferred_release(node);
     node_release(node);
 
     if (node->class->uninit) {
@@ -225,10 +338,13 @@ static void node_uninit(struct ngl_node *node)
     }
     reset_non_params(node);
     node->state = STATE_UNINITIALIZED;
+    node->cpu_initialized = 0;
     node->visit_time = -1.;
+    node->activity_gen = 0;
 }
 
-static int track_children(struct ngl_node *node)
+/* Push the node children into an array of struct ngl_node * */
+static int list_children(struct ngl_node *node, struct darray *children)
 {
     uint8_t *base_ptr = node->priv_data;
     const struct node_param *par = node->class->params;
@@ -241,7 +357,7 @@ static int track_children(struct ngl_node *node)
             case PARAM_TYPE_NODE: {
                 uint8_t *child_p = base_ptr + par->offset;
                 struct ngl_node *child = *(struct ngl_node **)child_p;
-                if (child && !ngli_darray_push(&node->children, &child))
+                if (child && !ngli_darray_push(children, &child))
                     return NGL_ERROR_MEMORY;
                 break;
             }
@@ -251,7 +367,7 @@ static int track_children(struct ngl_node *node)
                 struct ngl_node **elems = *(struct ngl_node ***)elems_p;
                 const int nb_elems = *(int *)nb_elems_p;
                 for (int i = 0; i < nb_elems; i++)
-                    if (!ngli_darray_push(&node->children, &elems[i]))
+                    if (!ngli_darray_push(children, &elems[i]))
                         return NGL_ERROR_MEMORY;
                 break;
             }
@@ -261,7 +377,7 @@ static int track_children(struct ngl_node *node)
                     break;
                 const struct hmap_entry *entry = NULL;
                 while ((entry = ngli_hmap_next(hmap, entry)))
-                    if (!ngli_darray_push(&node->children, &entry->data))
+                    if (!ngli_darray_push(children, &entry->data))
                         return NGL_ERROR_MEMORY;
                 break;
             }
@@ -272,28 +388,36 @@ static int track_children(struct ngl_node *node)
     return 0;
 }
 
+static int node_cpu_init(struct ngl_node *node)
+{
+    LOG(VERBOSE, "CPU INIT %s @ %p", node->label, node);
+    node->cpu_initialized = 1;
+    int ret = node->class->cpu_init(node);
+    if (ret < 0)
+        LOG(ERROR, "initializing node %s failed: %s", node->label, NGLI_RET_STR(ret));
+    return ret;
+}
+
 static int node_init(struct ngl_node *node)
 {
     if (node->state != STATE_UNINITIALIZED)
         return 0;
 
-    ngli_darray_init(&node->children, sizeof(struct ngl_node *), 0);
-
     ngli_assert(node->ctx);
-    if (node->class->init) {
+    int ret = 0;
+    if (node->class->cpu_init && !node->cpu_initialized)
+        ret = node_cpu_init(node);
+    if (ret >= 0 && node->class->init) {
         LOG(VERBOSE, "INIT %s @ %p", node->label, node);
-        int ret = node->class->init(node);
-        if (ret < 0) {
+        ret = node->class->init(node);
+        if (ret < 0)
             LOG(ERROR, "initializing node %s failed: %s", node->label, NGLI_RET_STR(ret));
-            node->state = STATE_INIT_FAILED;
-            node_uninit(node);
-            return ret;
-        }
     }
-
-    int ret = track_children(node);
-    if (ret < 0)
+    if (ret < 0) {
+        node->state = STATE_INIT_FAILED;
+        node_uninit(node);
         return ret;
+    }
 
     if (node->class->prefetch)
         node->state = STATE_INITIALIZED;
@@ -305,52 +429,39 @@ static int node_init(struct ngl_node *node)
 
 static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx, struct ngl_ctx *pctx);
 
-static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *params,
-                                 struct ngl_ctx *ctx, struct ngl_ctx *pctx)
+static void detach_children(struct ngl_node **children, int nb_children, struct ngl_ctx *ctx)
 {
-    if (!params)
-        return 0;
-    for (int i = 0; params[i].key; i++) {
-        const struct node_param *par = &params[i];
-
-        if (par->type == PARAM_TYPE_NODE) {
-            uint8_t *node_p = base_ptr + par->offset;
-            struct ngl_node *node = *(struct ngl_node **)node_p;
-            if (node) {
-                int ret = node_set_ctx(node, ctx, pctx);
-                if (ret < 0)
-                    return ret;
-            }
-        } else if (par->type == PARAM_TYPE_NODELIST) {
-            uint8_t *elems_p = base_ptr + par->offset;
-            uint8_t *nb_elems_p = base_ptr + par->offset + sizeof(struct ngl_node **);
-            struct ngl_node **elems = *(struct ngl_node ***)elems_p;
-            const int nb_elems = *(int *)nb_elems_p;
-            for (int j = 0; j < nb_elems; j++) {
-                int ret = node_set_ctx(elems[j], ctx, pctx);
-                if (ret < 0)
-                    return ret;
-            }
-        } else if (par->type == PARAM_TYPE_NODEDICT) {
-            struct hmap *hmap = *(struct hmap **)(base_ptr + par->offset);
-            if (!hmap)
-                continue;
-            const struct hmap_entry *entry = NULL;
-            while ((entry = ngli_hmap_next(hmap, entry))) {
-                struct ngl_node *node = entry->data;
-                int ret = node_set_ctx(node, ctx, pctx);
-                if (ret < 0)
-                    return ret;
-            }
+    for (int i = 0; i < nb_children; i++) {
+        int ret = node_set_ctx(children[i], NULL, ctx);
+        ngli_assert(ret == 0);
+    }
+}
+
+static int attach_children(struct ngl_node *node, struct ngl_ctx *ctx)
+{
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    const int nb_children = ngli_darray_count(&node->children);
+    for (int i = 0; i < nb_children; i++) {
+        int ret = node_set_ctx(children[i], ctx, ctx);
+        if (ret < 0) {
+            /* Only the references taken by this node are dropped */
+            detach_children(children, i, ctx);
+            return ret;
         }
     }
     return 0;
 }
 
+/*
+ * The context reference count of a node is the number of references held on
+ * it by its attached parents (and by the attach calls on the node itself).
+ * The children of a node are only attached along with the first reference
+ * and detached along with the last one, so every node of a graph is visited
+ * once per parent link instead of once per path from the root, no matter how
+ * heavily its subtrees are shared. A failed attach leaves no reference behind.
+ */
 static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx, struct ngl_ctx *pctx)
 {
-    int ret;
-
     /*
      * If node_set_ctx is used to attach a new context (ctx != NULL), the
      * context and the parent must be equal. This is not the case if
@@ -358,43 +469,192 @@ static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx, struct ngl_c
      */
     ngli_assert(!ctx || ctx == pctx);
 
-    if (ctx) {
-        if (node->ctx && node->ctx != ctx) {
+    if (!ctx) {
+        if (node->ctx != pctx)
+            return 0;
+        ngli_assert(node->ctx_refcount > 0);
+        if (--node->ctx_refcount > 0)
+            return 0;
+
+        /* The node is uninitialized before the children it may rely on */
+        struct darray children = node->children;
+        ngli_darray_init(&node->children, sizeof(struct ngl_node *), 0);
+        node_uninit(node);
+        node->ctx = NULL;
+        detach_children(ngli_darray_data(&children), ngli_darray_count(&children), pctx);
+        ngli_darray_reset(&children);
+        return 0;
+    }
+
+    if (node->ctx) {
+        if (node->ctx != ctx) {
             LOG(ERROR, "\"%s\" is associated with another rendering context", node->label);
             return NGL_ERROR_INVALID_USAGE;
         }
-    } else {
-        if (node->state > STATE_UNINITIALIZED) {
-            if (node->ctx != pctx)
-                return 0;
-            if (node->ctx_refcount-- == 1) {
-                node_uninit(node);
-                node->ctx = NULL;
-            }
-        }
-        ngli_assert(node->ctx_refcount >= 0);
+        node->ctx_refcount++;
+        return 0;
     }
 
-    if ((ret = node_set_children_ctx(node->priv_data, node->class->params, ctx, pctx)) < 0 ||
-        (ret = node_set_children_ctx((uint8_t *)node, ngli_base_node_params, ctx, pctx)) < 0)
+    ngli_darray_init(&node->children, sizeof(struct ngl_node *), 0);
+    int ret = list_children(node, &node->children);
+    if (ret < 0 || (ret = attach_children(node, ctx)) < 0) {
+        ngli_darray_reset(&node->children);
         return ret;
+    }
 
-    if (ctx) {
-        node->ctx = ctx;
-        ret = node_init(node);
-        if (ret < 0) {
-            node->ctx = NULL;
-            return ret;
-        }
-        node->ctx_refcount++;
+    node->ctx = ctx;
+    ret = node_init(node);
+    if (ret < 0) {
+        node->ctx = NULL;
+        detach_children(ngli_darray_data(&node->children), ngli_darray_count(&node->children), ctx);
+        ngli_darray_reset(&node->children);
+        return ret;
     }
+    node->ctx_refcount = 1;
 
     return 0;
 }
 
+static int bake_job(void *arg, int index)
+{
+    const struct ngl_ctx *ctx = arg;
+    const struct animation_bake *bakes = ngli_darray_data(&ctx->animation_bakes);
+    const struct animation_bake *bake = &bakes[index];
+    const int *rate = ctx->config.animation_bake_rate;
+    return ngli_animation_bake(bake->anim, bake->nb_comps, rate[0] / (double)rate[1]);
+}
+
+static int bake_animations(struct ngl_ctx *ctx)
+{
+    const int nb_bakes = ngli_darray_count(&ctx->animation_bakes);
+    if (!nb_bakes)
+        return 0;
+
+    if (!ctx->jobpool) {
+        for (int i = 0; i < nb_bakes; i++) {
+            int ret = bake_job(ctx, i);
+            if (ret < 0)
+                return ret;
+        }
+        return 0;
+    }
+
+    /* The job pool only runs one batch at a time */
+    ngli_node_wait_cpu_update(ctx);
+    return ngli_jobpool_run(ctx->jobpool, bake_job, ctx, nb_bakes);
+}
+
+/*
+ * Collect the nodes of a graph which are about to be initialized by its
+ * attach (the ones not attached yet) and have a CPU-only initialization part
+ */
+static int collect_cpu_inits(struct ngl_ctx *ctx, struct ngl_node *root, struct darray *nodes)
+{
+    struct darray stack;
+    ngli_darray_init(&stack, sizeof(struct ngl_node *), 0);
+    if (!ngli_darray_push(&stack, &root))
+        return NGL_ERROR_MEMORY;
+
+    /* Every shared node is only visited once */
+    ctx->attach_gen++;
+
+    int ret = 0;
+    while (ngli_darray_count(&stack)) {
+        struct ngl_node *node = *(struct ngl_node **)ngli_darray_pop(&stack);
+        if (node->ctx || node->attach_gen == ctx->attach_gen)
+            continue;
+        node->attach_gen = ctx->attach_gen;
+
+        if (node->class->cpu_init && !node->cpu_initialized &&
+            !ngli_darray_push(nodes, &node)) {
+            ret = NGL_ERROR_MEMORY;
+            break;
+        }
+
+        ret = list_children(node, &stack);
+        if (ret < 0)
+            break;
+    }
+
+    ngli_darray_reset(&stack);
+    return ret;
+}
+
+struct cpu_init_batch {
+    struct ngl_ctx *ctx;
+    struct ngl_node **nodes;
+};
+
+/* The context is only set during the cpu_init() for its image cache */
+static int cpu_init_job(void *arg, int index)
+{
+    const struct cpu_init_batch *batch = arg;
+    struct ngl_node *node = batch->nodes[index];
+    node->ctx = batch->ctx;
+    int ret = node_cpu_init(node);
+    node->ctx = NULL;
+    return ret;
+}
+
+static int cpu_init_nodes(struct ngl_ctx *ctx, const struct darray *nodes)
+{
+    struct cpu_init_batch batch = {
+        .ctx = ctx,
+        .nodes = ngli_darray_data(nodes),
+    };
+    const int nb_nodes = ngli_darray_count(nodes);
+    if (!ctx->jobpool || nb_nodes < 2) {
+        for (int i = 0; i < nb_nodes; i++) {
+            int ret = cpu_init_job(&batch, i);
+            if (ret < 0)
+                return ret;
+        }
+        return 0;
+    }
+
+    /* The job pool only runs one batch at a time */
+    ngli_node_wait_cpu_update(ctx);
+    return ngli_jobpool_run(ctx->jobpool, cpu_init_job, &batch, nb_nodes);
+}
+
+/* Uninit the nodes left with only their cpu_init() done by a failed attach */
+static void reset_cpu_inits(struct ngl_ctx *ctx, const struct darray *nodes)
+{
+    struct ngl_node **nodes_data = ngli_darray_data(nodes);
+    for (int i = 0; i < ngli_darray_count(nodes); i++) {
+        struct ngl_node *node = nodes_data[i];
+        if (!node->cpu_initialized || node->state != STATE_UNINITIALIZED)
+            continue;
+        node->ctx = ctx;
+        if (node->class->uninit)
+            node->class->uninit(node);
+        reset_non_params(node);
+        node->ctx = NULL;
+        node->cpu_initialized = 0;
+    }
+}
+
+/*
+ * The CPU-only part of the initialization of the nodes runs first, spread
+ * over the job pool, before the nodes are initialized one at a time
+ */
 int ngli_node_attach_ctx(struct ngl_node *node, struct ngl_ctx *ctx)
 {
-    return node_set_ctx(node, ctx, ctx);
+    struct darray cpu_inits;
+    ngli_darray_init(&cpu_inits, sizeof(struct ngl_node *), 0);
+
+    int ret = collect_cpu_inits(ctx, node, &cpu_inits);
+    if (ret >= 0)
+        ret = cpu_init_nodes(ctx, &cpu_inits);
+    if (ret >= 0)
+        ret = node_set_ctx(node, ctx, ctx);
+    if (ret >= 0)
+        ret = bake_animations(ctx);
+    ctx->animation_bakes.count = 0;
+
+    reset_cpu_inits(ctx, &cpu_inits);
+    ngli_darray_reset(&cpu_inits);
+    return ret;
 }
 
 void ngli_node_detach_ctx(struct ngl_node *node, struct ngl_ctx *ctx)
@@ -403,7 +663,21 @@ void ngli_node_detach_ctx(struct ngl_node *node, struct ngl_ctx *ctx)
     ngli_assert(ret == 0);
 }
 
-int ngli_node_visit(struct ngl_node *node, int is_active, double t)
+void ngli_node_restrict_activity_bounds(struct ngl_node *node, double start, double end)
+{
+    node->activity_bounds[0] = NGLI_MAX(node->activity_bounds[0], start);
+    node->activity_bounds[1] = NGLI_MIN(node->activity_bounds[1], end);
+}
+
+static int can_skip_visit(const struct ngl_node *node, double t)
+{
+    const struct ngl_ctx *ctx = node->ctx;
+    return !ctx->visit_noskip &&
+           node->activity_gen == ctx->activity_gen &&
+           t >= node->activity_bounds[0] && t < node->activity_bounds[1];
+}
+
+static int node_visit(struct ngl_node *node, int is_active, double t)
 {
     /*
      * If a node is inactive and meant to be, there is no need
@@ -414,19 +688,45 @@ int ngli_node_visit(struct ngl_node *node, int is_active, double t)
      * On the other hand, we cannot do the same if the node is active, because
      * we have to mark every node below for activity to prevent an early
      * release from another branch.
+     *
+     * The nodes kept ready while inactive (see ngli_node_holds_resources())
+     * are the exception: they are visited once the hold ends so they get
+     * released.
      */
-    if (!is_active && !node->is_active)
+    struct ngl_ctx *ctx = node->ctx;
+    if (!is_active && !node->is_active && !(ctx->visit_release_held && node->state == STATE_READY))
         return 0;
 
     const int queue_node = node->visit_time != t;
 
     if (queue_node) {
+        node->visit_skipped = 0;
+
+        /*
+         * If the node was active and the activity of its whole subtree is
+         * known to be stable at this time, visiting it again would produce
+         * the exact same states, so we skip it entirely. The nodes below are
+         * not marked for this time, which means a shared node could be
+         * flagged inactive by another branch; this is addressed by
+         * ngli_node_revisit_skipped() whenever a release is planned.
+         */
+        if (is_active && node->is_active && can_skip_visit(node, t)) {
+            node->visit_time = t;
+            node->visit_skipped = 1;
+            if (!ngli_darray_push(&ctx->visit_skipped_nodes, &node))
+                return NGL_ERROR_MEMORY;
+            return 0;
+        }
+
         /*
          * If we never passed through this node for that given time, the new
          * active state takes over to replace the one from a previous update.
          */
         node->is_active = is_active;
         node->visit_time = t;
+        node->activity_bounds[0] = -DBL_MAX;
+        node->activity_bounds[1] =  DBL_MAX;
+        node->activity_gen = ctx->activity_gen;
     } else {
         /*
          * This is not the first time we come across that node, so if it's
@@ -434,6 +734,8 @@ int ngli_node_visit(struct ngl_node *node, int is_active, double t)
          * get released.
          */
         node->is_active |= is_active;
+        if (node->visit_skipped)
+            return 0;
     }
 
     if (node->class->visit) {
@@ -448,15 +750,61 @@ int ngli_node_visit(struct ngl_node *node, int is_active, double t)
             int ret = ngli_node_visit(child, is_active, t);
             if (ret < 0)
                 return ret;
+            if (is_active)
+                ngli_node_restrict_activity_bounds(node, child->activity_bounds[0],
+                                                         child->activity_bounds[1]);
         }
     }
 
-    if (queue_node && !ngli_darray_push(&node->ctx->activitycheck_nodes, &node))
-        return NGL_ERROR_MEMORY;
+    if (queue_node) {
+        if (!ngli_darray_push(&ctx->activitycheck_nodes, &node))
+            return NGL_ERROR_MEMORY;
+        if (!is_active && node->state == STATE_READY)
+            ctx->visit_has_release = 1;
+    }
 
     return 0;
 }
 
+int ngli_node_visit(struct ngl_node *node, int is_active, double t)
+{
+    struct profiler *profiler = &node->ctx->profiler;
+    if (!profiler->active)
+        return node_visit(node, is_active, t);
+
+    const int64_t start = ngli_gettime();
+    int ret = node_visit(node, is_active, t);
+    ngli_profiler_add(profiler, NGLI_PROFILER_VISIT, node, node->label, node->class->name,
+                      start, ngli_gettime() - start);
+    return ret;
+}
+
+int ngli_node_revisit_skipped(struct ngl_ctx *ctx, double t)
+{
+    int ret = 0;
+    struct darray *nodes_array = &ctx->visit_skipped_nodes;
+    struct ngl_node **nodes = ngli_darray_data(nodes_array);
+    const int nb_nodes = ngli_darray_count(nodes_array);
+
+    /*
+     * Fully visit again the skipped subtrees so the nodes they share with
+     * another branch are marked as active before being released.
+     */
+    ctx->visit_noskip = 1;
+    for (int i = 0; i < nb_nodes; i++) {
+        struct ngl_node *node = nodes[i];
+        node->visit_skipped = 0;
+        node->visit_time = -1.;
+        ret = ngli_node_visit(node, 1, t);
+        if (ret < 0)
+            break;
+    }
+    ctx->visit_noskip = 0;
+    nodes_array->count = 0;
+
+    return ret;
+}
+
 static int node_prefetch(struct ngl_node *node)
 {
     if (node->state == STATE_READY)
@@ -464,7 +812,18 @@ static int node_prefetch(struct ngl_node *node)
 
     if (node->class->prefetch) {
         TRACE("PREFETCH %s @ %p", node->label, node);
+        struct profiler *profiler = &node->ctx->profiler;
+        const int64_t start = ngli_gettime();
         int ret = node->class->prefetch(node);
+        const int64_t duration = ngli_gettime() - start;
+        if (profiler->active)
+            ngli_profiler_add(profiler, NGLI_PROFILER_PREFETCH, node, node->label, node->class->name,
+                              start, duration);
+        if (ret >= 0) {
+            /* The first update (typically the first decoded frame) completes the startup */
+            node->pending_startup_cost = duration;
+            node->startup_pending = 1;
+        }
         if (ret < 0) {
             LOG(ERROR, "prefetching node %s failed: %s", node->label, NGLI_RET_STR(ret));
             node->visit_time = -1.;
@@ -480,49 +839,434 @@ static int node_prefetch(struct ngl_node *node)
     return 0;
 }
 
+static int defer_release(struct ngl_node *node)
+{
+    if (node->release_deadline)
+        return 0;
+
+    struct ngl_ctx *ctx = node->ctx;
+    if (!ngli_darray_push(&ctx->deferred_releases, &node))
+        return NGL_ERROR_MEMORY;
+    node->release_deadline = ngli_gettime() + ctx->config.release_delay * 1000LL;
+    return 0;
+}
+
 int ngli_node_honor_release_prefetch(struct darray *nodes_array)
 {
     struct ngl_node **nodes = ngli_darray_data(nodes_array);
     for (int i = 0; i < ngli_darray_count(nodes_array); i++) {
         struct ngl_node *node = nodes[i];
+        struct ngl_ctx *ctx = node->ctx;
 
         if (node->is_active) {
             int ret = node_prefetch(node);
             if (ret < 0)
                 return ret;
-        } else {
+        } else if (!ngli_node_holds_resources(ctx)) {
+            if (ctx->config.release_delay > 0 && node->state == STATE_READY) {
+                int ret = defer_release(node);
+                if (ret < 0)
+                    return ret;
+            } else {
+                node_release(node);
+            }
+        }
+    }
+    return 0;
+}
+
+static int exceeds_memory(const struct ngl_ctx *ctx, int limit)
+{
+    const int64_t *memory = ctx->stats.memory;
+    return limit > 0 && memory[NGL_STATS_MEMORY_BUFFERS] +
+                        memory[NGL_STATS_MEMORY_TEXTURES] +
+                        memory[NGL_STATS_MEMORY_RENDERBUFFERS] > limit * 1024LL * 1024;
+}
+
+static int over_memory_limit(const struct ngl_ctx *ctx)
+{
+    return exceeds_memory(ctx, ctx->config.release_memory_limit) ||
+           exceeds_memory(ctx, ctx->config.gpu_memory_budget);
+}
+
+/*
+ * Drop from the deferred releases the nodes which became active again, and
+ * release the inactive ones whose deadline expired. The queue is ordered by
+ * deadline, so when the memory limit is exceeded the nodes inactive for the
+ * longest time are released first.
+ */
+void ngli_node_release_deferred(struct ngl_ctx *ctx)
+{
+    if (ngli_node_holds_resources(ctx))
+        return;
+
+    struct ngl_node **nodes = ngli_darray_data(&ctx->deferred_releases);
+    const int nb_nodes = ngli_darray_count(&ctx->deferred_releases);
+    const int64_t now = nb_nodes ? ngli_gettime() : 0;
+    int nb_kept = 0;
+    for (int i = 0; i < nb_nodes; i++) {
+        struct ngl_node *node = nodes[i];
+        if (!node->is_active) {
+            const int expired = ctx->config.release_delay <= 0 ||
+                                now >= node->release_deadline ||
+                                over_memory_limit(ctx);
+            if (!expired) {
+                nodes[nb_kept++] = node;
+                continue;
+            }
             node_release(node);
         }
+        node->release_deadline = 0;
+    }
+    ctx->deferred_releases.count = nb_kept;
+}
+
+int ngli_node_keep_idle(struct ngl_node *node, int64_t idle_since)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    if (ctx->config.gpu_memory_budget <= 0)
+        return 1;
+    if (node == ctx->evicted_idle_node)
+        return 0;
+
+    const struct idle_node idle_node = {
+        .node = node,
+        .idle_since = idle_since,
+    };
+    if (!ngli_darray_push(&ctx->idle_nodes, &idle_node))
+        return NGL_ERROR_MEMORY;
+    return 1;
+}
+
+int ngli_node_exceeds_memory_budget(const struct ngl_ctx *ctx)
+{
+    return exceeds_memory(ctx, ctx->config.gpu_memory_budget);
+}
+
+/* Whether the inactive nodes are kept ready (batch drawing or warmed up range) */
+int ngli_node_holds_resources(const struct ngl_ctx *ctx)
+{
+    return ctx->hold_resources || ctx->warmup_hold;
+}
+
+void ngli_node_evict_idle(struct ngl_ctx *ctx)
+{
+    ctx->evicted_idle_node = NULL;
+
+    if (!ngli_node_holds_resources(ctx) && exceeds_memory(ctx, ctx->config.gpu_memory_budget)) {
+        const struct idle_node *idle_nodes = ngli_darray_data(&ctx->idle_nodes);
+        const struct idle_node *lru = NULL;
+        for (int i = 0; i < ngli_darray_count(&ctx->idle_nodes); i++) {
+            if (!lru || idle_nodes[i].idle_since < lru->idle_since)
+                lru = &idle_nodes[i];
+        }
+        if (lru) {
+            LOG(DEBUG, "GPU memory budget exceeded, release the idle subtree of %s", lru->node->label);
+            ctx->evicted_idle_node = lru->node;
+        }
+    }
+
+    ctx->idle_nodes.count = 0;
+}
+
+static void commit_startup_cost(struct ngl_node *node, int64_t cost)
+{
+    node->startup_cost = node->startup_cost ? (node->startup_cost + cost) / 2 : NGLI_MAX(cost, 1);
+    node->startup_pending = 0;
+}
+
+int64_t ngli_node_get_startup_cost(const struct ngl_node *node)
+{
+    int64_t cost = node->startup_cost;
+    struct ngl_node * const *children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++)
+        cost += ngli_node_get_startup_cost(children[i]);
+    return cost;
+}
+
+#define PREFETCH_FRAME_BUDGET 4000 /* µs */
+
+int ngli_node_schedule_prefetch(struct ngl_ctx *ctx, int64_t cost)
+{
+    if (ctx->nb_scheduled_prefetches && ctx->scheduled_prefetch_cost + cost > PREFETCH_FRAME_BUDGET)
+        return 0;
+    ctx->nb_scheduled_prefetches++;
+    ctx->scheduled_prefetch_cost += cost;
+    return 1;
+}
+
+int ngli_node_defer_upload(struct ngl_node *node, int64_t size)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    if (ctx->config.prefetch_upload_budget <= 0 || !node->class->upload)
+        return 0;
+
+    if (size <= ctx->upload_budget) {
+        ctx->upload_budget -= size;
+        return 0;
+    }
+
+    if (!node->pending_upload_size && !ngli_darray_push(&ctx->deferred_uploads, &node))
+        return NGL_ERROR_MEMORY;
+    node->pending_upload_size = size;
+    return 1;
+}
+
+static int64_t run_upload(struct ngl_node *node, int64_t max_size)
+{
+    TRACE("UPLOAD %s @ %p (%" PRId64 "/%" PRId64 " bytes)",
+          node->label, node, NGLI_MIN(max_size, node->pending_upload_size), node->pending_upload_size);
+    const int64_t ret = node->class->upload(node, max_size);
+    if (ret < 0) {
+        LOG(ERROR, "uploading the data of %s failed: %s", node->label, NGLI_RET_STR(ret));
+        return ret;
+    }
+    const int64_t uploaded = node->pending_upload_size - ret;
+    node->pending_upload_size = ret;
+    return uploaded;
+}
+
+static void remove_deferred_upload(struct ngl_node *node)
+{
+    struct darray *deferred_uploads = &node->ctx->deferred_uploads;
+    struct ngl_node **nodes = ngli_darray_data(deferred_uploads);
+    const int nb_nodes = ngli_darray_count(deferred_uploads);
+    for (int i = 0; i < nb_nodes; i++) {
+        if (nodes[i] == node) {
+            memmove(&nodes[i], &nodes[i + 1], (nb_nodes - i - 1) * sizeof(*nodes));
+            deferred_uploads->count--;
+            break;
+        }
     }
+    node->pending_upload_size = 0;
+}
+
+int ngli_node_finish_upload(struct ngl_node *node)
+{
+    if (!node->pending_upload_size)
+        return 0;
+    const int64_t ret = run_upload(node, INT64_MAX);
+    if (ret < 0)
+        return ret;
+    ngli_assert(!node->pending_upload_size);
+    remove_deferred_upload(node);
+    return 0;
+}
+
+void ngli_node_cancel_upload(struct ngl_node *node)
+{
+    if (node->pending_upload_size)
+        remove_deferred_upload(node);
+}
+
+/* The nodes prefetched first are the ones completed first */
+int ngli_node_run_deferred_uploads(struct ngl_ctx *ctx)
+{
+    struct ngl_node **nodes = ngli_darray_data(&ctx->deferred_uploads);
+    const int nb_nodes = ngli_darray_count(&ctx->deferred_uploads);
+    int nb_kept = 0;
+    int ret = 0;
+    for (int i = 0; i < nb_nodes; i++) {
+        struct ngl_node *node = nodes[i];
+        if (ret >= 0 && ctx->upload_budget > 0) {
+            const int64_t uploaded = run_upload(node, ctx->upload_budget);
+            if (uploaded < 0)
+                ret = uploaded;
+            else
+                ctx->upload_budget = NGLI_MAX(ctx->upload_budget - uploaded, 0);
+        }
+        if (node->pending_upload_size)
+            nodes[nb_kept++] = node;
+    }
+    ctx->deferred_uploads.count = nb_kept;
+    return ret;
+}
+
+void ngli_node_restrict_next_change(struct ngl_node *node, double t)
+{
+    node->next_change_time = NGLI_MIN(node->next_change_time, t);
+}
+
+static void reset_next_change(struct ngl_node *node, double t)
+{
+    node->next_change_time = node->class->flags & NGLI_NODE_FLAG_REPORTS_CHANGES ? DBL_MAX : t;
+}
+
+static int update_changed(const struct ngl_node *node, int ret)
+{
+    return ret > 0 || node->last_update_time == -1. ||
+           !(node->class->flags & NGLI_NODE_FLAG_REPORTS_CHANGES);
+}
+
+int ngli_node_record_texture_read(struct ngl_ctx *ctx, struct ngl_node *node)
+{
+    struct darray *texture_reads = ctx->texture_reads;
+    struct ngl_node **textures = ngli_darray_data(texture_reads);
+    for (int i = 0; i < ngli_darray_count(texture_reads); i++)
+        if (textures[i] == node)
+            return 0;
+    if (!ngli_darray_push(texture_reads, &node))
+        return NGL_ERROR_MEMORY;
     return 0;
 }
 
 int ngli_node_update(struct ngl_node *node, double t)
 {
     ngli_assert(node->state == STATE_READY);
+    if (node->pending_upload_size) {
+        int ret = ngli_node_finish_upload(node);
+        if (ret < 0)
+            return ret;
+    }
+    if (node->ctx->texture_reads && node->class->category == NGLI_NODE_CATEGORY_TEXTURE) {
+        int ret = ngli_node_record_texture_read(node->ctx, node);
+        if (ret < 0)
+            return ret;
+    }
+    if (node->startup_pending && !node->class->update)
+        commit_startup_cost(node, node->pending_startup_cost);
     if (node->class->update) {
         if (node->last_update_time != t) {
             TRACE("UPDATE %s @ %p with t=%g", node->label, node, t);
+            struct profiler *profiler = &node->ctx->profiler;
+            const int64_t start = profiler->active || node->startup_pending ? ngli_gettime() : 0;
+            reset_next_change(node, t);
             int ret = node->class->update(node, t);
+            const int64_t end = profiler->active || node->startup_pending ? ngli_gettime() : 0;
+            if (profiler->active)
+                ngli_profiler_add(profiler, NGLI_PROFILER_UPDATE, node, node->label, node->class->name,
+                                  start, end - start);
+            if (node->startup_pending)
+                commit_startup_cost(node, node->pending_startup_cost + end - start);
             if (ret < 0) {
                 LOG(ERROR, "updating node %s failed: %s", node->label, NGLI_RET_STR(ret));
                 return ret;
             }
+            if (update_changed(node, ret))
+                node->change_gen = node->ctx->update_gen;
             node->last_update_time = t;
             node->draw_count = 0;
         } else {
             TRACE("%s already updated for t=%g, skip it", node->label, t);
+            if (node->cpu_update_changed) {
+                node->change_gen = node->ctx->update_gen;
+                node->cpu_update_changed = 0;
+            }
         }
+        /* Also reported to the other parents of a node shared in the graph */
+        if (node->change_gen == node->ctx->update_gen)
+            node->ctx->frame_changed = 1;
+        node->ctx->next_change_time = NGLI_MIN(node->ctx->next_change_time, node->next_change_time);
     }
 
     return 0;
 }
 
+/*
+ * A node is only active if one of its parents is, so the flat list of the
+ * active nodes is the same as the one a walk from the root would give.
+ */
+static int collect_cpu_updates(struct darray *nodes_array, const struct schedule *schedule, double t)
+{
+    struct ngl_node **nodes = ngli_darray_data(&schedule->nodes);
+    for (int i = 0; i < ngli_darray_count(&schedule->nodes); i++) {
+        struct ngl_node *node = nodes[i];
+        if ((node->class->flags & NGLI_NODE_FLAG_CPU_UPDATE) &&
+            node->is_active && node->state == STATE_READY &&
+            node->last_update_time != t && !node->startup_pending &&
+            !ngli_darray_push(nodes_array, &node))
+            return NGL_ERROR_MEMORY;
+    }
+    return 0;
+}
+
+static int cpu_update_job(void *arg, int index)
+{
+    const struct ngl_ctx *ctx = arg;
+    struct ngl_node **nodes = ngli_darray_data(&ctx->cpu_update_nodes);
+    struct ngl_node *node = nodes[index];
+    reset_next_change(node, ctx->cpu_update_t);
+    int ret = node->class->update(node, ctx->cpu_update_t);
+    if (ret < 0)
+        return 0;
+    /* Reported to the context by the regular update pass */
+    node->cpu_update_changed = update_changed(node, ret);
+    node->last_update_time = ctx->cpu_update_t;
+    node->draw_count = 0;
+    return 0;
+}
+
+/* Below this number of updates, the dispatch would cost more than it saves */
+#define MIN_CPU_UPDATES 16
+
+int ngli_node_start_cpu_update(struct ngl_ctx *ctx, double t)
+{
+    ngli_node_wait_cpu_update(ctx);
+
+    /* The profiler records the events from the rendering thread only */
+    if (!ctx->jobpool || ctx->profiler.active)
+        return 0;
+
+    ctx->cpu_update_nodes.count = 0;
+    int ret = collect_cpu_updates(&ctx->cpu_update_nodes, &ctx->schedule, t);
+    if (ret < 0)
+        return ret;
+
+    const int nb_nodes = ngli_darray_count(&ctx->cpu_update_nodes);
+    if (nb_nodes < MIN_CPU_UPDATES)
+        return 0;
+
+    ctx->cpu_update_t = t;
+    ngli_jobpool_start(ctx->jobpool, cpu_update_job, ctx, nb_nodes);
+    return 0;
+}
+
+void ngli_node_wait_cpu_update(struct ngl_ctx *ctx)
+{
+    if (ctx->jobpool)
+        ngli_jobpool_wait(ctx->jobpool);
+}
+
+int ngli_node_update_cpu(struct ngl_ctx *ctx, double t)
+{
+    int ret = ngli_node_start_cpu_update(ctx, t);
+    if (ret < 0)
+        return ret;
+    ngli_node_wait_cpu_update(ctx);
+    return 0;
+}
+
 void ngli_node_draw(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
+    if (ctx->damage_pass) {
+        if (!node->class->draw)
+            return;
+        if (node->class->flags & NGLI_NODE_FLAG_DAMAGE_AWARE)
+            node->class->draw(node);
+        else
+            ngli_damage_set_full(&ctx->damage);
+        return;
+    }
+
     if (node->class->draw) {
         TRACE("DRAW %s @ %p", node->label, node);
+        struct profiler *profiler = &node->ctx->profiler;
+        if (!profiler->active) {
+            node->class->draw(node);
+            node->draw_count++;
+            return;
+        }
+
+        const int gpu_timed = node->class->id == NGL_NODE_RENDER  ||
+                              node->class->id == NGL_NODE_COMPUTE ||
+                              node->class->id == NGL_NODE_RENDERTOTEXTURE;
+        const int gpu_scope = gpu_timed ? ngli_profiler_gpu_begin(profiler, node, node->label, node->class->name) : -1;
+        const int64_t start = ngli_gettime();
         node->class->draw(node);
+        ngli_profiler_add(profiler, NGLI_PROFILER_DRAW, node, node->label, node->class->name,
+                          start, ngli_gettime() - start);
+        ngli_profiler_gpu_end(profiler, gpu_scope);
         node->draw_count++;
     }
 }
@@ -534,7 +1278,7 @@ const struct node_param *ngli_node_param_find(const struct ngl_node *node, const
     *base_ptrp = (uint8_t *)node;
 
     if (!par) {
-        par = ngli_params_find(node->class->params, key);
+        par = find_class_param(node->class, key);
         *base_ptrp = (uint8_t *)node->priv_data;
     }
     if (!par)
@@ -542,6 +1286,21 @@ const struct node_param *ngli_node_param_find(const struct ngl_node *node, const
     return par;
 }
 
+static int param_changed(struct ngl_node *node, const struct node_param *par)
+{
+    if (!node->ctx)
+        return 0;
+
+    if (node->class->visit)
+        node->ctx->activity_gen++;
+
+    node->ctx->live_change_gen++;
+    node->ctx->frame_changed = 1;
+    node->ctx->scene_hash_valid = 0;
+
+    return par->update_func ? par->update_func(node) : 0;
+}
+
 int ngl_node_param_add(struct ngl_node *node, const char *key,
                        int nb_elems, void *elems)
 {
@@ -563,10 +1322,68 @@ int ngl_node_param_add(struct ngl_node *node, const char *key,
         return ret;
     }
 
-    if (node->ctx && par->update_func)
-        ret = par->update_func(node);
+    return param_changed(node, par);
+}
 
-    return ret;
+static int has_handle(const struct node_param *par)
+{
+    switch (par->type) {
+        case PARAM_TYPE_DATA:
+        case PARAM_TYPE_NODE:
+        case PARAM_TYPE_NODELIST:
+        case PARAM_TYPE_DBLLIST:
+        case PARAM_TYPE_NODEDICT:
+            return 0;
+    }
+    return 1;
+}
+
+static int get_update_value(const struct node_param *par, va_list *ap, struct ngl_param_update *update)
+{
+    switch (par->type) {
+        case PARAM_TYPE_SELECT: {
+            const char *s = va_arg(*ap, const char *);
+            int ret = ngli_params_get_select_val(par->choices->consts, s, &update->value.i);
+            if (ret < 0)
+                LOG(ERROR, "unrecognized constant \"%s\" for option %s", s, par->key);
+            return ret;
+        }
+        case PARAM_TYPE_FLAGS: {
+            const char *s = va_arg(*ap, const char *);
+            int ret = ngli_params_get_flags_val(par->choices->consts, s, &update->value.i);
+            if (ret < 0)
+                LOG(ERROR, "unrecognized flags \"%s\" for option %s", s, par->key);
+            return ret;
+        }
+        case PARAM_TYPE_BOOL:
+        case PARAM_TYPE_INT:
+            update->value.i = va_arg(*ap, int);
+            break;
+        case PARAM_TYPE_I64:
+            update->value.i64 = va_arg(*ap, int64_t);
+            break;
+        case PARAM_TYPE_DBL:
+            update->value.dbl = va_arg(*ap, double);
+            break;
+        case PARAM_TYPE_STR:
+            update->value.str = va_arg(*ap, const char *);
+            break;
+        case PARAM_TYPE_VEC2:
+        case PARAM_TYPE_VEC3:
+        case PARAM_TYPE_VEC4:
+        case PARAM_TYPE_MAT4: {
+            const float *v = va_arg(*ap, const float *);
+            memcpy(update->value.vec, v, ngli_params_specs[par->type].size);
+            break;
+        }
+        case PARAM_TYPE_RATIONAL:
+            update->value.r[0] = va_arg(*ap, int);
+            update->value.r[1] = va_arg(*ap, int);
+            break;
+        default:
+            return NGL_ERROR_BUG;
+    }
+    return 0;
 }
 
 int ngl_node_param_set(struct ngl_node *node, const char *key, ...)
@@ -584,6 +1401,26 @@ int ngl_node_param_set(struct ngl_node *node, const char *key, ...)
         return NGL_ERROR_INVALID_USAGE;
     }
 
+    /*
+     * Outside of the worker, the graph of a context may be in use: the
+     * changes are then queued to be applied before the next draw
+     */
+    struct ngl_ctx *ctx = node->ctx;
+    if (ctx && has_handle(par) && !pthread_equal(pthread_self(), ctx->worker_tid)) {
+        struct ngl_param_update update = {
+            .node = node,
+            .handle = par - node->class->params,
+        };
+        va_start(ap, key);
+        ret = get_update_value(par, &ap, &update);
+        va_end(ap);
+        if (ret < 0) {
+            LOG(ERROR, "unable to set %s.%s", node->label, key);
+            return ret;
+        }
+        return ngli_queue_param_updates(ctx, &update, 1);
+    }
+
     va_start(ap, key);
     ret = ngli_params_set(base_ptr, par, &ap);
     va_end(ap);
@@ -592,10 +1429,105 @@ int ngl_node_param_set(struct ngl_node *node, const char *key, ...)
         return ret;
     }
 
-    if (node->ctx && par->update_func)
-        ret = par->update_func(node);
+    return param_changed(node, par);
+}
 
-    return ret;
+int ngl_node_param_handle(struct ngl_node *node, const char *key)
+{
+    const struct node_param *params = node->class->params;
+    const struct node_param *par = find_class_param(node->class, key);
+    if (!par) {
+        LOG(ERROR, "parameter %s not found in %s", key, node->class->name);
+        return NGL_ERROR_NOT_FOUND;
+    }
+
+    if (!(par->flags & PARAM_FLAG_ALLOW_LIVE_CHANGE)) {
+        LOG(ERROR, "%s.%s can not be live changed", node->label, key);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (!has_handle(par)) {
+        LOG(ERROR, "%s.%s has no handle", node->label, key);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    return par - params;
+}
+
+static int get_consts_mask(const struct param_const *consts)
+{
+    int mask = 0;
+    for (int i = 0; consts[i].key; i++)
+        mask |= consts[i].value;
+    return mask;
+}
+
+const struct node_param *ngli_node_param_check_update(const struct ngl_node *node,
+                                                      const struct ngl_param_update *update)
+{
+    const struct node_param *params = node->class->params;
+    int nb_params = 0;
+    while (params && params[nb_params].key)
+        nb_params++;
+
+    if (update->handle < 0 || update->handle >= nb_params) {
+        LOG(ERROR, "invalid parameter handle %d for %s", update->handle, node->label);
+        return NULL;
+    }
+
+    const struct node_param *par = &params[update->handle];
+    if (!(par->flags & PARAM_FLAG_ALLOW_LIVE_CHANGE)) {
+        LOG(ERROR, "%s.%s can not be live changed", node->label, par->key);
+        return NULL;
+    }
+
+    if (!has_handle(par)) {
+        LOG(ERROR, "%s.%s has no handle", node->label, par->key);
+        return NULL;
+    }
+
+    const int v = update->value.i;
+    switch (par->type) {
+        case PARAM_TYPE_SELECT:
+            if (!ngli_params_get_select_str(par->choices->consts, v)) {
+                LOG(ERROR, "invalid constant %d for %s.%s", v, node->label, par->key);
+                return NULL;
+            }
+            break;
+        case PARAM_TYPE_FLAGS:
+            if (v & ~get_consts_mask(par->choices->consts)) {
+                LOG(ERROR, "invalid flags 0x%x for %s.%s", v, node->label, par->key);
+                return NULL;
+            }
+            break;
+    }
+
+    return par;
+}
+
+int ngli_node_param_update(struct ngl_node *node, const struct ngl_param_update *update)
+{
+    const struct node_param *par = &node->class->params[update->handle];
+    uint8_t *dstp = (uint8_t *)node->priv_data + par->offset;
+
+    switch (par->type) {
+        case PARAM_TYPE_STR: {
+            int ret = ngli_params_vset(node->priv_data, par, update->value.str);
+            if (ret < 0)
+                return ret;
+            break;
+        }
+        case PARAM_TYPE_BOOL: {
+            const int v = update->value.i == -1 ? -1 : !!update->value.i;
+            memcpy(dstp, &v, sizeof(v));
+            break;
+        }
+        default:
+            memcpy(dstp, &update->value, ngli_params_specs[par->type].size);
+            break;
+    }
+
+    return param_changed(node, par);
 }
 
 struct ngl_node *ngl_node_ref(struct ngl_node *node)
@@ -615,9 +1547,16 @@ void ngl_node_unrefp(struct ngl_node **nodep)
     if (delete) {
         LOG(VERBOSE, "DELETE %s @ %p", node->label, node);
         ngli_assert(!node->ctx);
+        if (node->class->free)
+            node->class->free(node);
         ngli_params_free((uint8_t *)node, ngli_base_node_params);
         ngli_params_free(node->priv_data, node->class->params);
-        ngli_free_aligned(node);
+        /* The node memory belongs to the arena, which may go away with it */
+        struct arena *arena = node->arena;
+        if (arena)
+            ngli_arena_unrefp(&arena);
+        else
+            ngli_free_tagged(node);
     }
     *nodep = NULL;
 }
@@ -22,6 +22,7 @@
 #ifndef NODES_H
 #define NODES_H
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <sxplayer.h>
 #include <pthread.h>
@@ -33,36 +34,83 @@
 
 #if defined(TARGET_ANDROID)
 #include "android_handlerthread.h"
+#include "android_imagereader.h"
 #include "android_surface.h"
 #endif
 
-#if defined(TARGET_IPHONE)
+#if defined(TARGET_IPHONE) || defined(TARGET_DARWIN)
 #include <CoreVideo/CoreVideo.h>
 #endif
 
+#if defined(HAVE_GLPLATFORM_EGL)
+#include "egl.h"
+#endif
+
 #include "animation.h"
+#include "damage.h"
 #include "drawutils.h"
+#include "framecache.h"
+#include "framepacer.h"
 #include "glincludes.h"
 #include "glcontext.h"
 #include "glstate.h"
 #include "graphicconfig.h"
+#include "gputimer.h"
 #include "hmap.h"
 #include "image.h"
+#include "imagecache.h"
+#include "jobpool.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "params.h"
+#include "profiler.h"
 #include "program.h"
 #include "darray.h"
 #include "buffer.h"
 #include "format.h"
+#include "uploader.h"
+#include "renderscale.h"
+#include "schedule.h"
 #include "rendertarget.h"
 #include "texture.h"
+#include "samplercache.h"
+#include "textureatlas.h"
+#include "texturepool.h"
+#include "uniformring.h"
+#include "timeline.h"
 
+struct captureconv;
 struct node_class;
 
 typedef int (*cmd_func_type)(struct ngl_ctx *s, void *arg);
 
 typedef void (*capture_func_type)(struct ngl_ctx *s);
 
+#define NGLI_CAPTURE_NB_PBOS 3
+
+struct api_cmd {
+    cmd_func_type func;
+    void *arg;
+    int async;
+    double t; /* draw time storage for asynchronous commands */
+};
+
+#define NGLI_CMD_QUEUE_SIZE 4
+
+struct animation_bake {
+    struct animation *anim;
+    int nb_comps;
+};
+
+struct output {
+    struct ngl_output params;
+    struct texture color;
+    struct texture depth;
+    struct rendertarget rt;
+    struct texture capture_color;
+    struct rendertarget capture_rt;
+};
+
 struct ngl_ctx {
     /* Controller-only fields */
     const struct backend *backend;
@@ -70,19 +118,91 @@ struct ngl_ctx {
     pthread_t worker_tid;
 
     /* Worker-only fields */
+    int thread_priority;                /* scheduling applied to the worker thread */
+    uint64_t thread_affinity;
     struct glcontext *glcontext;
     struct glstate glstate;
-    struct graphicconfig graphicconfig;
+    int glstate_gen;                    /* graphicconfig_gen honored by glstate */
+    struct graphicconfig graphicconfig; /* only changed through ngli_glstate_set_pending() */
+    int graphicconfig_gen;
+    struct glstate pending_glstate;     /* resolved graphicconfig, if pending_glstate_gen matches */
+    int pending_glstate_gen;
     struct rendertarget *rendertarget;
+    const float *view_matrices;         /* one per view of a multiview render target */
     int viewport[4];
     float clear_color[4];
-    int program_id;
     struct ngl_node *scene;
+    struct ngl_node *prepared_scene;
     struct ngl_config config;
-    int timer_active;
     struct darray modelview_matrix_stack;
+    uint64_t modelview_version;
     struct darray projection_matrix_stack;
     struct darray activitycheck_nodes;
+    struct darray visit_skipped_nodes;
+    struct darray deferred_releases; /* inactive nodes waiting for their release deadline */
+    struct darray idle_nodes;        /* struct idle_node, candidates to an eviction */
+    const struct ngl_node *evicted_idle_node;
+    struct darray draw_items;
+    struct arena *frame_arena;          /* scratch memory of the frame being drawn, rewound by every draw */
+    int draw_list_depth;
+    int draw_list_depth_sort;
+    int draw_list_depth_prepass;
+    struct rendertarget framebuffer_copy_rt; /* fallback of the framebuffer fetches */
+    struct texture framebuffer_copy;
+    int nb_pass_execs;
+    int live_change_gen;
+    int gpu_write_gen;      /* incremented by every draw writing resources on the GPU */
+    int compute_write_gen;  /* gpu_write_gen of the last compute dispatch */
+    struct darray *texture_reads; /* collects the textures updated, if set */
+    int frame_changed;      /* something changed since the last frame drawn */
+    double next_change_time; /* earliest time the nodes updated by the last frame may change at */
+    int update_gen;         /* incremented by every update pass of the scene */
+    struct damage damage;
+    int damage_pass;        /* the draws only register their damage */
+    int damage_scissor;     /* the frame is only redrawn in the damage region */
+    int activity_gen;
+    int visit_noskip;
+    int visit_has_release;
+    int nb_scheduled_prefetches;        /* early prefetches granted to the current frame */
+    int64_t scheduled_prefetch_cost;
+    struct darray deferred_uploads;     /* nodes with data left to upload, in prefetch order */
+    int64_t upload_budget;              /* bytes the current frame can still upload */
+    struct hmap *media_pool;
+    struct darray parked_players;       /* players of the released Media kept running, oldest first */
+    struct imagecache image_cache;      /* still images of the Media nodes, shared by all the scenes */
+    struct hmap *rtt_ms_pool;
+    struct hmap *fontatlas_pool;
+    struct hmap *geometry_buffer_pool;
+    struct hmap *program_cache;
+    char *program_cache_dir;
+    struct ngl_share_group *share_group;
+    struct framecache frame_cache;
+    int frame_cache_enabled;
+    uint64_t scene_hash;    /* hash of the serialized scene, for the frame cache */
+    int scene_hash_valid;   /* reset by the changes of the scene */
+    struct texturepool texture_pool;
+    struct textureatlas texture_atlas;
+    struct samplercache sampler_cache;
+    struct uniformring uniform_ring;
+    struct profiler profiler;
+    struct schedule schedule;
+    int schedule_gen;
+    struct jobpool *jobpool;
+    struct uploader *uploader;          /* upload thread, see ngl_config.upload_thread */
+#if defined(TARGET_ANDROID)
+    struct android_handlerthread *android_handlerthread; /* SurfaceTexture callbacks of all the media */
+#endif
+    struct darray cpu_update_nodes;
+    struct darray animation_bakes;      /* struct animation_bake, pending until the end of the attach */
+    int attach_gen;                     /* incremented by every attach of a graph */
+    double cpu_update_t;
+    double pipelined_t;
+    int has_pipelined_t;
+    struct gputimer frame_timer;
+    struct framepacer framepacer;
+    struct renderscale renderscale;
+    struct ngl_stats stats;
+    struct ngl_stats last_stats;
 #if defined(HAVE_VAAPI_X11)
     Display *x11_display;
     VADisplay va_display;
@@ -92,6 +212,18 @@ struct ngl_ctx {
     struct rendertarget rt;
     struct texture rt_color;
     struct texture rt_depth;
+    /* Additional offscreen outputs */
+    struct output *outputs;
+    int nb_outputs;
+    int drawing_outputs;
+    /* Batch drawing atlas */
+    struct output batch;
+    struct rendertarget *batch_prev_rt;
+    int batch_prev_vp[4];
+    int hold_resources;
+    int warmup_hold;            /* the nodes of warmup_range are kept ready */
+    double warmup_range[2];     /* times warmed up by ngl_warmup() */
+    int visit_release_held;     /* the next visit releases the nodes kept ready while inactive */
     /* Capture offscreen render target */
     capture_func_type capture_func;
     struct rendertarget oes_resolve_rt;
@@ -99,18 +231,58 @@ struct ngl_ctx {
     struct rendertarget capture_rt;
     struct texture capture_rt_color;
     uint8_t *capture_buffer;
+    int capture_size;                   /* size of a captured frame in the capture format */
+    struct captureconv *capture_conv;   /* conversion into a YUV capture format */
+    GLuint capture_pbos[NGLI_CAPTURE_NB_PBOS];
+    GLsync capture_fences[NGLI_CAPTURE_NB_PBOS];
+    int capture_pbo_head;
+    int capture_pbo_count;
+#if defined(HAVE_GLPLATFORM_EGL)
+    EGLImageKHR capture_egl_image;
+    GLuint capture_egl_texture;
+#endif
+#if defined(TARGET_ANDROID) && __ANDROID_API__ >= 26
+    AHardwareBuffer *capture_hardware_buffer;
+#endif
+#if defined(HAVE_GLPLATFORM_WGL)
+    struct ID3D11Texture2D *capture_d3d11_texture;
+    void *capture_dx_device;            /* WGL_NV_DX_interop device handle */
+    void *capture_dx_object;            /* WGL_NV_DX_interop object handle */
+    GLuint capture_dx_texture;
+#endif
 #if defined(TARGET_IPHONE)
     CVPixelBufferRef capture_cvbuffer;
     CVOpenGLESTextureRef capture_cvtexture;
+#elif defined(TARGET_DARWIN)
+    CVPixelBufferRef capture_cvbuffer;
+    GLuint capture_iosurface_texture;
 #endif
 
     /* Shared fields */
     pthread_mutex_t lock;
     pthread_cond_t cond_ctl;
     pthread_cond_t cond_wkr;
-    cmd_func_type cmd_func;
-    void *cmd_arg;
+    struct api_cmd cmd_queue[NGLI_CMD_QUEUE_SIZE];
+    int cmd_queue_head;
+    int cmd_queue_count;
     int cmd_ret;
+    int async_ret;
+    pthread_mutex_t param_updates_lock;
+    struct darray param_updates;        /* struct ngl_param_update, applied before the next draw */
+
+    /* Worker-only, swapped with param_updates to apply them outside of the lock */
+    struct darray applied_param_updates;
+
+    pthread_mutex_t readback_lock;
+    struct darray readback_requests;    /* struct readback, copied at the end of the next draw */
+
+    /* Worker-only, struct readback copied and waiting for the GPU */
+    struct darray readbacks;
+};
+
+struct idle_node {
+    const struct ngl_node *node;
+    int64_t idle_since; /* µs */
 };
 
 struct ngl_node {
@@ -123,8 +295,40 @@ struct ngl_node {
     double visit_time;
     double last_update_time;
 
+    /* time interval in which the activity of the subtree is known to be stable */
+    double activity_bounds[2];
+    int activity_gen;
+    int visit_skipped;
+
     int draw_count;
 
+    /* the update run on the job pool changed the node output */
+    int cpu_update_changed;
+
+    /* update_gen of the last update which changed the node output */
+    int change_gen;
+
+    /* earliest time at which the output of the node may change again, see ngli_node_restrict_next_change() */
+    double next_change_time;
+
+    /* position in the schedule of the scene */
+    int schedule_index;
+    int schedule_gen;
+
+    /* time spent in prefetch and in the first update following it (µs, smoothed) */
+    int64_t startup_cost;
+    int64_t pending_startup_cost;
+    int startup_pending;
+
+    /* time (µs) at which the node is released if still inactive, 0 if not queued */
+    int64_t release_deadline;
+
+    /* bytes of data left to upload by the upload() callback, 0 if not queued */
+    int64_t pending_upload_size;
+
+    int cpu_initialized;    /* the cpu_init() ran, and uninit() has not */
+    int attach_gen;         /* attach_gen of the last attach which visited the node */
+
     int refcount;
     int ctx_refcount;
 
@@ -132,6 +336,7 @@ struct ngl_node {
 
     char *label;
 
+    struct arena *arena;
     void *priv_data;
 };
 
@@ -161,33 +366,74 @@ struct geometry_priv {
     double radius;
     int npoints;
 
+    /* circle vertices generated by cpu_init(), until init() */
+    float *circle_vertices;
+    float *circle_uvcoords;
+    float *circle_normals;
+
+    /* mesh params */
+    char *filename;
+
     /* geometry params */
     struct ngl_node *vertices_buffer;
     struct ngl_node *uvcoords_buffer;
     struct ngl_node *normals_buffer;
+    struct ngl_node *joints_buffer;
+    struct ngl_node *weights_buffer;
     struct ngl_node *indices_buffer;
 
     int topology;
+    int optimize_indices;
+
+    /* object space bounding box, only set for static vertices */
+    int has_bounds;
+    float bounds_min[3];
+    float bounds_max[3];
 };
 
+/*
+ * Return a buffer node of the given type holding the data, attached to the
+ * context. The generated buffers are shared between all the geometries of
+ * the context with identical content, and must be released with
+ * ngli_node_geometry_release_buffer().
+ */
 struct ngl_node *ngli_node_geometry_generate_buffer(struct ngl_ctx *ctx, int type, int count, int size, void *data);
+void ngli_node_geometry_release_buffer(struct ngl_node **nodep);
+void ngli_node_geometry_compute_bounds(struct geometry_priv *s);
+
+/*
+ * Beyond this number of changed ranges, the closest ones are merged and the
+ * data between them is uploaded as well
+ */
+#define NGLI_BUFFER_MAX_CHANGED_RANGES 8
 
 struct buffer_priv {
     int count;              // number of elements
     uint8_t *data;          // buffer of <count> elements
     int data_size;          // total buffer data size in bytes
     char *filename;         // filename from which the data will be read
+    int64_t file_offset;    // offset of the data in filename, set by the Mesh node
     int data_comp;          // number of components per element
     int data_stride;        // stride of 1 element, in bytes
     struct ngl_node *block;
     int block_field;
     int usage;              // flags defining buffer use
     int data_format;        // any of NGLI_FORMAT_*
+    int gpu_only;           // data released once uploaded, read back from the GPU when needed
 
     /* animatedbuffer */
     struct ngl_node **animkf;
     int nb_animkf;
     struct animation anim;
+    int gpu_interpolation;  // data holds every key frame, interpolated by the shaders
+    int kf_pair[2];         // gpu_interpolation: key frames to interpolate
+    float kf_ratio;         // gpu_interpolation: interpolation ratio between them
+
+    /* skin */
+    struct ngl_node *skeleton;
+    struct ngl_node **joints;
+    int nb_joints;
+    struct ngl_node *inverse_bind_matrices;
 
     int fd;
     int dynamic;
@@ -196,6 +442,20 @@ struct buffer_priv {
     struct buffer buffer;
     int buffer_refcount;
     double buffer_last_upload_time;
+    int upload_offset;      // next byte of the data to upload, see ngli_node_defer_upload()
+
+    /* user memory wrapped with ngl_node_buffer_wrap_data() */
+    uint8_t *data_ref;
+    int data_ref_size;
+
+    /* range of the data modified through ngl_node_buffer_map() */
+    int mapped;
+    int map_start;
+    int map_end;
+
+    /* sorted disjoint ranges of the data to upload at the next draw */
+    int changed_ranges[NGLI_BUFFER_MAX_CHANGED_RANGES][2];
+    int nb_changed_ranges;
 };
 
 int ngli_node_buffer_ref(struct ngl_node *node);
@@ -215,8 +475,10 @@ struct variable_priv {
 
     struct ngl_node *timestamps;
     struct ngl_node *buffer;
+    char *filename;
     int timebase[2];
     struct ngl_node *time_anim;
+    struct timeline timeline;
 
     struct animation anim;
     struct animation anim_eval;
@@ -234,6 +496,10 @@ struct variable_priv {
     int dynamic;
     int live_changed;
     int last_index;
+    int constant; /* animated only: every keyframe holds the same value */
+    int gpu_lookup; /* streamed only: the samples are read by the shader */
+    int specialized; /* number of passes with the value compiled into their program */
+    float lookup_ratio;
 };
 
 struct block_field_info {
@@ -241,6 +507,14 @@ struct block_field_info {
     int offset;
     int size;
     int stride;
+    int direct; /* laid out as in the field data, uploaded from it without any copy in the block data */
+};
+
+enum {
+    NGLI_BLOCK_LAYOUT_STD140,
+    NGLI_BLOCK_LAYOUT_STD430,
+    NGLI_BLOCK_LAYOUT_INTERLEAVED,
+    NGLI_BLOCK_NB_LAYOUTS
 };
 
 struct block_priv {
@@ -257,6 +531,9 @@ struct block_priv {
     struct buffer buffer;
     int buffer_refcount;
     int has_changed;
+    int changed_start;
+    int changed_end;
+    int direct_changed;
     double buffer_last_upload_time;
 };
 
@@ -268,10 +545,19 @@ struct program_priv {
     const char *vertex;
     const char *fragment;
     const char *compute;
+    int nb_views;
 
     struct program program;
 };
 
+/*
+ * Build the program of a Program or ComputeProgram node into a separate
+ * program, with the given uniforms compiled as constants (see
+ * ngli_program_submit_specialized())
+ */
+int ngli_node_program_specialize(struct ngl_node *node, struct program *program,
+                                 struct uniformpack_constant *constants, int nb_constants);
+
 extern const struct param_choices ngli_mipmap_filter_choices;
 extern const struct param_choices ngli_filter_choices;
 
@@ -281,11 +567,59 @@ struct texture_priv {
     int direct_rendering;
 
     uint32_t supported_image_layouts;
+    int packable;                               /* all the passes can sample it from an atlas */
+    struct textureatlas_region atlas_region;
     struct texture texture;
     struct image image;
+    int upload_row;                             /* next row of the data to upload, see ngli_node_defer_upload() */
 
     const struct hwmap_class *hwupload_map_class;
     void *hwupload_priv_data;
+    int hwupload_pending_width;  /* dimensions of a frame not yet latched by the hwupload */
+    int hwupload_pending_height;
+    struct uploader_job hwupload_job;           /* upload of hwupload_frame on the upload thread */
+    struct sxplayer_frame *hwupload_frame;
+
+    struct hwconv *capture_hwconv;   /* conversion of the capture device frames */
+    struct rendertarget *hud_rt;     /* rendering of the HUD widgets */
+
+    const struct ngl_node *last_rtt; /* RenderToTexture which last drew into the texture */
+    int rtt_format;                  /* format picked by the precision of a RenderToTexture, overriding params.format */
+    int write_gen;                   /* gpu_write_gen of this draw */
+
+    int still_texture_ref;           /* the image is the texture of a still Media, shared through the image cache */
+
+    int block_src;                   /* the data source is a block field, copied on the GPU */
+    int block_copy_gen;              /* gpu_write_gen of the last copy of the block field */
+    double block_upload_time;        /* buffer_last_upload_time of the block at the last copy */
+};
+
+/*
+ * Copy the block field data source of a texture into it if it was written
+ * by a compute or uploaded since the last copy, to be called before every
+ * draw sampling the texture
+ */
+void ngli_node_texture_copy_block_field(struct ngl_node *node);
+
+/*
+ * GPU memory the RenderToTexture allocates on top of its textures (implicit
+ * depth and stencil buffer, multisample render target), estimated from its
+ * parameters
+ */
+int64_t ngli_node_rtt_estimate_memory(const struct ngl_node *node);
+
+/* GPU memory of the particle state, lists and instances of a ParticleSystem */
+int64_t ngli_node_particlesystem_estimate_memory(const struct ngl_node *node);
+
+#define NGLI_MEDIA_MAX_LOOKAHEAD 16
+
+/* Uploaded frame kept by a Media node for the scrubbing */
+struct media_cache_entry {
+    int used;
+    double ts;          /* timestamp of the frame */
+    double max_time;    /* latest media time the frame is known to be displayed at */
+    int64_t last_use;
+    struct texture texture;
 };
 
 struct media_priv {
@@ -298,26 +632,130 @@ struct media_priv {
     int max_nb_sink;
     int max_pixels;
     int stream_idx;
+    int lookahead;
+    int async_surface;
+    int sw_pix_fmt;
+    int frame_cache;
+    int live;
+    int audio_fft;
+    int audio_nb_bins;
+    double audio_smoothing;
+    int still;
 
     struct sxplayer_ctx *player;
     struct sxplayer_frame *frame;
 
+    /* Frame cache, serving the media times of the uploaded frames without decoding */
+    struct media_cache_entry *cache;
+    int64_t cache_clock;
+    double cache_time;                          /* media time of the frame pending upload */
+    struct media_cache_entry *cache_current;    /* frame to display */
+    struct media_cache_entry *cache_player;     /* frame last returned by sxplayer */
+
+    /* Scheduling of the decoding threads, from the context configuration */
+    int thread_priority;
+    uint64_t thread_affinity;
+
+    /* Look-ahead decoding thread and its queue of decoded frames */
+    pthread_t lookahead_tid;
+    pthread_mutex_t lookahead_lock;
+    pthread_cond_t lookahead_cond;
+    struct sxplayer_frame *lookahead_queue[NGLI_MEDIA_MAX_LOOKAHEAD];
+    int lookahead_head;
+    int lookahead_count;
+    int lookahead_running;
+    int lookahead_eof;
+    int lookahead_delivered;
+    double lookahead_last_ts;
+
+    /* Live decoding thread, only keeping the most recent decoded frame */
+    pthread_t live_tid;
+    pthread_mutex_t live_lock;
+    int live_running;
+    struct sxplayer_frame *live_frame;
+    int64_t live_frame_time;        /* reception time of live_frame */
+    int64_t live_displayed_time;    /* reception time of the last frame returned by the update */
+    int live_nb_dropped;
+
+    struct media_shared *shared;
+    int shared_frame_id;
+
+    /* Still image decoded by the cpu_init() into the context image cache */
+    struct imagecache_entry *still_entry;
+    int still_delivered;
+
 #if defined(TARGET_ANDROID)
     struct texture android_texture;
     struct android_surface *android_surface;
-    struct android_handlerthread *android_handlerthread;
+    struct android_imagereader *android_imagereader;
 #endif
 };
 
+void ngli_node_media_release_frame(struct ngl_node *node, struct sxplayer_frame *frame);
+struct texture *ngli_node_media_cache_texture(struct ngl_node *node, struct texture *texture, double ts);
+int ngli_node_media_ref_still_texture(struct ngl_node *node, const struct texture_params *params,
+                                      struct texture **texturep);
+void ngli_node_media_unref_still_texture(struct ngl_node *node);
+void ngli_node_media_free_still_texture(void *user_arg, void *priv);
+
+#define NGLI_CAPTUREDEVICE_MAX_BUFFERS 8
+
+struct capturedevice_buffer {
+    int fd;                     /* dma-buf exported from the driver */
+#if defined(HAVE_GLPLATFORM_EGL)
+    EGLImageKHR egl_images[2];
+#endif
+    struct texture planes[2];
+};
+
+struct capturedevice_priv {
+    char *device;
+    int width;
+    int height;
+    int nb_buffers;
+
+    int fd;
+    int pitch;
+    struct capturedevice_buffer buffers[NGLI_CAPTUREDEVICE_MAX_BUFFERS];
+    int nb_allocated;
+    int streaming;
+    int current;                /* index of the buffer held for display, -1 if none */
+    struct texture *planes;     /* planes of the buffer held for display */
+    struct image image;
+};
+
 struct timerangemode_priv {
     double start_time;
     double render_time;
     int updated;
 };
 
+/* Whether a GraphicConfig enables the depth or stencil test for its child */
+int ngli_node_graphicconfig_tests_depth(const struct ngl_node *node);
+
+/* Whether the child of a TimeRangeFilter is drawn at time t (not in a noop range) */
+int ngli_node_timerangefilter_draws_child(const struct ngl_node *node, double t);
+
+/*
+ * Entry of the modelview matrix stack: two entries with the same version
+ * hold the same matrix, so whatever is derived from it can be reused.
+ */
+struct modelview {
+    NGLI_ALIGNED_MAT(matrix);
+    uint64_t version;
+};
+
 struct transform_priv {
     struct ngl_node *child;
     NGLI_ALIGNED_MAT(matrix);
+    NGLI_ALIGNED_MAT(world_matrix);
+    uint64_t parent_version; // version of the parent world_matrix derives from, 0 if stale
+    uint64_t world_version;
+    int animated;                     // whether the matrix changes over time
+    struct transform_priv *fold_head; // transform drawing this one as part of its folded chain
+    struct ngl_node *fold_child;      // node drawn in place of child at the end of the folded chain
+    int fold_stale;                   // whether fold_matrix needs to be recomputed
+    NGLI_ALIGNED_MAT(fold_matrix);    // product of the matrices of the folded chain
 };
 
 struct identity {
@@ -383,27 +821,20 @@ struct animkeyframe_priv {
     double *args;
     int nb_args;
     double offsets[2];
+    int lut_size;
     int scale_boundaries;
     double boundaries[2];
+    double *lut;
 };
 
-struct hud_priv {
-    struct ngl_node *child;
-    int measure_window;
-    int refresh_rate[2];
-    char *export_filename;
-    float bg_color[4];
-    int aspect_ratio[2];
-
-    struct darray widgets;
-    uint32_t bg_color_u32;
-    int fd_export;
-    struct bstr *csv_line;
-    struct canvas canvas;
-    double refresh_rate_interval;
-    double last_refresh_time;
-    int need_refresh;
-};
+void ngli_node_hud_get_dimensions(const struct ngl_node *node, int *width, int *height);
+
+/*
+ * Render the widgets of a HUD into a render target of the HUD dimensions, if
+ * they were refreshed since the last rendering (or unconditionally if force
+ * is set). Return whether the render target was rendered into.
+ */
+int ngli_node_hud_render(struct ngl_node *node, struct rendertarget *rt, int force);
 
 enum {
     NGLI_NODE_CATEGORY_NONE,
@@ -449,17 +880,54 @@ enum {
  * Note: nodes implementation do NOT have to implement this logic, but they can
  * rely on these properties in their callback implementations.
  */
+/*
+ * The update() only computes CPU data from the node own parameters, without
+ * touching the graphics context or updating other nodes: it may run on any
+ * thread, concurrently with other updates.
+ */
+#define NGLI_NODE_FLAG_CPU_UPDATE (1 << 0)
+
+/*
+ * The update() returns 1 if the node output changed, 0 otherwise; the changes
+ * of its children and parameters are tracked separately. Without this flag,
+ * every update of a node is considered as a change of the frame.
+ */
+#define NGLI_NODE_FLAG_REPORTS_CHANGES (1 << 1)
+
+/*
+ * The draw() only changes the matrices and graphic states, or registers its
+ * damage instead of drawing while ctx->damage_pass is set: it can run before
+ * the actual draw to locate the damage of the frame. Drawing any other node
+ * damages the whole frame.
+ */
+#define NGLI_NODE_FLAG_DAMAGE_AWARE (1 << 2)
+
+/*
+ * The cpu_init() is the CPU-only part of the initialization (file reads,
+ * data generation, ...), called before init(). It only computes data from
+ * the node own parameters, without touching the graphics context or the
+ * other nodes: the cpu_init() of the nodes of a graph being attached may run
+ * on any thread, concurrently with each other. Of the context, only the
+ * thread-safe image cache may be used. The uninit() must cope with a
+ * node whose init() has never been called after its cpu_init(). The free()
+ * releases what the node allocated outside of any context, right before the
+ * node itself is freed.
+ */
 struct node_class {
     int id;
     int category;
+    int flags;
     const char *name;
+    int (*cpu_init)(struct ngl_node *node);
     int (*init)(struct ngl_node *node);
     int (*visit)(struct ngl_node *node, int is_active, double t);
     int (*prefetch)(struct ngl_node *node);
     int (*update)(struct ngl_node *node, double t);
     void (*draw)(struct ngl_node *node);
+    int64_t (*upload)(struct ngl_node *node, int64_t max_size);
     void (*release)(struct ngl_node *node);
     void (*uninit)(struct ngl_node *node);
+    void (*free)(struct ngl_node *node);
     char *(*info_str)(const struct ngl_node *node);
     size_t priv_size;
     const struct node_param *params;
@@ -470,9 +938,104 @@ struct node_class {
 void ngli_node_print_specs(void);
 
 int ngli_node_visit(struct ngl_node *node, int is_active, double t);
+int ngli_node_revisit_skipped(struct ngl_ctx *ctx, double t);
+void ngli_node_restrict_activity_bounds(struct ngl_node *node, double start, double end);
+
+/*
+ * Report, from the update() callback of a node flagged with
+ * NGLI_NODE_FLAG_REPORTS_CHANGES, the earliest time at which its output may
+ * change again: t if it changes continuously, DBL_MAX (the default) if it
+ * never does. The nodes without the flag are assumed to change at every
+ * frame.
+ */
+void ngli_node_restrict_next_change(struct ngl_node *node, double t);
 int ngli_node_honor_release_prefetch(struct darray *nodes_array);
+void ngli_node_release_deferred(struct ngl_ctx *ctx);
+
+/*
+ * Register a node keeping its subtree alive while idle. Return 1 if the node
+ * can keep it alive, 0 if it has been picked to release it in order to honor
+ * the GPU memory budget, or a negative error code.
+ */
+int ngli_node_keep_idle(struct ngl_node *node, int64_t idle_since);
+
+/*
+ * Pick among the nodes registered during the previous visit the one which
+ * has to release its idle subtree, if the GPU memory budget is exceeded.
+ */
+void ngli_node_evict_idle(struct ngl_ctx *ctx);
+
+/*
+ * Return whether the GPU memory in use exceeds the GPU memory budget.
+ */
+int ngli_node_exceeds_memory_budget(const struct ngl_ctx *ctx);
+int ngli_node_holds_resources(const struct ngl_ctx *ctx);
+
+/*
+ * Run ahead on the job pool the updates flagged NGLI_NODE_FLAG_CPU_UPDATE of
+ * the active nodes of the scene. The nodes which fail are left to
+ * ngli_node_update(), which reports their errors.
+ */
+int ngli_node_update_cpu(struct ngl_ctx *ctx, double t);
+
+/*
+ * Asynchronous version of ngli_node_update_cpu(): the updates run in the
+ * background until ngli_node_wait_cpu_update() is called, and the graph must
+ * not be used in between.
+ */
+int ngli_node_start_cpu_update(struct ngl_ctx *ctx, double t);
+void ngli_node_wait_cpu_update(struct ngl_ctx *ctx);
+
+/*
+ * Sum of the measured startup costs of the nodes of a subtree, in
+ * microseconds, or 0 if the subtree has never been prefetched
+ */
+int64_t ngli_node_get_startup_cost(const struct ngl_node *node);
+
+/*
+ * Ask for an early prefetch of the given cost in the current frame: a frame
+ * always accepts one, and accepts more as long as their cumulated cost fits
+ * in the frame budget. Return whether the prefetch can happen now.
+ */
+int ngli_node_schedule_prefetch(struct ngl_ctx *ctx, int64_t cost);
+
+/*
+ * Uploads spread over the frames, honoring prefetch_upload_budget. A node
+ * about to upload size bytes asks ngli_node_defer_upload() first: if the
+ * data does not fit in what is left of the frame budget, 1 is returned and
+ * the node only allocates its GPU storage. The data is then uploaded by the
+ * upload() callback of the node, which uploads about max_size more bytes and
+ * returns the number of bytes still pending (or an error). The next frames
+ * run the pending uploads within their budget, and the update of a node,
+ * meaning its data is needed, finishes them at once.
+ */
+int ngli_node_defer_upload(struct ngl_node *node, int64_t size);
+int ngli_node_finish_upload(struct ngl_node *node);
+void ngli_node_cancel_upload(struct ngl_node *node);
+int ngli_node_run_deferred_uploads(struct ngl_ctx *ctx);
 int ngli_node_update(struct ngl_node *node, double t);
+
+/*
+ * Add a texture to ctx->texture_reads, which collects the textures updated
+ * while it is set (each texture is only added once)
+ */
+int ngli_node_record_texture_read(struct ngl_ctx *ctx, struct ngl_node *node);
 int ngli_prepare_draw(struct ngl_ctx *s, double t);
+
+/* Graph of the scene annotated with the costs measured by the running profile (see ngl_dot_cost()) */
+char *ngli_dot_cost(struct ngl_ctx *s, int metric);
+
+/* Visit the scene at time t, deciding the activity of its nodes without prefetching them */
+int ngli_visit_scene(struct ngl_ctx *s, double t);
+
+/* Replay the activity of the scene at each time without drawing it (see ngl_analyze()) */
+int ngli_analyze(struct ngl_ctx *s, const double *times, int nb_times, struct ngl_analysis *analysis);
+
+/*
+ * Queue checked parameter updates (see ngli_node_param_check_update()) to be
+ * applied by the worker before the next draw; safe to call from any thread
+ */
+int ngli_queue_param_updates(struct ngl_ctx *s, const struct ngl_param_update *updates, int nb_updates);
 void ngli_node_draw(struct ngl_node *node);
 
 int ngli_node_attach_ctx(struct ngl_node *node, struct ngl_ctx *ctx);
@@ -480,8 +1043,21 @@ void ngli_node_detach_ctx(struct ngl_node *node, struct ngl_ctx *ctx);
 
 char *ngli_node_default_label(const char *class_name);
 int ngli_is_default_label(const char *class_name, const char *str);
-struct ngl_node *ngli_node_create_noconstructor(int type);
+/*
+ * The node memory is taken from the arena if not NULL: the node then holds
+ * a reference on the arena, which is released with the node.
+ */
+struct ngl_node *ngli_node_create_noconstructor(int type, struct arena *arena);
 const struct node_param *ngli_node_param_find(const struct ngl_node *node, const char *key,
                                               uint8_t **base_ptrp);
 
+/*
+ * Return the parameter targeted by a ngl_params_update() entry, or NULL if
+ * the entry is invalid; only checked entries can then be applied with
+ * ngli_node_param_update()
+ */
+const struct node_param *ngli_node_param_check_update(const struct ngl_node *node,
+                                                      const struct ngl_param_update *update);
+int ngli_node_param_update(struct ngl_node *node, const struct ngl_param_update *update);
+
 #endif
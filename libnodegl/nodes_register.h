@@ -40,6 +40,7 @@
     action(NGL_NODE_ANIMKEYFRAMEQUAT,       ngli_animkeyframequat_class)        \
     action(NGL_NODE_ANIMKEYFRAMEBUFFER,     ngli_animkeyframebuffer_class)      \
     action(NGL_NODE_BLOCK,                  ngli_block_class)                   \
+    action(NGL_NODE_BLUR,                   ngli_blur_class)                    \
     action(NGL_NODE_BUFFERBYTE,             ngli_bufferbyte_class)              \
     action(NGL_NODE_BUFFERBVEC2,            ngli_bufferbvec2_class)             \
     action(NGL_NODE_BUFFERBVEC3,            ngli_bufferbvec3_class)             \
@@ -70,7 +71,14 @@
     action(NGL_NODE_BUFFERVEC3,             ngli_buffervec3_class)              \
     action(NGL_NODE_BUFFERVEC4,             ngli_buffervec4_class)              \
     action(NGL_NODE_BUFFERMAT4,             ngli_buffermat4_class)              \
+    action(NGL_NODE_BUFFERHALF,             ngli_bufferhalf_class)              \
+    action(NGL_NODE_BUFFERHVEC2,            ngli_bufferhvec2_class)             \
+    action(NGL_NODE_BUFFERHVEC3,            ngli_bufferhvec3_class)             \
+    action(NGL_NODE_BUFFERHVEC4,            ngli_bufferhvec4_class)             \
+    action(NGL_NODE_BUFFERPACK10,           ngli_bufferpack10_class)            \
+    action(NGL_NODE_BUFFERUPACK10,          ngli_bufferupack10_class)           \
     action(NGL_NODE_CAMERA,                 ngli_camera_class)                  \
+    action(NGL_NODE_CAPTUREDEVICE,          ngli_capturedevice_class)           \
     action(NGL_NODE_CIRCLE,                 ngli_circle_class)                  \
     action(NGL_NODE_COMPUTE,                ngli_compute_class)                 \
     action(NGL_NODE_COMPUTEPROGRAM,         ngli_computeprogram_class)          \
@@ -79,7 +87,11 @@
     action(NGL_NODE_GROUP,                  ngli_group_class)                   \
     action(NGL_NODE_HUD,                    ngli_hud_class)                     \
     action(NGL_NODE_IDENTITY,               ngli_identity_class)                \
+    action(NGL_NODE_LEVELOFDETAIL,          ngli_levelofdetail_class)           \
     action(NGL_NODE_MEDIA,                  ngli_media_class)                   \
+    action(NGL_NODE_MESH,                   ngli_mesh_class)                    \
+    action(NGL_NODE_OCCLUSIONCULL,          ngli_occlusioncull_class)           \
+    action(NGL_NODE_PARTICLESYSTEM,         ngli_particlesystem_class)          \
     action(NGL_NODE_PROGRAM,                ngli_program_class)                 \
     action(NGL_NODE_QUAD,                   ngli_quad_class)                    \
     action(NGL_NODE_RENDER,                 ngli_render_class)                  \
@@ -87,6 +99,9 @@
     action(NGL_NODE_ROTATE,                 ngli_rotate_class)                  \
     action(NGL_NODE_ROTATEQUAT,             ngli_rotatequat_class)              \
     action(NGL_NODE_SCALE,                  ngli_scale_class)                   \
+    action(NGL_NODE_SHAPE,                  ngli_shape_class)                   \
+    action(NGL_NODE_SKIN,                   ngli_skin_class)                    \
+    action(NGL_NODE_STEREOCAMERA,           ngli_stereocamera_class)            \
     action(NGL_NODE_TEXT,                   ngli_text_class)                    \
     action(NGL_NODE_TEXTURE2D,              ngli_texture2d_class)               \
     action(NGL_NODE_TEXTURE3D,              ngli_texture3d_class)               \
@@ -104,6 +119,12 @@
     action(NGL_NODE_STREAMEDVEC3,           ngli_streamedvec3_class)            \
     action(NGL_NODE_STREAMEDVEC4,           ngli_streamedvec4_class)            \
     action(NGL_NODE_STREAMEDMAT4,           ngli_streamedmat4_class)            \
+    action(NGL_NODE_STREAMEDFILEINT,        ngli_streamedfileint_class)         \
+    action(NGL_NODE_STREAMEDFILEFLOAT,      ngli_streamedfilefloat_class)       \
+    action(NGL_NODE_STREAMEDFILEVEC2,       ngli_streamedfilevec2_class)        \
+    action(NGL_NODE_STREAMEDFILEVEC3,       ngli_streamedfilevec3_class)        \
+    action(NGL_NODE_STREAMEDFILEVEC4,       ngli_streamedfilevec4_class)        \
+    action(NGL_NODE_STREAMEDFILEMAT4,       ngli_streamedfilemat4_class)        \
     action(NGL_NODE_UNIFORMINT,             ngli_uniformint_class)              \
     action(NGL_NODE_UNIFORMMAT4,            ngli_uniformmat4_class)             \
     action(NGL_NODE_UNIFORMFLOAT,           ngli_uniformfloat_class)            \
@@ -112,5 +133,6 @@
     action(NGL_NODE_UNIFORMVEC4,            ngli_uniformvec4_class)             \
     action(NGL_NODE_UNIFORMQUAT,            ngli_uniformquat_class)             \
     action(NGL_NODE_USERSWITCH,             ngli_userswitch_class)              \
+    action(NGL_NODE_VIRTUALTEXTURE,         ngli_virtualtexture_class)          \
 
 #endif
@@ -395,10 +395,10 @@ int ngli_params_set(uint8_t *base_ptr, const struct node_param *par, va_list *ap
             LOG(VERBOSE, "set %s to %p (of size %d)", par->key, data, size);
             uint8_t **dst = (uint8_t **)dstp;
 
-            ngli_free(*dst);
+            ngli_free_tagged(*dst);
             *dst = NULL;
             if (data && size) {
-                *dst = ngli_malloc(size);
+                *dst = ngli_malloc_tagged(size, NGLI_MEMTAG_BUFFERS);
                 if (!*dst)
                     return NGL_ERROR_MEMORY;
                 memcpy(*dst, data, size);
@@ -664,7 +664,7 @@ void ngli_params_free(uint8_t *base_ptr, const struct node_param *params)
             }
             case PARAM_TYPE_DATA: {
                 uint8_t *data = *(uint8_t **)parp;
-                ngli_free(data);
+                ngli_free_tagged(data);
                 break;
             }
             case PARAM_TYPE_NODE: {
@@ -21,11 +21,13 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 
 #include "buffer.h"
 #include "default_shaders.h"
+#include "fbfetch.h"
 #include "glincludes.h"
 #include "hmap.h"
 #include "image.h"
@@ -38,27 +40,124 @@
 #include "pipeline.h"
 #include "program.h"
 #include "texture.h"
+#include "texvideo.h"
 #include "topology.h"
 #include "type.h"
 #include "utils.h"
 
+/*
+ * A stream looked up on the GPU is exposed as the <name>_data storage block
+ * backed by its whole buffer, uploaded once, along with the <name>_index and
+ * <name>_ratio uniforms locating the current sample.
+ */
+static int register_lookup_uniform(struct pass *s, const char *name, struct ngl_node *uniform)
+{
+    struct variable_priv *variable_priv = uniform->priv_data;
+    struct ngl_node *buffer_node = variable_priv->buffer;
+    struct buffer_priv *buffer_priv = buffer_node->priv_data;
+
+    char data_name[MAX_ID_LEN];
+    snprintf(data_name, sizeof(data_name), "%s_data", name);
+    const struct blockprograminfo *info = ngli_hmap_get(s->pipeline_program->buffer_blocks, data_name);
+    if (!info) {
+        const struct pass_params *params = &s->params;
+        LOG(WARNING, "block %s attached to pipeline %s not found in shader", data_name, params->label);
+        return 0;
+    }
+
+    if (info->type != NGLI_TYPE_STORAGE_BUFFER) {
+        LOG(ERROR, "block %s must be a storage block", data_name);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    int ret = ngli_node_buffer_ref(buffer_node);
+    if (ret < 0)
+        return ret;
+
+    if (!ngli_darray_push(&s->lookup_buffers, &buffer_node)) {
+        ngli_node_buffer_unref(buffer_node);
+        return NGL_ERROR_MEMORY;
+    }
+
+    struct pipeline_buffer pipeline_buffer = {
+        .buffer = &buffer_priv->buffer,
+        .info   = info,
+    };
+    snprintf(pipeline_buffer.name, sizeof(pipeline_buffer.name), "%s", data_name);
+    if (!ngli_darray_push(&s->pipeline_buffers, &pipeline_buffer))
+        return NGL_ERROR_MEMORY;
+
+    const struct {
+        const char *suffix;
+        int type;
+        void *data;
+    } lookup_uniforms[] = {
+        {"index", NGLI_TYPE_INT,   &variable_priv->last_index},
+        {"ratio", NGLI_TYPE_FLOAT, &variable_priv->lookup_ratio},
+    };
+
+    for (int i = 0; i < NGLI_ARRAY_NB(lookup_uniforms); i++) {
+        struct pipeline_uniform pipeline_uniform = {
+            .type  = lookup_uniforms[i].type,
+            .count = 1,
+            .data  = lookup_uniforms[i].data,
+        };
+        snprintf(pipeline_uniform.name, sizeof(pipeline_uniform.name), "%s_%s", name, lookup_uniforms[i].suffix);
+        pipeline_uniform.info = ngli_hmap_get(s->pipeline_program->uniforms, pipeline_uniform.name);
+        if (!pipeline_uniform.info)
+            continue;
+        if (!ngli_darray_push(&s->pipeline_uniforms, &pipeline_uniform))
+            return NGL_ERROR_MEMORY;
+    }
+
+    if (!ngli_darray_push(&s->uniforms, &uniform))
+        return NGL_ERROR_MEMORY;
+
+    return 0;
+}
+
+static int is_specialized(const struct pass *s, const struct ngl_node *uniform)
+{
+    struct ngl_node **uniforms = ngli_darray_data(&s->specialized_uniforms);
+    for (int i = 0; i < ngli_darray_count(&s->specialized_uniforms); i++)
+        if (uniforms[i] == uniform)
+            return 1;
+    return 0;
+}
+
 static int register_uniform(struct pass *s, const char *name, struct ngl_node *uniform)
 {
     if (!uniform)
         return 0;
 
-    struct hmap *infos = s->pipeline_program->uniforms;
-    if (!ngli_hmap_get(infos, name)) {
+    if (uniform->class->category == NGLI_NODE_CATEGORY_UNIFORM) {
+        const struct variable_priv *variable_priv = uniform->priv_data;
+        if (variable_priv->gpu_lookup)
+            return register_lookup_uniform(s, name, uniform);
+    }
+
+    struct uniformprograminfo *info = ngli_hmap_get(s->pipeline_program->uniforms, name);
+    if (!info) {
+        if (is_specialized(s, uniform))
+            return 0;
         struct pass_params *params = &s->params;
         LOG(WARNING, "uniform %s attached to pipeline %s not found in shader", name, params->label);
         return 0;
     }
 
-    struct pipeline_uniform pipeline_uniform = {{0}};
+    struct pipeline_uniform pipeline_uniform = {.info = info};
     snprintf(pipeline_uniform.name, sizeof(pipeline_uniform.name), "%s", name);
 
     if (uniform->class->category == NGLI_NODE_CATEGORY_BUFFER) {
         struct buffer_priv *buffer_priv = uniform->priv_data;
+        if (buffer_priv->gpu_interpolation) {
+            LOG(ERROR, "buffer %s interpolated on the GPU can only be used as a vertex attribute", name);
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        if (buffer_priv->gpu_only) {
+            LOG(ERROR, "GPU-only buffer %s can not be used as a uniform", name);
+            return NGL_ERROR_INVALID_USAGE;
+        }
         pipeline_uniform.type  = buffer_priv->data_type;
         pipeline_uniform.count = buffer_priv->count;
         pipeline_uniform.data  = buffer_priv->data;
@@ -88,13 +187,24 @@ static int register_uniforms(struct pass *s)
         {.name = "ngl_modelview_matrix",  .type = NGLI_TYPE_MAT4, .count = 1, .data = NULL},
         {.name = "ngl_projection_matrix", .type = NGLI_TYPE_MAT4, .count = 1, .data = NULL},
         {.name = "ngl_normal_matrix",     .type = NGLI_TYPE_MAT3, .count = 1, .data = NULL},
+        {.name = "ngl_framebuffer_scale", .type = NGLI_TYPE_VEC2, .count = 1, .data = NULL},
+        {.name = "ngl_view_matrices",     .type = NGLI_TYPE_MAT4, .count = s->nb_views, .data = NULL},
+    };
+
+    int *indices[] = {
+        &s->modelview_matrix_index,
+        &s->projection_matrix_index,
+        &s->normal_matrix_index,
+        &s->framebuffer_scale_index,
+        &s->view_matrices_index,
     };
 
     for (int i = 0; i < NGLI_ARRAY_NB(pipeline_uniforms); i++) {
         struct pipeline_uniform *pipeline_uniform = &pipeline_uniforms[i];
-        struct hmap *infos = s->pipeline_program->uniforms;
-        if (!ngli_hmap_get(infos, pipeline_uniform->name))
+        pipeline_uniform->info = ngli_hmap_get(s->pipeline_program->uniforms, pipeline_uniform->name);
+        if (!pipeline_uniform->info)
             continue;
+        *indices[i] = ngli_darray_count(&s->pipeline_uniforms);
         if (!ngli_darray_push(&s->pipeline_uniforms, pipeline_uniform))
             return NGL_ERROR_MEMORY;
     }
@@ -121,13 +231,13 @@ struct texture_info_field {
 };
 
 struct texture_info {
-    const char *name;
     struct image *image;
     struct texture_info_field sampling_mode;
     struct texture_info_field default_sampler;
     struct texture_info_field coordinate_matrix;
     struct texture_info_field dimensions;
     struct texture_info_field timestamp;
+    struct texture_info_field age;
     struct texture_info_field oes_sampler;
     struct texture_info_field y_sampler;
     struct texture_info_field uv_sampler;
@@ -150,6 +260,7 @@ static const struct texture_info_map {
     {"_dimensions",       (const int[]){NGLI_TYPE_VEC2,
                                         NGLI_TYPE_VEC3, 0},                        OFFSET(dimensions)},
     {"_ts",               (const int[]){NGLI_TYPE_FLOAT, 0},                       OFFSET(timestamp)},
+    {"_age",              (const int[]){NGLI_TYPE_FLOAT, 0},                       OFFSET(age)},
     {"_external_sampler", (const int[]){NGLI_TYPE_SAMPLER_EXTERNAL_OES,
                                         NGLI_TYPE_SAMPLER_EXTERNAL_2D_Y2Y_EXT, 0}, OFFSET(oes_sampler)},
     {"_y_sampler",        (const int[]){NGLI_TYPE_SAMPLER_2D, 0},                  OFFSET(y_sampler)},
@@ -182,6 +293,40 @@ static int is_sampler_or_image(int type)
     }
 }
 
+/*
+ * Uniforms of a program matching the suffixed names of a texture, resolved
+ * once per program and texture name, and then shared by all the passes
+ * using this program
+ */
+struct texture_layout {
+    struct uniformprograminfo *infos[NGLI_ARRAY_NB(texture_info_maps)];
+    char names[NGLI_ARRAY_NB(texture_info_maps)][MAX_ID_LEN];
+};
+
+static const struct texture_layout *get_texture_layout(struct program *program, const char *name)
+{
+    struct texture_layout *layout = ngli_hmap_get(program->texture_layouts, name);
+    if (layout)
+        return layout;
+
+    layout = ngli_calloc(1, sizeof(*layout));
+    if (!layout)
+        return NULL;
+
+    for (int i = 0; i < NGLI_ARRAY_NB(texture_info_maps); i++) {
+        const struct texture_info_map *map = &texture_info_maps[i];
+        snprintf(layout->names[i], sizeof(layout->names[i]), "%s%s", name, map->suffix);
+        layout->infos[i] = ngli_hmap_get(program->uniforms, layout->names[i]);
+    }
+
+    if (ngli_hmap_set(program->texture_layouts, name, layout) < 0) {
+        ngli_free(layout);
+        return NULL;
+    }
+
+    return layout;
+}
+
 static int register_texture(struct pass *s, const char *name, struct ngl_node *texture)
 {
     if (!texture)
@@ -191,27 +336,27 @@ static int register_texture(struct pass *s, const char *name, struct ngl_node *t
     struct image *image = &texture_priv->image;
 
     struct texture_info info = {
-        .name  = name,
         .image = image,
     };
 
-    struct hmap *infos = s->pipeline_program->uniforms;
+    const struct texture_layout *layout = get_texture_layout(s->pipeline_program, name);
+    if (!layout)
+        return NGL_ERROR_MEMORY;
+
     for (int i = 0; i < NGLI_ARRAY_NB(texture_info_maps); i++) {
         const struct texture_info_map *map = &texture_info_maps[i];
 
         uint8_t *info_p = (uint8_t *)&info + map->field_offset;
         struct texture_info_field *field = (struct texture_info_field *)info_p;
+        field->index = -1;
 
-        char uniform_name[MAX_ID_LEN];
-        snprintf(uniform_name, sizeof(uniform_name), "%s%s", name, map->suffix);
-
-        const struct uniformprograminfo *uniform = ngli_hmap_get(infos, uniform_name);
+        struct uniformprograminfo *uniform = layout->infos[i];
         if (!uniform)
             continue;
 
         if (!is_allowed_type(map->allowed_types, uniform->type)) {
             LOG(ERROR, "invalid type 0x%x found for texture uniform %s",
-                uniform->type, uniform_name);
+                uniform->type, layout->names[i]);
             return NGL_ERROR_INVALID_ARG;
         }
         field->active = 1;
@@ -220,17 +365,20 @@ static int register_texture(struct pass *s, const char *name, struct ngl_node *t
 
         if (field->is_sampler_or_image) {
             struct pipeline_texture pipeline_texture = {
-                .name = {0}
+                .info = uniform,
             };
-            snprintf(pipeline_texture.name, sizeof(pipeline_texture.name), "%s", uniform_name);
+            memcpy(pipeline_texture.name, layout->names[i], sizeof(pipeline_texture.name));
+            field->index = ngli_darray_count(&s->pipeline_textures);
             if (!ngli_darray_push(&s->pipeline_textures, &pipeline_texture))
                 return NGL_ERROR_MEMORY;
         } else {
             struct pipeline_uniform pipeline_uniform = {
                 .type  = uniform->type,
-                .count = 1
+                .count = 1,
+                .info  = uniform,
             };
-            snprintf(pipeline_uniform.name, sizeof(pipeline_uniform.name), "%s", uniform_name);
+            memcpy(pipeline_uniform.name, layout->names[i], sizeof(pipeline_uniform.name));
+            field->index = ngli_darray_count(&s->pipeline_uniforms);
             if (!ngli_darray_push(&s->pipeline_uniforms, &pipeline_uniform))
                 return NGL_ERROR_MEMORY;
         }
@@ -255,6 +403,18 @@ static int register_texture(struct pass *s, const char *name, struct ngl_node *t
 
     texture_priv->supported_image_layouts &= supported_image_layouts;
 
+    /* A texture packed into an atlas is addressed through its coordinates matrix */
+    const int packable = info.default_sampler.type == NGLI_TYPE_SAMPLER_2D &&
+                         info.coordinate_matrix.active;
+    if (!packable) {
+        if (texture_priv->atlas_region.page) {
+            LOG(ERROR, "texture %s is packed into an atlas but is not sampled "
+                "with a sampler2D and its coordinates matrix", name);
+            return NGL_ERROR_INVALID_USAGE;
+        }
+        texture_priv->packable = 0;
+    }
+
     if (!ngli_darray_push(&s->texture_infos, &info))
         return NGL_ERROR_MEMORY;
 
@@ -282,22 +442,54 @@ static int register_textures(struct pass *s)
     return 0;
 }
 
+/* The copy of the render target sampled by the ngl_framebuffer_fetch() fallback */
+static int register_framebuffer(struct pass *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    struct uniformprograminfo *info = ngli_hmap_get(s->pipeline_program->uniforms, "ngl_framebuffer");
+    if (!info)
+        return 0;
+
+    if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT)) {
+        LOG(ERROR, "ngl_framebuffer_fetch() requires either framebuffer fetch or blit support");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    struct pipeline_texture pipeline_texture = {
+        .info = info,
+    };
+    snprintf(pipeline_texture.name, sizeof(pipeline_texture.name), "ngl_framebuffer");
+    s->framebuffer_index = ngli_darray_count(&s->pipeline_textures);
+    if (!ngli_darray_push(&s->pipeline_textures, &pipeline_texture))
+        return NGL_ERROR_MEMORY;
+
+    return 0;
+}
+
 static int register_block(struct pass *s, const char *name, struct ngl_node *block)
 {
     if (!block)
         return 0;
 
-    struct hmap *infos = s->pipeline_program->buffer_blocks;
-    if (!ngli_hmap_get(infos, name)) {
+    const struct blockprograminfo *info = ngli_hmap_get(s->pipeline_program->buffer_blocks, name);
+    if (!info) {
         struct pass_params *params = &s->params;
         LOG(WARNING, "block %s attached to pipeline %s not found in shader", name, params->label);
         return 0;
     }
 
     struct block_priv *block_priv = block->priv_data;
+    if (block_priv->layout == NGLI_BLOCK_LAYOUT_INTERLEAVED) {
+        LOG(ERROR, "interleaved block %s can only be accessed through vertex attributes", name);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
     struct buffer *buffer = &block_priv->buffer;
     struct pipeline_buffer pipeline_buffer = {
         .buffer = buffer,
+        .info   = info,
     };
     snprintf(pipeline_buffer.name, sizeof(pipeline_buffer.name), "%s", name);
 
@@ -343,7 +535,8 @@ static int check_attributes(struct pass *s, struct hmap *attributes, int per_ins
         struct buffer_priv *buffer = anode->priv_data;
 
         if (per_instance) {
-            if (buffer->count != s->params.nb_instances) {
+            /* The instances of indirect draws are only known by the GPU */
+            if (!s->params.indirect_buffer && buffer->count != s->params.nb_instances) {
                 LOG(ERROR, "attribute buffer %s count (%d) does not match instance count (%d)",
                     entry->key, buffer->count, s->params.nb_instances);
                 return NGL_ERROR_INVALID_ARG;
@@ -361,13 +554,91 @@ static int check_attributes(struct pass *s, struct hmap *attributes, int per_ins
     return 0;
 }
 
+struct morph_info {
+    const struct buffer_priv *buffer;
+    int kf_indices[2];
+};
+
+/*
+ * A buffer interpolated on the GPU is exposed as the <name>_kf0 and
+ * <name>_kf1 attributes, both reading the single buffer holding all the key
+ * frames at the offsets of the current pair, and the <name>_ratio uniform.
+ */
+static int register_morph_attribute(struct pass *s, const char *name, struct ngl_node *attribute, int rate, int warn)
+{
+    struct morph_info info = {.buffer = attribute->priv_data, .kf_indices = {-1, -1}};
+    char kf_names[2][MAX_ID_LEN];
+    const struct attributeprograminfo *kf_infos[2];
+    for (int i = 0; i < 2; i++) {
+        snprintf(kf_names[i], sizeof(kf_names[i]), "%s_kf%d", name, i);
+        kf_infos[i] = ngli_hmap_get(s->pipeline_program->attributes, kf_names[i]);
+    }
+
+    if (!kf_infos[0] && !kf_infos[1]) {
+        if (warn) {
+            const struct pass_params *params = &s->params;
+            LOG(WARNING, "attributes %s_kf0 and %s_kf1 attached to pipeline %s not found in shader",
+                name, name, params->label);
+        }
+        return 0;
+    }
+
+    if (rate > 0) {
+        LOG(ERROR, "buffer %s interpolated on the GPU can not be used as an instance attribute", name);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    int ret = ngli_node_buffer_ref(attribute);
+    if (ret < 0)
+        return ret;
+
+    struct buffer_priv *attribute_priv = attribute->priv_data;
+    for (int i = 0; i < 2; i++) {
+        if (!kf_infos[i])
+            continue;
+        struct pipeline_attribute pipeline_attribute = {
+            .format = attribute_priv->data_format,
+            .stride = attribute_priv->data_stride,
+            .count  = 1,
+            .buffer = &attribute_priv->buffer,
+            .info   = kf_infos[i],
+        };
+        snprintf(pipeline_attribute.name, sizeof(pipeline_attribute.name), "%s", kf_names[i]);
+        info.kf_indices[i] = ngli_darray_count(&s->pipeline_attributes);
+        if (!ngli_darray_push(&s->pipeline_attributes, &pipeline_attribute))
+            return NGL_ERROR_MEMORY;
+    }
+
+    struct pipeline_uniform pipeline_uniform = {
+        .type  = NGLI_TYPE_FLOAT,
+        .count = 1,
+        .data  = &attribute_priv->kf_ratio,
+    };
+    snprintf(pipeline_uniform.name, sizeof(pipeline_uniform.name), "%s_ratio", name);
+    pipeline_uniform.info = ngli_hmap_get(s->pipeline_program->uniforms, pipeline_uniform.name);
+    if (pipeline_uniform.info && !ngli_darray_push(&s->pipeline_uniforms, &pipeline_uniform))
+        return NGL_ERROR_MEMORY;
+
+    if (!ngli_darray_push(&s->morph_infos, &info))
+        return NGL_ERROR_MEMORY;
+
+    if (!ngli_darray_push(&s->attributes, &attribute))
+        return NGL_ERROR_MEMORY;
+
+    return 0;
+}
+
 static int register_attribute(struct pass *s, const char *name, struct ngl_node *attribute, int rate, int warn)
 {
     if (!attribute)
         return 0;
 
-    struct hmap *infos = s->pipeline_program->attributes;
-    if (!ngli_hmap_get(infos, name)) {
+    const struct buffer_priv *buffer_priv = attribute->priv_data;
+    if (buffer_priv->gpu_interpolation)
+        return register_morph_attribute(s, name, attribute, rate, warn);
+
+    const struct attributeprograminfo *info = ngli_hmap_get(s->pipeline_program->attributes, name);
+    if (!info) {
         if (warn) {
             const struct pass_params *params = &s->params;
             LOG(WARNING, "attribute %s attached to pipeline %s not found in shader", name, params->label);
@@ -399,6 +670,7 @@ static int register_attribute(struct pass *s, const char *name, struct ngl_node
         .count  = 1,
         .rate   = rate,
         .buffer = buffer,
+        .info   = info,
     };
     snprintf(pipeline_attribute.name, sizeof(pipeline_attribute.name), "%s", name);
 
@@ -411,6 +683,92 @@ static int register_attribute(struct pass *s, const char *name, struct ngl_node
     return 0;
 }
 
+#define MAX_INSTANCES_PER_DRAW 128
+
+static int register_instance_matrices(struct pass *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    const struct pass_params *params = &s->params;
+
+    const char *name = "ngl_instance_modelview_matrix";
+    const struct attributeprograminfo *info = ngli_hmap_get(s->pipeline_program->attributes, name);
+    if (!info)
+        return 0;
+
+    if (info->type != NGLI_TYPE_MAT4) {
+        LOG(ERROR, "%s must be a mat4", name);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    if (params->nb_instances || params->indirect_buffer) {
+        LOG(ERROR, "%s can not be used along with explicit instancing or indirect draws", name);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    const int matrix_size = 4 * 4 * sizeof(float);
+    s->instance_matrices = ngli_calloc(MAX_INSTANCES_PER_DRAW, matrix_size);
+    if (!s->instance_matrices)
+        return NGL_ERROR_MEMORY;
+
+    int ret = ngli_buffer_init(&s->instance_matrices_buffer, ctx,
+                               MAX_INSTANCES_PER_DRAW * matrix_size, NGLI_BUFFER_USAGE_STREAM);
+    if (ret < 0)
+        return ret;
+
+    struct pipeline_attribute pipeline_attribute = {
+        .format = NGLI_FORMAT_R32G32B32A32_SFLOAT,
+        .stride = 4 * sizeof(float),
+        .offset = 0,
+        .count  = 4,
+        .rate   = 1,
+        .buffer = &s->instance_matrices_buffer,
+        .info   = info,
+    };
+    snprintf(pipeline_attribute.name, sizeof(pipeline_attribute.name), "%s", name);
+
+    if (!ngli_darray_push(&s->pipeline_attributes, &pipeline_attribute))
+        return NGL_ERROR_MEMORY;
+
+    /* The pipeline always issues instanced draws, with at least one instance */
+    s->pipeline_graphics.nb_instances = 1;
+
+    return 0;
+}
+
+/*
+ * The indirect buffer can reference a block field written by a previous
+ * compute, in which case the block buffer is read at the field offset
+ */
+static int init_indirect_buffer(struct pass *s, int command_size, int nb_commands,
+                                struct buffer **bufferp, int *offsetp)
+{
+    struct ngl_node *indirect = s->params.indirect_buffer;
+    int ret = ngli_node_buffer_ref(indirect);
+    if (ret < 0)
+        return ret;
+    s->indirect = indirect;
+
+    struct buffer_priv *indirect_priv = indirect->priv_data;
+    int size = indirect_priv->data_size;
+    *bufferp = &indirect_priv->buffer;
+    *offsetp = 0;
+    if (indirect_priv->block) {
+        struct block_priv *block = indirect_priv->block->priv_data;
+        const struct block_field_info *fi = &block->field_info[indirect_priv->block_field];
+        size = fi->size;
+        *bufferp = &block->buffer;
+        *offsetp = fi->offset;
+    }
+
+    if (size < command_size * nb_commands) {
+        LOG(ERROR, "indirect buffer is too small (%d bytes) for %d commands of %d bytes",
+            size, nb_commands, command_size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    return 0;
+}
+
 static int pass_graphics_init(struct pass *s)
 {
     struct ngl_ctx *ctx = s->ctx;
@@ -419,9 +777,21 @@ static int pass_graphics_init(struct pass *s)
     s->pipeline_type = NGLI_PIPELINE_TYPE_GRAPHICS;
 
     if (!s->pipeline_program) {
-        const char *vertex = ngli_get_default_shader(NGLI_PROGRAM_SHADER_VERT);
         const char *fragment = ngli_get_default_shader(NGLI_PROGRAM_SHADER_FRAG);
-        int ret = ngli_program_init(&s->default_program, ctx, vertex, fragment, NULL);
+        char *vertex = ngli_get_default_vertex_shader(fragment);
+        if (!vertex)
+            return NGL_ERROR_MEMORY;
+        char *texvideo_fragment = NULL;
+        int ret = ngli_texvideo_preprocess(ctx->glcontext, fragment, &texvideo_fragment);
+        if (ret < 0) {
+            ngli_free(vertex);
+            return ret;
+        }
+        if (texvideo_fragment)
+            fragment = texvideo_fragment;
+        ret = ngli_program_init(&s->default_program, ctx, vertex, fragment, NULL);
+        ngli_free(texvideo_fragment);
+        ngli_free(vertex);
         if (ret < 0)
             return ret;
         s->pipeline_program = &s->default_program;
@@ -458,13 +828,32 @@ static int pass_graphics_init(struct pass *s)
     }
 
     int ret;
+    if (params->indirect_buffer) {
+        if (params->nb_instances) {
+            LOG(ERROR, "the number of instances of indirect draws is read from the indirect buffer");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        if (params->nb_indirect_draws < 1) {
+            LOG(ERROR, "the number of indirect draws must be at least 1");
+            return NGL_ERROR_INVALID_ARG;
+        }
+        const int command_size = (graphics->indices ? 5 : 4) * sizeof(uint32_t);
+        ret = init_indirect_buffer(s, command_size, params->nb_indirect_draws,
+                                   &graphics->indirect_buffer, &graphics->indirect_offset);
+        if (ret < 0)
+            return ret;
+        graphics->nb_indirect_draws = params->nb_indirect_draws;
+    }
+
     if ((ret = check_attributes(s, params->attributes, 0)) < 0 ||
         (ret = check_attributes(s, params->instance_attributes, 1)) < 0)
         return ret;
 
     if ((ret = register_attribute(s, "ngl_position", geometry_priv->vertices_buffer, 0, 0)) < 0 ||
         (ret = register_attribute(s, "ngl_uvcoord",  geometry_priv->uvcoords_buffer, 0, 0)) < 0 ||
-        (ret = register_attribute(s, "ngl_normal",   geometry_priv->normals_buffer,  0, 0)) < 0)
+        (ret = register_attribute(s, "ngl_normal",   geometry_priv->normals_buffer,  0, 0)) < 0 ||
+        (ret = register_attribute(s, "ngl_joints",   geometry_priv->joints_buffer,   0, 0)) < 0 ||
+        (ret = register_attribute(s, "ngl_weights",  geometry_priv->weights_buffer,  0, 0)) < 0)
         return ret;
 
     if (params->attributes) {
@@ -485,7 +874,7 @@ static int pass_graphics_init(struct pass *s)
         }
     }
 
-    return 0;
+    return register_instance_matrices(s);
 }
 
 static int pass_compute_init(struct pass *s)
@@ -496,31 +885,20 @@ static int pass_compute_init(struct pass *s)
     s->pipeline_compute.nb_group_x = params->nb_group_x;
     s->pipeline_compute.nb_group_y = params->nb_group_y;
     s->pipeline_compute.nb_group_z = params->nb_group_z;
+    s->pipeline_compute.barriers = params->barriers;
+
+    if (params->indirect_buffer)
+        return init_indirect_buffer(s, 3 * sizeof(uint32_t), 1,
+                                    &s->pipeline_compute.indirect_buffer,
+                                    &s->pipeline_compute.indirect_offset);
 
     return 0;
 }
 
-int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params *params)
+static int pass_build(struct pass *s)
 {
-    s->ctx = ctx;
-    s->params = *params;
-
-    ngli_darray_init(&s->attributes, sizeof(struct ngl_node *), 0);
-    ngli_darray_init(&s->textures, sizeof(struct ngl_node *), 0);
-    ngli_darray_init(&s->uniforms, sizeof(struct ngl_node *), 0);
-    ngli_darray_init(&s->blocks, sizeof(struct ngl_node *), 0);
-
-    ngli_darray_init(&s->texture_infos, sizeof(struct texture_info), 0);
-
-    ngli_darray_init(&s->pipeline_attributes, sizeof(struct pipeline_attribute), 0);
-    ngli_darray_init(&s->pipeline_textures, sizeof(struct pipeline_texture), 0);
-    ngli_darray_init(&s->pipeline_uniforms, sizeof(struct pipeline_uniform), 0);
-    ngli_darray_init(&s->pipeline_buffers, sizeof(struct pipeline_buffer), 0);
-
-    if (params->program) {
-        struct program_priv *program_priv = params->program->priv_data;
-        s->pipeline_program = &program_priv->program;
-    }
+    struct ngl_ctx *ctx = s->ctx;
+    const struct pass_params *params = &s->params;
 
     int ret = params->geometry ? pass_graphics_init(s)
                                : pass_compute_init(s);
@@ -529,6 +907,7 @@ int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params
 
     if ((ret = register_uniforms(s)) < 0 ||
         (ret = register_textures(s)) < 0 ||
+        (ret = register_framebuffer(s)) < 0 ||
         (ret = register_blocks(s)) < 0)
         return ret;
 
@@ -551,34 +930,177 @@ int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params
     if (ret < 0)
         return ret;
 
-    s->modelview_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "ngl_modelview_matrix");
-    s->projection_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "ngl_projection_matrix");
-    s->normal_matrix_index = ngli_pipeline_get_uniform_index(&s->pipeline, "ngl_normal_matrix");
+    /*
+     * All the entries are resolved against the program, so the indices
+     * recorded while registering them are also the pipeline ones, and the
+     * entries are not needed anymore
+     */
+    ngli_darray_reset(&s->pipeline_attributes);
+    ngli_darray_reset(&s->pipeline_textures);
+    ngli_darray_reset(&s->pipeline_uniforms);
+    ngli_darray_reset(&s->pipeline_buffers);
 
-    struct texture_info *texture_infos = ngli_darray_data(&s->texture_infos);
-    for (int i = 0; i < ngli_darray_count(&s->texture_infos); i++) {
-        struct texture_info *info = &texture_infos[i];
-        for (int i = 0; i < NGLI_ARRAY_NB(texture_info_maps); i++) {
-            const struct texture_info_map *map = &texture_info_maps[i];
-
-            uint8_t *info_p = (uint8_t *)info + map->field_offset;
-            struct texture_info_field *field = (struct texture_info_field *)info_p;
-            if (!field->active) {
-                field->index = -1;
-                continue;
-            }
+    /*
+     * The matrices uniforms would only honor the first instance of a merged
+     * draw, so the passes relying on them are never merged.
+     */
+    s->batchable = s->instance_matrices &&
+                   s->modelview_matrix_index < 0 &&
+                   s->normal_matrix_index < 0;
+
+    return 0;
+}
 
-            char name[MAX_ID_LEN];
-            snprintf(name, sizeof(name), "%s%s", info->name, map->suffix);
+/*
+ * The pass can only be built once its program is ready: with asynchronous
+ * programs, this is retried at every update until the driver is done.
+ */
+static int pass_try_build(struct pass *s)
+{
+    if (s->build_error)
+        return s->build_error;
+
+    if (s->pipeline_program) {
+        int ret = ngli_program_poll(s->pipeline_program);
+        if (ret <= 0)
+            return ret;
+    }
 
-            if (field->is_sampler_or_image)
-                field->index = ngli_pipeline_get_texture_index(&s->pipeline, name);
-            else
-                field->index = ngli_pipeline_get_uniform_index(&s->pipeline, name);
+    int ret = pass_build(s);
+    if (ret < 0) {
+        s->build_error = ret;
+        return ret;
+    }
+
+    s->ready = 1;
+    return 1;
+}
+
+static int is_specializable_type(int type)
+{
+    switch (type) {
+    case NGLI_TYPE_INT:
+    case NGLI_TYPE_FLOAT:
+    case NGLI_TYPE_VEC2:
+    case NGLI_TYPE_VEC3:
+    case NGLI_TYPE_VEC4:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * The uniforms which can not change over time (neither animated nor
+ * streamed) are compiled as constants into a program of the pass, shared
+ * with the passes using the same program and values. Their live changes
+ * are then rejected.
+ */
+static int init_specialized_program(struct pass *s)
+{
+    const struct pass_params *params = &s->params;
+    struct program_priv *program_priv = params->program->priv_data;
+    s->pipeline_program = &program_priv->program;
+
+    if (!params->uniforms)
+        return 0;
+
+    struct darray constants;
+    ngli_darray_init(&constants, sizeof(struct uniformpack_constant), 0);
+
+    int ret = 0;
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(params->uniforms, entry))) {
+        const struct ngl_node *uniform = entry->data;
+        if (!uniform || uniform->class->category != NGLI_NODE_CATEGORY_UNIFORM)
+            continue;
+        const struct variable_priv *variable_priv = uniform->priv_data;
+        if (variable_priv->dynamic || variable_priv->gpu_lookup ||
+            !is_specializable_type(variable_priv->data_type))
+            continue;
+        const struct uniformpack_constant constant = {
+            .name = entry->key,
+            .type = variable_priv->data_type,
+            .data = variable_priv->data,
+        };
+        if (!ngli_darray_push(&constants, &constant)) {
+            ret = NGL_ERROR_MEMORY;
+            goto end;
         }
     }
 
-    return 0;
+    if (!ngli_darray_count(&constants))
+        goto end;
+
+    ret = ngli_node_program_specialize(params->program, &s->specialized_program,
+                                       ngli_darray_data(&constants), ngli_darray_count(&constants));
+    if (ret < 0)
+        goto end;
+    s->pipeline_program = &s->specialized_program;
+
+    const struct uniformpack_constant *constant = ngli_darray_data(&constants);
+    for (int i = 0; i < ngli_darray_count(&constants); i++) {
+        if (!constant[i].specialized)
+            continue;
+        struct ngl_node *uniform = ngli_hmap_get(params->uniforms, constant[i].name);
+        if (!ngli_darray_push(&s->specialized_uniforms, &uniform)) {
+            ret = NGL_ERROR_MEMORY;
+            goto end;
+        }
+        struct variable_priv *variable_priv = uniform->priv_data;
+        variable_priv->specialized++;
+    }
+
+end:
+    ngli_darray_reset(&constants);
+    return ret;
+}
+
+int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params *params)
+{
+    s->ctx = ctx;
+    s->params = *params;
+    s->normal_matrix_version = 0;
+    s->modelview_matrix_index = -1;
+    s->projection_matrix_index = -1;
+    s->normal_matrix_index = -1;
+    s->framebuffer_index = -1;
+    s->framebuffer_scale_index = -1;
+    s->view_matrices_index = -1;
+    s->nb_views = 1;
+
+    ngli_darray_init(&s->attributes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->textures, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->uniforms, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->blocks, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->lookup_buffers, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->specialized_uniforms, sizeof(struct ngl_node *), 0);
+
+    ngli_darray_init(&s->texture_infos, sizeof(struct texture_info), 0);
+    ngli_darray_init(&s->morph_infos, sizeof(struct morph_info), 0);
+
+    ngli_darray_init(&s->pipeline_attributes, sizeof(struct pipeline_attribute), 0);
+    ngli_darray_init(&s->pipeline_textures, sizeof(struct pipeline_texture), 0);
+    ngli_darray_init(&s->pipeline_uniforms, sizeof(struct pipeline_uniform), 0);
+    ngli_darray_init(&s->pipeline_buffers, sizeof(struct pipeline_buffer), 0);
+
+    if (params->program && ctx->config.specialize_uniforms) {
+        int ret = init_specialized_program(s);
+        if (ret < 0)
+            return ret;
+    } else if (params->program) {
+        struct program_priv *program_priv = params->program->priv_data;
+        s->pipeline_program = &program_priv->program;
+    }
+
+    if (params->program) {
+        const struct program_priv *program_priv = params->program->priv_data;
+        s->framebuffer_fetch = ngli_fbfetch_is_used(program_priv->fragment);
+        s->nb_views = NGLI_MAX(program_priv->nb_views, 1);
+    }
+
+    int ret = pass_try_build(s);
+    return NGLI_MIN(ret, 0);
 }
 
 #define NODE_TYPE_DEFAULT 0
@@ -615,13 +1137,24 @@ void ngli_pass_uninit(struct pass *s)
 
     if (s->indices)
         ngli_node_buffer_unref(s->indices);
+    if (s->indirect)
+        ngli_node_buffer_unref(s->indirect);
 
     ngli_darray_reset(&s->uniforms);
     ngli_darray_reset(&s->textures);
     reset_block_nodes(&s->blocks);
     reset_buffer_nodes(&s->attributes);
+    reset_buffer_nodes(&s->lookup_buffers);
+
+    struct ngl_node **specialized_uniforms = ngli_darray_data(&s->specialized_uniforms);
+    for (int i = 0; i < ngli_darray_count(&s->specialized_uniforms); i++) {
+        struct variable_priv *variable_priv = specialized_uniforms[i]->priv_data;
+        variable_priv->specialized--;
+    }
+    ngli_darray_reset(&s->specialized_uniforms);
 
     ngli_darray_reset(&s->texture_infos);
+    ngli_darray_reset(&s->morph_infos);
 
     ngli_darray_reset(&s->pipeline_attributes);
     ngli_darray_reset(&s->pipeline_textures);
@@ -629,6 +1162,10 @@ void ngli_pass_uninit(struct pass *s)
     ngli_darray_reset(&s->pipeline_buffers);
 
     ngli_program_reset(&s->default_program);
+    ngli_program_reset(&s->specialized_program);
+
+    ngli_buffer_reset(&s->instance_matrices_buffer);
+    ngli_free(s->instance_matrices);
 
     memset(s, 0, sizeof(*s));
 }
@@ -666,6 +1203,12 @@ DECLARE_UPDATE_NODES_FUNC(buffer, NODE_TYPE_BUFFER)
 
 int ngli_pass_update(struct pass *s, double t)
 {
+    if (!s->ready) {
+        int ret = pass_try_build(s);
+        if (ret <= 0)
+            return ret;
+    }
+
     int ret;
     if ((ret = update_common_nodes(&s->uniforms, t)) < 0 ||
         (ret = update_common_nodes(&s->textures, t)) < 0 ||
@@ -673,39 +1216,106 @@ int ngli_pass_update(struct pass *s, double t)
         (ret = update_buffer_nodes(&s->attributes, t)))
         return ret;
 
+    if (s->indirect) {
+        if ((ret = ngli_node_update(s->indirect, t)) < 0 ||
+            (ret = ngli_node_buffer_upload(s->indirect)) < 0)
+            return ret;
+    }
+
+    if (s->indices && (ret = ngli_node_buffer_upload(s->indices)) < 0)
+        return ret;
+
+    struct ngl_node **lookup_buffers = ngli_darray_data(&s->lookup_buffers);
+    for (int i = 0; i < ngli_darray_count(&s->lookup_buffers); i++) {
+        ret = ngli_node_finish_upload(lookup_buffers[i]);
+        if (ret < 0)
+            return ret;
+    }
+
     return 0;
 }
 
-int ngli_pass_exec(struct pass *s)
+/*
+ * The modelview matrices of the instances are expected to be contiguous,
+ * nb_instances can only be greater than 1 for batchable passes. The version
+ * is the one of the first modelview matrix, from which the normal matrix is
+ * derived.
+ */
+static void pass_exec(struct pass *s, const float *modelview_matrix, uint64_t modelview_version,
+                      const float *projection_matrix, int nb_instances)
 {
     struct ngl_ctx *ctx = s->ctx;
 
-    const float *modelview_matrix = ngli_darray_tail(&ctx->modelview_matrix_stack);
-    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+    /* The vertex shader must render as many views as the render target holds */
+    if (s->pipeline_type == NGLI_PIPELINE_TYPE_GRAPHICS) {
+        const struct rendertarget *rt = ctx->rendertarget;
+        const int nb_views = rt && rt->nb_views ? rt->nb_views : 1;
+        if (nb_views != s->nb_views) {
+            if (!s->views_mismatch)
+                LOG(ERROR, "program of pipeline %s renders %d view(s) but the render target holds %d, "
+                    "skipping its draws", s->params.label, s->nb_views, nb_views);
+            s->views_mismatch = 1;
+            return;
+        }
+        if (nb_views > 1)
+            ngli_pipeline_update_uniform(&s->pipeline, s->view_matrices_index, ctx->view_matrices);
+    }
+
+    if (s->instance_matrices) {
+        ngli_buffer_upload(&s->instance_matrices_buffer, modelview_matrix, nb_instances * 4 * 4 * sizeof(float));
+        s->pipeline.graphics.nb_instances = nb_instances;
+    }
 
     ngli_pipeline_update_uniform(&s->pipeline, s->modelview_matrix_index, modelview_matrix);
     ngli_pipeline_update_uniform(&s->pipeline, s->projection_matrix_index, projection_matrix);
 
     if (s->normal_matrix_index >= 0) {
-        float normal_matrix[3*3];
-        ngli_mat3_from_mat4(normal_matrix, modelview_matrix);
-        ngli_mat3_inverse(normal_matrix, normal_matrix);
-        ngli_mat3_transpose(normal_matrix, normal_matrix);
-        ngli_pipeline_update_uniform(&s->pipeline, s->normal_matrix_index, normal_matrix);
+        /*
+         * A new modelview version does not imply a new normal matrix: it
+         * only depends on the upper-left 3x3 part, which translations leave
+         * untouched
+         */
+        if (s->normal_matrix_version != modelview_version) {
+            float linear_matrix[3*3];
+            ngli_mat3_from_mat4(linear_matrix, modelview_matrix);
+            if (!s->normal_matrix_version ||
+                memcmp(s->normal_matrix_src, linear_matrix, sizeof(linear_matrix))) {
+                memcpy(s->normal_matrix_src, linear_matrix, sizeof(linear_matrix));
+                ngli_mat3_inverse(s->normal_matrix, linear_matrix);
+                ngli_mat3_transpose(s->normal_matrix, s->normal_matrix);
+            }
+            s->normal_matrix_version = modelview_version;
+        }
+        ngli_pipeline_update_uniform(&s->pipeline, s->normal_matrix_index, s->normal_matrix);
     }
 
+    const struct morph_info *morph_infos = ngli_darray_data(&s->morph_infos);
+    for (int i = 0; i < ngli_darray_count(&s->morph_infos); i++) {
+        const struct morph_info *info = &morph_infos[i];
+        const struct buffer_priv *buffer = info->buffer;
+        const int kf_size = buffer->count * buffer->data_stride;
+        for (int j = 0; j < 2; j++)
+            ngli_pipeline_update_attribute(&s->pipeline, info->kf_indices[j], buffer->kf_pair[j] * kf_size);
+    }
+
+    struct ngl_node **textures = ngli_darray_data(&s->textures);
     struct texture_info *texture_infos = ngli_darray_data(&s->texture_infos);
     for (int i = 0; i < ngli_darray_count(&s->texture_infos); i++) {
         struct texture_info *info = &texture_infos[i];
         struct image *image = info->image;
         const float ts = image->ts;
+        const float age = image->age;
 
         ngli_pipeline_update_uniform(&s->pipeline, info->coordinate_matrix.index, image->coordinates_matrix);
         ngli_pipeline_update_uniform(&s->pipeline, info->timestamp.index, &ts);
+        ngli_pipeline_update_uniform(&s->pipeline, info->age.index, &age);
 
         if (image->layout) {
+            /* The dimensions of a packed texture are the ones of its atlas region */
+            const struct texture_priv *texture_priv = textures[i]->priv_data;
             const struct texture *plane = image->planes[0];
-            const struct texture_params *plane_params = &plane->params;
+            const struct texture_params *plane_params = texture_priv->atlas_region.page ? &texture_priv->params
+                                                                                       : &plane->params;
             const float dimensions[] = {plane_params->width, plane_params->height, plane_params->depth};
             ngli_pipeline_update_uniform(&s->pipeline, info->dimensions.index, dimensions);
         }
@@ -733,6 +1343,367 @@ int ngli_pass_exec(struct pass *s)
     }
 
     ngli_pipeline_exec(&s->pipeline);
+}
+
+/*
+ * Only the opaque graphics draws, relying on the depth test to resolve their
+ * visibility, can be executed in any order without altering the rendering.
+ */
+static int is_reorderable(const struct pass *s, const struct graphicconfig *gc)
+{
+    return s->pipeline_type == NGLI_PIPELINE_TYPE_GRAPHICS &&
+           gc->depth_test && gc->depth_write_mask &&
+           !gc->blend && !gc->stencil_test;
+}
+
+/*
+ * Blended draws testing the depth can be moved after the opaque draws: they
+ * are still rendered in order, on top of what is in front of them.
+ */
+static int is_deferrable(const struct pass *s, const struct graphicconfig *gc)
+{
+    return s->pipeline_type == NGLI_PIPELINE_TYPE_GRAPHICS &&
+           gc->depth_test && gc->blend && !gc->stencil_test;
+}
+
+/*
+ * Nearest depth of the draw, as the smallest depth of its geometry bounding
+ * box (or its origin if unknown) in normalized device coordinates; the
+ * depth is negated if the depth test keeps the farthest fragments.
+ */
+static float get_draw_depth(const struct pass *s, const float *modelview_matrix,
+                            const float *projection_matrix, const struct graphicconfig *gc)
+{
+    static const float origin[3] = {0};
+    const struct geometry_priv *geometry = s->params.geometry->priv_data;
+    const int has_bounds = geometry->has_bounds;
+
+    NGLI_ALIGNED_MAT(matrix);
+    ngli_mat4_mul(matrix, projection_matrix, modelview_matrix);
+    const float depth = ngli_mat4_box_min_depth(matrix, has_bounds ? geometry->bounds_min : origin,
+                                                        has_bounds ? geometry->bounds_max : origin);
+    const int reversed = gc->depth_func == NGLI_COMPARE_OP_GREATER ||
+                         gc->depth_func == NGLI_COMPARE_OP_GREATER_OR_EQUAL;
+    return reversed ? -depth : depth;
+}
+
+static GLuint get_first_texture_id(const struct pass *s)
+{
+    const struct texture_info *texture_infos = ngli_darray_data(&s->texture_infos);
+    for (int i = 0; i < ngli_darray_count(&s->texture_infos); i++) {
+        const struct image *image = texture_infos[i].image;
+        if (image->layout != NGLI_IMAGE_LAYOUT_NONE && image->planes[0])
+            return image->planes[0]->id;
+    }
+    return 0;
+}
+
+static int record_draw_item(struct pass *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+
+    struct draw_item *item = ngli_darray_push(&ctx->draw_items, NULL);
+    if (!item)
+        return NGL_ERROR_MEMORY;
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    item->pass = s;
+    memcpy(item->modelview_matrix, modelview->matrix, sizeof(item->modelview_matrix));
+    item->modelview_version = modelview->version;
+    memcpy(item->projection_matrix, ngli_darray_tail(&ctx->projection_matrix_stack), sizeof(item->projection_matrix));
+    item->graphicconfig = ctx->graphicconfig;
+    item->reorderable = is_reorderable(s, &ctx->graphicconfig);
+    item->depth_sort = ctx->draw_list_depth_sort;
+    item->depth_prepass = ctx->draw_list_depth_sort && ctx->draw_list_depth_prepass;
+    /* Only the reorderable draws are graphics ones with a depth test */
+    item->depth = item->depth_sort && item->reorderable
+                ? get_draw_depth(s, item->modelview_matrix, item->projection_matrix, &item->graphicconfig)
+                : 0.0f;
+    item->program_id = s->pipeline_program->id;
+    item->texture_id = get_first_texture_id(s);
+    item->index = ngli_darray_count(&ctx->draw_items) - 1;
+    return 0;
+}
+
+static int compare_draw_items(const void *a, const void *b)
+{
+    const struct draw_item *item_a = a;
+    const struct draw_item *item_b = b;
+    if (item_a->program_id != item_b->program_id)
+        return item_a->program_id < item_b->program_id ? -1 : 1;
+    if (item_a->texture_id != item_b->texture_id)
+        return item_a->texture_id < item_b->texture_id ? -1 : 1;
+    const uintptr_t geometry_a = (uintptr_t)item_a->pass->params.geometry;
+    const uintptr_t geometry_b = (uintptr_t)item_b->pass->params.geometry;
+    if (geometry_a != geometry_b)
+        return geometry_a < geometry_b ? -1 : 1;
+    return item_a->index - item_b->index;
+}
+
+static int compare_draw_items_depth(const void *a, const void *b)
+{
+    const struct draw_item *item_a = a;
+    const struct draw_item *item_b = b;
+    if (item_a->reorderable != item_b->reorderable)
+        return item_a->reorderable ? -1 : 1;
+    if (!item_a->reorderable)
+        return item_a->index - item_b->index;
+    if (item_a->depth != item_b->depth)
+        return item_a->depth < item_b->depth ? -1 : 1;
+    return compare_draw_items(a, b);
+}
+
+static int same_nodes(const struct hmap *a, const struct hmap *b)
+{
+    const int count_a = a ? ngli_hmap_count(a) : 0;
+    const int count_b = b ? ngli_hmap_count(b) : 0;
+    if (count_a != count_b)
+        return 0;
+    if (!count_a)
+        return 1;
+
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(a, entry)))
+        if (ngli_hmap_get_h(b, entry->key, entry->hash) != entry->data)
+            return 0;
+    return 1;
+}
+
+/*
+ * Two draws can be merged if only their modelview matrices differ: since the
+ * instances of a draw are rendered in order, this is true for any draw and
+ * not only the reorderable ones.
+ */
+static int can_merge_draw_items(const struct draw_item *a, const struct draw_item *b)
+{
+    const struct pass *pass_a = a->pass;
+    const struct pass *pass_b = b->pass;
+
+    if (!pass_a->batchable || !pass_b->batchable)
+        return 0;
+
+    if (memcmp(&a->graphicconfig, &b->graphicconfig, sizeof(a->graphicconfig)) ||
+        memcmp(a->projection_matrix, b->projection_matrix, sizeof(a->projection_matrix)))
+        return 0;
+
+    if (pass_a == pass_b)
+        return 1;
+
+    const struct pass_params *params_a = &pass_a->params;
+    const struct pass_params *params_b = &pass_b->params;
+    return params_a->program  == params_b->program  &&
+           params_a->geometry == params_b->geometry &&
+           same_nodes(params_a->textures,   params_b->textures)   &&
+           same_nodes(params_a->uniforms,   params_b->uniforms)   &&
+           same_nodes(params_a->blocks,     params_b->blocks)     &&
+           same_nodes(params_a->attributes, params_b->attributes);
+}
+
+void ngli_pass_begin_draw_list(struct ngl_ctx *ctx)
+{
+    ctx->draw_list_depth++;
+}
+
+void ngli_pass_end_draw_list(struct ngl_ctx *ctx)
+{
+    ngli_assert(ctx->draw_list_depth > 0);
+    if (--ctx->draw_list_depth == 0)
+        ngli_pass_flush_draw_list(ctx);
+}
+
+enum {
+    STAGE_DEFAULT,
+    STAGE_DEPTH_ONLY,
+    STAGE_SHADING,
+};
+
+static void set_item_graphicconfig(struct ngl_ctx *ctx, const struct draw_item *item, int stage)
+{
+    if (stage == STAGE_DEFAULT || !item->reorderable) {
+        ngli_glstate_set_pending(ctx, &item->graphicconfig, NULL);
+        return;
+    }
+
+    struct graphicconfig graphicconfig = item->graphicconfig;
+    if (stage == STAGE_DEPTH_ONLY) {
+        graphicconfig.color_write_mask = 0;
+    } else {
+        graphicconfig.depth_write_mask = 0;
+        graphicconfig.depth_func = NGLI_COMPARE_OP_EQUAL;
+    }
+    ngli_glstate_set_pending(ctx, &graphicconfig, NULL);
+}
+
+static void exec_draw_items(struct ngl_ctx *ctx, const struct draw_item *items, int nb_items, int stage)
+{
+    for (int i = 0; i < nb_items;) {
+        const struct draw_item *item = &items[i];
+        struct pass *pass = item->pass;
+
+        /* Only the opaque draws take part in the depth pre-pass */
+        if (stage == STAGE_DEPTH_ONLY && !item->reorderable)
+            break;
+        set_item_graphicconfig(ctx, item, stage);
+
+        int nb_instances = 1;
+        if (pass->batchable) {
+            const int matrix_size = sizeof(item->modelview_matrix);
+            memcpy(pass->instance_matrices, item->modelview_matrix, matrix_size);
+            while (i + nb_instances < nb_items &&
+                   nb_instances < MAX_INSTANCES_PER_DRAW &&
+                   can_merge_draw_items(item, &items[i + nb_instances])) {
+                const struct draw_item *next = &items[i + nb_instances];
+                memcpy(pass->instance_matrices + nb_instances * 4 * 4, next->modelview_matrix, matrix_size);
+                nb_instances++;
+            }
+            pass_exec(pass, pass->instance_matrices, item->modelview_version,
+                      item->projection_matrix, nb_instances);
+        } else {
+            pass_exec(pass, item->modelview_matrix, item->modelview_version,
+                      item->projection_matrix, 1);
+        }
+
+        i += nb_instances;
+    }
+}
+
+/*
+ * A depth sorted run spans the consecutive reorderable and deferrable items
+ * recorded with depth sorting, any other item is a barrier
+ */
+static int get_depth_sorted_run(const struct draw_item *items, int nb_items)
+{
+    int n = 0;
+    while (n < nb_items && items[n].depth_sort &&
+           items[n].depth_prepass == items[0].depth_prepass &&
+           (items[n].reorderable || is_deferrable(items[n].pass, &items[n].graphicconfig)))
+        n++;
+    return n;
+}
+
+void ngli_pass_flush_draw_list(struct ngl_ctx *ctx)
+{
+    struct draw_item *items = ngli_darray_data(&ctx->draw_items);
+    const int nb_items = ngli_darray_count(&ctx->draw_items);
+    if (!nb_items)
+        return;
+
+    const struct graphicconfig graphicconfig = ctx->graphicconfig;
+    for (int i = 0; i < nb_items;) {
+        struct draw_item *run = &items[i];
+        int nb_run_items = get_depth_sorted_run(run, nb_items - i);
+        if (nb_run_items) {
+            qsort(run, nb_run_items, sizeof(*run), compare_draw_items_depth);
+            if (run->depth_prepass) {
+                exec_draw_items(ctx, run, nb_run_items, STAGE_DEPTH_ONLY);
+                exec_draw_items(ctx, run, nb_run_items, STAGE_SHADING);
+            } else {
+                exec_draw_items(ctx, run, nb_run_items, STAGE_DEFAULT);
+            }
+        } else {
+            /* Sort every run of consecutive reorderable items by state */
+            nb_run_items = 1;
+            while (i + nb_run_items < nb_items && !items[i + nb_run_items].depth_sort &&
+                   items[i + nb_run_items].reorderable == run->reorderable)
+                nb_run_items++;
+            if (run->reorderable && nb_run_items > 1)
+                qsort(run, nb_run_items, sizeof(*run), compare_draw_items);
+            exec_draw_items(ctx, run, nb_run_items, STAGE_DEFAULT);
+        }
+        i += nb_run_items;
+    }
+    ngli_glstate_set_pending(ctx, &graphicconfig, NULL);
+
+    ctx->draw_items.count = 0;
+}
+
+static int copy_framebuffer(struct pass *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct rendertarget *rt = ctx->rendertarget;
+    struct texture *copy = &ctx->framebuffer_copy;
+    struct rendertarget *copy_rt = &ctx->framebuffer_copy_rt;
+    const int width = rt ? rt->width : gl->width;
+    const int height = rt ? rt->height : gl->height;
+
+    /*
+     * The copy only grows so the passes drawing into render targets of
+     * different sizes do not reallocate it at every draw
+     */
+    if (copy_rt->width < width || copy_rt->height < height) {
+        struct texture_params params = NGLI_TEXTURE_PARAM_DEFAULTS;
+        params.format = NGLI_FORMAT_R8G8B8A8_UNORM;
+        params.width = NGLI_MAX(width, copy_rt->width);
+        params.height = NGLI_MAX(height, copy_rt->height);
+        ngli_pass_reset_framebuffer_copy(ctx);
+        int ret = ngli_texture_init(copy, ctx, &params);
+        if (ret < 0)
+            return ret;
+
+        const struct texture *attachments[] = {copy};
+        struct rendertarget_params rt_params = {
+            .width = params.width,
+            .height = params.height,
+            .nb_attachments = NGLI_ARRAY_NB(attachments),
+            .attachments = attachments,
+        };
+        ret = ngli_rendertarget_init(copy_rt, ctx, &rt_params);
+        if (ret < 0) {
+            ngli_pass_reset_framebuffer_copy(ctx);
+            return ret;
+        }
+    }
+
+    const GLuint fbo_id = rt ? rt->id : ngli_glcontext_get_default_framebuffer(gl);
+    ngli_glBindFramebuffer(gl, GL_READ_FRAMEBUFFER, fbo_id);
+    ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, copy_rt->id);
+    ngli_glBlitFramebuffer(gl, 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+
+    const float scale[] = {1.f / copy_rt->width, 1.f / copy_rt->height};
+    ngli_pipeline_update_uniform(&s->pipeline, s->framebuffer_scale_index, scale);
+    return ngli_pipeline_update_texture(&s->pipeline, s->framebuffer_index, copy);
+}
+
+void ngli_pass_reset_framebuffer_copy(struct ngl_ctx *ctx)
+{
+    ngli_rendertarget_reset(&ctx->framebuffer_copy_rt);
+    ngli_texture_reset(&ctx->framebuffer_copy);
+}
+
+int ngli_pass_exec(struct pass *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+
+    ctx->nb_pass_execs++;
+
+    if (!s->ready)
+        return 0;
+
+    struct ngl_node **textures = ngli_darray_data(&s->textures);
+    for (int i = 0; i < ngli_darray_count(&s->textures); i++)
+        ngli_node_texture_copy_block_field(textures[i]);
+
+    if (ctx->draw_list_depth) {
+        if (!s->framebuffer_fetch && record_draw_item(s) >= 0)
+            return 0;
+        /*
+         * Preserve the draw order if the item could not be recorded, or if
+         * it reads the result of the previous draws
+         */
+        ngli_pass_flush_draw_list(ctx);
+    }
+
+    if (s->framebuffer_index >= 0) {
+        int ret = copy_framebuffer(s);
+        if (ret < 0)
+            return ret;
+    }
+
+    const struct modelview *modelview = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+    pass_exec(s, modelview->matrix, modelview->version, projection_matrix, 1);
 
     return 0;
 }
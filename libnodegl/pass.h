@@ -23,11 +23,14 @@
 #define PASS_H
 
 #include <stdint.h>
+#include "buffer.h"
 #include "darray.h"
 #include "glcontext.h"
 #include "glincludes.h"
+#include "graphicconfig.h"
 #include "pipeline.h"
 #include "program.h"
+#include "utils.h"
 
 struct pass_params {
     const char *label;
@@ -41,11 +44,16 @@ struct pass_params {
     int nb_instances;
     struct hmap *attributes;
     struct hmap *instance_attributes;
+    int nb_indirect_draws;
 
     /* compute */
     int nb_group_x;
     int nb_group_y;
     int nb_group_z;
+    int barriers;
+
+    /* draw commands or number of work groups, read by the GPU */
+    struct ngl_node *indirect_buffer;
 };
 
 enum {
@@ -58,16 +66,21 @@ struct pass {
     struct pass_params params;
 
     struct program default_program;
+    struct program specialized_program;
+    struct darray specialized_uniforms;
 
     struct darray attributes;
     struct darray textures;
     struct darray uniforms;
     struct darray blocks;
+    struct darray lookup_buffers;
 
     struct darray texture_infos;
+    struct darray morph_infos;
 
     struct ngl_node *indices;
     struct buffer *indices_buffer;
+    struct ngl_node *indirect;
 
     int pipeline_type;
     struct program *pipeline_program;
@@ -82,6 +95,37 @@ struct pass {
     int modelview_matrix_index;
     int projection_matrix_index;
     int normal_matrix_index;
+    int framebuffer_fetch;
+    int framebuffer_index;
+    int framebuffer_scale_index;
+    int view_matrices_index;
+    int nb_views;
+    int views_mismatch;
+    uint64_t normal_matrix_version;
+    float normal_matrix_src[3*3];
+    float normal_matrix[3*3];
+
+    struct buffer instance_matrices_buffer;
+    float *instance_matrices;
+    int batchable;
+
+    int ready;
+    int build_error;
+};
+
+struct draw_item {
+    struct pass *pass;
+    NGLI_ALIGNED_MAT(modelview_matrix);
+    uint64_t modelview_version;
+    NGLI_ALIGNED_MAT(projection_matrix);
+    struct graphicconfig graphicconfig;
+    int reorderable;
+    int depth_sort;      /* ctx->draw_list_depth_sort at record time */
+    int depth_prepass;   /* ctx->draw_list_depth_prepass at record time */
+    float depth;         /* nearest depth of the geometry, only set with depth_sort */
+    GLuint program_id;
+    GLuint texture_id;
+    int index;
 };
 
 int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params *params);
@@ -89,4 +133,33 @@ void ngli_pass_uninit(struct pass *s);
 int ngli_pass_update(struct pass *s, double t);
 int ngli_pass_exec(struct pass *s);
 
+/*
+ * While a draw list is open, the passes executions are recorded instead of
+ * being executed immediately. The list is sorted by state (where the
+ * graphic configuration allows it) and executed when the outermost draw list
+ * is closed, or when ngli_pass_flush_draw_list() is called (typically before
+ * a render target change).
+ *
+ * Consecutive draws of passes relying on the ngl_instance_modelview_matrix
+ * attribute and sharing the same resources and states are merged into a
+ * single instanced draw.
+ *
+ * The draws recorded while ctx->draw_list_depth_sort is set are instead
+ * sorted front to back, and followed by the blended draws relying on the
+ * depth test in their original order. With ctx->draw_list_depth_prepass,
+ * the sorted draws are first executed writing only the depth, then shaded
+ * with an equal depth test.
+ */
+void ngli_pass_begin_draw_list(struct ngl_ctx *ctx);
+void ngli_pass_end_draw_list(struct ngl_ctx *ctx);
+void ngli_pass_flush_draw_list(struct ngl_ctx *ctx);
+
+/*
+ * The passes reading the framebuffer with ngl_framebuffer_fetch() are never
+ * recorded in a draw list. Without GL_EXT_shader_framebuffer_fetch, the
+ * render target is copied before each of their draws into a texture shared
+ * by all the passes, released with this function.
+ */
+void ngli_pass_reset_framebuffer_copy(struct ngl_ctx *ctx);
+
 #endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "darray.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "params.h"
+#include "patch.h"
+
+extern const struct node_param ngli_base_node_params[];
+extern const struct param_specs ngli_params_specs[];
+
+struct param_change {
+    struct ngl_node *dst;
+    const struct node_param *par;
+    const uint8_t *src_value;
+};
+
+struct patch {
+    struct hmap *dst_pairs; // dst node -> src node
+    struct hmap *src_pairs; // src node -> dst node
+    struct darray changes;  // struct param_change
+};
+
+static int str_equal(const char *a, const char *b)
+{
+    if (!a || !b)
+        return a == b;
+    return !strcmp(a, b);
+}
+
+static int values_equal(const struct node_param *par, const uint8_t *a, const uint8_t *b)
+{
+    switch (par->type) {
+        case PARAM_TYPE_STR:
+            return str_equal(*(const char **)a, *(const char **)b);
+        case PARAM_TYPE_DATA:
+        case PARAM_TYPE_DBLLIST: {
+            const int size_a = *(const int *)(a + sizeof(void *));
+            const int size_b = *(const int *)(b + sizeof(void *));
+            const int elem_size = par->type == PARAM_TYPE_DBLLIST ? sizeof(double) : 1;
+            const void *data_a = *(const void **)a;
+            const void *data_b = *(const void **)b;
+            /* The data released by a GPU-only buffer can not be compared */
+            return size_a == size_b &&
+                   (!size_a || (data_a && data_b && !memcmp(data_a, data_b, size_a * elem_size)));
+        }
+        default:
+            return !memcmp(a, b, ngli_params_specs[par->type].size);
+    }
+}
+
+static int match_nodes(struct patch *s, struct ngl_node *dst, const struct ngl_node *src);
+
+static int match_params(struct patch *s, struct ngl_node *dst, uint8_t *dst_base,
+                        const struct ngl_node *src, const uint8_t *src_base,
+                        const struct node_param *par)
+{
+    for (; par && par->key; par++) {
+        uint8_t *dst_p = dst_base + par->offset;
+        const uint8_t *src_p = src_base + par->offset;
+
+        switch (par->type) {
+            case PARAM_TYPE_NODE: {
+                int ret = match_nodes(s, *(struct ngl_node **)dst_p, *(struct ngl_node * const *)src_p);
+                if (ret <= 0)
+                    return ret;
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **dst_nodes = *(struct ngl_node ***)dst_p;
+                struct ngl_node * const *src_nodes = *(struct ngl_node * const **)src_p;
+                const int nb_nodes = *(const int *)(dst_p + sizeof(struct ngl_node **));
+                if (nb_nodes != *(const int *)(src_p + sizeof(struct ngl_node **)))
+                    return 0;
+                for (int i = 0; i < nb_nodes; i++) {
+                    int ret = match_nodes(s, dst_nodes[i], src_nodes[i]);
+                    if (ret <= 0)
+                        return ret;
+                }
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                const struct hmap *dst_hmap = *(struct hmap **)dst_p;
+                const struct hmap *src_hmap = *(struct hmap * const *)src_p;
+                const int nb_nodes = dst_hmap ? ngli_hmap_count(dst_hmap) : 0;
+                if (nb_nodes != (src_hmap ? ngli_hmap_count(src_hmap) : 0))
+                    return 0;
+                const struct hmap_entry *entry = NULL;
+                while (nb_nodes && (entry = ngli_hmap_next(dst_hmap, entry))) {
+                    const struct ngl_node *src_node = ngli_hmap_get_h(src_hmap, entry->key, entry->hash);
+                    if (!src_node)
+                        return 0;
+                    int ret = match_nodes(s, entry->data, src_node);
+                    if (ret <= 0)
+                        return ret;
+                }
+                break;
+            }
+            default:
+                if (values_equal(par, dst_p, src_p))
+                    break;
+                if (!(par->flags & PARAM_FLAG_ALLOW_LIVE_CHANGE) ||
+                    par->type == PARAM_TYPE_DBLLIST) {
+                    LOG(DEBUG, "%s.%s differs and can not be live changed", dst->label, par->key);
+                    return 0;
+                }
+                struct param_change change = {
+                    .dst = dst,
+                    .par = par,
+                    .src_value = src_p,
+                };
+                if (!ngli_darray_push(&s->changes, &change))
+                    return NGL_ERROR_MEMORY;
+                break;
+        }
+    }
+    return 1;
+}
+
+static int match_nodes(struct patch *s, struct ngl_node *dst, const struct ngl_node *src)
+{
+    if (!dst || !src)
+        return dst == src;
+
+    char dst_key[32], src_key[32];
+    (void)snprintf(dst_key, sizeof(dst_key), "%p", dst);
+    (void)snprintf(src_key, sizeof(src_key), "%p", src);
+
+    /* Shared nodes must be shared the same way in both graphs */
+    const struct ngl_node *dst_pair = ngli_hmap_get(s->dst_pairs, dst_key);
+    const struct ngl_node *src_pair = ngli_hmap_get(s->src_pairs, src_key);
+    if (dst_pair || src_pair)
+        return dst_pair == src && src_pair == dst;
+
+    if (dst->class != src->class || !str_equal(dst->label, src->label))
+        return 0;
+
+    int ret;
+    if ((ret = ngli_hmap_set(s->dst_pairs, dst_key, (void *)src)) < 0 ||
+        (ret = ngli_hmap_set(s->src_pairs, src_key, dst)) < 0)
+        return ret;
+
+    ret = match_params(s, dst, (uint8_t *)dst, src, (const uint8_t *)src, ngli_base_node_params);
+    if (ret <= 0)
+        return ret;
+    return match_params(s, dst, dst->priv_data, src, src->priv_data, dst->class->params);
+}
+
+static int apply_change(const struct param_change *change)
+{
+    struct ngl_node *node = change->dst;
+    const struct node_param *par = change->par;
+    const uint8_t *v = change->src_value;
+
+    switch (par->type) {
+        case PARAM_TYPE_INT:
+        case PARAM_TYPE_BOOL:
+            return ngl_node_param_set(node, par->key, *(const int *)v);
+        case PARAM_TYPE_SELECT:
+            return ngl_node_param_set(node, par->key,
+                                      ngli_params_get_select_str(par->choices->consts, *(const int *)v));
+        case PARAM_TYPE_FLAGS: {
+            char *str = ngli_params_get_flags_str(par->choices->consts, *(const int *)v);
+            if (!str)
+                return NGL_ERROR_MEMORY;
+            int ret = ngl_node_param_set(node, par->key, str);
+            ngli_free(str);
+            return ret;
+        }
+        case PARAM_TYPE_I64:
+            return ngl_node_param_set(node, par->key, *(const int64_t *)v);
+        case PARAM_TYPE_DBL:
+            return ngl_node_param_set(node, par->key, *(const double *)v);
+        case PARAM_TYPE_STR:
+            return ngl_node_param_set(node, par->key, *(const char **)v);
+        case PARAM_TYPE_DATA:
+            return ngl_node_param_set(node, par->key, *(const int *)(v + sizeof(void *)), *(void **)v);
+        case PARAM_TYPE_VEC2:
+        case PARAM_TYPE_VEC3:
+        case PARAM_TYPE_VEC4:
+        case PARAM_TYPE_MAT4:
+            return ngl_node_param_set(node, par->key, (const float *)v);
+        case PARAM_TYPE_RATIONAL:
+            return ngl_node_param_set(node, par->key, ((const int *)v)[0], ((const int *)v)[1]);
+    }
+    return NGL_ERROR_BUG;
+}
+
+int ngli_patch_scene(struct ngl_node *dst, const struct ngl_node *src)
+{
+    struct patch s = {
+        .dst_pairs = ngli_hmap_create(),
+        .src_pairs = ngli_hmap_create(),
+    };
+    ngli_darray_init(&s.changes, sizeof(struct param_change), 0);
+
+    int ret = NGL_ERROR_MEMORY;
+    if (!s.dst_pairs || !s.src_pairs)
+        goto end;
+
+    /* Nothing is changed until the whole graphs are known to match */
+    ret = match_nodes(&s, dst, src);
+    if (ret <= 0)
+        goto end;
+
+    const struct param_change *changes = ngli_darray_data(&s.changes);
+    const int nb_changes = ngli_darray_count(&s.changes);
+    for (int i = 0; i < nb_changes; i++) {
+        ret = apply_change(&changes[i]);
+        if (ret < 0)
+            goto end;
+    }
+    LOG(DEBUG, "scene patched with %d parameter change(s)", nb_changes);
+    ret = 1;
+
+end:
+    ngli_darray_reset(&s.changes);
+    ngli_hmap_freep(&s.src_pairs);
+    ngli_hmap_freep(&s.dst_pairs);
+    return ret;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PATCH_H
+#define PATCH_H
+
+#include "nodegl.h"
+
+/*
+ * Apply to the dst graph the parameter changes needed to make it identical to
+ * the src graph, if the two graphs only differ by live changeable parameters.
+ * The nodes are paired by walking both graphs in parallel, and must have the
+ * same class, label and topology.
+ *
+ * Return 1 if dst has been patched, 0 if the graphs can not be reconciled
+ * (in which case dst is left untouched), or a negative error code.
+ */
+int ngli_patch_scene(struct ngl_node *dst, const struct ngl_node *src);
+
+#endif
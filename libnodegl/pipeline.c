@@ -26,8 +26,11 @@
 #include "log.h"
 #include "nodes.h"
 #include "pipeline.h"
+#include "texture.h"
 #include "topology.h"
 #include "type.h"
+#include "uniformpack.h"
+#include "uniformring.h"
 
 typedef void (*set_uniform_func)(struct glcontext *gl, GLint location, int count, const void *data);
 
@@ -35,6 +38,9 @@ struct uniform_pair {
     GLuint location;
     struct pipeline_uniform uniform;
     set_uniform_func set;
+    struct uniformprograminfo *info;
+    int size;
+    int block_offset;
 };
 
 struct texture_pair {
@@ -42,6 +48,7 @@ struct texture_pair {
     GLuint location;
     GLuint binding;
     struct pipeline_texture texture;
+    struct uniformprograminfo *info;
 };
 
 struct buffer_pair {
@@ -53,7 +60,11 @@ struct buffer_pair {
 struct attribute_pair {
     int count;
     GLuint location;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
     struct pipeline_attribute attribute;
+    int buffer_offset;
 };
 
 static void set_uniform_1i(struct glcontext *gl, GLint location, int count, const void *data)
@@ -102,6 +113,33 @@ static const set_uniform_func set_uniform_func_map[NGLI_TYPE_NB] = {
     [NGLI_TYPE_MAT4]  = set_uniform_mat4fv,
 };
 
+/*
+ * Update the shadow copy of the uniform in the program and return whether the
+ * value actually changed. The cache is shared by all the pipelines using the
+ * program since the uniform values are part of the GL program state.
+ */
+static int update_uniform_cache(struct uniformprograminfo *info, const void *data, int size)
+{
+    if (!info->cache)
+        return 1;
+    size = NGLI_MIN(size, info->cache_size);
+    if (!memcmp(info->cache, data, size))
+        return 0;
+    memcpy(info->cache, data, size);
+    return 1;
+}
+
+static void set_uniform(struct pipeline *s, struct glcontext *gl, struct uniform_pair *pair, const void *data)
+{
+    if (pair->block_offset >= 0) {
+        const int count = NGLI_MIN(pair->uniform.count, pair->info->size);
+        ngli_uniformpack_write(s->uniform_block + pair->block_offset, pair->info->type, data, count);
+        return;
+    }
+    if (update_uniform_cache(pair->info, data, pair->size))
+        pair->set(gl, pair->location, pair->uniform.count, data);
+}
+
 static int build_uniform_pairs(struct pipeline *s, const struct pipeline_params *params)
 {
     const struct program *program = params->program;
@@ -111,7 +149,8 @@ static int build_uniform_pairs(struct pipeline *s, const struct pipeline_params
 
     for (int i = 0; i < params->nb_uniforms; i++) {
         const struct pipeline_uniform *uniform = &params->uniforms[i];
-        const struct uniformprograminfo *info = ngli_hmap_get(program->uniforms, uniform->name);
+        struct uniformprograminfo *info = uniform->info ? uniform->info
+                                                        : ngli_hmap_get(program->uniforms, uniform->name);
         if (!info)
             continue;
 
@@ -127,6 +166,9 @@ static int build_uniform_pairs(struct pipeline *s, const struct pipeline_params
             .location = info->location,
             .uniform = *uniform,
             .set = set_func,
+            .info = info,
+            .size = ngli_type_get_size(uniform->type) * uniform->count,
+            .block_offset = s->uniform_block ? info->block_offset : -1,
         };
         if (!ngli_darray_push(&s->uniform_pairs, &pair))
             return NGL_ERROR_MEMORY;
@@ -137,15 +179,43 @@ static int build_uniform_pairs(struct pipeline *s, const struct pipeline_params
 
 static void set_uniforms(struct pipeline *s, struct glcontext *gl)
 {
-    const struct uniform_pair *pairs = ngli_darray_data(&s->uniform_pairs);
+    struct uniform_pair *pairs = ngli_darray_data(&s->uniform_pairs);
     for (int i = 0; i < ngli_darray_count(&s->uniform_pairs); i++) {
-        const struct uniform_pair *pair = &pairs[i];
+        struct uniform_pair *pair = &pairs[i];
         const struct pipeline_uniform *uniform = &pair->uniform;
         if (uniform->data)
-            pair->set(gl, pair->location, uniform->count, uniform->data);
+            set_uniform(s, gl, pair, uniform->data);
     }
 }
 
+static int push_uniform_block(struct pipeline *s, struct glcontext *gl)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct uniformring *ring = &ctx->uniform_ring;
+
+    if (!ring->ctx) {
+        int ret = ngli_uniformring_init(ring, ctx);
+        if (ret < 0) {
+            ngli_uniformring_reset(ring);
+            return ret;
+        }
+    }
+
+    if (s->uniform_block_gen != ring->gen ||
+        memcmp(s->uniform_block, s->pushed_uniform_block, s->uniform_block_size)) {
+        const int offset = ngli_uniformring_push(ring, s->uniform_block, s->uniform_block_size);
+        if (offset < 0)
+            return offset;
+        memcpy(s->pushed_uniform_block, s->uniform_block, s->uniform_block_size);
+        s->uniform_block_gen = ring->gen;
+        s->uniform_block_offset = offset;
+    }
+
+    ngli_glstate_bind_buffer_range(gl, GL_UNIFORM_BUFFER, s->program->uniform_block_binding,
+                                   ring->buffer.id, s->uniform_block_offset, s->uniform_block_size);
+    return 0;
+}
+
 static int build_texture_pairs(struct pipeline *s, const struct pipeline_params *params)
 {
     const struct program *program = params->program;
@@ -155,7 +225,8 @@ static int build_texture_pairs(struct pipeline *s, const struct pipeline_params
 
     for (int i = 0; i < params->nb_textures; i++) {
         const struct pipeline_texture *texture = &params->textures[i];
-        const struct uniformprograminfo *info = ngli_hmap_get(program->uniforms, texture->name);
+        struct uniformprograminfo *info = texture->info ? texture->info
+                                                        : ngli_hmap_get(program->uniforms, texture->name);
         if (!info)
             continue;
 
@@ -180,6 +251,7 @@ static int build_texture_pairs(struct pipeline *s, const struct pipeline_params
             .location = info->location,
             .binding  = info->binding,
             .texture  = *texture,
+            .info     = info,
         };
         if (!ngli_darray_push(&s->texture_pairs, &pair))
             return NGL_ERROR_MEMORY;
@@ -200,14 +272,23 @@ static int acquire_next_available_texture_unit(uint64_t *texture_units)
     return NGL_ERROR_LIMIT_EXCEEDED;
 }
 
-static void set_textures(struct pipeline *s, struct glcontext *gl)
+/*
+ * Return the number of texture binds, the textures sampled through a
+ * bindless handle not being bound to any texture unit.
+ */
+static int set_textures(struct pipeline *s, struct glcontext *gl)
 {
+    int nb_binds = 0;
     uint64_t texture_units = s->used_texture_units;
-    const struct texture_pair *pairs = ngli_darray_data(&s->texture_pairs);
+    struct texture_pair *pairs = ngli_darray_data(&s->texture_pairs);
     for (int i = 0; i < ngli_darray_count(&s->texture_pairs); i++) {
-        const struct texture_pair *pair = &pairs[i];
+        struct texture_pair *pair = &pairs[i];
         const struct pipeline_texture *pipeline_texture = &pair->texture;
-        const struct texture *texture = pipeline_texture->texture;
+        struct texture *texture = pipeline_texture->texture;
+
+        /* The upload thread may still be transferring the texture content */
+        if (texture)
+            ngli_texture_sync(texture);
 
         if (pair->type == NGLI_TYPE_IMAGE_2D) {
             GLuint texture_id = 0;
@@ -218,25 +299,45 @@ static void set_textures(struct pipeline *s, struct glcontext *gl)
                 texture_id = texture->id;
                 access = ngli_texture_get_gl_access(params->access);
                 internal_format = texture->internal_format;
+                if (params->access & NGLI_ACCESS_WRITE_BIT)
+                    ngli_texture_invalidate_mipmap(texture);
             }
             ngli_glBindImageTexture(gl, pair->binding, texture_id, 0, GL_FALSE, 0, access, internal_format);
+            nb_binds++;
         } else {
+            const uint64_t handle = s->program->bindless_samplers && texture ? ngli_texture_get_handle(texture) : 0;
+            if (handle) {
+                /* The sampler cache holds the handle, or the texture unit with a 0 handle */
+                const uint64_t value[2] = {handle, 0};
+                ngli_texture_update_mipmap(texture);
+                if (update_uniform_cache(pair->info, value, sizeof(value)))
+                    ngli_glUniformHandleui64ARB(gl, pair->location, handle);
+                continue;
+            }
+
             const int texture_index = acquire_next_available_texture_unit(&texture_units);
             if (texture_index < 0)
-                return;
-            ngli_glUniform1i(gl, pair->location, texture_index);
-            ngli_glActiveTexture(gl, GL_TEXTURE0 + texture_index);
+                return nb_binds;
+            const uint64_t value[2] = {0, texture_index};
+            if (update_uniform_cache(pair->info, value, sizeof(value)))
+                ngli_glUniform1i(gl, pair->location, texture_index);
+            ngli_glstate_active_texture(gl, GL_TEXTURE0 + texture_index);
+            if (gl->features & NGLI_FEATURE_SAMPLER_OBJECT)
+                ngli_glstate_bind_sampler(gl, texture_index, texture ? texture->sampler : 0);
             if (texture) {
-                ngli_glBindTexture(gl, texture->target, texture->id);
+                ngli_texture_update_mipmap(texture);
+                ngli_glstate_bind_texture(gl, texture->target, texture->id);
             } else {
-                ngli_glBindTexture(gl, GL_TEXTURE_2D, 0);
+                ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
                 if (gl->features & NGLI_FEATURE_TEXTURE_3D)
-                    ngli_glBindTexture(gl, GL_TEXTURE_3D, 0);
+                    ngli_glstate_bind_texture(gl, GL_TEXTURE_3D, 0);
                 if (gl->features & NGLI_FEATURE_OES_EGL_EXTERNAL_IMAGE)
-                    ngli_glBindTexture(gl, GL_TEXTURE_EXTERNAL_OES, 0);
+                    ngli_glstate_bind_texture(gl, GL_TEXTURE_EXTERNAL_OES, 0);
             }
+            nb_binds++;
         }
     }
+    return nb_binds;
 }
 
 static void set_buffers(struct pipeline *s, struct glcontext *gl)
@@ -246,7 +347,10 @@ static void set_buffers(struct pipeline *s, struct glcontext *gl)
         const struct buffer_pair *pair = &pairs[i];
         const struct pipeline_buffer *pipeline_buffer = &pair->buffer;
         const struct buffer *buffer = pipeline_buffer->buffer;
-        ngli_glBindBufferBase(gl, pair->type, pair->binding, buffer->id);
+        if (buffer->persistent)
+            ngli_glstate_bind_buffer_range(gl, pair->type, pair->binding, buffer->id, buffer->offset, buffer->size);
+        else
+            ngli_glstate_bind_buffer_base(gl, pair->type, pair->binding, buffer->id);
     }
 }
 
@@ -260,7 +364,8 @@ static int build_buffer_pairs(struct pipeline *s, const struct pipeline_params *
     for (int i = 0; i < params->nb_buffers; i++) {
         const struct pipeline_buffer *pipeline_buffer = &params->buffers[i];
         const struct buffer *buffer = pipeline_buffer->buffer;
-        const struct blockprograminfo *info = ngli_hmap_get(program->buffer_blocks, pipeline_buffer->name);
+        const struct blockprograminfo *info = pipeline_buffer->info ? pipeline_buffer->info
+                                                                    : ngli_hmap_get(program->buffer_blocks, pipeline_buffer->name);
         if (!info)
             continue;
 
@@ -285,25 +390,51 @@ static int build_buffer_pairs(struct pipeline *s, const struct pipeline_params *
     return 0;
 }
 
+static void set_vertex_attrib(const struct attribute_pair *pair, struct glcontext *gl)
+{
+    const int count = pair->count;
+    const GLuint location = pair->location;
+    const struct pipeline_attribute *attribute = &pair->attribute;
+    const struct buffer *buffer = attribute->buffer;
+    const GLint stride = attribute->stride * count;
+    const int offset = buffer->offset + attribute->offset;
+
+    for (int i = 0; i < count; i++) {
+        ngli_glEnableVertexAttribArray(gl, location + i);
+        ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, buffer->id);
+        ngli_glVertexAttribPointer(gl, location + i, pair->size, pair->type, pair->normalized, stride, (void*)(uintptr_t)(attribute->stride * i + offset));
+        if ((gl->features & NGLI_FEATURE_INSTANCED_ARRAY) && attribute->rate > 0)
+            ngli_glVertexAttribDivisor(gl, location + i, attribute->rate);
+    }
+}
+
 static void set_vertex_attribs(const struct pipeline *s, struct glcontext *gl)
 {
     const struct attribute_pair *pairs = ngli_darray_data(&s->attribute_pairs);
-    for (int i = 0; i < ngli_darray_count(&s->attribute_pairs); i++) {
-        const struct attribute_pair *pair = &pairs[i];
-        const int count = pair->count;
-        const GLuint location = pair->location;
-        const struct pipeline_attribute *attribute = &pair->attribute;
-        const struct buffer *buffer = attribute->buffer;
-        const GLuint size = ngli_format_get_nb_comp(attribute->format);
-        const GLint stride = attribute->stride * count;
+    for (int i = 0; i < ngli_darray_count(&s->attribute_pairs); i++)
+        set_vertex_attrib(&pairs[i], gl);
+}
 
-        for (int i = 0; i < count; i++) {
-            ngli_glEnableVertexAttribArray(gl, location + i);
-            ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, buffer->id);
-            ngli_glVertexAttribPointer(gl, location, size, GL_FLOAT, GL_FALSE, stride, (void*)(uintptr_t)(stride * i + attribute->offset));
-            if ((gl->features & NGLI_FEATURE_INSTANCED_ARRAY) && attribute->rate > 0)
-                ngli_glVertexAttribDivisor(gl, location + i, attribute->rate);
-        }
+/*
+ * The vertex array objects capture the buffer offsets, so they need to be
+ * updated when a persistently mapped buffer switches to another region, or
+ * when the offset of the attribute itself changes (buffer_offset is then
+ * reset to -1).
+ */
+static void update_vertex_attribs(struct pipeline *s, struct glcontext *gl)
+{
+    if (!(gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT))
+        return;
+
+    struct attribute_pair *pairs = ngli_darray_data(&s->attribute_pairs);
+    for (int i = 0; i < ngli_darray_count(&s->attribute_pairs); i++) {
+        struct attribute_pair *pair = &pairs[i];
+        const struct buffer *buffer = pair->attribute.buffer;
+        if (pair->buffer_offset == buffer->offset)
+            continue;
+        ngli_glstate_bind_vertex_array(gl, s->vao_id);
+        set_vertex_attrib(pair, gl);
+        pair->buffer_offset = buffer->offset;
     }
 }
 
@@ -333,7 +464,8 @@ static int build_attribute_pairs(struct pipeline *s, const struct pipeline_param
 
     for (int i = 0; i < params->nb_attributes; i++) {
         const struct pipeline_attribute *attribute = &params->attributes[i];
-        const struct attributeprograminfo *info = ngli_hmap_get(program->attributes, attribute->name);
+        const struct attributeprograminfo *info = attribute->info ? attribute->info
+                                                                  : ngli_hmap_get(program->attributes, attribute->name);
         if (!info)
             continue;
 
@@ -353,7 +485,13 @@ static int build_attribute_pairs(struct pipeline *s, const struct pipeline_param
             .count     = attribute_count,
             .location  = info->location,
             .attribute = *attribute,
+            .buffer_offset = attribute->buffer->offset,
         };
+        int ret = ngli_format_get_gl_attribute_format(gl, attribute->format, &pair.size,
+                                                      &pair.type, &pair.normalized);
+        if (ret < 0)
+            return ret;
+
         if (!ngli_darray_push(&s->attribute_pairs, &pair))
             return NGL_ERROR_MEMORY;
     }
@@ -363,12 +501,8 @@ static int build_attribute_pairs(struct pipeline *s, const struct pipeline_param
 
 static void use_program(struct pipeline *s, struct glcontext *gl)
 {
-    struct ngl_ctx *ctx = s->ctx;
     const struct program *program = s->program;
-    if (ctx->program_id != program->id) {
-        ngli_glUseProgram(gl, program->id);
-        ctx->program_id = program->id;
-    }
+    ngli_glstate_use_program(gl, program->id);
 }
 
 static const GLenum gl_indices_type_map[NGLI_FORMAT_NB] = {
@@ -384,7 +518,7 @@ static GLenum get_gl_indices_type(int indices_format)
 static void bind_vertex_attribs(const struct pipeline *s, struct glcontext *gl)
 {
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT)
-        ngli_glBindVertexArray(gl, s->vao_id);
+        ngli_glstate_bind_vertex_array(gl, s->vao_id);
     else
         set_vertex_attribs(s, gl);
 }
@@ -403,8 +537,8 @@ static void draw_elements(const struct pipeline *s, struct glcontext *gl)
     const struct buffer *indices = graphics->indices;
     const GLenum gl_topology = ngli_topology_get_gl_topology(graphics->topology);
     const GLenum gl_indices_type = get_gl_indices_type(graphics->indices_format);
-    ngli_glBindBuffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->id);
-    ngli_glDrawElements(gl, gl_topology, graphics->nb_indices, gl_indices_type, 0);
+    ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->id);
+    ngli_glDrawElements(gl, gl_topology, graphics->nb_indices, gl_indices_type, (void *)(uintptr_t)indices->offset);
 
     unbind_vertex_attribs(s, gl);
 }
@@ -417,8 +551,8 @@ static void draw_elements_instanced(const struct pipeline *s, struct glcontext *
     const struct buffer *indices = graphics->indices;
     const GLenum gl_topology = ngli_topology_get_gl_topology(graphics->topology);
     const GLenum gl_indices_type = get_gl_indices_type(graphics->indices_format);
-    ngli_glBindBuffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->id);
-    ngli_glDrawElementsInstanced(gl, gl_topology, graphics->nb_indices, gl_indices_type, 0, graphics->nb_instances);
+    ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->id);
+    ngli_glDrawElementsInstanced(gl, gl_topology, graphics->nb_indices, gl_indices_type, (void *)(uintptr_t)indices->offset, graphics->nb_instances);
 
     unbind_vertex_attribs(s, gl);
 }
@@ -445,12 +579,85 @@ static void draw_arrays_instanced(const struct pipeline *s, struct glcontext *gl
     unbind_vertex_attribs(s, gl);
 }
 
+/*
+ * Without multi draw indirect support, the commands are submitted one by one,
+ * which still saves the read back of the command buffer
+ */
+static void draw_indirect(const struct pipeline *s, struct glcontext *gl)
+{
+    bind_vertex_attribs(s, gl);
+
+    const struct pipeline_graphics *graphics = &s->graphics;
+    const struct buffer *indices = graphics->indices;
+    const GLenum gl_topology = ngli_topology_get_gl_topology(graphics->topology);
+    const int multi_draw = gl->features & NGLI_FEATURE_MULTI_DRAW_INDIRECT;
+    const int command_size = (indices ? 5 : 4) * sizeof(GLuint);
+    uintptr_t offset = graphics->indirect_buffer->offset + graphics->indirect_offset;
+
+    ngli_glBindBuffer(gl, GL_DRAW_INDIRECT_BUFFER, graphics->indirect_buffer->id);
+    if (indices) {
+        const GLenum gl_indices_type = get_gl_indices_type(graphics->indices_format);
+        ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->id);
+        if (multi_draw) {
+            ngli_glMultiDrawElementsIndirect(gl, gl_topology, gl_indices_type, (void *)offset,
+                                             graphics->nb_indirect_draws, 0);
+        } else {
+            for (int i = 0; i < graphics->nb_indirect_draws; i++, offset += command_size)
+                ngli_glDrawElementsIndirect(gl, gl_topology, gl_indices_type, (void *)offset);
+        }
+    } else {
+        if (multi_draw) {
+            ngli_glMultiDrawArraysIndirect(gl, gl_topology, (void *)offset, graphics->nb_indirect_draws, 0);
+        } else {
+            for (int i = 0; i < graphics->nb_indirect_draws; i++, offset += command_size)
+                ngli_glDrawArraysIndirect(gl, gl_topology, (void *)offset);
+        }
+    }
+    ngli_glBindBuffer(gl, GL_DRAW_INDIRECT_BUFFER, 0);
+
+    unbind_vertex_attribs(s, gl);
+}
+
+static const GLbitfield barrier_bits_map[][2] = {
+    {NGLI_BARRIER_VERTEX_ATTRIB_BIT,  GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT},
+    {NGLI_BARRIER_ELEMENT_ARRAY_BIT,  GL_ELEMENT_ARRAY_BARRIER_BIT},
+    {NGLI_BARRIER_UNIFORM_BIT,        GL_UNIFORM_BARRIER_BIT},
+    {NGLI_BARRIER_TEXTURE_FETCH_BIT,  GL_TEXTURE_FETCH_BARRIER_BIT},
+    {NGLI_BARRIER_IMAGE_ACCESS_BIT,   GL_SHADER_IMAGE_ACCESS_BARRIER_BIT},
+    {NGLI_BARRIER_COMMAND_BIT,        GL_COMMAND_BARRIER_BIT},
+    {NGLI_BARRIER_BUFFER_UPDATE_BIT,  GL_BUFFER_UPDATE_BARRIER_BIT},
+    {NGLI_BARRIER_TEXTURE_UPDATE_BIT, GL_TEXTURE_UPDATE_BARRIER_BIT},
+    {NGLI_BARRIER_FRAMEBUFFER_BIT,    GL_FRAMEBUFFER_BARRIER_BIT},
+    {NGLI_BARRIER_STORAGE_BIT,        GL_SHADER_STORAGE_BARRIER_BIT},
+    {NGLI_BARRIER_PIXEL_BUFFER_BIT,   GL_PIXEL_BUFFER_BARRIER_BIT},
+};
+
+static GLbitfield get_gl_barriers(int barriers)
+{
+    if (barriers == -1)
+        return GL_ALL_BARRIER_BITS;
+
+    GLbitfield gl_barriers = 0;
+    for (int i = 0; i < NGLI_ARRAY_NB(barrier_bits_map); i++)
+        if (barriers & barrier_bits_map[i][0])
+            gl_barriers |= barrier_bits_map[i][1];
+    return gl_barriers;
+}
+
 static void dispatch_compute(const struct pipeline *s, struct glcontext *gl)
 {
     const struct pipeline_compute *compute = &s->compute;
-    ngli_glMemoryBarrier(gl, GL_ALL_BARRIER_BITS);
-    ngli_glDispatchCompute(gl, compute->nb_group_x, compute->nb_group_y, compute->nb_group_z);
-    ngli_glMemoryBarrier(gl, GL_ALL_BARRIER_BITS);
+    if (compute->indirect_buffer) {
+        ngli_glBindBuffer(gl, GL_DISPATCH_INDIRECT_BUFFER, compute->indirect_buffer->id);
+        ngli_glDispatchComputeIndirect(gl, compute->indirect_buffer->offset + compute->indirect_offset);
+        ngli_glBindBuffer(gl, GL_DISPATCH_INDIRECT_BUFFER, 0);
+    } else {
+        ngli_glDispatchCompute(gl, compute->nb_group_x, compute->nb_group_y, compute->nb_group_z);
+    }
+
+    const GLbitfield barriers = get_gl_barriers(compute->barriers);
+    if (barriers)
+        ngli_glMemoryBarrier(gl, barriers);
 }
 
 static int pipeline_graphics_init(struct pipeline *s, const struct pipeline_params *params)
@@ -464,17 +671,30 @@ static int pipeline_graphics_init(struct pipeline *s, const struct pipeline_para
         return NGL_ERROR_UNSUPPORTED;
     }
 
+    if (graphics->indirect_buffer) {
+        if (!(gl->features & NGLI_FEATURE_DRAW_INDIRECT)) {
+            LOG(ERROR, "context does not support indirect draws");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (graphics->indices && graphics->indices->persistent) {
+            LOG(ERROR, "indirect draws can not use dynamic indices");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+    }
+
     int ret = build_attribute_pairs(s, params);
     if (ret < 0)
         return ret;
 
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT) {
         ngli_glGenVertexArrays(gl, 1, &s->vao_id);
-        ngli_glBindVertexArray(gl, s->vao_id);
+        ngli_glstate_bind_vertex_array(gl, s->vao_id);
         set_vertex_attribs(s, gl);
     }
 
-    if (graphics->indices)
+    if (graphics->indirect_buffer)
+        s->exec = draw_indirect;
+    else if (graphics->indices)
         s->exec = graphics->nb_instances > 0 ? draw_elements_instanced : draw_elements;
     else
         s->exec = graphics->nb_instances > 0 ? draw_arrays_instanced : draw_arrays;
@@ -494,9 +714,10 @@ static int pipeline_compute_init(struct pipeline *s)
 
     const struct pipeline_compute *compute = &s->compute;
     const int *max_work_groups = gl->max_compute_work_group_counts;
-    if (compute->nb_group_x > max_work_groups[0] ||
-        compute->nb_group_y > max_work_groups[1] ||
-        compute->nb_group_z > max_work_groups[2]) {
+    if (!compute->indirect_buffer &&
+        (compute->nb_group_x > max_work_groups[0] ||
+         compute->nb_group_y > max_work_groups[1] ||
+         compute->nb_group_z > max_work_groups[2])) {
         LOG(ERROR,
             "compute work group size (%d, %d, %d) exceeds driver limit (%d, %d, %d)",
             compute->nb_group_x, compute->nb_group_y, compute->nb_group_z,
@@ -522,6 +743,17 @@ int ngli_pipeline_init(struct pipeline *s, struct ngl_ctx *ctx, const struct pip
     ngli_darray_init(&s->buffer_pairs, sizeof(struct buffer_pair), 0);
     ngli_darray_init(&s->attribute_pairs, sizeof(struct attribute_pair), 0);
 
+    const struct uniformpack *uniform_pack = s->program->uniform_pack;
+    if (uniform_pack) {
+        /* Both copies start zeroed, like the uniforms of a linked program */
+        s->uniform_block_size = uniform_pack->size;
+        s->uniform_block = ngli_calloc(2, uniform_pack->size);
+        if (!s->uniform_block)
+            return NGL_ERROR_MEMORY;
+        s->pushed_uniform_block = s->uniform_block + uniform_pack->size;
+        s->uniform_block_gen = -1;
+    }
+
     int ret;
     if ((ret = build_uniform_pairs(s, params)) < 0 ||
         (ret = build_texture_pairs(s, params)) < 0 ||
@@ -567,6 +799,18 @@ int ngli_pipeline_get_texture_index(struct pipeline *s, const char *name)
     return NGL_ERROR_NOT_FOUND;
 }
 
+int ngli_pipeline_get_attribute_index(struct pipeline *s, const char *name)
+{
+    struct attribute_pair *pairs = ngli_darray_data(&s->attribute_pairs);
+    for (int i = 0; i < ngli_darray_count(&s->attribute_pairs); i++) {
+        struct attribute_pair *pair = &pairs[i];
+        struct pipeline_attribute *attribute = &pair->attribute;
+        if (!strcmp(attribute->name, name))
+            return i;
+    }
+    return NGL_ERROR_NOT_FOUND;
+}
+
 int ngli_pipeline_update_uniform(struct pipeline *s, int index, const void *data)
 {
     if (index < 0)
@@ -580,7 +824,7 @@ int ngli_pipeline_update_uniform(struct pipeline *s, int index, const void *data
         struct ngl_ctx *ctx = s->ctx;
         struct glcontext *gl = ctx->glcontext;
         use_program(s, gl);
-        pair->set(gl, pair->location, pipeline_uniform->count, data);
+        set_uniform(s, gl, pair, data);
     }
     pipeline_uniform->data = NULL;
 
@@ -600,6 +844,22 @@ int ngli_pipeline_update_texture(struct pipeline *s, int index, struct texture *
     return 0;
 }
 
+int ngli_pipeline_update_attribute(struct pipeline *s, int index, int offset)
+{
+    if (index < 0)
+        return NGL_ERROR_NOT_FOUND;
+
+    ngli_assert(index < ngli_darray_count(&s->attribute_pairs));
+    struct attribute_pair *pairs = ngli_darray_data(&s->attribute_pairs);
+    struct attribute_pair *pair = &pairs[index];
+    if (pair->attribute.offset != offset) {
+        pair->attribute.offset = offset;
+        pair->buffer_offset = -1;
+    }
+
+    return 0;
+}
+
 void ngli_pipeline_exec(struct pipeline *s)
 {
     struct ngl_ctx *ctx = s->ctx;
@@ -609,9 +869,25 @@ void ngli_pipeline_exec(struct pipeline *s)
 
     use_program(s, gl);
     set_uniforms(s, gl);
+    if (s->uniform_block) {
+        int ret = push_uniform_block(s, gl);
+        if (ret < 0) {
+            LOG(ERROR, "could not push the uniform block");
+            return;
+        }
+    }
     set_buffers(s, gl);
-    set_textures(s, gl);
+    const int nb_texture_binds = set_textures(s, gl);
+    if (s->type == NGLI_PIPELINE_TYPE_GRAPHICS)
+        update_vertex_attribs(s, gl);
     s->exec(s, gl);
+
+    struct ngl_stats *stats = &ctx->stats;
+    if (s->type == NGLI_PIPELINE_TYPE_GRAPHICS)
+        stats->nb_draws++;
+    else
+        stats->nb_dispatches++;
+    stats->nb_texture_binds += nb_texture_binds;
 }
 
 void ngli_pipeline_reset(struct pipeline *s)
@@ -623,9 +899,11 @@ void ngli_pipeline_reset(struct pipeline *s)
     ngli_darray_reset(&s->texture_pairs);
     ngli_darray_reset(&s->buffer_pairs);
     ngli_darray_reset(&s->attribute_pairs);
+    ngli_free(s->uniform_block);
 
     struct ngl_ctx *ctx = s->ctx;
     struct glcontext *gl = ctx->glcontext;
+    ngli_glstate_forget_vertex_array(gl, s->vao_id);
     ngli_glDeleteVertexArrays(gl, 1, &s->vao_id);
 
     memset(s, 0, sizeof(*s));
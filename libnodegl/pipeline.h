@@ -25,21 +25,31 @@
 #include "nodes.h"
 #include "program.h"
 
+/*
+ * The info field of the uniforms, textures, buffers and attributes can be
+ * set to the probed information of the program if the caller already
+ * resolved it, in which case the name is not looked up again. Such an entry
+ * always gets a pair, so if all the entries are resolved, the index of an
+ * entry is also its index in the pipeline (see ngli_pipeline_get_*_index()).
+ */
 struct pipeline_uniform {
     char name[MAX_ID_LEN];
     int type;
     int count;
     const void *data;
+    struct uniformprograminfo *info;
 };
 
 struct pipeline_texture {
     char name[MAX_ID_LEN];
     struct texture *texture;
+    struct uniformprograminfo *info;
 };
 
 struct pipeline_buffer {
     char name[MAX_ID_LEN];
     struct buffer *buffer;
+    const struct blockprograminfo *info;
 };
 
 struct pipeline_attribute {
@@ -50,8 +60,16 @@ struct pipeline_attribute {
     int offset;
     int rate;
     struct buffer *buffer;
+    const struct attributeprograminfo *info;
 };
 
+/*
+ * When indirect_buffer is set, nb_indirect_draws tightly packed draw commands
+ * are read from it at indirect_offset instead of using nb_vertices (or
+ * nb_indices) and nb_instances: 4 unsigned integers (count, instance count,
+ * first vertex, base instance) per command for arrays, 5 (count, instance
+ * count, first index, base vertex, base instance) for elements.
+ */
 struct pipeline_graphics {
     int topology;
     union {
@@ -61,12 +79,38 @@ struct pipeline_graphics {
     int indices_format;
     int nb_instances;
     struct buffer *indices;
+    struct buffer *indirect_buffer;
+    int indirect_offset;
+    int nb_indirect_draws;
 };
 
+enum {
+    NGLI_BARRIER_VERTEX_ATTRIB_BIT  = 1 << 0,
+    NGLI_BARRIER_ELEMENT_ARRAY_BIT  = 1 << 1,
+    NGLI_BARRIER_UNIFORM_BIT        = 1 << 2,
+    NGLI_BARRIER_TEXTURE_FETCH_BIT  = 1 << 3,
+    NGLI_BARRIER_IMAGE_ACCESS_BIT   = 1 << 4,
+    NGLI_BARRIER_COMMAND_BIT        = 1 << 5,
+    NGLI_BARRIER_BUFFER_UPDATE_BIT  = 1 << 6,
+    NGLI_BARRIER_TEXTURE_UPDATE_BIT = 1 << 7,
+    NGLI_BARRIER_FRAMEBUFFER_BIT    = 1 << 8,
+    NGLI_BARRIER_STORAGE_BIT        = 1 << 9,
+    NGLI_BARRIER_PIXEL_BUFFER_BIT   = 1 << 10,
+};
+
+/*
+ * When indirect_buffer is set, the number of work groups is read from it at
+ * indirect_offset (3 unsigned integers) instead of nb_group_*. The barriers
+ * (any of NGLI_BARRIER_*, or -1 for all of them) are issued after the
+ * dispatch so the following operations observe its writes.
+ */
 struct pipeline_compute {
     int nb_group_x;
     int nb_group_y;
     int nb_group_z;
+    struct buffer *indirect_buffer;
+    int indirect_offset;
+    int barriers;
 };
 
 enum {
@@ -107,13 +151,28 @@ struct pipeline {
 
     uint64_t used_texture_units;
     GLuint vao_id;
+
+    /*
+     * std140 content of the packed uniform block of the program, and its
+     * copy last pushed to the uniform ring, bound again as long as the ring
+     * generation and the content are unchanged
+     */
+    uint8_t *uniform_block;
+    uint8_t *pushed_uniform_block;
+    int uniform_block_size;
+    int uniform_block_gen;
+    int uniform_block_offset;
 };
 
 int ngli_pipeline_init(struct pipeline *s, struct ngl_ctx *ctx, const struct pipeline_params *params);
 int ngli_pipeline_get_uniform_index(struct pipeline *s, const char *name);
 int ngli_pipeline_get_texture_index(struct pipeline *s, const char *name);
+int ngli_pipeline_get_attribute_index(struct pipeline *s, const char *name);
 int ngli_pipeline_update_uniform(struct pipeline *s, int index, const void *value);
 int ngli_pipeline_update_texture(struct pipeline *s, int index, struct texture *texture);
+
+/* Change the offset at which an attribute is read in its buffer */
+int ngli_pipeline_update_attribute(struct pipeline *s, int index, int offset);
 void ngli_pipeline_exec(struct pipeline *s);
 void ngli_pipeline_reset(struct pipeline *s);
 
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "glcontext.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "profiler.h"
+#include "utils.h"
+
+static const char * const phase_names[NGLI_PROFILER_NB] = {
+    [NGLI_PROFILER_VISIT]    = "visit",
+    [NGLI_PROFILER_PREFETCH] = "prefetch",
+    [NGLI_PROFILER_UPDATE]   = "update",
+    [NGLI_PROFILER_DRAW]     = "draw",
+    [NGLI_PROFILER_GPU]      = "gpu",
+};
+
+int ngli_profiler_start(struct profiler *s, struct glcontext *gl)
+{
+    ngli_profiler_reset(s);
+
+    ngli_darray_init(&s->events, sizeof(struct profiler_event), 0);
+    ngli_darray_init(&s->gpu_scopes, sizeof(struct profiler_gpu_scope), 0);
+    ngli_darray_init(&s->free_queries, sizeof(GLuint), 0);
+
+    if (gl && (gl->features & NGLI_FEATURE_TIMER_QUERY)) {
+        s->glGenQueries          = ngli_glGenQueries;
+        s->glDeleteQueries       = ngli_glDeleteQueries;
+        s->glQueryCounter        = ngli_glQueryCounter;
+        s->glGetQueryObjectui64v = ngli_glGetQueryObjectui64v;
+        s->gl = gl;
+    } else if (gl && (gl->features & NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY)) {
+        s->glGenQueries          = ngli_glGenQueriesEXT;
+        s->glDeleteQueries       = ngli_glDeleteQueriesEXT;
+        s->glQueryCounter        = ngli_glQueryCounterEXT;
+        s->glGetQueryObjectui64v = ngli_glGetQueryObjectui64vEXT;
+        s->gl = gl;
+    } else {
+        LOG(WARNING, "timer queries are not supported, GPU timings will not be profiled");
+    }
+
+    s->cpu_ref = ngli_gettime();
+
+    /*
+     * Pair a GPU timestamp with the CPU clock so the GPU events can be
+     * placed on the same timeline. This is the only time the profiler waits
+     * for the GPU outside of ngli_profiler_stop().
+     */
+    if (s->gl) {
+        GLuint query;
+        GLuint64 gpu_ref = 0;
+        s->glGenQueries(gl, 1, &query);
+        s->glQueryCounter(gl, query, GL_TIMESTAMP);
+        s->cpu_ref = ngli_gettime();
+        s->glGetQueryObjectui64v(gl, query, GL_QUERY_RESULT, &gpu_ref);
+        s->glDeleteQueries(gl, 1, &query);
+        s->gpu_ref = gpu_ref;
+    }
+
+    s->active = 1;
+    return 0;
+}
+
+static struct profiler_event *add_event(struct profiler *s, int phase, const void *id,
+                                        const char *label, const char *type)
+{
+    struct profiler_event *event = ngli_darray_push(&s->events, NULL);
+    if (!event) {
+        s->error = NGL_ERROR_MEMORY;
+        s->active = 0;
+        return NULL;
+    }
+    event->id = id;
+    snprintf(event->label, sizeof(event->label), "%s", label ? label : "");
+    event->type = type;
+    event->phase = phase;
+    return event;
+}
+
+void ngli_profiler_add(struct profiler *s, int phase, const void *id, const char *label,
+                       const char *type, int64_t ts, int64_t dur)
+{
+    struct profiler_event *event = add_event(s, phase, id, label, type);
+    if (!event)
+        return;
+    event->ts = ts;
+    event->dur = dur;
+}
+
+static GLuint get_query(struct profiler *s)
+{
+    GLuint *query = ngli_darray_pop(&s->free_queries);
+    if (query)
+        return *query;
+    GLuint id = 0;
+    s->glGenQueries(s->gl, 1, &id);
+    return id;
+}
+
+int ngli_profiler_gpu_begin(struct profiler *s, const void *id, const char *label, const char *type)
+{
+    if (!s->gl)
+        return -1;
+
+    struct profiler_event *event = add_event(s, NGLI_PROFILER_GPU, id, label, type);
+    if (!event)
+        return -1;
+    event->ts = 0;
+    event->dur = -1;
+
+    struct profiler_gpu_scope scope = {
+        .queries = {get_query(s), get_query(s)},
+        .event = ngli_darray_count(&s->events) - 1,
+    };
+    if (!ngli_darray_push(&s->gpu_scopes, &scope)) {
+        s->glDeleteQueries(s->gl, 2, scope.queries);
+        s->error = NGL_ERROR_MEMORY;
+        s->active = 0;
+        return -1;
+    }
+
+    s->glQueryCounter(s->gl, scope.queries[0], GL_TIMESTAMP);
+    return ngli_darray_count(&s->gpu_scopes) - 1;
+}
+
+void ngli_profiler_gpu_end(struct profiler *s, int id)
+{
+    if (id < 0)
+        return;
+    const struct profiler_gpu_scope *scope = ngli_darray_get(&s->gpu_scopes, id);
+    s->glQueryCounter(s->gl, scope->queries[1], GL_TIMESTAMP);
+}
+
+void ngli_profiler_collect(struct profiler *s, int wait)
+{
+    if (!s->gl)
+        return;
+
+    struct profiler_gpu_scope *scopes = ngli_darray_data(&s->gpu_scopes);
+    const int nb_scopes = ngli_darray_count(&s->gpu_scopes);
+
+    /*
+     * The scopes are stored in submission order, so the first one with a
+     * result not yet available stops the read back
+     */
+    int nb_collected;
+    for (nb_collected = 0; nb_collected < nb_scopes; nb_collected++) {
+        struct profiler_gpu_scope *scope = &scopes[nb_collected];
+
+        if (!wait) {
+            GLuint64 available = 0;
+            s->glGetQueryObjectui64v(s->gl, scope->queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+        }
+
+        GLuint64 start = 0, end = 0;
+        s->glGetQueryObjectui64v(s->gl, scope->queries[0], GL_QUERY_RESULT, &start);
+        s->glGetQueryObjectui64v(s->gl, scope->queries[1], GL_QUERY_RESULT, &end);
+
+        struct profiler_event *event = ngli_darray_get(&s->events, scope->event);
+        event->ts = s->cpu_ref + ((int64_t)start - s->gpu_ref) / 1000;
+        event->dur = (end - start) / 1000;
+
+        for (int i = 0; i < 2; i++) {
+            if (!ngli_darray_push(&s->free_queries, &scope->queries[i]))
+                s->glDeleteQueries(s->gl, 1, &scope->queries[i]);
+        }
+    }
+
+    memmove(scopes, scopes + nb_collected, (nb_scopes - nb_collected) * sizeof(*scopes));
+    s->gpu_scopes.count -= nb_collected;
+}
+
+static void print_json_string(struct bstr *b, const char *str)
+{
+    ngli_bstr_print(b, "\"");
+    for (const char *p = str; *p; p++) {
+        const unsigned char c = *p;
+        if (c == '"' || c == '\\')
+            ngli_bstr_print(b, "\\%c", c);
+        else if (c < 0x20)
+            ngli_bstr_print(b, "\\u%04x", c);
+        else
+            ngli_bstr_print(b, "%c", c);
+    }
+    ngli_bstr_print(b, "\"");
+}
+
+int ngli_profiler_stop(struct profiler *s, char **tracep)
+{
+    *tracep = NULL;
+
+    if (!s->active && !s->error) {
+        LOG(ERROR, "no profile is being recorded");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (s->error) {
+        int ret = s->error;
+        LOG(ERROR, "the profile could not be recorded: %s", NGLI_RET_STR(ret));
+        ngli_profiler_reset(s);
+        return ret;
+    }
+
+    ngli_profiler_collect(s, 1);
+
+    struct bstr *b = ngli_bstr_create();
+    if (!b) {
+        ngli_profiler_reset(s);
+        return NGL_ERROR_MEMORY;
+    }
+
+    /* The CPU and GPU events are displayed as two separate threads */
+    ngli_bstr_print(b, "{\"traceEvents\":[\n"
+                       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+                       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    const struct profiler_event *events = ngli_darray_data(&s->events);
+    for (int i = 0; i < ngli_darray_count(&s->events); i++) {
+        const struct profiler_event *event = &events[i];
+        if (event->dur < 0)
+            continue;
+        ngli_bstr_print(b, ",\n{\"name\":");
+        print_json_string(b, event->label);
+        ngli_bstr_print(b, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRId64 ",\"dur\":%" PRId64
+                        ",\"pid\":1,\"tid\":%d,\"args\":{\"type\":\"%s\"}}",
+                        phase_names[event->phase], event->ts - s->cpu_ref, event->dur,
+                        event->phase == NGLI_PROFILER_GPU ? 2 : 1, event->type ? event->type : "");
+    }
+    ngli_bstr_print(b, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    *tracep = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    ngli_profiler_reset(s);
+    return *tracep ? 0 : NGL_ERROR_MEMORY;
+}
+
+void ngli_profiler_reset(struct profiler *s)
+{
+    if (s->gl) {
+        struct profiler_gpu_scope *scopes = ngli_darray_data(&s->gpu_scopes);
+        for (int i = 0; i < ngli_darray_count(&s->gpu_scopes); i++)
+            s->glDeleteQueries(s->gl, 2, scopes[i].queries);
+        const GLuint *queries = ngli_darray_data(&s->free_queries);
+        const int nb_queries = ngli_darray_count(&s->free_queries);
+        if (nb_queries)
+            s->glDeleteQueries(s->gl, nb_queries, queries);
+    }
+    ngli_darray_reset(&s->gpu_scopes);
+    ngli_darray_reset(&s->free_queries);
+    ngli_darray_reset(&s->events);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+#include "darray.h"
+#include "glcontext.h"
+
+enum {
+    NGLI_PROFILER_VISIT,
+    NGLI_PROFILER_PREFETCH,
+    NGLI_PROFILER_UPDATE,
+    NGLI_PROFILER_DRAW,
+    NGLI_PROFILER_GPU,
+    NGLI_PROFILER_NB
+};
+
+#define NGLI_PROFILER_LABEL_LEN 64
+
+struct profiler_event {
+    const void *id; // object timed, typically a node
+    char label[NGLI_PROFILER_LABEL_LEN];
+    const char *type;
+    int phase;
+    int64_t ts;  // microseconds
+    int64_t dur; // microseconds, negative while a GPU result is pending
+};
+
+struct profiler_gpu_scope {
+    GLuint queries[2];
+    int event;
+};
+
+/*
+ * Record of the time spent in each node of the graph, on the CPU for every
+ * node operation and on the GPU for the scopes explicitly timed with
+ * ngli_profiler_gpu_begin() and ngli_profiler_gpu_end().
+ *
+ * The GPU timings rely on timestamp queries which are read back without
+ * blocking in ngli_profiler_collect(), typically once per frame, so a GPU
+ * event only gets its duration a few frames after being recorded.
+ */
+struct profiler {
+    int active;
+    int error;
+    int nb_frames;
+    struct glcontext *gl;
+    struct darray events;
+    struct darray gpu_scopes;
+    struct darray free_queries;
+    int64_t cpu_ref;
+    int64_t gpu_ref;
+    void (*glGenQueries)(const struct glcontext *gl, GLsizei n, GLuint * ids);
+    void (*glDeleteQueries)(const struct glcontext *gl, GLsizei n, const GLuint * ids);
+    void (*glQueryCounter)(const struct glcontext *gl, GLuint id, GLenum target);
+    void (*glGetQueryObjectui64v)(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 *params);
+};
+
+int ngli_profiler_start(struct profiler *s, struct glcontext *gl);
+
+void ngli_profiler_add(struct profiler *s, int phase, const void *id, const char *label,
+                       const char *type, int64_t ts, int64_t dur);
+
+/*
+ * Return an identifier to pass to ngli_profiler_gpu_end(), or -1 if the GPU
+ * scope can not be timed. The identifiers are only valid until the next call
+ * to ngli_profiler_collect().
+ */
+int ngli_profiler_gpu_begin(struct profiler *s, const void *id, const char *label, const char *type);
+void ngli_profiler_gpu_end(struct profiler *s, int id);
+
+/*
+ * Read back the results of the GPU scopes the GPU is done with, or of all
+ * of them (waiting for the GPU) if wait is set.
+ */
+void ngli_profiler_collect(struct profiler *s, int wait);
+
+/*
+ * Stop the recording and serialize the events in the Chrome trace event
+ * format. The returned string must be freed with ngli_free().
+ */
+int ngli_profiler_stop(struct profiler *s, char **tracep);
+
+void ngli_profiler_reset(struct profiler *s);
+
+#endif
@@ -19,6 +19,8 @@
  * under the License.
  */
 
+#include <ctype.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -27,7 +29,34 @@
 #include "memory.h"
 #include "nodes.h"
 #include "program.h"
+#include "sharegroup.h"
+#include "tracemarker.h"
 #include "type.h"
+#include "utils.h"
+
+struct program_shared {
+    char *key;
+    int refcount;
+    struct program program;
+    struct uniformpack uniform_pack;
+
+    /* Build state, until the result of the compilation and link is known */
+    int pending;
+    int built;
+    int error;
+    GLuint shaders[NGLI_PROGRAM_SHADER_NB];
+    char *binary_path;
+    int share_binary;
+};
+
+#define BINARY_MAGIC "NGLP"
+
+struct binary_header {
+    char magic[4];
+    uint32_t format;
+    uint32_t key_size;
+    uint32_t binary_size;
+};
 
 static int program_check_status(const struct glcontext *gl, GLuint id, GLenum status)
 {
@@ -112,6 +141,21 @@ static int get_type(GLenum gl_type)
     return NGLI_TYPE_NONE;
 }
 
+static int get_cache_elem_size(int type)
+{
+    switch (type) {
+        case NGLI_TYPE_SAMPLER_2D:
+        case NGLI_TYPE_SAMPLER_2D_RECT:
+        case NGLI_TYPE_SAMPLER_3D:
+        case NGLI_TYPE_SAMPLER_CUBE:
+        case NGLI_TYPE_SAMPLER_EXTERNAL_OES:
+        case NGLI_TYPE_SAMPLER_EXTERNAL_2D_Y2Y_EXT:
+            /* Bindless handle and texture unit (see set_textures()) */
+            return 2 * sizeof(uint64_t);
+    }
+    return ngli_type_get_size(type);
+}
+
 static struct hmap *program_probe_uniforms(struct glcontext *gl, GLuint pid)
 {
     struct hmap *umap = ngli_hmap_create();
@@ -123,21 +167,34 @@ static struct hmap *program_probe_uniforms(struct glcontext *gl, GLuint pid)
     ngli_glGetProgramiv(gl, pid, GL_ACTIVE_UNIFORMS, &nb_active_uniforms);
     for (int i = 0; i < nb_active_uniforms; i++) {
         char name[MAX_ID_LEN];
-        struct uniformprograminfo *info = ngli_malloc(sizeof(*info));
+        GLint size;
+        GLenum gl_type;
+        ngli_glGetActiveUniform(gl, pid, i, sizeof(name), NULL,
+                                &size, &gl_type, name);
+
+        const int type = get_type(gl_type);
+        if (type == NGLI_TYPE_NONE) {
+            LOG(WARNING, "unrecognized uniform type 0x%x, ignore", gl_type);
+            continue;
+        }
+
+        /*
+         * The shadow copy of the uniform value is allocated along with the
+         * info. Uniforms are initialized to 0 when the program is linked, so
+         * a zeroed cache reflects the initial state of the program.
+         */
+        const int cache_size = get_cache_elem_size(type) * size;
+        struct uniformprograminfo *info = ngli_calloc(1, sizeof(*info) + cache_size);
         if (!info) {
             ngli_hmap_freep(&umap);
             return NULL;
         }
-
-        GLenum type;
-        ngli_glGetActiveUniform(gl, pid, i, sizeof(name), NULL,
-                                &info->size, &type, name);
-
-        info->type = get_type(type);
-        if (info->type == NGLI_TYPE_NONE) {
-            LOG(WARNING, "unrecognized uniform type 0x%x, ignore", type);
-            ngli_free(info);
-            continue;
+        info->size = size;
+        info->type = type;
+        info->block_offset = -1;
+        if (cache_size) {
+            info->cache = (uint8_t *)(info + 1);
+            info->cache_size = cache_size;
         }
 
         /* Remove [0] suffix from names of uniform arrays */
@@ -279,75 +336,571 @@ static struct hmap *program_probe_buffer_blocks(struct glcontext *gl, GLuint pid
     return bmap;
 }
 
-int ngli_program_init(struct program *s, struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute)
+/*
+ * Compile and link the program without querying any status: the driver is
+ * then free to do the work in the background (or lazily) until the result
+ * is requested by program_finalize().
+ */
+static void program_submit(struct program_shared *shared, const char *vertex, const char *fragment, const char *compute)
 {
-    int ret = 0;
-    struct {
-        GLenum type;
-        const char *src;
-        GLuint id;
-    } shaders[] = {
-        [NGLI_PROGRAM_SHADER_VERT] = {GL_VERTEX_SHADER,   vertex,   0},
-        [NGLI_PROGRAM_SHADER_FRAG] = {GL_FRAGMENT_SHADER, fragment, 0},
-        [NGLI_PROGRAM_SHADER_COMP] = {GL_COMPUTE_SHADER,  compute,  0},
+    static const GLenum types[] = {
+        [NGLI_PROGRAM_SHADER_VERT] = GL_VERTEX_SHADER,
+        [NGLI_PROGRAM_SHADER_FRAG] = GL_FRAGMENT_SHADER,
+        [NGLI_PROGRAM_SHADER_COMP] = GL_COMPUTE_SHADER,
+    };
+    const char *srcs[] = {
+        [NGLI_PROGRAM_SHADER_VERT] = vertex,
+        [NGLI_PROGRAM_SHADER_FRAG] = fragment,
+        [NGLI_PROGRAM_SHADER_COMP] = compute,
     };
 
+    struct program *s = &shared->program;
+    struct ngl_ctx *ctx = s->ctx;
     struct glcontext *gl = ctx->glcontext;
 
-    if (compute && !(gl->features & NGLI_FEATURE_COMPUTE_SHADER_ALL)) {
-        LOG(ERROR, "context does not support compute shaders");
-        return NGL_ERROR_UNSUPPORTED;
-    }
-
-    s->ctx = ctx;
-    s->id = ngli_glCreateProgram(gl);
-
-    for (int i = 0; i < NGLI_ARRAY_NB(shaders); i++) {
-        if (!shaders[i].src)
+    NGLI_TRACEMARKER_BEGIN(submit, "ngl program compile");
+    for (int i = 0; i < NGLI_ARRAY_NB(srcs); i++) {
+        if (!srcs[i])
             continue;
-        GLuint shader = ngli_glCreateShader(gl, shaders[i].type);
-        shaders[i].id = shader;
-        ngli_glShaderSource(gl, shader, 1, &shaders[i].src, NULL);
+        GLuint shader = ngli_glCreateShader(gl, types[i]);
+        shared->shaders[i] = shader;
+        ngli_glShaderSource(gl, shader, 1, &srcs[i], NULL);
         ngli_glCompileShader(gl, shader);
-        ret = program_check_status(gl, shader, GL_COMPILE_STATUS);
-        if (ret < 0)
-            goto fail;
         ngli_glAttachShader(gl, s->id, shader);
     }
 
+    if ((ctx->program_cache_dir || ctx->share_group) && (gl->features & NGLI_FEATURE_PROGRAM_BINARY))
+        ngli_glProgramParameteri(gl, s->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     ngli_glLinkProgram(gl, s->id);
-    ret = program_check_status(gl, s->id, GL_LINK_STATUS);
-    if (ret < 0)
-        goto fail;
+    shared->built = 1;
+    NGLI_TRACEMARKER_END(submit);
+}
+
+static char *get_binary_path(const struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute)
+{
+    return ngli_asprintf("%s/%08x%08x%08x.bin", ctx->program_cache_dir,
+                         vertex   ? ngli_crc32(vertex)   : 0,
+                         fragment ? ngli_crc32(fragment) : 0,
+                         compute  ? ngli_crc32(compute)  : 0);
+}
+
+/* The binary is rejected if the driver changed since it was retrieved */
+static int program_set_binary(struct program *s, uint32_t format, const void *data, int size)
+{
+    struct glcontext *gl = s->ctx->glcontext;
+
+    ngli_glProgramBinary(gl, s->id, format, data, size);
+
+    GLint status = GL_FALSE;
+    ngli_glGetProgramiv(gl, s->id, GL_LINK_STATUS, &status);
+    return status == GL_TRUE;
+}
+
+static int program_load_shared_binary(struct program *s, const char *key)
+{
+    uint32_t format;
+    int size;
+    uint8_t *binary = ngli_share_group_get_program_binary(s->ctx->share_group, key, &format, &size);
+    if (!binary)
+        return 0;
+
+    const int ret = program_set_binary(s, format, binary, size);
+    ngli_free(binary);
+    return ret;
+}
 
-    for (int i = 0; i < NGLI_ARRAY_NB(shaders); i++)
-        ngli_glDeleteShader(gl, shaders[i].id);
+static int program_load_binary(struct program *s, const char *path, const char *key)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+
+    int ret = 0;
+    char *data = NULL;
+    const uint32_t key_size = strlen(key);
+    struct binary_header header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) ||
+        header.key_size != key_size || !header.binary_size)
+        goto end;
+
+    data = ngli_malloc(key_size + header.binary_size);
+    if (!data)
+        goto end;
+    if (fread(data, key_size + header.binary_size, 1, fp) != 1 ||
+        memcmp(data, key, key_size))
+        goto end;
+
+    ret = program_set_binary(s, header.format, data + key_size, header.binary_size);
+
+    /* Spare the compilation to the rest of the share group as well */
+    if (ret && s->ctx->share_group)
+        ngli_share_group_add_program_binary(s->ctx->share_group, key, header.format,
+                                            (const uint8_t *)data + key_size, header.binary_size);
+
+end:
+    ngli_free(data);
+    fclose(fp);
+    return ret;
+}
+
+static char *program_get_binary(struct program *s, GLenum *format, GLint *size)
+{
+    struct glcontext *gl = s->ctx->glcontext;
+
+    GLint binary_size = 0;
+    ngli_glGetProgramiv(gl, s->id, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+    if (binary_size <= 0)
+        return NULL;
+
+    char *binary = ngli_malloc(binary_size);
+    if (!binary)
+        return NULL;
+
+    *format = 0;
+    ngli_glGetProgramBinary(gl, s->id, binary_size, &binary_size, format, binary);
+    *size = binary_size;
+    return binary;
+}
+
+static void program_save_binary(const char *path, const char *key,
+                                GLenum format, const char *binary, GLint binary_size)
+{
+    char *tmp_path = ngli_asprintf("%s.tmp", path);
+    if (!tmp_path)
+        return;
+
+    const uint32_t key_size = strlen(key);
+    struct binary_header header = {
+        .magic       = BINARY_MAGIC,
+        .format      = format,
+        .key_size    = key_size,
+        .binary_size = binary_size,
+    };
+
+    /* Written in a temporary file first so that concurrent instances never
+     * read a partially written binary */
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        LOG(WARNING, "could not open %s to store the program binary", tmp_path);
+        goto end;
+    }
+    const int written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                        fwrite(key, key_size, 1, fp) == 1 &&
+                        fwrite(binary, binary_size, 1, fp) == 1;
+    if (fclose(fp) || !written || rename(tmp_path, path)) {
+        LOG(WARNING, "could not store program binary to %s", path);
+        remove(tmp_path);
+    }
+
+end:
+    ngli_free(tmp_path);
+}
+
+/*
+ * The packed uniforms are uploaded with the block instead of glUniform*(),
+ * so they are not tracked by the uniform cache.
+ */
+static void program_bind_uniform_pack(struct program *s)
+{
+    const struct uniformpack *pack = s->uniform_pack;
+    if (!pack)
+        return;
+
+    const struct blockprograminfo *block = ngli_hmap_get(s->buffer_blocks, NGLI_UNIFORMPACK_BLOCK_NAME);
+    if (!block) {
+        s->uniform_pack = NULL;
+        return;
+    }
+    s->uniform_block_binding = block->binding;
+
+    for (int i = 0; i < pack->nb_members; i++) {
+        const struct uniformpack_member *member = &pack->members[i];
+        struct uniformprograminfo *info = ngli_hmap_get(s->uniforms, member->name);
+        if (!info)
+            continue;
+        info->block_offset = member->offset;
+        info->cache = NULL;
+        info->cache_size = 0;
+    }
+}
+
+static int program_finalize(struct program_shared *shared)
+{
+    struct program *s = &shared->program;
+    struct glcontext *gl = s->ctx->glcontext;
+
+    NGLI_TRACEMARKER_BEGIN(finalize, "ngl program finalize");
+    int ret = 0;
+    if (shared->built) {
+        for (int i = 0; i < NGLI_ARRAY_NB(shared->shaders); i++) {
+            if (!shared->shaders[i])
+                continue;
+            ret = program_check_status(gl, shared->shaders[i], GL_COMPILE_STATUS);
+            if (ret < 0)
+                goto end;
+        }
+        ret = program_check_status(gl, s->id, GL_LINK_STATUS);
+        if (ret < 0)
+            goto end;
+        if (shared->binary_path || shared->share_binary) {
+            GLenum format;
+            GLint binary_size;
+            char *binary = program_get_binary(s, &format, &binary_size);
+            if (binary && shared->binary_path)
+                program_save_binary(shared->binary_path, shared->key, format, binary, binary_size);
+            if (binary && shared->share_binary)
+                ngli_share_group_add_program_binary(s->ctx->share_group, shared->key,
+                                                    format, (const uint8_t *)binary, binary_size);
+            ngli_free(binary);
+        }
+    }
 
     s->uniforms = program_probe_uniforms(gl, s->id);
     s->attributes = program_probe_attributes(gl, s->id);
     s->buffer_blocks = program_probe_buffer_blocks(gl, s->id);
-    if (!s->uniforms || !s->attributes || !s->buffer_blocks) {
+    s->texture_layouts = ngli_hmap_create();
+    if (s->texture_layouts)
+        ngli_hmap_set_free(s->texture_layouts, free_pinfo, NULL);
+    if (!s->uniforms || !s->attributes || !s->buffer_blocks || !s->texture_layouts)
         ret = NGL_ERROR_MEMORY;
-        goto fail;
+    else
+        program_bind_uniform_pack(s);
+
+end:
+    for (int i = 0; i < NGLI_ARRAY_NB(shared->shaders); i++) {
+        ngli_glDeleteShader(gl, shared->shaders[i]);
+        shared->shaders[i] = 0;
     }
+    ngli_free(shared->binary_path);
+    shared->binary_path = NULL;
+    shared->pending = 0;
+    shared->error = NGLI_MIN(ret, 0);
+    NGLI_TRACEMARKER_END(finalize);
+    return shared->error;
+}
+
+static int program_is_complete(const struct program_shared *shared)
+{
+    if (!shared->pending)
+        return 1;
+
+    const struct program *s = &shared->program;
+    struct glcontext *gl = s->ctx->glcontext;
+    if (!(gl->features & NGLI_FEATURE_PARALLEL_SHADER_COMPILE))
+        return 1;
 
+    GLint status = GL_FALSE;
+    ngli_glGetProgramiv(gl, s->id, GL_COMPLETION_STATUS_KHR, &status);
+    return status == GL_TRUE;
+}
+
+static int program_create(struct program_shared *shared, const char *vertex, const char *fragment, const char *compute, int async)
+{
+    struct program *s = &shared->program;
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    s->id = ngli_glCreateProgram(gl);
+    shared->pending = 1;
+
+    char *binary_path = NULL;
+    if (ctx->program_cache_dir && (gl->features & NGLI_FEATURE_PROGRAM_BINARY)) {
+        binary_path = get_binary_path(ctx, vertex, fragment, compute);
+        if (!binary_path)
+            return NGL_ERROR_MEMORY;
+    }
+
+    const int share_binary = ctx->share_group && (gl->features & NGLI_FEATURE_PROGRAM_BINARY);
+    if (share_binary && program_load_shared_binary(s, shared->key)) {
+        LOG(DEBUG, "program loaded from the share group");
+        ngli_free(binary_path);
+    } else if (binary_path && program_load_binary(s, binary_path, shared->key)) {
+        LOG(DEBUG, "program loaded from %s", binary_path);
+        ngli_free(binary_path);
+    } else {
+        if (binary_path || share_binary) {
+            /* A program can not be built from source once a binary has
+             * been specified, even a rejected one */
+            ngli_glDeleteProgram(gl, s->id);
+            s->id = ngli_glCreateProgram(gl);
+        }
+        program_submit(shared, vertex, fragment, compute);
+        shared->binary_path = binary_path;
+        shared->share_binary = share_binary;
+    }
+
+    return async ? 0 : program_finalize(shared);
+}
+
+static void program_destroy(struct program_shared *shared)
+{
+    struct program *s = &shared->program;
+    ngli_hmap_freep(&s->uniforms);
+    ngli_hmap_freep(&s->attributes);
+    ngli_hmap_freep(&s->buffer_blocks);
+    ngli_hmap_freep(&s->texture_layouts);
+    struct glcontext *gl = s->ctx->glcontext;
+    for (int i = 0; i < NGLI_ARRAY_NB(shared->shaders); i++)
+        ngli_glDeleteShader(gl, shared->shaders[i]);
+    ngli_free(shared->binary_path);
+    ngli_glstate_forget_program(gl, s->id);
+    ngli_glDeleteProgram(gl, s->id);
+    ngli_uniformpack_reset(&shared->uniform_pack);
+}
+
+static char *get_shared_key(const char *vertex, const char *fragment, const char *compute)
+{
+    vertex   = vertex   ? vertex   : "";
+    fragment = fragment ? fragment : "";
+    compute  = compute  ? compute  : "";
+    return ngli_asprintf("%zu:%zu:%zu:%s%s%s",
+                         strlen(vertex), strlen(fragment), strlen(compute),
+                         vertex, fragment, compute);
+}
+
+static int program_init_shared(struct program *s, struct ngl_ctx *ctx,
+                               const char *vertex, const char *fragment, const char *compute,
+                               struct uniformpack *uniform_pack, int bindless_samplers, int async)
+{
+    char *key = get_shared_key(vertex, fragment, compute);
+    if (!key)
+        return NGL_ERROR_MEMORY;
+
+    if (!ctx->program_cache) {
+        ctx->program_cache = ngli_hmap_create();
+        if (!ctx->program_cache) {
+            ngli_free(key);
+            return NGL_ERROR_MEMORY;
+        }
+    }
+
+    struct program_shared *shared = ngli_hmap_get(ctx->program_cache, key);
+    if (shared) {
+        ngli_free(key);
+        if (shared->pending && !async)
+            program_finalize(shared);
+        if (shared->error)
+            return shared->error;
+        shared->refcount++;
+        *s = shared->program;
+        s->shared = shared;
+        return 0;
+    }
+
+    shared = ngli_calloc(1, sizeof(*shared));
+    if (!shared) {
+        ngli_free(key);
+        return NGL_ERROR_MEMORY;
+    }
+    shared->key = key;
+    shared->refcount = 1;
+    shared->uniform_pack = *uniform_pack;
+    memset(uniform_pack, 0, sizeof(*uniform_pack));
+
+    struct program *program = &shared->program;
+    program->ctx = ctx;
+    if (shared->uniform_pack.nb_members)
+        program->uniform_pack = &shared->uniform_pack;
+    program->bindless_samplers = bindless_samplers;
+    int ret = program_create(shared, vertex, fragment, compute, async);
+    if (ret < 0)
+        goto fail;
+
+    ret = ngli_hmap_set(ctx->program_cache, key, shared);
+    if (ret < 0)
+        goto fail;
+
+    *s = *program;
+    s->shared = shared;
     return 0;
 
 fail:
-    for (int i = 0; i < NGLI_ARRAY_NB(shaders); i++)
-        ngli_glDeleteShader(gl, shaders[i].id);
+    program_destroy(shared);
+    ngli_free(shared->key);
+    ngli_free(shared);
+    if (!ngli_hmap_count(ctx->program_cache))
+        ngli_hmap_freep(&ctx->program_cache);
+    return ret;
+}
+
+/*
+ * The bindless samplers require GLSL 4.00, and the extension directive must
+ * come before any declaration, right after the #version and #extension ones
+ */
+static const char *get_bindless_insert_point(const char *src)
+{
+    const char *p = strstr(src, "#version");
+    if (!p)
+        return NULL;
+    p += strlen("#version");
+    while (isspace(*p))
+        p++;
+    const int version = atoi(p);
+    while (isdigit(*p))
+        p++;
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if (version < 400 || !strncmp(p, "es", 2))
+        return NULL;
+
+    p = src;
+    for (;;) {
+        while (isspace(*p))
+            p++;
+        if (strncmp(p, "#version", 8) && strncmp(p, "#extension", 10))
+            return p;
+        const char *eol = strchr(p, '\n');
+        if (!eol)
+            return p + strlen(p);
+        p = eol + 1;
+    }
+}
 
+/*
+ * Declare all the samplers of the shaders as bindless, so they can be set
+ * with either a texture unit or a texture handle. Return 1 if the shaders
+ * were rewritten into dsts, 0 if they are not all eligible.
+ */
+static int enable_bindless_samplers(const char * const *srcs, char **dsts)
+{
+    const char *insert_points[NGLI_PROGRAM_SHADER_NB] = {NULL};
+    for (int i = 0; i < NGLI_PROGRAM_SHADER_NB; i++) {
+        if (!srcs[i])
+            continue;
+        insert_points[i] = get_bindless_insert_point(srcs[i]);
+        if (!insert_points[i])
+            return 0;
+    }
+
+    for (int i = 0; i < NGLI_PROGRAM_SHADER_NB; i++) {
+        if (!srcs[i])
+            continue;
+        const char *insert = insert_points[i];
+        dsts[i] = ngli_asprintf("%.*s"
+                                "#extension GL_ARB_bindless_texture : require\n"
+                                "layout(bindless_sampler) uniform;\n"
+                                "%s", (int)(insert - srcs[i]), srcs[i], insert);
+        if (!dsts[i])
+            return NGL_ERROR_MEMORY;
+    }
+    return 1;
+}
+
+static int program_init(struct program *s, struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute,
+                        struct uniformpack_constant *constants, int nb_constants, int async)
+{
+    struct glcontext *gl = ctx->glcontext;
+
+    if (compute && !(gl->features & NGLI_FEATURE_COMPUTE_SHADER_ALL)) {
+        LOG(ERROR, "context does not support compute shaders");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    const char *srcs[] = {
+        [NGLI_PROGRAM_SHADER_VERT] = vertex,
+        [NGLI_PROGRAM_SHADER_FRAG] = fragment,
+        [NGLI_PROGRAM_SHADER_COMP] = compute,
+    };
+    char *specialized[NGLI_PROGRAM_SHADER_NB] = {NULL};
+    char *bindless[NGLI_PROGRAM_SHADER_NB] = {NULL};
+    char *packed[NGLI_PROGRAM_SHADER_NB] = {NULL};
+    struct uniformpack uniform_pack = {0};
+    int bindless_samplers = 0;
+    int ret = 0;
+
+    if (nb_constants) {
+        ret = ngli_uniformpack_specialize(srcs, specialized, NGLI_ARRAY_NB(srcs), constants, nb_constants);
+        if (ret < 0)
+            goto end;
+        for (int i = 0; i < NGLI_ARRAY_NB(srcs); i++)
+            srcs[i] = specialized[i] ? specialized[i] : srcs[i];
+    }
+
+    if (ctx->config.bindless_textures && (gl->features & NGLI_FEATURE_BINDLESS_TEXTURE)) {
+        ret = enable_bindless_samplers(srcs, bindless);
+        if (ret < 0)
+            goto end;
+        bindless_samplers = ret;
+        for (int i = 0; i < NGLI_ARRAY_NB(srcs); i++)
+            srcs[i] = bindless[i] ? bindless[i] : srcs[i];
+    }
+
+    if (ctx->config.pack_uniforms) {
+        ret = ngli_uniformpack_init(&uniform_pack, gl, srcs, packed, NGLI_ARRAY_NB(srcs));
+        if (ret < 0)
+            goto end;
+        for (int i = 0; i < NGLI_ARRAY_NB(srcs); i++)
+            srcs[i] = packed[i] ? packed[i] : srcs[i];
+    }
+
+    ret = program_init_shared(s, ctx,
+                              srcs[NGLI_PROGRAM_SHADER_VERT],
+                              srcs[NGLI_PROGRAM_SHADER_FRAG],
+                              srcs[NGLI_PROGRAM_SHADER_COMP],
+                              &uniform_pack, bindless_samplers, async);
+
+end:
+    ngli_uniformpack_reset(&uniform_pack);
+    for (int i = 0; i < NGLI_ARRAY_NB(srcs); i++) {
+        ngli_free(specialized[i]);
+        ngli_free(bindless[i]);
+        ngli_free(packed[i]);
+    }
     return ret;
 }
 
+int ngli_program_init(struct program *s, struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute)
+{
+    return program_init(s, ctx, vertex, fragment, compute, NULL, 0, 0);
+}
+
+int ngli_program_submit(struct program *s, struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute)
+{
+    return program_init(s, ctx, vertex, fragment, compute, NULL, 0, ctx->config.async_programs);
+}
+
+int ngli_program_submit_specialized(struct program *s, struct ngl_ctx *ctx,
+                                    const char *vertex, const char *fragment, const char *compute,
+                                    struct uniformpack_constant *constants, int nb_constants)
+{
+    return program_init(s, ctx, vertex, fragment, compute, constants, nb_constants, ctx->config.async_programs);
+}
+
+int ngli_program_poll(struct program *s)
+{
+    struct program_shared *shared = s->shared;
+    if (shared->pending) {
+        if (!program_is_complete(shared))
+            return 0;
+        program_finalize(shared);
+    }
+    if (shared->error)
+        return shared->error;
+
+    /* Pick up the probed information, missing from the copy made while the
+     * program was still pending */
+    *s = shared->program;
+    s->shared = shared;
+    return 1;
+}
+
 void ngli_program_reset(struct program *s)
 {
     if (!s->ctx)
         return;
-    ngli_hmap_freep(&s->uniforms);
-    ngli_hmap_freep(&s->attributes);
-    ngli_hmap_freep(&s->buffer_blocks);
-    struct glcontext *gl = s->ctx->glcontext;
-    ngli_glDeleteProgram(gl, s->id);
+
+    struct ngl_ctx *ctx = s->ctx;
+    struct program_shared *shared = s->shared;
     memset(s, 0, sizeof(*s));
+    if (--shared->refcount)
+        return;
+
+    program_destroy(shared);
+    ngli_hmap_set(ctx->program_cache, shared->key, NULL);
+    ngli_free(shared->key);
+    ngli_free(shared);
+    if (!ngli_hmap_count(ctx->program_cache))
+        ngli_hmap_freep(&ctx->program_cache);
 }
@@ -22,8 +22,11 @@
 #ifndef PROGRAM_H
 #define PROGRAM_H
 
+#include <stdint.h>
+
 #include "glincludes.h"
 #include "hmap.h"
+#include "uniformpack.h"
 
 #define MAX_ID_LEN 128
 
@@ -32,6 +35,9 @@ struct uniformprograminfo {
     GLint size;
     int type;
     int binding;
+    int block_offset;   // offset in the packed uniform block, -1 if not packed
+    uint8_t *cache;     // last value uploaded to the program, NULL if not tracked
+    int cache_size;
 };
 
 struct attributeprograminfo {
@@ -52,16 +58,71 @@ enum {
     NGLI_PROGRAM_SHADER_NB
 };
 
+struct program_shared;
+
 struct program {
     struct ngl_ctx *ctx;
     struct hmap *uniforms;
     struct hmap *attributes;
     struct hmap *buffer_blocks;
 
+    /*
+     * Resolution of the texture names into their uniforms, filled by the
+     * passes using the program (see register_texture() in pass.c) and shared
+     * by all the programs built from the same sources
+     */
+    struct hmap *texture_layouts;
+
     GLuint id;
+    struct program_shared *shared;
+
+    /* Set if the uniforms are packed into a uniform block (see pack_uniforms) */
+    const struct uniformpack *uniform_pack;
+    int uniform_block_binding;
+
+    /* Whether the samplers accept bindless handles (see bindless_textures) */
+    int bindless_samplers;
 };
 
+/*
+ * Programs built from the same sources share the same GL program (and probed
+ * information) within a context. If the context has a program cache
+ * directory, the program binaries are also stored there and loaded back
+ * instead of being compiled and linked from source. If the context is
+ * configured with pack_uniforms, the uniforms of the shaders are moved into
+ * a uniform block whenever possible (see ngli_uniformpack_init()). If it is
+ * configured with bindless_textures, the samplers of the GLSL >= 400 desktop
+ * shaders are declared as bindless.
+ */
+
 int ngli_program_init(struct program *s, struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute);
+
+/*
+ * Same as ngli_program_init(), except that if the context is configured with
+ * async_programs, the compilation and link are only submitted to the driver
+ * and the program can not be used until ngli_program_poll() reports it
+ * ready (the uniforms, attributes and buffer_blocks are not probed yet).
+ */
+int ngli_program_submit(struct program *s, struct ngl_ctx *ctx, const char *vertex, const char *fragment, const char *compute);
+
+/*
+ * Same as ngli_program_submit(), except that the global declarations of the
+ * given uniforms are first replaced by constants holding their values (see
+ * ngli_uniformpack_specialize()). The specialized field of each constant
+ * tells whether it has been compiled into the shaders. The programs built
+ * with the same constant values share the same GL program.
+ */
+int ngli_program_submit_specialized(struct program *s, struct ngl_ctx *ctx,
+                                    const char *vertex, const char *fragment, const char *compute,
+                                    struct uniformpack_constant *constants, int nb_constants);
+
+/*
+ * Return 1 if the program is ready to be used, 0 if the driver is still
+ * building it, or a negative error code if the build failed. The
+ * completion is only polled without blocking if the driver supports
+ * KHR_parallel_shader_compile, otherwise the first call waits for the build.
+ */
+int ngli_program_poll(struct program *s);
 void ngli_program_reset(struct program *s);
 
 #endif
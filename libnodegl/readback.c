@@ -0,0 +1,203 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "darray.h"
+#include "glcontext.h"
+#include "log.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "readback.h"
+
+int ngli_readback_queue(struct ngl_ctx *s, struct ngl_node *node, int offset, int size,
+                        ngl_buffer_read_callback_type callback, void *user_arg)
+{
+    const struct readback readback = {
+        .node     = ngl_node_ref(node),
+        .offset   = offset,
+        .size     = size,
+        .callback = callback,
+        .user_arg = user_arg,
+    };
+
+    pthread_mutex_lock(&s->readback_lock);
+    const void *queued = ngli_darray_push(&s->readback_requests, &readback);
+    pthread_mutex_unlock(&s->readback_lock);
+
+    if (!queued) {
+        ngl_node_unrefp(&node);
+        return NGL_ERROR_MEMORY;
+    }
+    return 0;
+}
+
+/*
+ * Get the GPU buffer holding the data of a node and the offset of the data
+ * in this buffer, or NULL if the node has no GPU buffer anymore
+ */
+static const struct buffer *get_gpu_buffer(const struct ngl_node *node, int *offsetp)
+{
+    const struct ngl_node *block_node = node;
+    int offset = 0;
+
+    if (node->class->category == NGLI_NODE_CATEGORY_BUFFER) {
+        const struct buffer_priv *buffer = node->priv_data;
+        if (!buffer->block) {
+            *offsetp = buffer->buffer.offset;
+            return buffer->buffer_refcount ? &buffer->buffer : NULL;
+        }
+        const struct block_priv *block = buffer->block->priv_data;
+        block_node = buffer->block;
+        offset = block->field_info[buffer->block_field].offset;
+    }
+
+    const struct block_priv *block = block_node->priv_data;
+    *offsetp = block->buffer.offset + offset;
+    return block->buffer_refcount ? &block->buffer : NULL;
+}
+
+static void deliver_error(struct readback *readback, int ret)
+{
+    readback->callback(readback->user_arg, ret, NULL, readback->size);
+}
+
+static int copy_data(struct ngl_ctx *s, struct readback *readback)
+{
+    struct glcontext *gl = s->glcontext;
+
+    int offset;
+    const struct buffer *src = readback->node->ctx == s ? get_gpu_buffer(readback->node, &offset) : NULL;
+    if (!src) {
+        LOG(ERROR, "%s has no GPU data to read", readback->node->label);
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    ngli_glGenBuffers(gl, 1, &readback->buffer);
+    ngli_glBindBuffer(gl, GL_COPY_WRITE_BUFFER, readback->buffer);
+    ngli_glBufferData(gl, GL_COPY_WRITE_BUFFER, readback->size, NULL, GL_STREAM_READ);
+    ngli_glBindBuffer(gl, GL_COPY_READ_BUFFER, src->id);
+    ngli_glCopyBufferSubData(gl, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                             offset + readback->offset, 0, readback->size);
+    ngli_glBindBuffer(gl, GL_COPY_READ_BUFFER, 0);
+    ngli_glBindBuffer(gl, GL_COPY_WRITE_BUFFER, 0);
+    readback->fence = ngli_glFenceSync(gl, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    return 0;
+}
+
+static void deliver_data(struct ngl_ctx *s, struct readback *readback)
+{
+    struct glcontext *gl = s->glcontext;
+
+    ngli_glDeleteSync(gl, readback->fence);
+    ngli_glBindBuffer(gl, GL_COPY_READ_BUFFER, readback->buffer);
+    const void *data = ngli_glMapBufferRange(gl, GL_COPY_READ_BUFFER, 0, readback->size, GL_MAP_READ_BIT);
+    if (data) {
+        readback->callback(readback->user_arg, 0, data, readback->size);
+        ngli_glUnmapBuffer(gl, GL_COPY_READ_BUFFER);
+    } else {
+        LOG(ERROR, "could not map readback buffer");
+        deliver_error(readback, NGL_ERROR_EXTERNAL);
+    }
+    ngli_glBindBuffer(gl, GL_COPY_READ_BUFFER, 0);
+    ngli_glDeleteBuffers(gl, 1, &readback->buffer);
+}
+
+/* Deliver the reads in order, stopping at the first one still in flight */
+static void deliver_readbacks(struct ngl_ctx *s, int wait)
+{
+    struct glcontext *gl = s->glcontext;
+    struct readback *readbacks = ngli_darray_data(&s->readbacks);
+    const int nb_readbacks = ngli_darray_count(&s->readbacks);
+
+    int nb_delivered = 0;
+    for (; nb_delivered < nb_readbacks; nb_delivered++) {
+        struct readback *readback = &readbacks[nb_delivered];
+        if (wait) {
+            const GLuint64 timeout = 1000000; /* 1ms */
+            while (ngli_glClientWaitSync(gl, readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED)
+                ;
+        } else if (ngli_glClientWaitSync(gl, readback->fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        deliver_data(s, readback);
+    }
+
+    memmove(readbacks, readbacks + nb_delivered, (nb_readbacks - nb_delivered) * sizeof(*readbacks));
+    s->readbacks.count -= nb_delivered;
+}
+
+/* Take the queued reads out of the lock so they can be processed without it */
+static struct darray take_requests(struct ngl_ctx *s)
+{
+    pthread_mutex_lock(&s->readback_lock);
+    struct darray requests = s->readback_requests;
+    ngli_darray_init(&s->readback_requests, sizeof(struct readback), 0);
+    pthread_mutex_unlock(&s->readback_lock);
+    return requests;
+}
+
+void ngli_readback_submit(struct ngl_ctx *s)
+{
+    struct glcontext *gl = s->glcontext;
+    struct darray requests = take_requests(s);
+    struct readback *readbacks = ngli_darray_data(&requests);
+
+    /* Make the writes of the compute shaders visible to the copies */
+    if (ngli_darray_count(&requests) && (gl->features & NGLI_FEATURE_COMPUTE_SHADER))
+        ngli_glMemoryBarrier(gl, GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    for (int i = 0; i < ngli_darray_count(&requests); i++) {
+        struct readback *readback = &readbacks[i];
+        int ret = copy_data(s, readback);
+        ngl_node_unrefp(&readback->node);
+        if (ret < 0) {
+            deliver_error(readback, ret);
+            continue;
+        }
+        if (!ngli_darray_push(&s->readbacks, readback)) {
+            ngli_glDeleteSync(gl, readback->fence);
+            ngli_glDeleteBuffers(gl, 1, &readback->buffer);
+            deliver_error(readback, NGL_ERROR_MEMORY);
+        }
+    }
+    ngli_darray_reset(&requests);
+
+    deliver_readbacks(s, 0);
+}
+
+void ngli_readback_flush(struct ngl_ctx *s)
+{
+    deliver_readbacks(s, 1);
+}
+
+void ngli_readback_reset(struct ngl_ctx *s)
+{
+    ngli_readback_flush(s);
+
+    struct darray requests = take_requests(s);
+    struct readback *readbacks = ngli_darray_data(&requests);
+    for (int i = 0; i < ngli_darray_count(&requests); i++) {
+        ngl_node_unrefp(&readbacks[i].node);
+        deliver_error(&readbacks[i], NGL_ERROR_INVALID_USAGE);
+    }
+    ngli_darray_reset(&requests);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef READBACK_H
+#define READBACK_H
+
+#include "glincludes.h"
+#include "nodegl.h"
+
+struct ngl_ctx;
+
+/*
+ * Asynchronous read of the GPU data of a Buffer* or Block node: the data is
+ * copied into a dedicated buffer at the end of the next draw and only
+ * mapped once a fence tells the copy is complete, so the rendering never
+ * waits for the GPU.
+ */
+struct readback {
+    struct ngl_node *node; /* referenced until the copy */
+    int offset;
+    int size;
+    ngl_buffer_read_callback_type callback;
+    void *user_arg;
+    GLuint buffer;
+    GLsync fence;
+};
+
+/* Can be called from any thread */
+int ngli_readback_queue(struct ngl_ctx *s, struct ngl_node *node, int offset, int size,
+                        ngl_buffer_read_callback_type callback, void *user_arg);
+
+/*
+ * Copy the data of the queued reads, once the frame is drawn, and deliver
+ * the reads already completed by the GPU without waiting
+ */
+void ngli_readback_submit(struct ngl_ctx *s);
+
+/* Wait for all the reads in flight and deliver them */
+void ngli_readback_flush(struct ngl_ctx *s);
+
+/* Deliver the reads in flight and cancel the queued ones */
+void ngli_readback_reset(struct ngl_ctx *s);
+
+#endif
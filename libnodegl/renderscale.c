@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "gputimer.h"
+#include "renderscale.h"
+#include "utils.h"
+
+/* Scale factors, in eighths of the full resolution */
+static const int64_t factors[] = {8, 7, 6, 5, 4};
+
+#define NB_OVER_FRAMES  5
+#define NB_UNDER_FRAMES 60
+#define MARGIN          85 // percentage of the target to fit in before raising the resolution
+
+void ngli_renderscale_init(struct renderscale *s, int64_t target)
+{
+    memset(s, 0, sizeof(*s));
+    s->target = target;
+}
+
+static int set_level(struct renderscale *s, int level)
+{
+    s->level = level;
+    s->nb_over = 0;
+    s->nb_under = 0;
+    s->nb_skipped = NGLI_GPUTIMER_NB_QUERIES;
+    return 1;
+}
+
+int ngli_renderscale_update(struct renderscale *s, int64_t gpu_time)
+{
+    if (!s->target || gpu_time < 0)
+        return 0;
+
+    if (s->nb_skipped) {
+        s->nb_skipped--;
+        return 0;
+    }
+
+    if (gpu_time > s->target) {
+        s->nb_under = 0;
+        if (++s->nb_over >= NB_OVER_FRAMES && s->level < (int)NGLI_ARRAY_NB(factors) - 1)
+            return set_level(s, s->level + 1);
+        return 0;
+    }
+    s->nb_over = 0;
+
+    if (!s->level)
+        return 0;
+
+    /* The GPU time is assumed to be proportional to the number of pixels */
+    const int64_t cur = factors[s->level];
+    const int64_t up = factors[s->level - 1];
+    const int64_t predicted = gpu_time * up * up / (cur * cur);
+    if (predicted * 100 > s->target * MARGIN) {
+        s->nb_under = 0;
+        return 0;
+    }
+    if (++s->nb_under >= NB_UNDER_FRAMES)
+        return set_level(s, s->level - 1);
+    return 0;
+}
+
+int ngli_renderscale_get_size(const struct renderscale *s, int size)
+{
+    return NGLI_MAX(size * factors[s->level] / 8, 1);
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef RENDERSCALE_H
+#define RENDERSCALE_H
+
+#include <stdint.h>
+
+/*
+ * Controller of the rendering resolution: the resolution is lowered one
+ * level at a time while the GPU frame time exceeds the target, and raised
+ * back when the time predicted at the higher resolution fits in the target
+ * with some margin. The GPU measures are delayed by a few frames, so the
+ * measures following a change are ignored.
+ */
+struct renderscale {
+    int64_t target;  // microseconds, 0 if disabled
+    int level;       // 0 is the full resolution
+    int nb_over;     // consecutive frames over the target
+    int nb_under;    // consecutive frames fitting in the target at the upper level
+    int nb_skipped;  // remaining measures to ignore after a change
+};
+
+void ngli_renderscale_init(struct renderscale *s, int64_t target);
+
+/*
+ * Register the GPU time of a frame, in microseconds. Return 1 if the
+ * rendering resolution must change, 0 otherwise.
+ */
+int ngli_renderscale_update(struct renderscale *s, int64_t gpu_time);
+
+/*
+ * Return the dimension to render at for the full resolution dimension size.
+ */
+int ngli_renderscale_get_size(const struct renderscale *s, int size);
+
+#endif
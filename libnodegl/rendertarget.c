@@ -31,6 +31,12 @@
 #include "texture.h"
 #include "utils.h"
 
+NGLI_STATIC_ASSERT(load_op_clear, (int)NGLI_LOAD_OP_CLEAR == (int)NGL_LOAD_OP_CLEAR);
+NGLI_STATIC_ASSERT(load_op_load, (int)NGLI_LOAD_OP_LOAD == (int)NGL_LOAD_OP_LOAD);
+NGLI_STATIC_ASSERT(load_op_dont_care, (int)NGLI_LOAD_OP_DONT_CARE == (int)NGL_LOAD_OP_DONT_CARE);
+NGLI_STATIC_ASSERT(store_op_store, (int)NGLI_STORE_OP_STORE == (int)NGL_STORE_OP_STORE);
+NGLI_STATIC_ASSERT(store_op_dont_care, (int)NGLI_STORE_OP_DONT_CARE == (int)NGL_STORE_OP_DONT_CARE);
+
 static GLenum get_gl_attachment_index(GLenum format)
 {
     switch (format) {
@@ -56,10 +62,17 @@ static void blit(struct rendertarget *s, struct rendertarget *dst, int vflip, in
     struct ngl_ctx *ctx = s->ctx;
     struct glcontext *gl = ctx->glcontext;
 
+    /* Only the color can be scaled, in which case it is filtered */
+    GLenum filter = GL_NEAREST;
+    if (s->width != dst->width || s->height != dst->height) {
+        flags &= GL_COLOR_BUFFER_BIT;
+        filter = GL_LINEAR;
+    }
+
     if (vflip)
-        ngli_glBlitFramebuffer(gl, 0, 0, s->width, s->height, 0, dst->height, dst->width, 0, flags, GL_NEAREST);
+        ngli_glBlitFramebuffer(gl, 0, 0, s->width, s->height, 0, dst->height, dst->width, 0, flags, filter);
     else
-        ngli_glBlitFramebuffer(gl, 0, 0, s->width, s->height, 0, 0, dst->width, dst->height, flags, GL_NEAREST);
+        ngli_glBlitFramebuffer(gl, 0, 0, s->width, s->height, 0, 0, dst->width, dst->height, flags, filter);
 }
 
 static void blit_no_draw_buffers(struct rendertarget *s, struct rendertarget *dst, int vflip)
@@ -95,6 +108,18 @@ int ngli_rendertarget_init(struct rendertarget *s, struct ngl_ctx *ctx, const st
     s->ctx = ctx;
     s->width = params->width;
     s->height = params->height;
+    s->implicit_samples = params->implicit_samples;
+    s->nb_views = params->nb_views;
+
+    if (s->implicit_samples > 0 && !(gl->features & NGLI_FEATURE_MULTISAMPLED_RENDER_TO_TEXTURE)) {
+        LOG(ERROR, "context does not support rendering to multisampled textures");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+
+    if (s->nb_views > 0 && !(gl->features & NGLI_FEATURE_OVR_MULTIVIEW)) {
+        LOG(ERROR, "context does not support multiview rendering");
+        return NGL_ERROR_UNSUPPORTED;
+    }
 
     ngli_glGenFramebuffers(gl, 1, &s->id);
     ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, s->id);
@@ -124,13 +149,31 @@ int ngli_rendertarget_init(struct rendertarget *s, struct ngl_ctx *ctx, const st
             }
             break;
         case GL_TEXTURE_2D:
-            ngli_glFramebufferTexture2D(gl, GL_FRAMEBUFFER, attachment_index, GL_TEXTURE_2D, attachment->id, 0);
+        case GL_TEXTURE_RECTANGLE:
+            if (s->implicit_samples > 0)
+                ngli_glFramebufferTexture2DMultisampleEXT(gl, GL_FRAMEBUFFER, attachment_index, attachment->target,
+                                                          attachment->id, 0, s->implicit_samples);
+            else
+                ngli_glFramebufferTexture2D(gl, GL_FRAMEBUFFER, attachment_index, attachment->target, attachment->id, 0);
             break;
         case GL_TEXTURE_CUBE_MAP:
-            for (int face = 0; face < 6; face++)
-                ngli_glFramebufferTexture2D(gl, GL_FRAMEBUFFER, attachment_index++, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, attachment->id, 0);
+            for (int face = 0; face < 6; face++) {
+                const GLenum target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + face;
+                if (s->implicit_samples > 0)
+                    ngli_glFramebufferTexture2DMultisampleEXT(gl, GL_FRAMEBUFFER, attachment_index++, target,
+                                                              attachment->id, 0, s->implicit_samples);
+                else
+                    ngli_glFramebufferTexture2D(gl, GL_FRAMEBUFFER, attachment_index++, target, attachment->id, 0);
+            }
             s->nb_color_attachments += 5;
             break;
+        case GL_TEXTURE_2D_ARRAY:
+            if (s->nb_views > 0)
+                ngli_glFramebufferTextureMultiviewOVR(gl, GL_FRAMEBUFFER, attachment_index, attachment->id,
+                                                      0, 0, s->nb_views);
+            else
+                ngli_glFramebufferTextureLayer(gl, GL_FRAMEBUFFER, attachment_index, attachment->id, 0, params->layer);
+            break;
         default:
             ngli_assert(0);
         }
@@ -172,6 +215,15 @@ int ngli_rendertarget_init(struct rendertarget *s, struct ngl_ctx *ctx, const st
         }
     }
 
+    /* Color attachments first, followed by the depth and stencil ones */
+    s->invalidate_attachments = ngli_calloc(s->nb_color_attachments + 2, sizeof(*s->invalidate_attachments));
+    if (!s->invalidate_attachments)
+        goto done;
+    for (int i = 0; i < s->nb_color_attachments; i++)
+        s->invalidate_attachments[i] = GL_COLOR_ATTACHMENT0 + i;
+    s->invalidate_attachments[s->nb_color_attachments]     = GL_DEPTH_ATTACHMENT;
+    s->invalidate_attachments[s->nb_color_attachments + 1] = GL_STENCIL_ATTACHMENT;
+
     ret = 0;
 
 done:;
@@ -199,6 +251,54 @@ void ngli_rendertarget_blit(struct rendertarget *s, struct rendertarget *dst, in
     ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
 }
 
+void ngli_rendertarget_blit_rect(struct rendertarget *s, const int *rect)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT))
+        return;
+
+    struct rendertarget *rt = ctx->rendertarget;
+    const GLuint fbo_id = rt ? rt->id : ngli_glcontext_get_default_framebuffer(gl);
+    const GLenum filter = s->width != rect[2] || s->height != rect[3] ? GL_LINEAR : GL_NEAREST;
+
+    ngli_glBindFramebuffer(gl, GL_READ_FRAMEBUFFER, s->id);
+    ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, fbo_id);
+    ngli_glBlitFramebuffer(gl, 0, 0, s->width, s->height,
+                           rect[0], rect[1], rect[0] + rect[2], rect[1] + rect[3],
+                           GL_COLOR_BUFFER_BIT, filter);
+    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+}
+
+void ngli_rendertarget_invalidate(struct rendertarget *s, int color, int depth_stencil)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    if (!(gl->features & NGLI_FEATURE_INVALIDATE_SUBDATA) || (!color && !depth_stencil))
+        return;
+
+    const GLenum *attachments = s->invalidate_attachments;
+    int nb_attachments = s->nb_color_attachments + 2;
+    if (!color) {
+        attachments += s->nb_color_attachments;
+        nb_attachments = 2;
+    } else if (!depth_stencil) {
+        nb_attachments = s->nb_color_attachments;
+    }
+
+    struct rendertarget *rt = ctx->rendertarget;
+    const GLuint fbo_id = rt ? rt->id : ngli_glcontext_get_default_framebuffer(gl);
+    if (s->id != fbo_id)
+        ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, s->id);
+
+    ngli_glInvalidateFramebuffer(gl, GL_FRAMEBUFFER, nb_attachments, attachments);
+
+    if (s->id != fbo_id)
+        ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+}
+
 void ngli_rendertarget_read_pixels(struct rendertarget *s, uint8_t *data)
 {
     struct ngl_ctx *ctx = s->ctx;
@@ -226,6 +326,7 @@ void ngli_rendertarget_reset(struct rendertarget *s)
 
     ngli_free(s->draw_buffers);
     ngli_free(s->blit_draw_buffers);
+    ngli_free(s->invalidate_attachments);
 
     memset(s, 0, sizeof(*s));
 }
@@ -26,11 +26,41 @@
 #include "glcontext.h"
 #include "texture.h"
 
+/* Same values as the public NGL_LOAD_OP_* and NGL_STORE_OP_* */
+enum {
+    NGLI_LOAD_OP_CLEAR,
+    NGLI_LOAD_OP_LOAD,
+    NGLI_LOAD_OP_DONT_CARE,
+    NGLI_NB_LOAD_OP
+};
+
+enum {
+    NGLI_STORE_OP_STORE,
+    NGLI_STORE_OP_DONT_CARE,
+    NGLI_NB_STORE_OP
+};
+
 struct rendertarget_params {
     int width;
     int height;
     int nb_attachments;
     const struct texture **attachments;
+    /*
+     * Number of samples of the rendering into the texture attachments
+     * (EXT_multisampled_render_to_texture): the samples only live in the
+     * tile memory and are resolved into the textures when stored. The
+     * renderbuffer attachments must be allocated with the same number of
+     * samples and the NGLI_TEXTURE_USAGE_IMPLICIT_MULTISAMPLE usage.
+     */
+    int implicit_samples;
+    /*
+     * Number of views rendered at once into the layers of the 2D array
+     * attachments (OVR_multiview), the vertex shaders selecting their view
+     * with gl_ViewID_OVR. Without views, the 2D array attachments are
+     * attached by their given layer.
+     */
+    int nb_views;
+    int layer;
 };
 
 struct rendertarget {
@@ -38,17 +68,32 @@ struct rendertarget {
     int width;
     int height;
     int nb_color_attachments;
+    int implicit_samples;
+    int nb_views;
 
     GLuint id;
     GLuint prev_id;
     GLenum *draw_buffers;
     int nb_draw_buffers;
     GLenum *blit_draw_buffers;
+    GLenum *invalidate_attachments;
     void (*blit)(struct rendertarget *s, struct rendertarget *dst, int vflip);
 };
 
 int ngli_rendertarget_init(struct rendertarget *s, struct ngl_ctx *ctx, const struct rendertarget_params *params);
 void ngli_rendertarget_blit(struct rendertarget *s, struct rendertarget *dst, int vflip);
+
+/*
+ * Blit the color of the render target into the rectangle (x, y, width,
+ * height) of the current one, which may be the default framebuffer.
+ */
+void ngli_rendertarget_blit_rect(struct rendertarget *s, const int *rect);
+
+/*
+ * Discard the content of the color and/or depth/stencil attachments, the
+ * render target does not have to be bound.
+ */
+void ngli_rendertarget_invalidate(struct rendertarget *s, int color, int depth_stencil);
 void ngli_rendertarget_read_pixels(struct rendertarget *s, uint8_t *data);
 void ngli_rendertarget_reset(struct rendertarget *s);
 
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "glcontext.h"
+#include "samplercache.h"
+
+void ngli_samplercache_init(struct samplercache *s, struct glcontext *gl)
+{
+    s->gl = gl;
+    ngli_darray_init(&s->entries, sizeof(struct samplercache_entry), 0);
+}
+
+GLuint ngli_samplercache_get(struct samplercache *s, const struct sampler_key *key)
+{
+    const struct samplercache_entry *entries = ngli_darray_data(&s->entries);
+    for (int i = 0; i < ngli_darray_count(&s->entries); i++)
+        if (!memcmp(&entries[i].key, key, sizeof(*key)))
+            return entries[i].id;
+
+    struct glcontext *gl = s->gl;
+    struct samplercache_entry entry = {.key = *key};
+    ngli_glGenSamplers(gl, 1, &entry.id);
+    ngli_glSamplerParameteri(gl, entry.id, GL_TEXTURE_MIN_FILTER, key->min_filter);
+    ngli_glSamplerParameteri(gl, entry.id, GL_TEXTURE_MAG_FILTER, key->mag_filter);
+    ngli_glSamplerParameteri(gl, entry.id, GL_TEXTURE_WRAP_S, key->wrap_s);
+    ngli_glSamplerParameteri(gl, entry.id, GL_TEXTURE_WRAP_T, key->wrap_t);
+    ngli_glSamplerParameteri(gl, entry.id, GL_TEXTURE_WRAP_R, key->wrap_r);
+    if (!ngli_darray_push(&s->entries, &entry)) {
+        ngli_glDeleteSamplers(gl, 1, &entry.id);
+        return 0;
+    }
+    return entry.id;
+}
+
+void ngli_samplercache_reset(struct samplercache *s)
+{
+    const struct samplercache_entry *entries = ngli_darray_data(&s->entries);
+    for (int i = 0; i < ngli_darray_count(&s->entries); i++)
+        ngli_glDeleteSamplers(s->gl, 1, &entries[i].id);
+    ngli_darray_reset(&s->entries);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SAMPLERCACHE_H
+#define SAMPLERCACHE_H
+
+#include "darray.h"
+#include "glincludes.h"
+
+struct glcontext;
+
+struct sampler_key {
+    GLint min_filter;
+    GLint mag_filter;
+    GLint wrap_s;
+    GLint wrap_t;
+    GLint wrap_r;
+};
+
+struct samplercache_entry {
+    struct sampler_key key;
+    GLuint id;
+};
+
+/*
+ * GL sampler objects shared by all the textures with the same filtering
+ * and wrapping, living as long as the context
+ */
+struct samplercache {
+    struct glcontext *gl;
+    struct darray entries;
+};
+
+void ngli_samplercache_init(struct samplercache *s, struct glcontext *gl);
+
+/*
+ * Return the sampler object matching the key, created on first use, or 0
+ * if it could not be created.
+ */
+GLuint ngli_samplercache_get(struct samplercache *s, const struct sampler_key *key);
+
+void ngli_samplercache_reset(struct samplercache *s);
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "nodegl.h"
+#include "nodes.h"
+#include "schedule.h"
+
+/* Post-order depth-first walk, the reversed order being topological */
+static int add_node(struct schedule *s, struct ngl_node *node, int gen)
+{
+    if (node->schedule_gen == gen)
+        return 0;
+    node->schedule_gen = gen;
+
+    struct ngl_node **children = ngli_darray_data(&node->children);
+    for (int i = 0; i < ngli_darray_count(&node->children); i++) {
+        int ret = add_node(s, children[i], gen);
+        if (ret < 0)
+            return ret;
+    }
+
+    if (!ngli_darray_push(&s->nodes, &node))
+        return NGL_ERROR_MEMORY;
+    return 0;
+}
+
+int ngli_schedule_init(struct schedule *s, struct ngl_node *root)
+{
+    ngli_schedule_reset(s);
+    ngli_darray_init(&s->nodes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->spans, sizeof(struct schedule_span), 0);
+    ngli_darray_init(&s->children, sizeof(int), 0);
+
+    if (!root)
+        return 0;
+
+    int ret = add_node(s, root, ++root->ctx->schedule_gen);
+    if (ret < 0)
+        goto fail;
+
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes);
+    const int nb_nodes = ngli_darray_count(&s->nodes);
+    for (int i = 0; i < nb_nodes / 2; i++) {
+        struct ngl_node *tmp = nodes[i];
+        nodes[i] = nodes[nb_nodes - 1 - i];
+        nodes[nb_nodes - 1 - i] = tmp;
+    }
+    for (int i = 0; i < nb_nodes; i++)
+        nodes[i]->schedule_index = i;
+
+    for (int i = 0; i < nb_nodes; i++) {
+        const struct darray *children_array = &nodes[i]->children;
+        struct ngl_node **children = ngli_darray_data(children_array);
+        const struct schedule_span span = {
+            .start = ngli_darray_count(&s->children),
+            .count = ngli_darray_count(children_array),
+        };
+        if (!ngli_darray_push(&s->spans, &span)) {
+            ret = NGL_ERROR_MEMORY;
+            goto fail;
+        }
+        for (int j = 0; j < span.count; j++) {
+            if (!ngli_darray_push(&s->children, &children[j]->schedule_index)) {
+                ret = NGL_ERROR_MEMORY;
+                goto fail;
+            }
+        }
+    }
+
+    return 0;
+
+fail:
+    ngli_schedule_reset(s);
+    return ret;
+}
+
+void ngli_schedule_reset(struct schedule *s)
+{
+    ngli_darray_reset(&s->children);
+    ngli_darray_reset(&s->spans);
+    ngli_darray_reset(&s->nodes);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "darray.h"
+
+struct ngl_ctx;
+struct ngl_node;
+
+struct schedule_span {
+    int start; /* index of the first child in schedule.children */
+    int count;
+};
+
+/*
+ * Flat form of a graph: every node appears once, before all its children,
+ * and the children of the node at index i are the nodes at the indices
+ * children[spans[i].start] to children[spans[i].start + spans[i].count - 1].
+ * The traversals which do not depend on the node classes can then iterate
+ * over contiguous arrays instead of recursing through the graph.
+ *
+ * The schedule only depends on the topology of the graph, so it has to be
+ * built again when the nodes are initialized again.
+ */
+struct schedule {
+    struct darray nodes;    /* struct ngl_node * */
+    struct darray spans;    /* struct schedule_span, one per node */
+    struct darray children; /* int, indices in nodes */
+};
+
+int ngli_schedule_init(struct schedule *s, struct ngl_node *root);
+void ngli_schedule_reset(struct schedule *s);
+
+#endif
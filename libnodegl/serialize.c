@@ -20,18 +20,47 @@
  */
 
 #include <inttypes.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "bstr.h"
+#include "darray.h"
 #include "hmap.h"
 #include "log.h"
 #include "memory.h"
 #include "nodes.h"
 #include "nodegl.h"
+#include "serialize.h"
 #include "utils.h"
 
 extern const struct node_param ngli_base_node_params[];
 
+/*
+ * The text is staged in a string which, when streamed, is handed to the
+ * write callback every time it grows over FLUSH_SIZE
+ */
+#define FLUSH_SIZE (64 * 1024)
+#define HEX_CHUNK_SIZE 4096
+
+struct serializer {
+    struct hmap *nlist;
+    struct bstr *b;
+    ngl_serialize_callback_type write_func;
+    void *user_arg;
+    int error;
+};
+
+static void flush(struct serializer *s, int min_size)
+{
+    const int len = ngli_bstr_len(s->b);
+    if (!s->write_func || s->error || !len || len < min_size)
+        return;
+    int ret = s->write_func(s->user_arg, ngli_bstr_strptr(s->b), len);
+    if (ret < 0)
+        s->error = ret;
+    ngli_bstr_clear(s->b);
+}
+
 static void free_func(void *arg, void *data)
 {
     ngli_free(data);
@@ -44,22 +73,23 @@ static int register_node(struct hmap *nlist,
     int ret = snprintf(key, sizeof(key), "%p", node);
     if (ret < 0)
         return ret;
-    char *val = ngli_asprintf("%x", ngli_hmap_count(nlist));
+    int *val = ngli_malloc(sizeof(*val));
     if (!val)
         return NGL_ERROR_MEMORY;
+    *val = ngli_hmap_count(nlist);
     ret = ngli_hmap_set(nlist, key, val);
     if (ret < 0)
         ngli_free(val);
     return ret;
 }
 
-static const char *get_node_id(const struct hmap *nlist,
-                               const struct ngl_node *node)
+static int get_node_id(const struct hmap *nlist,
+                       const struct ngl_node *node)
 {
     char key[32];
     (void)snprintf(key, sizeof(key), "%p", node);
-    const char *val = ngli_hmap_get(nlist, key);
-    return val;
+    const int *val = ngli_hmap_get(nlist, key);
+    return val ? *val : -1;
 }
 
 #define DECLARE_FLT_PRINT_FUNCS(type, nbit, shift_exp, z)               \
@@ -86,12 +116,14 @@ static void print_##type##s(struct bstr *b, int n, const type *f)       \
 DECLARE_FLT_PRINT_FUNCS(float,  32, 23, 'z')
 DECLARE_FLT_PRINT_FUNCS(double, 64, 52, 'Z')
 
-static void serialize_options(struct hmap *nlist,
-                              struct bstr *b,
+static void serialize_options(struct serializer *s,
                               const struct ngl_node *node,
                               uint8_t *priv,
                               const struct node_param *p)
 {
+    struct hmap *nlist = s->nlist;
+    struct bstr *b = s->b;
+
     while (p && p->key) {
         const int constructor = p->flags & PARAM_FLAG_CONSTRUCTOR;
         switch (p->type) {
@@ -177,14 +209,28 @@ static void serialize_options(struct hmap *nlist,
             case PARAM_TYPE_DATA: {
                 const uint8_t *data = *(uint8_t **)(priv + p->offset);
                 const int size = *(int *)(priv + p->offset + sizeof(uint8_t *));
+                /* The data of a GPU-only buffer in use is not on the CPU */
+                if (!data && size) {
+                    LOG(ERROR, "the data of %s is only available on the GPU", node->label);
+                    s->error = NGL_ERROR_INVALID_USAGE;
+                    break;
+                }
                 if (!data || !size)
                     break;
                 if (!constructor)
                     ngli_bstr_print(b, " %s:%d,", p->key, size);
                 else
                     ngli_bstr_print(b, " %d,", size);
-                for (int i = 0; i < size; i++) {
-                    ngli_bstr_print(b, "%02x", data[i]);
+                static const char hexdigits[] = "0123456789abcdef";
+                char hex[2 * HEX_CHUNK_SIZE];
+                for (int i = 0; i < size; i += HEX_CHUNK_SIZE) {
+                    const int n = NGLI_MIN(HEX_CHUNK_SIZE, size - i);
+                    for (int j = 0; j < n; j++) {
+                        hex[2*j    ] = hexdigits[data[i + j] >> 4];
+                        hex[2*j + 1] = hexdigits[data[i + j] & 0xf];
+                    }
+                    ngli_bstr_append(b, hex, 2 * n);
+                    flush(s, FLUSH_SIZE);
                 }
                 break;
             }
@@ -217,11 +263,11 @@ static void serialize_options(struct hmap *nlist,
                 const struct ngl_node *node = *(struct ngl_node **)(priv + p->offset);
                 if (!node)
                     break;
-                const char *node_id = get_node_id(nlist, node);
+                const int node_id = get_node_id(nlist, node);
                 if (constructor)
-                    ngli_bstr_print(b, " %s", node_id);
+                    ngli_bstr_print(b, " %x", node_id);
                 else if (node)
-                    ngli_bstr_print(b, " %s:%s", p->key, node_id);
+                    ngli_bstr_print(b, " %s:%x", p->key, node_id);
                 break;
             }
             case PARAM_TYPE_NODELIST: {
@@ -234,8 +280,8 @@ static void serialize_options(struct hmap *nlist,
                 else
                     ngli_bstr_print(b, " %s:", p->key);
                 for (int i = 0; i < nb_nodes; i++) {
-                    const char *node_id = get_node_id(nlist, nodes[i]);
-                    ngli_bstr_print(b, "%s%s", i ? "," : "", node_id);
+                    const int node_id = get_node_id(nlist, nodes[i]);
+                    ngli_bstr_print(b, "%s%x", i ? "," : "", node_id);
                 }
                 break;
             }
@@ -265,8 +311,8 @@ static void serialize_options(struct hmap *nlist,
                 int i = 0;
                 const struct hmap_entry *entry = NULL;
                 while ((entry = ngli_hmap_next(hmap, entry))) {
-                    const char *node_id = get_node_id(nlist, entry->data);
-                    ngli_bstr_print(b, "%s%s=%s", i ? "," : "", entry->key, node_id);
+                    const int node_id = get_node_id(nlist, entry->data);
+                    ngli_bstr_print(b, "%s%s=%x", i ? "," : "", entry->key, node_id);
                     i++;
                 }
                 break;
@@ -278,22 +324,21 @@ static void serialize_options(struct hmap *nlist,
     }
 }
 
-static int serialize(struct hmap *nlist,
-                     struct bstr *b,
-                     const struct ngl_node *node);
+static int collect_nodes(struct hmap *nlist,
+                         struct darray *nodes,
+                         const struct ngl_node *node);
 
-static int serialize_children(struct hmap *nlist,
-                               struct bstr *b,
-                               const struct ngl_node *node,
-                               uint8_t *priv,
-                               const struct node_param *p)
+static int collect_children(struct hmap *nlist,
+                            struct darray *nodes,
+                            uint8_t *priv,
+                            const struct node_param *p)
 {
     while (p && p->key) {
         switch (p->type) {
             case PARAM_TYPE_NODE: {
                 const struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
                 if (child) {
-                    int ret = serialize(nlist, b, child);
+                    int ret = collect_nodes(nlist, nodes, child);
                     if (ret < 0)
                         return ret;
                 }
@@ -304,7 +349,7 @@ static int serialize_children(struct hmap *nlist,
                 const int nb_children = *(int *)(priv + p->offset + sizeof(struct ngl_node **));
 
                 for (int i = 0; i < nb_children; i++) {
-                    int ret = serialize(nlist, b, children[i]);
+                    int ret = collect_nodes(nlist, nodes, children[i]);
                     if (ret < 0)
                         return ret;
                 }
@@ -316,7 +361,7 @@ static int serialize_children(struct hmap *nlist,
                     break;
                 const struct hmap_entry *entry = NULL;
                 while ((entry = ngli_hmap_next(hmap, entry))) {
-                    int ret = serialize(nlist, b, entry->data);
+                    int ret = collect_nodes(nlist, nodes, entry->data);
                     if (ret < 0)
                         return ret;
                 }
@@ -328,49 +373,471 @@ static int serialize_children(struct hmap *nlist,
     return 0;
 }
 
-static int serialize(struct hmap *nlist,
-                     struct bstr *b,
-                     const struct ngl_node *node)
+/*
+ * List the nodes of the graph in dependency order: every node comes after
+ * the nodes it references, and its index in the list is its identifier.
+ */
+static int collect_nodes(struct hmap *nlist,
+                         struct darray *nodes,
+                         const struct ngl_node *node)
 {
-    if (get_node_id(nlist, node))
+    if (get_node_id(nlist, node) >= 0)
         return 0;
 
     int ret;
 
-    if ((ret = serialize_children(nlist, b, node, (uint8_t *)node, ngli_base_node_params)) < 0 ||
-        (ret = serialize_children(nlist, b, node, node->priv_data, node->class->params)) < 0)
+    if ((ret = collect_children(nlist, nodes, (uint8_t *)node, ngli_base_node_params)) < 0 ||
+        (ret = collect_children(nlist, nodes, node->priv_data, node->class->params)) < 0)
         return ret;
 
-    const uint32_t tag = node->class->id;
-    ngli_bstr_print(b, "%c%c%c%c",
-                    tag >> 24 & 0xff,
-                    tag >> 16 & 0xff,
-                    tag >>  8 & 0xff,
-                    tag       & 0xff);
-    serialize_options(nlist, b, node, node->priv_data, node->class->params);
-    serialize_options(nlist, b, node, (uint8_t *)node, ngli_base_node_params);
-    ngli_bstr_print(b, "\n");
+    if (!ngli_darray_push(nodes, &node))
+        return NGL_ERROR_MEMORY;
 
     return register_node(nlist, node);
 }
 
-char *ngl_node_serialize(const struct ngl_node *node)
+static int init_node_list(struct hmap **nlistp, struct darray *nodes,
+                          const struct ngl_node *node)
 {
-    char *s = NULL;
+    ngli_darray_init(nodes, sizeof(const struct ngl_node *), 0);
+
     struct hmap *nlist = ngli_hmap_create();
-    struct bstr *b = ngli_bstr_create();
-    if (!nlist || !b)
+    if (!nlist)
+        return NGL_ERROR_MEMORY;
+    ngli_hmap_set_free(nlist, free_func, NULL);
+    *nlistp = nlist;
+
+    return collect_nodes(nlist, nodes, node);
+}
+
+static int serialize(struct serializer *s, const struct ngl_node *node)
+{
+    struct darray nodes;
+    int ret = init_node_list(&s->nlist, &nodes, node);
+    if (ret < 0)
         goto end;
 
-    ngli_hmap_set_free(nlist, free_func, NULL);
-    ngli_bstr_print(b, "# Node.GL v%d.%d.%d\n",
+    s->b = ngli_bstr_create();
+    if (!s->b) {
+        ret = NGL_ERROR_MEMORY;
+        goto end;
+    }
+
+    ngli_bstr_print(s->b, "# Node.GL v%d.%d.%d\n",
                     NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
-    if (serialize(nlist, b, node) < 0)
+
+    const struct ngl_node **nodes_data = ngli_darray_data(&nodes);
+    for (int i = 0; i < ngli_darray_count(&nodes) && !s->error; i++) {
+        const struct ngl_node *n = nodes_data[i];
+        const uint32_t tag = n->class->id;
+        ngli_bstr_print(s->b, "%c%c%c%c",
+                        tag >> 24 & 0xff,
+                        tag >> 16 & 0xff,
+                        tag >>  8 & 0xff,
+                        tag       & 0xff);
+        serialize_options(s, n, n->priv_data, n->class->params);
+        serialize_options(s, n, (uint8_t *)n, ngli_base_node_params);
+        ngli_bstr_print(s->b, "\n");
+        flush(s, FLUSH_SIZE);
+    }
+    flush(s, 1);
+    ret = s->error;
+
+end:
+    ngli_hmap_freep(&s->nlist);
+    ngli_darray_reset(&nodes);
+    return ret;
+}
+
+char *ngl_node_serialize(const struct ngl_node *node)
+{
+    struct serializer s = {0};
+    int ret = serialize(&s, node);
+    char *str = ret < 0 ? NULL : ngli_bstr_strdup(s.b);
+    ngli_bstr_freep(&s.b);
+    return str;
+}
+
+int ngl_node_serialize_to(const struct ngl_node *node,
+                          ngl_serialize_callback_type write_func, void *user_arg)
+{
+    struct serializer s = {.write_func = write_func, .user_arg = user_arg};
+    int ret = serialize(&s, node);
+    ngli_bstr_freep(&s.b);
+    return ret;
+}
+
+static int write_file(void *user_arg, const char *data, int size)
+{
+    FILE *fp = user_arg;
+    return fwrite(data, 1, size, fp) == (size_t)size ? 0 : NGL_ERROR_IO;
+}
+
+int ngl_node_serialize_to_file(const struct ngl_node *node, const char *filename)
+{
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        LOG(ERROR, "unable to open %s", filename);
+        return NGL_ERROR_IO;
+    }
+
+    int ret = ngl_node_serialize_to(node, write_file, fp);
+    if (fclose(fp) && ret >= 0)
+        ret = NGL_ERROR_IO;
+    if (ret < 0) {
+        LOG(ERROR, "unable to write the scene to %s", filename);
+        remove(filename);
+    }
+    return ret;
+}
+
+struct binbuf {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    int error;
+};
+
+static void bin_write(struct binbuf *b, const void *data, size_t size)
+{
+    if (b->error)
+        return;
+    if (b->size + size > b->capacity) {
+        size_t capacity = NGLI_MAX(b->capacity * 2, 1024);
+        while (capacity < b->size + size)
+            capacity *= 2;
+        uint8_t *new_data = ngli_realloc(b->data, capacity);
+        if (!new_data) {
+            b->error = NGL_ERROR_MEMORY;
+            return;
+        }
+        b->data = new_data;
+        b->capacity = capacity;
+    }
+    if (data)
+        memcpy(b->data + b->size, data, size);
+    else
+        memset(b->data + b->size, 0, size);
+    b->size += size;
+}
+
+static void bin_align(struct binbuf *b, size_t align)
+{
+    bin_write(b, NULL, NGLI_ALIGN(b->size, align) - b->size);
+}
+
+static void bin_write_u32(struct binbuf *b, uint32_t v)
+{
+    const uint8_t d[] = {v, v >> 8, v >> 16, v >> 24};
+    bin_write(b, d, sizeof(d));
+}
+
+static void bin_write_u64(struct binbuf *b, uint64_t v)
+{
+    bin_write_u32(b, (uint32_t)v);
+    bin_write_u32(b, (uint32_t)(v >> 32));
+}
+
+static void bin_write_float(struct binbuf *b, float f)
+{
+    const union { uint32_t i; float f; } u = {.f = f};
+    bin_write_u32(b, u.i);
+}
+
+static void bin_write_double(struct binbuf *b, double f)
+{
+    const union { uint64_t i; double f; } u = {.f = f};
+    bin_write_u64(b, u.i);
+}
+
+static void bin_write_floats(struct binbuf *b, int n, const float *f)
+{
+    for (int i = 0; i < n; i++)
+        bin_write_float(b, f[i]);
+}
+
+static void bin_write_str(struct binbuf *b, const char *s)
+{
+    const size_t len = strlen(s);
+    bin_write_u32(b, len);
+    bin_write(b, s, len + 1);
+}
+
+struct binscene {
+    struct hmap *nlist;
+    struct binbuf params;
+    struct binbuf payloads;
+    struct hmap *payload_offsets;
+};
+
+static void bin_write_key(struct binbuf *b, const struct node_param *p, int *nb_paramsp)
+{
+    bin_write_str(b, p->key);
+    bin_write_u32(b, p->type);
+    (*nb_paramsp)++;
+}
+
+/*
+ * Identical data payloads are only stored once, whichever nodes they belong
+ * to: they are indexed by their hash and size, and compared on a match
+ */
+static int write_payload(struct binscene *bs, const uint8_t *data, int size, uint64_t *offsetp)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "%016" PRIx64 "-%d", ngli_fnv1a64(data, size), size);
+    const uint64_t *offset = ngli_hmap_get(bs->payload_offsets, key);
+    if (offset && !memcmp(bs->payloads.data + *offset, data, size)) {
+        *offsetp = *offset;
+        return 0;
+    }
+
+    bin_align(&bs->payloads, NGLI_BINSCENE_ALIGN);
+    *offsetp = bs->payloads.size;
+    bin_write(&bs->payloads, data, size);
+    if (bs->payloads.error)
+        return bs->payloads.error;
+
+    /* On a hash collision, the first payload remains the indexed one */
+    if (offset)
+        return 0;
+
+    uint64_t *new_offset = ngli_malloc(sizeof(*new_offset));
+    if (!new_offset)
+        return NGL_ERROR_MEMORY;
+    *new_offset = *offsetp;
+    int ret = ngli_hmap_set(bs->payload_offsets, key, new_offset);
+    if (ret < 0)
+        ngli_free(new_offset);
+    return ret;
+}
+
+static int serialize_binary_params(struct binscene *bs,
+                                   const struct ngl_node *node,
+                                   uint8_t *priv,
+                                   const struct node_param *p,
+                                   int *nb_paramsp)
+{
+    struct binbuf *b = &bs->params;
+
+    while (p && p->key) {
+        const int constructor = p->flags & PARAM_FLAG_CONSTRUCTOR;
+        switch (p->type) {
+            case PARAM_TYPE_SELECT:
+            case PARAM_TYPE_FLAGS: {
+                const int v = *(int *)(priv + p->offset);
+                if (!constructor && v == p->def_value.i64)
+                    break;
+                char *s = p->type == PARAM_TYPE_SELECT
+                        ? ngli_strdup(ngli_params_get_select_str(p->choices->consts, v))
+                        : ngli_params_get_flags_str(p->choices->consts, v);
+                if (!s)
+                    return NGL_ERROR_MEMORY;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_str(b, s);
+                ngli_free(s);
+                break;
+            }
+            case PARAM_TYPE_BOOL:
+            case PARAM_TYPE_INT: {
+                const int v = *(int *)(priv + p->offset);
+                if (!constructor && v == p->def_value.i64)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u32(b, v);
+                break;
+            }
+            case PARAM_TYPE_I64: {
+                const int64_t v = *(int64_t *)(priv + p->offset);
+                if (!constructor && v == p->def_value.i64)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u64(b, v);
+                break;
+            }
+            case PARAM_TYPE_DBL: {
+                const double v = *(double *)(priv + p->offset);
+                if (!constructor && v == p->def_value.dbl)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_double(b, v);
+                break;
+            }
+            case PARAM_TYPE_RATIONAL: {
+                const int *r = (int *)(priv + p->offset);
+                if (!constructor && !memcmp(r, p->def_value.r, sizeof(p->def_value.r)))
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u32(b, r[0]);
+                bin_write_u32(b, r[1]);
+                break;
+            }
+            case PARAM_TYPE_STR: {
+                const char *s = *(char **)(priv + p->offset);
+                if (!s || (p->def_value.str && !strcmp(s, p->def_value.str)))
+                    break;
+                if (!strcmp(p->key, "label") &&
+                    ngli_is_default_label(node->class->name, s))
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_str(b, s);
+                break;
+            }
+            case PARAM_TYPE_DATA: {
+                const uint8_t *data = *(uint8_t **)(priv + p->offset);
+                const int size = *(int *)(priv + p->offset + sizeof(uint8_t *));
+                if (!data && size) {
+                    LOG(ERROR, "the data of %s is only available on the GPU", node->label);
+                    return NGL_ERROR_INVALID_USAGE;
+                }
+                if (!data || !size)
+                    break;
+                uint64_t offset;
+                int ret = write_payload(bs, data, size, &offset);
+                if (ret < 0)
+                    return ret;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u64(b, offset);
+                bin_write_u32(b, size);
+                break;
+            }
+            case PARAM_TYPE_VEC2:
+            case PARAM_TYPE_VEC3:
+            case PARAM_TYPE_VEC4: {
+                const float *v = (float *)(priv + p->offset);
+                const int n = p->type - PARAM_TYPE_VEC2 + 2;
+                if (!constructor && !memcmp(v, p->def_value.vec, n * sizeof(*v)))
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_floats(b, n, v);
+                break;
+            }
+            case PARAM_TYPE_MAT4: {
+                const float *m = (float *)(priv + p->offset);
+                if (!constructor && !memcmp(m, p->def_value.mat, 16 * sizeof(*m)))
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_floats(b, 16, m);
+                break;
+            }
+            case PARAM_TYPE_NODE: {
+                const struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
+                if (!child)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u32(b, get_node_id(bs->nlist, child));
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **children = *(struct ngl_node ***)(priv + p->offset);
+                const int nb_children = *(int *)(priv + p->offset + sizeof(struct ngl_node **));
+                if (!nb_children)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u32(b, nb_children);
+                for (int i = 0; i < nb_children; i++)
+                    bin_write_u32(b, get_node_id(bs->nlist, children[i]));
+                break;
+            }
+            case PARAM_TYPE_DBLLIST: {
+                const double *elems = *(double **)(priv + p->offset);
+                const int nb_elems = *(int *)(priv + p->offset + sizeof(double *));
+                if (!nb_elems)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u32(b, nb_elems);
+                for (int i = 0; i < nb_elems; i++)
+                    bin_write_double(b, elems[i]);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(priv + p->offset);
+                const int nb_children = hmap ? ngli_hmap_count(hmap) : 0;
+                if (!nb_children)
+                    break;
+                bin_write_key(b, p, nb_paramsp);
+                bin_write_u32(b, nb_children);
+                const struct hmap_entry *entry = NULL;
+                while ((entry = ngli_hmap_next(hmap, entry))) {
+                    bin_write_str(b, entry->key);
+                    bin_write_u32(b, get_node_id(bs->nlist, entry->data));
+                }
+                break;
+            }
+            default:
+                LOG(ERROR, "cannot serialize %s: unsupported parameter type", p->key);
+                return NGL_ERROR_UNSUPPORTED;
+        }
+        p++;
+    }
+    return b->error ? b->error : bs->payloads.error;
+}
+
+void *ngl_node_serialize_binary(const struct ngl_node *node, size_t *sizep)
+{
+    uint8_t *data = NULL;
+    struct binscene bs = {0};
+    struct binbuf table = {0};
+    struct darray nodes;
+    int ret = init_node_list(&bs.nlist, &nodes, node);
+    if (ret < 0)
+        goto end;
+
+    bs.payload_offsets = ngli_hmap_create();
+    if (!bs.payload_offsets)
+        goto end;
+    ngli_hmap_set_free(bs.payload_offsets, free_func, NULL);
+
+    const struct ngl_node **nodes_data = ngli_darray_data(&nodes);
+    const int nb_nodes = ngli_darray_count(&nodes);
+    for (int i = 0; i < nb_nodes; i++) {
+        const struct ngl_node *n = nodes_data[i];
+        const size_t offset = bs.params.size;
+        int nb_params = 0;
+        if ((ret = serialize_binary_params(&bs, n, n->priv_data, n->class->params, &nb_params)) < 0 ||
+            (ret = serialize_binary_params(&bs, n, (uint8_t *)n, ngli_base_node_params, &nb_params)) < 0)
+            goto end;
+        bin_write_u32(&table, n->class->id);
+        bin_write_u32(&table, nb_params);
+        bin_write_u64(&table, offset);
+    }
+    if (table.error)
         goto end;
-    s = ngli_bstr_strdup(b);
+
+    const size_t params_offset = NGLI_BINSCENE_HEADER_SIZE + table.size;
+    const size_t payloads_offset = NGLI_ALIGN(params_offset + bs.params.size, NGLI_BINSCENE_ALIGN);
+    const size_t size = payloads_offset + bs.payloads.size;
+    data = ngli_malloc(size);
+    if (!data)
+        goto end;
+
+    struct binbuf header = {0};
+    bin_write(&header, NGLI_BINSCENE_MAGIC, 4);
+    bin_write_u32(&header, NGLI_BINSCENE_VERSION);
+    bin_write_u32(&header, NODEGL_VERSION_INT);
+    bin_write_u32(&header, nb_nodes);
+    bin_write_u64(&header, params_offset);
+    bin_write_u64(&header, payloads_offset);
+    if (header.error) {
+        ngli_free(data);
+        data = NULL;
+        goto end;
+    }
+    ngli_assert(header.size == NGLI_BINSCENE_HEADER_SIZE);
+
+    memcpy(data, header.data, header.size);
+    memcpy(data + NGLI_BINSCENE_HEADER_SIZE, table.data, table.size);
+    memcpy(data + params_offset, bs.params.data, bs.params.size);
+    memset(data + params_offset + bs.params.size, 0, payloads_offset - params_offset - bs.params.size);
+    memcpy(data + payloads_offset, bs.payloads.data, bs.payloads.size);
+    *sizep = size;
+    ngli_free(header.data);
 
 end:
-    ngli_hmap_freep(&nlist);
-    ngli_bstr_freep(&b);
-    return s;
+    ngli_hmap_freep(&bs.nlist);
+    ngli_hmap_freep(&bs.payload_offsets);
+    ngli_darray_reset(&nodes);
+    ngli_free(table.data);
+    ngli_free(bs.params.data);
+    ngli_free(bs.payloads.data);
+    return data;
 }
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+/*
+ * Binary scene format, all the fields being little-endian:
+ *
+ *   header:   "NGLB", version (u32), node.gl version (u32), nb_nodes (u32),
+ *             params offset (u64), payloads offset (u64)
+ *   nodes:    nb_nodes x {type (u32), nb_params (u32), offset (u64)}
+ *   params:   for each node, nb_params x {key (str), type (u32), value}
+ *   payloads: the PARAM_TYPE_DATA contents, each aligned on
+ *             NGLI_BINSCENE_ALIGN bytes; identical contents are stored once
+ *             and referenced by all the params holding them
+ *
+ * A str is its length (u32) followed by the characters and a nul byte, so
+ * it can be used in place. The node offsets are relative to the params
+ * section, the data offsets to the payloads section. The nodes are stored
+ * in dependency order, the last one being the root of the graph, and they
+ * can only reference the nodes preceding them.
+ *
+ * The param values are encoded as follows:
+ *   int, bool:             i32
+ *   i64:                   i64
+ *   double:                f64
+ *   rational:              2 x i32
+ *   str, select, flags:    str
+ *   data:                  offset (u64), size (u32)
+ *   vec2, vec3, vec4:      2, 3 or 4 x f32
+ *   mat4:                  16 x f32
+ *   node:                  node index (u32)
+ *   nodelist:              count (u32), count x node index (u32)
+ *   doublelist:            count (u32), count x f64
+ *   nodedict:              count (u32), count x {key (str), node index (u32)}
+ */
+
+#define NGLI_BINSCENE_MAGIC "NGLB"
+#define NGLI_BINSCENE_VERSION 1
+#define NGLI_BINSCENE_HEADER_SIZE 32
+#define NGLI_BINSCENE_NODE_SIZE 16
+#define NGLI_BINSCENE_ALIGN 16
+
+#endif
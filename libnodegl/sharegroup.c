@@ -0,0 +1,141 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "hmap.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "sharegroup.h"
+
+struct program_binary {
+    uint32_t format;
+    int size;
+    uint8_t data[];
+};
+
+struct ngl_share_group {
+    pthread_mutex_t lock;
+    int refcount;               // user reference and configured contexts, protected by lock
+    struct hmap *program_binaries;
+};
+
+static void free_program_binary(void *user_arg, void *data)
+{
+    ngli_free(data);
+}
+
+struct ngl_share_group *ngl_share_group_create(void)
+{
+    struct ngl_share_group *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+
+    s->program_binaries = ngli_hmap_create();
+    if (!s->program_binaries) {
+        ngli_free(s);
+        return NULL;
+    }
+    ngli_hmap_set_free(s->program_binaries, free_program_binary, NULL);
+
+    if (pthread_mutex_init(&s->lock, NULL)) {
+        ngli_hmap_freep(&s->program_binaries);
+        ngli_free(s);
+        return NULL;
+    }
+
+    s->refcount = 1;
+    return s;
+}
+
+struct ngl_share_group *ngli_share_group_ref(struct ngl_share_group *s)
+{
+    if (!s)
+        return NULL;
+
+    pthread_mutex_lock(&s->lock);
+    s->refcount++;
+    pthread_mutex_unlock(&s->lock);
+    return s;
+}
+
+void ngli_share_group_unrefp(struct ngl_share_group **sp)
+{
+    struct ngl_share_group *s = *sp;
+    if (!s)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    const int refcount = --s->refcount;
+    pthread_mutex_unlock(&s->lock);
+
+    if (!refcount) {
+        ngli_hmap_freep(&s->program_binaries);
+        pthread_mutex_destroy(&s->lock);
+        ngli_free(s);
+    }
+    *sp = NULL;
+}
+
+void ngl_share_group_freep(struct ngl_share_group **sp)
+{
+    ngli_share_group_unrefp(sp);
+}
+
+uint8_t *ngli_share_group_get_program_binary(struct ngl_share_group *s, const char *key,
+                                             uint32_t *format, int *size)
+{
+    uint8_t *data = NULL;
+
+    pthread_mutex_lock(&s->lock);
+    const struct program_binary *binary = ngli_hmap_get(s->program_binaries, key);
+    if (binary) {
+        data = ngli_malloc(binary->size);
+        if (data) {
+            memcpy(data, binary->data, binary->size);
+            *format = binary->format;
+            *size = binary->size;
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return data;
+}
+
+int ngli_share_group_add_program_binary(struct ngl_share_group *s, const char *key,
+                                        uint32_t format, const uint8_t *data, int size)
+{
+    struct program_binary *binary = ngli_malloc(sizeof(*binary) + size);
+    if (!binary)
+        return NGL_ERROR_MEMORY;
+    binary->format = format;
+    binary->size = size;
+    memcpy(binary->data, data, size);
+
+    pthread_mutex_lock(&s->lock);
+    int ret = ngli_hmap_set(s->program_binaries, key, binary);
+    pthread_mutex_unlock(&s->lock);
+
+    if (ret < 0)
+        ngli_free(binary);
+    return ret;
+}
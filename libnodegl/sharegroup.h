@@ -0,0 +1,52 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SHAREGROUP_H
+#define SHAREGROUP_H
+
+#include <stdint.h>
+
+#include "nodegl.h"
+
+/*
+ * Resources shared by the contexts configured with the same share group,
+ * which may render concurrently from their own threads. No GL object is
+ * shared: the contexts may live on different displays or devices, and the
+ * state of a GL program (such as its uniform values) would be raced on.
+ * Instead, the linked program binaries are kept in memory so each context
+ * loads them instead of compiling and linking the same shaders again.
+ */
+
+struct ngl_share_group *ngli_share_group_ref(struct ngl_share_group *s);
+void ngli_share_group_unrefp(struct ngl_share_group **sp);
+
+/*
+ * Copy the binary of the program identified by key into a newly allocated
+ * buffer. Return NULL if the group does not hold it.
+ */
+uint8_t *ngli_share_group_get_program_binary(struct ngl_share_group *s, const char *key,
+                                             uint32_t *format, int *size);
+
+/* Store a copy of the binary of the program identified by key */
+int ngli_share_group_add_program_binary(struct ngl_share_group *s, const char *key,
+                                        uint32_t format, const uint8_t *data, int size);
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "nodegl.h"
+#include "shelfpack.h"
+
+void ngli_shelfpack_init(struct shelfpack *s, int width, int height)
+{
+    ngli_darray_init(&s->shelves, sizeof(struct shelf), 0);
+    s->width = width;
+    s->height = height;
+    s->next_y = 0;
+}
+
+int ngli_shelfpack_alloc(struct shelfpack *s, int width, int height, int *x, int *y)
+{
+    if (width <= 0 || height <= 0 || width > s->width)
+        return NGL_ERROR_LIMIT_EXCEEDED;
+
+    /* Best fit: the lowest shelf able to hold the rectangle wastes the least */
+    struct shelf *best = NULL;
+    struct shelf *shelves = ngli_darray_data(&s->shelves);
+    for (int i = 0; i < ngli_darray_count(&s->shelves); i++) {
+        struct shelf *shelf = &shelves[i];
+        if (shelf->height >= height && shelf->x + width <= s->width &&
+            (!best || shelf->height < best->height))
+            best = shelf;
+    }
+
+    if (!best) {
+        if (s->next_y + height > s->height)
+            return NGL_ERROR_LIMIT_EXCEEDED;
+        const struct shelf shelf = {.y = s->next_y, .height = height};
+        best = ngli_darray_push(&s->shelves, &shelf);
+        if (!best)
+            return NGL_ERROR_MEMORY;
+        s->next_y += height;
+    }
+
+    *x = best->x;
+    *y = best->y;
+    best->x += width;
+    return 0;
+}
+
+void ngli_shelfpack_reset(struct shelfpack *s)
+{
+    ngli_darray_reset(&s->shelves);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SHELFPACK_H
+#define SHELFPACK_H
+
+#include "darray.h"
+
+struct shelf {
+    int y;
+    int height;
+    int x; /* first free column */
+};
+
+/*
+ * Allocator of rectangles in a fixed size area, arranged in horizontal
+ * shelves: a rectangle is placed at the end of the shelf of the closest
+ * height, or opens a new shelf below the last one. The space is never
+ * reclaimed, the whole area is expected to be released at once.
+ */
+struct shelfpack {
+    int width;
+    int height;
+    struct darray shelves;
+    int next_y; /* top of the next shelf */
+};
+
+void ngli_shelfpack_init(struct shelfpack *s, int width, int height);
+
+/*
+ * Allocate a rectangle of the given dimensions and return its position in
+ * x and y. Return NGL_ERROR_LIMIT_EXCEEDED if there is not enough space
+ * left.
+ */
+int ngli_shelfpack_alloc(struct shelfpack *s, int width, int height, int *x, int *y);
+
+void ngli_shelfpack_reset(struct shelfpack *s);
+
+#endif
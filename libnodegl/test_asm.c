@@ -19,12 +19,34 @@
  * under the License.
  */
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 #include "utils.h"
 #include "math_utils.h"
 
+#define BENCH_NB_RUNS 200000
+
+/*
+ * Time the C and the arch specific versions of a kernel. The output of each
+ * call is fed back as an input of the next one so the calls can not be
+ * optimized out or overlapped.
+ */
+#define BENCH(name, ref_call, out_call) do {                                \
+    int64_t t = ngli_gettime();                                             \
+    for (int r = 0; r < BENCH_NB_RUNS; r++) { ref_call; }                   \
+    const int64_t ref_time = ngli_gettime() - t;                            \
+    t = ngli_gettime();                                                     \
+    for (int r = 0; r < BENCH_NB_RUNS; r++) { out_call; }                   \
+    const int64_t out_time = ngli_gettime() - t;                            \
+    printf("%-12s c: %6.2fns arch: %6.2fns (x%.2f)\n", name,               \
+           ref_time * 1000. / BENCH_NB_RUNS,                                \
+           out_time * 1000. / BENCH_NB_RUNS,                                \
+           out_time ? (double)ref_time / out_time : 0.);                    \
+} while (0)
+
 static void flt_diff(float *dst, const float *a, const float *b, int size)
 {
     for (int i = 0; i < size; i++)
@@ -99,5 +121,121 @@ int main(void)
         }
     }
 
+    if (ngli_mix_f32_c != ngli_mix_f32) {
+        printf(":: Testing mix f32\n");
+
+        /* Not a multiple of the vector size to also cover the tail */
+        enum { N = 37 };
+        float v1[N], v2[N], f_ref[N], f_out[N] = {0}, f_diff[N];
+        for (int i = 0; i < N; i++) {
+            v1[i] = m1[i % 16] * (i + 1);
+            v2[i] = m2[i % 16] - i;
+        }
+
+        ngli_mix_f32_c(f_ref, v1, v2, 0.37f, N);
+        ngli_mix_f32(f_out, v1, v2, 0.37f, N);
+        flt_diff(f_diff, f_ref, f_out, N);
+        flt_check(f_diff, N);
+    }
+
+    if (ngli_mat3_inverse_c != ngli_mat3_inverse) {
+        printf(":: Testing mat3 inverse\n");
+
+        float m[3*3], m_ref[3*3], m_out[3*3], m_diff[3*3];
+        ngli_mat3_from_mat4(m, m1);
+        ngli_mat3_inverse_c(m_ref, m);
+        ngli_mat3_inverse(m_out, m);
+        flt_diff(m_diff, m_ref, m_out, 3*3);
+        flt_check(m_diff, 3*3);
+
+        /* In place, as done for the normal matrix */
+        ngli_mat3_inverse(m, m);
+        flt_diff(m_diff, m_ref, m, 3*3);
+        flt_check(m_diff, 3*3);
+
+        /* Singular matrix, which is returned as is */
+        static const float singular[3*3] = {1, 2, 3, 2, 4, 6, 0, 1, 0};
+        ngli_mat3_inverse(m_out, singular);
+        flt_diff(m_diff, singular, m_out, 3*3);
+        flt_check(m_diff, 3*3);
+    }
+
+    if (ngli_quat_slerp_c != ngli_quat_slerp) {
+        static const float quats[][2][4] = {
+            {{0.0f, 0.0f, 0.0f, 1.0f}, {0.70711f, 0.0f, 0.0f, 0.70711f}},
+            {{0.5f, 0.5f, 0.5f, 0.5f}, {-0.5f, -0.5f, 0.5f, -0.5f}},               // negative dot
+            {{0.0f, 0.0f, 0.0f, 1.0f}, {0.01f, 0.0f, 0.0f, 0.99995f}},            // close quaternions
+        };
+        for (int i = 0; i < NGLI_ARRAY_NB(quats); i++) {
+            for (int j = 0; j <= 4; j++) {
+                printf(":: Testing quat slerp %d/%d t=%g\n", i + 1, NGLI_ARRAY_NB(quats), j / 4.);
+                float q_ref[4], q_out[4], q_diff[4];
+                ngli_quat_slerp_c(q_ref, quats[i][0], quats[i][1], j / 4.f);
+                ngli_quat_slerp(q_out, quats[i][0], quats[i][1], j / 4.f);
+                flt_diff(q_diff, q_ref, q_out, 4);
+                flt_check(q_diff, 4);
+            }
+        }
+    }
+
+    if (ngli_pad_vec4_c != ngli_pad_vec4) {
+        /* Integers and NaN patterns must be copied untouched */
+        enum { N = 37 };
+        uint32_t src[N * 3];
+        for (int i = 0; i < N * 3; i++)
+            src[i] = i % 5 ? 0x7fc00001 + i : (uint32_t)i * 0x01020304;
+
+        for (int size = 4; size <= 12; size += 4) {
+            printf(":: Testing pad vec4 size=%d\n", size);
+            uint8_t p_ref[N * 16], p_out[N * 16];
+            memset(p_ref, 0xff, sizeof(p_ref));
+            memset(p_out, 0xff, sizeof(p_out));
+            ngli_pad_vec4_c(p_ref, src, size, N);
+            ngli_pad_vec4(p_out, src, size, N);
+            if (memcmp(p_ref, p_out, sizeof(p_ref))) {
+                fprintf(stderr, "padded data mismatch\n");
+                return 1;
+            }
+            for (int i = 0; i < N; i++) {
+                if (memcmp(p_ref + i * 16, (const uint8_t *)src + i * size, size)) {
+                    fprintf(stderr, "element %d/%d mismatch\n", i + 1, N);
+                    return 1;
+                }
+            }
+            printf("=> OK\n");
+        }
+    }
+
+    printf(":: Benchmarks\n");
+    {
+        NGLI_ALIGNED_MAT(m_ref);
+        NGLI_ALIGNED_MAT(m_out);
+        memcpy(m_ref, m2, sizeof(m_ref));
+        memcpy(m_out, m2, sizeof(m_out));
+        BENCH("mat4_mul", ngli_mat4_mul_c(m_ref, m1, m_ref), ngli_mat4_mul(m_out, m1, m_out));
+
+        NGLI_ALIGNED_VEC(v_ref) = {1.0f, 2.0f, 3.0f, 4.0f};
+        NGLI_ALIGNED_VEC(v_out) = {1.0f, 2.0f, 3.0f, 4.0f};
+        BENCH("mat4_mul_vec4", ngli_mat4_mul_vec4_c(v_ref, m1, v_ref), ngli_mat4_mul_vec4(v_out, m1, v_out));
+
+        float n_ref[3*3], n_out[3*3];
+        ngli_mat3_from_mat4(n_ref, m1);
+        ngli_mat3_from_mat4(n_out, m1);
+        BENCH("mat3_inverse", ngli_mat3_inverse_c(n_ref, n_ref), ngli_mat3_inverse(n_out, n_out));
+
+        float q_ref[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        float q_out[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        static const float q_dst[4] = {0.5f, 0.5f, 0.5f, 0.5f};
+        BENCH("quat_slerp", ngli_quat_slerp_c(q_ref, q_ref, q_dst, 0.1f), ngli_quat_slerp(q_out, q_out, q_dst, 0.1f));
+
+        enum { N = 1024 };
+        static float f1[N], f2[N], f_ref[N], f_out[N];
+        BENCH("mix_f32", ngli_mix_f32_c(f_ref, f1, f2, 0.37f, N), ngli_mix_f32(f_out, f1, f2, 0.37f, N));
+
+        static float p_ref[N * 4], p_out[N * 4];
+        BENCH("pad_vec4_4",  ngli_pad_vec4_c(p_ref, f_ref, 4,  N),     ngli_pad_vec4(p_out, f_out, 4,  N));
+        BENCH("pad_vec4_12", ngli_pad_vec4_c(p_ref, f_ref, 12, N / 3), ngli_pad_vec4(p_out, f_out, 12, N / 3));
+    }
+
     return 0;
 }
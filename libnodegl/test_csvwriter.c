@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L // mkstemp()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "csvwriter.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#define NB_ROWS 1000
+
+static char *read_file(const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+    ngli_assert(f);
+    static char buf[1 << 16];
+    const size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[n] = 0;
+    fclose(f);
+    return buf;
+}
+
+int main(void)
+{
+    char filename[] = "/tmp/ngl-test-csvwriter-XXXXXX";
+    const int fd = mkstemp(filename);
+    ngli_assert(fd != -1);
+    close(fd);
+
+    ngli_assert(!ngli_csvwriter_create(filename, "time,a,b", 2, 0));
+
+    /* The ring is large enough to never drop any row */
+    struct csvwriter *csvwriter = ngli_csvwriter_create(filename, "time,a,b", 2, NB_ROWS);
+    ngli_assert(csvwriter);
+    for (int i = 0; i < NB_ROWS; i++) {
+        const int64_t values[] = {i, -i * 1000000000LL};
+        ngli_assert(ngli_csvwriter_push(csvwriter, i / 2., values) == 0);
+    }
+    ngli_assert(ngli_csvwriter_close(&csvwriter) == 0);
+    ngli_assert(!csvwriter);
+
+    const char *p = read_file(filename);
+    ngli_assert(!strncmp(p, "time,a,b\n", 9));
+    p += 9;
+    for (int i = 0; i < NB_ROWS; i++) {
+        char line[64];
+        snprintf(line, sizeof(line), "\"%f\",%d,%lld\n", i / 2., i, -i * 1000000000LL);
+        ngli_assert(!strncmp(p, line, strlen(line)));
+        p += strlen(line);
+    }
+    ngli_assert(!*p);
+
+    /* The rows pushed while the ring is full are dropped, never waited for */
+    csvwriter = ngli_csvwriter_create(filename, "time,a", 1, 4);
+    ngli_assert(csvwriter);
+    int nb_pushed = 0;
+    for (int i = 0; i < NB_ROWS; i++) {
+        const int64_t value = i;
+        nb_pushed += ngli_csvwriter_push(csvwriter, i, &value) == 0;
+    }
+    const int nb_dropped = ngli_csvwriter_close(&csvwriter);
+    ngli_assert(nb_dropped == NB_ROWS - nb_pushed);
+
+    int nb_lines = 0;
+    for (p = read_file(filename); *p; p++)
+        nb_lines += *p == '\n';
+    ngli_assert(nb_lines == 1 + nb_pushed);
+
+    unlink(filename);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "damage.h"
+#include "utils.h"
+
+static const int viewport[4] = {0, 0, 640, 480};
+static const int background[4] = {0, 0, 640, 480};
+static const int overlay[4] = {10, 20, 100, 50};
+static const int moved_overlay[4] = {30, 20, 100, 50};
+
+static int check_rect(const char *name, const int *rect, const int *expected)
+{
+    if (memcmp(rect, expected, 4 * sizeof(*rect))) {
+        fprintf(stderr, "%s: got %d,%d %dx%d instead of %d,%d %dx%d\n", name,
+                rect[0], rect[1], rect[2], rect[3],
+                expected[0], expected[1], expected[2], expected[3]);
+        return 0;
+    }
+    return 1;
+}
+
+static void draw_frame(struct damage *s, const int *overlay_rect, int overlay_changed)
+{
+    ngli_assert(ngli_damage_add_draw(s, background, background, 0) == 0);
+    if (overlay_rect)
+        ngli_assert(ngli_damage_add_draw(s, overlay, overlay_rect, overlay_changed) == 0);
+    ngli_damage_end_frame(s, viewport);
+}
+
+int main(void)
+{
+    struct damage s;
+    ngli_damage_init(&s);
+
+    int rect[4];
+
+    /* The first frame is always fully damaged */
+    draw_frame(&s, overlay, 1);
+    ngli_assert(check_rect("first frame", s.rect, viewport));
+    ngli_assert(ngli_damage_get_region(&s, 1, rect) == 0);
+
+    /* Only the changed overlay is damaged */
+    draw_frame(&s, overlay, 1);
+    ngli_assert(check_rect("changed overlay", s.rect, overlay));
+    ngli_assert(ngli_damage_get_region(&s, 1, rect) == 1);
+    ngli_assert(check_rect("changed overlay region", rect, overlay));
+
+    /* Nothing changed */
+    draw_frame(&s, overlay, 0);
+    static const int empty[4] = {0};
+    ngli_assert(check_rect("static frame", s.rect, empty));
+
+    /* A buffer 3 frames old also misses the changed overlay */
+    ngli_assert(ngli_damage_get_region(&s, 2, rect) == 1);
+    ngli_assert(check_rect("age 2 region", rect, overlay));
+    ngli_assert(ngli_damage_get_region(&s, 3, rect) == 0);
+    ngli_assert(ngli_damage_get_region(&s, 0, rect) == 0);
+    ngli_assert(ngli_damage_get_region(&s, NGLI_DAMAGE_HISTORY + 1, rect) == 0);
+
+    /* A moving overlay damages both its previous and current areas */
+    draw_frame(&s, moved_overlay, 0);
+    static const int moved[4] = {10, 20, 120, 50};
+    ngli_assert(check_rect("moved overlay", s.rect, moved));
+
+    /* A disappearing overlay damages its previous area */
+    draw_frame(&s, NULL, 0);
+    ngli_assert(check_rect("disappeared overlay", s.rect, moved_overlay));
+
+    /* A full damage is requested */
+    ngli_damage_set_full(&s);
+    draw_frame(&s, NULL, 0);
+    ngli_assert(check_rect("full frame", s.rect, viewport));
+
+    /* The content of the buffers is lost */
+    ngli_damage_invalidate(&s);
+    draw_frame(&s, overlay, 1);
+    ngli_assert(ngli_damage_get_region(&s, 1, rect) == 1);
+    ngli_assert(ngli_damage_get_region(&s, 2, rect) == 0);
+
+    /* A box projected with an identity matrix covers the whole viewport */
+    static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    static const float box_min[3] = {-.5f, -.5f, 0.f};
+    static const float box_max[3] = { .5f,  .5f, 0.f};
+    ngli_assert(ngli_damage_project_box(identity, box_min, box_max, viewport, rect) == 1);
+    static const int projected[4] = {159, 119, 322, 242};
+    ngli_assert(check_rect("projected box", rect, projected));
+
+    /* A box crossing the plane of the eye can not be projected */
+    static const float perspective[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, -1, 0, 0, 0, 0};
+    static const float crossing_min[3] = {-1.f, -1.f, -1.f};
+    static const float crossing_max[3] = { 1.f,  1.f,  1.f};
+    ngli_assert(ngli_damage_project_box(perspective, crossing_min, crossing_max, viewport, rect) == 0);
+
+    ngli_damage_reset(&s);
+    return 0;
+}
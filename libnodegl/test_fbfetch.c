@@ -0,0 +1,121 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fbfetch.h"
+#include "glcontext.h"
+#include "memory.h"
+#include "utils.h"
+
+static int count_occurrences(const char *s, const char *needle)
+{
+    int n = 0;
+    while ((s = strstr(s, needle))) {
+        s += strlen(needle);
+        n++;
+    }
+    return n;
+}
+
+static const char shader_es2[] =
+    "#version 100\n"
+    "precision highp float;\n"
+    "uniform float opacity;\n"
+    "void main(void)\n"
+    "{\n"
+    "    gl_FragColor = ngl_framebuffer_fetch() * opacity;\n"
+    "}\n";
+
+static const char shader_es3[] =
+    "#version 300 es\n"
+    "in vec2 uv;\n"
+    "layout(location = 0) out mediump vec4 color;\n"
+    "vec4 invert(vec4 c, out float a) { a = c.a; return vec4(1.0 - c.rgb, a); }\n"
+    "void main(void)\n"
+    "{\n"
+    "    float a;\n"
+    "    color = vec4(0.0);\n"
+    "    color += invert(ngl_framebuffer_fetch(), a);\n"
+    "}\n";
+
+static char *preprocess(uint64_t features, const char *src)
+{
+    struct glcontext gl = {.version = 300, .features = features};
+    char *dst;
+    ngli_assert(ngli_fbfetch_preprocess(&gl, src, &dst) == 0);
+    ngli_assert(dst);
+    printf("%s\n", dst);
+    return dst;
+}
+
+int main(void)
+{
+    const struct glcontext gl = {.version = 300};
+    char *dst;
+
+    ngli_assert(!ngli_fbfetch_is_used("void main(void) { ngl_framebuffer_fetch_foo(); }"));
+    ngli_assert(ngli_fbfetch_preprocess(&gl, "void main(void) { ngl_framebuffer_fetch_foo(); }", &dst) == 0);
+    ngli_assert(!dst);
+
+    /* Native fetch on GLSL versions without fragment outputs */
+    dst = preprocess(NGLI_FEATURE_SHADER_FRAMEBUFFER_FETCH, shader_es2);
+    ngli_assert(!strncmp(dst, "#version 100\n#extension GL_EXT_shader_framebuffer_fetch : require\n",
+                         strlen("#version 100\n#extension GL_EXT_shader_framebuffer_fetch : require\n")));
+    ngli_assert(count_occurrences(dst, "#define ngl_framebuffer_fetch() gl_LastFragData[0]\n") == 1);
+    ngli_assert(count_occurrences(dst, "uniform sampler2D ngl_framebuffer;") == 0);
+    ngli_assert(count_occurrences(dst, "precision mediump float;") == 0);
+    ngli_free(dst);
+
+    /* Native fetch through the fragment output, saved before the user main function */
+    dst = preprocess(NGLI_FEATURE_SHADER_FRAMEBUFFER_FETCH, shader_es3);
+    ngli_assert(count_occurrences(dst, "#extension GL_EXT_shader_framebuffer_fetch : require\n") == 1);
+    ngli_assert(count_occurrences(dst, "layout(location = 0) inout mediump vec4 color;") == 1);
+    ngli_assert(count_occurrences(dst, ", out float a)") == 1);
+    ngli_assert(count_occurrences(dst, "void ngli_fbfetch_main(void)") == 1);
+    ngli_assert(count_occurrences(dst, "ngli_framebuffer_color = color;\n    ngli_fbfetch_main();") == 1);
+    ngli_assert(count_occurrences(dst, "precision mediump float;") == 1);
+    ngli_assert(strstr(dst, "#define ngl_framebuffer_fetch()") < strstr(dst, "void ngli_fbfetch_main("));
+    ngli_free(dst);
+
+    /* Fallback on a copy of the render target */
+    dst = preprocess(0, shader_es2);
+    ngli_assert(count_occurrences(dst, "#extension") == 0);
+    ngli_assert(count_occurrences(dst, "uniform sampler2D ngl_framebuffer;") == 1);
+    ngli_assert(count_occurrences(dst, "uniform vec2 ngl_framebuffer_scale;") == 1);
+    ngli_assert(count_occurrences(dst, "texelFetch(") == 0);
+    ngli_free(dst);
+
+    dst = preprocess(0, shader_es3);
+    ngli_assert(count_occurrences(dst, "uniform sampler2D ngl_framebuffer;") == 1);
+    ngli_assert(count_occurrences(dst, "ngl_framebuffer_scale") == 0);
+    ngli_assert(count_occurrences(dst, "texelFetch(ngl_framebuffer, ivec2(gl_FragCoord.xy), 0)") == 1);
+    ngli_assert(count_occurrences(dst, "inout") == 0);
+    ngli_free(dst);
+
+    /* A fragment output is required to fetch its previous color */
+    const struct glcontext gl_fetch = {.version = 300, .features = NGLI_FEATURE_SHADER_FRAMEBUFFER_FETCH};
+    ngli_assert(ngli_fbfetch_preprocess(&gl_fetch, "#version 300 es\nvoid main(void) { ngl_framebuffer_fetch(); }", &dst) < 0);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L // mkdtemp()
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "framecache.h"
+#include "memory.h"
+#include "utils.h"
+
+#define FRAME_SIZE 1000
+
+static int count_frames(const char *path)
+{
+    DIR *dir = opendir(path);
+    ngli_assert(dir);
+    int nb_frames = 0;
+    struct dirent *dirent;
+    while ((dirent = readdir(dir)))
+        nb_frames += !!strstr(dirent->d_name, ".frame");
+    closedir(dir);
+    return nb_frames;
+}
+
+static void remove_frames(const char *path)
+{
+    DIR *dir = opendir(path);
+    ngli_assert(dir);
+    struct dirent *dirent;
+    while ((dirent = readdir(dir))) {
+        if (dirent->d_name[0] == '.')
+            continue;
+        char *file = ngli_asprintf("%s/%s", path, dirent->d_name);
+        ngli_assert(file);
+        unlink(file);
+        ngli_free(file);
+    }
+    closedir(dir);
+}
+
+int main(void)
+{
+    char path[] = "/tmp/ngl-test-framecache-XXXXXX";
+    ngli_assert(mkdtemp(path));
+
+    struct arena *scratch = ngli_arena_create(4096, NGLI_MEMTAG_DRAWING);
+    ngli_assert(scratch);
+
+    struct framecache framecache = {0};
+    ngli_assert(ngli_framecache_init(&framecache, "/nonexistent/ngl-framecache", 1 << 20, scratch) < 0);
+    ngli_framecache_reset(&framecache);
+
+    /* Room for 3 frames and their headers */
+    const int64_t max_size = 3 * (FRAME_SIZE + 64);
+    ngli_assert(ngli_framecache_init(&framecache, path, max_size, scratch) == 0);
+
+    uint8_t frame[FRAME_SIZE];
+    uint8_t loaded[FRAME_SIZE];
+    char *keys[4];
+    for (int i = 0; i < NGLI_ARRAY_NB(keys); i++) {
+        keys[i] = ngli_framecache_get_key(scratch, 0x1234, i / 10., 16, 16, 0);
+        ngli_assert(keys[i]);
+    }
+
+    /* Different scenes, times and dimensions get different keys */
+    const char *key = ngli_framecache_get_key(scratch, 0x1235, 0, 16, 16, 0);
+    ngli_assert(strcmp(key, keys[0]));
+    key = ngli_framecache_get_key(scratch, 0x1234, 0, 16, 8, 0);
+    ngli_assert(strcmp(key, keys[0]));
+
+    ngli_assert(!ngli_framecache_load(&framecache, keys[0], loaded, FRAME_SIZE));
+    for (int i = 0; i < 3; i++) {
+        memset(frame, i, sizeof(frame));
+        ngli_assert(ngli_framecache_store(&framecache, keys[i], frame, FRAME_SIZE) == 0);
+    }
+    ngli_assert(count_frames(path) == 3);
+
+    ngli_assert(ngli_framecache_load(&framecache, keys[1], loaded, FRAME_SIZE));
+    memset(frame, 1, sizeof(frame));
+    ngli_assert(!memcmp(loaded, frame, FRAME_SIZE));
+
+    /* The least recently used frame (keys[0]) is evicted */
+    memset(frame, 3, sizeof(frame));
+    ngli_assert(ngli_framecache_store(&framecache, keys[3], frame, FRAME_SIZE) == 0);
+    ngli_assert(count_frames(path) <= 3);
+    ngli_assert(!ngli_framecache_load(&framecache, keys[0], loaded, FRAME_SIZE));
+    ngli_assert(ngli_framecache_load(&framecache, keys[1], loaded, FRAME_SIZE));
+    ngli_assert(ngli_framecache_load(&framecache, keys[3], loaded, FRAME_SIZE));
+    ngli_assert(!memcmp(loaded, frame, FRAME_SIZE));
+    ngli_framecache_reset(&framecache);
+
+    /* The frames are found again by a later session */
+    ngli_assert(ngli_framecache_init(&framecache, path, max_size, scratch) == 0);
+    ngli_assert(ngli_framecache_load(&framecache, keys[3], loaded, FRAME_SIZE));
+    ngli_assert(!memcmp(loaded, frame, FRAME_SIZE));
+
+    /* A frame not matching the expected size is discarded */
+    ngli_assert(!ngli_framecache_load(&framecache, keys[1], loaded, FRAME_SIZE / 2));
+    ngli_assert(!ngli_framecache_load(&framecache, keys[1], loaded, FRAME_SIZE));
+    ngli_assert(count_frames(path) == 2);
+
+    /* A frame larger than the cache is never stored */
+    uint8_t *large_frame = ngli_calloc(1, max_size);
+    ngli_assert(large_frame);
+    ngli_assert(ngli_framecache_store(&framecache, keys[0], large_frame, max_size) == 0);
+    ngli_assert(!ngli_framecache_load(&framecache, keys[0], large_frame, max_size));
+    ngli_free(large_frame);
+    ngli_framecache_reset(&framecache);
+
+    ngli_arena_unrefp(&scratch);
+    remove_frames(path);
+    rmdir(path);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "framepacer.h"
+#include "utils.h"
+
+#define PERIOD 16667
+
+int main(void)
+{
+    struct framepacer s;
+    ngli_framepacer_init(&s);
+
+    ngli_assert(ngli_framepacer_predict(&s, 1000) == 1000);
+
+    /* Presentations on every refresh, with a slight jitter */
+    int64_t vsync = 1000000;
+    for (int i = 0; i < 20; i++) {
+        const int64_t jitter = (i % 3) * 50;
+        ngli_framepacer_add(&s, vsync - 4000, vsync + jitter);
+        vsync += PERIOD;
+    }
+    ngli_assert(s.period >= PERIOD - 100 && s.period <= PERIOD + 100);
+    ngli_assert(s.nb_late_frames == 0);
+    ngli_assert(s.nb_dropped_frames == 0);
+
+    /* A frame missing 2 refreshes is reported and does not bias the period */
+    vsync += 2 * PERIOD;
+    ngli_framepacer_add(&s, vsync - 4000, vsync);
+    ngli_assert(s.nb_late_frames == 1);
+    ngli_assert(s.nb_dropped_frames == 2);
+    ngli_assert(s.period >= PERIOD - 100 && s.period <= PERIOD + 100);
+
+    /* A draw starting now is presented on the next refresh */
+    const int64_t predicted = ngli_framepacer_predict(&s, vsync + 1000);
+    if (llabs(predicted - (vsync + s.period)) > 100) {
+        fprintf(stderr, "predicted %lld instead of %lld\n",
+                (long long)predicted, (long long)(vsync + s.period));
+        return EXIT_FAILURE;
+    }
+
+    /* A draw too long for the next refresh is presented on the one after */
+    const int64_t late = ngli_framepacer_predict(&s, vsync + PERIOD - 1000);
+    ngli_assert(late == vsync + 2 * s.period);
+
+    /* Pausing the drawing is not a late frame */
+    ngli_framepacer_add(&s, vsync + 2000000 - 4000, vsync + 2000000);
+    ngli_assert(s.nb_late_frames == 1);
+
+    return 0;
+}
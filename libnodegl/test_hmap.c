@@ -19,6 +19,9 @@
  * under the License.
  */
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define HMAP_SIZE_NBIT 1
@@ -41,6 +44,98 @@ static void free_func(void *arg, void *data)
     ngli_free(data);
 }
 
+#define NB_KEYS 1000
+
+/*
+ * Random additions, replacements and deletions, checked against a plain
+ * array holding the expected value of every key
+ */
+static void stress_test(void)
+{
+    static void *ref[NB_KEYS];
+    char key[32];
+
+    struct hmap *hm = ngli_hmap_create();
+    ngli_assert(hm);
+
+    srand(0);
+    for (int i = 0; i < 100000; i++) {
+        const int k = rand() % NB_KEYS;
+        snprintf(key, sizeof(key), "key%d", k);
+        void *data = rand() % 3 ? (void *)(intptr_t)(i + 1) : NULL;
+        const int ret = ngli_hmap_set(hm, key, data);
+        ngli_assert(ret >= 0);
+        ngli_assert(data || ret == !!ref[k]);
+        ref[k] = data;
+    }
+
+    int count = 0;
+    for (int k = 0; k < NB_KEYS; k++) {
+        snprintf(key, sizeof(key), "key%d", k);
+        ngli_assert(ngli_hmap_get(hm, key) == ref[k]);
+        ngli_assert(ngli_hmap_get_h(hm, key, ngli_hmap_hash(key)) == ref[k]);
+        count += !!ref[k];
+    }
+    ngli_assert(ngli_hmap_count(hm) == count);
+
+    const struct hmap_entry *e = NULL;
+    while ((e = ngli_hmap_next(hm, e))) {
+        ngli_assert(e->hash == ngli_hmap_hash(e->key));
+        ngli_assert(ref[atoi(e->key + 3)] == e->data);
+        count--;
+    }
+    ngli_assert(count == 0);
+
+    ngli_hmap_freep(&hm);
+}
+
+#define BENCH_NB_KEYS 64
+#define BENCH_NB_RUNS 100000
+
+static void benchmark(void)
+{
+    char keys[BENCH_NB_KEYS][32];
+    uint32_t hashes[BENCH_NB_KEYS];
+
+    struct hmap *hm = ngli_hmap_create();
+    ngli_assert(hm);
+    for (int i = 0; i < BENCH_NB_KEYS; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "ngl_uniform_name_%d", i);
+        hashes[i] = ngli_hmap_hash(keys[i]);
+        ngli_assert(ngli_hmap_set(hm, keys[i], keys[i]) >= 0);
+    }
+
+    int64_t t = ngli_gettime();
+    for (int r = 0; r < BENCH_NB_RUNS; r++)
+        for (int i = 0; i < BENCH_NB_KEYS; i++)
+            ngli_assert(ngli_hmap_get(hm, keys[i]) == keys[i]);
+    const int64_t get_time = ngli_gettime() - t;
+
+    t = ngli_gettime();
+    for (int r = 0; r < BENCH_NB_RUNS; r++)
+        for (int i = 0; i < BENCH_NB_KEYS; i++)
+            ngli_assert(ngli_hmap_get_h(hm, keys[i], hashes[i]) == keys[i]);
+    const int64_t get_h_time = ngli_gettime() - t;
+
+    t = ngli_gettime();
+    for (int r = 0; r < BENCH_NB_RUNS / 100; r++) {
+        struct hmap *tmp = ngli_hmap_create();
+        ngli_assert(tmp);
+        for (int i = 0; i < BENCH_NB_KEYS; i++)
+            ngli_assert(ngli_hmap_set(tmp, keys[i], keys[i]) >= 0);
+        ngli_hmap_freep(&tmp);
+    }
+    const int64_t build_time = ngli_gettime() - t;
+
+    const double nb_lookups = (double)BENCH_NB_RUNS * BENCH_NB_KEYS;
+    printf("benchmark [%d keys]:\n", BENCH_NB_KEYS);
+    printf("  get:   %.1fns/lookup\n", get_time * 1000. / nb_lookups);
+    printf("  get_h: %.1fns/lookup\n", get_h_time * 1000. / nb_lookups);
+    printf("  build: %" PRId64 "us/map\n", build_time / (BENCH_NB_RUNS / 100));
+
+    ngli_hmap_freep(&hm);
+}
+
 int main(void)
 {
     static const struct {
@@ -90,5 +185,8 @@ int main(void)
         ngli_hmap_freep(&hm);
     }
 
+    stress_test();
+    benchmark();
+
     return 0;
 }
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L // mkdtemp(), nanosleep()
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "imagecache.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#define NB_THREADS 8
+#define SIZE 4 /* 4x4 RGBA images of 64 bytes */
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int nb_decodes;
+static int nb_freed_privs;
+
+/* The first byte of the file is the value of the pixels, 0 fails the decoding */
+static int decode(void *arg, const char *filename, struct imagecache_image *image)
+{
+    pthread_mutex_lock(&lock);
+    nb_decodes++;
+    pthread_mutex_unlock(&lock);
+
+    /* Leave the time to the other threads to look the image up */
+    const struct timespec delay = {.tv_nsec = 10 * 1000 * 1000};
+    nanosleep(&delay, NULL);
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+        return NGL_ERROR_IO;
+    const int value = fgetc(fp);
+    fclose(fp);
+    if (value <= 0)
+        return NGL_ERROR_INVALID_DATA;
+
+    image->width = image->height = SIZE;
+    image->bytes_per_pixel = 4;
+    image->data = ngli_malloc(SIZE * SIZE * 4);
+    if (!image->data)
+        return NGL_ERROR_MEMORY;
+    memset(image->data, value, SIZE * SIZE * 4);
+    return 0;
+}
+
+static void free_priv(void *user_arg, void *priv)
+{
+    nb_freed_privs++;
+    ngli_free(priv);
+}
+
+static void write_file(const char *filename, const char *content)
+{
+    FILE *fp = fopen(filename, "wb");
+    ngli_assert(fp);
+    fputs(content, fp);
+    ngli_assert(!fclose(fp));
+}
+
+struct lookup {
+    struct imagecache *cache;
+    const char *filename;
+    struct imagecache_entry *entry;
+};
+
+static void *lookup_thread(void *arg)
+{
+    struct lookup *lookup = arg;
+    int ret = ngli_imagecache_get(lookup->cache, lookup->filename, NULL, decode, NULL, &lookup->entry);
+    ngli_assert(ret == 0);
+    return NULL;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/ngl-test-imagecache-XXXXXX";
+    ngli_assert(mkdtemp(path));
+    char *filename_a = ngli_asprintf("%s/a", path);
+    char *filename_b = ngli_asprintf("%s/b", path);
+    char *filename_c = ngli_asprintf("%s/c", path);
+    ngli_assert(filename_a && filename_b && filename_c);
+    write_file(filename_a, "a");
+    write_file(filename_b, "b");
+    write_file(filename_c, "");
+
+    /* Room for a single unused image */
+    struct imagecache cache = {0};
+    ngli_assert(ngli_imagecache_init(&cache, 100, free_priv, NULL) == 0);
+
+    /* Concurrent lookups of the same image only decode it once */
+    pthread_t tids[NB_THREADS];
+    struct lookup lookups[NB_THREADS];
+    for (int i = 0; i < NB_THREADS; i++) {
+        lookups[i] = (struct lookup){.cache = &cache, .filename = filename_a};
+        ngli_assert(!pthread_create(&tids[i], NULL, lookup_thread, &lookups[i]));
+    }
+    for (int i = 0; i < NB_THREADS; i++)
+        pthread_join(tids[i], NULL);
+    ngli_assert(nb_decodes == 1);
+    const struct imagecache_entry *shared_entry = lookups[0].entry;
+    for (int i = 0; i < NB_THREADS; i++) {
+        ngli_assert(lookups[i].entry == shared_entry);
+        ngli_assert(lookups[i].entry->image.data[0] == 'a');
+        ngli_imagecache_release(&cache, &lookups[i].entry);
+        ngli_assert(!lookups[i].entry);
+    }
+
+    /* The image is kept once unused */
+    struct imagecache_entry *entry_a = NULL;
+    ngli_assert(ngli_imagecache_get(&cache, filename_a, NULL, decode, NULL, &entry_a) == 0);
+    ngli_assert(nb_decodes == 1);
+
+    /* but not with other decoding options */
+    struct imagecache_entry *entry = NULL;
+    ngli_assert(ngli_imagecache_get(&cache, filename_a, "opt", decode, NULL, &entry) == 0);
+    ngli_assert(nb_decodes == 2 && entry != entry_a);
+    ngli_imagecache_release(&cache, &entry);
+
+    /* The private object is released with the entry, or dropped once unreferenced */
+    ngli_assert(!ngli_imagecache_ref_priv(&cache, entry_a));
+    entry_a->priv = ngli_malloc(1);
+    ngli_assert(!ngli_imagecache_drop_priv(&cache));
+    ngli_imagecache_unref_priv(&cache, entry_a);
+    ngli_assert(ngli_imagecache_drop_priv(&cache) == 1);
+    ngli_assert(!entry_a->priv && nb_freed_privs == 1);
+    entry_a->priv = ngli_malloc(1);
+    ngli_imagecache_release(&cache, &entry_a);
+
+    /* The least recently used images are evicted beyond the maximum size */
+    struct imagecache_entry *entry_b = NULL;
+    ngli_assert(ngli_imagecache_get(&cache, filename_b, NULL, decode, NULL, &entry_b) == 0);
+    ngli_assert(nb_decodes == 3 && entry_b->image.data[0] == 'b');
+    ngli_imagecache_release(&cache, &entry_b);
+    ngli_assert(nb_freed_privs == 2);
+    ngli_assert(ngli_imagecache_get(&cache, filename_a, NULL, decode, NULL, &entry_a) == 0);
+    ngli_assert(nb_decodes == 4);
+    ngli_imagecache_release(&cache, &entry_a);
+
+    /* A modified file is decoded again */
+    write_file(filename_a, "aa");
+    ngli_assert(ngli_imagecache_get(&cache, filename_a, NULL, decode, NULL, &entry_a) == 0);
+    ngli_assert(nb_decodes == 5);
+    ngli_imagecache_release(&cache, &entry_a);
+
+    /* The failures are not cached */
+    ngli_assert(ngli_imagecache_get(&cache, filename_c, NULL, decode, NULL, &entry) == NGL_ERROR_INVALID_DATA);
+    ngli_assert(ngli_imagecache_get(&cache, filename_c, NULL, decode, NULL, &entry) == NGL_ERROR_INVALID_DATA);
+    ngli_assert(nb_decodes == 7 && !entry);
+    ngli_assert(ngli_imagecache_get(&cache, path, NULL, decode, NULL, &entry) < 0);
+    ngli_assert(ngli_imagecache_get(&cache, "/nonexistent", NULL, decode, NULL, &entry) == NGL_ERROR_IO);
+
+    ngli_imagecache_reset(&cache);
+
+    unlink(filename_a);
+    unlink(filename_b);
+    unlink(filename_c);
+    rmdir(path);
+    ngli_free(filename_a);
+    ngli_free(filename_b);
+    ngli_free(filename_c);
+    return 0;
+}
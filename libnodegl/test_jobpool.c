@@ -0,0 +1,83 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "jobpool.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#define NB_JOBS 1000
+
+static int fill_job(void *arg, int index)
+{
+    int *values = arg;
+    values[index] += index;
+    return 0;
+}
+
+static int fail_job(void *arg, int index)
+{
+    int *values = arg;
+    values[index]++;
+    return index == NB_JOBS / 2 ? NGL_ERROR_INVALID_ARG : 0;
+}
+
+int main(void)
+{
+    ngli_assert(!ngli_jobpool_create(0, 0, 0));
+
+    for (int nb_threads = 1; nb_threads <= 8; nb_threads *= 2) {
+        struct jobpool *jobpool = ngli_jobpool_create(nb_threads, 0, 0);
+        ngli_assert(jobpool);
+        ngli_assert(ngli_jobpool_get_nb_threads(jobpool) == nb_threads);
+
+        int values[NB_JOBS] = {0};
+        for (int run = 0; run < 10; run++) {
+            const int nb_jobs = run * NB_JOBS / 9;
+            memset(values, 0, sizeof(values));
+            int ret = ngli_jobpool_run(jobpool, fill_job, values, nb_jobs);
+            ngli_assert(ret == 0);
+            for (int i = 0; i < NB_JOBS; i++)
+                ngli_assert(values[i] == (i < nb_jobs ? i : 0));
+        }
+
+        /* The batch runs in the background until the wait */
+        memset(values, 0, sizeof(values));
+        ngli_jobpool_start(jobpool, fill_job, values, NB_JOBS);
+        ngli_assert(ngli_jobpool_wait(jobpool) == 0);
+        ngli_assert(ngli_jobpool_wait(jobpool) == 0);
+        for (int i = 0; i < NB_JOBS; i++)
+            ngli_assert(values[i] == i);
+
+        /* An error does not prevent the other jobs from running */
+        memset(values, 0, sizeof(values));
+        int ret = ngli_jobpool_run(jobpool, fail_job, values, NB_JOBS);
+        ngli_assert(ret == NGL_ERROR_INVALID_ARG);
+        for (int i = 0; i < NB_JOBS; i++)
+            ngli_assert(values[i] == 1);
+
+        ngli_jobpool_freep(&jobpool);
+        ngli_assert(!jobpool);
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "format.h"
+#include "ktx.h"
+#include "nodegl.h"
+#include "utils.h"
+
+static uint8_t *write_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8 & 0xff;
+    p[2] = v >> 16 & 0xff;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+static uint8_t *write_u64(uint8_t *p, uint64_t v)
+{
+    p = write_u32(p, v & 0xffffffff);
+    return write_u32(p, v >> 32);
+}
+
+/* 8x8 ETC2 RGB image with 4 levels: 4x8, 8, 8 and 8 bytes */
+static int make_ktx1(uint8_t *buf, int nb_levels)
+{
+    static const uint8_t id[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    static const uint8_t kvd[8] = "key\0val";
+    const uint32_t header[13] = {0x04030201, 0, 1, 0, GL_COMPRESSED_RGB8_ETC2, GL_RGB,
+                                 8, 8, 0, 0, 1, nb_levels, sizeof(kvd)};
+    uint8_t *p = buf;
+    memcpy(p, id, sizeof(id));
+    p += sizeof(id);
+    for (int i = 0; i < NGLI_ARRAY_NB(header); i++)
+        p = write_u32(p, header[i]);
+    memcpy(p, kvd, sizeof(kvd));
+    p += sizeof(kvd);
+    for (int i = 0; i < NGLI_MAX(nb_levels, 1); i++) {
+        const int size = i ? 8 : 32;
+        p = write_u32(p, size);
+        memset(p, i, size);
+        p += size;
+    }
+    return p - buf;
+}
+
+/* 10x10 ASTC 4x4 image with 2 levels: 9x16 and 4x16 bytes */
+static int make_ktx2(uint8_t *buf, uint32_t supercompression)
+{
+    static const uint8_t id[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    const uint32_t header[9] = {157, 1, 10, 10, 0, 0, 1, 2, supercompression};
+    const int data_offset = 12 + 13 * 4 + 2 * 8 + 2 * 3 * 8;
+    uint8_t *p = buf;
+    memcpy(p, id, sizeof(id));
+    p += sizeof(id);
+    for (int i = 0; i < NGLI_ARRAY_NB(header); i++)
+        p = write_u32(p, header[i]);
+    for (int i = 0; i < 4; i++)
+        p = write_u32(p, 0);
+    p = write_u64(p, 0);
+    p = write_u64(p, 0);
+    /* KTX2 stores the smallest level first */
+    p = write_u64(p, data_offset + 4 * 16);
+    p = write_u64(p, 9 * 16);
+    p = write_u64(p, 0);
+    p = write_u64(p, data_offset);
+    p = write_u64(p, 4 * 16);
+    p = write_u64(p, 0);
+    memset(p, 1, 4 * 16);
+    memset(p + 4 * 16, 0, 9 * 16);
+    return p + 13 * 16 - buf;
+}
+
+int main(void)
+{
+    uint8_t buf[1024];
+    struct ktx ktx;
+
+    ngli_assert(!ngli_ktx_probe((const uint8_t *)"KTX", 3));
+
+    int size = make_ktx1(buf, 4);
+    ngli_assert(ngli_ktx_probe(buf, size));
+    ngli_assert(ngli_ktx_parse(&ktx, buf, size) == 0);
+    ngli_assert(ktx.format == NGLI_FORMAT_ETC2_R8G8B8_UNORM_BLOCK);
+    ngli_assert(ktx.width == 8 && ktx.height == 8 && ktx.nb_levels == 4);
+    for (int i = 0; i < ktx.nb_levels; i++) {
+        ngli_assert(ktx.levels[i].size == (i ? 8 : 32));
+        ngli_assert(ktx.levels[i].data[0] == i);
+    }
+    ngli_assert(ngli_ktx_parse(&ktx, buf, size - 1) == NGL_ERROR_INVALID_DATA);
+    ngli_assert(ngli_ktx_parse(&ktx, buf, 40) == NGL_ERROR_INVALID_DATA);
+
+    size = make_ktx1(buf, 0);
+    ngli_assert(ngli_ktx_parse(&ktx, buf, size) == 0);
+    ngli_assert(ktx.nb_levels == 1 && ktx.levels[0].size == 32);
+
+    size = make_ktx2(buf, 0);
+    ngli_assert(ngli_ktx_probe(buf, size));
+    ngli_assert(ngli_ktx_parse(&ktx, buf, size) == 0);
+    ngli_assert(ktx.format == NGLI_FORMAT_ASTC_4x4_UNORM_BLOCK);
+    ngli_assert(ktx.width == 10 && ktx.height == 10 && ktx.nb_levels == 2);
+    ngli_assert(ktx.levels[0].size == 9 * 16 && ktx.levels[0].data[0] == 0);
+    ngli_assert(ktx.levels[1].size == 4 * 16 && ktx.levels[1].data[0] == 1);
+    ngli_assert(ngli_format_get_image_size(ktx.format, 10, 10) == 9 * 16);
+
+    size = make_ktx2(buf, 2);
+    ngli_assert(ngli_ktx_parse(&ktx, buf, size) == NGL_ERROR_UNSUPPORTED);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "memory.h"
+#include "utils.h"
+
+#define BLOCK_SIZE 1024
+
+static void check_usage(int tag, int64_t live, int64_t peak)
+{
+    int64_t lives[NGLI_MEMTAG_NB], peaks[NGLI_MEMTAG_NB];
+    ngli_memory_get_usage(lives, peaks);
+    ngli_assert(lives[tag] == live);
+    ngli_assert(peaks[tag] == peak);
+}
+
+static void test_tagged(void)
+{
+    uint8_t *a = ngli_malloc_tagged(100, NGLI_MEMTAG_BUFFERS);
+    uint8_t *b = ngli_calloc_tagged(10, 30, NGLI_MEMTAG_BUFFERS);
+    ngli_assert(a && b);
+    ngli_assert(((uintptr_t)a & (NGLI_ALIGN_VAL - 1)) == 0);
+    ngli_assert(((uintptr_t)b & (NGLI_ALIGN_VAL - 1)) == 0);
+    for (int i = 0; i < 300; i++)
+        ngli_assert(b[i] == 0);
+    check_usage(NGLI_MEMTAG_BUFFERS, 400, 400);
+
+    /*
+     * The content is preserved and the accounting follows the new size; the
+     * data being moved, both allocations briefly coexist
+     */
+    for (int i = 0; i < 100; i++)
+        a[i] = i;
+    a = ngli_realloc_tagged(a, 50, NGLI_MEMTAG_BUFFERS);
+    ngli_assert(a);
+    for (int i = 0; i < 50; i++)
+        ngli_assert(a[i] == i);
+    check_usage(NGLI_MEMTAG_BUFFERS, 350, 450);
+
+    ngli_free_tagged(b);
+    ngli_free_tagged(a);
+    ngli_free_tagged(NULL);
+    check_usage(NGLI_MEMTAG_BUFFERS, 0, 450);
+    check_usage(NGLI_MEMTAG_DRAWING, 0, 0);
+
+    ngli_assert(!ngli_calloc_tagged(SIZE_MAX / 2, 4, NGLI_MEMTAG_BUFFERS));
+}
+
+static void fill_frame(struct arena *arena)
+{
+    for (int i = 0; i < 3 * BLOCK_SIZE / NGLI_ALIGN_VAL; i++) {
+        uint8_t *p = ngli_arena_alloc(arena, NGLI_ALIGN_VAL);
+        ngli_assert(p);
+        memset(p, 0xff, NGLI_ALIGN_VAL);
+    }
+}
+
+static void test_reset(void)
+{
+    struct arena *arena = ngli_arena_create(BLOCK_SIZE, NGLI_MEMTAG_DRAWING);
+    ngli_assert(arena);
+
+    /* A reset arena hands out the same memory again */
+    uint8_t *a = ngli_arena_alloc(arena, 3);
+    ngli_arena_reset(arena);
+    ngli_assert(ngli_arena_alloc(arena, 3) == a);
+
+    /* The blocks of an overflowing frame are merged into a single one... */
+    ngli_arena_reset(arena);
+    ngli_arena_alloc(arena, 1);
+    fill_frame(arena);
+    ngli_arena_reset(arena);
+    int64_t live[NGLI_MEMTAG_NB], peak[NGLI_MEMTAG_NB];
+    ngli_memory_get_usage(live, peak);
+    const int64_t frame_live = live[NGLI_MEMTAG_DRAWING];
+
+    /* ...so the following frames do not allocate anymore */
+    for (int i = 0; i < 3; i++) {
+        a = ngli_arena_alloc(arena, 1);
+        fill_frame(arena);
+        ngli_memory_get_usage(live, peak);
+        ngli_assert(live[NGLI_MEMTAG_DRAWING] == frame_live);
+        ngli_arena_reset(arena);
+        ngli_assert(ngli_arena_alloc(arena, 1) == a);
+        ngli_arena_reset(arena);
+    }
+
+    ngli_arena_unrefp(&arena);
+    ngli_memory_get_usage(live, peak);
+    ngli_assert(live[NGLI_MEMTAG_DRAWING] == 0);
+}
+
+int main(void)
+{
+    test_tagged();
+    test_reset();
+
+    struct arena *arena = ngli_arena_create(BLOCK_SIZE, NGLI_MEMTAG_NODES);
+    ngli_assert(arena);
+
+    /* Small allocations are contiguous and aligned */
+    uint8_t *a = ngli_arena_alloc(arena, 3);
+    uint8_t *b = ngli_arena_alloc(arena, 20);
+    ngli_assert(a && b);
+    ngli_assert(((uintptr_t)a & (NGLI_ALIGN_VAL - 1)) == 0);
+    ngli_assert(b == a + NGLI_ALIGN_VAL);
+    memset(a, 0xff, 3);
+    memset(b, 0xff, 20);
+
+    /* A large allocation does not interrupt the current block */
+    uint8_t *large = ngli_arena_alloc(arena, BLOCK_SIZE * 4);
+    ngli_assert(large);
+    memset(large, 0xff, BLOCK_SIZE * 4);
+    uint8_t *c = ngli_arena_alloc(arena, 1);
+    ngli_assert(c == b + 2 * NGLI_ALIGN_VAL);
+
+    /* Filling the block moves to a new one */
+    for (int i = 0; i < 3 * BLOCK_SIZE / NGLI_ALIGN_VAL; i++) {
+        uint8_t *p = ngli_arena_alloc(arena, NGLI_ALIGN_VAL);
+        ngli_assert(p);
+        ngli_assert(((uintptr_t)p & (NGLI_ALIGN_VAL - 1)) == 0);
+        memset(p, 0xff, NGLI_ALIGN_VAL);
+    }
+
+    /* The memory stays available until the last reference is dropped */
+    struct arena *ref = ngli_arena_ref(arena);
+    ngli_arena_unrefp(&arena);
+    ngli_assert(!arena);
+    memset(a, 0, 3);
+    ngli_arena_unrefp(&ref);
+    ngli_assert(!ref);
+
+    /* The arena blocks are accounted until released */
+    int64_t live[NGLI_MEMTAG_NB], peak[NGLI_MEMTAG_NB];
+    ngli_memory_get_usage(live, peak);
+    ngli_assert(live[NGLI_MEMTAG_NODES] == 0);
+    ngli_assert(peak[NGLI_MEMTAG_NODES] >= 4 * BLOCK_SIZE);
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "memory.h"
+#include "multiview.h"
+#include "utils.h"
+
+static const char shader_es3[] =
+    "#version 300 es\n"
+    "#extension GL_OES_EGL_image_external_essl3 : require\n"
+    "in vec4 ngl_position;\n"
+    "uniform mat4 ngl_modelview_matrix;\n"
+    "uniform mat4 ngl_projection_matrix;\n"
+    "void main(void)\n"
+    "{\n"
+    "    gl_Position = ngl_projection_matrix * ngl_view_matrix * ngl_modelview_matrix * ngl_position;\n"
+    "}\n";
+
+int main(void)
+{
+    char *dst;
+
+    /* The view index is not available in the older GLSL versions */
+    ngli_assert(ngli_multiview_preprocess("void main(void) {}", 2, &dst) < 0);
+    ngli_assert(!dst);
+    ngli_assert(ngli_multiview_preprocess("#version 100\nvoid main(void) {}", 2, &dst) < 0);
+    ngli_assert(ngli_multiview_preprocess("#version 140\nvoid main(void) {}", 2, &dst) < 0);
+
+    ngli_assert(ngli_multiview_preprocess(shader_es3, 2, &dst) == 0);
+    printf("%s\n", dst);
+    const char *ext = strstr(dst, "#extension GL_OES_EGL_image_external_essl3");
+    const char *multiview_ext = strstr(dst, "#extension GL_OVR_multiview : require\n");
+    const char *layout = strstr(dst, "layout(num_views = 2) in;\n");
+    const char *matrices = strstr(dst, "uniform mat4 ngl_view_matrices[2];\n");
+    const char *input = strstr(dst, "in vec4 ngl_position;");
+    ngli_assert(ext && multiview_ext && layout && matrices && input);
+    ngli_assert(ext < multiview_ext && multiview_ext < layout && layout < matrices && matrices < input);
+    ngli_assert(strstr(dst, "#define ngl_view_matrix ngl_view_matrices[int(gl_ViewID_OVR)]\n"));
+    ngli_free(dst);
+
+    ngli_assert(ngli_multiview_preprocess("#version 330\nvoid main(void) {}", 4, &dst) == 0);
+    ngli_assert(!strncmp(dst, "#version 330\n#extension GL_OVR_multiview", 40));
+    ngli_assert(strstr(dst, "ngl_view_matrices[4]"));
+    ngli_free(dst);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "renderscale.h"
+#include "utils.h"
+
+#define TARGET 16000
+
+static int feed(struct renderscale *s, int64_t gpu_time, int nb)
+{
+    int nb_changes = 0;
+    for (int i = 0; i < nb; i++)
+        nb_changes += ngli_renderscale_update(s, gpu_time);
+    return nb_changes;
+}
+
+int main(void)
+{
+    struct renderscale s;
+
+    /* Disabled controller */
+    ngli_renderscale_init(&s, 0);
+    ngli_assert(feed(&s, 100000, 100) == 0);
+    ngli_assert(ngli_renderscale_get_size(&s, 1920) == 1920);
+
+    ngli_renderscale_init(&s, TARGET);
+
+    /* Within the budget at the full resolution */
+    ngli_assert(feed(&s, 10000, 100) == 0);
+    ngli_assert(s.level == 0);
+
+    /* An isolated spike does not change the resolution */
+    ngli_assert(feed(&s, 30000, 2) == 0);
+    ngli_assert(feed(&s, 10000, 1) == 0);
+    ngli_assert(s.level == 0);
+
+    /* A sustained overload lowers the resolution one level at a time */
+    ngli_assert(feed(&s, 30000, 5) == 1);
+    ngli_assert(s.level == 1);
+    ngli_assert(ngli_renderscale_get_size(&s, 1920) == 1680);
+    ngli_assert(feed(&s, 30000, 200) == 3);
+    ngli_assert(s.level == 4);
+    ngli_assert(ngli_renderscale_get_size(&s, 1920) == 960);
+    ngli_assert(ngli_renderscale_get_size(&s, 1) == 1);
+
+    /* The resolution is not raised if it would exceed the budget again */
+    ngli_assert(feed(&s, 12000, 200) == 0);
+    ngli_assert(s.level == 4);
+
+    /* The resolution is raised back when the load allows it */
+    ngli_assert(feed(&s, 4000, 1000) == 4);
+    ngli_assert(s.level == 0);
+
+    /* Unavailable GPU times are ignored */
+    ngli_assert(feed(&s, -1, 100) == 0);
+
+    return 0;
+}
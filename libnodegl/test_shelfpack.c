@@ -0,0 +1,60 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "nodegl.h"
+#include "shelfpack.h"
+#include "utils.h"
+
+int main(void)
+{
+    struct shelfpack pack;
+    ngli_shelfpack_init(&pack, 64, 32);
+    int x, y;
+
+    /* The first rectangle opens a shelf of its height */
+    ngli_assert(ngli_shelfpack_alloc(&pack, 32, 16, &x, &y) == 0);
+    ngli_assert(x == 0 && y == 0);
+
+    /* Shorter rectangles fill the remaining space of the shelf */
+    ngli_assert(ngli_shelfpack_alloc(&pack, 32, 8, &x, &y) == 0);
+    ngli_assert(x == 32 && y == 0);
+
+    /* A full shelf makes room for a new one below */
+    ngli_assert(ngli_shelfpack_alloc(&pack, 8, 12, &x, &y) == 0);
+    ngli_assert(x == 0 && y == 16);
+    ngli_assert(ngli_shelfpack_alloc(&pack, 16, 10, &x, &y) == 0);
+    ngli_assert(x == 8 && y == 16);
+    ngli_assert(ngli_shelfpack_alloc(&pack, 48, 4, &x, &y) == 0);
+    ngli_assert(x == 0 && y == 28);
+
+    /* The shelf with the closest height is picked */
+    ngli_assert(ngli_shelfpack_alloc(&pack, 8, 3, &x, &y) == 0);
+    ngli_assert(x == 48 && y == 28);
+    ngli_assert(ngli_shelfpack_alloc(&pack, 8, 8, &x, &y) == 0);
+    ngli_assert(x == 24 && y == 16);
+
+    /* No room left for a new shelf */
+    ngli_assert(ngli_shelfpack_alloc(&pack, 64, 8, &x, &y) == NGL_ERROR_LIMIT_EXCEEDED);
+    ngli_assert(ngli_shelfpack_alloc(&pack, 128, 1, &x, &y) == NGL_ERROR_LIMIT_EXCEEDED);
+
+    ngli_shelfpack_reset(&pack);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "texturepool.h"
+#include "utils.h"
+
+static int nb_released;
+
+static void release(void *user_arg, const struct texturepool_key *key, GLuint id)
+{
+    GLuint *last_released = user_arg;
+    *last_released = id;
+    nb_released++;
+}
+
+int main(void)
+{
+    GLuint last_released = 0;
+    struct texturepool pool = {0};
+    ngli_texturepool_init(&pool, 1000, release, &last_released);
+
+    const struct texturepool_key key_a = {.target = GL_TEXTURE_2D, .width = 16, .height = 16, .levels = 1};
+    const struct texturepool_key key_b = {.target = GL_TEXTURE_2D, .width = 8,  .height = 16, .levels = 1};
+
+    /* Empty pool */
+    ngli_assert(ngli_texturepool_get(&pool, &key_a) == 0);
+
+    /* Recycle the most recently released matching entry */
+    ngli_texturepool_put(&pool, &key_a, 300, 1);
+    ngli_texturepool_put(&pool, &key_b, 300, 2);
+    ngli_texturepool_put(&pool, &key_a, 300, 3);
+    ngli_assert(pool.size == 900);
+    ngli_assert(ngli_texturepool_get(&pool, &key_a) == 3);
+    ngli_assert(pool.size == 600);
+
+    /* The least recently released entries are evicted first */
+    ngli_texturepool_put(&pool, &key_b, 300, 4);
+    ngli_texturepool_put(&pool, &key_b, 300, 5);
+    ngli_assert(nb_released == 1 && last_released == 1);
+    ngli_assert(pool.size == 900);
+    ngli_assert(ngli_texturepool_get(&pool, &key_a) == 0);
+
+    /* Entries larger than the cap are released immediately */
+    ngli_texturepool_put(&pool, &key_a, 2000, 6);
+    ngli_assert(nb_released == 2 && last_released == 6);
+
+    ngli_assert(ngli_texturepool_get(&pool, &key_b) == 5);
+    ngli_assert(ngli_texturepool_get(&pool, &key_b) == 4);
+    ngli_assert(ngli_texturepool_get(&pool, &key_b) == 2);
+    ngli_assert(ngli_texturepool_get(&pool, &key_b) == 0);
+    ngli_assert(pool.size == 0);
+
+    ngli_texturepool_put(&pool, &key_a, 100, 7);
+    ngli_texturepool_reset(&pool);
+    ngli_assert(nb_released == 3 && last_released == 7);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glcontext.h"
+#include "memory.h"
+#include "texvideo.h"
+#include "utils.h"
+
+static int count_occurrences(const char *s, const char *needle)
+{
+    int n = 0;
+    while ((s = strstr(s, needle))) {
+        s += strlen(needle);
+        n++;
+    }
+    return n;
+}
+
+static const char shader_es2[] =
+    "#version 100\n"
+    "precision highp float;\n"
+    "uniform sampler2D tex0_sampler;\n"
+    "varying vec2 uv;\n"
+    "void main(void)\n"
+    "{\n"
+    "    gl_FragColor = ngl_texvideo(tex0, uv) * ngl_texvideo( tex1 ,uv) + ngl_texvideo(tex0, uv);\n"
+    "}\n";
+
+static const char shader_es3[] =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "in vec2 uv;\n"
+    "out vec4 color;\n"
+    "void main(void)\n"
+    "{\n"
+    "    color = ngl_texvideo(tex0, uv);\n"
+    "}\n";
+
+int main(void)
+{
+    struct glcontext gl = {.version = 300};
+    char *dst;
+
+    ngli_assert(ngli_texvideo_preprocess(&gl, "void main(void) { ngl_texvideo_foo(); }", &dst) == 0);
+    ngli_assert(!dst);
+
+    ngli_assert(ngli_texvideo_preprocess(&gl, shader_es2, &dst) == 0);
+    ngli_assert(dst);
+    printf("%s\n", dst);
+    ngli_assert(!strncmp(dst, "#version 100\n", strlen("#version 100\n")));
+    ngli_assert(count_occurrences(dst, "ngl_texvideo_tex0(uv)") == 2);
+    ngli_assert(count_occurrences(dst, "ngl_texvideo_tex1(uv)") == 1);
+    ngli_assert(count_occurrences(dst, "vec4 ngl_texvideo_tex0(vec2 coords)") == 1);
+    ngli_assert(count_occurrences(dst, "vec4 ngl_texvideo_tex1(vec2 coords)") == 1);
+    ngli_assert(count_occurrences(dst, "uniform sampler2D tex0_sampler;") == 1);
+    ngli_assert(count_occurrences(dst, "uniform sampler2D tex1_sampler;") == 1);
+    ngli_assert(count_occurrences(dst, "texture(") == 0);
+    ngli_assert(count_occurrences(dst, "precision mediump float;") == 0);
+    ngli_free(dst);
+
+    ngli_assert(ngli_texvideo_preprocess(&gl, shader_es3, &dst) == 0);
+    ngli_assert(dst);
+    printf("%s\n", dst);
+    ngli_assert(count_occurrences(dst, "texture2D(") == 0);
+    ngli_assert(count_occurrences(dst, "color = ngl_texvideo_tex0(uv);") == 1);
+    ngli_free(dst);
+
+    ngli_assert(ngli_texvideo_preprocess(&gl, "void main(void) { ngl_texvideo(uv); }", &dst) < 0);
+    ngli_assert(ngli_texvideo_preprocess(&gl, "void main(void) { ngl_texvideo", &dst) < 0);
+
+    return 0;
+}
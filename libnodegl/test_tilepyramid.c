@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L // mkdtemp()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "memory.h"
+#include "tilepyramid.h"
+#include "utils.h"
+
+#define WIDTH 100
+#define HEIGHT 70
+#define TILE_SIZE 32
+
+static uint8_t get_value(int x, int y, int c)
+{
+    return (x * 2 + y * 3 + c) & 0xff;
+}
+
+static const uint8_t *get_pixel(const uint8_t *tile, int x, int y)
+{
+    return tile + (y * TILE_SIZE + x) * NGLI_TILEPYRAMID_PIXEL_SIZE;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/ngl-test-tilepyramid-XXXXXX";
+    ngli_assert(mkdtemp(path));
+    char *src_filename = ngli_asprintf("%s/image.raw", path);
+    char *filename = ngli_asprintf("%s/image.pyramid", path);
+    ngli_assert(src_filename && filename);
+
+    FILE *fp = fopen(src_filename, "wb");
+    ngli_assert(fp);
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+            for (int c = 0; c < NGLI_TILEPYRAMID_PIXEL_SIZE; c++)
+                fputc(get_value(x, y, c), fp);
+    ngli_assert(!fclose(fp));
+
+    struct tilepyramid pyramid = {0};
+    ngli_assert(ngli_tilepyramid_init(&pyramid, filename, src_filename, WIDTH, HEIGHT * 2, TILE_SIZE) < 0);
+    ngli_tilepyramid_reset(&pyramid);
+
+    /* 100x70, 50x35, 25x18 */
+    ngli_assert(ngli_tilepyramid_init(&pyramid, filename, src_filename, WIDTH, HEIGHT, TILE_SIZE) == 0);
+    ngli_assert(pyramid.nb_levels == 3);
+    ngli_assert(pyramid.levels[0].nb_tiles_x == 4 && pyramid.levels[0].nb_tiles_y == 3);
+    ngli_assert(pyramid.levels[1].width == 50 && pyramid.levels[1].height == 35);
+    ngli_assert(pyramid.levels[2].width == 25 && pyramid.levels[2].height == 18);
+    ngli_assert(pyramid.levels[2].nb_tiles_x == 1 && pyramid.levels[2].nb_tiles_y == 1);
+
+    uint8_t tile[TILE_SIZE * TILE_SIZE * NGLI_TILEPYRAMID_PIXEL_SIZE];
+    ngli_assert(ngli_tilepyramid_read_tile(&pyramid, 0, 1, 2, tile) == 0);
+    ngli_assert(get_pixel(tile, 5, 3)[1] == get_value(37, 67, 1));
+
+    /* The edge tiles repeat the last column and row */
+    ngli_assert(ngli_tilepyramid_read_tile(&pyramid, 0, 3, 2, tile) == 0);
+    ngli_assert(get_pixel(tile, 31, 31)[0] == get_value(WIDTH - 1, HEIGHT - 1, 0));
+
+    /* Box filtered from the 2x2 pixels of the previous level */
+    ngli_assert(ngli_tilepyramid_read_tile(&pyramid, 1, 1, 0, tile) == 0);
+    const int expected = (get_value(74, 10, 2) + get_value(75, 10, 2) +
+                          get_value(74, 11, 2) + get_value(75, 11, 2) + 2) >> 2;
+    ngli_assert(get_pixel(tile, 5, 5)[2] == expected);
+    ngli_tilepyramid_reset(&pyramid);
+
+    /* The pyramid built by a previous session is reused */
+    struct stat st;
+    ngli_assert(!stat(filename, &st));
+    const ino_t ino = st.st_ino;
+    ngli_assert(ngli_tilepyramid_init(&pyramid, filename, src_filename, WIDTH, HEIGHT, TILE_SIZE) == 0);
+    ngli_assert(!stat(filename, &st) && st.st_ino == ino);
+    ngli_tilepyramid_reset(&pyramid);
+
+    /* but not with another tile size */
+    ngli_assert(ngli_tilepyramid_init(&pyramid, filename, src_filename, WIDTH, HEIGHT, TILE_SIZE / 2) == 0);
+    ngli_assert(pyramid.nb_levels == 4);
+    ngli_assert(ngli_tilepyramid_read_tile(&pyramid, 0, 2, 4, tile) == 0);
+    ngli_assert(tile[0] == get_value(32, 64, 0));
+    ngli_tilepyramid_reset(&pyramid);
+
+    unlink(filename);
+    unlink(src_filename);
+    rmdir(path);
+    ngli_free(filename);
+    ngli_free(src_filename);
+    return 0;
+}
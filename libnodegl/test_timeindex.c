@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timeindex.h"
+#include "utils.h"
+
+static const double times[] = {0.0, 0.5, 1.0, 1.0, 1.0, 2.5, 3.0, 7.0, 7.5, 10.0};
+
+static double get_time(const void *arg, int index)
+{
+    const double *t = arg;
+    return t[index];
+}
+
+static int linear_search(const double *t, int nb, double v)
+{
+    int ret = -1;
+    for (int i = 0; i < nb && t[i] <= v; i++)
+        ret = i;
+    return ret;
+}
+
+int main(void)
+{
+    const int nb_times = NGLI_ARRAY_NB(times);
+
+    ngli_assert(ngli_timeindex_search(times, 0, 0, 1.0, get_time) == -1);
+
+    for (int i = 0; i < 200; i++) {
+        const double t = -1.0 + i * 0.0625;
+        const int ref = linear_search(times, nb_times, t);
+        for (int cursor = -1; cursor <= nb_times; cursor++) {
+            const int idx = ngli_timeindex_search(times, nb_times, cursor, t, get_time);
+            if (idx != ref) {
+                fprintf(stderr, "t=%g cursor=%d: got %d instead of %d\n", t, cursor, idx, ref);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return 0;
+}
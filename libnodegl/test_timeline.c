@@ -0,0 +1,127 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timeline.h"
+#include "utils.h"
+
+#define FILENAME "test_timeline.nglt"
+#define NB_CHUNKS 7
+#define NB_ELEMS_PER_CHUNK 10
+
+/* Elements hold their own index, timestamps are 10 * index + 5 */
+static int64_t get_ts(int index)
+{
+    return index * 10 + 5;
+}
+
+static int write_file(void)
+{
+    FILE *fp = fopen(FILENAME, "wb");
+    if (!fp)
+        return -1;
+
+    const uint32_t header[] = {1, sizeof(int32_t), NB_CHUNKS};
+    fwrite("NGLT", 4, 1, fp);
+    fwrite(header, sizeof(header), 1, fp);
+
+    const uint64_t index_size = NB_CHUNKS * sizeof(struct timeline_index_entry);
+    const uint64_t data_offset = 4 + sizeof(header) + index_size;
+    const uint64_t chunk_size = NB_ELEMS_PER_CHUNK * (sizeof(int64_t) + sizeof(int32_t));
+    for (int i = 0; i < NB_CHUNKS; i++) {
+        const struct timeline_index_entry entry = {
+            .first_ts = get_ts(i * NB_ELEMS_PER_CHUNK),
+            .offset = data_offset + i * chunk_size,
+            .nb_elems = NB_ELEMS_PER_CHUNK,
+        };
+        fwrite(&entry, sizeof(entry), 1, fp);
+    }
+
+    for (int i = 0; i < NB_CHUNKS; i++) {
+        for (int j = 0; j < NB_ELEMS_PER_CHUNK; j++) {
+            const int64_t ts = get_ts(i * NB_ELEMS_PER_CHUNK + j);
+            fwrite(&ts, sizeof(ts), 1, fp);
+        }
+        for (int j = 0; j < NB_ELEMS_PER_CHUNK; j++) {
+            const int32_t v = i * NB_ELEMS_PER_CHUNK + j;
+            fwrite(&v, sizeof(v), 1, fp);
+        }
+    }
+
+    return fclose(fp);
+}
+
+static int get_ref(int64_t t)
+{
+    const int nb_elems = NB_CHUNKS * NB_ELEMS_PER_CHUNK;
+    int ret = 0;
+    for (int i = 0; i < nb_elems && get_ts(i) <= t; i++)
+        ret = i;
+    return ret;
+}
+
+static int check(struct timeline *s, int64_t t)
+{
+    int32_t v = -1;
+    int ret = ngli_timeline_get(s, t, &v);
+    if (ret < 0) {
+        fprintf(stderr, "t=%d: could not get timeline element\n", (int)t);
+        return ret;
+    }
+    const int ref = get_ref(t);
+    if (v != ref) {
+        fprintf(stderr, "t=%d: got %d instead of %d\n", (int)t, v, ref);
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    ngli_assert(write_file() == 0);
+
+    struct timeline s = {0};
+    ngli_assert(ngli_timeline_init(&s, FILENAME, sizeof(int64_t)) < 0);
+    ngli_timeline_reset(&s);
+
+    int ret = ngli_timeline_init(&s, FILENAME, sizeof(int32_t));
+    if (ret < 0)
+        goto end;
+
+    /* Monotonic playback */
+    for (int64_t t = -10; t < 750; t += 3)
+        if ((ret = check(&s, t)) < 0)
+            goto end;
+
+    /* Random seeks */
+    srand(0);
+    for (int i = 0; i < 200; i++)
+        if ((ret = check(&s, rand() % 800 - 20)) < 0)
+            goto end;
+
+end:
+    ngli_timeline_reset(&s);
+    remove(FILENAME);
+    return ret < 0 ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glcontext.h"
+#include "memory.h"
+#include "type.h"
+#include "uniformpack.h"
+#include "utils.h"
+
+static int count_occurrences(const char *s, const char *needle)
+{
+    int n = 0;
+    while ((s = strstr(s, needle))) {
+        s += strlen(needle);
+        n++;
+    }
+    return n;
+}
+
+static const char vertex_es3[] =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "in vec4 ngl_position;\n"
+    "uniform mat4 ngl_modelview_matrix;\n"
+    "uniform mat4 ngl_projection_matrix;\n"
+    "uniform mediump float scale; // uniform vec4 commented;\n"
+    "void main(void)\n"
+    "{\n"
+    "    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position * scale;\n"
+    "}\n";
+
+static const char fragment_es3[] =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "uniform sampler2D tex0_sampler;\n"
+    "uniform float scale;\n"
+    "uniform vec3 colors[2];\n"
+    "uniform mat3 transform;\n"
+    "uniform bool enabled;\n"
+    "out vec4 color;\n"
+    "void main(void)\n"
+    "{\n"
+    "    color = vec4(transform * colors[1] * scale, enabled ? 1.0 : 0.0);\n"
+    "}\n";
+
+static const char fragment_conditional[] =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "#ifdef FOO\n"
+    "uniform float scale;\n"
+    "#endif\n"
+    "out vec4 color;\n"
+    "void main(void) { color = vec4(1.0); }\n";
+
+static const char fragment_es2[] =
+    "#version 100\n"
+    "precision highp float;\n"
+    "uniform float scale;\n"
+    "void main(void) { gl_FragColor = vec4(scale); }\n";
+
+static const struct uniformpack_member *get_member(const struct uniformpack *s, const char *name)
+{
+    for (int i = 0; i < s->nb_members; i++)
+        if (!strcmp(s->members[i].name, name))
+            return &s->members[i];
+    return NULL;
+}
+
+int main(void)
+{
+    struct glcontext gl = {
+        .version = 300,
+        .features = NGLI_FEATURE_UNIFORM_BUFFER_OBJECT,
+        .max_uniform_block_size = 16384,
+    };
+    struct uniformpack pack;
+    char *dsts[2];
+
+    const char *srcs[] = {vertex_es3, fragment_es3};
+    ngli_assert(ngli_uniformpack_init(&pack, &gl, srcs, dsts, 2) == 0);
+    ngli_assert(dsts[0] && dsts[1]);
+    printf("%s\n%s\n", dsts[0], dsts[1]);
+    ngli_assert(pack.nb_members == 6);
+    ngli_assert(get_member(&pack, "ngl_modelview_matrix")->offset == 0);
+    ngli_assert(get_member(&pack, "ngl_projection_matrix")->offset == 64);
+    ngli_assert(get_member(&pack, "scale")->offset == 128);
+    ngli_assert(get_member(&pack, "colors")->offset == 144);
+    ngli_assert(get_member(&pack, "colors")->count == 2);
+    ngli_assert(get_member(&pack, "transform")->offset == 176);
+    ngli_assert(get_member(&pack, "enabled")->offset == 224);
+    ngli_assert(pack.size == 240);
+    for (int i = 0; i < 2; i++) {
+        ngli_assert(!strncmp(dsts[i], "#version 300 es\n", strlen("#version 300 es\n")));
+        ngli_assert(count_occurrences(dsts[i], "layout(std140) uniform ngl_uniforms {") == 1);
+        ngli_assert(count_occurrences(dsts[i], "uniform float scale;") == 0);
+        ngli_assert(count_occurrences(dsts[i], "    highp float scale;\n") == 1);
+        ngli_assert(count_occurrences(dsts[i], "    highp vec3 colors[2];\n") == 1);
+        ngli_assert(count_occurrences(dsts[i], "    bool enabled;\n") == 1);
+        ngli_free(dsts[i]);
+    }
+    ngli_assert(count_occurrences(fragment_es3, "uniform sampler2D tex0_sampler;") == 1);
+    ngli_uniformpack_reset(&pack);
+
+    const char *mismatch[] = {vertex_es3, "#version 300 es\nuniform vec2 scale;\nvoid main(void) {}\n"};
+    ngli_assert(ngli_uniformpack_init(&pack, &gl, mismatch, dsts, 2) == 0);
+    ngli_assert(!pack.nb_members && !dsts[0] && !dsts[1]);
+
+    const char *conditional[] = {vertex_es3, fragment_conditional};
+    ngli_assert(ngli_uniformpack_init(&pack, &gl, conditional, dsts, 2) == 0);
+    ngli_assert(!pack.nb_members && !dsts[0] && !dsts[1]);
+
+    const char *es2[] = {NULL, fragment_es2};
+    ngli_assert(ngli_uniformpack_init(&pack, &gl, es2, dsts, 2) == 0);
+    ngli_assert(!pack.nb_members && !dsts[0] && !dsts[1]);
+
+    gl.max_uniform_block_size = 128;
+    ngli_assert(ngli_uniformpack_init(&pack, &gl, srcs, dsts, 2) == 0);
+    ngli_assert(!pack.nb_members && !dsts[0] && !dsts[1]);
+
+    const float scale = 2.f;
+    const float color[3] = {0.5f, -1.f, 1e-3f};
+    const int enabled = 1;
+    struct uniformpack_constant constants[] = {
+        {.name = "scale",   .type = NGLI_TYPE_FLOAT, .data = &scale},
+        {.name = "colors",  .type = NGLI_TYPE_VEC3,  .data = color},
+        {.name = "enabled", .type = NGLI_TYPE_INT,   .data = &enabled},
+    };
+    ngli_assert(ngli_uniformpack_specialize(srcs, dsts, 2, constants, NGLI_ARRAY_NB(constants)) == 0);
+    ngli_assert(dsts[0] && dsts[1]);
+    printf("%s\n%s\n", dsts[0], dsts[1]);
+    ngli_assert(count_occurrences(dsts[0], "const mediump float scale = 2.0;") == 1);
+    ngli_assert(count_occurrences(dsts[1], "const float scale = 2.0;") == 1);
+    ngli_assert(count_occurrences(dsts[1], "const bool enabled = true;") == 1);
+    /* Arrays are never specialized */
+    ngli_assert(count_occurrences(dsts[1], "uniform vec3 colors[2];") == 1);
+    ngli_assert(constants[0].specialized && !constants[1].specialized && constants[2].specialized);
+    for (int i = 0; i < 2; i++)
+        ngli_free(dsts[i]);
+
+    const char *vec3_src[] = {NULL, "#version 100\nuniform vec3 colors;\n#ifdef FOO\nuniform float scale;\n#endif\n"};
+    ngli_assert(ngli_uniformpack_specialize(vec3_src, dsts, 2, constants, NGLI_ARRAY_NB(constants)) == 0);
+    ngli_assert(!dsts[0] && dsts[1]);
+    ngli_assert(count_occurrences(dsts[1], "const vec3 colors = vec3(0.5, -1.0, 0.00100000005);") == 1);
+    ngli_assert(count_occurrences(dsts[1], "#ifdef FOO\nconst float scale = 2.0;\n#endif\n") == 1);
+    ngli_free(dsts[1]);
+
+    const char *unparsed[] = {NULL, "#version 100\nuniform float scale, gain;\n"};
+    ngli_assert(ngli_uniformpack_specialize(unparsed, dsts, 2, constants, NGLI_ARRAY_NB(constants)) == 0);
+    ngli_assert(!dsts[0] && !dsts[1]);
+
+    const float mat3[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    float std140[12] = {0};
+    ngli_uniformpack_write((uint8_t *)std140, NGLI_TYPE_MAT3, mat3, 1);
+    const float expected_mat3[12] = {1, 2, 3, 0, 4, 5, 6, 0, 7, 8, 9, 0};
+    ngli_assert(!memcmp(std140, expected_mat3, sizeof(expected_mat3)));
+
+    const float floats[3] = {1, 2, 3};
+    memset(std140, 0, sizeof(std140));
+    ngli_uniformpack_write((uint8_t *)std140, NGLI_TYPE_FLOAT, floats, 3);
+    const float expected_floats[12] = {1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0};
+    ngli_assert(!memcmp(std140, expected_floats, sizeof(expected_floats)));
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+#include "vertexcache.h"
+
+#define GRID_SIZE 32
+#define NB_VERTICES ((GRID_SIZE + 1) * (GRID_SIZE + 1))
+#define NB_INDICES (GRID_SIZE * GRID_SIZE * 6)
+
+static int cmp_triangle(const void *a, const void *b)
+{
+    return memcmp(a, b, 3 * sizeof(uint32_t));
+}
+
+int main(void)
+{
+    uint32_t *indices   = ngli_calloc(NB_INDICES, sizeof(*indices));
+    uint32_t *optimized = ngli_calloc(NB_INDICES, sizeof(*optimized));
+    ngli_assert(indices && optimized);
+
+    /* Grid of quads with the triangles in a random order */
+    for (int y = 0; y < GRID_SIZE; y++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            const uint32_t i = y * (GRID_SIZE + 1) + x;
+            const uint32_t quad[] = {i, i + 1, i + GRID_SIZE + 1, i + 1, i + GRID_SIZE + 2, i + GRID_SIZE + 1};
+            memcpy(indices + (y * GRID_SIZE + x) * 6, quad, sizeof(quad));
+        }
+    }
+    uint32_t seed = 1;
+    for (int i = NB_INDICES / 3 - 1; i > 0; i--) {
+        seed = seed * 1664525 + 1013904223;
+        const int j = (seed >> 8) % (i + 1);
+        uint32_t tmp[3];
+        memcpy(tmp, indices + i * 3, sizeof(tmp));
+        memcpy(indices + i * 3, indices + j * 3, sizeof(tmp));
+        memcpy(indices + j * 3, tmp, sizeof(tmp));
+    }
+
+    ngli_assert(ngli_vertexcache_optimize(optimized, indices, NB_INDICES, NB_VERTICES) == 0);
+
+    const float acmr_before = ngli_vertexcache_get_acmr(indices, NB_INDICES, 16);
+    const float acmr_after = ngli_vertexcache_get_acmr(optimized, NB_INDICES, 16);
+    printf("ACMR: %f -> %f\n", acmr_before, acmr_after);
+    ngli_assert(acmr_after < 0.8f && acmr_after < acmr_before);
+
+    /* Same triangles with the same winding, only in a different order */
+    qsort(indices, NB_INDICES / 3, 3 * sizeof(*indices), cmp_triangle);
+    qsort(optimized, NB_INDICES / 3, 3 * sizeof(*optimized), cmp_triangle);
+    ngli_assert(!memcmp(indices, optimized, NB_INDICES * sizeof(*indices)));
+
+    /* Out of range indices */
+    ngli_assert(ngli_vertexcache_optimize(optimized, indices, NB_INDICES, NB_VERTICES - 1) == NGL_ERROR_INVALID_ARG);
+
+    ngli_free(indices);
+    ngli_free(optimized);
+    return 0;
+}
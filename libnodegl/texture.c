@@ -27,7 +27,9 @@
 #include "glincludes.h"
 #include "glcontext.h"
 #include "nodes.h"
+#include "rendertarget.h"
 #include "texture.h"
+#include "uploader.h"
 
 static const GLint gl_filter_map[NGLI_NB_FILTER][NGLI_NB_MIPMAP] = {
     [NGLI_FILTER_NEAREST] = {
@@ -87,6 +89,9 @@ static void texture_set_image(struct texture *s, const uint8_t *data)
     case GL_TEXTURE_3D:
         ngli_glTexImage3D(gl, GL_TEXTURE_3D, 0, s->internal_format, params->width, params->height, params->depth, 0, s->format, s->format_type, data);
         break;
+    case GL_TEXTURE_2D_ARRAY:
+        ngli_glTexImage3D(gl, GL_TEXTURE_2D_ARRAY, 0, s->internal_format, params->width, params->height, params->depth, 0, s->format, s->format_type, data);
+        break;
     case GL_TEXTURE_CUBE_MAP: {
         const int face_size = data ? s->bytes_per_pixel * params->width * params->height : 0;
         for (int face = 0; face < 6; face++) {
@@ -98,32 +103,27 @@ static void texture_set_image(struct texture *s, const uint8_t *data)
     }
 }
 
-static void texture2d_set_sub_image(struct texture *s, const uint8_t *data, int linesize, int row_upload)
+static void texture2d_set_sub_image(struct texture *s, struct glcontext *gl, const uint8_t *data, int linesize, int row_upload,
+                                    int x, int y, int width, int height)
 {
-    struct ngl_ctx *ctx = s->ctx;
-    struct glcontext *gl = ctx->glcontext;
-    const struct texture_params *params = &s->params;
-
     if (row_upload) {
-        for (int y = 0; y < params->height; y++) {
-            ngli_glTexSubImage2D(gl, GL_TEXTURE_2D, 0, 0, y, params->width, 1, s->format, s->format_type, data);
+        for (int i = 0; i < height; i++) {
+            ngli_glTexSubImage2D(gl, GL_TEXTURE_2D, 0, x, y + i, width, 1, s->format, s->format_type, data);
             data += linesize * s->bytes_per_pixel;
         }
         return;
     }
-    ngli_glTexSubImage2D(gl, GL_TEXTURE_2D, 0, 0, 0, params->width, params->height, s->format, s->format_type, data);
+    ngli_glTexSubImage2D(gl, GL_TEXTURE_2D, 0, x, y, width, height, s->format, s->format_type, data);
 }
 
-static void texture3d_set_sub_image(struct texture *s, const uint8_t *data, int linesize, int row_upload)
+static void texture3d_set_sub_image(struct texture *s, struct glcontext *gl, const uint8_t *data, int linesize, int row_upload)
 {
-    struct ngl_ctx *ctx = s->ctx;
-    struct glcontext *gl = ctx->glcontext;
     const struct texture_params *params = &s->params;
 
     if (row_upload) {
         for (int z = 0; z < params->depth; z++) {
             for (int y = 0; y < params->height; y++) {
-                ngli_glTexSubImage3D(gl, GL_TEXTURE_3D, 0, 0, y, z, params->width, 1, params->depth, s->format, s->format_type, data);
+                ngli_glTexSubImage3D(gl, GL_TEXTURE_3D, 0, 0, y, z, params->width, 1, 1, s->format, s->format_type, data);
                 data += linesize * s->bytes_per_pixel;
             }
         }
@@ -132,10 +132,8 @@ static void texture3d_set_sub_image(struct texture *s, const uint8_t *data, int
     ngli_glTexSubImage3D(gl, GL_TEXTURE_3D, 0, 0, 0, 0, params->width, params->height, params->depth, s->format, s->format_type, data);
 }
 
-static void texturecube_set_sub_image(struct texture *s, const uint8_t *data, int linesize, int row_upload)
+static void texturecube_set_sub_image(struct texture *s, struct glcontext *gl, const uint8_t *data, int linesize, int row_upload)
 {
-    struct ngl_ctx *ctx = s->ctx;
-    struct glcontext *gl = ctx->glcontext;
     const struct texture_params *params = &s->params;
 
     if (row_upload) {
@@ -154,40 +152,65 @@ static void texturecube_set_sub_image(struct texture *s, const uint8_t *data, in
     }
 }
 
-static void texture_set_sub_image(struct texture *s, const uint8_t *data, int linesize)
+/*
+ * Set the unpack state for rows of the given width read from an image of
+ * linesize pixels, and return whether the rows must be uploaded one by one
+ * because the context can not skip the end of the image lines.
+ */
+static int set_unpack_state(struct texture *s, struct glcontext *gl, int linesize, int width)
+{
+    const int bytes_per_row = linesize * s->bytes_per_pixel;
+    const int alignment = NGLI_MIN(bytes_per_row & ~(bytes_per_row - 1), 8);
+    ngli_glPixelStorei(gl, GL_UNPACK_ALIGNMENT, alignment);
+
+    if (gl->features & NGLI_FEATURE_ROW_LENGTH) {
+        ngli_glPixelStorei(gl, GL_UNPACK_ROW_LENGTH, linesize);
+        return 0;
+    }
+    return width != linesize;
+}
+
+static void reset_unpack_state(struct texture *s, struct glcontext *gl)
+{
+    ngli_glPixelStorei(gl, GL_UNPACK_ALIGNMENT, 4);
+    if (gl->features & NGLI_FEATURE_ROW_LENGTH)
+        ngli_glPixelStorei(gl, GL_UNPACK_ROW_LENGTH, 0);
+}
+
+static void texture_set_sub_image(struct texture *s, struct glcontext *gl, const uint8_t *data, int linesize)
 {
-    struct ngl_ctx *ctx = s->ctx;
-    struct glcontext *gl = ctx->glcontext;
     const struct texture_params *params = &s->params;
 
     if (!linesize)
         linesize = params->width;
 
-    const int bytes_per_row = linesize * ngli_format_get_bytes_per_pixel(params->format);
-    const int alignment = NGLI_MIN(bytes_per_row & ~(bytes_per_row - 1), 8);
-    ngli_glPixelStorei(gl, GL_UNPACK_ALIGNMENT, alignment);
-
-    int row_upload = 0;
-    if (gl->features & NGLI_FEATURE_ROW_LENGTH)
-        ngli_glPixelStorei(gl, GL_UNPACK_ROW_LENGTH, linesize);
-    else if (params->width != linesize)
-        row_upload = 1;
+    const int row_upload = set_unpack_state(s, gl, linesize, params->width);
 
     switch (s->target) {
     case GL_TEXTURE_2D:
-        texture2d_set_sub_image(s, data, linesize, row_upload);
+        texture2d_set_sub_image(s, gl, data, linesize, row_upload, 0, 0, params->width, params->height);
         break;
     case GL_TEXTURE_3D:
-        texture3d_set_sub_image(s, data, linesize, row_upload);
+        texture3d_set_sub_image(s, gl, data, linesize, row_upload);
         break;
     case GL_TEXTURE_CUBE_MAP:
-        texturecube_set_sub_image(s, data, linesize, row_upload);
+        texturecube_set_sub_image(s, gl, data, linesize, row_upload);
         break;
     }
 
-    ngli_glPixelStorei(gl, GL_UNPACK_ALIGNMENT, 4);
-    if (gl->features & NGLI_FEATURE_ROW_LENGTH)
-        ngli_glPixelStorei(gl, GL_UNPACK_ROW_LENGTH, 0);
+    reset_unpack_state(s, gl);
+}
+
+static int get_mipmap_levels(const struct texture *s)
+{
+    const struct texture_params *params = &s->params;
+    int mipmap_levels = 1;
+    if (ngli_format_is_compressed(params->format))
+        return ngli_texture_has_mipmap(s) ? params->mipmap_levels : 1;
+    if (s->target == GL_TEXTURE_2D && ngli_texture_has_mipmap(s))
+        while ((params->width | params->height) >> mipmap_levels)
+            mipmap_levels += 1;
+    return mipmap_levels;
 }
 
 static void texture_set_storage(struct texture *s)
@@ -198,14 +221,12 @@ static void texture_set_storage(struct texture *s)
 
     switch (s->target) {
     case GL_TEXTURE_2D: {
-        int mipmap_levels = 1;
-        if (ngli_texture_has_mipmap(s))
-            while ((params->width | params->height) >> mipmap_levels)
-                mipmap_levels += 1;
+        const int mipmap_levels = get_mipmap_levels(s);
         ngli_glTexStorage2D(gl, s->target, mipmap_levels, s->internal_format, params->width, params->height);
         break;
     }
     case GL_TEXTURE_3D:
+    case GL_TEXTURE_2D_ARRAY:
         ngli_glTexStorage3D(gl, s->target, 1, s->internal_format, params->width, params->height, params->depth);
         break;
     case GL_TEXTURE_CUBE_MAP:
@@ -240,7 +261,9 @@ static void renderbuffer_set_storage(struct texture *s)
     struct glcontext *gl = ctx->glcontext;
     const struct texture_params *params = &s->params;
 
-    if (params->samples > 0)
+    if (params->samples > 0 && (params->usage & NGLI_TEXTURE_USAGE_IMPLICIT_MULTISAMPLE))
+        ngli_glRenderbufferStorageMultisampleEXT(gl, GL_RENDERBUFFER, params->samples, s->format, params->width, params->height);
+    else if (params->samples > 0)
         ngli_glRenderbufferStorageMultisample(gl, GL_RENDERBUFFER, params->samples, s->format, params->width, params->height);
     else
         ngli_glRenderbufferStorage(gl, GL_RENDERBUFFER, s->format, params->width, params->height);
@@ -278,6 +301,9 @@ static int texture_init_fields(struct texture *s)
     if (params->cubemap) {
         ngli_assert(params->dimensions == 3);
         s->target = GL_TEXTURE_CUBE_MAP;
+    } else if (params->array) {
+        ngli_assert(params->dimensions == 2);
+        s->target = GL_TEXTURE_2D_ARRAY;
     }
 
     if (params->external_oes) {
@@ -298,9 +324,25 @@ static int texture_init_fields(struct texture *s)
 
     s->bytes_per_pixel = ngli_format_get_bytes_per_pixel(params->format);
 
+    /* Compressed images can not be generated on the GPU, including the mipmaps */
+    if (ngli_format_is_compressed(params->format)) {
+        if (s->target != GL_TEXTURE_2D || params->external_storage) {
+            LOG(ERROR, "compressed formats are only supported with 2D textures uploaded from the CPU");
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        if (params->mipmap_filter != NGLI_MIPMAP_FILTER_NONE && params->mipmap_levels < 2) {
+            LOG(WARNING, "compressed texture data has no mipmap levels, mipmapping will be disabled");
+            s->params.mipmap_filter = NGLI_MIPMAP_FILTER_NONE;
+        }
+    }
+
     if (params->external_storage || params->external_oes)
         s->external_storage = 1;
 
+    /* Immutable storage lets the driver allocate the whole mipmap chain once */
+    if (!s->external_storage && (gl->features & NGLI_FEATURE_TEXTURE_STORAGE))
+        s->immutable = 1;
+
     return 0;
 }
 
@@ -309,6 +351,54 @@ static int is_pow2(int x)
     return x && !(x & (x - 1));
 }
 
+static int texture_is_poolable(const struct texture *s)
+{
+    const struct texturepool *pool = &s->ctx->texture_pool;
+    return pool->max_size > 0 && !s->wrapped && !s->external_storage &&
+           !(s->params.usage & NGLI_TEXTURE_USAGE_IMPLICIT_MULTISAMPLE);
+}
+
+static void texture_get_pool_key(const struct texture *s, struct texturepool_key *key)
+{
+    const struct texture_params *params = &s->params;
+    memset(key, 0, sizeof(*key));
+    key->target          = s->target;
+    key->internal_format = s->internal_format;
+    key->format_type     = s->format_type;
+    key->width           = params->width;
+    key->height          = params->height;
+    key->depth           = params->depth;
+    key->levels          = get_mipmap_levels(s);
+    key->samples         = params->samples;
+    key->immutable       = s->immutable;
+}
+
+static int64_t texture_get_data_size(const struct texture *s)
+{
+    const struct texture_params *params = &s->params;
+    int64_t size = ngli_format_get_image_size(params->format, params->width, params->height);
+    if (s->target == GL_TEXTURE_CUBE_MAP)
+        size *= 6;
+    else if (s->target == GL_TEXTURE_3D || s->target == GL_TEXTURE_2D_ARRAY)
+        size *= params->depth;
+    return size;
+}
+
+static int64_t texture_get_pool_size(const struct texture *s)
+{
+    const struct texture_params *params = &s->params;
+    int64_t size = texture_get_data_size(s);
+    size *= NGLI_MAX(params->samples, 1);
+    if (get_mipmap_levels(s) > 1)
+        size += size / 3;
+    return size;
+}
+
+static int get_memory_category(const struct texture *s)
+{
+    return s->target == GL_RENDERBUFFER ? NGL_STATS_MEMORY_RENDERBUFFERS : NGL_STATS_MEMORY_TEXTURES;
+}
+
 int ngli_texture_init(struct texture *s,
                       struct ngl_ctx *ctx,
                       const struct texture_params *params)
@@ -322,14 +412,34 @@ int ngli_texture_init(struct texture *s,
 
     struct glcontext *gl = ctx->glcontext;
 
+    if (s->target != GL_RENDERBUFFER && !s->external_storage &&
+        (!params->width || !params->height || ((params->dimensions == 3 || params->array) && !params->depth))) {
+        LOG(ERROR, "invalid texture dimensions %dx%dx%d",
+            params->width, params->height, params->depth);
+        memset(s, 0, sizeof(*s));
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    /* Recycle a previously released texture with the same storage if any */
+    int recycled = 0;
+    if (texture_is_poolable(s)) {
+        struct texturepool_key key;
+        texture_get_pool_key(s, &key);
+        s->id = ngli_texturepool_get(&ctx->texture_pool, &key);
+        recycled = s->id != 0;
+    }
+
     if (s->target == GL_RENDERBUFFER) {
-        ngli_glGenRenderbuffers(gl, 1, &s->id);
-        ngli_glBindRenderbuffer(gl, s->target, s->id);
-        renderbuffer_set_storage(s);
+        if (!recycled) {
+            ngli_glGenRenderbuffers(gl, 1, &s->id);
+            ngli_glBindRenderbuffer(gl, s->target, s->id);
+            renderbuffer_set_storage(s);
+        }
     } else {
-        ngli_glGenTextures(gl, 1, &s->id);
-        ngli_glBindTexture(gl, s->target, s->id);
-        int mipmap_filter = params->mipmap_filter;
+        if (!recycled)
+            ngli_glGenTextures(gl, 1, &s->id);
+        ngli_glstate_bind_texture(gl, s->target, s->id);
+        int mipmap_filter = s->params.mipmap_filter;
         if (mipmap_filter &&
             !(gl->features & NGLI_FEATURE_TEXTURE_NPOT) &&
             (!is_pow2(params->width) || !is_pow2(params->height))) {
@@ -342,29 +452,45 @@ int ngli_texture_init(struct texture *s,
         const GLint wrap_s = ngli_texture_get_gl_wrap(params->wrap_s);
         const GLint wrap_t = ngli_texture_get_gl_wrap(params->wrap_t);
         const GLint wrap_r = ngli_texture_get_gl_wrap(params->wrap_r);
-        ngli_glTexParameteri(gl, s->target, GL_TEXTURE_MIN_FILTER, min_filter);
-        ngli_glTexParameteri(gl, s->target, GL_TEXTURE_MAG_FILTER, mag_filter);
-        ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_S, wrap_s);
-        ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_T, wrap_t);
-        if (s->target == GL_TEXTURE_3D || s->target == GL_TEXTURE_CUBE_MAP)
-            ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_R, wrap_r);
-
-        if (!s->external_storage) {
-            if (!params->width || !params->height ||
-                (params->dimensions == 3 && !params->depth)) {
-                LOG(ERROR, "invalid texture dimensions %dx%dx%d",
-                    params->width, params->height, params->depth);
-                ngli_texture_reset(s);
-                return NGL_ERROR_INVALID_ARG;
-            }
-            if (params->immutable) {
+
+        /*
+         * The sampling parameters of the textures owned by the library are
+         * held by shared sampler objects, bound along with the textures
+         */
+        if ((gl->features & NGLI_FEATURE_SAMPLER_OBJECT) && !s->external_storage &&
+            (s->target == GL_TEXTURE_2D || s->target == GL_TEXTURE_3D || s->target == GL_TEXTURE_CUBE_MAP)) {
+            const struct sampler_key key = {
+                .min_filter = min_filter,
+                .mag_filter = mag_filter,
+                .wrap_s     = wrap_s,
+                .wrap_t     = wrap_t,
+                .wrap_r     = wrap_r,
+            };
+            s->sampler = ngli_samplercache_get(&ctx->sampler_cache, &key);
+        }
+
+        if (!s->sampler) {
+            ngli_glTexParameteri(gl, s->target, GL_TEXTURE_MIN_FILTER, min_filter);
+            ngli_glTexParameteri(gl, s->target, GL_TEXTURE_MAG_FILTER, mag_filter);
+            ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_S, wrap_s);
+            ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_T, wrap_t);
+            if (s->target == GL_TEXTURE_3D || s->target == GL_TEXTURE_CUBE_MAP)
+                ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_R, wrap_r);
+        }
+
+        if (!s->external_storage && !recycled) {
+            /* Mutable compressed images are only specified with their data */
+            if (s->immutable) {
                 texture_set_storage(s);
-            } else {
+            } else if (!ngli_format_is_compressed(params->format)) {
                 texture_set_image(s, NULL);
             }
         }
     }
 
+    if (!s->external_storage)
+        ctx->stats.memory[get_memory_category(s)] += texture_get_pool_size(s);
+
     return 0;
 }
 
@@ -392,6 +518,9 @@ void ngli_texture_set_id(struct texture *s, GLuint id)
     /* only wrapped textures can update their id with this function */
     ngli_assert(s->wrapped);
 
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    ngli_glstate_forget_texture(gl, s->id);
     s->id = id;
 }
 
@@ -417,6 +546,24 @@ int ngli_texture_match_dimensions(const struct texture *s, int width, int height
     return params->width == width && params->height == height && params->depth == depth;
 }
 
+GLuint64 ngli_texture_get_handle(struct texture *s)
+{
+    if (s->handle)
+        return s->handle;
+
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    if (!ctx->config.bindless_textures || !(gl->features & NGLI_FEATURE_BINDLESS_TEXTURE) ||
+        s->external_storage || !s->immutable)
+        return 0;
+
+    s->handle = s->sampler ? ngli_glGetTextureSamplerHandleARB(gl, s->id, s->sampler)
+                           : ngli_glGetTextureHandleARB(gl, s->id);
+    if (s->handle)
+        ngli_glMakeTextureHandleResidentARB(gl, s->handle);
+    return s->handle;
+}
+
 int ngli_texture_upload(struct texture *s, const uint8_t *data, int linesize)
 {
 
@@ -428,17 +575,217 @@ int ngli_texture_upload(struct texture *s, const uint8_t *data, int linesize)
      * buffers) cannot update their content with this function */
     ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
 
-    ngli_glBindTexture(gl, s->target, s->id);
+    if (ngli_format_is_compressed(params->format))
+        return data ? ngli_texture_upload_compressed(s, 0, data, texture_get_data_size(s)) : 0;
+
+    ngli_glstate_bind_texture(gl, s->target, s->id);
     if (data) {
-        texture_set_sub_image(s, data, linesize);
+        ctx->stats.uploaded_bytes += texture_get_data_size(s);
+        texture_set_sub_image(s, gl, data, linesize);
         if (ngli_texture_has_mipmap(s))
             ngli_glGenerateMipmap(gl, s->target);
     }
-    ngli_glBindTexture(gl, s->target, 0);
+    ngli_glstate_bind_texture(gl, s->target, 0);
+
+    return 0;
+}
+
+int ngli_texture_upload_region(struct texture *s, const uint8_t *data, int linesize,
+                               int x, int y, int width, int height)
+{
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(x >= 0 && y >= 0 && x <= params->width && y <= params->height);
+
+    if (!linesize)
+        linesize = params->width;
+
+    data += ((int64_t)y * linesize + x) * s->bytes_per_pixel;
+    return ngli_texture_upload_sub_image(s, data, linesize, x, y, width, height);
+}
+
+int ngli_texture_upload_sub_image(struct texture *s, const uint8_t *data, int linesize,
+                                  int x, int y, int width, int height)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
+    ngli_assert(s->target == GL_TEXTURE_2D && !ngli_format_is_compressed(params->format));
+    ngli_assert(x >= 0 && y >= 0 && width >= 0 && height >= 0 &&
+                x + width <= params->width && y + height <= params->height);
+
+    if (!width || !height)
+        return 0;
+
+    if (!linesize)
+        linesize = width;
+
+    ngli_glstate_bind_texture(gl, s->target, s->id);
+    ctx->stats.uploaded_bytes += ngli_format_get_image_size(params->format, width, height);
+    const int row_upload = set_unpack_state(s, gl, linesize, width);
+    texture2d_set_sub_image(s, gl, data, linesize, row_upload, x, y, width, height);
+    reset_unpack_state(s, gl);
+    if (ngli_texture_has_mipmap(s))
+        ngli_glGenerateMipmap(gl, s->target);
+    ngli_glstate_bind_texture(gl, s->target, 0);
+
+    return 0;
+}
+
+int ngli_texture_upload_rows(struct texture *s, const uint8_t *data, int linesize, int y, int height)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
+    ngli_assert(s->target == GL_TEXTURE_2D && !ngli_format_is_compressed(params->format));
+    ngli_assert(y >= 0 && height >= 0 && y + height <= params->height);
+
+    if (!height)
+        return 0;
+
+    if (!linesize)
+        linesize = params->width;
+
+    data += (int64_t)y * linesize * s->bytes_per_pixel;
+    ngli_glstate_bind_texture(gl, s->target, s->id);
+    ctx->stats.uploaded_bytes += ngli_format_get_image_size(params->format, params->width, height);
+    const int row_upload = set_unpack_state(s, gl, linesize, params->width);
+    texture2d_set_sub_image(s, gl, data, linesize, row_upload, 0, y, params->width, height);
+    reset_unpack_state(s, gl);
+    if (y + height == params->height && ngli_texture_has_mipmap(s))
+        ngli_glGenerateMipmap(gl, s->target);
+    ngli_glstate_bind_texture(gl, s->target, 0);
+
+    return 0;
+}
+
+int ngli_texture_upload_from_buffer(struct texture *s, GLuint buffer, int offset, int linesize)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
+    ngli_assert(!ngli_format_is_compressed(params->format));
+
+    /* With a pixel unpack buffer bound, the data pointer is an offset in the buffer */
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, buffer);
+    ngli_glstate_bind_texture(gl, s->target, s->id);
+    ctx->stats.uploaded_bytes += texture_get_data_size(s);
+    texture_set_sub_image(s, gl, (const uint8_t *)(uintptr_t)offset, linesize);
+    if (ngli_texture_has_mipmap(s))
+        ngli_glGenerateMipmap(gl, s->target);
+    ngli_glstate_bind_texture(gl, s->target, 0);
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return 0;
+}
+
+int ngli_texture_upload_shared(struct texture *s, struct glcontext *gl, const uint8_t *data, int linesize)
+{
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
+    ngli_assert(!ngli_format_is_compressed(params->format));
+
+    ngli_glstate_bind_texture(gl, s->target, s->id);
+    texture_set_sub_image(s, gl, data, linesize);
+    ngli_glstate_bind_texture(gl, s->target, 0);
+
+    return 0;
+}
+
+int ngli_texture_upload_from_buffer_shared(struct texture *s, struct glcontext *gl,
+                                           GLuint buffer, int offset, int linesize)
+{
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
+    ngli_assert(!ngli_format_is_compressed(params->format));
+
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, buffer);
+    ngli_glstate_bind_texture(gl, s->target, s->id);
+    texture_set_sub_image(s, gl, (const uint8_t *)(uintptr_t)offset, linesize);
+    ngli_glstate_bind_texture(gl, s->target, 0);
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return 0;
+}
+
+int ngli_texture_upload_compressed(struct texture *s, int level, const uint8_t *data, int size)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    const struct texture_params *params = &s->params;
+
+    ngli_assert(ngli_format_is_compressed(params->format) && s->target == GL_TEXTURE_2D);
+
+    if (level >= get_mipmap_levels(s))
+        return 0;
+
+    const int width  = NGLI_MAX(params->width  >> level, 1);
+    const int height = NGLI_MAX(params->height >> level, 1);
+    const int64_t image_size = ngli_format_get_image_size(params->format, width, height);
+    if (size < image_size) {
+        LOG(ERROR, "compressed image level %d is too small for %dx%d", level, width, height);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    ngli_glstate_bind_texture(gl, s->target, s->id);
+    ctx->stats.uploaded_bytes += image_size;
+    if (s->immutable)
+        ngli_glCompressedTexSubImage2D(gl, s->target, level, 0, 0, width, height, s->internal_format, image_size, data);
+    else
+        ngli_glCompressedTexImage2D(gl, s->target, level, s->internal_format, width, height, 0, image_size, data);
+    ngli_glstate_bind_texture(gl, s->target, 0);
 
     return 0;
 }
 
+/*
+ * Downsample every level from the previous one with a linear blit, which is
+ * faster than glGenerateMipmap() on some drivers. All the levels must have
+ * been allocated, which is only guaranteed with immutable storage.
+ */
+static void generate_mipmap_blit(struct texture *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    const struct texture_params *params = &s->params;
+
+    GLuint fbos[2];
+    ngli_glGenFramebuffers(gl, 2, fbos);
+    ngli_glBindFramebuffer(gl, GL_READ_FRAMEBUFFER, fbos[0]);
+    ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, fbos[1]);
+
+    const int nb_faces = s->target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    const int nb_levels = get_mipmap_levels(s);
+    for (int face = 0; face < nb_faces; face++) {
+        const GLenum target = nb_faces > 1 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : s->target;
+        int width = params->width;
+        int height = params->height;
+        for (int level = 1; level < nb_levels; level++) {
+            const int dst_width  = NGLI_MAX(width  >> 1, 1);
+            const int dst_height = NGLI_MAX(height >> 1, 1);
+            ngli_glFramebufferTexture2D(gl, GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, s->id, level - 1);
+            ngli_glFramebufferTexture2D(gl, GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, s->id, level);
+            ngli_glBlitFramebuffer(gl, 0, 0, width, height, 0, 0, dst_width, dst_height,
+                                   GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            width = dst_width;
+            height = dst_height;
+        }
+    }
+
+    struct rendertarget *rt = ctx->rendertarget;
+    const GLuint fbo_id = rt ? rt->id : ngli_glcontext_get_default_framebuffer(gl);
+    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+    ngli_glDeleteFramebuffers(gl, 2, fbos);
+}
+
 int ngli_texture_generate_mipmap(struct texture *s)
 {
     struct ngl_ctx *ctx = s->ctx;
@@ -447,24 +794,72 @@ int ngli_texture_generate_mipmap(struct texture *s)
 
     ngli_assert(!(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
 
-    ngli_glBindTexture(gl, s->target, s->id);
+    s->mipmap_outdated = 0;
+    if (params->mipmap_generation == NGLI_MIPMAP_GENERATION_BLIT && s->immutable &&
+        (s->target == GL_TEXTURE_2D || s->target == GL_TEXTURE_CUBE_MAP) &&
+        (gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT)) {
+        generate_mipmap_blit(s);
+        return 0;
+    }
+
+    ngli_glstate_bind_texture(gl, s->target, s->id);
     ngli_glGenerateMipmap(gl, s->target);
     return 0;
 }
 
+void ngli_texture_invalidate_mipmap(struct texture *s)
+{
+    if (ngli_texture_has_mipmap(s))
+        s->mipmap_outdated = 1;
+}
+
+void ngli_texture_update_mipmap(struct texture *s)
+{
+    if (s->mipmap_outdated)
+        ngli_texture_generate_mipmap(s);
+}
+
+void ngli_texture_delete(struct glcontext *gl, GLenum target, GLuint id)
+{
+    if (target == GL_RENDERBUFFER)
+        ngli_glDeleteRenderbuffers(gl, 1, &id);
+    else
+        ngli_glDeleteTextures(gl, 1, &id);
+}
+
+void ngli_texture_sync(struct texture *s)
+{
+    if (s->upload_job)
+        ngli_uploader_sync(s->ctx->uploader, s->upload_job);
+}
+
 void ngli_texture_reset(struct texture *s)
 {
     struct ngl_ctx *ctx = s->ctx;
     if (!ctx)
         return;
 
+    ngli_texture_sync(s);
+
     struct glcontext *gl = ctx->glcontext;
 
-    if (!s->wrapped) {
-        if (s->target == GL_RENDERBUFFER)
-            ngli_glDeleteRenderbuffers(gl, 1, &s->id);
-        else
-            ngli_glDeleteTextures(gl, 1, &s->id);
+    if (s->target != GL_RENDERBUFFER)
+        ngli_glstate_forget_texture(gl, s->id);
+
+    if (s->id && !s->external_storage)
+        ctx->stats.memory[get_memory_category(s)] -= texture_get_pool_size(s);
+
+    /* The parameters of a texture with a handle are frozen, so it can not be
+     * recycled by a texture with different ones */
+    if (s->handle) {
+        ngli_glMakeTextureHandleNonResidentARB(gl, s->handle);
+        ngli_texture_delete(gl, s->target, s->id);
+    } else if (texture_is_poolable(s)) {
+        struct texturepool_key key;
+        texture_get_pool_key(s, &key);
+        ngli_texturepool_put(&ctx->texture_pool, &key, texture_get_pool_size(s), s->id);
+    } else if (!s->wrapped) {
+        ngli_texture_delete(gl, s->target, s->id);
     }
 
     memset(s, 0, sizeof(*s));
@@ -39,6 +39,12 @@ enum {
     NGLI_NB_FILTER
 };
 
+enum {
+    NGLI_MIPMAP_GENERATION_DRIVER,
+    NGLI_MIPMAP_GENERATION_BLIT,
+    NGLI_NB_MIPMAP_GENERATION
+};
+
 GLint ngli_texture_get_gl_min_filter(int min_filter, int mipmap_filter);
 GLint ngli_texture_get_gl_mag_filter(int mag_filter);
 
@@ -76,6 +82,9 @@ GLenum ngli_texture_get_gl_access(int access);
 }
 
 #define NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY (1 << 0)
+/* Multisample attachment combined with implicitly resolved attachments
+ * (see rendertarget_params.implicit_samples) */
+#define NGLI_TEXTURE_USAGE_IMPLICIT_MULTISAMPLE (1 << 1)
 
 struct texture_params {
     int dimensions;
@@ -87,23 +96,29 @@ struct texture_params {
     int min_filter;
     int mag_filter;
     int mipmap_filter;
+    int mipmap_generation;
     int wrap_s;
     int wrap_t;
     int wrap_r;
     int access;
-    int immutable;
     int usage;
     int external_storage;
     int external_oes;
     int rectangle;
     int cubemap;
+    int array;         // 2D array of depth layers, only used as render target attachment
+    int mipmap_levels; // number of levels provided with compressed formats
 };
 
+struct uploader_job;
+
 struct texture {
     struct ngl_ctx *ctx;
     struct texture_params params;
     int wrapped;
     int external_storage;
+    int immutable;
+    int mipmap_outdated;
     int bytes_per_pixel;
 
     GLenum target;
@@ -111,6 +126,9 @@ struct texture {
     GLint format;
     GLint internal_format;
     GLenum format_type;
+    GLuint64 handle;
+    GLuint sampler; /* shared sampler object holding the sampling parameters, if any */
+    struct uploader_job *upload_job; /* upload running on the upload thread, see ngli_texture_sync() */
 };
 
 int ngli_texture_init(struct texture *s,
@@ -128,9 +146,85 @@ void ngli_texture_set_dimensions(struct texture *s, int width, int height, int d
 int ngli_texture_has_mipmap(const struct texture *s);
 int ngli_texture_match_dimensions(const struct texture *s, int width, int height, int depth);
 
+/*
+ * Return the resident bindless handle of the texture, created on the first
+ * call, or 0 if the texture must be bound to a texture unit instead: the
+ * context is not configured with bindless_textures (or does not support
+ * them), or the texture storage is not owned and immutable. The texture
+ * parameters can not be changed anymore once the handle exists.
+ */
+GLuint64 ngli_texture_get_handle(struct texture *s);
+
 int ngli_texture_upload(struct texture *s, const uint8_t *data, int linesize);
+
+/*
+ * Upload only a rectangle of a 2D texture, read from an image of the texture
+ * dimensions (and the given linesize) which is only partially updated.
+ */
+int ngli_texture_upload_region(struct texture *s, const uint8_t *data, int linesize,
+                               int x, int y, int width, int height);
+
+/*
+ * Upload an image of the given dimensions (and linesize) into the rectangle
+ * of a 2D texture located at x, y.
+ */
+int ngli_texture_upload_sub_image(struct texture *s, const uint8_t *data, int linesize,
+                               int x, int y, int width, int height);
+
+/*
+ * Upload the rows [y, y + height) of a 2D texture, read from an image of the
+ * texture dimensions (and the given linesize). The mipmap levels are only
+ * regenerated once the last row is written, so an image can be uploaded in
+ * several calls.
+ */
+int ngli_texture_upload_rows(struct texture *s, const uint8_t *data, int linesize, int y, int height);
+
+/*
+ * Upload one mipmap level of a texture using a compressed format, the data
+ * being the level image as stored in the client texture container.
+ */
+int ngli_texture_upload_compressed(struct texture *s, int level, const uint8_t *data, int size);
+
+/*
+ * Upload the texture content from a pixel unpack buffer, starting at offset
+ * bytes, the transfer is asynchronous with regard to the CPU.
+ */
+int ngli_texture_upload_from_buffer(struct texture *s, GLuint buffer, int offset, int linesize);
+
+/*
+ * Variants of ngli_texture_upload() and ngli_texture_upload_from_buffer()
+ * issuing the transfer in the given context, which can be another context
+ * sharing the texture (such as the upload thread one, see uploader.h). The
+ * mipmap levels and the upload statistics are left to the caller.
+ */
+int ngli_texture_upload_shared(struct texture *s, struct glcontext *gl, const uint8_t *data, int linesize);
+int ngli_texture_upload_from_buffer_shared(struct texture *s, struct glcontext *gl,
+                                           GLuint buffer, int offset, int linesize);
+
 int ngli_texture_generate_mipmap(struct texture *s);
 
+/*
+ * Mark the mipmap levels as outdated after the base level got written by the
+ * GPU, they are regenerated only when the texture is next sampled, with
+ * ngli_texture_update_mipmap().
+ */
+void ngli_texture_invalidate_mipmap(struct texture *s);
+void ngli_texture_update_mipmap(struct texture *s);
+
+/*
+ * Release a texture (or render buffer) storage, bypassing the context texture
+ * pool.
+ */
+void ngli_texture_delete(struct glcontext *gl, GLenum target, GLuint id);
+
+/*
+ * Wait for the upload of the texture running on the upload thread, if any,
+ * before the rendering context uses it. Only the GPU of the rendering
+ * context waits for the transfer, the CPU only waits for the upload thread
+ * to submit it.
+ */
+void ngli_texture_sync(struct texture *s);
+
 void ngli_texture_reset(struct texture *s);
 
 #endif
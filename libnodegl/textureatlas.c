@@ -0,0 +1,209 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "format.h"
+#include "log.h"
+#include "math_utils.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "textureatlas.h"
+
+#define PADDING 1
+
+void ngli_textureatlas_init(struct textureatlas *s, struct ngl_ctx *ctx)
+{
+    s->ctx = ctx;
+    ngli_darray_init(&s->pages, sizeof(struct textureatlas_page *), 0);
+}
+
+static int is_packable(const struct texture_params *params)
+{
+    return params->dimensions == 2 &&
+           !params->cubemap && !params->rectangle &&
+           !params->external_storage && !params->external_oes &&
+           !params->samples && !params->usage &&
+           params->width > 0 && params->width <= NGLI_TEXTUREATLAS_MAX_SIZE &&
+           params->height > 0 && params->height <= NGLI_TEXTUREATLAS_MAX_SIZE &&
+           params->mipmap_filter == NGLI_MIPMAP_FILTER_NONE &&
+           params->wrap_s == NGLI_WRAP_CLAMP_TO_EDGE &&
+           params->wrap_t == NGLI_WRAP_CLAMP_TO_EDGE &&
+           !ngli_format_is_compressed(params->format);
+}
+
+static int page_matches(const struct textureatlas_page *page, const struct texture_params *params)
+{
+    const struct texture_params *page_params = &page->texture.params;
+    return page_params->format     == params->format &&
+           page_params->min_filter == params->min_filter &&
+           page_params->mag_filter == params->mag_filter;
+}
+
+static struct textureatlas_page *create_page(struct textureatlas *s, const struct texture_params *params)
+{
+    struct textureatlas_page *page = ngli_calloc(1, sizeof(*page));
+    if (!page)
+        return NULL;
+
+    struct texture_params page_params = NGLI_TEXTURE_PARAM_DEFAULTS;
+    page_params.format = params->format;
+    page_params.width = NGLI_TEXTUREATLAS_PAGE_SIZE;
+    page_params.height = NGLI_TEXTUREATLAS_PAGE_SIZE;
+    page_params.min_filter = params->min_filter;
+    page_params.mag_filter = params->mag_filter;
+    page_params.access = NGLI_ACCESS_READ_BIT;
+
+    if (ngli_texture_init(&page->texture, s->ctx, &page_params) < 0) {
+        ngli_free(page);
+        return NULL;
+    }
+    ngli_shelfpack_init(&page->shelves, NGLI_TEXTUREATLAS_PAGE_SIZE, NGLI_TEXTUREATLAS_PAGE_SIZE);
+
+    if (!ngli_darray_push(&s->pages, &page)) {
+        ngli_shelfpack_reset(&page->shelves);
+        ngli_texture_reset(&page->texture);
+        ngli_free(page);
+        return NULL;
+    }
+    return page;
+}
+
+/*
+ * Copy the image into dst, surrounded by PADDING copies of its edges (the
+ * equivalent of the clamp to edge wrapping).
+ */
+static void pad_image(uint8_t *dst, const uint8_t *src, int width, int height, int bpp)
+{
+    const int dst_width = width + 2 * PADDING;
+    for (int y = 0; y < height + 2 * PADDING; y++) {
+        const int src_y = NGLI_MIN(NGLI_MAX(y - PADDING, 0), height - 1);
+        const uint8_t *src_line = src + (int64_t)src_y * width * bpp;
+        uint8_t *dst_line = dst + (int64_t)y * dst_width * bpp;
+        for (int x = 0; x < PADDING; x++) {
+            memcpy(dst_line + x * bpp, src_line, bpp);
+            memcpy(dst_line + (PADDING + width + x) * bpp, src_line + (width - 1) * bpp, bpp);
+        }
+        memcpy(dst_line + PADDING * bpp, src_line, width * bpp);
+    }
+}
+
+int ngli_textureatlas_add(struct textureatlas *s, const struct texture_params *params,
+                          const uint8_t *data, struct textureatlas_region *region)
+{
+    memset(region, 0, sizeof(*region));
+
+    if (!data || !is_packable(params))
+        return 0;
+
+    const int padded_width = params->width + 2 * PADDING;
+    const int padded_height = params->height + 2 * PADDING;
+
+    struct textureatlas_page *page = NULL;
+    int x, y;
+    struct textureatlas_page **pages = ngli_darray_data(&s->pages);
+    for (int i = 0; i < ngli_darray_count(&s->pages); i++) {
+        if (page_matches(pages[i], params) &&
+            ngli_shelfpack_alloc(&pages[i]->shelves, padded_width, padded_height, &x, &y) == 0) {
+            page = pages[i];
+            break;
+        }
+    }
+
+    if (!page) {
+        page = create_page(s, params);
+        if (!page)
+            return NGL_ERROR_MEMORY;
+        int ret = ngli_shelfpack_alloc(&page->shelves, padded_width, padded_height, &x, &y);
+        if (ret < 0)
+            return ret;
+    }
+
+    const int bpp = ngli_format_get_bytes_per_pixel(params->format);
+    uint8_t *padded = ngli_malloc((int64_t)padded_width * padded_height * bpp);
+    if (!padded)
+        return NGL_ERROR_MEMORY;
+    pad_image(padded, data, params->width, params->height, bpp);
+    int ret = ngli_texture_upload_sub_image(&page->texture, padded, padded_width,
+                                            x, y, padded_width, padded_height);
+    ngli_free(padded);
+    if (ret < 0)
+        return ret;
+
+    page->nb_regions++;
+    region->page = page;
+    region->x = x + PADDING;
+    region->y = y + PADDING;
+    region->width = params->width;
+    region->height = params->height;
+    TRACE("pack %dx%d image at (%d,%d) in atlas page %p",
+          region->width, region->height, region->x, region->y, page);
+    return 0;
+}
+
+void ngli_textureatlas_get_coordinates_matrix(const struct textureatlas_region *region, float *matrix)
+{
+    const float size = NGLI_TEXTUREATLAS_PAGE_SIZE;
+    ngli_mat4_identity(matrix);
+    matrix[0]  = region->width  / size;
+    matrix[5]  = region->height / size;
+    matrix[12] = region->x / size;
+    matrix[13] = region->y / size;
+}
+
+static void release_page(struct textureatlas_page *page)
+{
+    ngli_shelfpack_reset(&page->shelves);
+    ngli_texture_reset(&page->texture);
+    ngli_free(page);
+}
+
+void ngli_textureatlas_remove(struct textureatlas *s, struct textureatlas_region *region)
+{
+    struct textureatlas_page *page = region->page;
+    if (!page)
+        return;
+    memset(region, 0, sizeof(*region));
+
+    if (--page->nb_regions)
+        return;
+
+    /* The space of the regions is not reclaimed, so the page is only released with its last region */
+    struct textureatlas_page **pages = ngli_darray_data(&s->pages);
+    const int count = ngli_darray_count(&s->pages);
+    for (int i = 0; i < count; i++) {
+        if (pages[i] == page) {
+            memmove(&pages[i], &pages[i + 1], (count - i - 1) * sizeof(*pages));
+            ngli_darray_pop(&s->pages);
+            break;
+        }
+    }
+    release_page(page);
+}
+
+void ngli_textureatlas_reset(struct textureatlas *s)
+{
+    struct textureatlas_page **pages = ngli_darray_data(&s->pages);
+    for (int i = 0; i < ngli_darray_count(&s->pages); i++)
+        release_page(pages[i]);
+    ngli_darray_reset(&s->pages);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <stdint.h>
+
+#include "darray.h"
+#include "shelfpack.h"
+#include "texture.h"
+
+#define NGLI_TEXTUREATLAS_PAGE_SIZE 1024
+#define NGLI_TEXTUREATLAS_MAX_SIZE  256 /* largest packed width or height */
+
+struct ngl_ctx;
+
+struct textureatlas_page {
+    struct texture texture;
+    struct shelfpack shelves;
+    int nb_regions;
+};
+
+struct textureatlas_region {
+    struct textureatlas_page *page; /* NULL if the image is not packed */
+    int x, y, width, height;
+};
+
+/*
+ * Shared 2D textures holding many small images side by side, each of them
+ * surrounded by a copy of its edges so that the filtering does not bleed
+ * across the neighbouring images. A page is created for every combination
+ * of format and filters, and is released along with its last region.
+ */
+struct textureatlas {
+    struct ngl_ctx *ctx;
+    struct darray pages; /* struct textureatlas_page pointers */
+};
+
+void ngli_textureatlas_init(struct textureatlas *s, struct ngl_ctx *ctx);
+
+/*
+ * Pack the image (tightly packed data of the texture dimensions) of a
+ * texture with the given parameters into the atlas. Only the small 2D
+ * textures without mipmaps, with a clamp to edge wrapping and an
+ * uncompressed format can be packed: region->page is set to NULL
+ * otherwise.
+ */
+int ngli_textureatlas_add(struct textureatlas *s, const struct texture_params *params,
+                          const uint8_t *data, struct textureatlas_region *region);
+
+/*
+ * Set the matrix mapping the texture coordinates of the image to the
+ * coordinates of its region in the page texture.
+ */
+void ngli_textureatlas_get_coordinates_matrix(const struct textureatlas_region *region, float *matrix);
+
+void ngli_textureatlas_remove(struct textureatlas *s, struct textureatlas_region *region);
+
+void ngli_textureatlas_reset(struct textureatlas *s);
+
+#endif
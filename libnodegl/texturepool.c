@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "log.h"
+#include "texturepool.h"
+
+void ngli_texturepool_init(struct texturepool *s, int64_t max_size,
+                           texturepool_release_func_type release, void *user_arg)
+{
+    ngli_darray_init(&s->entries, sizeof(struct texturepool_entry), 0);
+    s->size = 0;
+    s->max_size = max_size;
+    s->release = release;
+    s->user_arg = user_arg;
+}
+
+static void remove_entry(struct texturepool *s, int index)
+{
+    struct texturepool_entry *entries = ngli_darray_data(&s->entries);
+    const int count = ngli_darray_count(&s->entries);
+    s->size -= entries[index].size;
+    memmove(&entries[index], &entries[index + 1], (count - index - 1) * sizeof(*entries));
+    ngli_darray_pop(&s->entries);
+}
+
+GLuint ngli_texturepool_get(struct texturepool *s, const struct texturepool_key *key)
+{
+    const struct texturepool_entry *entries = ngli_darray_data(&s->entries);
+    for (int i = ngli_darray_count(&s->entries) - 1; i >= 0; i--) {
+        if (!memcmp(&entries[i].key, key, sizeof(*key))) {
+            const GLuint id = entries[i].id;
+            remove_entry(s, i);
+            return id;
+        }
+    }
+    return 0;
+}
+
+void ngli_texturepool_put(struct texturepool *s, const struct texturepool_key *key, int64_t size, GLuint id)
+{
+    if (size > s->max_size) {
+        s->release(s->user_arg, key, id);
+        return;
+    }
+
+    while (s->size + size > s->max_size) {
+        const struct texturepool_entry *entry = ngli_darray_get(&s->entries, 0);
+        TRACE("evict texture %u (%dx%dx%d) from the pool",
+              entry->id, entry->key.width, entry->key.height, entry->key.depth);
+        s->release(s->user_arg, &entry->key, entry->id);
+        remove_entry(s, 0);
+    }
+
+    const struct texturepool_entry entry = {.key = *key, .size = size, .id = id};
+    if (!ngli_darray_push(&s->entries, &entry)) {
+        s->release(s->user_arg, key, id);
+        return;
+    }
+    s->size += size;
+}
+
+void ngli_texturepool_reset(struct texturepool *s)
+{
+    const struct texturepool_entry *entries = ngli_darray_data(&s->entries);
+    for (int i = 0; i < ngli_darray_count(&s->entries); i++)
+        s->release(s->user_arg, &entries[i].key, entries[i].id);
+    ngli_darray_reset(&s->entries);
+    memset(s, 0, sizeof(*s));
+}
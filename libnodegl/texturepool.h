@@ -0,0 +1,81 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TEXTUREPOOL_H
+#define TEXTUREPOOL_H
+
+#include <stdint.h>
+
+#include "darray.h"
+#include "glincludes.h"
+
+struct texturepool_key {
+    GLenum target;
+    GLint internal_format;
+    GLenum format_type;
+    int width;
+    int height;
+    int depth;
+    int levels;
+    int samples;
+    int immutable;
+};
+
+typedef void (*texturepool_release_func_type)(void *user_arg, const struct texturepool_key *key, GLuint id);
+
+struct texturepool_entry {
+    struct texturepool_key key;
+    int64_t size;
+    GLuint id;
+};
+
+/*
+ * Storage of released textures (or render buffers), waiting to be recycled
+ * by a texture with matching properties. The entries are kept in release
+ * order so that the least recently released ones get evicted first whenever
+ * the total size exceeds the memory cap.
+ */
+struct texturepool {
+    struct darray entries;
+    int64_t size;
+    int64_t max_size;
+    texturepool_release_func_type release;
+    void *user_arg;
+};
+
+void ngli_texturepool_init(struct texturepool *s, int64_t max_size,
+                           texturepool_release_func_type release, void *user_arg);
+
+/*
+ * Take out of the pool the most recently released entry matching key and
+ * return its identifier, or 0 if there is none.
+ */
+GLuint ngli_texturepool_get(struct texturepool *s, const struct texturepool_key *key);
+
+/*
+ * Hand over the ownership of the texture id to the pool. The texture is
+ * released immediately if it can not be kept around.
+ */
+void ngli_texturepool_put(struct texturepool *s, const struct texturepool_key *key, int64_t size, GLuint id);
+
+void ngli_texturepool_reset(struct texturepool *s);
+
+#endif
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "image.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "texvideo.h"
+
+#define MAX_KEYS 16
+#define MAX_KEY_LEN 64
+
+static const char yuv2rgb_matrix[] =
+    "const mat4 ngli_texvideo_yuv2rgb = mat4("                              "\n"
+    "    1.164,     1.164,    1.164,   0.0,"                                "\n"
+    "    0.0,      -0.213,    2.112,   0.0,"                                "\n"
+    "    1.787,    -0.531,    0.0,     0.0,"                                "\n"
+    "   -0.96625,   0.29925, -1.12875, 1.0);"                               "\n";
+
+static int is_ident_char(int c)
+{
+    return isalnum(c) || c == '_';
+}
+
+static const char *skip_spaces(const char *p)
+{
+    while (*p && isspace(*p))
+        p++;
+    return p;
+}
+
+static int has_word(const char *src, const char *word)
+{
+    const size_t len = strlen(word);
+    const char *p = src;
+    while ((p = strstr(p, word))) {
+        if ((p == src || !is_ident_char(p[-1])) && !is_ident_char(p[len]))
+            return 1;
+        p += len;
+    }
+    return 0;
+}
+
+static int use_texture_func(const char *src)
+{
+    const char *p = strstr(src, "#version");
+    if (!p)
+        return 0;
+    p = skip_spaces(p + strlen("#version"));
+    const int version = atoi(p);
+    while (isdigit(*p))
+        p++;
+    const int es = version == 100 || !strncmp(skip_spaces(p), "es", 2);
+    return es ? version >= 300 : version >= 130;
+}
+
+/*
+ * The generated code must be inserted after the #version and #extension
+ * directives, which must come first in the shader
+ */
+static const char *get_insert_point(const char *src)
+{
+    const char *p = src;
+    for (;;) {
+        const char *line = skip_spaces(p);
+        if (strncmp(line, "#version", 8) && strncmp(line, "#extension", 10))
+            return line;
+        const char *eol = strchr(line, '\n');
+        if (!eol)
+            return line + strlen(line);
+        p = eol + 1;
+    }
+}
+
+/*
+ * The generated code is inserted right before the top-level declaration
+ * holding the first ngl_texvideo() call so it can reference the uniforms and
+ * precision qualifiers the user declared above it
+ */
+static const char *get_code_point(const char *start, const char *call)
+{
+    const char *ret = start;
+    int depth = 0;
+    for (const char *p = start; p < call; p++) {
+        if (*p == '{') {
+            depth++;
+        } else if (*p == '}' || *p == ';') {
+            if (*p == '}')
+                depth--;
+            if (!depth)
+                ret = p + 1;
+        }
+    }
+    return ret == start ? start : skip_spaces(ret);
+}
+
+static void declare_uniform(struct bstr *b, const char *type, const char *key, const char *suffix)
+{
+    char name[MAX_KEY_LEN + 32];
+    snprintf(name, sizeof(name), "%.*s_%s", MAX_KEY_LEN - 1, key, suffix);
+    if (!has_word(ngli_bstr_strptr(b), name))
+        ngli_bstr_print(b, "uniform %s %s;\n", type, name);
+}
+
+static void generate_function(struct bstr *b, const char *key,
+                              const char *tex, const char *uv)
+{
+    declare_uniform(b, "int", key, "sampling_mode");
+    declare_uniform(b, "sampler2D", key, "sampler");
+#if defined(TARGET_ANDROID)
+    declare_uniform(b, "samplerExternalOES", key, "external_sampler");
+#elif defined(TARGET_DARWIN)
+    const int rect = !strcmp(tex, "texture");
+    if (rect) {
+        declare_uniform(b, "vec2", key, "dimensions");
+        declare_uniform(b, "sampler2DRect", key, "y_rect_sampler");
+        declare_uniform(b, "sampler2DRect", key, "uv_rect_sampler");
+    }
+#else
+    declare_uniform(b, "sampler2D", key, "y_sampler");
+    declare_uniform(b, "sampler2D", key, "uv_sampler");
+#endif
+
+    ngli_bstr_print(b, "vec4 ngl_texvideo_%s(vec2 coords)\n{\n", key);
+#if defined(TARGET_ANDROID)
+    ngli_bstr_print(b, "    if (%s_sampling_mode == %d)\n"
+                       "        return %s(%s_external_sampler, coords);\n",
+                    key, NGLI_IMAGE_LAYOUT_MEDIACODEC, tex, key);
+#elif defined(TARGET_DARWIN)
+    if (rect)
+        ngli_bstr_print(b, "    if (%s_sampling_mode == %d) {\n"
+                           "        vec2 rect_coords = coords * %s_dimensions;\n"
+                           "        vec3 yuv = vec3(%s(%s_y_rect_sampler, rect_coords).r,\n"
+                           "                        %s(%s_uv_rect_sampler, rect_coords * 0.5).%s);\n"
+                           "        return ngli_texvideo_yuv2rgb * vec4(yuv, 1.0);\n"
+                           "    }\n",
+                        key, NGLI_IMAGE_LAYOUT_NV12_RECTANGLE, key, tex, key, tex, key, uv);
+#else
+    ngli_bstr_print(b, "    if (%s_sampling_mode == %d) {\n"
+                       "        vec3 yuv = vec3(%s(%s_y_sampler, coords).r,\n"
+                       "                        %s(%s_uv_sampler, coords).%s);\n"
+                       "        return ngli_texvideo_yuv2rgb * vec4(yuv, 1.0);\n"
+                       "    }\n",
+                    key, NGLI_IMAGE_LAYOUT_NV12, tex, key, tex, key, uv);
+#endif
+    ngli_bstr_print(b, "    return %s(%s_sampler, coords);\n}\n", tex, key);
+}
+
+int ngli_texvideo_preprocess(const struct glcontext *gl, const char *src, char **dstp)
+{
+    *dstp = NULL;
+
+    if (!has_word(src, "ngl_texvideo"))
+        return 0;
+
+    int ret = 0;
+    char keys[MAX_KEYS][MAX_KEY_LEN];
+    int nb_keys = 0;
+
+    struct bstr *b = ngli_bstr_create();
+    struct bstr *body = ngli_bstr_create();
+    if (!b || !body) {
+        ret = NGL_ERROR_MEMORY;
+        goto end;
+    }
+
+    /* Rewrite every ngl_texvideo(key, ...) call into ngl_texvideo_key(...) */
+    const char *header_end = get_insert_point(src);
+    const char *first_call = strstr(header_end, "ngl_texvideo");
+    const char *insert = first_call ? get_code_point(header_end, first_call) : header_end;
+    const char *p = insert;
+    for (;;) {
+        const char *call = strstr(p, "ngl_texvideo");
+        if (!call) {
+            ngli_bstr_print(body, "%s", p);
+            break;
+        }
+
+        const char *args = call + strlen("ngl_texvideo");
+        if ((call > src && is_ident_char(call[-1])) || is_ident_char(*args)) {
+            ngli_bstr_print(body, "%.*s", (int)(args - p), p);
+            p = args;
+            continue;
+        }
+
+        const char *paren = skip_spaces(args);
+        const char *key = *paren == '(' ? skip_spaces(paren + 1) : paren;
+        const char *key_end = key;
+        while (is_ident_char(*key_end))
+            key_end++;
+        const int key_len = key_end - key;
+        const char *comma = skip_spaces(key_end);
+        if (*paren != '(' || !key_len || key_len >= MAX_KEY_LEN || *comma != ',') {
+            LOG(ERROR, "invalid ngl_texvideo() usage, expected ngl_texvideo(key, coords)");
+            ret = NGL_ERROR_INVALID_ARG;
+            goto end;
+        }
+
+        int i;
+        for (i = 0; i < nb_keys; i++)
+            if ((int)strlen(keys[i]) == key_len && !strncmp(keys[i], key, key_len))
+                break;
+        if (i == nb_keys) {
+            if (nb_keys == MAX_KEYS) {
+                LOG(ERROR, "ngl_texvideo() can not be used with more than %d textures", MAX_KEYS);
+                ret = NGL_ERROR_LIMIT_EXCEEDED;
+                goto end;
+            }
+            snprintf(keys[nb_keys++], MAX_KEY_LEN, "%.*s", key_len, key);
+        }
+
+        ngli_bstr_print(body, "%.*sngl_texvideo_%.*s(", (int)(call - p), p, key_len, key);
+        p = skip_spaces(comma + 1);
+    }
+
+    const int texture_func = use_texture_func(src);
+    const char *tex = texture_func ? "texture" : "texture2D";
+    const char *uv = gl->version < 300 ? "ra": "rg";
+
+    ngli_bstr_print(b, "%.*s", (int)(header_end - src), src);
+#if defined(TARGET_ANDROID)
+    ngli_bstr_print(b, "#extension %s : require\n",
+                    texture_func ? "GL_OES_EGL_image_external_essl3" : "GL_OES_EGL_image_external");
+#endif
+    ngli_bstr_print(b, "%.*s", (int)(insert - header_end), header_end);
+    if (!has_word(ngli_bstr_strptr(b), "precision"))
+        ngli_bstr_print(b, "#if defined(GL_ES)\nprecision mediump float;\n#endif\n");
+    ngli_bstr_print(b, "%s", yuv2rgb_matrix);
+    for (int i = 0; i < nb_keys; i++)
+        generate_function(b, keys[i], tex, uv);
+    ngli_bstr_print(b, "%s", ngli_bstr_strptr(body));
+
+    *dstp = ngli_bstr_strdup(b);
+    if (!*dstp)
+        ret = NGL_ERROR_MEMORY;
+
+end:
+    ngli_bstr_freep(&body);
+    ngli_bstr_freep(&b);
+    return ret;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TEXVIDEO_H
+#define TEXVIDEO_H
+
+#include "glcontext.h"
+
+/*
+ * Expand the ngl_texvideo(key, coords) calls of a fragment shader source into
+ * a generated sampling function, picking the color from whichever image
+ * layout the texture uses (including multi-planar layouts converted from YUV
+ * on the fly).
+ *
+ * On success, *dstp is set to the newly allocated shader source, or NULL if
+ * the source does not use ngl_texvideo().
+ */
+int ngli_texvideo_preprocess(const struct glcontext *gl, const char *src, char **dstp);
+
+#endif
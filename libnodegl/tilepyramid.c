@@ -0,0 +1,292 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#define _POSIX_C_SOURCE 200809L // fseeko(), stat()
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "tilepyramid.h"
+#include "utils.h"
+
+#define PYRAMID_MAGIC "NGLP"
+#define MAX_TILE_SIZE 8192
+
+struct pyramid_header {
+    char magic[4];
+    int32_t width;
+    int32_t height;
+    int32_t tile_size;
+    int64_t src_size;
+    int64_t src_mtime;
+};
+
+static int64_t get_tile_size(const struct tilepyramid *s)
+{
+    return (int64_t)s->tile_size * s->tile_size * NGLI_TILEPYRAMID_PIXEL_SIZE;
+}
+
+static int64_t init_levels(struct tilepyramid *s, int width, int height)
+{
+    const int tile_size = s->tile_size;
+    int64_t offset = sizeof(struct pyramid_header);
+    for (;;) {
+        if (s->nb_levels == NGLI_TILEPYRAMID_MAX_LEVELS)
+            return NGL_ERROR_LIMIT_EXCEEDED;
+        struct tilepyramid_level *level = &s->levels[s->nb_levels++];
+        level->width = width;
+        level->height = height;
+        level->nb_tiles_x = (width + tile_size - 1) / tile_size;
+        level->nb_tiles_y = (height + tile_size - 1) / tile_size;
+        level->offset = offset;
+        offset += (int64_t)level->nb_tiles_x * level->nb_tiles_y * get_tile_size(s);
+        if (width <= tile_size && height <= tile_size)
+            return offset;
+        width = NGLI_MAX((width + 1) / 2, 1);
+        height = NGLI_MAX((height + 1) / 2, 1);
+    }
+}
+
+static int seek(FILE *fp, int64_t offset)
+{
+    return fseeko(fp, offset, SEEK_SET) ? NGL_ERROR_IO : 0;
+}
+
+static int read_tile(const struct tilepyramid *s, FILE *fp, const struct tilepyramid_level *level,
+                     int x, int y, uint8_t *data)
+{
+    const int64_t tile_size = get_tile_size(s);
+    int ret = seek(fp, level->offset + ((int64_t)y * level->nb_tiles_x + x) * tile_size);
+    if (ret < 0)
+        return ret;
+    return fread(data, tile_size, 1, fp) == 1 ? 0 : NGL_ERROR_IO;
+}
+
+static int build_base_level(struct tilepyramid *s, FILE *fp, FILE *src, uint8_t *tile)
+{
+    const struct tilepyramid_level *level = &s->levels[0];
+    const int tile_size = s->tile_size;
+    const int linesize = tile_size * NGLI_TILEPYRAMID_PIXEL_SIZE;
+
+    for (int ty = 0; ty < level->nb_tiles_y; ty++) {
+        for (int tx = 0; tx < level->nb_tiles_x; tx++) {
+            const int x = tx * tile_size;
+            const int nb_pixels = NGLI_MIN(level->width - x, tile_size);
+            for (int row = 0; row < tile_size; row++) {
+                const int y = NGLI_MIN(ty * tile_size + row, level->height - 1);
+                uint8_t *dst = tile + row * linesize;
+                int ret = seek(src, ((int64_t)y * level->width + x) * NGLI_TILEPYRAMID_PIXEL_SIZE);
+                if (ret < 0)
+                    return ret;
+                if (fread(dst, nb_pixels * NGLI_TILEPYRAMID_PIXEL_SIZE, 1, src) != 1)
+                    return NGL_ERROR_IO;
+                const uint8_t *last = dst + (nb_pixels - 1) * NGLI_TILEPYRAMID_PIXEL_SIZE;
+                for (int i = nb_pixels; i < tile_size; i++)
+                    memcpy(dst + i * NGLI_TILEPYRAMID_PIXEL_SIZE, last, NGLI_TILEPYRAMID_PIXEL_SIZE);
+            }
+            if (fwrite(tile, get_tile_size(s), 1, fp) != 1)
+                return NGL_ERROR_IO;
+        }
+    }
+    return 0;
+}
+
+/* The 2x2 parent tiles are loaded in children, in row-major order */
+static const uint8_t *get_child_pixel(const struct tilepyramid *s, const uint8_t *children,
+                                      int tx, int ty, int x, int y)
+{
+    const int tile_size = s->tile_size;
+    const int lx = x - 2 * tx * tile_size;
+    const int ly = y - 2 * ty * tile_size;
+    const int child = (ly / tile_size) * 2 + lx / tile_size;
+    const int pos = (ly % tile_size) * tile_size + lx % tile_size;
+    return children + child * get_tile_size(s) + pos * NGLI_TILEPYRAMID_PIXEL_SIZE;
+}
+
+static int build_level(struct tilepyramid *s, FILE *fp, int index, uint8_t *children, uint8_t *tile)
+{
+    const struct tilepyramid_level *level = &s->levels[index];
+    const struct tilepyramid_level *parent = &s->levels[index - 1];
+    const int tile_size = s->tile_size;
+    int64_t pos = level->offset;
+
+    for (int ty = 0; ty < level->nb_tiles_y; ty++) {
+        for (int tx = 0; tx < level->nb_tiles_x; tx++) {
+            for (int i = 0; i < 4; i++) {
+                const int cx = tx * 2 + (i & 1);
+                const int cy = ty * 2 + (i >> 1);
+                if (cx >= parent->nb_tiles_x || cy >= parent->nb_tiles_y)
+                    continue;
+                int ret = read_tile(s, fp, parent, cx, cy, children + i * get_tile_size(s));
+                if (ret < 0)
+                    return ret;
+            }
+
+            uint8_t *dst = tile;
+            for (int row = 0; row < tile_size; row++) {
+                const int y = NGLI_MIN(ty * tile_size + row, level->height - 1);
+                const int y0 = 2 * y;
+                const int y1 = NGLI_MIN(2 * y + 1, parent->height - 1);
+                for (int col = 0; col < tile_size; col++) {
+                    const int x = NGLI_MIN(tx * tile_size + col, level->width - 1);
+                    const int x0 = 2 * x;
+                    const int x1 = NGLI_MIN(2 * x + 1, parent->width - 1);
+                    const uint8_t *p00 = get_child_pixel(s, children, tx, ty, x0, y0);
+                    const uint8_t *p01 = get_child_pixel(s, children, tx, ty, x1, y0);
+                    const uint8_t *p10 = get_child_pixel(s, children, tx, ty, x0, y1);
+                    const uint8_t *p11 = get_child_pixel(s, children, tx, ty, x1, y1);
+                    for (int c = 0; c < NGLI_TILEPYRAMID_PIXEL_SIZE; c++)
+                        *dst++ = (p00[c] + p01[c] + p10[c] + p11[c] + 2) >> 2;
+                }
+            }
+
+            int ret = seek(fp, pos);
+            if (ret < 0)
+                return ret;
+            if (fwrite(tile, get_tile_size(s), 1, fp) != 1)
+                return NGL_ERROR_IO;
+            pos += get_tile_size(s);
+        }
+    }
+    return 0;
+}
+
+static int build(struct tilepyramid *s, const char *filename, const char *src_filename,
+                 const struct pyramid_header *header)
+{
+    char *tmp_filename = ngli_asprintf("%s.tmp", filename);
+    uint8_t *tiles = ngli_malloc(5 * get_tile_size(s));
+    if (!tmp_filename || !tiles) {
+        ngli_free(tmp_filename);
+        ngli_free(tiles);
+        return NGL_ERROR_MEMORY;
+    }
+
+    LOG(INFO, "building the tile pyramid of %s into %s", src_filename, filename);
+
+    /* Written aside and renamed, so an interrupted build is never reused */
+    int ret = NGL_ERROR_IO;
+    FILE *src = fopen(src_filename, "rb");
+    FILE *fp = fopen(tmp_filename, "w+b");
+    if (src && fp && fwrite(header, sizeof(*header), 1, fp) == 1) {
+        uint8_t *tile = tiles + 4 * get_tile_size(s);
+        ret = build_base_level(s, fp, src, tile);
+        for (int i = 1; ret >= 0 && i < s->nb_levels; i++)
+            ret = build_level(s, fp, i, tiles, tile);
+    }
+    if (src)
+        fclose(src);
+    if (fp && fclose(fp) && ret >= 0)
+        ret = NGL_ERROR_IO;
+    if (ret >= 0 && rename(tmp_filename, filename))
+        ret = NGL_ERROR_IO;
+    if (ret < 0) {
+        LOG(ERROR, "could not build the tile pyramid into %s", filename);
+        remove(tmp_filename);
+    }
+
+    ngli_free(tmp_filename);
+    ngli_free(tiles);
+    return ret;
+}
+
+static int is_reusable(FILE *fp, const struct pyramid_header *header, int64_t size)
+{
+    struct pyramid_header file_header;
+    return fread(&file_header, sizeof(file_header), 1, fp) == 1 &&
+           !memcmp(&file_header, header, sizeof(file_header)) &&
+           !fseeko(fp, 0, SEEK_END) && ftello(fp) == size;
+}
+
+int ngli_tilepyramid_init(struct tilepyramid *s, const char *filename, const char *src_filename,
+                          int width, int height, int tile_size)
+{
+    if (width <= 0 || height <= 0 || tile_size <= 0 || tile_size > MAX_TILE_SIZE) {
+        LOG(ERROR, "invalid image (%dx%d) or tile (%d) dimensions", width, height, tile_size);
+        return NGL_ERROR_INVALID_ARG;
+    }
+
+    struct stat st;
+    if (stat(src_filename, &st)) {
+        LOG(ERROR, "could not stat '%s'", src_filename);
+        return NGL_ERROR_IO;
+    }
+    if (st.st_size < (int64_t)width * height * NGLI_TILEPYRAMID_PIXEL_SIZE) {
+        LOG(ERROR, "'%s' is too small to hold %dx%d RGBA pixels", src_filename, width, height);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    s->tile_size = tile_size;
+    const int64_t size = init_levels(s, width, height);
+    if (size < 0)
+        return size;
+
+    /* Padding bytes included, as the header is compared as a whole */
+    struct pyramid_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PYRAMID_MAGIC, sizeof(header.magic));
+    header.width = width;
+    header.height = height;
+    header.tile_size = tile_size;
+    header.src_size = st.st_size;
+    header.src_mtime = st.st_mtime;
+
+    s->fp = fopen(filename, "rb");
+    if (s->fp && is_reusable(s->fp, &header, size))
+        return 0;
+
+    if (s->fp) {
+        fclose(s->fp);
+        s->fp = NULL;
+    }
+
+    int ret = build(s, filename, src_filename, &header);
+    if (ret < 0)
+        return ret;
+
+    s->fp = fopen(filename, "rb");
+    if (!s->fp) {
+        LOG(ERROR, "could not open '%s'", filename);
+        return NGL_ERROR_IO;
+    }
+    return 0;
+}
+
+int ngli_tilepyramid_read_tile(struct tilepyramid *s, int level, int x, int y, uint8_t *data)
+{
+    ngli_assert(level >= 0 && level < s->nb_levels);
+    const struct tilepyramid_level *l = &s->levels[level];
+    ngli_assert(x >= 0 && y >= 0 && x < l->nb_tiles_x && y < l->nb_tiles_y);
+    return read_tile(s, s->fp, l, x, y, data);
+}
+
+void ngli_tilepyramid_reset(struct tilepyramid *s)
+{
+    if (s->fp)
+        fclose(s->fp);
+    memset(s, 0, sizeof(*s));
+}
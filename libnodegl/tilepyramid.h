@@ -0,0 +1,66 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TILEPYRAMID_H
+#define TILEPYRAMID_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define NGLI_TILEPYRAMID_MAX_LEVELS 32
+#define NGLI_TILEPYRAMID_PIXEL_SIZE 4
+
+struct tilepyramid_level {
+    int width;
+    int height;
+    int nb_tiles_x;
+    int nb_tiles_y;
+    int64_t offset;     /* position of the first tile in the file */
+};
+
+/*
+ * Mip pyramid of a raw RGBA8 image stored as a file of square tiles, level
+ * by level from the full resolution one down to the level fitting a single
+ * tile. Each level halves the dimensions of the previous one with a box
+ * filter. The tiles crossing the right and bottom edges are padded by
+ * repeating the last column and row of the level.
+ *
+ * The pyramid file is built from the image file at init, or reused as is if
+ * it was built from the same image (same dimensions, tile size, file size
+ * and modification time). The build only holds a few tiles in memory,
+ * whatever the size of the image.
+ */
+struct tilepyramid {
+    FILE *fp;
+    int tile_size;
+    int nb_levels;
+    struct tilepyramid_level levels[NGLI_TILEPYRAMID_MAX_LEVELS];
+};
+
+int ngli_tilepyramid_init(struct tilepyramid *s, const char *filename, const char *src_filename,
+                          int width, int height, int tile_size);
+
+/* Read the tile (x, y) of a level into data, which holds tile_size * tile_size pixels */
+int ngli_tilepyramid_read_tile(struct tilepyramid *s, int level, int x, int y, uint8_t *data);
+
+void ngli_tilepyramid_reset(struct tilepyramid *s);
+
+#endif
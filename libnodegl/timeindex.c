@@ -0,0 +1,54 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "timeindex.h"
+
+int ngli_timeindex_search(const void *arg, int nb_elems, int cursor, double t,
+                          ngli_timeindex_get_time_func get_time)
+{
+    /*
+     * Binary search invariant: every element before lo has a time lower or
+     * equal to t, and every element starting at hi has a time greater than t.
+     */
+    int lo = 0;
+    int hi = nb_elems;
+
+    if (cursor >= 0 && cursor < nb_elems) {
+        if (get_time(arg, cursor) <= t) {
+            /* Check the cursor and the element following it first */
+            for (lo = cursor + 1; lo < nb_elems && lo <= cursor + 2; lo++)
+                if (get_time(arg, lo) > t)
+                    return lo - 1;
+        } else {
+            hi = cursor;
+        }
+    }
+
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (get_time(arg, mid) > t)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo - 1;
+}
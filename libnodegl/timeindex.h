@@ -0,0 +1,39 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+typedef double (*ngli_timeindex_get_time_func)(const void *arg, int index);
+
+/*
+ * Return the index of the last element with a time lower or equal to t, or -1
+ * if t is before the first element. The times must be monotonically
+ * increasing.
+ *
+ * The cursor is a hint (typically the previously returned index) allowing
+ * constant time lookups during a monotonic playback; any value can be
+ * specified, in which case a binary search is performed.
+ */
+int ngli_timeindex_search(const void *arg, int nb_elems, int cursor, double t,
+                          ngli_timeindex_get_time_func get_time);
+
+#endif
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L // fseeko()
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "timeindex.h"
+#include "timeline.h"
+#include "utils.h"
+
+#define TIMELINE_MAGIC "NGLT"
+#define TIMELINE_VERSION 1
+
+/* Upper bound of the memory used by a slot */
+#define MAX_CHUNK_SIZE (64 << 20)
+
+struct timeline_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t elem_size;
+    uint32_t nb_chunks;
+};
+
+static double get_chunk_time(const void *arg, int index)
+{
+    const struct timeline_index_entry *index_entries = arg;
+    return index_entries[index].first_ts;
+}
+
+static double get_elem_time(const void *arg, int index)
+{
+    const int64_t *timestamps = arg;
+    return timestamps[index];
+}
+
+static int load_chunk(struct timeline *s, struct timeline_slot *slot, int chunk)
+{
+    const struct timeline_index_entry *entry = &s->index[chunk];
+    const size_t nb_elems = entry->nb_elems;
+
+    if (fseeko(s->fp, (off_t)entry->offset, SEEK_SET) < 0 ||
+        fread(slot->timestamps, sizeof(*slot->timestamps), nb_elems, s->fp) != nb_elems ||
+        fread(slot->data, s->elem_size, nb_elems, s->fp) != nb_elems) {
+        LOG(ERROR, "could not read timeline chunk %d", chunk);
+        return NGL_ERROR_IO;
+    }
+
+    if (slot->timestamps[0] != entry->first_ts) {
+        LOG(ERROR, "timeline chunk %d starts at %" PRId64 " instead of %" PRId64,
+            chunk, slot->timestamps[0], entry->first_ts);
+        return NGL_ERROR_INVALID_DATA;
+    }
+    for (size_t i = 1; i < nb_elems; i++) {
+        if (slot->timestamps[i] < slot->timestamps[i - 1]) {
+            LOG(ERROR, "timeline timestamps must be monotonically increasing: %" PRId64 " < %" PRId64,
+                slot->timestamps[i], slot->timestamps[i - 1]);
+            return NGL_ERROR_INVALID_DATA;
+        }
+    }
+
+    return 0;
+}
+
+static struct timeline_slot *find_slot(struct timeline *s, int chunk)
+{
+    for (int i = 0; i < NGLI_TIMELINE_NB_SLOTS; i++) {
+        struct timeline_slot *slot = &s->slots[i];
+        if (slot->state != NGLI_TIMELINE_SLOT_EMPTY && slot->chunk == chunk)
+            return slot;
+    }
+    return NULL;
+}
+
+/*
+ * Pick the slot to load a chunk into: an empty one if any, otherwise the one
+ * holding the chunk the furthest away from the current one
+ */
+static struct timeline_slot *get_free_slot(struct timeline *s)
+{
+    struct timeline_slot *ret = NULL;
+    int max_dist = -1;
+    for (int i = 0; i < NGLI_TIMELINE_NB_SLOTS; i++) {
+        struct timeline_slot *slot = &s->slots[i];
+        if (slot->state == NGLI_TIMELINE_SLOT_EMPTY)
+            return slot;
+        if (slot->state == NGLI_TIMELINE_SLOT_LOADING || slot->chunk == s->current)
+            continue;
+        const int dist = abs(slot->chunk - s->current);
+        if (dist > max_dist) {
+            max_dist = dist;
+            ret = slot;
+        }
+    }
+    return ret;
+}
+
+static void *reader_thread(void *arg)
+{
+    struct timeline *s = arg;
+
+    ngli_thread_set_name("ngl-timeline");
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        while (!s->stop && s->request < 0)
+            pthread_cond_wait(&s->cond_wkr, &s->lock);
+        if (s->stop)
+            break;
+
+        const int chunk = s->request;
+        s->request = -1;
+        if (find_slot(s, chunk))
+            continue;
+
+        struct timeline_slot *slot = get_free_slot(s);
+        ngli_assert(slot);
+        slot->state = NGLI_TIMELINE_SLOT_LOADING;
+        slot->chunk = chunk;
+
+        /* The slot is reserved, the file is only accessed by this thread */
+        pthread_mutex_unlock(&s->lock);
+        const int ret = load_chunk(s, slot, chunk);
+        pthread_mutex_lock(&s->lock);
+
+        slot->error = ret;
+        slot->state = NGLI_TIMELINE_SLOT_READY;
+        pthread_cond_broadcast(&s->cond_ctl);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+
+int ngli_timeline_init(struct timeline *s, const char *filename, int elem_size)
+{
+    s->request = -1;
+    s->current = -1;
+
+    s->fp = fopen(filename, "rb");
+    if (!s->fp) {
+        LOG(ERROR, "could not open '%s'", filename);
+        return NGL_ERROR_IO;
+    }
+
+    struct timeline_header header;
+    if (fread(&header, sizeof(header), 1, s->fp) != 1) {
+        LOG(ERROR, "could not read the header of '%s'", filename);
+        return NGL_ERROR_IO;
+    }
+
+    if (memcmp(header.magic, TIMELINE_MAGIC, sizeof(header.magic)) ||
+        header.version != TIMELINE_VERSION) {
+        LOG(ERROR, "'%s' is not a supported timeline file", filename);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    if (header.elem_size != elem_size) {
+        LOG(ERROR, "timeline element size (%u) does not match the expected size (%d)",
+            header.elem_size, elem_size);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    if (!header.nb_chunks || header.nb_chunks > INT32_MAX / sizeof(*s->index)) {
+        LOG(ERROR, "invalid number of timeline chunks: %u", header.nb_chunks);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    s->elem_size = elem_size;
+    s->nb_chunks = header.nb_chunks;
+    s->index = ngli_calloc(s->nb_chunks, sizeof(*s->index));
+    if (!s->index)
+        return NGL_ERROR_MEMORY;
+
+    if (fread(s->index, sizeof(*s->index), s->nb_chunks, s->fp) != s->nb_chunks) {
+        LOG(ERROR, "could not read the index of '%s'", filename);
+        return NGL_ERROR_IO;
+    }
+
+    uint32_t max_elems = 0;
+    for (int i = 0; i < s->nb_chunks; i++) {
+        const struct timeline_index_entry *entry = &s->index[i];
+        if (!entry->nb_elems) {
+            LOG(ERROR, "timeline chunk %d is empty", i);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        if (i && entry->first_ts < s->index[i - 1].first_ts) {
+            LOG(ERROR, "timeline chunks must be monotonically increasing: %" PRId64 " < %" PRId64,
+                entry->first_ts, s->index[i - 1].first_ts);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        max_elems = NGLI_MAX(max_elems, entry->nb_elems);
+    }
+
+    if ((uint64_t)max_elems * (sizeof(int64_t) + elem_size) > MAX_CHUNK_SIZE) {
+        LOG(ERROR, "timeline chunks can not be larger than %d bytes", MAX_CHUNK_SIZE);
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    }
+
+    for (int i = 0; i < NGLI_TIMELINE_NB_SLOTS; i++) {
+        struct timeline_slot *slot = &s->slots[i];
+        slot->timestamps = ngli_calloc(max_elems, sizeof(*slot->timestamps));
+        slot->data = ngli_calloc(max_elems, elem_size);
+        if (!slot->timestamps || !slot->data)
+            return NGL_ERROR_MEMORY;
+    }
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond_wkr, NULL);
+    pthread_cond_init(&s->cond_ctl, NULL);
+    if (pthread_create(&s->thread, NULL, reader_thread, s)) {
+        pthread_cond_destroy(&s->cond_ctl);
+        pthread_cond_destroy(&s->cond_wkr);
+        pthread_mutex_destroy(&s->lock);
+        return NGL_ERROR_MEMORY;
+    }
+    s->thread_started = 1;
+
+    /* Start reading the first chunk right away */
+    pthread_mutex_lock(&s->lock);
+    s->request = 0;
+    pthread_cond_signal(&s->cond_wkr);
+    pthread_mutex_unlock(&s->lock);
+
+    return 0;
+}
+
+static struct timeline_slot *get_chunk(struct timeline *s, int chunk)
+{
+    pthread_mutex_lock(&s->lock);
+
+    struct timeline_slot *slot;
+    for (;;) {
+        slot = find_slot(s, chunk);
+        if (slot && slot->state == NGLI_TIMELINE_SLOT_READY)
+            break;
+        /* A pending read-ahead is superseded by the chunk needed now */
+        if (!slot && s->request != chunk) {
+            s->request = chunk;
+            pthread_cond_signal(&s->cond_wkr);
+        }
+        pthread_cond_wait(&s->cond_ctl, &s->lock);
+    }
+    s->current = chunk;
+
+    const int next = chunk + 1;
+    if (next < s->nb_chunks && !find_slot(s, next) && s->request < 0) {
+        s->request = next;
+        pthread_cond_signal(&s->cond_wkr);
+    }
+
+    pthread_mutex_unlock(&s->lock);
+    return slot;
+}
+
+int ngli_timeline_get(struct timeline *s, int64_t t, void *dst)
+{
+    int chunk = ngli_timeindex_search(s->index, s->nb_chunks, s->chunk_cursor, t, get_chunk_time);
+    if (chunk < 0) // t is before the first timestamp
+        chunk = 0;
+
+    /* The current chunk is never evicted, so it can be read without the lock */
+    const struct timeline_slot *slot = get_chunk(s, chunk);
+    if (slot->error)
+        return slot->error;
+
+    if (chunk != s->chunk_cursor)
+        s->elem_cursor = 0;
+    s->chunk_cursor = chunk;
+
+    const int nb_elems = s->index[chunk].nb_elems;
+    int index = ngli_timeindex_search(slot->timestamps, nb_elems, s->elem_cursor, t, get_elem_time);
+    if (index < 0)
+        index = 0;
+    s->elem_cursor = index;
+
+    memcpy(dst, slot->data + index * s->elem_size, s->elem_size);
+    return 0;
+}
+
+void ngli_timeline_reset(struct timeline *s)
+{
+    if (s->thread_started) {
+        pthread_mutex_lock(&s->lock);
+        s->stop = 1;
+        pthread_cond_signal(&s->cond_wkr);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+        pthread_cond_destroy(&s->cond_ctl);
+        pthread_cond_destroy(&s->cond_wkr);
+        pthread_mutex_destroy(&s->lock);
+    }
+    for (int i = 0; i < NGLI_TIMELINE_NB_SLOTS; i++) {
+        ngli_free(s->slots[i].timestamps);
+        ngli_free(s->slots[i].data);
+    }
+    ngli_free(s->index);
+    if (s->fp)
+        fclose(s->fp);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Reader of the chunked timeline files, holding a series of timestamped
+ * elements of a fixed size. All the fields are little-endian:
+ *
+ *   header:  "NGLT", version (u32, 1), elem_size (u32), nb_chunks (u32)
+ *   index:   nb_chunks x {first_ts (i64), offset (u64), nb_elems (u32), reserved (u32)}
+ *   chunk:   nb_elems x timestamp (i64), followed by nb_elems x elem_size bytes
+ *
+ * The timestamps must be monotonically increasing across the whole file, and
+ * first_ts must match the first timestamp of each chunk.
+ *
+ * Only the chunk being read and a few around it are resident: the chunk
+ * following the current one is read ahead on a background thread, so a
+ * monotonic playback never waits for the file.
+ */
+
+#define NGLI_TIMELINE_NB_SLOTS 3
+
+struct timeline_index_entry {
+    int64_t first_ts;
+    uint64_t offset;
+    uint32_t nb_elems;
+    uint32_t reserved;
+};
+
+enum {
+    NGLI_TIMELINE_SLOT_EMPTY,
+    NGLI_TIMELINE_SLOT_LOADING,
+    NGLI_TIMELINE_SLOT_READY,
+};
+
+struct timeline_slot {
+    int state;
+    int chunk;
+    int error;
+    int64_t *timestamps;
+    uint8_t *data;
+};
+
+struct timeline {
+    FILE *fp;
+    int elem_size;
+    int nb_chunks;
+    struct timeline_index_entry *index;
+    struct timeline_slot slots[NGLI_TIMELINE_NB_SLOTS];
+    int chunk_cursor;
+    int elem_cursor;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond_wkr;
+    pthread_cond_t cond_ctl;
+    int thread_started;
+    int current;    // chunk used by the reader, never evicted
+    int request;    // chunk to load by the thread, -1 if none
+    int stop;
+};
+
+int ngli_timeline_init(struct timeline *s, const char *filename, int elem_size);
+
+/*
+ * Copy the element with the last timestamp lower or equal to t into dst
+ * (elem_size bytes), or the first element if t is before the first
+ * timestamp.
+ */
+int ngli_timeline_get(struct timeline *s, int64_t t, void *dst);
+
+void ngli_timeline_reset(struct timeline *s);
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+
+#include "tracemarker.h"
+
+#if defined(__ANDROID__)
+#include <android/trace.h>
+
+/* ATrace sections are implicitly nested per thread */
+uint64_t ngli_tracemarker_begin(const char *name)
+{
+#if __ANDROID_API__ >= 23
+    ATrace_beginSection(name);
+#endif
+    return 0;
+}
+
+void ngli_tracemarker_end(uint64_t id)
+{
+#if __ANDROID_API__ >= 23
+    ATrace_endSection();
+#endif
+}
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <os/signpost.h>
+
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+static os_log_t log_handle;
+
+static void log_init(void)
+{
+    log_handle = os_log_create("org.nodegl", "libnodegl");
+}
+
+uint64_t ngli_tracemarker_begin(const char *name)
+{
+    if (__builtin_available(macOS 10.14, iOS 12.0, *)) {
+        pthread_once(&log_once, log_init);
+        const os_signpost_id_t id = os_signpost_id_generate(log_handle);
+        os_signpost_interval_begin(log_handle, id, "ngl", "%{public}s", name);
+        return id;
+    }
+    return 0;
+}
+
+void ngli_tracemarker_end(uint64_t id)
+{
+    if (__builtin_available(macOS 10.14, iOS 12.0, *)) {
+        if (id)
+            os_signpost_interval_end(log_handle, id, "ngl");
+    }
+}
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+static pthread_once_t marker_once = PTHREAD_ONCE_INIT;
+static int marker_fd = -1;
+static int marker_pid;
+
+/* Only available while tracing with the required permissions */
+static void marker_init(void)
+{
+    marker_fd = open("/sys/kernel/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+    if (marker_fd < 0)
+        marker_fd = open("/sys/kernel/debug/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+    marker_pid = getpid();
+}
+
+/* The events use the atrace format understood by Perfetto */
+uint64_t ngli_tracemarker_begin(const char *name)
+{
+    pthread_once(&marker_once, marker_init);
+    if (marker_fd < 0)
+        return 0;
+
+    char buf[256];
+    const int len = snprintf(buf, sizeof(buf), "B|%d|%s", marker_pid, name);
+    const ssize_t ret = write(marker_fd, buf, len < sizeof(buf) ? len : sizeof(buf) - 1);
+    (void)ret;
+    return 0;
+}
+
+void ngli_tracemarker_end(uint64_t id)
+{
+    if (marker_fd < 0)
+        return;
+
+    char buf[32];
+    const int len = snprintf(buf, sizeof(buf), "E|%d", marker_pid);
+    const ssize_t ret = write(marker_fd, buf, len);
+    (void)ret;
+}
+#else
+uint64_t ngli_tracemarker_begin(const char *name)
+{
+    return 0;
+}
+
+void ngli_tracemarker_end(uint64_t id)
+{
+}
+#endif
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef TRACEMARKER_H
+#define TRACEMARKER_H
+
+#include <stdint.h>
+
+/*
+ * Markers delimiting the phases of a frame in the system traces: ATrace on
+ * Android (Perfetto, systrace), os_signpost on Darwin (Instruments) and the
+ * ftrace marker file on Linux (Perfetto, trace-cmd). The markers of a
+ * thread must be strictly nested. They are compiled out unless the library
+ * is built with TRACE_MARKERS=yes.
+ */
+uint64_t ngli_tracemarker_begin(const char *name);
+void ngli_tracemarker_end(uint64_t id);
+
+#ifdef TRACE_MARKERS
+# define NGLI_TRACEMARKER_BEGIN(id, name) const uint64_t tracemarker_##id = ngli_tracemarker_begin(name)
+# define NGLI_TRACEMARKER_END(id) ngli_tracemarker_end(tracemarker_##id)
+#else
+# define NGLI_TRACEMARKER_BEGIN(id, name) do { } while (0)
+# define NGLI_TRACEMARKER_END(id) do { } while (0)
+#endif
+
+#endif
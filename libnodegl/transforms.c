@@ -53,20 +53,100 @@ const float *ngli_get_last_transformation_matrix(const struct ngl_node *node)
     return NULL;
 }
 
-void ngli_transform_draw(struct ngl_node *node)
+uint64_t ngli_modelview_new_version(struct ngl_ctx *ctx)
+{
+    return ++ctx->modelview_version;
+}
+
+int ngli_modelview_push(struct ngl_ctx *ctx, const float *matrix, uint64_t version)
+{
+    struct modelview *modelview = ngli_darray_push(&ctx->modelview_matrix_stack, NULL);
+    if (!modelview)
+        return NGL_ERROR_MEMORY;
+    memcpy(modelview->matrix, matrix, sizeof(modelview->matrix));
+    modelview->version = version;
+    return 0;
+}
+
+void ngli_modelview_pop(struct ngl_ctx *ctx)
+{
+    ngli_darray_pop(&ctx->modelview_matrix_stack);
+}
+
+static int is_transform(const struct ngl_node *node)
+{
+    const int id = node->class->id;
+    return id == NGL_NODE_ROTATE    ||
+           id == NGL_NODE_ROTATEQUAT ||
+           id == NGL_NODE_SCALE     ||
+           id == NGL_NODE_TRANSFORM ||
+           id == NGL_NODE_TRANSLATE;
+}
+
+int ngli_transform_init(struct ngl_node *node, int animated)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct transform_priv *s = node->priv_data;
     struct ngl_node *child = s->child;
 
-    float *prev_matrix = ngli_darray_tail(&ctx->modelview_matrix_stack);
-    ngli_assert(prev_matrix);
+    s->animated = animated;
 
-    float *next_matrix = ngli_darray_push(&ctx->modelview_matrix_stack, NULL);
-    if (!next_matrix)
-        return;
+    if (!ctx->config.optimize_graph || animated || !is_transform(child))
+        return 0;
+
+    /*
+     * The child has already been initialized at this point, so it is
+     * claimed along with the chain it may have folded itself. A transform
+     * shared between several parents is only folded into the first one.
+     */
+    struct transform_priv *child_trf = child->priv_data;
+    if (child_trf->animated || child_trf->fold_head)
+        return 0;
+    LOG(DEBUG, "fold %s into %s", child->label, node->label);
+    child_trf->fold_head = s;
+    s->fold_child = child_trf->fold_child ? child_trf->fold_child : child_trf->child;
+    s->fold_stale = 1;
+    return 0;
+}
 
-    ngli_mat4_mul(next_matrix, prev_matrix, s->matrix);
+void ngli_transform_invalidate(struct transform_priv *s)
+{
+    while (s) {
+        s->parent_version = 0;
+        s->fold_stale = 1;
+        s = s->fold_head;
+    }
+}
+
+static const float *get_fold_matrix(struct transform_priv *s)
+{
+    if (!s->fold_child)
+        return s->matrix;
+    if (s->fold_stale) {
+        struct transform_priv *child_trf = s->child->priv_data;
+        ngli_mat4_mul(s->fold_matrix, s->matrix, get_fold_matrix(child_trf));
+        s->fold_stale = 0;
+    }
+    return s->fold_matrix;
+}
+
+void ngli_transform_draw(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct transform_priv *s = node->priv_data;
+    struct ngl_node *child = s->fold_child ? s->fold_child : s->child;
+
+    const struct modelview *parent = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    ngli_assert(parent);
+
+    if (s->parent_version != parent->version) {
+        ngli_mat4_mul(s->world_matrix, parent->matrix, get_fold_matrix(s));
+        s->parent_version = parent->version;
+        s->world_version = ngli_modelview_new_version(ctx);
+    }
+
+    if (ngli_modelview_push(ctx, s->world_matrix, s->world_version) < 0)
+        return;
     ngli_node_draw(child);
-    ngli_darray_pop(&ctx->modelview_matrix_stack);
+    ngli_modelview_pop(ctx);
 }
@@ -22,9 +22,36 @@
 #ifndef TRANSFORMS_H
 #define TRANSFORMS_H
 
+#include <stdint.h>
+
 #include "nodes.h"
 
+/* Version of the identity matrices pushed on the modelview matrix stack */
+#define NGLI_MODELVIEW_VERSION_IDENTITY 1
+
+uint64_t ngli_modelview_new_version(struct ngl_ctx *ctx);
+int ngli_modelview_push(struct ngl_ctx *ctx, const float *matrix, uint64_t version);
+void ngli_modelview_pop(struct ngl_ctx *ctx);
+
 const float *ngli_get_last_transformation_matrix(const struct ngl_node *node);
+
+/*
+ * The world matrix of a transform is only recomputed when its own matrix
+ * changed, which must be signaled with ngli_transform_invalidate(), or when
+ * the version of the parent matrix differs from the one of the last draw.
+ */
+void ngli_transform_invalidate(struct transform_priv *s);
+
+/*
+ * Must be called by the transform nodes at the end of their init. With the
+ * optimize_graph option, a non-animated transform folds the chain of
+ * non-animated transforms below it: it is drawn with the product of their
+ * matrices, directly followed by the first node which is not part of the
+ * chain. The folded transforms are still updated, and a change of their
+ * matrix signaled with ngli_transform_invalidate() is propagated to the
+ * transform folding them.
+ */
+int ngli_transform_init(struct ngl_node *node, int animated);
 void ngli_transform_draw(struct ngl_node *node);
 
 #endif
@@ -0,0 +1,600 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "darray.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "type.h"
+#include "uniformpack.h"
+#include "utils.h"
+
+#define MAX_WORD_LEN 64
+
+static const struct {
+    const char *name;
+    int type;
+    int size;       /* std140 size of a single element */
+    int alignment;  /* std140 base alignment of a single element */
+} packed_types[] = {
+    {"bool",  NGLI_TYPE_BOOL,   4,  4},
+    {"int",   NGLI_TYPE_INT,    4,  4},
+    {"float", NGLI_TYPE_FLOAT,  4,  4},
+    {"vec2",  NGLI_TYPE_VEC2,   8,  8},
+    {"vec3",  NGLI_TYPE_VEC3,  12, 16},
+    {"vec4",  NGLI_TYPE_VEC4,  16, 16},
+    {"mat3",  NGLI_TYPE_MAT3,  48, 16},
+    {"mat4",  NGLI_TYPE_MAT4,  64, 16},
+};
+
+static const char * const opaque_type_prefixes[] = {
+    "sampler", "isampler", "usampler", "image", "iimage", "uimage", "atomic_uint",
+};
+
+static const char * const precisions[] = {"lowp", "mediump", "highp"};
+
+struct declaration {
+    const char *start;  /* start of the statement, "uniform" keyword included */
+    const char *end;    /* end of the statement, past the semicolon */
+    struct uniformpack_member member;
+};
+
+static int get_packed_type_index(const char *name)
+{
+    for (int i = 0; i < NGLI_ARRAY_NB(packed_types); i++)
+        if (!strcmp(packed_types[i].name, name))
+            return i;
+    return -1;
+}
+
+static int get_packed_type_index_from_type(int type)
+{
+    for (int i = 0; i < NGLI_ARRAY_NB(packed_types); i++)
+        if (packed_types[i].type == type)
+            return i;
+    return -1;
+}
+
+static int is_opaque_type(const char *name)
+{
+    for (int i = 0; i < NGLI_ARRAY_NB(opaque_type_prefixes); i++)
+        if (!strncmp(name, opaque_type_prefixes[i], strlen(opaque_type_prefixes[i])))
+            return 1;
+    return 0;
+}
+
+static int is_precision(const char *name)
+{
+    for (int i = 0; i < NGLI_ARRAY_NB(precisions); i++)
+        if (!strcmp(name, precisions[i]))
+            return 1;
+    return 0;
+}
+
+static int is_ident_char(int c)
+{
+    return isalnum(c) || c == '_';
+}
+
+static const char *skip_spaces(const char *p)
+{
+    while (*p && isspace(*p))
+        p++;
+    return p;
+}
+
+/* Return the position past the comment starting at p, or p if there is none */
+static const char *skip_comment(const char *p)
+{
+    if (!strncmp(p, "//", 2)) {
+        const char *eol = strchr(p, '\n');
+        return eol ? eol : p + strlen(p);
+    }
+    if (!strncmp(p, "/*", 2)) {
+        const char *end = strstr(p + 2, "*/");
+        return end ? end + 2 : p + strlen(p);
+    }
+    return p;
+}
+
+static const char *read_word(const char *p, char *word, int size)
+{
+    p = skip_spaces(p);
+    int len = 0;
+    while (is_ident_char(p[len]))
+        len++;
+    if (len >= size)
+        len = 0;
+    memcpy(word, p, len);
+    word[len] = 0;
+    return p + len;
+}
+
+static int get_glsl_version(const char *src, int *es)
+{
+    const char *p = strstr(src, "#version");
+    if (!p)
+        return 0;
+    p = skip_spaces(p + strlen("#version"));
+    const int version = atoi(p);
+    while (isdigit(*p))
+        p++;
+    *es = version == 100 || !strncmp(skip_spaces(p), "es", 2);
+    return version;
+}
+
+static int has_uniform_blocks(const char *src)
+{
+    int es;
+    const int version = get_glsl_version(src, &es);
+    return es ? version >= 300 : version >= 140;
+}
+
+/* Same as the insertion point of the texvideo preprocessing */
+static const char *get_insert_point(const char *src)
+{
+    const char *p = src;
+    for (;;) {
+        const char *line = skip_spaces(p);
+        if (strncmp(line, "#version", 8) && strncmp(line, "#extension", 10))
+            return line;
+        const char *eol = strchr(line, '\n');
+        if (!eol)
+            return line + strlen(line);
+        p = eol + 1;
+    }
+}
+
+/*
+ * Parse the uniform declaration statement starting at p (right after the
+ * uniform keyword). Return 1 if it can be packed, 0 if it must be left
+ * as is, or a negative value if it prevents the packing of the whole
+ * program.
+ */
+static int parse_declaration(const char *start, const char *p, struct declaration *decl)
+{
+    char type[MAX_WORD_LEN];
+    p = read_word(p, type, sizeof(type));
+    if (is_precision(type))
+        p = read_word(p, type, sizeof(type));
+    if (!*type)
+        return -1;
+
+    const int type_index = get_packed_type_index(type);
+    if (type_index < 0) {
+        /* Opaque types and uniform blocks are not concerned by the packing */
+        if (is_opaque_type(type) || *skip_spaces(p) == '{')
+            return 0;
+        return -1;
+    }
+
+    memset(decl, 0, sizeof(*decl));
+    struct uniformpack_member *member = &decl->member;
+    p = read_word(p, member->name, sizeof(member->name));
+    if (!*member->name)
+        return -1;
+    member->type = packed_types[type_index].type;
+    member->count = 1;
+
+    p = skip_spaces(p);
+    if (*p == '[') {
+        char *endptr;
+        member->count = strtol(p + 1, &endptr, 10);
+        p = skip_spaces(endptr);
+        if (member->count <= 0 || *p != ']')
+            return -1;
+        p = skip_spaces(p + 1);
+    }
+    if (*p != ';')
+        return -1;
+
+    decl->start = start;
+    decl->end = p + 1;
+    return 1;
+}
+
+/*
+ * Collect the global uniform declarations which can be packed, including the
+ * conditionally compiled ones if they are only meant to be rewritten in
+ * place. Return a negative value if the shader can not be packed.
+ */
+static int collect_declarations(const char *src, struct darray *decls, int conditionals)
+{
+    const char *p = get_insert_point(src);
+    int depth = 0;
+    int statement_start = 1;
+
+    while (*p) {
+        const char *next = skip_comment(p);
+        if (next != p) {
+            p = next;
+            continue;
+        }
+
+        if (isspace(*p)) {
+            p++;
+            continue;
+        }
+
+        if (*p == '#') {
+            /* The declarations can not be moved out of conditional blocks */
+            char directive[MAX_WORD_LEN];
+            read_word(p + 1, directive, sizeof(directive));
+            if (!conditionals && !strncmp(directive, "if", 2))
+                return NGL_ERROR_UNSUPPORTED;
+            while (*p && (*p != '\n' || p[-1] == '\\'))
+                p++;
+            statement_start = 1;
+            continue;
+        }
+
+        if (is_ident_char(*p)) {
+            char word[MAX_WORD_LEN];
+            const char *end = read_word(p, word, sizeof(word));
+            if (!depth && statement_start && !strcmp(word, "uniform")) {
+                struct declaration decl;
+                const int ret = parse_declaration(p, end, &decl);
+                if (ret < 0)
+                    return NGL_ERROR_UNSUPPORTED;
+                if (ret) {
+                    if (!ngli_darray_push(decls, &decl))
+                        return NGL_ERROR_MEMORY;
+                    p = decl.end;
+                    continue;
+                }
+            }
+            p = end;
+            statement_start = 0;
+            continue;
+        }
+
+        if (*p == '{' || *p == '(' || *p == '[')
+            depth++;
+        else if (*p == '}' || *p == ')' || *p == ']')
+            depth--;
+        statement_start = *p == ';' || *p == '{' || *p == '}';
+        p++;
+    }
+
+    return 0;
+}
+
+static int add_member(struct uniformpack *s, const struct uniformpack_member *member)
+{
+    for (int i = 0; i < s->nb_members; i++) {
+        const struct uniformpack_member *m = &s->members[i];
+        if (strcmp(m->name, member->name))
+            continue;
+        if (m->type != member->type || m->count != member->count) {
+            LOG(DEBUG, "uniform %s declared differently across the stages, not packed", member->name);
+            return NGL_ERROR_UNSUPPORTED;
+        }
+        return 0;
+    }
+
+    struct uniformpack_member *members = ngli_realloc(s->members, (s->nb_members + 1) * sizeof(*members));
+    if (!members)
+        return NGL_ERROR_MEMORY;
+    members[s->nb_members++] = *member;
+    s->members = members;
+    return 0;
+}
+
+/*
+ * std140 layout: the array elements (and the matrix columns) are aligned to
+ * the size of a vec4, so are the block and the members following an array.
+ */
+static void compute_layout(struct uniformpack *s)
+{
+    int offset = 0;
+    for (int i = 0; i < s->nb_members; i++) {
+        struct uniformpack_member *member = &s->members[i];
+        const int index = get_packed_type_index_from_type(member->type);
+        int alignment = packed_types[index].alignment;
+        int size = packed_types[index].size;
+        if (member->count > 1) {
+            alignment = 16;
+            size = NGLI_ALIGN(size, 16) * member->count;
+        }
+        member->offset = NGLI_ALIGN(offset, alignment);
+        offset = member->offset + size;
+        if (member->count > 1)
+            offset = NGLI_ALIGN(offset, 16);
+    }
+    s->size = NGLI_ALIGN(offset, 16);
+}
+
+static void print_block(struct bstr *b, const struct uniformpack *s)
+{
+    ngli_bstr_print(b, "layout(std140) uniform %s {\n", NGLI_UNIFORMPACK_BLOCK_NAME);
+    for (int i = 0; i < s->nb_members; i++) {
+        const struct uniformpack_member *member = &s->members[i];
+        const int index = get_packed_type_index_from_type(member->type);
+        const char *precision = member->type == NGLI_TYPE_BOOL ? "" : "highp ";
+        ngli_bstr_print(b, "    %s%s %s", precision, packed_types[index].name, member->name);
+        if (member->count > 1)
+            ngli_bstr_print(b, "[%d]", member->count);
+        ngli_bstr_print(b, ";\n");
+    }
+    ngli_bstr_print(b, "};\n");
+}
+
+static char *rewrite_shader(const char *src, const struct darray *decls, const char *block)
+{
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+
+    const char *insert = get_insert_point(src);
+    ngli_bstr_print(b, "%.*s%s", (int)(insert - src), src, block);
+
+    const char *p = insert;
+    const struct declaration *decl = ngli_darray_data(decls);
+    for (int i = 0; i < ngli_darray_count(decls); i++) {
+        ngli_bstr_print(b, "%.*s", (int)(decl[i].start - p), p);
+        p = decl[i].end;
+    }
+    ngli_bstr_print(b, "%s", p);
+
+    char *dst = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return dst;
+}
+
+int ngli_uniformpack_init(struct uniformpack *s, const struct glcontext *gl,
+                          const char * const *srcs, char **dsts, int nb_srcs)
+{
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < nb_srcs; i++)
+        dsts[i] = NULL;
+
+    if (!(gl->features & NGLI_FEATURE_UNIFORM_BUFFER_OBJECT))
+        return 0;
+
+    for (int i = 0; i < nb_srcs; i++)
+        if (srcs[i] && !has_uniform_blocks(srcs[i]))
+            return 0;
+
+    int ret = 0;
+    struct bstr *block = NULL;
+    struct darray *decls = ngli_calloc(nb_srcs, sizeof(*decls));
+    if (!decls)
+        return NGL_ERROR_MEMORY;
+    for (int i = 0; i < nb_srcs; i++)
+        ngli_darray_init(&decls[i], sizeof(struct declaration), 0);
+
+    for (int i = 0; i < nb_srcs; i++) {
+        if (!srcs[i])
+            continue;
+        ret = collect_declarations(srcs[i], &decls[i], 0);
+        if (ret < 0)
+            goto end;
+        const struct declaration *decl = ngli_darray_data(&decls[i]);
+        for (int j = 0; j < ngli_darray_count(&decls[i]); j++) {
+            ret = add_member(s, &decl[j].member);
+            if (ret < 0)
+                goto end;
+        }
+    }
+
+    if (!s->nb_members)
+        goto end;
+
+    compute_layout(s);
+    if (s->size > gl->max_uniform_block_size) {
+        LOG(DEBUG, "uniform block of %d bytes exceeds the limit of %d bytes, not packed",
+            s->size, gl->max_uniform_block_size);
+        ret = NGL_ERROR_UNSUPPORTED;
+        goto end;
+    }
+
+    block = ngli_bstr_create();
+    if (!block) {
+        ret = NGL_ERROR_MEMORY;
+        goto end;
+    }
+    print_block(block, s);
+
+    for (int i = 0; i < nb_srcs; i++) {
+        if (!srcs[i] || !ngli_darray_count(&decls[i]))
+            continue;
+        dsts[i] = rewrite_shader(srcs[i], &decls[i], ngli_bstr_strptr(block));
+        if (!dsts[i]) {
+            ret = NGL_ERROR_MEMORY;
+            goto end;
+        }
+    }
+
+end:
+    if (ret < 0) {
+        for (int i = 0; i < nb_srcs; i++) {
+            ngli_free(dsts[i]);
+            dsts[i] = NULL;
+        }
+        ngli_uniformpack_reset(s);
+        /* Shaders which can not be packed are used as is */
+        if (ret == NGL_ERROR_UNSUPPORTED)
+            ret = 0;
+    }
+    for (int i = 0; i < nb_srcs; i++)
+        ngli_darray_reset(&decls[i]);
+    ngli_free(decls);
+    ngli_bstr_freep(&block);
+    return ret;
+}
+
+static int format_float(char *dst, int size, float value)
+{
+    if (!isfinite(value))
+        return NGL_ERROR_UNSUPPORTED;
+    const int len = snprintf(dst, size, "%.9g", value);
+    /* An integer literal would not be implicitly converted in GLSL ES */
+    if (!strpbrk(dst, ".e"))
+        snprintf(dst + len, size - len, ".0");
+    return 0;
+}
+
+static int format_constant(char *dst, int size, int decl_type, const struct uniformpack_constant *constant)
+{
+    const float *values = constant->data;
+    switch (constant->type) {
+    case NGLI_TYPE_INT: {
+        const int value = *(const int *)constant->data;
+        if (decl_type == NGLI_TYPE_BOOL)
+            snprintf(dst, size, "%s", value ? "true" : "false");
+        else if (decl_type == NGLI_TYPE_INT)
+            snprintf(dst, size, "%d", value);
+        else
+            return NGL_ERROR_UNSUPPORTED;
+        return 0;
+    }
+    case NGLI_TYPE_FLOAT:
+        if (decl_type != NGLI_TYPE_FLOAT)
+            return NGL_ERROR_UNSUPPORTED;
+        return format_float(dst, size, values[0]);
+    case NGLI_TYPE_VEC2:
+    case NGLI_TYPE_VEC3:
+    case NGLI_TYPE_VEC4: {
+        if (decl_type != constant->type)
+            return NGL_ERROR_UNSUPPORTED;
+        const int nb_comps = constant->type - NGLI_TYPE_VEC2 + 2;
+        int len = snprintf(dst, size, "vec%d(", nb_comps);
+        for (int i = 0; i < nb_comps; i++) {
+            char value[32];
+            int ret = format_float(value, sizeof(value), values[i]);
+            if (ret < 0)
+                return ret;
+            len += snprintf(dst + len, size - len, "%s%s", i ? ", " : "", value);
+        }
+        snprintf(dst + len, size - len, ")");
+        return 0;
+    }
+    default:
+        return NGL_ERROR_UNSUPPORTED;
+    }
+}
+
+static struct uniformpack_constant *get_constant(struct uniformpack_constant *constants, int nb_constants,
+                                                 const struct uniformpack_member *member)
+{
+    if (member->count != 1)
+        return NULL;
+    for (int i = 0; i < nb_constants; i++)
+        if (!strcmp(constants[i].name, member->name))
+            return &constants[i];
+    return NULL;
+}
+
+static int specialize_shader(const char *src, char **dst, const struct darray *decls,
+                             struct uniformpack_constant *constants, int nb_constants)
+{
+    struct bstr *b = NULL;
+    const char *p = src;
+    const struct declaration *decl = ngli_darray_data(decls);
+    for (int i = 0; i < ngli_darray_count(decls); i++) {
+        struct uniformpack_constant *constant = get_constant(constants, nb_constants, &decl[i].member);
+        char value[256];
+        if (!constant || format_constant(value, sizeof(value), decl[i].member.type, constant) < 0)
+            continue;
+
+        if (!b) {
+            b = ngli_bstr_create();
+            if (!b)
+                return NGL_ERROR_MEMORY;
+        }
+
+        /* "uniform <precision> <type> <name>;" becomes "const <precision> <type> <name> = <value>;" */
+        const char *qualified_type = decl[i].start + strlen("uniform");
+        ngli_bstr_print(b, "%.*sconst%.*s = %s;", (int)(decl[i].start - p), p,
+                        (int)(decl[i].end - 1 - qualified_type), qualified_type, value);
+        p = decl[i].end;
+        constant->specialized = 1;
+    }
+
+    if (!b)
+        return 0;
+
+    ngli_bstr_print(b, "%s", p);
+    *dst = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return *dst ? 0 : NGL_ERROR_MEMORY;
+}
+
+int ngli_uniformpack_specialize(const char * const *srcs, char **dsts, int nb_srcs,
+                                struct uniformpack_constant *constants, int nb_constants)
+{
+    for (int i = 0; i < nb_srcs; i++)
+        dsts[i] = NULL;
+
+    int ret = 0;
+    for (int i = 0; i < nb_srcs && ret >= 0; i++) {
+        if (!srcs[i])
+            continue;
+        struct darray decls;
+        ngli_darray_init(&decls, sizeof(struct declaration), 0);
+        ret = collect_declarations(srcs[i], &decls, 1);
+        if (ret >= 0)
+            ret = specialize_shader(srcs[i], &dsts[i], &decls, constants, nb_constants);
+        else if (ret == NGL_ERROR_UNSUPPORTED)
+            ret = 0;
+        ngli_darray_reset(&decls);
+    }
+
+    if (ret < 0) {
+        for (int i = 0; i < nb_srcs; i++) {
+            ngli_free(dsts[i]);
+            dsts[i] = NULL;
+        }
+    }
+    return ret;
+}
+
+void ngli_uniformpack_write(uint8_t *dst, int type, const void *data, int count)
+{
+    const int index = get_packed_type_index_from_type(type);
+    ngli_assert(index >= 0);
+
+    const uint8_t *src = data;
+    const int elem_size = packed_types[index].size;
+    if (type == NGLI_TYPE_MAT3) {
+        /* Each column is padded to the size of a vec4 */
+        for (int i = 0; i < count * 3; i++)
+            memcpy(dst + i * 16, src + i * 12, 12);
+    } else if (count == 1 || elem_size == 16 || elem_size == 64) {
+        memcpy(dst, src, elem_size * count);
+    } else {
+        for (int i = 0; i < count; i++)
+            memcpy(dst + i * 16, src + i * elem_size, elem_size);
+    }
+}
+
+void ngli_uniformpack_reset(struct uniformpack *s)
+{
+    ngli_free(s->members);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef UNIFORMPACK_H
+#define UNIFORMPACK_H
+
+#include <stdint.h>
+
+#include "glcontext.h"
+
+#define NGLI_UNIFORMPACK_BLOCK_NAME "ngl_uniforms"
+#define NGLI_UNIFORMPACK_MAX_NAME_LEN 128
+
+struct uniformpack_member {
+    char name[NGLI_UNIFORMPACK_MAX_NAME_LEN];
+    int type;
+    int count;  /* number of elements, 1 if not an array */
+    int offset; /* std140 offset in the block */
+};
+
+struct uniformpack {
+    struct uniformpack_member *members;
+    int nb_members;
+    int size;       /* std140 size of the block */
+};
+
+/*
+ * Move the global uniform declarations of the program shaders (nb_srcs
+ * sources, NULL ones being ignored) into a std140 uniform block named
+ * NGLI_UNIFORMPACK_BLOCK_NAME, declared identically in every stage using
+ * one of them. Only the scalar, vector and mat3/mat4 uniforms are packed,
+ * the opaque types (samplers, images) are left untouched.
+ *
+ * The packing only happens if all the shaders target a GLSL version with
+ * uniform blocks (300 es, or 140 on desktop), the context supports them,
+ * and the uniform declarations can all be moved safely (no conditional
+ * compilation, single declarator per statement, matching declarations
+ * across the stages). On success, s->nb_members is 0 and the dsts are all
+ * set to NULL if the shaders are left as is, otherwise each dsts[i] is the
+ * newly allocated source of the stage, or NULL if the stage is unchanged.
+ */
+int ngli_uniformpack_init(struct uniformpack *s, const struct glcontext *gl,
+                          const char * const *srcs, char **dsts, int nb_srcs);
+
+struct uniformpack_constant {
+    const char *name;
+    int type;           /* NGLI_TYPE_INT, NGLI_TYPE_FLOAT or NGLI_TYPE_VEC[234] */
+    const void *data;
+    int specialized;    /* set if at least one declaration has been replaced */
+};
+
+/*
+ * Replace the global declarations of the given uniforms in the program
+ * shaders (nb_srcs sources, NULL ones being ignored) by constants holding
+ * their values, so the compiler can fold them. Only the non-array
+ * declarations of the same type as the constant (or bool for an int) are
+ * replaced, in place, conditionally compiled ones included. A shader whose
+ * uniform declarations can not all be parsed (see ngli_uniformpack_init())
+ * is left as is. Each dsts[i] is set to the newly allocated source of the
+ * stage, or NULL if the stage is unchanged.
+ */
+int ngli_uniformpack_specialize(const char * const *srcs, char **dsts, int nb_srcs,
+                                struct uniformpack_constant *constants, int nb_constants);
+
+/*
+ * Write count elements of a uniform of the given type, tightly packed in
+ * data (as uploaded with glUniform*()), to dst with the std140 layout.
+ */
+void ngli_uniformpack_write(uint8_t *dst, int type, const void *data, int count);
+
+void ngli_uniformpack_reset(struct uniformpack *s);
+
+#endif
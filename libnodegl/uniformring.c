@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "glcontext.h"
+#include "log.h"
+#include "nodes.h"
+#include "uniformring.h"
+#include "utils.h"
+
+#define MIN_RING_SIZE (256 * 1024)
+
+int ngli_uniformring_init(struct uniformring *s, struct ngl_ctx *ctx)
+{
+    struct glcontext *gl = ctx->glcontext;
+
+    s->ctx = ctx;
+    s->alignment = NGLI_MAX(gl->uniform_buffer_offset_alignment, 16);
+    const int size = NGLI_MAX(MIN_RING_SIZE, gl->max_uniform_block_size);
+    int ret = ngli_buffer_init(&s->buffer, ctx, size, NGLI_BUFFER_USAGE_DYNAMIC);
+    if (ret < 0)
+        return ret;
+    s->mapped = s->buffer.persistent ? s->buffer.mapped_data + s->buffer.offset : NULL;
+    return 0;
+}
+
+static void renew_storage(struct uniformring *s)
+{
+    s->mapped = ngli_buffer_renew(&s->buffer);
+    s->pos = 0;
+    s->gen++;
+}
+
+void ngli_uniformring_begin_frame(struct uniformring *s)
+{
+    if (s->pos)
+        renew_storage(s);
+}
+
+int ngli_uniformring_push(struct uniformring *s, const void *data, int size)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    const int aligned_size = NGLI_ALIGN(size, s->alignment);
+    if (aligned_size > s->buffer.size)
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    if (s->pos + aligned_size > s->buffer.size)
+        renew_storage(s);
+
+    if (s->mapped) {
+        memcpy(s->mapped + s->pos, data, size);
+    } else {
+        ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, s->buffer.id);
+        ngli_glBufferSubData(gl, GL_ARRAY_BUFFER, s->pos, size, data);
+    }
+    ctx->stats.uploaded_bytes += size;
+
+    const int offset = s->buffer.offset + s->pos;
+    s->pos += aligned_size;
+    return offset;
+}
+
+void ngli_uniformring_reset(struct uniformring *s)
+{
+    ngli_buffer_reset(&s->buffer);
+    memset(s, 0, sizeof(*s));
+}
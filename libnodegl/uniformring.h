@@ -0,0 +1,64 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef UNIFORMRING_H
+#define UNIFORMRING_H
+
+#include <stdint.h>
+
+#include "buffer.h"
+#include "glincludes.h"
+
+/*
+ * Uniform buffer where the packed uniform blocks of the pipelines are
+ * appended before every draw, and bound as a range of it. The storage is
+ * renewed at the beginning of every frame (and whenever it is full) so the
+ * blocks are never written while the GPU may still read them: the next
+ * region of the persistently mapped buffer if supported, an orphaned
+ * storage otherwise.
+ */
+struct uniformring {
+    struct ngl_ctx *ctx;
+    struct buffer buffer;
+    int alignment;
+    int pos;            /* write position in the current storage */
+    uint8_t *mapped;    /* current region if persistently mapped */
+    int gen;            /* incremented every time the storage is renewed */
+};
+
+int ngli_uniformring_init(struct uniformring *s, struct ngl_ctx *ctx);
+
+/*
+ * Start a new frame, which must not overwrite the blocks of the previous
+ * ones.
+ */
+void ngli_uniformring_begin_frame(struct uniformring *s);
+
+/*
+ * Append size bytes of data to the ring and return the offset at which they
+ * can be bound, or a negative error code. The data written with a previous
+ * generation of the ring (see gen) may be overwritten.
+ */
+int ngli_uniformring_push(struct uniformring *s, const void *data, int size);
+
+void ngli_uniformring_reset(struct uniformring *s);
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <pthread.h>
+
+#include "glcontext.h"
+#include "glincludes.h"
+#include "glstate.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "uploader.h"
+#include "utils.h"
+
+enum {
+    JOB_STATE_IDLE,
+    JOB_STATE_QUEUED,
+    JOB_STATE_DONE,
+};
+
+struct uploader {
+    struct glcontext *gl;        /* rendering context */
+    struct glcontext *upload_gl; /* context of the upload thread */
+    pthread_t thread;
+    int started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond_jobs;
+    pthread_cond_t cond_done;
+    int ready;
+    int init_ret;
+    int quit;
+    struct uploader_job *head;
+    struct uploader_job *tail;
+};
+
+static void *upload_thread(void *arg)
+{
+    struct uploader *s = arg;
+    struct glcontext *gl = s->upload_gl;
+
+    ngli_thread_set_name("ngl-upload");
+
+    const int init_ret = ngli_glcontext_make_current(gl, 1);
+    if (init_ret >= 0)
+        ngli_glstate_reset_bindings(gl);
+
+    pthread_mutex_lock(&s->lock);
+    s->init_ret = init_ret;
+    s->ready = 1;
+    pthread_cond_broadcast(&s->cond_done);
+    if (init_ret < 0) {
+        pthread_mutex_unlock(&s->lock);
+        return NULL;
+    }
+
+    /* The jobs left are still run on exit, so none is waited for forever */
+    for (;;) {
+        while (!s->quit && !s->head)
+            pthread_cond_wait(&s->cond_jobs, &s->lock);
+        struct uploader_job *job = s->head;
+        if (!job)
+            break;
+        s->head = job->next;
+        if (!s->head)
+            s->tail = NULL;
+        pthread_mutex_unlock(&s->lock);
+
+        /* The commands of the rendering context previously using the
+         * resources (such as the draws sampling a texture) must be complete */
+        ngli_glWaitSync(gl, job->render_fence, 0, GL_TIMEOUT_IGNORED);
+        ngli_glDeleteSync(gl, job->render_fence);
+
+        const int ret = job->func(gl, job->arg);
+
+        /* Flushed so the rendering context can wait for it */
+        GLsync fence = ngli_glFenceSync(gl, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ngli_glFlush(gl);
+
+        pthread_mutex_lock(&s->lock);
+        job->render_fence = NULL;
+        job->upload_fence = fence;
+        job->ret = ret;
+        job->state = JOB_STATE_DONE;
+        pthread_cond_broadcast(&s->cond_done);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    ngli_glcontext_make_current(gl, 0);
+    return NULL;
+}
+
+struct uploader *ngli_uploader_create(struct ngl_ctx *ctx)
+{
+    struct glcontext *gl = ctx->glcontext;
+    if (!(gl->features & NGLI_FEATURE_SYNC)) {
+        LOG(WARNING, "context does not support the fences required by the upload thread");
+        return NULL;
+    }
+
+    struct uploader *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->gl = gl;
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond_jobs, NULL);
+    pthread_cond_init(&s->cond_done, NULL);
+
+    s->upload_gl = ngli_glcontext_new_shared(gl);
+    if (!s->upload_gl) {
+        LOG(WARNING, "could not create a context shared with the rendering one for the upload thread");
+        ngli_uploader_freep(&s);
+        return NULL;
+    }
+
+    if (pthread_create(&s->thread, NULL, upload_thread, s)) {
+        LOG(ERROR, "unable to create the upload thread");
+        ngli_uploader_freep(&s);
+        return NULL;
+    }
+    s->started = 1;
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->ready)
+        pthread_cond_wait(&s->cond_done, &s->lock);
+    const int ret = s->init_ret;
+    pthread_mutex_unlock(&s->lock);
+
+    if (ret < 0) {
+        LOG(ERROR, "could not make the upload context current");
+        ngli_uploader_freep(&s);
+        return NULL;
+    }
+
+    return s;
+}
+
+void ngli_uploader_submit(struct uploader *s, struct uploader_job *job)
+{
+    struct glcontext *gl = s->gl;
+
+    ngli_assert(job->state == JOB_STATE_IDLE);
+
+    /* Flushed so the upload thread can wait for it */
+    GLsync fence = ngli_glFenceSync(gl, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ngli_glFlush(gl);
+
+    pthread_mutex_lock(&s->lock);
+    job->state = JOB_STATE_QUEUED;
+    job->render_fence = fence;
+    job->next = NULL;
+    if (s->tail)
+        s->tail->next = job;
+    else
+        s->head = job;
+    s->tail = job;
+    pthread_cond_signal(&s->cond_jobs);
+    pthread_mutex_unlock(&s->lock);
+}
+
+void ngli_uploader_sync(struct uploader *s, struct uploader_job *job)
+{
+    pthread_mutex_lock(&s->lock);
+    if (job->state == JOB_STATE_IDLE) {
+        pthread_mutex_unlock(&s->lock);
+        return;
+    }
+    while (job->state != JOB_STATE_DONE)
+        pthread_cond_wait(&s->cond_done, &s->lock);
+    GLsync fence = job->upload_fence;
+    const int ret = job->ret;
+    job->upload_fence = NULL;
+    job->state = JOB_STATE_IDLE;
+    pthread_mutex_unlock(&s->lock);
+
+    /* Only the GPU waits, the transfer itself may still be running */
+    ngli_glWaitSync(s->gl, fence, 0, GL_TIMEOUT_IGNORED);
+    ngli_glDeleteSync(s->gl, fence);
+
+    if (job->complete)
+        job->complete(job->arg, ret);
+}
+
+void ngli_uploader_freep(struct uploader **sp)
+{
+    struct uploader *s = *sp;
+    if (!s)
+        return;
+
+    if (s->started) {
+        pthread_mutex_lock(&s->lock);
+        s->quit = 1;
+        pthread_cond_signal(&s->cond_jobs);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+    }
+
+    ngli_glcontext_freep(&s->upload_gl);
+    pthread_cond_destroy(&s->cond_done);
+    pthread_cond_destroy(&s->cond_jobs);
+    pthread_mutex_destroy(&s->lock);
+    ngli_free(s);
+    *sp = NULL;
+}
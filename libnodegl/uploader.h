@@ -0,0 +1,77 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef UPLOADER_H
+#define UPLOADER_H
+
+#include "glincludes.h"
+#include "glcontext.h"
+
+struct ngl_ctx;
+
+/*
+ * Thread owning a GL context shared with the rendering one, on which the
+ * uploads run concurrently with the rendering. The transfers are ordered
+ * with the rendering context commands through fences, waited for on the GPU
+ * side only: an upload waits for the commands issued by the rendering thread
+ * before its submission, and the rendering context waits for the upload when
+ * the job is synced.
+ */
+struct uploader;
+
+typedef int (*uploader_func_type)(struct glcontext *gl, void *arg);
+
+struct uploader_job {
+    uploader_func_type func;              /* upload, called on the upload thread with its context */
+    void (*complete)(void *arg, int ret); /* called on the rendering thread once synced */
+    void *arg;
+
+    /* Private fields, protected by the uploader lock */
+    int state;
+    int ret;
+    GLsync render_fence;
+    GLsync upload_fence;
+    struct uploader_job *next;
+};
+
+/*
+ * Create the upload thread and its context, sharing the objects of the
+ * rendering context of ctx. Return NULL if the platform can not create a
+ * shared context or if the context does not support fences.
+ */
+struct uploader *ngli_uploader_create(struct ngl_ctx *ctx);
+
+/*
+ * Queue the job on the upload thread, the job must not be pending already
+ * and must remain valid until it is synced.
+ */
+void ngli_uploader_submit(struct uploader *s, struct uploader_job *job);
+
+/*
+ * Wait for the upload thread to run the job and make the rendering context
+ * wait for the transfer before its next commands, then call the complete
+ * callback. Nothing is done if the job is not pending.
+ */
+void ngli_uploader_sync(struct uploader *s, struct uploader_job *job);
+
+void ngli_uploader_freep(struct uploader **sp);
+
+#endif
@@ -22,6 +22,7 @@
 #define _GNU_SOURCE
 #include <pthread.h>
 
+#include <inttypes.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -29,8 +30,21 @@
 #include <string.h>
 #include <sys/time.h>
 
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "log.h"
 #include "memory.h"
+#include "nodegl.h"
 #include "utils.h"
 
 char *ngli_strdup(const char *s)
@@ -83,6 +97,26 @@ end:
     return p;
 }
 
+char *ngli_arena_asprintf(struct arena *arena, const char *fmt, ...)
+{
+    va_list va;
+
+    va_start(va, fmt);
+    const int len = vsnprintf(NULL, 0, fmt, va);
+    va_end(va);
+    if (len < 0)
+        return NULL;
+
+    char *p = ngli_arena_alloc(arena, len + 1);
+    if (!p)
+        return NULL;
+
+    va_start(va, fmt);
+    vsnprintf(p, len + 1, fmt, va);
+    va_end(va);
+    return p;
+}
+
 uint32_t ngli_crc32(const char *s)
 {
     uint32_t crc = ~0;
@@ -96,6 +130,17 @@ uint32_t ngli_crc32(const char *s)
     return ~crc;
 }
 
+uint64_t ngli_fnv1a64(const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
 void ngli_thread_set_name(const char *name)
 {
 #if defined(__APPLE__)
@@ -104,3 +149,82 @@ void ngli_thread_set_name(const char *name)
     pthread_setname_np(pthread_self(), name);
 #endif
 }
+
+#if defined(__APPLE__)
+void ngli_thread_set_priority(int priority, uint64_t affinity)
+{
+    /* Darwin only schedules through QoS classes and has no core affinity */
+    const qos_class_t qos_class = priority == NGL_THREAD_PRIORITY_DEFAULT ? QOS_CLASS_DEFAULT
+                                                                          : QOS_CLASS_USER_INTERACTIVE;
+    if (pthread_set_qos_class_self_np(qos_class, 0))
+        LOG(WARNING, "could not set the QoS class of the thread");
+}
+#elif defined(_WIN32)
+void ngli_thread_set_priority(int priority, uint64_t affinity)
+{
+    static const int priorities[] = {
+        [NGL_THREAD_PRIORITY_DEFAULT]  = THREAD_PRIORITY_NORMAL,
+        [NGL_THREAD_PRIORITY_DISPLAY]  = THREAD_PRIORITY_HIGHEST,
+        [NGL_THREAD_PRIORITY_REALTIME] = THREAD_PRIORITY_TIME_CRITICAL,
+    };
+    HANDLE thread = GetCurrentThread();
+    if (!SetThreadPriority(thread, priorities[priority]))
+        LOG(WARNING, "could not set the priority of the thread");
+
+    DWORD_PTR mask = (DWORD_PTR)affinity;
+    if (!mask) {
+        DWORD_PTR system_mask;
+        GetProcessAffinityMask(GetCurrentProcess(), &mask, &system_mask);
+    }
+    if (!SetThreadAffinityMask(thread, mask))
+        LOG(WARNING, "could not set the affinity of the thread to 0x%" PRIx64, affinity);
+}
+#elif defined(__linux__) || defined(__ANDROID__)
+#define DISPLAY_NICE_VALUE -4 /* THREAD_PRIORITY_DISPLAY on Android */
+
+void ngli_thread_set_priority(int priority, uint64_t affinity)
+{
+    /* Also resets a previous real-time policy */
+    struct sched_param param = {0};
+    int policy = SCHED_OTHER;
+    if (priority == NGL_THREAD_PRIORITY_REALTIME) {
+        policy = SCHED_FIFO;
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    }
+    if (pthread_setschedparam(pthread_self(), policy, &param) && policy == SCHED_FIFO) {
+        LOG(WARNING, "real-time scheduling is not permitted, falling back on the display priority");
+        priority = NGL_THREAD_PRIORITY_DISPLAY;
+    }
+
+    /* The nice value is specific to each thread on Linux */
+    const int nice_value = priority == NGL_THREAD_PRIORITY_DISPLAY ? DISPLAY_NICE_VALUE : 0;
+    if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), nice_value) < 0)
+        LOG(WARNING, "could not set the nice value of the thread to %d", nice_value);
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int i = 0; i < CPU_SETSIZE; i++)
+        if (!affinity || (i < 64 && (affinity >> i & 1)))
+            CPU_SET(i, &cpu_set);
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) < 0)
+        LOG(WARNING, "could not set the affinity of the thread to 0x%" PRIx64, affinity);
+}
+#else
+void ngli_thread_set_priority(int priority, uint64_t affinity)
+{
+}
+#endif
+
+int ngli_get_nb_cpus(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    const long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return nb_cpus > 0 ? (int)nb_cpus : 1;
+#else
+    return 1;
+#endif
+}
@@ -96,7 +96,20 @@
 char *ngli_strdup(const char *s);
 int64_t ngli_gettime(void);
 char *ngli_asprintf(const char *fmt, ...) ngli_printf_format(1, 2);
+struct arena;
+char *ngli_arena_asprintf(struct arena *arena, const char *fmt, ...) ngli_printf_format(2, 3);
 uint32_t ngli_crc32(const char *s);
+uint64_t ngli_fnv1a64(const void *data, size_t size);
 void ngli_thread_set_name(const char *name);
 
+/*
+ * Apply a scheduling priority (any of NGL_THREAD_PRIORITY_*) and a mask of
+ * allowed CPU cores (0 for any core) to the calling thread. The settings
+ * not supported or not permitted are skipped with a warning.
+ */
+void ngli_thread_set_priority(int priority, uint64_t affinity);
+
+/* Number of CPU cores currently online, at least 1 */
+int ngli_get_nb_cpus(void);
+
 #endif /* UTILS_H */
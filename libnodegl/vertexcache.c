@@ -0,0 +1,205 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+#include "vertexcache.h"
+
+#define CACHE_SIZE 32
+
+static float get_vertex_score(int cache_pos, int nb_triangles)
+{
+    if (!nb_triangles)
+        return -1.f;
+
+    float score = 0.f;
+    if (cache_pos >= 0) {
+        /* The vertices of the last triangle get a fixed score so the next
+         * triangle does not favor any of its edges */
+        if (cache_pos < 3)
+            score = 0.75f;
+        else
+            score = powf(1.f - (cache_pos - 3) * (1.f / (CACHE_SIZE - 3)), 1.5f);
+    }
+
+    /* Bonus for the vertices with few remaining triangles, so they are
+     * finished early instead of being left isolated */
+    return score + 2.f * powf(nb_triangles, -0.5f);
+}
+
+static int find_index(const int *array, int nb, int value)
+{
+    for (int i = 0; i < nb; i++)
+        if (array[i] == value)
+            return i;
+    return -1;
+}
+
+int ngli_vertexcache_optimize(uint32_t *dst, const uint32_t *indices, int nb_indices, int nb_vertices)
+{
+    const int nb_triangles = nb_indices / 3;
+    if (nb_indices % 3)
+        return NGL_ERROR_INVALID_ARG;
+    for (int i = 0; i < nb_indices; i++)
+        if (indices[i] >= nb_vertices)
+            return NGL_ERROR_INVALID_ARG;
+
+    int ret = NGL_ERROR_MEMORY;
+    int *adj_offsets   = ngli_calloc(nb_vertices + 1, sizeof(*adj_offsets));
+    int *nb_adj        = ngli_calloc(nb_vertices, sizeof(*nb_adj));
+    int *adj           = ngli_calloc(nb_indices, sizeof(*adj));
+    int *cache_pos     = ngli_calloc(nb_vertices, sizeof(*cache_pos));
+    float *vertex_score   = ngli_calloc(nb_vertices, sizeof(*vertex_score));
+    float *triangle_score = ngli_calloc(nb_triangles, sizeof(*triangle_score));
+    uint8_t *emitted      = ngli_calloc(nb_triangles, sizeof(*emitted));
+    if (!adj_offsets || !nb_adj || !adj || !cache_pos || !vertex_score || !triangle_score || !emitted)
+        goto end;
+
+    /* Triangles adjacent to each vertex */
+    for (int i = 0; i < nb_indices; i++)
+        nb_adj[indices[i]]++;
+    for (int i = 0; i < nb_vertices; i++)
+        adj_offsets[i + 1] = adj_offsets[i] + nb_adj[i];
+    memset(nb_adj, 0, nb_vertices * sizeof(*nb_adj));
+    for (int i = 0; i < nb_indices; i++) {
+        const int v = indices[i];
+        adj[adj_offsets[v] + nb_adj[v]++] = i / 3;
+    }
+
+    for (int i = 0; i < nb_vertices; i++) {
+        cache_pos[i] = -1;
+        vertex_score[i] = get_vertex_score(-1, nb_adj[i]);
+    }
+
+    int best = -1;
+    float best_score = -1.f;
+    for (int i = 0; i < nb_triangles; i++) {
+        const uint32_t *tri = indices + i * 3;
+        triangle_score[i] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+        if (triangle_score[i] > best_score) {
+            best = i;
+            best_score = triangle_score[i];
+        }
+    }
+
+    int cache[CACHE_SIZE + 3];
+    int cache_len = 0;
+    int next_unemitted = 0;
+
+    for (int n = 0; n < nb_triangles; n++) {
+        /* No candidate around the cache: restart from any triangle left */
+        if (best < 0) {
+            while (emitted[next_unemitted])
+                next_unemitted++;
+            best = next_unemitted;
+        }
+
+        const uint32_t *tri = indices + best * 3;
+        memcpy(dst + n * 3, tri, 3 * sizeof(*dst));
+        emitted[best] = 1;
+
+        for (int k = 0; k < 3; k++) {
+            const int v = tri[k];
+            int *list = adj + adj_offsets[v];
+            const int pos = find_index(list, nb_adj[v], best);
+            list[pos] = list[--nb_adj[v]];
+        }
+
+        /* The triangle vertices move to the front of the cache, pushing the
+         * others back, possibly out of it */
+        int new_cache[CACHE_SIZE + 3];
+        int new_len = 0;
+        for (int k = 0; k < 3; k++)
+            if (find_index(new_cache, new_len, tri[k]) < 0)
+                new_cache[new_len++] = tri[k];
+        for (int i = 0; i < cache_len; i++)
+            if (find_index(new_cache, new_len, cache[i]) < 0)
+                new_cache[new_len++] = cache[i];
+        for (int i = 0; i < new_len; i++)
+            cache_pos[new_cache[i]] = i < CACHE_SIZE ? i : -1;
+
+        for (int i = 0; i < new_len; i++) {
+            const int v = new_cache[i];
+            vertex_score[v] = get_vertex_score(cache_pos[v], nb_adj[v]);
+        }
+
+        best = -1;
+        best_score = -1.f;
+        for (int i = 0; i < new_len; i++) {
+            const int v = new_cache[i];
+            const int *list = adj + adj_offsets[v];
+            for (int j = 0; j < nb_adj[v]; j++) {
+                const int t = list[j];
+                const uint32_t *adj_tri = indices + t * 3;
+                triangle_score[t] = vertex_score[adj_tri[0]] + vertex_score[adj_tri[1]] + vertex_score[adj_tri[2]];
+                if (cache_pos[v] >= 0 && triangle_score[t] > best_score) {
+                    best = t;
+                    best_score = triangle_score[t];
+                }
+            }
+        }
+
+        cache_len = NGLI_MIN(new_len, CACHE_SIZE);
+        memcpy(cache, new_cache, cache_len * sizeof(*cache));
+    }
+
+    ret = 0;
+
+end:
+    ngli_free(adj_offsets);
+    ngli_free(nb_adj);
+    ngli_free(adj);
+    ngli_free(cache_pos);
+    ngli_free(vertex_score);
+    ngli_free(triangle_score);
+    ngli_free(emitted);
+    return ret;
+}
+
+float ngli_vertexcache_get_acmr(const uint32_t *indices, int nb_indices, int cache_size)
+{
+    const int nb_triangles = nb_indices / 3;
+    if (!nb_triangles)
+        return 0.f;
+
+    uint32_t fifo[NGLI_VERTEXCACHE_MAX_SIZE];
+    int fifo_len = 0;
+    int fifo_pos = 0;
+    int nb_misses = 0;
+
+    cache_size = NGLI_MIN(cache_size, NGLI_VERTEXCACHE_MAX_SIZE);
+    for (int i = 0; i < nb_triangles * 3; i++) {
+        int hit = 0;
+        for (int j = 0; j < fifo_len && !hit; j++)
+            hit = fifo[j] == indices[i];
+        if (hit)
+            continue;
+        nb_misses++;
+        fifo[fifo_pos] = indices[i];
+        fifo_pos = (fifo_pos + 1) % cache_size;
+        fifo_len = NGLI_MIN(fifo_len + 1, cache_size);
+    }
+    return nb_misses / (float)nb_triangles;
+}
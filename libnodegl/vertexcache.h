@@ -0,0 +1,46 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef VERTEXCACHE_H
+#define VERTEXCACHE_H
+
+#include <stdint.h>
+
+#define NGLI_VERTEXCACHE_MAX_SIZE 64
+
+/*
+ * Reorder the triangles of an indexed triangle list so consecutive
+ * triangles share their vertices as much as possible, which maximizes the
+ * hits in the post-transform vertex cache of the GPU (Tom Forsyth's "Linear-
+ * Speed Vertex Cache Optimisation"). The triangles and their winding are
+ * preserved, only their order changes. dst must hold nb_indices elements
+ * and may not overlap indices.
+ */
+int ngli_vertexcache_optimize(uint32_t *dst, const uint32_t *indices, int nb_indices, int nb_vertices);
+
+/*
+ * Return the average number of vertices transformed per triangle (ACMR)
+ * when drawing the indices with a FIFO vertex cache of the given size (at
+ * most NGLI_VERTEXCACHE_MAX_SIZE).
+ */
+float ngli_vertexcache_get_acmr(const uint32_t *indices, int nb_indices, int cache_size);
+
+#endif
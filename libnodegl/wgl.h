@@ -0,0 +1,41 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef WGL_H
+#define WGL_H
+
+#include <windows.h>
+
+#include <GL/glcorearb.h>
+#include <GL/wglext.h>
+
+#include "glcontext.h"
+
+HANDLE ngli_wglDXOpenDeviceNV(struct glcontext *gl, void *dx_device);
+BOOL ngli_wglDXCloseDeviceNV(struct glcontext *gl, HANDLE device);
+HANDLE ngli_wglDXRegisterObjectNV(struct glcontext *gl, HANDLE device, void *dx_object,
+                                  GLuint name, GLenum type, GLenum access);
+BOOL ngli_wglDXUnregisterObjectNV(struct glcontext *gl, HANDLE device, HANDLE object);
+BOOL ngli_wglDXLockObjectsNV(struct glcontext *gl, HANDLE device, GLint count, HANDLE *objects);
+BOOL ngli_wglDXUnlockObjectsNV(struct glcontext *gl, HANDLE device, GLint count, HANDLE *objects);
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2019 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nodegl.h>
+
+#define EXIT_OVER_BUDGET 2
+
+struct range {
+    float start;
+    float duration;
+    int freq;
+};
+
+/* Peaks of a time window, and sums of its prefetches */
+struct window {
+    double start;
+    double end;
+    int nb_active_nodes;
+    int64_t memory;
+    int nb_unknown_sizes;
+    int nb_draws;
+    int nb_dispatches;
+    int nb_prefetches;
+    int64_t prefetch_memory;
+};
+
+static double to_mib(int64_t size)
+{
+    return size / (1024. * 1024.);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double da = *(const double *)a;
+    const double db = *(const double *)b;
+    return da < db ? -1 : da > db;
+}
+
+/* The frames of all the ranges, in increasing order and without duplicates */
+static double *get_times(const struct range *ranges, int nb_ranges, int *nb_timesp)
+{
+    int nb_times = 0;
+    for (int i = 0; i < nb_ranges; i++)
+        nb_times += (int)(ranges[i].duration * ranges[i].freq) + 1;
+
+    double *times = calloc(nb_times, sizeof(*times));
+    if (!times)
+        return NULL;
+
+    int k = 0;
+    for (int i = 0; i < nb_ranges; i++) {
+        const struct range *r = &ranges[i];
+        const int nb_frames = (int)(r->duration * r->freq) + 1;
+        for (int j = 0; j < nb_frames; j++)
+            times[k++] = r->start + j / (double)r->freq;
+    }
+    qsort(times, nb_times, sizeof(*times), cmp_double);
+
+    int nb_unique = 0;
+    for (int i = 0; i < nb_times; i++)
+        if (!nb_unique || times[i] != times[nb_unique - 1])
+            times[nb_unique++] = times[i];
+    *nb_timesp = nb_unique;
+    return times;
+}
+
+static void print_windows(const struct ngl_analysis *analysis, int nb_times, double interval)
+{
+    printf("%9s %9s %7s %12s %8s %6s %10s %11s %16s\n", "start", "end", "active", "memory(MiB)",
+           "unknown", "draws", "dispatches", "prefetches", "prefetched(MiB)");
+
+    int i = 0;
+    while (i < nb_times) {
+        struct window w = {.start = analysis[i].t, .end = analysis[i].t + interval};
+        for (; i < nb_times && analysis[i].t < w.end; i++) {
+            const struct ngl_analysis *a = &analysis[i];
+            if (a->nb_active_nodes > w.nb_active_nodes) w.nb_active_nodes = a->nb_active_nodes;
+            if (a->memory > w.memory)                   w.memory = a->memory;
+            if (a->nb_unknown_sizes > w.nb_unknown_sizes) w.nb_unknown_sizes = a->nb_unknown_sizes;
+            if (a->nb_draws > w.nb_draws)               w.nb_draws = a->nb_draws;
+            if (a->nb_dispatches > w.nb_dispatches)     w.nb_dispatches = a->nb_dispatches;
+            w.nb_prefetches += a->nb_prefetches;
+            w.prefetch_memory += a->prefetch_memory;
+        }
+        printf("%9.3f %9.3f %7d %12.2f %8d %6d %10d %11d %16.2f\n", w.start, w.end,
+               w.nb_active_nodes, to_mib(w.memory), w.nb_unknown_sizes, w.nb_draws,
+               w.nb_dispatches, w.nb_prefetches, to_mib(w.prefetch_memory));
+    }
+}
+
+static void print_peaks(const struct ngl_analysis *analysis, int nb_times)
+{
+    const struct ngl_analysis *peak_active = &analysis[0];
+    const struct ngl_analysis *peak_memory = &analysis[0];
+    const struct ngl_analysis *peak_draws = &analysis[0];
+    const struct ngl_analysis *peak_prefetch = &analysis[0];
+    for (int i = 1; i < nb_times; i++) {
+        const struct ngl_analysis *a = &analysis[i];
+        if (a->nb_active_nodes > peak_active->nb_active_nodes) peak_active = a;
+        if (a->memory > peak_memory->memory)                   peak_memory = a;
+        if (a->nb_draws > peak_draws->nb_draws)                peak_draws = a;
+        if (a->prefetch_memory > peak_prefetch->prefetch_memory) peak_prefetch = a;
+    }
+
+    printf("\npeak active nodes: %d at t=%.3f\n", peak_active->nb_active_nodes, peak_active->t);
+    printf("peak memory: %.2fMiB at t=%.3f", to_mib(peak_memory->memory), peak_memory->t);
+    if (peak_memory->nb_unknown_sizes)
+        printf(" (+%d textures of unknown size)", peak_memory->nb_unknown_sizes);
+    printf("\npeak draws: %d (%d dispatches) at t=%.3f\n", peak_draws->nb_draws,
+           peak_draws->nb_dispatches, peak_draws->t);
+    printf("largest prefetch: %d nodes, %.2fMiB at t=%.3f\n", peak_prefetch->nb_prefetches,
+           to_mib(peak_prefetch->prefetch_memory), peak_prefetch->t);
+}
+
+/* The consecutive frames exceeding a budget are reported as one interval */
+static int check_budget(const struct ngl_analysis *analysis, int nb_times, const char *name,
+                        int64_t budget, int64_t (*get_value)(const struct ngl_analysis *a),
+                        double scale, int precision, const char *unit)
+{
+    int nb_exceeded = 0;
+    int i = 0;
+    while (i < nb_times) {
+        if (get_value(&analysis[i]) <= budget) {
+            i++;
+            continue;
+        }
+        const struct ngl_analysis *first = &analysis[i];
+        const struct ngl_analysis *peak = first;
+        const struct ngl_analysis *last = first;
+        for (; i < nb_times && get_value(&analysis[i]) > budget; i++) {
+            last = &analysis[i];
+            if (get_value(last) > get_value(peak))
+                peak = last;
+        }
+        printf("%s over budget (%.*f%s) from t=%.3f to t=%.3f, peak of %.*f%s at t=%.3f\n",
+               name, precision, budget * scale, unit, first->t, last->t,
+               precision, get_value(peak) * scale, unit, peak->t);
+        nb_exceeded++;
+    }
+    return nb_exceeded;
+}
+
+static int64_t get_memory(const struct ngl_analysis *a)   { return a->memory; }
+static int64_t get_nb_draws(const struct ngl_analysis *a) { return a->nb_draws; }
+
+int main(int argc, char *argv[])
+{
+    int ret = EXIT_FAILURE;
+    const char *input = NULL;
+    struct range ranges[128] = {0};
+    struct range *r;
+    int nb_ranges = 0;
+    double interval = 1.0;
+    int64_t memory_budget = 0;
+    int max_draws = 0;
+    int device = 0;
+    int debug = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-d")) {
+            debug = 1;
+        } else if (argv[i][0] == '-' && i < argc - 1) {
+            const char opt = argv[i][1];
+            const char *arg = argv[i + 1];
+            switch (opt) {
+                case 'i':
+                    interval = atof(arg);
+                    if (interval <= 0.) {
+                        fprintf(stderr, "Invalid window interval: \"%s\"\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case 'm':
+                    memory_budget = (int64_t)(atof(arg) * 1024 * 1024);
+                    if (memory_budget <= 0) {
+                        fprintf(stderr, "Invalid memory budget: \"%s\"\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case 'D':
+                    max_draws = atoi(arg);
+                    if (max_draws <= 0) {
+                        fprintf(stderr, "Invalid maximum number of draws: \"%s\"\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case 'g':
+                    device = atoi(arg);
+                    if (device < 1) {
+                        fprintf(stderr, "Invalid device: \"%s\" is not a device number starting at 1\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case 't':
+                    if (nb_ranges >= sizeof(ranges)/sizeof(*ranges)) {
+                        fprintf(stderr, "Too much ranges specified (max:%d)\n",
+                                (int)(sizeof(ranges)/sizeof(*ranges)));
+                        return EXIT_FAILURE;
+                    }
+                    r = &ranges[nb_ranges++];
+                    if (sscanf(arg, "%f:%f:%d", &r->start, &r->duration, &r->freq) != 3 ||
+                        r->duration < 0 || r->freq <= 0) {
+                        fprintf(stderr, "Invalid range format: \"%s\" "
+                                "is not following \"start:duration:freq\"\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                default:
+                    fprintf(stderr, "Unknown option -%c\n", opt);
+                    return EXIT_FAILURE;
+            }
+            i++;
+        } else if (!input) {
+            input = argv[i];
+        } else {
+            fprintf(stderr, "Unexpected option \"%s\"\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!input) {
+        fprintf(stderr, "Usage: %s [-i interval] [-m budget] [-D draws] [-g device] [-d] "
+                "-t start:duration:freq [-t start:duration:freq ...] input.ngl\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!nb_ranges) {
+        fprintf(stderr, "At least one range needs to be specified\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!debug)
+        ngl_log_set_min_level(NGL_LOG_WARNING);
+
+    int nb_times = 0;
+    double *times = get_times(ranges, nb_ranges, &nb_times);
+    struct ngl_analysis *analysis = calloc(nb_times, sizeof(*analysis));
+    struct ngl_node *scene = ngl_node_deserialize_file(input);
+    struct ngl_ctx *ctx = ngl_create();
+    if (!times || !analysis || !scene || !ctx)
+        goto end;
+
+    /* Nothing is drawn, the dimensions do not matter */
+    struct ngl_config config = {
+        .width = 16,
+        .height = 16,
+        .viewport = {0, 0, 16, 16},
+        .offscreen = 1,
+        .device = device,
+    };
+    if (ngl_configure(ctx, &config) < 0 || ngl_set_scene(ctx, scene) < 0)
+        goto end;
+
+    if (ngl_analyze(ctx, times, nb_times, analysis) < 0)
+        goto end;
+
+    if (debug) {
+        for (int i = 0; i < nb_times; i++) {
+            const struct ngl_analysis *a = &analysis[i];
+            printf("t=%.3f active=%d memory=%.2fMiB unknown=%d draws=%d dispatches=%d "
+                   "prefetches=%d prefetched=%.2fMiB\n", a->t, a->nb_active_nodes, to_mib(a->memory),
+                   a->nb_unknown_sizes, a->nb_draws, a->nb_dispatches, a->nb_prefetches,
+                   to_mib(a->prefetch_memory));
+        }
+        printf("\n");
+    }
+
+    print_windows(analysis, nb_times, interval);
+    print_peaks(analysis, nb_times);
+
+    int nb_exceeded = 0;
+    if (memory_budget || max_draws)
+        printf("\n");
+    if (memory_budget)
+        nb_exceeded += check_budget(analysis, nb_times, "memory", memory_budget, get_memory, 1. / (1024 * 1024), 2, "MiB");
+    if (max_draws)
+        nb_exceeded += check_budget(analysis, nb_times, "draws", max_draws, get_nb_draws, 1., 0, "");
+    if (memory_budget || max_draws)
+        printf("%s\n", nb_exceeded ? "budget exceeded" : "within budget");
+
+    ret = nb_exceeded ? EXIT_OVER_BUDGET : 0;
+
+end:
+    ngl_freep(&ctx);
+    ngl_node_unrefp(&scene);
+    free(analysis);
+    free(times);
+    return ret;
+}
@@ -19,55 +19,1128 @@
  * under the License.
  */
 
+#define _GNU_SOURCE // vmsplice(), F_SETPIPE_SZ
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/types.h>
 #include <fcntl.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 #include <nodegl.h>
 
 #include "common.h"
 #include "wsi.h"
 
-static struct ngl_node *get_scene(const char *filename)
+struct range {
+    float start;
+    float duration;
+    int freq;
+};
+
+enum {
+    BENCH_FRAME,
+    BENCH_CPU,
+    BENCH_VISIT,
+    BENCH_PREFETCH,
+    BENCH_UPDATE,
+    BENCH_DRAW,
+    BENCH_CAPTURE,
+    BENCH_SWAP,
+    BENCH_GPU,
+    BENCH_NB
+};
+
+static const char * const bench_names[BENCH_NB] = {
+    [BENCH_FRAME]    = "frame",
+    [BENCH_CPU]      = "cpu",
+    [BENCH_VISIT]    = "visit",
+    [BENCH_PREFETCH] = "prefetch",
+    [BENCH_UPDATE]   = "update",
+    [BENCH_DRAW]     = "draw",
+    [BENCH_CAPTURE]  = "capture",
+    [BENCH_SWAP]     = "swap",
+    [BENCH_GPU]      = "gpu",
+};
+
+static const char * const memory_names[NGL_STATS_MEMORY_NB] = {
+    [NGL_STATS_MEMORY_BUFFERS]       = "buffers",
+    [NGL_STATS_MEMORY_TEXTURES]      = "textures",
+    [NGL_STATS_MEMORY_RENDERBUFFERS] = "renderbuffers",
+    [NGL_STATS_MEMORY_TEXTURE_POOL]  = "texture_pool",
+};
+
+static const char * const cpu_memory_names[NGL_STATS_CPU_MEMORY_NB] = {
+    [NGL_STATS_CPU_MEMORY_NODES]   = "nodes",
+    [NGL_STATS_CPU_MEMORY_BUFFERS] = "buffers",
+    [NGL_STATS_CPU_MEMORY_DRAWING] = "drawing",
+};
+
+/*
+ * Per-frame timings of the measured frames, in microseconds, and peak GPU
+ * and CPU memory usage, in bytes
+ */
+struct bench {
+    int64_t *samples[BENCH_NB];
+    int nb_samples[BENCH_NB];
+    int max_samples;
+    int64_t total_time;
+    int64_t memory[NGL_STATS_MEMORY_NB];
+    int64_t cpu_memory[NGL_STATS_CPU_MEMORY_NB];
+};
+
+static int bench_add(struct bench *b, int metric, int64_t value)
 {
-    struct ngl_node *scene = NULL;
-    char *buf = NULL;
-    struct stat st;
+    if (b->nb_samples[metric] == b->max_samples) {
+        const int max_samples = b->max_samples ? b->max_samples * 2 : 256;
+        for (int i = 0; i < BENCH_NB; i++) {
+            int64_t *samples = realloc(b->samples[i], max_samples * sizeof(*samples));
+            if (!samples)
+                return -1;
+            b->samples[i] = samples;
+        }
+        b->max_samples = max_samples;
+    }
+    b->samples[metric][b->nb_samples[metric]++] = value;
+    return 0;
+}
+
+static int bench_add_frame(struct bench *b, struct ngl_ctx *ctx, int64_t frame_time)
+{
+    struct ngl_stats stats;
+    if (ngl_get_stats(ctx, &stats) < 0)
+        return -1;
+
+    const int64_t values[BENCH_NB] = {
+        [BENCH_FRAME]    = frame_time,
+        [BENCH_CPU]      = stats.cpu_time,
+        [BENCH_VISIT]    = stats.visit_time,
+        [BENCH_PREFETCH] = stats.prefetch_time,
+        [BENCH_UPDATE]   = stats.update_time,
+        [BENCH_DRAW]     = stats.draw_time,
+        [BENCH_CAPTURE]  = stats.capture_time,
+        [BENCH_SWAP]     = stats.swap_time,
+        [BENCH_GPU]      = stats.gpu_time,
+    };
+    for (int i = 0; i < BENCH_NB; i++) {
+        /* The GPU time is negative if timer queries are unsupported */
+        if (i == BENCH_GPU && values[i] < 0)
+            continue;
+        if (bench_add(b, i, values[i]) < 0)
+            return -1;
+    }
+    for (int i = 0; i < NGL_STATS_MEMORY_NB; i++)
+        if (stats.memory[i] > b->memory[i])
+            b->memory[i] = stats.memory[i];
+    memcpy(b->cpu_memory, stats.cpu_memory_peak, sizeof(b->cpu_memory));
+    b->total_time += frame_time;
+    return 0;
+}
+
+static int cmp_int64(const void *a, const void *b)
+{
+    const int64_t va = *(const int64_t *)a;
+    const int64_t vb = *(const int64_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static int64_t get_percentile(const int64_t *samples, int nb_samples, int p)
+{
+    const int rank = (p * nb_samples + 99) / 100;
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+
+static int bench_report(struct bench *b, const char *input, int warmup, const char *json_output)
+{
+    const int nb_frames = b->nb_samples[BENCH_FRAME];
+    if (!nb_frames) {
+        fprintf(stderr, "No frame measured, the warmup (%d frames) covers the whole time ranges\n", warmup);
+        return -1;
+    }
+
+    FILE *f = NULL;
+    if (json_output) {
+        f = fopen(json_output, "w");
+        if (!f) {
+            fprintf(stderr, "Unable to open %s\n", json_output);
+            return -1;
+        }
+    }
+
+    const double fps = nb_frames * 1000000. / b->total_time;
+    printf("Benchmark of %s: %d frames measured after %d warmup frames, FPS=%g\n",
+           input, nb_frames, warmup, fps);
+    printf("%-10s %10s %10s %10s %10s  (microseconds)\n", "", "min", "median", "p95", "p99");
+    if (f) {
+        fprintf(f, "{\n  \"input\": \"");
+        for (const char *p = input; *p; p++)
+            fprintf(f, *p == '"' || *p == '\\' ? "\\%c" : "%c", *p);
+        fprintf(f, "\",\n  \"warmup\": %d,\n  \"frames\": %d,\n  \"fps\": %g,\n  \"timings\": {",
+                warmup, nb_frames, fps);
+    }
+
+    int nb_printed = 0;
+    for (int i = 0; i < BENCH_NB; i++) {
+        int64_t *samples = b->samples[i];
+        const int nb_samples = b->nb_samples[i];
+        if (!nb_samples)
+            continue;
+        qsort(samples, nb_samples, sizeof(*samples), cmp_int64);
+        const int64_t min    = samples[0];
+        const int64_t median = get_percentile(samples, nb_samples, 50);
+        const int64_t p95    = get_percentile(samples, nb_samples, 95);
+        const int64_t p99    = get_percentile(samples, nb_samples, 99);
+        printf("%-10s %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "\n",
+               bench_names[i], min, median, p95, p99);
+        if (f)
+            fprintf(f, "%s\n    \"%s\": {\"min\": %" PRId64 ", \"median\": %" PRId64
+                    ", \"p95\": %" PRId64 ", \"p99\": %" PRId64 "}",
+                    nb_printed ? "," : "", bench_names[i], min, median, p95, p99);
+        nb_printed++;
+    }
+
+    printf("Peak memory (bytes):");
+    if (f)
+        fprintf(f, "\n  },\n  \"memory\": {");
+    for (int i = 0; i < NGL_STATS_MEMORY_NB; i++) {
+        printf(" %s=%" PRId64, memory_names[i], b->memory[i]);
+        if (f)
+            fprintf(f, "%s\n    \"%s\": %" PRId64, i ? "," : "", memory_names[i], b->memory[i]);
+    }
+    printf("\n");
+
+    printf("Peak CPU memory (bytes):");
+    if (f)
+        fprintf(f, "\n  },\n  \"cpu_memory\": {");
+    for (int i = 0; i < NGL_STATS_CPU_MEMORY_NB; i++) {
+        printf(" %s=%" PRId64, cpu_memory_names[i], b->cpu_memory[i]);
+        if (f)
+            fprintf(f, "%s\n    \"%s\": %" PRId64, i ? "," : "", cpu_memory_names[i], b->cpu_memory[i]);
+    }
+    printf("\n");
+
+    if (f) {
+        fprintf(f, "\n  }\n}\n");
+        fclose(f);
+    }
+    return 0;
+}
+
+static void bench_reset(struct bench *b)
+{
+    for (int i = 0; i < BENCH_NB; i++)
+        free(b->samples[i]);
+    memset(b, 0, sizeof(*b));
+}
+
+/*
+ * Output frame formats: the YUV ones are converted on the GPU by the capture,
+ * y4m wraps I420 frames in a YUV4MPEG2 stream directly readable by encoders
+ */
+enum {
+    OUTPUT_RGBA,
+    OUTPUT_NV12,
+    OUTPUT_I420,
+    OUTPUT_P010,
+    OUTPUT_Y4M,
+    OUTPUT_NB
+};
+
+static const struct {
+    const char *name;
+    int capture_format;
+} output_formats[OUTPUT_NB] = {
+    [OUTPUT_RGBA] = {"rgba", NGL_CAPTURE_FORMAT_RGBA},
+    [OUTPUT_NV12] = {"nv12", NGL_CAPTURE_FORMAT_NV12},
+    [OUTPUT_I420] = {"i420", NGL_CAPTURE_FORMAT_I420},
+    [OUTPUT_P010] = {"p010", NGL_CAPTURE_FORMAT_P010},
+    [OUTPUT_Y4M]  = {"y4m",  NGL_CAPTURE_FORMAT_I420},
+};
+
+static int get_output_format(const char *name)
+{
+    for (int i = 0; i < OUTPUT_NB; i++)
+        if (!strcmp(output_formats[i].name, name))
+            return i;
+    return -1;
+}
+
+static size_t get_frame_size(int format, int width, int height)
+{
+    switch (output_formats[format].capture_format) {
+    case NGL_CAPTURE_FORMAT_NV12:
+    case NGL_CAPTURE_FORMAT_I420: return (size_t)width * height * 3 / 2;
+    case NGL_CAPTURE_FORMAT_P010: return (size_t)width * height * 3;
+    default:                      return (size_t)width * height * 4;
+    }
+}
+
+struct output {
+    int fd;
+    int format;
+    size_t frame_size;
+    int splice;         // frames are spliced into the output pipe
+    int64_t pipe_size;
+    int64_t nb_bytes;   // bytes sent to the output so far
+};
+
+static int write_data(struct output *o, const uint8_t *data, size_t size)
+{
+    while (size) {
+        const ssize_t n = write(o->fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("write");
+            return -1;
+        }
+        data += n;
+        size -= n;
+        o->nb_bytes += n;
+    }
+    return 0;
+}
+
+#ifdef __linux__
+static int splice_data(struct output *o, const uint8_t *data, size_t size)
+{
+    while (size) {
+        struct iovec iov = {.iov_base = (void *)data, .iov_len = size};
+        const ssize_t n = vmsplice(o->fd, &iov, 1, 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("vmsplice");
+            return -1;
+        }
+        data += n;
+        size -= n;
+        o->nb_bytes += n;
+    }
+    return 0;
+}
+#endif
+
+static int output_init(struct output *o, int fd, int format, int width, int height,
+                       int rate, int splice)
+{
+    *o = (struct output){
+        .fd = fd,
+        .format = format,
+        .frame_size = get_frame_size(format, width, height),
+    };
+
+    if (splice) {
+#ifdef __linux__
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode)) {
+            /* A larger pipe lets the reader consume whole frames at once */
+            fcntl(fd, F_SETPIPE_SZ, 1 << 20);
+            o->pipe_size = fcntl(fd, F_GETPIPE_SZ);
+            o->splice = o->pipe_size > 0;
+        }
+#endif
+        if (!o->splice)
+            fprintf(stderr, "The output is not a pipe, falling back on regular writes\n");
+    }
+
+    if (format == OUTPUT_Y4M) {
+        /* The GPU conversion averages 2x2 blocks (centered chroma) in the BT.709 limited range */
+        char header[128];
+        snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                 width, height, rate);
+        return write_data(o, (const uint8_t *)header, strlen(header));
+    }
+    return 0;
+}
+
+/*
+ * When spliced, the pages of the frame are referenced by the pipe instead of
+ * being copied into it: they must not be modified until the reader consumed
+ * them, which is guaranteed once pipe_size more bytes have been sent (see
+ * output_get_release())
+ */
+static int output_frame(struct output *o, const uint8_t *data)
+{
+    if (o->format == OUTPUT_Y4M && write_data(o, (const uint8_t *)"FRAME\n", 6) < 0)
+        return -1;
+#ifdef __linux__
+    if (o->splice)
+        return splice_data(o, data, o->frame_size);
+#endif
+    return write_data(o, data, o->frame_size);
+}
+
+/* Output position past which the data of the last frame sent can be reused */
+static int64_t output_get_release(const struct output *o)
+{
+    return o->splice ? o->nb_bytes + o->pipe_size : o->nb_bytes;
+}
+
+/* Frames queued ahead of the writer before the rendering waits for it */
+#define QUEUE_SIZE 8
+
+/*
+ * Frame queue consumed by a writer thread, so the rendering only waits for
+ * the output when the queue is full
+ */
+struct writer {
+    struct output output;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *slots;
+    int64_t *slot_releases; // output position releasing each slot
+    int nb_slots;
+    int64_t nb_queued;
+    int64_t nb_written;
+    int64_t nb_released;    // frames whose slot can be reused
+    int eof;
+    int error;
+};
+
+static void *writer_thread(void *arg)
+{
+    struct writer *w = arg;
+    struct output *o = &w->output;
+
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        while (w->nb_written == w->nb_queued && !w->eof && !w->error)
+            pthread_cond_wait(&w->cond, &w->lock);
+        const int64_t frame = w->nb_written;
+        const int done = frame == w->nb_queued || w->error;
+        pthread_mutex_unlock(&w->lock);
+        if (done)
+            break;
+
+        const int slot = frame % w->nb_slots;
+        const int ret = output_frame(o, w->slots + slot * o->frame_size);
+
+        pthread_mutex_lock(&w->lock);
+        if (ret < 0)
+            w->error = 1;
+        w->slot_releases[slot] = output_get_release(o);
+        w->nb_written++;
+        while (w->nb_released < w->nb_written &&
+               w->slot_releases[w->nb_released % w->nb_slots] <= o->nb_bytes)
+            w->nb_released++;
+        pthread_cond_broadcast(&w->cond);
+        pthread_mutex_unlock(&w->lock);
+    }
+    return NULL;
+}
+
+static int writer_init(struct writer *w, int fd, int format, int width, int height,
+                       int rate, int splice)
+{
+    memset(w, 0, sizeof(*w));
+    if (output_init(&w->output, fd, format, width, height, rate, splice) < 0)
+        return -1;
+
+    /*
+     * A spliced slot is released pipe_size bytes later, the queue needs the
+     * room for the frames in flight in the pipe on top of the queued ones
+     */
+    const struct output *o = &w->output;
+    w->nb_slots = QUEUE_SIZE;
+    if (o->splice)
+        w->nb_slots += o->pipe_size / o->frame_size + 1;
+
+    w->slots = malloc(w->nb_slots * o->frame_size);
+    w->slot_releases = calloc(w->nb_slots, sizeof(*w->slot_releases));
+    if (!w->slots || !w->slot_releases)
+        goto fail;
+
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->cond, NULL);
+    if (pthread_create(&w->thread, NULL, writer_thread, w)) {
+        pthread_cond_destroy(&w->cond);
+        pthread_mutex_destroy(&w->lock);
+        goto fail;
+    }
+    return 0;
+
+fail:
+    free(w->slot_releases);
+    free(w->slots);
+    w->slots = NULL;
+    return -1;
+}
+
+static int writer_push(struct writer *w, const uint8_t *data)
+{
+    const size_t frame_size = w->output.frame_size;
+
+    pthread_mutex_lock(&w->lock);
+    while (w->nb_queued - w->nb_released == w->nb_slots && !w->error)
+        pthread_cond_wait(&w->cond, &w->lock);
+    const int error = w->error;
+    pthread_mutex_unlock(&w->lock);
+    if (error)
+        return -1;
+
+    /* The writer never accesses the slot before nb_queued moves */
+    memcpy(w->slots + (w->nb_queued % w->nb_slots) * frame_size, data, frame_size);
+
+    pthread_mutex_lock(&w->lock);
+    w->nb_queued++;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    return 0;
+}
+
+static int writer_get_error(struct writer *w)
+{
+    pthread_mutex_lock(&w->lock);
+    const int error = w->error;
+    pthread_mutex_unlock(&w->lock);
+    return error;
+}
+
+static void writer_push_cb(void *user_arg, const uint8_t *data)
+{
+    /* An error is reported by the next writer_push() or writer_close() */
+    writer_push(user_arg, data);
+}
+
+/* Wait for the queued frames to be written and release the writer */
+static int writer_close(struct writer *w)
+{
+    if (!w->slots)
+        return 0;
+
+    pthread_mutex_lock(&w->lock);
+    w->eof = 1;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+
+    const int ret = w->error ? -1 : 0;
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+    free(w->slot_releases);
+    free(w->slots);
+    w->slots = NULL;
+    return ret;
+}
+
+/*
+ * Frames are distributed to the contexts in chunks of consecutive times so
+ * each context keeps decoding its media sequentially instead of seeking
+ */
+#define CHUNK_SIZE 16
+
+struct parallel {
+    const char *input;
+    int width;
+    int height;
+    int device;
+    int debug;
+    int capture_format;
+    struct output *output;  // NULL if the frames are not written
+    float *times;
+    int nb_frames;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int next_chunk;     // first frame of the next chunk to render
+    int next_write;     // next frame to write to the output
+    int error;
+
+    /* Reorder buffer of the rendered frames waiting to be written in order */
+    uint8_t *slots;
+    int *slot_frames;   // frame index stored in each slot, -1 if empty
+    int nb_slots;
+};
+
+static int store_frame(struct parallel *p, int frame, const uint8_t *data)
+{
+    const size_t frame_size = p->output->frame_size;
 
-    int fd = open(filename, O_RDONLY);
-    if (fd == -1) {
-        fprintf(stderr, "unable to open %s\n", filename);
+    pthread_mutex_lock(&p->lock);
+    while (frame >= p->next_write + p->nb_slots && !p->error)
+        pthread_cond_wait(&p->cond, &p->lock);
+    if (p->error) {
+        pthread_mutex_unlock(&p->lock);
+        return -1;
+    }
+    const int slot = frame % p->nb_slots;
+    memcpy(p->slots + slot * frame_size, data, frame_size);
+    p->slot_frames[slot] = frame;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+static void *render_thread(void *arg)
+{
+    struct parallel *p = arg;
+    struct ngl_ctx *ctx = NULL;
+    uint8_t *capture_buffer = NULL;
+    int ret = -1;
+
+    /* A scene can only be attached to one context, each gets its own copy */
+    struct ngl_node *scene = ngl_node_deserialize_file(p->input);
+    if (!scene)
         goto end;
+
+    if (p->output) {
+        capture_buffer = calloc(1, p->output->frame_size);
+        if (!capture_buffer)
+            goto end;
     }
 
-    if (fstat(fd, &st) == -1)
+    ctx = ngl_create();
+    if (!ctx)
         goto end;
 
-    buf = malloc(st.st_size + 1);
-    if (!buf)
+    struct ngl_config config = {
+        .width = p->width,
+        .height = p->height,
+        .viewport = {0, 0, p->width, p->height},
+        .offscreen = 1,
+        .device = p->device,
+        .capture_buffer = capture_buffer,
+        .capture_format = p->capture_format,
+        .clear_color = {0.0f, 0.0f, 0.0f, 1.0f},
+    };
+
+    if (ngl_configure(ctx, &config) < 0 || ngl_set_scene(ctx, scene) < 0)
         goto end;
 
-    int n = read(fd, buf, st.st_size);
-    buf[n] = 0;
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        const int start = p->next_chunk;
+        const int error = p->error;
+        p->next_chunk += CHUNK_SIZE;
+        pthread_mutex_unlock(&p->lock);
 
-    scene = ngl_node_deserialize(buf);
+        if (error || start >= p->nb_frames)
+            break;
+
+        const int end = start + CHUNK_SIZE < p->nb_frames ? start + CHUNK_SIZE : p->nb_frames;
+        for (int i = start; i < end; i++) {
+            const float t = p->times[i];
+            if (p->debug)
+                printf("draw @ t=%f [frame %d/%d]\n", t, i + 1, p->nb_frames);
+            if (ngl_draw(ctx, t) < 0) {
+                fprintf(stderr, "Unable to draw @ t=%g\n", t);
+                goto end;
+            }
+            if (capture_buffer && store_frame(p, i, capture_buffer) < 0)
+                goto end;
+        }
+    }
+    ret = 0;
 
 end:
+    if (ret < 0) {
+        pthread_mutex_lock(&p->lock);
+        p->error = 1;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+    }
+    ngl_node_unrefp(&scene);
+    ngl_freep(&ctx);
+    free(capture_buffer);
+    return NULL;
+}
+
+static int write_frames(struct parallel *p)
+{
+    const size_t frame_size = p->output->frame_size;
+
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        const int frame = p->next_write;
+        const int slot = frame % p->nb_slots;
+        while (frame < p->nb_frames && p->slot_frames[slot] != frame && !p->error)
+            pthread_cond_wait(&p->cond, &p->lock);
+        const int error = p->error;
+        pthread_mutex_unlock(&p->lock);
+
+        if (error)
+            return -1;
+        if (frame >= p->nb_frames)
+            return 0;
+
+        /* The slot can not be reused by the rendering threads until next_write moves */
+        if (output_frame(p->output, p->slots + slot * frame_size) < 0) {
+            pthread_mutex_lock(&p->lock);
+            p->error = 1;
+            pthread_cond_broadcast(&p->cond);
+            pthread_mutex_unlock(&p->lock);
+            return -1;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        p->slot_frames[slot] = -1;
+        p->next_write++;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+static int render_parallel(const char *input, const struct range *ranges, int nb_ranges,
+                           int width, int height, int device, struct output *output,
+                           int capture_format, int nb_jobs, int debug)
+{
+    int ret = -1;
+    int nb_threads = 0;
+    pthread_t threads[64];
+    struct parallel p = {
+        .input = input,
+        .width = width,
+        .height = height,
+        .device = device,
+        .debug = debug,
+        .capture_format = capture_format,
+        .output = output,
+        .nb_slots = 2 * nb_jobs * CHUNK_SIZE,
+    };
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass) {
+            p.times = malloc(p.nb_frames * sizeof(*p.times));
+            if (!p.times)
+                goto end;
+            p.nb_frames = 0;
+        }
+        for (int i = 0; i < nb_ranges; i++) {
+            const struct range *r = &ranges[i];
+            const float t1 = r->start + r->duration;
+            for (int k = 0;; k++) {
+                const float t = r->start + k*1./r->freq;
+                if (t >= t1)
+                    break;
+                if (pass)
+                    p.times[p.nb_frames] = t;
+                p.nb_frames++;
+            }
+        }
+    }
+
+    if (output) {
+        p.slots = calloc(p.nb_slots, output->frame_size);
+        p.slot_frames = malloc(p.nb_slots * sizeof(*p.slot_frames));
+        if (!p.slots || !p.slot_frames)
+            goto end;
+        for (int i = 0; i < p.nb_slots; i++)
+            p.slot_frames[i] = -1;
+    }
+
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.cond, NULL);
+
+    const int64_t start = gettime();
+
+    for (nb_threads = 0; nb_threads < nb_jobs; nb_threads++) {
+        if (pthread_create(&threads[nb_threads], NULL, render_thread, &p)) {
+            pthread_mutex_lock(&p.lock);
+            p.error = 1;
+            pthread_cond_broadcast(&p.cond);
+            pthread_mutex_unlock(&p.lock);
+            break;
+        }
+    }
+
+    ret = output ? write_frames(&p) : 0;
+
+    for (int i = 0; i < nb_threads; i++)
+        pthread_join(threads[i], NULL);
+    if (p.error)
+        ret = -1;
+
+    if (ret == 0) {
+        const double tdiff = (gettime() - start) / 1000000.;
+        printf("Rendered %d frames with %d contexts in %g (FPS=%g)\n",
+               p.nb_frames, nb_jobs, tdiff, p.nb_frames / tdiff);
+    }
+
+    pthread_cond_destroy(&p.cond);
+    pthread_mutex_destroy(&p.lock);
+
+end:
+    free(p.slot_frames);
+    free(p.slots);
+    free(p.times);
+    return ret;
+}
+
+#ifndef _WIN32
+/*
+ * Render server: the contexts are kept configured between the jobs, so
+ * the jobs sharing the same dimensions and format skip the context creation
+ * and reuse the programs, images and media of the previous scenes
+ */
+#define MAX_CONTEXTS 4
+
+struct server_context {
+    struct ngl_ctx *ctx;
+    int width;
+    int height;
+    int capture_format;
+    int capture;
+    int64_t last_use;
+    struct writer writer; // capture_user_arg of the context
+};
+
+struct job {
+    int width;
+    int height;
+    int format;
+    char *output;
+    struct range ranges[128];
+    int nb_ranges;
+    struct ngl_node *scene;
+    int64_t load_time; // scene deserialization
+};
+
+struct job_timings {
+    int warm;
+    int nb_frames;
+    int64_t setup;  // context creation and scene initialization
+    int64_t render;
+    int64_t flush;  // output of the last queued frames
+};
+
+static void server_context_reset(struct server_context *c)
+{
+    ngl_freep(&c->ctx);
+    memset(c, 0, sizeof(*c));
+}
+
+static struct server_context *get_server_context(struct server_context *contexts, int64_t clock,
+                                                 const struct job *job, int device, int *warm)
+{
+    const int capture = job->output != NULL;
+    const int capture_format = output_formats[job->format].capture_format;
+    struct server_context *c = NULL;
+    for (int i = 0; i < MAX_CONTEXTS; i++) {
+        struct server_context *cur = &contexts[i];
+        if (cur->ctx && cur->width == job->width && cur->height == job->height &&
+            cur->capture_format == capture_format && cur->capture == capture) {
+            cur->last_use = clock;
+            *warm = 1;
+            return cur;
+        }
+        if (!c || !cur->ctx || (c->ctx && cur->last_use < c->last_use))
+            c = cur;
+    }
+
+    /* Replace the least recently used context */
+    *warm = 0;
+    server_context_reset(c);
+    c->ctx = ngl_create();
+    if (!c->ctx)
+        return NULL;
+
+    struct ngl_config config = {
+        .width = job->width,
+        .height = job->height,
+        .viewport = {0, 0, job->width, job->height},
+        .offscreen = 1,
+        .device = device,
+        .capture_callback = capture ? writer_push_cb : NULL,
+        .capture_user_arg = &c->writer,
+        .capture_format = capture_format,
+        .clear_color = {0.0f, 0.0f, 0.0f, 1.0f},
+    };
+    if (ngl_configure(c->ctx, &config) < 0) {
+        server_context_reset(c);
+        return NULL;
+    }
+
+    c->width = job->width;
+    c->height = job->height;
+    c->capture_format = capture_format;
+    c->capture = capture;
+    c->last_use = clock;
+    return c;
+}
+
+static int run_job(struct server_context *contexts, int64_t clock, const struct job *job,
+                   int device, int debug, struct job_timings *timings)
+{
+    int64_t t = gettime();
+    struct server_context *c = get_server_context(contexts, clock, job, device, &timings->warm);
+    if (!c)
+        return -1;
+
+    /* A scene matching the previous one keeps its nodes and resources */
+    if (ngl_update_scene(c->ctx, job->scene) < 0)
+        goto fail;
+    timings->setup = gettime() - t;
+
+    int fd = -1;
+    if (job->output) {
+        fd = open(job->output, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+        if (fd == -1) {
+            fprintf(stderr, "Unable to open %s\n", job->output);
+            return -1;
+        }
+        if (writer_init(&c->writer, fd, job->format, job->width, job->height, job->ranges[0].freq, 0) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    t = gettime();
+    int ret = 0;
+    for (int i = 0; i < job->nb_ranges && ret == 0; i++) {
+        const struct range *r = &job->ranges[i];
+        for (int k = 0;; k++) {
+            const float t = r->start + k*1./r->freq;
+            if (t >= r->start + r->duration)
+                break;
+            if (debug)
+                printf("draw @ t=%f\n", t);
+            ret = ngl_draw(c->ctx, t);
+            if (ret < 0) {
+                fprintf(stderr, "Unable to draw @ t=%g\n", t);
+                break;
+            }
+            if (fd != -1 && writer_get_error(&c->writer)) {
+                fprintf(stderr, "Unable to write the frames to %s\n", job->output);
+                ret = -1;
+                break;
+            }
+            timings->nb_frames++;
+        }
+    }
+    timings->render = gettime() - t;
+
+    /* Deliver the frames still being read back before closing the output */
+    t = gettime();
+    if (ngl_wait(c->ctx) < 0)
+        ret = -1;
+    if (writer_close(&c->writer) < 0)
+        ret = -1;
     if (fd != -1)
         close(fd);
-    free(buf);
-    return scene;
+    timings->flush = gettime() - t;
+
+    if (ret < 0)
+        goto fail;
+    return 0;
+
+fail:
+    /* The state of a context which failed can not be trusted anymore */
+    server_context_reset(c);
+    return -1;
 }
 
-struct range {
-    float start;
-    float duration;
-    int freq;
-};
+static char *read_payload(FILE *f, size_t size)
+{
+    char *data = malloc(size + 1);
+    if (!data)
+        return NULL;
+    if (fread(data, 1, size, f) != size) {
+        free(data);
+        return NULL;
+    }
+    data[size] = 0;
+    return data;
+}
+
+/*
+ * Read the lines of a job up to its scene, which terminates it. Returns 0
+ * if a job has been read, 1 on quit or end of connection, and -1 on error
+ * along with its description.
+ */
+static int read_job(FILE *f, struct job *job, char *err, size_t err_size)
+{
+    char line[4096];
+    int has_scene = 0;
+    *job = (struct job){.width = 320, .height = 240};
+    while (!has_scene && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        char *arg = strchr(line, ' ');
+        if (arg)
+            *arg++ = 0;
+
+        if (!strcmp(line, "quit")) {
+            return 1;
+        } else if (!arg) {
+            snprintf(err, err_size, "missing argument to \"%s\"", line);
+            return -1;
+        } else if (!strcmp(line, "size")) {
+            if (sscanf(arg, "%dx%d", &job->width, &job->height) != 2 ||
+                job->width <= 0 || job->width > 8192 || job->height <= 0 || job->height > 8192) {
+                snprintf(err, err_size, "invalid size \"%s\"", arg);
+                return -1;
+            }
+        } else if (!strcmp(line, "format")) {
+            job->format = get_output_format(arg);
+            if (job->format < 0) {
+                snprintf(err, err_size, "invalid output format \"%s\"", arg);
+                return -1;
+            }
+        } else if (!strcmp(line, "output")) {
+            free(job->output);
+            job->output = strdup(arg);
+            if (!job->output)
+                return -1;
+        } else if (!strcmp(line, "range")) {
+            if (job->nb_ranges >= sizeof(job->ranges)/sizeof(*job->ranges)) {
+                snprintf(err, err_size, "too much ranges");
+                return -1;
+            }
+            struct range *r = &job->ranges[job->nb_ranges++];
+            if (sscanf(arg, "%f:%f:%d", &r->start, &r->duration, &r->freq) != 3 || r->freq <= 0) {
+                snprintf(err, err_size, "invalid range \"%s\"", arg);
+                return -1;
+            }
+        } else if (!strcmp(line, "scene") || !strcmp(line, "scene_binary")) {
+            const int binary = !strcmp(line, "scene_binary");
+            const long size = strtol(arg, NULL, 0);
+            char *data = size > 0 ? read_payload(f, size) : NULL;
+            if (!data) {
+                snprintf(err, err_size, "unable to read the %ld bytes of the scene", size);
+                return -1;
+            }
+            const int64_t start = gettime();
+            job->scene = binary ? ngl_node_deserialize_binary(data, size) : ngl_node_deserialize(data);
+            job->load_time = gettime() - start;
+            free(data);
+            has_scene = 1;
+        } else if (!strcmp(line, "scene_file")) {
+            const int64_t start = gettime();
+            job->scene = ngl_node_deserialize_file(arg);
+            job->load_time = gettime() - start;
+            has_scene = 1;
+        } else {
+            snprintf(err, err_size, "unknown command \"%s\"", line);
+            return -1;
+        }
+    }
+
+    if (!has_scene)
+        return 1;
+    if (!job->scene) {
+        snprintf(err, err_size, "unable to deserialize the scene");
+        return -1;
+    }
+    if (!job->nb_ranges) {
+        snprintf(err, err_size, "at least one range needs to be specified");
+        return -1;
+    }
+    if (output_formats[job->format].capture_format != NGL_CAPTURE_FORMAT_RGBA &&
+        (job->width % 4 || job->height % 4)) {
+        snprintf(err, err_size, "the %s output format requires dimensions multiple of 4",
+                 output_formats[job->format].name);
+        return -1;
+    }
+    return 0;
+}
+
+static void job_reset(struct job *job)
+{
+    free(job->output);
+    ngl_node_unrefp(&job->scene);
+}
+
+static int run_server(const char *path, int device, int debug)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    const int sfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sfd == -1) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(sfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(sfd, 16) < 0) {
+        perror(path);
+        close(sfd);
+        return -1;
+    }
+
+    /* The clients and output pipes closing early must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Listening on %s\n", path);
+
+    struct server_context contexts[MAX_CONTEXTS] = {0};
+    int64_t clock = 0;
+    int quit = 0;
+    int ret = 0;
+
+    while (!quit) {
+        const int cfd = accept(sfd, NULL, NULL);
+        if (cfd == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("accept");
+            ret = -1;
+            break;
+        }
+        FILE *f = fdopen(cfd, "r");
+        if (!f) {
+            close(cfd);
+            continue;
+        }
+
+        /* The jobs of a connection are processed in sequence until it is closed */
+        for (;;) {
+            struct job job;
+            struct job_timings timings = {0};
+            char err[256] = "out of memory";
+
+            const int job_ret = read_job(f, &job, err, sizeof(err));
+            if (job_ret == 1) {
+                quit = !feof(f) && !ferror(f);
+                job_reset(&job);
+                break;
+            }
+
+            if (job_ret < 0) {
+                dprintf(cfd, "error %s\n", err);
+            } else if (run_job(contexts, ++clock, &job, device, debug, &timings) < 0) {
+                dprintf(cfd, "error job failed after %d frames\n", timings.nb_frames);
+            } else {
+                const int64_t total = job.load_time + timings.setup + timings.render + timings.flush;
+                dprintf(cfd, "ok frames=%d warm=%d load=%" PRId64 " setup=%" PRId64 " render=%" PRId64
+                        " flush=%" PRId64 " total=%" PRId64 "\n", timings.nb_frames, timings.warm,
+                        job.load_time, timings.setup, timings.render, timings.flush, total);
+                printf("Job %" PRId64 ": %dx%d %s -> %s, %d frames in %g (%s context)\n",
+                       clock, job.width, job.height, output_formats[job.format].name,
+                       job.output ? job.output : "-", timings.nb_frames, total / 1000000.,
+                       timings.warm ? "warm" : "new");
+            }
+            job_reset(&job);
+            if (job_ret < 0)
+                break;
+        }
+        fclose(f);
+    }
+
+    for (int i = 0; i < MAX_CONTEXTS; i++)
+        server_context_reset(&contexts[i]);
+    close(sfd);
+    unlink(path);
+    return ret;
+}
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -81,6 +1154,17 @@ int main(int argc, char *argv[])
     int show_window = 0;
     int swap_interval = 0;
     int debug = 0;
+    int nb_jobs = 1;
+    int device = 0;
+    int bench = 0;
+    int splice = 0;
+    int format = OUTPUT_RGBA;
+    int warmup = 10;
+    const char *bench_output = NULL;
+#ifndef _WIN32
+    const char *server = NULL;
+#endif
+    struct bench bench_data = {0};
     GLFWwindow *window = NULL;
 
     for (int i = 1; i < argc; i++) {
@@ -88,6 +1172,14 @@ int main(int argc, char *argv[])
             debug = 1;
         } else if (!strcmp(argv[i], "-w")) {
             show_window = 1;
+        } else if (!strcmp(argv[i], "--bench")) {
+            bench = 1;
+        } else if (!strcmp(argv[i], "--splice")) {
+            splice = 1;
+#ifndef _WIN32
+        } else if (!strcmp(argv[i], "--server") && i < argc - 1) {
+            server = argv[++i];
+#endif
         } else if (argv[i][0] == '-' && i < argc - 1) {
             const char opt = argv[i][1];
             const char *arg = argv[i + 1];
@@ -95,6 +1187,24 @@ int main(int argc, char *argv[])
                 case 'o':
                     output = arg;
                     break;
+                case 'b':
+                    bench_output = arg;
+                    break;
+                case 'f':
+                    format = get_output_format(arg);
+                    if (format < 0) {
+                        fprintf(stderr, "Invalid output format: \"%s\" is not any of "
+                                "rgba, nv12, i420, p010 or y4m\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case 'W':
+                    warmup = atoi(arg);
+                    if (warmup < 0) {
+                        fprintf(stderr, "Invalid number of warmup frames: \"%s\"\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
                 case 's':
                     if (sscanf(arg, "%dx%d", &width, &height) != 2) {
                         fprintf(stderr, "Invalid size format: \"%s\" "
@@ -109,6 +1219,20 @@ int main(int argc, char *argv[])
                 case 'z':
                     swap_interval = atoi(arg);
                     break;
+                case 'j':
+                    nb_jobs = atoi(arg);
+                    if (nb_jobs < 1 || nb_jobs > 64) {
+                        fprintf(stderr, "Invalid number of jobs: \"%s\" is not in [1,64]\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case 'g':
+                    device = atoi(arg);
+                    if (device < 1) {
+                        fprintf(stderr, "Invalid device: \"%s\" is not a device number starting at 1\n", arg);
+                        return EXIT_FAILURE;
+                    }
+                    break;
                 case 't':
                     if (nb_ranges >= sizeof(ranges)/sizeof(*ranges)) {
                         fprintf(stderr, "Too much ranges specified (max:%d)\n",
@@ -135,8 +1259,15 @@ int main(int argc, char *argv[])
         }
     }
 
+#ifndef _WIN32
+    if (server)
+        return run_server(server, device, debug) < 0 ? EXIT_FAILURE : 0;
+#endif
+
     if (!input) {
-        fprintf(stderr, "Usage: %s [-o out.raw] [-s WxH] [-w] [-d] [-z swapinterval] input.ngl\n", argv[0]);
+        fprintf(stderr, "Usage: %s [-o out.raw] [-f rgba|nv12|i420|p010|y4m] [--splice] [-s WxH] [-w] [-d] "
+                "[-z swapinterval] [-j jobs] [-g device] [--bench] [-W warmup] [-b report.json] input.ngl\n"
+                "       %s --server socket [-g device] [-d]\n", argv[0], argv[0]);
         return EXIT_FAILURE;
     }
 
@@ -145,6 +1276,31 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (nb_jobs > 1 && show_window) {
+        fprintf(stderr, "Parallel rendering can only be done offscreen\n");
+        return EXIT_FAILURE;
+    }
+
+    if (nb_jobs > 1 && bench) {
+        fprintf(stderr, "The benchmark mode can not be used with parallel rendering\n");
+        return EXIT_FAILURE;
+    }
+
+    if (bench_output && !bench) {
+        fprintf(stderr, "A benchmark report can only be written in benchmark mode\n");
+        return EXIT_FAILURE;
+    }
+
+    if (output_formats[format].capture_format != NGL_CAPTURE_FORMAT_RGBA && (width % 4 || height % 4)) {
+        fprintf(stderr, "The %s output format requires dimensions multiple of 4\n", output_formats[format].name);
+        return EXIT_FAILURE;
+    }
+
+    if (nb_jobs > 1 && splice) {
+        fprintf(stderr, "The output can not be spliced with parallel rendering\n");
+        return EXIT_FAILURE;
+    }
+
     printf("%s -> %s %dx%d\n", input, output ? output : "-", width, height);
 
     if (show_window) {
@@ -161,12 +1317,10 @@ int main(int argc, char *argv[])
     int fd = -1;
     struct ngl_ctx *ctx = NULL;
     uint8_t *capture_buffer = NULL;
+    struct output parallel_output;
+    struct writer writer = {0};
 
-    struct ngl_node *scene = get_scene(input);
-    if (!scene) {
-        ret = EXIT_FAILURE;
-        goto end;
-    }
+    struct ngl_node *scene = NULL;
 
     if (output) {
         int flags = O_WRONLY|O_CREAT|O_TRUNC;
@@ -179,9 +1333,45 @@ int main(int argc, char *argv[])
             ret = EXIT_FAILURE;
             goto end;
         }
-        capture_buffer = calloc(width * height, 4);
-        if (!capture_buffer)
+    }
+
+    const int capture_format = output_formats[format].capture_format;
+
+    if (nb_jobs > 1) {
+        struct output *o = NULL;
+        if (output) {
+            if (output_init(&parallel_output, fd, format, width, height, ranges[0].freq, 0) < 0) {
+                ret = EXIT_FAILURE;
+                goto end;
+            }
+            o = &parallel_output;
+        }
+        if (render_parallel(input, ranges, nb_ranges, width, height, device, o, capture_format, nb_jobs, debug) < 0)
+            ret = EXIT_FAILURE;
+        goto end;
+    }
+
+    scene = ngl_node_deserialize_file(input);
+    if (!scene) {
+        ret = EXIT_FAILURE;
+        goto end;
+    }
+
+    if (output) {
+        if (writer_init(&writer, fd, format, width, height, ranges[0].freq, splice) < 0) {
+            ngl_node_unrefp(&scene);
+            ret = EXIT_FAILURE;
             goto end;
+        }
+        /* The asynchronous capture is only available offscreen */
+        if (show_window) {
+            capture_buffer = calloc(1, writer.output.frame_size);
+            if (!capture_buffer) {
+                ngl_node_unrefp(&scene);
+                ret = EXIT_FAILURE;
+                goto end;
+            }
+        }
     }
 
     ctx = ngl_create();
@@ -195,7 +1385,11 @@ int main(int argc, char *argv[])
         .height = height,
         .viewport = {0, 0, width, height},
         .offscreen = !show_window,
+        .device = device,
         .capture_buffer = capture_buffer,
+        .capture_callback = output && !show_window ? writer_push_cb : NULL,
+        .capture_user_arg = &writer,
+        .capture_format = output ? capture_format : NGL_CAPTURE_FORMAT_RGBA,
         .clear_color = {0.0f, 0.0f, 0.0f, 1.0f},
     };
     if (show_window) {
@@ -218,6 +1412,7 @@ int main(int argc, char *argv[])
     if (ret < 0)
         goto end;
 
+    int nb_drawn = 0;
     for (int i = 0; i < nb_ranges; i++) {
         int k = 0;
         const struct range *r = &ranges[i];
@@ -233,13 +1428,28 @@ int main(int argc, char *argv[])
             if (debug)
                 printf("draw @ t=%f [range %d/%d: %g-%g @ %dHz]\n",
                        t, i + 1, nb_ranges, t0, t1, r->freq);
+            const int64_t frame_start = gettime();
             ret = ngl_draw(ctx, t);
             if (ret < 0) {
                 fprintf(stderr, "Unable to draw @ t=%g\n", t);
                 goto end;
             }
+            const int64_t frame_time = gettime() - frame_start;
+            if (bench && nb_drawn >= warmup) {
+                ret = bench_add_frame(&bench_data, ctx, frame_time);
+                if (ret < 0) {
+                    fprintf(stderr, "Unable to record the frame timings\n");
+                    goto end;
+                }
+            }
+            nb_drawn++;
             if (capture_buffer)
-                write(fd, capture_buffer, 4 * width * height);
+                writer_push(&writer, capture_buffer);
+            if (output && writer_get_error(&writer)) {
+                fprintf(stderr, "Unable to write the frames to %s\n", output);
+                ret = EXIT_FAILURE;
+                goto end;
+            }
             if (show_window)
                 glfwPollEvents();
             k++;
@@ -249,8 +1459,16 @@ int main(int argc, char *argv[])
         printf("Rendered %d frames in %g (FPS=%g)\n", k, tdiff, k / tdiff);
     }
 
+    if (bench && bench_report(&bench_data, input, warmup, bench_output) < 0)
+        ret = EXIT_FAILURE;
+
 end:
+    bench_reset(&bench_data);
+
+    /* Releasing the context delivers the last captured frames to the writer */
     ngl_freep(&ctx);
+    if (writer_close(&writer) < 0)
+        ret = EXIT_FAILURE;
 
     if (fd != -1)
         close(fd);
@@ -204,7 +204,10 @@ static void update_time(int64_t seek_at)
     }
 
     if (!p->paused) {
-        const int64_t now = gettime();
+        /* Draw the frame for the time it is going to be displayed at */
+        int64_t delay = 0;
+        ngl_predict_display_delay(p->ngl, &delay);
+        const int64_t now = gettime() + delay;
         if (p->clock_off < 0 || now - p->clock_off > p->duration)
             p->clock_off = now;
 
@@ -299,6 +302,11 @@ void player_uninit(void)
 {
     struct player *p = g_player;
 
+    struct ngl_stats stats;
+    if (p->ngl && ngl_get_stats(p->ngl, &stats) == 0 && stats.nb_late_frames)
+        fprintf(stderr, "%d late frame(s), %d display refresh(es) missed\n",
+                stats.nb_late_frames, stats.nb_dropped_frames);
+
     ngl_freep(&p->ngl);
     glfwDestroyWindow(p->window);
     glfwTerminate();
@@ -21,6 +21,7 @@
 # under the License.
 #
 
+import atexit
 import imp
 import importlib
 import inspect
@@ -28,6 +29,7 @@ import os
 import os.path as op
 import pickle
 import pkgutil
+import struct
 import subprocess
 import sys
 import traceback
@@ -36,13 +38,11 @@ import pynodegl as ngl
 from pynodegl_utils.filetracker import FileTracker
 
 
-IPC_READ_BUFSIZE = 4096
+IPC_HEADER = struct.Struct('<Q')
 
-# For some unknown reason, Python deadlocks with the pipes when trying to run
-# subprocesses simultaneously. In the context of the viewer, this may happen
-# with concurrent 'list' and 'scene' queries when a change is detected. This
-# global lock is here to prevent several sub-process to happen in parallel.
-_lock = threading.Lock()
+# Maximum number of idle workers kept alive; the viewer typically runs a
+# 'list' and a 'scene' query concurrently when a change is detected
+MAX_IDLE_WORKERS = 2
 
 
 def _load_script(path):
@@ -57,58 +57,101 @@ def _load_script(path):
             fp.close()
 
 
-def query_subproc(**idict):
+def _read_all(fd, size):
+    data = ''
+    while len(data) < size:
+        rdata = os.read(fd, size - len(data))
+        if not rdata:
+            raise EOFError('connection closed')
+        data += rdata
+    return data
+
+
+def _send_msg(fd, obj):
+    data = pickle.dumps(obj, pickle.HIGHEST_PROTOCOL)
+    data = IPC_HEADER.pack(len(data)) + data
+    while data:
+        data = data[os.write(fd, data):]
 
-    '''
-    Run the query in a sub-process. IPC happens using pipes and pickle
-    serialization of dict.
 
-    The parent process will write the query to the writable input fd
-    (ifilesd[1]) and read the result from the readable output fd (ofilesd[0]).
+def _recv_msg(fd):
+    size, = IPC_HEADER.unpack(_read_all(fd, IPC_HEADER.size))
+    return pickle.loads(_read_all(fd, size))
+
+
+class _Worker:
 
-    The executed child (ngl-com sub-process) will read the query from the
-    readable input fd (ifilesd[0]) and write result to writable output fd
-    (ofilesd[1]).
+    '''
+    Persistent ngl-com sub-process answering the queries one at a time. The
+    queries and results are pickled dicts sent through the standard input and
+    output of the process, prefixed with their size.
     '''
 
-    _lock.acquire()
+    def __init__(self):
+        cmd = [sys.executable, '-m', 'pynodegl_utils.com']
+        # close_fds prevents the workers from inheriting the pipes of each
+        # other, which would keep them open when a worker exits
+        self._proc = subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE, close_fds=True)
 
-    ifilesd = os.pipe()
-    ofilesd = os.pipe()
+    def query(self, idict):
+        _send_msg(self._proc.stdin.fileno(), idict)
+        return _recv_msg(self._proc.stdout.fileno())
 
-    def close_unused_child_fds():
-        os.close(ifilesd[1])
-        os.close(ofilesd[0])
+    def close(self):
+        self._proc.stdin.close()
+        self._proc.stdout.close()
+        self._proc.wait()
 
-    def close_unused_parent_fds():
-        os.close(ifilesd[0])
-        os.close(ofilesd[1])
 
-    cmd = [sys.executable, '-m', 'pynodegl_utils.com', str(ifilesd[0]), str(ofilesd[1])]
-    ret = subprocess.Popen(cmd, preexec_fn=close_unused_child_fds)
-    close_unused_parent_fds()
+class _WorkerPool:
 
-    # Send input
-    fd_w = ifilesd[1]
-    idata = pickle.dumps(idict)
-    os.write(fd_w, idata)
-    os.close(fd_w)
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._idle_workers = []
+        atexit.register(self.close)
 
-    # Receive output
-    fd_r = ofilesd[0]
-    odata = ''
-    while True:
-        rdata = os.read(fd_r, IPC_READ_BUFSIZE)
-        if not rdata:
-            break
-        odata += rdata
-    os.close(fd_r)
-    odict = pickle.loads(odata)
+    def query(self, idict):
+        with self._lock:
+            worker = self._idle_workers.pop() if self._idle_workers else None
+        if worker is None:
+            worker = _Worker()
 
-    ret.wait()
+        try:
+            odict = worker.query(idict)
+        except (EOFError, OSError):
+            # The worker exits when it can not reload its modules, the query
+            # is then run again by a new one
+            worker.close()
+            worker = _Worker()
+            odict = worker.query(idict)
+
+        with self._lock:
+            if len(self._idle_workers) < MAX_IDLE_WORKERS:
+                self._idle_workers.append(worker)
+                worker = None
+        if worker is not None:
+            worker.close()
+        return odict
+
+    def close(self):
+        with self._lock:
+            workers, self._idle_workers = self._idle_workers, []
+        for worker in workers:
+            worker.close()
 
-    _lock.release()
-    return odict
+
+_pool = _WorkerPool()
+
+
+def query_subproc(**idict):
+
+    '''
+    Run the query in a persistent sub-process of the worker pool, which
+    saves the interpreter startup and the imports of pynodegl and of the
+    unchanged scripts from one query to the next.
+    '''
+
+    return _pool.query(idict)
 
 
 def query_inplace(**idict):
@@ -214,27 +257,88 @@ def query_inplace(**idict):
     return odict
 
 
-# Entry point for the ngl-com tool
+def _get_changed_files(mtimes):
+    changed = []
+    for path, mtime in mtimes.items():
+        try:
+            if os.stat(path).st_mtime != mtime:
+                changed.append(path)
+        except OSError:
+            changed.append(path)
+    return changed
+
+
+def _get_module_path(module):
+    path = getattr(module, '__file__', None)
+    if path is None:
+        return None
+    if path.endswith('.pyc'):
+        path = path[:-1]
+    return op.realpath(path)
+
+
+def _reload_modules(mtimes):
+
+    '''
+    Drop the modules used by the previous queries if any of the files they
+    depend on changed, so that the next query imports them again. Returns
+    False if a changed module can not be dropped (extension module or module
+    of the worker itself).
+    '''
+
+    changed = _get_changed_files(mtimes)
+    if not changed:
+        return True
+
+    own_dir = op.dirname(op.realpath(__file__))
+    examples_dir = op.join(own_dir, 'examples')
+    for path in changed:
+        if path.startswith(own_dir) and not path.startswith(examples_dir):
+            return False
+        if not path.endswith('.py') and path in (_get_module_path(m) for m in sys.modules.values()):
+            return False
+
+    tracked = set(mtimes)
+    for name, module in list(sys.modules.items()):
+        if module is None:
+            continue
+        if name.startswith('pynodegl_utils.') and not name.startswith('pynodegl_utils.examples'):
+            continue
+        if _get_module_path(module) in tracked:
+            del sys.modules[name]
+    mtimes.clear()
+    return True
+
+
+# Entry point for the ngl-com workers
 def run():
-    fd_r, fd_w = int(sys.argv[1]), int(sys.argv[2])
+    fd_r, fd_w = os.dup(0), os.dup(1)
+
+    # Anything printed by the scripts goes to stderr instead of the pipe
+    os.dup2(2, 1)
+
+    # Modification times of the files used by the queries since the last
+    # reload of the modules
+    mtimes = {}
 
-    # Read input
-    idata = ''
     while True:
-        rdata = os.read(fd_r, IPC_READ_BUFSIZE)
-        if not rdata:
+        try:
+            idict = _recv_msg(fd_r)
+        except EOFError:
+            break
+
+        if not _reload_modules(mtimes):
             break
-        idata += rdata
-    os.close(fd_r)
-    idict = pickle.loads(idata)
 
-    # Execute the query
-    odict = query_inplace(**idict)
+        odict = query_inplace(**idict)
+        for path in odict['filelist']:
+            if path not in mtimes:
+                try:
+                    mtimes[path] = os.stat(path).st_mtime
+                except OSError:
+                    pass
 
-    # Write output
-    odata = pickle.dumps(odict)
-    os.write(fd_w, odata)
-    os.close(fd_w)
+        _send_msg(fd_w, odict)
 
 
 if __name__ == '__main__':
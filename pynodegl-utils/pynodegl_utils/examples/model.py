@@ -1,7 +1,8 @@
 import os.path as op
 import array
+import tempfile
 import pynodegl as ngl
-from pynodegl_utils.misc import scene
+from pynodegl_utils.misc import scene, write_mesh
 
 
 def _load_model(fp):
@@ -100,6 +101,38 @@ def obj(cfg, n=0.5, model=None):
     return camera
 
 
+@scene(model=scene.File(filter='Object files (*.obj)'))
+def mesh(cfg, model=None):
+    '''Convert an object to a mesh file and display it with a Mesh node'''
+
+    if model is None:
+        model = op.join(op.dirname(__file__), 'data', 'model.obj')
+
+    with open(model) as fp:
+        vertices_data, uvs_data, normals_data = _load_model(fp)
+
+    # The mesh file is mapped by the node, nothing is parsed at load time
+    mesh_file = op.join(tempfile.gettempdir(), op.splitext(op.basename(model))[0] + '.nglmesh')
+    indices_data = array.array('I', range(len(vertices_data) // 3))
+    write_mesh(mesh_file, vertices_data, indices_data, uvs_data, normals_data)
+
+    m = ngl.Media(cfg.medias[0].filename)
+    t = ngl.Texture2D(data_src=m)
+    p = ngl.Program(fragment=cfg.get_frag('tex-tint-normals'))
+    render = ngl.Render(ngl.Mesh(mesh_file), p)
+    render.update_textures(tex0=t)
+    render = ngl.GraphicConfig(render, depth_test=True)
+
+    camera = ngl.Camera(render)
+    camera.set_eye(2.0, 2.0, 2.0)
+    camera.set_center(0.0, 0.0, 0.0)
+    camera.set_up(0.0, 1.0, 0.0)
+    camera.set_perspective(45.0, cfg.aspect_ratio_float)
+    camera.set_clipping(1.0, 10.0)
+
+    return camera
+
+
 @scene(stl=scene.File(filter='STL files (*.stl)'),
        scale=scene.Range(range=[0.01, 10], unit_base=100))
 def stl(cfg, stl=None, scale=.8):
@@ -6,8 +6,10 @@ from pynodegl_utils.misc import scene
 
 
 @scene(square_color=scene.Color(),
-       circle_color=scene.Color())
-def square2circle(cfg, square_color=(0.9, 0.1, 0.3, 1.0), circle_color=(1.0, 1.0, 1.0, 1.0)):
+       circle_color=scene.Color(),
+       gpu_interpolation=scene.Bool())
+def square2circle(cfg, square_color=(0.9, 0.1, 0.3, 1.0), circle_color=(1.0, 1.0, 1.0, 1.0),
+                  gpu_interpolation=False):
     '''Morphing of a square (composed of many vertices) into a circle'''
     cfg.duration = 5
     cfg.aspect_ratio = (1, 1)
@@ -47,7 +49,7 @@ def square2circle(cfg, square_color=(0.9, 0.1, 0.3, 1.0), circle_color=(1.0, 1.0
             ngl.AnimKeyFrameBuffer(cfg.duration/2., circle_vertices, interp),
             ngl.AnimKeyFrameBuffer(cfg.duration,    square_vertices, interp),
     ]
-    vertices = ngl.AnimatedBufferVec3(vertices_animkf)
+    vertices = ngl.AnimatedBufferVec3(vertices_animkf, gpu_interpolation=gpu_interpolation)
 
     color_animkf = [
             ngl.AnimKeyFrameVec4(0,               square_color),
@@ -59,6 +61,8 @@ def square2circle(cfg, square_color=(0.9, 0.1, 0.3, 1.0), circle_color=(1.0, 1.0
     geom = ngl.Geometry(vertices)
     geom.set_topology('triangle_fan')
     p = ngl.Program(fragment=cfg.get_frag('color'))
+    if gpu_interpolation:
+        p.set_vertex(cfg.get_vert('morphing'))
     render = ngl.Render(geom, p)
     render.update_uniforms(color=ucolor)
     return render
@@ -110,3 +114,68 @@ def urchin(cfg, npoints=25):
     render = ngl.Render(geom, p)
     render.update_uniforms(color=ngl.UniformVec4(value=(.9, .1, .3, 1)))
     return render
+
+
+@scene(nb_joints=scene.Range(range=[2, 16]),
+       color=scene.Color())
+def skinning(cfg, nb_joints=6, color=(0.9, 0.1, 0.3, 1.0)):
+    '''Ribbon bent by a chain of rotating joints, skinned in the vertex shader'''
+    cfg.duration = 4
+    cfg.aspect_ratio = (1, 1)
+
+    n = 128      # number of segments of the ribbon
+    length = 1.5
+    width = .1
+    joint_length = length / nb_joints
+
+    # Each vertex is blended between the two joints surrounding it
+    vertices = array.array('f')
+    joints = array.array('f')
+    weights = array.array('f')
+    for i in range(n + 1):
+        x = i / float(n) * length
+        pos = min(x / joint_length, nb_joints - 1)
+        j0 = int(pos)
+        j1 = min(j0 + 1, nb_joints - 1)
+        w1 = pos - j0
+        for y in (-width / 2., width / 2.):
+            vertices.extend([x - length / 2., y, 0])
+            joints.extend([j0, j1, 0, 0])
+            weights.extend([1 - w1, w1, 0, 0])
+
+    # The bind pose is the straight ribbon, with every joint at the start of its segment
+    inverse_bind_matrices = array.array('f')
+    for i in range(nb_joints):
+        inverse_bind_matrices.extend([1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0,
+                                      length / 2. - i * joint_length, 0, 0, 1])
+
+    identities = [ngl.Identity() for i in range(nb_joints)]
+    joint = None
+    for i in reversed(range(nb_joints)):
+        animkf = [
+            ngl.AnimKeyFrameFloat(0, -30),
+            ngl.AnimKeyFrameFloat(cfg.duration / 2., 30, 'sinus_in_out'),
+            ngl.AnimKeyFrameFloat(cfg.duration, -30, 'sinus_in_out'),
+        ]
+        children = [identities[i]]
+        if joint:
+            children.append(ngl.Translate(joint, vector=(joint_length, 0, 0)))
+        joint = ngl.Rotate(ngl.Group(children=children), anim=ngl.AnimatedFloat(animkf))
+    skeleton = ngl.Translate(joint, vector=(-length / 2., 0, 0))
+
+    skin = ngl.Skin(skeleton, joints=identities,
+                    inverse_bind_matrices=ngl.BufferMat4(data=inverse_bind_matrices))
+
+    geometry = ngl.Geometry(ngl.BufferVec3(data=vertices),
+                            joints=ngl.BufferVec4(data=joints),
+                            weights=ngl.BufferVec4(data=weights),
+                            topology='triangle_strip')
+
+    shader_version = '300 es' if cfg.backend == 'gles' else '330'
+    shader_header = '#version %s\n' % shader_version
+    vertex = shader_header + cfg.get_vert('skinning') % {'nb_joints': nb_joints}
+    p = ngl.Program(vertex=vertex, fragment=shader_header + cfg.get_frag('skinning'))
+    render = ngl.Render(geometry, p)
+    render.update_blocks(skin=ngl.Block(fields=[skin]))
+    render.update_uniforms(color=ngl.UniformVec4(value=color))
+    return render
@@ -0,0 +1,13 @@
+#version 100
+precision highp float;
+attribute vec3 ngl_position_kf0;
+attribute vec3 ngl_position_kf1;
+uniform float ngl_position_ratio;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+
+void main()
+{
+    vec3 position = mix(ngl_position_kf0, ngl_position_kf1, ngl_position_ratio);
+    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * vec4(position, 1.0);
+}
@@ -0,0 +1,8 @@
+precision mediump float;
+uniform vec4 color;
+out vec4 frag_color;
+
+void main()
+{
+    frag_color = color;
+}
@@ -0,0 +1,19 @@
+precision highp float;
+in vec4 ngl_position;
+in vec4 ngl_joints;
+in vec4 ngl_weights;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+
+layout(std140) uniform skin {
+    mat4 joint_matrices[%(nb_joints)d];
+};
+
+void main()
+{
+    mat4 skin_matrix = ngl_weights.x * joint_matrices[int(ngl_joints.x)]
+                     + ngl_weights.y * joint_matrices[int(ngl_joints.y)]
+                     + ngl_weights.z * joint_matrices[int(ngl_joints.z)]
+                     + ngl_weights.w * joint_matrices[int(ngl_joints.w)];
+    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * skin_matrix * ngl_position;
+}
@@ -2,6 +2,11 @@ import os
 import os.path as op
 import tempfile
 import subprocess
+import threading
+try:
+    import queue
+except ImportError:
+    import Queue as queue
 
 import pynodegl as ngl
 from PyQt5 import QtGui, QtCore
@@ -10,6 +15,43 @@ from com import query_inplace
 from misc import get_backend, get_viewport
 
 
+class _FrameWriter(threading.Thread):
+
+    '''
+    Write the frames to the encoder from a separate thread so the encoding
+    overlaps with the rendering. The bounded queue makes the rendering wait
+    for the encoder when it falls too far behind.
+    '''
+
+    QUEUE_SIZE = 8
+
+    def __init__(self, fd):
+        super(_FrameWriter, self).__init__()
+        self._fd = fd
+        self._queue = queue.Queue(self.QUEUE_SIZE)
+        self.error = None
+
+    def push(self, frame):
+        if self.error is None:
+            self._queue.put(frame)
+
+    def run(self):
+        while True:
+            frame = self._queue.get()
+            if frame is None:
+                break
+            if self.error is not None:
+                continue
+            try:
+                os.write(self._fd, frame)
+            except OSError as e:
+                self.error = e
+
+    def finish(self):
+        self._queue.put(None)
+        self.join()
+
+
 class Exporter(QtCore.QThread):
 
     progressed = QtCore.pyqtSignal(int)
@@ -73,9 +115,14 @@ class Exporter(QtCore.QThread):
         reader = subprocess.Popen(cmd, preexec_fn=close_unused_child_fd, close_fds=False)
         close_unused_parent_fd()
 
-        capture_buffer = bytearray(width * height * 4)
+        writer = _FrameWriter(fd_w)
+        writer.start()
 
-        # node.gl context
+        # node.gl context, with the frames read back asynchronously and
+        # handed to the writer thread. The frames are delivered in a ring of
+        # buffers large enough to hold the ones queued, the one being written
+        # and the one being delivered, so they are never overwritten before
+        # being written.
         ngl_viewer = ngl.Viewer()
         ngl_viewer.configure(
             platform=ngl.PLATFORM_AUTO,
@@ -86,28 +133,35 @@ class Exporter(QtCore.QThread):
             viewport=get_viewport(width, height, cfg['aspect_ratio']),
             samples=samples,
             clear_color=cfg['clear_color'],
-            capture_buffer=capture_buffer,
+            capture_callback=writer.push,
+            capture_ring=_FrameWriter.QUEUE_SIZE + 2,
         )
         ngl_viewer.set_scene_from_string(cfg['scene'])
 
         if self._time is not None:
             ngl_viewer.draw(self._time)
-            os.write(fd_w, capture_buffer)
             self.progressed.emit(100)
         else:
-            # Draw every frame
+            # Queue the draw of every frame
             nb_frame = int(duration * fps[0] / fps[1])
             for i in range(nb_frame):
-                if self._cancelled:
+                if self._cancelled or writer.error is not None:
                     break
                 time = i * fps[1] / float(fps[0])
-                ngl_viewer.draw(time)
-                os.write(fd_w, capture_buffer)
+                ngl_viewer.draw_async(time)
                 self.progressed.emit(i*100 / nb_frame)
             self.progressed.emit(100)
 
+        # Flush the frames still being read back or queued
+        ngl_viewer.wait()
+        del ngl_viewer
+        writer.finish()
+
         os.close(fd_w)
         reader.wait()
+        if writer.error is not None:
+            self.failed.emit()
+            return False
         return True
 
     def cancel(self):
@@ -4,6 +4,7 @@ import platform
 import math
 import inspect
 import json
+import struct
 import subprocess
 import pynodegl as ngl
 from pynodegl_utils import controls
@@ -179,3 +180,17 @@ def get_backend(backend):
         'gles': ngl.BACKEND_OPENGLES,
     }
     return backend_map[backend]
+
+
+def write_mesh(filename, vertices, indices, uvcoords=None, normals=None):
+    '''Write a mesh file readable by the Mesh node (see node_mesh.c for the layout)'''
+    nb_vertices = len(vertices) // 3
+    flags = (1 if uvcoords else 0) | (2 if normals else 0)
+    bounds_min = [min(vertices[i::3]) for i in range(3)]
+    bounds_max = [max(vertices[i::3]) for i in range(3)]
+    with open(filename, 'wb') as fp:
+        fp.write(struct.pack('<4s4I6f5I', b'NGLM', 1, nb_vertices, len(indices), flags,
+                             *(bounds_min + bounds_max + [0] * 5)))
+        for data, typecode in ((vertices, 'f'), (uvcoords, 'f'), (normals, 'f'), (indices, 'I')):
+            if data:
+                fp.write(struct.pack('<%d%s' % (len(data), typecode), *data))
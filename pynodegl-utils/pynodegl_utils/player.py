@@ -243,7 +243,9 @@ class Player(QtCore.QThread):
         if self._backend != cfg['backend']:
             self._backend = cfg['backend']
             self._viewer = ngl.Viewer()
-        self._viewer.set_scene_from_string(self._scene)
+        # Only the parameters that changed since the previous version of the
+        # scene are updated, if the rest of the graph is identical
+        self._viewer.update_scene_from_string(self._scene)
         self._configure_viewer()
         self._clock.configure(self._framerate, self._duration)
         self.onSceneMetadata.emit({'framerate': self._framerate, 'duration': self._duration})
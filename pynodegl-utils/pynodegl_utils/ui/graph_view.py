@@ -52,6 +52,13 @@ class _SVGGraphView(QtWidgets.QGraphicsView):
 
 class GraphView(QtWidgets.QWidget):
 
+    _COSTS = (
+        ('No cost', None),
+        ('CPU time', ngl.DOT_COST_CPU),
+        ('GPU time', ngl.DOT_COST_GPU),
+        ('GPU memory', ngl.DOT_COST_MEMORY),
+    )
+
     def __init__(self, get_scene_func, config):
         super(GraphView, self).__init__()
 
@@ -71,7 +78,14 @@ class GraphView(QtWidgets.QWidget):
         self._seekbar = Seekbar(config, stop_button=False)
         self._seekbar.setEnabled(False)
 
+        self._cost_cbbox = QtWidgets.QComboBox()
+        for cost_name, _ in self._COSTS:
+            self._cost_cbbox.addItem(cost_name)
+        self._cost_cbbox.setEnabled(False)
+
         hbox = QtWidgets.QHBoxLayout()
+        hbox.addWidget(QtWidgets.QLabel('Color by:'))
+        hbox.addWidget(self._cost_cbbox)
         hbox.addStretch()
         hbox.addWidget(self._save_btn)
 
@@ -83,6 +97,7 @@ class GraphView(QtWidgets.QWidget):
 
         self._save_btn.clicked.connect(self._save_to_file)
         self._seek_chkbox.stateChanged.connect(self._seek_check_changed)
+        self._cost_cbbox.currentIndexChanged.connect(self._cost_changed)
 
         self._seekbar.play.connect(self._play)
         self._seekbar.pause.connect(self._pause)
@@ -117,12 +132,23 @@ class GraphView(QtWidgets.QWidget):
         self._pause()
         self._update()
 
+    @QtCore.pyqtSlot(int)
+    def _cost_changed(self, index):
+        self._update()
+
     @QtCore.pyqtSlot()
     def _update(self):
         if not self._viewer:
             return
         frame_index, frame_time = self._clock.get_playback_time_info()
-        dot_scene = self._viewer.dot(frame_time)
+        cost = self._COSTS[self._cost_cbbox.currentIndex()][1]
+        if cost is None:
+            dot_scene = self._viewer.dot(frame_time)
+        else:
+            # Costs of the current frame only, the previous profile is discarded
+            self._viewer.profile_start()
+            self._viewer.draw(frame_time)
+            dot_scene = self._viewer.dot_cost(cost)
         if dot_scene:
             self._update_graph(dot_scene)
             self._seekbar.set_frame_time(frame_index, frame_time)
@@ -218,4 +244,5 @@ class GraphView(QtWidgets.QWidget):
             self._seekbar.setEnabled(True)
         else:
             self._seekbar.setEnabled(False)
+        self._cost_cbbox.setEnabled(bool(state))
         self.enter()
@@ -1,7 +1,11 @@
-from libc.stdlib cimport calloc
-from libc.string cimport memset
+from libc.stdlib cimport calloc, free
+from libc.string cimport memcpy, memset
+from libc.stdint cimport int64_t
 from libc.stdint cimport uint8_t
+from libc.stdint cimport uint64_t
 from libc.stdint cimport uintptr_t
+from cpython.buffer cimport PyObject_GetBuffer, PyBuffer_Release, PyBUF_SIMPLE, PyBUF_WRITABLE
+from cpython.ref cimport Py_INCREF, Py_DECREF
 
 cdef extern from "nodegl.h":
     cdef int NGL_LOG_VERBOSE
@@ -10,6 +14,8 @@ cdef extern from "nodegl.h":
     cdef int NGL_LOG_WARNING
     cdef int NGL_LOG_ERROR
 
+    cdef int NGL_ERROR_INVALID_ARG
+
     void ngl_log_set_min_level(int level)
 
     cdef struct ngl_node
@@ -21,11 +27,23 @@ cdef extern from "nodegl.h":
     int ngl_node_param_add(ngl_node *node, const char *key,
                            int nb_elems, void *elems)
     int ngl_node_param_set(ngl_node *node, const char *key, ...)
+    int ngl_node_buffer_wrap_data(ngl_node *node, int size, void *data)
+    int ngl_node_buffer_map(ngl_node *node, int offset, int size, void **datap)
+    int ngl_node_buffer_unmap(ngl_node *node)
+    int ngl_node_buffer_update(ngl_node *node, int offset, int count, const void *data)
+    ctypedef void (*ngl_buffer_read_callback_type)(void *user_arg, int ret, const void *data, int size)
+    int ngl_node_buffer_read_async(ngl_node *node, int offset, int size,
+                                   ngl_buffer_read_callback_type callback, void *user_arg)
     char *ngl_node_dot(const ngl_node *node)
     char *ngl_node_serialize(const ngl_node *node)
+    int ngl_node_serialize_to_file(const ngl_node *node, const char *filename)
     ngl_node *ngl_node_deserialize(const char *s)
+    ngl_node *ngl_node_deserialize_file(const char *filename)
+    void *ngl_node_serialize_binary(const ngl_node *node, size_t *sizep)
+    ngl_node *ngl_node_deserialize_binary(const void *data, size_t size)
 
     int ngl_anim_evaluate(ngl_node *anim, void *dst, double t)
+    int ngl_anim_evaluate_batch(ngl_node *anim, void *dst, const double *times, int nb_times)
 
     cdef int NGL_PLATFORM_AUTO
     cdef int NGL_PLATFORM_XLIB
@@ -38,7 +56,26 @@ cdef extern from "nodegl.h":
     cdef int NGL_BACKEND_OPENGL
     cdef int NGL_BACKEND_OPENGLES
 
+    cdef int NGL_CAPTURE_FORMAT_RGBA
+    cdef int NGL_CAPTURE_FORMAT_NV12
+    cdef int NGL_CAPTURE_FORMAT_I420
+    cdef int NGL_CAPTURE_FORMAT_P010
+
+    cdef int NGL_DOT_COST_CPU
+    cdef int NGL_DOT_COST_GPU
+    cdef int NGL_DOT_COST_MEMORY
+
+    cdef int NGL_THREAD_PRIORITY_DEFAULT
+    cdef int NGL_THREAD_PRIORITY_DISPLAY
+    cdef int NGL_THREAD_PRIORITY_REALTIME
+
     cdef struct ngl_ctx
+    cdef struct ngl_share_group
+
+    cdef struct ngl_output:
+        int width
+        int height
+        uint8_t *capture_buffer
 
     cdef struct ngl_config:
         int  platform
@@ -46,6 +83,7 @@ cdef extern from "nodegl.h":
         uintptr_t display
         uintptr_t window
         uintptr_t handle
+        int  device
         int  swap_interval
         int  offscreen
         int  width
@@ -55,12 +93,119 @@ cdef extern from "nodegl.h":
         int  set_surface_pts
         float clear_color[4]
         uint8_t *capture_buffer
+        void (*capture_callback)(void *user_arg, const uint8_t *data)
+        void *capture_user_arg
+        int  capture_format
+        int  capture_width
+        int  capture_height
+        int  texture_pool_size
+        int  color_load_op
+        int  depth_stencil_load_op
+        int  depth_stencil_store_op
+        const char *program_cache_dir
+        ngl_share_group *share_group
+        int  async_programs
+        int  target_frame_time
+        int  release_delay
+        int  release_memory_limit
+        int  decoder_pool_size
+        int  gpu_memory_budget
+        int  prefetch_upload_budget
+        int  nb_update_threads
+        int  pipelined_updates
+        int  upload_thread
+        int  thread_priority
+        uint64_t thread_affinity
+        int  skip_idle_frames
+        int  damage_tracking
+        const char *frame_cache_dir
+        int  frame_cache_size
+        int  pack_uniforms
+        int  specialize_uniforms
+        int  bindless_textures
+        int  texture_atlas
+        int  optimize_graph
+        int  animation_bake_rate[2]
+        int  debug
+        const ngl_output *outputs
+        int  nb_outputs
+
+    cdef int NGL_STATS_MEMORY_BUFFERS
+    cdef int NGL_STATS_MEMORY_TEXTURES
+    cdef int NGL_STATS_MEMORY_RENDERBUFFERS
+    cdef int NGL_STATS_MEMORY_TEXTURE_POOL
+    cdef int NGL_STATS_MEMORY_NB
+
+    cdef int NGL_STATS_CPU_MEMORY_NODES
+    cdef int NGL_STATS_CPU_MEMORY_BUFFERS
+    cdef int NGL_STATS_CPU_MEMORY_DRAWING
+    cdef int NGL_STATS_CPU_MEMORY_NB
+
+    cdef int NGL_STATS_RTT_FORMAT_R8G8B8A8_UNORM
+    cdef int NGL_STATS_RTT_FORMAT_A2B10G10R10_UNORM
+    cdef int NGL_STATS_RTT_FORMAT_B10G11R11_UFLOAT
+    cdef int NGL_STATS_RTT_FORMAT_R16G16B16A16_SFLOAT
+    cdef int NGL_STATS_RTT_FORMAT_NB
+
+    cdef struct ngl_stats:
+        int64_t cpu_time
+        int64_t gpu_time
+        int nb_draws
+        int nb_dispatches
+        int nb_texture_binds
+        int64_t uploaded_bytes
+        int64_t memory[4]
+        int64_t visit_time
+        int64_t prefetch_time
+        int64_t update_time
+        int64_t draw_time
+        int64_t capture_time
+        int64_t swap_time
+        int64_t display_period
+        int nb_late_frames
+        int nb_dropped_frames
+        int frame_reused
+        int frame_cached
+        int redraw_region[4]
+        int64_t cpu_memory[3]
+        int64_t cpu_memory_peak[3]
+        int nb_rtt_formats[4]
+        int nb_rtt_dropped_depths
+        int64_t rtt_saved_memory
+
+    cdef struct ngl_analysis:
+        double t
+        int nb_active_nodes
+        int nb_draws
+        int nb_dispatches
+        int64_t memory
+        int nb_unknown_sizes
+        int nb_prefetches
+        int64_t prefetch_memory
+
+    ngl_share_group *ngl_share_group_create()
+    void ngl_share_group_freep(ngl_share_group **sp)
 
     ngl_ctx *ngl_create()
     int ngl_configure(ngl_ctx *s, ngl_config *config)
     int ngl_set_scene(ngl_ctx *s, ngl_node *scene)
+    int ngl_update_scene(ngl_ctx *s, ngl_node *scene)
     int ngl_draw(ngl_ctx *s, double t) nogil
+    int ngl_draw_async(ngl_ctx *s, double t) nogil
+    int ngl_draw_batch(ngl_ctx *s, const double *times, int nb_times,
+                       uint8_t *atlas, int nb_columns) nogil
+    int ngl_wait(ngl_ctx *s) nogil
+    int ngl_warmup(ngl_ctx *s, double t_start, double duration,
+                   void (*progress_cb)(void *user_arg, double progress), void *user_arg) nogil
     char *ngl_dot(ngl_ctx *s, double t) nogil
+    char *ngl_dot_cost(ngl_ctx *s, int metric) nogil
+    int ngl_analyze(ngl_ctx *s, const double *times, int nb_times, ngl_analysis *analysis) nogil
+    int ngl_prepare_scene(ngl_ctx *s, ngl_node *scene)
+    int ngl_get_stats(ngl_ctx *s, ngl_stats *stats)
+    int ngl_predict_display_delay(ngl_ctx *s, int64_t *delayp)
+    int ngl_get_next_change_time(ngl_ctx *s, double *tp)
+    int ngl_profile_start(ngl_ctx *s)
+    int ngl_profile_stop(ngl_ctx *s, char **tracep)
     void ngl_freep(ngl_ctx **ss)
 
     int ngl_easing_evaluate(const char *name, double *args, int nb_args,
@@ -79,6 +224,19 @@ BACKEND_AUTO      = NGL_BACKEND_AUTO
 BACKEND_OPENGL    = NGL_BACKEND_OPENGL
 BACKEND_OPENGLES  = NGL_BACKEND_OPENGLES
 
+CAPTURE_FORMAT_RGBA = NGL_CAPTURE_FORMAT_RGBA
+CAPTURE_FORMAT_NV12 = NGL_CAPTURE_FORMAT_NV12
+CAPTURE_FORMAT_I420 = NGL_CAPTURE_FORMAT_I420
+CAPTURE_FORMAT_P010 = NGL_CAPTURE_FORMAT_P010
+
+DOT_COST_CPU    = NGL_DOT_COST_CPU
+DOT_COST_GPU    = NGL_DOT_COST_GPU
+DOT_COST_MEMORY = NGL_DOT_COST_MEMORY
+
+THREAD_PRIORITY_DEFAULT  = NGL_THREAD_PRIORITY_DEFAULT
+THREAD_PRIORITY_DISPLAY  = NGL_THREAD_PRIORITY_DISPLAY
+THREAD_PRIORITY_REALTIME = NGL_THREAD_PRIORITY_REALTIME
+
 LOG_VERBOSE = NGL_LOG_VERBOSE
 LOG_DEBUG   = NGL_LOG_DEBUG
 LOG_INFO    = NGL_LOG_INFO
@@ -92,6 +250,12 @@ cdef _ret_pystr(char *s):
         free(s)
     return pystr
 
+# The callable is referenced by the pending read and released on delivery
+cdef void _buffer_read_callback(void *user_arg, int ret, const void *data, int size) with gil:
+    callback = <object>user_arg
+    Py_DECREF(callback)
+    callback(ret, (<const char *>data)[:size] if data != NULL else None)
+
 include "nodes_def.pyx"
 
 def log_set_min_level(int level):
@@ -139,8 +303,69 @@ def easing_solve(name, v, args=None, offsets=None):
     return _eval_solve(name, v, args, offsets, False)
 
 
+cdef int _get_capture_size(int capture_format, int width, int height):
+    if capture_format == NGL_CAPTURE_FORMAT_NV12 or capture_format == NGL_CAPTURE_FORMAT_I420:
+        return width * height * 3 // 2
+    if capture_format == NGL_CAPTURE_FORMAT_P010:
+        return width * height * 3
+    return width * height * 4
+
+
+# Memory of any writable contiguous object implementing the buffer protocol
+# (bytearray, NumPy array, ...), pinned for as long as the context writes
+# the frames into it
+cdef class _PinnedBuffer:
+    cdef Py_buffer view
+    cdef int pinned
+
+    def __cinit__(self, data):
+        PyObject_GetBuffer(data, &self.view, PyBUF_SIMPLE | PyBUF_WRITABLE)
+        self.pinned = 1
+
+    def __dealloc__(self):
+        if self.pinned:
+            PyBuffer_Release(&self.view)
+
+
+# With a capture ring, the frames are copied into the next buffer of the ring
+# and delivered as a memoryview of it, valid until the ring wraps around
+cdef void _capture_callback(void *user_arg, const uint8_t *data) with gil:
+    cdef uint8_t *slot_data
+    viewer = <Viewer>user_arg
+    if not viewer._capture_ring:
+        viewer._capture_func(data[:viewer._capture_size])
+        return
+    slot = viewer._capture_ring[viewer._capture_ring_index]
+    viewer._capture_ring_index = (viewer._capture_ring_index + 1) % len(viewer._capture_ring)
+    slot_data = slot
+    memcpy(slot_data, data, viewer._capture_size)
+    viewer._capture_func(memoryview(slot))
+
+
+cdef void _warmup_callback(void *user_arg, double progress) with gil:
+    (<object>user_arg)(progress)
+
+
+cdef class ShareGroup:
+    cdef ngl_share_group *share_group
+
+    def __cinit__(self):
+        self.share_group = ngl_share_group_create()
+        if self.share_group is NULL:
+            raise MemoryError()
+
+    def __dealloc__(self):
+        ngl_share_group_freep(&self.share_group)
+
+
 cdef class Viewer:
     cdef ngl_ctx *ctx
+    cdef object _capture_func
+    cdef int _capture_size
+    cdef object _capture_ring
+    cdef int _capture_ring_index
+    cdef object _capture_view
+    cdef object _outputs
 
     def __cinit__(self):
         self.ctx = ngl_create()
@@ -155,6 +380,7 @@ cdef class Viewer:
         config.display = kwargs.get('display', 0)
         config.window = kwargs.get('window', 0)
         config.handle = kwargs.get('handle', 0)
+        config.device = kwargs.get('device', 0)
         config.swap_interval = kwargs.get('swap_interval', -1)
         config.offscreen = kwargs.get('offscreen', 0)
         config.width = kwargs.get('width', 0)
@@ -167,23 +393,178 @@ cdef class Viewer:
         clear_color = kwargs.get('clear_color', (0.0, 0.0, 0.0, 1.0))
         for i in range(4):
             config.clear_color[i] = clear_color[i]
+        # The callback receives a copy of each frame, from the rendering
+        # thread, while the next frames are being drawn; as bytes, or as a
+        # memoryview of the next of the capture_ring preallocated buffers
+        capture_func = kwargs.get('capture_callback')
+        if capture_func is not None:
+            config.capture_callback = _capture_callback
+            config.capture_user_arg = <void *>self
+        capture_ring = kwargs.get('capture_ring', 0)
+        config.capture_format = kwargs.get('capture_format', CAPTURE_FORMAT_RGBA)
+        capture_size = kwargs.get('capture_size', (0, 0))
+        config.capture_width = capture_size[0]
+        config.capture_height = capture_size[1]
+        cdef int frame_size = _get_capture_size(config.capture_format,
+                                                config.capture_width or config.width,
+                                                config.capture_height or config.height)
+        # The frames are written in place into the capture buffer, which can
+        # be a NumPy array
+        cdef _PinnedBuffer capture_view = None
         capture_buffer = kwargs.get('capture_buffer')
         if capture_buffer is not None:
-            config.capture_buffer = capture_buffer
-        return ngl_configure(self.ctx, &config)
+            capture_view = _PinnedBuffer(capture_buffer)
+            if capture_view.view.len < frame_size:
+                return NGL_ERROR_INVALID_ARG
+            config.capture_buffer = <uint8_t *>capture_view.view.buf
+        config.texture_pool_size = kwargs.get('texture_pool_size', 0)
+        config.color_load_op = kwargs.get('color_load_op', 0)
+        config.depth_stencil_load_op = kwargs.get('depth_stencil_load_op', 0)
+        config.depth_stencil_store_op = kwargs.get('depth_stencil_store_op', 0)
+        program_cache_dir = kwargs.get('program_cache_dir')
+        if program_cache_dir is not None:
+            program_cache_dir = program_cache_dir.encode()
+            config.program_cache_dir = program_cache_dir
+        cdef ShareGroup share_group = kwargs.get('share_group')
+        if share_group is not None:
+            config.share_group = share_group.share_group
+        config.async_programs = kwargs.get('async_programs', 0)
+        config.target_frame_time = kwargs.get('target_frame_time', 0)
+        config.release_delay = kwargs.get('release_delay', 0)
+        config.release_memory_limit = kwargs.get('release_memory_limit', 0)
+        config.decoder_pool_size = kwargs.get('decoder_pool_size', 0)
+        config.gpu_memory_budget = kwargs.get('gpu_memory_budget', 0)
+        config.prefetch_upload_budget = kwargs.get('prefetch_upload_budget', 0)
+        config.nb_update_threads = kwargs.get('nb_update_threads', 0)
+        config.pipelined_updates = kwargs.get('pipelined_updates', 0)
+        config.upload_thread = kwargs.get('upload_thread', 0)
+        config.thread_priority = kwargs.get('thread_priority', THREAD_PRIORITY_DEFAULT)
+        config.thread_affinity = kwargs.get('thread_affinity', 0)
+        config.skip_idle_frames = kwargs.get('skip_idle_frames', 0)
+        config.damage_tracking = kwargs.get('damage_tracking', 0)
+        frame_cache_dir = kwargs.get('frame_cache_dir')
+        if frame_cache_dir is not None:
+            frame_cache_dir = frame_cache_dir.encode()
+            config.frame_cache_dir = frame_cache_dir
+        config.frame_cache_size = kwargs.get('frame_cache_size', 0)
+        config.pack_uniforms = kwargs.get('pack_uniforms', 0)
+        config.specialize_uniforms = kwargs.get('specialize_uniforms', 0)
+        config.bindless_textures = kwargs.get('bindless_textures', 0)
+        config.texture_atlas = kwargs.get('texture_atlas', 0)
+        config.optimize_graph = kwargs.get('optimize_graph', 0)
+        animation_bake_rate = kwargs.get('animation_bake_rate', (0, 0))
+        for i in range(2):
+            config.animation_bake_rate[i] = animation_bake_rate[i]
+        config.debug = kwargs.get('debug', 0)
+        # Additional outputs, as a list of (width, height, capture_buffer)
+        outputs = kwargs.get('outputs', [])
+        output_views = [_PinnedBuffer(output_buffer) for width, height, output_buffer in outputs]
+        cdef _PinnedBuffer output_view
+        for i, (width, height, output_buffer) in enumerate(outputs):
+            output_view = output_views[i]
+            if output_view.view.len < width * height * 4:
+                return NGL_ERROR_INVALID_ARG
+        cdef ngl_output *c_outputs = NULL
+        if outputs:
+            c_outputs = <ngl_output *>calloc(len(outputs), sizeof(ngl_output))
+            if c_outputs is NULL:
+                raise MemoryError()
+            for i, (width, height, output_buffer) in enumerate(outputs):
+                output_view = output_views[i]
+                c_outputs[i].width = width
+                c_outputs[i].height = height
+                c_outputs[i].capture_buffer = <uint8_t *>output_view.view.buf
+        config.outputs = c_outputs
+        config.nb_outputs = len(outputs)
+        # The frames of the previous configuration still pending are
+        # delivered to the previous callback during the reconfiguration
+        ret = ngl_configure(self.ctx, &config)
+        free(c_outputs)
+        # The capture buffers must outlive the configuration
+        self._capture_view = capture_view
+        self._outputs = output_views
+        self._capture_func = capture_func
+        self._capture_size = frame_size
+        self._capture_ring = [bytearray(frame_size) for i in range(capture_ring)]
+        self._capture_ring_index = 0
+        return ret
 
     def set_scene(self, _Node scene):
         return ngl_set_scene(self.ctx, NULL if scene is None else scene.ctx)
 
+    def prepare_scene(self, _Node scene):
+        return ngl_prepare_scene(self.ctx, NULL if scene is None else scene.ctx)
+
     def set_scene_from_string(self, s):
         cdef ngl_node *scene = ngl_node_deserialize(s);
         ret = ngl_set_scene(self.ctx, scene)
         ngl_node_unrefp(&scene)
         return ret
 
+    def update_scene(self, _Node scene):
+        return ngl_update_scene(self.ctx, NULL if scene is None else scene.ctx)
+
+    def update_scene_from_string(self, s):
+        cdef ngl_node *scene = ngl_node_deserialize(s);
+        ret = ngl_update_scene(self.ctx, scene)
+        ngl_node_unrefp(&scene)
+        return ret
+
+    def set_scene_from_binary(self, bytes data):
+        cdef ngl_node *scene = ngl_node_deserialize_binary(<const char *>data, len(data))
+        ret = ngl_set_scene(self.ctx, scene)
+        ngl_node_unrefp(&scene)
+        return ret
+
+    def set_scene_from_file(self, str filename):
+        filename_b = filename.encode()
+        cdef ngl_node *scene = ngl_node_deserialize_file(filename_b)
+        ret = ngl_set_scene(self.ctx, scene)
+        ngl_node_unrefp(&scene)
+        return ret
+
     def draw(self, double t):
+        cdef int ret
+        with nogil:
+            ret = ngl_draw(self.ctx, t)
+        return ret
+
+    def draw_async(self, double t):
+        cdef int ret
         with nogil:
-            ngl_draw(self.ctx, t)
+            ret = ngl_draw_async(self.ctx, t)
+        return ret
+
+    def draw_batch(self, times, bytearray atlas, int nb_columns):
+        cdef int ret
+        cdef int nb_times = len(times)
+        cdef uint8_t *c_atlas = atlas
+        cdef double *c_times = <double *>calloc(max(nb_times, 1), sizeof(double))
+        if c_times is NULL:
+            raise MemoryError()
+        for i, t in enumerate(times):
+            c_times[i] = t
+        with nogil:
+            ret = ngl_draw_batch(self.ctx, c_times, nb_times, c_atlas, nb_columns)
+        free(c_times)
+        return ret
+
+    def wait(self):
+        cdef int ret
+        with nogil:
+            ret = ngl_wait(self.ctx)
+        return ret
+
+    def warmup(self, double t_start, double duration, progress_callback=None):
+        cdef int ret
+        cdef void *user_arg = <void *>progress_callback
+        if progress_callback is None:
+            with nogil:
+                ret = ngl_warmup(self.ctx, t_start, duration, NULL, NULL)
+        else:
+            with nogil:
+                ret = ngl_warmup(self.ctx, t_start, duration, _warmup_callback, user_arg)
+        return ret
 
     def dot(self, double t):
         cdef char *s;
@@ -191,5 +572,108 @@ cdef class Viewer:
             s = ngl_dot(self.ctx, t)
         return _ret_pystr(s) if s else None
 
+    def dot_cost(self, int metric=DOT_COST_CPU):
+        cdef char *s;
+        with nogil:
+            s = ngl_dot_cost(self.ctx, metric)
+        return _ret_pystr(s) if s else None
+
+    def analyze(self, times):
+        cdef int ret
+        cdef int nb_times = len(times)
+        cdef double *c_times = <double *>calloc(max(nb_times, 1), sizeof(double))
+        cdef ngl_analysis *c_analysis = <ngl_analysis *>calloc(max(nb_times, 1), sizeof(ngl_analysis))
+        if c_times is NULL or c_analysis is NULL:
+            free(c_times)
+            free(c_analysis)
+            raise MemoryError()
+        for i, t in enumerate(times):
+            c_times[i] = t
+        with nogil:
+            ret = ngl_analyze(self.ctx, c_times, nb_times, c_analysis)
+        analysis = None
+        if ret >= 0:
+            analysis = [dict(
+                t=c_analysis[i].t,
+                nb_active_nodes=c_analysis[i].nb_active_nodes,
+                nb_draws=c_analysis[i].nb_draws,
+                nb_dispatches=c_analysis[i].nb_dispatches,
+                memory=c_analysis[i].memory,
+                nb_unknown_sizes=c_analysis[i].nb_unknown_sizes,
+                nb_prefetches=c_analysis[i].nb_prefetches,
+                prefetch_memory=c_analysis[i].prefetch_memory,
+            ) for i in range(nb_times)]
+        free(c_times)
+        free(c_analysis)
+        return analysis
+
+    def get_stats(self):
+        cdef ngl_stats stats
+        ret = ngl_get_stats(self.ctx, &stats)
+        if ret < 0:
+            return None
+        return dict(
+            cpu_time=stats.cpu_time,
+            gpu_time=stats.gpu_time,
+            nb_draws=stats.nb_draws,
+            nb_dispatches=stats.nb_dispatches,
+            nb_texture_binds=stats.nb_texture_binds,
+            uploaded_bytes=stats.uploaded_bytes,
+            memory_buffers=stats.memory[NGL_STATS_MEMORY_BUFFERS],
+            memory_textures=stats.memory[NGL_STATS_MEMORY_TEXTURES],
+            memory_renderbuffers=stats.memory[NGL_STATS_MEMORY_RENDERBUFFERS],
+            memory_texture_pool=stats.memory[NGL_STATS_MEMORY_TEXTURE_POOL],
+            visit_time=stats.visit_time,
+            prefetch_time=stats.prefetch_time,
+            update_time=stats.update_time,
+            draw_time=stats.draw_time,
+            capture_time=stats.capture_time,
+            swap_time=stats.swap_time,
+            display_period=stats.display_period,
+            nb_late_frames=stats.nb_late_frames,
+            nb_dropped_frames=stats.nb_dropped_frames,
+            frame_reused=stats.frame_reused,
+            frame_cached=stats.frame_cached,
+            redraw_region=tuple(stats.redraw_region[i] for i in range(4)),
+            cpu_memory_nodes=stats.cpu_memory[NGL_STATS_CPU_MEMORY_NODES],
+            cpu_memory_buffers=stats.cpu_memory[NGL_STATS_CPU_MEMORY_BUFFERS],
+            cpu_memory_drawing=stats.cpu_memory[NGL_STATS_CPU_MEMORY_DRAWING],
+            cpu_memory_peak_nodes=stats.cpu_memory_peak[NGL_STATS_CPU_MEMORY_NODES],
+            cpu_memory_peak_buffers=stats.cpu_memory_peak[NGL_STATS_CPU_MEMORY_BUFFERS],
+            cpu_memory_peak_drawing=stats.cpu_memory_peak[NGL_STATS_CPU_MEMORY_DRAWING],
+            nb_rtt_formats=dict(
+                r8g8b8a8_unorm=stats.nb_rtt_formats[NGL_STATS_RTT_FORMAT_R8G8B8A8_UNORM],
+                a2b10g10r10_unorm=stats.nb_rtt_formats[NGL_STATS_RTT_FORMAT_A2B10G10R10_UNORM],
+                b10g11r11_ufloat=stats.nb_rtt_formats[NGL_STATS_RTT_FORMAT_B10G11R11_UFLOAT],
+                r16g16b16a16_sfloat=stats.nb_rtt_formats[NGL_STATS_RTT_FORMAT_R16G16B16A16_SFLOAT],
+            ),
+            nb_rtt_dropped_depths=stats.nb_rtt_dropped_depths,
+            rtt_saved_memory=stats.rtt_saved_memory,
+        )
+
+    def predict_display_delay(self):
+        cdef int64_t delay = 0
+        ret = ngl_predict_display_delay(self.ctx, &delay)
+        if ret < 0:
+            return None
+        return delay
+
+    def get_next_change_time(self):
+        cdef double t = 0
+        ret = ngl_get_next_change_time(self.ctx, &t)
+        if ret < 0:
+            return None
+        return t
+
+    def profile_start(self):
+        return ngl_profile_start(self.ctx)
+
+    def profile_stop(self):
+        cdef char *s = NULL
+        ret = ngl_profile_stop(self.ctx, &s)
+        if ret < 0:
+            return None
+        return _ret_pystr(s)
+
     def __dealloc__(self):
         ngl_freep(&self.ctx)
@@ -70,7 +70,7 @@ class CommandUtils:
 
         content = 'from libc.stdlib cimport free\n'
         content += 'from libc.stdint cimport uintptr_t\n'
-        content += 'from cpython cimport array\n'
+        content += 'from cpython.buffer cimport PyObject_GetBuffer, PyBuffer_Release, PyBUF_SIMPLE\n'
 
         # Map C nodes identifiers (NGL_NODE_*)
         content += 'cdef extern from "nodegl.h":\n'
@@ -192,9 +192,31 @@ cdef class _Node:
     def serialize(self):
         return _ret_pystr(ngl_node_serialize(self.ctx))
 
+    def serialize_to_file(self, str filename):
+        filename_b = filename.encode()
+        return ngl_node_serialize_to_file(self.ctx, filename_b)
+
+    def serialize_binary(self):
+        cdef size_t size = 0
+        cdef char *data = <char *>ngl_node_serialize_binary(self.ctx, &size)
+        if data == NULL:
+            return None
+        try:
+            return data[:size]
+        finally:
+            free(data)
+
     def dot(self):
         return _ret_pystr(ngl_node_dot(self.ctx))
 
+    # Buffer* and Block nodes only
+    def read_async(self, int offset, int size, callback):
+        Py_INCREF(callback)
+        ret = ngl_node_buffer_read_async(self.ctx, offset, size, _buffer_read_callback, <void *>callback)
+        if ret < 0:
+            Py_DECREF(callback)
+        return ret
+
     def __dealloc__(self):
         ngl_node_unrefp(&self.ctx)
 
@@ -311,10 +333,89 @@ cdef class %(class_name)s(%(parent_node)s):
                     retstr = '(%s)' % ', '.join('vec[%d]' % x for x in range(n))
                 class_str += '''
     def evaluate(self, t):
-        cdef float[%d] vec
+        cdef float[%(n)d] vec
         ngl_anim_evaluate(self.ctx, vec, t)
-        return %s
-''' % (n, retstr)
+        return %(retstr)s
+
+    def evaluate_batch(self, times):
+        cdef int nb_times = len(times)
+        cdef double *times_c = <double *>calloc(nb_times, sizeof(double))
+        cdef float *vecs = <float *>calloc(nb_times * %(n)d, sizeof(float))
+        if times_c is NULL or vecs is NULL:
+            free(times_c)
+            free(vecs)
+            raise MemoryError()
+        cdef float *vec
+        cdef int i
+        for i, t in enumerate(times):
+            times_c[i] = t
+        ret = ngl_anim_evaluate_batch(self.ctx, vecs, times_c, nb_times)
+        free(times_c)
+        values = []
+        if ret == 0:
+            for i in range(nb_times):
+                vec = &vecs[i * %(n)d]
+                values.append(%(retstr)s)
+        free(vecs)
+        return values
+''' % {'n': n, 'retstr': retstr}
+
+            # Buffers can reference the memory of any contiguous object
+            # implementing the buffer protocol (such as NumPy arrays) instead
+            # of copying it. The object is kept alive and its memory pinned by
+            # the Python node for as long as it is wrapped; if the Python node
+            # goes away first, the C node takes a copy of the memory.
+            if node == '_Buffer':
+                class_str += '''
+    cdef Py_buffer _wrapped_view
+    cdef int _has_wrapped_view
+
+    cdef _release_wrapped_view(self):
+        if self._has_wrapped_view:
+            PyBuffer_Release(&self._wrapped_view)
+            self._has_wrapped_view = 0
+
+    def wrap_data(self, data):
+        cdef Py_buffer view
+        PyObject_GetBuffer(data, &view, PyBUF_SIMPLE)
+        ret = ngl_node_buffer_wrap_data(self.ctx, <int>view.len, view.buf)
+        if ret < 0:
+            PyBuffer_Release(&view)
+            return ret
+        self._release_wrapped_view()
+        self._wrapped_view = view
+        self._has_wrapped_view = 1
+        return 0
+
+    def unwrap_data(self):
+        ret = ngl_node_buffer_wrap_data(self.ctx, 0, NULL)
+        if ret < 0:
+            return ret
+        self._release_wrapped_view()
+        return 0
+
+    def map(self, int offset, int size):
+        cdef void *data = NULL
+        ret = ngl_node_buffer_map(self.ctx, offset, size, &data)
+        if ret < 0:
+            return None
+        return <unsigned char[:size]><unsigned char *>data
+
+    def unmap(self):
+        return ngl_node_buffer_unmap(self.ctx)
+
+    def update(self, int offset, int count, data):
+        cdef Py_buffer view
+        PyObject_GetBuffer(data, &view, PyBUF_SIMPLE)
+        ret = ngl_node_buffer_update(self.ctx, offset, count, view.buf)
+        PyBuffer_Release(&view)
+        return ret
+
+    def __dealloc__(self):
+        if self._has_wrapped_view:
+            ngl_node_buffer_wrap_data(self.ctx, 0, NULL)
+            self._release_wrapped_view()
+'''
 
             # Declare a set, add or update method for every optional field of
             # the node. The constructor parameters can not be changed so we
@@ -367,11 +468,13 @@ cdef class %(class_name)s(%(parent_node)s):
                         'field_type': 'const char *',
                     }
                     class_str += '''
-    def set_%(field_name)s(self, array.array %(field_name)s):
-        return ngl_node_param_set(self.ctx,
-                                  "%(field_name)s",
-                                  <int>(%(field_name)s.buffer_info()[1] * %(field_name)s.itemsize),
-                                  <void *>(%(field_name)s.data.as_voidptr))
+    def set_%(field_name)s(self, %(field_name)s):
+        cdef Py_buffer view
+        PyObject_GetBuffer(%(field_name)s, &view, PyBUF_SIMPLE)
+        try:
+            return ngl_node_param_set(self.ctx, "%(field_name)s", <int>view.len, view.buf)
+        finally:
+            PyBuffer_Release(&view)
 
 ''' % field_data
 
@@ -21,6 +21,12 @@
 # under the License.
 #
 
+import array
+import json
+import os
+import sys
+import tempfile
+
 import pynodegl as ngl
 
 
@@ -42,6 +48,82 @@ def test_reconfigure():
     del viewer
 
 
+def test_reconfigure_keep_scene():
+    viewer = ngl.Viewer()
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program())
+    captures = []
+    for width, samples in ((16, 0), (32, 0), (32, 4)):
+        capture_buffer = bytearray(width * width * 4)
+        assert viewer.configure(offscreen=1, width=width, height=width, samples=samples,
+                                capture_buffer=capture_buffer) == 0
+        if not captures:
+            viewer.set_scene(render)
+        assert viewer.draw(0) == 0
+        captures.append(capture_buffer[:4])
+    # The scene is drawn at every size without being set again
+    assert captures[0] == captures[1] == captures[2]
+    del viewer
+
+
+def test_thread_priority():
+    viewer = ngl.Viewer()
+    # Raising the priority may not be permitted, which is not an error
+    assert viewer.configure(offscreen=1, width=16, height=16, nb_update_threads=2,
+                            thread_priority=ngl.THREAD_PRIORITY_DISPLAY, thread_affinity=1) == 0
+    viewer.set_scene(ngl.Render(ngl.Quad()))
+    assert viewer.draw(0) == 0
+    assert viewer.configure(offscreen=1, width=16, height=16, nb_update_threads=2) == 0
+    assert viewer.draw(1) == 0
+    assert viewer.configure(offscreen=1, width=16, height=16, thread_priority=-1) < 0
+    del viewer
+
+
+def test_debug():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16, debug=1) == 0
+    texture = ngl.Texture2D(width=4, height=4, label='debug texture')
+    render = ngl.Render(ngl.Quad())
+    render.update_textures(tex0=texture)
+    viewer.set_scene(render)
+    assert viewer.draw(0) == 0
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    assert viewer.draw(1) == 0
+    del viewer
+
+
+def test_shared_subtree():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    # 2^32 paths lead to the render, which must not be visited once per path
+    scene = ngl.Render(ngl.Quad())
+    for i in range(32):
+        scene = ngl.Group(children=(scene, scene))
+    assert viewer.set_scene(scene) == 0
+    assert viewer.set_scene(None) == 0
+    assert viewer.set_scene(scene) == 0
+    del viewer
+
+
+def test_draw_async():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    scene = ngl.Render(ngl.Quad())
+    viewer.set_scene(scene)
+    for i in range(10):
+        assert viewer.draw_async(i / 10.) == 0
+    assert viewer.wait() == 0
+    viewer.draw(1)
+    del viewer
+
+
+def test_anim_evaluate_batch():
+    kfs = [ngl.AnimKeyFrameVec2(0, (0, 1)), ngl.AnimKeyFrameVec2(1, (1, 3), 'quadratic_in')]
+    anim = ngl.AnimatedVec2(kfs)
+    times = [-1, 0, 0.25, 0.5, 1, 2]
+    values = anim.evaluate_batch(times)
+    assert values == [anim.evaluate(t) for t in times]
+
+
 def test_ctx_ownership():
     viewer = ngl.Viewer()
     viewer2 = ngl.Viewer()
@@ -76,8 +158,1548 @@ def test_ctx_ownership_subgraph():
         del viewer2
 
 
+def test_stats():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    render = ngl.Render(ngl.Quad())
+    render.update_textures(tex0=ngl.Texture2D(width=4, height=4))
+    viewer.set_scene(ngl.Group([render, render]))
+    viewer.draw(0)
+    stats = viewer.get_stats()
+    assert stats['nb_draws'] == 2
+    assert stats['nb_dispatches'] == 0
+    assert stats['nb_texture_binds'] == 2
+    assert stats['memory_buffers'] > 0
+    assert stats['memory_textures'] >= 4 * 4 * 4
+    phases = ('visit', 'prefetch', 'update', 'draw', 'capture', 'swap')
+    assert all(stats[phase + '_time'] >= 0 for phase in phases)
+    assert sum(stats[phase + '_time'] for phase in phases) <= stats['cpu_time']
+    assert stats['display_period'] == 0
+    assert stats['nb_late_frames'] == 0
+    assert stats['nb_dropped_frames'] == 0
+    assert viewer.predict_display_delay() >= 0
+    viewer.set_scene(None)
+    stats = viewer.get_stats()
+    assert stats['memory_textures'] == 0
+    del viewer
+
+
+def test_cpu_memory_stats():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    stats = viewer.get_stats()
+    base_buffers = stats['cpu_memory_buffers']
+    buf = ngl.BufferFloat(data=array.array('f', [0] * 1024))
+    stats = viewer.get_stats()
+    assert stats['cpu_memory_buffers'] == base_buffers + 4 * 1024
+    assert stats['cpu_memory_peak_buffers'] >= stats['cpu_memory_buffers']
+    assert stats['cpu_memory_nodes'] > 0
+    del buf
+    assert viewer.get_stats()['cpu_memory_buffers'] == base_buffers
+    del viewer
+
+
+def test_profile():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    assert viewer.profile_stop() is None
+    render = ngl.Render(ngl.Quad(), label='profiled render')
+    viewer.set_scene(ngl.Group([render]))
+    assert viewer.profile_start() == 0
+    for i in range(3):
+        viewer.draw(i / 3.)
+    trace = json.loads(viewer.profile_stop())
+    events = [e for e in trace['traceEvents'] if e['ph'] == 'X']
+    assert any(e['name'] == 'profiled render' and e['cat'] == 'draw' for e in events)
+    assert any(e['cat'] == 'update' for e in events)
+    assert viewer.profile_stop() is None
+    del viewer
+
+
+def test_dot_cost():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    render = ngl.Render(ngl.Quad(), label='costly render')
+    viewer.set_scene(ngl.Group([render, ngl.Render(ngl.Quad())]))
+    assert viewer.dot_cost() is None
+    assert viewer.profile_start() == 0
+    for i in range(3):
+        viewer.draw(i / 3.)
+    for metric in (ngl.DOT_COST_CPU, ngl.DOT_COST_GPU, ngl.DOT_COST_MEMORY):
+        dot = viewer.dot_cost(metric)
+        assert dot.startswith('digraph')
+        assert 'costly render' in dot
+        assert 'draws: 2' in dot
+    assert viewer.dot_cost(ngl.DOT_COST_MEMORY + 1) is None
+    assert viewer.profile_stop() is not None
+    del viewer
+
+
+def test_async_programs():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16, async_programs=1) == 0
+    render = ngl.Render(ngl.Quad(), ngl.Program())
+    viewer.set_scene(render)
+    for i in range(100):
+        assert viewer.draw(i / 100.) == 0
+        if viewer.get_stats()['nb_draws']:
+            break
+    assert viewer.get_stats()['nb_draws'] == 1
+    # The build errors are only reported once the program is used
+    program = ngl.Program(fragment='void main() { invalid; }')
+    assert viewer.set_scene(ngl.Render(ngl.Quad(), program)) == 0
+    assert any(viewer.draw(i / 100.) < 0 for i in range(100))
+    del viewer
+
+
+def test_share_group():
+    share_group = ngl.ShareGroup()
+    captures = []
+    for i in range(2):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                share_group=share_group) == 0
+        # The group outlives the user reference while a context uses it
+        if i == 1:
+            del share_group
+        render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program())
+        viewer.set_scene(render)
+        assert viewer.draw(0) == 0
+        captures.append(bytes(capture_buffer))
+        del viewer
+    assert captures[0] == captures[1]
+
+
+def test_gl_caps_cache():
+    cache_dir = tempfile.mkdtemp()
+    captures = []
+    for i in range(2):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                program_cache_dir=cache_dir) == 0
+        viewer.set_scene(ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program()))
+        assert viewer.draw(0) == 0
+        captures.append(bytes(capture_buffer))
+        del viewer
+    # The second context is created from the cached capabilities
+    assert any(name.startswith('caps-') for name in os.listdir(cache_dir))
+    assert captures[0] == captures[1]
+
+
+def test_prepare_scene():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    program = ngl.Program()
+    scene0 = ngl.Render(ngl.Quad(), program)
+    scene1 = ngl.Render(ngl.Circle(), program)
+    assert viewer.set_scene(scene0) == 0
+    viewer.draw(0)
+    assert viewer.prepare_scene(scene1) == 0
+    viewer.draw(1)
+    assert viewer.set_scene(scene1) == 0
+    viewer.draw(2)
+    assert viewer.prepare_scene(ngl.Render(ngl.Quad())) == 0
+    assert viewer.prepare_scene(None) == 0
+    del viewer
+
+
+def test_serialize_binary():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    vertices = ngl.BufferVec3(data=array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0]))
+    geometry = ngl.Geometry(vertices, topology='triangle_strip')
+    render = ngl.Render(geometry, label='binary')
+    color = ngl.AnimatedVec4([ngl.AnimKeyFrameVec4(0, (1, 0, 0, 1)),
+                              ngl.AnimKeyFrameVec4(1, (0, 1, 0, 1), 'quadratic_in')])
+    render.update_uniforms(color=color, factor=ngl.UniformFloat(0.5))
+    scene = ngl.Group(children=[render, ngl.Rotate(render, 45)])
+    data = scene.serialize_binary()
+    assert data[:4] == b'NGLB'
+    assert viewer.set_scene_from_binary(data) == 0
+    viewer.draw(0)
+    del viewer
+
+
+def test_deserialize_file():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    vertices = ngl.BufferVec3(data=array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0] * 50000))
+    render = ngl.Render(ngl.Geometry(vertices), label='from file')
+    for data in (render.serialize(), render.serialize_binary()):
+        with tempfile.NamedTemporaryFile() as fp:
+            fp.write(data if isinstance(data, bytes) else data.encode())
+            fp.flush()
+            assert viewer.set_scene_from_file(fp.name) == 0
+            viewer.draw(0)
+    del viewer
+
+
+def test_serialize_to_file():
+    vertices = ngl.BufferVec3(data=array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0] * 50000))
+    render = ngl.Render(ngl.Geometry(vertices), label='to file')
+    scene = ngl.Group(children=[render, ngl.Rotate(render, 45)])
+    with tempfile.NamedTemporaryFile(suffix='.ngl') as fp:
+        assert scene.serialize_to_file(fp.name) == 0
+        assert fp.read().decode() == scene.serialize()
+    assert scene.serialize_to_file('/nonexistent/scene.ngl') < 0
+
+
+def test_serialize_binary_dedup():
+    data = array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0] * 10000)
+    renders = [ngl.Render(ngl.Geometry(ngl.BufferVec3(data=data))) for i in range(4)]
+    scene = ngl.Group(children=renders)
+    binary = scene.serialize_binary()
+    assert len(data) * data.itemsize < len(binary) < 2 * len(data) * data.itemsize
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    assert viewer.set_scene_from_binary(binary) == 0
+    viewer.draw(0)
+    del viewer
+
+
+def test_buffer_wrap_map():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    data = array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0])
+    vertices = ngl.BufferVec3()
+    assert vertices.wrap_data(data) == 0
+    render = ngl.Render(ngl.Geometry(vertices, topology='triangle_strip'))
+    viewer.set_scene(render)
+    viewer.draw(0)
+    assert vertices.wrap_data(array.array('f', [0] * 3)) < 0
+    mapped = vertices.map(4 * 3, 4 * 3)
+    mapped[:] = array.array('f', [1, 1, 0]).tobytes()
+    assert vertices.unmap() == 0
+    assert data[3:6] == array.array('f', [1, 1, 0])
+    viewer.draw(1)
+    assert viewer.get_stats()['uploaded_bytes'] >= 4 * 3
+    assert vertices.map(4 * 6, 4 * 6) is None
+    assert vertices.unwrap_data() == 0
+    viewer.draw(2)
+    del viewer
+
+
+def test_buffer_update():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    vertices = ngl.BufferVec3(data=array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0, 0, 0, 0]))
+    assert vertices.update(0, 1, array.array('f', [0, 0, 0])) < 0
+    render = ngl.Render(ngl.Geometry(vertices, topology='triangle_strip'))
+    viewer.set_scene(render)
+    viewer.draw(0)
+    viewer.draw(1)
+    base_uploaded_bytes = viewer.get_stats()['uploaded_bytes']
+    assert vertices.update(1, 1, array.array('f', [1, 1, 0])) == 0
+    viewer.draw(2)
+    assert viewer.get_stats()['uploaded_bytes'] == base_uploaded_bytes + 4 * 3
+    # The last element wraps around to the first one
+    assert vertices.update(3, 2, array.array('f', [0, 0, 0, -1, 1, 0])) == 0
+    viewer.draw(3)
+    assert viewer.get_stats()['uploaded_bytes'] == base_uploaded_bytes + 4 * 3 * 2
+    assert vertices.update(4, 1, array.array('f', [0, 0, 0])) < 0
+    assert vertices.update(0, 5, array.array('f', [0] * 15)) < 0
+    del viewer
+
+
+def test_buffer_read_async():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    data = array.array('f', [-1, -1, 0, 1, -1, 0, 0, 1, 0])
+    vertices = ngl.BufferVec3(data=data)
+    reads = []
+    callback = lambda ret, read_data: reads.append((ret, read_data))
+    assert vertices.read_async(0, 4, callback) < 0
+    render = ngl.Render(ngl.Geometry(vertices, topology='triangle_strip'))
+    viewer.set_scene(render)
+    assert vertices.read_async(4 * 3, 4 * 7, callback) < 0
+    assert vertices.read_async(4 * 3, 4 * 6, callback) == 0
+    viewer.draw(0)
+    assert viewer.wait() == 0
+    assert reads == [(0, data[3:].tobytes())]
+    del viewer
+
+
+def test_buffer_gpu_only():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    data = array.array('f', [-1, -1, 0, 1, -1, 0, -1, 1, 0, 1, 1, 0] * 256)
+    vertices = ngl.BufferVec3(data=data, gpu_only=True)
+    render = ngl.Render(ngl.Geometry(vertices, topology='triangle_strip'))
+    base_buffers = viewer.get_stats()['cpu_memory_buffers']
+    viewer.set_scene(render)
+    viewer.draw(0)
+    assert viewer.get_stats()['cpu_memory_buffers'] == base_buffers - len(data) * 4
+    assert render.serialize() is None
+    assert vertices.update(0, 1, array.array('f', [0, 0, 0])) < 0
+    viewer.set_scene(None)
+    assert data.tobytes().hex() in render.serialize()
+    assert viewer.set_scene(ngl.Render(ngl.Quad(), blocks=dict(b=ngl.Block(fields=[vertices])))) < 0
+    del viewer
+
+
+def test_buffer_block_texture():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    compute = (
+        '#version 430\n'
+        'layout(local_size_x = 4) in;\n'
+        'uniform float t;\n'
+        'layout(std430, binding = 0) buffer colors { vec4 data[]; };\n'
+        'void main() { data[gl_LocalInvocationID.x] = vec4(t, 0.0, 1.0 - t, 1.0); }\n'
+    )
+    block = ngl.Block(fields=[ngl.BufferVec4(count=4)], layout='std430')
+    time = ngl.AnimatedFloat([ngl.AnimKeyFrameFloat(0, 0), ngl.AnimKeyFrameFloat(1, 1)])
+    writer = ngl.Compute(1, 1, 1, ngl.ComputeProgram(compute))
+    writer.update_blocks(colors=block)
+    writer.update_uniforms(t=time)
+    # The texture is copied from the block buffer after each dispatch
+    texture = ngl.Texture2D(width=2, height=2, data_src=ngl.BufferVec4(block=block))
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+    render.update_textures(tex0=texture)
+    viewer.set_scene(ngl.Group(children=(writer, render)))
+    for t, color in ((0, (0, 0, 255, 255)), (1, (255, 0, 0, 255))):
+        assert viewer.draw(t) == 0
+        assert capture_buffer == bytearray(color) * 16 * 16
+    del viewer
+
+
+def test_outputs():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    output_buffer = bytearray(8 * 4 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, clear_color=(1.0, 0.0, 0.0, 1.0),
+                            capture_buffer=capture_buffer, outputs=[(8, 4, output_buffer)]) == 0
+    viewer.set_scene(ngl.Group())
+    viewer.draw(0)
+    assert capture_buffer == bytearray((255, 0, 0, 255)) * 16 * 16
+    assert output_buffer == bytearray((255, 0, 0, 255)) * 8 * 4
+    assert viewer.configure(offscreen=1, width=16, height=16, outputs=[(0, 4, output_buffer)]) < 0
+    del viewer
+
+
+def test_capture_buffer_view():
+    viewer = ngl.Viewer()
+    # Any writable buffer, such as a NumPy array, receives the frames in place
+    capture_buffer = array.array('B', bytes(16 * 16 * 4))
+    assert viewer.configure(offscreen=1, width=16, height=16, clear_color=(1.0, 0.0, 0.0, 1.0),
+                            capture_buffer=capture_buffer) == 0
+    viewer.set_scene(ngl.Group())
+    assert viewer.draw(0) == 0
+    assert capture_buffer.tobytes() == bytes((255, 0, 0, 255)) * 16 * 16
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=bytearray(16)) < 0
+
+    # The asynchronous captures are delivered in a ring of buffers
+    frames = []
+    assert viewer.configure(offscreen=1, width=16, height=16, clear_color=(1.0, 0.0, 0.0, 1.0),
+                            capture_callback=frames.append, capture_ring=2) == 0
+    viewer.set_scene(ngl.Group())
+    for i in range(3):
+        assert viewer.draw_async(i) == 0
+    assert viewer.wait() == 0
+    assert len(frames) == 3
+    assert frames[0].obj is frames[2].obj and frames[0].obj is not frames[1].obj
+    assert all(frame.tobytes() == bytes((255, 0, 0, 255)) * 16 * 16 for frame in frames)
+    del viewer
+
+
+def test_capture_format():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(8 * 4 * 3 // 2)
+    assert viewer.configure(offscreen=1, width=16, height=16, clear_color=(1.0, 0.0, 0.0, 1.0),
+                            capture_buffer=capture_buffer, capture_format=ngl.CAPTURE_FORMAT_NV12,
+                            capture_size=(8, 4)) == 0
+    viewer.set_scene(ngl.Group())
+    viewer.draw(0)
+    # BT.709 limited range red
+    assert capture_buffer == bytearray((63,)) * 8 * 4 + bytearray((102, 240)) * 4 * 2
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                            capture_format=ngl.CAPTURE_FORMAT_I420, capture_size=(6, 6)) < 0
+    del viewer
+
+
+def test_occlusion_cull():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    frag = '#version 100\nprecision mediump float;\nuniform vec4 color;\nvoid main() { gl_FragColor = color; }\n'
+
+    def quad(z, color):
+        render = ngl.Render(ngl.Quad((-1, -1, z), (2, 0, 0), (0, 2, 0)), ngl.Program(fragment=frag))
+        render.update_uniforms(color=ngl.UniformVec4(color))
+        return render
+
+    foreground = ngl.UserSwitch(quad(0.0, (0.0, 0.0, 1.0, 1.0)))
+    hidden = ngl.OcclusionCull(quad(0.5, (1.0, 0.0, 0.0, 1.0)), quad(0.5, (0.0, 1.0, 0.0, 1.0)))
+    viewer.set_scene(ngl.GraphicConfig(ngl.Group(children=(foreground, hidden)), depth_test=True))
+    for i in range(3):
+        viewer.draw(i)
+    # The foreground and the proxy are the only draws while it is covered
+    assert viewer.get_stats()['nb_draws'] == 2
+    assert capture_buffer[:4] == bytearray((0, 0, 255, 255))
+    foreground.set_enabled(False)
+    for i in range(3, 6):
+        viewer.draw(i)
+    assert capture_buffer[:4] == bytearray((255, 0, 0, 255))
+    del viewer
+
+
+def test_virtual_texture():
+    image_dir = tempfile.mkdtemp()
+    filename = os.path.join(image_dir, 'image.raw')
+    with open(filename, 'wb') as fp:
+        row = bytes((255, 0, 0, 255) * 128 + (0, 0, 255, 255) * 128)
+        fp.write(row * 128)
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    texture = ngl.VirtualTexture(filename=filename, width=256, height=128, tile_size=32, cache_size=3)
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+    render.update_textures(tex0=texture)
+    viewer.set_scene(render)
+    assert viewer.draw(0) == 0
+    assert capture_buffer[:4] == bytearray((255, 0, 0, 255))
+    # The tiles of the right half are paged in at full resolution
+    texture.set_region(0.75, 0.5, 0.01, 0.01)
+    assert viewer.draw(1) == 0
+    assert capture_buffer[:4] == bytearray((0, 0, 255, 255))
+    del viewer
+    # The tile pyramid is built next to the image
+    assert os.path.exists(filename + '.pyramid')
+    for name in os.listdir(image_dir):
+        os.remove(os.path.join(image_dir, name))
+    os.rmdir(image_dir)
+
+
+def test_media_still():
+    fd, filename = tempfile.mkstemp(suffix='.ppm')
+    with os.fdopen(fd, 'wb') as fp:
+        fp.write(b'P6 4 4 255\n' + bytes((0, 255, 0)) * 16)
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+
+    def scene():
+        texture = ngl.Texture2D(data_src=ngl.Media(filename, still=True))
+        render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+        render.update_textures(tex0=texture)
+        return render
+
+    # The image decoded for the first scene is reused by the next one
+    for i in range(2):
+        viewer.set_scene(scene())
+        assert viewer.draw(i) == 0
+        assert capture_buffer[:4] == bytearray((0, 255, 0, 255))
+    del viewer
+    os.remove(filename)
+
+
+def test_blur():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    # Red left half, blue right half
+    row = bytes((255, 0, 0, 255) * 8 + (0, 0, 255, 255) * 8)
+    source = ngl.Texture2D(data_src=ngl.BufferUBVec4(data=row * 16), width=16, height=16)
+    destination = ngl.Texture2D(width=16, height=16)
+    blur = ngl.Blur(source, destination, radius=4, levels=1)
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+    render.update_textures(tex0=destination)
+    viewer.set_scene(ngl.Group(children=(blur, render)))
+    assert viewer.draw(0) == 0
+    # The colors only bleed around the edge
+    middle = 8 * 16 * 4
+    assert capture_buffer[middle:middle + 4] == bytearray((255, 0, 0, 255))
+    edge = middle + 7 * 4
+    assert 0 < capture_buffer[edge] < 255 and 0 < capture_buffer[edge + 2] < 255
+    del viewer
+
+def test_framebuffer_fetch():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    frag = '#version 100\nprecision mediump float;\nuniform vec4 color;\nvoid main() { gl_FragColor = color; }\n'
+    scene = ngl.Render(ngl.Quad((-1, -1, 0), (1, 0, 0), (0, 2, 0)), ngl.Program(fragment=frag))
+    scene.update_uniforms(color=ngl.UniformVec4((1.0, 0.0, 0.0, 1.0)))
+    invert_frag = (
+        '#version 100\n'
+        'precision mediump float;\n'
+        'void main() { gl_FragColor = vec4(1.0 - ngl_framebuffer_fetch().rgb, 1.0); }\n'
+    )
+    invert = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program(fragment=invert_frag))
+    viewer.set_scene(ngl.Group(children=(scene, invert), sort_draws=True))
+    assert viewer.draw(0) == 0
+    # The left half is red and the right one is cleared in black before the inversion
+    left = (8 * 16 + 2) * 4
+    right = (8 * 16 + 13) * 4
+    assert capture_buffer[left:left + 4] == bytearray((0, 255, 255, 255))
+    assert capture_buffer[right:right + 4] == bytearray((255, 255, 255, 255))
+    del viewer
+
+def test_depth_sort():
+    frag = '#version 100\nprecision mediump float;\nuniform vec4 color;\nvoid main() { gl_FragColor = color; }\n'
+
+    def quad(z, color, size=1.0):
+        geometry = ngl.Quad((-size, -size, z), (2 * size, 0, 0), (0, 2 * size, 0))
+        render = ngl.Render(geometry, ngl.Program(fragment=frag))
+        render.update_uniforms(color=ngl.UniformVec4(color))
+        return render
+
+    # Submitted back to front, with the blended draw first
+    for depth_prepass in (False, True):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+        blended = ngl.GraphicConfig(quad(0.0, (1.0, 0.0, 0.0, 0.5)), blend=True,
+                                    blend_src_factor='src_alpha', blend_dst_factor='one_minus_src_alpha')
+        back = quad(0.5, (0.0, 0.0, 1.0, 1.0))
+        front = quad(-0.5, (0.0, 1.0, 0.0, 1.0), size=0.5)
+        group = ngl.Group(children=(blended, back, front), sort_draws=True,
+                          depth_sort=True, depth_prepass=depth_prepass)
+        viewer.set_scene(ngl.GraphicConfig(group, depth_test=True))
+        viewer.draw(0)
+        center = (8 * 16 + 8) * 4
+        assert capture_buffer[center:center + 3] == bytearray((0, 255, 0))
+        # The opaque background is drawn before the blended quad
+        assert capture_buffer[0] in (127, 128) and capture_buffer[2] in (127, 128)
+        del viewer
+
+
+def test_level_of_detail():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    frag = '#version 100\nprecision mediump float;\nuniform vec4 color;\nvoid main() { gl_FragColor = color; }\n'
+
+    def quad(color):
+        render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program(fragment=frag))
+        render.update_uniforms(color=ngl.UniformVec4(color))
+        return render
+
+    lod = ngl.LevelOfDetail(
+        children=(quad((1.0, 0.0, 0.0, 1.0)), quad((0.0, 1.0, 0.0, 1.0))),
+        thresholds=(0.5,),
+        bounding_box_min=(-1, -1, 0),
+        bounding_box_max=(1, 1, 0),
+    )
+    scale = ngl.Scale(lod)
+    viewer.set_scene(scale)
+    # The least detailed child is drawn until the scene has been measured
+    viewer.draw(0)
+    assert capture_buffer[:4] == bytearray((0, 255, 0, 255))
+    viewer.draw(1)
+    assert capture_buffer[:4] == bytearray((255, 0, 0, 255))
+    scale.set_factors(0.25, 0.25, 1.0)
+    viewer.draw(2)
+    viewer.draw(3)
+    center = (8 * 16 + 8) * 4
+    assert capture_buffer[center:center + 4] == bytearray((0, 255, 0, 255))
+    del viewer
+
+
+def test_draw_batch():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=4, height=2, clear_color=(0.0, 0.0, 0.0, 0.0)) == 0
+    # Each tile is only covered by the quad at the times within its range
+    frag = '#version 100\nprecision mediump float;\nvoid main() { gl_FragColor = vec4(1.0); }\n'
+    quad = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program(fragment=frag))
+    scene = ngl.TimeRangeFilter(quad, ranges=[ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(1)])
+    viewer.set_scene(scene)
+    times = (2.0, 0.0, 1.5, 0.5, 1.0)
+    atlas = bytearray(4 * 3 * 2 * 2 * 4)
+    assert viewer.draw_batch(times, atlas, 3) == 0
+    stride = 4 * 3 * 4
+    for i, t in enumerate(times):
+        x, y = i % 3 * 4, i // 3 * 2
+        pixel = atlas[y * stride + x * 4:y * stride + x * 4 + 4]
+        assert (pixel[3] == 255) == (t >= 1.0), (t, pixel)
+    assert viewer.draw_batch([], atlas, 3) < 0
+    viewer.set_scene(None)
+    del viewer
+
+
+def test_warmup():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    # Each texture is only used by its render within its time range
+    branches = []
+    for start in (0, 2, 4):
+        render = ngl.Render(ngl.Quad())
+        render.update_textures(tex0=ngl.Texture2D(width=64, height=64))
+        trf = ngl.TimeRangeFilter(render, prefetch_time=0)
+        trf.add_ranges(ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(start), ngl.TimeRangeModeNoop(start + 1))
+        branches.append(trf)
+    viewer.set_scene(ngl.Group(children=branches))
+    tex_size = 64 * 64 * 4
+    progress = []
+    assert viewer.warmup(0.5, 3.0, progress.append) == 0
+    assert progress[-1] == 1.0 and progress == sorted(progress)
+    # The textures of the range are ready before being drawn, and kept while inactive
+    assert viewer.get_stats()['memory_textures'] == 2 * tex_size
+    assert viewer.draw(0.5) == 0
+    assert viewer.get_stats()['memory_textures'] == 2 * tex_size
+    assert viewer.draw(2.5) == 0
+    assert viewer.get_stats()['memory_textures'] == 2 * tex_size
+    # and released once out of the range
+    assert viewer.draw(4.5) == 0
+    assert viewer.get_stats()['memory_textures'] == tex_size
+    assert viewer.warmup(0, -1) < 0
+    viewer.set_scene(None)
+    del viewer
+
+
+def test_analyze():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    branches = []
+    for start in (0, 3):
+        render = ngl.Render(ngl.Quad())
+        render.update_textures(tex0=ngl.Texture2D(width=64, height=64))
+        ranges = [ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(start), ngl.TimeRangeModeNoop(start + 1)]
+        branches.append(ngl.TimeRangeFilter(render, ranges=ranges, prefetch_time=0.5, max_idle_time=1))
+    viewer.set_scene(ngl.Group(children=branches))
+    tex_size = 64 * 64 * 4
+    analysis = viewer.analyze([0.5, 1.5, 2.75, 3.5, 4.5])
+    assert [a['nb_draws'] for a in analysis] == [1, 0, 0, 1, 0]
+    assert [a['memory'] for a in analysis] == [tex_size, 0, tex_size, tex_size, 0]
+    assert [a['nb_prefetches'] > 0 for a in analysis] == [True, False, True, False, False]
+    assert analysis[2]['prefetch_memory'] == tex_size
+    # Nothing is allocated by the analysis
+    assert viewer.get_stats()['memory_textures'] == 0
+    assert viewer.draw(3.5) == 0
+    assert viewer.get_stats()['memory_textures'] == tex_size
+    assert viewer.analyze([1, 0]) is None
+    viewer.set_scene(None)
+    del viewer
+
+
+def test_update_scene():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+
+    def get_scene(color, angle):
+        render = ngl.Render(ngl.Quad())
+        render.update_uniforms(color=ngl.UniformVec4(color))
+        return ngl.Rotate(render, angle)
+
+    scene = get_scene((1, 0, 0, 1), 0)
+    assert viewer.set_scene(scene) == 0
+    viewer.draw(0)
+
+    # Live changeable parameters only: the current scene is patched
+    assert viewer.update_scene(get_scene((0, 1, 0, 1), 45)) == 0
+    viewer.draw(0)
+    assert viewer.get_stats()['nb_draws'] == 1
+    assert scene.set_angle(90) == 0
+
+    # Different topology: the new scene replaces the current one
+    new_scene = ngl.Group([get_scene((0, 0, 1, 1), 0), get_scene((1, 1, 1, 1), 0)])
+    assert viewer.update_scene(new_scene) == 0
+    viewer.draw(0)
+    assert viewer.get_stats()['nb_draws'] == 2
+    del viewer
+
+
+def test_text_live_change():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    text0 = ngl.Text('00:00')
+    text1 = ngl.Text('caption', box_corner=(-1, 0, 0))
+    viewer.set_scene(ngl.Group([text0, text1]))
+    viewer.draw(0)
+    memory = viewer.get_stats()['memory_textures']
+    assert memory > 0
+
+    # The glyph atlas is shared and is never reallocated by a text change
+    for i, text in enumerate(('00:01', 'a longer\ntext', '')):
+        assert text0.set_text(text) == 0
+        assert text1.set_fg_color(1, 0, 0, 1) == 0
+        viewer.draw(i)
+        assert viewer.get_stats()['memory_textures'] == memory
+    del viewer
+
+
+def test_release_delay():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16, release_delay=60000) == 0
+    render = ngl.Render(ngl.Quad())
+    render.update_textures(tex0=ngl.Texture2D(width=4, height=4))
+    ranges = [ngl.TimeRangeModeCont(0), ngl.TimeRangeModeNoop(1)]
+    viewer.set_scene(ngl.TimeRangeFilter(render, ranges=ranges, prefetch_time=0))
+    viewer.draw(0)
+    memory = viewer.get_stats()['memory_textures']
+    assert memory > 0
+    # The inactive branch is kept until the delay expires
+    viewer.draw(2)
+    assert viewer.get_stats()['memory_textures'] == memory
+    viewer.draw(0.5)
+    viewer.draw(2)
+    assert viewer.get_stats()['memory_textures'] == memory
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    viewer.draw(3)
+    assert viewer.get_stats()['memory_textures'] == 0
+    del viewer
+
+
+def test_gpu_memory_budget():
+    for budget in (0, 1):
+        viewer = ngl.Viewer()
+        assert viewer.configure(offscreen=1, width=16, height=16, gpu_memory_budget=budget) == 0
+        render = ngl.Render(ngl.Quad())
+        render.update_textures(tex0=ngl.Texture2D(width=1024, height=1024))
+        ranges = [ngl.TimeRangeModeCont(0), ngl.TimeRangeModeNoop(1), ngl.TimeRangeModeCont(3)]
+        viewer.set_scene(ngl.TimeRangeFilter(render, ranges=ranges, prefetch_time=0))
+        viewer.draw(0)
+        memory = viewer.get_stats()['memory_textures']
+        assert memory > 1024 * 1024
+        # The idle child is only released if it exceeds the budget
+        viewer.draw(1.5)
+        viewer.draw(1.6)
+        assert viewer.get_stats()['memory_textures'] == (0 if budget else memory)
+        del viewer
+
+
+def test_prefetch_upload_budget():
+    captures = []
+    for budget in (0, 1):
+        capture_buffer = bytearray(16 * 16 * 4)
+        viewer = ngl.Viewer()
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                prefetch_upload_budget=budget) == 0
+        data = array.array('B', [0, 255, 0, 255] * 64 * 64)
+        texture = ngl.Texture2D(width=64, height=64, data_src=ngl.BufferUBVec4(data=data))
+        render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+        render.update_textures(tex0=texture)
+        ranges = [ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(1)]
+        viewer.set_scene(ngl.TimeRangeFilter(render, ranges=ranges, prefetch_time=1))
+        # The uploads left when the render starts are completed at once
+        for i in range(10):
+            assert viewer.draw(i / 8.) == 0
+        captures.append(bytes(capture_buffer))
+        del viewer
+    assert captures[0] == captures[1]
+
+def test_update_threads():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16, nb_update_threads=4) == 0
+    renders = []
+    for i in range(32):
+        kfs = [ngl.AnimKeyFrameFloat(0, 0), ngl.AnimKeyFrameFloat(1, i)]
+        render = ngl.Render(ngl.Quad())
+        render.update_uniforms(value=ngl.AnimatedFloat(kfs))
+        renders.append(render)
+    viewer.set_scene(ngl.Group(renders))
+    for i in range(10):
+        assert viewer.draw(i / 10.) == 0
+    assert viewer.get_stats()['nb_draws'] == 32
+    assert viewer.configure(offscreen=1, width=16, height=16, nb_update_threads=4, pipelined_updates=1) == 0
+    for i in range(10):
+        assert viewer.draw(i / 10.) == 0
+    assert viewer.get_stats()['nb_draws'] == 32
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    assert viewer.draw(1) == 0
+    del viewer
+
+
+def test_upload_thread():
+    fd, filename = tempfile.mkstemp(suffix='.ppm')
+    with os.fdopen(fd, 'wb') as fp:
+        fp.write(b'P6 4 4 255\n' + bytes((0, 255, 0)) * 16)
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer, upload_thread=1) == 0
+    texture = ngl.Texture2D(data_src=ngl.Media(filename))
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+    render.update_textures(tex0=texture)
+    viewer.set_scene(render)
+    # The frame uploaded by the upload thread is waited for before the draw
+    for i in range(2):
+        assert viewer.draw(i) == 0
+        assert capture_buffer[:4] == bytearray((0, 255, 0, 255))
+    del viewer
+    os.remove(filename)
+
+
+def test_decoder_pool():
+    fd, filename = tempfile.mkstemp(suffix='.ppm')
+    with os.fdopen(fd, 'wb') as fp:
+        fp.write(b'P6 4 4 255\n' + bytes((0, 0, 255)) * 16)
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer, decoder_pool_size=1) == 0
+    texture = ngl.Texture2D(data_src=ngl.Media(filename))
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+    render.update_textures(tex0=texture)
+    ranges = [ngl.TimeRangeModeCont(0), ngl.TimeRangeModeNoop(1)]
+    viewer.set_scene(ngl.TimeRangeFilter(render, ranges=ranges, prefetch_time=0))
+    # The player kept running after the release serves the frames again
+    for t in (0.5, 2, 0.5):
+        assert viewer.draw(t) == 0
+    assert capture_buffer[:4] == bytearray((0, 0, 255, 255))
+    del viewer
+    os.remove(filename)
+
+
+def test_skip_idle_frames():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16, skip_idle_frames=1) == 0
+    text = ngl.Text('static')
+    viewer.set_scene(text)
+    assert viewer.draw(0) == 0
+    assert viewer.get_stats()['frame_reused'] == 0
+    assert viewer.draw(1) == 0
+    assert viewer.get_stats()['frame_reused'] == 1
+
+    # A live change forces a redraw
+    assert text.set_text('changed') == 0
+    assert viewer.draw(1) == 0
+    assert viewer.get_stats()['frame_reused'] == 0
+
+    kfs = [ngl.AnimKeyFrameFloat(0, 0), ngl.AnimKeyFrameFloat(1, 1)]
+    render = ngl.Render(ngl.Quad())
+    render.update_uniforms(value=ngl.AnimatedFloat(kfs))
+    viewer.set_scene(render)
+    assert viewer.draw(0) == 0
+    assert viewer.draw(0.5) == 0
+    assert viewer.get_stats()['frame_reused'] == 0
+    # The animation is constant after its last key frame
+    assert viewer.draw(2) == 0
+    assert viewer.draw(3) == 0
+    assert viewer.get_stats()['frame_reused'] == 1
+    del viewer
+
+
+def test_next_change_time():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    # Nothing drawn yet
+    assert viewer.get_next_change_time() == -sys.float_info.max
+
+    # Animation holding its value between 1 and 3, drawn until 5
+    kfs = [
+        ngl.AnimKeyFrameFloat(0, 0),
+        ngl.AnimKeyFrameFloat(1, 1),
+        ngl.AnimKeyFrameFloat(3, 1),
+        ngl.AnimKeyFrameFloat(4, 0),
+    ]
+    frag = ('#version 100\nprecision mediump float;\nuniform float value;\nuniform vec4 color;\n'
+            'void main() { gl_FragColor = color * value; }\n')
+    color = ngl.UniformVec4()
+    render = ngl.Render(ngl.Quad(), ngl.Program(fragment=frag))
+    render.update_uniforms(value=ngl.AnimatedFloat(kfs), color=color)
+    ranges = [ngl.TimeRangeModeCont(0), ngl.TimeRangeModeNoop(5)]
+    viewer.set_scene(ngl.TimeRangeFilter(render, ranges=ranges))
+
+    expected = [(0.5, 0.5), (1, 3), (2, 3), (3.5, 3.5), (4, 5), (4.5, 5), (5.5, sys.float_info.max)]
+    for t, next_t in expected:
+        assert viewer.draw(t) == 0
+        assert viewer.get_next_change_time() == next_t
+
+    # A live change requires a redraw
+    assert color.set_value(1, 0, 0, 1) == 0
+    assert viewer.get_next_change_time() == -sys.float_info.max
+    assert viewer.draw(6) == 0
+    assert viewer.get_next_change_time() == sys.float_info.max
+    del viewer
+
+
+def test_damage_tracking():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=64, height=64, damage_tracking=1) == 0
+    background = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)))
+    kfs = [ngl.AnimKeyFrameVec3(0, (0, 0, 0)), ngl.AnimKeyFrameVec3(1, (0.25, 0, 0))]
+    overlay = ngl.Render(ngl.Quad((-1, -1, 0), (0.25, 0, 0), (0, 0.25, 0)))
+    viewer.set_scene(ngl.Group([background, ngl.Translate(overlay, anim=ngl.AnimatedVec3(kfs))]))
+    assert viewer.draw(0) == 0
+    assert viewer.get_stats()['redraw_region'] == (0, 0, 64, 64)
+
+    # Only the previous and current areas of the moving overlay are redrawn
+    assert viewer.draw(0.5) == 0
+    x, y, width, height = viewer.get_stats()['redraw_region']
+    assert x == 0 and y == 0
+    assert 0 < width < 32 and 0 < height < 16
+
+    # The animation is constant after its last key frame
+    assert viewer.draw(2) == 0
+    assert viewer.draw(3) == 0
+    assert viewer.get_stats()['redraw_region'][2:] == (0, 0)
+    del viewer
+
+
+def test_frame_cache():
+    cache_dir = tempfile.mkdtemp()
+    frag = ('#version 100\nprecision mediump float;\nuniform vec4 color;\nuniform vec4 tint;\n'
+            'void main() { gl_FragColor = color * tint; }\n')
+    kfs = [ngl.AnimKeyFrameVec4(0, (0, 0, 0, 1)), ngl.AnimKeyFrameVec4(1, (1, 1, 1, 1))]
+    tint = ngl.UniformVec4((1, 1, 1, 1))
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program(fragment=frag))
+    render.update_uniforms(color=ngl.AnimatedVec4(kfs), tint=tint)
+    captures = []
+    for i in range(2):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                frame_cache_dir=cache_dir) == 0
+        viewer.set_scene(render)
+        frames = []
+        for t in (0, 0.5, 1):
+            assert viewer.draw(t) == 0
+            # The frames rendered by the first context are reused by the second one
+            assert viewer.get_stats()['frame_cached'] == i
+            frames.append(bytes(capture_buffer))
+        captures.append(frames)
+        del viewer
+    assert captures[0] == captures[1]
+    assert len([name for name in os.listdir(cache_dir) if name.endswith('.frame')]) == 3
+
+    # A live change renders the frames again
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                            frame_cache_dir=cache_dir) == 0
+    viewer.set_scene(render)
+    assert viewer.draw(0.5) == 0
+    assert viewer.get_stats()['frame_cached'] == 1
+    assert tint.set_value(0.5, 0.5, 0.5, 1) == 0
+    assert viewer.draw(0.5) == 0
+    assert viewer.get_stats()['frame_cached'] == 0
+    assert bytes(capture_buffer) != captures[0][1]
+    del viewer
+
+
+def test_rtt_cache():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    frag = '#version 100\nprecision mediump float;\nuniform vec4 color;\nvoid main() { gl_FragColor = color; }\n'
+    quad = ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0))
+
+    def get_rtt(render):
+        texture = ngl.Texture2D(width=16, height=16)
+        return ngl.RenderToTexture(render, color_textures=[texture]), texture
+
+    def get_render(corner, texture):
+        render = ngl.Render(ngl.Quad(corner, (1, 0, 0), (0, 2, 0)))
+        render.update_textures(tex0=texture)
+        return render
+
+    # A static RTT sampling the texture of an animated one, and a static RTT
+    kfs = [ngl.AnimKeyFrameVec4(0, (1, 0, 0, 1)), ngl.AnimKeyFrameVec4(1, (0, 0, 1, 1))]
+    animated = ngl.Render(quad, ngl.Program(fragment=frag))
+    animated.update_uniforms(color=ngl.AnimatedVec4(kfs))
+    rtt0, texture0 = get_rtt(animated)
+    copy = ngl.Render(quad)
+    copy.update_textures(tex0=texture0)
+    rtt1, texture1 = get_rtt(copy)
+    color = ngl.UniformVec4((0, 1, 0, 1))
+    static = ngl.Render(quad, ngl.Program(fragment=frag))
+    static.update_uniforms(color=color)
+    rtt2, texture2 = get_rtt(static)
+    viewer.set_scene(ngl.Group([rtt0, rtt1, rtt2,
+                                get_render((-1, -1, 0), texture1),
+                                get_render((0, -1, 0), texture2)]))
+
+    def get_pixel(x, y):
+        pos = (y * 16 + x) * 4
+        return tuple(capture_buffer[pos:pos + 4])
+
+    # The textures drawn once follow the animation and the live changes
+    for t, pixel in ((0, (255, 0, 0, 255)), (1, (0, 0, 255, 255)), (2, (0, 0, 255, 255))):
+        assert viewer.draw(t) == 0
+        assert get_pixel(0, 0) == pixel
+        assert get_pixel(15, 15) == (0, 255, 0, 255)
+    assert color.set_value(1, 1, 0, 1) == 0
+    assert viewer.draw(3) == 0
+    assert get_pixel(15, 15) == (255, 255, 0, 255)
+    del viewer
+
+
+def test_pack_uniforms():
+    vert = '''#version 330
+in vec4 ngl_position;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+void main() { gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position; }
+'''
+    frag = '''#version 330
+uniform vec4 color;
+uniform float gain;
+uniform vec3 offsets[2];
+out vec4 frag_color;
+void main() { frag_color = vec4(color.rgb * gain + offsets[1], color.a); }
+'''
+    captures = []
+    for pack_uniforms in (0, 1):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                pack_uniforms=pack_uniforms) == 0
+        program = ngl.Program(vertex=vert, fragment=frag)
+        colors = [ngl.UniformVec4((0.5, 0, 0, 1)), ngl.UniformVec4((0, 0.5, 0, 1))]
+        renders = []
+        for i, color in enumerate(colors):
+            render = ngl.Render(ngl.Quad((-1 + i, -1, 0), (1, 0, 0), (0, 2, 0)), program)
+            render.update_uniforms(color=color, gain=ngl.UniformFloat(2),
+                                   offsets=ngl.BufferVec3(data=array.array('f', [0.5] * 3 + [0, 0, 0.25])))
+            renders.append(render)
+        viewer.set_scene(ngl.Group(renders))
+        # Both pipelines share the program but not their uniform values
+        assert viewer.draw(0) == 0
+        capture = bytes(capture_buffer)
+        assert colors[1].set_value(0, 0.25, 0, 1) == 0
+        assert viewer.draw(1) == 0
+        captures.append((capture, bytes(capture_buffer)))
+        del viewer
+    assert captures[0] == captures[1]
+    assert captures[0][0] != captures[0][1]
+
+
+def test_specialize_uniforms():
+    frag = '''#version 100
+precision highp float;
+uniform vec4 color;
+uniform float gain;
+varying vec3 var_normal;
+void main() { gl_FragColor = vec4(color.rgb * gain + var_normal * 0.0, color.a); }
+'''
+    captures = []
+    for specialize_uniforms in (0, 1):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                specialize_uniforms=specialize_uniforms) == 0
+        program = ngl.Program(fragment=frag)
+        colors = [ngl.UniformVec4((0.25, 0, 0, 1)), ngl.UniformVec4((0, 0.25, 0, 1))]
+        renders = []
+        for i, color in enumerate(colors):
+            render = ngl.Render(ngl.Quad((-1 + i, -1, 0), (1, 0, 0), (0, 2, 0)), program)
+            render.update_uniforms(color=color, gain=ngl.UniformFloat(2))
+            renders.append(render)
+        viewer.set_scene(ngl.Group(renders))
+        # Both passes get their own program with the values compiled in
+        assert viewer.draw(0) == 0
+        captures.append(bytes(capture_buffer))
+        colors[1].set_value(0, 0, 0.25, 1)
+        assert (viewer.draw(1) == 0) == (not specialize_uniforms)
+        del viewer
+    assert captures[0] == captures[1]
+
+
+def test_bindless_textures():
+    vert = '''#version 400
+in vec4 ngl_position;
+in vec2 ngl_uvcoord;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+out vec2 var_uvcoord;
+void main() {
+    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position;
+    var_uvcoord = ngl_uvcoord;
+}
+'''
+    frag = '''#version 400
+uniform sampler2D tex0_sampler;
+in vec2 var_uvcoord;
+out vec4 frag_color;
+void main() { frag_color = texture(tex0_sampler, var_uvcoord); }
+'''
+    captures = []
+    for bindless_textures in (0, 1):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                bindless_textures=bindless_textures) == 0
+        program = ngl.Program(vertex=vert, fragment=frag)
+        renders = []
+        for i in range(2):
+            pixels = array.array('B', ([255, 0, 0, 255] if i else [0, 0, 255, 255]) * 4)
+            texture = ngl.Texture2D(width=2, height=2, data_src=ngl.BufferUBVec4(data=pixels))
+            render = ngl.Render(ngl.Quad((-1 + i, -1, 0), (1, 0, 0), (0, 2, 0)), program)
+            render.update_textures(tex0=texture)
+            renders.append(render)
+        viewer.set_scene(ngl.Group(renders))
+        # The program is shared while each pipeline samples its own texture
+        assert viewer.draw(0) == 0
+        capture = bytes(capture_buffer)
+        assert viewer.draw(1) == 0
+        captures.append((capture, bytes(capture_buffer)))
+        del viewer
+    assert captures[0] == captures[1]
+    assert captures[0][0] == captures[0][1]
+
+
+def test_texture_atlas():
+    captures = []
+    for texture_atlas in (0, 1):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                texture_atlas=texture_atlas) == 0
+        renders = []
+        for i in range(2):
+            pixels = array.array('B')
+            for j in range(4):
+                pixels.extend([200 - 40 * j, 0, 50 * i, 255])
+            texture = ngl.Texture2D(width=2, height=2, min_filter='linear', mag_filter='linear',
+                                    data_src=ngl.BufferUBVec4(data=pixels))
+            render = ngl.Render(ngl.Quad((-1 + i, -1, 0), (1, 0, 0), (0, 2, 0)))
+            render.update_textures(tex0=texture)
+            renders.append(render)
+        viewer.set_scene(ngl.Group(renders))
+        # The filtering must not bleed across the neighbouring atlas regions
+        assert viewer.draw(0) == 0
+        captures.append(bytes(capture_buffer))
+        del viewer
+    assert captures[0] == captures[1]
+
+
+def test_shared_program_layout():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    colors = [(255, 0, 0, 255), (0, 0, 255, 255)]
+    renders = []
+    for i, color in enumerate(colors):
+        texture = ngl.Texture2D(width=1, height=1, data_src=ngl.BufferUBVec4(data=array.array('B', color)))
+        render = ngl.Render(ngl.Quad((-1 + i, -1, 0), (1, 0, 0), (0, 2, 0)))
+        render.update_textures(tex0=texture)
+        renders.append(render)
+    scene = ngl.Group(renders)
+    # The renders resolve tex0 through the layout cached in their shared
+    # program, but must still sample their own texture
+    for i in range(2):
+        assert viewer.set_scene(scene) == 0
+        assert viewer.draw(i) == 0
+        for x, color in ((4, colors[0]), (12, colors[1])):
+            offset = (8 * 16 + x) * 4
+            assert tuple(capture_buffer[offset:offset + 4]) == color
+        assert viewer.set_scene(None) == 0
+    del viewer
+
+
+def test_geometry_buffer_sharing():
+    memory = []
+    for nb_quads in (1, 3):
+        viewer = ngl.Viewer()
+        assert viewer.configure(offscreen=1, width=16, height=16) == 0
+        renders = [ngl.Render(ngl.Quad()) for i in range(nb_quads)]
+        viewer.set_scene(ngl.Group(renders))
+        assert viewer.draw(0) == 0
+        memory.append(viewer.get_stats()['memory_buffers'])
+        viewer.set_scene(None)
+        assert viewer.get_stats()['memory_buffers'] == 0
+        del viewer
+    # Identical shapes share their generated vertex buffers
+    assert memory[0] == memory[1]
+
+
+def test_shape():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    viewer.set_scene(ngl.Shape(shape='ellipse'))
+    assert viewer.draw(0) == 0
+    alpha = capture_buffer[3::4]
+    assert alpha[0] == 0
+    assert alpha[8 * 16 + 8] == 255
+    # The edge is antialiased without multisampling
+    assert any(0 < a < 255 for a in alpha)
+
+
+def test_particle_system():
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+    particles = ngl.ParticleSystem(max_particles=1024, rate=1000, lifetime=0.5, size=0.1,
+                                   velocity=(0, 0, 0), velocity_spread=1.0, gravity=(0, 0, 0))
+    viewer.set_scene(particles)
+    # The system starts at its first draw, and emits from the next one
+    assert viewer.draw(0) == 0
+    assert not any(capture_buffer[0::4])
+    assert viewer.draw(0.1) == 0
+    assert any(capture_buffer[0::4])
+    # Without emission, the particles die at the end of their life
+    particles.set_rate(0)
+    assert viewer.draw(0.7) == 0
+    assert not any(capture_buffer[0::4])
+    # Going back in time restarts the system
+    particles.set_rate(1000)
+    assert viewer.draw(0) == 0
+    assert viewer.draw(0.1) == 0
+    assert any(capture_buffer[0::4])
+    del viewer
+
+
+def test_geometry_optimize_indices():
+    n = 4
+    vertices = array.array('f')
+    for y in range(n + 1):
+        for x in range(n + 1):
+            vertices.extend([-1 + 2. * x / n, -1 + 2. * y / n, 0])
+    indices = array.array('H')
+    for y in range(n):
+        for x in range(n):
+            i = y * (n + 1) + x
+            indices.extend([i, i + 1, i + n + 1, i + 1, i + n + 2, i + n + 1])
+    # Reversed triangle order, which the optimization is free to change
+    triangles = [indices[i:i + 3] for i in range(0, len(indices), 3)]
+    indices = array.array('H', [i for tri in reversed(triangles) for i in tri])
+
+    frag = '#version 100\nprecision mediump float;\nvoid main() { gl_FragColor = vec4(gl_FragCoord.xy / 16.0, 0.0, 1.0); }\n'
+    captures = []
+    for optimize_indices in (0, 1):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+        geometry = ngl.Geometry(ngl.BufferVec3(data=vertices), indices=ngl.BufferUShort(data=indices),
+                                optimize_indices=optimize_indices)
+        viewer.set_scene(ngl.Render(geometry, ngl.Program(fragment=frag)))
+        assert viewer.draw(0) == 0
+        captures.append(bytes(capture_buffer))
+        del viewer
+    assert captures[0] == captures[1]
+
+
+def test_skin():
+    vertices = array.array('f', [-1, -1, 0, 0, -1, 0, 0, 1, 0, -1, 1, 0])
+    joints = array.array('f', [0, 1, 0, 0] * 4)
+    weights = array.array('f', [0, 1, 0, 0] * 4)
+    geometry = ngl.Geometry(ngl.BufferVec3(data=vertices), joints=ngl.BufferVec4(data=joints),
+                            weights=ngl.BufferVec4(data=weights), topology='triangle_fan')
+
+    # The second joint follows its parent, moved from the left to the right half
+    animkf = [ngl.AnimKeyFrameVec3(0, (0, 0, 0)), ngl.AnimKeyFrameVec3(1, (1, 0, 0))]
+    joint0, joint1 = ngl.Identity(), ngl.Identity()
+    skeleton = ngl.Group(children=(joint0, ngl.Translate(joint1, anim=ngl.AnimatedVec3(animkf))))
+    skin = ngl.Skin(skeleton, joints=(joint0, joint1))
+
+    vert = '''#version 330
+in vec4 ngl_position;
+in vec4 ngl_joints;
+in vec4 ngl_weights;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+layout(std140) uniform skin { mat4 joint_matrices[2]; };
+void main()
+{
+    mat4 m = ngl_weights.x * joint_matrices[int(ngl_joints.x)] + ngl_weights.y * joint_matrices[int(ngl_joints.y)];
+    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * m * ngl_position;
+}
+'''
+    frag = '#version 330\nout vec4 color;\nvoid main() { color = vec4(1.0); }\n'
+    render = ngl.Render(geometry, ngl.Program(vertex=vert, fragment=frag))
+    render.update_blocks(skin=ngl.Block(fields=[skin]))
+
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(16 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                            backend=ngl.BACKEND_OPENGL) == 0
+    viewer.set_scene(render)
+    row = 8 * 16 * 4
+    assert viewer.draw(0) == 0
+    assert capture_buffer[row + 2 * 4] and not capture_buffer[row + 13 * 4]
+    assert viewer.draw(1) == 0
+    assert not capture_buffer[row + 2 * 4] and capture_buffer[row + 13 * 4]
+
+    # A joint out of the skeleton is rejected
+    assert viewer.set_scene(ngl.Block(fields=[ngl.Skin(skeleton, joints=(ngl.Identity(),))])) < 0
+    del viewer
+
+
+def test_mesh():
+    import tempfile
+    from pynodegl_utils.misc import write_mesh
+
+    vertices = array.array('f', [-1, -1, 0, 1, -1, 0, -1, 1, 0, 1, 1, 0])
+    uvcoords = array.array('f', [0, 0, 1, 0, 0, 1, 1, 1])
+    indices = array.array('I', [0, 1, 2, 1, 3, 2])
+    frag = '#version 100\nprecision mediump float;\nvarying vec2 var_uvcoord;\n' \
+           'void main() { gl_FragColor = vec4(var_uvcoord, 0.0, 1.0); }\n'
+
+    with tempfile.NamedTemporaryFile(suffix='.nglmesh') as fp:
+        write_mesh(fp.name, vertices, indices, uvcoords)
+        geometries = (
+            ngl.Geometry(ngl.BufferVec3(data=vertices), ngl.BufferVec2(data=uvcoords),
+                         indices=ngl.BufferUInt(data=indices)),
+            ngl.Mesh(fp.name),
+        )
+        captures = []
+        for geometry in geometries:
+            viewer = ngl.Viewer()
+            capture_buffer = bytearray(16 * 16 * 4)
+            assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+            viewer.set_scene(ngl.Render(geometry, ngl.Program(fragment=frag)))
+            assert viewer.draw(0) == 0
+            captures.append(bytes(capture_buffer))
+            del viewer
+        assert captures[0] == captures[1]
+
+        # Truncated file
+        fp.truncate(100)
+        fp.flush()
+        viewer = ngl.Viewer()
+        assert viewer.configure(offscreen=1, width=16, height=16) == 0
+        assert viewer.set_scene(ngl.Render(ngl.Mesh(fp.name))) < 0
+        del viewer
+
+
+def test_optimize_graph():
+    frag = '#version 100\nprecision mediump float;\nvoid main() { gl_FragColor = vec4(gl_FragCoord.xy / 16.0, 0.0, 1.0); }\n'
+    captures = []
+    for optimize_graph in (0, 1):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer,
+                                optimize_graph=optimize_graph) == 0
+        render = ngl.Render(ngl.Quad(), ngl.Program(fragment=frag))
+        scale = ngl.Scale(render, factors=(0.5, 0.7, 1))
+        kfs = [ngl.AnimKeyFrameFloat(0, 30), ngl.AnimKeyFrameFloat(1, 30)]
+        rotate = ngl.Rotate(scale, anim=ngl.AnimatedFloat(kfs))
+        viewer.set_scene(ngl.Translate(rotate, vector=(0.1, -0.2, 0)))
+        assert viewer.draw(0) == 0
+        # A live change of a folded transform must be honored
+        scale.set_factors(0.3, 0.9, 1)
+        assert viewer.draw(0.5) == 0
+        captures.append(bytes(capture_buffer))
+        del viewer
+    assert captures[0] == captures[1]
+
+def test_animation_bake():
+    frag = '#version 100\nprecision mediump float;\nuniform vec4 color;\nvoid main() { gl_FragColor = color; }\n'
+    captures = []
+    for animation_bake_rate, nb_update_threads in (((0, 0), 0), ((60, 1), 0), ((60, 1), 4)):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(4 * 4 * 4)
+        assert viewer.configure(offscreen=1, width=4, height=4, capture_buffer=capture_buffer,
+                                animation_bake_rate=animation_bake_rate,
+                                nb_update_threads=nb_update_threads) == 0
+        render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program(fragment=frag))
+        color = ngl.AnimatedVec4([ngl.AnimKeyFrameVec4(0, (0, 0.2, 1, 1)),
+                                  ngl.AnimKeyFrameVec4(1, (1, 0.7, 0, 1), 'cubic_in_out')])
+        render.update_uniforms(color=color)
+        viewer.set_scene(render)
+        frames = []
+        # The baked animations are exact at the sampling times
+        for i in range(61):
+            assert viewer.draw(i / 60.) == 0
+            frames.append(bytes(capture_buffer))
+        captures.append(frames)
+        del viewer
+    assert captures[0] == captures[1] == captures[2]
+
+def test_animatedbuffer_gpu_interpolation():
+    vert_cpu = '''#version 100
+precision highp float;
+attribute vec4 ngl_position;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+void main() { gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position; }
+'''
+    vert_gpu = '''#version 100
+precision highp float;
+attribute vec3 ngl_position_kf0;
+attribute vec3 ngl_position_kf1;
+uniform float ngl_position_ratio;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+void main()
+{
+    vec3 position = mix(ngl_position_kf0, ngl_position_kf1, ngl_position_ratio);
+    gl_Position = ngl_projection_matrix * ngl_modelview_matrix * vec4(position, 1.0);
+}
+'''
+    frag = '#version 100\nprecision mediump float;\nvoid main() { gl_FragColor = vec4(1.0, 0.5, 0.2, 1.0); }\n'
+    keyframes = (
+        (-1, -1, 0, 1, -1, 0, 0, 1, 0),
+        (-0.5, -1, 0, 0.5, -0.5, 0, 0, 0.2, 0),
+        (-1, 0, 0, 1, 0, 0, 0.3, 1, 0),
+    )
+    captures = []
+    for gpu_interpolation, vert in ((0, vert_cpu), (1, vert_gpu)):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+        animkf = [ngl.AnimKeyFrameBuffer(i, array.array('f', data), 'quadratic_in')
+                  for i, data in enumerate(keyframes)]
+        vertices = ngl.AnimatedBufferVec3(animkf, gpu_interpolation=gpu_interpolation)
+        render = ngl.Render(ngl.Geometry(vertices), ngl.Program(vertex=vert, fragment=frag))
+        viewer.set_scene(render)
+        frames = []
+        # Before, across and after the key frames
+        for i in range(12):
+            assert viewer.draw(-0.5 + i * 0.25) == 0
+            frames.append(bytes(capture_buffer))
+        captures.append(frames)
+        del viewer
+    assert captures[0] == captures[1]
+
+def test_streamed_gpu_lookup():
+    vert = '''#version 430
+in vec4 ngl_position;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+void main() { gl_Position = ngl_projection_matrix * ngl_modelview_matrix * ngl_position; }
+'''
+    frag_cpu = '''#version 430
+uniform vec4 color;
+out vec4 frag_color;
+void main() { frag_color = color; }
+'''
+    frag_gpu = '''#version 430
+layout(std430, binding=0) buffer color_data { vec4 samples[]; };
+uniform int color_index;
+out vec4 frag_color;
+void main() { frag_color = samples[color_index]; }
+'''
+    timestamps = array.array('q', (0, 1000000, 2000000, 4000000))
+    colors = array.array('f', (1, 0, 0, 1,  0, 1, 0, 1,  0, 0, 1, 1,  1, 1, 1, 1))
+    captures = []
+    for gpu_lookup, frag in ((0, frag_cpu), (1, frag_gpu)):
+        viewer = ngl.Viewer()
+        capture_buffer = bytearray(16 * 16 * 4)
+        assert viewer.configure(offscreen=1, width=16, height=16, capture_buffer=capture_buffer) == 0
+        streamed = ngl.StreamedVec4(ngl.BufferInt64(data=timestamps), ngl.BufferVec4(data=colors),
+                                    gpu_lookup=gpu_lookup)
+        render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), ngl.Program(vertex=vert, fragment=frag))
+        render.update_uniforms(color=streamed)
+        viewer.set_scene(render)
+        frames = []
+        # Before, across and after the samples
+        for i in range(11):
+            assert viewer.draw(-0.5 + i * 0.5) == 0
+            frames.append(bytes(capture_buffer))
+        captures.append(frames)
+        del viewer
+    assert captures[0] == captures[1]
+
+
+def test_rtt_precision():
+    viewer = ngl.Viewer()
+    assert viewer.configure(offscreen=1, width=16, height=16) == 0
+    texture = ngl.Texture2D(width=16, height=16, format='r32g32b32a32_sfloat')
+    rtt = ngl.RenderToTexture(ngl.Render(ngl.Quad()), color_textures=[texture],
+                              features='depth', precision='ldr')
+    render = ngl.Render(ngl.Quad())
+    render.update_textures(tex0=texture)
+    scene = ngl.Group([rtt, render])
+
+    # The scene never tests the depth, its buffer is dropped
+    assert viewer.set_scene(scene) == 0
+    assert viewer.draw(0) == 0
+    stats = viewer.get_stats()
+    assert stats['nb_rtt_formats']['r8g8b8a8_unorm'] == 1
+    assert stats['nb_rtt_dropped_depths'] == 1
+    assert stats['rtt_saved_memory'] == 16 * 16 * (16 - 4) + 16 * 16 * 2
+
+    # The depth test inherited from a parent restores it
+    assert viewer.set_scene(ngl.GraphicConfig(scene, depth_test=True)) == 0
+    assert viewer.draw(0) == 0
+    stats = viewer.get_stats()
+    assert stats['nb_rtt_formats']['r8g8b8a8_unorm'] == 1
+    assert stats['nb_rtt_dropped_depths'] == 0
+    assert stats['rtt_saved_memory'] == 16 * 16 * (16 - 4)
+
+    assert viewer.set_scene(None) == 0
+    stats = viewer.get_stats()
+    assert stats['nb_rtt_formats']['r8g8b8a8_unorm'] == 0
+    assert stats['rtt_saved_memory'] == 0
+
+
+def test_stereo_camera():
+    vert = '''#version 330
+in vec4 ngl_position;
+uniform mat4 ngl_modelview_matrix;
+uniform mat4 ngl_projection_matrix;
+void main() { gl_Position = ngl_projection_matrix * ngl_view_matrix * ngl_modelview_matrix * ngl_position; }
+'''
+    frag = '''#version 330
+out vec4 frag_color;
+void main() { frag_color = vec4(1.0, 0.0, 0.0, 1.0); }
+'''
+    viewer = ngl.Viewer()
+    capture_buffer = bytearray(32 * 16 * 4)
+    assert viewer.configure(offscreen=1, width=32, height=16, capture_buffer=capture_buffer) == 0
+    render = ngl.Render(ngl.Quad((-0.5, -1, 0), (1, 0, 0), (0, 2, 0)),
+                        ngl.Program(vertex=vert, fragment=frag, nb_views=2))
+    # The scene is shifted by half the eye separation in each view
+    scene = ngl.StereoCamera(render, eye_separation=1)
+    if viewer.set_scene(scene) < 0:
+        return  # multiview rendering not supported by the context
+    assert viewer.draw(0) == 0
+    red = [(x, capture_buffer[(8 * 32 + x) * 4]) for x in (4, 12, 20, 28)]
+    assert red == [(4, 0), (12, 255), (20, 255), (28, 0)]
+
+
 if __name__ == '__main__':
     test_backend()
     test_reconfigure()
+    test_reconfigure_keep_scene()
+    test_thread_priority()
+    test_debug()
+    test_shared_subtree()
+    test_draw_async()
+    test_anim_evaluate_batch()
     test_ctx_ownership()
     test_ctx_ownership_subgraph()
+    test_stats()
+    test_cpu_memory_stats()
+    test_profile()
+    test_dot_cost()
+    test_async_programs()
+    test_share_group()
+    test_gl_caps_cache()
+    test_prepare_scene()
+    test_serialize_binary()
+    test_serialize_binary_dedup()
+    test_deserialize_file()
+    test_serialize_to_file()
+    test_buffer_wrap_map()
+    test_buffer_update()
+    test_buffer_read_async()
+    test_buffer_gpu_only()
+    test_buffer_block_texture()
+    test_outputs()
+    test_capture_buffer_view()
+    test_capture_format()
+    test_occlusion_cull()
+    test_level_of_detail()
+    test_virtual_texture()
+    test_media_still()
+    test_blur()
+    test_framebuffer_fetch()
+    test_depth_sort()
+    test_draw_batch()
+    test_warmup()
+    test_analyze()
+    test_update_scene()
+    test_text_live_change()
+    test_release_delay()
+    test_gpu_memory_budget()
+    test_prefetch_upload_budget()
+    test_update_threads()
+    test_upload_thread()
+    test_decoder_pool()
+    test_skip_idle_frames()
+    test_next_change_time()
+    test_damage_tracking()
+    test_frame_cache()
+    test_rtt_cache()
+    test_pack_uniforms()
+    test_specialize_uniforms()
+    test_bindless_textures()
+    test_texture_atlas()
+    test_shared_program_layout()
+    test_geometry_buffer_sharing()
+    test_shape()
+    test_particle_system()
+    test_geometry_optimize_indices()
+    test_skin()
+    test_mesh()
+    test_optimize_graph()
+    test_animation_bake()
+    test_animatedbuffer_gpu_interpolation()
+    test_streamed_gpu_lookup()
+    test_rtt_precision()
+    test_stereo_camera()
@@ -0,0 +1,137 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2019 GoPro Inc.
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+
+import os
+import os.path as op
+import json
+import subprocess
+import sys
+
+from pynodegl_utils.com import query_inplace
+
+
+# Heavy scenes covering the costly code paths, as (module, scene, options)
+PERF_SCENES = (
+    ('misc', 'cropboard', dict(extra_args=dict(dim=50))),           # many renders
+    ('transforms', 'animated_buffer', dict(extra_args=dict(dim=50))),  # big animated buffer
+    ('misc', 'particules', dict(extra_args=dict(particules=1023))),  # compute
+    ('medias', 'playback_speed', None),                             # media decoding
+    ('misc', 'histogram', None),                                    # RTT and compute chain
+    ('misc', 'cube', None),                                         # RTT with depth
+    ('misc', 'fibo', dict(enable_hud=True)),                        # HUD
+)
+
+WARMUP = 30
+RANGES = ('0:5:60',)
+
+# Timings (median and 95th percentile, in microseconds) compared against the
+# baseline; a regression smaller than the noise floor is never reported
+TIMING_METRICS = ('frame', 'cpu', 'gpu')
+TIMING_NOISE_FLOOR = 200
+
+
+def _serialize(dirname, module_name, scene_name, options):
+    cfg = dict(pkg='pynodegl_utils.examples', query='scene', scene=(module_name, scene_name))
+    cfg.update(options or {})
+    ret = query_inplace(**cfg)
+    assert 'error' not in ret, ret['error']
+    fname = op.join(dirname, 'perf_%s_%s.ngl' % (module_name, scene_name))
+    open(fname, 'w').write(ret['scene'])
+    return fname
+
+
+def _bench(fname):
+    report = fname[:-len('.ngl')] + '.json'
+    cmd = ['ngl-render', fname, '--bench', '-W', str(WARMUP), '-b', report]
+    for time_range in RANGES:
+        cmd += ['-t', time_range]
+    subprocess.check_call(cmd)
+    return json.load(open(report))
+
+
+def _compare(name, result, baseline, threshold):
+    errors = []
+    ratio = 1. + threshold / 100.
+
+    for metric in TIMING_METRICS:
+        ref = baseline['timings'].get(metric)
+        cur = result['timings'].get(metric)
+        if ref is None or cur is None:
+            continue
+        for key in ('median', 'p95'):
+            if cur[key] > ref[key] * ratio and cur[key] - ref[key] > TIMING_NOISE_FLOOR:
+                errors.append('%s: %s %s time regressed from %dus to %dus' % (
+                              name, metric, key, ref[key], cur[key]))
+
+    for category, ref in baseline['memory'].items():
+        cur = result['memory'].get(category, 0)
+        if cur > ref * ratio:
+            errors.append('%s: %s memory regressed from %d to %d bytes' % (
+                          name, category, ref, cur))
+
+    return errors
+
+
+def perf(dirname, baseline_file, threshold=None):
+    '''
+    Benchmark the performance scenes and compare the results against the
+    baseline file, or update it if no threshold (in percent) is specified.
+    '''
+    if not op.exists(dirname):
+        os.makedirs(dirname)
+
+    baselines = json.load(open(baseline_file)) if op.exists(baseline_file) else {}
+
+    errors = []
+    for module_name, scene_name, options in PERF_SCENES:
+        name = '%s_%s' % (module_name, scene_name)
+        fname = _serialize(dirname, module_name, scene_name, options)
+        result = _bench(fname)
+
+        if threshold is None:
+            baselines[name] = dict(timings=result['timings'], memory=result['memory'])
+            continue
+
+        baseline = baselines.get(name)
+        if not baseline:
+            print('%s: no baseline recorded, run "make tests_perf_update"' % name)
+            continue
+        errors += _compare(name, result, baseline, threshold)
+
+    if threshold is None:
+        with open(baseline_file, 'w') as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write('\n')
+        return 0
+
+    for error in errors:
+        print(error)
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4:
+        print('Usage: %s <datadir> <baseline.json> <threshold|update>' % sys.argv[0])
+        sys.exit(1)
+    threshold = None if sys.argv[3] == 'update' else float(sys.argv[3])
+    sys.exit(perf(sys.argv[1], sys.argv[2], threshold))